@@ -18,209 +18,535 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <exception>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <sstream>
+#include <thread>
 
 #include "../../shared/CLI11.hpp"
+#include "../../shared/environment.h"
 #include "../../shared/gpubuf.h"
 #include "../../shared/hip_object_wrapper.h"
+#include "../../shared/power_sampler.h"
 #include "../../shared/rocfft_params.h"
 #include "bench.h"
 #include "rocfft/rocfft.h"
 
-int main(int argc, char* argv[])
+// value at quantile q (0 to 1) of sorted values, by nearest rank
+static double quantile(const std::vector<double>& sorted, double q)
 {
-    // This helps with mixing output of both wide and narrow characters to the screen
-    std::ios::sync_with_stdio(false);
-
-    // Control output verbosity:
-    int verbose{};
-
-    // hip Device number for running tests:
-    int deviceId{};
-
-    // Number of performance trial samples
-    int ntrial{};
+    if(sorted.empty())
+        return 0.0;
+    size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
 
-    // FFT parameters:
-    rocfft_params params;
+// Run nplans copies of the transform concurrently on nstreams
+// streams, enqueued from nthreads host threads, and report aggregate
+// throughput and the distribution of per-execution times.  Each copy
+// has its own plan and buffers, with input copied from the given
+// buffers.
+static void run_throughput(const rocfft_params&       params,
+                           const std::vector<gpubuf>& ibuffer,
+                           int                        nplans,
+                           int                        nstreams,
+                           int                        nthreads,
+                           int                        ntrial)
+{
+    struct Instance
+    {
+        std::unique_ptr<rocfft_params>  params;
+        std::vector<gpubuf>             ibuffer;
+        std::vector<gpubuf>             obuffer;
+        std::vector<void*>              pibuffer;
+        std::vector<void*>              pobuffer;
+        std::vector<hipEvent_wrapper_t> start;
+        std::vector<hipEvent_wrapper_t> stop;
+    };
 
-    // Token string to fully specify fft params.
-    std::string token;
+    std::vector<hipStream_wrapper_t> streams(nstreams);
+    for(auto& stream : streams)
+        stream.alloc();
 
-    CLI::App app{"rocfft-bench command line options"};
+    const auto ibuffer_sizes = params.ibuffer_sizes();
+    const auto obuffer_sizes = params.obuffer_sizes();
+    const bool inplace       = params.placement == fft_placement_inplace;
 
-    // Declare the supported options. Some option pointers are declared to track passed opts.
-    app.add_flag("--version", "Print queryable version information from the rocfft library")
-        ->each([](const std::string&) {
-            char v[256];
-            rocfft_get_version_string(v, 256);
-            std::cout << "version " << v << std::endl;
-            std::exit(EXIT_SUCCESS);
-        });
-
-    CLI::Option* opt_token
-        = app.add_option("--token", token, "Token to read FFT params from")->default_val("");
-    // Group together options that conflict with --token
-    auto* non_token = app.add_option_group("Token Conflict", "Options excluded by --token");
-    non_token
-        ->add_flag("--double", "Double precision transform (deprecated: use --precision double)")
-        ->each([&](const std::string&) { params.precision = fft_precision_double; });
-    non_token->excludes(opt_token);
-    non_token
-        ->add_option("-t, --transformType",
-                     params.transform_type,
-                     "Type of transform:\n0) complex forward\n1) complex inverse\n2) real "
-                     "forward\n3) real inverse")
-        ->default_val(fft_transform_type_complex_forward);
-    non_token
-        ->add_option(
-            "--precision", params.precision, "Transform precision: single (default), double, half")
-        ->excludes("--double");
-    CLI::Option* opt_not_in_place
-        = non_token->add_flag("-o, --notInPlace", "Not in-place FFT transform (default: in-place)")
-              ->each([&](const std::string&) { params.placement = fft_placement_notinplace; });
-    non_token
-        ->add_option("--itype",
-                     params.itype,
-                     "Array type of input data:\n0) interleaved\n1) planar\n2) real\n3) "
-                     "hermitian interleaved\n4) hermitian planar")
-        ->default_val(fft_array_type_unset);
-    non_token
-        ->add_option("--otype",
-                     params.otype,
-                     "Array type of output data:\n0) interleaved\n1) planar\n2) real\n3) "
-                     "hermitian interleaved\n4) hermitian planar")
-        ->default_val(fft_array_type_unset);
-    CLI::Option* opt_length
-        = non_token->add_option("--length", params.length, "Lengths")->required()->expected(1, 3);
-    non_token
-        ->add_option("-b, --batchSize",
-                     params.nbatch,
-                     "If this value is greater than one, arrays will be used")
-        ->default_val(1);
-    CLI::Option* opt_istride = non_token->add_option("--istride", params.istride, "Input strides");
-    CLI::Option* opt_ostride = non_token->add_option("--ostride", params.ostride, "Output strides");
-    non_token->add_option("--idist", params.idist, "Logical distance between input batches")
-        ->default_val(0)
-        ->each([&](const std::string& val) { std::cout << "idist: " << val << "\n"; });
-    non_token->add_option("--odist", params.odist, "Logical distance between output batches")
-        ->default_val(0)
-        ->each([&](const std::string& val) { std::cout << "odist: " << val << "\n"; });
-    CLI::Option* opt_ioffset = non_token->add_option("--ioffset", params.ioffset, "Input offset");
-    CLI::Option* opt_ooffset = non_token->add_option("--ooffset", params.ooffset, "Output offset");
+    std::vector<Instance> instances(nplans);
+    for(int i = 0; i < nplans; ++i)
+    {
+        auto& inst  = instances[i];
+        inst.params = std::make_unique<rocfft_params>(static_cast<const fft_params&>(params));
+        if(inst.params->create_plan() != fft_status_success)
+            LIB_V_THROW(rocfft_status_failure, "Plan creation failed");
+        LIB_V_THROW(rocfft_execution_info_set_stream(inst.params->info, streams[i % nstreams]),
+                    "rocfft_execution_info_set_stream failed");
 
-    app.add_option("--device", deviceId, "Select a specific device id")->default_val(0);
-    app.add_option("--verbose", verbose, "Control output verbosity")->default_val(0);
-    app.add_option("-N, --ntrial", ntrial, "Trial size for the problem")
-        ->default_val(1)
-        ->each([&](const std::string& val) {
-            std::cout << "Running profile with " << val << " samples\n";
-        });
+        inst.ibuffer.resize(ibuffer_sizes.size());
+        for(unsigned int j = 0; j < ibuffer_sizes.size(); ++j)
+        {
+            HIP_V_THROW(inst.ibuffer[j].alloc(ibuffer_sizes[j]), "Creating input Buffer failed");
+            HIP_V_THROW(hipMemcpy(inst.ibuffer[j].data(),
+                                  ibuffer[j].data(),
+                                  ibuffer_sizes[j],
+                                  hipMemcpyDeviceToDevice),
+                        "hipMemcpy failed");
+            inst.pibuffer.push_back(inst.ibuffer[j].data());
+        }
+        if(inplace)
+            inst.pobuffer = inst.pibuffer;
+        else
+        {
+            inst.obuffer.resize(obuffer_sizes.size());
+            for(unsigned int j = 0; j < obuffer_sizes.size(); ++j)
+            {
+                HIP_V_THROW(inst.obuffer[j].alloc(obuffer_sizes[j]),
+                            "Creating output Buffer failed");
+                inst.pobuffer.push_back(inst.obuffer[j].data());
+            }
+        }
 
-    app.add_option("-g, --inputGen",
-                   params.igen,
-                   "Input data generation:\n0) PRNG sequence (device)\n"
-                   "1) PRNG sequence (host)\n"
-                   "2) linearly-spaced sequence (device)\n"
-                   "3) linearly-spaced sequence (host)")
-        ->default_val(fft_input_random_generator_device);
-    app.add_option("--isize", params.isize, "Logical size of input buffer");
-    app.add_option("--osize", params.osize, "Logical size of output buffer");
-    app.add_option("--scalefactor", params.scale_factor, "Scale factor to apply to output");
+        inst.start.resize(ntrial);
+        inst.stop.resize(ntrial);
+        for(int t = 0; t < ntrial; ++t)
+        {
+            inst.start[t].alloc();
+            inst.stop[t].alloc();
+        }
 
-    // Parse args and catch any errors here
-    try
-    {
-        app.parse(argc, argv);
-    }
-    catch(const CLI::ParseError& e)
-    {
-        return app.exit(e);
+        // warm up each plan on its stream
+        if(inst.params->execute(inst.pibuffer.data(), inst.pobuffer.data()) != fft_status_success)
+            LIB_V_THROW(rocfft_status_failure, "Execution failed");
     }
+    HIP_V_THROW(hipDeviceSynchronize(), "hipDeviceSynchronize failed");
 
-    if(!token.empty())
-    {
-        std::cout << "Reading fft params from token:\n" << token << std::endl;
-
+    // each thread enqueues every trial of its share of the plans
+    std::exception_ptr error;
+    std::mutex         error_mutex;
+    auto               run = [&](int thread) {
         try
         {
-            params.from_token(token);
+            for(int t = 0; t < ntrial; ++t)
+            {
+                for(int i = thread; i < nplans; i += nthreads)
+                {
+                    auto&       inst   = instances[i];
+                    hipStream_t stream = streams[i % nstreams];
+                    HIP_V_THROW(hipEventRecord(inst.start[t], stream), "hipEventRecord failed");
+                    if(inst.params->execute(inst.pibuffer.data(), inst.pobuffer.data())
+                       != fft_status_success)
+                        LIB_V_THROW(rocfft_status_failure, "Execution failed");
+                    HIP_V_THROW(hipEventRecord(inst.stop[t], stream), "hipEventRecord failed");
+                }
+            }
         }
         catch(...)
         {
-            std::cout << "Unable to parse token." << std::endl;
-            return EXIT_FAILURE;
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if(!error)
+                error = std::current_exception();
         }
-    }
-    else
+    };
+
+    auto                     wall_start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for(int thread = 0; thread < nthreads; ++thread)
+        threads.emplace_back(run, thread);
+    for(auto& thread : threads)
+        thread.join();
+    HIP_V_THROW(hipDeviceSynchronize(), "hipDeviceSynchronize failed");
+    auto wall_end = std::chrono::steady_clock::now();
+    if(error)
+        std::rethrow_exception(error);
+
+    std::vector<double> exec_time;
+    for(auto& inst : instances)
     {
-        if(*opt_not_in_place)
+        for(int t = 0; t < ntrial; ++t)
         {
-            std::cout << "out-of-place\n";
+            float time;
+            HIP_V_THROW(hipEventElapsedTime(&time, inst.start[t], inst.stop[t]),
+                        "hipEventElapsedTime failed");
+            exec_time.push_back(time);
         }
-        else
+    }
+    std::sort(exec_time.begin(), exec_time.end());
+
+    size_t exec_bytes = 0;
+    for(auto size : ibuffer_sizes)
+        exec_bytes += size;
+    for(auto size : inplace ? ibuffer_sizes : obuffer_sizes)
+        exec_bytes += size;
+
+    const double seconds    = std::chrono::duration<double>(wall_end - wall_start).count();
+    const double executions = static_cast<double>(nplans) * ntrial;
+
+    std::cout << "\nThroughput: " << nplans << " plans, " << nstreams << " streams, " << nthreads
+              << " threads, " << ntrial << " trials" << std::endl;
+    std::cout << "Aggregate time: " << seconds * 1e3 << " ms" << std::endl;
+    std::cout << "Aggregate throughput: " << executions * params.nbatch / seconds
+              << " transforms/s, " << executions * exec_bytes / (seconds * 1e9) << " GB/s"
+              << std::endl;
+    std::cout << "Execution gpu time p50: " << quantile(exec_time, 0.5)
+              << " ms, p99: " << quantile(exec_time, 0.99) << " ms" << std::endl;
+}
+
+// Remove a kernel cache database along with any files sqlite keeps
+// beside it.
+static void remove_cache_db(const std::filesystem::path& db)
+{
+    std::error_code ec;
+    for(const char* suffix : {"", "-journal", "-wal", "-shm"})
+        std::filesystem::remove(db.string() + suffix, ec);
+}
+
+static void print_times(const char* label, const std::vector<double>& times)
+{
+    std::cout << label << ":";
+    for(auto t : times)
+        std::cout << " " << t;
+    auto sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    std::cout << " ms (median " << quantile(sorted, 0.5) << " ms)" << std::endl;
+}
+
+// Time library setup, plan creation and the first execution of the
+// transform under controlled kernel cache states.  The states are
+// selected through the RTC cache environment variables, which the
+// library only reads in rocfft_setup.
+static void run_plan_create(rocfft_params&      params,
+                            std::vector<void*>& pibuffer,
+                            std::vector<void*>& pobuffer,
+                            int                 ntrial)
+{
+    namespace fs = std::filesystem;
+
+    const auto tag = std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    const auto user_cache   = fs::temp_directory_path() / ("rocfft-bench-cache-" + tag + ".db");
+    const auto no_sys_cache = fs::temp_directory_path() / ("rocfft-bench-nosys-" + tag + ".db");
+
+    struct cache_state
+    {
+        const char* name;
+        // use the AOT kernels shipped with the library
+        bool sys_cache;
+        // keep the user cache between trials, after priming it
+        bool keep_user_cache;
+        // keep the library set up between trials, so kernels stay
+        // loaded in memory
+        bool keep_setup;
+    };
+    const cache_state states[] = {
+        {"empty cache", false, false, false},
+        {"warm sqlite cache", false, true, false},
+        {"AOT cache only", true, false, false},
+        {"in-memory warm", true, true, true},
+    };
+
+    const auto elapsed_ms = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count();
+    };
+
+    // start from a library that has never seen the transform
+    params.free();
+    rocfft_cleanup();
+
+    for(const auto& state : states)
+    {
+        remove_cache_db(user_cache);
+        EnvironmentSetTemp user_env("ROCFFT_RTC_CACHE_PATH", user_cache.string().c_str());
+        // pointing the system cache at a nonexistent file disables it
+        std::optional<EnvironmentSetTemp> sys_env;
+        if(!state.sys_cache)
+            sys_env.emplace("ROCFFT_RTC_SYS_CACHE_PATH", no_sys_cache.string().c_str());
+
+        // prime the caches this state expects to be warm
+        if(state.keep_user_cache)
         {
-            std::cout << "in-place\n";
+            rocfft_setup();
+            if(params.create_plan() != fft_status_success)
+                LIB_V_THROW(rocfft_status_failure, "Plan creation failed");
+            params.free();
+            if(!state.keep_setup)
+                rocfft_cleanup();
         }
 
-        if(*opt_length)
+        std::vector<double> setup_ms;
+        std::vector<double> create_ms;
+        std::vector<double> first_exec_ms;
+        // where plan creation spent its time on kernels - a cache hit
+        // should spend none of it generating or compiling source
+        std::vector<double> generation_ms;
+        std::vector<double> lookup_ms;
+        std::vector<double> compile_ms;
+        std::vector<double> load_ms;
+        for(int itrial = 0; itrial < ntrial; ++itrial)
         {
-            std::cout << "length:";
-            for(auto& i : params.length)
-                std::cout << " " << i;
-            std::cout << "\n";
+            if(!state.keep_setup)
+            {
+                if(!state.keep_user_cache)
+                    remove_cache_db(user_cache);
+                auto start = std::chrono::steady_clock::now();
+                rocfft_setup();
+                setup_ms.push_back(elapsed_ms(start));
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            if(params.create_plan() != fft_status_success)
+                LIB_V_THROW(rocfft_status_failure, "Plan creation failed");
+            create_ms.push_back(elapsed_ms(start));
+
+            rocfft_plan_create_times times = {};
+            LIB_V_THROW(rocfft_plan_get_create_times(params.plan, &times),
+                        "rocfft_plan_get_create_times failed");
+            generation_ms.push_back(times.kernel_generation_ms);
+            lookup_ms.push_back(times.rtc_cache_lookup_ms);
+            compile_ms.push_back(times.rtc_compile_ms);
+            load_ms.push_back(times.module_load_ms);
+
+            start = std::chrono::steady_clock::now();
+            params.execute(pibuffer.data(), pobuffer.data());
+            HIP_V_THROW(hipDeviceSynchronize(), "hipDeviceSynchronize failed");
+            first_exec_ms.push_back(elapsed_ms(start));
+
+            params.free();
+            if(!state.keep_setup)
+                rocfft_cleanup();
         }
+        if(state.keep_setup)
+            rocfft_cleanup();
 
-        if(*opt_istride)
+        std::cout << "\nPlan creation, " << state.name << ":" << std::endl;
+        if(!setup_ms.empty())
+            print_times("rocfft_setup time", setup_ms);
+        print_times("Plan creation time", create_ms);
+        print_times("  Kernel generation time", generation_ms);
+        print_times("  Kernel cache lookup time", lookup_ms);
+        print_times("  Kernel compile time", compile_ms);
+        print_times("  Kernel load time", load_ms);
+        print_times("First execution time", first_exec_ms);
+    }
+    remove_cache_db(user_cache);
+}
+
+// Parse a plan's rocfft-bench command line, as written to the bench
+// and replay logs, into params.
+static void parse_bench_command(const std::string& command, rocfft_params& params)
+{
+    CLI::App app;
+    app.add_option("-t, --transformType", params.transform_type);
+    app.add_option("--precision", params.precision);
+    app.add_flag("-o, --notInPlace")->each([&](const std::string&) {
+        params.placement = fft_placement_notinplace;
+    });
+    app.add_option("--itype", params.itype);
+    app.add_option("--otype", params.otype);
+    app.add_option("--length", params.length)->required()->expected(1, 3);
+    app.add_option("-b, --batchSize", params.nbatch);
+    app.add_option("--istride", params.istride);
+    app.add_option("--ostride", params.ostride);
+    app.add_option("--idist", params.idist);
+    app.add_option("--odist", params.odist);
+    app.add_option("--ioffset", params.ioffset);
+    app.add_option("--ooffset", params.ooffset);
+    try
+    {
+        app.parse(command, true);
+    }
+    catch(const CLI::ParseError&)
+    {
+        throw std::runtime_error("unable to parse replay plan: " + command);
+    }
+}
+
+// Replay a trace written by the library's replay log layer: create
+// the same mixture of plans, then execute them in the recorded order
+// and at the recorded cadence.  Executions are all enqueued on the
+// null stream.
+static void run_replay(const std::string& path, int verbose)
+{
+    struct replay_plan
+    {
+        std::unique_ptr<rocfft_params> params;
+        std::vector<gpubuf>            ibuffer;
+        std::vector<gpubuf>            obuffer;
+        std::vector<void*>             pibuffer;
+        std::vector<void*>             pobuffer;
+        std::vector<double>            gpu_time;
+    };
+
+    // plans by their ID in the trace, and (plan ID, enqueue time in
+    // microseconds) for each execution
+    std::map<size_t, replay_plan>           plans;
+    std::vector<std::pair<size_t, int64_t>> executions;
+
+    std::ifstream in(path);
+    if(!in)
+        throw std::runtime_error("unable to open replay file " + path);
+    std::string line;
+    while(std::getline(in, line))
+    {
+        std::istringstream ss(line);
+        std::string        kind;
+        size_t             id;
+        if(!(ss >> kind >> id))
+            continue;
+        if(kind == "plan")
         {
-            std::cout << "istride:";
-            for(auto& i : params.istride)
-                std::cout << " " << i;
-            std::cout << "\n";
+            std::string command;
+            std::getline(ss >> std::ws, command);
+            auto& plan  = plans[id];
+            plan.params = std::make_unique<rocfft_params>();
+            parse_bench_command(command, *plan.params);
         }
-        if(*opt_ostride)
+        else if(kind == "execute")
         {
-            std::cout << "ostride:";
-            for(auto& i : params.ostride)
-                std::cout << " " << i;
-            std::cout << "\n";
+            int64_t us;
+            if(!(ss >> us))
+                continue;
+            if(plans.find(id) == plans.end())
+                throw std::runtime_error("replay file executes unknown plan " + std::to_string(id));
+            executions.emplace_back(id, us);
         }
+    }
+    if(executions.empty())
+        throw std::runtime_error("replay file " + path + " has no executions");
 
-        if(*opt_ioffset)
+    for(auto& [id, plan] : plans)
+    {
+        auto& params = *plan.params;
+        params.validate();
+        if(!params.valid(verbose))
+            throw std::runtime_error("Invalid parameters for replay plan " + std::to_string(id));
+        if(params.create_plan() != fft_status_success)
+            LIB_V_THROW(rocfft_status_failure, "Plan creation failed");
+
+        for(auto size : params.ibuffer_sizes())
         {
-            std::cout << "ioffset:";
-            for(auto& i : params.ioffset)
-                std::cout << " " << i;
-            std::cout << "\n";
+            plan.ibuffer.emplace_back();
+            HIP_V_THROW(plan.ibuffer.back().alloc(size), "Creating input Buffer failed");
+            plan.pibuffer.push_back(plan.ibuffer.back().data());
         }
-        if(*opt_ooffset)
+        params.compute_input(plan.ibuffer);
+        if(params.placement == fft_placement_inplace)
+            plan.pobuffer = plan.pibuffer;
+        else
         {
-            std::cout << "ooffset:";
-            for(auto& i : params.ooffset)
-                std::cout << " " << i;
-            std::cout << "\n";
+            for(auto size : params.obuffer_sizes())
+            {
+                plan.obuffer.emplace_back();
+                HIP_V_THROW(plan.obuffer.back().alloc(size), "Creating output Buffer failed");
+                plan.pobuffer.push_back(plan.obuffer.back().data());
+            }
         }
     }
 
-    std::cout << std::flush;
+    std::vector<hipEvent_wrapper_t> start(executions.size());
+    std::vector<hipEvent_wrapper_t> stop(executions.size());
+    for(size_t i = 0; i < executions.size(); ++i)
+    {
+        start[i].alloc();
+        stop[i].alloc();
+    }
+    HIP_V_THROW(hipDeviceSynchronize(), "hipDeviceSynchronize failed");
 
-    rocfft_setup();
+    const auto trace_start = executions.front().second;
+    const auto wall_start  = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < executions.size(); ++i)
+    {
+        auto& plan = plans[executions[i].first];
+        std::this_thread::sleep_until(wall_start
+                                      + std::chrono::microseconds(executions[i].second
+                                                                  - trace_start));
+        HIP_V_THROW(hipEventRecord(start[i]), "hipEventRecord failed");
+        plan.params->execute(plan.pibuffer.data(), plan.pobuffer.data());
+        HIP_V_THROW(hipEventRecord(stop[i]), "hipEventRecord failed");
+    }
+    HIP_V_THROW(hipDeviceSynchronize(), "hipDeviceSynchronize failed");
+    auto wall_end = std::chrono::steady_clock::now();
 
-    // Set GPU for single-device FFT computation
-    rocfft_scoped_device dev(deviceId);
+    for(size_t i = 0; i < executions.size(); ++i)
+    {
+        float time;
+        HIP_V_THROW(hipEventElapsedTime(&time, start[i], stop[i]), "hipEventElapsedTime failed");
+        plans[executions[i].first].gpu_time.push_back(time);
+    }
+
+    const double span_ms = (executions.back().second - trace_start) / 1e3;
+    std::cout << "\nReplayed " << executions.size() << " executions of " << plans.size()
+              << " plans in "
+              << std::chrono::duration<double, std::milli>(wall_end - wall_start).count()
+              << " ms (trace span " << span_ms << " ms)" << std::endl;
+
+    // per-plan results, in the same form as a single-problem run
+    for(auto& [id, plan] : plans)
+    {
+        std::cout << "\nToken: " << plan.params->token() << std::endl;
+        if(plan.gpu_time.empty())
+            continue;
+        std::cout << "Execution gpu time:";
+        for(auto t : plan.gpu_time)
+            std::cout << " " << t;
+        std::cout << " ms" << std::endl;
+    }
+}
+
+// Options that apply to every problem rocfft-bench times
+struct bench_options
+{
+    // Control output verbosity
+    int verbose = 0;
+
+    // hip Device number for running tests
+    int deviceId = 0;
+
+    // Number of performance trial samples
+    int ntrial = 1;
 
+    // Throughput mode: number of plans run concurrently, and the
+    // streams and host threads they are spread over
+    int nplans   = 1;
+    int nstreams = 1;
+    int nthreads = 1;
+
+    // What to measure: execution time, or plan creation time under
+    // various kernel cache states
+    std::string measure = "execution";
+
+    // Size in MiB of a scratch buffer written between trials to evict
+    // the transform's data from the GPU caches, or 0 to keep them warm
+    size_t flush_mib = 0;
+
+    // Sample the GPU's power draw during each trial and report energy
+    bool power = false;
+};
+
+// Allocate buffers for one problem, create its plan and time it.
+// Returns false if the problem was skipped because it does not fit
+// on the device.  Everything the problem allocates is released on
+// return.
+static bool run_problem(rocfft_params& params, const bench_options& opts)
+{
     params.validate();
 
-    if(!params.valid(verbose))
+    if(!params.valid(opts.verbose))
     {
         throw std::runtime_error("Invalid parameters, add --verbose=1 for detail");
     }
 
     std::cout << "Token: " << params.token() << std::endl;
-    if(verbose)
+    if(opts.verbose)
     {
         std::cout << params.str(" ") << std::endl;
     }
@@ -235,7 +561,7 @@ int main(int argc, char* argv[])
     {
         std::cout << "SKIPPED: Problem size (" << raw_vram_footprint
                   << ") raw data too large for device.\n";
-        return EXIT_SUCCESS;
+        return false;
     }
 
     const auto vram_footprint = params.vram_footprint();
@@ -243,7 +569,7 @@ int main(int argc, char* argv[])
     {
         std::cout << "SKIPPED: Problem size (" << vram_footprint
                   << ") raw data too large for device.\n";
-        return EXIT_SUCCESS;
+        return false;
     }
 
     auto ret = params.create_plan();
@@ -273,7 +599,7 @@ int main(int argc, char* argv[])
         // Input data:
         params.compute_input(ibuffer);
 
-        if(verbose > 1)
+        if(opts.verbose > 1)
         {
             // Copy input to CPU
             ibuffer_cpu = allocate_host_buffer(params.precision, params.itype, params.isize);
@@ -297,7 +623,7 @@ int main(int argc, char* argv[])
         ibuffer_cpu = allocate_host_buffer(params.precision, params.itype, params.isize);
         params.compute_input(ibuffer_cpu);
 
-        if(verbose > 1)
+        if(opts.verbose > 1)
         {
             std::cout << "GPU input:\n";
             params.print_ibuffer(ibuffer_cpu);
@@ -338,15 +664,45 @@ int main(int argc, char* argv[])
     // Scatter input out to other devices and adjust I/O buffers to match requested transform
     params.multi_gpu_prepare(ibuffer, pibuffer, pobuffer);
 
+    if(opts.measure == "plan_create")
+    {
+        run_plan_create(params, pibuffer, pobuffer, opts.ntrial);
+        return true;
+    }
+
     // Execute a warm-up call
     params.execute(pibuffer.data(), pobuffer.data());
 
+    if(opts.nplans > 1 || opts.nstreams > 1 || opts.nthreads > 1)
+    {
+        if(!params.ifields.empty() || !params.ofields.empty())
+            throw std::runtime_error("throughput mode does not support multi-GPU transforms");
+        run_throughput(params, ibuffer, opts.nplans, opts.nstreams, opts.nthreads, opts.ntrial);
+        return true;
+    }
+
     // Run the transform several times and record the execution time:
-    std::vector<double> gpu_time(ntrial);
+    std::vector<double> gpu_time(opts.ntrial);
+    std::vector<double> energy;
 
     hipEvent_wrapper_t start, stop;
     start.alloc();
     stop.alloc();
+
+    gpubuf flush_buffer;
+    if(opts.flush_mib > 0)
+        HIP_V_THROW(flush_buffer.alloc(opts.flush_mib << 20),
+                    "Creating cache flush buffer failed");
+
+    std::unique_ptr<power_sampler> sampler;
+    if(opts.power)
+    {
+        sampler = std::make_unique<power_sampler>(opts.deviceId);
+        if(!sampler->valid())
+            throw std::runtime_error("GPU power draw is not readable for device "
+                                     + std::to_string(opts.deviceId));
+    }
+
     for(unsigned int itrial = 0; itrial < gpu_time.size(); ++itrial)
     {
         // Create input at every iteration to avoid overflow
@@ -374,19 +730,35 @@ int main(int argc, char* argv[])
             params.multi_gpu_prepare(ibuffer, pibuffer, pobuffer);
         }
 
+        // Generating input leaves it in cache, so flush after that
+        if(flush_buffer.data())
+            HIP_V_THROW(hipMemset(flush_buffer.data(), itrial & 0xff, flush_buffer.size()),
+                        "hipMemset failed");
+
+        // Make sure the power samples only cover this execution
+        if(sampler)
+            HIP_V_THROW(hipDeviceSynchronize(), "hipDeviceSynchronize failed");
+        const auto host_start = power_sampler::clock::now();
+
         HIP_V_THROW(hipEventRecord(start), "hipEventRecord failed");
 
         params.execute(pibuffer.data(), pobuffer.data());
 
         HIP_V_THROW(hipEventRecord(stop), "hipEventRecord failed");
         HIP_V_THROW(hipEventSynchronize(stop), "hipEventSynchronize failed");
+        const auto host_stop = power_sampler::clock::now();
 
         float time;
         HIP_V_THROW(hipEventElapsedTime(&time, start, stop), "hipEventElapsedTime failed");
         gpu_time[itrial] = time;
 
+        // Energy is the mean power while the transform ran, over its
+        // GPU time
+        if(sampler)
+            energy.push_back(sampler->average_watts(host_start, host_stop) * time / 1e3);
+
         // Print result after FFT transform
-        if(verbose > 2)
+        if(opts.verbose > 2)
         {
             // Gather data to default GPU if this is a multi-GPU test
             params.multi_gpu_finalize(*obuffer, pobuffer);
@@ -425,5 +797,349 @@ int main(int argc, char* argv[])
     }
     std::cout << std::endl;
 
-    rocfft_cleanup();
+    if(!energy.empty())
+    {
+        std::cout << "Execution energy:";
+        for(const auto& e : energy)
+            std::cout << " " << e;
+        std::cout << " J" << std::endl;
+
+        std::cout << "Transform energy:";
+        for(const auto& e : energy)
+            std::cout << " " << e / params.nbatch;
+        std::cout << " J" << std::endl;
+    }
+    return true;
+}
+
+// Time every problem listed in a batch file, or on stdin if the path
+// is "-", in this one process, so a suite pays for process startup,
+// library setup and opening the kernel cache only once.  Each line
+// is a token, or a rocfft-bench command line as written to the bench
+// log (the leading "rocfft-bench" may be left out).  Every problem
+// gets its own plan and buffers, and unused work buffer memory is
+// released before the next one starts.  Results are printed as one
+// block per problem, ending in a Status line.
+static int run_batch(const std::string&  path,
+                     const bench_options& opts,
+                     fft_input_generator  igen)
+{
+    std::ifstream file;
+    if(path != "-")
+    {
+        file.open(path);
+        if(!file)
+            throw std::runtime_error("unable to open batch file " + path);
+    }
+    std::istream& in = path == "-" ? std::cin : file;
+
+    size_t      nproblems = 0;
+    size_t      nskipped  = 0;
+    size_t      nfailed   = 0;
+    std::string line;
+    while(std::getline(in, line))
+    {
+        // ignore blank lines and comments
+        const auto first = line.find_first_not_of(" \t\r");
+        if(first == std::string::npos || line[first] == '#')
+            continue;
+        const auto problem = line.substr(first, line.find_last_not_of(" \t\r") + 1 - first);
+
+        std::cout << "\nProblem: " << nproblems++ << std::endl;
+        std::string status = "success";
+        try
+        {
+            rocfft_params params;
+            params.igen = igen;
+            if(problem.rfind("rocfft-bench", 0) == 0)
+                parse_bench_command(problem, params);
+            else if(problem.front() == '-')
+                parse_bench_command("rocfft-bench " + problem, params);
+            else
+                params.from_token(problem);
+            if(!run_problem(params, opts))
+            {
+                status = "skipped";
+                ++nskipped;
+            }
+        }
+        catch(const std::exception& e)
+        {
+            status = std::string("failed: ") + e.what();
+            ++nfailed;
+        }
+        catch(...)
+        {
+            status = "failed: unable to parse " + problem;
+            ++nfailed;
+        }
+
+        // don't let a failed problem's errors or memory carry over to
+        // the next one
+        (void)hipDeviceSynchronize();
+        (void)hipGetLastError();
+        rocfft_work_buffer_pool_trim();
+        std::cout << "Status: " << status << std::endl;
+    }
+
+    std::cout << "\nBatch: " << nproblems << " problems, " << nskipped << " skipped, " << nfailed
+              << " failed" << std::endl;
+    return nfailed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+int main(int argc, char* argv[])
+{
+    // This helps with mixing output of both wide and narrow characters to the screen
+    std::ios::sync_with_stdio(false);
+
+    // Options for timing each problem
+    bench_options opts;
+
+    // FFT parameters:
+    rocfft_params params;
+
+    // Token string to fully specify fft params.
+    std::string token;
+
+    // Trace to replay, as written by the library's replay log layer
+    std::string replay;
+
+    // File listing problems to time in one process, or "-" for stdin
+    std::string batch;
+
+    CLI::App app{"rocfft-bench command line options"};
+
+    // Declare the supported options. Some option pointers are declared to track passed opts.
+    app.add_flag("--version", "Print queryable version information from the rocfft library")
+        ->each([](const std::string&) {
+            char v[256];
+            rocfft_get_version_string(v, 256);
+            std::cout << "version " << v << std::endl;
+            std::exit(EXIT_SUCCESS);
+        });
+
+    CLI::Option* opt_token
+        = app.add_option("--token", token, "Token to read FFT params from")->default_val("");
+    // Group together options that conflict with --token
+    auto* non_token = app.add_option_group("Token Conflict", "Options excluded by --token");
+    non_token
+        ->add_flag("--double", "Double precision transform (deprecated: use --precision double)")
+        ->each([&](const std::string&) { params.precision = fft_precision_double; });
+    non_token->excludes(opt_token);
+    CLI::Option* opt_replay
+        = app.add_option("--replay",
+                         replay,
+                         "Replay file to play back: the plans and execution cadence recorded "
+                         "with ROCFFT_LAYER=512 and ROCFFT_LOG_REPLAY_PATH")
+              ->excludes(opt_token);
+    non_token->excludes(opt_replay);
+    CLI::Option* opt_batch
+        = app.add_option("--batch",
+                         batch,
+                         "File listing problems to time in one process, one token or set of "
+                         "transform options per line, or - to read them from stdin")
+              ->excludes(opt_token)
+              ->excludes(opt_replay);
+    non_token->excludes(opt_batch);
+    non_token
+        ->add_option("-t, --transformType",
+                     params.transform_type,
+                     "Type of transform:\n0) complex forward\n1) complex inverse\n2) real "
+                     "forward\n3) real inverse")
+        ->default_val(fft_transform_type_complex_forward);
+    non_token
+        ->add_option(
+            "--precision", params.precision, "Transform precision: single (default), double, half")
+        ->excludes("--double");
+    CLI::Option* opt_not_in_place
+        = non_token->add_flag("-o, --notInPlace", "Not in-place FFT transform (default: in-place)")
+              ->each([&](const std::string&) { params.placement = fft_placement_notinplace; });
+    non_token
+        ->add_option("--itype",
+                     params.itype,
+                     "Array type of input data:\n0) interleaved\n1) planar\n2) real\n3) "
+                     "hermitian interleaved\n4) hermitian planar")
+        ->default_val(fft_array_type_unset);
+    non_token
+        ->add_option("--otype",
+                     params.otype,
+                     "Array type of output data:\n0) interleaved\n1) planar\n2) real\n3) "
+                     "hermitian interleaved\n4) hermitian planar")
+        ->default_val(fft_array_type_unset);
+    CLI::Option* opt_length
+        = non_token->add_option("--length", params.length, "Lengths")->required()->expected(1, 3);
+    non_token
+        ->add_option("-b, --batchSize",
+                     params.nbatch,
+                     "If this value is greater than one, arrays will be used")
+        ->default_val(1);
+    CLI::Option* opt_istride = non_token->add_option("--istride", params.istride, "Input strides");
+    CLI::Option* opt_ostride = non_token->add_option("--ostride", params.ostride, "Output strides");
+    non_token->add_option("--idist", params.idist, "Logical distance between input batches")
+        ->default_val(0)
+        ->each([&](const std::string& val) { std::cout << "idist: " << val << "\n"; });
+    non_token->add_option("--odist", params.odist, "Logical distance between output batches")
+        ->default_val(0)
+        ->each([&](const std::string& val) { std::cout << "odist: " << val << "\n"; });
+    CLI::Option* opt_ioffset = non_token->add_option("--ioffset", params.ioffset, "Input offset");
+    CLI::Option* opt_ooffset = non_token->add_option("--ooffset", params.ooffset, "Output offset");
+
+    app.add_option("--device", opts.deviceId, "Select a specific device id")->default_val(0);
+    app.add_option("--verbose", opts.verbose, "Control output verbosity")->default_val(0);
+    app.add_option("-N, --ntrial", opts.ntrial, "Trial size for the problem")
+        ->default_val(1)
+        ->each([&](const std::string& val) {
+            std::cout << "Running profile with " << val << " samples\n";
+        });
+
+    app.add_option("-g, --inputGen",
+                   params.igen,
+                   "Input data generation:\n0) PRNG sequence (device)\n"
+                   "1) PRNG sequence (host)\n"
+                   "2) linearly-spaced sequence (device)\n"
+                   "3) linearly-spaced sequence (host)")
+        ->default_val(fft_input_random_generator_device);
+    app.add_option("--concurrent",
+                   opts.nplans,
+                   "Throughput mode: number of plans for the problem, executed concurrently")
+        ->default_val(1)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--streams", opts.nstreams, "Throughput mode: number of streams to run plans on")
+        ->default_val(1)
+        ->check(CLI::PositiveNumber);
+    app.add_option(
+           "--threads", opts.nthreads, "Throughput mode: number of host threads launching plans")
+        ->default_val(1)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--flushCache",
+                   opts.flush_mib,
+                   "Size in MiB of a scratch buffer written between trials, to time the "
+                   "transform with cold L2 and Infinity Cache (default: 0, caches stay warm)")
+        ->default_val(0);
+    app.add_flag("--power",
+                 opts.power,
+                 "Sample the GPU's power draw during each trial and report the energy used, "
+                 "in joules per execution and per transform");
+    app.add_option("--measure",
+                   opts.measure,
+                   "What to time: execution, or plan_create (setup, plan creation and first "
+                   "execution, with empty, warm sqlite, AOT-only and in-memory kernel caches)")
+        ->default_val("execution")
+        ->check(CLI::IsMember({"execution", "plan_create"}));
+    app.add_option("--isize", params.isize, "Logical size of input buffer");
+    app.add_option("--osize", params.osize, "Logical size of output buffer");
+    app.add_option("--scalefactor", params.scale_factor, "Scale factor to apply to output");
+
+    // Parse args and catch any errors here
+    try
+    {
+        app.parse(argc, argv);
+    }
+    catch(const CLI::ParseError& e)
+    {
+        return app.exit(e);
+    }
+
+    if(!replay.empty())
+    {
+        rocfft_setup();
+        {
+            rocfft_scoped_device dev(opts.deviceId);
+            run_replay(replay, opts.verbose);
+        }
+        rocfft_cleanup();
+        return EXIT_SUCCESS;
+    }
+
+    if(!batch.empty())
+    {
+        // plan creation timing tears the library down between states
+        if(opts.measure != "execution")
+            throw std::runtime_error("--batch only supports --measure execution");
+        rocfft_setup();
+        int ret;
+        {
+            rocfft_scoped_device dev(opts.deviceId);
+            ret = run_batch(batch, opts, params.igen);
+        }
+        rocfft_cleanup();
+        return ret;
+    }
+
+    if(!token.empty())
+    {
+        std::cout << "Reading fft params from token:\n" << token << std::endl;
+
+        try
+        {
+            params.from_token(token);
+        }
+        catch(...)
+        {
+            std::cout << "Unable to parse token." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        if(*opt_not_in_place)
+        {
+            std::cout << "out-of-place\n";
+        }
+        else
+        {
+            std::cout << "in-place\n";
+        }
+
+        if(*opt_length)
+        {
+            std::cout << "length:";
+            for(auto& i : params.length)
+                std::cout << " " << i;
+            std::cout << "\n";
+        }
+
+        if(*opt_istride)
+        {
+            std::cout << "istride:";
+            for(auto& i : params.istride)
+                std::cout << " " << i;
+            std::cout << "\n";
+        }
+        if(*opt_ostride)
+        {
+            std::cout << "ostride:";
+            for(auto& i : params.ostride)
+                std::cout << " " << i;
+            std::cout << "\n";
+        }
+
+        if(*opt_ioffset)
+        {
+            std::cout << "ioffset:";
+            for(auto& i : params.ioffset)
+                std::cout << " " << i;
+            std::cout << "\n";
+        }
+        if(*opt_ooffset)
+        {
+            std::cout << "ooffset:";
+            for(auto& i : params.ooffset)
+                std::cout << " " << i;
+            std::cout << "\n";
+        }
+    }
+
+    std::cout << std::flush;
+
+    rocfft_setup();
+
+    // Set GPU for single-device FFT computation
+    rocfft_scoped_device dev(opts.deviceId);
+
+    run_problem(params, opts);
+
+    // timing plan creation leaves the library cleaned up
+    if(opts.measure != "plan_create")
+        rocfft_cleanup();
 }
@@ -23,6 +23,12 @@
 // which produces fewer type 1 errors where one incorrectly rejects the null hypothesis.
 
 #include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
 
 #if __has_include(<filesystem>)
 #include <filesystem>
@@ -51,6 +57,7 @@ namespace std
 #include "../../shared/CLI11.hpp"
 #include "../../shared/gpubuf.h"
 #include "../../shared/hip_object_wrapper.h"
+#include "../../shared/power_sampler.h"
 #include "../../shared/rocfft_params.h"
 #include "bench.h"
 #include "rocfft/rocfft.h"
@@ -275,6 +282,307 @@ std::pair<ROCFFT_LIB, rocfft_plan> create_handleplan(const std::string& libstrin
     return std::make_pair(libhandle, plan);
 }
 
+// GPU state read alongside each timing sample from the amdgpu
+// driver's sysfs files.  Fields are 0 where that information is not
+// available.
+struct gpu_telemetry
+{
+    int    sclk_mhz     = 0;
+    int    max_sclk_mhz = 0;
+    double temp_c       = 0.0;
+};
+
+gpu_telemetry read_gpu_telemetry(const std::string& dir)
+{
+    gpu_telemetry gpu;
+    if(dir.empty())
+        return gpu;
+
+    // pp_dpm_sclk lists the shader clock levels, like "1: 800Mhz *",
+    // with the current level marked
+    std::ifstream sclk(dir + "/pp_dpm_sclk");
+    std::string   line;
+    while(std::getline(sclk, line))
+    {
+        auto colon = line.find(':');
+        if(colon == std::string::npos)
+            continue;
+        int mhz          = std::atoi(line.c_str() + colon + 1);
+        gpu.max_sclk_mhz = std::max(gpu.max_sclk_mhz, mhz);
+        if(line.find('*') != std::string::npos)
+            gpu.sclk_mhz = mhz;
+    }
+
+    // prefer the junction (hotspot) temperature if the driver has it
+    std::error_code ec;
+    for(const auto& hwmon : std::filesystem::directory_iterator(dir + "/hwmon", ec))
+    {
+        for(const char* sensor : {"temp2_input", "temp1_input"})
+        {
+            std::ifstream temp(hwmon.path() / sensor);
+            long          millidegrees = 0;
+            if(temp >> millidegrees)
+            {
+                gpu.temp_c = millidegrees / 1000.0;
+                return gpu;
+            }
+        }
+    }
+    return gpu;
+}
+
+// Samples taken while the GPU was throttled, or hotter than asked
+// for, are discarded.  A limit of 0 disables that check.
+struct throttle_limits
+{
+    int    min_clock_pct = 0;
+    double max_temp_c    = 0.0;
+
+    bool throttled(const gpu_telemetry& gpu) const
+    {
+        if(min_clock_pct > 0 && gpu.max_sclk_mhz > 0
+           && gpu.sclk_mhz * 100 < min_clock_pct * gpu.max_sclk_mhz)
+            return true;
+        return max_temp_c > 0 && gpu.temp_c > max_temp_c;
+    }
+};
+
+// Pin the GPU's clocks to their peak for the lifetime of this
+// object, by forcing the driver's performance level.  This needs
+// write access to sysfs, so failures only produce a warning.
+struct gpu_clock_pin
+{
+    explicit gpu_clock_pin(const std::string& dir)
+    {
+        if(dir.empty())
+        {
+            std::cerr << "Warning: unable to find the GPU's sysfs directory to pin clocks\n";
+            return;
+        }
+        path = dir + "/power_dpm_force_performance_level";
+        std::ifstream in(path);
+        std::getline(in, old_level);
+        std::ofstream out(path);
+        if(!(out << "profile_peak" << std::flush))
+        {
+            std::cerr << "Warning: unable to pin clocks through " << path << "\n";
+            path.clear();
+        }
+    }
+    ~gpu_clock_pin()
+    {
+        if(!path.empty() && !old_level.empty())
+            std::ofstream(path) << old_level;
+    }
+    gpu_clock_pin(const gpu_clock_pin&) = delete;
+    gpu_clock_pin& operator=(const gpu_clock_pin&) = delete;
+
+    std::string path;
+    std::string old_level;
+};
+
+// Fill in the order to run test cases in, for ntrial trials of each
+// of ncase cases.
+std::vector<size_t> make_schedule(int test_sequence, size_t ncase, int ntrial)
+{
+    std::vector<size_t> schedule(ncase * ntrial);
+    for(int itrial = 0; itrial < ntrial; ++itrial)
+    {
+        for(size_t icase = 0; icase < ncase; ++icase)
+        {
+            if(test_sequence == 2)
+                schedule[icase * ntrial + itrial] = icase;
+            else
+                schedule[ncase * itrial + icase] = icase;
+        }
+    }
+    switch(test_sequence)
+    {
+    case 0:
+    {
+        std::random_device rd;
+        std::mt19937       g(rd());
+        std::shuffle(schedule.begin(), schedule.end(), g);
+        break;
+    }
+    case 1:
+    case 2:
+        break;
+    default:
+        throw std::runtime_error("Invalid test sequence choice.");
+    }
+    return schedule;
+}
+
+// Benchmark every problem in a token file with every library, with
+// all (problem, library) trials interleaved in one schedule so that
+// drift in the GPU's state over the run is spread across all of
+// them.  Each library's times are written as a perflib .dat file in
+// its output directory, along with a .telemetry file recording the
+// clock and temperature of each sample.
+int run_token_file(const std::string&              token_file,
+                   const std::vector<std::string>& lib_strings,
+                   std::vector<std::string>        out_dirs,
+                   int                             test_sequence,
+                   int                             ntrial,
+                   const std::string&              sysfs_dir,
+                   const throttle_limits&          limits,
+                   int                             verbose)
+{
+    std::vector<fft_params> problems;
+    std::ifstream           in(token_file);
+    if(!in)
+        throw std::runtime_error("unable to open token file " + token_file);
+    std::string line;
+    while(std::getline(in, line))
+    {
+        if(line.empty() || line[0] == '#')
+            continue;
+        problems.emplace_back();
+        problems.back().from_token(line);
+        problems.back().validate();
+        if(!problems.back().valid(verbose))
+            throw std::runtime_error("Invalid parameters for token " + line);
+    }
+
+    for(size_t ilib = out_dirs.size(); ilib < lib_strings.size(); ++ilib)
+        out_dirs.push_back("out" + std::to_string(ilib));
+
+    // buffers are shared by all libraries running a problem
+    struct problem_buffers
+    {
+        std::vector<gpubuf> ibuffer;
+        std::vector<gpubuf> obuffer;
+        std::vector<void*>  pibuffer;
+        std::vector<void*>  pobuffer;
+    };
+    std::vector<problem_buffers> buffers(problems.size());
+    for(size_t iprob = 0; iprob < problems.size(); ++iprob)
+    {
+        auto& params = problems[iprob];
+        auto& buf    = buffers[iprob];
+        for(auto size : params.ibuffer_sizes())
+        {
+            buf.ibuffer.emplace_back();
+            HIP_V_THROW(buf.ibuffer.back().alloc(size), "Creating input Buffer failed");
+            buf.pibuffer.push_back(buf.ibuffer.back().data());
+        }
+        if(params.placement == fft_placement_inplace)
+            buf.pobuffer = buf.pibuffer;
+        else
+        {
+            for(auto size : params.obuffer_sizes())
+            {
+                buf.obuffer.emplace_back();
+                HIP_V_THROW(buf.obuffer.back().alloc(size), "Creating output Buffer failed");
+                buf.pobuffer.push_back(buf.obuffer.back().data());
+            }
+        }
+    }
+
+    // a test case is one (problem, library) pair
+    struct test_case
+    {
+        size_t                problem;
+        size_t                lib;
+        rocfft_plan           plan = nullptr;
+        rocfft_execution_info info = nullptr;
+        gpubuf                wbuffer;
+        std::vector<double>   times;
+        size_t                discarded = 0;
+
+        // every sample, kept or not, with the GPU state after it
+        std::vector<std::pair<gpu_telemetry, double>> samples;
+    };
+    std::vector<ROCFFT_LIB> handle;
+    for(const auto& lib_string : lib_strings)
+    {
+        auto libhandle = rocfft_lib_load(lib_string);
+        if(libhandle == NULL)
+        {
+            std::cout << "Failed to open " << lib_string << ", error: " << rocfft_lib_load_error()
+                      << "\n";
+            return 1;
+        }
+        handle.push_back(libhandle);
+    }
+    std::vector<test_case> cases(problems.size() * lib_strings.size());
+    for(size_t icase = 0; icase < cases.size(); ++icase)
+    {
+        auto& tc   = cases[icase];
+        tc.problem = icase / lib_strings.size();
+        tc.lib     = icase % lib_strings.size();
+        tc.plan    = make_plan(handle[tc.lib], problems[tc.problem]);
+        tc.info    = make_execinfo(handle[tc.lib]);
+        auto wsize = get_wbuffersize(handle[tc.lib], tc.plan);
+        if(wsize)
+            HIP_V_THROW(tc.wbuffer.alloc(wsize), "Creating intermediate Buffer failed");
+        set_work_buffer(handle[tc.lib], tc.info, wsize, tc.wbuffer.data());
+
+        // warm up
+        auto& buf = buffers[tc.problem];
+        problems[tc.problem].compute_input(buf.ibuffer);
+        run_plan(handle[tc.lib], tc.plan, tc.info, buf.pibuffer.data(), buf.pobuffer.data());
+    }
+
+    auto schedule = make_schedule(test_sequence, cases.size(), ntrial);
+    std::cout << "Running " << schedule.size() << " samples of " << problems.size()
+              << " problems with " << lib_strings.size() << " libraries...\n";
+    for(auto icase : schedule)
+    {
+        auto& tc  = cases[icase];
+        auto& buf = buffers[tc.problem];
+        problems[tc.problem].compute_input(buf.ibuffer);
+        auto ms
+            = run_plan(handle[tc.lib], tc.plan, tc.info, buf.pibuffer.data(), buf.pobuffer.data());
+        auto gpu = read_gpu_telemetry(sysfs_dir);
+        tc.samples.emplace_back(gpu, ms);
+        if(limits.throttled(gpu))
+            ++tc.discarded;
+        else
+            tc.times.push_back(ms);
+    }
+
+    const auto stem = std::filesystem::path(token_file).stem().string();
+    for(size_t ilib = 0; ilib < lib_strings.size(); ++ilib)
+    {
+        std::filesystem::create_directories(out_dirs[ilib]);
+        const auto    base = std::filesystem::path(out_dirs[ilib]) / stem;
+        std::ofstream dat(base.string() + ".dat");
+        std::ofstream telemetry(base.string() + ".telemetry");
+        dat << "# title: " << stem << "\n";
+        dat << "# lib: " << lib_strings[ilib] << "\n";
+        telemetry << "token\ttime_ms\tsclk_mhz\tmax_sclk_mhz\ttemp_c\tdiscarded\n";
+        for(const auto& tc : cases)
+        {
+            if(tc.lib != ilib)
+                continue;
+            const auto token = problems[tc.problem].token();
+            dat << token << "\t" << tc.times.size();
+            for(auto t : tc.times)
+                dat << "\t" << t;
+            dat << "\n";
+            for(const auto& [gpu, ms] : tc.samples)
+                telemetry << token << "\t" << ms << "\t" << gpu.sclk_mhz << "\t"
+                          << gpu.max_sclk_mhz << "\t" << gpu.temp_c << "\t"
+                          << limits.throttled(gpu) << "\n";
+            if(tc.discarded)
+                std::cout << lib_strings[ilib] << ": " << token << ": discarded " << tc.discarded
+                          << " throttled samples\n";
+        }
+        std::cout << "Wrote " << base.string() << ".dat\n";
+    }
+
+    for(auto& tc : cases)
+    {
+        destroy_info(handle[tc.lib], tc.info);
+        destroy_plan(handle[tc.lib], tc.plan);
+    }
+    for(auto libhandle : handle)
+        rocfft_lib_close(libhandle);
+    return EXIT_SUCCESS;
+}
+
 int main(int argc, char* argv[])
 {
     // Control output verbosity:
@@ -301,6 +609,14 @@ int main(int argc, char* argv[])
     // Token string to fully specify fft params.
     std::string token;
 
+    // File with a list of tokens to benchmark together, and the
+    // output directory for each library's results
+    std::string              token_file;
+    std::vector<std::string> out_dirs;
+
+    // Limits on the GPU's state for a sample to be kept
+    throttle_limits limits;
+
     CLI::App app{"dyna-rocfft-bench command line options"};
 
     // Declare the supported options. Some option pointers are declared to track passed opts.
@@ -320,6 +636,31 @@ int main(int argc, char* argv[])
         ->add_flag("--double", "Double precision transform (deprecated: use --precision double)")
         ->each([&](const std::string&) { params.precision = fft_precision_double; });
     non_token->excludes(opt_token);
+    CLI::Option* opt_token_file
+        = app.add_option("--tokenFile",
+                         token_file,
+                         "File of tokens (one per line) to benchmark with all libraries, in one "
+                         "interleaved schedule")
+              ->excludes(opt_token);
+    non_token->excludes(opt_token_file);
+    app.add_option("--out",
+                   out_dirs,
+                   "With --tokenFile, output directory for each library's .dat file "
+                   "(appendable, default: out0, out1, ...)");
+    app.add_option("--minClock",
+                   limits.min_clock_pct,
+                   "Discard samples taken with the shader clock below this percentage of its "
+                   "maximum (default: 0, keep all)")
+        ->default_val(0);
+    app.add_option("--maxTemp",
+                   limits.max_temp_c,
+                   "Discard samples taken with the GPU hotter than this, in degrees C "
+                   "(default: 0, keep all)")
+        ->default_val(0);
+    auto* opt_pin_clock = app.add_flag(
+        "--pinClock", "Pin GPU clocks to their peak while benchmarking (needs sysfs write access)");
+    auto* opt_power = app.add_flag(
+        "--power", "Sample the GPU's power draw during each trial and report the energy used");
     non_token
         ->add_option("-t, --transformType",
                      params.transform_type,
@@ -417,7 +758,7 @@ int main(int argc, char* argv[])
             return 1;
         }
     }
-    else
+    else if(token_file.empty())
     {
         if(*opt_not_in_place)
         {
@@ -471,6 +812,15 @@ int main(int argc, char* argv[])
     // Set GPU for single-device FFT computation
     rocfft_scoped_device dev(deviceId);
 
+    const auto                   sysfs_dir = gpu_sysfs_dir(deviceId);
+    std::optional<gpu_clock_pin> clock_pin;
+    if(*opt_pin_clock)
+        clock_pin.emplace(sysfs_dir);
+
+    if(!token_file.empty())
+        return run_token_file(
+            token_file, lib_strings, out_dirs, test_sequence, ntrial, sysfs_dir, limits, verbose);
+
     params.validate();
 
     if(!params.valid(verbose))
@@ -593,6 +943,18 @@ int main(int argc, char* argv[])
 
     // Execution times for loaded libraries:
     std::vector<std::vector<double>> time(lib_strings.size());
+    // Energy in joules of each kept sample, if power is sampled:
+    std::vector<std::vector<double>> energy(lib_strings.size());
+    std::unique_ptr<power_sampler>   sampler;
+    if(*opt_power)
+    {
+        sampler = std::make_unique<power_sampler>(deviceId);
+        if(!sampler->valid())
+            throw std::runtime_error("GPU power draw is not readable for device "
+                                     + std::to_string(deviceId));
+    }
+    // Samples dropped because the GPU was throttled:
+    size_t discarded = 0;
 
     // If we are doing a reverse-run, then we need two ntrials; otherwise, just one.
     std::vector<int> ntrial_runs;
@@ -740,9 +1102,24 @@ int main(int argc, char* argv[])
                 }
             }
 
+            // Make sure the power samples only cover this execution
+            if(sampler)
+                HIP_V_THROW(hipDeviceSynchronize(), "hipDeviceSynchronize failed");
+            const auto host_start = power_sampler::clock::now();
+
             // Run the plan using its associated rocFFT library:
-            time[tidx].push_back(
-                run_plan(handle[tidx], plan[tidx], info[tidx], pibuffer.data(), pobuffer.data()));
+            auto ms
+                = run_plan(handle[tidx], plan[tidx], info[tidx], pibuffer.data(), pobuffer.data());
+            const auto host_stop = power_sampler::clock::now();
+            if(limits.throttled(read_gpu_telemetry(sysfs_dir)))
+                ++discarded;
+            else
+            {
+                time[tidx].push_back(ms);
+                if(sampler)
+                    energy[tidx].push_back(sampler->average_watts(host_start, host_stop) * ms
+                                           / 1e3);
+            }
 
             if(verbose > 2)
             {
@@ -769,6 +1146,8 @@ int main(int argc, char* argv[])
         }
     }
 
+    if(discarded)
+        std::cout << "Discarded " << discarded << " throttled samples\n";
     std::cout << "Execution times in ms:\n";
     for(unsigned int idx = 0; idx < time.size(); ++idx)
     {
@@ -778,6 +1157,13 @@ int main(int argc, char* argv[])
             std::cout << " " << i;
         }
         std::cout << " ms" << std::endl;
+        if(sampler)
+        {
+            std::cout << "Execution energy:";
+            for(auto& e : energy[idx])
+                std::cout << " " << e;
+            std::cout << " J" << std::endl;
+        }
     }
 
     return EXIT_SUCCESS;
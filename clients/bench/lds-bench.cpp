@@ -0,0 +1,223 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Microbenchmark for the LDS bank shifts that 1D Stockham kernels
+// can be tuned to use.  Each kernel moves rows of complex elements
+// through LDS with the same strided write and linear read pattern as
+// the passes of a radix-4 Stockham kernel, padding LDS with one
+// element every SHIFT elements (or not at all for SHIFT 0).
+//
+// The program reports the time of each shift.  The bank conflicts
+// behind those times come from hardware counters: run it under
+// rocprof, e.g.
+//
+//   rocprofv3 --pmc SQ_LDS_BANK_CONFLICT SQ_LDS_IDX_ACTIVE -- rocfft-lds-bench
+//
+// Every combination is its own kernel instantiation, so the counters
+// for each one are reported under a separate kernel name.
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../shared/CLI11.hpp"
+#include "../../shared/gpubuf.h"
+#include "../../shared/hip_object_wrapper.h"
+#include <hip/hip_runtime.h>
+
+static const unsigned int LDS_BENCH_THREADS = 256;
+static const unsigned int LDS_BENCH_RADIX   = 4;
+
+template <unsigned int SHIFT>
+__device__ inline unsigned int lds_bench_index(unsigned int i)
+{
+    return SHIFT ? i + i / SHIFT : i;
+}
+
+template <typename T, unsigned int LENGTH, unsigned int SHIFT>
+__global__ static void __launch_bounds__(LDS_BENCH_THREADS)
+    lds_bench_kernel(T* out, const unsigned int iterations)
+{
+    constexpr unsigned int tpt  = LENGTH / LDS_BENCH_RADIX;
+    constexpr unsigned int rows = LDS_BENCH_THREADS / tpt;
+    constexpr unsigned int used = rows * LENGTH;
+    __shared__ T           lds[used + (SHIFT ? used / SHIFT : 0)];
+
+    const unsigned int row = threadIdx.x / tpt;
+    const unsigned int tid = threadIdx.x % tpt;
+
+    T r[LDS_BENCH_RADIX];
+    for(unsigned int w = 0; w < LDS_BENCH_RADIX; ++w)
+    {
+        r[w].x = threadIdx.x;
+        r[w].y = w;
+    }
+
+    for(unsigned int i = 0; i < iterations; ++i)
+    {
+        for(unsigned int cumheight = 1; cumheight < LENGTH; cumheight *= LDS_BENCH_RADIX)
+        {
+            // Stockham store: butterfly outputs are cumheight apart
+            for(unsigned int w = 0; w < LDS_BENCH_RADIX; ++w)
+            {
+                auto idx = row * LENGTH + (tid / cumheight) * (LDS_BENCH_RADIX * cumheight)
+                           + tid % cumheight + w * cumheight;
+                lds[lds_bench_index<SHIFT>(idx)] = r[w];
+            }
+            __syncthreads();
+            // next pass' load: butterfly inputs are tpt apart
+            for(unsigned int w = 0; w < LDS_BENCH_RADIX; ++w)
+            {
+                auto idx = row * LENGTH + tid + w * tpt;
+                r[w]     = lds[lds_bench_index<SHIFT>(idx)];
+            }
+            __syncthreads();
+        }
+    }
+
+    T sum = r[0];
+    for(unsigned int w = 1; w < LDS_BENCH_RADIX; ++w)
+    {
+        sum.x += r[w].x;
+        sum.y += r[w].y;
+    }
+    out[blockIdx.x * blockDim.x + threadIdx.x] = sum;
+}
+
+// time one kernel, returning milliseconds per launch
+template <typename T, unsigned int LENGTH, unsigned int SHIFT>
+static float time_lds_kernel(T* out, unsigned int blocks, unsigned int iterations, int ntrial)
+{
+    hipEvent_wrapper_t start, stop;
+    start.alloc();
+    stop.alloc();
+
+    // warm up
+    hipLaunchKernelGGL(HIP_KERNEL_NAME(lds_bench_kernel<T, LENGTH, SHIFT>),
+                       blocks,
+                       LDS_BENCH_THREADS,
+                       0,
+                       0,
+                       out,
+                       iterations);
+
+    if(hipEventRecord(start) != hipSuccess)
+        throw std::runtime_error("hipEventRecord failed");
+    for(int i = 0; i < ntrial; ++i)
+        hipLaunchKernelGGL(HIP_KERNEL_NAME(lds_bench_kernel<T, LENGTH, SHIFT>),
+                           blocks,
+                           LDS_BENCH_THREADS,
+                           0,
+                           0,
+                           out,
+                           iterations);
+    if(hipEventRecord(stop) != hipSuccess || hipEventSynchronize(stop) != hipSuccess)
+        throw std::runtime_error("kernel timing failed");
+
+    float ms = 0.0f;
+    if(hipEventElapsedTime(&ms, start, stop) != hipSuccess)
+        throw std::runtime_error("hipEventElapsedTime failed");
+    return ms / ntrial;
+}
+
+template <typename T, unsigned int LENGTH>
+static void run_lds_length(const std::string& precision,
+                           T*                 out,
+                           unsigned int       blocks,
+                           unsigned int       iterations,
+                           int                ntrial)
+{
+    const std::vector<std::pair<unsigned int, float>> results = {
+        {0, time_lds_kernel<T, LENGTH, 0>(out, blocks, iterations, ntrial)},
+        {16, time_lds_kernel<T, LENGTH, 16>(out, blocks, iterations, ntrial)},
+        {32, time_lds_kernel<T, LENGTH, 32>(out, blocks, iterations, ntrial)},
+        {64, time_lds_kernel<T, LENGTH, 64>(out, blocks, iterations, ntrial)},
+    };
+    for(const auto& r : results)
+        std::cout << std::setw(8) << precision << std::setw(8) << LENGTH << std::setw(8)
+                  << r.first << std::setw(14) << std::fixed << std::setprecision(4) << r.second
+                  << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int          deviceId   = 0;
+    unsigned int blocks     = 4096;
+    unsigned int iterations = 64;
+    int          ntrial     = 10;
+
+    CLI::App app{"rocFFT LDS bank shift microbenchmark"};
+    app.add_option("--device", deviceId, "Select a specific device id")->default_val(0);
+    app.add_option("--blocks", blocks, "Thread blocks per launch")->default_val(4096);
+    app.add_option("--iterations", iterations, "Passes through LDS per launch")
+        ->default_val(64);
+    app.add_option("-N, --ntrial", ntrial, "Trial size for the problem")->default_val(10);
+    try
+    {
+        app.parse(argc, argv);
+    }
+    catch(const CLI::ParseError& e)
+    {
+        return app.exit(e);
+    }
+
+    if(hipSetDevice(deviceId) != hipSuccess)
+    {
+        std::cerr << "hipSetDevice failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    hipDeviceProp_t props;
+    if(hipGetDeviceProperties(&props, deviceId) != hipSuccess)
+    {
+        std::cerr << "hipGetDeviceProperties failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "device " << deviceId << ": " << props.gcnArchName << std::endl;
+
+    gpubuf out;
+    if(out.alloc(static_cast<size_t>(blocks) * LDS_BENCH_THREADS * sizeof(double2))
+       != hipSuccess)
+    {
+        std::cerr << "device allocation failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::cout << std::setw(8) << "prec" << std::setw(8) << "length" << std::setw(8)
+                  << "shift" << std::setw(14) << "ms/launch" << std::endl;
+        auto out_single = static_cast<float2*>(out.data());
+        auto out_double = static_cast<double2*>(out.data());
+        run_lds_length<float2, 64>("single", out_single, blocks, iterations, ntrial);
+        run_lds_length<float2, 256>("single", out_single, blocks, iterations, ntrial);
+        run_lds_length<double2, 64>("double", out_double, blocks, iterations, ntrial);
+        run_lds_length<double2, 256>("double", out_double, blocks, iterations, ntrial);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -48,9 +48,20 @@ std::vector<std::vector<size_t>> adhoc_sizes = {
     {196597},
     {25165813},
 
-    // 2D single-kernel bluestein size combined with multi-kernel bluestein
+    // 2D single-kernel bluestein size combined with multi-kernel
+    // bluestein (single-kernel for both in single precision)
     {19, 2053},
 
+    // medium primes whose pow2 padded length of 8192 only fits in
+    // LDS as a single-kernel bluestein in single precision
+    {3001},
+    {4093, 8},
+
+    // Rader primes, where p-1 factors into supported lengths
+    {12289},
+    {40961},
+    {7681, 64},
+
     // TILE_UNALIGNED type of SBRC 3D ERC
     {98, 98, 98},
 
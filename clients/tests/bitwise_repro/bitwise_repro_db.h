@@ -28,6 +28,7 @@
 #include <hip/hip_runtime_api.h>
 #include <iostream>
 #include <string>
+#include <unordered_map>
 
 #if __has_include(<filesystem>)
 #include <filesystem>
@@ -65,24 +66,35 @@ struct rocfft_test_run
 
     static std::string get_create_rocfft_test_run_sql()
     {
-        return "CREATE TABLE IF NOT EXISTS rocfft_test_run(ibuffer_hash_real TEXT NOT NULL, "
-               "ibuffer_hash_imag TEXT NOT NULL, obuffer_hash_real TEXT NOT NULL, "
+        // hashes are computed on the device, and are not comparable
+        // with the host hashes stored in the older rocfft_test_run
+        // table
+        return "CREATE TABLE IF NOT EXISTS rocfft_test_run_device(ibuffer_hash_real TEXT NOT "
+               "NULL, ibuffer_hash_imag TEXT NOT NULL, obuffer_hash_real TEXT NOT NULL, "
                "obuffer_hash_imag TEXT NOT NULL, token TEXT NOT NULL, runtime_version TEXT NOT "
                "NULL, lib_version TEXT NOT NULL, gpu_architecture TEXT NOT NULL); CREATE UNIQUE "
-               "INDEX IF NOT EXISTS idx_unique_run ON rocfft_test_run(token, runtime_version, "
-               "lib_version, gpu_architecture);";
+               "INDEX IF NOT EXISTS idx_unique_run_device ON rocfft_test_run_device(token, "
+               "runtime_version, lib_version, gpu_architecture);";
     }
 
     static std::string get_match_sql()
     {
         return "SELECT ibuffer_hash_real, ibuffer_hash_imag, obuffer_hash_real, obuffer_hash_imag, "
-               "token, runtime_version, lib_version, gpu_architecture FROM rocfft_test_run WHERE "
-               "token = ? AND runtime_version = ? AND lib_version = ? AND gpu_architecture = ? ";
+               "token, runtime_version, lib_version, gpu_architecture FROM rocfft_test_run_device "
+               "WHERE token = ? AND runtime_version = ? AND lib_version = ? AND "
+               "gpu_architecture = ? ";
+    }
+
+    static std::string get_prefetch_sql()
+    {
+        return "SELECT ibuffer_hash_real, ibuffer_hash_imag, obuffer_hash_real, obuffer_hash_imag, "
+               "token, runtime_version, lib_version, gpu_architecture FROM rocfft_test_run_device "
+               "WHERE runtime_version = ? AND lib_version = ? AND gpu_architecture = ? ";
     }
 
     static std::string get_insert_sql()
     {
-        return "INSERT INTO rocfft_test_run(ibuffer_hash_real, ibuffer_hash_imag, "
+        return "INSERT INTO rocfft_test_run_device(ibuffer_hash_real, ibuffer_hash_imag, "
                "obuffer_hash_real, obuffer_hash_imag, token, runtime_version, lib_version, "
                "gpu_architecture) VALUES (?,?,?,?,?,?,?,?)";
     }
@@ -107,6 +119,13 @@ struct rocfft_test_run
         bind_gpu_architecture(stmt, 4);
     }
 
+    void bind_prefetch_statement(sqlite3_stmt* stmt)
+    {
+        bind_runtime_version(stmt, 1);
+        bind_lib_version(stmt, 2);
+        bind_gpu_architecture(stmt, 3);
+    }
+
     void update(sqlite3_stmt* stmt)
     {
         for(int col = 0; col < sqlite3_column_count(stmt); ++col)
@@ -146,6 +165,11 @@ struct rocfft_test_run
     Tint obuffer_hash_real;
     Tint obuffer_hash_imag;
 
+    std::string get_token() const
+    {
+        return token;
+    }
+
 private:
     std::string token;
     std::string runtime_version;
@@ -172,11 +196,6 @@ private:
         return std::to_string(obuffer_hash_imag);
     }
 
-    std::string get_token() const
-    {
-        return token;
-    }
-
     std::string get_runtime_version() const
     {
         return runtime_version;
@@ -306,44 +325,65 @@ private:
     }
 };
 
-template <typename Tint>
-inline rocfft_test_run<Tint> get_rocfft_test_run(const hash_output<Tint>& ibuffer_hash,
-                                                 const hash_output<Tint>& obuffer_hash,
-                                                 const std::string&       token)
+// runtime version, library version and GPU architecture that test
+// runs are recorded against
+struct rocfft_test_run_env
+{
+    std::string runtime_ver;
+    std::string lib_ver;
+    std::string gpu_arch;
+};
+
+// The environment does not change during a test run, so query it
+// once rather than for every hash check.
+inline const rocfft_test_run_env& get_rocfft_test_run_env()
 {
-    hipDeviceProp_t device_prop;
+    static const rocfft_test_run_env env = []() {
+        hipDeviceProp_t device_prop;
+
+        if(hipGetDeviceProperties(&device_prop, 0) != hipSuccess)
+            throw std::runtime_error("hipGetDeviceProperties failure");
 
-    if(hipGetDeviceProperties(&device_prop, 0) != hipSuccess)
-        throw std::runtime_error("hipGetDeviceProperties failure");
+        auto gpu_arch = std::string(device_prop.gcnArchName);
 
-    auto gpu_arch = std::string(device_prop.gcnArchName);
+        auto ver_sep = std::string(".");
+        auto runtime_ver
+            = std::to_string(HIP_VERSION_MAJOR) + ver_sep + std::to_string(HIP_VERSION_MINOR);
 
-    auto ver_sep = std::string(".");
-    auto runtime_ver
-        = std::to_string(HIP_VERSION_MAJOR) + ver_sep + std::to_string(HIP_VERSION_MINOR);
+        const size_t ver_size = 256;
+        char         lib_version[ver_size];
+        rocfft_get_version_string(lib_version, ver_size);
+        auto lib_ver_full = std::string(lib_version);
 
-    const size_t ver_size = 256;
-    char         lib_version[ver_size];
-    rocfft_get_version_string(lib_version, ver_size);
-    auto lib_ver_full = std::string(lib_version);
+        auto idx_maj = lib_ver_full.find(ver_sep);
+        auto idx_min = lib_ver_full.find(ver_sep, idx_maj + 1);
+        auto idx_rev = lib_ver_full.find(ver_sep, idx_min + 1);
+        auto ver_maj = lib_ver_full.substr(0, idx_maj);
+        auto ver_min = lib_ver_full.substr(idx_maj + 1, idx_min - idx_maj - 1);
+        auto ver_rev = lib_ver_full.substr(idx_min + 1, idx_rev - idx_min - 1);
 
-    auto idx_maj = lib_ver_full.find(ver_sep);
-    auto idx_min = lib_ver_full.find(ver_sep, idx_maj + 1);
-    auto idx_rev = lib_ver_full.find(ver_sep, idx_min + 1);
-    auto ver_maj = lib_ver_full.substr(0, idx_maj);
-    auto ver_min = lib_ver_full.substr(idx_maj + 1, idx_min - idx_maj - 1);
-    auto ver_rev = lib_ver_full.substr(idx_min + 1, idx_rev - idx_min - 1);
+        auto lib_ver = ver_maj + ver_sep + ver_min + ver_sep + ver_rev;
 
-    auto lib_ver = ver_maj + ver_sep + ver_min + ver_sep + ver_rev;
+        return rocfft_test_run_env{runtime_ver, lib_ver, gpu_arch};
+    }();
+    return env;
+}
+
+template <typename Tint>
+inline rocfft_test_run<Tint> get_rocfft_test_run(const hash_output<Tint>& ibuffer_hash,
+                                                 const hash_output<Tint>& obuffer_hash,
+                                                 const std::string&       token)
+{
+    const auto& env = get_rocfft_test_run_env();
 
     return rocfft_test_run<Tint>(ibuffer_hash.buffer_real,
                                  ibuffer_hash.buffer_imag,
                                  obuffer_hash.buffer_real,
                                  obuffer_hash.buffer_imag,
                                  token,
-                                 runtime_ver,
-                                 lib_ver,
-                                 gpu_arch);
+                                 env.runtime_ver,
+                                 env.lib_ver,
+                                 env.gpu_arch);
 }
 
 class fft_hash_db
@@ -385,6 +425,7 @@ public:
         prepare_begin_end_stmts();
         prepare_match_stmt();
         prepare_insert_stmt();
+        prefetch();
     }
 
     ~fft_hash_db()
@@ -407,6 +448,21 @@ public:
 
         auto test_run = get_rocfft_test_run<Tint>(ibuffer_hash, obuffer_hash, token);
 
+        // most runs check tokens already in the database, which can
+        // be answered from the prefetched entries without a query
+        auto cached = known_runs.find(token);
+        if(cached != known_runs.end())
+        {
+            hash_entry_found = true;
+            hash_valid       = cached->second.ibuffer_hash_real == ibuffer_hash.buffer_real
+                         && cached->second.ibuffer_hash_imag == ibuffer_hash.buffer_imag
+                         && cached->second.obuffer_hash_real == obuffer_hash.buffer_real
+                         && cached->second.obuffer_hash_imag == obuffer_hash.buffer_imag;
+            return;
+        }
+
+        // another process may have added the entry since it was
+        // prefetched, so check the database again before inserting
         begin_transaction();
 
         hash_entry_found = check_match(&test_run);
@@ -422,9 +478,39 @@ public:
             insert(&test_run);
 
         end_transaction();
+
+        known_runs.emplace(token, test_run);
     }
 
 private:
+    // Load all entries recorded against the current environment, so
+    // that lookups don't each need a transaction.
+    void prefetch()
+    {
+        sqlite3_stmt* prefetch_stmt = nullptr;
+        auto          prefetch_sql  = rocfft_test_run<>::get_prefetch_sql();
+
+        ret = sqlite3_prepare_v2(db_connection, prefetch_sql.c_str(), -1, &prefetch_stmt, nullptr);
+        if(ret != SQLITE_OK)
+            throw std::runtime_error("Cannot prepare prefetch statement: "
+                                     + std::string(sqlite3_errmsg(db_connection)));
+
+        auto env_run = get_rocfft_test_run<default_hash_type>({}, {}, {});
+        env_run.bind_prefetch_statement(prefetch_stmt);
+
+        while((ret = sqlite3_step(prefetch_stmt)) == SQLITE_ROW)
+        {
+            auto entry = env_run;
+            entry.update(prefetch_stmt);
+            known_runs.emplace(entry.get_token(), entry);
+        }
+        sqlite3_finalize(prefetch_stmt);
+
+        if(ret != SQLITE_DONE)
+            throw std::runtime_error(std::string("Error executing prefetch statement: ")
+                                     + std::string(sqlite3_errmsg(db_connection)));
+    }
+
     void prepare_begin_end_stmts()
     {
         auto begin_sql = std::string("BEGIN TRANSACTION;");
@@ -522,6 +608,8 @@ private:
     sqlite3_stmt* end_stmt;
     sqlite3_stmt* insert_stmt;
     sqlite3_stmt* match_stmt;
+
+    std::unordered_map<std::string, rocfft_test_run<default_hash_type>> known_runs;
 };
 
 #endif // BITWISE_REPRO_DB_H
\ No newline at end of file
@@ -29,6 +29,7 @@
 
 #include "../../../shared/accuracy_test.h"
 #include "../../../shared/enum_to_string.h"
+#include "../../../shared/fft_hash_device.h"
 #include "../../../shared/fft_params.h"
 #include "../../../shared/gpubuf.h"
 #include "../../../shared/rocfft_params.h"
@@ -54,53 +55,52 @@ public:
 
 // execute the GPU transform
 template <class Tparams>
-inline void execute_fft(Tparams&              params,
-                        std::vector<void*>&   pibuffer,
-                        std::vector<void*>&   pobuffer,
-                        std::vector<gpubuf>&  obuffer,
-                        std::vector<hostbuf>& gpu_output)
+inline void execute_fft(Tparams&             params,
+                        std::vector<void*>&  pibuffer,
+                        std::vector<void*>&  pobuffer,
+                        std::vector<gpubuf>& obuffer)
 {
     // Execute the transform:
     auto fft_status = params.execute(pibuffer.data(), pobuffer.data());
     if(fft_status != fft_status_success)
         throw std::runtime_error("rocFFT plan execution failure");
 
-    ASSERT_TRUE(!gpu_output.empty()) << "no output buffers";
-    for(unsigned int idx = 0; idx < gpu_output.size(); ++idx)
+    // output is hashed on the device, so only copy it back to print it
+    if(verbose > 2)
     {
-        ASSERT_TRUE(gpu_output[idx].data() != nullptr)
-            << "output buffer index " << idx << " is empty";
-        auto hip_status = hipMemcpy(gpu_output[idx].data(),
-                                    pobuffer.at(idx),
-                                    gpu_output[idx].size(),
-                                    hipMemcpyDeviceToHost);
-        if(hip_status != hipSuccess)
+        auto gpu_output = allocate_host_buffer(params.precision, params.otype, params.osize);
+        for(unsigned int idx = 0; idx < gpu_output.size(); ++idx)
         {
-            ++n_hip_failures;
-            std::stringstream msg;
-            msg << "hipMemcpy failure";
-            if(skip_runtime_fails)
-                throw ROCFFT_GTEST_SKIP{std::move(msg)};
-            else
-                throw ROCFFT_GTEST_FAIL{std::move(msg)};
+            auto hip_status = hipMemcpy(gpu_output[idx].data(),
+                                        pobuffer.at(idx),
+                                        gpu_output[idx].size(),
+                                        hipMemcpyDeviceToHost);
+            if(hip_status != hipSuccess)
+            {
+                ++n_hip_failures;
+                std::stringstream msg;
+                msg << "hipMemcpy failure";
+                if(skip_runtime_fails)
+                    throw ROCFFT_GTEST_SKIP{std::move(msg)};
+                else
+                    throw ROCFFT_GTEST_FAIL{std::move(msg)};
+            }
         }
-    }
-    if(verbose > 2)
-    {
         std::cout << "GPU output:\n";
         params.print_obuffer(gpu_output);
-    }
-    if(verbose > 5)
-    {
-        std::cout << "flat GPU output:\n";
-        params.print_obuffer_flat(gpu_output);
+        if(verbose > 5)
+        {
+            std::cout << "flat GPU output:\n";
+            params.print_obuffer_flat(gpu_output);
+        }
     }
 }
 
+// Run the transform, and hash its input and output on the device.
 template <class Tparams>
-void compute_fft_data(Tparams&              params,
-                      std::vector<hostbuf>& fft_input,
-                      std::vector<hostbuf>& fft_output)
+void compute_fft_hashes(Tparams&             params,
+                        hash_output<size_t>& ibuffer_hash,
+                        hash_output<size_t>& obuffer_hash)
 {
     // Call hipGetLastError to reset any errors
     // returned by previous HIP runtime API calls.
@@ -156,34 +156,18 @@ void compute_fft_data(Tparams&              params,
         pibuffer[i] = ibuffer[i].data();
     }
 
-    // allocation counts in elements, ibuffer_sizes is in bytes
-    auto ibuffer_sizes_elems = ibuffer_sizes;
-    for(auto& buf : ibuffer_sizes_elems)
-        buf /= var_size<size_t>(params.precision, params.itype);
-
     //generate the input directly on the gpu
     params.compute_input(ibuffer);
 
-    // Copy input to CPU
-    fft_input = allocate_host_buffer(params.precision, params.itype, ibuffer_sizes_elems);
-    for(unsigned int idx = 0; idx < ibuffer.size(); ++idx)
-    {
-        hip_status = hipMemcpy(fft_input.at(idx).data(),
-                               ibuffer[idx].data(),
-                               ibuffer_sizes[idx],
-                               hipMemcpyDeviceToHost);
-        if(hip_status != hipSuccess)
-        {
-            std::stringstream msg;
-            msg << "hipMemcpy failure with error " << hip_status;
-
-            ++n_hip_failures;
-            if(skip_runtime_fails)
-                throw ROCFFT_GTEST_SKIP{std::move(msg)};
-            else
-                throw ROCFFT_GTEST_FAIL{std::move(msg)};
-        }
-    }
+    // hash the input before an in-place transform overwrites it
+    ibuffer_hash = compute_hash_device(pibuffer,
+                                       params.precision,
+                                       params.itype,
+                                       params.ilength(),
+                                       params.istride,
+                                       params.idist,
+                                       params.nbatch,
+                                       params.ioffset);
 
     std::vector<gpubuf>  obuffer_data;
     std::vector<gpubuf>* obuffer = &obuffer_data;
@@ -222,35 +206,24 @@ void compute_fft_data(Tparams&              params,
     }
 
     // execute GPU transform
-    fft_output = allocate_host_buffer(params.precision, params.otype, params.osize);
-
-    execute_fft(params, pibuffer, pobuffer, *obuffer, fft_output);
+    execute_fft(params, pibuffer, pobuffer, *obuffer);
+
+    obuffer_hash = compute_hash_device(pobuffer,
+                                       params.precision,
+                                       params.otype,
+                                       params.olength(),
+                                       params.ostride,
+                                       params.odist,
+                                       params.nbatch,
+                                       params.ooffset);
 }
 
 template <class Tfloat, class Tparams>
 inline void bitwise_repro_impl(Tparams& params, Tparams& params_comp)
 {
-    std::vector<hostbuf> fft_input, fft_output;
-    compute_fft_data(params, fft_input, fft_output);
-
-    auto ibuffer_hash_in = hash_input(rocfft_precision_from_fftparams(params.precision),
-                                      params.ilength(),
-                                      params.istride,
-                                      params.idist,
-                                      rocfft_array_type_from_fftparams(params.itype),
-                                      params.nbatch);
-
     auto ibuffer_hash_out = hash_output<size_t>();
-    compute_hash(fft_input, ibuffer_hash_in, ibuffer_hash_out);
-
-    auto obuffer_hash_in  = hash_input(rocfft_precision_from_fftparams(params.precision),
-                                      params.olength(),
-                                      params.ostride,
-                                      params.odist,
-                                      rocfft_array_type_from_fftparams(params.otype),
-                                      params.nbatch);
     auto obuffer_hash_out = hash_output<size_t>();
-    compute_hash(fft_output, obuffer_hash_in, obuffer_hash_out);
+    compute_fft_hashes(params, ibuffer_hash_out, obuffer_hash_out);
 
     if(params_comp.token().compare(params.token()) == 0)
     {
@@ -259,17 +232,9 @@ inline void bitwise_repro_impl(Tparams& params, Tparams& params_comp)
         throw ROCFFT_GTEST_SKIP{std::move(msg)};
     }
 
-    std::vector<hostbuf> fft_input_comp, fft_output_comp;
-    compute_fft_data(params_comp, fft_input_comp, fft_output_comp);
-
-    auto obuffer_hash_in_comp  = hash_input(rocfft_precision_from_fftparams(params_comp.precision),
-                                           params_comp.olength(),
-                                           params_comp.ostride,
-                                           params_comp.odist,
-                                           rocfft_array_type_from_fftparams(params_comp.otype),
-                                           params_comp.nbatch);
+    auto ibuffer_hash_out_comp = hash_output<size_t>();
     auto obuffer_hash_out_comp = hash_output<size_t>();
-    compute_hash(fft_output_comp, obuffer_hash_in_comp, obuffer_hash_out_comp);
+    compute_fft_hashes(params_comp, ibuffer_hash_out_comp, obuffer_hash_out_comp);
 
     params.free();
     params_comp.free();
@@ -283,26 +248,9 @@ inline void bitwise_repro_impl(Tparams& params, Tparams& params_comp)
 template <class Tfloat, class Tparams>
 inline void bitwise_repro_impl(Tparams& params)
 {
-    std::vector<hostbuf> fft_input, fft_output;
-    compute_fft_data(params, fft_input, fft_output);
-
-    auto ibuffer_hash_in  = hash_input(rocfft_precision_from_fftparams(params.precision),
-                                      params.ilength(),
-                                      params.istride,
-                                      params.idist,
-                                      rocfft_array_type_from_fftparams(params.itype),
-                                      params.nbatch);
     auto ibuffer_hash_out = hash_output<size_t>();
-    compute_hash(fft_input, ibuffer_hash_in, ibuffer_hash_out);
-
-    auto obuffer_hash_in  = hash_input(rocfft_precision_from_fftparams(params.precision),
-                                      params.olength(),
-                                      params.ostride,
-                                      params.odist,
-                                      rocfft_array_type_from_fftparams(params.otype),
-                                      params.nbatch);
     auto obuffer_hash_out = hash_output<size_t>();
-    compute_hash(fft_output, obuffer_hash_in, obuffer_hash_out);
+    compute_fft_hashes(params, ibuffer_hash_out, obuffer_hash_out);
 
     bool hash_entry_found, hash_valid;
 
@@ -23,10 +23,12 @@
 ///
 
 #include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <streambuf>
 #include <string>
@@ -36,6 +38,7 @@
 #include "../../shared/concurrency.h"
 #include "../../shared/environment.h"
 #include "../../shared/rocfft_accuracy_test.h"
+#include "../../shared/subprocess.h"
 #include "../../shared/test_params.h"
 #include "../../shared/work_queue.h"
 #include "bitwise_repro/bitwise_repro_db.h"
@@ -97,12 +100,22 @@ double max_l2_eps_half     = 0.0;
 // Control whether we use FFTW's wisdom (which we use to imply FFTW_MEASURE).
 bool use_fftw_wisdom = false;
 
+// Number of FFTW plans to keep for reuse across tests.
+size_t fftw_plan_cache_size = 32;
+
 // Compare results against FFTW in accuracy tests
 bool fftw_compare = true;
 
+// Compare against a reference computed on the GPU where possible,
+// instead of FFTW
+bool gpu_reference_compare = false;
+
 // Cache the last cpu fft that was requested
 last_cpu_fft_cache last_cpu_fft_data;
 
+// Content-addressed cache of FFTW references
+reference_fft_cache reference_cache;
+
 // Number of devices to distribute the FFT to for manual tests
 int manual_devices = 1;
 
@@ -242,8 +255,146 @@ void precompile_test_kernels(const std::string& precompile_file)
               << " ms\n";
 }
 
+// Run the test list in child processes spread across GPUs, one
+// worker per device.  The list is split into contiguous chunks so
+// that each child still benefits from tests being ordered to reuse
+// FFTW results.  Returns the process exit code.
+int run_sharded_tests(const std::string& exe, const std::vector<std::string>& args, int shards)
+{
+    int device_count = 0;
+    if(hipGetDeviceCount(&device_count) != hipSuccess || device_count == 0)
+    {
+        std::cerr << "no devices found for sharded run\n";
+        return EXIT_FAILURE;
+    }
+    if(shards <= 0 || shards > device_count)
+        shards = device_count;
+
+    // ask a child for the (filtered) test list
+    std::vector<std::string> tests;
+    {
+        auto list_args = args;
+        list_args.push_back("--gtest_list_tests");
+        auto               list = execute_subprocess(exe, list_args, {});
+        std::istringstream in(std::string(list.begin(), list.end()));
+        std::string        line;
+        std::string        suite;
+        while(std::getline(in, line))
+        {
+            if(line.empty())
+                continue;
+            if(line.compare(0, 2, "  ") == 0)
+            {
+                if(suite.empty())
+                    continue;
+                auto name = line.substr(2, line.find_first_of(" #", 2) - 2);
+                tests.push_back(suite + name);
+            }
+            else
+            {
+                auto name = line.substr(0, line.find_first_of(" #"));
+                suite     = !name.empty() && name.back() == '.' ? name : std::string();
+            }
+        }
+    }
+    if(tests.empty())
+    {
+        std::cout << "no tests to run\n";
+        return EXIT_SUCCESS;
+    }
+
+    // make a few chunks per device, so that devices that finish
+    // early can pick up more work
+    const size_t                       num_chunks = std::min<size_t>(tests.size(), shards * 4);
+    std::random_device                 dev;
+    auto                               tmpdir = std::filesystem::temp_directory_path();
+    std::vector<std::filesystem::path> chunk_files;
+    WorkQueue<std::string>             chunkQueue;
+    for(size_t c = 0; c < num_chunks; ++c)
+    {
+        auto path = tmpdir
+                    / ("rocfft-test-shard-" + std::to_string(dev()) + "-" + std::to_string(c)
+                       + ".txt");
+        std::ofstream out(path);
+        for(size_t t = tests.size() * c / num_chunks; t < tests.size() * (c + 1) / num_chunks;
+            ++t)
+            out << tests[t] << "\n";
+        chunk_files.push_back(path);
+        chunkQueue.push(path.string());
+    }
+
+    std::cout << "running " << tests.size() << " tests in " << num_chunks << " chunks on "
+              << shards << " devices\n";
+
+    std::mutex               output_mutex;
+    size_t                   failed_chunks = 0;
+    std::vector<std::thread> threads;
+    for(int device = 0; device < shards; ++device)
+    {
+        threads.emplace_back([&, device]() {
+            for(;;)
+            {
+                std::string chunk{chunkQueue.pop()};
+                if(chunk.empty())
+                    break;
+
+                auto child_args = args;
+                child_args.insert(child_args.end(),
+                                  {"--shard_device",
+                                   std::to_string(device),
+                                   "--shard_count",
+                                   std::to_string(shards),
+                                   "--shard_tests",
+                                   chunk});
+                std::string output;
+                bool        failed = false;
+                try
+                {
+                    auto out = execute_subprocess(exe, child_args, {});
+                    output.assign(out.begin(), out.end());
+                }
+                catch(std::exception& e)
+                {
+                    // a failing child's stdout comes back in the exception
+                    output = e.what();
+                    failed = true;
+                }
+
+                std::lock_guard<std::mutex> lock(output_mutex);
+                std::cout << "[device " << device << "] " << chunk << "\n" << output << std::endl;
+                if(failed)
+                    ++failed_chunks;
+            }
+        });
+        // insert empty chunks to tell threads to stop
+        chunkQueue.push({});
+    }
+    for(auto& t : threads)
+        t.join();
+
+    std::error_code ec;
+    for(const auto& path : chunk_files)
+        std::filesystem::remove(path, ec);
+
+    std::cout << "sharded run: " << failed_chunks << " of " << num_chunks << " chunks failed\n";
+    return failed_chunks ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 int main(int argc, char* argv[])
 {
+    // Keep the original arguments to pass on to children in a
+    // sharded run, since gtest removes its own from argv.
+    const std::string        exe = argv[0];
+    std::vector<std::string> child_args;
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if(arg == "--shards")
+            ++i;
+        else if(arg.compare(0, 9, "--shards=") != 0)
+            child_args.push_back(std::move(arg));
+    }
+
     // We would like to parse a few arguments before initiating gtest.
 
     CLI::App app{
@@ -287,6 +438,10 @@ int main(int argc, char* argv[])
         ->check(CLI::Range(0.0, 1.0));
     app.add_option("--fftw_compare", fftw_compare, "Compare to FFTW in accuracy tests")
         ->default_val(true);
+    app.add_flag("--gpu_reference",
+                 gpu_reference_compare,
+                 "In accuracy tests, compare single and half-precision transforms to a "
+                 "double-precision DFT computed on the GPU instead of FFTW, where possible");
     app.add_option("--mp_lib", mp_lib, "Multi-process library type: none (default), mpi")
         ->default_val("none");
     app.add_option("--mp_ranks", mp_ranks, "Number of multi-process ranks to launch")
@@ -311,6 +466,17 @@ int main(int argc, char* argv[])
     app.add_flag("--callback", "Inject load/store callbacks")->each([&](const std::string&) {
         manual_params.run_callbacks = true;
     });
+    int          shards = 0;
+    CLI::Option* opt_shards
+        = app.add_option("--shards",
+                         shards,
+                         "Spread tests over this many GPUs, running one child process per GPU "
+                         "at a time (0 for all visible GPUs)");
+    // internal options used by the children of a sharded run
+    int shard_device = -1;
+    app.add_option("--shard_device", shard_device)->group("");
+    size_t shard_count = 0;
+    app.add_option("--shard_count", shard_count)->group("");
     app.add_flag("--smoketest", "Run a short (approx 5 minute) randomized selection of tests")
         ->each([&](const std::string&) {
             // The objective is to have an test that takes about 5 minutes, so just set the probability
@@ -330,6 +496,27 @@ int main(int argc, char* argv[])
         return app.exit(e);
     }
 
+    // A sharded child only sees its own device, and gets its share
+    // of the host threads.  This must happen before HIP or OpenMP
+    // are initialized.
+    if(shard_device >= 0)
+    {
+        // device numbers are relative to any devices the parent
+        // was already restricted to
+        std::vector<std::string> visible;
+        std::stringstream        ss(rocfft_getenv("HIP_VISIBLE_DEVICES"));
+        for(std::string id; std::getline(ss, id, ',');)
+            visible.push_back(id);
+        auto device = static_cast<size_t>(shard_device) < visible.size()
+                          ? visible[shard_device]
+                          : std::to_string(shard_device);
+        rocfft_setenv("HIP_VISIBLE_DEVICES", device.c_str());
+    }
+    const size_t host_threads
+        = std::max<size_t>(rocfft_concurrency() / std::max<size_t>(shard_count, 1), 1);
+    if(shard_count > 1 && rocfft_getenv("OMP_NUM_THREADS").empty())
+        rocfft_setenv("OMP_NUM_THREADS", std::to_string(host_threads).c_str());
+
     // NB: If we initialize gtest first, then it removes all of its own command-line
     // arguments and sets argc and argv correctly;
     ::testing::InitGoogleTest(&argc, argv);
@@ -417,9 +604,28 @@ int main(int argc, char* argv[])
                    skip_runtime_fails,
                    "Skip the test if there is a runtime failure")
         ->default_val(true);
+    size_t ref_cache_gb = 0;
+    app.add_option("--ref_cache_gb",
+                   ref_cache_gb,
+                   "RAM in GiB for caching FFTW references across tests (0 to disable)")
+        ->default_val(2);
+    app.add_option("--ref_cache_dir",
+                   reference_cache.directory,
+                   "Directory to persist FFTW references to, for reuse by later runs");
+    std::string shard_tests;
+    app.add_option("--shard_tests", shard_tests)->group("");
     app.add_option("-w, --wise", use_fftw_wisdom, "Use FFTW wisdom");
     app.add_option("-W, --wisdomfile", fftw_wisdom_filename, "FFTW3 wisdom filename")
         ->default_val("wisdom3.txt");
+    app.add_option("--fftw_plan_cache",
+                   fftw_plan_cache_size,
+                   "Number of FFTW plans to reuse across tests, 0 to plan every reference")
+        ->default_val(32);
+    size_t fftw_threads = 0;
+    app.add_option("--fftw_threads",
+                   fftw_threads,
+                   "Number of threads for FFTW to use, 0 for the number of host threads")
+        ->default_val(0);
     app.add_option("--manual_devices",
                    manual_devices,
                    "Distribute manual test case among this many devices")
@@ -462,6 +668,8 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
+    reference_cache.max_bytes = ref_cache_gb * ONE_GiB;
+
     std::cout << "half epsilon: " << half_epsilon << "\tsingle epsilon: " << single_epsilon
               << "\tdouble epsilon: " << double_epsilon << "\n";
 
@@ -472,6 +680,33 @@ int main(int argc, char* argv[])
     }
     std::cout << "Random seed: " << random_seed << "\n";
 
+    if(*opt_shards)
+    {
+        // children must generate the same random tests
+        if(!*opt_seed)
+            child_args.insert(child_args.end(), {"--seed", std::to_string(random_seed)});
+        return run_sharded_tests(exe, child_args, shards);
+    }
+
+    if(!shard_tests.empty())
+    {
+        // run only this child's chunk of the test list.  '-' would
+        // start gtest's negative patterns, so match it with '?'.
+        std::ifstream in(shard_tests);
+        std::string   filter;
+        std::string   name;
+        while(std::getline(in, name))
+        {
+            std::replace(name.begin(), name.end(), '-', '?');
+            if(!filter.empty())
+                filter += ':';
+            filter += name;
+        }
+        ::testing::GTEST_FLAG(filter) = filter;
+    }
+    if(shard_count > 1)
+        ramgb = std::max<size_t>(ramgb / shard_count, 1);
+
     // if precompiling, tell rocFFT to use the specified cache file
     // to write kernels to
     //
@@ -492,8 +727,10 @@ int main(int argc, char* argv[])
 #ifdef FFTW_MULTITHREAD
     fftw_init_threads();
     fftwf_init_threads();
-    fftw_plan_with_nthreads(rocfft_concurrency());
-    fftwf_plan_with_nthreads(rocfft_concurrency());
+    if(fftw_threads == 0)
+        fftw_threads = host_threads;
+    fftw_plan_with_nthreads(static_cast<int>(fftw_threads));
+    fftwf_plan_with_nthreads(static_cast<int>(fftw_threads));
 #endif
 
     if(use_fftw_wisdom)
@@ -589,7 +826,6 @@ int main(int argc, char* argv[])
     {
         std::string fftw_wisdom  = std::string(fftw_export_wisdom_to_string());
         std::string fftwf_wisdom = std::string(fftwf_export_wisdom_to_string());
-        fftw_wisdom.append(std::string(fftwf_export_wisdom_to_string()));
         std::ofstream fftw_wisdom_file(fftw_wisdom_filename);
         fftw_wisdom_file << fftw_wisdom;
         fftw_wisdom_file << fftwf_wisdom;
@@ -606,6 +842,7 @@ int main(int argc, char* argv[])
     std::cout << "double precision max l-inf epsilon: " << max_linf_eps_double << "\n";
     std::cout << "double precision max l2 epsilon:     " << max_l2_eps_double << "\n";
     std::cout << "Number of runtime issues: " << n_hip_failures << "\n";
+    std::cout << "Cached FFTW references reused: " << reference_cache.hits << "\n";
 
     return retval;
 }
@@ -388,3 +388,83 @@ TEST(rocfft_UnitTest, DISABLED_hipGraph_execution)
 
     ASSERT_EQ(hipStreamDestroy(other_stream), hipSuccess);
 }
+
+// Export forward + inverse transforms as graphs with
+// rocfft_plan_capture_graph, and check that replaying them
+// round-trips the input
+TEST(rocfft_UnitTest, hipGraph_plan_capture)
+{
+    size_t N    = 256;
+    size_t seed = 100;
+
+    gpubuf_t<rocfft_complex<float>>    device_mem_in;
+    std::vector<rocfft_complex<float>> host_mem_in;
+    init_input_data(N, seed, host_mem_in, device_mem_in);
+    void* in_ptr = device_mem_in.data();
+
+    gpubuf_t<rocfft_complex<float>>    device_mem_out;
+    std::vector<rocfft_complex<float>> host_mem_out;
+    init_data<rocfft_complex<float>>(
+        N, rocfft_complex<float>(0., 0.), host_mem_out, device_mem_out);
+    void* out_ptr = device_mem_out.data();
+
+    rocfft_plan plan = nullptr;
+    create_forward_fft_plan(N, plan);
+    rocfft_plan plan_inv = nullptr;
+    create_inverse_fft_plan(N, plan_inv);
+
+    hipStream_wrapper_t stream;
+    stream.alloc();
+
+    rocfft_execution_info info = nullptr;
+    set_fft_info(stream, info);
+
+    // capture mode requires any work buffer to be provided up front
+    size_t work_size     = 0;
+    size_t work_size_inv = 0;
+    ASSERT_EQ(rocfft_plan_get_work_buffer_size(plan, &work_size), rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_get_work_buffer_size(plan_inv, &work_size_inv), rocfft_status_success);
+    work_size = std::max(work_size, work_size_inv);
+    gpubuf work_buf;
+    if(work_size)
+    {
+        ASSERT_EQ(work_buf.alloc(work_size), hipSuccess);
+        ASSERT_EQ(rocfft_execution_info_set_work_buffer(info, work_buf.data(), work_size),
+                  rocfft_status_success);
+    }
+
+    void* graph_fwd = nullptr;
+    void* graph_inv = nullptr;
+    ASSERT_EQ(rocfft_plan_capture_graph(plan, &in_ptr, &out_ptr, info, &graph_fwd),
+              rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_capture_graph(plan_inv, &out_ptr, nullptr, info, &graph_inv),
+              rocfft_status_success);
+
+    // nothing should have executed yet
+    compare_data_exact_match<rocfft_complex<float>>(stream, host_mem_out, device_mem_out);
+
+    hipGraphExec_t exec_fwd = nullptr;
+    hipGraphExec_t exec_inv = nullptr;
+    ASSERT_EQ(
+        hipGraphInstantiate(&exec_fwd, static_cast<hipGraph_t>(graph_fwd), NULL, NULL, 0),
+        hipSuccess);
+    ASSERT_EQ(
+        hipGraphInstantiate(&exec_inv, static_cast<hipGraph_t>(graph_inv), NULL, NULL, 0),
+        hipSuccess);
+    ASSERT_EQ(hipGraphDestroy(static_cast<hipGraph_t>(graph_fwd)), hipSuccess);
+    ASSERT_EQ(hipGraphDestroy(static_cast<hipGraph_t>(graph_inv)), hipSuccess);
+
+    ASSERT_EQ(hipGraphLaunch(exec_fwd, stream), hipSuccess);
+    ASSERT_EQ(hipGraphLaunch(exec_inv, stream), hipSuccess);
+    scale_device_data(
+        stream, 1.0f / N, N, static_cast<rocfft_complex<float>*>(device_mem_out.data()));
+    ASSERT_EQ(hipStreamSynchronize(stream), hipSuccess);
+
+    compare_data(host_mem_in, device_mem_out);
+
+    ASSERT_EQ(hipGraphExecDestroy(exec_fwd), hipSuccess);
+    ASSERT_EQ(hipGraphExecDestroy(exec_inv), hipSuccess);
+    ASSERT_EQ(rocfft_execution_info_destroy(info), rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_destroy(plan), rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_destroy(plan_inv), rocfft_status_success);
+}
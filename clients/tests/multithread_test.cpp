@@ -121,6 +121,21 @@ struct Test_Transform
                                      nullptr),
                   rocfft_status_success);
 
+        execute_transform();
+    }
+
+    // run the transform with plans that other threads are also
+    // executing at the same time
+    void run_shared_transform(rocfft_plan shared_plan, rocfft_plan shared_plan_inv)
+    {
+        plan       = shared_plan;
+        plan_inv   = shared_plan_inv;
+        owns_plans = false;
+        execute_transform();
+    }
+
+    void execute_transform()
+    {
         // allocate work buffer if necessary
         ASSERT_EQ(rocfft_plan_get_work_buffer_size(plan, &work_buffer_size), rocfft_status_success);
         // NOTE: assuming that same-sized work buffer is ok for both
@@ -178,9 +193,12 @@ struct Test_Transform
         ASSERT_EQ(hipFree(work_buffer), hipSuccess);
         work_buffer = nullptr;
 
-        ASSERT_EQ(rocfft_plan_destroy(plan), rocfft_status_success);
-        plan = nullptr;
-        ASSERT_EQ(rocfft_plan_destroy(plan_inv), rocfft_status_success);
+        if(owns_plans)
+        {
+            ASSERT_EQ(rocfft_plan_destroy(plan), rocfft_status_success);
+            ASSERT_EQ(rocfft_plan_destroy(plan_inv), rocfft_status_success);
+        }
+        plan     = nullptr;
         plan_inv = nullptr;
 
         // Copy result back to host
@@ -240,6 +258,7 @@ struct Test_Transform
     hipStream_wrapper_t                stream;
     rocfft_plan                        plan             = nullptr;
     rocfft_plan                        plan_inv         = nullptr;
+    bool                               owns_plans       = true;
     size_t                             work_buffer_size = 0;
     void*                              work_buffer      = nullptr;
     gpubuf                             device_mem_in;
@@ -274,6 +293,55 @@ static void multithread_transform(size_t N, size_t dim, size_t num_threads)
         t.join();
 }
 
+// run concurrent transforms, one per thread, that all execute the
+// same pair of plans on their own streams
+static void shared_plan_transform(size_t N, size_t dim, size_t num_threads)
+{
+    std::vector<size_t> lengths(dim, N);
+    rocfft_plan         plan     = nullptr;
+    rocfft_plan         plan_inv = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 dim,
+                                 lengths.data(),
+                                 1,
+                                 nullptr),
+              rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_create(&plan_inv,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_inverse,
+                                 rocfft_precision_single,
+                                 dim,
+                                 lengths.data(),
+                                 1,
+                                 nullptr),
+              rocfft_status_success);
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for(size_t j = 0; j < num_threads; ++j)
+    {
+        threads.emplace_back([=]() {
+            try
+            {
+                Test_Transform t(N, dim, j);
+                t.run_shared_transform(plan, plan_inv);
+            }
+            catch(std::bad_alloc& e)
+            {
+                ADD_FAILURE() << "memory allocation failure";
+            }
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+
+    ASSERT_EQ(rocfft_plan_destroy(plan), rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_destroy(plan_inv), rocfft_status_success);
+}
+
 // for multi-stream tests, set up a bunch of streams, then execute
 // all of those transforms from a single thread.  afterwards,
 // wait/verify/cleanup in parallel to save wall time during the test.
@@ -349,3 +417,13 @@ TEST(rocfft_UnitTest, simple_multistream_3D)
 {
     multistream_transform(128, 3, 32);
 }
+
+TEST(rocfft_UnitTest, shared_plan_multithread_1D)
+{
+    shared_plan_transform(1048576, 1, 32);
+}
+
+TEST(rocfft_UnitTest, shared_plan_multithread_2D)
+{
+    shared_plan_transform(1024, 2, 32);
+}
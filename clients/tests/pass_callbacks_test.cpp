@@ -0,0 +1,290 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <hip/hip_runtime.h>
+
+#include "../../shared/gpubuf.h"
+#include "../../shared/rocfft_complex.h"
+#include "rocfft/rocfft.h"
+
+// callbacks that scale each element by a float in device memory.
+// FFTs are linear, so scaling at any point of the plan scales the
+// result by the same amount.
+template <typename T>
+__device__ T scale_load_cb(T* data, size_t offset, void* cbdata, void* sharedMem)
+{
+    return data[offset] * *static_cast<const float*>(cbdata);
+}
+
+template <typename T>
+__device__ void scale_store_cb(T* data, size_t offset, T element, void* cbdata, void* sharedMem)
+{
+    data[offset] = element * *static_cast<const float*>(cbdata);
+}
+
+__device__ auto scale_load_cb_float          = scale_load_cb<float>;
+__device__ auto scale_store_cb_float         = scale_store_cb<float>;
+__device__ auto scale_store_cb_complex_float = scale_store_cb<rocfft_complex<float>>;
+
+// run a single-precision complex forward transform on interleaved
+// data, with whatever callbacks are set on info
+static void run_interleaved(const std::vector<size_t>&                lengths,
+                            rocfft_plan_description                   desc,
+                            rocfft_execution_info                     info,
+                            const std::vector<rocfft_complex<float>>& input,
+                            std::vector<rocfft_complex<float>>&       output,
+                            rocfft_status&                            status)
+{
+    const size_t bytes = input.size() * sizeof(rocfft_complex<float>);
+    gpubuf       dev_in, dev_out;
+    ASSERT_EQ(hipSuccess, dev_in.alloc(bytes));
+    ASSERT_EQ(hipSuccess, dev_out.alloc(bytes));
+    ASSERT_EQ(hipSuccess, hipMemcpy(dev_in.data(), input.data(), bytes, hipMemcpyHostToDevice));
+
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 1,
+                                 desc));
+    void* in_ptr  = dev_in.data();
+    void* out_ptr = dev_out.data();
+    status        = rocfft_execute(plan, &in_ptr, &out_ptr, info);
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+    output.resize(input.size());
+    ASSERT_EQ(hipSuccess, hipMemcpy(output.data(), dev_out.data(), bytes, hipMemcpyDeviceToHost));
+}
+
+static std::vector<rocfft_complex<float>> make_input(size_t count)
+{
+    std::vector<rocfft_complex<float>> input(count);
+    for(size_t i = 0; i < count; ++i)
+        input[i] = {static_cast<float>(i % 7) * 0.25f - 0.5f,
+                    static_cast<float>(i % 3) * 0.5f - 0.5f};
+    return input;
+}
+
+static void expect_scaled(const std::vector<rocfft_complex<float>>& ref,
+                          const std::vector<rocfft_complex<float>>& out,
+                          float                                     scale)
+{
+    ASSERT_EQ(ref.size(), out.size());
+    for(size_t i = 0; i < ref.size(); ++i)
+    {
+        const float tol = 1e-4f * std::max(1.0f, std::abs(ref[i].x) + std::abs(ref[i].y));
+        ASSERT_NEAR(ref[i].x * scale, out[i].x, tol) << "index " << i;
+        ASSERT_NEAR(ref[i].y * scale, out[i].y, tol) << "index " << i;
+    }
+}
+
+// store callbacks on each pass of multi-kernel plans
+TEST(rocfft_UnitTest, pass_store_callbacks)
+{
+    const float scale = 3.0f;
+    gpubuf      dev_scale;
+    ASSERT_EQ(hipSuccess, dev_scale.alloc(sizeof(float)));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(dev_scale.data(), &scale, sizeof(float), hipMemcpyHostToDevice));
+    void* cb_fn = nullptr;
+    ASSERT_EQ(
+        hipSuccess,
+        hipMemcpyFromSymbol(&cb_fn, HIP_SYMBOL(scale_store_cb_complex_float), sizeof(void*)));
+    void* cb_data = dev_scale.data();
+
+    for(const auto& lengths : std::vector<std::vector<size_t>>{{20, 40}, {63, 5, 6}, {8192}})
+    {
+        size_t count = 1;
+        for(auto len : lengths)
+            count *= len;
+        const auto input = make_input(count);
+
+        rocfft_plan_description desc = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_pass_callbacks(desc, 1));
+
+        std::vector<rocfft_complex<float>> ref;
+        rocfft_status                      status;
+        run_interleaved(lengths, desc, nullptr, input, ref, status);
+        ASSERT_EQ(rocfft_status_success, status);
+
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     lengths.size(),
+                                     lengths.data(),
+                                     1,
+                                     desc));
+        rocfft_plan_info plan_info;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &plan_info));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+        // kernels that can't run callbacks reject them at execution
+        // time, but the plan's passes can't all be like that
+        size_t callback_passes = 0;
+        for(size_t pass = 0; pass < plan_info.kernel_count; ++pass)
+        {
+            rocfft_execution_info info = nullptr;
+            ASSERT_EQ(rocfft_status_success, rocfft_execution_info_create(&info));
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_execution_info_set_pass_store_callback(
+                          info, pass, &cb_fn, &cb_data, 0));
+
+            std::vector<rocfft_complex<float>> out;
+            run_interleaved(lengths, desc, info, input, out, status);
+            if(status == rocfft_status_success)
+            {
+                expect_scaled(ref, out, scale);
+                ++callback_passes;
+
+                // the last pass can't also run the ordinary store callback
+                if(pass + 1 == plan_info.kernel_count)
+                {
+                    ASSERT_EQ(rocfft_status_success,
+                              rocfft_execution_info_set_store_callback(info, &cb_fn, &cb_data, 0));
+                    run_interleaved(lengths, desc, info, input, out, status);
+                    EXPECT_EQ(rocfft_status_invalid_arg_value, status);
+                }
+            }
+            else
+                EXPECT_EQ(rocfft_status_invalid_arg_value, status) << "pass " << pass;
+            ASSERT_EQ(rocfft_status_success, rocfft_execution_info_destroy(info));
+        }
+        EXPECT_GT(callback_passes, 0u);
+
+        // passes past the end of the plan don't exist
+        rocfft_execution_info info = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_execution_info_create(&info));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_execution_info_set_pass_store_callback(
+                      info, plan_info.kernel_count, &cb_fn, &cb_data, 0));
+        std::vector<rocfft_complex<float>> out;
+        run_interleaved(lengths, desc, info, input, out, status);
+        EXPECT_EQ(rocfft_status_invalid_arg_value, status);
+        ASSERT_EQ(rocfft_status_success, rocfft_execution_info_destroy(info));
+
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+    }
+}
+
+// real-valued callbacks on planar input and output
+TEST(rocfft_UnitTest, planar_callbacks)
+{
+    const float scale = 0.5f;
+    gpubuf      dev_scale;
+    ASSERT_EQ(hipSuccess, dev_scale.alloc(sizeof(float)));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(dev_scale.data(), &scale, sizeof(float), hipMemcpyHostToDevice));
+    void* load_fn  = nullptr;
+    void* store_fn = nullptr;
+    ASSERT_EQ(hipSuccess,
+              hipMemcpyFromSymbol(&load_fn, HIP_SYMBOL(scale_load_cb_float), sizeof(void*)));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpyFromSymbol(&store_fn, HIP_SYMBOL(scale_store_cb_float), sizeof(void*)));
+    void* cb_data = dev_scale.data();
+
+    for(const auto& lengths : std::vector<std::vector<size_t>>{{64}, {8192}, {23}, {20, 40}})
+    {
+        size_t count = 1;
+        for(auto len : lengths)
+            count *= len;
+        const auto input = make_input(count);
+
+        std::vector<rocfft_complex<float>> ref;
+        rocfft_status                      status;
+        run_interleaved(lengths, nullptr, nullptr, input, ref, status);
+        ASSERT_EQ(rocfft_status_success, status);
+
+        // split the input into planar buffers
+        std::vector<float> host_re(count), host_im(count);
+        for(size_t i = 0; i < count; ++i)
+        {
+            host_re[i] = input[i].x;
+            host_im[i] = input[i].y;
+        }
+        const size_t bytes = count * sizeof(float);
+        gpubuf       in_re, in_im, out_re, out_im;
+        ASSERT_EQ(hipSuccess, in_re.alloc(bytes));
+        ASSERT_EQ(hipSuccess, in_im.alloc(bytes));
+        ASSERT_EQ(hipSuccess, out_re.alloc(bytes));
+        ASSERT_EQ(hipSuccess, out_im.alloc(bytes));
+        ASSERT_EQ(hipSuccess, hipMemcpy(in_re.data(), host_re.data(), bytes, hipMemcpyHostToDevice));
+        ASSERT_EQ(hipSuccess, hipMemcpy(in_im.data(), host_im.data(), bytes, hipMemcpyHostToDevice));
+
+        rocfft_plan_description desc = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_data_layout(desc,
+                                                          rocfft_array_type_complex_planar,
+                                                          rocfft_array_type_complex_planar,
+                                                          nullptr,
+                                                          nullptr,
+                                                          0,
+                                                          nullptr,
+                                                          0,
+                                                          0,
+                                                          nullptr,
+                                                          0));
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     lengths.size(),
+                                     lengths.data(),
+                                     1,
+                                     desc));
+
+        rocfft_execution_info info = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_execution_info_create(&info));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_execution_info_set_load_callback(info, &load_fn, &cb_data, 0));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_execution_info_set_store_callback(info, &store_fn, &cb_data, 0));
+
+        void* in_ptrs[2]  = {in_re.data(), in_im.data()};
+        void* out_ptrs[2] = {out_re.data(), out_im.data()};
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, in_ptrs, out_ptrs, info));
+        ASSERT_EQ(rocfft_status_success, rocfft_execution_info_destroy(info));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+        ASSERT_EQ(hipSuccess, hipMemcpy(host_re.data(), out_re.data(), bytes, hipMemcpyDeviceToHost));
+        ASSERT_EQ(hipSuccess, hipMemcpy(host_im.data(), out_im.data(), bytes, hipMemcpyDeviceToHost));
+        std::vector<rocfft_complex<float>> out(count);
+        for(size_t i = 0; i < count; ++i)
+            out[i] = {host_re[i], host_im[i]};
+        expect_scaled(ref, out, scale * scale);
+    }
+}
@@ -28,6 +28,7 @@
 #include "../../shared/rocfft_against_fftw.h"
 #include "../../shared/rocfft_hip.h"
 #include "rocfft/rocfft.h"
+#include <algorithm>
 #include <chrono>
 #include <mpi.h>
 
@@ -341,10 +342,11 @@ void execute_reference_fft(const fft_params& params, std::vector<hostbuf>& input
 
     fftw_run<Tfloat>(params.transform_type, cpu_plan, input, input);
 
-    fftw_destroy_plan_type(cpu_plan);
+    fftw_release_plan<Tfloat>(cpu_plan);
 }
 
 bool   use_fftw_wisdom = false;
+size_t fftw_plan_cache_size = 0;
 double half_epsilon    = default_half_epsilon();
 double single_epsilon  = default_single_epsilon();
 double double_epsilon  = default_double_epsilon();
@@ -353,12 +355,167 @@ void usage()
 {
     puts("Usage:\n"
          "  rocfft_mpi_worker token --accuracy\n"
-         "  rocfft_mpi_worker token --benchmark\n");
+         "  rocfft_mpi_worker token --benchmark [ntrial]\n");
+}
+
+// time ntrial executions, reporting the slowest rank's time for
+// each, and then break one more execution down by plan item
+void run_benchmark(MPI_Comm            mpi_comm,
+                   int                 mpi_rank,
+                   rocfft_params&      params,
+                   std::vector<void*>& local_input_ptrs,
+                   std::vector<void*>& local_output_ptrs,
+                   int                 ntrial)
+{
+    // ensure plan is finished building, synchronize all devices
+    // in the input bricks
+    synchronize_brick_devices(params.ifields.back().bricks);
+
+    // warm up once so the trials don't include one-time setup
+    params.execute(local_input_ptrs.data(), local_output_ptrs.data());
+    synchronize_brick_devices(params.ofields.back().bricks);
+
+    std::vector<double> max_times;
+    for(int trial = 0; trial < ntrial; ++trial)
+    {
+        MPI_Barrier(mpi_comm);
+
+        auto start = std::chrono::steady_clock::now();
+        params.execute(local_input_ptrs.data(), local_output_ptrs.data());
+        // ensure FFT is finished executing - synchronize all devices
+        // on output bricks
+        synchronize_brick_devices(params.ofields.back().bricks);
+        auto stop = std::chrono::steady_clock::now();
+
+        double diff_ms     = std::chrono::duration<double, std::milli>(stop - start).count();
+        double max_diff_ms = 0.0;
+        // reduce max runtime to root
+        MPI_Reduce(&diff_ms, &max_diff_ms, 1, MPI_DOUBLE, MPI_MAX, 0, mpi_comm);
+
+        if(mpi_rank == 0)
+        {
+            printf("Max rank time %f ms\n", max_diff_ms);
+            max_times.push_back(max_diff_ms);
+        }
+    }
+
+    if(mpi_rank == 0 && !max_times.empty())
+    {
+        std::sort(max_times.begin(), max_times.end());
+        printf("Trials %d: min %f ms, median %f ms, max %f ms\n",
+               ntrial,
+               max_times.front(),
+               max_times[max_times.size() / 2],
+               max_times.back());
+    }
+
+    // run one more execution with plan items timed.  Items run
+    // one at a time, so the breakdown doesn't include any overlap
+    // of communication with computation.
+    if(rocfft_execution_info_set_item_timing(params.info, 1 << 16) != rocfft_status_success)
+        throw std::runtime_error("failed to enable item timing");
+    MPI_Barrier(mpi_comm);
+    params.execute(local_input_ptrs.data(), local_output_ptrs.data());
+
+    size_t count = 0;
+    rocfft_execution_info_get_item_times(params.info, nullptr, &count);
+    std::vector<rocfft_plan_item_time> records(count);
+    rocfft_execution_info_get_item_times(params.info, records.data(), &count);
+    rocfft_execution_info_set_item_timing(params.info, 0);
+
+    // ranks run different subsets of the items, so combine times
+    // by item index across all ranks
+    unsigned long long local_items = 0;
+    for(const auto& r : records)
+        local_items = std::max<unsigned long long>(local_items, r.item_index + 1);
+    unsigned long long num_items = 0;
+    MPI_Allreduce(&local_items, &num_items, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, mpi_comm);
+
+    const int           num_phases = rocfft_plan_item_phase_communication + 1;
+    std::vector<double> durations(num_items);
+    std::vector<int>    ranks(num_items);
+    std::vector<int>    phases(num_items, -1);
+    std::vector<double> phase_totals(num_phases);
+    for(const auto& r : records)
+    {
+        durations[r.item_index] = r.duration_ms;
+        ranks[r.item_index]     = 1;
+        phases[r.item_index]    = r.phase;
+        phase_totals[r.phase] += r.duration_ms;
+    }
+
+    std::vector<double> sum_durations(num_items);
+    std::vector<double> max_durations(num_items);
+    std::vector<int>    item_ranks(num_items);
+    std::vector<int>    item_phases(num_items);
+    std::vector<double> max_phase_totals(num_phases);
+    std::vector<double> sum_phase_totals(num_phases);
+    MPI_Reduce(
+        durations.data(), sum_durations.data(), num_items, MPI_DOUBLE, MPI_SUM, 0, mpi_comm);
+    MPI_Reduce(
+        durations.data(), max_durations.data(), num_items, MPI_DOUBLE, MPI_MAX, 0, mpi_comm);
+    MPI_Reduce(ranks.data(), item_ranks.data(), num_items, MPI_INT, MPI_SUM, 0, mpi_comm);
+    MPI_Reduce(phases.data(), item_phases.data(), num_items, MPI_INT, MPI_MAX, 0, mpi_comm);
+    MPI_Reduce(phase_totals.data(),
+               max_phase_totals.data(),
+               num_phases,
+               MPI_DOUBLE,
+               MPI_MAX,
+               0,
+               mpi_comm);
+    MPI_Reduce(phase_totals.data(),
+               sum_phase_totals.data(),
+               num_phases,
+               MPI_DOUBLE,
+               MPI_SUM,
+               0,
+               mpi_comm);
+
+    if(mpi_rank != 0)
+        return;
+
+    static const char* phase_names[] = {"fft", "pack", "unpack", "communication"};
+    int mpi_size = 0;
+    MPI_Comm_size(mpi_comm, &mpi_size);
+
+    // imbalance is the slowest rank's time relative to the mean
+    // over the ranks that ran the item
+    printf("Item breakdown (serialized):\n");
+    printf("%6s %-14s %6s %12s %12s %10s\n",
+           "item",
+           "phase",
+           "ranks",
+           "mean ms",
+           "max ms",
+           "imbalance");
+    for(size_t i = 0; i < num_items; ++i)
+    {
+        if(!item_ranks[i])
+            continue;
+        double mean = sum_durations[i] / item_ranks[i];
+        printf("%6zu %-14s %6d %12f %12f %10.2f\n",
+               i,
+               phase_names[item_phases[i]],
+               item_ranks[i],
+               mean,
+               max_durations[i],
+               mean > 0.0 ? max_durations[i] / mean : 1.0);
+    }
+    printf("Phase totals:\n");
+    for(int p = 0; p < num_phases; ++p)
+    {
+        double mean = sum_phase_totals[p] / mpi_size;
+        printf("%-14s mean %f ms, max rank %f ms, imbalance %.2f\n",
+               phase_names[p],
+               mean,
+               max_phase_totals[p],
+               mean > 0.0 ? max_phase_totals[p] / mean : 1.0);
+    }
 }
 
 int main(int argc, char* argv[])
 {
-    if(argc != 3)
+    if(argc != 3 && !(argc == 4 && strcmp(argv[2], "--benchmark") == 0))
     {
         usage();
         return 1;
@@ -381,10 +538,15 @@ int main(int argc, char* argv[])
 
     bool run_fftw  = false;
     bool run_bench = false;
+    int  ntrial    = 1;
     if(strcmp(argv[2], "--accuracy") == 0)
         run_fftw = true;
     else if(strcmp(argv[2], "--benchmark") == 0)
+    {
         run_bench = true;
+        if(argc == 4)
+            ntrial = std::max(1, atoi(argv[3]));
+    }
     else
     {
         usage();
@@ -481,43 +643,10 @@ int main(int argc, char* argv[])
     // call rocfft_plan_create
     params.create_plan();
 
-    std::chrono::time_point<std::chrono::steady_clock> start, stop;
-
     if(run_bench)
-    {
-        // ensure plan is finished building, synchronize all devices
-        // in the output bricks
-        synchronize_brick_devices(params.ifields.back().bricks);
-
-        MPI_Barrier(mpi_comm);
-
-        // start timer
-        start = std::chrono::steady_clock::now();
-    }
-
-    params.execute(local_input_ptrs.data(), local_output_ptrs.data());
-
-    if(run_bench)
-    {
-        // ensure FFT is finished executing - synchronize all devices
-        // on output bricks
-        synchronize_brick_devices(params.ofields.back().bricks);
-
-        stop = std::chrono::steady_clock::now();
-
-        std::chrono::duration<double, std::milli> diff = stop - start;
-
-        double diff_ms = diff.count();
-
-        double max_diff_ms = 0.0;
-        // reduce max runtime to root
-        MPI_Reduce(&diff_ms, &max_diff_ms, 1, MPI_DOUBLE, MPI_MAX, 0, mpi_comm);
-
-        if(mpi_rank == 0)
-        {
-            printf("Max rank time %f ms\n", max_diff_ms);
-        }
-    }
+        run_benchmark(mpi_comm, mpi_rank, params, local_input_ptrs, local_output_ptrs, ntrial);
+    else
+        params.execute(local_input_ptrs.data(), local_output_ptrs.data());
 
     if(run_fftw)
     {
@@ -25,11 +25,17 @@
 #include "../../shared/gpubuf.h"
 #include "../../shared/rocfft_complex.h"
 #include "hip/hip_runtime_api.h"
+#include <atomic>
 #include <boost/scope_exit.hpp>
+#include <cmath>
+#include <complex>
 #include <condition_variable>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <fstream>
 #include <gtest/gtest.h>
+#include <limits>
 #include <mutex>
 #include <regex>
 #include <thread>
@@ -101,6 +107,4239 @@ TEST(rocfft_UnitTest, plan_description)
     ASSERT_TRUE(rocfft_status_success == rocfft_plan_destroy(plan));
 }
 
+// Asking for minimal work buffers should never need more work
+// memory than the default
+TEST(rocfft_UnitTest, plan_minimize_work_buffer)
+{
+    const std::vector<std::vector<size_t>> problems = {{200, 256, 256}, {8191}, {336, 336}};
+
+    for(const auto& lengths : problems)
+    {
+        size_t work_size[2] = {0, 0};
+        for(int minimize = 0; minimize < 2; ++minimize)
+        {
+            rocfft_plan_description desc = nullptr;
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_description_set_minimize_work_buffer(desc, minimize));
+
+            rocfft_plan plan = nullptr;
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_create(&plan,
+                                         rocfft_placement_notinplace,
+                                         rocfft_transform_type_real_forward,
+                                         rocfft_precision_single,
+                                         lengths.size(),
+                                         lengths.data(),
+                                         1,
+                                         desc));
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_get_work_buffer_size(plan, &work_size[minimize]));
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+        }
+        EXPECT_LE(work_size[1], work_size[0]);
+    }
+}
+
+// Each optimization goal builds a plan, and optimizing for memory
+// never needs more work memory than optimizing for throughput or
+// latency
+TEST(rocfft_UnitTest, plan_optimization_goal)
+{
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_optimization_goal(nullptr,
+                                                            rocfft_optimization_goal_latency));
+
+    const std::vector<std::vector<size_t>> problems = {{4096}, {8191}, {336, 336}};
+    const rocfft_optimization_goal         goals[]
+        = {rocfft_optimization_goal_throughput,
+           rocfft_optimization_goal_latency,
+           rocfft_optimization_goal_memory};
+
+    for(const auto& lengths : problems)
+    {
+        size_t work_size[3] = {0, 0, 0};
+        for(size_t i = 0; i < 3; ++i)
+        {
+            rocfft_plan_description desc = nullptr;
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_description_set_optimization_goal(desc, goals[i]));
+
+            rocfft_plan plan = nullptr;
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_create(&plan,
+                                         rocfft_placement_notinplace,
+                                         rocfft_transform_type_complex_forward,
+                                         rocfft_precision_single,
+                                         lengths.size(),
+                                         lengths.data(),
+                                         1,
+                                         desc));
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_get_work_buffer_size(plan, &work_size[i]));
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+        }
+        EXPECT_LE(work_size[2], work_size[0]);
+        EXPECT_LE(work_size[2], work_size[1]);
+    }
+}
+
+// number of kernels a 4096-point single-precision C2C plan launches
+static size_t low_batch_kernel_count(size_t batch, rocfft_optimization_goal goal)
+{
+    rocfft_plan_description desc = nullptr;
+    EXPECT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    EXPECT_EQ(rocfft_status_success, rocfft_plan_description_set_optimization_goal(desc, goal));
+
+    const size_t length = 4096;
+    rocfft_plan  plan   = nullptr;
+    EXPECT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc));
+    rocfft_plan_info info = {};
+    EXPECT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+    EXPECT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    EXPECT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+    return info.kernel_count;
+}
+
+// A small batch of a single-kernel length is split over two kernels
+// to occupy the device, unless the plan minimizes its work buffer
+// or the batch already fills the device
+TEST(rocfft_UnitTest, plan_low_batch_split)
+{
+    int             deviceId = 0;
+    hipDeviceProp_t prop;
+    ASSERT_EQ(hipSuccess, hipGetDevice(&deviceId));
+    ASSERT_EQ(hipSuccess, hipGetDeviceProperties(&prop, deviceId));
+    // a single transform already fills a quarter of tiny devices
+    if(prop.multiProcessorCount <= 4)
+        GTEST_SKIP();
+
+    EXPECT_GT(low_batch_kernel_count(1, rocfft_optimization_goal_throughput), 1u);
+    EXPECT_GT(low_batch_kernel_count(1, rocfft_optimization_goal_latency), 1u);
+    EXPECT_EQ(low_batch_kernel_count(1, rocfft_optimization_goal_memory), 1u);
+
+    const size_t full_batch = 64 * prop.multiProcessorCount;
+    EXPECT_EQ(low_batch_kernel_count(full_batch, rocfft_optimization_goal_throughput), 1u);
+    EXPECT_EQ(low_batch_kernel_count(full_batch, rocfft_optimization_goal_latency), 1u);
+
+    // frame windows are only applied by a single kernel, so a
+    // short-time FFT of a few long frames isn't split
+    const size_t frame = 4096;
+    gpubuf       window;
+    ASSERT_EQ(hipSuccess, window.alloc(frame * sizeof(float)));
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create_stft(
+                  &plan, rocfft_precision_single, frame, frame / 4, 2, window.data(), nullptr));
+    rocfft_plan_info info = {};
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+    EXPECT_EQ(info.kernel_count, 1u);
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+// A plan confined to one CU is sized for that CU, so a small batch
+// of a single-kernel length isn't split to occupy the whole device
+TEST(rocfft_UnitTest, plan_cu_mask)
+{
+    const uint32_t no_cus = 0;
+    const uint32_t one_cu = 1;
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_cu_mask(nullptr, 1, &one_cu));
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_cu_mask(desc, 1, &no_cus));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_cu_mask(desc, 1, &one_cu));
+
+    const size_t length = 4096;
+    rocfft_plan  plan   = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 desc));
+    rocfft_plan_info info = {};
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+    EXPECT_EQ(info.kernel_count, 1u);
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_execution_info_set_stream_priority(nullptr, -1));
+    rocfft_execution_info exec_info = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_create(&exec_info));
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_set_stream_priority(exec_info, -1));
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_destroy(exec_info));
+}
+
+// Measuring access modes still builds a plan when there is nowhere
+// to keep the measured solution, or nothing to measure
+TEST(rocfft_UnitTest, plan_measure_access_modes)
+{
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_measure_access_modes(nullptr, 1));
+
+    // large 1D uses SBCC and SBRC kernels, a small 1D does not
+    const std::vector<std::vector<size_t>> problems = {{8192 * 4}, {64}};
+    for(const auto& lengths : problems)
+    {
+        rocfft_plan_description desc = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_measure_access_modes(desc, 1));
+
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     lengths.size(),
+                                     lengths.data(),
+                                     1,
+                                     desc));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+    }
+}
+
+// Half-precision storage is only for single-precision C2C
+// transforms, and halves the bytes that kernels move
+TEST(rocfft_UnitTest, plan_storage_format)
+{
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_storage_format(nullptr, rocfft_storage_format_half));
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_storage_format(desc, rocfft_storage_format_half));
+
+    size_t      length = 4096;
+    rocfft_plan plan   = nullptr;
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_double,
+                                 1,
+                                 &length,
+                                 1,
+                                 desc));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_real_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 desc));
+
+    size_t bytes_moved[5] = {0, 0, 0, 0, 0};
+    for(auto storage : {rocfft_storage_format_native,
+                        rocfft_storage_format_half,
+                        rocfft_storage_format_bfloat16,
+                        rocfft_storage_format_fp8_e4m3,
+                        rocfft_storage_format_fp8_e5m2})
+    {
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_storage_format(desc, storage));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_inplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     1,
+                                     &length,
+                                     1,
+                                     desc));
+        rocfft_plan_info info;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+        bytes_moved[storage] = info.estimated_bytes_moved;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    }
+    EXPECT_LT(bytes_moved[rocfft_storage_format_half], bytes_moved[rocfft_storage_format_native]);
+    EXPECT_EQ(bytes_moved[rocfft_storage_format_bfloat16], bytes_moved[rocfft_storage_format_half]);
+    EXPECT_LT(bytes_moved[rocfft_storage_format_fp8_e4m3], bytes_moved[rocfft_storage_format_half]);
+    EXPECT_EQ(bytes_moved[rocfft_storage_format_fp8_e5m2],
+              bytes_moved[rocfft_storage_format_fp8_e4m3]);
+
+    // FP8 data is usually scaled into range by the caller
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_input_scale_factor(
+                  desc, std::numeric_limits<double>::quiet_NaN()));
+    EXPECT_EQ(rocfft_status_success, rocfft_plan_description_set_input_scale_factor(desc, 0.5));
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+// Exchanged data must be narrower than the plan's precision
+TEST(rocfft_UnitTest, plan_exchange_storage_format)
+{
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_exchange_storage_format(nullptr,
+                                                                  rocfft_storage_format_single));
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_exchange_storage_format(desc,
+                                                                  rocfft_storage_format_fp8_e4m3));
+
+    size_t length = 4096;
+    auto   create = [&](rocfft_storage_format storage, rocfft_precision precision) {
+        EXPECT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_exchange_storage_format(desc, storage));
+        rocfft_plan plan = nullptr;
+        auto        ret  = rocfft_plan_create(&plan,
+                                      rocfft_placement_inplace,
+                                      rocfft_transform_type_complex_forward,
+                                      precision,
+                                      1,
+                                      &length,
+                                      1,
+                                      desc);
+        if(ret == rocfft_status_success)
+            EXPECT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        return ret;
+    };
+    EXPECT_EQ(rocfft_status_success,
+              create(rocfft_storage_format_single, rocfft_precision_double));
+    EXPECT_EQ(rocfft_status_success, create(rocfft_storage_format_half, rocfft_precision_single));
+    EXPECT_EQ(rocfft_status_success,
+              create(rocfft_storage_format_bfloat16, rocfft_precision_single));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              create(rocfft_storage_format_single, rocfft_precision_single));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              create(rocfft_storage_format_half, rocfft_precision_double));
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+// Check device lists given to plan descriptions, and that a
+// transform distributed over every device matches the same
+// transform on the current device
+TEST(rocfft_UnitTest, plan_description_set_devices)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipSuccess, hipGetDeviceCount(&deviceCount));
+    std::vector<int> devices(deviceCount);
+    for(int i = 0; i < deviceCount; ++i)
+        devices[i] = i;
+
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_devices(nullptr, devices.data(), devices.size()));
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    const int negative = -1;
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_devices(desc, nullptr, 1));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_devices(desc, &negative, 1));
+
+    const std::vector<size_t> lengths = {256, 256};
+    auto                      create  = [&](rocfft_plan_description d, rocfft_plan* plan) {
+        return rocfft_plan_create(plan,
+                                  rocfft_placement_notinplace,
+                                  rocfft_transform_type_complex_forward,
+                                  rocfft_precision_single,
+                                  lengths.size(),
+                                  lengths.data(),
+                                  1,
+                                  d);
+    };
+
+    // devices that don't exist, or are listed twice, fail at plan
+    // creation
+    rocfft_plan plan = nullptr;
+    for(const auto& bad : {std::vector<int>{deviceCount}, std::vector<int>{0, 0}})
+    {
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_devices(desc, bad.data(), bad.size()));
+        EXPECT_EQ(rocfft_status_invalid_arg_value, create(desc, &plan));
+    }
+
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_devices(desc, devices.data(), devices.size()));
+    ASSERT_EQ(rocfft_status_success, create(desc, &plan));
+    rocfft_plan single_plan = nullptr;
+    ASSERT_EQ(rocfft_status_success, create(nullptr, &single_plan));
+
+    const size_t elems = lengths[0] * lengths[1];
+    const size_t bytes = elems * sizeof(rocfft_complex<float>);
+    std::vector<rocfft_complex<float>> host(elems);
+    for(size_t i = 0; i < host.size(); ++i)
+        host[i] = rocfft_complex<float>(i % 7, i % 3);
+
+    gpubuf in, out, single_out;
+    ASSERT_EQ(hipSuccess, in.alloc(bytes));
+    ASSERT_EQ(hipSuccess, out.alloc(bytes));
+    ASSERT_EQ(hipSuccess, single_out.alloc(bytes));
+    ASSERT_EQ(hipSuccess, hipMemcpy(in.data(), host.data(), bytes, hipMemcpyHostToDevice));
+
+    void* in_ptr         = in.data();
+    void* out_ptr        = out.data();
+    void* single_out_ptr = single_out.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_execute(single_plan, &in_ptr, &single_out_ptr, nullptr));
+    ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+    std::vector<rocfft_complex<float>> host_out(elems), host_single(elems);
+    ASSERT_EQ(hipSuccess, hipMemcpy(host_out.data(), out.data(), bytes, hipMemcpyDeviceToHost));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_single.data(), single_out.data(), bytes, hipMemcpyDeviceToHost));
+    for(size_t i = 0; i < elems; ++i)
+    {
+        ASSERT_NEAR(host_single[i].real(), host_out[i].real(), 1e-3 * elems);
+        ASSERT_NEAR(host_single[i].imag(), host_out[i].imag(), 1e-3 * elems);
+    }
+
+    EXPECT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    EXPECT_EQ(rocfft_status_success, rocfft_plan_destroy(single_plan));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+// Query plan info and check that it's consistent with other queries
+TEST(rocfft_UnitTest, plan_get_info)
+{
+    // prime length needs Bluestein, so has several kernels and a
+    // work buffer
+    size_t      length = 8191;
+    rocfft_plan plan   = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 nullptr));
+
+    rocfft_plan_info info;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+
+    size_t work_size = 0;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_get_work_buffer_size(plan, &work_size));
+    EXPECT_EQ(info.work_buffer_bytes, work_size);
+    EXPECT_GT(info.kernel_count, 1U);
+    EXPECT_LE(info.global_memory_passes, info.kernel_count);
+    EXPECT_GT(info.global_memory_passes, 0U);
+    // at least read + write the data once
+    EXPECT_GE(info.estimated_bytes_moved, 2 * length * sizeof(float) * 2);
+    EXPECT_GT(info.twiddle_bytes, 0U);
+
+    ASSERT_EQ(rocfft_status_invalid_arg_value, rocfft_plan_get_info(plan, nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+TEST(rocfft_UnitTest, plan_get_create_times)
+{
+    size_t      length = 4096;
+    rocfft_plan plan   = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_real_forward,
+                                 rocfft_precision_double,
+                                 1,
+                                 &length,
+                                 3,
+                                 nullptr));
+
+    rocfft_plan_create_times times;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_get_create_times(plan, &times));
+    EXPECT_GT(times.total_ms, 0.0);
+    for(double t : {times.solution_map_ms,
+                    times.build_tree_ms,
+                    times.fusion_ms,
+                    times.buffer_assignment_ms,
+                    times.kernel_generation_ms,
+                    times.rtc_cache_lookup_ms,
+                    times.rtc_compile_ms,
+                    times.module_load_ms,
+                    times.tables_ms})
+        EXPECT_GE(t, 0.0);
+    // phases that run on the creating thread fit in the total
+    EXPECT_LE(times.solution_map_ms + times.build_tree_ms + times.fusion_ms
+                  + times.buffer_assignment_ms + times.tables_ms,
+              times.total_ms);
+
+    ASSERT_EQ(rocfft_status_invalid_arg_value, rocfft_plan_get_create_times(plan, nullptr));
+    ASSERT_EQ(rocfft_status_invalid_arg_value, rocfft_plan_get_create_times(nullptr, &times));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+// Time kernels executed on a user stream, and collect the timings
+// without rocFFT synchronizing
+TEST(rocfft_UnitTest, execution_info_profile)
+{
+    // Bluestein runs several kernels
+    size_t      length = 8191;
+    rocfft_plan plan   = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 nullptr));
+
+    hipStream_t stream = nullptr;
+    ASSERT_EQ(hipSuccess, hipStreamCreate(&stream));
+    rocfft_execution_info info = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_create(&info));
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_set_stream(info, stream));
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_set_profile(info, 64));
+
+    gpubuf buf;
+    ASSERT_EQ(hipSuccess, buf.alloc(length * sizeof(rocfft_complex<float>)));
+    ASSERT_EQ(hipSuccess, hipMemset(buf.data(), 0, length * sizeof(rocfft_complex<float>)));
+    void* ptr = buf.data();
+    for(int i = 0; i < 2; ++i)
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &ptr, nullptr, info));
+    ASSERT_EQ(hipSuccess, hipStreamSynchronize(stream));
+
+    size_t count = 0;
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_get_profile(info, nullptr, &count));
+    ASSERT_GT(count, 0U);
+    ASSERT_EQ(count % 2, 0U);
+
+    std::vector<rocfft_kernel_profile> records(count);
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_execution_info_get_profile(info, records.data(), &count));
+    ASSERT_EQ(count, records.size());
+    for(size_t i = 0; i < count; ++i)
+    {
+        // timings are in launch order, half from each execution
+        EXPECT_EQ(records[i].execution_index, i < count / 2 ? 0U : 1U);
+        EXPECT_EQ(records[i].kernel_index, i % (count / 2));
+        EXPECT_GE(records[i].duration_ms, 0.0f);
+        EXPECT_GT(records[i].bytes_moved, 0U);
+    }
+
+    // collected timings are removed
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_get_profile(info, nullptr, &count));
+    EXPECT_EQ(count, 0U);
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_execution_info_get_profile(info, nullptr, nullptr));
+
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_destroy(info));
+    ASSERT_EQ(hipSuccess, hipStreamDestroy(stream));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+// A single-device plan is one FFT item, timed once per execution
+TEST(rocfft_UnitTest, execution_info_item_timing)
+{
+    size_t      length = 8191;
+    rocfft_plan plan   = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 nullptr));
+
+    rocfft_execution_info info = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_create(&info));
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_set_item_timing(info, 16));
+
+    gpubuf buf;
+    ASSERT_EQ(hipSuccess, buf.alloc(length * sizeof(rocfft_complex<float>)));
+    ASSERT_EQ(hipSuccess, hipMemset(buf.data(), 0, length * sizeof(rocfft_complex<float>)));
+    void* ptr = buf.data();
+    for(int i = 0; i < 2; ++i)
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &ptr, nullptr, info));
+
+    size_t count = 0;
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_get_item_times(info, nullptr, &count));
+    ASSERT_EQ(count, 2U);
+
+    std::vector<rocfft_plan_item_time> records(count);
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_execution_info_get_item_times(info, records.data(), &count));
+    ASSERT_EQ(count, 2U);
+    for(size_t i = 0; i < count; ++i)
+    {
+        EXPECT_EQ(records[i].execution_index, i);
+        EXPECT_EQ(records[i].item_index, records[0].item_index);
+        EXPECT_EQ(records[i].phase, rocfft_plan_item_phase_fft);
+        EXPECT_GT(records[i].duration_ms, 0.0);
+    }
+
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_get_item_times(info, nullptr, &count));
+    EXPECT_EQ(count, 0U);
+
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_destroy(info));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+TEST(rocfft_UnitTest, get_counters)
+{
+    size_t      length = 8191;
+    rocfft_plan plan   = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 nullptr));
+
+    rocfft_counters before;
+    ASSERT_EQ(rocfft_status_success, rocfft_get_counters(nullptr, &before));
+
+    rocfft_counters planCounters;
+    ASSERT_EQ(rocfft_status_success, rocfft_get_counters(plan, &planCounters));
+    EXPECT_EQ(planCounters.executions, 0U);
+    EXPECT_EQ(planCounters.kernels_launched, 0U);
+
+    gpubuf buf;
+    ASSERT_EQ(hipSuccess, buf.alloc(length * sizeof(rocfft_complex<float>)));
+    ASSERT_EQ(hipSuccess, hipMemset(buf.data(), 0, length * sizeof(rocfft_complex<float>)));
+    void* ptr = buf.data();
+    for(int i = 0; i < 2; ++i)
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &ptr, nullptr, nullptr));
+    ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+    ASSERT_EQ(rocfft_status_success, rocfft_get_counters(plan, &planCounters));
+    EXPECT_EQ(planCounters.executions, 2U);
+    // each execution launches the same kernels
+    EXPECT_GT(planCounters.kernels_launched, 0U);
+    EXPECT_EQ(planCounters.kernels_launched % 2, 0U);
+    EXPECT_GT(planCounters.bytes_moved, 0U);
+    // Bluestein needs a work buffer, and none was provided
+    EXPECT_EQ(planCounters.work_buffer_allocations, 2U);
+    EXPECT_EQ(planCounters.rtc_compiles, 0U);
+    EXPECT_EQ(planCounters.cache_hits, 0U);
+
+    rocfft_counters after;
+    ASSERT_EQ(rocfft_status_success, rocfft_get_counters(nullptr, &after));
+    EXPECT_GE(after.executions - before.executions, planCounters.executions);
+    EXPECT_GE(after.kernels_launched - before.kernels_launched, planCounters.kernels_launched);
+    EXPECT_GE(after.bytes_moved - before.bytes_moved, planCounters.bytes_moved);
+
+    ASSERT_EQ(rocfft_status_invalid_arg_value, rocfft_get_counters(plan, nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+// lengths made of larger primes have generated butterflies, so
+// should be done by Stockham kernels instead of Bluestein
+TEST(rocfft_UnitTest, plan_prime_radix)
+{
+    for(size_t length : {29, 61, 174})
+    {
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_double,
+                                     1,
+                                     &length,
+                                     1,
+                                     nullptr));
+
+        rocfft_plan_info info;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+        EXPECT_EQ(info.kernel_count, 1U) << "length " << length;
+        EXPECT_EQ(info.work_buffer_bytes, 0U) << "length " << length;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    }
+}
+
+// length-1 dimensions are dropped even when the other dimensions
+// can't be reordered, so they don't change the plan
+TEST(rocfft_UnitTest, plan_drop_length1_dims)
+{
+    auto kernel_count = [](std::vector<size_t> lengths,
+                           std::vector<size_t> istrides,
+                           std::vector<size_t> ostrides) {
+        rocfft_plan_description desc = nullptr;
+        EXPECT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+        EXPECT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_data_layout(desc,
+                                                          rocfft_array_type_complex_interleaved,
+                                                          rocfft_array_type_complex_interleaved,
+                                                          nullptr,
+                                                          nullptr,
+                                                          istrides.size(),
+                                                          istrides.data(),
+                                                          128,
+                                                          ostrides.size(),
+                                                          ostrides.data(),
+                                                          128));
+        rocfft_plan plan = nullptr;
+        EXPECT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     lengths.size(),
+                                     lengths.data(),
+                                     1,
+                                     desc));
+        rocfft_plan_info info = {};
+        EXPECT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+        EXPECT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        EXPECT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+        return info.kernel_count;
+    };
+
+    // transposed 2D, with and without trailing and leading length-1 dims
+    auto expected = kernel_count({8, 16}, {1, 8}, {16, 1});
+    EXPECT_EQ(kernel_count({8, 16, 1}, {1, 8, 128}, {16, 1, 128}), expected);
+    EXPECT_EQ(kernel_count({1, 8, 16}, {128, 1, 8}, {128, 16, 1}), expected);
+}
+
+// single-kernel Bluestein builds the FFT of its chirp at plan time,
+// so execution is one kernel that needs no work buffer
+TEST(rocfft_UnitTest, plan_bluestein_single_chirp)
+{
+    for(size_t length : {1021, 2039})
+    {
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_inplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     1,
+                                     &length,
+                                     1,
+                                     nullptr));
+
+        rocfft_plan_info info;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+        EXPECT_EQ(info.kernel_count, 1U) << "length " << length;
+        EXPECT_EQ(info.work_buffer_bytes, 0U) << "length " << length;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    }
+}
+
+// out-of-place odd-length real transforms that fit in one kernel
+// should read and write the user buffers directly, without copying
+// through a complex work buffer
+TEST(rocfft_UnitTest, plan_real_odd_single)
+{
+    for(auto type : {rocfft_transform_type_real_forward, rocfft_transform_type_real_inverse})
+    {
+        for(size_t length : {81, 125})
+        {
+            rocfft_plan plan = nullptr;
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_create(&plan,
+                                         rocfft_placement_notinplace,
+                                         type,
+                                         rocfft_precision_single,
+                                         1,
+                                         &length,
+                                         1,
+                                         nullptr));
+
+            rocfft_plan_info info;
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+            EXPECT_EQ(info.kernel_count, 1U) << "length " << length;
+            EXPECT_EQ(info.work_buffer_bytes, 0U) << "length " << length;
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        }
+    }
+}
+
+// batched odd-length R2C packs pairs of real inputs into one complex
+// FFT, so its work buffer only needs to hold half the batch
+TEST(rocfft_UnitTest, plan_real_pair)
+{
+    for(size_t length : {81, 125})
+    {
+        const size_t batch = 4;
+        rocfft_plan  plan  = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_inplace,
+                                     rocfft_transform_type_real_forward,
+                                     rocfft_precision_single,
+                                     1,
+                                     &length,
+                                     batch,
+                                     nullptr));
+
+        rocfft_plan_info info;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+        EXPECT_LE(info.work_buffer_bytes, length * batch / 2 * 2 * sizeof(float))
+            << "length " << length;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    }
+}
+
+// out-of-place real-to-complex Bluestein transforms should read and
+// write the user buffers from the fused Bluestein kernels, and launch
+// no more kernels than the complex transform of the same length
+TEST(rocfft_UnitTest, plan_real_bluestein_fused)
+{
+    auto get_info = [](rocfft_transform_type type, size_t length) {
+        rocfft_plan_info info = {};
+        rocfft_plan      plan = nullptr;
+        EXPECT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     type,
+                                     rocfft_precision_single,
+                                     1,
+                                     &length,
+                                     1,
+                                     nullptr));
+        EXPECT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+        EXPECT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        return info;
+    };
+
+    // prime, and too long for Rader or single-kernel Bluestein
+    size_t length  = 100043;
+    auto   real    = get_info(rocfft_transform_type_real_forward, length);
+    auto   complex = get_info(rocfft_transform_type_complex_forward, length);
+    EXPECT_EQ(real.kernel_count, complex.kernel_count);
+    EXPECT_LE(real.work_buffer_bytes, complex.work_buffer_bytes);
+}
+
+// small 3D C2C transforms fit into LDS, and should be done by a
+// single 3D_SINGLE kernel
+TEST(rocfft_UnitTest, plan_3D_single)
+{
+    std::vector<std::vector<size_t>> all_lengths = {{16, 16, 16}, {8, 8, 64}};
+    for(auto& lengths : all_lengths)
+    {
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_inplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     lengths.size(),
+                                     lengths.data(),
+                                     1,
+                                     nullptr));
+
+        rocfft_plan_info info;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+        EXPECT_EQ(info.kernel_count, 1U);
+        EXPECT_EQ(info.work_buffer_bytes, 0U);
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    }
+}
+
+// 1D lengths beyond 2^32 elements decompose into several passes
+// whose large twiddles need more than 4 table steps.  Only the plan
+// is built, since executing needs tens of GiB of device memory.
+TEST(rocfft_UnitTest, plan_large_1D_over_4G)
+{
+    for(size_t length : {static_cast<size_t>(1) << 33, static_cast<size_t>(1) << 35})
+    {
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     1,
+                                     &length,
+                                     1,
+                                     nullptr))
+            << "length " << length;
+
+        rocfft_plan_info info;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+        EXPECT_GE(info.kernel_count, 3U) << "length " << length;
+        EXPECT_GT(info.twiddle_bytes, 0U) << "length " << length;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    }
+}
+
+// Reload the solution map while other threads create plans
+TEST(rocfft_UnitTest, solution_map_reload)
+{
+    // a missing file keeps the current map
+    EXPECT_EQ(rocfft_solution_map_reload("no_such_solution_map.dat"), rocfft_status_failure);
+
+    std::atomic<bool>        done{false};
+    std::vector<std::thread> threads;
+    for(unsigned int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([&done]() {
+            size_t length = 256;
+            while(!done)
+            {
+                rocfft_plan plan = nullptr;
+                ASSERT_EQ(rocfft_status_success,
+                          rocfft_plan_create(&plan,
+                                             rocfft_placement_inplace,
+                                             rocfft_transform_type_complex_forward,
+                                             rocfft_precision_single,
+                                             1,
+                                             &length,
+                                             1,
+                                             nullptr));
+                ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+            }
+        });
+    }
+
+    // re-read the maps from the environment a few times
+    for(unsigned int i = 0; i < 8; ++i)
+        EXPECT_EQ(rocfft_solution_map_reload(nullptr), rocfft_status_success);
+
+    done = true;
+    for(auto& t : threads)
+        t.join();
+}
+
+// Create several plans asynchronously and wait for them
+TEST(rocfft_UnitTest, plan_create_async)
+{
+    static const size_t NUM_PLANS = 8;
+
+    std::vector<rocfft_plan> plans(NUM_PLANS, nullptr);
+    for(size_t i = 0; i < NUM_PLANS; ++i)
+    {
+        // lengths go out of scope before creation finishes
+        size_t length = 64 * (i + 1) + 1;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create_async(&plans[i],
+                                           rocfft_placement_inplace,
+                                           rocfft_transform_type_complex_forward,
+                                           rocfft_precision_single,
+                                           1,
+                                           &length,
+                                           1,
+                                           nullptr));
+    }
+
+    for(auto plan : plans)
+    {
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_wait(plan));
+        int ready = 0;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_is_ready(plan, &ready));
+        ASSERT_NE(ready, 0);
+        size_t work_size = 0;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_get_work_buffer_size(plan, &work_size));
+    }
+
+    for(auto plan : plans)
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+    // failed creation is reported by the wait - kernel arguments
+    // can't hold this many dimensions
+    rocfft_plan               bad_plan = nullptr;
+    const std::vector<size_t> bad_length(16, 2);
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create_async(&bad_plan,
+                                       rocfft_placement_inplace,
+                                       rocfft_transform_type_complex_forward,
+                                       rocfft_precision_single,
+                                       bad_length.size(),
+                                       bad_length.data(),
+                                       1,
+                                       nullptr));
+    ASSERT_EQ(rocfft_status_invalid_dimensions, rocfft_plan_wait(bad_plan));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(bad_plan));
+}
+
+// Plans whose tables are generated on a stream give the same
+// results as plans that waited for their tables
+TEST(rocfft_UnitTest, plan_table_stream)
+{
+    // include a large 1D and a Bluestein length, so that large
+    // twiddles and chirp tables are needed as well
+    const std::vector<size_t> lengths = {336, 1048576, 8191};
+
+    hipStream_t stream = nullptr;
+    ASSERT_EQ(hipSuccess, hipStreamCreate(&stream));
+
+    for(auto length : lengths)
+    {
+        const size_t                       bytes = length * sizeof(rocfft_complex<float>);
+        std::vector<rocfft_complex<float>> host(length);
+        for(size_t j = 0; j < host.size(); ++j)
+            host[j] = rocfft_complex<float>(j % 7, j % 3);
+
+        gpubuf in, out[2];
+        ASSERT_EQ(hipSuccess, in.alloc(bytes));
+        ASSERT_EQ(hipSuccess, out[0].alloc(bytes));
+        ASSERT_EQ(hipSuccess, out[1].alloc(bytes));
+        ASSERT_EQ(hipSuccess, hipMemcpy(in.data(), host.data(), bytes, hipMemcpyHostToDevice));
+
+        // create the stream plan first, so that it generates the
+        // tables the other plan reuses
+        rocfft_plan plans[2] = {nullptr, nullptr};
+        for(int use_stream = 1; use_stream >= 0; --use_stream)
+        {
+            rocfft_plan_description desc = nullptr;
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_description_set_table_stream(desc,
+                                                              use_stream ? stream : nullptr));
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_create(&plans[use_stream],
+                                         rocfft_placement_notinplace,
+                                         rocfft_transform_type_complex_forward,
+                                         rocfft_precision_single,
+                                         1,
+                                         &length,
+                                         1,
+                                         desc));
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+        }
+
+        // execute on the null stream, which has to wait for the
+        // tables being generated on the other stream
+        for(int i = 0; i < 2; ++i)
+        {
+            void* in_ptr  = in.data();
+            void* out_ptr = out[i].data();
+            ASSERT_EQ(rocfft_status_success, rocfft_execute(plans[i], &in_ptr, &out_ptr, nullptr));
+        }
+        ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+        for(auto plan : plans)
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+        std::vector<rocfft_complex<float>> host_wait(length), host_stream(length);
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_wait.data(), out[0].data(), bytes, hipMemcpyDeviceToHost));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_stream.data(), out[1].data(), bytes, hipMemcpyDeviceToHost));
+        ASSERT_EQ(0, memcmp(host_wait.data(), host_stream.data(), bytes));
+    }
+
+    ASSERT_EQ(hipSuccess, hipStreamDestroy(stream));
+}
+
+// Serialize a plan, create a new plan from the buffer, and check
+// that both plans produce the same results
+TEST(rocfft_UnitTest, plan_serialize)
+{
+    const std::vector<size_t> lengths = {64, 100};
+    const size_t              batch   = 3;
+
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_real_forward,
+                                 rocfft_precision_single,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 nullptr));
+
+    void*  buffer     = nullptr;
+    size_t buffer_len = 0;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_serialize(plan, &buffer, &buffer_len));
+    ASSERT_NE(nullptr, buffer);
+    ASSERT_GT(buffer_len, 0u);
+
+    rocfft_plan restored = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_deserialize(&restored, buffer, buffer_len));
+
+    // a modified buffer is rejected
+    std::vector<char> modified(static_cast<char*>(buffer), static_cast<char*>(buffer) + buffer_len);
+    modified.back() = modified.back() == ' ' ? '\n' : ' ';
+    rocfft_plan bad_plan = nullptr;
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_deserialize(&bad_plan, modified.data(), modified.size()));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_buffer_free(buffer));
+
+    size_t work_size = 0, restored_work_size = 0;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_get_work_buffer_size(plan, &work_size));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_get_work_buffer_size(restored, &restored_work_size));
+    ASSERT_EQ(work_size, restored_work_size);
+
+    const size_t       in_count  = lengths[0] * lengths[1] * batch;
+    const size_t       out_count = (lengths[0] / 2 + 1) * lengths[1] * batch;
+    std::vector<float> host_in(in_count);
+    for(size_t i = 0; i < in_count; ++i)
+        host_in[i] = static_cast<float>(i % 11) - 5.0f;
+
+    gpubuf in, out, restored_out;
+    ASSERT_EQ(hipSuccess, in.alloc(in_count * sizeof(float)));
+    ASSERT_EQ(hipSuccess, out.alloc(out_count * sizeof(rocfft_complex<float>)));
+    ASSERT_EQ(hipSuccess, restored_out.alloc(out_count * sizeof(rocfft_complex<float>)));
+    ASSERT_EQ(
+        hipSuccess,
+        hipMemcpy(in.data(), host_in.data(), in_count * sizeof(float), hipMemcpyHostToDevice));
+
+    void* in_ptr           = in.data();
+    void* out_ptr          = out.data();
+    void* restored_out_ptr = restored_out.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_execute(restored, &in_ptr, &restored_out_ptr, nullptr));
+    ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+    std::vector<rocfft_complex<float>> host_out(out_count), host_restored_out(out_count);
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_out.data(),
+                        out.data(),
+                        out_count * sizeof(rocfft_complex<float>),
+                        hipMemcpyDeviceToHost));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_restored_out.data(),
+                        restored_out.data(),
+                        out_count * sizeof(rocfft_complex<float>),
+                        hipMemcpyDeviceToHost));
+    ASSERT_EQ(0,
+              memcmp(host_out.data(),
+                     host_restored_out.data(),
+                     out_count * sizeof(rocfft_complex<float>)));
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(restored));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+TEST(rocfft_UnitTest, plan_serialize_cu_mask)
+{
+    const size_t   length = 256;
+    const uint32_t one_cu = 1;
+
+    // serialize a plan made from the description, or return an empty
+    // vector if the plan can't be serialized
+    auto serialize = [&](rocfft_plan_description desc) {
+        rocfft_plan plan = nullptr;
+        EXPECT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_inplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     1,
+                                     &length,
+                                     1,
+                                     desc));
+        std::vector<char> ret;
+        void*             buffer     = nullptr;
+        size_t            buffer_len = 0;
+        if(rocfft_plan_serialize(plan, &buffer, &buffer_len) == rocfft_status_success)
+        {
+            ret.assign(static_cast<char*>(buffer), static_cast<char*>(buffer) + buffer_len);
+            EXPECT_EQ(rocfft_status_success, rocfft_plan_buffer_free(buffer));
+        }
+        EXPECT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        return ret;
+    };
+
+    const auto unmasked = serialize(nullptr);
+    ASSERT_FALSE(unmasked.empty());
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_cu_mask(desc, 1, &one_cu));
+    const auto masked = serialize(desc);
+    ASSERT_FALSE(masked.empty());
+    ASSERT_NE(masked, unmasked);
+
+    // a plan restored from the buffer keeps the mask, so it
+    // serializes to the same buffer
+    rocfft_plan restored = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_deserialize(&restored, masked.data(), masked.size()));
+    void*  buffer     = nullptr;
+    size_t buffer_len = 0;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_serialize(restored, &buffer, &buffer_len));
+    const std::vector<char> reserialized(static_cast<char*>(buffer),
+                                         static_cast<char*>(buffer) + buffer_len);
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_buffer_free(buffer));
+    ASSERT_EQ(masked, reserialized);
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(restored));
+
+    // device IDs are specific to the process, so plans that name
+    // their devices are not serialized
+    const int device = 0;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_cu_mask(desc, 0, nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_devices(desc, &device, 1));
+    ASSERT_TRUE(serialize(desc).empty());
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+TEST(rocfft_UnitTest, grouped_plan)
+{
+    // repeated lengths share a kernel launch, and 10000 needs more
+    // than one kernel so it's executed per transform
+    const std::vector<size_t> lengths = {64, 100, 64, 10000, 100};
+    std::vector<size_t>       in_offsets, out_offsets;
+    size_t                    count = 0;
+    for(auto len : lengths)
+    {
+        // leave gaps between transforms, so offsets are not a
+        // multiple of any distance
+        in_offsets.push_back(count + 3);
+        out_offsets.push_back(count + 5);
+        count += len + 7;
+    }
+
+    rocfft_grouped_plan grouped = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_grouped_plan_create(&grouped,
+                                         rocfft_placement_notinplace,
+                                         rocfft_transform_type_complex_forward,
+                                         rocfft_precision_single,
+                                         lengths.size(),
+                                         lengths.data(),
+                                         in_offsets.data(),
+                                         out_offsets.data()));
+
+    std::vector<rocfft_complex<float>> host_in(count);
+    for(size_t i = 0; i < count; ++i)
+        host_in[i] = {static_cast<float>(i % 11) - 5.0f, static_cast<float>(i % 7) - 3.0f};
+
+    const size_t bytes = count * sizeof(rocfft_complex<float>);
+    gpubuf       in, out, expected_out;
+    ASSERT_EQ(hipSuccess, in.alloc(bytes));
+    ASSERT_EQ(hipSuccess, out.alloc(bytes));
+    ASSERT_EQ(hipSuccess, expected_out.alloc(bytes));
+    ASSERT_EQ(hipSuccess, hipMemcpy(in.data(), host_in.data(), bytes, hipMemcpyHostToDevice));
+    ASSERT_EQ(hipSuccess, hipMemset(out.data(), 0, bytes));
+    ASSERT_EQ(hipSuccess, hipMemset(expected_out.data(), 0, bytes));
+
+    void* in_ptr  = in.data();
+    void* out_ptr = out.data();
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_grouped_plan_execute(grouped, &in_ptr, &out_ptr, nullptr));
+
+    // compare with a plan for each transform
+    for(size_t i = 0; i < lengths.size(); ++i)
+    {
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     1,
+                                     &lengths[i],
+                                     1,
+                                     nullptr));
+        void* plan_in  = static_cast<rocfft_complex<float>*>(in.data()) + in_offsets[i];
+        void* plan_out = static_cast<rocfft_complex<float>*>(expected_out.data()) + out_offsets[i];
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &plan_in, &plan_out, nullptr));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    }
+    ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+    std::vector<rocfft_complex<float>> host_out(count), host_expected(count);
+    ASSERT_EQ(hipSuccess, hipMemcpy(host_out.data(), out.data(), bytes, hipMemcpyDeviceToHost));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_expected.data(), expected_out.data(), bytes, hipMemcpyDeviceToHost));
+    for(size_t i = 0; i < count; ++i)
+    {
+        ASSERT_NEAR(host_out[i].x, host_expected[i].x, 1e-3 * (1.0 + std::abs(host_expected[i].x)));
+        ASSERT_NEAR(host_out[i].y, host_expected[i].y, 1e-3 * (1.0 + std::abs(host_expected[i].y)));
+    }
+
+    ASSERT_EQ(rocfft_status_success, rocfft_grouped_plan_destroy(grouped));
+}
+
+// transform a contiguous array along one dimension on the host,
+// where dimension 0 is the fastest
+static void naive_dft_along(std::vector<std::complex<double>>& data,
+                            const std::vector<size_t>&         lengths,
+                            size_t                             dim,
+                            size_t                             batch)
+{
+    size_t stride = 1;
+    for(size_t i = 0; i < dim; ++i)
+        stride *= lengths[i];
+    const size_t len   = lengths[dim];
+    const size_t count = data.size() / batch;
+
+    std::vector<std::complex<double>> line(len);
+    for(size_t b = 0; b < batch; ++b)
+    {
+        for(size_t start = 0; start < count; ++start)
+        {
+            if((start / stride) % len != 0)
+                continue;
+            auto base = data.begin() + b * count + start;
+            for(size_t k = 0; k < len; ++k)
+            {
+                line[k] = 0.0;
+                for(size_t j = 0; j < len; ++j)
+                    line[k] += base[j * stride] * std::polar(1.0, -2.0 * M_PI * j * k / len);
+            }
+            for(size_t k = 0; k < len; ++k)
+                base[k * stride] = line[k];
+        }
+    }
+}
+
+TEST(rocfft_UnitTest, rank_4_transform)
+{
+    const std::vector<size_t> lengths = {4, 6, 8, 5};
+    const size_t              batch   = 2;
+    const size_t              count   = 4 * 6 * 8 * 5;
+
+    // higher dimensions of real transforms aren't implemented
+    rocfft_plan real_plan = nullptr;
+    ASSERT_EQ(rocfft_status_invalid_dimensions,
+              rocfft_plan_create(&real_plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_real_forward,
+                                 rocfft_precision_double,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 nullptr));
+    rocfft_plan_destroy(real_plan);
+
+    std::vector<std::complex<double>> expected(count * batch);
+    for(size_t i = 0; i < expected.size(); ++i)
+        expected[i] = {static_cast<double>(i % 11) - 5.0, static_cast<double>(i % 7) - 3.0};
+    const auto host_in = expected;
+    for(size_t dim = 0; dim < lengths.size(); ++dim)
+        naive_dft_along(expected, lengths, dim, batch);
+
+    // padding between input transforms stops the higher dimensions
+    // from folding into a batch of 3D transforms on the input, so
+    // the 3D transforms have to run last
+    for(size_t in_pad : {0, 3})
+    {
+        SCOPED_TRACE("input padding " + std::to_string(in_pad));
+
+        std::vector<size_t> strides = {1, 4, 24, 192};
+        const size_t        in_dist = count + in_pad;
+
+        rocfft_plan_description desc = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_data_layout(desc,
+                                                          rocfft_array_type_complex_interleaved,
+                                                          rocfft_array_type_complex_interleaved,
+                                                          nullptr,
+                                                          nullptr,
+                                                          strides.size(),
+                                                          strides.data(),
+                                                          in_dist,
+                                                          strides.size(),
+                                                          strides.data(),
+                                                          count));
+
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_double,
+                                     lengths.size(),
+                                     lengths.data(),
+                                     batch,
+                                     desc));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+        std::vector<std::complex<double>> padded_in(in_dist * batch);
+        for(size_t b = 0; b < batch; ++b)
+            std::copy_n(host_in.begin() + b * count, count, padded_in.begin() + b * in_dist);
+
+        const size_t in_bytes  = padded_in.size() * sizeof(std::complex<double>);
+        const size_t out_bytes = expected.size() * sizeof(std::complex<double>);
+        gpubuf       in, out;
+        ASSERT_EQ(hipSuccess, in.alloc(in_bytes));
+        ASSERT_EQ(hipSuccess, out.alloc(out_bytes));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(in.data(), padded_in.data(), in_bytes, hipMemcpyHostToDevice));
+
+        void* in_ptr  = in.data();
+        void* out_ptr = out.data();
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+        ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+        std::vector<std::complex<double>> host_out(expected.size());
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(), out.data(), out_bytes, hipMemcpyDeviceToHost));
+        for(size_t i = 0; i < expected.size(); ++i)
+        {
+            ASSERT_NEAR(host_out[i].real(), expected[i].real(), 1e-8 * count);
+            ASSERT_NEAR(host_out[i].imag(), expected[i].imag(), 1e-8 * count);
+        }
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    }
+}
+
+TEST(rocfft_UnitTest, split_plan)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipSuccess, hipGetDeviceCount(&deviceCount));
+    std::vector<int> devices;
+    for(int d = 0; d < std::min(deviceCount, 4); ++d)
+        devices.push_back(d);
+
+    const size_t length = 256;
+    const size_t batch  = 13;
+    const size_t count  = length * batch;
+
+    rocfft_split_plan split = nullptr;
+
+    // devices may not be listed twice, and need some weight
+    const std::vector<int> repeated = {0, 0};
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_split_plan_create(&split,
+                                       rocfft_placement_notinplace,
+                                       rocfft_transform_type_complex_forward,
+                                       rocfft_precision_single,
+                                       1,
+                                       &length,
+                                       batch,
+                                       nullptr,
+                                       repeated.data(),
+                                       repeated.size(),
+                                       nullptr));
+    const std::vector<double> no_weight(devices.size(), 0.0);
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_split_plan_create(&split,
+                                       rocfft_placement_notinplace,
+                                       rocfft_transform_type_complex_forward,
+                                       rocfft_precision_single,
+                                       1,
+                                       &length,
+                                       batch,
+                                       nullptr,
+                                       devices.data(),
+                                       devices.size(),
+                                       no_weight.data()));
+
+    std::vector<rocfft_complex<float>> host_in(count);
+    for(size_t i = 0; i < count; ++i)
+        host_in[i] = {static_cast<float>(i % 11) - 5.0f, static_cast<float>(i % 7) - 3.0f};
+
+    // reference result from an ordinary plan on the current device
+    const size_t bytes = count * sizeof(rocfft_complex<float>);
+    gpubuf       in, out;
+    ASSERT_EQ(hipSuccess, in.alloc(bytes));
+    ASSERT_EQ(hipSuccess, out.alloc(bytes));
+    ASSERT_EQ(hipSuccess, hipMemcpy(in.data(), host_in.data(), bytes, hipMemcpyHostToDevice));
+    void*       in_ptr  = in.data();
+    void*       out_ptr = out.data();
+    rocfft_plan plan    = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    std::vector<rocfft_complex<float>> expected(count);
+    ASSERT_EQ(hipSuccess, hipMemcpy(expected.data(), out.data(), bytes, hipMemcpyDeviceToHost));
+
+    auto check = [&](const std::vector<rocfft_complex<float>>& actual, size_t first, size_t n) {
+        for(size_t i = 0; i < n * length; ++i)
+        {
+            const auto& e = expected[first * length + i];
+            ASSERT_NEAR(actual[i].x, e.x, 1e-3 * (1.0 + std::abs(e.x)));
+            ASSERT_NEAR(actual[i].y, e.y, 1e-3 * (1.0 + std::abs(e.y)));
+        }
+    };
+
+    // estimated speeds, and deliberately uneven weights
+    std::vector<double> uneven(devices.size(), 1.0);
+    uneven.front() = 3.0;
+    for(const double* weights : {static_cast<const double*>(nullptr), uneven.data()})
+    {
+        SCOPED_TRACE(weights ? "uneven weights" : "estimated weights");
+
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_split_plan_create(&split,
+                                           rocfft_placement_notinplace,
+                                           rocfft_transform_type_complex_forward,
+                                           rocfft_precision_single,
+                                           1,
+                                           &length,
+                                           batch,
+                                           nullptr,
+                                           devices.data(),
+                                           devices.size(),
+                                           weights));
+
+        // shares must cover the batch in order
+        std::vector<size_t> first(devices.size()), num(devices.size());
+        size_t              next = 0;
+        for(size_t d = 0; d < devices.size(); ++d)
+        {
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_split_plan_get_share(split, d, &first[d], &num[d]));
+            ASSERT_EQ(first[d], next);
+            next += num[d];
+        }
+        ASSERT_EQ(next, batch);
+        size_t first_dummy = 0, num_dummy = 0;
+        ASSERT_EQ(rocfft_status_invalid_arg_value,
+                  rocfft_split_plan_get_share(split, devices.size(), &first_dummy, &num_dummy));
+
+        // whole batch on the current device, scattered and gathered
+        ASSERT_EQ(hipSuccess, hipMemset(out.data(), 0, bytes));
+        ASSERT_EQ(rocfft_status_success, rocfft_split_plan_execute(split, &in_ptr, &out_ptr));
+        std::vector<rocfft_complex<float>> host_out(count);
+        ASSERT_EQ(hipSuccess, hipMemcpy(host_out.data(), out.data(), bytes, hipMemcpyDeviceToHost));
+        check(host_out, 0, batch);
+
+        // each device's share already on that device
+        std::vector<gpubuf> local_in(devices.size()), local_out(devices.size());
+        std::vector<void*>  local_in_ptrs(devices.size()), local_out_ptrs(devices.size());
+        for(size_t d = 0; d < devices.size(); ++d)
+        {
+            if(!num[d])
+                continue;
+            ASSERT_EQ(hipSuccess, hipSetDevice(devices[d]));
+            const size_t share_bytes = num[d] * length * sizeof(rocfft_complex<float>);
+            ASSERT_EQ(hipSuccess, local_in[d].alloc(share_bytes));
+            ASSERT_EQ(hipSuccess, local_out[d].alloc(share_bytes));
+            ASSERT_EQ(hipSuccess,
+                      hipMemcpy(local_in[d].data(),
+                                host_in.data() + first[d] * length,
+                                share_bytes,
+                                hipMemcpyHostToDevice));
+            local_in_ptrs[d]  = local_in[d].data();
+            local_out_ptrs[d] = local_out[d].data();
+        }
+        ASSERT_EQ(hipSuccess, hipSetDevice(devices.front()));
+        ASSERT_EQ(
+            rocfft_status_success,
+            rocfft_split_plan_execute_local(split, local_in_ptrs.data(), local_out_ptrs.data()));
+        for(size_t d = 0; d < devices.size(); ++d)
+        {
+            if(!num[d])
+                continue;
+            std::vector<rocfft_complex<float>> share_out(num[d] * length);
+            ASSERT_EQ(hipSuccess,
+                      hipMemcpy(share_out.data(),
+                                local_out[d].data(),
+                                share_out.size() * sizeof(rocfft_complex<float>),
+                                hipMemcpyDeviceToHost));
+            check(share_out, first[d], num[d]);
+        }
+
+        ASSERT_EQ(rocfft_status_success, rocfft_split_plan_destroy(split));
+    }
+}
+
+// Split a batch with an output offset, whose shares must be gathered
+// without overwriting each other, and check that interleaved output
+// is rejected
+TEST(rocfft_UnitTest, split_plan_layouts)
+{
+    int deviceCount = 0;
+    ASSERT_EQ(hipSuccess, hipGetDeviceCount(&deviceCount));
+    if(deviceCount < 2)
+        GTEST_SKIP() << "needs at least two devices";
+    const std::vector<int> devices = {0, 1};
+
+    const size_t length        = 64;
+    const size_t batch         = 7;
+    const size_t offset        = 5;
+    const size_t count         = length * batch;
+    const size_t zero[2]       = {0, 0};
+    const size_t outOffsets[2] = {offset, 0};
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_data_layout(desc,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      zero,
+                                                      outOffsets,
+                                                      0,
+                                                      nullptr,
+                                                      0,
+                                                      0,
+                                                      nullptr,
+                                                      0));
+
+    std::vector<rocfft_complex<float>> host_in(count);
+    for(size_t i = 0; i < count; ++i)
+        host_in[i] = {static_cast<float>(i % 11) - 5.0f, static_cast<float>(i % 7) - 3.0f};
+    const size_t in_bytes  = count * sizeof(rocfft_complex<float>);
+    const size_t out_bytes = (count + offset) * sizeof(rocfft_complex<float>);
+    gpubuf       in, out;
+    ASSERT_EQ(hipSuccess, in.alloc(in_bytes));
+    ASSERT_EQ(hipSuccess, out.alloc(out_bytes));
+    void* in_ptr  = in.data();
+    void* out_ptr = out.data();
+
+    // run an ordinary plan and the split plan on the same layout,
+    // with the output's offset region filled with a sentinel
+    auto run = [&](auto execute) {
+        std::vector<rocfft_complex<float>> host_out(count + offset, {-7.0f, 3.0f});
+        EXPECT_EQ(hipSuccess,
+                  hipMemcpy(in.data(), host_in.data(), in_bytes, hipMemcpyHostToDevice));
+        EXPECT_EQ(hipSuccess,
+                  hipMemcpy(out.data(), host_out.data(), out_bytes, hipMemcpyHostToDevice));
+        execute();
+        EXPECT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(), out.data(), out_bytes, hipMemcpyDeviceToHost));
+        return host_out;
+    };
+
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc));
+    const auto expected = run([&]() {
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+    });
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+    rocfft_split_plan split = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_split_plan_create(&split,
+                                       rocfft_placement_notinplace,
+                                       rocfft_transform_type_complex_forward,
+                                       rocfft_precision_single,
+                                       1,
+                                       &length,
+                                       batch,
+                                       desc,
+                                       devices.data(),
+                                       devices.size(),
+                                       nullptr));
+    const auto actual = run([&]() {
+        ASSERT_EQ(rocfft_status_success, rocfft_split_plan_execute(split, &in_ptr, &out_ptr));
+    });
+    ASSERT_EQ(rocfft_status_success, rocfft_split_plan_destroy(split));
+    for(size_t i = 0; i < expected.size(); ++i)
+    {
+        ASSERT_NEAR(actual[i].x, expected[i].x, 1e-3 * (1.0 + std::abs(expected[i].x)));
+        ASSERT_NEAR(actual[i].y, expected[i].y, 1e-3 * (1.0 + std::abs(expected[i].y)));
+    }
+
+    // transforms interleaved with each other can't be gathered per
+    // device
+    const size_t interleaved_stride = batch;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_data_layout(desc,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      zero,
+                                                      zero,
+                                                      1,
+                                                      &interleaved_stride,
+                                                      1,
+                                                      1,
+                                                      &interleaved_stride,
+                                                      1));
+    const std::vector<double> even(devices.size(), 1.0);
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_split_plan_create(&split,
+                                       rocfft_placement_notinplace,
+                                       rocfft_transform_type_complex_forward,
+                                       rocfft_precision_single,
+                                       1,
+                                       &length,
+                                       batch,
+                                       desc,
+                                       devices.data(),
+                                       devices.size(),
+                                       even.data()));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+TEST(rocfft_UnitTest, nufft)
+{
+    const size_t modes_bad[] = {0};
+    rocfft_nufft_plan plan     = nullptr;
+    // half precision and zero modes are rejected
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_nufft_plan_create(&plan,
+                                       rocfft_nufft_type_1,
+                                       rocfft_transform_type_complex_forward,
+                                       rocfft_precision_half,
+                                       1,
+                                       modes_bad,
+                                       1,
+                                       1e-3));
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_nufft_plan_create(&plan,
+                                       rocfft_nufft_type_1,
+                                       rocfft_transform_type_complex_forward,
+                                       rocfft_precision_double,
+                                       1,
+                                       modes_bad,
+                                       1,
+                                       1e-3));
+
+    const std::vector<std::vector<size_t>> all_modes = {{24}, {12, 10}};
+    for(const auto& modes : all_modes)
+    {
+        for(auto type : {rocfft_nufft_type_1, rocfft_nufft_type_2})
+        {
+            const size_t dim        = modes.size();
+            const size_t batch      = 2;
+            const size_t num_points = 37 * dim;
+            size_t       num_modes  = 1;
+            for(auto N : modes)
+                num_modes *= N;
+
+            // points spread over [-pi, pi) without a pattern the grid
+            // could line up with
+            std::vector<double> coords(dim * num_points);
+            for(size_t i = 0; i < coords.size(); ++i)
+            {
+                double t  = i * 0.6180339887498949;
+                coords[i] = 2.0 * M_PI * (t - std::floor(t)) - M_PI;
+            }
+            std::vector<std::complex<double>> strengths(batch * num_points);
+            for(size_t i = 0; i < strengths.size(); ++i)
+                strengths[i] = {std::sin(0.37 * i + 0.1), std::cos(1.3 * i)};
+            std::vector<std::complex<double>> mode_data(batch * num_modes);
+            for(size_t i = 0; i < mode_data.size(); ++i)
+                mode_data[i] = {std::cos(0.81 * i), std::sin(0.23 * i + 0.4)};
+
+            // direct sums with the forward sign
+            const auto& in       = type == rocfft_nufft_type_1 ? strengths : mode_data;
+            auto        expected = type == rocfft_nufft_type_1 ? mode_data : strengths;
+            std::fill(expected.begin(), expected.end(), 0.0);
+            for(size_t t = 0; t < batch; ++t)
+            {
+                for(size_t j = 0; j < num_points; ++j)
+                {
+                    for(size_t m = 0; m < num_modes; ++m)
+                    {
+                        double phase = 0.0;
+                        size_t rem   = m;
+                        for(size_t d = 0; d < dim; ++d)
+                        {
+                            const double k = static_cast<double>(rem % modes[d])
+                                             - static_cast<double>(modes[d] / 2);
+                            rem /= modes[d];
+                            phase -= k * coords[d * num_points + j];
+                        }
+                        const std::complex<double> e = std::polar(1.0, phase);
+                        if(type == rocfft_nufft_type_1)
+                            expected[t * num_modes + m] += in[t * num_points + j] * e;
+                        else
+                            expected[t * num_points + j] += in[t * num_modes + m] * e;
+                    }
+                }
+            }
+
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_nufft_plan_create(&plan,
+                                               type,
+                                               rocfft_transform_type_complex_forward,
+                                               rocfft_precision_double,
+                                               dim,
+                                               modes.data(),
+                                               batch,
+                                               1e-6));
+
+            gpubuf coords_dev, strengths_dev, modes_dev;
+            ASSERT_EQ(hipSuccess, coords_dev.alloc(coords.size() * sizeof(double)));
+            ASSERT_EQ(hipSuccess,
+                      hipMemcpy(coords_dev.data(),
+                                coords.data(),
+                                coords_dev.size(),
+                                hipMemcpyHostToDevice));
+            std::vector<const void*> xyz(3, nullptr);
+            for(size_t d = 0; d < dim; ++d)
+                xyz[d] = coords_dev.data_offset(d * num_points * sizeof(double));
+
+            // execution needs points
+            ASSERT_EQ(hipSuccess,
+                      strengths_dev.alloc(strengths.size() * sizeof(std::complex<double>)));
+            ASSERT_EQ(hipSuccess, modes_dev.alloc(mode_data.size() * sizeof(std::complex<double>)));
+            ASSERT_EQ(rocfft_status_invalid_arg_value,
+                      rocfft_nufft_execute(plan, strengths_dev.data(), modes_dev.data(), nullptr));
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_nufft_plan_set_points(plan, num_points, xyz[0], xyz[1], xyz[2]));
+
+            auto& in_dev  = type == rocfft_nufft_type_1 ? strengths_dev : modes_dev;
+            auto& out_dev = type == rocfft_nufft_type_1 ? modes_dev : strengths_dev;
+            ASSERT_EQ(hipSuccess,
+                      hipMemcpy(in_dev.data(), in.data(), in_dev.size(), hipMemcpyHostToDevice));
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_nufft_execute(plan, strengths_dev.data(), modes_dev.data(), nullptr));
+            ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+            std::vector<std::complex<double>> actual(expected.size());
+            ASSERT_EQ(hipSuccess,
+                      hipMemcpy(actual.data(), out_dev.data(), out_dev.size(), hipMemcpyDeviceToHost));
+            double diff = 0.0, norm = 0.0;
+            for(size_t i = 0; i < actual.size(); ++i)
+            {
+                diff += std::norm(actual[i] - expected[i]);
+                norm += std::norm(expected[i]);
+            }
+            EXPECT_LT(std::sqrt(diff / norm), 1e-5) << "type " << type + 1 << ", " << dim << "D";
+
+            ASSERT_EQ(rocfft_status_success, rocfft_nufft_plan_destroy(plan));
+        }
+    }
+}
+
+TEST(rocfft_UnitTest, packed_hermitian)
+{
+    const std::vector<size_t> lengths = {16, 6, 4};
+    const size_t              batch   = 2;
+    const size_t              rows    = 6 * 4;
+    const size_t              count   = lengths[0] * rows;
+    const size_t              packed  = lengths[0] / 2;
+    const size_t              herm    = lengths[0] / 2 + 1;
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_packed_hermitian(desc, 1));
+
+    // packing needs an even length, and a real transform
+    rocfft_plan plan       = nullptr;
+    const auto  odd_length = std::vector<size_t>{15, 6, 4};
+    ASSERT_EQ(rocfft_status_invalid_dimensions,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_real_forward,
+                                 rocfft_precision_double,
+                                 odd_length.size(),
+                                 odd_length.data(),
+                                 batch,
+                                 desc));
+    rocfft_plan_destroy(plan);
+    plan = nullptr;
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_double,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 desc));
+    rocfft_plan_destroy(plan);
+    plan = nullptr;
+
+    std::vector<double> host_in(count * batch);
+    for(size_t i = 0; i < host_in.size(); ++i)
+        host_in[i] = static_cast<double>(i % 13) - 6.0;
+
+    // reference result from an ordinary out-of-place plan
+    const size_t in_bytes   = host_in.size() * sizeof(double);
+    const size_t herm_bytes = herm * rows * batch * sizeof(std::complex<double>);
+    gpubuf       in, out;
+    ASSERT_EQ(hipSuccess, in.alloc(in_bytes));
+    ASSERT_EQ(hipSuccess, out.alloc(herm_bytes));
+    ASSERT_EQ(hipSuccess, hipMemcpy(in.data(), host_in.data(), in_bytes, hipMemcpyHostToDevice));
+    void* in_ptr  = in.data();
+    void* out_ptr = out.data();
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_real_forward,
+                                 rocfft_precision_double,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    std::vector<std::complex<double>> expected(herm * rows * batch);
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(expected.data(), out.data(), herm_bytes, hipMemcpyDeviceToHost));
+
+    // in-place packed transforms need no padding
+    rocfft_plan forward = nullptr;
+    rocfft_plan inverse = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&forward,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_real_forward,
+                                 rocfft_precision_double,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&inverse,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_real_inverse,
+                                 rocfft_precision_double,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(forward, &in_ptr, nullptr, nullptr));
+    std::vector<std::complex<double>> host_packed(packed * rows * batch);
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_packed.data(), in.data(), in_bytes, hipMemcpyDeviceToHost));
+
+    // the first element of each row is X[0] + i*X[N/2]
+    for(size_t row = 0; row < rows * batch; ++row)
+    {
+        for(size_t k = 0; k < packed; ++k)
+        {
+            auto e = expected[row * herm + k];
+            if(k == 0)
+                e += std::complex<double>(0.0, 1.0) * expected[row * herm + packed];
+            const auto& actual = host_packed[row * packed + k];
+            ASSERT_NEAR(actual.real(), e.real(), 1e-8 * count);
+            ASSERT_NEAR(actual.imag(), e.imag(), 1e-8 * count);
+        }
+    }
+
+    // the inverse reads the same format, and transforms back to the
+    // (unnormalized) input
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(inverse, &in_ptr, nullptr, nullptr));
+    std::vector<double> host_out(host_in.size());
+    ASSERT_EQ(hipSuccess, hipMemcpy(host_out.data(), in.data(), in_bytes, hipMemcpyDeviceToHost));
+    for(size_t i = 0; i < host_in.size(); ++i)
+        ASSERT_NEAR(host_out[i], host_in[i] * count, 1e-8 * count);
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(forward));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(inverse));
+}
+
+// Execute several different plans in one call, and check that the
+// results match executing them individually
+TEST(rocfft_UnitTest, execute_batch)
+{
+    const std::vector<size_t> lengths = {64, 100, 4096};
+    const size_t              nplans  = lengths.size();
+
+    std::vector<rocfft_plan> plans(nplans, nullptr);
+    std::vector<gpubuf>      in(nplans), out_batch(nplans), out_rebatch(nplans), out_single(nplans);
+    std::vector<void*>       in_ptrs(nplans), out_batch_ptrs(nplans), out_rebatch_ptrs(nplans),
+        out_single_ptrs(nplans);
+    std::vector<void**>      in_arrays(nplans), out_arrays(nplans), out_rebatch_arrays(nplans);
+
+    for(size_t i = 0; i < nplans; ++i)
+    {
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plans[i],
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     1,
+                                     &lengths[i],
+                                     1,
+                                     nullptr));
+
+        const size_t                       bytes = lengths[i] * sizeof(rocfft_complex<float>);
+        std::vector<rocfft_complex<float>> host(lengths[i]);
+        for(size_t j = 0; j < host.size(); ++j)
+            host[j] = rocfft_complex<float>(j % 7, j % 3);
+
+        ASSERT_EQ(hipSuccess, in[i].alloc(bytes));
+        ASSERT_EQ(hipSuccess, out_batch[i].alloc(bytes));
+        ASSERT_EQ(hipSuccess, out_rebatch[i].alloc(bytes));
+        ASSERT_EQ(hipSuccess, out_single[i].alloc(bytes));
+        ASSERT_EQ(hipSuccess, hipMemcpy(in[i].data(), host.data(), bytes, hipMemcpyHostToDevice));
+
+        in_ptrs[i]            = in[i].data();
+        out_batch_ptrs[i]     = out_batch[i].data();
+        out_rebatch_ptrs[i]   = out_rebatch[i].data();
+        out_single_ptrs[i]    = out_single[i].data();
+        in_arrays[i]          = &in_ptrs[i];
+        out_arrays[i]         = &out_batch_ptrs[i];
+        out_rebatch_arrays[i] = &out_rebatch_ptrs[i];
+    }
+
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_execute_batch(
+                  plans.data(), in_arrays.data(), out_arrays.data(), nullptr, nplans));
+    // the same plans on other buffers reuse the batch's graph
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_execute_batch(
+                  plans.data(), in_arrays.data(), out_rebatch_arrays.data(), nullptr, nplans));
+    for(size_t i = 0; i < nplans; ++i)
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_execute(plans[i], &in_ptrs[i], &out_single_ptrs[i], nullptr));
+    ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+    for(size_t i = 0; i < nplans; ++i)
+    {
+        const size_t                       bytes = lengths[i] * sizeof(rocfft_complex<float>);
+        std::vector<rocfft_complex<float>> host_batch(lengths[i]), host_rebatch(lengths[i]),
+            host_single(lengths[i]);
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_batch.data(), out_batch[i].data(), bytes, hipMemcpyDeviceToHost));
+        ASSERT_EQ(
+            hipSuccess,
+            hipMemcpy(host_rebatch.data(), out_rebatch[i].data(), bytes, hipMemcpyDeviceToHost));
+        ASSERT_EQ(
+            hipSuccess,
+            hipMemcpy(host_single.data(), out_single[i].data(), bytes, hipMemcpyDeviceToHost));
+        ASSERT_EQ(0, memcmp(host_batch.data(), host_single.data(), bytes));
+        ASSERT_EQ(0, memcmp(host_rebatch.data(), host_single.data(), bytes));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plans[i]));
+    }
+
+    // null plans are rejected before anything is launched
+    rocfft_plan null_plan = nullptr;
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_execute_batch(&null_plan, in_arrays.data(), nullptr, nullptr, 1));
+}
+
+// Submit transforms to a persistent executor, and check that they
+// match executing the plan normally
+TEST(rocfft_UnitTest, persistent_executor)
+{
+    const size_t length  = 64;
+    const size_t batch   = 16;
+    const size_t entries = 8;
+    const size_t bytes   = length * batch * sizeof(rocfft_complex<float>);
+
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 nullptr));
+
+    std::vector<rocfft_complex<float>> host(length * batch);
+    for(size_t i = 0; i < host.size(); ++i)
+        host[i] = rocfft_complex<float>(i % 7, i % 3);
+
+    gpubuf in, out_single;
+    ASSERT_EQ(hipSuccess, in.alloc(bytes));
+    ASSERT_EQ(hipSuccess, out_single.alloc(bytes));
+    ASSERT_EQ(hipSuccess, hipMemcpy(in.data(), host.data(), bytes, hipMemcpyHostToDevice));
+
+    void* in_ptr         = in.data();
+    void* out_single_ptr = out_single.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_single_ptr, nullptr));
+    ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+    std::vector<rocfft_complex<float>> host_single(length * batch);
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_single.data(), out_single.data(), bytes, hipMemcpyDeviceToHost));
+
+    // a queue shorter than the number of entries, so that
+    // submission has to wait for slots to be reused
+    rocfft_persistent_executor executor = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_persistent_executor_create(&executor, plan, 4));
+
+    std::vector<gpubuf>             out(entries);
+    std::vector<unsigned long long> tickets(entries);
+    for(size_t e = 0; e < entries; ++e)
+    {
+        ASSERT_EQ(hipSuccess, out[e].alloc(bytes));
+        void* out_ptr = out[e].data();
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_persistent_executor_submit(executor, &in_ptr, &out_ptr, &tickets[e]));
+    }
+    for(auto ticket : tickets)
+        ASSERT_EQ(rocfft_status_success, rocfft_persistent_executor_wait(executor, ticket));
+
+    for(size_t e = 0; e < entries; ++e)
+    {
+        std::vector<rocfft_complex<float>> host_out(length * batch);
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(), out[e].data(), bytes, hipMemcpyDeviceToHost));
+        for(size_t i = 0; i < host_out.size(); ++i)
+        {
+            ASSERT_NEAR(host_single[i].real(), host_out[i].real(), 1e-3 * length);
+            ASSERT_NEAR(host_single[i].imag(), host_out[i].imag(), 1e-3 * length);
+        }
+    }
+
+    ASSERT_EQ(rocfft_status_success, rocfft_persistent_executor_destroy(executor));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+// Execute a real-inverse transform whose input batches overlap,
+// and check that the input is left alone and each batch matches
+// transforming a contiguous copy of its input
+TEST(rocfft_UnitTest, execute_overlapping_input)
+{
+    const size_t length    = 64;
+    const size_t cmplx_len = length / 2 + 1;
+    const size_t batch     = 8;
+    const size_t idist     = 16;
+    const size_t in_elems  = (batch - 1) * idist + cmplx_len;
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    const size_t odist = length;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_data_layout(desc,
+                                                      rocfft_array_type_hermitian_interleaved,
+                                                      rocfft_array_type_real,
+                                                      nullptr,
+                                                      nullptr,
+                                                      0,
+                                                      nullptr,
+                                                      idist,
+                                                      0,
+                                                      nullptr,
+                                                      odist));
+
+    // in-place transforms would overwrite input that other batches
+    // still read
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_real_inverse,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc));
+
+    rocfft_plan plan_single = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_real_inverse,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan_single,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_real_inverse,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+    // keep the DC terms real, so each window is a valid spectrum
+    std::vector<rocfft_complex<float>> host_in(in_elems);
+    for(size_t i = 0; i < in_elems; ++i)
+        host_in[i] = rocfft_complex<float>(i % 7, i % idist == 0 ? 0.0f : i % 5);
+
+    const size_t in_bytes  = in_elems * sizeof(rocfft_complex<float>);
+    const size_t out_bytes = batch * length * sizeof(float);
+    gpubuf       in, out, in_single, out_single;
+    ASSERT_EQ(hipSuccess, in.alloc(in_bytes));
+    ASSERT_EQ(hipSuccess, out.alloc(out_bytes));
+    ASSERT_EQ(hipSuccess, in_single.alloc(cmplx_len * sizeof(rocfft_complex<float>)));
+    ASSERT_EQ(hipSuccess, out_single.alloc(length * sizeof(float)));
+    ASSERT_EQ(hipSuccess, hipMemcpy(in.data(), host_in.data(), in_bytes, hipMemcpyHostToDevice));
+
+    void* in_ptr  = in.data();
+    void* out_ptr = out.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+    ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+    std::vector<rocfft_complex<float>> host_in_after(in_elems);
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_in_after.data(), in.data(), in_bytes, hipMemcpyDeviceToHost));
+    ASSERT_EQ(0, memcmp(host_in.data(), host_in_after.data(), in_bytes));
+
+    std::vector<float> host_out(batch * length);
+    ASSERT_EQ(hipSuccess, hipMemcpy(host_out.data(), out.data(), out_bytes, hipMemcpyDeviceToHost));
+
+    std::vector<float> host_single(length);
+    for(size_t b = 0; b < batch; ++b)
+    {
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(in_single.data(),
+                            host_in.data() + b * idist,
+                            cmplx_len * sizeof(rocfft_complex<float>),
+                            hipMemcpyHostToDevice));
+        void* in_single_ptr  = in_single.data();
+        void* out_single_ptr = out_single.data();
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_execute(plan_single, &in_single_ptr, &out_single_ptr, nullptr));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_single.data(),
+                            out_single.data(),
+                            length * sizeof(float),
+                            hipMemcpyDeviceToHost));
+        for(size_t i = 0; i < length; ++i)
+            ASSERT_NEAR(host_single[i], host_out[b * length + i], 1e-3 * length);
+    }
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_single));
+}
+
+// Execute a tiled batch, and check that the results match
+// transforming the same data laid out one transform after another
+TEST(rocfft_UnitTest, execute_batch_tile)
+{
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    ASSERT_EQ(rocfft_status_invalid_arg_value, rocfft_plan_description_set_batch_tile(desc, 0));
+    ASSERT_EQ(rocfft_status_invalid_arg_value, rocfft_plan_description_set_batch_tile(nullptr, 8));
+
+    const size_t              tile    = 8;
+    const size_t              batch   = 2 * tile;
+    const std::vector<size_t> lengths = {32, 16};
+    const size_t              count   = lengths[0] * lengths[1];
+    const size_t              bytes   = count * batch * sizeof(rocfft_complex<float>);
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_batch_tile(desc, tile));
+
+    // the batch must be made of whole tiles
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch + 1,
+                                 desc));
+
+    rocfft_plan plan_tiled = nullptr, plan_plain = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan_tiled,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan_plain,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+    // element i of transform b is at b * count + i in the plain
+    // layout, and at (b / tile) * count * tile + i * tile + b % tile
+    // in the tiled one
+    auto tiled_index = [&](size_t b, size_t i) {
+        return (b / tile) * count * tile + i * tile + b % tile;
+    };
+    std::vector<rocfft_complex<float>> host_plain(count * batch), host_tiled(count * batch);
+    for(size_t b = 0; b < batch; ++b)
+    {
+        for(size_t i = 0; i < count; ++i)
+        {
+            host_plain[b * count + i]     = rocfft_complex<float>((b + i) % 7, (b * i) % 5);
+            host_tiled[tiled_index(b, i)] = host_plain[b * count + i];
+        }
+    }
+
+    gpubuf in_plain, in_tiled, out_plain, out_tiled;
+    ASSERT_EQ(hipSuccess, in_plain.alloc(bytes));
+    ASSERT_EQ(hipSuccess, in_tiled.alloc(bytes));
+    ASSERT_EQ(hipSuccess, out_plain.alloc(bytes));
+    ASSERT_EQ(hipSuccess, out_tiled.alloc(bytes));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(in_plain.data(), host_plain.data(), bytes, hipMemcpyHostToDevice));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(in_tiled.data(), host_tiled.data(), bytes, hipMemcpyHostToDevice));
+
+    std::vector<void*> in_ptrs  = {in_plain.data(), in_tiled.data()};
+    std::vector<void*> out_ptrs = {out_plain.data(), out_tiled.data()};
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_execute(plan_plain, &in_ptrs[0], &out_ptrs[0], nullptr));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_execute(plan_tiled, &in_ptrs[1], &out_ptrs[1], nullptr));
+    ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_plain.data(), out_plain.data(), bytes, hipMemcpyDeviceToHost));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_tiled.data(), out_tiled.data(), bytes, hipMemcpyDeviceToHost));
+    for(size_t b = 0; b < batch; ++b)
+    {
+        for(size_t i = 0; i < count; ++i)
+        {
+            const auto expected = host_plain[b * count + i];
+            const auto actual   = host_tiled[tiled_index(b, i)];
+            ASSERT_NEAR(expected.real(), actual.real(), 1e-3 * count);
+            ASSERT_NEAR(expected.imag(), actual.imag(), 1e-3 * count);
+        }
+    }
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_tiled));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_plain));
+}
+
+// Execute fewer transforms than a plan was created for, and compare
+// with a plan created for that batch
+TEST(rocfft_UnitTest, execute_smaller_batch)
+{
+    ASSERT_EQ(rocfft_status_invalid_arg_value, rocfft_execution_info_set_batch(nullptr, 2));
+
+    // 1D, 2D and a large 1D that decomposes into several kernels
+    const std::vector<std::vector<size_t>> problems = {{64}, {32, 16}, {8192 * 4}};
+    const size_t                           batch    = 5;
+    const size_t                           executed = 3;
+
+    for(const auto& lengths : problems)
+    {
+        size_t count = 1;
+        for(auto len : lengths)
+            count *= len;
+        const size_t bytes = count * batch * sizeof(rocfft_complex<float>);
+
+        rocfft_plan plan_full = nullptr, plan_small = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan_full,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     lengths.size(),
+                                     lengths.data(),
+                                     batch,
+                                     nullptr));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan_small,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     lengths.size(),
+                                     lengths.data(),
+                                     executed,
+                                     nullptr));
+
+        std::vector<rocfft_complex<float>> host_in(count * batch);
+        for(size_t i = 0; i < host_in.size(); ++i)
+            host_in[i] = rocfft_complex<float>(i % 7, i % 5);
+
+        // transforms past the executed batch must not be written
+        const rocfft_complex<float>        sentinel(-1.0f, -1.0f);
+        std::vector<rocfft_complex<float>> host_full(count * batch, sentinel);
+        std::vector<rocfft_complex<float>> host_small(count * batch);
+
+        gpubuf in, out_full, out_small;
+        ASSERT_EQ(hipSuccess, in.alloc(bytes));
+        ASSERT_EQ(hipSuccess, out_full.alloc(bytes));
+        ASSERT_EQ(hipSuccess, out_small.alloc(bytes));
+        ASSERT_EQ(hipSuccess, hipMemcpy(in.data(), host_in.data(), bytes, hipMemcpyHostToDevice));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(out_full.data(), host_full.data(), bytes, hipMemcpyHostToDevice));
+
+        rocfft_execution_info info = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_execution_info_create(&info));
+
+        void* in_ptr        = in.data();
+        void* out_full_ptr  = out_full.data();
+        void* out_small_ptr = out_small.data();
+
+        // more transforms than the plan has can't be executed
+        ASSERT_EQ(rocfft_status_success, rocfft_execution_info_set_batch(info, batch + 1));
+        ASSERT_EQ(rocfft_status_invalid_arg_value,
+                  rocfft_execute(plan_full, &in_ptr, &out_full_ptr, info));
+
+        ASSERT_EQ(rocfft_status_success, rocfft_execution_info_set_batch(info, executed));
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan_full, &in_ptr, &out_full_ptr, info));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_execute(plan_small, &in_ptr, &out_small_ptr, nullptr));
+        ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_full.data(), out_full.data(), bytes, hipMemcpyDeviceToHost));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_small.data(), out_small.data(), bytes, hipMemcpyDeviceToHost));
+        for(size_t i = 0; i < count * executed; ++i)
+        {
+            ASSERT_NEAR(host_small[i].real(), host_full[i].real(), 1e-3 * count);
+            ASSERT_NEAR(host_small[i].imag(), host_full[i].imag(), 1e-3 * count);
+        }
+        for(size_t i = count * executed; i < count * batch; ++i)
+        {
+            ASSERT_EQ(sentinel.real(), host_full[i].real());
+            ASSERT_EQ(sentinel.imag(), host_full[i].imag());
+        }
+
+        ASSERT_EQ(rocfft_status_success, rocfft_execution_info_destroy(info));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_small));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_full));
+    }
+}
+
+// Execute a batch whose transforms are in separate buffers, and
+// compare with executing the same batch in one contiguous buffer
+TEST(rocfft_UnitTest, execute_pointer_array)
+{
+    const size_t length = 64;
+    const size_t batch  = 4;
+    const size_t bytes  = length * sizeof(rocfft_complex<float>);
+
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 nullptr));
+
+    std::vector<rocfft_complex<float>> host_in(length * batch);
+    for(size_t i = 0; i < host_in.size(); ++i)
+        host_in[i] = rocfft_complex<float>(i % 7, i % 5);
+
+    // reference: the whole batch in one buffer
+    gpubuf in, out;
+    ASSERT_EQ(hipSuccess, in.alloc(bytes * batch));
+    ASSERT_EQ(hipSuccess, out.alloc(bytes * batch));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(in.data(), host_in.data(), bytes * batch, hipMemcpyHostToDevice));
+    void* in_ptr  = in.data();
+    void* out_ptr = out.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+
+    // each transform in a buffer of its own
+    std::vector<gpubuf> ins(batch), outs(batch);
+    std::vector<void*>  in_ptrs(batch), out_ptrs(batch);
+    for(size_t b = 0; b < batch; ++b)
+    {
+        ASSERT_EQ(hipSuccess, ins[b].alloc(bytes));
+        ASSERT_EQ(hipSuccess, outs[b].alloc(bytes));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(
+                      ins[b].data(), host_in.data() + b * length, bytes, hipMemcpyHostToDevice));
+        in_ptrs[b]  = ins[b].data();
+        out_ptrs[b] = outs[b].data();
+    }
+    gpubuf in_table, out_table;
+    ASSERT_EQ(hipSuccess, in_table.alloc(batch * sizeof(void*)));
+    ASSERT_EQ(hipSuccess, out_table.alloc(batch * sizeof(void*)));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(
+                  in_table.data(), in_ptrs.data(), batch * sizeof(void*), hipMemcpyHostToDevice));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(out_table.data(),
+                        out_ptrs.data(),
+                        batch * sizeof(void*),
+                        hipMemcpyHostToDevice));
+
+    auto in_array  = static_cast<void* const*>(in_table.data());
+    auto out_array = static_cast<void* const*>(out_table.data());
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_execute_pointer_array(plan, nullptr, out_array, nullptr));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_execute_pointer_array(plan, in_array, out_array, nullptr));
+    ASSERT_EQ(hipSuccess, hipDeviceSynchronize());
+
+    std::vector<rocfft_complex<float>> host_ref(length * batch);
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_ref.data(), out.data(), bytes * batch, hipMemcpyDeviceToHost));
+    for(size_t b = 0; b < batch; ++b)
+    {
+        std::vector<rocfft_complex<float>> host_out(length);
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(), outs[b].data(), bytes, hipMemcpyDeviceToHost));
+        for(size_t i = 0; i < length; ++i)
+        {
+            ASSERT_NEAR(host_ref[b * length + i].real(), host_out[i].real(), 1e-3 * length);
+            ASSERT_NEAR(host_ref[b * length + i].imag(), host_out[i].imag(), 1e-3 * length);
+        }
+    }
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+    // plans that need more than one kernel aren't supported
+    const size_t large = 8192 * 4;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &large,
+                                 batch,
+                                 nullptr));
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_execute_pointer_array(plan, in_array, out_array, nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+// Execute a batch from host memory in chunks, and compare with
+// executing the whole batch on the device
+TEST(rocfft_UnitTest, execute_out_of_core)
+{
+    // force a remainder chunk
+    EnvironmentSetTemp chunk_env("ROCFFT_OUT_OF_CORE_CHUNK", "3");
+
+    const std::vector<size_t> lengths = {32, 16};
+    const size_t              batch   = 7;
+    const size_t              elems   = lengths[0] * lengths[1] * batch;
+    const size_t              bytes   = elems * sizeof(rocfft_complex<float>);
+
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 nullptr));
+
+    std::vector<rocfft_complex<float>> host_in(elems), host_ooc(elems), host_dev(elems);
+    for(size_t i = 0; i < elems; ++i)
+        host_in[i] = rocfft_complex<float>(i % 11, i % 5);
+
+    void* ooc_in  = host_in.data();
+    void* ooc_out = host_ooc.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute_out_of_core(plan, &ooc_in, &ooc_out, nullptr));
+
+    gpubuf dev_in, dev_out;
+    ASSERT_EQ(hipSuccess, dev_in.alloc(bytes));
+    ASSERT_EQ(hipSuccess, dev_out.alloc(bytes));
+    ASSERT_EQ(hipSuccess, hipMemcpy(dev_in.data(), host_in.data(), bytes, hipMemcpyHostToDevice));
+    void* dev_in_ptr  = dev_in.data();
+    void* dev_out_ptr = dev_out.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_dev.data(), dev_out.data(), bytes, hipMemcpyDeviceToHost));
+
+    // chunk plans may pick different kernels, so allow for rounding
+    for(size_t i = 0; i < elems; ++i)
+    {
+        ASSERT_NEAR(host_ooc[i].real(), host_dev[i].real(), 1e-2);
+        ASSERT_NEAR(host_ooc[i].imag(), host_dev[i].imag(), 1e-2);
+    }
+
+    // out-of-core execution allocates its own work buffers
+    rocfft_execution_info info = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_create(&info));
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_set_work_buffer(info, dev_in_ptr, bytes));
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_execute_out_of_core(plan, &ooc_in, &ooc_out, info));
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_destroy(info));
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+// Execute out of core with an output offset, and check that each
+// chunk only writes its own transforms.  Interleaved output can't be
+// copied back chunk by chunk, so it's rejected.
+TEST(rocfft_UnitTest, execute_out_of_core_layouts)
+{
+    EnvironmentSetTemp chunk_env("ROCFFT_OUT_OF_CORE_CHUNK", "3");
+
+    const size_t length     = 64;
+    const size_t batch      = 7;
+    const size_t in_elems   = length * batch;
+    const size_t out_offset = 5;
+    const size_t out_elems  = out_offset + length * batch;
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    const size_t in_offsets[2]  = {0, 0};
+    const size_t out_offsets[2] = {out_offset, 0};
+    const size_t unit_stride    = 1;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_data_layout(desc,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      in_offsets,
+                                                      out_offsets,
+                                                      1,
+                                                      &unit_stride,
+                                                      length,
+                                                      1,
+                                                      &unit_stride,
+                                                      length));
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc));
+
+    std::vector<rocfft_complex<float>> host_in(in_elems);
+    for(size_t i = 0; i < in_elems; ++i)
+        host_in[i] = rocfft_complex<float>(i % 11, i % 5);
+    // the offset region must be left alone
+    const rocfft_complex<float>        sentinel(-7.0f, 3.0f);
+    std::vector<rocfft_complex<float>> host_ooc(out_elems, sentinel), host_dev(out_elems, sentinel);
+
+    void* ooc_in  = host_in.data();
+    void* ooc_out = host_ooc.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute_out_of_core(plan, &ooc_in, &ooc_out, nullptr));
+
+    const size_t in_bytes  = in_elems * sizeof(rocfft_complex<float>);
+    const size_t out_bytes = out_elems * sizeof(rocfft_complex<float>);
+    gpubuf       dev_in, dev_out;
+    ASSERT_EQ(hipSuccess, dev_in.alloc(in_bytes));
+    ASSERT_EQ(hipSuccess, dev_out.alloc(out_bytes));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(dev_in.data(), host_in.data(), in_bytes, hipMemcpyHostToDevice));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(dev_out.data(), host_dev.data(), out_bytes, hipMemcpyHostToDevice));
+    void* dev_in_ptr  = dev_in.data();
+    void* dev_out_ptr = dev_out.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_dev.data(), dev_out.data(), out_bytes, hipMemcpyDeviceToHost));
+
+    for(size_t i = 0; i < out_elems; ++i)
+    {
+        ASSERT_NEAR(host_ooc[i].real(), host_dev[i].real(), 1e-2);
+        ASSERT_NEAR(host_ooc[i].imag(), host_dev[i].imag(), 1e-2);
+    }
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+    // transform b's elements are at b + k * batch
+    const size_t interleaved_stride = batch;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_data_layout(desc,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      in_offsets,
+                                                      in_offsets,
+                                                      1,
+                                                      &interleaved_stride,
+                                                      1,
+                                                      1,
+                                                      &interleaved_stride,
+                                                      1));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc));
+    // devices that share memory with the host transform the buffers
+    // in place, without chunks
+    int deviceId   = 0;
+    int integrated = 0;
+    ASSERT_EQ(hipSuccess, hipGetDevice(&deviceId));
+    ASSERT_EQ(hipSuccess,
+              hipDeviceGetAttribute(&integrated, hipDeviceAttributeIntegrated, deviceId));
+    if(!integrated)
+        ASSERT_EQ(rocfft_status_invalid_arg_value,
+                  rocfft_execute_out_of_core(plan, &ooc_in, &ooc_out, nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+// Execute a 3D transform with its XY passes run slab by slab, and
+// compare with running each pass on the whole volume
+TEST(rocfft_UnitTest, execute_slabs)
+{
+    const std::vector<size_t> lengths = {128, 128, 128};
+    const size_t              batch   = 2;
+    const size_t              elems   = lengths[0] * lengths[1] * lengths[2] * batch;
+    const size_t              bytes   = elems * sizeof(rocfft_complex<float>);
+
+    auto create_plan = [&](const char* cache_bytes) {
+        EnvironmentSetTemp slab_env("ROCFFT_SLAB_CACHE_BYTES", cache_bytes);
+        rocfft_plan        plan = nullptr;
+        EXPECT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     lengths.size(),
+                                     lengths.data(),
+                                     batch,
+                                     nullptr));
+        return plan;
+    };
+    // slabs of 32 planes, or none
+    rocfft_plan plan_slabs = create_plan("8388608");
+    rocfft_plan plan_whole = create_plan("0");
+    ASSERT_NE(plan_slabs, nullptr);
+    ASSERT_NE(plan_whole, nullptr);
+
+    std::vector<rocfft_complex<float>> host_in(elems), host_slabs(elems), host_whole(elems);
+    for(size_t i = 0; i < elems; ++i)
+        host_in[i] = rocfft_complex<float>(i % 13, i % 7);
+
+    gpubuf dev_in, dev_out;
+    ASSERT_EQ(hipSuccess, dev_in.alloc(bytes));
+    ASSERT_EQ(hipSuccess, dev_out.alloc(bytes));
+    void* in_ptr  = dev_in.data();
+    void* out_ptr = dev_out.data();
+
+    auto run = [&](rocfft_plan plan, std::vector<rocfft_complex<float>>& host_out) {
+        ASSERT_EQ(hipSuccess, hipMemcpy(in_ptr, host_in.data(), bytes, hipMemcpyHostToDevice));
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+        ASSERT_EQ(hipSuccess, hipMemcpy(host_out.data(), out_ptr, bytes, hipMemcpyDeviceToHost));
+    };
+    run(plan_slabs, host_slabs);
+    run(plan_whole, host_whole);
+
+    // both plans run the same kernels, so results match exactly
+    for(size_t i = 0; i < elems; ++i)
+    {
+        ASSERT_EQ(host_slabs[i].real(), host_whole[i].real());
+        ASSERT_EQ(host_slabs[i].imag(), host_whole[i].imag());
+    }
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_whole));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_slabs));
+}
+
+// Execute an in-place plan created for host buffers on pageable
+// memory, and compare with executing the batch on the device
+TEST(rocfft_UnitTest, execute_host_buffers)
+{
+    const std::vector<size_t> lengths = {64};
+    const size_t              batch   = 9;
+    const size_t              elems   = lengths[0] * batch;
+    const size_t              bytes   = elems * sizeof(rocfft_complex<float>);
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_host_buffers(desc, 1));
+
+    rocfft_plan plan_host = nullptr;
+    rocfft_plan plan_dev  = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan_host,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan_dev,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 lengths.size(),
+                                 lengths.data(),
+                                 batch,
+                                 nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+    std::vector<rocfft_complex<float>> host_data(elems), host_dev(elems);
+    for(size_t i = 0; i < elems; ++i)
+        host_data[i] = rocfft_complex<float>(i % 7, i % 3);
+
+    gpubuf dev_data;
+    ASSERT_EQ(hipSuccess, dev_data.alloc(bytes));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(dev_data.data(), host_data.data(), bytes, hipMemcpyHostToDevice));
+    void* dev_ptr = dev_data.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan_dev, &dev_ptr, nullptr, nullptr));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_dev.data(), dev_data.data(), bytes, hipMemcpyDeviceToHost));
+
+    void* host_ptr = host_data.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan_host, &host_ptr, nullptr, nullptr));
+
+    // chunk plans may pick different kernels, so allow for rounding
+    for(size_t i = 0; i < elems; ++i)
+    {
+        ASSERT_NEAR(host_data[i].real(), host_dev[i].real(), 1e-2);
+        ASSERT_NEAR(host_data[i].imag(), host_dev[i].imag(), 1e-2);
+    }
+
+    // host-side staging can't be enqueued with other plans
+    void** in_buffers[] = {&host_ptr};
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_execute_batch(&plan_host, in_buffers, nullptr, nullptr, 1));
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_host));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_dev));
+}
+
+// unnormalized DCT/DST of one real sequence, as defined by FFTW's
+// REDFTxx/RODFTxx
+static std::vector<double> naive_real_to_real(rocfft_transform_type     type,
+                                              const std::vector<double>& x)
+{
+    const double        pi = std::acos(-1.0);
+    const size_t        n  = x.size();
+    std::vector<double> y(n);
+    for(size_t k = 0; k < n; ++k)
+    {
+        double sum = 0;
+        for(size_t j = 0; j < n; ++j)
+        {
+            switch(type)
+            {
+            case rocfft_transform_type_dct1:
+                sum += (j == 0 || j == n - 1 ? 1 : 2) * x[j] * std::cos(pi * j * k / (n - 1));
+                break;
+            case rocfft_transform_type_dct2:
+                sum += 2 * x[j] * std::cos(pi * (j + 0.5) * k / n);
+                break;
+            case rocfft_transform_type_dct3:
+                sum += (j == 0 ? 1 : 2) * x[j] * std::cos(pi * j * (k + 0.5) / n);
+                break;
+            case rocfft_transform_type_dct4:
+                sum += 2 * x[j] * std::cos(pi * (j + 0.5) * (k + 0.5) / n);
+                break;
+            case rocfft_transform_type_dst1:
+                sum += 2 * x[j] * std::sin(pi * (j + 1) * (k + 1) / (n + 1));
+                break;
+            case rocfft_transform_type_dst2:
+                sum += 2 * x[j] * std::sin(pi * (j + 0.5) * (k + 1) / n);
+                break;
+            case rocfft_transform_type_dst3:
+                sum += (j == n - 1 ? 1 : 2) * x[j] * std::sin(pi * (j + 1) * (k + 0.5) / n);
+                break;
+            case rocfft_transform_type_dst4:
+                sum += 2 * x[j] * std::sin(pi * (j + 0.5) * (k + 0.5) / n);
+                break;
+            default:
+                break;
+            }
+        }
+        y[k] = sum;
+    }
+    return y;
+}
+
+// DCT/DST plans are a single kernel, and match the naive definitions
+TEST(rocfft_UnitTest, execute_real_to_real)
+{
+    struct r2r_case
+    {
+        rocfft_transform_type type;
+        size_t                length;
+    };
+    // lengths whose underlying complex FFT is single-kernel,
+    // including both even and odd type-IV lengths
+    const std::vector<r2r_case> cases = {{rocfft_transform_type_dct1, 9},
+                                         {rocfft_transform_type_dct2, 16},
+                                         {rocfft_transform_type_dct3, 16},
+                                         {rocfft_transform_type_dct4, 32},
+                                         {rocfft_transform_type_dct4, 5},
+                                         {rocfft_transform_type_dst1, 7},
+                                         {rocfft_transform_type_dst2, 15},
+                                         {rocfft_transform_type_dst3, 15},
+                                         {rocfft_transform_type_dst4, 32},
+                                         {rocfft_transform_type_dst4, 5}};
+    const size_t                batch = 3;
+
+    for(const auto& c : cases)
+    {
+        const size_t elems = c.length * batch;
+        const size_t bytes = elems * sizeof(double);
+
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     c.type,
+                                     rocfft_precision_double,
+                                     1,
+                                     &c.length,
+                                     batch,
+                                     nullptr));
+
+        rocfft_plan_info info;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_get_info(plan, &info));
+        EXPECT_EQ(info.kernel_count, 1U) << "type " << c.type << " length " << c.length;
+
+        std::vector<double> host_in(elems), host_out(elems);
+        for(size_t i = 0; i < elems; ++i)
+            host_in[i] = static_cast<double>(i % 7) - 3.0;
+
+        gpubuf dev_in, dev_out;
+        ASSERT_EQ(hipSuccess, dev_in.alloc(bytes));
+        ASSERT_EQ(hipSuccess, dev_out.alloc(bytes));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(dev_in.data(), host_in.data(), bytes, hipMemcpyHostToDevice));
+        void* dev_in_ptr  = dev_in.data();
+        void* dev_out_ptr = dev_out.data();
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(), dev_out.data(), bytes, hipMemcpyDeviceToHost));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+        for(size_t b = 0; b < batch; ++b)
+        {
+            std::vector<double> x(host_in.begin() + b * c.length,
+                                  host_in.begin() + (b + 1) * c.length);
+            auto                ref = naive_real_to_real(c.type, x);
+            for(size_t k = 0; k < c.length; ++k)
+                ASSERT_NEAR(ref[k], host_out[b * c.length + k], 1e-9)
+                    << "type " << c.type << " length " << c.length << " index " << k;
+        }
+    }
+
+    // only 1D transforms are supported so far
+    const std::vector<size_t> lengths2D = {16, 16};
+    rocfft_plan               plan      = nullptr;
+    ASSERT_EQ(rocfft_status_invalid_dimensions,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_dct2,
+                                 rocfft_precision_double,
+                                 lengths2D.size(),
+                                 lengths2D.data(),
+                                 1,
+                                 nullptr));
+}
+
+// write the multi-dimensional index of flat index i (first length
+// fastest) to idx
+static void unflatten_index(size_t i, const std::vector<size_t>& lengths, std::vector<size_t>& idx)
+{
+    idx.resize(lengths.size());
+    for(size_t d = 0; d < lengths.size(); ++d)
+    {
+        idx[d] = i % lengths[d];
+        i /= lengths[d];
+    }
+}
+
+// circular convolution (or correlation) of one transform x with the
+// kernel k, scaled by the number of points to match an unnormalized
+// inverse FFT
+static std::vector<std::complex<double>> naive_convolution(const std::vector<size_t>& lengths,
+                                                           const std::complex<double>* x,
+                                                           const std::vector<std::complex<double>>& k,
+                                                           bool correlate)
+{
+    const size_t                      n = k.size();
+    std::vector<std::complex<double>> y(n);
+    std::vector<size_t>               yi, ki;
+    for(size_t i = 0; i < n; ++i)
+    {
+        unflatten_index(i, lengths, yi);
+        for(size_t j = 0; j < n; ++j)
+        {
+            unflatten_index(j, lengths, ki);
+            // convolution reads x[i - j], correlation reads x[i + j]
+            size_t xflat = 0;
+            for(size_t d = lengths.size(); d-- > 0;)
+            {
+                size_t xd = correlate ? (yi[d] + ki[d]) % lengths[d]
+                                      : (yi[d] + lengths[d] - ki[d]) % lengths[d];
+                xflat     = xflat * lengths[d] + xd;
+            }
+            y[i] += x[xflat] * (correlate ? std::conj(k[j]) : k[j]);
+        }
+        y[i] *= static_cast<double>(n);
+    }
+    return y;
+}
+
+// convolution plans match a naive circular convolution with the
+// kernel whose spectrum they were given
+TEST(rocfft_UnitTest, execute_convolution)
+{
+    struct conv_case
+    {
+        rocfft_transform_type   type;
+        std::vector<size_t>     lengths;
+        rocfft_result_placement placement;
+        rocfft_convolution_type conv;
+    };
+    const std::vector<conv_case> cases = {
+        {rocfft_transform_type_complex_forward,
+         {12},
+         rocfft_placement_notinplace,
+         rocfft_convolution_type_convolve},
+        {rocfft_transform_type_complex_forward,
+         {8, 6},
+         rocfft_placement_inplace,
+         rocfft_convolution_type_correlate},
+        {rocfft_transform_type_complex_forward,
+         {4, 4, 6},
+         rocfft_placement_notinplace,
+         rocfft_convolution_type_convolve},
+        {rocfft_transform_type_real_forward,
+         {16},
+         rocfft_placement_inplace,
+         rocfft_convolution_type_convolve},
+        {rocfft_transform_type_real_forward,
+         {10, 4},
+         rocfft_placement_notinplace,
+         rocfft_convolution_type_correlate},
+    };
+    const size_t batch = 2;
+    const double pi    = std::acos(-1.0);
+
+    for(const auto& c : cases)
+    {
+        const bool real = c.type == rocfft_transform_type_real_forward;
+        size_t     n    = 1;
+        for(auto len : c.lengths)
+            n *= len;
+
+        // kernel and its spectrum, which only has the non-redundant
+        // half of the first dimension for real transforms
+        std::vector<std::complex<double>> kernel(n);
+        for(size_t i = 0; i < n; ++i)
+            kernel[i] = {std::cos(0.3 * i), real ? 0.0 : std::sin(0.7 * i)};
+        auto spectrumLengths = c.lengths;
+        if(real)
+            spectrumLengths.front() = spectrumLengths.front() / 2 + 1;
+        size_t spectrumElems = 1;
+        for(auto len : spectrumLengths)
+            spectrumElems *= len;
+        std::vector<std::complex<double>> spectrum(spectrumElems);
+        std::vector<size_t>               si, ki;
+        for(size_t s = 0; s < spectrumElems; ++s)
+        {
+            unflatten_index(s, spectrumLengths, si);
+            for(size_t j = 0; j < n; ++j)
+            {
+                unflatten_index(j, c.lengths, ki);
+                double phase = 0;
+                for(size_t d = 0; d < c.lengths.size(); ++d)
+                    phase += static_cast<double>(si[d] * ki[d]) / c.lengths[d];
+                spectrum[s] += kernel[j] * std::polar(1.0, -2 * pi * phase);
+            }
+        }
+
+        std::vector<std::complex<double>> host_in(n * batch);
+        for(size_t i = 0; i < host_in.size(); ++i)
+            host_in[i]
+                = {static_cast<double>(i % 5) - 2.0, real ? 0.0 : static_cast<double>(i % 3) - 1.0};
+
+        gpubuf spectrum_dev;
+        ASSERT_EQ(hipSuccess, spectrum_dev.alloc(spectrumElems * sizeof(std::complex<double>)));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(spectrum_dev.data(),
+                            spectrum.data(),
+                            spectrumElems * sizeof(std::complex<double>),
+                            hipMemcpyHostToDevice));
+
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create_convolution(&plan,
+                                                 c.placement,
+                                                 c.type,
+                                                 rocfft_precision_double,
+                                                 c.lengths.size(),
+                                                 c.lengths.data(),
+                                                 batch,
+                                                 spectrum_dev.data(),
+                                                 c.conv,
+                                                 nullptr));
+        // the plan keeps its own copy of the spectrum
+        spectrum_dev.free();
+
+        // real data is uploaded without imaginary parts
+        const size_t        elemSize = real ? sizeof(double) : sizeof(std::complex<double>);
+        const size_t        bytes    = n * batch * elemSize;
+        std::vector<double> host_real(n * batch);
+        for(size_t i = 0; i < host_real.size(); ++i)
+            host_real[i] = host_in[i].real();
+        const void* host_src = real ? static_cast<const void*>(host_real.data())
+                                    : static_cast<const void*>(host_in.data());
+
+        gpubuf dev_in, dev_out;
+        ASSERT_EQ(hipSuccess, dev_in.alloc(bytes));
+        ASSERT_EQ(hipSuccess, hipMemcpy(dev_in.data(), host_src, bytes, hipMemcpyHostToDevice));
+        void* dev_in_ptr  = dev_in.data();
+        void* dev_out_ptr = nullptr;
+        if(c.placement == rocfft_placement_notinplace)
+        {
+            ASSERT_EQ(hipSuccess, dev_out.alloc(bytes));
+            dev_out_ptr = dev_out.data();
+        }
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_execute(plan,
+                                 &dev_in_ptr,
+                                 c.placement == rocfft_placement_notinplace ? &dev_out_ptr : nullptr,
+                                 nullptr));
+
+        std::vector<std::complex<double>> host_out(n * batch);
+        std::vector<double>               host_out_real(n * batch);
+        void* host_dst = real ? static_cast<void*>(host_out_real.data())
+                              : static_cast<void*>(host_out.data());
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_dst,
+                            c.placement == rocfft_placement_notinplace ? dev_out_ptr : dev_in_ptr,
+                            bytes,
+                            hipMemcpyDeviceToHost));
+        if(real)
+            for(size_t i = 0; i < host_out.size(); ++i)
+                host_out[i] = host_out_real[i];
+
+        // convolution plans can't be split into chunks
+        ASSERT_EQ(rocfft_status_invalid_arg_value,
+                  rocfft_execute_out_of_core(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+        for(size_t b = 0; b < batch; ++b)
+        {
+            auto ref = naive_convolution(
+                c.lengths, host_in.data() + b * n, kernel, c.conv == rocfft_convolution_type_correlate);
+            for(size_t i = 0; i < n; ++i)
+            {
+                ASSERT_NEAR(ref[i].real(), host_out[b * n + i].real(), 1e-8)
+                    << "length " << c.lengths.front() << " index " << i;
+                ASSERT_NEAR(ref[i].imag(), host_out[b * n + i].imag(), 1e-8)
+                    << "length " << c.lengths.front() << " index " << i;
+            }
+        }
+    }
+
+    // only forward transform types are accepted
+    const size_t len      = 16;
+    double       dummy[2] = {};
+    rocfft_plan  plan     = nullptr;
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create_convolution(&plan,
+                                             rocfft_placement_notinplace,
+                                             rocfft_transform_type_complex_inverse,
+                                             rocfft_precision_double,
+                                             1,
+                                             &len,
+                                             1,
+                                             dummy,
+                                             rocfft_convolution_type_convolve,
+                                             nullptr));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+// analytic signal plans match a naive DFT with the negative
+// frequencies removed, and keep the input as the real part
+TEST(rocfft_UnitTest, execute_analytic_signal)
+{
+    const size_t batch = 2;
+    const double pi    = std::acos(-1.0);
+
+    for(size_t length : {16, 15, 200})
+    {
+        std::vector<double> host_in(length * batch);
+        for(size_t i = 0; i < host_in.size(); ++i)
+            host_in[i] = std::cos(0.3 * i) + static_cast<double>(i % 7) - 3.0;
+
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create_analytic_signal(
+                      &plan, rocfft_precision_double, length, batch, nullptr));
+
+        gpubuf dev_in, dev_out;
+        ASSERT_EQ(hipSuccess, dev_in.alloc(host_in.size() * sizeof(double)));
+        ASSERT_EQ(hipSuccess, dev_out.alloc(host_in.size() * sizeof(std::complex<double>)));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(dev_in.data(),
+                            host_in.data(),
+                            host_in.size() * sizeof(double),
+                            hipMemcpyHostToDevice));
+        void* dev_in_ptr  = dev_in.data();
+        void* dev_out_ptr = dev_out.data();
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+
+        std::vector<std::complex<double>> host_out(length * batch);
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(),
+                            dev_out.data(),
+                            host_out.size() * sizeof(std::complex<double>),
+                            hipMemcpyDeviceToHost));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+        for(size_t b = 0; b < batch; ++b)
+        {
+            const double*                     x = host_in.data() + b * length;
+            std::vector<std::complex<double>> spectrum(length);
+            for(size_t k = 0; k <= length / 2; ++k)
+            {
+                for(size_t j = 0; j < length; ++j)
+                    spectrum[k] += x[j] * std::polar(1.0, -2 * pi * k * j / length);
+                if(k != 0 && 2 * k != length)
+                    spectrum[k] *= 2.0;
+            }
+            for(size_t i = 0; i < length; ++i)
+            {
+                std::complex<double> ref;
+                for(size_t k = 0; k <= length / 2; ++k)
+                    ref += spectrum[k] * std::polar(1.0, 2 * pi * k * i / length);
+                ref /= static_cast<double>(length);
+
+                const auto& out = host_out[b * length + i];
+                ASSERT_NEAR(x[i], out.real(), 1e-8) << "length " << length << " index " << i;
+                ASSERT_NEAR(ref.real(), out.real(), 1e-8) << "length " << length << " index " << i;
+                ASSERT_NEAR(ref.imag(), out.imag(), 1e-8) << "length " << length << " index " << i;
+            }
+        }
+    }
+
+    // the output is already normalized
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_normalization(desc, rocfft_normalization_backward));
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create_analytic_signal(&plan, rocfft_precision_double, 16, 1, desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+// integer input, a window and zero-padding are all applied while
+// the first kernel loads the input
+TEST(rocfft_UnitTest, execute_load_ops)
+{
+    struct load_ops_case
+    {
+        std::vector<size_t> lengths;
+        std::vector<size_t> valid_lengths;
+    };
+    const std::vector<load_ops_case> cases = {
+        {{16}, {10}},
+        {{64}, {64}},
+        {{8, 6}, {5, 4}},
+    };
+    const size_t batch = 2;
+    const double scale = 1.0 / 256;
+    const double pi    = std::acos(-1.0);
+
+    for(const auto& c : cases)
+    {
+        size_t n = 1;
+        for(auto len : c.lengths)
+            n *= len;
+
+        // padding is filled with values that must not be read
+        std::vector<std::complex<int16_t>> host_in(n * batch);
+        std::vector<float>                 window(n);
+        std::vector<size_t>                idx;
+        for(size_t i = 0; i < host_in.size(); ++i)
+        {
+            unflatten_index(i % n, c.lengths, idx);
+            bool valid = true;
+            for(size_t d = 0; d < c.lengths.size(); ++d)
+                valid = valid && idx[d] < c.valid_lengths[d];
+            host_in[i] = valid ? std::complex<int16_t>(static_cast<int16_t>(i % 7 * 300 - 900),
+                                                       static_cast<int16_t>(i % 5 * 200 - 400))
+                               : std::complex<int16_t>(30000, -30000);
+        }
+        for(size_t i = 0; i < n; ++i)
+            window[i] = 0.5f - 0.5f * static_cast<float>(std::cos(2 * pi * i / n));
+
+        gpubuf dev_in, dev_out, dev_window;
+        ASSERT_EQ(hipSuccess, dev_in.alloc(host_in.size() * sizeof(std::complex<int16_t>)));
+        ASSERT_EQ(hipSuccess, dev_out.alloc(n * batch * sizeof(std::complex<float>)));
+        ASSERT_EQ(hipSuccess, dev_window.alloc(n * sizeof(float)));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(dev_in.data(),
+                            host_in.data(),
+                            host_in.size() * sizeof(std::complex<int16_t>),
+                            hipMemcpyHostToDevice));
+        ASSERT_EQ(
+            hipSuccess,
+            hipMemcpy(dev_window.data(), window.data(), n * sizeof(float), hipMemcpyHostToDevice));
+
+        rocfft_plan_description desc = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_input_storage_format(desc,
+                                                                   rocfft_storage_format_int16));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_input_scale_factor(desc, scale));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_input_window(desc, dev_window.data()));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_input_zero_padding(
+                      desc, c.valid_lengths.size(), c.valid_lengths.data()));
+
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     c.lengths.size(),
+                                     c.lengths.data(),
+                                     batch,
+                                     desc));
+        void* dev_in_ptr  = dev_in.data();
+        void* dev_out_ptr = dev_out.data();
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+        std::vector<std::complex<float>> host_out(n * batch);
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(),
+                            dev_out.data(),
+                            host_out.size() * sizeof(std::complex<float>),
+                            hipMemcpyDeviceToHost));
+
+        std::vector<size_t> ki;
+        for(size_t b = 0; b < batch; ++b)
+        {
+            for(size_t k = 0; k < n; ++k)
+            {
+                unflatten_index(k, c.lengths, ki);
+                std::complex<double> ref;
+                for(size_t j = 0; j < n; ++j)
+                {
+                    unflatten_index(j, c.lengths, idx);
+                    bool   valid = true;
+                    double phase = 0;
+                    for(size_t d = 0; d < c.lengths.size(); ++d)
+                    {
+                        valid = valid && idx[d] < c.valid_lengths[d];
+                        phase += static_cast<double>(idx[d] * ki[d]) / c.lengths[d];
+                    }
+                    if(!valid)
+                        continue;
+                    const auto&          v = host_in[b * n + j];
+                    std::complex<double> x(v.real(), v.imag());
+                    ref += x * static_cast<double>(window[j]) * scale
+                           * std::polar(1.0, -2 * pi * phase);
+                }
+                ASSERT_NEAR(ref.real(), host_out[b * n + k].real(), 1e-3)
+                    << "length " << c.lengths.front() << " index " << k;
+                ASSERT_NEAR(ref.imag(), host_out[b * n + k].imag(), 1e-3)
+                    << "length " << c.lengths.front() << " index " << k;
+            }
+        }
+    }
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    const size_t len       = 16;
+    const size_t valid_len = 17;
+    rocfft_plan  plan      = nullptr;
+
+    // valid lengths can't exceed the transform length
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_input_zero_padding(desc, 1, &valid_len));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &len,
+                                 1,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_input_zero_padding(desc, 0, nullptr));
+
+    // windows are only applied to complex input
+    float dummy = 0.0f;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_input_window(desc, &dummy));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_real_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &len,
+                                 1,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_input_window(desc, nullptr));
+
+    // integer data can't be written back in place
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_input_storage_format(desc, rocfft_storage_format_int16));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &len,
+                                 1,
+                                 desc));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_storage_format(desc, rocfft_storage_format_int16));
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+// zero-padded input and truncated output run without touching the
+// padded or discarded parts of the user's buffers
+TEST(rocfft_UnitTest, execute_padded_truncated)
+{
+    struct truncate_case
+    {
+        std::vector<size_t> lengths;
+        std::vector<size_t> valid_lengths;
+        std::vector<size_t> kept_lengths;
+    };
+    const std::vector<truncate_case> cases = {
+        {{16}, {10}, {12}},
+        {{100}, {60}, {50}},
+        {{8, 6}, {5, 4}, {6, 3}},
+    };
+    const size_t batch    = 2;
+    const double pi       = std::acos(-1.0);
+    const auto   sentinel = std::complex<float>(12345.0f, -12345.0f);
+
+    for(const auto& c : cases)
+    {
+        size_t n = 1;
+        for(auto len : c.lengths)
+            n *= len;
+
+        std::vector<std::complex<float>> host_in(n * batch);
+        std::vector<size_t>              idx;
+        auto                             inside = [&idx](const std::vector<size_t>& lengths) {
+            for(size_t d = 0; d < lengths.size(); ++d)
+                if(idx[d] >= lengths[d])
+                    return false;
+            return true;
+        };
+        for(size_t i = 0; i < host_in.size(); ++i)
+        {
+            unflatten_index(i % n, c.lengths, idx);
+            host_in[i] = inside(c.valid_lengths)
+                             ? std::complex<float>(static_cast<float>(i % 7) * 0.25f - 0.5f,
+                                                   static_cast<float>(i % 5) * 0.25f - 0.5f)
+                             : sentinel;
+        }
+        std::vector<std::complex<float>> host_out(n * batch, sentinel);
+
+        const size_t bytes = n * batch * sizeof(std::complex<float>);
+        gpubuf       dev_in, dev_out;
+        ASSERT_EQ(hipSuccess, dev_in.alloc(bytes));
+        ASSERT_EQ(hipSuccess, dev_out.alloc(bytes));
+        ASSERT_EQ(hipSuccess, hipMemcpy(dev_in.data(), host_in.data(), bytes, hipMemcpyHostToDevice));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(dev_out.data(), host_out.data(), bytes, hipMemcpyHostToDevice));
+
+        rocfft_plan_description desc = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_input_zero_padding(
+                      desc, c.valid_lengths.size(), c.valid_lengths.data()));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_output_truncation(
+                      desc, c.kept_lengths.size(), c.kept_lengths.data()));
+
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     c.lengths.size(),
+                                     c.lengths.data(),
+                                     batch,
+                                     desc));
+        void* dev_in_ptr  = dev_in.data();
+        void* dev_out_ptr = dev_out.data();
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(), dev_out.data(), bytes, hipMemcpyDeviceToHost));
+
+        std::vector<size_t> ki;
+        for(size_t b = 0; b < batch; ++b)
+        {
+            for(size_t k = 0; k < n; ++k)
+            {
+                unflatten_index(k, c.lengths, ki);
+                idx = ki;
+                if(!inside(c.kept_lengths))
+                {
+                    ASSERT_EQ(sentinel, host_out[b * n + k]) << "index " << k;
+                    continue;
+                }
+                std::complex<double> ref;
+                for(size_t j = 0; j < n; ++j)
+                {
+                    unflatten_index(j, c.lengths, idx);
+                    if(!inside(c.valid_lengths))
+                        continue;
+                    double phase = 0;
+                    for(size_t d = 0; d < c.lengths.size(); ++d)
+                        phase += static_cast<double>(idx[d] * ki[d]) / c.lengths[d];
+                    const auto& v = host_in[b * n + j];
+                    ref += std::complex<double>(v.real(), v.imag())
+                           * std::polar(1.0, -2 * pi * phase);
+                }
+                ASSERT_NEAR(ref.real(), host_out[b * n + k].real(), 1e-3) << "index " << k;
+                ASSERT_NEAR(ref.imag(), host_out[b * n + k].imag(), 1e-3) << "index " << k;
+            }
+        }
+    }
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    const size_t len      = 16;
+    const size_t kept_len = 17;
+    rocfft_plan  plan     = nullptr;
+
+    // kept lengths can't exceed the output length
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_output_truncation(desc, 1, &kept_len));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &len,
+                                 1,
+                                 desc));
+
+    // truncated output must be written only by the last kernel, so
+    // can't be in-place
+    const size_t short_len = 8;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_output_truncation(desc, 1, &short_len));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &len,
+                                 1,
+                                 desc));
+
+    // removing the truncation allows the plan again
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_output_truncation(desc, 0, nullptr));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &len,
+                                 1,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+// 3D transforms of a zero-padded sub-box skip first-pass pencils
+// that are entirely padding, and must match transforms of the
+// zero-filled volume
+TEST(rocfft_UnitTest, execute_padded_sub_box)
+{
+    const std::vector<size_t> lengths       = {128, 96, 80};
+    const std::vector<size_t> valid_lengths = {40, 30, 20};
+    const size_t              batch         = 2;
+    const size_t              n             = lengths[0] * lengths[1] * lengths[2];
+    const size_t              bytes         = n * batch * sizeof(std::complex<float>);
+
+    std::vector<std::complex<float>> padded(n * batch), zeroed(n * batch);
+    std::vector<size_t>              idx;
+    for(size_t i = 0; i < padded.size(); ++i)
+    {
+        unflatten_index(i % n, lengths, idx);
+        bool valid = true;
+        for(size_t d = 0; d < lengths.size(); ++d)
+            valid = valid && idx[d] < valid_lengths[d];
+        const std::complex<float> x(static_cast<float>(i % 7) * 0.25f - 0.5f,
+                                    static_cast<float>(i % 5) * 0.25f - 0.5f);
+        padded[i] = valid ? x : std::complex<float>(12345.0f, -12345.0f);
+        zeroed[i] = valid ? x : std::complex<float>(0.0f, 0.0f);
+    }
+
+    for(auto placement : {rocfft_placement_notinplace, rocfft_placement_inplace})
+    {
+        gpubuf dev_in, dev_out;
+        ASSERT_EQ(hipSuccess, dev_in.alloc(bytes));
+        ASSERT_EQ(hipSuccess, dev_out.alloc(bytes));
+        void* dev_in_ptr  = dev_in.data();
+        void* dev_out_ptr = placement == rocfft_placement_inplace ? dev_in.data() : dev_out.data();
+
+        auto run = [&](const std::vector<std::complex<float>>& input, bool pad) {
+            std::vector<std::complex<float>> output(n * batch);
+            EXPECT_EQ(hipSuccess, hipMemcpy(dev_in_ptr, input.data(), bytes, hipMemcpyHostToDevice));
+
+            rocfft_plan_description desc = nullptr;
+            EXPECT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+            if(pad)
+                EXPECT_EQ(rocfft_status_success,
+                          rocfft_plan_description_set_input_zero_padding(
+                              desc, valid_lengths.size(), valid_lengths.data()));
+            rocfft_plan plan = nullptr;
+            EXPECT_EQ(rocfft_status_success,
+                      rocfft_plan_create(&plan,
+                                         placement,
+                                         rocfft_transform_type_complex_forward,
+                                         rocfft_precision_single,
+                                         lengths.size(),
+                                         lengths.data(),
+                                         batch,
+                                         desc));
+            EXPECT_EQ(rocfft_status_success,
+                      rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+            EXPECT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+            EXPECT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+            EXPECT_EQ(hipSuccess,
+                      hipMemcpy(output.data(), dev_out_ptr, bytes, hipMemcpyDeviceToHost));
+            return output;
+        };
+
+        const auto expected = run(zeroed, false);
+        const auto actual   = run(padded, true);
+        double     diff = 0.0, norm = 0.0;
+        for(size_t i = 0; i < actual.size(); ++i)
+        {
+            diff += std::norm(std::complex<double>(actual[i] - expected[i]));
+            norm += std::norm(std::complex<double>(expected[i]));
+        }
+        EXPECT_LT(std::sqrt(diff / norm), 1e-5) << "placement " << placement;
+    }
+}
+
+// pruned output only stores a range of bins in each dimension
+TEST(rocfft_UnitTest, execute_output_pruning)
+{
+    struct pruning_case
+    {
+        std::vector<size_t> lengths;
+        std::vector<size_t> first_bins;
+        std::vector<size_t> bin_counts;
+    };
+    const std::vector<pruning_case> cases = {
+        {{100}, {20}, {30}},
+        {{64, 48}, {10, 5}, {20, 15}},
+        {{32, 16, 8}, {0, 3, 2}, {32, 10, 4}},
+    };
+    const size_t batch    = 2;
+    const double pi       = std::acos(-1.0);
+    const auto   sentinel = std::complex<float>(12345.0f, -12345.0f);
+
+    for(const auto& c : cases)
+    {
+        size_t n = 1;
+        for(auto len : c.lengths)
+            n *= len;
+
+        std::vector<std::complex<float>> host_in(n * batch);
+        for(size_t i = 0; i < host_in.size(); ++i)
+            host_in[i] = std::complex<float>(static_cast<float>(i % 7) * 0.25f - 0.5f,
+                                             static_cast<float>(i % 5) * 0.25f - 0.5f);
+        std::vector<std::complex<float>> host_out(n * batch, sentinel);
+
+        const size_t bytes = n * batch * sizeof(std::complex<float>);
+        gpubuf       dev_in, dev_out;
+        ASSERT_EQ(hipSuccess, dev_in.alloc(bytes));
+        ASSERT_EQ(hipSuccess, dev_out.alloc(bytes));
+        ASSERT_EQ(hipSuccess, hipMemcpy(dev_in.data(), host_in.data(), bytes, hipMemcpyHostToDevice));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(dev_out.data(), host_out.data(), bytes, hipMemcpyHostToDevice));
+
+        rocfft_plan_description desc = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_output_pruning(
+                      desc, c.lengths.size(), c.first_bins.data(), c.bin_counts.data()));
+
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     c.lengths.size(),
+                                     c.lengths.data(),
+                                     batch,
+                                     desc));
+        void* dev_in_ptr  = dev_in.data();
+        void* dev_out_ptr = dev_out.data();
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(), dev_out.data(), bytes, hipMemcpyDeviceToHost));
+
+        std::vector<size_t> idx, ki;
+        for(size_t b = 0; b < batch; ++b)
+        {
+            for(size_t k = 0; k < n; ++k)
+            {
+                unflatten_index(k, c.lengths, ki);
+                bool kept = true;
+                for(size_t d = 0; d < c.lengths.size(); ++d)
+                    kept = kept && ki[d] >= c.first_bins[d]
+                           && ki[d] < c.first_bins[d] + c.bin_counts[d];
+                if(!kept)
+                {
+                    ASSERT_EQ(sentinel, host_out[b * n + k]) << "index " << k;
+                    continue;
+                }
+                std::complex<double> ref;
+                for(size_t j = 0; j < n; ++j)
+                {
+                    unflatten_index(j, c.lengths, idx);
+                    double phase = 0;
+                    for(size_t d = 0; d < c.lengths.size(); ++d)
+                        phase += static_cast<double>(idx[d] * ki[d]) / c.lengths[d];
+                    const auto& v = host_in[b * n + j];
+                    ref += std::complex<double>(v.real(), v.imag())
+                           * std::polar(1.0, -2 * pi * phase);
+                }
+                ASSERT_NEAR(ref.real(), host_out[b * n + k].real(), 1e-3) << "index " << k;
+                ASSERT_NEAR(ref.imag(), host_out[b * n + k].imag(), 1e-3) << "index " << k;
+            }
+        }
+    }
+
+    // ranges must fit in the output
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    const size_t len   = 16;
+    const size_t first = 10;
+    const size_t count = 7;
+    rocfft_plan  plan  = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_output_pruning(desc, 1, &first, &count));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &len,
+                                 1,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+// short-time FFTs read overlapping frames straight from the signal,
+// weighting each element by its position in the frame
+TEST(rocfft_UnitTest, execute_stft)
+{
+    const size_t frame  = 256;
+    const size_t hop    = 64;
+    const size_t frames = 20;
+    const size_t signal = (frames - 1) * hop + frame;
+    const double pi     = std::acos(-1.0);
+
+    std::vector<std::complex<float>> host_in(signal);
+    for(size_t i = 0; i < signal; ++i)
+        host_in[i] = std::complex<float>(static_cast<float>(i % 7) * 0.25f - 0.5f,
+                                         static_cast<float>(i % 5) * 0.25f - 0.5f);
+    std::vector<float> host_window(frame);
+    for(size_t i = 0; i < frame; ++i)
+        host_window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2 * pi * i / frame));
+
+    const size_t in_bytes     = signal * sizeof(std::complex<float>);
+    const size_t out_bytes    = frame * frames * sizeof(std::complex<float>);
+    const size_t window_bytes = frame * sizeof(float);
+    gpubuf       dev_in, dev_out, dev_window;
+    ASSERT_EQ(hipSuccess, dev_in.alloc(in_bytes));
+    ASSERT_EQ(hipSuccess, dev_out.alloc(out_bytes));
+    ASSERT_EQ(hipSuccess, dev_window.alloc(window_bytes));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(dev_in.data(), host_in.data(), in_bytes, hipMemcpyHostToDevice));
+    ASSERT_EQ(
+        hipSuccess,
+        hipMemcpy(dev_window.data(), host_window.data(), window_bytes, hipMemcpyHostToDevice));
+
+    for(bool windowed : {true, false})
+    {
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create_stft(&plan,
+                                          rocfft_precision_single,
+                                          frame,
+                                          hop,
+                                          frames,
+                                          windowed ? dev_window.data() : nullptr,
+                                          nullptr));
+        void* dev_in_ptr  = dev_in.data();
+        void* dev_out_ptr = dev_out.data();
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+        std::vector<std::complex<float>> host_out(frame * frames);
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(), dev_out.data(), out_bytes, hipMemcpyDeviceToHost));
+
+        for(size_t f = 0; f < frames; ++f)
+        {
+            for(size_t k = 0; k < frame; ++k)
+            {
+                std::complex<double> ref;
+                for(size_t j = 0; j < frame; ++j)
+                {
+                    const auto&  v = host_in[f * hop + j];
+                    const double w = windowed ? host_window[j] : 1.0;
+                    ref += w * std::complex<double>(v.real(), v.imag())
+                           * std::polar(1.0, -2 * pi * static_cast<double>(j * k) / frame);
+                }
+                const auto& out = host_out[f * frame + k];
+                ASSERT_NEAR(ref.real(), out.real(), 1e-2) << "frame " << f << " bin " << k;
+                ASSERT_NEAR(ref.imag(), out.imag(), 1e-2) << "frame " << f << " bin " << k;
+            }
+        }
+    }
+
+    // the frame layout comes from the hop, so the description can't
+    // set an input distance
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    const size_t in_stride = 1;
+    const size_t out_dist  = frame;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_data_layout(desc,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      nullptr,
+                                                      nullptr,
+                                                      1,
+                                                      &in_stride,
+                                                      hop,
+                                                      1,
+                                                      &in_stride,
+                                                      out_dist));
+    rocfft_plan plan = nullptr;
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create_stft(
+                  &plan, rocfft_precision_single, frame, hop, frames, dev_window.data(), desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+// normalization folds 1/N or 1/sqrt(N) into the scale applied as
+// the result is stored, depending on the transform's direction
+TEST(rocfft_UnitTest, execute_normalization)
+{
+    struct norm_case
+    {
+        rocfft_transform_type type;
+        std::vector<size_t>   lengths;
+    };
+    // includes a multi-kernel 2D plan, and a real inverse plan whose
+    // N comes from its output lengths
+    const std::vector<norm_case> cases = {
+        {rocfft_transform_type_complex_forward, {64}},
+        {rocfft_transform_type_complex_inverse, {64}},
+        {rocfft_transform_type_complex_forward, {128, 96}},
+        {rocfft_transform_type_real_inverse, {100}},
+    };
+    const size_t batch = 3;
+
+    for(const auto& c : cases)
+    {
+        const bool real    = c.type == rocfft_transform_type_real_inverse;
+        const bool forward = c.type == rocfft_transform_type_complex_forward;
+        size_t     n       = 1;
+        for(auto len : c.lengths)
+            n *= len;
+        // sizes in floats
+        const size_t in_elems  = real ? 2 * (n / c.lengths.front() * (c.lengths.front() / 2 + 1))
+                                      : 2 * n;
+        const size_t out_elems = real ? n : 2 * n;
+
+        std::vector<float> host_in(in_elems * batch);
+        for(size_t i = 0; i < host_in.size(); ++i)
+            host_in[i] = static_cast<float>(i % 11) * 0.125f - 0.5f;
+
+        gpubuf dev_in, dev_out;
+        ASSERT_EQ(hipSuccess, dev_in.alloc(host_in.size() * sizeof(float)));
+        ASSERT_EQ(hipSuccess, dev_out.alloc(out_elems * batch * sizeof(float)));
+
+        auto run = [&](rocfft_normalization normalization, std::vector<float>& host_out) {
+            // real inverse transforms overwrite their input
+            ASSERT_EQ(hipSuccess,
+                      hipMemcpy(dev_in.data(),
+                                host_in.data(),
+                                host_in.size() * sizeof(float),
+                                hipMemcpyHostToDevice));
+            rocfft_plan_description desc = nullptr;
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_description_set_normalization(desc, normalization));
+            rocfft_plan plan = nullptr;
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_plan_create(&plan,
+                                         rocfft_placement_notinplace,
+                                         c.type,
+                                         rocfft_precision_single,
+                                         c.lengths.size(),
+                                         c.lengths.data(),
+                                         batch,
+                                         desc));
+            void* dev_in_ptr  = dev_in.data();
+            void* dev_out_ptr = dev_out.data();
+            ASSERT_EQ(rocfft_status_success,
+                      rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+            ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+            host_out.resize(out_elems * batch);
+            ASSERT_EQ(hipSuccess,
+                      hipMemcpy(host_out.data(),
+                                dev_out.data(),
+                                host_out.size() * sizeof(float),
+                                hipMemcpyDeviceToHost));
+        };
+
+        std::vector<float> unscaled;
+        run(rocfft_normalization_none, unscaled);
+
+        const double inv_n = 1.0 / static_cast<double>(n);
+        for(auto normalization : {rocfft_normalization_backward,
+                                  rocfft_normalization_forward,
+                                  rocfft_normalization_ortho})
+        {
+            double scale = 1.0;
+            if(normalization == rocfft_normalization_ortho)
+                scale = std::sqrt(inv_n);
+            else if((normalization == rocfft_normalization_forward) == forward)
+                scale = inv_n;
+
+            std::vector<float> scaled;
+            run(normalization, scaled);
+            for(size_t i = 0; i < scaled.size(); ++i)
+            {
+                const double expected = unscaled[i] * scale;
+                ASSERT_NEAR(expected, scaled[i], 1e-5 * (1.0 + std::abs(unscaled[i])))
+                    << "normalization " << normalization << " index " << i;
+            }
+        }
+    }
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_normalization(desc,
+                                                        static_cast<rocfft_normalization>(-1)));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+// power/magnitude outputs and accumulation are applied as the last
+// kernel stores the result
+TEST(rocfft_UnitTest, execute_output_ops)
+{
+    struct output_op_case
+    {
+        rocfft_transform_type type;
+        size_t                length;
+        rocfft_output_op      op;
+        bool                  accumulate;
+        rocfft_storage_format storage;
+    };
+    const std::vector<output_op_case> cases = {
+        {rocfft_transform_type_complex_forward,
+         64,
+         rocfft_output_op_power,
+         false,
+         rocfft_storage_format_native},
+        {rocfft_transform_type_complex_forward,
+         64,
+         rocfft_output_op_magnitude,
+         false,
+         rocfft_storage_format_native},
+        {rocfft_transform_type_complex_inverse,
+         100,
+         rocfft_output_op_log_power,
+         false,
+         rocfft_storage_format_native},
+        {rocfft_transform_type_complex_forward,
+         64,
+         rocfft_output_op_none,
+         true,
+         rocfft_storage_format_native},
+        {rocfft_transform_type_complex_forward,
+         64,
+         rocfft_output_op_power,
+         true,
+         rocfft_storage_format_native},
+        {rocfft_transform_type_complex_forward,
+         64,
+         rocfft_output_op_magnitude,
+         false,
+         rocfft_storage_format_half},
+        {rocfft_transform_type_real_forward,
+         32,
+         rocfft_output_op_power,
+         false,
+         rocfft_storage_format_native},
+    };
+    const size_t batch = 2;
+    const double pi    = std::acos(-1.0);
+
+    for(const auto& c : cases)
+    {
+        const bool   real       = c.type == rocfft_transform_type_real_forward;
+        const bool   complexOut = c.op == rocfft_output_op_none;
+        const bool   halfOut    = c.storage == rocfft_storage_format_half;
+        const size_t outLen     = real ? c.length / 2 + 1 : c.length;
+        const double sign       = c.type == rocfft_transform_type_complex_inverse ? 1.0 : -1.0;
+
+        std::vector<std::complex<float>> host_in(c.length * batch);
+        for(size_t i = 0; i < host_in.size(); ++i)
+            host_in[i] = {static_cast<float>(i % 7) * 0.25f - 0.5f,
+                          real ? 0.0f : static_cast<float>(i % 3) * 0.5f - 0.5f};
+        std::vector<float> host_real(host_in.size());
+        for(size_t i = 0; i < host_in.size(); ++i)
+            host_real[i] = host_in[i].real();
+
+        // output elements are real unless only accumulating
+        const size_t outElemSize = complexOut ? sizeof(std::complex<float>)
+                                   : halfOut  ? sizeof(_Float16)
+                                              : sizeof(float);
+        const size_t inBytes
+            = host_in.size() * (real ? sizeof(float) : sizeof(std::complex<float>));
+        const size_t outBytes = outLen * batch * outElemSize;
+
+        // accumulation starts from an existing output
+        std::vector<std::complex<float>> prev_complex(outLen * batch);
+        std::vector<float>               prev_real(outLen * batch);
+        for(size_t i = 0; i < prev_real.size(); ++i)
+        {
+            prev_complex[i] = {1.0f + i % 4, -2.0f};
+            prev_real[i]    = 3.0f + i % 5;
+        }
+
+        gpubuf dev_in, dev_out;
+        ASSERT_EQ(hipSuccess, dev_in.alloc(inBytes));
+        ASSERT_EQ(hipSuccess, dev_out.alloc(outBytes));
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(dev_in.data(),
+                            real ? static_cast<void*>(host_real.data())
+                                 : static_cast<void*>(host_in.data()),
+                            inBytes,
+                            hipMemcpyHostToDevice));
+        if(c.accumulate)
+            ASSERT_EQ(hipSuccess,
+                      hipMemcpy(dev_out.data(),
+                                complexOut ? static_cast<void*>(prev_complex.data())
+                                           : static_cast<void*>(prev_real.data()),
+                                outBytes,
+                                hipMemcpyHostToDevice));
+
+        rocfft_plan_description desc = nullptr;
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_set_output_op(desc, c.op));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_output_accumulate(desc, c.accumulate));
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_description_set_output_storage_format(desc, c.storage));
+
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_status_success,
+                  rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     c.type,
+                                     rocfft_precision_single,
+                                     1,
+                                     &c.length,
+                                     batch,
+                                     desc));
+        void* dev_in_ptr  = dev_in.data();
+        void* dev_out_ptr = dev_out.data();
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, nullptr));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+        std::vector<char> host_out(outBytes);
+        ASSERT_EQ(hipSuccess,
+                  hipMemcpy(host_out.data(), dev_out.data(), outBytes, hipMemcpyDeviceToHost));
+
+        for(size_t b = 0; b < batch; ++b)
+        {
+            for(size_t k = 0; k < outLen; ++k)
+            {
+                std::complex<double> X;
+                for(size_t j = 0; j < c.length; ++j)
+                {
+                    const auto& v = host_in[b * c.length + j];
+                    X += std::complex<double>(v.real(), v.imag())
+                         * std::polar(1.0, sign * 2 * pi * j * k / c.length);
+                }
+                const size_t i = b * outLen + k;
+                if(complexOut)
+                {
+                    auto ref = X + std::complex<double>(prev_complex[i].real(),
+                                                        prev_complex[i].imag());
+                    auto out = reinterpret_cast<const std::complex<float>*>(host_out.data())[i];
+                    ASSERT_NEAR(ref.real(), out.real(), 1e-4) << "index " << i;
+                    ASSERT_NEAR(ref.imag(), out.imag(), 1e-4) << "index " << i;
+                    continue;
+                }
+
+                double ref = c.op == rocfft_output_op_magnitude ? std::abs(X) : std::norm(X);
+                if(c.accumulate)
+                    ref += prev_real[i];
+                double out = halfOut
+                                 ? static_cast<double>(
+                                     reinterpret_cast<const _Float16*>(host_out.data())[i])
+                                 : reinterpret_cast<const float*>(host_out.data())[i];
+                // compare log-power as power, since it's ill-conditioned
+                // near zero
+                if(c.op == rocfft_output_op_log_power)
+                    out = std::pow(10.0, out / 10);
+                ASSERT_NEAR(ref, out, (halfOut ? 1e-2 : 1e-4) * std::max(1.0, ref))
+                    << "length " << c.length << " index " << i;
+            }
+        }
+    }
+
+    // the output buffer can't also hold the input
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_output_op(desc, rocfft_output_op_power));
+    const size_t len  = 64;
+    rocfft_plan  plan = nullptr;
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &len,
+                                 1,
+                                 desc));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_description_set_output_storage_format(desc,
+                                                                rocfft_storage_format_int16));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
+TEST(rocfft_UnitTest, execute_inline_callbacks)
+{
+    // load callback scales by a factor in device memory, store
+    // callback conjugates
+    static const char* load_src = R"(
+__device__ rocfft_complex<float> scale_load(rocfft_complex<float>* data, size_t offset, void* cbdata, void* sharedMem)
+{
+    const float s = *static_cast<float*>(cbdata);
+    return rocfft_complex<float>{data[offset].x * s, data[offset].y * s};
+}
+)";
+    static const char* store_src = R"(
+__device__ void conj_store(rocfft_complex<float>* data, size_t offset, rocfft_complex<float> element, void* cbdata, void* sharedMem)
+{
+    data[offset] = rocfft_complex<float>{element.x, -element.y};
+}
+)";
+    const size_t length = 64;
+    const size_t batch  = 2;
+    const float  scale  = 0.5f;
+    const double pi     = std::acos(-1.0);
+
+    std::vector<std::complex<float>> host_in(length * batch);
+    for(size_t i = 0; i < host_in.size(); ++i)
+        host_in[i] = {static_cast<float>(i % 7) * 0.25f - 0.5f,
+                      static_cast<float>(i % 3) * 0.5f - 0.5f};
+    const size_t bytes = host_in.size() * sizeof(std::complex<float>);
+
+    gpubuf dev_in, dev_out, dev_scale;
+    ASSERT_EQ(hipSuccess, dev_in.alloc(bytes));
+    ASSERT_EQ(hipSuccess, dev_out.alloc(bytes));
+    ASSERT_EQ(hipSuccess, dev_scale.alloc(sizeof(float)));
+    ASSERT_EQ(hipSuccess, hipMemcpy(dev_in.data(), host_in.data(), bytes, hipMemcpyHostToDevice));
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(dev_scale.data(), &scale, sizeof(float), hipMemcpyHostToDevice));
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_load_callback_source(desc, load_src, "scale_load"));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_store_callback_source(desc, store_src, "conj_store"));
+
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc));
+
+    rocfft_execution_info info = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_create(&info));
+    void* load_data = dev_scale.data();
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_execution_info_set_load_callback(info, nullptr, &load_data, 0));
+
+    void* dev_in_ptr  = dev_in.data();
+    void* dev_out_ptr = dev_out.data();
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &dev_in_ptr, &dev_out_ptr, info));
+    ASSERT_EQ(rocfft_status_success, rocfft_execution_info_destroy(info));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+
+    std::vector<std::complex<float>> host_out(host_in.size());
+    ASSERT_EQ(hipSuccess,
+              hipMemcpy(host_out.data(), dev_out.data(), bytes, hipMemcpyDeviceToHost));
+    for(size_t b = 0; b < batch; ++b)
+    {
+        for(size_t k = 0; k < length; ++k)
+        {
+            std::complex<double> X;
+            for(size_t j = 0; j < length; ++j)
+            {
+                const auto& v = host_in[b * length + j];
+                X += std::complex<double>(v.real(), v.imag()) * static_cast<double>(scale)
+                     * std::polar(1.0, -2 * pi * j * k / length);
+            }
+            const auto& out = host_out[b * length + k];
+            ASSERT_NEAR(X.real(), out.real(), 1e-4) << "index " << k;
+            ASSERT_NEAR(-X.imag(), out.imag(), 1e-4) << "index " << k;
+        }
+    }
+
+    // callbacks can't be combined with an output op
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_output_op(desc, rocfft_output_op_power));
+    EXPECT_EQ(rocfft_status_invalid_arg_value,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_output_op(desc, rocfft_output_op_none));
+
+    // clearing the callbacks allows the plan again
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_load_callback_source(desc, nullptr, nullptr));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_store_callback_source(desc, nullptr, nullptr));
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 batch,
+                                 desc));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+}
+
 // Check whether logs can be emitted from multiple threads properly
 TEST(rocfft_UnitTest, log_multithreading)
 {
@@ -234,6 +4473,19 @@ TEST(rocfft_UnitTest, workmem_missing)
     workmem_test([](size_t) { return 0; }, rocfft_status_success);
 }
 
+// check that library-allocated work memory can be reused from the
+// pool, and that the pool can be capped and trimmed
+TEST(rocfft_UnitTest, workmem_pool)
+{
+    workmem_test([](size_t) { return 0; }, rocfft_status_success);
+    workmem_test([](size_t) { return 0; }, rocfft_status_success);
+    ASSERT_EQ(rocfft_work_buffer_pool_set_limit(0), rocfft_status_success);
+    workmem_test([](size_t) { return 0; }, rocfft_status_success);
+    ASSERT_EQ(rocfft_work_buffer_pool_trim(), rocfft_status_success);
+    ASSERT_EQ(rocfft_work_buffer_pool_set_limit(std::numeric_limits<size_t>::max()),
+              rocfft_status_success);
+}
+
 // check what happens if work memory is required but not enough is provided
 TEST(rocfft_UnitTest, workmem_small)
 {
@@ -416,6 +4668,555 @@ TEST(rocfft_UnitTest, rtc_cache_null)
     ASSERT_EQ(rocfft_cache_deserialize(&buf_len, 0), rocfft_status_invalid_arg_value);
 }
 
+// incremental cache updates only carry new kernels, and merge into
+// an existing cache
+TEST(rocfft_UnitTest, rtc_cache_delta)
+{
+    void*  buf     = nullptr;
+    size_t buf_len = 0;
+    ASSERT_EQ(rocfft_cache_serialize_since(0, nullptr, &buf_len), rocfft_status_invalid_arg_value);
+    ASSERT_EQ(rocfft_cache_serialize_since(0, &buf, nullptr), rocfft_status_invalid_arg_value);
+    ASSERT_EQ(rocfft_cache_deserialize_merge(nullptr, 12345), rocfft_status_invalid_arg_value);
+    ASSERT_EQ(rocfft_cache_deserialize_merge(&buf_len, 0), rocfft_status_invalid_arg_value);
+
+    const std::string rtc_cache_path = std::tmpnam(nullptr);
+    void*             empty_delta    = nullptr;
+    size_t            empty_len      = 0;
+    void*             delta          = nullptr;
+    size_t            delta_len      = 0;
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        rocfft_cleanup();
+        remove(rtc_cache_path.c_str());
+        // re-init lib now that the env vars are gone
+        rocfft_setup();
+        if(empty_delta)
+            rocfft_cache_buffer_free(empty_delta);
+        if(delta)
+            rocfft_cache_buffer_free(delta);
+    };
+
+    rocfft_cleanup();
+    EnvironmentSetTemp cache_env("ROCFFT_RTC_CACHE_PATH", rtc_cache_path.c_str());
+    EnvironmentSetTemp cache_sys_env("ROCFFT_RTC_SYS_CACHE_PATH", "/nonexistent/cache.db");
+    rocfft_setup();
+
+    auto build_plan = [&]() {
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_plan_create(&plan,
+                                     rocfft_placement_inplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     1,
+                                     &RTC_PROBLEM_SIZE,
+                                     1,
+                                     nullptr),
+                  rocfft_status_success);
+        rocfft_plan_destroy(plan);
+    };
+
+    const int64_t marker = time(nullptr);
+    ASSERT_EQ(rocfft_cache_serialize_since(marker, &empty_delta, &empty_len),
+              rocfft_status_success);
+    build_plan();
+    ASSERT_EQ(rocfft_cache_serialize_since(marker, &delta, &delta_len), rocfft_status_success);
+    ASSERT_GT(delta_len, empty_len);
+
+    // start over with an empty cache, merge in the delta, and the
+    // kernel should not need compiling
+    rocfft_cleanup();
+    remove(rtc_cache_path.c_str());
+    rocfft_setup();
+    ASSERT_EQ(rocfft_cache_deserialize_merge(delta, delta_len), rocfft_status_success);
+    // merging again leaves the existing rows alone
+    ASSERT_EQ(rocfft_cache_deserialize_merge(delta, delta_len), rocfft_status_success);
+
+    rocfft_cache_stats before;
+    ASSERT_EQ(rocfft_cache_get_stats(&before), rocfft_status_success);
+    build_plan();
+    rocfft_cache_stats after;
+    ASSERT_EQ(rocfft_cache_get_stats(&after), rocfft_status_success);
+    ASSERT_EQ(after.misses, before.misses);
+}
+
+TEST(rocfft_UnitTest, rtc_cache_stats)
+{
+    ASSERT_EQ(rocfft_cache_get_stats(nullptr), rocfft_status_invalid_arg_value);
+
+    const std::string rtc_cache_path = std::tmpnam(nullptr);
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        rocfft_cleanup();
+        remove(rtc_cache_path.c_str());
+        // re-init lib now that the env vars are gone
+        rocfft_setup();
+    };
+
+    // use an empty user cache and no system cache, so the kernel
+    // must be compiled the first time
+    rocfft_cleanup();
+    EnvironmentSetTemp cache_env("ROCFFT_RTC_CACHE_PATH", rtc_cache_path.c_str());
+    EnvironmentSetTemp cache_sys_env("ROCFFT_RTC_SYS_CACHE_PATH", "/nonexistent/cache.db");
+    rocfft_setup();
+
+    auto build_plan = [&]() {
+        rocfft_plan plan = nullptr;
+        ASSERT_EQ(rocfft_plan_create(&plan,
+                                     rocfft_placement_inplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     1,
+                                     &RTC_PROBLEM_SIZE,
+                                     1,
+                                     nullptr),
+                  rocfft_status_success);
+        rocfft_plan_destroy(plan);
+    };
+
+    rocfft_cache_stats before;
+    ASSERT_EQ(rocfft_cache_get_stats(&before), rocfft_status_success);
+
+    build_plan();
+    rocfft_cache_stats compiled;
+    ASSERT_EQ(rocfft_cache_get_stats(&compiled), rocfft_status_success);
+    ASSERT_GT(compiled.misses, before.misses);
+    ASSERT_GT(compiled.compile_seconds, before.compile_seconds);
+    ASSERT_GT(compiled.bytes_stored, before.bytes_stored);
+
+    // kernels are still loaded, so they come from memory
+    build_plan();
+    rocfft_cache_stats loaded;
+    ASSERT_EQ(rocfft_cache_get_stats(&loaded), rocfft_status_success);
+    ASSERT_GT(loaded.memory_hits, compiled.memory_hits);
+    ASSERT_EQ(loaded.misses, compiled.misses);
+
+    // cleanup unloads kernels, so they come from the user cache
+    rocfft_cleanup();
+    rocfft_setup();
+    build_plan();
+    rocfft_cache_stats reloaded;
+    ASSERT_EQ(rocfft_cache_get_stats(&reloaded), rocfft_status_success);
+    ASSERT_GT(reloaded.user_hits, loaded.user_hits);
+    ASSERT_EQ(reloaded.misses, loaded.misses);
+}
+
+// with the generic fallback enabled, a plan whose kernel isn't in
+// any cache is usable straight away, and executions give the same
+// results before and after the compiled kernel takes over
+TEST(rocfft_UnitTest, rtc_generic_fallback)
+{
+    const std::string rtc_cache_path = std::tmpnam(nullptr);
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        rocfft_cleanup();
+        remove(rtc_cache_path.c_str());
+        // re-init lib now that the env vars are gone
+        rocfft_setup();
+    };
+
+    rocfft_cleanup();
+    EnvironmentSetTemp cache_env("ROCFFT_RTC_CACHE_PATH", rtc_cache_path.c_str());
+    EnvironmentSetTemp cache_sys_env("ROCFFT_RTC_SYS_CACHE_PATH", "/nonexistent/cache.db");
+    EnvironmentSetTemp fallback_env("ROCFFT_RTC_GENERIC_FALLBACK", "1");
+    rocfft_setup();
+
+    // each transform is a single tone, so its spectrum is one bin
+    const size_t                     N     = RTC_PROBLEM_SIZE;
+    const size_t                     batch = 3;
+    std::vector<std::complex<float>> host_in(N * batch);
+    for(size_t b = 0; b < batch; ++b)
+        for(size_t n = 0; n < N; ++n)
+        {
+            const double phase = 2.0 * M_PI * ((b + 1) * n % N) / N;
+            host_in[b * N + n] = {static_cast<float>(cos(phase)), static_cast<float>(sin(phase))};
+        }
+
+    const size_t bytes = host_in.size() * sizeof(std::complex<float>);
+    gpubuf       buf;
+    ASSERT_EQ(hipSuccess, buf.alloc(bytes));
+    void* buf_ptr = buf.data();
+
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &N,
+                                 batch,
+                                 nullptr),
+              rocfft_status_success);
+
+    std::vector<std::complex<float>> host_out(host_in.size());
+    for(unsigned int exec = 0; exec < 3; ++exec)
+    {
+        ASSERT_EQ(hipSuccess, hipMemcpy(buf_ptr, host_in.data(), bytes, hipMemcpyHostToDevice));
+        ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &buf_ptr, nullptr, nullptr));
+        ASSERT_EQ(hipSuccess, hipMemcpy(host_out.data(), buf_ptr, bytes, hipMemcpyDeviceToHost));
+
+        for(size_t b = 0; b < batch; ++b)
+            for(size_t k = 0; k < N; ++k)
+            {
+                const float expected = k == b + 1 ? static_cast<float>(N) : 0.0f;
+                ASSERT_NEAR(host_out[b * N + k].real(), expected, 1e-4 * N);
+                ASSERT_NEAR(host_out[b * N + k].imag(), 0.0f, 1e-4 * N);
+            }
+    }
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+TEST(rocfft_UnitTest, rtc_direction_agnostic)
+{
+    const std::string rtc_cache_path = std::tmpnam(nullptr);
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        rocfft_cleanup();
+        remove(rtc_cache_path.c_str());
+        // re-init lib now that the env vars are gone
+        rocfft_setup();
+    };
+
+    rocfft_cleanup();
+    EnvironmentSetTemp cache_env("ROCFFT_RTC_CACHE_PATH", rtc_cache_path.c_str());
+    EnvironmentSetTemp cache_sys_env("ROCFFT_RTC_SYS_CACHE_PATH", "/nonexistent/cache.db");
+    EnvironmentSetTemp anydir_env("ROCFFT_RTC_DIRECTION_AGNOSTIC", "1");
+    rocfft_setup();
+
+    // forward transform a single tone, then inverse transform its
+    // spectrum back with the same kernel
+    const size_t                     N = RTC_PROBLEM_SIZE;
+    std::vector<std::complex<float>> host_in(N);
+    for(size_t n = 0; n < N; ++n)
+    {
+        const double phase = 2.0 * M_PI * (3 * n % N) / N;
+        host_in[n]         = {static_cast<float>(cos(phase)), static_cast<float>(sin(phase))};
+    }
+
+    const size_t bytes = host_in.size() * sizeof(std::complex<float>);
+    gpubuf       buf;
+    ASSERT_EQ(hipSuccess, buf.alloc(bytes));
+    void* buf_ptr = buf.data();
+    ASSERT_EQ(hipSuccess, hipMemcpy(buf_ptr, host_in.data(), bytes, hipMemcpyHostToDevice));
+
+    rocfft_plan plan_fwd = nullptr;
+    rocfft_plan plan_inv = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&plan_fwd,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &N,
+                                 1,
+                                 nullptr),
+              rocfft_status_success);
+    ASSERT_EQ(rocfft_plan_create(&plan_inv,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_inverse,
+                                 rocfft_precision_single,
+                                 1,
+                                 &N,
+                                 1,
+                                 nullptr),
+              rocfft_status_success);
+
+    std::vector<std::complex<float>> host_out(N);
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan_fwd, &buf_ptr, nullptr, nullptr));
+    ASSERT_EQ(hipSuccess, hipMemcpy(host_out.data(), buf_ptr, bytes, hipMemcpyDeviceToHost));
+    for(size_t k = 0; k < N; ++k)
+    {
+        const float expected = k == 3 ? static_cast<float>(N) : 0.0f;
+        ASSERT_NEAR(host_out[k].real(), expected, 1e-4 * N);
+        ASSERT_NEAR(host_out[k].imag(), 0.0f, 1e-4 * N);
+    }
+
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan_inv, &buf_ptr, nullptr, nullptr));
+    ASSERT_EQ(hipSuccess, hipMemcpy(host_out.data(), buf_ptr, bytes, hipMemcpyDeviceToHost));
+    for(size_t n = 0; n < N; ++n)
+    {
+        ASSERT_NEAR(host_out[n].real(), N * host_in[n].real(), 1e-4 * N);
+        ASSERT_NEAR(host_out[n].imag(), N * host_in[n].imag(), 1e-4 * N);
+    }
+
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_fwd));
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan_inv));
+}
+
+TEST(rocfft_UnitTest, rtc_static_layout)
+{
+    const std::string rtc_cache_path = std::tmpnam(nullptr);
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        rocfft_cleanup();
+        remove(rtc_cache_path.c_str());
+        // re-init lib now that the env vars are gone
+        rocfft_setup();
+    };
+
+    rocfft_cleanup();
+    EnvironmentSetTemp cache_env("ROCFFT_RTC_CACHE_PATH", rtc_cache_path.c_str());
+    EnvironmentSetTemp cache_sys_env("ROCFFT_RTC_SYS_CACHE_PATH", "/nonexistent/cache.db");
+    EnvironmentSetTemp layout_env("ROCFFT_RTC_STATIC_LAYOUT", "1");
+    rocfft_setup();
+
+    // out-of-place, with padding between output transforms so the
+    // input and output layouts differ
+    const size_t                     N     = RTC_PROBLEM_SIZE;
+    const size_t                     batch = 3;
+    const size_t                     idist = N;
+    const size_t                     odist = N + 4;
+    std::vector<std::complex<float>> host_in(idist * batch);
+    for(size_t b = 0; b < batch; ++b)
+        for(size_t n = 0; n < N; ++n)
+        {
+            const double phase     = 2.0 * M_PI * ((b + 1) * n % N) / N;
+            host_in[b * idist + n] = {static_cast<float>(cos(phase)),
+                                      static_cast<float>(sin(phase))};
+        }
+
+    const size_t in_bytes  = host_in.size() * sizeof(std::complex<float>);
+    const size_t out_bytes = odist * batch * sizeof(std::complex<float>);
+    gpubuf       in_buf;
+    gpubuf       out_buf;
+    ASSERT_EQ(hipSuccess, in_buf.alloc(in_bytes));
+    ASSERT_EQ(hipSuccess, out_buf.alloc(out_bytes));
+    void* in_ptr  = in_buf.data();
+    void* out_ptr = out_buf.data();
+    ASSERT_EQ(hipSuccess, hipMemcpy(in_ptr, host_in.data(), in_bytes, hipMemcpyHostToDevice));
+
+    rocfft_plan_description desc = nullptr;
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_create(&desc));
+    const size_t stride = 1;
+    ASSERT_EQ(rocfft_status_success,
+              rocfft_plan_description_set_data_layout(desc,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      rocfft_array_type_complex_interleaved,
+                                                      nullptr,
+                                                      nullptr,
+                                                      1,
+                                                      &stride,
+                                                      idist,
+                                                      1,
+                                                      &stride,
+                                                      odist));
+    rocfft_plan plan = nullptr;
+    ASSERT_EQ(rocfft_plan_create(&plan,
+                                 rocfft_placement_notinplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &N,
+                                 batch,
+                                 desc),
+              rocfft_status_success);
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_description_destroy(desc));
+
+    ASSERT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+    std::vector<std::complex<float>> host_out(odist * batch);
+    ASSERT_EQ(hipSuccess, hipMemcpy(host_out.data(), out_ptr, out_bytes, hipMemcpyDeviceToHost));
+    for(size_t b = 0; b < batch; ++b)
+        for(size_t k = 0; k < N; ++k)
+        {
+            const float expected = k == b + 1 ? static_cast<float>(N) : 0.0f;
+            ASSERT_NEAR(host_out[b * odist + k].real(), expected, 1e-4 * N);
+            ASSERT_NEAR(host_out[b * odist + k].imag(), 0.0f, 1e-4 * N);
+        }
+    ASSERT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+}
+
+TEST(rocfft_UnitTest, rtc_fuse_l1d)
+{
+    const std::string rtc_cache_path = std::tmpnam(nullptr);
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        rocfft_cleanup();
+        remove(rtc_cache_path.c_str());
+        // re-init lib now that the env vars are gone
+        rocfft_setup();
+    };
+
+    rocfft_cleanup();
+    EnvironmentSetTemp cache_env("ROCFFT_RTC_CACHE_PATH", rtc_cache_path.c_str());
+    EnvironmentSetTemp cache_sys_env("ROCFFT_RTC_SYS_CACHE_PATH", "/nonexistent/cache.db");
+    rocfft_setup();
+
+    // large enough to be split over a column and a row kernel
+    const size_t                     N     = 65536;
+    const size_t                     batch = 2;
+    std::vector<std::complex<float>> host_in(N * batch);
+    for(size_t b = 0; b < batch; ++b)
+        for(size_t n = 0; n < N; ++n)
+        {
+            const double phase = 2.0 * M_PI * ((b + 3) * n % N) / N;
+            host_in[b * N + n] = {static_cast<float>(cos(phase)), static_cast<float>(sin(phase))};
+        }
+
+    const size_t bytes = host_in.size() * sizeof(std::complex<float>);
+    gpubuf       in_buf;
+    gpubuf       out_buf;
+    ASSERT_EQ(hipSuccess, in_buf.alloc(bytes));
+    ASSERT_EQ(hipSuccess, out_buf.alloc(bytes));
+    void* in_ptr  = in_buf.data();
+    void* out_ptr = out_buf.data();
+
+    // run the transform once with the given fusion setting, returning
+    // the number of kernels the execution launched
+    auto run = [&](const char* fuse, std::vector<std::complex<float>>& host_out) {
+        EnvironmentSetTemp fuse_env("ROCFFT_RTC_FUSE_L1D", fuse);
+
+        rocfft_plan plan = nullptr;
+        EXPECT_EQ(rocfft_plan_create(&plan,
+                                     rocfft_placement_notinplace,
+                                     rocfft_transform_type_complex_forward,
+                                     rocfft_precision_single,
+                                     1,
+                                     &N,
+                                     batch,
+                                     nullptr),
+                  rocfft_status_success);
+        EXPECT_EQ(hipSuccess, hipMemcpy(in_ptr, host_in.data(), bytes, hipMemcpyHostToDevice));
+        EXPECT_EQ(rocfft_status_success, rocfft_execute(plan, &in_ptr, &out_ptr, nullptr));
+        host_out.resize(N * batch);
+        EXPECT_EQ(hipSuccess, hipMemcpy(host_out.data(), out_ptr, bytes, hipMemcpyDeviceToHost));
+
+        rocfft_counters counters;
+        EXPECT_EQ(rocfft_status_success, rocfft_get_counters(plan, &counters));
+        EXPECT_EQ(rocfft_status_success, rocfft_plan_destroy(plan));
+        return counters.kernels_launched;
+    };
+
+    std::vector<std::complex<float>> separate_out;
+    std::vector<std::complex<float>> fused_out;
+    const size_t                     separate_kernels = run("0", separate_out);
+    const size_t                     fused_kernels    = run("1", fused_out);
+    if(fused_kernels == separate_kernels)
+        GTEST_SKIP() << "transform was not fused on this device";
+    ASSERT_EQ(fused_kernels + 1, separate_kernels);
+
+    for(size_t b = 0; b < batch; ++b)
+        for(size_t k = 0; k < N; ++k)
+        {
+            const float expected = k == b + 3 ? static_cast<float>(N) : 0.0f;
+            ASSERT_NEAR(fused_out[b * N + k].real(), expected, 1e-4 * N);
+            ASSERT_NEAR(fused_out[b * N + k].imag(), 0.0f, 1e-4 * N);
+            ASSERT_NEAR(fused_out[b * N + k].real(), separate_out[b * N + k].real(), 1e-2);
+            ASSERT_NEAR(fused_out[b * N + k].imag(), separate_out[b * N + k].imag(), 1e-2);
+        }
+}
+
+TEST(rocfft_UnitTest, device_function_source)
+{
+    size_t source_size = 0;
+    ASSERT_EQ(rocfft_device_function_get_source(64,
+                                                rocfft_precision_single,
+                                                rocfft_transform_type_real_forward,
+                                                nullptr,
+                                                &source_size,
+                                                nullptr),
+              rocfft_status_invalid_arg_value);
+
+    unsigned int threads = 0;
+    ASSERT_EQ(rocfft_device_function_get_source(64,
+                                                rocfft_precision_single,
+                                                rocfft_transform_type_complex_forward,
+                                                nullptr,
+                                                &source_size,
+                                                &threads),
+              rocfft_status_success);
+    ASSERT_GT(source_size, 1U);
+    ASSERT_GT(threads, 0U);
+
+    // a buffer that can't hold the terminating null is rejected
+    std::vector<char> source(source_size);
+    size_t            short_size = source_size - 1;
+    ASSERT_EQ(rocfft_device_function_get_source(64,
+                                                rocfft_precision_single,
+                                                rocfft_transform_type_complex_forward,
+                                                source.data(),
+                                                &short_size,
+                                                nullptr),
+              rocfft_status_invalid_arg_value);
+
+    ASSERT_EQ(rocfft_device_function_get_source(64,
+                                                rocfft_precision_single,
+                                                rocfft_transform_type_complex_forward,
+                                                source.data(),
+                                                &source_size,
+                                                nullptr),
+              rocfft_status_success);
+    ASSERT_EQ(source.back(), '\0');
+    ASSERT_NE(std::string(source.data()).find("rocfft_device_fft_len64_fwd_sp("),
+              std::string::npos);
+}
+
+TEST(rocfft_UnitTest, rtc_cache_prefetch)
+{
+    ASSERT_EQ(rocfft_cache_prefetch(nullptr), rocfft_status_invalid_arg_value);
+    ASSERT_EQ(rocfft_cache_prefetch("not a problem"), rocfft_status_invalid_arg_value);
+    // comments and blank lines are fine
+    ASSERT_EQ(rocfft_cache_prefetch("# nothing here\n\n"), rocfft_status_success);
+
+    // one problem in bench format, one as a token
+    const char* manifest
+        = "rocfft-bench --length 2304 -b 1 -t 0 --precision single --itype 0 --otype 0 "
+          "--istride 1 --ostride 1 --idist 2304 --odist 2304 --ioffset 0 0 --ooffset 0 0\n"
+          "complex_forward_len_64_64_double_op_batch_2_istride_64_1_CI_ostride_64_1_CI_"
+          "idist_4096_odist_4096_ioffset_0_0_ooffset_0_0\n";
+    ASSERT_EQ(rocfft_cache_prefetch(manifest), rocfft_status_success);
+
+    // cleanup waits for prefetching that has already started
+    rocfft_cleanup();
+    rocfft_setup();
+
+    rocfft_plan  plan   = nullptr;
+    const size_t length = 2304;
+    ASSERT_EQ(rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 nullptr),
+              rocfft_status_success);
+    rocfft_plan_destroy(plan);
+}
+
+// a system cache that looks like an AOT archive but is truncated must
+// be ignored instead of breaking plan creation
+TEST(rocfft_UnitTest, rtc_sys_cache_bad_archive)
+{
+    const fs::path archive_path = fs::temp_directory_path() / "rocfft_unittest_bad_archive.rka";
+    {
+        std::ofstream archive(archive_path, std::ios::binary);
+        archive << "ROCFFTKA" << "truncated";
+    }
+    BOOST_SCOPE_EXIT_ALL(=)
+    {
+        rocfft_cleanup();
+        fs::remove(archive_path);
+        // re-init lib now that the env var is gone
+        rocfft_setup();
+    };
+
+    // system cache is only located on setup
+    rocfft_cleanup();
+    EnvironmentSetTemp env_sys_cache("ROCFFT_RTC_SYS_CACHE_PATH", archive_path.string().c_str());
+    rocfft_setup();
+
+    rocfft_plan  plan   = nullptr;
+    const size_t length = 8;
+    ASSERT_EQ(rocfft_plan_create(&plan,
+                                 rocfft_placement_inplace,
+                                 rocfft_transform_type_complex_forward,
+                                 rocfft_precision_single,
+                                 1,
+                                 &length,
+                                 1,
+                                 nullptr),
+              rocfft_status_success);
+    rocfft_plan_destroy(plan);
+}
+
 // make sure RTC gracefully handles a helper process that crashes
 TEST(rocfft_UnitTest, rtc_helper_crash)
 {
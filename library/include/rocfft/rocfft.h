@@ -35,7 +35,11 @@
 
 #ifdef __cplusplus
 #include <cstddef>
+#include <cstdint>
 extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
 #endif /* __cplusplus */
 
 /*! @brief Pointer type to plan structure
@@ -73,6 +77,38 @@ typedef struct rocfft_field_t* rocfft_field;
  *  */
 typedef struct rocfft_brick_t* rocfft_brick;
 
+/*! @brief Pointer type to a persistent executor structure
+ *  @details This type is used to declare a persistent executor handle
+ *  that can be initialized with ::rocfft_persistent_executor_create.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_persistent_executor_t* rocfft_persistent_executor;
+
+/*! @brief Pointer type to a grouped plan structure
+ *  @details This type is used to declare a grouped plan handle that
+ *  can be initialized with ::rocfft_grouped_plan_create.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_grouped_plan_t* rocfft_grouped_plan;
+
+/*! @brief Pointer type to a split plan structure
+ *  @details This type is used to declare a split plan handle that
+ *  can be initialized with ::rocfft_split_plan_create.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_split_plan_t* rocfft_split_plan;
+
+/*! @brief Pointer type to a non-uniform FFT plan structure
+ *  @details This type is used to declare a non-uniform FFT plan
+ *  handle that can be initialized with ::rocfft_nufft_plan_create.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_nufft_plan_t* rocfft_nufft_plan;
+
 /*! @brief rocFFT status/error codes */
 typedef enum rocfft_status_e
 {
@@ -94,6 +130,22 @@ typedef enum rocfft_transform_type_e
     rocfft_transform_type_complex_inverse,
     rocfft_transform_type_real_forward,
     rocfft_transform_type_real_inverse,
+    /*! Real-to-real transforms: unnormalized discrete cosine and sine
+     *  transforms, using the same definitions as FFTW's REDFTxx and
+     *  RODFTxx kinds.  Input and output are both
+     *  ::rocfft_array_type_real, of the same length.
+     *
+     *  @warning Experimental!  Only 1D transforms whose underlying
+     *  complex FFT is done by a single kernel are currently supported.
+     */
+    rocfft_transform_type_dct1,
+    rocfft_transform_type_dct2,
+    rocfft_transform_type_dct3,
+    rocfft_transform_type_dct4,
+    rocfft_transform_type_dst1,
+    rocfft_transform_type_dst2,
+    rocfft_transform_type_dst3,
+    rocfft_transform_type_dst4,
 } rocfft_transform_type;
 
 /*! @brief Precision */
@@ -104,6 +156,61 @@ typedef enum rocfft_precision_e
     rocfft_precision_half,
 } rocfft_precision;
 
+/*! @brief Storage format of user data
+ *  @details Declares how input and output data are stored in
+ *  memory, independently of the precision that the transform is
+ *  computed in.  Native data is stored in the precision of the
+ *  plan.  The FP8 formats are the OCP 8-bit floating point formats
+ *  with 4 exponent and 3 mantissa bits (e4m3) or 5 exponent and 2
+ *  mantissa bits (e5m2).  The integer formats hold signed 16-bit or
+ *  8-bit integers, and can only be used for input data.  The single
+ *  format holds FP32 values, and is only used for exchanges between
+ *  devices in double-precision plans.
+ */
+typedef enum rocfft_storage_format_e
+{
+    rocfft_storage_format_native,
+    rocfft_storage_format_half,
+    rocfft_storage_format_bfloat16,
+    rocfft_storage_format_fp8_e4m3,
+    rocfft_storage_format_fp8_e5m2,
+    rocfft_storage_format_int16,
+    rocfft_storage_format_int8,
+    rocfft_storage_format_single,
+} rocfft_storage_format;
+
+/*! @brief Output operation
+ *  @details Declares what a transform writes for each complex result
+ *  X.  By default the complex result is written.  The other
+ *  operations write one real value per result: the power |X|^2, the
+ *  magnitude |X|, or the log-power 10*log10(|X|^2) in decibels.
+ */
+typedef enum rocfft_output_op_e
+{
+    rocfft_output_op_none,
+    rocfft_output_op_power,
+    rocfft_output_op_magnitude,
+    rocfft_output_op_log_power,
+} rocfft_output_op;
+
+/*! @brief Normalization of results
+ *  @details Declares which directions of transform divide their
+ *  results by the transform size N, the product of the transform's
+ *  lengths.  With ::rocfft_normalization_backward, inverse
+ *  transforms are scaled by 1/N and forward transforms are not.
+ *  With ::rocfft_normalization_forward, forward transforms are
+ *  scaled by 1/N and inverse transforms are not.  With
+ *  ::rocfft_normalization_ortho, transforms in both directions are
+ *  scaled by 1/sqrt(N).  By default, results are not normalized.
+ */
+typedef enum rocfft_normalization_e
+{
+    rocfft_normalization_none,
+    rocfft_normalization_backward,
+    rocfft_normalization_forward,
+    rocfft_normalization_ortho,
+} rocfft_normalization;
+
 /*! @brief Result placement
  *  @details Declares where the output of the transform should be
  *  placed.  Note that input buffers may still be overwritten
@@ -116,6 +223,29 @@ typedef enum rocfft_result_placement_e
     rocfft_placement_notinplace,
 } rocfft_result_placement;
 
+/*! @brief Convolution type
+ *  @details Selects whether a convolution plan multiplies the input
+ *  spectrum by the kernel spectrum (convolution) or by its complex
+ *  conjugate (cross-correlation).
+ */
+typedef enum rocfft_convolution_type_e
+{
+    rocfft_convolution_type_convolve,
+    rocfft_convolution_type_correlate,
+} rocfft_convolution_type;
+
+/*! @brief Type of non-uniform FFT
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef enum rocfft_nufft_type_e
+{
+    /*! non-uniform points to uniform Fourier modes */
+    rocfft_nufft_type_1,
+    /*! uniform Fourier modes to non-uniform points */
+    rocfft_nufft_type_2,
+} rocfft_nufft_type;
+
 /*! @brief Array type */
 typedef enum rocfft_array_type_e
 {
@@ -132,8 +262,23 @@ typedef enum rocfft_comm_type_e
 {
     rocfft_comm_none,
     rocfft_comm_mpi,
+    rocfft_comm_rccl,
 } rocfft_comm_type;
 
+/*! @brief What plans should be optimized for
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef enum rocfft_optimization_goal_e
+{
+    /*! the most transforms per second over many executions (default) */
+    rocfft_optimization_goal_throughput,
+    /*! the shortest time for one execution of a small batch */
+    rocfft_optimization_goal_latency,
+    /*! the smallest work buffer */
+    rocfft_optimization_goal_memory,
+} rocfft_optimization_goal;
+
 #if 0
 /*! @brief Execution mode */
 typedef enum rocfft_execution_mode_e
@@ -163,6 +308,11 @@ ROCFFT_EXPORT rocfft_status rocfft_cleanup();
  *  that lengths[0] is the size of the innermost dimension, lengths[1]
  *  is the next higher dimension and so on (column-major ordering).
  *
+ *  Complex transforms on a single device may also have up to 14
+ *  dimensions, if the dimensions above the third and the batch are
+ *  packed together in the input or the output, so that they can be
+ *  treated as one batch of 3D transforms.
+ *
  *  The 'number_of_transforms' parameter specifies how many
  *  transforms (of the same kind) needs to be computed. By specifying
  *  a value greater than 1, a batch of transforms can be computed
@@ -194,6 +344,235 @@ ROCFFT_EXPORT rocfft_status rocfft_plan_create(rocfft_plan*                  pla
                                                size_t                        number_of_transforms,
                                                const rocfft_plan_description description);
 
+/*! @brief Create an FFT plan asynchronously
+ *
+ *  @details This API accepts the same parameters as
+ *  ::rocfft_plan_create, but returns as soon as the parameters have
+ *  been captured.  The plan is constructed (including any runtime
+ *  compilation of kernels) in the background, so that many plans
+ *  can be created concurrently with other work in the application.
+ *
+ *  The lengths array and description may be modified or destroyed
+ *  as soon as this function returns.
+ *
+ *  ::rocfft_plan_wait blocks until the plan is ready and returns the
+ *  status of plan creation.  ::rocfft_plan_is_ready can be used to
+ *  poll for readiness.  Other functions that accept the plan
+ *  (including ::rocfft_execute and ::rocfft_plan_destroy) implicitly
+ *  wait for creation to finish.
+ *
+ *  The plan is created for the device that is current when this
+ *  function is called.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[out] plan plan handle
+ *  @param[in] placement placement of result
+ *  @param[in] transform_type type of transform
+ *  @param[in] precision precision
+ *  @param[in] dimensions dimensions
+ *  @param[in] lengths dimensions-sized array of transform lengths
+ *  @param[in] number_of_transforms number of transforms
+ *  @param[in] description description handle created by
+ * rocfft_plan_description_create; can be
+ *  NULL for simple transforms
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_create_async(rocfft_plan*            plan,
+                                                     rocfft_result_placement placement,
+                                                     rocfft_transform_type   transform_type,
+                                                     rocfft_precision        precision,
+                                                     size_t                  dimensions,
+                                                     const size_t*           lengths,
+                                                     size_t                  number_of_transforms,
+                                                     const rocfft_plan_description description);
+
+/*! @brief Create a circular convolution plan
+ *
+ *  @details Creates a plan that computes the circular convolution
+ *  (or cross-correlation) of each input transform with a fixed
+ *  kernel, given the kernel's spectrum.  Executing the plan computes
+ *
+ *    output = IFFT(FFT(input) * S)
+ *
+ *  where S is the kernel spectrum (or its complex conjugate for
+ *  ::rocfft_convolution_type_correlate) and the product is
+ *  elementwise.  Like other rocFFT transforms, the result is not
+ *  normalized by default; use
+ *  ::rocfft_plan_description_set_normalization or
+ *  ::rocfft_plan_description_set_scale_factor to divide by the
+ *  product of the lengths if needed.
+ *
+ *  The multiply is fused into the kernel that writes the forward
+ *  transform's output, so no separate pass over the spectrum is
+ *  needed.
+ *
+ *  transform_type must be ::rocfft_transform_type_complex_forward
+ *  (complex input and output) or ::rocfft_transform_type_real_forward
+ *  (real input and output).  The description's input and output
+ *  layouts describe the user's input and output in that type.  Its
+ *  input scale factor and input storage format apply to the forward
+ *  pass, and its scale factor and output storage format apply to the
+ *  inverse pass.  Fields and communicators are not supported.
+ *
+ *  kernel_spectrum is a device pointer to a single transform's
+ *  spectrum in the plan's precision, stored as contiguous
+ *  interleaved complex data with lengths[0] the fastest-varying
+ *  dimension.  For real transforms this is the Hermitian spectrum,
+ *  whose first dimension has length lengths[0]/2 + 1.  The spectrum
+ *  is applied to every transform in the batch, and is copied when
+ *  the plan is created, so it may be freed afterwards.
+ *
+ *  The forward transform is stored in a buffer owned by the plan, so
+ *  a convolution plan must not be executed concurrently on multiple
+ *  streams.  Callbacks are not supported.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[out] plan plan handle
+ *  @param[in] placement placement of result
+ *  @param[in] transform_type ::rocfft_transform_type_complex_forward
+ *  or ::rocfft_transform_type_real_forward
+ *  @param[in] precision precision
+ *  @param[in] dimensions dimensions
+ *  @param[in] lengths dimensions-sized array of transform lengths
+ *  @param[in] number_of_transforms number of transforms
+ *  @param[in] kernel_spectrum device pointer to the kernel spectrum
+ *  @param[in] convolution_type convolve or correlate
+ *  @param[in] description description handle created by
+ * rocfft_plan_description_create; can be
+ *  NULL for simple transforms
+ *  */
+ROCFFT_EXPORT rocfft_status
+    rocfft_plan_create_convolution(rocfft_plan*                  plan,
+                                   rocfft_result_placement       placement,
+                                   rocfft_transform_type         transform_type,
+                                   rocfft_precision              precision,
+                                   size_t                        dimensions,
+                                   const size_t*                 lengths,
+                                   size_t                        number_of_transforms,
+                                   const void*                   kernel_spectrum,
+                                   rocfft_convolution_type       convolution_type,
+                                   const rocfft_plan_description description);
+
+/*! @brief Create an analytic signal plan
+ *
+ *  @details Creates a plan that computes the analytic signal
+ *  x + i*H(x) of each real 1D input transform x, where H is the
+ *  Hilbert transform.  The output is complex and has the same length
+ *  as the input.  Executing the plan computes
+ *
+ *    output = IFFT(FFT(input) * h) / length
+ *
+ *  where h is 1 at the zero bin and (for even lengths) the Nyquist
+ *  bin, 2 at the other positive frequency bins and 0 at the negative
+ *  frequency bins, so the real part of the output is the input.
+ *
+ *  The plan runs in two passes.  The first computes the real forward
+ *  transform's Hermitian spectrum into a buffer owned by the plan.
+ *  The second is a complex inverse transform whose first kernel
+ *  applies h as it loads the spectrum, and loads the negative
+ *  frequencies as zero instead of reading them, so h is never
+ *  applied in a separate pass.
+ *
+ *  The plan is not in-place.  The description's input layout
+ *  describes real input, and its output layout describes interleaved
+ *  or planar complex output, both with the given length.  Its input
+ *  scale factor and input storage format apply to the first pass,
+ *  and its scale factor, output storage format and output operations
+ *  apply to the second pass.  The output is already normalized, so
+ *  normalization must not be set.  Input windows and padding, fields
+ *  and communicators are not supported.
+ *
+ *  The spectrum is stored in a buffer owned by the plan, so an
+ *  analytic signal plan must not be executed concurrently on
+ *  multiple streams.  Callbacks are not supported.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[out] plan plan handle
+ *  @param[in] precision precision
+ *  @param[in] length length of each transform
+ *  @param[in] number_of_transforms number of transforms
+ *  @param[in] description description handle created by
+ * rocfft_plan_description_create; can be
+ *  NULL for simple transforms
+ *  */
+ROCFFT_EXPORT rocfft_status
+    rocfft_plan_create_analytic_signal(rocfft_plan*                  plan,
+                                       rocfft_precision              precision,
+                                       size_t                        length,
+                                       size_t                        number_of_transforms,
+                                       const rocfft_plan_description description);
+
+/*! @brief Create a short-time FFT plan
+ *
+ *  @details Creates a plan that computes the forward complex FFT of
+ *  overlapping frames of a single 1D signal.  Frame f covers input
+ *  elements f*hop_size through f*hop_size + frame_length - 1, and
+ *  its spectrum is the f-th transform of the output.  Frames are
+ *  read directly from the signal, so it does not need to be copied
+ *  into separate frames first.
+ *
+ *  window, if not NULL, is a device pointer to frame_length real
+ *  values in the plan's precision.  Each input element is multiplied
+ *  by the window value for its position in the frame as it is
+ *  loaded, so the same element may be weighted differently in each
+ *  frame that contains it.
+ *
+ *  The plan is complex forward and not in-place.  The description's
+ *  input layout must leave the distance unset, and may give a single
+ *  input stride for the signal.  The rest of the description,
+ *  including output layout, output operations and output storage
+ *  format, applies as for other plans.  Only frame lengths computed
+ *  by a single kernel are supported.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[out] plan plan handle
+ *  @param[in] precision precision
+ *  @param[in] frame_length length of each frame
+ *  @param[in] hop_size distance in elements between the starts of
+ *  consecutive frames
+ *  @param[in] number_of_frames number of frames
+ *  @param[in] window device pointer to frame_length window values,
+ *  or NULL
+ *  @param[in] description description handle created by
+ * rocfft_plan_description_create; can be
+ *  NULL for simple transforms
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_create_stft(rocfft_plan*                  plan,
+                                                    rocfft_precision              precision,
+                                                    size_t                        frame_length,
+                                                    size_t                        hop_size,
+                                                    size_t                        number_of_frames,
+                                                    const void*                   window,
+                                                    const rocfft_plan_description description);
+
+/*! @brief Wait for asynchronous plan creation to finish
+ *
+ *  @details Blocks until a plan created by
+ *  ::rocfft_plan_create_async is ready, and returns the status of
+ *  plan creation.  Returns ::rocfft_status_success immediately for
+ *  plans created with ::rocfft_plan_create.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan plan handle
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_wait(const rocfft_plan plan);
+
+/*! @brief Query whether asynchronous plan creation has finished
+ *
+ *  @details Sets ready to nonzero if the plan has finished being
+ *  created (successfully or not), without blocking.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan plan handle
+ *  @param[out] ready nonzero if the plan is ready
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_is_ready(const rocfft_plan plan, int* ready);
+
 /*! @brief Execute an FFT plan
  *
  *  @details This API executes an FFT plan on buffers given by the user.
@@ -219,6 +598,11 @@ ROCFFT_EXPORT rocfft_status rocfft_plan_create(rocfft_plan*                  pla
  *  handle. This optional parameter serves as a way for the user to control
  *  execution streams and work buffers.
  *
+ *  A plan is not modified once it has been created.  Plans that run
+ *  on a single device may be executed concurrently from several
+ *  host threads, for example on different streams, as long as each
+ *  concurrent execution uses its own execution info and work buffer.
+ *
  *  @param[in] plan plan handle
  *  @param[in,out] in_buffer array (of size 1 for interleaved data, of size 2
  * for planar data, or one per brick if an input field is set) of input buffers
@@ -233,6 +617,119 @@ ROCFFT_EXPORT rocfft_status rocfft_execute(const rocfft_plan     plan,
                                            void*                 out_buffer[],
                                            rocfft_execution_info info);
 
+/*! @brief Execute several FFT plans
+ *
+ *  @details Executes a number of (possibly different) plans with a
+ *  single call.  This is equivalent to calling ::rocfft_execute on
+ *  each plan in order, except that all arguments are validated
+ *  before any work is launched, and all of the work is enqueued
+ *  without returning to the caller in between.
+ *
+ *  If all of the plans execute on the same stream and could be
+ *  captured by ::rocfft_plan_capture_graph (with work buffers given
+ *  in their execution infos where they need one, and without
+ *  kernel profiling), their work is captured into one graph, which
+ *  is launched at once.  Repeated calls with the same list of plans
+ *  reuse the graph's executable.  Each call still captures the
+ *  plans' work, since buffers, work buffers and callbacks may have
+ *  changed, but the graph is then updated in place instead of
+ *  being instantiated again.
+ *
+ *  Plans whose execution infos specify different streams may
+ *  execute concurrently on the device.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plans array of num_plans plan handles
+ *  @param[in] in_buffers array of num_plans input buffer arrays, each
+ *  as would be passed to ::rocfft_execute
+ *  @param[in] out_buffers array of num_plans output buffer arrays,
+ *  each as would be passed to ::rocfft_execute; may be NULL if all
+ *  plans are in-place
+ *  @param[in] infos array of num_plans execution info handles; may
+ *  be NULL, as may any individual element
+ *  @param[in] num_plans number of plans to execute
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_execute_batch(const rocfft_plan*          plans,
+                                                 void**                      in_buffers[],
+                                                 void**                      out_buffers[],
+                                                 const rocfft_execution_info infos[],
+                                                 size_t                      num_plans);
+
+/*! @brief Execute an FFT plan on data in host memory
+ *  @details Executes a plan whose input and output live in host
+ *  memory, for problems that are too large to fit in device memory
+ *  at once.  The batch is split into chunks that fit in device
+ *  memory.  Each chunk is copied to the device, transformed, and
+ *  copied back, with copies of one chunk overlapping the transform
+ *  of another.
+ *
+ *  Pinned host buffers (e.g. allocated with hipHostMalloc) are
+ *  copied directly.  Pageable buffers are staged through pinned
+ *  buffers that the library allocates, so that their copies can also
+ *  overlap with computation.  This function returns once all results
+ *  have been copied back to the host.
+ *
+ *  Devices that share physical memory with the host, such as
+ *  MI300A, transform the host buffers in place without copying them
+ *  when the device can access them.  Pageable buffers are only
+ *  accessible when the device supports pageable memory access (on
+ *  MI300A, when XNACK is enabled).
+ *
+ *  Only single-device plans without fields are supported.  A single
+ *  transform of the batch must fit in device memory.  Output
+ *  transforms must not be interleaved, i.e. the output distance must
+ *  cover a whole transform, if the batch needs more than one chunk.
+ *  Execution info may not contain callbacks, a work buffer, or
+ *  capture mode.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan plan handle
+ *  @param[in,out] in_buffer array (of size 1 for interleaved data, of size 2
+ *  for planar data) of input buffers in host memory
+ *  @param[in,out] out_buffer array (of size 1 for interleaved data, of size 2
+ *  for planar data) of output buffers in host memory.  Ignored for in-place
+ *  transforms.
+ *  @param[in] info execution info handle created by
+ *  rocfft_execution_info_create, or NULL
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_execute_out_of_core(const rocfft_plan     plan,
+                                                       void*                 in_buffer[],
+                                                       void*                 out_buffer[],
+                                                       rocfft_execution_info info);
+
+/*! @brief Execute an FFT plan on transforms in separate buffers
+ *  @details Executes a plan whose batch of transforms are each in
+ *  a buffer of their own, in the style of batched BLAS.  Instead of
+ *  offsetting one buffer by the plan's distance for each transform,
+ *  the plan reads transform i from in_pointers[i] and writes it to
+ *  out_pointers[i].  The plan's strides still apply within each
+ *  transform, and its distances are ignored.
+ *
+ *  The whole batch runs in one kernel launch, so only plans that
+ *  rocFFT computes with a single kernel are supported, such as
+ *  small 1D complex transforms on interleaved data.  Other plans,
+ *  plans with offsets or a non-native storage format, and
+ *  execution info with callbacks or a smaller batch return
+ *  ::rocfft_status_invalid_arg_value.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan plan handle
+ *  @param[in] in_pointers device array of the plan's batch of input
+ *  pointers
+ *  @param[in] out_pointers device array of the plan's batch of output
+ *  pointers.  Ignored for in-place transforms, and may be NULL in
+ *  that case.
+ *  @param[in] info execution info handle created by
+ *  rocfft_execution_info_create, or NULL
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_execute_pointer_array(const rocfft_plan     plan,
+                                                         void* const*          in_pointers,
+                                                         void* const*          out_pointers,
+                                                         rocfft_execution_info info);
+
 /*! @brief Destroy an FFT plan
  *  @details This API frees the plan after it is no longer needed.
  *  @param[in] plan plan handle
@@ -250,122 +747,617 @@ ROCFFT_EXPORT rocfft_status rocfft_plan_destroy(rocfft_plan plan);
 ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_scale_factor(
     rocfft_plan_description description, const double scale_factor);
 
-/*!
- *  @brief Set advanced data layout parameters on a plan description
+/*! @brief Set normalization of results.
+ *  @details rocFFT computes the normalization's factor for the
+ *  plan's direction and lengths when the plan is created, and
+ *  multiplies it into the scale factor set with
+ *  ::rocfft_plan_description_set_scale_factor.  The combined factor
+ *  is applied as the results are stored, so normalizing does not
+ *  need a separate pass over the data.
+ *
+ *  For convolution plans, any normalization other than
+ *  ::rocfft_normalization_none divides the result by N, since the
+ *  plan computes both a forward and an inverse transform.
  *
- *  @details This API specifies advanced layout of input/output
- *  buffers for a plan description.
+ *  @warning Experimental!  This feature is part of an experimental API preview.
  *
- *  The following parameters are supported for inputs and outputs:
+ *  @param[in] description description handle
+ *  @param[in] normalization normalization to apply
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_normalization(
+    rocfft_plan_description description, const rocfft_normalization normalization);
+
+/*! @brief Set storage format of input and output data.
+ *  @details rocFFT loads input data and stores output data in the
+ *  given format, and converts it to and from the plan's precision
+ *  while computing the transform.  This reduces the memory traffic
+ *  of a transform while keeping the accuracy of the plan's
+ *  precision.
+ *
+ *  Formats other than ::rocfft_storage_format_native require a
+ *  single-precision complex transform on interleaved data, and
+ *  cannot be combined with callbacks, fields or out-of-core
+ *  execution.  Plan creation fails with
+ *  ::rocfft_status_invalid_arg_value for other transforms.
+ *
+ *  Stored values that are out of range of an FP8 format saturate to
+ *  its largest finite value.  Use
+ *  ::rocfft_plan_description_set_input_scale_factor and
+ *  ::rocfft_plan_description_set_scale_factor to apply a
+ *  per-transform scale to FP8 data.
  *
- *  * Array type (real, hermitian, or complex data, in either
- *    interleaved or planar format).
- *      * Real forward transforms require real input and hermitian output.
- *      * Real inverse transforms require hermitian input and real output.
- *      * Complex transforms require complex input and output.
- *      * Hermitian and complex data defaults to interleaved if a specific
-          format is not specified.
- *  * Offset of first data element in the data buffer.  Defaults to 0 if unspecified.
- *  * Stride between consecutive elements in each dimension.  Defaults
-      to contiguous data in all dimensions if unspecified.
- *  * Distance between consecutive batches.  Defaults to contiguous
-      batches if unspecified.
+ *  @param[in] description description handle
+ *  @param[in] format storage format of input and output data
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_storage_format(
+    rocfft_plan_description description, const rocfft_storage_format format);
+
+/*! @brief Set storage format of input data only.
+ *  @details Like ::rocfft_plan_description_set_storage_format, but
+ *  only changes the format that input data is loaded from.  Output
+ *  keeps the format it already had (native by default).
  *
- *  Not all combinations of array types are supported and error codes
- *  will be returned for unsupported cases.
+ *  This additionally accepts the integer formats
+ *  ::rocfft_storage_format_int16 and ::rocfft_storage_format_int8,
+ *  for example for IQ samples straight from an ADC.  Integers are
+ *  converted to the plan's precision as-is, so use
+ *  ::rocfft_plan_description_set_input_scale_factor to normalize
+ *  them.  Integer input requires a not-in-place transform.
  *
- *  Offset, stride, and distance for either input or output provided
- *  here is ignored if a field is set for the corresponding input or
- *  output.
- * 
- *  @param[in, out] description description handle
- *  @param[in] in_array_type array type of input buffer
- *  @param[in] out_array_type array type of output buffer
- *  @param[in] in_offsets offsets, in element units, to start of data in input buffer
- *  @param[in] out_offsets offsets, in element units, to start of data in output buffer
- *  @param[in] in_strides_size size of in_strides array (must be equal to transform dimensions)
- *  @param[in] in_strides array of strides, in each dimension, of
- *   input buffer; if set to null ptr library chooses defaults
- *  @param[in] in_distance distance between start of each data instance in input buffer
- *  @param[in] out_strides_size size of out_strides array (must be
- *  equal to transform dimensions)
- *  @param[in] out_strides array of strides, in each dimension, of
- *   output buffer; if set to null ptr library chooses defaults
- *  @param[in] out_distance distance between start of each data instance in output buffer
- */
-ROCFFT_EXPORT rocfft_status
-    rocfft_plan_description_set_data_layout(rocfft_plan_description description,
-                                            const rocfft_array_type in_array_type,
-                                            const rocfft_array_type out_array_type,
-                                            const size_t*           in_offsets,
-                                            const size_t*           out_offsets,
-                                            const size_t            in_strides_size,
-                                            const size_t*           in_strides,
-                                            const size_t            in_distance,
-                                            const size_t            out_strides_size,
-                                            const size_t*           out_strides,
-                                            const size_t            out_distance);
-
-/*! @brief Create a rocfft field struct.
+ *  In-place transforms require the input and output storage formats
+ *  to match.
  *
  *  @warning Experimental!  This feature is part of an experimental API preview.
- */
-ROCFFT_EXPORT rocfft_status rocfft_field_create(rocfft_field* field);
+ *
+ *  @param[in] description description handle
+ *  @param[in] format storage format of input data
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_input_storage_format(
+    rocfft_plan_description description, const rocfft_storage_format format);
 
-/*! @brief Destroy a rocfft field struct
- * 
- * The field struct can be destroyed after being added to the plan description; it is not used for
- * plan execution.
+/*! @brief Set a window to multiply input data by.
+ *  @details rocFFT multiplies each input element by the
+ *  corresponding element of the window as it is loaded, after
+ *  converting it from the storage format and before applying the
+ *  input scale factor.  This fuses windowing into the first kernel of
+ *  the transform.
+ *
+ *  window is a device pointer to real values in the plan's
+ *  precision.  The window element for an input element is the one
+ *  at the same offset from the start of its transform, so the window
+ *  is laid out with the input strides and must hold at least input
+ *  distance elements.  The same window applies to every transform in
+ *  the batch.  rocFFT does not copy the window, so it must remain
+ *  valid while the plan is executed.
+ *
+ *  A window requires a complex transform on interleaved input, and
+ *  cannot be combined with fields.  Pass NULL to remove the window.
  *
  *  @warning Experimental!  This feature is part of an experimental API preview.
- */
-ROCFFT_EXPORT rocfft_status rocfft_field_destroy(rocfft_field field);
+ *
+ *  @param[in] description description handle
+ *  @param[in] window device pointer to the window, or NULL
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_input_window(
+    rocfft_plan_description description, const void* window);
 
-/*! @brief Get library version string
+/*! @brief Zero-pad input data up to the transform length.
+ *  @details Only the first valid_lengths[d] elements of input
+ *  dimension d are loaded.  Elements past them are taken as zero
+ *  without being read, so the caller does not need to clear the
+ *  padding in the input buffer.
+ *
+ *  Where the plan's first kernel transforms whole sub-transforms
+ *  (pencils) that lie entirely in the padding, it skips them, and
+ *  the kernel after it loads their results as zero.  The first pass
+ *  of a 3D transform of a padded sub-box then only does work
+ *  proportional to the sub-box's cross section.
+ *
+ *  dimensions must match the plan's dimensions, and each valid length
+ *  must be between 1 and the transform length of its dimension.
+ *  The input strides and distance still describe the full transform
+ *  lengths, and must not overlap.
+ *
+ *  Zero-padding requires a complex transform on interleaved input,
+ *  and cannot be combined with fields.  Pass 0 dimensions to remove
+ *  the padding.
  *
- * @param[in, out] buf buffer that receives the version string
- * @param[in] len length of buf, minimum 30 characters
- */
-ROCFFT_EXPORT rocfft_status rocfft_get_version_string(char* buf, size_t len);
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] dimensions number of valid lengths
+ *  @param[in] valid_lengths number of valid elements in each input
+ *  dimension
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_input_zero_padding(
+    rocfft_plan_description description, const size_t dimensions, const size_t* valid_lengths);
 
-/*! @brief Set the communication library for distributed transforms.
+/*! @brief Truncate output data to a smaller logical length.
+ *  @details Only the first kept_lengths[d] elements of output
+ *  dimension d are stored.  The rest of the transform's output is
+ *  discarded without being written, so the output buffer is left
+ *  unchanged past the kept lengths.
+ *
+ *  Together with ::rocfft_plan_description_set_input_zero_padding,
+ *  this computes an FFT of N samples padded to a larger length M
+ *  without the caller clearing or reading back the padded parts of
+ *  the buffers.
+ *
+ *  dimensions must match the plan's dimensions, and each kept length
+ *  must be between 1 and the output length of its dimension.  The
+ *  output strides and distance still describe the full output
+ *  lengths, and must not overlap.
+ *
+ *  Truncation is applied by the plan's last kernel, and has the
+ *  same restrictions as ::rocfft_plan_description_set_output_op.
+ *  This replaces any pruning set with
+ *  ::rocfft_plan_description_set_output_pruning.  Pass 0 dimensions
+ *  to remove the truncation.
  *
- *  @details Set the multi-processing communication library for a plan.
+ *  @warning Experimental!  This feature is part of an experimental API preview.
  *
- *  Multi-processing communication libraries require library-specific
- *  handle to also be specified.  For MPI libraries, this is a
- *  pointer to an MPI communicator.
+ *  @param[in] description description handle
+ *  @param[in] dimensions number of kept lengths
+ *  @param[in] kept_lengths number of elements to store in each
+ *  output dimension
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_output_truncation(
+    rocfft_plan_description description, const size_t dimensions, const size_t* kept_lengths);
+
+/*! @brief Compute only a range of output bins.
+ *  @details Only output elements whose index along dimension d is in
+ *  [first_bins[d], first_bins[d] + bin_counts[d]) are stored.  The
+ *  output buffer is left unchanged outside that range.  Where the
+ *  plan's last kernel computes whole sub-transforms that fall
+ *  outside the range, it skips them instead of discarding their
+ *  results.
+ *
+ *  This replaces any truncation set with
+ *  ::rocfft_plan_description_set_output_truncation, which is
+ *  equivalent to pruning with all first bins set to 0.
+ *
+ *  dimensions must match the plan's dimensions, each bin count must
+ *  be at least 1, and each range must fit in the output length of
+ *  its dimension.  The output strides and distance still describe
+ *  the full output lengths, and must not overlap.
+ *
+ *  Pruning has the same restrictions as
+ *  ::rocfft_plan_description_set_output_truncation.  Pass 0
+ *  dimensions to remove the pruning.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
  *
  *  @param[in] description description handle
- *  @param[in] comm_type communicator type
- *  @param[in] comm_handle handle to communication-library-specific state
- * 
- */
-ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_comm(rocfft_plan_description description,
-                                                             rocfft_comm_type        comm_type,
-                                                             void*                   comm_handle);
+ *  @param[in] dimensions number of bin ranges
+ *  @param[in] first_bins first bin to store in each output dimension
+ *  @param[in] bin_counts number of bins to store in each output
+ *  dimension
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_output_pruning(
+    rocfft_plan_description description,
+    const size_t            dimensions,
+    const size_t*           first_bins,
+    const size_t*           bin_counts);
 
-/*! @brief Define a brick as part of a decomposition of a field.
+/*! @brief Set storage format of output data only.
+ *  @details Like ::rocfft_plan_description_set_storage_format, but
+ *  only changes the format that output data is stored in.  Input
+ *  keeps the format it already had (native by default).  Integer
+ *  formats are not accepted.
  *
- * Fields can contain a full-dimensional data distribution.  The
- * decomposition is specified by providing a lower coordinate and an
- * upper coordinate in the field's index space.  The lower coordinate
- * is inclusive (contained within the brick) and the upper coordinate
- * is exclusive (first index past the end of the brick).
+ *  In-place transforms require the input and output storage formats
+ *  to match.
  *
- * One must also provide a stride for the brick data which specifies
- * how the brick's data is arranged in memory.
+ *  @warning Experimental!  This feature is part of an experimental API preview.
  *
- * All coordinates and strides include batch dimensions.
+ *  @param[in] description description handle
+ *  @param[in] format storage format of output data
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_output_storage_format(
+    rocfft_plan_description description, const rocfft_storage_format format);
+
+/*! @brief Set an operation to apply to the output.
+ *  @details rocFFT applies the operation to each complex result as
+ *  it is stored, after the scale factor and before conversion to
+ *  the output storage format.  For operations other than
+ *  ::rocfft_output_op_none, each output element is a single real
+ *  value, so the output buffer holds real numbers, at the positions
+ *  given by the output strides and distance.  The output array type
+ *  still describes the complex results (for example,
+ *  ::rocfft_array_type_hermitian_interleaved for a real-to-complex
+ *  transform), and the output strides and distance are counted in
+ *  the real output elements.
+ *
+ *  Output operations require a not-in-place complex or
+ *  real-to-complex transform with interleaved output, and cannot be
+ *  combined with callbacks, fields or out-of-core execution.  Plan
+ *  creation fails if the plan's last kernel cannot apply the
+ *  operation.
  *
- * A HIP device ID is also provided - each brick may reside on a
- * different device.
+ *  @warning Experimental!  This feature is part of an experimental API preview.
  *
- * All arrays may be re-used or freed immediately after the function returns.
+ *  @param[in] description description handle
+ *  @param[in] op operation to apply to each output element
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_output_op(
+    rocfft_plan_description description, const rocfft_output_op op);
+
+/*! @brief Accumulate into the output buffer.
+ *  @details If accumulate is nonzero, rocFFT adds each output value
+ *  to the value already in the output buffer (out += X), instead of
+ *  overwriting it.  Accumulation happens after any output operation
+ *  set with ::rocfft_plan_description_set_output_op, so that for
+ *  example power spectra of several transforms can be summed by
+ *  executing the plan repeatedly.
  *
- * @param[out] brick: brick structure
- * @param[in] field_lower: array of length dim specifying the lower index (inclusive) for the brick in the
- * field's index space.
+ *  Accumulation has the same restrictions as output operations.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] accumulate nonzero to add to the existing output
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_output_accumulate(
+    rocfft_plan_description description, const int accumulate);
+
+/*! @brief Set a load callback given as source code.
+ *  @details Instead of a device function pointer, the load callback
+ *  is given as HIP source code that rocFFT compiles into the
+ *  transform's kernels at plan creation time.  The source must
+ *  define a device function named 'function_name' with the load
+ *  callback signature:
+ *
+ *  @code
+ *  __device__ T function_name(T* data, size_t offset, void* cbdata, void* sharedMem);
+ *  @endcode
+ *
+ *  'T' is the type of a single input element, as described for
+ *  ::rocfft_execution_info_set_load_callback.  The source may not
+ *  include any headers, but may use rocfft_complex<float>,
+ *  rocfft_complex<double> and _Float16.
+ *
+ *  Data for the callback is supplied at execution time by calling
+ *  ::rocfft_execution_info_set_load_callback with null function
+ *  pointers.
+ *
+ *  Compiled kernels are cached by a hash of the source, so plans
+ *  using the same callback source do not recompile it.
+ *
+ *  Null source or function_name clears a previously set load
+ *  callback source.  Callbacks given as source are not supported
+ *  with storage formats or output operations.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] source HIP source code defining the callback
+ *  @param[in] function_name name of the callback function
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_load_callback_source(
+    rocfft_plan_description description, const char* source, const char* function_name);
+
+/*! @brief Set a store callback given as source code.
+ *  @details Like ::rocfft_plan_description_set_load_callback_source,
+ *  but for the store callback, which has the signature:
+ *
+ *  @code
+ *  __device__ void function_name(T* data, size_t offset, T element, void* cbdata, void* sharedMem);
+ *  @endcode
+ *
+ *  Data for the callback is supplied by calling
+ *  ::rocfft_execution_info_set_store_callback with null function
+ *  pointers.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] source HIP source code defining the callback
+ *  @param[in] function_name name of the callback function
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_store_callback_source(
+    rocfft_plan_description description, const char* source, const char* function_name);
+
+/*! @brief Allow store callbacks on any pass of the plan.
+ *  @details Normally, callback kernels are only built for the
+ *  kernels that read the input and write the output.  If enable is
+ *  nonzero, they are built for every kernel of the plan, so that
+ *  ::rocfft_execution_info_set_pass_store_callback can run a
+ *  callback between the plan's passes.  This makes plan creation
+ *  slower.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] enable nonzero to build callback kernels for every pass
+ *  */
+ROCFFT_EXPORT rocfft_status
+    rocfft_plan_description_set_pass_callbacks(rocfft_plan_description description,
+                                               const int               enable);
+
+/*! @brief Set input scaling factor.
+ *  @details rocFFT multiplies each element of the input by the given
+ *  factor as it is loaded, after converting it from the storage
+ *  format.  rocfft_plan_description_set_scale_factor scales the
+ *  result before it is converted to the storage format.
+ *
+ *  The supplied factor must be a finite number.  That is, it must neither be infinity nor NaN.
+ *
+ *  @param[in] description description handle
+ *  @param[in] scale_factor scaling factor
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_input_scale_factor(
+    rocfft_plan_description description, const double scale_factor);
+
+/*! @brief Ask for the smallest work buffer
+ *  @details By default, rocFFT balances work buffer size against
+ *  the number of kernels it can fuse together.  If minimize is
+ *  nonzero, plans created with this description instead choose the
+ *  internal buffer arrangement that needs the smallest work buffer,
+ *  even if that requires more kernels or slower memory access
+ *  patterns.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] minimize nonzero to minimize work buffer size
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_minimize_work_buffer(
+    rocfft_plan_description description, const int minimize);
+
+/*! @brief Choose what plans are optimized for
+ *  @details By default, rocFFT chooses algorithms and buffer
+ *  arrangements for throughput, on the assumption that the plan is
+ *  executed many times on large batches.
+ *
+ *  With ::rocfft_optimization_goal_latency, plans created with this
+ *  description fuse as many kernels as they can, even if that needs
+ *  a larger work buffer.  Small batches of long 1D transforms that
+ *  would otherwise run in a single kernel are split over two kernels
+ *  whenever one kernel would not occupy every compute unit.
+ *
+ *  With ::rocfft_optimization_goal_memory, plans choose the internal
+ *  buffer arrangement that needs the smallest work buffer, and never
+ *  split a transform that fits in one kernel.  This is the same as
+ *  ::rocfft_plan_description_set_minimize_work_buffer with a nonzero
+ *  argument.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] goal what to optimize plans for
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_optimization_goal(
+    rocfft_plan_description description, rocfft_optimization_goal goal);
+
+/*! @brief Generate plan tables without waiting for them
+ *  @details By default, plan creation waits for the device to finish
+ *  generating the twiddle and chirp tables that the plan needs.  If
+ *  a stream is set, plans created with this description instead
+ *  order table generation after work already enqueued on the stream,
+ *  and return without waiting for it to finish.  Work enqueued on
+ *  the stream afterwards is ordered after the tables, and executions
+ *  of the plan on any stream wait for them.
+ *
+ *  The stream must be of type hipStream_t on the device that the
+ *  plan is created for, and must stay valid until plan creation
+ *  returns.  Multi-device plans ignore the stream.
+ *
+ *  ::rocfft_plan_capture_graph waits on the host for the tables
+ *  before capturing.  Callers that capture execution into their own
+ *  graph must synchronize the stream before beginning the capture.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] stream stream to order table generation with, or NULL
+ *  to wait for table generation during plan creation
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_table_stream(
+    rocfft_plan_description description, void* stream);
+
+/*! @brief Execute plans on buffers in host memory
+ *  @details Plans created with this description are given host
+ *  buffers by ::rocfft_execute, which executes them the same way as
+ *  ::rocfft_execute_out_of_core: the batch is copied to the device,
+ *  transformed, and copied back in chunks, with the copies of one
+ *  chunk overlapping the transform of another.  This is usually
+ *  faster than copying the whole batch, executing, and copying it
+ *  back.
+ *
+ *  The same restrictions as ::rocfft_execute_out_of_core apply.
+ *  ::rocfft_execute_batch and ::rocfft_plan_capture_graph do not
+ *  accept these plans.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] host_buffers nonzero if buffers given to
+ *  ::rocfft_execute are in host memory
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_host_buffers(
+    rocfft_plan_description description, const int host_buffers);
+
+/*! @brief Store the Hermitian side of real transforms in packed form
+ *  @details Real-to-complex transforms ordinarily produce N/2+1
+ *  complex elements along the fastest dimension, which takes two
+ *  more real values than the input and requires padded allocations
+ *  for in-place transforms.  Plans created with this description
+ *  instead store N/2 complex elements along the fastest dimension,
+ *  so the Hermitian data takes exactly the space of the real data.
+ *
+ *  Element 0 of each row holds X[0] + i*X[N/2], where X[0] and
+ *  X[N/2] are the ordinary Hermitian outputs for the first and last
+ *  elements of that row.  The other elements are unchanged.  For 1D
+ *  transforms, X[0] and X[N/2] are real, so element 0 is
+ *  (X[0], X[N/2]).  Complex-to-real transforms read the same format.
+ *
+ *  The fastest real length must be even, and the Hermitian data must
+ *  be ::rocfft_array_type_hermitian_interleaved.  Lengths and default
+ *  strides and distances of the Hermitian side are counted in packed
+ *  elements.  Transforms of rank greater than 3, tiled batches,
+ *  output pruning, and distributed or multi-device plans are not
+ *  supported.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] packed nonzero to pack the Hermitian side of real
+ *  transforms
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_packed_hermitian(
+    rocfft_plan_description description, const int packed);
+
+/*! @brief Measure kernel access modes during plan creation
+ *  @details SBCC, SBRC and SBCR kernels can load and store global
+ *  memory directly to and from registers, and some can use buffer
+ *  instructions.  By default, rocFFT chooses these modes from rules
+ *  for each device architecture.  Plans created with this
+ *  description instead benchmark each mode on the device during
+ *  plan creation, if the problem has no tuned solution yet, and
+ *  build the plan with the fastest ones.
+ *
+ *  The measured solution is written to the folder given by the
+ *  ROCFFT_USER_SOL_MAP_PATH environment variable, and is reused by
+ *  later plans for the same problem on the same architecture,
+ *  including in other processes.  The solution maps given by the
+ *  environment are then reloaded, as ::rocfft_solution_map_reload
+ *  does for a NULL path.  If ROCFFT_USER_SOL_MAP_PATH is not set,
+ *  or the rocfft_offline_tuner program cannot be found, plans are
+ *  built as usual.
+ *
+ *  Measuring can make plan creation take several seconds.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] description description handle
+ *  @param[in] measure nonzero to measure access modes
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_measure_access_modes(
+    rocfft_plan_description description, const int measure);
+
+/*!
+ *  @brief Set advanced data layout parameters on a plan description
+ *
+ *  @details This API specifies advanced layout of input/output
+ *  buffers for a plan description.
+ *
+ *  The following parameters are supported for inputs and outputs:
+ *
+ *  * Array type (real, hermitian, or complex data, in either
+ *    interleaved or planar format).
+ *      * Real forward transforms require real input and hermitian output.
+ *      * Real inverse transforms require hermitian input and real output.
+ *      * Complex transforms require complex input and output.
+ *      * Hermitian and complex data defaults to interleaved if a specific
+          format is not specified.
+ *  * Offset of first data element in the data buffer.  Defaults to 0 if unspecified.
+ *  * Stride between consecutive elements in each dimension.  Defaults
+      to contiguous data in all dimensions if unspecified.
+ *  * Distance between consecutive batches.  Defaults to contiguous
+      batches if unspecified.
+ *
+ *  Not all combinations of array types are supported and error codes
+ *  will be returned for unsupported cases.
+ *
+ *  Offset, stride, and distance for either input or output provided
+ *  here is ignored if a field is set for the corresponding input or
+ *  output.
+ * 
+ *  @param[in, out] description description handle
+ *  @param[in] in_array_type array type of input buffer
+ *  @param[in] out_array_type array type of output buffer
+ *  @param[in] in_offsets offsets, in element units, to start of data in input buffer
+ *  @param[in] out_offsets offsets, in element units, to start of data in output buffer
+ *  @param[in] in_strides_size size of in_strides array (must be equal to transform dimensions)
+ *  @param[in] in_strides array of strides, in each dimension, of
+ *   input buffer; if set to null ptr library chooses defaults
+ *  @param[in] in_distance distance between start of each data instance in input buffer
+ *  @param[in] out_strides_size size of out_strides array (must be
+ *  equal to transform dimensions)
+ *  @param[in] out_strides array of strides, in each dimension, of
+ *   output buffer; if set to null ptr library chooses defaults
+ *  @param[in] out_distance distance between start of each data instance in output buffer
+ */
+ROCFFT_EXPORT rocfft_status
+    rocfft_plan_description_set_data_layout(rocfft_plan_description description,
+                                            const rocfft_array_type in_array_type,
+                                            const rocfft_array_type out_array_type,
+                                            const size_t*           in_offsets,
+                                            const size_t*           out_offsets,
+                                            const size_t            in_strides_size,
+                                            const size_t*           in_strides,
+                                            const size_t            in_distance,
+                                            const size_t            out_strides_size,
+                                            const size_t*           out_strides,
+                                            const size_t            out_distance);
+
+/*! @brief Create a rocfft field struct.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ */
+ROCFFT_EXPORT rocfft_status rocfft_field_create(rocfft_field* field);
+
+/*! @brief Destroy a rocfft field struct
+ * 
+ * The field struct can be destroyed after being added to the plan description; it is not used for
+ * plan execution.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ */
+ROCFFT_EXPORT rocfft_status rocfft_field_destroy(rocfft_field field);
+
+/*! @brief Get library version string
+ *
+ * @param[in, out] buf buffer that receives the version string
+ * @param[in] len length of buf, minimum 30 characters
+ */
+ROCFFT_EXPORT rocfft_status rocfft_get_version_string(char* buf, size_t len);
+
+/*! @brief Set the communication library for distributed transforms.
+ *
+ *  @details Set the multi-processing communication library for a plan.
+ *
+ *  Multi-processing communication libraries require library-specific
+ *  handle to also be specified.  For MPI libraries, this is a
+ *  pointer to an MPI communicator.
+ *
+ *  For RCCL, this is a pointer to an ncclComm_t, whose device must
+ *  be the device of all bricks that this rank provides.  RCCL
+ *  sends and receives are ordered on streams on that device rather
+ *  than progressed by the host.  The communicator is not
+ *  duplicated, so it must remain valid for the lifetime of plans
+ *  created from this description.
+ *
+ *  @param[in] description description handle
+ *  @param[in] comm_type communicator type
+ *  @param[in] comm_handle handle to communication-library-specific state
+ * 
+ */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_comm(rocfft_plan_description description,
+                                                             rocfft_comm_type        comm_type,
+                                                             void*                   comm_handle);
+
+/*! @brief Define a brick as part of a decomposition of a field.
+ *
+ * Fields can contain a full-dimensional data distribution.  The
+ * decomposition is specified by providing a lower coordinate and an
+ * upper coordinate in the field's index space.  The lower coordinate
+ * is inclusive (contained within the brick) and the upper coordinate
+ * is exclusive (first index past the end of the brick).
+ *
+ * One must also provide a stride for the brick data which specifies
+ * how the brick's data is arranged in memory.
+ *
+ * All coordinates and strides include batch dimensions.
+ *
+ * A HIP device ID is also provided - each brick may reside on a
+ * different device.
+ *
+ * All arrays may be re-used or freed immediately after the function returns.
+ *
+ * @param[out] brick: brick structure
+ * @param[in] field_lower: array of length dim specifying the lower index (inclusive) for the brick in the
+ * field's index space.
  * @param[in] field_upper: array of length dim specifying the upper index (exclusive) for the brick in the
  * field's index space.
  * @param[in] brick_stride: array of length dim specifying the brick's stride in memory
@@ -428,13 +1420,286 @@ ROCFFT_EXPORT rocfft_status rocfft_plan_description_add_infield(rocfft_plan_desc
 ROCFFT_EXPORT rocfft_status
     rocfft_plan_description_add_outfield(rocfft_plan_description description, rocfft_field field);
 
+/*! @brief Limit the size of data exchanges between bricks.
+ *
+ * Multi-device plans move data between bricks by packing it into
+ * staging buffers, sending it, and unpacking it at the destination.
+ * By default each exchange is staged in one piece.  If chunk_bytes
+ * is nonzero, exchanges are split into pieces of at most that many
+ * bytes along their slowest dimension, which reuse the same staging
+ * buffers one after another.  A piece is never smaller than one
+ * slice of the slowest dimension, so chunks may exceed chunk_bytes
+ * if a single slice does.
+ *
+ * This bounds the extra device memory used for staging, at the cost
+ * of serializing the pieces of each exchange.  It is most useful
+ * with in-place multi-device transforms of problems that nearly
+ * fill device memory.
+ *
+ * @param[in, out] description: \ref rocfft_plan_description to modify
+ * @param[in] chunk_bytes: largest exchange piece in bytes, or 0 for no limit
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_exchange_chunk_size(
+    rocfft_plan_description description, size_t chunk_bytes);
+
+/*! @brief Interleave the transforms of a batch in tiles.
+ *
+ * By default, each transform in a batch occupies its own region of
+ * the buffer, distance elements after the previous one.  If
+ * tile_width is greater than 1, the batch is instead split into
+ * tiles of tile_width transforms that are interleaved element by
+ * element: the element at offset o (computed from the strides set
+ * by \ref rocfft_plan_description_set_data_layout) of transform b
+ * is stored at
+ *
+ *   (b / tile_width) * distance + o * tile_width + b % tile_width
+ *
+ * The distances given to the plan are the distances between tiles,
+ * and default to tile_width times the usual distance.  The number
+ * of transforms must be a multiple of tile_width.  Tiled batches
+ * cannot be combined with bricks or real-to-real transforms.
+ *
+ * @param[in, out] description: \ref rocfft_plan_description to modify
+ * @param[in] tile_width: number of transforms in each tile, 1 to disable tiling
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_batch_tile(
+    rocfft_plan_description description, size_t tile_width);
+
+/*! @brief Confine a plan to a subset of the device's compute units.
+ *
+ * When FFTs share a device with other work that is confined to
+ * other compute units (CUs), the plan should be sized for the CUs
+ * it actually runs on.  cu_mask is a bit mask of CUs in the same
+ * form as for hipExtStreamCreateWithCUMask: bit i of word w enables
+ * CU 32 * w + i.
+ *
+ * Plan creation sizes launch grids and looks up tuned solutions for
+ * the number of CUs in the mask, as it would for a device with that
+ * many CUs.  Streams that the plan creates for itself, such as those
+ * of multi-device plans, are created with the mask.  Kernels that
+ * run on the stream given by ::rocfft_execution_info_set_stream are
+ * only confined to the mask if that stream was created with it.
+ *
+ * A cu_mask_size of 0 removes the mask.
+ *
+ * @param[in, out] description: \ref rocfft_plan_description to modify
+ * @param[in] cu_mask_size: number of 32-bit words in cu_mask
+ * @param[in] cu_mask: mask of enabled CUs, with at least one bit set
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_cu_mask(
+    rocfft_plan_description description, size_t cu_mask_size, const uint32_t* cu_mask);
+
+/*! @brief Set the format that data is exchanged between bricks in.
+ *
+ * By default, multi-device plans exchange data in the precision of
+ * the plan.  A narrower format reduces the bytes sent between
+ * devices and processes, which usually limit the speed of
+ * multi-device transforms, at the cost of accuracy.  Data is
+ * converted as it's packed before sending, and converted back to
+ * the plan's precision as it's unpacked, so bricks keep the plan's
+ * precision and every FFT is computed in it.  Only data that is
+ * exchanged loses precision.
+ *
+ * ::rocfft_storage_format_single may be used by double-precision
+ * plans, and ::rocfft_storage_format_half or
+ * ::rocfft_storage_format_bfloat16 by single-precision plans.
+ * Plan creation fails with ::rocfft_status_invalid_arg_value for
+ * other combinations, and for planar data.  Exchanges in another
+ * format are always packed and unpacked, even where the plan would
+ * otherwise send or receive data in place.
+ *
+ * @param[in, out] description: \ref rocfft_plan_description to modify
+ * @param[in] format: format of exchanged data, or ::rocfft_storage_format_native
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_exchange_storage_format(
+    rocfft_plan_description description, rocfft_storage_format format);
+
+/*! @brief Distribute a plan over a list of devices.
+ *
+ * A plan normally runs on the current device.  With a list of
+ * devices, the plan takes ordinary input and output buffers on the
+ * current device, as described by the rest of the plan description,
+ * and runs the transform across the listed devices.  rocFFT chooses
+ * how the data is divided into bricks, scatters it to internal
+ * buffers on each device, and gathers the result back to the
+ * output buffer.  Callers don't add fields to the description.
+ *
+ * The plan supports the same features as plans with fields, and
+ * plan creation fails with ::rocfft_status_invalid_arg_value if
+ * the description also has fields or a communicator, if a device
+ * is listed twice or does not exist, or if the data is planar.
+ * Transforms that can't be divided over the devices run on the
+ * current device.
+ *
+ * Passing a null list with a count of zero restores the default of
+ * running on the current device.
+ *
+ * @param[in, out] description: \ref rocfft_plan_description to modify
+ * @param[in] devices: array of device IDs to run on
+ * @param[in] num_devices: number of device IDs in the array
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ */
+ROCFFT_EXPORT rocfft_status rocfft_plan_description_set_devices(
+    rocfft_plan_description description, const int* devices, size_t num_devices);
+
 /*! @brief Get work buffer size
  *  @details Get the work buffer size required for a plan.
  *  @param[in] plan plan handle
  *  @param[out] size_in_bytes size of needed work buffer in bytes
  *  */
-ROCFFT_EXPORT rocfft_status rocfft_plan_get_work_buffer_size(const rocfft_plan plan,
-                                                             size_t*           size_in_bytes);
+ROCFFT_EXPORT rocfft_status rocfft_plan_get_work_buffer_size(const rocfft_plan plan,
+                                                             size_t*           size_in_bytes);
+
+/*! @brief Resource and cost estimates for a plan
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_plan_info_s
+{
+    /*! number of kernels launched per execution */
+    size_t kernel_count;
+    /*! number of kernels that read and write data in global memory */
+    size_t global_memory_passes;
+    /*! estimated number of bytes read from and written to global
+     *  memory per execution */
+    size_t estimated_bytes_moved;
+    /*! work buffer size, as returned by ::rocfft_plan_get_work_buffer_size */
+    size_t work_buffer_bytes;
+    /*! bytes of twiddle and chirp tables used by the plan.  Tables
+     *  are shared between plans that need identical ones, so these
+     *  bytes may not be unique to this plan. */
+    size_t twiddle_bytes;
+} rocfft_plan_info;
+
+/*! @brief Query resource and cost estimates for a plan
+ *  @details Returns the number of kernels the plan launches, the
+ *  number of passes over global memory, estimated memory traffic,
+ *  and the device memory it uses, without executing the plan.
+ *
+ *  For plans that span multiple processes, only work done by the
+ *  current process is counted.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan plan handle
+ *  @param[out] info receives the plan information
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_get_info(const rocfft_plan plan, rocfft_plan_info* info);
+
+/*! @brief Time spent in each phase of plan creation
+ *
+ *  @details Kernels are generated, looked up, compiled and loaded
+ *  on worker threads in parallel, so those phases are summed over
+ *  all workers and may add up to more than the total.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_plan_create_times_s
+{
+    /*! looking up the problem in the solution map */
+    double solution_map_ms;
+    /*! building the tree of plan nodes */
+    double build_tree_ms;
+    /*! fusing kernels */
+    double fusion_ms;
+    /*! assigning and padding buffers */
+    double buffer_assignment_ms;
+    /*! generating kernel source code */
+    double kernel_generation_ms;
+    /*! looking up compiled kernels in the caches */
+    double rtc_cache_lookup_ms;
+    /*! compiling kernels that were not cached */
+    double rtc_compile_ms;
+    /*! loading compiled kernels onto the device */
+    double module_load_ms;
+    /*! generating twiddle and chirp tables and kernel arguments */
+    double tables_ms;
+    /*! wall-clock time of the whole plan creation */
+    double total_ms;
+} rocfft_plan_create_times;
+
+/*! @brief Query where plan creation spent its time
+ *  @details The same times are written to the plan log when plan
+ *  logging is enabled.  A plan found in the plan cache reports
+ *  only the time taken to find it.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan plan handle
+ *  @param[out] times receives the plan creation times
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_get_create_times(const rocfft_plan         plan,
+                                                         rocfft_plan_create_times* times);
+
+/*! @brief Serialize a plan's decisions
+ *  @details Serialize the parameters of a plan and the decisions
+ *  made while creating it (the decomposition of the transform,
+ *  the kernels chosen from the solution map and the assignment of
+ *  buffers) into a buffer.  The buffer can be passed to
+ *  ::rocfft_plan_deserialize, possibly in another process, to
+ *  create the same plan without making those decisions again.
+ *
+ *  The buffer is allocated by rocFFT and must be freed with a call
+ *  to ::rocfft_plan_buffer_free.
+ *
+ *  Only plans that run on a single device can be serialized.
+ *  ::rocfft_status_invalid_arg_value is returned for plans that
+ *  communicate between processes or devices, for plans whose
+ *  descriptions name the devices to run on, and for plans whose
+ *  descriptions refer to memory or code of the process (input
+ *  windows, multiplied buffers and inline callbacks) or set
+ *  zero padding or output truncation.  A CU mask set on the
+ *  description is part of the buffer.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan plan handle
+ *  @param[out] buffer receives the allocated buffer
+ *  @param[out] buffer_len_bytes receives the length of the buffer
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_serialize(const rocfft_plan plan,
+                                                  void**            buffer,
+                                                  size_t*           buffer_len_bytes);
+
+/*! @brief Free plan serialization buffer
+ *  @details Deallocate a buffer allocated by ::rocfft_plan_serialize.
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_buffer_free(void* buffer);
+
+/*! @brief Create a plan from a serialized buffer
+ *  @details Create a plan from a buffer written by
+ *  ::rocfft_plan_serialize.  If the current device has the same
+ *  architecture as the device the plan was serialized on, the
+ *  recorded decisions are replayed, so that only kernel loading
+ *  and twiddle table generation remain.  Otherwise, or if the
+ *  decisions do not fit this build of rocFFT, the plan is created
+ *  from its parameters as ::rocfft_plan_create would.
+ *
+ *  Compiled kernels are not part of the buffer - they can be
+ *  distributed with ::rocfft_cache_serialize.
+ *
+ *  ::rocfft_status_invalid_arg_value is returned if the buffer was
+ *  not written by this version of rocFFT, or has been modified.
+ *  The plan must be freed with a call to ::rocfft_plan_destroy.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[out] plan plan handle
+ *  @param[in] buffer buffer from ::rocfft_plan_serialize
+ *  @param[in] buffer_len_bytes length of the buffer
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_deserialize(rocfft_plan* plan,
+                                                    const void*  buffer,
+                                                    size_t       buffer_len_bytes);
 
 /*! @brief Print all plan information
  *  @details Prints plan details to stdout, to aid debugging
@@ -530,6 +1795,156 @@ ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_mode( rocfft_execution_inf
 ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_stream(rocfft_execution_info info,
                                                              void*                 stream);
 
+/*! @brief Set the priority of streams a plan creates for itself
+ *  @details Multi-device plans create streams of their own for
+ *  transfers and for work on devices other than the one the user's
+ *  stream is on.  Those streams are created with this priority, so
+ *  that an execution can be prioritized over (or under) other work
+ *  sharing the device.  Priorities are as for
+ *  hipStreamCreateWithPriority: lower numbers are higher priorities,
+ *  and values outside the device's range are clamped to it.  The
+ *  default is 0.
+ *
+ *  The priority of the stream given by
+ *  ::rocfft_execution_info_set_stream is not changed.  Streams of
+ *  plans confined to compute units with
+ *  ::rocfft_plan_description_set_cu_mask are created with the mask
+ *  instead, which HIP does not allow to be combined with a priority.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] info execution info handle
+ *  @param[in] priority priority of internal streams
+ *  */
+ROCFFT_EXPORT rocfft_status
+    rocfft_execution_info_set_stream_priority(rocfft_execution_info info, int priority);
+
+/*! @brief Set graph capture mode in execution info
+ *  @details When capture mode is enabled, ::rocfft_execute
+ *  guarantees that it performs no memory or HIP object allocations
+ *  and no host synchronization, so that the execution can be
+ *  captured into a hipGraph and replayed.
+ *
+ *  In capture mode:
+ *
+ *  - a work buffer must be provided with
+ *    ::rocfft_execution_info_set_work_buffer if the plan requires
+ *    one, otherwise ::rocfft_status_invalid_work_buffer is returned.
+ *  - plans that span multiple devices or processes cannot be
+ *    executed, and ::rocfft_status_invalid_arg_value is returned.
+ *  - profile and kernel IO logging are disabled.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] info execution info handle
+ *  @param[in] capture nonzero to enable capture mode
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_capture_mode(rocfft_execution_info info,
+                                                                  int                   capture);
+
+/*! @brief Set the number of transforms to execute
+ *  @details Lets a plan created for a batch of transforms execute
+ *  fewer of them, so that one plan can serve batches of varying
+ *  size up to the one it was created for.  The first batch
+ *  transforms at the start of the input and output buffers are
+ *  executed, using the plan's strides and distances.  Launch grids
+ *  are derived from the batch when the plan is executed.
+ *
+ *  A batch of 0, which is the default, executes the plan's whole
+ *  batch.  ::rocfft_execute returns ::rocfft_status_invalid_arg_value
+ *  if the batch is larger than the plan's, or if the plan spans
+ *  multiple devices, uses host buffers or is a convolution plan.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] info execution info handle
+ *  @param[in] batch number of transforms to execute
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_batch(rocfft_execution_info info,
+                                                            size_t                batch);
+
+/*! @brief Capture the execution of a plan into a hipGraph
+ *  @details Records the kernels that ::rocfft_execute would
+ *  launch for the given buffers into a new hipGraph_t, which is
+ *  returned in graph.  The caller owns the graph and must destroy it
+ *  with hipGraphDestroy.  Nothing is executed by this call.
+ *
+ *  Execution is captured in capture mode (see
+ *  ::rocfft_execution_info_set_capture_mode), so the same
+ *  restrictions apply.  If the execution info specifies a stream,
+ *  that stream is used for capture; otherwise a temporary stream is
+ *  used.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan plan handle
+ *  @param[in] in_buffer input buffers, as for ::rocfft_execute
+ *  @param[in] out_buffer output buffers, as for ::rocfft_execute
+ *  @param[in] info execution info handle, may be NULL
+ *  @param[out] graph receives the captured hipGraph_t
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_plan_capture_graph(const rocfft_plan     plan,
+                                                      void*                 in_buffer[],
+                                                      void*                 out_buffer[],
+                                                      rocfft_execution_info info,
+                                                      void**                graph);
+
+/*! @brief Limit the memory retained by the work buffer pool
+ *  @details If no work buffer is provided to ::rocfft_execute for a
+ *  plan that needs one, rocFFT allocates the work buffer from a
+ *  per-device, stream-ordered memory pool and returns it to the pool
+ *  when the transform finishes.  Memory in the pool is reused by
+ *  later executions instead of being reallocated.
+ *
+ *  This API sets the number of bytes each device's pool may keep
+ *  allocated while idle.  By default, the pool keeps all of its
+ *  memory.  Memory beyond the new limit is released immediately.
+ *
+ *  The limit is a retention threshold, not a cap on allocations.
+ *  Work buffers are still allocated from the pool while more than
+ *  the limit is in use, and unused memory beyond the limit is
+ *  released when the execution stream is next synchronized.
+ *
+ *  Setting the ROCFFT_WORK_BUFFER_POOL environment variable to 0
+ *  disables the pool.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] size_in_bytes bytes each device's pool may retain
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_work_buffer_pool_set_limit(size_t size_in_bytes);
+
+/*! @brief Release unused memory held by the work buffer pool
+ *  @details Releases all memory held by the work buffer pool that is
+ *  not in use by a pending execution.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_work_buffer_pool_trim();
+
+/*! @brief Reload the solution map used for plan creation
+ *  @details Reads a new solution map and swaps it in for plans
+ *  created afterwards.  Plan creation that is already under way keeps
+ *  using the previous map, and existing plans are not changed.  This
+ *  allows a long-running process to pick up newly-tuned solutions
+ *  without restarting.
+ *
+ *  path may be a solution map file, or a folder of solution maps,
+ *  the same as the ROCFFT_READ_EXPLICIT_SOL_MAP_FILE and
+ *  ROCFFT_READ_SOL_MAP_FROM_FOLDER environment variables.  If path
+ *  is NULL, the solution maps given by the environment are read
+ *  again.  Solutions tuned on first use in ROCFFT_USER_SOL_MAP_PATH
+ *  are always read.
+ *
+ *  If the map can't be read, the current map stays in use and
+ *  ::rocfft_status_failure is returned.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] path solution map file or folder, or NULL
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_solution_map_reload(const char* path);
+
 /*! @brief Set a load callback for a plan execution (experimental)
  *  @details This function specifies a user-defined callback function
  *  that is run to load input from global memory at the start of the
@@ -557,9 +1972,9 @@ ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_stream(rocfft_execution_in
  *  A null value for 'cb' may be specified to clear any previously
  *  registered load callback.
  *
- *  Currently, 'shared_mem_bytes' must be 0.  Callbacks are not
- *  supported on transforms that use planar formats for either input
- *  or output.
+ *  Currently, 'shared_mem_bytes' must be 0.  On planar input, 'T'
+ *  is the real type and the callback is called twice per element,
+ *  once for the real buffer and once for the imaginary buffer.
  *
  *  @param[in] info execution info handle
  *  @param[in] cb_functions callback function pointers
@@ -597,9 +2012,9 @@ ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_load_callback(rocfft_execu
  *  A null value for 'cb' may be specified to clear any previously
  *  registered store callback.
  *
- *  Currently, 'shared_mem_bytes' must be 0.  Callbacks are not
- *  supported on transforms that use planar formats for either input
- *  or output.
+ *  Currently, 'shared_mem_bytes' must be 0.  On planar output, 'T'
+ *  is the real type and the callback is called twice per element,
+ *  once for the real buffer and once for the imaginary buffer.
  *
  *  @param[in] info execution info handle
  *  @param[in] cb_functions callbacks function pointers
@@ -611,6 +2026,189 @@ ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_store_callback(rocfft_exec
                                                                      void** cb_data,
                                                                      size_t shared_mem_bytes);
 
+/*! @brief Set a store callback for one pass of a plan execution
+ *  @details Like ::rocfft_execution_info_set_store_callback, but the
+ *  callback is run by the kernel at position 'pass' in the plan's
+ *  execution order as it stores its result, instead of by the
+ *  kernel that writes the transform's output.  Passes are counted
+ *  from 0, in the order that ::rocfft_plan_get_print lists the
+ *  plan's kernels.  This allows, for example, filtering the data
+ *  between the passes of a multi-dimensional transform without a
+ *  separate kernel.
+ *
+ *  The callback sees data in the layout that the pass writes it,
+ *  which may be in a temporary buffer: 'offset' is the element's
+ *  offset in that buffer, and 'T' is the type that the pass stores.
+ *
+ *  Only plans whose description enabled pass callbacks with
+ *  ::rocfft_plan_description_set_pass_callbacks can run them.
+ *  Executing fails if the pass does not exist, if its kernel can't
+ *  run callbacks, or if the pass is the one that writes the output
+ *  and a store callback was also set.  Pass callbacks are not
+ *  supported on plans that use more than one device or on
+ *  convolution plans.
+ *
+ *  A null value for 'cb_functions' clears the pass's callback.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] info execution info handle
+ *  @param[in] pass index of the pass that runs the callback
+ *  @param[in] cb_functions callback function pointers
+ *  @param[in] cb_data callback function data, passed to the function pointer when it is called
+ *  @param[in] shared_mem_bytes amount of shared memory to allocate for the callback function to use
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_pass_store_callback(
+    rocfft_execution_info info,
+    size_t                pass,
+    void**                cb_functions,
+    void**                cb_data,
+    size_t                shared_mem_bytes);
+
+/*! @brief Timing of one kernel launched by ::rocfft_execute
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_kernel_profile_s
+{
+    /*! number of executions with the execution info that preceded
+     *  the one that launched this kernel */
+    size_t execution_index;
+    /*! position of the kernel in its plan's sequence of kernels */
+    size_t kernel_index;
+    /*! device the kernel ran on */
+    int device;
+    /*! elapsed time of the kernel, in milliseconds */
+    float duration_ms;
+    /*! bytes the kernel reads from and writes to global memory */
+    size_t bytes_moved;
+} rocfft_kernel_profile;
+
+/*! @brief Time kernels launched with an execution info
+ *  @details Enables asynchronous profiling for executions that use
+ *  this execution info.  Each kernel is bracketed by events recorded
+ *  on the execution's stream, in a ring of max_kernels timing slots,
+ *  so profiling adds no synchronization with the device.  Elapsed
+ *  times are collected once kernels have finished, at the start of
+ *  the next ::rocfft_execute with this execution info or by
+ *  ::rocfft_execution_info_get_profile.  Collected timings are also
+ *  written to the profile log, if it is enabled.
+ *
+ *  If more than max_kernels kernels are launched before their times
+ *  are collected, timings of the oldest kernels are lost.  Kernels
+ *  are not timed in capture mode.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] info execution info handle
+ *  @param[in] max_kernels number of kernel timings to hold, or 0 to disable profiling
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_profile(rocfft_execution_info info,
+                                                              size_t max_kernels);
+
+/*! @brief Retrieve kernel timings from an execution info
+ *  @details Collects the times of kernels that have finished, from
+ *  executions that used this execution info with profiling enabled
+ *  by ::rocfft_execution_info_set_profile.  Kernels that are still
+ *  running are left to a later call.  This function does not wait
+ *  for the device.
+ *
+ *  If records is NULL, the number of timings available is returned
+ *  in num_records.  Otherwise, up to num_records of the oldest
+ *  timings are copied to records and removed from the execution
+ *  info, and num_records is set to the number copied.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] info execution info handle
+ *  @param[out] records array that receives kernel timings, or NULL
+ *  @param[in, out] num_records size of the records array on input, number of timings on output
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_execution_info_get_profile(rocfft_execution_info  info,
+                                                              rocfft_kernel_profile* records,
+                                                              size_t*                num_records);
+
+/*! @brief Type of work done by one item of a plan
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef enum rocfft_plan_item_phase_e
+{
+    /*! FFT kernels */
+    rocfft_plan_item_phase_fft,
+    /*! packing data before it is sent to other devices or ranks */
+    rocfft_plan_item_phase_pack,
+    /*! unpacking data received from other devices or ranks */
+    rocfft_plan_item_phase_unpack,
+    /*! moving data between devices or ranks */
+    rocfft_plan_item_phase_communication,
+} rocfft_plan_item_phase;
+
+/*! @brief Time taken by one item of a plan in ::rocfft_execute
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_plan_item_time_s
+{
+    /*! number of executions with the execution info that preceded
+     *  the one that ran this item */
+    size_t execution_index;
+    /*! index of the item in the plan.  Every rank of a distributed
+     *  plan numbers items the same way. */
+    size_t item_index;
+    /*! type of work the item does */
+    rocfft_plan_item_phase phase;
+    /*! wall-clock time from issuing the item to its completion, in
+     *  milliseconds */
+    double duration_ms;
+} rocfft_plan_item_time;
+
+/*! @brief Time plan items run by executions with an execution info
+ *  @details A multi-device or multi-process plan is made of items
+ *  that run FFT kernels, pack and unpack data, and communicate
+ *  between devices and ranks.  With item timing enabled, executions
+ *  that use this execution info run the plan's items one at a time,
+ *  in the order that every rank issues them, and measure how long
+ *  each item takes on this rank.  Time spent waiting for other ranks
+ *  is counted in the communication items that wait for them.
+ *
+ *  Running items one at a time removes the overlap of communication
+ *  and computation that executions normally have, so timed
+ *  executions are slower than untimed ones and are meant for
+ *  finding which part of a transform is expensive.  Item timing
+ *  synchronizes with the device, so it is ignored in capture mode.
+ *
+ *  At most max_items timings are held; if more items are run before
+ *  their times are retrieved, timings of the oldest items are lost.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] info execution info handle
+ *  @param[in] max_items number of item timings to hold, or 0 to disable item timing
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_execution_info_set_item_timing(rocfft_execution_info info,
+                                                                  size_t max_items);
+
+/*! @brief Retrieve plan item timings from an execution info
+ *  @details Collects the times of plan items run by executions that
+ *  used this execution info with item timing enabled by
+ *  ::rocfft_execution_info_set_item_timing.
+ *
+ *  If records is NULL, the number of timings available is returned
+ *  in num_records.  Otherwise, up to num_records of the oldest
+ *  timings are copied to records and removed from the execution
+ *  info, and num_records is set to the number copied.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] info execution info handle
+ *  @param[out] records array that receives item timings, or NULL
+ *  @param[in, out] num_records size of the records array on input, number of timings on output
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_execution_info_get_item_times(rocfft_execution_info  info,
+                                                                 rocfft_plan_item_time* records,
+                                                                 size_t*                num_records);
+
 #if 0
 /*! @brief Get events from execution info
  *  @details This is one of the execution info functions to retrieve information from execution.
@@ -645,6 +2243,624 @@ ROCFFT_EXPORT rocfft_status rocfft_cache_buffer_free(void* buffer);
  *  pointer or a zero length is passed. */
 ROCFFT_EXPORT rocfft_status rocfft_cache_deserialize(const void* buffer, size_t buffer_len_bytes);
 
+/*! @brief Serialize recently added kernels from the compiled kernel cache
+
+ *  @details Like ::rocfft_cache_serialize, but only kernels that
+ *  were added to the cache (or last used) at or after the Unix time
+ *  'since', in seconds, are written to the buffer.  This allows
+ *  distributing small incremental updates to a cache that other
+ *  nodes already have most of.  The buffer must be freed with a call
+ *  to ::rocfft_cache_buffer_free.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] since Unix time of the oldest kernels to serialize
+ *  @param[out] buffer receives the allocated buffer
+ *  @param[out] buffer_len_bytes receives the length of the buffer
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_cache_serialize_since(int64_t since,
+                                                         void**  buffer,
+                                                         size_t* buffer_len_bytes);
+
+/*! @brief Merge a serialized buffer into the compiled kernel cache
+
+ *  @details Like ::rocfft_cache_deserialize, but kernels that are
+ *  already in the cache are left as they are, instead of being
+ *  replaced by the kernels in the buffer.  Only new kernels are
+ *  written.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] buffer buffer from ::rocfft_cache_serialize or ::rocfft_cache_serialize_since
+ *  @param[in] buffer_len_bytes length of the buffer
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_cache_deserialize_merge(const void* buffer,
+                                                           size_t      buffer_len_bytes);
+
+/*! @brief Warm up the compiled kernel cache in the background
+
+ *  @details Starts compiling or loading the kernels needed by a list
+ *  of transform problems on background threads, so that later calls
+ *  to ::rocfft_plan_create for those problems do not have to wait
+ *  for runtime compilation.  Kernels are prepared for the current
+ *  device.  This function returns without waiting for the work to
+ *  finish.
+ *
+ *  The manifest holds one problem per line.  Each line is either a
+ *  rocfft-bench command line, in the format that rocFFT writes to its
+ *  bench log, or a test token.  Blank lines and lines starting with
+ *  '#' are ignored.  Nothing is prefetched if any line cannot be
+ *  parsed.
+ *
+ *  Setting the ROCFFT_RTC_PREFETCH environment variable to the path
+ *  of a manifest file prefetches its problems during ::rocfft_setup.
+ *
+ *  ::rocfft_cleanup stops any prefetching that has not started yet.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] manifest newline-separated list of problems
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_cache_prefetch(const char* manifest);
+
+/*! @brief Compiled kernel cache statistics
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_cache_stats_s
+{
+    /*! kernels found already loaded in this process */
+    size_t memory_hits;
+    /*! kernels found in the user cache (see ROCFFT_RTC_CACHE_PATH) */
+    size_t user_hits;
+    /*! kernels found in the cache shipped with the library */
+    size_t system_hits;
+    /*! kernels that were not cached and had to be compiled */
+    size_t misses;
+    /*! total time spent compiling kernels, in seconds */
+    double compile_seconds;
+    /*! bytes of compiled code written to the user cache */
+    size_t bytes_stored;
+    /*! kernels removed from the user cache to keep it under its size
+     *  limit */
+    size_t evictions;
+    /*! loaded kernels dropped from memory to stay under the in-process
+     *  cache limit */
+    size_t memory_evictions;
+} rocfft_cache_stats;
+
+/*! @brief Get compiled kernel cache statistics
+ *  @details Reports how often kernels needed by plans were found in
+ *  each level of rocFFT's kernel caches, and how much work was spent
+ *  compiling and storing kernels that were not found.  Counts cover
+ *  the whole process, including activity before any calls to
+ *  ::rocfft_cleanup.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[out] stats receives the statistics
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_cache_get_stats(rocfft_cache_stats* stats);
+
+/*! @brief Execution counters
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_counters_s
+{
+    /*! calls that executed the plan, or all plans */
+    size_t executions;
+    /*! kernels enqueued by those executions */
+    size_t kernels_launched;
+    /*! estimated bytes of device memory read and written by those
+     *  kernels */
+    size_t bytes_moved;
+    /*! executions that had to obtain a work buffer because the
+     *  caller did not provide one */
+    size_t work_buffer_allocations;
+    /*! kernels compiled at runtime.  Only counted for the whole
+     *  process, 0 when a plan is given. */
+    size_t rtc_compiles;
+    /*! kernels found in one of the compiled kernel caches.  Only
+     *  counted for the whole process, 0 when a plan is given. */
+    size_t cache_hits;
+} rocfft_counters;
+
+/*! @brief Get execution counters
+ *  @details Reports counters that rocFFT always keeps, without
+ *  enabling any log layers.  Counters start at zero when the plan
+ *  is created, or when the process starts if no plan is given, and
+ *  are never reset.  Executions captured into a graph are not
+ *  counted.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan plan to report, or null for totals across all plans
+ *  @param[out] counters receives the counters
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_get_counters(const rocfft_plan plan, rocfft_counters* counters);
+
+/*! @brief Work queue of a persistent executor
+ *  @details The queue is a ring of length slots, in memory that is
+ *  visible to both the host and the device.  Entry k of the queue
+ *  occupies slot k % length.
+ *
+ *  To submit entry k, a producer waits until slot_completed[k %
+ *  length] is at least k + 1 - length, writes the entry's buffer
+ *  pointers to entries[4 * (k % length)] onwards, and then stores k
+ *  + 1 to submitted with release semantics.  The entry is finished
+ *  once slot_completed[k % length] is at least k + 1.
+ *
+ *  Entries must be submitted in order by one producer at a time,
+ *  which may be the host or a kernel running on the executor's
+ *  device.  The host producer used by
+ *  ::rocfft_persistent_executor_submit follows this protocol, so it
+ *  can't be mixed with another producer.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *  */
+typedef struct rocfft_persistent_queue_s
+{
+    /*! 4 buffer pointers per slot: input, imaginary input (for
+     *  planar data), output and imaginary output (for planar data).
+     *  Output pointers are ignored by in-place plans. */
+    void** entries;
+    /*! number of entries submitted so far */
+    unsigned long long* submitted;
+    /*! per slot, one more than the index of the last entry finished
+     *  in that slot */
+    unsigned long long* slot_completed;
+    /*! number of slots in the queue */
+    size_t length;
+} rocfft_persistent_queue;
+
+/*! @brief Create a persistent executor for a plan
+ *  @details Launches a kernel that stays resident on the plan's
+ *  device and runs the plan's transform on each entry it finds in
+ *  a work queue.  This avoids the cost of a kernel launch per
+ *  transform, for small transforms that are submitted at high rates.
+ *
+ *  Only plans that run as a single Stockham kernel, without a work
+ *  buffer or callbacks, can be executed this way.
+ *  ::rocfft_status_invalid_arg_value is returned for other plans.
+ *
+ *  The kernel occupies part of the device until the executor is
+ *  destroyed, and all of its blocks must be resident at once.  It
+ *  uses at most half of each compute unit's occupancy for that, but
+ *  other kernels that never exit (such as other executors' kernels)
+ *  can still keep it from becoming resident, so a device should not
+ *  be shared between several of them.  The plan must not be
+ *  destroyed before the executor.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[out] executor persistent executor handle
+ *  @param[in] plan plan handle
+ *  @param[in] queue_length number of slots in the work queue
+ *  */
+ROCFFT_EXPORT rocfft_status
+    rocfft_persistent_executor_create(rocfft_persistent_executor* executor,
+                                      const rocfft_plan           plan,
+                                      size_t                      queue_length);
+
+/*! @brief Submit a transform to a persistent executor
+ *  @details Adds the buffers to the executor's work queue, waiting
+ *  for a free slot if the queue is full.  The transform runs in the
+ *  background, and ::rocfft_persistent_executor_wait waits for it to
+ *  finish.  The buffers are given as for ::rocfft_execute.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] executor persistent executor handle
+ *  @param[in] in_buffer array (of size 1 for interleaved data, of size 2
+ *  for planar data) of input buffers
+ *  @param[in] out_buffer array (of size 1 for interleaved data, of size 2
+ *  for planar data) of output buffers, ignored for in-place plans
+ *  @param[out] ticket receives the index of the submitted entry
+ *  */
+ROCFFT_EXPORT rocfft_status
+    rocfft_persistent_executor_submit(rocfft_persistent_executor executor,
+                                      void*                      in_buffer[],
+                                      void*                      out_buffer[],
+                                      unsigned long long*        ticket);
+
+/*! @brief Wait for a submitted transform to finish
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] executor persistent executor handle
+ *  @param[in] ticket index of the entry, as returned by
+ *  ::rocfft_persistent_executor_submit
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_persistent_executor_wait(rocfft_persistent_executor executor,
+                                                            unsigned long long         ticket);
+
+/*! @brief Get the work queue of a persistent executor
+ *  @details Returns the queue, so that entries can be submitted by
+ *  a producer other than ::rocfft_persistent_executor_submit, such as
+ *  a kernel on the device.  The queue's memory is owned by the
+ *  executor.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] executor persistent executor handle
+ *  @param[out] queue receives the work queue
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_persistent_executor_get_queue(
+    rocfft_persistent_executor executor, rocfft_persistent_queue* queue);
+
+/*! @brief Destroy a persistent executor
+ *  @details Waits for all submitted entries to finish, then stops
+ *  the executor's kernel and frees its queue.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] executor persistent executor handle
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_persistent_executor_destroy(rocfft_persistent_executor executor);
+
+/*! @brief Create a grouped plan for a batch of different-length transforms
+ *  @details Creates a plan that runs num_transforms 1D transforms,
+ *  which may all have different lengths, in one call to
+ *  ::rocfft_grouped_plan_execute.  Each transform has its own
+ *  length, and its own offsets into the input and output buffers.
+ *  All transforms share the placement, transform type and precision,
+ *  and the data is interleaved, as for a plan created without a
+ *  description.
+ *
+ *  Transforms of the same length are planned once, and complex
+ *  transforms that rocFFT computes with a single kernel run in one
+ *  kernel launch per length, which reads each transform's offsets
+ *  from a table on the device.  Other transforms are executed one
+ *  at a time.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[out] plan grouped plan handle
+ *  @param[in] placement placement of result
+ *  @param[in] transform_type type of transform
+ *  @param[in] precision precision
+ *  @param[in] num_transforms number of transforms
+ *  @param[in] lengths array of num_transforms lengths
+ *  @param[in] in_offsets array of num_transforms offsets of each
+ *  transform's input, in elements of the input data
+ *  @param[in] out_offsets array of num_transforms offsets of each
+ *  transform's output, in elements of the output data.  Ignored for
+ *  in-place transforms, and may be NULL in that case.
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_grouped_plan_create(rocfft_grouped_plan*    plan,
+                                                       rocfft_result_placement placement,
+                                                       rocfft_transform_type   transform_type,
+                                                       rocfft_precision        precision,
+                                                       size_t                  num_transforms,
+                                                       const size_t*           lengths,
+                                                       const size_t*           in_offsets,
+                                                       const size_t*           out_offsets);
+
+/*! @brief Get the work buffer size of a grouped plan
+ *  @details A work buffer of this size may be given to
+ *  ::rocfft_grouped_plan_execute in its execution info.  Otherwise,
+ *  work buffers are allocated when needed.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan grouped plan handle
+ *  @param[out] size_in_bytes receives the size of the work buffer in bytes
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_grouped_plan_get_work_buffer_size(
+    const rocfft_grouped_plan plan, size_t* size_in_bytes);
+
+/*! @brief Execute a grouped plan
+ *  @details Runs every transform in the grouped plan, on the stream
+ *  in the execution info.  The buffers are given as for
+ *  ::rocfft_execute, and each transform's data starts at its offset
+ *  into them.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan grouped plan handle
+ *  @param[in] in_buffer array of size 1 holding the input buffer
+ *  @param[in] out_buffer array of size 1 holding the output buffer,
+ *  ignored for in-place plans
+ *  @param[in] info execution info handle, may be NULL
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_grouped_plan_execute(const rocfft_grouped_plan plan,
+                                                        void*                     in_buffer[],
+                                                        void*                     out_buffer[],
+                                                        rocfft_execution_info     info);
+
+/*! @brief Destroy a grouped plan
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan grouped plan handle
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_grouped_plan_destroy(rocfft_grouped_plan plan);
+
+/*! @brief Create a plan that splits its batch across devices
+ *  @details Creates a plan for number_of_transforms transforms, as
+ *  ::rocfft_plan_create does, that divides the batch into contiguous
+ *  ranges and runs each range on one of the listed devices.  Each
+ *  device gets an ordinary plan for its share of the batch, and the
+ *  devices never exchange data, so this is much lighter than
+ *  distributing a transform with fields or
+ *  ::rocfft_plan_description_set_devices.
+ *
+ *  The batch is divided in proportion to the given weights.  With
+ *  NULL weights, rocFFT estimates each device's speed from its
+ *  memory bandwidth, so that faster devices get more transforms.
+ *  Devices may be given no transforms if the batch is small.
+ *
+ *  The description applies to every device's share, and its
+ *  distances and offsets describe the whole batch.  Plan creation
+ *  fails with ::rocfft_status_invalid_arg_value if the description
+ *  has fields, a communicator, a device list, host buffers or batch
+ *  tiles, if a device is listed twice or does not exist, or if output
+ *  transforms are interleaved (the output distance does not cover a
+ *  whole transform) and the batch is divided between more than one
+ *  device.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[out] plan split plan handle
+ *  @param[in] placement placement of result
+ *  @param[in] transform_type type of transform
+ *  @param[in] precision precision
+ *  @param[in] dimensions dimensions
+ *  @param[in] lengths dimensions-sized array of transform lengths
+ *  @param[in] number_of_transforms number of transforms in the batch
+ *  @param[in] description description handle, or NULL
+ *  @param[in] devices array of device IDs to run on
+ *  @param[in] num_devices number of device IDs in the array
+ *  @param[in] weights num_devices-sized array of non-negative
+ *  relative speeds of the devices, or NULL to estimate them
+ *  */
+ROCFFT_EXPORT rocfft_status
+    rocfft_split_plan_create(rocfft_split_plan*            plan,
+                             rocfft_result_placement       placement,
+                             rocfft_transform_type         transform_type,
+                             rocfft_precision              precision,
+                             size_t                        dimensions,
+                             const size_t*                 lengths,
+                             size_t                        number_of_transforms,
+                             const rocfft_plan_description description,
+                             const int*                    devices,
+                             size_t                        num_devices,
+                             const double*                 weights);
+
+/*! @brief Get the part of the batch that a split plan runs on a device
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan split plan handle
+ *  @param[in] device_index index of the device in the list given
+ *  to ::rocfft_split_plan_create
+ *  @param[out] first_transform receives the index of the device's
+ *  first transform in the batch
+ *  @param[out] num_transforms receives the number of transforms the
+ *  device runs, which may be 0
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_split_plan_get_share(const rocfft_split_plan plan,
+                                                        size_t                  device_index,
+                                                        size_t*                 first_transform,
+                                                        size_t*                 num_transforms);
+
+/*! @brief Execute a split plan on buffers on the current device
+ *  @details The buffers are given as for ::rocfft_execute, and hold
+ *  the whole batch on the current device.  Each other device's share
+ *  is copied to buffers that the plan allocates on that device,
+ *  transformed, and copied back, while the current device transforms
+ *  its own share in place in the user's buffers.  This function
+ *  returns once every device has finished.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan split plan handle
+ *  @param[in,out] in_buffer array (of size 1 for interleaved data, of
+ *  size 2 for planar data) of input buffers
+ *  @param[in,out] out_buffer array (of size 1 for interleaved data, of
+ *  size 2 for planar data) of output buffers.  Ignored for in-place
+ *  transforms.
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_split_plan_execute(const rocfft_split_plan plan,
+                                                      void*                   in_buffer[],
+                                                      void*                   out_buffer[]);
+
+/*! @brief Execute a split plan on buffers already on each device
+ *  @details Each device's buffers hold only its share of the batch,
+ *  as returned by ::rocfft_split_plan_get_share, laid out as the
+ *  first transforms of a batch described by the plan, so no data is
+ *  copied between devices.  The arrays hold the buffers for each
+ *  device in the order the devices were listed: one buffer per device
+ *  for interleaved data, or two consecutive buffers for planar data.
+ *  Buffers of devices with no transforms are ignored.  This function
+ *  returns once every device has finished.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan split plan handle
+ *  @param[in,out] in_buffers array of each device's input buffers
+ *  @param[in,out] out_buffers array of each device's output buffers.
+ *  Ignored for in-place transforms.
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_split_plan_execute_local(const rocfft_split_plan plan,
+                                                            void*                   in_buffers[],
+                                                            void*                   out_buffers[]);
+
+/*! @brief Destroy a split plan
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan split plan handle
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_split_plan_destroy(rocfft_split_plan plan);
+
+/*! @brief Create a non-uniform FFT plan
+ *  @details Creates a plan for the non-uniform FFT of
+ *  number_of_transforms vectors of strengths at the same points.
+ *  With M points x_j, a type 1 transform computes
+ *
+ *    f[k] = sum_j c[j] * exp(s * i * k . x_j)
+ *
+ *  for the modes k in [-N_d/2, (N_d-1)/2] of each dimension d, and
+ *  a type 2 transform computes
+ *
+ *    c[j] = sum_k f[k] * exp(s * i * k . x_j)
+ *
+ *  where s is -1 for ::rocfft_transform_type_complex_forward and +1
+ *  for ::rocfft_transform_type_complex_inverse.  Point coordinates
+ *  are in radians, so coordinates that differ by a multiple of 2*pi
+ *  are the same point.
+ *
+ *  The strengths of each point are spread onto a grid oversampled
+ *  by 2 in each dimension with an "exponential of semicircle"
+ *  kernel, the grid is transformed with an ordinary rocFFT plan, and
+ *  the kernel is divided out of the modes (type 1).  A type 2
+ *  transform runs the same steps in reverse, interpolating the
+ *  transformed grid at the points.  Dividing out the kernel is
+ *  fused into the pass that moves modes between the user's buffer
+ *  and the grid, so it costs nothing extra.  The kernel width is
+ *  chosen for the requested relative tolerance, which is limited by
+ *  the precision.
+ *
+ *  Modes are stored contiguously with the first dimension fastest.
+ *  Mode k of dimension d is at index k + N_d/2 (rounded down).
+ *  Strengths are stored contiguously in the order points are given.
+ *  Both are complex interleaved data in the plan's precision.
+ *  Successive transforms in the batch are M strengths and
+ *  N_0*N_1*N_2 modes apart.
+ *
+ *  Points must be set with ::rocfft_nufft_plan_set_points before the
+ *  plan is executed.  The plan owns the oversampled grid, so a
+ *  non-uniform FFT plan must not be executed concurrently on
+ *  multiple streams.  Single and double precision are supported
+ *  for 1, 2 and 3 dimensions.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[out] plan non-uniform FFT plan handle
+ *  @param[in] type type 1 or type 2
+ *  @param[in] transform_type ::rocfft_transform_type_complex_forward
+ *  or ::rocfft_transform_type_complex_inverse, for the sign of the
+ *  exponent
+ *  @param[in] precision precision
+ *  @param[in] dimensions dimensions
+ *  @param[in] modes dimensions-sized array of numbers of modes
+ *  @param[in] number_of_transforms number of transforms
+ *  @param[in] tolerance requested relative accuracy, e.g. 1e-6
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_nufft_plan_create(rocfft_nufft_plan*    plan,
+                                                     rocfft_nufft_type     type,
+                                                     rocfft_transform_type transform_type,
+                                                     rocfft_precision      precision,
+                                                     size_t                dimensions,
+                                                     const size_t*         modes,
+                                                     size_t                number_of_transforms,
+                                                     double                tolerance);
+
+/*! @brief Set the points of a non-uniform FFT plan
+ *  @details Coordinates are device arrays of num_points real values
+ *  in the plan's precision, one array per dimension.  Arrays for
+ *  dimensions the plan does not have are ignored and may be NULL.
+ *
+ *  The points are sorted by their position on the oversampled grid,
+ *  so that neighbouring threads spread to and interpolate from
+ *  nearby grid points.  The sorted points are kept by the plan, so
+ *  every execution on the same points reuses the sort.  This
+ *  function synchronizes with the device and returns once the
+ *  coordinates have been copied, so the arrays may be freed or
+ *  reused afterwards.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan non-uniform FFT plan handle
+ *  @param[in] num_points number of points
+ *  @param[in] x device array of coordinates in the first dimension
+ *  @param[in] y device array of coordinates in the second dimension, or NULL
+ *  @param[in] z device array of coordinates in the third dimension, or NULL
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_nufft_plan_set_points(rocfft_nufft_plan plan,
+                                                         size_t            num_points,
+                                                         const void*       x,
+                                                         const void*       y,
+                                                         const void*       z);
+
+/*! @brief Execute a non-uniform FFT plan
+ *  @details A type 1 transform reads strengths and writes modes,
+ *  and a type 2 transform reads modes and writes strengths.  Work
+ *  is enqueued on the execution info's stream, and the function
+ *  returns without waiting for it.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan non-uniform FFT plan handle
+ *  @param[in,out] strengths device buffer of strengths at the points
+ *  @param[in,out] modes device buffer of uniform modes
+ *  @param[in] info execution info handle, or NULL
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_nufft_execute(const rocfft_nufft_plan plan,
+                                                 void*                   strengths,
+                                                 void*                   modes,
+                                                 rocfft_execution_info   info);
+
+/*! @brief Destroy a non-uniform FFT plan
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] plan non-uniform FFT plan handle
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_nufft_plan_destroy(rocfft_nufft_plan plan);
+
+/*! @brief Get the source of a device-callable FFT function
+ *  @details Generates HIP source for a device function that computes
+ *  one complex 1D FFT of the given length on data in shared memory
+ *  (LDS), so that user kernels can run small FFTs as part of their
+ *  own work without a round trip through global memory.  The source
+ *  can be compiled with hipRTC, or included in a user's own kernel
+ *  source.
+ *
+ *  The function is named
+ *  rocfft_device_fft_len<length>_<direction><precision>, for example
+ *  rocfft_device_fft_len64_fwd_sp, where direction is fwd or inv and
+ *  precision is _sp, _dp or _half.  It is declared as
+ *
+ *      __device__ void rocfft_device_fft_len64_fwd_sp(
+ *          rocfft_complex<float>* lds, unsigned int thread);
+ *
+ *  lds points to the transform's length contiguous elements, which
+ *  are transformed in place.  The number of threads returned in
+ *  threads must call the function together for each transform,
+ *  passing their index within the transform in thread.  The function
+ *  synchronizes the thread block, so every thread in the block must
+ *  call it.  Callers must synchronize the block again before reading
+ *  elements written by other threads.
+ *
+ *  Sources for different lengths, directions and precisions can be
+ *  compiled together.  The transform is unnormalized, as for
+ *  ::rocfft_execute.  Only lengths that rocFFT computes with a single
+ *  1D kernel are available; ::rocfft_status_invalid_arg_value is
+ *  returned for other lengths.
+ *
+ *  @warning Experimental!  This feature is part of an experimental API preview.
+ *
+ *  @param[in] length length of the FFT
+ *  @param[in] precision precision of the data
+ *  @param[in] transform_type ::rocfft_transform_type_complex_forward or
+ *  ::rocfft_transform_type_complex_inverse
+ *  @param[out] source buffer that receives the null-terminated source,
+ *  or NULL to only query its size
+ *  @param[in,out] source_size size of the source buffer in bytes; receives
+ *  the size of the source including the terminating null
+ *  @param[out] threads receives the number of threads that compute
+ *  each transform, may be NULL
+ *  */
+ROCFFT_EXPORT rocfft_status rocfft_device_function_get_source(size_t                length,
+                                                              rocfft_precision      precision,
+                                                              rocfft_transform_type transform_type,
+                                                              char*                 source,
+                                                              size_t*               source_size,
+                                                              unsigned int*         threads);
+
 #ifdef ROCFFT_BUILD_OFFLINE_TUNER
 /*! @brief Get a handler of offline-tuner
 
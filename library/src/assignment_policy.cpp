@@ -20,11 +20,16 @@
 
 #include "assignment_policy.h"
 #include "../../shared/arithmetic.h"
+#include "../../shared/array_predicate.h"
+#include "../../shared/array_validator.h"
+#include "../../shared/environment.h"
 #include "../../shared/ptrdiff.h"
 #include "./device/kernels/array_format.h"
 #include "enum_printer.h"
 #include "logging.h"
 #include "node_factory.h"
+#include <iterator>
+#include <map>
 #include <numeric>
 #include <optional>
 #include <set>
@@ -131,7 +136,18 @@ void PlacementTrace::Backtracking(ExecPlan& execPlan, int execSeqID)
     // such.  This is particularly important for leaf nodes, since
     // kernelio debugging depends on knowing the correct type of the
     // array to print.
-    if(node->scheme == CS_KERNEL_COPY_R_TO_CMPLX)
+    if(node->scheme == CS_KERNEL_COPY_R_TO_CMPLX || node->scheme == CS_KERNEL_PAIR_R_TO_CMPLX)
+        node->inArrayType = rocfft_array_type_real;
+    // real-to-real kernels read and write real data directly
+    if(node->ebtype == EmbeddedType::Real2Real)
+    {
+        node->inArrayType  = rocfft_array_type_real;
+        node->outArrayType = rocfft_array_type_real;
+    }
+    // so do the fused Bluestein kernels that read a real-to-complex
+    // transform's input
+    if(node->fuseBlue == BFT_FWD_CHIRP_MUL && node->obIn == OB_USER_IN
+       && execPlan.rootPlan->inArrayType == rocfft_array_type_real)
         node->inArrayType = rocfft_array_type_real;
 
     // for nodes that uses bluestein buffer
@@ -199,6 +215,26 @@ bool AssignmentPolicy::EquivalentArrayType(rocfft_array_type rootAryType,
     return (testAryType == rootAryType);
 }
 
+// return true if more than one element of the root's input, across
+// all of its batches, is read from the same location
+static bool InputIsAliased(const TreeNode& root)
+{
+    auto length = root.length;
+    auto stride = root.inStride;
+    length.push_back(root.batch);
+    stride.push_back(root.iDist);
+    return !array_valid(length, stride);
+}
+
+// output length of a fused Bluestein node.  The last kernel of a
+// real-to-complex transform only writes the Hermitian half.
+static std::vector<size_t> FusedBluesteinOutputLength(const TreeNode& node, const TreeNode& root)
+{
+    if(node.fuseBlue == BFT_INV_CHIRP_MUL && root.inArrayType == rocfft_array_type_real)
+        return {node.lengthBlueN / 2 + 1};
+    return {node.lengthBlueN};
+}
+
 // return true if OB_TEMP_BLUESTEIN is a valid output buffer for the node
 static bool ValidOutBufferBluestein(TreeNode& node)
 {
@@ -225,7 +261,7 @@ static bool ValidOutBufferBluestein(TreeNode& node)
         if(p == nullptr)
             break;
 
-        if(p->scheme != CS_BLUESTEIN)
+        if(p->scheme != CS_BLUESTEIN && p->scheme != CS_RADER)
         {
             // keep going, can't decide if we're under bluestein yet
             continue;
@@ -235,8 +271,9 @@ static bool ValidOutBufferBluestein(TreeNode& node)
         // does not write to it)
         if(p->childNodes.size() == 3)
             return n->IsBluesteinChirpSetup();
-        // or it could have 6 children, in which case all but the
-        // last must write to bluestein
+        // or it could have 6 children (multi-kernel bluestein or
+        // rader), in which case all but the last must write to
+        // bluestein
         else if(p->childNodes.size() == 6)
         {
             return n != p->childNodes.back().get();
@@ -263,15 +300,18 @@ bool AssignmentPolicy::ValidOutBuffer(ExecPlan&           execPlan,
     // the input side of an in-place R2C transform (which the plan
     // would normally call OB_USER_OUT).
     auto dataFits = [&execPlan](const TreeNode& node, OperatingBuffer buffer) {
-        auto outLengthBlueN = {node.lengthBlueN};
-        auto nodeLen        = (node.fuseBlue == BFT_NONE) ? node.GetOutputLength() : outLengthBlueN;
+        auto nodeLen = (node.fuseBlue == BFT_NONE)
+                           ? node.GetOutputLength()
+                           : FusedBluesteinOutputLength(node, *execPlan.rootPlan);
         auto bufLen         = buffer == OB_USER_OUT ? execPlan.rootPlan->GetOutputLength()
                                                     : execPlan.rootPlan->length;
 
         // if node's output is complex and buffer's format is real,
         // adjust output length to be 2x to make the units of
         // comparison match
-        bool kernelOutputIsReal = node.scheme == CS_KERNEL_COPY_CMPLX_TO_R;
+        bool kernelOutputIsReal = node.scheme == CS_KERNEL_COPY_CMPLX_TO_R
+                                  || node.ebtype == EmbeddedType::C2Real_ODD
+                                  || node.ebtype == EmbeddedType::Real2Real;
         bool outBufferIsReal
             = (buffer == OB_USER_OUT && execPlan.rootPlan->outArrayType == rocfft_array_type_real)
               || (buffer == OB_USER_IN && execPlan.rootPlan->inArrayType == rocfft_array_type_real);
@@ -297,16 +337,35 @@ bool AssignmentPolicy::ValidOutBuffer(ExecPlan&           execPlan,
         // ensure that the node's dimensions fit exactly into the
         // buffer's dimensions.  e.g. if the node wants XxYxZ and the
         // buffer is AxZ, this is ok so long as X*Y == A
-        for(auto len : nodeLen)
+        auto decomposes = [nodeLen, bufLen]() mutable {
+            for(auto len : nodeLen)
+            {
+                // not decomposing evenly
+                if(bufLen.empty() || bufLen.front() % len != 0)
+                    return false;
+                bufLen.front() /= len;
+                if(bufLen.front() == 1)
+                    bufLen.erase(bufLen.begin());
+            }
+            return true;
+        };
+        if(decomposes())
+            return true;
+
+        // The user's output buffer of an out-of-place C2C transform
+        // can also hold intermediate data laid out independently of
+        // the user's strides, so long as it fits within the buffer's
+        // extent.  CheckAssignmentValid verifies the strides the
+        // node is eventually given against that extent.
+        const auto& root = *execPlan.rootPlan;
+        if(buffer == OB_USER_OUT && root.placement == rocfft_placement_notinplace
+           && array_type_is_complex(root.inArrayType) && array_type_is_complex(root.outArrayType)
+           && &node != execPlan.execSeq.back())
         {
-            // not decomposing evenly
-            if(bufLen.empty() || bufLen.front() % len != 0)
-                return false;
-            bufLen.front() /= len;
-            if(bufLen.front() == 1)
-                bufLen.erase(bufLen.begin());
+            auto nodeElems = node.batch * product(nodeLen.begin(), nodeLen.end());
+            return nodeElems <= compute_ptrdiff(bufLen, root.outStride, root.batch, root.oDist);
         }
-        return true;
+        return false;
     };
 
     bool test_result = true;
@@ -344,6 +403,21 @@ bool AssignmentPolicy::ValidOutBuffer(ExecPlan&           execPlan,
     {
         test_result = false;
     }
+    // only its last kernel knows to skip the redundant half of
+    // Hermitian output
+    else if(buffer == OB_USER_OUT && node.fuseBlue == BFT_INV_CHIRP_MUL
+            && node.scheme != CS_KERNEL_STOCKHAM_BLOCK_RC
+            && execPlan.rootPlan->inArrayType == rocfft_array_type_real)
+    {
+        test_result = false;
+    }
+    // output ops are applied by the last kernel, and leave data in
+    // the output buffer that earlier kernels can't use as scratch
+    else if(buffer == OB_USER_OUT && execPlan.rootPlan->storeOps.needs_exclusive_output()
+            && &node != execPlan.execSeq.back())
+    {
+        test_result = false;
+    }
     // if output goes to a temp buffer, that will be dynamically sized
     // to be big enough so it's always ok but if output is in/out, we
     // have to fit into whatever the user gave us
@@ -378,9 +452,10 @@ static void RecursiveTraverse(TreeNode* node, const std::function<void(TreeNode*
 
 bool AssignmentPolicy::CheckAssignmentValid(ExecPlan& execPlan)
 {
-    auto getBufSize = [](TreeNode* node, bool input) {
-        auto lengthBlueN = {node->lengthBlueN};
-        auto outputLen   = node->fuseBlue == BFT_NONE ? node->GetOutputLength() : lengthBlueN;
+    auto getBufSize = [&execPlan](TreeNode* node, bool input) {
+        auto outputLen = node->fuseBlue == BFT_NONE
+                             ? node->GetOutputLength()
+                             : FusedBluesteinOutputLength(*node, *execPlan.rootPlan);
 
         if(input)
             return compute_ptrdiff(node->length, node->inStride, node->batch, node->iDist);
@@ -457,9 +532,48 @@ void AssignmentPolicy::UpdateWinnerFromValidPaths(ExecPlan& execPlan)
 
     //std::cout << "total candidates: " << winnerCandidates.size() << std::endl;
 
+    const bool minBuffers = execPlan.assignOptStrategy == rocfft_optimize_min_buffer;
+
+    // when minimizing buffers, work out how large a work buffer each
+    // candidate needs.  The temp, copy and Bluestein buffers are
+    // all counted in complex elements, so their sum orders the
+    // candidates the same way their size in bytes would.
+    std::map<const PlacementTrace*, size_t> workBufSizes;
+    if(minBuffers)
+    {
+        for(auto& candidate : winnerCandidates)
+        {
+            candidate->Backtracking(execPlan, execPlan.execSeq.size() - 1);
+            execPlan.rootPlan->RefreshTree();
+            execPlan.rootPlan->AssignParams();
+
+            size_t tmpBufSize       = 0;
+            size_t cmplxForRealSize = 0;
+            size_t blueSize         = 0;
+            size_t chirpSize        = 0;
+            execPlan.rootPlan->DetermineBufferMemory(
+                tmpBufSize, cmplxForRealSize, blueSize, chirpSize);
+            workBufSizes[candidate] = tmpBufSize + cmplxForRealSize + blueSize;
+        }
+    }
+
     // sort the candidate, front is the best
     std::sort(
-        winnerCandidates.begin(), winnerCandidates.end(), [](const auto& lhs, const auto& rhs) {
+        winnerCandidates.begin(),
+        winnerCandidates.end(),
+        [minBuffers, &workBufSizes](const auto& lhs, const auto& rhs) {
+            // when minimizing buffers, a smaller work buffer wins
+            // over more fusions, and then fewer buffers do
+            if(minBuffers)
+            {
+                const auto lhsSize = workBufSizes.at(lhs);
+                const auto rhsSize = workBufSizes.at(rhs);
+                if(lhsSize != rhsSize)
+                    return lhsSize < rhsSize;
+                if(lhs->NumUsedBuffers() != rhs->NumUsedBuffers())
+                    return lhs->NumUsedBuffers() < rhs->NumUsedBuffers();
+            }
+
             // compare numFusedNodes (more is better)
             if(lhs->numFusedNodes > rhs->numFusedNodes)
                 return true;
@@ -588,6 +702,37 @@ void AssignmentPolicy::AssignBuffers(ExecPlan& execPlan)
     AssignBuffers_internal(execPlan);
 }
 
+bool AssignmentPolicy::RestoreBuffers(ExecPlan&                          execPlan,
+                                      const std::vector<NodeAssignment>& buffers)
+{
+    AssignChirpBuffers(execPlan);
+
+    auto& execSeq = execPlan.execSeq;
+    if(execSeq.empty() || buffers.size() != execSeq.size())
+        return false;
+
+    // rebuild the winning path through execSeq, which skips chirp
+    // setup nodes the same way Backtracking does
+    PlacementTrace  dummyRoot;
+    PlacementTrace* path = &dummyRoot;
+    for(size_t i = 0; i < execSeq.size(); ++i)
+    {
+        if(execSeq[i]->IsBluesteinChirpSetup() && !execPlan.IsChirpPlan)
+            continue;
+        const auto& b = buffers[i];
+        path->branches.emplace_back(std::make_unique<PlacementTrace>(
+            execSeq[i], b.obIn, b.obOut, b.inArrayType, b.outArrayType, path));
+        path = path->branches.back().get();
+    }
+    if(path->curNode != execSeq.back())
+        return false;
+
+    path->Backtracking(execPlan, execSeq.size() - 1);
+    execPlan.rootPlan->RefreshTree();
+    execPlan.rootPlan->AssignParams();
+    return CheckAssignmentValid(execPlan);
+}
+
 void AssignmentPolicy::AssignBuffers_internal(ExecPlan& execPlan)
 {
     int maxFusions      = execPlan.fuseShims.size();
@@ -604,9 +749,12 @@ void AssignmentPolicy::AssignBuffers_internal(ExecPlan& execPlan)
     // Start from a minimal requirement; // out buffer
     availableBuffers.insert(execPlan.rootPlan->obOut);
 
-    // real-inverse transforms are allowed to modify input
+    // real-inverse transforms are allowed to modify input, unless
+    // its elements are shared between transforms (e.g. overlapping
+    // sliding windows), since later transforms still read them
     if(execPlan.rootPlan->direction == 1
-       && execPlan.rootPlan->outArrayType == rocfft_array_type_real)
+       && execPlan.rootPlan->outArrayType == rocfft_array_type_real
+       && !InputIsAliased(*execPlan.rootPlan))
     {
         availableBuffers.insert(execPlan.rootPlan->obIn);
     }
@@ -626,7 +774,7 @@ void AssignmentPolicy::AssignBuffers_internal(ExecPlan& execPlan)
 
     // look for nodes that imply presence of other buffers (bluestein)
     RecursiveTraverse(execPlan.rootPlan.get(), [this](TreeNode* n) {
-        if(n->scheme == CS_BLUESTEIN)
+        if(n->scheme == CS_BLUESTEIN || n->scheme == CS_RADER)
         {
             availableBuffers.insert(OB_TEMP_BLUESTEIN);
             availableArrayTypes.insert(rocfft_array_type_complex_interleaved);
@@ -890,6 +1038,52 @@ enum class PaddingDim
     SECOND_HIGHEST,
 };
 
+// Rule for deciding whether and how much to pad a temp buffer's
+// strides.  A buffer is split into its highest dim and the product
+// of its lower dims; it's padded if either is a multiple of
+// "multiple" and the bigger one is at least "minLength".
+struct TempPaddingRule
+{
+    // architecture the rule applies to, empty for any
+    const char* arch;
+    size_t      multiple;
+    size_t      minLength;
+    // elements to add to the padded stride, 0 to never pad
+    size_t padding;
+    // if nonzero, don't pad 2D buffers whose two strides are both
+    // powers of 2 larger than this
+    size_t maxPo2Stride;
+};
+
+// first matching rule wins
+static const TempPaddingRule tempPaddingRules[] = {
+    // large double-precision pow2 2D strides are slower with
+    // padding on gfx906
+    {"gfx906", 64, 512, 64, 2048},
+    {"", 64, 512, 64, 0},
+};
+
+// Choose the padding rule for a device.  ROCFFT_TEMP_PADDING
+// overrides the amount of padding (0 disables it), so that tuning
+// runs can compare different choices.
+static TempPaddingRule GetTempPaddingRule(const hipDeviceProp_t& deviceProp)
+{
+    TempPaddingRule rule = tempPaddingRules[std::size(tempPaddingRules) - 1];
+    for(const auto& r : tempPaddingRules)
+    {
+        if(*r.arch == '\0' || is_device_gcn_arch(deviceProp, r.arch))
+        {
+            rule = r;
+            break;
+        }
+    }
+
+    auto envPadding = rocfft_getenv("ROCFFT_TEMP_PADDING");
+    if(!envPadding.empty())
+        rule.padding = std::stoull(envPadding);
+    return rule;
+}
+
 // Function to pad strides on a buffer, if the strides would produce
 // a problematic access pattern.  Previous stride/dist/length are
 // provided in cases where a previous write must be compatible with a
@@ -904,7 +1098,8 @@ static void PadStride(std::vector<size_t>&       stride,
                       const std::vector<size_t>& prevStride,
                       const size_t&              prevDist,
                       const std::vector<size_t>& prevLength,
-                      PaddingDim                 paddingDim)
+                      PaddingDim                 paddingDim,
+                      const TempPaddingRule&     rule)
 {
     // only consider padding for 2D and higher
     if(stride.size() < 2)
@@ -1028,12 +1223,14 @@ static void PadStride(std::vector<size_t>&       stride,
 
         const size_t biggerDim  = std::max(highLength, lowerLengths);
         const size_t smallerDim = std::min(highLength, lowerLengths);
-        bool needsPadding = ((smallerDim % 64 == 0) || (biggerDim % 64 == 0)) && (biggerDim >= 512);
+        bool         needsPadding
+            = ((smallerDim % rule.multiple == 0) || (biggerDim % rule.multiple == 0))
+              && (biggerDim >= rule.minLength);
 
         if(!needsPadding)
             return;
 
-        static const size_t padding = 64;
+        const size_t padding = rule.padding;
 
         // normal case - adjust highest dim
         if(paddingDim == PaddingDim::HIGHEST)
@@ -1238,12 +1435,21 @@ static bool IsPaddableTempBuffer(OperatingBuffer buf)
 
 void AssignmentPolicy::PadPlan(ExecPlan& execPlan)
 {
+    // padding makes temp buffers bigger, so don't pad if we're
+    // trying to keep them small
+    if(execPlan.assignOptStrategy == rocfft_optimize_min_buffer)
+        return;
+
     // for strided FFTs with dist 1, we mess around with dimensions
     // in ways that confuse padding.  don't try.
     if(execPlan.rootPlan->iDist == 1 || execPlan.rootPlan->oDist == 1)
         return;
 
-    RecursiveTraverse(execPlan.rootPlan.get(), [&execPlan](TreeNode* n) {
+    const auto rule = GetTempPaddingRule(execPlan.deviceProp);
+    if(rule.padding == 0)
+        return;
+
+    RecursiveTraverse(execPlan.rootPlan.get(), [&rule](TreeNode* n) {
         // Look for nodes that begin writing to a new temp buffer
         // (i.e. obOut is a paddable temp buffer, and obIn was a
         // different buffer)
@@ -1291,6 +1497,11 @@ void AssignmentPolicy::PadPlan(ExecPlan& execPlan)
                 if(u.node.scheme == CS_BLUESTEIN || u.node.scheme == CS_KERNEL_PAD_MUL
                    || u.node.scheme == CS_KERNEL_FFT_MUL || u.node.scheme == CS_KERNEL_RES_MUL)
                     return;
+                // and Rader is built the same way
+                if(u.node.scheme == CS_RADER || u.node.scheme == CS_KERNEL_RADER_GATHER
+                   || u.node.scheme == CS_KERNEL_RADER_MUL
+                   || u.node.scheme == CS_KERNEL_RADER_SCATTER)
+                    return;
                 // SBCR plans combine higher dimensions in ways that confuse padding
                 if(u.node.scheme == CS_KERNEL_STOCKHAM_BLOCK_CR)
                     return;
@@ -1320,13 +1531,11 @@ void AssignmentPolicy::PadPlan(ExecPlan& execPlan)
                     prevPaddingDim = curPaddingDim;
             }
 
-            // specific case for gfx906 - large double-precision pow2
-            // 2D strides are slower with padding
-            if(is_device_gcn_arch(execPlan.deviceProp, "gfx906"))
+            if(rule.maxPo2Stride)
             {
                 const auto& stride = users.front().stride;
-                if(stride.size() == 3 && IsPo2(stride[0]) && stride[0] > 2048 && IsPo2(stride[1])
-                   && stride[1] > 2048)
+                if(stride.size() == 3 && IsPo2(stride[0]) && stride[0] > rule.maxPo2Stride
+                   && IsPo2(stride[1]) && stride[1] > rule.maxPo2Stride)
                     return;
             }
 
@@ -1351,7 +1560,8 @@ void AssignmentPolicy::PadPlan(ExecPlan& execPlan)
                               previousWrite->stride,
                               previousWrite->dist,
                               previousWrite->length,
-                              u.GetForcedPaddingDim().value_or(PaddingDim::HIGHEST));
+                              u.GetForcedPaddingDim().value_or(PaddingDim::HIGHEST),
+                              rule);
                 else
                     PadStride(u.stride,
                               u.dist,
@@ -1360,7 +1570,8 @@ void AssignmentPolicy::PadPlan(ExecPlan& execPlan)
                               {},
                               0,
                               {},
-                              u.GetForcedPaddingDim().value_or(PaddingDim::HIGHEST));
+                              u.GetForcedPaddingDim().value_or(PaddingDim::HIGHEST),
+                              rule);
                 if(u.op == TempBufOp::BufWrite)
                     previousWrite = &u;
             }
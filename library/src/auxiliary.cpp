@@ -23,15 +23,23 @@
 #include "../../shared/device_properties.h"
 #include "../../shared/environment.h"
 #include "../../shared/rocfft_hip.h"
+#include "cache_prefetch.h"
 #include "logging.h"
+#include "online_tuner.h"
+#include "plan_cache.h"
 #include "repo.h"
 #include "rocfft/rocfft.h"
 #include "rocfft_ostream.hpp"
 #include "rtc_cache.h"
+#include "rtc_module_cache.h"
 #include "solution_map.h"
+#include "stream_pool.h"
 #include "tuning_helper.h"
+#include "work_buffer_pool.h"
 #include <fcntl.h>
+#include <fstream>
 #include <memory>
+#include <sstream>
 
 /*******************************************************************************
  * Static handle data
@@ -44,6 +52,7 @@ int log_kernelio_fd = -1;
 int log_rtc_fd      = -1;
 int log_tuning_fd   = -1;
 int log_graph_fd    = -1;
+int log_replay_fd   = -1;
 
 /**
  *  @brief Logging function
@@ -125,13 +134,34 @@ rocfft_status rocfft_setup()
         // open log_graph file
         if(layer_mode & rocfft_layer_mode_log_graph)
             open_log_stream("ROCFFT_LOG_GRAPH_PATH", log_graph_fd);
+
+        // open log_replay file
+        if(layer_mode & rocfft_layer_mode_log_replay)
+            open_log_stream("ROCFFT_LOG_REPLAY_PATH", log_replay_fd);
+
+        // ROCFFT_LOG_FORMAT=json writes log records as JSON Lines
+        LogSingleton::GetInstance().SetJSONFormat(rocfft_getenv("ROCFFT_LOG_FORMAT") == "json");
     }
 
     // setup solution map once in program at the start of library use
-    auto arch_name = get_arch_name(get_curr_device_prop());
+    auto deviceProp = get_curr_device_prop();
+    auto arch_name  = get_arch_name(deviceProp);
     solution_map::get_solution_map().setup(arch_name);
+    solution_map::get_solution_map().setup_transfer_arch(arch_name, deviceProp);
     TuningBenchmarker::GetSingleton().Setup();
 
+    // warm up the kernel cache from a manifest, if one is given.
+    // failure to read the manifest should not fail setup.
+    auto prefetch_path = rocfft_getenv("ROCFFT_RTC_PREFETCH");
+    if(!prefetch_path.empty())
+    {
+        std::ifstream     manifest(prefetch_path);
+        std::stringstream contents;
+        contents << manifest.rdbuf();
+        if(manifest)
+            (void)CachePrefetcher::GetPrefetcher().Prefetch(contents.str());
+    }
+
     log_trace(__func__);
     return rocfft_status_success;
 }
@@ -141,14 +171,28 @@ rocfft_status rocfft_cleanup()
 {
     log_trace(__func__);
 
+    // finish any plans being created for prefetch before tearing
+    // down the caches they use
+    CachePrefetcher::GetPrefetcher().Stop();
+
+    // a problem that is being tuned on first use finishes tuning,
+    // but nothing else queued is tuned
+    OnlineTuner::GetTuner().Stop();
+
     // close the RTC cache and clear the repo, so that subsequent
-    // rocfft_setup() + plan creation will start from scratch
+    // rocfft_setup() + plan creation will start from scratch.  cached
+    // plans hold twiddles, so release those first.
+    PlanCache::GetCache().Clear();
     Repo::Clear();
+    WorkBufferPool::GetPool().Clear();
+    StreamPool::GetPool().Clear();
+    RTCModuleCache::GetCache().Clear();
     RTCCache::single.reset();
 
     TuningBenchmarker::GetSingleton().Clean();
 
     LogSingleton::GetInstance().SetLayerMode(rocfft_layer_mode_none);
+    LogSingleton::GetInstance().SetJSONFormat(false);
     // Close log files
     if(log_trace_fd != -1)
     {
@@ -190,6 +234,11 @@ rocfft_status rocfft_cleanup()
         CLOSE(log_graph_fd);
         log_graph_fd = -1;
     }
+    if(log_replay_fd != -1)
+    {
+        CLOSE(log_replay_fd);
+        log_replay_fd = -1;
+    }
 
     // stop all log worker threads
     rocfft_ostream::cleanup();
@@ -197,6 +246,33 @@ rocfft_status rocfft_cleanup()
     return rocfft_status_success;
 }
 
+rocfft_status rocfft_solution_map_reload(const char* path)
+{
+    log_trace(__func__, "path", path ? path : "");
+
+    // tuning holds on to nodes of the current map
+    if(TuningBenchmarker::GetSingleton().IsInitializingTuning()
+       || TuningBenchmarker::GetSingleton().IsProcessingTuning())
+        return rocfft_status_failure;
+
+    try
+    {
+        auto deviceProp = get_curr_device_prop();
+        if(!solution_map::reload(path ? path : "", get_arch_name(deviceProp), deviceProp))
+            return rocfft_status_failure;
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        return rocfft_status_failure;
+    }
+
+    // cached plans were built with the old solutions
+    PlanCache::GetCache().Clear();
+    return rocfft_status_success;
+}
+
 #ifdef ROCFFT_BUILD_OFFLINE_TUNER
 rocfft_status rocfft_get_offline_tuner_handle(void** offline_tuner)
 {
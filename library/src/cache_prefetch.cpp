@@ -0,0 +1,338 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "cache_prefetch.h"
+#include "../../shared/concurrency.h"
+#include "../../shared/rocfft_hip.h"
+#include "logging.h"
+#include "rtc_compile_scheduler.h"
+
+#include <algorithm>
+#include <sstream>
+
+// read a list of numbers from the words, starting at pos.  stops at
+// the first word that is not a number.
+static std::vector<size_t> parse_size_list(const std::vector<std::string>& words, size_t& pos)
+{
+    std::vector<size_t> ret;
+    for(; pos < words.size(); ++pos)
+    {
+        const auto& w = words[pos];
+        if(w.empty() || !std::all_of(w.begin(), w.end(), ::isdigit))
+            break;
+        ret.push_back(std::stoull(w));
+    }
+    return ret;
+}
+
+static bool parse_precision(const std::string& name, rocfft_precision& precision)
+{
+    if(name == "half")
+        precision = rocfft_precision_half;
+    else if(name == "single")
+        precision = rocfft_precision_single;
+    else if(name == "double")
+        precision = rocfft_precision_double;
+    else
+        return false;
+    return true;
+}
+
+// parse "rocfft-bench --length 64 64 -b 1 -t 0 ..." as produced by
+// rocfft_bench_command.  row-major lengths and strides are reversed.
+static bool parse_bench_command(const std::vector<std::string>& words, PrefetchProblem& problem)
+{
+    size_t pos = 0;
+    if(pos < words.size() && words[pos] == "rocfft-bench")
+        ++pos;
+
+    while(pos < words.size())
+    {
+        const auto arg = words[pos++];
+        // options that take one value
+        auto next = [&]() { return pos < words.size() ? words[pos++] : std::string(); };
+
+        if(arg == "--length")
+        {
+            problem.lengths = parse_size_list(words, pos);
+            std::reverse(problem.lengths.begin(), problem.lengths.end());
+        }
+        else if(arg == "-b" || arg == "--batchSize")
+            problem.batch = std::stoull(next());
+        else if(arg == "-o" || arg == "--notInPlace")
+            problem.placement = rocfft_placement_notinplace;
+        else if(arg == "-t" || arg == "--transformType")
+            problem.transformType = static_cast<rocfft_transform_type>(std::stoi(next()));
+        else if(arg == "--precision")
+        {
+            if(!parse_precision(next(), problem.precision))
+                return false;
+        }
+        else if(arg == "--double")
+            problem.precision = rocfft_precision_double;
+        else if(arg == "--itype")
+            problem.inArrayType = static_cast<rocfft_array_type>(std::stoi(next()));
+        else if(arg == "--otype")
+            problem.outArrayType = static_cast<rocfft_array_type>(std::stoi(next()));
+        else if(arg == "--istride")
+        {
+            problem.inStrides = parse_size_list(words, pos);
+            std::reverse(problem.inStrides.begin(), problem.inStrides.end());
+        }
+        else if(arg == "--ostride")
+        {
+            problem.outStrides = parse_size_list(words, pos);
+            std::reverse(problem.outStrides.begin(), problem.outStrides.end());
+        }
+        else if(arg == "--idist")
+            problem.inDist = std::stoull(next());
+        else if(arg == "--odist")
+            problem.outDist = std::stoull(next());
+        else if(arg == "--ioffset")
+            problem.inOffset = parse_size_list(words, pos);
+        else if(arg == "--ooffset")
+            problem.outOffset = parse_size_list(words, pos);
+        else if(arg.compare(0, 1, "-") == 0)
+        {
+            // other bench options (device, trial count, etc.) don't
+            // affect which kernels are needed - skip them and their
+            // values
+            while(pos < words.size() && words[pos].compare(0, 1, "-") != 0)
+                ++pos;
+        }
+        else
+            return false;
+    }
+    return true;
+}
+
+// parse a test token like
+// "complex_forward_len_64_64_single_ip_batch_1_istride_64_1_CI_...".
+// row-major lengths and strides are reversed.
+static bool parse_token(const std::string& token, PrefetchProblem& problem)
+{
+    std::vector<std::string> vals;
+    std::stringstream        ss(token);
+    for(std::string v; std::getline(ss, v, '_');)
+        vals.push_back(v);
+
+    auto array_type = [](const std::string& val) {
+        if(val == "CI")
+            return rocfft_array_type_complex_interleaved;
+        if(val == "CP")
+            return rocfft_array_type_complex_planar;
+        if(val == "R")
+            return rocfft_array_type_real;
+        if(val == "HI")
+            return rocfft_array_type_hermitian_interleaved;
+        if(val == "HP")
+            return rocfft_array_type_hermitian_planar;
+        return rocfft_array_type_unset;
+    };
+
+    size_t pos = 0;
+    if(vals.size() < 8)
+        return false;
+    const bool complex = vals[pos++] == "complex";
+    const bool forward = vals[pos++] == "forward";
+    if(complex)
+        problem.transformType = forward ? rocfft_transform_type_complex_forward
+                                        : rocfft_transform_type_complex_inverse;
+    else
+        problem.transformType
+            = forward ? rocfft_transform_type_real_forward : rocfft_transform_type_real_inverse;
+
+    if(vals[pos++] != "len")
+        return false;
+    problem.lengths = parse_size_list(vals, pos);
+    std::reverse(problem.lengths.begin(), problem.lengths.end());
+
+    if(pos + 2 >= vals.size() || !parse_precision(vals[pos++], problem.precision))
+        return false;
+    problem.placement
+        = vals[pos++] == "ip" ? rocfft_placement_inplace : rocfft_placement_notinplace;
+
+    while(pos < vals.size())
+    {
+        const auto key = vals[pos++];
+        if(key == "batch" && pos < vals.size())
+            problem.batch = std::stoull(vals[pos++]);
+        else if(key == "istride")
+        {
+            problem.inStrides = parse_size_list(vals, pos);
+            std::reverse(problem.inStrides.begin(), problem.inStrides.end());
+            if(pos < vals.size())
+                problem.inArrayType = array_type(vals[pos++]);
+        }
+        else if(key == "ostride")
+        {
+            problem.outStrides = parse_size_list(vals, pos);
+            std::reverse(problem.outStrides.begin(), problem.outStrides.end());
+            if(pos < vals.size())
+                problem.outArrayType = array_type(vals[pos++]);
+        }
+        else if(key == "idist" && pos < vals.size())
+            problem.inDist = std::stoull(vals[pos++]);
+        else if(key == "odist" && pos < vals.size())
+            problem.outDist = std::stoull(vals[pos++]);
+        else if(key == "ioffset")
+            problem.inOffset = parse_size_list(vals, pos);
+        else if(key == "ooffset")
+            problem.outOffset = parse_size_list(vals, pos);
+        // callback, scale and field markers don't change which
+        // kernels a single-device plan needs
+        else if(key == "CB" || key == "scale")
+            continue;
+        else
+            return false;
+    }
+    return true;
+}
+
+bool PrefetchProblem::parse(const std::string& line)
+{
+    std::vector<std::string> words;
+    std::stringstream        ss(line);
+    for(std::string w; ss >> w;)
+        words.push_back(w);
+    if(words.empty())
+        return false;
+
+    try
+    {
+        bool ok = words.size() == 1 ? parse_token(words.front(), *this)
+                                    : parse_bench_command(words, *this);
+        return ok && !lengths.empty() && lengths.size() <= 3;
+    }
+    catch(std::exception&)
+    {
+        // malformed number
+        return false;
+    }
+}
+
+// create and destroy a plan for the problem, so its kernels get
+// compiled and loaded
+static void prefetch_problem(const PrefetchProblem& problem)
+{
+    rocfft_plan_description desc = nullptr;
+    if(rocfft_plan_description_create(&desc) != rocfft_status_success)
+        return;
+    rocfft_plan plan = nullptr;
+    if(rocfft_plan_description_set_data_layout(desc,
+                                               problem.inArrayType,
+                                               problem.outArrayType,
+                                               problem.inOffset.empty() ? nullptr
+                                                                        : problem.inOffset.data(),
+                                               problem.outOffset.empty() ? nullptr
+                                                                         : problem.outOffset.data(),
+                                               problem.inStrides.size(),
+                                               problem.inStrides.data(),
+                                               problem.inDist,
+                                               problem.outStrides.size(),
+                                               problem.outStrides.data(),
+                                               problem.outDist)
+           == rocfft_status_success
+       && rocfft_plan_create(&plan,
+                             problem.placement,
+                             problem.transformType,
+                             problem.precision,
+                             problem.lengths.size(),
+                             problem.lengths.data(),
+                             problem.batch,
+                             desc)
+              == rocfft_status_success)
+        rocfft_plan_destroy(plan);
+    rocfft_plan_description_destroy(desc);
+}
+
+rocfft_status CachePrefetcher::Prefetch(const std::string& manifest)
+{
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        return rocfft_status_failure;
+
+    std::vector<PrefetchProblem> problems;
+    std::stringstream            ss(manifest);
+    for(std::string line; std::getline(ss, line);)
+    {
+        auto start = line.find_first_not_of(" \t\r");
+        if(start == std::string::npos || line[start] == '#')
+            continue;
+        if(!problems.emplace_back().parse(line))
+            return rocfft_status_invalid_arg_value;
+    }
+    if(problems.empty())
+        return rocfft_status_success;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for(auto& p : problems)
+        queue.emplace_back(deviceId, std::move(p));
+
+    // each plan already compiles its kernels in parallel, so don't
+    // start more workers than there are problems
+    size_t num_workers = std::min<size_t>(problems.size(), std::max(rocfft_concurrency(), 1u));
+    for(size_t i = 0; i < num_workers; ++i)
+        workers.emplace_back(&CachePrefetcher::Worker, this);
+    return rocfft_status_success;
+}
+
+void CachePrefetcher::Worker()
+{
+    // compiles for prefetch shouldn't delay plans that callers are
+    // waiting for
+    RTCCompileScheduler::BackgroundScope background;
+
+    while(true)
+    {
+        std::pair<int, PrefetchProblem> item;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if(queue.empty())
+                return;
+            item = std::move(queue.front());
+            queue.pop_front();
+        }
+        if(hipSetDevice(item.first) != hipSuccess)
+            continue;
+        prefetch_problem(item.second);
+    }
+}
+
+void CachePrefetcher::Stop()
+{
+    std::vector<std::thread> to_join;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        queue.clear();
+        to_join.swap(workers);
+    }
+    for(auto& t : to_join)
+        t.join();
+}
+
+rocfft_status rocfft_cache_prefetch(const char* manifest)
+{
+    log_trace(__func__, "manifest", manifest ? manifest : "");
+    if(!manifest)
+        return rocfft_status_invalid_arg_value;
+    return CachePrefetcher::GetPrefetcher().Prefetch(manifest);
+}
@@ -28,6 +28,7 @@
 #include "rtc_cache.h"
 #include "rtc_chirp_kernel.h"
 #include "rtc_kernel.h"
+#include "twiddles.h"
 #include <cassert>
 #include <iostream>
 #include <math.h>
@@ -36,17 +37,6 @@
 #include <string>
 #include <tuple>
 
-// this vector stores chirp for each device id.  index in the
-// vector is device id.  note that this vector needs to be protected
-// against concurrent access, but chirp are always accessed
-// through the Repo which guarantees exclusive access.
-static std::vector<hipStream_wrapper_t> chirp_streams;
-
-void chirp_streams_cleanup()
-{
-    chirp_streams.clear();
-}
-
 template <typename Tcomplex>
 void launch_chirp_kernel(const size_t           N,
                          rocfft_precision       precision,
@@ -57,7 +47,10 @@ void launch_chirp_kernel(const size_t           N,
     auto blockSize = CHIRP_THREADS;
     auto numBlocks = DivRoundingUp<size_t>(N, blockSize);
 
-    auto          kernel = RTCKernelChirp::generate(deviceProp.gcnArchName, precision);
+    auto& kernel = table_kernel(chirp_rtc_kernel_name(precision), [&]() {
+        return std::unique_ptr<RTCKernel>(
+            new RTCKernelChirp(RTCKernelChirp::generate(deviceProp.gcnArchName, precision)));
+    });
     RTCKernelArgs kargs;
     kargs.append_size_t(N);
     kargs.append_ptr(output);
@@ -77,19 +70,12 @@ gpubuf chirp_create_pr(size_t                 N,
     if(chirp.alloc(chirp_bytes) != hipSuccess)
         throw std::runtime_error("unable to allocate chirp length " + std::to_string(N));
 
-    if(deviceId >= chirp_streams.size())
-        chirp_streams.resize(deviceId + 1);
-    hipStream_wrapper_t& stream = chirp_streams[deviceId];
-    if(!stream)
-        stream.alloc();
+    hipStream_t stream = table_stream(deviceId);
 
     auto device_chirp_ptr = static_cast<Tcomplex*>(chirp.data());
 
     launch_chirp_kernel(N, precision, deviceProp, stream, device_chirp_ptr);
 
-    if(hipStreamSynchronize(stream) != hipSuccess)
-        throw std::runtime_error("hipStream failure");
-
     return chirp;
 }
 
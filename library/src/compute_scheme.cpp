@@ -47,6 +47,16 @@ static const std::map<ComputeScheme, const char*>& ComputeSchemetoStringMap()
            {ENUMSTR(CS_KERNEL_COPY_HERM_TO_CMPLX)},
            {ENUMSTR(CS_KERNEL_COPY_CMPLX_TO_R)},
 
+           {ENUMSTR(CS_REAL_TRANSFORM_PAIR)},
+           {ENUMSTR(CS_KERNEL_PAIR_R_TO_CMPLX)},
+           {ENUMSTR(CS_KERNEL_PAIR_CMPLX_TO_HERM)},
+
+           {ENUMSTR(CS_REAL_TRANSFORM_PACKED)},
+           {ENUMSTR(CS_KERNEL_PACK_HERM)},
+           {ENUMSTR(CS_KERNEL_UNPACK_HERM)},
+
+           {ENUMSTR(CS_REAL_TO_REAL)},
+
            {ENUMSTR(CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z)},
            {ENUMSTR(CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY)},
            {ENUMSTR(CS_KERNEL_STOCKHAM_R_TO_CMPLX_TRANSPOSE_Z_XY)},
@@ -66,6 +76,12 @@ static const std::map<ComputeScheme, const char*>& ComputeSchemetoStringMap()
            {ENUMSTR(CS_KERNEL_RES_MUL)},
            {ENUMSTR(CS_KERNEL_BLUESTEIN_SINGLE)},
 
+           {ENUMSTR(CS_RADER)},
+           {ENUMSTR(CS_KERNEL_RADER_CHIRP)},
+           {ENUMSTR(CS_KERNEL_RADER_GATHER)},
+           {ENUMSTR(CS_KERNEL_RADER_MUL)},
+           {ENUMSTR(CS_KERNEL_RADER_SCATTER)},
+
            {ENUMSTR(CS_L1D_TRTRT)},
            {ENUMSTR(CS_L1D_CC)},
            {ENUMSTR(CS_L1D_CRT)},
@@ -83,7 +99,9 @@ static const std::map<ComputeScheme, const char*>& ComputeSchemetoStringMap()
            {ENUMSTR(CS_3D_BLOCK_CR)},
            {ENUMSTR(CS_3D_RC)},
            {ENUMSTR(CS_KERNEL_3D_STOCKHAM_BLOCK_CC)},
-           {ENUMSTR(CS_KERNEL_3D_SINGLE)}};
+           {ENUMSTR(CS_KERNEL_3D_SINGLE)},
+
+           {ENUMSTR(CS_ND_RC)}};
     return ComputeSchemetoString;
 }
 
@@ -114,21 +132,27 @@ static const std::set<ComputeScheme>& ProblemScheme()
 {
     static const std::set<ComputeScheme> ProblemSchemeSet = {(CS_KERNEL_STOCKHAM),
                                                              (CS_REAL_TRANSFORM_USING_CMPLX),
+                                                             (CS_REAL_TRANSFORM_PAIR),
+                                                             (CS_REAL_TRANSFORM_PACKED),
+                                                             (CS_REAL_TO_REAL),
                                                              (CS_REAL_TRANSFORM_EVEN),
                                                              (CS_REAL_2D_EVEN),
                                                              (CS_REAL_3D_EVEN),
                                                              (CS_BLUESTEIN),
+                                                             (CS_RADER),
                                                              (CS_L1D_TRTRT),
                                                              (CS_L1D_CC),
                                                              (CS_L1D_CRT),
                                                              (CS_2D_RTRT),
                                                              (CS_2D_RC),
                                                              (CS_KERNEL_2D_SINGLE),
+                                                             (CS_KERNEL_3D_SINGLE),
                                                              (CS_3D_TRTRTR),
                                                              (CS_3D_RTRT),
                                                              (CS_3D_BLOCK_RC),
                                                              (CS_3D_BLOCK_CR),
-                                                             (CS_3D_RC)};
+                                                             (CS_3D_RC),
+                                                             (CS_ND_RC)};
 
     return ProblemSchemeSet;
 }
@@ -152,6 +176,8 @@ std::string PrintKernelSchemeAbbr(ComputeScheme cs)
         return "sbrc";
     case CS_KERNEL_2D_SINGLE:
         return "2d_single";
+    case CS_KERNEL_3D_SINGLE:
+        return "3d_single";
     case CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z:
         return "sbrc_xy_z";
     case CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY:
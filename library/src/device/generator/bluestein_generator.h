@@ -66,6 +66,7 @@ public:
     Variable data_buf{"data_buf", "scalar_type", true};
     Variable data_bufre{"data_bufre", "real_type_t<scalar_type>", true, true};
     Variable data_bufim{"data_bufim", "real_type_t<scalar_type>", true, true};
+    Variable data_buf_real{"data_buf_real", "real_type_t<scalar_type>", true};
     Variable data_elem{"data_elem", "scalar_type"};
     Variable length_N_blue{"length_N_blue", "const size_t"};
     Variable length_M_blue{"length_M_blue", "const size_t"};
@@ -644,13 +645,17 @@ public:
                     int               direction,
                     bool              planar_load,
                     bool              planar_store,
-                    bool              intrinsic)
+                    bool              intrinsic,
+                    bool              real_load       = false,
+                    bool              hermitian_store = false)
         : scheme(scheme)
         , type(type)
         , direction(direction)
         , planar_load(planar_load)
         , planar_store(planar_store)
         , intrinsic(intrinsic)
+        , real_load(real_load)
+        , hermitian_store(hermitian_store)
     {
     }
 
@@ -722,9 +727,11 @@ private:
         return tpls;
     }
 
-    void append_data_buf(ArgumentList& args, bool planar)
+    void append_data_buf(ArgumentList& args, bool planar, bool real = false)
     {
-        if(planar)
+        if(real)
+            args.append(blueData.data_buf_real);
+        else if(planar)
         {
             args.append(blueData.data_bufre);
             args.append(blueData.data_bufim);
@@ -766,6 +773,8 @@ private:
                     blueData.data_bufre,
                     blueData.data_bufim,
                     blueData.data_idx,
+                    blueData.load_cb_fn,
+                    blueData.load_cb_data,
                 }));
         }
         else
@@ -785,6 +794,28 @@ private:
         }
     }
 
+    std::unique_ptr<Expression> get_real_load_expression()
+    {
+        if(intrinsic)
+            return std::make_unique<Expression>(CallExpr{
+                "scalar_type",
+                {IntrinsicLoad({
+                     blueData.data_buf_real,
+                     blueData.data_voffset,
+                     blueData.data_soffset,
+                     blueData.data_rw_flag,
+                 }),
+                 0}});
+        else
+            return std::make_unique<Expression>(CallExpr{
+                "scalar_type",
+                {LoadGlobal{
+                     blueData.data_buf_real,
+                     blueData.data_idx,
+                 },
+                 0}});
+    }
+
     std::unique_ptr<Expression> get_load_expression(const Expression& index)
     {
         if(planar_load)
@@ -802,6 +833,8 @@ private:
                     blueData.data_bufre,
                     blueData.data_bufim,
                     index,
+                    blueData.load_cb_fn,
+                    blueData.load_cb_data,
                 }));
         }
         else
@@ -839,7 +872,8 @@ private:
                 return std::make_unique<Statement>(StoreGlobalPlanar(blueData.data_bufre,
                                                                      blueData.data_bufim,
                                                                      blueData.data_idx,
-                                                                     blueData.data_elem));
+                                                                     blueData.data_elem,
+                                                                     true));
             }
         }
         else
@@ -872,7 +906,7 @@ private:
             else
             {
                 return std::make_unique<Statement>(StoreGlobalPlanar(
-                    blueData.data_bufre, blueData.data_bufim, index, blueData.data_elem));
+                    blueData.data_bufre, blueData.data_bufim, index, blueData.data_elem, true));
             }
         }
         else
@@ -975,7 +1009,7 @@ private:
         args.append(blueData.transform_idx);
         append_data_index(args, intrinsic);
         args.append(blueData.length_N_blue);
-        append_data_buf(args, planar_load);
+        append_data_buf(args, planar_load, real_load);
         args.append(blueData.load_cb_fn);
         args.append(blueData.load_cb_data);
         f.arguments   = args;
@@ -985,7 +1019,9 @@ private:
         Variable elem_scalar{"elem_scalar", "scalar_type"};
         Variable aux_real{"aux_real", "real_type_t<scalar_type>"};
 
-        auto load_expression = get_load_expression();
+        // real input is read as is and extended with a zero
+        // imaginary part, so no conversion pass is needed
+        auto load_expression = real_load ? get_real_load_expression() : get_load_expression();
 
         std::unique_ptr<Expression> mul_assign_expression_x, mul_assign_expression_y;
         if(direction == -1) // forward
@@ -1008,7 +1044,8 @@ private:
         }
 
         StatementList& body = f.body;
-        body += CallbackLoadDeclaration{blueData.scalar_type.render(),
+        body += CallbackLoadDeclaration{real_load ? "real_type_t<scalar_type>"
+                                                  : blueData.scalar_type.render(),
                                         blueData.callback_type.render()};
         body += If{blueData.transform_idx >= blueData.length_N_blue,
                    {
@@ -1290,11 +1327,15 @@ private:
                 aux_real * blueData.chirp[blueData.transform_idx].y()
                 - blueData.data_elem.y() * blueData.chirp[blueData.transform_idx].x());
 
+        // Hermitian output only keeps the non-redundant first half
+        Expression store_length = hermitian_store ? Expression{blueData.length_N_blue / 2 + 1}
+                                                  : Expression{blueData.length_N_blue};
+
         StatementList& body = f.body;
         body += CallbackStoreDeclaration{blueData.scalar_type.render(),
                                          blueData.callback_type.render()};
         body += If{
-            blueData.transform_idx < blueData.length_N_blue,
+            blueData.transform_idx < store_length,
             {
                 Assign{blueData.data_elem,
                        blueData.data_elem
@@ -1319,26 +1360,35 @@ private:
     bool              planar_load;
     bool              planar_store;
     bool              intrinsic;
+    bool              real_load;
+    bool              hermitian_store;
     BluesteinFunction function;
 };
 
+// real is true if the kernel reads the real input of a real-to-complex
+// transform directly
 static Function generate_bluestein_device_load_function(const ComputeScheme     scheme,
                                                         const BluesteinFuseType type,
                                                         int                     direction,
                                                         bool                    planar,
-                                                        bool                    intrinsic)
+                                                        bool                    intrinsic,
+                                                        bool                    real = false)
 {
-    auto blueKernel = BluesteinKernel(scheme, type, direction, planar, false, intrinsic);
+    auto blueKernel = BluesteinKernel(scheme, type, direction, planar, false, intrinsic, real);
     return blueKernel.generate_device_load_function();
 }
 
+// hermitian is true if the kernel writes the Hermitian output of a
+// real-to-complex transform directly
 static Function generate_bluestein_device_store_function(const ComputeScheme     scheme,
                                                          const BluesteinFuseType type,
                                                          int                     direction,
                                                          bool                    planar,
-                                                         bool                    intrinsic)
+                                                         bool                    intrinsic,
+                                                         bool                    hermitian = false)
 {
-    auto blueKernel = BluesteinKernel(scheme, type, direction, false, planar, intrinsic);
+    auto blueKernel
+        = BluesteinKernel(scheme, type, direction, false, planar, intrinsic, false, hermitian);
     return blueKernel.generate_device_store_function();
 }
 
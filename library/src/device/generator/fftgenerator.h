@@ -856,22 +856,25 @@ struct FFTExchangeDual
     }
 };
 
+// chirp values are computed in-kernel by the bluestein_chirp device
+// function, rather than read from a chirp buffer
 struct FFTBluesteinPadMul : public FFTGPUWork
 {
     unsigned int length;
-    FFTBuffer    dst, src, chirp;
+    int          direction;
+    FFTBuffer    dst, src;
 
     FFTBluesteinPadMul() = delete;
     FFTBluesteinPadMul(unsigned int            length,
+                       int                     direction,
                        FFTBuffer const&        dst,
                        FFTBuffer const&        src,
-                       FFTBuffer const&        chirp,
                        FFTGPUWorkParams const& params)
         : FFTGPUWork(params)
         , length(length)
+        , direction(direction)
         , dst(dst)
         , src(src)
-        , chirp(chirp)
     {
     }
 
@@ -885,6 +888,7 @@ struct FFTBluesteinPadMul : public FFTGPUWork
         StatementList stmts;
 
         Variable in_elem{"in_elem", "scalar_type"};
+        Variable chirp{"chirp", "scalar_type"};
 
         for(unsigned int w = 0; w < params.width; ++w)
         {
@@ -895,10 +899,12 @@ struct FFTBluesteinPadMul : public FFTGPUWork
                         {
                             Declaration{in_elem},
                             Assign{in_elem, src.load_global(idx)},
-                            Assign{dst[idx].x(),
-                                   in_elem.x() * chirp[idx].x() + in_elem.y() * chirp[idx].y()},
+                            Declaration{chirp,
+                                        CallExpr{"bluestein_chirp<scalar_type>",
+                                                 {idx, Literal{length}, Literal{direction}}}},
+                            Assign{dst[idx].x(), in_elem.x() * chirp.x() + in_elem.y() * chirp.y()},
                             Assign{dst[idx].y(),
-                                   -in_elem.x() * chirp[idx].y() + in_elem.y() * chirp[idx].x()},
+                                   -in_elem.x() * chirp.y() + in_elem.y() * chirp.x()},
                         }};
             stmts += Else{{
                 Assign{dst[idx], CallExpr{"scalar_type", {0, 0}}},
@@ -953,27 +959,29 @@ struct FFTBluesteinFFTMul : public FFTGPUWork
     }
 };
 
+// like FFTBluesteinPadMul, computes chirp values in-kernel
 struct FFTBluesteinResMul : public FFTGPUWork
 {
     unsigned int length;
     unsigned int lengthBlue;
-    FFTBuffer    dst, src, chirp;
+    int          direction;
+    FFTBuffer    dst, src;
     Variable     elem;
 
     FFTBluesteinResMul() = delete;
     FFTBluesteinResMul(unsigned int            length,
                        unsigned int            lengthBlue,
+                       int                     direction,
                        FFTBuffer const&        dst,
                        FFTBuffer const&        src,
-                       FFTBuffer const&        chirp,
                        Variable&               elem,
                        FFTGPUWorkParams const& params)
         : FFTGPUWork(params)
         , length(length)
         , lengthBlue(lengthBlue)
+        , direction(direction)
         , dst(dst)
         , src(src)
-        , chirp(chirp)
         , elem(elem)
     {
     }
@@ -988,6 +996,7 @@ struct FFTBluesteinResMul : public FFTGPUWork
         StatementList stmts;
 
         Literal MI{"(1.0 / real_type_t<scalar_type>(" + std::to_string(lengthBlue) + "))"};
+        Variable chirp{"chirp", "scalar_type"};
 
         for(unsigned int w = 0; w < params.width; ++w)
         {
@@ -995,10 +1004,14 @@ struct FFTBluesteinResMul : public FFTGPUWork
             auto idx = tid + w * (params.length / params.width);
 
             If write_cond{idx < length, {}};
+            write_cond.body += Declaration{
+                chirp,
+                CallExpr{"bluestein_chirp<scalar_type>",
+                         {idx, Literal{length}, Literal{direction}}}};
             write_cond.body += Assign{
-                elem.x(), MI * (src[idx].x() * chirp[idx].x() + src[idx].y() * chirp[idx].y())};
+                elem.x(), MI * (src[idx].x() * chirp.x() + src[idx].y() * chirp.y())};
             write_cond.body += Assign{
-                elem.y(), MI * (-src[idx].x() * chirp[idx].y() + src[idx].y() * chirp[idx].x())};
+                elem.y(), MI * (-src[idx].x() * chirp.y() + src[idx].y() * chirp.x())};
             write_cond.body += dst.store_global(idx, elem);
             stmts += write_cond;
         }
@@ -1537,10 +1550,9 @@ struct BluesteinTransform
     FFTBuffer R{"R", Literal{0}, Literal{1}, 0};
     // LDS buffer
     FFTBuffer A{"A", Variable{"offset_lds", "int"}, Variable{"stride_lds", "int"}};
-    // FFTed chirp signal (second half of chirp buffer)
+    // FFTed chirp signal (second half of chirp buffer).  the chirp
+    // signal itself is computed in-kernel.
     FFTBuffer B{"B", Literal{0}, Literal{1}};
-    // chirp signal (first half of chirp buffer)
-    FFTBuffer a{"a", Literal{0}, Literal{1}};
     // user data
     FFTBuffer X{"X", Variable{"offset", "size_t"}, Variable{"stride0", "size_t"}};
 
@@ -1587,7 +1599,6 @@ struct BluesteinTransform
         context->add_local(offset);
         context->add_local(batch);
         context->add_local(write);
-        context->add_local(a.variable());
         context->add_local(B.variable());
         context->add_local(A.variable());
         context->add_local(val);
@@ -1618,8 +1629,8 @@ struct BluesteinTransform
 
         bluestein += offsets;
 
-        // pad X to lengthBlue, store X * a -> A
-        bluestein += FFTBluesteinPadMul(length, A, X, a, work_full);
+        // pad X to lengthBlue, store X * chirp -> A
+        bluestein += FFTBluesteinPadMul(length, direction, A, X, work_full);
 
         bluestein += FFTSyncThreads{work_full};
 
@@ -1638,8 +1649,8 @@ struct BluesteinTransform
         bluestein += make_inverse(stockham.generate());
 
         bluestein += FFTSyncThreads{work_full};
-        // multiply a * A -> X
-        bluestein += FFTBluesteinResMul(length, lengthBlue, X, A, a, val, work_full);
+        // multiply chirp * A -> X
+        bluestein += FFTBluesteinResMul(length, lengthBlue, direction, X, A, val, work_full);
 
         return make_table_twiddle(bluestein, stockham.twiddles);
     }
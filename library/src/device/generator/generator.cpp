@@ -31,14 +31,22 @@
     {                                                              \
         std::string s;                                             \
         if(get_precedence(args[0]) > precedence)                   \
-            s += "(" + vrender(args[0]) + ")";                     \
+        {                                                          \
+            s += "(";                                              \
+            s += vrender(args[0]);                                 \
+            s += ")";                                              \
+        }                                                          \
         else                                                       \
             s += vrender(args[0]);                                 \
         for(auto arg = args.begin() + 1; arg != args.end(); ++arg) \
         {                                                          \
             s += oper;                                             \
             if(get_precedence(*arg) >= precedence)                 \
-                s += "(" + vrender(*arg) + ")";                    \
+            {                                                      \
+                s += "(";                                          \
+                s += vrender(*arg);                                \
+                s += ")";                                          \
+            }                                                      \
             else                                                   \
                 s += vrender(*arg);                                \
         }                                                          \
@@ -50,7 +58,11 @@
     {                                                 \
         std::string s = oper;                         \
         if(get_precedence(args.front()) > precedence) \
-            s += "(" + vrender(args.front()) + ")";   \
+        {                                             \
+            s += "(";                                 \
+            s += vrender(args.front());               \
+            s += ")";                                 \
+        }                                             \
         else                                          \
             s += vrender(args.front());               \
         return s;                                     \
@@ -185,6 +197,9 @@ LoadGlobalPlanar::LoadGlobalPlanar(const std::vector<Expression>& args)
 
 std::string LoadGlobalPlanar::render() const
 {
+    if(args.size() == 5)
+        return "load_planar_cb<cbtype>(" + vrender(args[0]) + "," + vrender(args[1]) + ","
+               + vrender(args[2]) + "," + vrender(args[3]) + "," + vrender(args[4]) + ")";
     return "load_planar(" + vrender(args[0]) + "," + vrender(args[1]) + "," + vrender(args[2])
            + ")";
 }
@@ -395,18 +410,16 @@ std::string ComplexMultiply::render() const
     return r.render();
 }
 
+// twiddle multiplies go through helpers in common.h, so that each
+// precision can use the best instructions it has
 std::string TwiddleMultiply::render() const
 {
-    auto& a = vars[0];
-    auto& b = vars[1];
-    return ComplexLiteral{a.x() * b.x() - a.y() * b.y(), a.y() * b.x() + a.x() * b.y()}.render();
+    return CallExpr{"twiddle_multiply", {vars[0], vars[1]}}.render();
 }
 
 std::string TwiddleMultiplyConjugate::render() const
 {
-    auto& a = vars[0];
-    auto& b = vars[1];
-    return ComplexLiteral{a.x() * b.x() + a.y() * b.y(), a.y() * b.x() - a.x() * b.y()}.render();
+    return CallExpr{"twiddle_multiply_conj", {vars[0], vars[1]}}.render();
 }
 
 Parens::Parens(Expression&& inside)
@@ -523,6 +536,9 @@ std::string Declaration::render() const
 
 std::string StoreGlobalPlanar::render() const
 {
+    if(callbacks)
+        return "store_planar_cb<cbtype>(" + realPtr.render() + "," + imagPtr.render() + ","
+               + vrender(index) + "," + vrender(value) + ", store_cb_fn, store_cb_data);";
     return "store_planar(" + realPtr.render() + "," + imagPtr.render() + "," + vrender(index) + ","
            + vrender(value) + ");";
 }
@@ -538,6 +554,8 @@ std::string Butterfly::render() const
     {
         func += "InvRad" + std::to_string(args.size()) + "B1";
     }
+    if(matrix)
+        func += "Matrix";
     return Call{func, args}.render();
 }
 
@@ -546,9 +564,14 @@ StatementList::StatementList(const std::initializer_list<Statement>& il)
     : statements(il){};
 std::string StatementList::render() const
 {
+    // statements can be large subtrees, so avoid copying them and
+    // append each rendering in place
     std::string r;
-    for(auto s : statements)
-        r += vrender(s) + "\n";
+    for(const auto& s : statements)
+    {
+        r += vrender(s);
+        r += "\n";
+    }
     return r;
 }
 
@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <optional>
@@ -348,6 +349,10 @@ public:
     std::vector<Expression> args;
 };
 
+// Load from a global buffer.  args are the pointer and the index,
+// optionally followed by the element's index within its transform
+// for load ops that need it.  Only the pointer and index are
+// rendered.
 class LoadGlobal
 {
 public:
@@ -364,6 +369,10 @@ public:
     std::vector<Expression> args;
 };
 
+// Load from planar buffers.  args are the real and imaginary
+// pointers and the index, optionally followed by the load callback
+// function and data.  With a callback, it is called once for each
+// of the real and imaginary parts.
 class LoadGlobalPlanar
 {
 public:
@@ -670,10 +679,11 @@ struct CommentLines
 
         static const char* NEWLINE   = "\n";
         const char*        separator = "";
-        for(auto c : comments)
+        for(const auto& c : comments)
         {
             s += separator;
-            s += "// " + c;
+            s += "// ";
+            s += c;
             separator = NEWLINE;
         }
         return s;
@@ -806,7 +816,8 @@ public:
             return R"lambda(
     	    auto load_cb = [load_cb_fn](scalar_type* data, size_t offset, void* cbdata, void* sharedMem)
     	    {
-                auto real_cb = reinterpret_cast<typename callback_type<real_type_t<scalar_type>>::load>(load_cb_fn);
+                auto real_cb = get_load_cb<real_type_t<scalar_type>, )lambda"
+                   + cbtype + R"lambda(>(load_cb_fn);
                 return scalar_type
                 {
                     real_cb(reinterpret_cast<real_type_t<scalar_type>*>(data), offset * 2, cbdata, sharedMem),
@@ -837,7 +848,8 @@ public:
             return R"lambda(
                 auto store_cb = [store_cb_fn](scalar_type* data, size_t offset, scalar_type elem, void* cbdata, void* sharedMem)
                 {
-                    auto real_cb = reinterpret_cast<typename callback_type<real_type_t<scalar_type>>::store>(store_cb_fn);
+                    auto real_cb = get_store_cb<real_type_t<scalar_type>, )lambda"
+                   + cbtype + R"lambda(>(store_cb_fn);
                     real_cb(reinterpret_cast<real_type_t<scalar_type>*>(data), offset * 2, elem.x, cbdata, sharedMem);
                     real_cb(reinterpret_cast<real_type_t<scalar_type>*>(data), offset * 2 + 1, elem.y, cbdata, sharedMem);
                 };
@@ -968,18 +980,22 @@ public:
 };
 
 // Planar version of StoreGlobal, so we remember the scale factor
-// after a conversion to planar kernel
+// after a conversion to planar kernel.  If callbacks is set, the
+// store callback is called once for each of the real and imaginary
+// parts.
 class StoreGlobalPlanar
 {
 public:
     StoreGlobalPlanar(const Variable&   realPtr,
                       const Variable&   imagPtr,
                       const Expression& index,
-                      const Expression& value)
+                      const Expression& value,
+                      bool              callbacks = false)
         : realPtr{realPtr}
         , imagPtr{imagPtr}
         , index{index}
         , value{value}
+        , callbacks{callbacks}
     {
     }
     std::string render() const;
@@ -988,19 +1004,24 @@ public:
     Variable   imagPtr;
     Expression index;
     Expression value;
+    bool       callbacks;
 };
 
 class Butterfly
 {
 public:
     static const unsigned int precedence = 0;
-    Butterfly(bool forward, const std::vector<Expression>& args)
+    Butterfly(bool forward, const std::vector<Expression>& args, bool matrix = false)
         : forward(forward)
         , args(args)
+        , matrix(matrix)
     {
     }
     bool                    forward;
     std::vector<Expression> args;
+    // evaluate the butterfly as a matrix product on matrix cores,
+    // where the device supports it
+    bool                    matrix;
     std::string             render() const;
 };
 
@@ -1108,7 +1129,7 @@ static void operator+=(StatementList& stmts, const StatementList& s)
 {
     //    stmts.statements.insert(stmts.statements.end(), s.statements.cbegin(),
     //    s.statements.cend());
-    for(auto x : s.statements)
+    for(const auto& x : s.statements)
     {
         stmts += x;
     }
@@ -1329,7 +1350,7 @@ struct BaseVisitor
     virtual StatementList visit_StatementList(const StatementList& x)
     {
         auto y = StatementList();
-        for(auto s : x.statements)
+        for(const auto& s : x.statements)
         {
             y += std::visit(*this, s);
         }
@@ -1339,7 +1360,7 @@ struct BaseVisitor
     virtual ArgumentList visit_ArgumentList(const ArgumentList& x)
     {
         auto y = ArgumentList();
-        for(auto s : x.arguments)
+        for(const auto& s : x.arguments)
         {
             y.append(std::get<Variable>(visit_Variable(s)));
         }
@@ -1454,7 +1475,7 @@ struct BaseVisitor
         auto imagPtr = std::get<Variable>(visit_Variable(x.imagPtr));
         auto index   = std::visit(*this, x.index);
         auto value   = std::visit(*this, x.value);
-        return StatementList{StoreGlobalPlanar(realPtr, imagPtr, index, value)};
+        return StatementList{StoreGlobalPlanar(realPtr, imagPtr, index, value, x.callbacks)};
     }
 
     virtual Function visit_Function(const Function& x)
@@ -1477,6 +1498,11 @@ struct MakePlanarVisitor : public BaseVisitor
 {
     std::string varname, rename, imname;
 
+    // functions that take callback arguments run the callbacks on
+    // planar data too
+    bool load_callbacks  = false;
+    bool store_callbacks = false;
+
     MakePlanarVisitor(const std::string& varname)
         : varname(varname)
         , rename(varname + "re")
@@ -1484,6 +1510,18 @@ struct MakePlanarVisitor : public BaseVisitor
     {
     }
 
+    Function visit_Function(const Function& x) override
+    {
+        for(const auto& a : x.arguments.arguments)
+        {
+            if(a.name == "load_cb_fn")
+                load_callbacks = true;
+            else if(a.name == "store_cb_fn")
+                store_callbacks = true;
+        }
+        return BaseVisitor::visit_Function(x);
+    }
+
     ArgumentList visit_ArgumentList(const ArgumentList& x) override
     {
         ArgumentList y;
@@ -1517,6 +1555,12 @@ struct MakePlanarVisitor : public BaseVisitor
             re.name     = rename;
             Variable im = var;
             im.name     = imname;
+            if(load_callbacks)
+                return LoadGlobalPlanar({re,
+                                         im,
+                                         x.args[1],
+                                         Variable{"load_cb_fn", "void*"},
+                                         Variable{"load_cb_data", "void*"}});
             return LoadGlobalPlanar({re, im, x.args[1]});
         }
         return x;
@@ -1545,7 +1589,7 @@ struct MakePlanarVisitor : public BaseVisitor
             re.name     = rename;
             Variable im = var;
             im.name     = imname;
-            return {StoreGlobalPlanar{re, im, x.index, x.value}};
+            return {StoreGlobalPlanar{re, im, x.index, x.value, store_callbacks}};
         }
         return {x};
     }
@@ -1637,6 +1681,17 @@ struct MakeOutOfPlaceVisitor : public BaseVisitor
         return stmts;
     }
 
+    // global vector helpers take the buffer as an argument, so the
+    // helper's name says whether it's the input or output buffer
+    Expression visit_CallExpr(const CallExpr& x) override
+    {
+        if(x.name.rfind("load_global", 0) == 0)
+            mode = ExpressionVisitMode::INPUT;
+        else if(x.name.rfind("store_global", 0) == 0)
+            mode = ExpressionVisitMode::OUTPUT;
+        return BaseVisitor::visit_CallExpr(x);
+    }
+
     StatementList visit_Assign(const Assign& x) override
     {
         if(!op_name_match(x.lhs.name))
@@ -1757,7 +1812,7 @@ struct MakeInverseVisitor : public BaseVisitor
 
     StatementList visit_Butterfly(const Butterfly& x) override
     {
-        return {Butterfly{false, x.args}};
+        return {Butterfly{false, x.args, x.matrix}};
     }
 
     Expression visit_CallExpr(const CallExpr& x) override
@@ -1789,6 +1844,129 @@ static Function make_inverse(const Function& f)
     return visitor(f);
 }
 
+//
+// Make direction-agnostic
+//
+// An inverse transform is the conjugate of the forward transform
+// of the conjugated input.  Conjugate what a forward global
+// function loads and stores when its "direction" argument is 1, so
+// one kernel can do both directions.
+struct MakeRuntimeDirectionVisitor : public BaseVisitor
+{
+    Variable direction{"direction", "const int"};
+
+    Expression conjugate(const Expression& x)
+    {
+        return CallExpr{"conjugate_if_inverse", {x, direction}};
+    }
+
+    Expression visit_LoadGlobal(const LoadGlobal& x) override
+    {
+        return conjugate(BaseVisitor::visit_LoadGlobal(x));
+    }
+
+    Expression visit_LoadGlobalPlanar(const LoadGlobalPlanar& x) override
+    {
+        return conjugate(BaseVisitor::visit_LoadGlobalPlanar(x));
+    }
+
+    Expression visit_IntrinsicLoad(const IntrinsicLoad& x) override
+    {
+        return conjugate(BaseVisitor::visit_IntrinsicLoad(x));
+    }
+
+    Expression visit_IntrinsicLoadPlanar(const IntrinsicLoadPlanar& x) override
+    {
+        return conjugate(BaseVisitor::visit_IntrinsicLoadPlanar(x));
+    }
+
+    StatementList visit_IntrinsicLoadToDest(const IntrinsicLoadToDest& x) override
+    {
+        StatementList stmts = BaseVisitor::visit_IntrinsicLoadToDest(x);
+        if(auto dest = std::get_if<Variable>(&x.dest))
+            stmts += Assign{*dest, conjugate(*dest)};
+        return stmts;
+    }
+
+    StatementList visit_StoreGlobal(const StoreGlobal& x) override
+    {
+        auto value = conjugate(std::visit(*this, x.value));
+        return {StoreGlobal{x.ptr, x.index, value}};
+    }
+
+    StatementList visit_StoreGlobalPlanar(const StoreGlobalPlanar& x) override
+    {
+        auto value = conjugate(std::visit(*this, x.value));
+        return {StoreGlobalPlanar{x.realPtr, x.imagPtr, x.index, value, x.callbacks}};
+    }
+
+    StatementList visit_IntrinsicStore(const IntrinsicStore& x) override
+    {
+        auto value = conjugate(std::visit(*this, x.value));
+        return {IntrinsicStore{x.ptr, x.voffset, x.soffset, value, x.rw_flag}};
+    }
+
+    StatementList visit_IntrinsicStorePlanar(const IntrinsicStorePlanar& x) override
+    {
+        auto value = conjugate(std::visit(*this, x.value));
+        return {IntrinsicStorePlanar{x.ptrre, x.ptrim, x.voffset, x.soffset, value, x.rw_flag}};
+    }
+
+    Function visit_Function(const Function& x) override
+    {
+        Function y{x};
+        y.arguments.append(direction);
+        return BaseVisitor::visit_Function(y);
+    }
+};
+
+static Function make_runtime_direction(const Function& f)
+{
+    auto visitor = MakeRuntimeDirectionVisitor();
+    return visitor(f);
+}
+
+//
+// Replace variables
+//
+// Replace variables by name, either with another variable that keeps
+// the original's index, or with an arbitrary expression.
+struct ReplaceVariablesVisitor : public BaseVisitor
+{
+    const std::map<std::string, Expression> replacements;
+    explicit ReplaceVariablesVisitor(std::map<std::string, Expression>&& replacements)
+        : replacements(replacements)
+    {
+    }
+
+    Expression visit_Variable(const Variable& x) override
+    {
+        Variable y{x};
+        if(y.index)
+            y.index = std::visit(*this, *y.index);
+        if(y.index2D)
+            y.index2D = std::visit(*this, *y.index2D);
+        auto replacement = replacements.find(x.name);
+        if(replacement == replacements.end())
+            return y;
+        if(auto var = std::get_if<Variable>(&replacement->second))
+        {
+            y.name = var->name;
+            return y;
+        }
+        return replacement->second;
+    }
+
+    StatementList visit_IntrinsicLoadToDest(const IntrinsicLoadToDest& x) override
+    {
+        return {IntrinsicLoadToDest{std::visit(*this, x.dest),
+                                    std::visit(*this, x.data),
+                                    std::visit(*this, x.voffset),
+                                    std::visit(*this, x.soffset),
+                                    std::visit(*this, x.rw_flag)}};
+    }
+};
+
 //
 // Make runtime-compileable
 //
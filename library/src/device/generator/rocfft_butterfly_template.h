@@ -10,36 +10,60 @@ __device__ T TW_NSteps(const T* const twiddles, size_t u)
 {
     size_t j      = u & ((1 << Base) - 1); // get the lowest Base bits
     T      result = twiddles[j];
-    u >>= Base; // discard the lowest Base bits
-    int i = 0;
-    // static compiled, currently, steps can only be 2 or 3
-    if(Steps >= 2)
-    {
-        i += 1;
-        j      = u & ((1 << Base) - 1);
-        result = T((result.x * twiddles[(1 << Base) * i + j].x
-                    - result.y * twiddles[(1 << Base) * i + j].y),
-                   (result.y * twiddles[(1 << Base) * i + j].x
-                    + result.x * twiddles[(1 << Base) * i + j].y));
-    }
-    // static compiled
-    if(Steps >= 3)
+    // Steps is static, so the loop is fully unrolled.  Each step
+    // consumes the next Base bits of u: 5 steps of base 8 cover
+    // lengths up to 2^40.
+    static_assert(Steps <= 5, "at most 5 large twiddle steps are supported");
+    for(size_t i = 1; i < Steps; ++i)
     {
         u >>= Base; // discard the lowest Base bits
-
-        i += 1;
         j      = u & ((1 << Base) - 1);
         result = T((result.x * twiddles[(1 << Base) * i + j].x
                     - result.y * twiddles[(1 << Base) * i + j].y),
                    (result.y * twiddles[(1 << Base) * i + j].x
                     + result.x * twiddles[(1 << Base) * i + j].y));
     }
-    // we probably don't have 4-steps for large-twiddle
-    // if(Steps >= 4){...}
 
     return result;
 }
 
+// Compute the large twiddle for index u of an N-point large 1D
+// transform directly, instead of reading a multi-step table.  u is
+// reduced exactly in integer arithmetic first, so sincospi's argument
+// stays in [-1, 1] however large N is, and double-precision evaluation
+// keeps the result as accurate as the table.
+template <typename T>
+__device__ T TW_Compute(size_t u, size_t N)
+{
+    long long n = N;
+    long long r = u % N;
+    if(2 * r > n)
+        r -= n;
+    double s, c;
+    sincospi(2.0 * r / n, &s, &c);
+    return T(c, s);
+}
+
+// Twiddle u of a length N = 8 * N8 transform, from a table of its
+// first N8 + 1 twiddles, i.e. the angles in the first octant of the
+// unit circle.  Every other octant mirrors the first, so its
+// twiddles are table entries with their parts swapped and negated.
+template <typename T>
+__device__ T TW_Octant(const T* const twiddles, unsigned int u, unsigned int N8)
+{
+    unsigned int octant = u / N8;
+    unsigned int r      = u % N8;
+    // odd octants run backwards from the end of the next one
+    T w = twiddles[(octant & 1) ? N8 - r : r];
+
+    bool swap  = (octant ^ (octant >> 1)) & 1;
+    bool neg_x = (octant ^ (octant >> 2)) & 1;
+    bool neg_y = (octant ^ (octant >> 1) ^ (octant >> 2)) & 1;
+    auto x     = swap ? w.y : w.x;
+    auto y     = swap ? w.x : w.y;
+    return T(neg_x ? -x : x, neg_y ? -y : y);
+}
+
 template <typename T>
 __device__ T TW3step(const T* const twiddles, size_t u)
 {
@@ -118,6 +142,40 @@ __device__ void InvRad3B1(T* R0, T* R1, T* R2)
     ((*R2).y) = TI2;
 }
 
+// Half-precision radix-3 written with complex arithmetic, which is
+// packed for rocfft_complex<_Float16>.  Equivalent to the templates above.
+__device__ inline void Rad3B1Half(rocfft_complex<_Float16>* R0,
+                                  rocfft_complex<_Float16>* R1,
+                                  rocfft_complex<_Float16>* R2,
+                                  _Float16                  sign)
+{
+    typedef rocfft_complex<_Float16> T;
+
+    T sum  = (*R1) + (*R2);
+    T diff = (*R1) - (*R2);
+    // multiply by -i for forward, +i for inverse
+    T rot = T(diff.y, -diff.x) * sign;
+    T mid = (*R0) - C3QA * sum;
+
+    (*R0) = (*R0) + sum;
+    (*R1) = mid + C3QB * rot;
+    (*R2) = mid - C3QB * rot;
+}
+
+__device__ inline void FwdRad3B1(rocfft_complex<_Float16>* R0,
+                                 rocfft_complex<_Float16>* R1,
+                                 rocfft_complex<_Float16>* R2)
+{
+    Rad3B1Half(R0, R1, R2, 1);
+}
+
+__device__ inline void InvRad3B1(rocfft_complex<_Float16>* R0,
+                                 rocfft_complex<_Float16>* R1,
+                                 rocfft_complex<_Float16>* R2)
+{
+    Rad3B1Half(R0, R1, R2, -1);
+}
+
 template <typename T>
 __device__ void FwdRad4B1(T* R0, T* R2, T* R1, T* R3)
 {
@@ -237,6 +295,51 @@ __device__ void InvRad5B1(T* R0, T* R1, T* R2, T* R3, T* R4)
     ((*R4).y) = TI4;
 }
 
+// Half-precision radix-5 written with complex arithmetic, which is
+// packed for rocfft_complex<_Float16>.  Equivalent to the templates above.
+__device__ inline void Rad5B1Half(rocfft_complex<_Float16>* R0,
+                                  rocfft_complex<_Float16>* R1,
+                                  rocfft_complex<_Float16>* R2,
+                                  rocfft_complex<_Float16>* R3,
+                                  rocfft_complex<_Float16>* R4,
+                                  _Float16                  sign)
+{
+    typedef rocfft_complex<_Float16> T;
+
+    // multiply by -i for forward, +i for inverse
+    T d14 = (*R1) - (*R4);
+    T d23 = (*R2) - (*R3);
+    T r14 = T(d14.y, -d14.x) * sign;
+    T r23 = T(d23.y, -d23.x) * sign;
+
+    T mid14 = ((*R0) - C5QC * ((*R2) + (*R3))) + C5QA * (((*R1) - (*R2)) + ((*R4) - (*R3)));
+    T mid23 = ((*R0) - C5QC * ((*R1) + (*R4))) + C5QA * (((*R2) - (*R1)) + ((*R3) - (*R4)));
+
+    (*R0) = (*R0) + (*R1) + (*R2) + (*R3) + (*R4);
+    (*R1) = mid14 + C5QB * r14 + C5QD * r23;
+    (*R4) = mid14 - C5QB * r14 - C5QD * r23;
+    (*R2) = mid23 - C5QB * r23 + C5QD * r14;
+    (*R3) = mid23 + C5QB * r23 - C5QD * r14;
+}
+
+__device__ inline void FwdRad5B1(rocfft_complex<_Float16>* R0,
+                                 rocfft_complex<_Float16>* R1,
+                                 rocfft_complex<_Float16>* R2,
+                                 rocfft_complex<_Float16>* R3,
+                                 rocfft_complex<_Float16>* R4)
+{
+    Rad5B1Half(R0, R1, R2, R3, R4, 1);
+}
+
+__device__ inline void InvRad5B1(rocfft_complex<_Float16>* R0,
+                                 rocfft_complex<_Float16>* R1,
+                                 rocfft_complex<_Float16>* R2,
+                                 rocfft_complex<_Float16>* R3,
+                                 rocfft_complex<_Float16>* R4)
+{
+    Rad5B1Half(R0, R1, R2, R3, R4, -1);
+}
+
 template <typename T>
 __device__ void FwdRad6B1(T* R0, T* R1, T* R2, T* R3, T* R4, T* R5)
 {
@@ -1004,6 +1107,390 @@ __device__ void InvRad16B1(T* R0,
     (*R13) = res;
 }
 
+// multiply by dir * i
+template <int dir, typename T>
+__device__ T Rad16B1SRRotate(const T& b)
+{
+    return T(-dir * b.y, dir * b.x);
+}
+
+// in-place 4-point DFT
+template <int dir, typename T>
+__device__ void Rad16B1SRDFT4(T& p0, T& p1, T& p2, T& p3)
+{
+    T a0 = p0 + p2;
+    T a1 = p0 - p2;
+    T b0 = p1 + p3;
+    T b1 = p1 - p3;
+    p0   = a0 + b0;
+    p2   = a0 - b0;
+    p1   = a1 + Rad16B1SRRotate<dir>(b1);
+    p3   = a1 - Rad16B1SRRotate<dir>(b1);
+}
+
+// Split-radix step for N = 4q: given lo = E[k], hi = E[k+q] from the
+// even terms and z = Z[k], zc = Z'[k] from the odd terms, return
+// X[k], X[k+2q] in lo, z and X[k+q], X[k+3q] in hi, zc.  The twiddle
+// W^k = c * (1 + dir * i * t), and c is folded into the output FMAs.
+template <int dir, typename T>
+__device__ void Rad16B1SRStep(T& lo, T& hi, T& z, T& zc, real_type_t<T> c, real_type_t<T> t)
+{
+    typedef real_type_t<T> real_t;
+    const real_t           ds = -dir;
+
+    real_t sx = z.x + zc.x;
+    real_t dx = z.x - zc.x;
+    real_t sy = z.y + zc.y;
+    real_t dy = z.y - zc.y;
+
+    // W^k z + W^-k zc = c * (ax, ay), W^k z - W^-k zc = c * (bx, by)
+    real_t ax = sx + ds * t * dy;
+    real_t ay = sy - ds * t * dx;
+    real_t bx = dx + ds * t * sy;
+    real_t by = dy - ds * t * sx;
+
+    z  = T(lo.x - c * ax, lo.y - c * ay);
+    lo = T(lo.x + c * ax, lo.y + c * ay);
+    zc = T(hi.x - ds * c * by, hi.y + ds * c * bx);
+    hi = T(hi.x + ds * c * by, hi.y - ds * c * bx);
+}
+
+// Split-radix step for k = 0, where the twiddle is 1
+template <int dir, typename T>
+__device__ void Rad16B1SRStep0(T& lo, T& hi, T& z, T& zc)
+{
+    T a = z + zc;
+    T b = z - zc;
+    z   = lo - a;
+    lo  = lo + a;
+    zc  = hi - Rad16B1SRRotate<dir>(b);
+    hi  = hi + Rad16B1SRRotate<dir>(b);
+}
+
+// 16-point split-radix butterfly with conjugate-pair odd terms:
+//
+//   X[k] = E[k] + W^k Z[k] + W^-k Z'[k]
+//
+// where E is the 8-point DFT of x[2n] (itself split the same way),
+// and Z, Z' are the 4-point DFTs of x[4n+1] and x[4n-1].  This takes
+// 144 FMA-unit operations, against 148 for the radix-2 form in
+// FwdRad16B1.  Parameters are in bit-reversed order, so x[n] and X[n]
+// are in R<bitrev(n)>.
+template <int dir, typename T>
+__device__ void Rad16B1SR(T* R0,
+                          T* R8,
+                          T* R4,
+                          T* R12,
+                          T* R2,
+                          T* R10,
+                          T* R6,
+                          T* R14,
+                          T* R1,
+                          T* R9,
+                          T* R5,
+                          T* R13,
+                          T* R3,
+                          T* R11,
+                          T* R7,
+                          T* R15)
+{
+    T x0  = (*R0);
+    T x1  = (*R8);
+    T x2  = (*R4);
+    T x3  = (*R12);
+    T x4  = (*R2);
+    T x5  = (*R10);
+    T x6  = (*R6);
+    T x7  = (*R14);
+    T x8  = (*R1);
+    T x9  = (*R9);
+    T x10 = (*R5);
+    T x11 = (*R13);
+    T x12 = (*R3);
+    T x13 = (*R11);
+    T x14 = (*R7);
+    T x15 = (*R15);
+
+    // E from V = DFT4(x[0,4,8,12]) and the 2-point DFTs of x[2,10], x[14,6]
+    Rad16B1SRDFT4<dir>(x0, x4, x8, x12);
+    T y0  = x2 + x10;
+    T y1  = x2 - x10;
+    T yc0 = x14 + x6;
+    T yc1 = x14 - x6;
+    Rad16B1SRStep0<dir>(x0, x8, y0, yc0);
+    Rad16B1SRStep<dir>(x4, x12, y1, yc1, C8Q, 1.0);
+    // E[0..7] is now in x0, x4, x8, x12, y0, y1, yc0, yc1
+
+    Rad16B1SRDFT4<dir>(x1, x5, x9, x13);
+    Rad16B1SRDFT4<dir>(x15, x3, x7, x11);
+    Rad16B1SRStep0<dir>(x0, y0, x1, x15);
+    Rad16B1SRStep<dir>(x4, y1, x5, x3, C16A, C16T1);
+    Rad16B1SRStep<dir>(x8, yc0, x9, x7, C8Q, 1.0);
+    Rad16B1SRStep<dir>(x12, yc1, x13, x11, C16B, C16T3);
+
+    (*R0)  = x0;
+    (*R8)  = x4;
+    (*R4)  = x8;
+    (*R12) = x12;
+    (*R2)  = y0;
+    (*R10) = y1;
+    (*R6)  = yc0;
+    (*R14) = yc1;
+    (*R1)  = x1;
+    (*R9)  = x5;
+    (*R5)  = x9;
+    (*R13) = x13;
+    (*R3)  = x15;
+    (*R11) = x3;
+    (*R7)  = x7;
+    (*R15) = x11;
+}
+
+// double precision is compute-bound enough for the split-radix form
+// to pay off, single and half keep the radix-2 form above
+__device__ inline void FwdRad16B1(rocfft_complex<double>* R0,
+                                  rocfft_complex<double>* R8,
+                                  rocfft_complex<double>* R4,
+                                  rocfft_complex<double>* R12,
+                                  rocfft_complex<double>* R2,
+                                  rocfft_complex<double>* R10,
+                                  rocfft_complex<double>* R6,
+                                  rocfft_complex<double>* R14,
+                                  rocfft_complex<double>* R1,
+                                  rocfft_complex<double>* R9,
+                                  rocfft_complex<double>* R5,
+                                  rocfft_complex<double>* R13,
+                                  rocfft_complex<double>* R3,
+                                  rocfft_complex<double>* R11,
+                                  rocfft_complex<double>* R7,
+                                  rocfft_complex<double>* R15)
+{
+    Rad16B1SR<-1>(R0, R8, R4, R12, R2, R10, R6, R14, R1, R9, R5, R13, R3, R11, R7, R15);
+}
+
+__device__ inline void InvRad16B1(rocfft_complex<double>* R0,
+                                  rocfft_complex<double>* R8,
+                                  rocfft_complex<double>* R4,
+                                  rocfft_complex<double>* R12,
+                                  rocfft_complex<double>* R2,
+                                  rocfft_complex<double>* R10,
+                                  rocfft_complex<double>* R6,
+                                  rocfft_complex<double>* R14,
+                                  rocfft_complex<double>* R1,
+                                  rocfft_complex<double>* R9,
+                                  rocfft_complex<double>* R5,
+                                  rocfft_complex<double>* R13,
+                                  rocfft_complex<double>* R3,
+                                  rocfft_complex<double>* R11,
+                                  rocfft_complex<double>* R7,
+                                  rocfft_complex<double>* R15)
+{
+    Rad16B1SR<1>(R0, R8, R4, R12, R2, R10, R6, R14, R1, R9, R5, R13, R3, R11, R7, R15);
+}
+
+// FP64 matrix cores: CDNA2 and newer
+#if defined(__gfx90a__) || defined(__gfx940__) || defined(__gfx941__) || defined(__gfx942__) \
+    || defined(__gfx950__)
+#define ROCFFT_FP64_MFMA
+#endif
+
+// pick one of four values without indexing registers dynamically
+template <typename T>
+__device__ inline T Rad16B1MatrixSelect(unsigned int i, T a, T b, T c, T d)
+{
+    return i == 0 ? a : (i == 1 ? b : (i == 2 ? c : d));
+}
+
+// cos(m * pi / 8) for m in [0, 16), from the first quadrant by symmetry
+__device__ inline double Rad16B1MatrixCos(unsigned int m)
+{
+    const unsigned int j  = m & 3;
+    const unsigned int q  = m >> 2;
+    const double       c  = Rad16B1MatrixSelect(
+        j, 1.0, 0.923879532511286738, 0.707106781186547524, 0.382683432365089772);
+    const double       cr = Rad16B1MatrixSelect(
+        j, 0.0, 0.382683432365089772, 0.707106781186547524, 0.923879532511286738);
+    return q == 0 ? c : (q == 1 ? -cr : (q == 2 ? -c : cr));
+}
+
+#ifdef ROCFFT_FP64_MFMA
+// 16-point DFTs of a whole wavefront as a dense matrix product.
+// Each lane's 16 points are a column of a 16x64 matrix X, and
+// Y = F X is computed 16 columns at a time with 16x16x4 FP64 MFMA
+// steps.  In those, lane (g, c) = (lane / 16, lane % 16) supplies
+// row 4s+g of column c of X, and gets back rows 4g..4g+3 of column
+// c of Y, so X and Y are transposed between lanes with shuffles.
+// All 64 lanes of the wavefront must call this together.
+template <int dir>
+__device__ void Rad16B1Matrix(rocfft_complex<double>* const* R)
+{
+    typedef double     double4_t __attribute__((ext_vector_type(4)));
+    const unsigned int lane = __lane_id();
+    const unsigned int g    = lane / 16;
+    const unsigned int c    = lane % 16;
+
+    // bt[t][s] is point 4s+g of lane ((g+t)&3)*16+c
+    rocfft_complex<double> bt[4][4];
+#pragma unroll
+    for(unsigned int t = 0; t < 4; ++t)
+    {
+        const int src = ((g + t) & 3) * 16 + c;
+#pragma unroll
+        for(unsigned int s = 0; s < 4; ++s)
+        {
+            const auto v = Rad16B1MatrixSelect(
+                (g - t) & 3, *R[4 * s], *R[4 * s + 1], *R[4 * s + 2], *R[4 * s + 3]);
+            bt[t][s] = rocfft_complex<double>(__shfl(v.x, src), __shfl(v.y, src));
+        }
+    }
+
+    // this lane's column of F, for each of the 4 steps
+    double fr[4], fi[4];
+#pragma unroll
+    for(unsigned int s = 0; s < 4; ++s)
+    {
+        const unsigned int m = (c * (4 * s + g)) & 15;
+        fr[s]                = Rad16B1MatrixCos(m);
+        fi[s]                = dir * Rad16B1MatrixCos((m + 12) & 15);
+    }
+
+    // yr[G], yi[G] are rows 4g..4g+3 of column c of Y for lanes
+    // G*16..G*16+15
+    double4_t yr[4], yi[4];
+#pragma unroll
+    for(unsigned int G = 0; G < 4; ++G)
+    {
+        double4_t accr = {0.0, 0.0, 0.0, 0.0};
+        double4_t acci = {0.0, 0.0, 0.0, 0.0};
+#pragma unroll
+        for(unsigned int s = 0; s < 4; ++s)
+        {
+            const auto b = Rad16B1MatrixSelect((G - g) & 3, bt[0][s], bt[1][s], bt[2][s], bt[3][s]);
+            accr         = __builtin_amdgcn_mfma_f64_16x16x4f64(fr[s], b.x, accr, 0, 0, 0);
+            accr         = __builtin_amdgcn_mfma_f64_16x16x4f64(-fi[s], b.y, accr, 0, 0, 0);
+            acci         = __builtin_amdgcn_mfma_f64_16x16x4f64(fr[s], b.y, acci, 0, 0, 0);
+            acci         = __builtin_amdgcn_mfma_f64_16x16x4f64(fi[s], b.x, acci, 0, 0, 0);
+        }
+        yr[G] = accr;
+        yi[G] = acci;
+    }
+
+    // ot[t][r] is point 4*((g+t)&3)+r of this lane's output
+    rocfft_complex<double> ot[4][4];
+#pragma unroll
+    for(unsigned int t = 0; t < 4; ++t)
+    {
+        const int          src = ((g + t) & 3) * 16 + c;
+        const unsigned int G   = (g - t) & 3;
+#pragma unroll
+        for(unsigned int r = 0; r < 4; ++r)
+        {
+            const double vr = Rad16B1MatrixSelect(G, yr[0][r], yr[1][r], yr[2][r], yr[3][r]);
+            const double vi = Rad16B1MatrixSelect(G, yi[0][r], yi[1][r], yi[2][r], yi[3][r]);
+            ot[t][r]        = rocfft_complex<double>(__shfl(vr, src), __shfl(vi, src));
+        }
+    }
+#pragma unroll
+    for(unsigned int q = 0; q < 4; ++q)
+#pragma unroll
+        for(unsigned int r = 0; r < 4; ++r)
+            *R[4 * q + r]
+                = Rad16B1MatrixSelect((q - g) & 3, ot[0][r], ot[1][r], ot[2][r], ot[3][r]);
+}
+#endif
+
+// radix-16 butterflies the generator asks to run on matrix cores.
+// Only double precision has a matching matrix instruction, so other
+// precisions, and devices without FP64 matrix cores, use the
+// regular butterflies.
+template <typename T>
+__device__ void FwdRad16B1Matrix(T* R0,
+                                 T* R8,
+                                 T* R4,
+                                 T* R12,
+                                 T* R2,
+                                 T* R10,
+                                 T* R6,
+                                 T* R14,
+                                 T* R1,
+                                 T* R9,
+                                 T* R5,
+                                 T* R13,
+                                 T* R3,
+                                 T* R11,
+                                 T* R7,
+                                 T* R15)
+{
+    FwdRad16B1(R0, R8, R4, R12, R2, R10, R6, R14, R1, R9, R5, R13, R3, R11, R7, R15);
+}
+
+template <typename T>
+__device__ void InvRad16B1Matrix(T* R0,
+                                 T* R8,
+                                 T* R4,
+                                 T* R12,
+                                 T* R2,
+                                 T* R10,
+                                 T* R6,
+                                 T* R14,
+                                 T* R1,
+                                 T* R9,
+                                 T* R5,
+                                 T* R13,
+                                 T* R3,
+                                 T* R11,
+                                 T* R7,
+                                 T* R15)
+{
+    InvRad16B1(R0, R8, R4, R12, R2, R10, R6, R14, R1, R9, R5, R13, R3, R11, R7, R15);
+}
+
+#ifdef ROCFFT_FP64_MFMA
+__device__ inline void FwdRad16B1Matrix(rocfft_complex<double>* R0,
+                                        rocfft_complex<double>* R8,
+                                        rocfft_complex<double>* R4,
+                                        rocfft_complex<double>* R12,
+                                        rocfft_complex<double>* R2,
+                                        rocfft_complex<double>* R10,
+                                        rocfft_complex<double>* R6,
+                                        rocfft_complex<double>* R14,
+                                        rocfft_complex<double>* R1,
+                                        rocfft_complex<double>* R9,
+                                        rocfft_complex<double>* R5,
+                                        rocfft_complex<double>* R13,
+                                        rocfft_complex<double>* R3,
+                                        rocfft_complex<double>* R11,
+                                        rocfft_complex<double>* R7,
+                                        rocfft_complex<double>* R15)
+{
+    rocfft_complex<double>* const R[16]
+        = {R0, R8, R4, R12, R2, R10, R6, R14, R1, R9, R5, R13, R3, R11, R7, R15};
+    Rad16B1Matrix<-1>(R);
+}
+
+__device__ inline void InvRad16B1Matrix(rocfft_complex<double>* R0,
+                                        rocfft_complex<double>* R8,
+                                        rocfft_complex<double>* R4,
+                                        rocfft_complex<double>* R12,
+                                        rocfft_complex<double>* R2,
+                                        rocfft_complex<double>* R10,
+                                        rocfft_complex<double>* R6,
+                                        rocfft_complex<double>* R14,
+                                        rocfft_complex<double>* R1,
+                                        rocfft_complex<double>* R9,
+                                        rocfft_complex<double>* R5,
+                                        rocfft_complex<double>* R13,
+                                        rocfft_complex<double>* R3,
+                                        rocfft_complex<double>* R11,
+                                        rocfft_complex<double>* R7,
+                                        rocfft_complex<double>* R15)
+{
+    rocfft_complex<double>* const R[16]
+        = {R0, R8, R4, R12, R2, R10, R6, R14, R1, R9, R5, R13, R3, R11, R7, R15};
+    Rad16B1Matrix<1>(R);
+}
+#endif
+
 template <typename T>
 __device__ void
     FwdRad11B1(T* R0, T* R1, T* R2, T* R3, T* R4, T* R5, T* R6, T* R7, T* R8, T* R9, T* R10)
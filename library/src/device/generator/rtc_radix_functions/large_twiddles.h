@@ -7,32 +7,56 @@ __device__ T TW_NSteps(const T* const twiddles, size_t u)
 {
     size_t j      = u & ((1 << Base) - 1); // get the lowest Base bits
     T      result = twiddles[j];
-    u >>= Base; // discard the lowest Base bits
-    int i = 0;
-    // static compiled, currently, steps can only be 2 or 3
-    if(Steps >= 2)
-    {
-        i += 1;
-        j      = u & ((1 << Base) - 1);
-        result = T((result.x * twiddles[(1 << Base) * i + j].x
-                    - result.y * twiddles[(1 << Base) * i + j].y),
-                   (result.y * twiddles[(1 << Base) * i + j].x
-                    + result.x * twiddles[(1 << Base) * i + j].y));
-    }
-    // static compiled
-    if(Steps >= 3)
+    // Steps is static, so the loop is fully unrolled.  Each step
+    // consumes the next Base bits of u: 5 steps of base 8 cover
+    // lengths up to 2^40.
+    static_assert(Steps <= 5, "at most 5 large twiddle steps are supported");
+    for(size_t i = 1; i < Steps; ++i)
     {
         u >>= Base; // discard the lowest Base bits
-
-        i += 1;
         j      = u & ((1 << Base) - 1);
         result = T((result.x * twiddles[(1 << Base) * i + j].x
                     - result.y * twiddles[(1 << Base) * i + j].y),
                    (result.y * twiddles[(1 << Base) * i + j].x
                     + result.x * twiddles[(1 << Base) * i + j].y));
     }
-    static_assert(Steps < 4, "4-steps is not support");
-    // if(Steps >= 4){...}
 
     return result;
 }
+
+// Compute the large twiddle for index u of an N-point large 1D
+// transform directly, instead of reading a multi-step table.  u is
+// reduced exactly in integer arithmetic first, so sincospi's argument
+// stays in [-1, 1] however large N is, and double-precision evaluation
+// keeps the result as accurate as the table.
+template <typename T>
+__device__ T TW_Compute(size_t u, size_t N)
+{
+    long long n = N;
+    long long r = u % N;
+    if(2 * r > n)
+        r -= n;
+    double s, c;
+    sincospi(2.0 * r / n, &s, &c);
+    return T(c, s);
+}
+
+// Twiddle u of a length N = 8 * N8 transform, from a table of its
+// first N8 + 1 twiddles, i.e. the angles in the first octant of the
+// unit circle.  Every other octant mirrors the first, so its
+// twiddles are table entries with their parts swapped and negated.
+template <typename T>
+__device__ T TW_Octant(const T* const twiddles, unsigned int u, unsigned int N8)
+{
+    unsigned int octant = u / N8;
+    unsigned int r      = u % N8;
+    // odd octants run backwards from the end of the next one
+    T w = twiddles[(octant & 1) ? N8 - r : r];
+
+    bool swap  = (octant ^ (octant >> 1)) & 1;
+    bool neg_x = (octant ^ (octant >> 2)) & 1;
+    bool neg_y = (octant ^ (octant >> 1) ^ (octant >> 2)) & 1;
+    auto x     = swap ? w.y : w.x;
+    auto y     = swap ? w.x : w.y;
+    return T(neg_x ? -x : x, neg_y ? -y : y);
+}
@@ -45,3 +45,37 @@ __device__ void InvRad3B1(T* R0, T* R1, T* R2)
     ((*R2).x) = TR2;
     ((*R2).y) = TI2;
 }
+
+// Half-precision radix-3 written with complex arithmetic, which is
+// packed for rocfft_complex<_Float16>.  Equivalent to the templates above.
+__device__ inline void Rad3B1Half(rocfft_complex<_Float16>* R0,
+                                  rocfft_complex<_Float16>* R1,
+                                  rocfft_complex<_Float16>* R2,
+                                  _Float16                  sign)
+{
+    typedef rocfft_complex<_Float16> T;
+
+    T sum  = (*R1) + (*R2);
+    T diff = (*R1) - (*R2);
+    // multiply by -i for forward, +i for inverse
+    T rot = T(diff.y, -diff.x) * sign;
+    T mid = (*R0) - C3QA * sum;
+
+    (*R0) = (*R0) + sum;
+    (*R1) = mid + C3QB * rot;
+    (*R2) = mid - C3QB * rot;
+}
+
+__device__ inline void FwdRad3B1(rocfft_complex<_Float16>* R0,
+                                 rocfft_complex<_Float16>* R1,
+                                 rocfft_complex<_Float16>* R2)
+{
+    Rad3B1Half(R0, R1, R2, 1);
+}
+
+__device__ inline void InvRad3B1(rocfft_complex<_Float16>* R0,
+                                 rocfft_complex<_Float16>* R1,
+                                 rocfft_complex<_Float16>* R2)
+{
+    Rad3B1Half(R0, R1, R2, -1);
+}
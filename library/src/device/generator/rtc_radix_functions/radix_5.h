@@ -77,3 +77,48 @@ __device__ void InvRad5B1(T* R0, T* R1, T* R2, T* R3, T* R4)
     ((*R4).x) = TR4;
     ((*R4).y) = TI4;
 }
+
+// Half-precision radix-5 written with complex arithmetic, which is
+// packed for rocfft_complex<_Float16>.  Equivalent to the templates above.
+__device__ inline void Rad5B1Half(rocfft_complex<_Float16>* R0,
+                                  rocfft_complex<_Float16>* R1,
+                                  rocfft_complex<_Float16>* R2,
+                                  rocfft_complex<_Float16>* R3,
+                                  rocfft_complex<_Float16>* R4,
+                                  _Float16                  sign)
+{
+    typedef rocfft_complex<_Float16> T;
+
+    // multiply by -i for forward, +i for inverse
+    T d14 = (*R1) - (*R4);
+    T d23 = (*R2) - (*R3);
+    T r14 = T(d14.y, -d14.x) * sign;
+    T r23 = T(d23.y, -d23.x) * sign;
+
+    T mid14 = ((*R0) - C5QC * ((*R2) + (*R3))) + C5QA * (((*R1) - (*R2)) + ((*R4) - (*R3)));
+    T mid23 = ((*R0) - C5QC * ((*R1) + (*R4))) + C5QA * (((*R2) - (*R1)) + ((*R3) - (*R4)));
+
+    (*R0) = (*R0) + (*R1) + (*R2) + (*R3) + (*R4);
+    (*R1) = mid14 + C5QB * r14 + C5QD * r23;
+    (*R4) = mid14 - C5QB * r14 - C5QD * r23;
+    (*R2) = mid23 - C5QB * r23 + C5QD * r14;
+    (*R3) = mid23 + C5QB * r23 - C5QD * r14;
+}
+
+__device__ inline void FwdRad5B1(rocfft_complex<_Float16>* R0,
+                                 rocfft_complex<_Float16>* R1,
+                                 rocfft_complex<_Float16>* R2,
+                                 rocfft_complex<_Float16>* R3,
+                                 rocfft_complex<_Float16>* R4)
+{
+    Rad5B1Half(R0, R1, R2, R3, R4, 1);
+}
+
+__device__ inline void InvRad5B1(rocfft_complex<_Float16>* R0,
+                                 rocfft_complex<_Float16>* R1,
+                                 rocfft_complex<_Float16>* R2,
+                                 rocfft_complex<_Float16>* R3,
+                                 rocfft_complex<_Float16>* R4)
+{
+    Rad5B1Half(R0, R1, R2, R3, R4, -1);
+}
@@ -285,12 +285,13 @@ std::string stockham_variants(const std::string&      filename,
     output += append_headers();
     if(specs.scheme == "CS_KERNEL_STOCKHAM")
     {
+        specs.lds_bank_shift = StockhamGeneratorSpecs::resolve_lds_bank_shift(-1, specs.length);
         StockhamKernelRR kernel(specs);
         output += append_common_functions(kernel.generate_lds_to_reg_input_function(),
                                           kernel.generate_lds_from_reg_output_function(),
                                           {},
                                           {});
-        output += make_variants(kernel.generate_device_function_with_bank_shift(),
+        output += make_variants(kernel.generate_device_function(),
                                 {},
                                 kernel.generate_global_function(),
                                 true);
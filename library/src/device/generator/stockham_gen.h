@@ -22,7 +22,9 @@
 
 #pragma once
 #include "../../../../shared/arithmetic.h"
+#include "../kernels/bank_shift.h"
 #include "rocfft/rocfft.h"
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -48,6 +50,10 @@ struct StockhamGeneratorSpecs
     std::vector<unsigned int> precisions; // mapped from rocfft_precision
     unsigned int              length;
     unsigned int              length2d = 0;
+    // third dimension of 3D_SINGLE kernels, which are otherwise
+    // described like 2D_SINGLE
+    std::vector<unsigned int> factors3d;
+    unsigned int              threads_per_transform3d = 0;
 
     unsigned int workgroup_size;
     unsigned int threads_per_transform = 0;
@@ -58,6 +64,86 @@ struct StockhamGeneratorSpecs
     // statically defined for the kernel
     unsigned int static_dim = 0;
     std::string  scheme;
+    // wavefront size of the device the kernel is generated for, or
+    // 0 if the kernel must run on any wavefront size (e.g. kernels
+    // built ahead of time for several archs at once)
+    unsigned int wave_size = 0;
+    // number of complex elements moved by each 128-bit global load
+    // or store, or 0 to always access global memory one element at
+    // a time.  Only used by 1D kernels with one thread per
+    // transform, whose elements are contiguous in each thread.
+    unsigned int vector_width = 0;
+    // lengths and strides the kernel is specialized for, or empty
+    // if they are kernel arguments.  Strides end with the batch
+    // distance, and stride_out is only used out-of-place.  Baking
+    // them into the kernel lets its index math fold away.
+    std::vector<size_t> static_lengths;
+    std::vector<size_t> static_stride_in;
+    std::vector<size_t> static_stride_out;
+    // true if every offset into the kernel's buffers fits in 32
+    // bits, so that its index math can be done in 32-bit integers
+    bool index32 = false;
+    // true if radix-16 butterflies are evaluated as dense matrix
+    // products on matrix cores.  Every lane of a wavefront must
+    // call them together, so the workgroup size must be a multiple
+    // of the 64-lane wavefront.
+    bool matrix_butterflies = false;
+    // true if a 1D single-kernel (SBRR) kernel's blocks each work
+    // through PIPELINE_TILES tiles of transforms in turn, issuing the
+    // next tile's global loads into registers before computing the
+    // current one
+    bool pipelined_loads = false;
+    // true if the kernel's output isn't read again by the plan, so
+    // global stores can bypass the caches
+    bool nontemporal_stores = false;
+    // 1D single-kernel (SBRR) kernels can pad their LDS with one
+    // element after every lds_bank_shift elements, so that strided
+    // accesses between passes fall in different banks.  0 means no
+    // padding.
+    unsigned int lds_bank_shift = 0;
+    // true if a 1D single-kernel (SBRR) kernel reads its twiddles
+    // from a table of the first length/8 + 1 twiddles of its length,
+    // and reconstructs the rest of the unit circle by symmetry
+    bool octant_twiddles = false;
+    // direction of an odd-length real transform done by a 1D kernel
+    // as a complex transform of the same length, or 0 for a complex
+    // transform.  Forward (-1) kernels read real input and store
+    // only the length/2+1 non-redundant outputs; backward (1)
+    // kernels read only those Hermitian inputs and store the real
+    // part of the output.
+    int odd_real_direction = 0;
+    // DCT/DST type of a 1D kernel that does a real-to-real transform
+    // through a complex FFT of 'length': the extension and twiddling
+    // of the real input and output happen in its LDS loads and
+    // stores.  Complex transform types mean a plain FFT.
+    rocfft_transform_type r2r_type = rocfft_transform_type_complex_forward;
+    // real input and output length of a real-to-real transform
+    unsigned int r2r_length = 0;
+
+    bool is_real_to_real() const
+    {
+        return r2r_type != rocfft_transform_type_complex_forward
+               && r2r_type != rocfft_transform_type_complex_inverse
+               && r2r_type != rocfft_transform_type_real_forward
+               && r2r_type != rocfft_transform_type_real_inverse;
+    }
+
+    // LDS bank shift of a 1D kernel, given the shift in its kernel
+    // config, which is negative to use the default.  By default
+    // only length-64 kernels pad their LDS.
+    static unsigned int resolve_lds_bank_shift(int config_shift, unsigned int length)
+    {
+        if(config_shift >= 0)
+            return config_shift;
+        return length == 64 ? LDS_BANK_SHIFT : 0;
+    }
+
+    // octant twiddle tables need the length to split the circle
+    // into octants of whole twiddles
+    static bool can_use_octant_twiddles(unsigned int length)
+    {
+        return length % 8 == 0;
+    }
 
     // this value indicating if the wgs, tpt are excatly what we want
     // (i.e. were already derived somewhere)
@@ -65,6 +151,33 @@ struct StockhamGeneratorSpecs
     // Particularly useful when tuning or running a tuned kernel. (RTC-ing)
     // We don't want them to be overwritten by StockhamKernel.
     bool wgs_is_derived = false;
+
+    // 1D kernels this short that use one thread per transform keep
+    // the whole transform in that thread's registers, so they need
+    // no LDS and no barriers between passes
+    static const unsigned int REGISTERS_ONLY_MAX_LENGTH = 64;
+    static bool               is_registers_only(unsigned int length,
+                                                unsigned int threads_per_transform,
+                                                bool         direct_to_from_reg)
+    {
+        return threads_per_transform == 1 && length <= REGISTERS_ONLY_MAX_LENGTH
+               && direct_to_from_reg;
+    }
+
+    // matrix butterflies are double-precision radix-16 butterflies
+    // done by whole 64-lane wavefronts
+    template <typename Tfactor>
+    static bool can_use_matrix_butterflies(rocfft_precision            precision,
+                                           unsigned int                workgroup_size,
+                                           const std::vector<Tfactor>& factors)
+    {
+        return precision == rocfft_precision_double && workgroup_size % 64 == 0
+               && std::find(factors.begin(), factors.end(), 16) != factors.end();
+    }
+
+    // number of tiles of transforms_per_block transforms that each
+    // block of a pipelined kernel does
+    static constexpr unsigned int PIPELINE_TILES = 2;
 };
 
 // generate default stockham variants for ahead-of-time compilation
@@ -0,0 +1,346 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// 3D_SINGLE: keeps an entire small 3D volume in LDS and does all
+// three dimensions' FFTs in one kernel.  Like 2D_SINGLE, this
+// inherits RR for convenient access to variables to generate the
+// global function with, but contains one RR kernel per dimension for
+// the device functions since they have distinct specs.
+//
+// Only plain C2C is supported - there is no embedded real pre/post
+// processing.
+struct StockhamKernelFused3D : public StockhamKernelRR
+{
+    // maximum number of threads in a block
+    static constexpr unsigned int MAX_WORKGROUP_SIZE = 1024;
+
+    StockhamKernelFused3D(const StockhamGeneratorSpecs& specs0,
+                          const StockhamGeneratorSpecs& specs1,
+                          const StockhamGeneratorSpecs& specs2)
+        : StockhamKernelRR(specs0)
+        , kernel0(specs0)
+        , kernel1(specs1)
+        , kernel2(specs2)
+    {
+        workgroup_size = 0;
+        for(auto k : dim_kernels())
+            workgroup_size = std::max(workgroup_size, k->threads_per_transform * rows(*k));
+        // each dimension loops over its rows if there are more than
+        // the block can do at once
+        workgroup_size = std::min(workgroup_size, MAX_WORKGROUP_SIZE);
+        for(auto k : dim_kernels())
+        {
+            if(workgroup_size % k->threads_per_transform != 0)
+                throw std::runtime_error("3D_SINGLE workgroup size must be a multiple of "
+                                         "each dimension's threads per transform");
+        }
+
+        // 3D_SINGLE does one 3D volume per workgroup(threadblock)
+        threads_per_transform = workgroup_size;
+        transforms_per_block  = 1;
+        R.size = std::max(std::max(kernel0.nregisters, kernel1.nregisters), kernel2.nregisters);
+        kernel0.writeGuard = true;
+        kernel1.writeGuard = true;
+        kernel2.writeGuard = true;
+        // 3D kernels use the per-dimension device functions,
+        // so this writeGuard value is not used and irrelevant
+        writeGuard = true;
+    }
+
+    StockhamKernelRR kernel0;
+    StockhamKernelRR kernel1;
+    StockhamKernelRR kernel2;
+
+    std::vector<StockhamKernelRR*> dim_kernels()
+    {
+        return {&kernel0, &kernel1, &kernel2};
+    }
+
+    // number of 1D transforms needed along the kernel's dimension
+    unsigned int rows(const StockhamKernelRR& k) const
+    {
+        return kernel0.length * kernel1.length * kernel2.length / k.length;
+    }
+
+    // offset of a dimension's table in the twiddle buffer.  Each
+    // dimension's table is appended after the previous ones, unless
+    // an earlier dimension has identical factors, in which case that
+    // table is reused.
+    unsigned int twiddle_offset(unsigned int d)
+    {
+        auto         kernels = dim_kernels();
+        unsigned int offset  = 0;
+        for(unsigned int i = 0; i < d; ++i)
+        {
+            if(kernels[i]->factors == kernels[d]->factors)
+                return twiddle_offset(i);
+            bool is_new_table = true;
+            for(unsigned int j = 0; j < i; ++j)
+            {
+                if(kernels[j]->factors == kernels[i]->factors)
+                    is_new_table = false;
+            }
+            if(is_new_table)
+                offset += kernels[i]->length - kernels[i]->factors.front();
+        }
+        return offset;
+    }
+
+    std::vector<unsigned int> launcher_lengths() override
+    {
+        return {kernel0.length, kernel1.length, kernel2.length};
+    }
+    std::vector<unsigned int> launcher_factors() override
+    {
+        std::vector<unsigned int> ret;
+        for(auto k : dim_kernels())
+            std::copy(k->factors.begin(), k->factors.end(), std::back_inserter(ret));
+        return ret;
+    }
+
+    std::vector<Expression> device_lds_reg_inout_device_call_arguments() override
+    {
+        return {R, lds_complex, stride_lds, offset_lds, thread_in_device, write};
+    }
+
+    std::vector<Expression> device_call_arguments(unsigned int call_iter) override
+    {
+        return {R,
+                lds_real,
+                lds_complex,
+                twiddles,
+                stride_lds,
+                call_iter ? Expression{offset_lds + call_iter * stride_lds * transforms_per_block}
+                          : Expression{offset_lds},
+                thread_in_device,
+                write};
+    }
+
+    Variable pitch{"pitch", "const unsigned int"};
+    Variable pitch_z{"pitch_z", "const unsigned int"};
+    Variable row{"row", "unsigned int"};
+
+    // load or store the whole volume, using all threads
+    StatementList load_store_volume(bool load)
+    {
+        auto length0    = kernel0.length;
+        auto length1    = kernel1.length;
+        auto length2    = kernel2.length;
+        auto num_elems  = length0 * length1 * length2;
+        auto rw_iters   = DivRoundingUp(num_elems, workgroup_size);
+        auto need_guard = num_elems % workgroup_size != 0;
+
+        StatementList stmts;
+        stmts += CommentLines{std::string{load ? "load" : "store"} + " the "
+                                  + std::to_string(length0) + "x" + std::to_string(length1) + "x"
+                                  + std::to_string(length2) + " volume using all threads.",
+                              "need " + std::to_string(rw_iters) + " iterations"};
+        for(unsigned int i = 0; i < rw_iters; ++i)
+        {
+            auto elem   = Parens{i * workgroup_size + thread_id};
+            auto x      = Parens{elem % length0};
+            auto y      = Parens{Parens{elem / length0} % length1};
+            auto z      = Parens{elem / (length0 * length1)};
+            auto lds_at = lds_complex[z * pitch_z + y * pitch + x];
+            auto glb_at = offset + x * stride[0] + y * stride[1] + z * stride[2];
+
+            StatementList rw;
+            if(load)
+                rw += Assign{lds_at, LoadGlobal{buf, glb_at}};
+            else
+                rw += StoreGlobal{buf, glb_at, lds_at};
+
+            if(need_guard)
+                stmts += If{Less{elem, num_elems}, rw};
+            else
+                stmts += rw;
+        }
+        return stmts;
+    }
+
+    StatementList load_from_global(bool load_registers) override
+    {
+        return load_store_volume(true);
+    }
+
+    StatementList store_to_global(bool store_registers) override
+    {
+        return load_store_volume(false);
+    }
+
+    // transform each row along dimension d of the volume in LDS
+    StatementList dim_work(unsigned int d)
+    {
+        auto& k       = *dim_kernels()[d];
+        auto  length0 = kernel0.length;
+        auto  nrows   = rows(k);
+        auto  tpt     = k.threads_per_transform;
+        auto  iters   = DivRoundingUp(tpt * nrows, workgroup_size);
+
+        StatementList stmts;
+        stmts += CommentLines{"", "length: " + std::to_string(k.length), ""};
+        stmts += CommentLines{"this dim: length-" + std::to_string(k.length),
+                              "  uses " + std::to_string(tpt) + " threads per transform",
+                              "  does " + std::to_string(nrows) + " transforms in "
+                                  + std::to_string(iters) + " iterations"};
+
+        // elements of a row along x are contiguous, along y/z they're
+        // strided by the pitch of that dimension
+        stmts += Assign{stride_lds, d == 0 ? pitch : (d == 1 ? pitch : pitch_z)};
+
+        auto lds_tmpl = device_lds_reg_inout_device_call_templates();
+        auto lds_args = device_lds_reg_inout_device_call_arguments();
+        lds_tmpl.set_value(stride_type.name, d == 0 ? "SB_UNIT" : "SB_NONUNIT");
+
+        auto templates = device_call_templates();
+        templates.set_value(stride_type.name, d == 0 ? "SB_UNIT" : "SB_NONUNIT");
+        auto arguments = device_call_arguments(0);
+        auto twd_off   = twiddle_offset(d);
+        if(twd_off)
+            arguments[3] = twiddles + twd_off;
+
+        for(unsigned int i = 0; i < iters; ++i)
+        {
+            stmts += LineBreak{};
+            stmts += Assign{row, (i * workgroup_size + thread_id) / tpt};
+            if((i + 1) * workgroup_size <= tpt * nrows)
+                stmts += Assign{write, 1};
+            else
+                stmts += Assign{write, row < nrows};
+
+            // starting lds-ptr of each row
+            Expression row_offset = row * pitch;
+            if(d == 1)
+                row_offset = Parens{row / length0} * pitch_z + Parens{row % length0};
+            else if(d == 2)
+                row_offset = Parens{row / length0} * pitch + Parens{row % length0};
+            stmts += Assign{offset_lds, Ternary{write, Expression{row_offset}, 0}};
+            stmts += Assign{thread_in_device, thread_id % tpt};
+
+            stmts += Call{"lds_to_reg_input_length" + std::to_string(k.length) + "_device",
+                          lds_tmpl,
+                          lds_args};
+            stmts += Call{"forward_length" + std::to_string(k.length) + "_SBRR_device",
+                          templates,
+                          arguments};
+            stmts += Call{"lds_from_reg_output_length" + std::to_string(k.length) + "_device",
+                          lds_tmpl,
+                          lds_args};
+        }
+        return stmts;
+    }
+
+    Function generate_global_function() override
+    {
+        auto is_pow2 = [](unsigned int n) { return n != 0 && (n & (n - 1)) == 0; };
+
+        auto length0 = kernel0.length;
+        auto length1 = kernel1.length;
+        auto length2 = kernel2.length;
+
+        // for pow2, add padding to avoid bank conflict
+        auto length0_padded = is_pow2(length0) ? (length0 + 1) : length0;
+
+        Function f{"forward_length" + std::to_string(length0) + "x" + std::to_string(length1) + "x"
+                   + std::to_string(length2)};
+
+        StatementList& body = f.body;
+        body += LineBreak{};
+        body += CommentLines{"",
+                             "this kernel:",
+                             "  uses " + std::to_string(workgroup_size)
+                                 + " threads per 3d transform",
+                             "  does 1 3d transform per thread block",
+                             "therefore it should be called with " + std::to_string(workgroup_size)
+                                 + " threads per block",
+                             ""};
+
+        Variable d{"d", "int"};
+        Variable index_along_d{"index_along_d", "size_t"};
+        Variable remaining{"remaining", "size_t"};
+        Variable plength{"plength", "size_t"};
+        Variable batch0{"batch0", "size_t"};
+
+        body += LDSDeclaration{scalar_type.name};
+        body += Declaration{R};
+        body += Declaration{transform};
+        body += Declaration{offset, 0};
+        body += Declaration{offset_lds};
+        body += Declaration{stride_lds};
+        body += Declaration{write};
+        body += Declaration{row};
+        body += Declaration{thread_in_device};
+        body += Declaration{batch0};
+        body += Declaration{remaining};
+        body += Declaration{plength, 1};
+        body += Declaration{index_along_d};
+        body += Declaration{lds_is_real, "false"};
+        body += Declaration{lds_linear, "true"};
+        body += Declaration{direct_load_to_reg, "false"};
+        body += Declaration{direct_store_from_reg, "false"};
+        body += CallbackLoadDeclaration{scalar_type.name, callback_type.name};
+        body += CallbackStoreDeclaration{scalar_type.name, callback_type.name};
+        body += Declaration{pitch, length0_padded};
+        body += Declaration{pitch_z, length0_padded * length1};
+
+        body += LineBreak{};
+        body += CommentLines{"transform is: 3D volume number (1 per block)"};
+        body += Assign{transform, block_id};
+        body += Assign{remaining, transform};
+        body += CommentLines{"compute 3D volume offset (start from length/stride index 3)"};
+
+        if(static_dim)
+        {
+            body += Declaration{dim, static_dim};
+        }
+        body += For{d,
+                    3,
+                    d < dim,
+                    1,
+                    {Assign{plength, plength * lengths[d]},
+                     Assign{index_along_d, remaining % lengths[d]},
+                     Assign{remaining, remaining / lengths[d]},
+                     Assign{offset, offset + index_along_d * stride[d]}}};
+        body += Assign{batch0, transform / plength};
+        body += CommentLines{"offset is the starting global-mem-ptr of the entire 3D volume"};
+        body += Assign{offset, offset + batch0 * stride[dim]};
+
+        // load
+        body += LineBreak{};
+        body += load_from_global(false);
+
+        // note there is a syncthreads at the start of each device call
+        for(unsigned int dim_idx = 0; dim_idx < 3; ++dim_idx)
+        {
+            body += LineBreak{};
+            body += dim_work(dim_idx);
+        }
+
+        // store
+        body += SyncThreads{};
+        body += store_to_global(false);
+
+        f.qualifier     = "__global__";
+        f.templates     = global_templates();
+        f.arguments     = global_arguments();
+        f.launch_bounds = workgroup_size;
+        return f;
+    }
+};
@@ -80,7 +80,10 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         }
 
         nregisters = compute_nregisters(length, factors, threads_per_transform);
-        R.size     = Expression{nregisters};
+        R.size      = Expression{nregisters};
+        Rp.size     = Expression{nregisters};
+        R_next.size = Expression{nregisters};
+        R_tile.size = Expression{DivRoundingUp(length * transforms_per_block, workgroup_size)};
     }
     virtual ~StockhamKernel(){};
 
@@ -223,6 +226,19 @@ struct StockhamKernel : public StockhamGeneratorSpecs
     // butterfly registers
     Variable R{"R", "scalar_type", false, false};
 
+    // scratch registers for permuting R between passes
+    Variable Rp{"Rp", "scalar_type", false, false};
+
+    // pipelined kernels: registers the next tile is loaded into, and
+    // the tile and block of work being done
+    Variable R_next{"R_next", "scalar_type", false, false};
+
+    // half-lds tilings: each thread's part of a tile that is staged
+    // through LDS one component at a time
+    Variable R_tile{"R_tile", "scalar_type", false, false};
+    Variable pipeline_tile{"pipeline_tile", "unsigned int"};
+    Variable pipeline_block{"pipeline_block", "const unsigned int"};
+
     virtual std::vector<unsigned int> launcher_lengths()
     {
         return {length};
@@ -283,6 +299,37 @@ struct StockhamKernel : public StockhamGeneratorSpecs
     // virtual functions implemented by different tiling implementations
     virtual std::string tiling_name() = 0;
 
+    // true if the whole transform stays in registers, see
+    // generate_device_function_registers_only
+    virtual bool registers_only()
+    {
+        return false;
+    }
+
+    // true if each block works through PIPELINE_TILES tiles of
+    // transforms, see generate_global_function
+    virtual bool pipelines_loads()
+    {
+        return false;
+    }
+
+    // Barrier between LDS writes and reads of the transform(s) done
+    // by the device function.  Tilings where all threads of a
+    // transform are in one wavefront and LDS is never shared between
+    // transforms can override this with a cheaper wavefront barrier.
+    virtual StatementList lds_barrier()
+    {
+        return {SyncThreads()};
+    }
+
+    // true if the threads of each transform are consecutive lanes of
+    // a single wavefront on the target device
+    bool transform_fits_in_wave() const
+    {
+        return wave_size > 0 && threads_per_transform > 0 && threads_per_transform <= wave_size
+               && wave_size % threads_per_transform == 0;
+    }
+
     // TODO- support embedded Pre/Post
     virtual StatementList set_direct_to_from_registers()
     {
@@ -307,6 +354,21 @@ struct StockhamKernel : public StockhamGeneratorSpecs
             return {Declaration{lds_is_real, Literal{"false"}}};
     }
 
+    // Conditions for having the lds_to_reg_input and
+    // lds_from_reg_output device functions move registers to and
+    // from complex LDS, with direct_to_from_reg enabled.  Tilings
+    // that stage their transposed side through real-only LDS do that
+    // in load_from_global/store_to_global instead.
+    virtual Expression lds_to_reg_input_needed()
+    {
+        return !direct_load_to_reg;
+    }
+
+    virtual Expression lds_from_reg_output_needed()
+    {
+        return !direct_store_from_reg;
+    }
+
     virtual StatementList large_twiddles_load()
     {
         return {CommentLines{"- no large twiddles"}};
@@ -363,7 +425,7 @@ struct StockhamKernel : public StockhamGeneratorSpecs
             work += Assign(l_offset, idx);
 
             if(bank_shift)
-                work += Assign(l_offset, l_offset + l_offset / LDS_BANK_SHIFT);
+                work += Assign(l_offset, l_offset + l_offset / lds_bank_shift);
 
             switch(component)
             {
@@ -405,7 +467,7 @@ struct StockhamKernel : public StockhamGeneratorSpecs
             work += Assign(l_offset, idx);
 
             if(bank_shift)
-                work += Assign(l_offset, l_offset + l_offset / LDS_BANK_SHIFT);
+                work += Assign(l_offset, l_offset + l_offset / lds_bank_shift);
 
             switch(component)
             {
@@ -448,7 +510,19 @@ struct StockhamKernel : public StockhamGeneratorSpecs
             auto ridx = hr * width + w;
 
             // TODO- Can try IntrinsicLoadToDest, but should not be a bottleneck
-            work += Assign(W, twiddles[tidx]);
+            if(octant_twiddles)
+            {
+                // the stacked table's entry is the (cumheight *
+                // width)-th root of unity to the power tid * w, which
+                // is a power of the length's root
+                auto power = Parens{tid % cumheight} * (w * (length / (cumheight * width)));
+                work += Assign(W,
+                               CallExpr{"TW_Octant",
+                                        TemplateList{scalar_type},
+                                        {twiddles, power, length / 8}});
+            }
+            else
+                work += Assign(W, twiddles[tidx]);
             work += Assign(t, TwiddleMultiply(R[ridx], W));
             work += Assign(R[ridx], t);
         }
@@ -463,7 +537,16 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         std::vector<Expression> args;
         for(unsigned int w = 0; w < width; ++w)
             args.push_back(R + (hr * width + w));
-        return {Butterfly{true, args}};
+        // matrix butterflies are only implemented for radix 16
+        return {Butterfly{true, args, matrix_butterflies && width == 16}};
+    }
+
+    // load element idx of the current transform, passing idx along
+    // for load ops that depend on an element's position in its
+    // transform rather than its offset in the buffer
+    Expression load_transform_elem(const Expression& idx) const
+    {
+        return LoadGlobal{{buf, offset + Parens{idx} * stride0, idx}};
     }
 
     StatementList load_global_generator(unsigned int h,
@@ -479,8 +562,7 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         {
             auto tid = Parens{thread + dt + h * threads_per_transform};
             auto idx = Parens{tid + w * length / width};
-            load += Assign{R[hr * width + w],
-                           LoadGlobal{buf, offset + Parens{Expression{idx}} * stride0}};
+            load += Assign{R[hr * width + w], load_transform_elem(idx)};
         }
         return load;
     }
@@ -600,7 +682,7 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         // first pass of load (full)
         unsigned int width  = factors[0];
         float        height = static_cast<float>(length) / width / threads_per_transform;
-        body += SyncThreads();
+        body += lds_barrier();
         body += add_work(std::bind(load_lds, this, _1, _2, _3, _4, _5, Component::BOTH, false),
                          width,
                          height,
@@ -630,7 +712,7 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         unsigned int width     = factors.back();
         float        height    = static_cast<float>(length) / width / threads_per_transform;
         unsigned int cumheight = product(factors.begin(), factors.end() - 1);
-        body += SyncThreads();
+        body += lds_barrier();
         body += add_work(
             std::bind(store_lds, this, _1, _2, _3, _4, _5, Component::BOTH, cumheight, false),
             width,
@@ -639,8 +721,153 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         return f;
     }
 
+    // Move one component of the registers from real-only LDS, in the
+    // layout of the first pass' loads.  Tilings that stage their
+    // transposed side through half LDS call this from the global
+    // function, where LDS is accessed non-linearly and the device
+    // function's thread index isn't declared yet.
+    StatementList lds_real_to_reg_input(Component component)
+    {
+        auto load_lds = std::mem_fn(&StockhamKernel::load_lds_generator);
+
+        unsigned int width  = factors[0];
+        float        height = static_cast<float>(length) / width / threads_per_transform;
+        return half_lds_global_scope(
+            add_work(std::bind(load_lds, this, _1, _2, _3, _4, _5, component, false),
+                     width,
+                     height,
+                     ThreadGuardMode::NO_GUARD));
+    }
+
+    // Move one component of the registers to real-only LDS, in the
+    // layout of the last pass' stores.  See lds_real_to_reg_input.
+    StatementList lds_real_from_reg_output(Component component)
+    {
+        auto store_lds = std::mem_fn(&StockhamKernel::store_lds_generator);
+
+        unsigned int width     = factors.back();
+        float        height    = static_cast<float>(length) / width / threads_per_transform;
+        unsigned int cumheight = product(factors.begin(), factors.end() - 1);
+        return half_lds_global_scope(
+            add_work(std::bind(store_lds, this, _1, _2, _3, _4, _5, component, cumheight, false),
+                     width,
+                     height,
+                     ThreadGuardMode::GUARD_BY_IF));
+    }
+
+    StatementList half_lds_global_scope(const StatementList& stmts)
+    {
+        ReplaceVariablesVisitor global_scope{
+            {{thread.name, Parens{thread_id / transforms_per_block}}, {lstride.name, stride_lds}}};
+        return global_scope(stmts);
+    }
+
+    // Exchange data between two passes when one thread does the
+    // whole transform.  The positions each register is stored to and
+    // loaded from are known at generation time, so the exchange is a
+    // fixed permutation of the registers that the compiler can turn
+    // into renames.
+    StatementList permute_registers_generator(unsigned int npass)
+    {
+        unsigned int width     = factors[npass];
+        unsigned int cumheight = product(factors.begin(), factors.begin() + npass);
+
+        // register holding each position after this pass, using the
+        // same indexing as store_lds_generator
+        std::vector<unsigned int> reg_at(length);
+        for(unsigned int h = 0; h < length / width; ++h)
+            for(unsigned int w = 0; w < width; ++w)
+                reg_at[(h / cumheight) * (width * cumheight) + h % cumheight + w * cumheight]
+                    = h * width + w;
+
+        // registers that the next pass wants each position in, using
+        // the same indexing as load_lds_generator
+        unsigned int  next_width = factors[npass + 1];
+        StatementList copy;
+        StatementList move;
+        for(unsigned int h = 0; h < length / next_width; ++h)
+        {
+            for(unsigned int w = 0; w < next_width; ++w)
+            {
+                unsigned int dst = h * next_width + w;
+                unsigned int src = reg_at[h + w * length / next_width];
+                if(dst == src)
+                    continue;
+                copy += Assign{Rp[dst], R[src]};
+                move += Assign{R[dst], Rp[dst]};
+            }
+        }
+
+        StatementList stmts;
+        stmts += copy;
+        stmts += move;
+        return stmts;
+    }
+
+    // Device function for kernels where each thread does a whole
+    // transform.  Passes are joined by register permutations instead
+    // of LDS round trips, so there's no LDS traffic or __syncthreads.
+    Function generate_device_function_registers_only()
+    {
+        std::string function_name
+            = "forward_length" + std::to_string(length) + "_" + tiling_name() + "_device";
+
+        Function f{function_name};
+        f.arguments = device_arguments();
+        f.templates = device_templates();
+        f.qualifier = "__device__";
+        if(length == 1)
+        {
+            return f;
+        }
+
+        StatementList& body = f.body;
+        body += Declaration{W};
+        body += Declaration{t};
+        if(factors.size() > 1)
+            body += Declaration{Rp};
+
+        for(unsigned int npass = 0; npass < factors.size(); ++npass)
+        {
+            unsigned int width     = factors[npass];
+            float        height    = static_cast<float>(length) / width;
+            unsigned int cumheight = product(factors.begin(), factors.begin() + npass);
+
+            body += LineBreak{};
+            body += CommentLines{"pass " + std::to_string(npass) + ", width "
+                                     + std::to_string(width),
+                                 "one thread does all " + std::to_string(length / width)
+                                     + " radix-" + std::to_string(width) + " butterflies"};
+
+            if(npass > 0)
+            {
+                auto apply_twiddle = std::mem_fn(&StockhamKernel::apply_twiddle_generator);
+                body += add_work(
+                    std::bind(apply_twiddle, this, _1, _2, _3, _4, _5, cumheight, factors.front()),
+                    width,
+                    height,
+                    ThreadGuardMode::NO_GUARD);
+            }
+
+            auto butterfly = std::mem_fn(&StockhamKernel::butterfly_generator);
+            body += add_work(std::bind(butterfly, this, _1, _2, _3, _4, _5),
+                             width,
+                             height,
+                             ThreadGuardMode::NO_GUARD);
+
+            if(npass == factors.size() - 1)
+                body += large_twiddles_multiply(width, height, cumheight);
+            else
+                body += permute_registers_generator(npass);
+        }
+        return f;
+    }
+
     Function generate_device_function()
     {
+        if(registers_only())
+            return generate_device_function_registers_only();
+
         std::string function_name
             = "forward_length" + std::to_string(length) + "_" + tiling_name() + "_device";
 
@@ -660,6 +887,11 @@ struct StockhamKernel : public StockhamGeneratorSpecs
             lstride, Ternary{Parens{stride_type == "SB_UNIT"}, Parens{1}, Parens{stride_lds}}};
         body += Declaration{l_offset};
 
+        // LDS is only padded between passes.  Data going to and from
+        // global memory uses the unpadded layout, with barriers
+        // between it and the padded accesses.
+        const bool bank_shift = lds_bank_shift != 0;
+
         for(unsigned int npass = 0; npass < factors.size(); ++npass)
         {
             // width is the butterfly width, Radix-n.
@@ -687,9 +919,9 @@ struct StockhamKernel : public StockhamGeneratorSpecs
             {
                 // internal full lds2reg (both linear/nonlinear variants)
                 StatementList lds2reg_full;
-                lds2reg_full += SyncThreads();
+                lds2reg_full += lds_barrier();
                 lds2reg_full += add_work(
-                    std::bind(load_lds, this, _1, _2, _3, _4, _5, Component::BOTH, false),
+                    std::bind(load_lds, this, _1, _2, _3, _4, _5, Component::BOTH, bank_shift),
                     width,
                     height,
                     ThreadGuardMode::GUARD_BY_IF,
@@ -727,34 +959,32 @@ struct StockhamKernel : public StockhamGeneratorSpecs
                         = static_cast<float>(length) / half_width / threads_per_transform;
                     // minimize sync as possible
                     if(!isFirstStore)
-                        reg2lds_half += SyncThreads();
+                        reg2lds_half += lds_barrier();
                     reg2lds_half += add_work(
-                        std::bind(store_lds, this, _1, _2, _3, _4, _5, component, cumheight, false),
+                        std::bind(
+                            store_lds, this, _1, _2, _3, _4, _5, component, cumheight, bank_shift),
                         half_width,
                         half_height,
                         ThreadGuardMode::GUARD_BY_IF);
 
                     half_width  = factors[npass + 1];
                     half_height = static_cast<float>(length) / half_width / threads_per_transform;
-                    reg2lds_half += SyncThreads();
-                    reg2lds_half
-                        += add_work(std::bind(load_lds, this, _1, _2, _3, _4, _5, component, false),
-                                    half_width,
-                                    half_height,
-                                    ThreadGuardMode::GUARD_BY_IF);
+                    reg2lds_half += lds_barrier();
+                    reg2lds_half += add_work(
+                        std::bind(load_lds, this, _1, _2, _3, _4, _5, component, bank_shift),
+                        half_width,
+                        half_height,
+                        ThreadGuardMode::GUARD_BY_IF);
                 }
 
                 // internal full lds store (both linear/nonlinear variants)
                 if(npass == 0)
-                    reg2lds_full += If{!direct_load_to_reg, {SyncThreads()}};
+                    reg2lds_full += If{!direct_load_to_reg, lds_barrier()};
                 else
-                    reg2lds_full += SyncThreads();
-                reg2lds_full += add_work(
-                    std::bind(
-                        store_lds, this, _1, _2, _3, _4, _5, Component::BOTH, cumheight, false),
-                    width,
-                    height,
-                    ThreadGuardMode::GUARD_BY_IF);
+                    reg2lds_full += lds_barrier();
+                auto store_full = std::bind(
+                    store_lds, this, _1, _2, _3, _4, _5, Component::BOTH, cumheight, bank_shift);
+                reg2lds_full += add_work(store_full, width, height, ThreadGuardMode::GUARD_BY_IF);
 
                 body += If{Not{lds_is_real}, reg2lds_full};
                 body += Else{reg2lds_half};
@@ -800,8 +1030,16 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         // half-lds
         body += set_lds_is_real();
 
-        body += CallbackLoadDeclaration{scalar_type.name, callback_type.name};
-        body += CallbackStoreDeclaration{scalar_type.name, callback_type.name};
+        // odd-length real and real-to-real transforms load or store
+        // real elements
+        std::string cb_load_type = odd_real_direction == -1 || is_real_to_real()
+                                       ? "real_type_t<scalar_type>"
+                                       : scalar_type.name;
+        std::string cb_store_type = odd_real_direction == 1 || is_real_to_real()
+                                        ? "real_type_t<scalar_type>"
+                                        : scalar_type.name;
+        body += CallbackLoadDeclaration{cb_load_type, callback_type.name};
+        body += CallbackStoreDeclaration{cb_store_type, callback_type.name};
 
         body += LineBreak{};
         body += CommentLines{"large twiddles"};
@@ -810,8 +1048,15 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         body += LineBreak{};
         body += CommentLines{"offsets"};
         collect_length_stride(body);
-        body += calculate_offsets();
-        body += LineBreak{};
+
+        // a pipelined kernel does the rest once per tile, with
+        // offsets recomputed from the tile's block of work
+        StatementList  tile_body;
+        StatementList& tbody = pipelines_loads() ? tile_body : body;
+        if(pipelines_loads())
+            tbody += Assign{offset, 0};
+        tbody += calculate_offsets();
+        tbody += LineBreak{};
 
         StatementList loadlds;
         loadlds += CommentLines{"load global into lds"};
@@ -822,30 +1067,42 @@ struct StockhamKernel : public StockhamGeneratorSpecs
 
         if(!direct_to_from_reg)
         {
-            body += loadlds;
+            tbody += loadlds;
         }
         else
         {
             StatementList loadr;
             loadr += CommentLines{"load global into registers"};
-            loadr += load_from_global(true);
+            if(pipelines_loads())
+            {
+                // later tiles were loaded during the previous tile
+                loadr += If{pipeline_tile == 0, load_from_global(true)};
+                StatementList copy_next;
+                for(unsigned int i = 0; i < nregisters; ++i)
+                    copy_next += Assign{R[i], R_next[i]};
+                loadr += Else{copy_next};
+                loadr += CommentLines{"start loading the next tile"};
+                loadr += If{pipeline_tile + 1 < PIPELINE_TILES, load_next_tile()};
+            }
+            else
+                loadr += load_from_global(true);
 
-            body += If{direct_load_to_reg, loadr};
-            body += Else{loadlds};
+            tbody += If{direct_load_to_reg, loadr};
+            tbody += Else{loadlds};
         }
 
-        body += LineBreak{};
-        body += CommentLines{"calc the thread_in_device value once and for all device funcs"};
-        body += Declaration{thread_in_device,
-                            Ternary{lds_linear,
-                                    thread_id % threads_per_transform,
-                                    thread_id / transforms_per_block}};
+        tbody += LineBreak{};
+        tbody += CommentLines{"calc the thread_in_device value once and for all device funcs"};
+        tbody += Declaration{thread_in_device,
+                             Ternary{lds_linear,
+                                     thread_id % threads_per_transform,
+                                     thread_id / transforms_per_block}};
 
         // before starting the transform job (core device function)
         // we call a re-load lds-to-reg function here, but it's not always doing things.
         // If we're doing direct-to-reg, this function simply returns.
-        body += LineBreak{};
-        body += CommentLines{"call a pre-load from lds to registers (if necessary)"};
+        tbody += LineBreak{};
+        tbody += CommentLines{"call a pre-load from lds to registers (if necessary)"};
         auto pre_post_lds_tmpl = device_lds_reg_inout_device_call_templates();
         auto pre_post_lds_args = device_lds_reg_inout_device_call_arguments();
         pre_post_lds_tmpl.set_value(stride_type.name, "lds_linear ? SB_UNIT : SB_NONUNIT");
@@ -854,12 +1111,12 @@ struct StockhamKernel : public StockhamGeneratorSpecs
                         pre_post_lds_tmpl,
                         pre_post_lds_args};
         if(!direct_to_from_reg)
-            body += preLoad;
+            tbody += preLoad;
         else
-            body += If{!direct_load_to_reg, preLoad};
+            tbody += If{lds_to_reg_input_needed(), preLoad};
 
-        body += LineBreak{};
-        body += CommentLines{"transform"};
+        tbody += LineBreak{};
+        tbody += CommentLines{"transform"};
         for(unsigned int c = 0; c < n_device_calls; ++c)
         {
             auto templates = device_call_templates();
@@ -867,40 +1124,40 @@ struct StockhamKernel : public StockhamGeneratorSpecs
 
             templates.set_value(stride_type.name, "lds_linear ? SB_UNIT : SB_NONUNIT");
 
-            body
+            tbody
                 += Call{"forward_length" + std::to_string(length) + "_" + tiling_name() + "_device",
                         templates,
                         arguments};
-            body += LineBreak{};
+            tbody += LineBreak{};
         }
 
         // after finishing the transform job (core device function)
         // we call a post-store reg-to-lds function here, but it's not always doing things.
         // If we're doing direct-from-reg, this function simply returns.
-        body += LineBreak{};
-        body += CommentLines{"call a post-store from registers to lds (if necessary)"};
+        tbody += LineBreak{};
+        tbody += CommentLines{"call a post-store from registers to lds (if necessary)"};
         StatementList postStore;
         postStore += Call{"lds_from_reg_output_length" + std::to_string(length) + "_device",
                           pre_post_lds_tmpl,
                           pre_post_lds_args};
         if(!direct_to_from_reg)
-            body += postStore;
+            tbody += postStore;
         else
-            body += If{!direct_store_from_reg, postStore};
+            tbody += If{lds_from_reg_output_needed(), postStore};
 
-        body += LineBreak{};
+        tbody += LineBreak{};
         StatementList storelds;
         storelds += LineBreak{};
         // handle even-length complex to real post-process in lds after transform
         storelds += real_trans_pre_post(ProcessingType::POST);
         storelds += LineBreak{};
         storelds += CommentLines{"store global"};
-        storelds += SyncThreads{};
+        storelds += lds_barrier();
         storelds += store_to_global(false);
 
         if(!direct_to_from_reg)
         {
-            body += storelds;
+            tbody += storelds;
         }
         else
         {
@@ -908,8 +1165,23 @@ struct StockhamKernel : public StockhamGeneratorSpecs
             storer += CommentLines{"store registers into global"};
             storer += store_to_global(true);
 
-            body += If{direct_store_from_reg, storer};
-            body += Else{storelds};
+            tbody += If{direct_store_from_reg, storer};
+            tbody += Else{storelds};
+        }
+
+        if(pipelines_loads())
+        {
+            // the next tile reuses the LDS rows of this one
+            if(!registers_only())
+                tile_body += lds_barrier();
+
+            ReplaceVariablesVisitor use_pipeline_block{{{block_id.name, pipeline_block}}};
+            StatementList           loop;
+            loop += Declaration{pipeline_block, block_id * PIPELINE_TILES + pipeline_tile};
+            loop += use_pipeline_block(tile_body);
+
+            body += Declaration{R_next};
+            body += For{pipeline_tile, 0, pipeline_tile < PIPELINE_TILES, 1, loop, true};
         }
 
         f.templates = global_templates();
@@ -917,6 +1189,24 @@ struct StockhamKernel : public StockhamGeneratorSpecs
         return f;
     }
 
+    // Load the next tile's transforms into R_next.  Its offsets are
+    // computed in a scope of their own that shadows the current
+    // tile's.
+    StatementList load_next_tile()
+    {
+        StatementList stmts;
+        stmts += Declaration{offset, 0};
+        stmts += Declaration{offset_lds};
+        stmts += Declaration{stride_lds};
+        stmts += Declaration{batch};
+        stmts += Declaration{transform};
+        stmts += calculate_offsets();
+        stmts += load_from_global(true);
+
+        ReplaceVariablesVisitor next_tile{{{block_id.name, pipeline_block + 1}, {R.name, R_next}}};
+        return next_tile(stmts);
+    }
+
     // void update_kernel_settings();
 
     virtual StatementList calculate_offsets() = 0;
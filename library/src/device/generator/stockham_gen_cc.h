@@ -30,8 +30,9 @@ struct StockhamKernelCC : public StockhamKernel
         , largeTwdBatchIsTransformCount(largeTwdBatchIsTransformCount)
         , emitGlobalId(emitGlobalId)
     {
-        large_twiddle_steps.decl_default = 3;
-        large_twiddle_base.decl_default  = 8;
+        large_twiddle_steps.decl_default  = 3;
+        large_twiddle_base.decl_default   = 8;
+        large_twiddle_length.decl_default = 0;
     }
 
     bool largeTwdBatchIsTransformCount = false;
@@ -44,6 +45,9 @@ struct StockhamKernelCC : public StockhamKernel
     Variable apply_large_twiddle{"apply_large_twiddle", "bool"};
     Variable large_twiddle_steps{"large_twiddle_steps", "size_t"};
     Variable large_twiddle_base{"large_twiddle_base", "size_t"};
+    // if non-zero, large twiddles are computed for this length
+    // instead of being read from the large twiddle table
+    Variable large_twiddle_length{"large_twiddle_length", "size_t"};
 
     //
     // arguments
@@ -65,7 +69,8 @@ struct StockhamKernelCC : public StockhamKernel
 
     // large twiddle support
     Multiply ltwd_entries{Parens{ShiftLeft{1, large_twiddle_base}}, 3};
-    And      ltwd_in_lds{apply_large_twiddle, Less{large_twiddle_base, 8}};
+    And      ltwd_in_lds{And{apply_large_twiddle, Less{large_twiddle_base, 8}},
+                        Equal{large_twiddle_length, 0}};
     Variable large_twd_lds{"large_twd_lds",
                            "__shared__ scalar_type",
                            false,
@@ -492,6 +497,7 @@ struct StockhamKernelCC : public StockhamKernel
         tpls.append(apply_large_twiddle);
         tpls.append(large_twiddle_steps);
         tpls.append(large_twiddle_base);
+        tpls.append(large_twiddle_length);
         return tpls;
     }
 
@@ -510,6 +516,7 @@ struct StockhamKernelCC : public StockhamKernel
         tpls.append(apply_large_twiddle);
         tpls.append(large_twiddle_steps);
         tpls.append(large_twiddle_base);
+        tpls.append(large_twiddle_length);
         return tpls;
     }
 
@@ -527,15 +534,14 @@ struct StockhamKernelCC : public StockhamKernel
         tpls.append(apply_large_twiddle);
         tpls.append(large_twiddle_steps);
         tpls.append(large_twiddle_base);
+        tpls.append(large_twiddle_length);
         return tpls;
     }
 
     std::vector<Expression> device_call_arguments(unsigned int call_iter) override
     {
         std::vector<Expression> args = StockhamKernel::device_call_arguments(call_iter);
-        auto which = Ternary{Parens{And{apply_large_twiddle, large_twiddle_base < 8}},
-                             Parens{large_twd_lds},
-                             Parens{large_twiddles}};
+        auto which = Ternary{Parens{ltwd_in_lds}, Parens{large_twd_lds}, Parens{large_twiddles}};
         args.push_back(which);
         args.push_back(largeTwdBatchIsTransformCount ? batch : transform);
         return args;
@@ -579,11 +585,16 @@ struct StockhamKernelCC : public StockhamKernel
                        + " + " + std::to_string(h * threads_per_transform) + ") % "
                        + std::to_string(cumheight) + ") + " + std::to_string(w) + " * "
                        + std::to_string(cumheight) + ") * " + trans_local.render();
-            work += Assign{
+            work += If{large_twiddle_length != 0,
+                       {Assign{W,
+                               CallExpr{"TW_Compute",
+                                        TemplateList{scalar_type},
+                                        {idx, large_twiddle_length}}}}};
+            work += Else{{Assign{
                 W,
                 CallExpr{"TW_NSteps",
                          TemplateList{scalar_type, large_twiddle_base, large_twiddle_steps},
-                         {large_twiddles, idx}}};
+                         {large_twiddles, idx}}}}};
             work += Assign{t, TwiddleMultiply{R[hr * width + w], W}};
             work += Assign{R[hr * width + w], t};
         }
@@ -63,10 +63,20 @@ struct StockhamKernelCR : public StockhamKernel
                     Declaration{lds_linear, Literal{"true"}}};
     }
 
+    // SBCR can use half-lds when loading to registers: the
+    // transposed store of the tile is then staged through LDS one
+    // component at a time
     StatementList set_lds_is_real() override
     {
-        // SBCR can't support half-lds
-        return {Declaration{lds_is_real, Literal{"false"}}};
+        if(half_lds && direct_to_from_reg)
+            return {Declaration{lds_is_real, direct_load_to_reg}};
+        else
+            return {Declaration{lds_is_real, Literal{"false"}}};
+    }
+
+    Expression lds_from_reg_output_needed() override
+    {
+        return !direct_store_from_reg && !lds_is_real;
     }
 
     StatementList load_global_generator(unsigned int h,
@@ -376,9 +386,68 @@ struct StockhamKernelCR : public StockhamKernel
                                   {StoreGlobal{buf, offset + buf_idx, lds_complex[lds_idx]}}};
             }
 
-            stmts += If{in_bound, regular_store};
-            stmts += If{Not{in_bound}, edge_store};
-            // stmts += Else{edge_store};  // FIXME: Need to check with compiler team.
+            StatementList full_lds;
+            full_lds += If{in_bound, regular_store};
+            full_lds += If{Not{in_bound}, edge_store};
+            // full_lds += Else{edge_store};  // FIXME: Need to check with compiler team.
+
+            if(half_lds && direct_to_from_reg)
+            {
+                // half-lds: the real and then the imaginary parts go
+                // from registers through LDS into R_tile, which holds
+                // each thread's part of the tile until it's stored
+                auto tile_pred = [&](unsigned int i) -> Expression {
+                    if(divisible)
+                        return (tile_index * transforms_per_block + thread + i * tid0_inc_step)
+                               < lengths[1];
+                    else
+                        return (thread_id + i * workgroup_size) < (length * transforms_per_block);
+                };
+                auto n_tile = DivRoundingUp(length * transforms_per_block, workgroup_size);
+
+                StatementList half;
+                half += Declaration{R_tile};
+                half += Declaration{l_offset};
+                for(auto component : {Component::REAL, Component::IMAG})
+                {
+                    StatementList regular_read;
+                    StatementList edge_read;
+                    for(unsigned int i = 0; i < n_tile; ++i)
+                    {
+                        auto   value = component == Component::REAL ? R_tile[i].x() : R_tile[i].y();
+                        Assign read{value, lds_real[offset_tile_rlds_trans(i)]};
+                        if(i < num_store_blocks)
+                            regular_read += read;
+                        edge_read += If{tile_pred(i), {read}};
+                    }
+
+                    if(component == Component::IMAG)
+                        half += SyncThreads{};
+                    half += lds_real_from_reg_output(component);
+                    half += SyncThreads{};
+                    half += If{in_bound, regular_read};
+                    half += If{Not{in_bound}, edge_read};
+                }
+
+                StatementList regular_tile_store;
+                StatementList edge_tile_store;
+                for(unsigned int i = 0; i < n_tile; ++i)
+                {
+                    StoreGlobal store{buf, offset + offset_tile_wbuf(i), R_tile[i]};
+                    if(i < num_store_blocks)
+                        regular_tile_store += store;
+                    edge_tile_store += If{tile_pred(i), {store}};
+                }
+                half += If{in_bound, regular_tile_store};
+                half += If{Not{in_bound}, edge_tile_store};
+
+                stmts += If{lds_is_real, half};
+                stmts += Else{full_lds};
+            }
+            else
+            {
+                stmts += full_lds;
+            }
         }
         else
         {
@@ -90,10 +90,20 @@ struct StockhamKernelRC : public StockhamKernel
                     Declaration{lds_linear, Literal{"true"}}};
     }
 
+    // SBRC can use half-lds when storing from registers: the
+    // transposed load of the tile is then staged through LDS one
+    // component at a time
     StatementList set_lds_is_real() override
     {
-        // SBRC can't support half-lds
-        return {Declaration{lds_is_real, Literal{"false"}}};
+        if(half_lds && direct_to_from_reg)
+            return {Declaration{lds_is_real, direct_store_from_reg}};
+        else
+            return {Declaration{lds_is_real, Literal{"false"}}};
+    }
+
+    Expression lds_to_reg_input_needed() override
+    {
+        return !direct_load_to_reg && !lds_is_real;
     }
 
     StatementList store_global_generator(unsigned int h,
@@ -271,13 +281,17 @@ struct StockhamKernelRC : public StockhamKernel
         offset_3d += Assign{tile_serial_in_batch, block_id % num_of_tiles_in_batch};
 
         // Use DIAGONAL or NOT
-        auto xy_z_diagonal = [&]() -> StatementList {
+        // Diagonal ordering: consecutive blocks take the same tile of
+        // consecutive planes, shifted by the tile index, so that
+        // concurrent blocks don't all hit the same channels.  For
+        // each tile the shift is a rotation of the planes, so this
+        // covers every (tile, plane) once for any rectangular volume.
+        auto diagonal = [&]() -> StatementList {
             return {
-                Assign{tile_index_in_plane, tile_serial_in_batch % threads_per_transform},
-                // looks like lengths[1] is correct? but if we restrict the size to be cubic, then we can simply use length
+                Assign{tile_index_in_plane, tile_serial_in_batch % num_of_tiles_in_plane},
                 Assign{plane_id,
-                       (tile_serial_in_batch / threads_per_transform + tile_index_in_plane)
-                           % length},
+                       (tile_serial_in_batch / num_of_tiles_in_plane + tile_index_in_plane)
+                           % len_along_plane},
             };
         };
         auto xy_z_regular = [&]() -> StatementList {
@@ -289,15 +303,6 @@ struct StockhamKernelRC : public StockhamKernel
             };
         };
 
-        auto z_xy_diagonal = [&]() -> StatementList {
-            return {
-                Assign{tile_index_in_plane, tile_serial_in_batch % threads_per_transform},
-                // looks like lengths[2] is correct? but if we restrict the size to be cubic, then we can simply use length
-                Assign{plane_id,
-                       (tile_serial_in_batch / threads_per_transform + tile_index_in_plane)
-                           % length},
-            };
-        };
         auto z_xy_regular = [&]() -> StatementList {
             return {
                 Assign{plane_id, tile_serial_in_batch / num_of_tiles_in_plane},
@@ -306,11 +311,11 @@ struct StockhamKernelRC : public StockhamKernel
         };
 
         StatementList xy_z_offset;
-        xy_z_offset += If{transpose_type == "DIAGONAL", xy_z_diagonal()};
+        xy_z_offset += If{transpose_type == "DIAGONAL", diagonal()};
         xy_z_offset += Else{xy_z_regular()};
 
         StatementList z_xy_offset;
-        z_xy_offset += If{transpose_type == "DIAGONAL", z_xy_diagonal()};
+        z_xy_offset += If{transpose_type == "DIAGONAL", diagonal()};
         z_xy_offset += Else{z_xy_regular()};
 
         offset_3d += If{sbrc_type == "SBRC_3D_FFT_TRANS_XY_Z", xy_z_offset};
@@ -538,8 +543,79 @@ struct StockhamKernelRC : public StockhamKernel
                 }
             }
 
-            stmts += If{Or{transpose_type != "TILE_UNALIGNED", Not{edge}}, regular_load};
-            stmts += Else{edge_load};
+            StatementList full_lds;
+            full_lds += If{Or{transpose_type != "TILE_UNALIGNED", Not{edge}}, regular_load};
+            full_lds += Else{edge_load};
+
+            if(half_lds && direct_to_from_reg)
+            {
+                // half-lds: each thread keeps its part of the tile in
+                // R_tile, while the real and then the imaginary parts go
+                // through LDS into registers
+                auto tile_pred = [&](unsigned int i) -> Expression {
+                    if(divisible)
+                        return (tile_index_in_plane * transforms_per_block + thread
+                                + i * tid0_inc_step)
+                               < len_along_block;
+                    else
+                        return (thread_id + i * workgroup_size) < (length * transforms_per_block);
+                };
+                auto n_tile = DivRoundingUp(length * transforms_per_block, workgroup_size);
+
+                StatementList regular_tile_load;
+                StatementList edge_tile_load;
+                for(unsigned int i = 0; i < n_tile; ++i)
+                {
+                    StatementList load;
+                    if(emitGlobalId)
+                    {
+                        load += Assign{global_data_id,
+                                       global_load_data_offset + offset_tile_tmp(i)};
+                        load += Assign{global_transf_id,
+                                       global_load_transf_offset + offset_tile_tmp(i)};
+                    }
+                    load += Assign{R_tile[i], LoadGlobal{buf, offset_in + offset_tile_rbuf(i)}};
+
+                    if(i < num_load_blocks)
+                        regular_tile_load += load;
+                    edge_tile_load += If{tile_pred(i), load};
+                }
+
+                StatementList half;
+                half += Declaration{R_tile};
+                half += Declaration{l_offset};
+                half += If{Or{transpose_type != "TILE_UNALIGNED", Not{edge}}, regular_tile_load};
+                half += Else{edge_tile_load};
+                for(auto component : {Component::REAL, Component::IMAG})
+                {
+                    StatementList regular_write;
+                    StatementList edge_write;
+                    for(unsigned int i = 0; i < n_tile; ++i)
+                    {
+                        auto value = component == Component::REAL ? R_tile[i].x() : R_tile[i].y();
+                        Assign write{lds_real[offset_tile_wlds_trans(i)], value};
+                        if(i < num_load_blocks)
+                            regular_write += write;
+                        edge_write += If{tile_pred(i), {write}};
+                    }
+
+                    if(component == Component::IMAG)
+                        half += SyncThreads{};
+                    half += If{Or{transpose_type != "TILE_UNALIGNED", Not{edge}}, regular_write};
+                    half += Else{edge_write};
+                    half += SyncThreads{};
+                    half += lds_real_to_reg_input(component);
+                }
+                // the first pass' LDS stores follow without a barrier
+                half += SyncThreads{};
+
+                stmts += If{lds_is_real, half};
+                stmts += Else{full_lds};
+            }
+            else
+            {
+                stmts += full_lds;
+            }
         }
         else
         {
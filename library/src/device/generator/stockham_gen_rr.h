@@ -37,6 +37,260 @@ struct StockhamKernelRR : public StockhamKernel
         return "SBRR";
     }
 
+    // fused 2D/3D kernels are built from SBRR kernels too, but they
+    // share LDS between dimensions, so only plain 1D kernels get the
+    // specialisations below
+    bool is_1d_sbrr() const
+    {
+        return scheme == "CS_KERNEL_STOCKHAM";
+    }
+
+    bool registers_only() override
+    {
+        // odd-length real transforms go through LDS to expand and
+        // trim the Hermitian half
+        return is_1d_sbrr() && odd_real_direction == 0 && !is_real_to_real()
+               && is_registers_only(length, threads_per_transform, direct_to_from_reg);
+    }
+
+    // each block can work through several tiles of transforms with
+    // its own LDS rows, loading the next tile's transforms while the
+    // current one is computed
+    bool pipelines_loads() override
+    {
+        return pipelined_loads && is_1d_sbrr();
+    }
+
+    // element j of the real input or output of a real-to-real
+    // transform
+    Expression r2r_elem(const Expression& j)
+    {
+        return LoadGlobal{buf, offset + j * stride0};
+    }
+
+    Expression r2r_rotate(const Expression& v, const Expression& r, unsigned int d, int dir)
+    {
+        return CallExpr{"r2r_rotate", TemplateList{scalar_type}, {v, r, d, dir}};
+    }
+
+    // DCT-II/III reorder even-indexed inputs to the front and
+    // odd-indexed ones (reversed) to the back of the FFT
+    Expression r2r_even_odd_index(const Expression& idx)
+    {
+        return Ternary{2 * idx < r2r_length, 2 * idx, 2 * Parens{r2r_length - 1 - idx} + 1};
+    }
+
+    // build element 'idx' of the complex FFT input from the real
+    // input, following Makhoul's mappings of each DCT/DST to a
+    // complex FFT
+    StatementList load_real_to_real(const Expression& idx)
+    {
+        const unsigned int n    = r2r_length;
+        auto               elem = lds_complex[offset_lds + idx];
+        Expression         zero = Literal{"0.0"};
+
+        StatementList stmts;
+        switch(r2r_type)
+        {
+        case rocfft_transform_type_dct1:
+            // even extension without repeating the endpoints
+            stmts += Assign{elem.x(), Ternary{idx < n, r2r_elem(idx), r2r_elem(length - idx)}};
+            stmts += Assign{elem.y(), zero};
+            break;
+        case rocfft_transform_type_dst1:
+            // odd extension of 0, x[0..n-1], 0
+            stmts += If{Or{idx == 0, idx == n + 1}, {Assign{elem.x(), zero}}};
+            stmts += ElseIf{idx <= n, {Assign{elem.x(), r2r_elem(idx - 1)}}};
+            stmts += Else{{Assign{elem.x(), -r2r_elem(length - 1 - idx)}}};
+            stmts += Assign{elem.y(), zero};
+            break;
+        case rocfft_transform_type_dct2:
+        case rocfft_transform_type_dst2:
+        {
+            // DST-II negates the odd-indexed inputs as well (and
+            // reverses the output)
+            Expression odd = r2r_elem(2 * Parens{n - 1 - idx} + 1);
+            if(r2r_type == rocfft_transform_type_dst2)
+                odd = -odd;
+            stmts += Assign{elem.x(), Ternary{2 * idx < n, r2r_elem(2 * idx), Expression{odd}}};
+            stmts += Assign{elem.y(), zero};
+            break;
+        }
+        case rocfft_transform_type_dct3:
+        case rocfft_transform_type_dst3:
+        {
+            // DST-III is DCT-III of the reversed input
+            auto in = [this, n](const Expression& j) {
+                return r2r_type == rocfft_transform_type_dst3 ? r2r_elem(n - 1 - j) : r2r_elem(j);
+            };
+            stmts += If{idx == 0, {Assign{elem, ComplexLiteral{in(0), zero}}}};
+            stmts += Else{{Assign{
+                elem, r2r_rotate(ComplexLiteral{in(idx), -in(n - idx)}, idx, 2 * n, 1)}}};
+            break;
+        }
+        case rocfft_transform_type_dct4:
+        case rocfft_transform_type_dst4:
+        {
+            // DST-IV is DCT-IV of the reversed input
+            auto in = [this, n](const Expression& j) {
+                return r2r_type == rocfft_transform_type_dst4 ? r2r_elem(n - 1 - j) : r2r_elem(j);
+            };
+            if(n == 2 * length)
+            {
+                // even n: pack even-indexed and (reversed) odd-indexed
+                // inputs into an n/2-point FFT
+                stmts += Assign{elem,
+                                r2r_rotate(ComplexLiteral{in(2 * idx), in(n - 1 - 2 * idx)},
+                                           4 * idx + 1,
+                                           4 * n,
+                                           -1)};
+            }
+            else
+            {
+                // odd n: zero-padded 2n-point FFT
+                stmts += If{idx < n,
+                            {Assign{elem, r2r_rotate(ComplexLiteral{in(idx), zero}, idx, 2 * n, -1)}}};
+                stmts += Else{{Assign{elem, ComplexLiteral{zero, zero}}}};
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error("invalid real-to-real transform type");
+        }
+        return stmts;
+    }
+
+    // store the real outputs that FFT output 'idx' contributes to
+    StatementList store_real_to_real(const Expression& idx)
+    {
+        const unsigned int n    = r2r_length;
+        auto               elem = lds_complex[offset_lds + idx];
+        auto               out  = [this](const Expression& j, const Expression& value) {
+            return StoreGlobal{buf, offset + j * stride0, value};
+        };
+
+        StatementList stmts;
+        switch(r2r_type)
+        {
+        case rocfft_transform_type_dct1:
+            stmts += If{idx < n, {out(idx, elem.x())}};
+            break;
+        case rocfft_transform_type_dst1:
+            stmts += If{And{idx >= 1, idx <= n}, {out(idx - 1, -elem.y())}};
+            break;
+        case rocfft_transform_type_dct2:
+        case rocfft_transform_type_dst2:
+            stmts += Assign{elem, r2r_rotate(elem, idx, 2 * n, -1)};
+            stmts += out(r2r_type == rocfft_transform_type_dct2 ? Expression{idx}
+                                                                : Expression{n - 1 - idx},
+                         elem.x() + elem.x());
+            break;
+        case rocfft_transform_type_dct3:
+            stmts += out(r2r_even_odd_index(idx), elem.x());
+            break;
+        case rocfft_transform_type_dst3:
+            // DST-III negates the odd-indexed outputs of the DCT-III
+            stmts += out(r2r_even_odd_index(idx), Ternary{2 * idx < n, elem.x(), -elem.x()});
+            break;
+        case rocfft_transform_type_dct4:
+        case rocfft_transform_type_dst4:
+        {
+            // DST-IV negates the odd-indexed outputs of the DCT-IV
+            const bool sine = r2r_type == rocfft_transform_type_dst4;
+            if(n == 2 * length)
+            {
+                stmts += Assign{elem, r2r_rotate(elem, idx, n, -1)};
+                stmts += out(2 * idx, elem.x() + elem.x());
+                stmts += out(n - 1 - 2 * idx,
+                             sine ? Expression{elem.y() + elem.y()}
+                                  : Expression{-Parens{elem.y() + elem.y()}});
+            }
+            else
+            {
+                StatementList work;
+                work += Assign{elem, r2r_rotate(elem, 2 * idx + 1, 4 * n, -1)};
+                work += out(idx,
+                            sine ? Expression{Ternary{idx % 2 == 0,
+                                                      elem.x() + elem.x(),
+                                                      -Parens{elem.x() + elem.x()}}}
+                                 : Expression{elem.x() + elem.x()});
+                stmts += If{idx < n, work};
+            }
+            break;
+        }
+        default:
+            throw std::runtime_error("invalid real-to-real transform type");
+        }
+        return stmts;
+    }
+
+    // each transform has its own LDS row, so when its threads are all
+    // in one wavefront only that wavefront needs to wait
+    StatementList lds_barrier() override
+    {
+        if(is_1d_sbrr() && transform_fits_in_wave())
+            return {Call{"wave_lds_barrier", {}}};
+        return {SyncThreads()};
+    }
+
+    // a thread that owns a whole transform can move it to and from
+    // registers with 128-bit accesses, when the transform is
+    // contiguous in memory
+    bool use_vector_global_access() const
+    {
+        return is_1d_sbrr() && threads_per_transform == 1 && vector_width > 1
+               && length % vector_width == 0;
+    }
+
+    // condition for the vector path, checked per transform since
+    // offsets and distances need not preserve alignment
+    Expression vector_global_access_ok(const std::string& helper)
+    {
+        return CallExpr{helper, {buf, offset}} && stride0 == 1;
+    }
+
+    // register holding element 'idx' of the transform, for a thread
+    // that owns the whole transform: consecutive elements are spread
+    // across butterflies of the first pass on load, and gathered
+    // from butterflies of the last pass on store
+    Expression vector_load_register(unsigned int idx)
+    {
+        auto height = length / factors.front();
+        return R[(idx % height) * factors.front() + idx / height];
+    }
+
+    Expression vector_store_register(unsigned int idx)
+    {
+        auto cumheight = length / factors.back();
+        return R[(idx % cumheight) * factors.back() + idx / cumheight];
+    }
+
+    StatementList load_global_vector()
+    {
+        StatementList stmts;
+        for(unsigned int i = 0; i < length; i += vector_width)
+        {
+            std::vector<Expression> args{buf, offset + i};
+            for(unsigned int v = 0; v < vector_width; ++v)
+                args.push_back(vector_load_register(i + v));
+            stmts += Call{"load_global_vector", args};
+        }
+        return stmts;
+    }
+
+    StatementList store_global_vector()
+    {
+        StatementList stmts;
+        for(unsigned int i = 0; i < length; i += vector_width)
+        {
+            std::vector<Expression> args{buf, offset + i};
+            for(unsigned int v = 0; v < vector_width; ++v)
+                args.push_back(vector_store_register(i + v));
+            stmts += Call{"store_global_vector", args};
+        }
+        return stmts;
+    }
+
     StatementList calculate_offsets() override
     {
         Variable d{"d", "int"};
@@ -82,9 +336,31 @@ struct StockhamKernelRR : public StockhamKernel
             for(unsigned int h = 0; h < height; ++h)
             {
                 auto idx = thread + h * width;
-                stmts += Assign{lds_complex[offset_lds + idx],
-                                LoadGlobal{buf, offset + idx * stride0}};
+                auto elem = lds_complex[offset_lds + idx];
+                if(is_real_to_real())
+                    stmts += load_real_to_real(idx);
+                else if(odd_real_direction == -1)
+                {
+                    stmts += Assign{
+                        elem, ComplexLiteral{LoadGlobal{buf, offset + idx * stride0}, "0.0"}};
+                }
+                else if(odd_real_direction == 1)
+                {
+                    // only the first length/2+1 elements are in
+                    // memory, the rest are their conjugates
+                    stmts += If{idx <= length / 2,
+                                {Assign{elem, LoadGlobal{buf, offset + idx * stride0}}}};
+                    stmts += Else{{Assign{elem, LoadGlobal{buf, offset + (length - idx) * stride0}},
+                                   Assign{elem.y(), -elem.y()}}};
+                }
+                else
+                    stmts += Assign{elem, load_transform_elem(idx)};
             }
+            // odd-length real and real-to-real kernels can't be
+            // embedded C2Real kernels, and their input may be real
+            if(odd_real_direction != 0 || is_real_to_real())
+                return {If{inbound, stmts}};
+
             stmts += LineBreak();
             stmts += CommentLines{"append extra global loading for C2Real pre-process only"};
 
@@ -94,7 +370,7 @@ struct StockhamKernelRR : public StockhamKernel
             stmts_c2real_pre += If{
                 thread == threads_per_transform - 1,
                 {Assign{lds_complex[offset_lds + thread + (height - 1) * width + 1],
-                        LoadGlobal{buf, offset + (thread + (height - 1) * width + 1) * stride0}}}};
+                        load_transform_elem(thread + (height - 1) * width + 1)}}};
             stmts += If{embedded_type == Literal{"EmbeddedType::C2Real_PRE"}, stmts_c2real_pre};
         }
         else
@@ -102,11 +378,20 @@ struct StockhamKernelRR : public StockhamKernel
             unsigned int width  = factors[0];
             auto         height = static_cast<float>(length) / width / threads_per_transform;
 
-            auto load_global = std::mem_fn(&StockhamKernel::load_global_generator);
-            stmts += add_work(std::bind(load_global, this, _1, _2, _3, _4, _5),
-                              width,
-                              height,
-                              ThreadGuardMode::GUARD_BY_IF);
+            auto          load_global = std::mem_fn(&StockhamKernel::load_global_generator);
+            StatementList load_elements;
+            load_elements += add_work(std::bind(load_global, this, _1, _2, _3, _4, _5),
+                                      width,
+                                      height,
+                                      ThreadGuardMode::GUARD_BY_IF);
+            if(use_vector_global_access())
+            {
+                stmts += If{vector_global_access_ok("load_global_vector_aligned"),
+                            load_global_vector()};
+                stmts += Else{load_elements};
+            }
+            else
+                stmts += load_elements;
         }
 
         return {If{inbound, stmts}};
@@ -123,9 +408,27 @@ struct StockhamKernelRR : public StockhamKernel
             for(unsigned int h = 0; h < height; ++h)
             {
                 auto idx = thread + h * width;
-                stmts += StoreGlobal{buf, offset + idx * stride0, lds_complex[offset_lds + idx]};
+                if(is_real_to_real())
+                    stmts += store_real_to_real(idx);
+                else if(odd_real_direction == -1)
+                {
+                    // the rest of the output is redundant
+                    stmts += If{idx <= length / 2,
+                                {StoreGlobal{
+                                    buf, offset + idx * stride0, lds_complex[offset_lds + idx]}}};
+                }
+                else if(odd_real_direction == 1)
+                    stmts += StoreGlobal{
+                        buf, offset + idx * stride0, lds_complex[offset_lds + idx].x()};
+                else
+                    stmts
+                        += StoreGlobal{buf, offset + idx * stride0, lds_complex[offset_lds + idx]};
             }
 
+            // nor are they embedded Real2C kernels
+            if(odd_real_direction != 0 || is_real_to_real())
+                return {If{inbound, stmts}};
+
             stmts += LineBreak{};
             stmts += CommentLines{"append extra global write for Real2C post-process only"};
             StatementList stmts_real2c_post;
@@ -144,11 +447,21 @@ struct StockhamKernelRR : public StockhamKernel
             auto cumheight = product(factors.begin(), factors.begin() + (factors.size() - 1));
             auto height    = static_cast<float>(length) / width / threads_per_transform;
 
-            auto store_global = std::mem_fn(&StockhamKernel::store_global_generator);
-            stmts += add_work(std::bind(store_global, this, _1, _2, _3, _4, _5, cumheight),
-                              width,
-                              height,
-                              ThreadGuardMode::GUARD_BY_IF);
+            auto          store_global = std::mem_fn(&StockhamKernel::store_global_generator);
+            StatementList store_elements;
+            store_elements
+                += add_work(std::bind(store_global, this, _1, _2, _3, _4, _5, cumheight),
+                            width,
+                            height,
+                            ThreadGuardMode::GUARD_BY_IF);
+            if(use_vector_global_access())
+            {
+                stmts += If{vector_global_access_ok("store_global_vector_aligned"),
+                            store_global_vector()};
+                stmts += Else{store_elements};
+            }
+            else
+                stmts += store_elements;
         }
 
         return {If{inbound, stmts}};
@@ -164,182 +477,4 @@ struct StockhamKernelRR : public StockhamKernel
         stmts += real2cmplx_pre_post(length, type, threads_per_transform, twd_offset);
         return stmts;
     }
-
-    Function generate_device_function_with_bank_shift()
-    {
-        std::string function_name
-            = "forward_length" + std::to_string(length) + "_" + tiling_name() + "_device";
-
-        Function f{function_name};
-        f.arguments = device_arguments();
-        f.templates = device_templates();
-        f.qualifier = "__device__";
-        if(length == 1)
-        {
-            return f;
-        }
-
-        StatementList& body = f.body;
-        body += Declaration{W};
-        body += Declaration{t};
-        body += Declaration{
-            lstride, Ternary{Parens{stride_type == "SB_UNIT"}, Parens{1}, Parens{stride_lds}}};
-
-        body += Declaration{l_offset};
-
-        for(unsigned int npass = 0; npass < factors.size(); ++npass)
-        {
-            // width is the butterfly width, Radix-n. Mostly is used as dt in add_work()
-            unsigned int width = factors[npass];
-            // height is how many butterflies per thread will do on average
-            float height = static_cast<float>(length) / width / threads_per_transform;
-
-            unsigned int cumheight
-                = product(factors.begin(),
-                          factors.begin() + npass); // cumheight is irrelevant to the above height,
-            // is used for twiddle multiplication and lds writing.
-
-            body += LineBreak{};
-            body += CommentLines{
-                "pass " + std::to_string(npass) + ", width " + std::to_string(width),
-                "using " + std::to_string(threads_per_transform) + " threads we need to do "
-                    + std::to_string(length / width) + " radix-" + std::to_string(width)
-                    + " butterflies",
-                "therefore each thread will do " + std::to_string(height) + " butterflies"};
-
-            auto load_lds  = std::mem_fn(&StockhamKernel::load_lds_generator);
-            auto store_lds = std::mem_fn(&StockhamKernel::store_lds_generator);
-
-            if(npass > 0)
-            {
-                // internal full lds2reg (both linear/nonlinear variants)
-                StatementList lds2reg_full;
-                lds2reg_full += SyncThreads();
-
-                // NB:
-                //   When lds conflict becomes significant enough, we can apply lds bank shift to reduce it.
-                //   We enable it for small pow of 2 cases on all supported archs for now.
-                if(length == 64)
-                {
-                    lds2reg_full += add_work(
-                        std::bind(load_lds, this, _1, _2, _3, _4, _5, Component::BOTH, true),
-                        width,
-                        height,
-                        ThreadGuardMode::NO_GUARD);
-                }
-                else
-                {
-                    lds2reg_full += add_work(
-                        std::bind(load_lds, this, _1, _2, _3, _4, _5, Component::BOTH, false),
-                        width,
-                        height,
-                        ThreadGuardMode::GUARD_BY_IF);
-                }
-                body += If{Not{lds_is_real}, lds2reg_full};
-
-                auto apply_twiddle = std::mem_fn(&StockhamKernel::apply_twiddle_generator);
-                body += add_work(
-                    std::bind(apply_twiddle, this, _1, _2, _3, _4, _5, cumheight, factors.front()),
-                    width,
-                    height,
-                    ThreadGuardMode::NO_GUARD);
-            }
-
-            auto butterfly = std::mem_fn(&StockhamKernel::butterfly_generator);
-            body += add_work(std::bind(butterfly, this, _1, _2, _3, _4, _5),
-                             width,
-                             height,
-                             ThreadGuardMode::NO_GUARD);
-
-            if(npass == factors.size() - 1)
-                body += large_twiddles_multiply(width, height, cumheight);
-
-            // internal lds store (half-with-linear and full-with-linear/nonlinear)
-            StatementList reg2lds_full;
-            StatementList reg2lds_half;
-            if(npass < factors.size() - 1)
-            {
-                // linear variant store (half) and load (half)
-                for(auto component : {Component::REAL, Component::IMAG})
-                {
-                    bool isFirstStore = (npass == 0) && (component == Component::REAL);
-                    auto half_width   = factors[npass];
-                    auto half_height
-                        = static_cast<float>(length) / half_width / threads_per_transform;
-                    // minimize sync as possible
-                    if(!isFirstStore)
-                        reg2lds_half += SyncThreads();
-
-                    if(length == 64)
-                    {
-                        reg2lds_half += add_work(
-                            std::bind(
-                                store_lds, this, _1, _2, _3, _4, _5, component, cumheight, true),
-                            half_width,
-                            half_height,
-                            ThreadGuardMode::GUARD_BY_IF);
-                    }
-                    else
-                    {
-                        reg2lds_half += add_work(
-                            std::bind(
-                                store_lds, this, _1, _2, _3, _4, _5, component, cumheight, false),
-                            half_width,
-                            half_height,
-                            ThreadGuardMode::GUARD_BY_IF);
-                    }
-
-                    half_width  = factors[npass + 1];
-                    half_height = static_cast<float>(length) / half_width / threads_per_transform;
-                    reg2lds_half += SyncThreads();
-                    if(length == 64)
-                    {
-                        reg2lds_half += add_work(
-                            std::bind(load_lds, this, _1, _2, _3, _4, _5, component, true),
-                            half_width,
-                            half_height,
-                            ThreadGuardMode::GUARD_BY_IF);
-                    }
-                    else
-                    {
-                        reg2lds_half += add_work(
-                            std::bind(load_lds, this, _1, _2, _3, _4, _5, component, false),
-                            half_width,
-                            half_height,
-                            ThreadGuardMode::GUARD_BY_IF);
-                    }
-                }
-
-                // internal full lds store (both linear/nonlinear variants)
-                if(npass == 0)
-                    reg2lds_full += If{!direct_load_to_reg, {SyncThreads()}};
-                else
-                    reg2lds_full += SyncThreads();
-
-                if(length == 64)
-                {
-                    reg2lds_full += add_work(
-                        std::bind(
-                            store_lds, this, _1, _2, _3, _4, _5, Component::BOTH, cumheight, true),
-                        width,
-                        height,
-                        ThreadGuardMode::GUARD_BY_IF);
-                }
-                else
-                {
-                    reg2lds_full += add_work(
-                        std::bind(
-                            store_lds, this, _1, _2, _3, _4, _5, Component::BOTH, cumheight, false),
-                        width,
-                        height,
-                        ThreadGuardMode::GUARD_BY_IF);
-                }
-
-                body += If{Not{lds_is_real}, reg2lds_full};
-                body += Else{reg2lds_half};
-            }
-        }
-
-        return f;
-    }
 };
@@ -26,6 +26,8 @@
 #include <unordered_map>
 #include <vector>
 
+#include "rtc_radix_gen.h"
+
 extern const char* rocfft_complex_h;
 extern const char* common_h;
 extern const char* memory_gfx_h;
@@ -84,7 +86,12 @@ static void append_radix_h(std::string& src, const std::vector<unsigned int>& fa
         // no-op radix 1
         if(f == 1)
             continue;
-        src += butterfly_funcs.at(f);
+        // larger primes have no hand-written butterfly
+        auto func = butterfly_funcs.find(f);
+        if(func != butterfly_funcs.end())
+            src += func->second;
+        else
+            src += prime_radix_rtc(f);
     }
 }
 #endif
@@ -41,8 +41,8 @@ from pathlib import Path
 from types import SimpleNamespace as NS
 from operator import mul
 
-from generator import (ArgumentList, BaseNode, Call, CommentBlock, Function,
-                       Include, LineBreak, Map, StatementList, Variable,
+from generator import (Add, ArgumentList, BaseNode, Call, CommentBlock,
+                       Function, Include, LineBreak, StatementList, Variable,
                        Assign, name_args, write)
 
 from collections import namedtuple
@@ -104,82 +104,103 @@ def is_aot_rtc(meta):
 #
 
 
+# keep in sync with FUNCTION_POOL_MAX_FACTORS in function_pool.h
+FUNCTION_POOL_MAX_FACTORS = 16
+
+
 @name_args(['function'])
-class FFTKernel(BaseNode):
+class FunctionPoolEntry(BaseNode):
+    """Aggregate initializer for one function_pool_entry."""
+
+    precisions = {
+        'sp': 'rocfft_precision_single',
+        'dp': 'rocfft_precision_double',
+        'half': 'rocfft_precision_half',
+    }
+
+    def lengths(self):
+        length = self.function.meta.length
+        if isinstance(length, (int, str)):
+            return [length, 0]
+        return list(length)
 
     def __str__(self):
-        aot_rtc = is_aot_rtc(self.function.meta)
-        f = 'FFTKernel('
-        if self.function.meta.runtime_compile or aot_rtc:
-            f += 'nullptr'
+        meta = self.function.meta
+        aot_rtc = is_aot_rtc(meta)
+        length = self.lengths()
+
+        if meta.runtime_compile or aot_rtc:
+            fn = 'nullptr'
         else:
-            f += str(self.function.address())
-        use_3steps_large_twd = getattr(self.function.meta,
-                                       'use_3steps_large_twd', None)
+            fn = str(self.function.address())
+        use_3steps_large_twd = getattr(meta, 'use_3steps_large_twd', None)
         # assume half-precision needs the same thing as single
-        precision = 'sp' if self.function.meta.precision == 'half' else self.function.meta.precision
+        precision = 'sp' if meta.precision == 'half' else meta.precision
+        use_3steps = 'false'
         if use_3steps_large_twd is not None:
-            f += ', ' + str(use_3steps_large_twd[precision])
-        else:
-            f += ', false'
-        factors = getattr(self.function.meta, 'factors', None)
-        if factors is not None:
-            f += ', {' + cjoin(factors) + '}'
-        transforms_per_block = getattr(self.function.meta,
-                                       'transforms_per_block', None)
-        if transforms_per_block is not None:
-            f += ', ' + str(transforms_per_block)
-        workgroup_size = getattr(self.function.meta, 'workgroup_size', None)
-        if workgroup_size is not None:
-            f += ', ' + str(workgroup_size)
-        f += ', {' + ','.join(
-            [str(s) for s in self.function.meta.threads_per_transform]) + '}'
-        direct_to_from_reg = None
+            use_3steps = str(use_3steps_large_twd[precision])
+
+        factors = getattr(meta, 'factors', [])
+        if len(factors) > FUNCTION_POOL_MAX_FACTORS:
+            sys.exit(f"too many factors for function pool: {factors}")
+
         half_lds = None
-        if hasattr(self.function.meta, 'params'):
-            half_lds = getattr(self.function.meta.params, 'half_lds', None)
-            direct_to_from_reg = getattr(self.function.meta.params,
-                                         'direct_to_from_reg', None)
-        if half_lds is not None:
-            f += ', ' + str(half_lds).lower()
-        if direct_to_from_reg is not None:
-            f += ', ' + str(direct_to_from_reg).lower()
-        f += ', '
-        if aot_rtc:
-            f += 'true'
-        else:
-            f += 'false'
-        f += ')'
-        return f
+        direct_to_from_reg = None
+        if hasattr(meta, 'params'):
+            half_lds = getattr(meta.params, 'half_lds', None)
+            direct_to_from_reg = getattr(meta.params, 'direct_to_from_reg',
+                                         None)
+
+        fields = [
+            '{' + cjoin(length) + '}',
+            self.precisions[meta.precision],
+            meta.scheme,
+            meta.transpose or 'NONE',
+            fn,
+            use_3steps,
+            str(len(factors)),
+            '{' + cjoin(factors) + '}',
+            str(getattr(meta, 'transforms_per_block', 0)),
+            str(getattr(meta, 'workgroup_size', 0)),
+            '{' + cjoin(meta.threads_per_transform) + '}',
+            str(bool(half_lds)).lower(),
+            str(bool(direct_to_from_reg)).lower(),
+            str(aot_rtc).lower(),
+        ]
+        return '{' + ', '.join(fields) + '}'
+
+
+@name_args(['name', 'entries'])
+class FunctionPoolTable(BaseNode):
+    """Constant table of function pool entries."""
+
+    def __str__(self):
+        return ('static const function_pool_entry ' + self.name + '[] = {' +
+                ','.join([str(e) for e in self.entries]) + '};')
 
 
 def generate_cpu_function_pool(functions):
-    """Generate function to populate the kernel function pool."""
+    """Generate the table of kernels in the function pool.
 
-    function_map = Map('function_map')
-    precisions = {
-        'sp': 'rocfft_precision_single',
-        'dp': 'rocfft_precision_double',
-        'half': 'rocfft_precision_half',
-    }
-    var_kernel = Variable('kernel', 'FFTKernel')
+    The table is constant-initialized, so nothing runs at library
+    load.  Entries are sorted by length so the pool can binary search
+    it, and are only turned into FFTKernels when first looked up.
+    """
+
+    entries = [FunctionPoolEntry(f) for f in functions]
+    # sort is stable, so a repeated key resolves to the first kernel
+    # generated for it, as when entries were inserted one by one
+    entries.sort(key=lambda e: [int(x) for x in e.lengths()])
+    table = Variable('function_pool_table')
 
     populate = StatementList()
-    populate += var_kernel.declaration()
-    for f in functions:
-        length, precision, scheme, transpose = f.meta.length, f.meta.precision, f.meta.scheme, f.meta.transpose
-        if isinstance(length, (int, str)):
-            length = [length, 0]
-        populate += Assign(var_kernel, FFTKernel(f))
-        key = Call(
-            name='FMKey',
-            arguments=ArgumentList(length[0], length[1], precisions[precision],
-                                   scheme, transpose or 'NONE',
-                                   'kernel.get_kernel_config()')).inline()
-        populate += function_map.assert_insert(key, var_kernel)
+    populate += Assign(Variable('generated_begin'), table)
+    populate += Assign(Variable('generated_end'),
+                       Add(table, str(len(entries))))
 
     return StatementList(
         Include('"../include/function_pool.h"'),
+        FunctionPoolTable(str(table), entries),
         Function(name='function_pool::function_pool',
                  value=False,
                  arguments=ArgumentList(),
@@ -242,42 +263,59 @@ def list_small_kernels():
         NS(length=  13, workgroup_size= 64, threads_per_transform=  1, factors=(13,), runtime_compile=True),
         NS(length=  14, workgroup_size=128, threads_per_transform=  7, factors=(7, 2), runtime_compile=True),
         NS(length=  15, workgroup_size=128, threads_per_transform=  5, factors=(3, 5), runtime_compile=True),
-        NS(length=  16, workgroup_size= 64, threads_per_transform=  4, factors=(4, 4), runtime_compile=True),
+        NS(length=  16, workgroup_size= 64, threads_per_transform=  1, factors=(4, 4), runtime_compile=True),
         NS(length=  17, workgroup_size=256, threads_per_transform=  1, factors=(17,), runtime_compile=True),
         NS(length=  18, workgroup_size= 64, threads_per_transform=  6, factors=(3, 6), runtime_compile=True),
+        NS(length=  19, workgroup_size=128, threads_per_transform=  1, factors=(19,), runtime_compile=True),
         NS(length=  20, workgroup_size=256, threads_per_transform= 10, factors=(5, 4), runtime_compile=True),
         NS(length=  21, workgroup_size=128, threads_per_transform=  7, factors=(3, 7), runtime_compile=True),
         NS(length=  22, workgroup_size= 64, threads_per_transform=  2, factors=(11, 2), runtime_compile=True),
+        NS(length=  23, workgroup_size=128, threads_per_transform=  1, factors=(23,), runtime_compile=True),
         NS(length=  24, workgroup_size=256, threads_per_transform=  8, factors=(8, 3), runtime_compile=True),
         NS(length=  25, workgroup_size=256, threads_per_transform=  5, factors=(5, 5), runtime_compile=True),
         NS(length=  26, workgroup_size= 64, threads_per_transform=  2, factors=(13, 2), runtime_compile=True),
         NS(length=  27, workgroup_size=256, threads_per_transform=  9, factors=(3, 3, 3), runtime_compile=True),
         NS(length=  28, workgroup_size= 64, threads_per_transform=  4, factors=(7, 4), runtime_compile=True),
+        NS(length=  29, workgroup_size= 64, threads_per_transform=  1, factors=(29,), runtime_compile=True),
         NS(length=  30, workgroup_size=128, threads_per_transform= 10, factors=(10, 3), runtime_compile=True),
-        NS(length=  32, workgroup_size=128, threads_per_transform= 16, factors=(8, 4)),
+        NS(length=  31, workgroup_size= 64, threads_per_transform=  1, factors=(31,), runtime_compile=True),
+        NS(length=  32, workgroup_size= 64, threads_per_transform=  1, factors=(8, 4)),
         NS(length=  33, workgroup_size=256, threads_per_transform= 11, factors=(11, 3), runtime_compile=True),
         NS(length=  34, workgroup_size=256, threads_per_transform= 17, factors=(17, 2), runtime_compile=True),
         NS(length=  35, workgroup_size=256, threads_per_transform=  7, factors=(5, 7), half_lds=False, runtime_compile=True),
         NS(length=  36, workgroup_size= 64, threads_per_transform=  6, factors=(6, 6)),
+        NS(length=  37, workgroup_size= 64, threads_per_transform=  1, factors=(37,), runtime_compile=True),
+        NS(length=  38, workgroup_size=128, threads_per_transform= 19, factors=(19, 2), runtime_compile=True),
         NS(length=  39, workgroup_size=256, threads_per_transform= 13, factors=(13, 3), runtime_compile=True),
         NS(length=  40, workgroup_size=128, threads_per_transform= 10, factors=(10, 4)),
+        NS(length=  41, workgroup_size= 64, threads_per_transform=  1, factors=(41,), runtime_compile=True),
         NS(length=  42, workgroup_size=256, threads_per_transform=  7, factors=(7, 6)),
+        NS(length=  43, workgroup_size= 64, threads_per_transform=  1, factors=(43,), runtime_compile=True),
         NS(length=  44, workgroup_size= 64, threads_per_transform=  4, factors=(11, 4)),
         NS(length=  45, workgroup_size=128, threads_per_transform= 15, factors=(5, 3, 3)),
+        NS(length=  46, workgroup_size=128, threads_per_transform= 23, factors=(23, 2), runtime_compile=True),
+        NS(length=  47, workgroup_size= 64, threads_per_transform=  1, factors=(47,), runtime_compile=True),
         NS(length=  48, workgroup_size= 64, threads_per_transform= 16, factors=(4, 3, 4)),
         NS(length=  49, workgroup_size= 64, threads_per_transform=  7, factors=(7, 7)),
         NS(length=  50, workgroup_size=256, threads_per_transform= 10, factors=(10, 5)),
         NS(length=  51, workgroup_size=256, threads_per_transform= 17, factors=(17, 3), runtime_compile=True),
         NS(length=  52, workgroup_size= 64, threads_per_transform=  4, factors=(13, 4)),
+        NS(length=  53, workgroup_size= 64, threads_per_transform=  1, factors=(53,), runtime_compile=True),
         NS(length=  54, workgroup_size=256, threads_per_transform= 18, factors=(6, 3, 3)),
         NS(length=  55, workgroup_size=256, threads_per_transform= 11, factors=(5, 11), half_lds=False, runtime_compile=True),
         NS(length=  56, workgroup_size=128, threads_per_transform=  8, factors=(7, 8)),
+        NS(length=  57, workgroup_size=128, threads_per_transform= 19, factors=(19, 3), runtime_compile=True),
+        NS(length=  58, workgroup_size=128, threads_per_transform= 29, factors=(29, 2), runtime_compile=True),
+        NS(length=  59, workgroup_size= 64, threads_per_transform=  1, factors=(59,), runtime_compile=True),
         NS(length=  60, workgroup_size= 64, threads_per_transform= 10, factors=(6, 10)),
+        NS(length=  61, workgroup_size= 64, threads_per_transform=  1, factors=(61,), runtime_compile=True),
+        NS(length=  62, workgroup_size=128, threads_per_transform= 31, factors=(31, 2), runtime_compile=True),
         NS(length=  63, workgroup_size=256, threads_per_transform= 21, factors=(3, 3, 7), half_lds=False, runtime_compile=True),
         NS(length=  64, workgroup_size= 64, threads_per_transform= 16, factors=(4, 4, 4), half_lds=False, direct_to_from_reg=True),
         NS(length=  65, workgroup_size=256, threads_per_transform= 13, factors=(13, 5), runtime_compile=True),
         NS(length=  66, workgroup_size=256, threads_per_transform= 11, factors=(6, 11), half_lds=False, runtime_compile=True),
         NS(length=  68, workgroup_size=256, threads_per_transform= 17, factors=(17, 4), runtime_compile=True),
+        NS(length=  69, workgroup_size=128, threads_per_transform= 23, factors=(23, 3), runtime_compile=True),
         NS(length=  70, workgroup_size=256, threads_per_transform= 14, factors=(2, 5, 7), runtime_compile=True),
         NS(length=  72, workgroup_size= 64, threads_per_transform=  9, factors=(8, 3, 3)),
         NS(length=  75, workgroup_size=256, threads_per_transform= 25, factors=(5, 5, 3)),
@@ -287,9 +325,11 @@ def list_small_kernels():
         NS(length=  81, workgroup_size=128, threads_per_transform= 27, factors=(3, 3, 3, 3)),
         NS(length=  84, workgroup_size=128, threads_per_transform= 12, factors=(7, 2, 6)),
         NS(length=  85, workgroup_size=256, threads_per_transform= 17, factors=(17, 5), runtime_compile=True),
+        NS(length=  87, workgroup_size=128, threads_per_transform= 29, factors=(29, 3), runtime_compile=True),
         NS(length=  88, workgroup_size=128, threads_per_transform= 11, factors=(11, 8)),
         NS(length=  90, workgroup_size= 64, threads_per_transform=  9, factors=(3, 3, 10)),
         NS(length=  91, workgroup_size=256, threads_per_transform= 13, factors=(7, 13), half_lds=False, runtime_compile=True),
+        NS(length=  93, workgroup_size=128, threads_per_transform= 31, factors=(31, 3), runtime_compile=True),
         NS(length=  96, workgroup_size=128, threads_per_transform= 16, factors=(6, 16), half_lds=False, direct_to_from_reg=False),
         NS(length=  98, workgroup_size= 256, threads_per_transform= 14, factors=(2, 7, 7), half_lds=False, runtime_compile=True),
         NS(length=  99, workgroup_size= 256, threads_per_transform= 11, factors=(3, 3, 11), half_lds=False, runtime_compile=True),
@@ -300,6 +340,7 @@ def list_small_kernels():
         NS(length= 108, workgroup_size=256, threads_per_transform= 36, factors=(6, 6, 3)),
         NS(length= 110, workgroup_size=256, threads_per_transform= 11, factors=(2, 5, 11), half_lds=False, runtime_compile=True),
         NS(length= 112, workgroup_size=256, threads_per_transform= 16, factors=(16, 7), half_lds=False, direct_to_from_reg=False),
+        NS(length= 116, workgroup_size=128, threads_per_transform= 29, factors=(29, 4), runtime_compile=True),
         NS(length= 117, workgroup_size= 64, threads_per_transform= 13, factors=(13, 9), runtime_compile=True),
         NS(length= 119, workgroup_size=256, threads_per_transform= 17, factors=(17, 7), runtime_compile=True),
         NS(length= 120, workgroup_size= 64, threads_per_transform= 12, factors=(6, 10, 2), runtime_compile=True),
@@ -314,6 +355,7 @@ def list_small_kernels():
         NS(length= 162, workgroup_size=256, threads_per_transform= 27, factors=(6, 3, 3, 3), runtime_compile=True),
         NS(length= 168, workgroup_size=256, threads_per_transform= 56, factors=(8, 7, 3), half_lds=False, direct_to_from_reg=False),
         NS(length= 169, workgroup_size=256, threads_per_transform= 13, factors=(13, 13), runtime_compile=True),
+        NS(length= 174, workgroup_size=128, threads_per_transform= 29, factors=(29, 6), runtime_compile=True),
         NS(length= 176, workgroup_size= 64, threads_per_transform= 16, factors=(11, 16), runtime_compile=True),
         NS(length= 180, workgroup_size=256, threads_per_transform= 60, factors=(10, 6, 3), half_lds=False, direct_to_from_reg=False),
         NS(length= 192, workgroup_size=128, threads_per_transform= 16, factors=(6, 4, 4, 2)),
@@ -422,9 +464,35 @@ def list_small_kernels():
         NS(length=4096, workgroup_size=256, threads_per_transform=256, factors=(16, 16, 16), runtime_compile=True),
     ]
 
+    # Longer lengths only fit in LDS in single precision: 8192 points
+    # are 64 KiB, or 32 KiB with half_lds.  Plans only use these
+    # where the device's LDS per block fits them.
+    kernels1d_sp = [
+        NS(length=4320, workgroup_size=320, threads_per_transform=270, factors=(16, 10, 3, 3, 3), runtime_compile=True),
+        NS(length=4374, workgroup_size=512, threads_per_transform=486, factors=(6, 9, 9, 9), runtime_compile=True),
+        NS(length=4608, workgroup_size=320, threads_per_transform=288, factors=(16, 16, 2, 9), runtime_compile=True),
+        NS(length=5000, workgroup_size=512, threads_per_transform=500, factors=(10, 10, 10, 5), runtime_compile=True),
+        NS(length=5120, workgroup_size=320, threads_per_transform=320, factors=(16, 16, 10, 2), runtime_compile=True),
+        NS(length=5184, workgroup_size=384, threads_per_transform=324, factors=(16, 9, 6, 6), runtime_compile=True),
+        NS(length=5400, workgroup_size=576, threads_per_transform=540, factors=(10, 10, 6, 9), runtime_compile=True),
+        NS(length=6000, workgroup_size=640, threads_per_transform=600, factors=(10, 10, 10, 6), runtime_compile=True),
+        NS(length=6144, workgroup_size=384, threads_per_transform=384, factors=(16, 16, 8, 3), runtime_compile=True),
+        NS(length=6250, workgroup_size=640, threads_per_transform=625, factors=(10, 5, 5, 5, 5), runtime_compile=True),
+        NS(length=6400, workgroup_size=448, threads_per_transform=400, factors=(16, 10, 10, 4), runtime_compile=True),
+        NS(length=6561, workgroup_size=768, threads_per_transform=729, factors=(9, 9, 9, 9), runtime_compile=True),
+        NS(length=6912, workgroup_size=448, threads_per_transform=432, factors=(16, 16, 3, 9), runtime_compile=True),
+        NS(length=7200, workgroup_size=768, threads_per_transform=720, factors=(10, 10, 8, 9), runtime_compile=True),
+        NS(length=7776, workgroup_size=512, threads_per_transform=486, factors=(16, 9, 9, 6), runtime_compile=True),
+        NS(length=8000, workgroup_size=832, threads_per_transform=800, factors=(10, 10, 10, 8), runtime_compile=True),
+        NS(length=8192, workgroup_size=512, threads_per_transform=512, factors=(16, 16, 16, 2), runtime_compile=True),
+    ]
+
     kernels = [NS(**kernel.__dict__,
                   scheme='CS_KERNEL_STOCKHAM',
                   precision=['sp', 'dp']) for kernel in kernels1d]
+    kernels += [NS(**kernel.__dict__,
+                   scheme='CS_KERNEL_STOCKHAM',
+                   precision=['sp']) for kernel in kernels1d_sp]
 
     return kernels
 
@@ -482,6 +550,7 @@ def list_2d_kernels():
         NS(length=[16,81], factors=[[4,4],[3,3,3,3]], threads_per_transform=[4,27], workgroup_size=432),
         NS(length=[16,125], factors=[[4,4],[5,5,5]], threads_per_transform=[4,25], workgroup_size=500),
         NS(length=[16,128], factors=[[4,4],[8,4,4]], threads_per_transform=[4,16], workgroup_size=512),
+        NS(length=[16,256], factors=[[4,4],[4,4,4,4]], threads_per_transform=[4,64], workgroup_size=1024),
         NS(length=[25,4], factors=[[5,5],[2,2]], threads_per_transform=[5,2], workgroup_size=50),
         NS(length=[25,8], factors=[[5,5],[4,2]], threads_per_transform=[5,2], workgroup_size=50),
         NS(length=[25,9], factors=[[5,5],[3,3]], threads_per_transform=[5,3], workgroup_size=75),
@@ -520,6 +589,8 @@ def list_2d_kernels():
         NS(length=[64,25], factors=[[4,4,4],[5,5]], threads_per_transform=[16,5], workgroup_size=400),
         NS(length=[64,27], factors=[[4,4,4],[3,3,3]], threads_per_transform=[16,9], workgroup_size=576),
         NS(length=[64,32], factors=[[4,4,4],[8,4]], threads_per_transform=[16,4], workgroup_size=512),
+        NS(length=[64,64], factors=[[4,4,4],[4,4,4]], threads_per_transform=[16,16], workgroup_size=1024),
+        NS(length=[64,128], factors=[[8,8],[8,4,4]], threads_per_transform=[8,16], workgroup_size=1024),
         NS(length=[81,4], factors=[[3,3,3,3],[2,2]], threads_per_transform=[27,2], workgroup_size=162),
         NS(length=[81,8], factors=[[3,3,3,3],[4,2]], threads_per_transform=[27,2], workgroup_size=216),
         NS(length=[81,9], factors=[[3,3,3,3],[3,3]], threads_per_transform=[27,3], workgroup_size=243),
@@ -539,12 +610,14 @@ def list_2d_kernels():
         NS(length=[128,16], factors=[[8,4,4],[4,4]], threads_per_transform=[16,4], workgroup_size=512),
         NS(length=[128,25], factors=[[8,4,4],[5,5]], threads_per_transform=[16,5], workgroup_size=640),
         NS(length=[128,32], factors=[[8,4,4],[8,4]], threads_per_transform=[16,4], workgroup_size=512),
+        NS(length=[128,64], factors=[[8,4,4],[8,8]], threads_per_transform=[16,8], workgroup_size=1024),
         NS(length=[243,4], factors=[[3,3,3,3,3],[2,2]], threads_per_transform=[81,2], workgroup_size=486),
         NS(length=[243,8], factors=[[3,3,3,3,3],[4,2]], threads_per_transform=[81,2], workgroup_size=648),
         NS(length=[243,9], factors=[[3,3,3,3,3],[3,3]], threads_per_transform=[81,3], workgroup_size=729),
         NS(length=[256,4], factors=[[4,4,4,4],[2,2]], threads_per_transform=[64,2], workgroup_size=512),
         NS(length=[256,8], factors=[[4,4,4,4],[4,2]], threads_per_transform=[64,2], workgroup_size=512),
         NS(length=[256,9], factors=[[4,4,4,4],[3,3]], threads_per_transform=[64,3], workgroup_size=768),
+        NS(length=[256,16], factors=[[4,4,4,4],[4,4]], threads_per_transform=[64,4], workgroup_size=1024),
         # ----- new for r2c/c2r
         NS(length=[7,84], factors=[[7],[7,2,6]], threads_per_transform=[1,12], workgroup_size=84),
         NS(length=[84,7], factors=[[7,2,6],[7]], threads_per_transform=[12,1], workgroup_size=84),
@@ -664,8 +737,8 @@ def list_large_kernels():
             k.length = functools.reduce(lambda a, b: a * b, k.factors)
 
     # for SBRC, if direct_to_from_reg is True, we do store-from-reg, but will not do load-to-reg
-    #           And since SBRC is is dir-from-lds but NOT dir-to-reg, the global load part requires full LDS
-    #           So, SBRC is able to use half-lds.
+    #           With half_lds, the global load part is staged through LDS one component at a time.
+    #           Tuned solutions can enable that; the shipped kernels don't.
     sbrc_kernels = [
         NS(length=17,  factors=[17], scheme='CS_KERNEL_STOCKHAM_BLOCK_RC', workgroup_size=256, threads_per_transform=1, runtime_compile=True),
         NS(length=49,  factors=[7, 7], scheme='CS_KERNEL_STOCKHAM_BLOCK_RC', workgroup_size=196, threads_per_transform=7), # block_width=28
@@ -703,8 +776,8 @@ def list_large_kernels():
     #
 
     # for SBCR, if direct_to_from_reg is True, we do load-to-reg, but will not do store-from-reg
-    #           And since sbcr is dir-to-reg BUT NOT dir-from-reg, the global store part requires full LDS
-    #           So, we can't satifly half_lds in SBCR !
+    #           With half_lds, the global store part is staged through LDS one component at a time.
+    #           Tuned solutions can enable that; the shipped kernels don't.
     sbcr_kernels = [
         NS(length=56,  factors=[7, 8], direct_to_from_reg=False),
         NS(length=100, factors=[10, 10], workgroup_size=100),
@@ -747,6 +820,13 @@ def generate_kernel(kernel, precisions, stockham_aot):
 
     args = [stockham_aot]
     pre_enum = {'sp': 0, 'dp': 1}
+    # some kernels are only generated for some precisions
+    kernel_precisions = getattr(kernel, 'precision', precisions)
+    if not isinstance(kernel_precisions, list):
+        kernel_precisions = [kernel_precisions]
+    precisions = [p for p in precisions if p in kernel_precisions]
+    if not precisions:
+        return []
     # 2D single kernels always specify threads per transform
     if isinstance(kernel.length, list):
         args.append(','.join([str(f) for f in kernel.factors[0]]))
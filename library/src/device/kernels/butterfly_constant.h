@@ -353,5 +353,8 @@
 // butterfly radix-16 constants
 #define C16A static_cast<real_type_t<T>>(0.923879532511286738)
 #define C16B static_cast<real_type_t<T>>(0.382683432365089837)
+// tan(pi/8) and tan(3pi/8), for the split-radix radix-16 butterfly
+#define C16T1 static_cast<real_type_t<T>>(0.414213562373095048801688724209698)
+#define C16T3 static_cast<real_type_t<T>>(2.414213562373095048801688724209698)
 
 #endif //  BUTTERFLY_CONSTANT_H
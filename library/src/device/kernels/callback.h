@@ -38,6 +38,32 @@ struct UserCallbacks
     size_t store_cb_lds_bytes = 0;
 };
 
+// Kernels built with ROCFFT_NONTEMPORAL_STORES write output that
+// the rest of the plan doesn't read, so their default stores bypass
+// the caches.
+#ifdef ROCFFT_NONTEMPORAL_STORES
+template <typename T>
+__device__ void store_nontemporal(T* data, T element)
+{
+    __builtin_nontemporal_store(element, data);
+}
+
+template <typename Tfloat>
+__device__ void store_nontemporal(rocfft_complex<Tfloat>* data, rocfft_complex<Tfloat> element)
+{
+    __builtin_nontemporal_store(element.x, &data->x);
+    __builtin_nontemporal_store(element.y, &data->y);
+}
+#endif
+
+#ifdef USE_GFX_BUFFER_INTRINSIC
+#ifdef ROCFFT_NONTEMPORAL_STORES
+static const CacheOperation::Kind STORE_CACHE_OP = CacheOperation::Streaming;
+#else
+static const CacheOperation::Kind STORE_CACHE_OP = CacheOperation::Always;
+#endif
+#endif
+
 // default callback implementations that just do simple load/store
 template <typename T>
 __device__ T load_cb_default(T* data, size_t offset, void* cbdata, void* sharedMem)
@@ -48,7 +74,11 @@ __device__ T load_cb_default(T* data, size_t offset, void* cbdata, void* sharedM
 template <typename T>
 __device__ void store_cb_default(T* data, size_t offset, T element, void* cbdata, void* sharedMem)
 {
+#ifdef ROCFFT_NONTEMPORAL_STORES
+    store_nontemporal(data + offset, element);
+#else
     data[offset] = element;
+#endif
 }
 
 // callback function types
@@ -209,11 +239,11 @@ __device__ void
     store_intrinsic(T* data, unsigned int voffset, unsigned int soffset, T element, bool rw)
 {
 #ifdef USE_GFX_BUFFER_INTRINSIC
-    buffer_store<T, sizeof(T)>(element,
-                               reinterpret_cast<void*>(const_cast<T*>(data)),
-                               (uint32_t)(voffset * sizeof(T)),
-                               (uint32_t)(soffset * sizeof(T)),
-                               rw);
+    buffer_store<T, sizeof(T), STORE_CACHE_OP>(element,
+                                               reinterpret_cast<void*>(const_cast<T*>(data)),
+                                               (uint32_t)(voffset * sizeof(T)),
+                                               (uint32_t)(soffset * sizeof(T)),
+                                               rw);
 #else
     if(rw)
         data[soffset + voffset] = element;
@@ -229,16 +259,18 @@ __device__ void store_intrinsic_planar(Tfloat*                dataRe,
                                        bool                   rw)
 {
 #ifdef USE_GFX_BUFFER_INTRINSIC
-    buffer_store<Tfloat, sizeof(Tfloat)>(element.x,
-                                         reinterpret_cast<void*>(const_cast<Tfloat*>(dataRe)),
-                                         (uint32_t)(voffset * sizeof(Tfloat)),
-                                         (uint32_t)(soffset * sizeof(Tfloat)),
-                                         rw);
-    buffer_store<Tfloat, sizeof(Tfloat)>(element.y,
-                                         reinterpret_cast<void*>(const_cast<Tfloat*>(dataIm)),
-                                         (uint32_t)(voffset * sizeof(Tfloat)),
-                                         (uint32_t)(soffset * sizeof(Tfloat)),
-                                         rw);
+    buffer_store<Tfloat, sizeof(Tfloat), STORE_CACHE_OP>(
+        element.x,
+        reinterpret_cast<void*>(const_cast<Tfloat*>(dataRe)),
+        (uint32_t)(voffset * sizeof(Tfloat)),
+        (uint32_t)(soffset * sizeof(Tfloat)),
+        rw);
+    buffer_store<Tfloat, sizeof(Tfloat), STORE_CACHE_OP>(
+        element.y,
+        reinterpret_cast<void*>(const_cast<Tfloat*>(dataIm)),
+        (uint32_t)(voffset * sizeof(Tfloat)),
+        (uint32_t)(soffset * sizeof(Tfloat)),
+        rw);
 #else
     if(rw)
     {
@@ -262,13 +294,32 @@ enum struct CallbackType
     USER_LOAD_STORE_C2R,
 };
 
-// helpers to cast void* to the correct function pointer type
+// Callbacks given to the plan as source code are compiled into the
+// kernel.  The source and definitions of these wrappers that call
+// it are appended to the kernel source, after the kernel itself.
+#ifdef ROCFFT_INLINE_LOAD_CALLBACK
+template <typename T>
+__device__ T rocfft_inline_load_cb(T* data, size_t offset, void* cbdata, void* sharedMem);
+#endif
+#ifdef ROCFFT_INLINE_STORE_CALLBACK
+template <typename T>
+__device__ void
+    rocfft_inline_store_cb(T* data, size_t offset, T element, void* cbdata, void* sharedMem);
+#endif
+
+// helpers to cast void* to the correct function pointer type.
+// Inline callbacks ignore the pointer - returning a known function
+// lets the compiler inline the call.
 template <typename T, CallbackType cbtype>
 static __device__ typename callback_type<T>::load get_load_cb(void* ptr)
 {
 #ifdef ROCFFT_CALLBACKS_ENABLED
     if(cbtype != CallbackType::NONE)
+#ifdef ROCFFT_INLINE_LOAD_CALLBACK
+        return rocfft_inline_load_cb<T>;
+#else
         return reinterpret_cast<typename callback_type<T>::load>(ptr);
+#endif
 #endif
     return load_cb_default<T>;
 }
@@ -278,9 +329,40 @@ static __device__ typename callback_type<T>::store get_store_cb(void* ptr)
 {
 #ifdef ROCFFT_CALLBACKS_ENABLED
     if(cbtype != CallbackType::NONE)
+#ifdef ROCFFT_INLINE_STORE_CALLBACK
+        return rocfft_inline_store_cb<T>;
+#else
         return reinterpret_cast<typename callback_type<T>::store>(ptr);
+#endif
 #endif
     return store_cb_default<T>;
 }
 
+// planar helpers that run callbacks.  Callbacks on planar data are
+// real-valued, and are called once for the real part and once for
+// the imaginary part.
+template <CallbackType cbtype, typename Tfloat>
+__device__ rocfft_complex<Tfloat> load_planar_cb(
+    const Tfloat* dataRe, const Tfloat* dataIm, size_t offset, void* load_cb_fn, void* load_cb_data)
+{
+    auto load_cb = get_load_cb<Tfloat, cbtype>(load_cb_fn);
+    // callback might modify input, but it's otherwise const
+    return rocfft_complex<Tfloat>{
+        load_cb(const_cast<Tfloat*>(dataRe), offset, load_cb_data, nullptr),
+        load_cb(const_cast<Tfloat*>(dataIm), offset, load_cb_data, nullptr)};
+}
+
+template <CallbackType cbtype, typename Tfloat>
+__device__ void store_planar_cb(Tfloat*                dataRe,
+                                Tfloat*                dataIm,
+                                size_t                 offset,
+                                rocfft_complex<Tfloat> element,
+                                void*                  store_cb_fn,
+                                void*                  store_cb_data)
+{
+    auto store_cb = get_store_cb<Tfloat, cbtype>(store_cb_fn);
+    store_cb(dataRe, offset, element.x, store_cb_data, nullptr);
+    store_cb(dataIm, offset, element.y, store_cb_data, nullptr);
+}
+
 #endif
@@ -114,6 +114,9 @@ enum class EmbeddedType : int
     NONE        = 0, // Works as the regular complex to complex FFT kernel
     Real2C_POST = 1, // Works with even-length real2complex post-processing
     C2Real_PRE  = 2, // Works with even-length complex2real pre-processing
+    Real2C_ODD  = 3, // Odd-length real2complex: real input, Hermitian output
+    C2Real_ODD  = 4, // Odd-length complex2real: Hermitian input, real output
+    Real2Real   = 5, // DCT/DST: real input and output, pre/post-processed in LDS
 };
 
 // TODO: rework this
@@ -280,6 +283,346 @@ __device__ T TWLstep4(const T* twiddles, size_t u)
     return result;
 }
 
+template <typename T>
+__device__ T TWLstep5(const T* twiddles, size_t u)
+{
+    T result = TWLstep4(twiddles, u);
+    u >>= 32;
+    size_t j = u & 255;
+    result   = T((result.x * twiddles[1024 + j].x - result.y * twiddles[1024 + j].y),
+               (result.y * twiddles[1024 + j].x + result.x * twiddles[1024 + j].y));
+    return result;
+}
+
+// Order LDS accesses between the lanes of one wavefront.  This is
+// enough in place of __syncthreads when only threads in the same
+// wavefront share the LDS being accessed.
+__device__ inline void wave_lds_barrier()
+{
+#if defined(__HIP_PLATFORM_NVIDIA__)
+    __syncwarp();
+#elif defined(__HIP_DEVICE_COMPILE__)
+    __builtin_amdgcn_fence(__ATOMIC_RELEASE, "wavefront");
+    __builtin_amdgcn_wave_barrier();
+    __builtin_amdgcn_fence(__ATOMIC_ACQUIRE, "wavefront");
+#endif
+}
+
+// 128-bit global memory accesses of N contiguous complex elements,
+// for kernels whose threads each own a contiguous range of a
+// transform.  Callers check alignment before using them.
+template <typename T, size_t N>
+struct alignas(16) global_vector_t
+{
+    T data[N];
+};
+
+template <typename T>
+__device__ inline bool global_vector_aligned(const T* buf, size_t offset)
+{
+    return reinterpret_cast<uintptr_t>(buf + offset) % 16 == 0;
+}
+
+template <typename T>
+__device__ inline bool load_global_vector_aligned(const T* buf, size_t offset)
+{
+    return global_vector_aligned(buf, offset);
+}
+
+template <typename T>
+__device__ inline bool store_global_vector_aligned(const T* buf, size_t offset)
+{
+    return global_vector_aligned(buf, offset);
+}
+
+template <typename T>
+__device__ inline void load_global_vector(const T* buf, size_t index, T& r0, T& r1)
+{
+    static_assert(sizeof(global_vector_t<T, 2>) == 16, "not a 128-bit vector");
+    auto v = *reinterpret_cast<const global_vector_t<T, 2>*>(buf + index);
+    r0     = v.data[0];
+    r1     = v.data[1];
+}
+
+template <typename T>
+__device__ inline void
+    load_global_vector(const T* buf, size_t index, T& r0, T& r1, T& r2, T& r3)
+{
+    static_assert(sizeof(global_vector_t<T, 4>) == 16, "not a 128-bit vector");
+    auto v = *reinterpret_cast<const global_vector_t<T, 4>*>(buf + index);
+    r0     = v.data[0];
+    r1     = v.data[1];
+    r2     = v.data[2];
+    r3     = v.data[3];
+}
+
+// store one 128-bit vector.  Kernels whose output isn't read again
+// by the plan store it non-temporally, see callback.h.
+template <typename V>
+__device__ inline void store_global_vector_bits(void* dst, const V& v)
+{
+#ifdef ROCFFT_NONTEMPORAL_STORES
+    typedef unsigned int bits_t __attribute__((ext_vector_type(4)));
+    __builtin_nontemporal_store(*reinterpret_cast<const bits_t*>(&v),
+                                reinterpret_cast<bits_t*>(dst));
+#else
+    *reinterpret_cast<V*>(dst) = v;
+#endif
+}
+
+template <typename T>
+__device__ inline void store_global_vector(T* buf, size_t index, const T& r0, const T& r1)
+{
+    static_assert(sizeof(global_vector_t<T, 2>) == 16, "not a 128-bit vector");
+    store_global_vector_bits(buf + index, global_vector_t<T, 2>{{r0, r1}});
+}
+
+template <typename T>
+__device__ inline void store_global_vector(
+    T* buf, size_t index, const T& r0, const T& r1, const T& r2, const T& r3)
+{
+    static_assert(sizeof(global_vector_t<T, 4>) == 16, "not a 128-bit vector");
+    store_global_vector_bits(buf + index, global_vector_t<T, 4>{{r0, r1, r2, r3}});
+}
+
+// Multiply by a twiddle factor, or by its conjugate for inverse
+// transforms.  Half precision uses the packed complex product.
+template <typename T>
+__device__ inline T twiddle_multiply(const T& a, const T& w)
+{
+    return T(a.x * w.x - a.y * w.y, a.y * w.x + a.x * w.y);
+}
+
+template <typename T>
+__device__ inline T twiddle_multiply_conj(const T& a, const T& w)
+{
+    return T(a.x * w.x + a.y * w.y, a.y * w.x - a.x * w.y);
+}
+
+__device__ inline rocfft_complex<_Float16> twiddle_multiply(const rocfft_complex<_Float16>& a,
+                                                            const rocfft_complex<_Float16>& w)
+{
+    return a * w;
+}
+
+__device__ inline rocfft_complex<_Float16> twiddle_multiply_conj(
+    const rocfft_complex<_Float16>& a, const rocfft_complex<_Float16>& w)
+{
+    return a * rocfft_complex<_Float16>(w.x, -w.y);
+}
+
+// Direction-agnostic kernels compute forward transforms, and do an
+// inverse by conjugating what they load and store.
+template <typename T>
+__device__ inline T conjugate_if_inverse(const T& a, const int direction)
+{
+    return direction == 1 ? T(a.x, -a.y) : a;
+}
+
+// Storage-only element types for user data, kept as raw bits.
+// Kernels convert them to float to compute.
+__device__ inline uint16_t float_to_bfloat16(float v)
+{
+    uint32_t u = __float_as_uint(v);
+    // keep NaNs quiet, round everything else to nearest even
+    if((u & 0x7fffffff) > 0x7f800000)
+        return (u >> 16) | 0x40;
+    u += 0x7fff + ((u >> 16) & 1);
+    return u >> 16;
+}
+
+struct rocfft_bfloat16_t
+{
+    uint16_t bits;
+
+    rocfft_bfloat16_t() = default;
+    __device__ explicit rocfft_bfloat16_t(float v)
+        : bits(float_to_bfloat16(v))
+    {
+    }
+    __device__ explicit operator float() const
+    {
+        return __uint_as_float(static_cast<uint32_t>(bits) << 16);
+    }
+};
+
+// 8-bit floats with E exponent bits and M mantissa bits.  IEEE
+// formats reserve the largest exponent for infinities and NaNs,
+// others only reserve the all-ones encoding for NaN.  Values outside
+// of the finite range saturate.
+template <int E, int M, bool IEEE>
+__device__ inline float fp8_to_float(uint8_t b)
+{
+    const int bias = (1 << (E - 1)) - 1;
+    uint32_t  sign = static_cast<uint32_t>(b & 0x80) << 24;
+    int       e    = (b >> M) & ((1 << E) - 1);
+    uint32_t  m    = b & ((1 << M) - 1);
+
+    if(IEEE ? e == (1 << E) - 1 : (b & 0x7f) == 0x7f)
+        return __uint_as_float(sign | ((IEEE && m == 0) ? 0x7f800000 : 0x7fc00000));
+    if(e == 0)
+    {
+        float f = static_cast<float>(m) * ldexpf(1.0f, 1 - bias - M);
+        return sign ? -f : f;
+    }
+    return __uint_as_float(sign | static_cast<uint32_t>(e - bias + 127) << 23 | m << (23 - M));
+}
+
+template <int E, int M, bool IEEE>
+__device__ inline uint8_t float_to_fp8(float v)
+{
+    const int      bias     = (1 << (E - 1)) - 1;
+    const uint32_t max_code = IEEE ? (((1u << E) - 2) << M) | ((1u << M) - 1) : 0x7e;
+
+    uint32_t u    = __float_as_uint(v);
+    uint8_t  sign = (u >> 24) & 0x80;
+    u &= 0x7fffffff;
+    if(u > 0x7f800000)
+        return sign | 0x7f;
+
+    uint32_t code;
+    if(u < static_cast<uint32_t>(128 - bias) << 23)
+    {
+        // subnormal, count multiples of the smallest subnormal.
+        // rounding up to 2^M gives the smallest normal.
+        code = static_cast<uint32_t>(rintf(__uint_as_float(u) * ldexpf(1.0f, bias + M - 1)));
+    }
+    else
+    {
+        // rebias the exponent and round the mantissa to nearest
+        // even - a carry out of the mantissa increments the exponent
+        const int shift = 23 - M;
+        code            = ((u >> 23) - 127 + bias) << M | ((u >> shift) & ((1u << M) - 1));
+        uint32_t rem    = u & ((1u << shift) - 1);
+        uint32_t half   = 1u << (shift - 1);
+        if(rem > half || (rem == half && (code & 1)))
+            ++code;
+    }
+    return sign | (code > max_code ? max_code : code);
+}
+
+template <int E, int M, bool IEEE>
+struct rocfft_fp8_t
+{
+    uint8_t bits;
+
+    rocfft_fp8_t() = default;
+    __device__ explicit rocfft_fp8_t(float v)
+        : bits(float_to_fp8<E, M, IEEE>(v))
+    {
+    }
+    __device__ explicit operator float() const
+    {
+        return fp8_to_float<E, M, IEEE>(bits);
+    }
+};
+
+typedef rocfft_fp8_t<4, 3, false> rocfft_fp8_e4m3_t;
+typedef rocfft_fp8_t<5, 2, true>  rocfft_fp8_e5m2_t;
+
+// Conversions for user data that is stored in memory in a narrower
+// format than the kernel computes in.  Narrow formats are computed
+// in single precision.  Loads widen single values to the kernel's
+// precision after conversion.
+__device__ inline float from_storage(const float& v)
+{
+    return v;
+}
+
+__device__ inline float from_storage(const _Float16& v)
+{
+    return static_cast<float>(v);
+}
+
+__device__ inline float from_storage(const rocfft_bfloat16_t& v)
+{
+    return static_cast<float>(v);
+}
+
+template <int E, int M, bool IEEE>
+__device__ inline float from_storage(const rocfft_fp8_t<E, M, IEEE>& v)
+{
+    return static_cast<float>(v);
+}
+
+// integer samples (e.g. from an ADC) are converted without
+// normalization; an input scale factor can be set for that
+__device__ inline float from_storage(const int16_t& v)
+{
+    return static_cast<float>(v);
+}
+
+__device__ inline float from_storage(const int8_t& v)
+{
+    return static_cast<float>(v);
+}
+
+template <typename S>
+__device__ inline rocfft_complex<float> from_storage(const rocfft_complex<S>& v)
+{
+    return rocfft_complex<float>(from_storage(v.x), from_storage(v.y));
+}
+
+// convert a computed value to the element type of buf
+template <typename S, typename T>
+__device__ inline S to_storage(const S* buf, const T& v)
+{
+    return S(v);
+}
+
+template <typename S>
+__device__ inline auto load_storage(const S* buf, size_t index)
+{
+    return from_storage(buf[index]);
+}
+
+template <typename S, typename T>
+__device__ inline void store_storage(S* buf, size_t index, const T& v)
+{
+    buf[index] = to_storage(buf, v);
+}
+
+// Reductions of a complex result to one real value, for plans that
+// output a power or magnitude spectrum.  Half precision computes the
+// magnitude and log-power in single precision, since the power of
+// a value above 256 overflows FP16.
+template <typename T>
+__device__ inline real_type_t<T> output_power(const T& v)
+{
+    return v.x * v.x + v.y * v.y;
+}
+
+__device__ inline float output_magnitude(const rocfft_complex<float>& v)
+{
+    return sqrtf(output_power(v));
+}
+
+__device__ inline double output_magnitude(const rocfft_complex<double>& v)
+{
+    return sqrt(output_power(v));
+}
+
+__device__ inline _Float16 output_magnitude(const rocfft_complex<_Float16>& v)
+{
+    return static_cast<_Float16>(output_magnitude(rocfft_complex<float>(v.x, v.y)));
+}
+
+// power in decibels - a zero result gives -infinity
+__device__ inline float output_log_power(const rocfft_complex<float>& v)
+{
+    return 10.0f * log10f(output_power(v));
+}
+
+__device__ inline double output_log_power(const rocfft_complex<double>& v)
+{
+    return 10.0 * log10(output_power(v));
+}
+
+__device__ inline _Float16 output_log_power(const rocfft_complex<_Float16>& v)
+{
+    return static_cast<_Float16>(output_log_power(rocfft_complex<float>(v.x, v.y)));
+}
+
 #define TWIDDLE_STEP_MUL_FWD(TWFUNC, TWIDDLES, INDEX, REG) \
     {                                                      \
         T              W = TWFUNC(TWIDDLES, INDEX);        \
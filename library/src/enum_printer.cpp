@@ -72,7 +72,10 @@ static std::map<EmbeddedType, const char*> EBTypeToStrMap()
 {
     std::map<EmbeddedType, const char*> EBTypeToStr = {{EmbeddedType::NONE, "NONE"},
                                                        {EmbeddedType::Real2C_POST, "R2C_POST"},
-                                                       {EmbeddedType::C2Real_PRE, "C2R_PRE"}};
+                                                       {EmbeddedType::C2Real_PRE, "C2R_PRE"},
+                                                       {EmbeddedType::Real2C_ODD, "R2C_ODD"},
+                                                       {EmbeddedType::C2Real_ODD, "C2R_ODD"},
+                                                       {EmbeddedType::Real2Real, "R2R"}};
     return EBTypeToStr;
 }
 
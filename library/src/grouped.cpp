@@ -0,0 +1,362 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../shared/gpubuf.h"
+#include "../../shared/precision_type.h"
+#include "../../shared/rocfft_hip.h"
+#include "kernel_launch.h"
+#include "logging.h"
+#include "plan.h"
+#include "rocfft/rocfft.h"
+#include "rtc_stockham_kernel.h"
+#include "transform.h"
+#include "tree_node.h"
+
+// A grouped plan runs a batch of 1D transforms of different lengths,
+// each placed at its own offset in the buffers.
+//
+// Transforms are grouped into classes of the same length.  Each
+// class has one plan, and classes whose plan is a single Stockham
+// kernel run all of their transforms in one launch of a variant of
+// that kernel, which reads each transform's offsets from a table on
+// the device.  Other classes execute their plan once per transform.
+struct rocfft_grouped_plan_t
+{
+    // transforms of one length
+    struct LengthClass
+    {
+        rocfft_plan plan = nullptr;
+        // in and out offsets of each transform in the class
+        std::vector<size_t> inOffsets;
+        std::vector<size_t> outOffsets;
+
+        // grouped kernel that runs every transform in the class, and
+        // its offset tables: all input offsets followed by all output
+        // offsets.  Without a kernel, the plan is executed for each
+        // transform in turn.
+        std::unique_ptr<RTCKernel> kernel;
+        gpubuf_t<size_t>           offsetTable;
+    };
+
+    rocfft_grouped_plan_t() = default;
+    ~rocfft_grouped_plan_t();
+
+    rocfft_grouped_plan_t(const rocfft_grouped_plan_t&) = delete;
+    rocfft_grouped_plan_t& operator=(const rocfft_grouped_plan_t&) = delete;
+
+    int                     deviceId  = 0;
+    rocfft_result_placement placement = rocfft_placement_inplace;
+    rocfft_precision        precision = rocfft_precision_single;
+    rocfft_array_type       inArrayType;
+    rocfft_array_type       outArrayType;
+
+    std::vector<LengthClass> classes;
+
+    void Execute(void* in_buffer[], void* out_buffer[], rocfft_execution_info info);
+};
+
+rocfft_grouped_plan_t::~rocfft_grouped_plan_t()
+{
+    for(auto& c : classes)
+        rocfft_plan_destroy(c.plan);
+}
+
+// a class's transforms can all run in one launch if the plan is a
+// single Stockham kernel that reads from and writes to user buffers,
+// so that each transform's offsets are only used in one place
+static TreeNode* grouped_node(const rocfft_plan plan)
+{
+    if(plan->WorkBufBytes())
+        return nullptr;
+    auto execPlan = plan->SingleExecPlan();
+    if(!execPlan || execPlan->execSeq.size() != 1)
+        return nullptr;
+
+    auto node = execPlan->execSeq.front();
+    if(node->scheme != CS_KERNEL_STOCKHAM || node->ebtype != EmbeddedType::NONE
+       || node->fuseBlue != BFT_NONE || node->obIn != OB_USER_IN
+       || (node->obOut != OB_USER_OUT && node->obOut != OB_USER_IN))
+        return nullptr;
+    return node;
+}
+
+static void rocfft_grouped_class_create(rocfft_grouped_plan_t::LengthClass& c,
+                                        rocfft_result_placement             placement,
+                                        rocfft_transform_type               transform_type,
+                                        rocfft_precision                    precision,
+                                        size_t                              length)
+{
+    // grouped kernels are launched with the plan's batch, so try a
+    // plan for the whole class first
+    const size_t count = c.inOffsets.size();
+    if(rocfft_plan_create(&c.plan, placement, transform_type, precision, 1, &length, count, nullptr)
+       != rocfft_status_success)
+        throw std::runtime_error("failed to create grouped plan for length "
+                                 + std::to_string(length));
+    if(c.plan->WaitCreate() != rocfft_status_success)
+        throw std::runtime_error("failed to create grouped plan for length "
+                                 + std::to_string(length));
+
+    if(auto node = grouped_node(c.plan))
+    {
+        c.kernel = RTCKernelStockham::compile_grouped(
+            *node, c.plan->SingleExecPlan()->deviceProp.gcnArchName);
+        if(c.kernel)
+        {
+            std::vector<size_t> table = c.inOffsets;
+            table.insert(table.end(), c.outOffsets.begin(), c.outOffsets.end());
+            if(c.offsetTable.alloc(table.size() * sizeof(size_t)) != hipSuccess
+               || hipMemcpy(c.offsetTable.data(),
+                            table.data(),
+                            table.size() * sizeof(size_t),
+                            hipMemcpyHostToDevice)
+                      != hipSuccess)
+                throw std::runtime_error("failed to upload grouped offset table");
+
+            // the kernel reads tables from the plan, which must be
+            // ready before it is launched
+            c.plan->WaitTables();
+            return;
+        }
+    }
+
+    // otherwise, execute a single transform for each member
+    if(count == 1)
+        return;
+    rocfft_plan_destroy(c.plan);
+    c.plan = nullptr;
+    if(rocfft_plan_create(&c.plan, placement, transform_type, precision, 1, &length, 1, nullptr)
+           != rocfft_status_success
+       || c.plan->WaitCreate() != rocfft_status_success)
+        throw std::runtime_error("failed to create grouped plan for length "
+                                 + std::to_string(length));
+}
+
+void rocfft_grouped_plan_t::Execute(void*                 in_buffer[],
+                                    void*                 out_buffer[],
+                                    rocfft_execution_info info)
+{
+    const bool inplace = placement == rocfft_placement_inplace;
+    for(auto& c : classes)
+    {
+        if(!c.kernel)
+        {
+            for(size_t i = 0; i < c.inOffsets.size(); ++i)
+            {
+                void* in[1] = {ptr_offset(in_buffer[0], c.inOffsets[i], precision, inArrayType)};
+                void* out[1] = {nullptr};
+                if(!inplace)
+                    out[0] = ptr_offset(out_buffer[0], c.outOffsets[i], precision, outArrayType);
+                if(rocfft_execute(c.plan, in, inplace ? nullptr : out, info)
+                   != rocfft_status_success)
+                    throw std::runtime_error("failed to execute grouped transform");
+            }
+            continue;
+        }
+
+        auto  execPlan = c.plan->SingleExecPlan();
+        auto& gp       = execPlan->gridParam.front();
+
+        DeviceCallIn data;
+        data.node          = execPlan->execSeq.front();
+        data.bufIn[0]      = in_buffer[0];
+        data.bufOut[0]     = inplace ? in_buffer[0] : out_buffer[0];
+        data.gridParam     = gp;
+        data.deviceProp    = execPlan->deviceProp;
+        data.rocfft_stream = info ? info->rocfft_stream : nullptr;
+
+        auto kargs = c.kernel->get_launch_args(data);
+        kargs.append_ptr(c.offsetTable.data());
+        kargs.append_ptr(c.offsetTable.data() + c.inOffsets.size());
+        c.kernel->launch(kargs,
+                         {gp.b_x, gp.b_y, gp.b_z},
+                         {gp.wgs_x, gp.wgs_y, gp.wgs_z},
+                         gp.lds_bytes,
+                         execPlan->deviceProp,
+                         data.rocfft_stream);
+    }
+}
+
+rocfft_status rocfft_grouped_plan_create(rocfft_grouped_plan*    plan,
+                                         rocfft_result_placement placement,
+                                         rocfft_transform_type   transform_type,
+                                         rocfft_precision        precision,
+                                         size_t                  num_transforms,
+                                         const size_t*           lengths,
+                                         const size_t*           in_offsets,
+                                         const size_t*           out_offsets)
+{
+    log_trace(__func__,
+              "plan",
+              plan,
+              "placement",
+              placement,
+              "transform_type",
+              transform_type,
+              "precision",
+              precision,
+              "num_transforms",
+              num_transforms,
+              "lengths",
+              std::make_pair(lengths, num_transforms),
+              "in_offsets",
+              std::make_pair(in_offsets, num_transforms),
+              "out_offsets",
+              std::make_pair(out_offsets, num_transforms));
+
+    if(!plan || !num_transforms || !lengths || !in_offsets)
+        return rocfft_status_invalid_arg_value;
+    if(placement == rocfft_placement_notinplace && !out_offsets)
+        return rocfft_status_invalid_arg_value;
+
+    try
+    {
+        auto grouped       = std::make_unique<rocfft_grouped_plan_t>();
+        grouped->placement = placement;
+        grouped->precision = precision;
+        switch(transform_type)
+        {
+        case rocfft_transform_type_complex_forward:
+        case rocfft_transform_type_complex_inverse:
+            grouped->inArrayType  = rocfft_array_type_complex_interleaved;
+            grouped->outArrayType = rocfft_array_type_complex_interleaved;
+            break;
+        case rocfft_transform_type_real_forward:
+            grouped->inArrayType  = rocfft_array_type_real;
+            grouped->outArrayType = rocfft_array_type_hermitian_interleaved;
+            break;
+        case rocfft_transform_type_real_inverse:
+            grouped->inArrayType  = rocfft_array_type_hermitian_interleaved;
+            grouped->outArrayType = rocfft_array_type_real;
+            break;
+        default:
+            return rocfft_status_invalid_arg_value;
+        }
+        if(hipGetDevice(&grouped->deviceId) != hipSuccess)
+            return rocfft_status_failure;
+
+        // collect the transforms of each length, in the order they
+        // were given
+        std::map<size_t, size_t> classIdx;
+        for(size_t i = 0; i < num_transforms; ++i)
+        {
+            if(!lengths[i])
+                return rocfft_status_invalid_arg_value;
+            auto idx = classIdx.emplace(lengths[i], grouped->classes.size());
+            if(idx.second)
+                grouped->classes.emplace_back();
+            auto& c = grouped->classes[idx.first->second];
+            c.inOffsets.push_back(in_offsets[i]);
+            c.outOffsets.push_back(out_offsets ? out_offsets[i] : in_offsets[i]);
+        }
+
+        for(auto& idx : classIdx)
+            rocfft_grouped_class_create(
+                grouped->classes[idx.second], placement, transform_type, precision, idx.first);
+
+        *plan = grouped.release();
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_grouped_plan_get_work_buffer_size(const rocfft_grouped_plan plan,
+                                                       size_t*                   size_in_bytes)
+{
+    log_trace(__func__, "plan", plan, "size_in_bytes", size_in_bytes);
+
+    if(!plan || !size_in_bytes)
+        return rocfft_status_invalid_arg_value;
+
+    // classes run one after another, so they can share a buffer
+    *size_in_bytes = 0;
+    for(const auto& c : plan->classes)
+        *size_in_bytes = std::max(*size_in_bytes, c.plan->WorkBufBytes());
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_grouped_plan_execute(const rocfft_grouped_plan plan,
+                                          void*                     in_buffer[],
+                                          void*                     out_buffer[],
+                                          rocfft_execution_info     info)
+{
+    log_trace(__func__,
+              "plan",
+              plan,
+              "in_buffer",
+              in_buffer,
+              "out_buffer",
+              out_buffer,
+              "info",
+              info);
+
+    if(!plan || !in_buffer)
+        return rocfft_status_invalid_arg_value;
+    if(plan->placement == rocfft_placement_notinplace && !out_buffer)
+        return rocfft_status_invalid_arg_value;
+
+    try
+    {
+        rocfft_scoped_device dev(plan->deviceId);
+        plan->Execute(in_buffer, out_buffer, info);
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_grouped_plan_destroy(rocfft_grouped_plan plan)
+{
+    log_trace(__func__, "plan", plan);
+
+    if(!plan)
+        return rocfft_status_success;
+
+    try
+    {
+        rocfft_scoped_device dev(plan->deviceId);
+        delete plan;
+    }
+    catch(std::exception&)
+    {
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
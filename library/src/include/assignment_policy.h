@@ -115,6 +115,11 @@ public:
 
     void AssignBuffers(ExecPlan& execPlan);
 
+    // Apply an assignment that was recorded from an earlier plan
+    // for the same problem, instead of searching for one.  Returns
+    // false if the assignment does not fit the plan.
+    bool RestoreBuffers(ExecPlan& execPlan, const std::vector<NodeAssignment>& buffers);
+
     // pad temp buffers in a plan to avoid badly-performing strided accesses
     void PadPlan(ExecPlan& execPlan);
 
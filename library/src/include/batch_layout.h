@@ -0,0 +1,124 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_BATCH_LAYOUT_H
+#define ROCFFT_BATCH_LAYOUT_H
+
+#include <array>
+#include <vector>
+
+#include "../../../shared/array_predicate.h"
+#include "../../../shared/precision_type.h"
+#include "plan.h"
+
+// Describes the memory occupied by one side (input or output) of a
+// batched plan, so that a range of transforms in the batch can be
+// copied between buffers as one contiguous span.
+//
+// A range's span starts at the first element of its first transform,
+// so that copying it doesn't touch the plan's offset region or the
+// transforms before it.  Buffers that ranges are copied to keep the
+// plan's offsets.
+struct batch_layout_t
+{
+    rocfft_array_type   arrayType;
+    std::vector<size_t> length;
+    std::vector<size_t> stride;
+    size_t              dist;
+    // offset for each pointer (planar data has two)
+    std::array<size_t, 2> offset;
+    size_t                elem_size;
+
+    static batch_layout_t input(const rocfft_plan_t& plan)
+    {
+        return {plan.desc.inArrayType,
+                plan.lengths,
+                plan.desc.inStrides,
+                plan.desc.inDist,
+                plan.desc.inOffset,
+                element_size(plan.precision, plan.desc.inArrayType)};
+    }
+
+    static batch_layout_t output(const rocfft_plan_t& plan)
+    {
+        return {plan.desc.outArrayType,
+                plan.outputLengths,
+                plan.desc.outStrides,
+                plan.desc.outDist,
+                plan.desc.outOffset,
+                element_size(plan.precision, plan.desc.outArrayType)};
+    }
+
+    size_t num_pointers() const
+    {
+        return array_type_is_planar(arrayType) ? 2 : 1;
+    }
+
+    // elements covered by a single transform
+    size_t transform_span() const
+    {
+        size_t span = 1;
+        for(size_t i = 0; i < length.size(); ++i)
+            span += (length[i] - 1) * stride[i];
+        return span;
+    }
+
+    // true if the spans of consecutive transforms overlap, so that
+    // ranges of the batch can't be copied as separate spans without
+    // overwriting each other
+    bool transforms_overlap() const
+    {
+        return dist < transform_span();
+    }
+
+    // bytes spanned by count transforms
+    size_t span_bytes(size_t count) const
+    {
+        return ((count - 1) * dist + transform_span()) * elem_size;
+    }
+
+    // byte offset of a transform's first element in a user buffer
+    size_t span_start(size_t ptrIdx, size_t transform) const
+    {
+        return (transform * dist + offset[ptrIdx]) * elem_size;
+    }
+
+    // byte offset of a transform from the start of a user buffer,
+    // not counting the plan's offset, for running the plan on part
+    // of the batch in place
+    size_t transform_start(size_t transform) const
+    {
+        return transform * dist * elem_size;
+    }
+
+    // byte offset of the first transform in a buffer holding a range
+    size_t offset_bytes(size_t ptrIdx) const
+    {
+        return offset[ptrIdx] * elem_size;
+    }
+
+    // bytes of one pointer's buffer needed to hold count transforms
+    size_t buffer_bytes(size_t ptrIdx, size_t count) const
+    {
+        return offset_bytes(ptrIdx) + span_bytes(count);
+    }
+};
+
+#endif
@@ -0,0 +1,101 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef ROCFFT_CACHE_PREFETCH_H
+#define ROCFFT_CACHE_PREFETCH_H
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rocfft/rocfft.h"
+
+// A transform problem read from a prefetch manifest
+struct PrefetchProblem
+{
+    rocfft_transform_type   transformType = rocfft_transform_type_complex_forward;
+    rocfft_precision        precision     = rocfft_precision_single;
+    rocfft_result_placement placement     = rocfft_placement_inplace;
+    rocfft_array_type       inArrayType   = rocfft_array_type_unset;
+    rocfft_array_type       outArrayType  = rocfft_array_type_unset;
+
+    // lengths and strides are fastest dimension first, as passed to
+    // rocfft_plan_create
+    std::vector<size_t> lengths;
+    size_t              batch = 1;
+    std::vector<size_t> inStrides;
+    std::vector<size_t> outStrides;
+    size_t              inDist  = 0;
+    size_t              outDist = 0;
+    std::vector<size_t> inOffset;
+    std::vector<size_t> outOffset;
+
+    // parse one line of a manifest, either a rocfft-bench command
+    // line as logged by rocFFT's bench logging, or a test token.
+    // returns false if the line is not understood.
+    bool parse(const std::string& line);
+};
+
+// Warms up rocFFT's kernel caches in the background.
+//
+// Problems from a manifest are queued, and worker threads create and
+// immediately destroy a plan for each one.  Creating the plan
+// compiles or loads every kernel it needs, so a later
+// rocfft_plan_create for the same problem finds the kernels already
+// loaded.
+class CachePrefetcher
+{
+    CachePrefetcher() = default;
+
+public:
+    // prefetcher is a singleton, so no copying or assignment
+    CachePrefetcher(const CachePrefetcher&) = delete;
+    CachePrefetcher& operator=(const CachePrefetcher&) = delete;
+
+    static CachePrefetcher& GetPrefetcher()
+    {
+        static CachePrefetcher prefetcher;
+        return prefetcher;
+    }
+
+    // Queue the problems in a manifest (one per line, blank lines and
+    // lines starting with '#' are ignored) and start warming up on
+    // the current device.  Nothing is queued if any line fails to
+    // parse.
+    rocfft_status Prefetch(const std::string& manifest);
+
+    // Drop any problems that have not started yet and wait for the
+    // workers to finish.
+    void Stop();
+
+private:
+    void Worker();
+
+    // queued problems, with the device to create each plan on
+    std::deque<std::pair<int, PrefetchProblem>> queue;
+    std::vector<std::thread>                    workers;
+    std::mutex                                  mtx;
+};
+
+#endif
@@ -30,6 +30,4 @@ gpubuf chirp_create(size_t                 N,
                     unsigned int           deviceId,
                     const hipDeviceProp_t& deviceProp);
 
-void chirp_streams_cleanup();
-
 #endif // defined( CHIRP_H )
@@ -47,6 +47,16 @@ enum ComputeScheme
     CS_KERNEL_COPY_HERM_TO_CMPLX,
     CS_KERNEL_COPY_CMPLX_TO_R,
 
+    CS_REAL_TRANSFORM_PAIR,
+    CS_KERNEL_PAIR_R_TO_CMPLX,
+    CS_KERNEL_PAIR_CMPLX_TO_HERM,
+
+    CS_REAL_TRANSFORM_PACKED,
+    CS_KERNEL_PACK_HERM,
+    CS_KERNEL_UNPACK_HERM,
+
+    CS_REAL_TO_REAL,
+
     CS_REAL_TRANSFORM_EVEN,
     CS_KERNEL_R_TO_CMPLX,
     CS_KERNEL_R_TO_CMPLX_TRANSPOSE,
@@ -62,6 +72,12 @@ enum ComputeScheme
     CS_KERNEL_RES_MUL,
     CS_KERNEL_BLUESTEIN_SINGLE,
 
+    CS_RADER,
+    CS_KERNEL_RADER_CHIRP,
+    CS_KERNEL_RADER_GATHER,
+    CS_KERNEL_RADER_MUL,
+    CS_KERNEL_RADER_SCATTER,
+
     CS_L1D_TRTRT,
     CS_L1D_CC,
     CS_L1D_CRT,
@@ -79,7 +95,9 @@ enum ComputeScheme
     CS_3D_BLOCK_CR,
     CS_3D_RC,
     CS_KERNEL_3D_STOCKHAM_BLOCK_CC, // not implemented yet
-    CS_KERNEL_3D_SINGLE // not implemented yet
+    CS_KERNEL_3D_SINGLE,
+
+    CS_ND_RC
 };
 
 // print abbreviation for kernel scheme
@@ -33,9 +33,22 @@
 struct KernelConfig
 {
     bool                use_3steps_large_twd  = false;
+    // compute large twiddles in the kernel instead of reading a table
+    bool                compute_large_twd     = false;
     bool                half_lds              = false;
     bool                direct_to_from_reg    = false;
     bool                intrinsic_buffer_inst = false;
+    // evaluate radix-16 butterflies on matrix cores
+    bool                matrix_butterflies    = false;
+    // have each block of a 1D kernel work through two tiles of
+    // transforms, loading the next while computing the current
+    bool                pipelined_loads       = false;
+    // elements between the LDS padding elements of a 1D kernel, 0
+    // to not pad, or negative for the default for its length
+    int                 lds_bank_shift        = -1;
+    // read twiddles of a 1D kernel from a table of one octant of the
+    // unit circle, instead of the table stacked from its factors
+    bool                octant_twiddles       = false;
     unsigned int        transforms_per_block  = 0;
     int                 workgroup_size        = 0;
     std::array<int, 2>  threads_per_transform = {0, 0};
@@ -102,17 +115,27 @@ struct KernelConfig
     bool operator==(const KernelConfig& rhs) const
     {
         return std::tie(use_3steps_large_twd,
+                        compute_large_twd,
                         half_lds,
                         direct_to_from_reg,
                         intrinsic_buffer_inst,
+                        matrix_butterflies,
+                        pipelined_loads,
+                        lds_bank_shift,
+                        octant_twiddles,
                         transforms_per_block,
                         workgroup_size,
                         threads_per_transform,
                         factors)
                == std::tie(rhs.use_3steps_large_twd,
+                           rhs.compute_large_twd,
                            rhs.half_lds,
                            rhs.direct_to_from_reg,
                            rhs.intrinsic_buffer_inst,
+                           rhs.matrix_butterflies,
+                           rhs.pipelined_loads,
+                           rhs.lds_bank_shift,
+                           rhs.octant_twiddles,
                            rhs.transforms_per_block,
                            rhs.workgroup_size,
                            rhs.threads_per_transform,
@@ -122,17 +145,27 @@ struct KernelConfig
     bool operator<(const KernelConfig& rhs) const
     {
         return std::tie(use_3steps_large_twd,
+                        compute_large_twd,
                         half_lds,
                         direct_to_from_reg,
                         intrinsic_buffer_inst,
+                        matrix_butterflies,
+                        pipelined_loads,
+                        lds_bank_shift,
+                        octant_twiddles,
                         transforms_per_block,
                         workgroup_size,
                         threads_per_transform,
                         factors)
                < std::tie(rhs.use_3steps_large_twd,
+                          rhs.compute_large_twd,
                           rhs.half_lds,
                           rhs.direct_to_from_reg,
                           rhs.intrinsic_buffer_inst,
+                          rhs.matrix_butterflies,
+                          rhs.pipelined_loads,
+                          rhs.lds_bank_shift,
+                          rhs.octant_twiddles,
                           rhs.transforms_per_block,
                           rhs.workgroup_size,
                           rhs.threads_per_transform,
@@ -145,9 +178,14 @@ struct KernelConfig
         ss << "KernelConfig: {";
 
         ss << "3steps: " << (use_3steps_large_twd ? "true" : "false")
+           << ", ltwd_compute: " << (compute_large_twd ? "true" : "false")
            << ", half_lds: " << (half_lds ? "true" : "false")
            << ", direct_reg: " << (direct_to_from_reg ? "true" : "false")
            << ", try_use_buf_inst: " << (intrinsic_buffer_inst ? "true" : "false")
+           << ", matrix_bfly: " << (matrix_butterflies ? "true" : "false")
+           << ", pipelined: " << (pipelined_loads ? "true" : "false")
+           << ", lds_shift: " << lds_bank_shift
+           << ", octant_twd: " << (octant_twiddles ? "true" : "false")
            << ", tpb: " << transforms_per_block << ", wgs: " << workgroup_size << ", tpt: ["
            << threads_per_transform[0] << "," << threads_per_transform[1] << "], factors: [";
 
@@ -181,9 +219,14 @@ namespace std
         {
             size_t h = 0;
             h ^= std::hash<bool>{}(config.use_3steps_large_twd);
+            h ^= std::hash<bool>{}(config.compute_large_twd);
             h ^= std::hash<bool>{}(config.half_lds);
             h ^= std::hash<bool>{}(config.direct_to_from_reg);
             h ^= std::hash<bool>{}(config.intrinsic_buffer_inst);
+            h ^= std::hash<bool>{}(config.matrix_butterflies);
+            h ^= std::hash<bool>{}(config.pipelined_loads);
+            h ^= std::hash<int>{}(config.lds_bank_shift);
+            h ^= std::hash<bool>{}(config.octant_twiddles);
             h ^= std::hash<unsigned int>{}(config.transforms_per_block);
             h ^= std::hash<int>{}(config.workgroup_size);
             for(auto& v : config.threads_per_transform)
@@ -212,9 +255,14 @@ struct ToString<KernelConfig>
         std::vector<int> tpt = {value.threads_per_transform[0], value.threads_per_transform[1]};
 
         str += FieldDescriptor<bool>().describe("use_3steps", value.use_3steps_large_twd) + ",";
+        str += FieldDescriptor<bool>().describe("ltwd_compute", value.compute_large_twd) + ",";
         str += FieldDescriptor<bool>().describe("half_lds", value.half_lds) + ",";
         str += FieldDescriptor<bool>().describe("dir_reg", value.direct_to_from_reg) + ",";
         str += FieldDescriptor<bool>().describe("buffer_inst", value.intrinsic_buffer_inst) + ",";
+        str += FieldDescriptor<bool>().describe("matrix_bfly", value.matrix_butterflies) + ",";
+        str += FieldDescriptor<bool>().describe("pipelined", value.pipelined_loads) + ",";
+        str += FieldDescriptor<int>().describe("lds_shift", value.lds_bank_shift) + ",";
+        str += FieldDescriptor<bool>().describe("octant_twd", value.octant_twiddles) + ",";
         str += FieldDescriptor<unsigned int>().describe("tpb", value.transforms_per_block) + ",";
         str += FieldDescriptor<int>().describe("wgs", value.workgroup_size) + ",";
         str += VectorFieldDescriptor<int>().describe("tpt", tpt) + ",";
@@ -245,9 +293,24 @@ struct FromString<KernelConfig>
         std::string      ebTypeStr, placementStr, iAryTypeStr, oAryTypeStr;
 
         FieldParser<bool>().parse("use_3steps", ret.use_3steps_large_twd, current);
+        // (version >= 5) can compute large twiddles in the kernel
+        if(DescriptorFormatVersion::UsingVersion >= 5)
+            FieldParser<bool>().parse("ltwd_compute", ret.compute_large_twd, current);
         FieldParser<bool>().parse("half_lds", ret.half_lds, current);
         FieldParser<bool>().parse("dir_reg", ret.direct_to_from_reg, current);
         FieldParser<bool>().parse("buffer_inst", ret.intrinsic_buffer_inst, current);
+        // (version >= 6) can evaluate butterflies on matrix cores
+        if(DescriptorFormatVersion::UsingVersion >= 6)
+            FieldParser<bool>().parse("matrix_bfly", ret.matrix_butterflies, current);
+        // (version >= 7) can pipeline global loads across tiles
+        if(DescriptorFormatVersion::UsingVersion >= 7)
+            FieldParser<bool>().parse("pipelined", ret.pipelined_loads, current);
+        // (version >= 8) can choose how LDS is padded
+        if(DescriptorFormatVersion::UsingVersion >= 8)
+            FieldParser<int>().parse("lds_shift", ret.lds_bank_shift, current);
+        // (version >= 9) can read twiddles from one octant
+        if(DescriptorFormatVersion::UsingVersion >= 9)
+            FieldParser<bool>().parse("octant_twd", ret.octant_twiddles, current);
         FieldParser<size_t>().parse("tpb", tpb, current);
 
         FieldParser<int>().parse("wgs", ret.workgroup_size, current);
@@ -380,7 +443,8 @@ static void GetKernelToken(const FMKey& key, std::string& min_token)
 
     min_token += "_len";
     min_token += std::to_string(key.lengths[0]);
-    if(key.scheme == CS_KERNEL_2D_SINGLE)
+    if(key.scheme == CS_KERNEL_2D_SINGLE || key.scheme == CS_KERNEL_TRANSPOSE
+       || key.scheme == CS_KERNEL_TRANSPOSE_XY_Z || key.scheme == CS_KERNEL_TRANSPOSE_Z_XY)
         min_token += "x" + std::to_string(key.lengths[1]);
 
     min_token += "_" + PrintPrecision(key.precision);
@@ -23,9 +23,12 @@
 #ifndef FUNCTION_POOL_H
 #define FUNCTION_POOL_H
 
+#include "../../../shared/precision_type.h"
 #include "../../../shared/rocfft_complex.h"
 #include "../device/kernels/common.h"
 #include "tree_node.h"
+#include <algorithm>
+#include <mutex>
 #include <sstream>
 #include <unordered_map>
 
@@ -58,11 +61,20 @@ struct FFTKernel
     // otherwise second dim's threads will be 0
     std::array<int, 2> threads_per_transform = {0, 0};
     bool               use_3steps_large_twd  = false;
+    bool               compute_large_twd     = false;
     bool               half_lds              = false;
     bool               direct_to_from_reg    = false;
+    bool               matrix_butterflies    = false;
+    bool               pipelined_loads       = false;
+    // see KernelConfig::lds_bank_shift
+    int  lds_bank_shift  = -1;
+    bool octant_twiddles = false;
     // true if this kernel is compiled ahead of time (i.e. at library
     // build time), using runtime compilation.
     bool aot_rtc = false;
+    // true if this kernel was derived at runtime from another
+    // scheme's kernel instead of being generated for its own scheme
+    bool derived = false;
 
     FFTKernel()                 = default;
     FFTKernel(const FFTKernel&) = default;
@@ -96,8 +108,13 @@ struct FFTKernel
         , workgroup_size(config.workgroup_size)
         , threads_per_transform(config.threads_per_transform)
         , use_3steps_large_twd(config.use_3steps_large_twd)
+        , compute_large_twd(config.compute_large_twd)
         , half_lds(config.half_lds)
         , direct_to_from_reg(config.direct_to_from_reg)
+        , matrix_butterflies(config.matrix_butterflies)
+        , pipelined_loads(config.pipelined_loads)
+        , lds_bank_shift(config.lds_bank_shift)
+        , octant_twiddles(config.octant_twiddles)
     {
     }
 
@@ -108,14 +125,63 @@ struct FFTKernel
         config.workgroup_size        = workgroup_size;
         config.threads_per_transform = threads_per_transform;
         config.use_3steps_large_twd  = use_3steps_large_twd;
+        config.compute_large_twd     = compute_large_twd;
         config.half_lds              = half_lds;
         config.direct_to_from_reg    = direct_to_from_reg;
+        config.matrix_butterflies    = matrix_butterflies;
+        config.pipelined_loads       = pipelined_loads;
+        config.lds_bank_shift        = lds_bank_shift;
+        config.octant_twiddles       = octant_twiddles;
         config.factors               = factors;
 
         return config;
     }
 };
 
+// keep in sync with FUNCTION_POOL_MAX_FACTORS in kernel-generator.py
+static const unsigned int FUNCTION_POOL_MAX_FACTORS = 16;
+
+// A kernel generated by kernel-generator.py.  Entries are plain
+// constants, so the generated table is initialized without running
+// any code at library load.
+struct function_pool_entry
+{
+    size_t              lengths[2];
+    rocfft_precision    precision;
+    ComputeScheme       scheme;
+    SBRC_TRANSPOSE_TYPE sbrcTrans;
+    DevFnCall           device_function;
+    bool                use_3steps_large_twd;
+    unsigned int        num_factors;
+    size_t              factors[FUNCTION_POOL_MAX_FACTORS];
+    int                 transforms_per_block;
+    int                 workgroup_size;
+    int                 threads_per_transform[2];
+    bool                half_lds;
+    bool                direct_to_from_reg;
+    bool                aot_rtc;
+
+    bool matches(const FMKey& key) const
+    {
+        return lengths[0] == key.lengths[0] && lengths[1] == key.lengths[1]
+               && precision == key.precision && scheme == key.scheme
+               && sbrcTrans == key.sbrcTrans;
+    }
+
+    FFTKernel kernel() const
+    {
+        return FFTKernel(device_function,
+                         use_3steps_large_twd,
+                         std::vector<size_t>(factors, factors + num_factors),
+                         transforms_per_block,
+                         workgroup_size,
+                         {threads_per_transform[0], threads_per_transform[1]},
+                         half_lds,
+                         direct_to_from_reg,
+                         aot_rtc);
+    }
+};
+
 class function_pool
 {
     // when AOT generator adds a default key-kernel,
@@ -124,25 +190,113 @@ class function_pool
     std::unordered_map<FMKey, FMKey, SimpleHash>     def_key_pool;
     std::unordered_map<FMKey, FFTKernel, SimpleHash> function_map;
 
+    // table of generated kernels, sorted by length.  Entries are
+    // only added to the maps above the first time they're looked up.
+    const function_pool_entry* generated_begin = nullptr;
+    const function_pool_entry* generated_end   = nullptr;
+
+    // lookups can add entries to the maps, and plans are created
+    // from many threads at once
+    std::mutex mutex;
+
     ROCFFT_DEVICE_EXPORT function_pool();
 
 private:
-    static const FMKey& get_actual_key(const FMKey& key)
+    // orders generated entries by length, for binary searching
+    struct generated_less
+    {
+        using lengths_t = std::array<size_t, 2>;
+        bool operator()(const function_pool_entry& e, const lengths_t& l) const
+        {
+            return std::lexicographical_compare(e.lengths, e.lengths + 2, l.begin(), l.end());
+        }
+        bool operator()(const lengths_t& l, const function_pool_entry& e) const
+        {
+            return std::lexicographical_compare(l.begin(), l.end(), e.lengths, e.lengths + 2);
+        }
+    };
+
+    // generated entries with the same lengths as the key
+    std::pair<const function_pool_entry*, const function_pool_entry*>
+        generated_range(const FMKey& key) const
+    {
+        return std::equal_range(generated_begin, generated_end, key.lengths, generated_less());
+    }
+
+    const function_pool_entry* find_generated(const FMKey& key) const
+    {
+        auto range = generated_range(key);
+        auto entry = std::find_if(range.first, range.second, [&key](const auto& e) {
+            return e.matches(key);
+        });
+        return entry == range.second ? nullptr : entry;
+    }
+
+    // Add the default kernel for a key to the maps, if it's not there
+    // already.  Returns false if there is no such kernel.
+    bool materialize(const FMKey& key)
     {
-        function_pool& func_pool = get_function_pool();
+        FMKey simple_key(key);
+        simple_key.kernel_config = KernelConfig::EmptyConfig();
+        if(def_key_pool.count(simple_key))
+            return true;
+
+        auto range = generated_range(simple_key);
+        bool found = false;
+        for(auto e = range.first; e != range.second; ++e)
+        {
+            if(!e->matches(simple_key))
+                continue;
+            auto kernel = e->kernel();
+            insert_default_entry(FMKey(e->lengths[0],
+                                       e->lengths[1],
+                                       e->precision,
+                                       e->scheme,
+                                       e->sbrcTrans,
+                                       kernel.get_kernel_config()),
+                                 kernel);
+            found = true;
+        }
+        if(found)
+            return true;
+
+        // column kernels can be derived from a row kernel
+        if((key.scheme != CS_KERNEL_STOCKHAM_BLOCK_CC && key.scheme != CS_KERNEL_STOCKHAM_BLOCK_CR)
+           || key.lengths[1] != 0 || key.sbrcTrans != NONE)
+            return false;
+        FMKey row_key(key.lengths[0], key.precision);
+        if(!materialize(row_key))
+            return false;
+        FFTKernel kernel;
+        if(!derive_block_kernel(
+               function_map.at(def_key_pool.at(row_key)), key.lengths[0], key.precision, kernel))
+            return false;
+        insert_default_entry(FMKey(key.lengths[0],
+                                   key.precision,
+                                   key.scheme,
+                                   NONE,
+                                   kernel.get_kernel_config()),
+                             kernel);
+        return true;
+    }
+
+    const FMKey& get_actual_key(const FMKey& key)
+    {
+        materialize(key);
 
         // - for keys that we are querying with no/empty kernel-config, actually we are refering to
         //   the default kernel-configs in kernel-generator.py. So get the actual keys to look-up
         //   the pool.
         // - if not in the def_key_pool, then we simply use itself (for dynamically added kernel)
-        if(func_pool.def_key_pool.count(key) > 0)
-            return func_pool.def_key_pool.at(key);
+        if(def_key_pool.count(key) > 0)
+            return def_key_pool.at(key);
         else
             return key;
     }
 
-    // insert a key-kernel pair for AOT generator, this is a private function and can be called
-    // only in ctor. That is, the default kernel-config we set in the kernel-generator.py
+    // insert a key-kernel pair for a default kernel - one from the
+    // generated table, or derived from one.  That is, the default
+    // kernel-config we set in the kernel-generator.py
     // we save a pair as <key-empty-config, key-actual-config> that allows us to use
     // the empty-config key to get the default kernel
     bool insert_default_entry(const FMKey& def_key, const FFTKernel& kernel)
@@ -158,6 +312,43 @@ private:
         return std::get<1>(function_map.emplace(def_key, kernel));
     }
 
+    // Derive a column (SBCC or SBCR) kernel from the row kernel of a
+    // length that has none, to be compiled at runtime.  The derived
+    // kernel uses the row kernel's factors and threads, with as many
+    // columns per block as fit in LDS.  Derived kernels were not
+    // tuned, so only decompositions that would otherwise need
+    // standalone transposes ask for them.
+    static bool derive_block_kernel(const FFTKernel& row,
+                                    size_t           length,
+                                    rocfft_precision precision,
+                                    FFTKernel&       kernel)
+    {
+        // LDS most devices have per block
+        static const size_t max_lds_bytes = 64 * 1024;
+        // columns per block - fewer would no longer coalesce
+        // column accesses
+        static const size_t min_block_width = 8;
+        static const size_t max_block_width = 16;
+
+        const size_t tpt = row.threads_per_transform[0];
+        if(tpt == 0)
+            return false;
+        const size_t column_bytes = length * complex_type_size(precision);
+        const size_t width
+            = std::min({max_block_width, 1024 / tpt, max_lds_bytes / column_bytes});
+        if(width < min_block_width)
+            return false;
+
+        kernel                       = FFTKernel();
+        kernel.factors               = row.factors;
+        kernel.transforms_per_block  = width;
+        kernel.workgroup_size        = width * tpt;
+        kernel.threads_per_transform = {static_cast<int>(tpt), 0};
+        kernel.direct_to_from_reg    = row.direct_to_from_reg;
+        kernel.derived               = true;
+        return true;
+    }
+
 public:
     function_pool(const function_pool&) = delete;
 
@@ -178,7 +369,8 @@ public:
         if(has_function(new_key))
             return true;
 
-        function_pool& func_pool = get_function_pool();
+        function_pool&              func_pool = get_function_pool();
+        std::lock_guard<std::mutex> lock(func_pool.mutex);
         return std::get<1>(
             func_pool.function_map.emplace(new_key, FFTKernel(new_key.kernel_config)));
     }
@@ -195,18 +387,45 @@ public:
 
         out_FMKey->kernel_config = alt_config;
 
-        function_pool& func_pool = get_function_pool();
+        function_pool&              func_pool = get_function_pool();
+        std::lock_guard<std::mutex> lock(func_pool.mutex);
         return std::get<1>(func_pool.function_map.emplace(*out_FMKey, FFTKernel(alt_config)));
     }
 
     static bool has_function(const FMKey& key)
     {
-        function_pool& func_pool = get_function_pool();
+        function_pool&              func_pool = get_function_pool();
+        std::lock_guard<std::mutex> lock(func_pool.mutex);
 
-        auto real_key = function_pool::get_actual_key(key);
+        auto real_key = func_pool.get_actual_key(key);
         return func_pool.function_map.count(real_key) > 0;
     }
 
+    // bytes of LDS that one block of a 1D Stockham kernel uses,
+    // without embedded pre/post-processing
+    static size_t get_lds_bytes(const FMKey& key)
+    {
+        auto   kernel = get_kernel(key);
+        size_t bytes  = key.lengths[0] * std::max(kernel.transforms_per_block, 1u)
+                       * complex_type_size(key.precision);
+        if(kernel.half_lds)
+            bytes /= 2;
+        return bytes;
+    }
+
+    // true if the pool has the kernel and one block of it fits in the
+    // LDS of the device
+    static bool has_function_for_device(const FMKey& key, const hipDeviceProp_t& prop)
+    {
+        if(!has_function(key))
+            return false;
+
+        size_t ldsSize = prop.sharedMemPerBlock;
+        if(ldsSize == 0)
+            ldsSize = 64 * 1024;
+        return get_lds_bytes(key) <= ldsSize;
+    }
+
     static size_t get_largest_length(rocfft_precision precision)
     {
         auto supported = function_pool::get_lengths(precision, CS_KERNEL_STOCKHAM);
@@ -218,14 +437,41 @@ public:
 
     static std::vector<size_t> get_lengths(rocfft_precision precision, ComputeScheme scheme)
     {
-        const function_pool& func_pool = get_function_pool();
-        std::vector<size_t>  lengths;
+        function_pool&              func_pool = get_function_pool();
+        std::lock_guard<std::mutex> lock(func_pool.mutex);
+        std::vector<size_t>         lengths;
+
+        auto wanted = [&](const auto& lengths, rocfft_precision p, ComputeScheme s, auto trans) {
+            return lengths[1] == 0 && p == precision && s == scheme && trans == NONE;
+        };
+        bool derivable
+            = scheme == CS_KERNEL_STOCKHAM_BLOCK_CC || scheme == CS_KERNEL_STOCKHAM_BLOCK_CR;
+        for(auto e = func_pool.generated_begin; e != func_pool.generated_end; ++e)
+        {
+            if(wanted(e->lengths, e->precision, e->scheme, e->sbrcTrans))
+                lengths.push_back(e->lengths[0]);
+            else if(derivable && wanted(e->lengths, e->precision, scheme, e->sbrcTrans)
+                    && e->scheme == CS_KERNEL_STOCKHAM
+                    && !func_pool.find_generated(FMKey(e->lengths[0], precision, scheme)))
+            {
+                FFTKernel kernel;
+                if(derive_block_kernel(e->kernel(), e->lengths[0], precision, kernel))
+                    lengths.push_back(e->lengths[0]);
+            }
+        }
+
+        // kernels added at runtime, not counting the default kernels
+        // already listed from the table
         for(auto const& kv : func_pool.function_map)
         {
-            if(kv.first.lengths[1] == 0 && kv.first.precision == precision
-               && kv.first.scheme == scheme && kv.first.sbrcTrans == NONE)
+            if(wanted(kv.first.lengths, kv.first.precision, kv.first.scheme, kv.first.sbrcTrans)
+               && !kv.second.derived)
             {
-                lengths.push_back(kv.first.lengths[0]);
+                FMKey simple_key(kv.first);
+                simple_key.kernel_config = KernelConfig::EmptyConfig();
+                auto def                 = func_pool.def_key_pool.find(simple_key);
+                if(def == func_pool.def_key_pool.end() || !(def->second == kv.first))
+                    lengths.push_back(kv.first.lengths[0]);
             }
         }
 
@@ -234,24 +480,29 @@ public:
 
     static DevFnCall get_function(const FMKey& key)
     {
-        function_pool& func_pool = get_function_pool();
+        function_pool&              func_pool = get_function_pool();
+        std::lock_guard<std::mutex> lock(func_pool.mutex);
 
-        auto real_key = function_pool::get_actual_key(key);
+        auto real_key = func_pool.get_actual_key(key);
         return func_pool.function_map.at(real_key).device_function;
     }
 
     static FFTKernel get_kernel(const FMKey& key)
     {
-        function_pool& func_pool = get_function_pool();
+        function_pool&              func_pool = get_function_pool();
+        std::lock_guard<std::mutex> lock(func_pool.mutex);
 
-        auto real_key = function_pool::get_actual_key(key);
+        auto real_key = func_pool.get_actual_key(key);
         return func_pool.function_map.at(real_key);
     }
 
-    // helper for common used
-    static bool has_SBCC_kernel(size_t length, rocfft_precision precision)
+    // helper for common used.  kernels derived from row kernels are
+    // only reported if allow_derived is set.
+    static bool
+        has_SBCC_kernel(size_t length, rocfft_precision precision, bool allow_derived = false)
     {
-        return has_function(FMKey(length, precision, CS_KERNEL_STOCKHAM_BLOCK_CC));
+        FMKey key(length, precision, CS_KERNEL_STOCKHAM_BLOCK_CC);
+        return has_function(key) && (allow_derived || !get_kernel(key).derived);
     }
 
     static bool has_SBRC_kernel(size_t              length,
@@ -261,13 +512,21 @@ public:
         return has_function(FMKey(length, precision, CS_KERNEL_STOCKHAM_BLOCK_RC, trans_type));
     }
 
-    static bool has_SBCR_kernel(size_t length, rocfft_precision precision)
+    static bool
+        has_SBCR_kernel(size_t length, rocfft_precision precision, bool allow_derived = false)
     {
-        return has_function(FMKey(length, precision, CS_KERNEL_STOCKHAM_BLOCK_CR));
+        FMKey key(length, precision, CS_KERNEL_STOCKHAM_BLOCK_CR);
+        return has_function(key) && (allow_derived || !get_kernel(key).derived);
     }
 
-    const auto& get_map() const
+    // all generated kernels, plus any added at runtime.  Kernels
+    // that would be derived from row kernels are only included once
+    // they've been looked up.
+    const auto& get_map()
     {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(auto e = generated_begin; e != generated_end; ++e)
+            materialize(FMKey(e->lengths[0], e->lengths[1], e->precision, e->scheme, e->sbrcTrans));
         return function_map;
     }
 };
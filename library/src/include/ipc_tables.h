@@ -0,0 +1,64 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef ROCFFT_IPC_TABLES_H
+#define ROCFFT_IPC_TABLES_H
+
+#include <string>
+#include <utility>
+
+// If ROCFFT_SHARE_TWIDDLES_IPC names a file (e.g. in /dev/shm), the
+// file is a registry of twiddle and chirp tables that processes on
+// the node publish for each other.  A process that builds a table
+// publishes its HIP IPC handle under a key, and other processes with
+// the same registry map the table instead of building their own.
+//
+// Published tables stay allocated in the process that built them
+// until it calls rocfft_cleanup or exits.  Entries of processes that
+// have exited are reclaimed by the next process to find them.
+
+bool ipc_tables_enabled();
+
+// prefix of keys that identifies a device across processes, which
+// may number devices differently
+std::string ipc_table_device_key(int deviceId);
+
+// map a table that another process published under key on the
+// current device.  Returns the table and its size in bytes, or
+// nullptr if no live process has published it.
+std::pair<void*, size_t> ipc_table_open(const std::string& key);
+
+// publish a table that this process built, if no other process has
+// published one under key.  The table must be a whole allocation
+// and fully generated.
+void ipc_table_publish(const std::string& key, void* ptr, size_t bytes);
+
+// true if ptr is a table this process published
+bool ipc_table_published(void* ptr);
+
+// if ptr was mapped by ipc_table_open, unmap it and return true
+bool ipc_table_close(void* ptr);
+
+// withdraw every table this process published and unmap every
+// table it opened
+void ipc_tables_clear();
+
+#endif // ROCFFT_IPC_TABLES_H
@@ -26,34 +26,39 @@
 
 #include "../../../shared/gpubuf.h"
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 #define KERN_ARGS_ARRAY_WIDTH 16
 
-gpubuf_t<size_t> kargs_create(std::vector<size_t> length,
-                              std::vector<size_t> inStride,
-                              std::vector<size_t> outStride,
-                              size_t              iDist,
-                              size_t              oDist);
+// Kernel argument arrays are shared by all nodes on a device that
+// have the same lengths, strides and distances.  The device buffer
+// is freed once the last node using it is destroyed.  Returns
+// nullptr if allocation or copying fails.
+std::shared_ptr<gpubuf_t<size_t>> kargs_create(const std::vector<size_t>& length,
+                                               const std::vector<size_t>& inStride,
+                                               const std::vector<size_t>& outStride,
+                                               size_t                     iDist,
+                                               size_t                     oDist);
 
 // data->node->devKernArg : points to the internal length device pointer
 // data->node->devKernArg + 1*KERN_ARGS_ARRAY_WIDTH : points to the intenal in
 // stride device pointer
 // data->node->devKernArg + 2*KERN_ARGS_ARRAY_WIDTH : points to the internal out
 // stride device pointer, only used in outof place kernels
-static size_t* kargs_lengths(const gpubuf_t<size_t>& devKernArg)
+static size_t* kargs_lengths(const std::shared_ptr<gpubuf_t<size_t>>& devKernArg)
 {
-    return devKernArg.data();
+    return devKernArg ? devKernArg->data() : nullptr;
 }
 
-static size_t* kargs_stride_in(const gpubuf_t<size_t>& devKernArg)
+static size_t* kargs_stride_in(const std::shared_ptr<gpubuf_t<size_t>>& devKernArg)
 {
-    return devKernArg.data() + 1 * KERN_ARGS_ARRAY_WIDTH;
+    return devKernArg ? devKernArg->data() + 1 * KERN_ARGS_ARRAY_WIDTH : nullptr;
 }
 
-static size_t* kargs_stride_out(const gpubuf_t<size_t>& devKernArg)
+static size_t* kargs_stride_out(const std::shared_ptr<gpubuf_t<size_t>>& devKernArg)
 {
-    return devKernArg.data() + 2 * KERN_ARGS_ARRAY_WIDTH;
+    return devKernArg ? devKernArg->data() + 2 * KERN_ARGS_ARRAY_WIDTH : nullptr;
 }
 
 #endif // defined( KARGS_H )
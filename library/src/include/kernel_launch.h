@@ -76,6 +76,15 @@ struct DeviceCallIn
 
     UserCallbacks callbacks;
 
+    // transforms to execute, if fewer than the node was planned for.
+    // 0 executes the node's whole batch.
+    size_t batch = 0;
+
+    size_t get_batch() const
+    {
+        return batch ? batch : node->batch;
+    }
+
     CallbackType get_callback_type() const
     {
         if(callbacks.load_cb_fn || callbacks.store_cb_fn)
@@ -450,7 +459,7 @@ bcc - block column column
                                         data->node->length.size(),                 \
                                         kargs_lengths(data->node->devKernArg),     \
                                         kargs_stride_in(data->node->devKernArg),   \
-                                        data->node->batch,                         \
+                                        data->get_batch(),                         \
                                         data->node->lds_padding,                   \
                                         data->callbacks.load_cb_fn,                \
                                         data->callbacks.load_cb_data,              \
@@ -478,7 +487,7 @@ bcc - block column column
                                         data->node->length.size(),                 \
                                         kargs_lengths(data->node->devKernArg),     \
                                         kargs_stride_in(data->node->devKernArg),   \
-                                        data->node->batch,                         \
+                                        data->get_batch(),                         \
                                         data->node->lds_padding,                   \
                                         data->callbacks.load_cb_fn,                \
                                         data->callbacks.load_cb_data,              \
@@ -511,7 +520,7 @@ bcc - block column column
                                         kargs_lengths(data->node->devKernArg),     \
                                         kargs_stride_in(data->node->devKernArg),   \
                                         kargs_stride_out(data->node->devKernArg),  \
-                                        data->node->batch,                         \
+                                        data->get_batch(),                         \
                                         data->node->lds_padding,                   \
                                         data->callbacks.load_cb_fn,                \
                                         data->callbacks.load_cb_data,              \
@@ -542,7 +551,7 @@ bcc - block column column
                                         kargs_lengths(data->node->devKernArg),     \
                                         kargs_stride_in(data->node->devKernArg),   \
                                         kargs_stride_out(data->node->devKernArg),  \
-                                        data->node->batch,                         \
+                                        data->get_batch(),                         \
                                         data->node->lds_padding,                   \
                                         data->callbacks.load_cb_fn,                \
                                         data->callbacks.load_cb_data,              \
@@ -574,7 +583,7 @@ bcc - block column column
                                         kargs_lengths(data->node->devKernArg),     \
                                         kargs_stride_in(data->node->devKernArg),   \
                                         kargs_stride_out(data->node->devKernArg),  \
-                                        data->node->batch,                         \
+                                        data->get_batch(),                         \
                                         data->node->lds_padding,                   \
                                         data->callbacks.load_cb_fn,                \
                                         data->callbacks.load_cb_data,              \
@@ -607,7 +616,7 @@ bcc - block column column
                                         kargs_lengths(data->node->devKernArg),     \
                                         kargs_stride_in(data->node->devKernArg),   \
                                         kargs_stride_out(data->node->devKernArg),  \
-                                        data->node->batch,                         \
+                                        data->get_batch(),                         \
                                         data->node->lds_padding,                   \
                                         data->callbacks.load_cb_fn,                \
                                         data->callbacks.load_cb_data,              \
@@ -633,7 +642,7 @@ bcc - block column column
         DeviceCallIn* data          = (DeviceCallIn*)data_p;                       \
         hipStream_t   rocfft_stream = data->rocfft_stream;                         \
                                                                                    \
-        const size_t batch = data->node->batch;                                    \
+        const size_t batch = data->get_batch();                                    \
                                                                                    \
         if(data->node->placement == rocfft_placement_inplace)                      \
         {                                                                          \
@@ -840,7 +849,7 @@ bcc - block column column
         DeviceCallIn* data          = (DeviceCallIn*)data_p;                          \
         hipStream_t   rocfft_stream = data->rocfft_stream;                            \
                                                                                       \
-        const size_t batch = data->node->batch;                                       \
+        const size_t batch = data->get_batch();                                       \
                                                                                       \
         if(array_type_is_interleaved(data->node->inArrayType)                         \
            && array_type_is_interleaved(data->node->outArrayType))                    \
@@ -986,7 +995,7 @@ bcc - block column column
         DeviceCallIn* data          = (DeviceCallIn*)data_p;                               \
         hipStream_t   rocfft_stream = data->rocfft_stream;                                 \
                                                                                            \
-        const size_t batch = data->node->batch;                                            \
+        const size_t batch = data->get_batch();                                            \
                                                                                            \
         if(array_type_is_interleaved(data->node->inArrayType)                              \
            && array_type_is_interleaved(data->node->outArrayType))                         \
@@ -0,0 +1,55 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_LINK_TOPOLOGY_H
+#define ROCFFT_LINK_TOPOLOGY_H
+
+#include <vector>
+
+struct rocfft_location_t;
+
+// Relative cost of moving data between two locations, from the
+// links between this process' devices.  Costs are rough inverse
+// bandwidths: 0 within a device, 1 over a direct xGMI link, more
+// for PCIe, for links that take several hops, or for peers that
+// can't access each other, and most between comm ranks.
+//
+// Other ranks are assumed to have the same topology as this one.
+class LinkTopology
+{
+public:
+    // topology of this process' devices, queried once
+    static const LinkTopology& Local();
+
+    double Cost(const rocfft_location_t& src, const rocfft_location_t& dest) const;
+
+    // true if transfers between the two locations have a link to
+    // themselves, so they don't slow down transfers between other
+    // devices that run at the same time
+    bool Dedicated(const rocfft_location_t& src, const rocfft_location_t& dest) const;
+
+private:
+    LinkTopology();
+
+    // cost[src][dest] between devices on the same rank
+    std::vector<std::vector<double>> cost;
+};
+
+#endif
@@ -21,25 +21,231 @@
 #ifndef ROCFFT_LOAD_STORE_OPS_H
 #define ROCFFT_LOAD_STORE_OPS_H
 
+#include "../../../shared/precision_type.h"
+#include "rocfft/rocfft.h"
+#include <algorithm>
+#include <initializer_list>
 #include <string>
+#include <vector>
 
 class RTCKernelArgs;
 class Function;
 class TreeNode;
 
+static const char* storage_format_name(rocfft_storage_format storage)
+{
+    switch(storage)
+    {
+    case rocfft_storage_format_native:
+        return "native";
+    case rocfft_storage_format_half:
+        return "half";
+    case rocfft_storage_format_bfloat16:
+        return "bfloat16";
+    case rocfft_storage_format_fp8_e4m3:
+        return "fp8_e4m3";
+    case rocfft_storage_format_fp8_e5m2:
+        return "fp8_e5m2";
+    case rocfft_storage_format_int16:
+        return "int16";
+    case rocfft_storage_format_int8:
+        return "int8";
+    case rocfft_storage_format_single:
+        return "single";
+    }
+    return "unknown";
+}
+
+static const char* output_op_name(rocfft_output_op op)
+{
+    switch(op)
+    {
+    case rocfft_output_op_none:
+        return "none";
+    case rocfft_output_op_power:
+        return "power";
+    case rocfft_output_op_magnitude:
+        return "magnitude";
+    case rocfft_output_op_log_power:
+        return "logPower";
+    }
+    return "unknown";
+}
+
+static const char* normalization_name(rocfft_normalization normalization)
+{
+    switch(normalization)
+    {
+    case rocfft_normalization_none:
+        return "none";
+    case rocfft_normalization_backward:
+        return "backward";
+    case rocfft_normalization_forward:
+        return "forward";
+    case rocfft_normalization_ortho:
+        return "ortho";
+    }
+    return "unknown";
+}
+
+// size in bytes of one real number stored in "storage", for a kernel
+// that computes in "precision"
+static size_t storage_real_size(rocfft_storage_format storage, rocfft_precision precision)
+{
+    switch(storage)
+    {
+    case rocfft_storage_format_native:
+        return real_type_size(precision);
+    case rocfft_storage_format_single:
+        return 4;
+    case rocfft_storage_format_half:
+    case rocfft_storage_format_bfloat16:
+    case rocfft_storage_format_int16:
+        return 2;
+    case rocfft_storage_format_fp8_e4m3:
+    case rocfft_storage_format_fp8_e5m2:
+    case rocfft_storage_format_int8:
+        return 1;
+    }
+    return real_type_size(precision);
+}
+
+// integer formats can only be loaded - there is no sensible way to
+// round and saturate a transform's output to them
+static bool storage_is_integer(rocfft_storage_format storage)
+{
+    return storage == rocfft_storage_format_int16 || storage == rocfft_storage_format_int8;
+}
+
+static size_t storage_element_size(rocfft_storage_format storage,
+                                   rocfft_precision      precision,
+                                   rocfft_array_type     array_type)
+{
+    auto real_size = storage_real_size(storage, precision);
+    return array_type_is_complex(array_type) ? real_size * 2 : real_size;
+}
+
+// offset a pointer to data stored in "storage" by a number of
+// elements
+static void* storage_ptr_offset(void*                 p,
+                                size_t                elems,
+                                rocfft_storage_format storage,
+                                rocfft_precision      precision,
+                                rocfft_array_type     type)
+{
+    return static_cast<char*>(p) + elems * storage_element_size(storage, precision, type);
+}
+
+// sort the strides of a buffer's dimensions fastest to slowest, and
+// reorder "paired" (which hold one value per dimension) to match.
+// Elements are tested against sorted lengths by peeling coordinates
+// off their offset, slowest dimension first.
+static void sort_by_stride(std::vector<size_t>&                     sorted_strides,
+                           const std::vector<size_t>&               strides,
+                           std::initializer_list<std::vector<size_t>*> paired)
+{
+    std::vector<size_t> order(sorted_strides.size());
+    for(size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::stable_sort(
+        order.begin(), order.end(), [&strides](size_t a, size_t b) { return strides[a] < strides[b]; });
+    sorted_strides.clear();
+    for(auto i : order)
+        sorted_strides.push_back(strides[i]);
+    for(auto values : paired)
+    {
+        std::vector<size_t> sorted;
+        for(auto i : order)
+            sorted.push_back((*values)[i]);
+        *values = std::move(sorted);
+    }
+}
+
+// User callback given as device source code, which is compiled into
+// the callback-enabled variant of the kernel that loads input or
+// stores output, instead of being called through a function pointer
+struct InlineCallback
+{
+    std::string source;
+    // name of the callback function defined by source
+    std::string function;
+
+    bool empty() const
+    {
+        return function.empty();
+    }
+
+    // stable hash of source and function, to distinguish the kernels
+    // that different callbacks are compiled into
+    std::string hash() const;
+};
+
 struct LoadOps
 {
     LoadOps() = default;
 
+    // multiplies each element as it's loaded, after conversion from
+    // the storage format
+    double scale_factor{1.0};
+
+    // format of data in the buffers this kernel loads from user
+    // memory - converted to the kernel's precision on load
+    rocfft_storage_format storage{rocfft_storage_format_native};
+
+    // if non-null, each element is multiplied by the element of this
+    // real-valued device buffer at the same offset from the start of
+    // its transform, after conversion from the storage format and
+    // before scaling
+    const void* window{nullptr};
+
+    // if true, the window is instead indexed by an element's
+    // position in its (1D) transform, so that transforms whose input
+    // overlaps (short-time FFT frames) can share the window.  Only
+    // kernels that pass the position to their loads support this.
+    bool frame_window{false};
+
+    // if non-empty, elements whose index along dimension d is at
+    // least valid_lengths[d] load as zero.  The lengths are paired
+    // with their strides and sorted fastest to slowest when the plan
+    // is created - see set_layout.
+    std::vector<size_t> valid_lengths;
+    std::vector<size_t> valid_strides;
+
+    // distance between transforms in the input, used to find an
+    // element's offset within its transform
+    size_t dist{0};
+
+    // load callback compiled into the kernel.  This is not a load
+    // op - it only affects the kernel that is built with callbacks.
+    InlineCallback callback;
+
     // returns true if some load operation is enabled
     bool enabled() const
     {
-        return false;
+        return scale_factor != 1.0 || storage != rocfft_storage_format_native || window
+               || !valid_lengths.empty();
+    }
+
+    // remember the input layout needed by the window and zero
+    // padding.  strides are in the same order as valid_lengths.
+    void set_layout(const std::vector<size_t>& strides, size_t in_dist)
+    {
+        dist = in_dist;
+        valid_strides.resize(valid_lengths.size());
+        sort_by_stride(valid_strides, strides, {&valid_lengths});
     }
 
     std::string name_suffix() const
     {
         std::string ret;
+        if(scale_factor != 1.0)
+            ret += "_loadScale";
+        if(window)
+            ret += frame_window ? "_frameWindow" : "_window";
+        if(!valid_lengths.empty())
+            ret += "_zeroPad" + std::to_string(valid_lengths.size()) + "D";
+        if(storage != rocfft_storage_format_native)
+            ret += std::string("_") + storage_format_name(storage) + "In";
         return ret;
     }
 
@@ -52,6 +258,23 @@ struct LoadOps
     template <typename Tstream>
     void print(Tstream& os, const std::string& indent) const
     {
+        if(scale_factor != 1.0)
+            os << indent << "load scale factor: " << scale_factor << "\n";
+        if(window)
+            os << indent << (frame_window ? "load frame window: " : "load window: ") << window
+               << "\n";
+        if(!valid_lengths.empty())
+        {
+            os << indent << "load valid lengths:";
+            for(auto len : valid_lengths)
+                os << " " << len;
+            os << "\n";
+        }
+        if(storage != rocfft_storage_format_native)
+            os << indent << "load storage: " << storage_format_name(storage) << "\n";
+        if(!callback.empty())
+            os << indent << "load callback: " << callback.function << " (" << callback.hash()
+               << ")\n";
     }
 };
 
@@ -61,10 +284,91 @@ struct StoreOps
 
     double scale_factor{1.0};
 
+    // normalization requested by the user.  Plan creation multiplies
+    // its factor into scale_factor and resets this to none, so
+    // kernels and plans derived from the description only see the
+    // scale.
+    rocfft_normalization normalization{rocfft_normalization_none};
+
+    // format of data in the buffers this kernel stores to user
+    // memory - converted from the kernel's precision after scaling
+    rocfft_storage_format storage{rocfft_storage_format_native};
+
+    // if non-null, each complex element is multiplied by the element
+    // of this device buffer at the same position within its
+    // transform (i.e. the output index modulo multiply_dist), after
+    // scaling.  Used by convolution plans to apply the kernel
+    // spectrum as the forward transform is written out.
+    const void* multiply_buffer{nullptr};
+    size_t      multiply_dist{0};
+
+    // reduces each complex element to a real value (e.g. its power)
+    // after scaling and multiplying, so the buffer being stored to
+    // holds real elements
+    rocfft_output_op output_op{rocfft_output_op_none};
+
+    // add to the value already in the buffer, instead of
+    // overwriting it.  Happens after output_op and before
+    // conversion to the storage format.
+    bool accumulate{false};
+
+    // if non-empty, elements whose index along dimension d is
+    // outside [kept_starts[d], kept_starts[d] + kept_lengths[d]) are
+    // not stored, leaving the output buffer untouched there.  Sorted
+    // with their strides like LoadOps::valid_lengths.
+    std::vector<size_t> kept_starts;
+    std::vector<size_t> kept_lengths;
+    std::vector<size_t> kept_strides;
+
+    // distance between transforms in the output, used to find an
+    // element's offset within its transform
+    size_t dist{0};
+
+    // store callback compiled into the kernel.  This is not a store
+    // op - it only affects the kernel that is built with callbacks.
+    InlineCallback callback;
+
+    // build callback kernels for every node of the plan, not just
+    // the ones that load input and store output, so that store
+    // callbacks can be set on interior passes
+    bool pass_callbacks{false};
+
     // returns true if some store operation is enabled
     bool enabled() const
     {
-        return scale_factor != 1.0;
+        return scale_factor != 1.0 || storage != rocfft_storage_format_native || multiply_buffer
+               || output_op != rocfft_output_op_none || accumulate || !kept_lengths.empty();
+    }
+
+    // true if the output buffer must only be written by the kernel
+    // that applies these ops - it holds values that aren't the
+    // complex results, or that must survive until the final store
+    bool needs_exclusive_output() const
+    {
+        return output_op != rocfft_output_op_none || accumulate || !kept_lengths.empty();
+    }
+
+    // true if the kept range of some dimension doesn't start at 0
+    bool kept_offset() const
+    {
+        return std::any_of(
+            kept_starts.begin(), kept_starts.end(), [](size_t start) { return start != 0; });
+    }
+
+    // remember the output layout needed by truncation and pruning.
+    // strides are in the same order as kept_lengths.
+    void set_layout(const std::vector<size_t>& strides, size_t out_dist)
+    {
+        dist = out_dist;
+        kept_strides.resize(kept_lengths.size());
+        sort_by_stride(kept_strides, strides, {&kept_starts, &kept_lengths});
+    }
+
+    // array type of the elements written to memory by a kernel
+    // that computes elements of "type"
+    rocfft_array_type stored_array_type(rocfft_array_type type) const
+    {
+        return output_op == rocfft_output_op_none ? type : rocfft_array_type_real;
     }
 
     std::string name_suffix() const
@@ -72,6 +376,17 @@ struct StoreOps
         std::string ret;
         if(scale_factor != 1.0)
             ret += "_scale";
+        if(multiply_buffer)
+            ret += "_mulSpectrum";
+        if(output_op != rocfft_output_op_none)
+            ret += std::string("_") + output_op_name(output_op);
+        if(accumulate)
+            ret += "_accum";
+        if(!kept_lengths.empty())
+            ret += std::string(kept_offset() ? "_prune" : "_truncate")
+                   + std::to_string(kept_lengths.size()) + "D";
+        if(storage != rocfft_storage_format_native)
+            ret += std::string("_") + storage_format_name(storage) + "Out";
         return ret;
     }
 
@@ -86,6 +401,27 @@ struct StoreOps
     {
         if(scale_factor != 1.0)
             os << indent << "scale factor: " << scale_factor << "\n";
+        if(normalization != rocfft_normalization_none)
+            os << indent << "normalization: " << normalization_name(normalization) << "\n";
+        if(multiply_buffer)
+            os << indent << "multiply by spectrum: " << multiply_buffer << ", dist "
+               << multiply_dist << "\n";
+        if(output_op != rocfft_output_op_none)
+            os << indent << "output op: " << output_op_name(output_op) << "\n";
+        if(accumulate)
+            os << indent << "accumulate output\n";
+        if(!kept_lengths.empty())
+        {
+            os << indent << "store kept range:";
+            for(size_t i = 0; i < kept_lengths.size(); ++i)
+                os << " [" << kept_starts[i] << "," << kept_starts[i] + kept_lengths[i] << ")";
+            os << "\n";
+        }
+        if(storage != rocfft_storage_format_native)
+            os << indent << "store storage: " << storage_format_name(storage) << "\n";
+        if(!callback.empty())
+            os << indent << "store callback: " << callback.function << " (" << callback.hash()
+               << ")\n";
     }
 };
 
@@ -35,11 +35,13 @@
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <sstream>
 #include <string>
 #include <tuple>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "rocfft/rocfft.h"
 
@@ -134,6 +136,7 @@ extern int log_kernelio_fd;
 extern int log_rtc_fd;
 extern int log_tuning_fd;
 extern int log_graph_fd;
+extern int log_replay_fd;
 
 /*! \brief Indicates if layer is active with bitmask*/
 typedef enum rocfft_layer_mode_
@@ -147,6 +150,8 @@ typedef enum rocfft_layer_mode_
     rocfft_layer_mode_log_rtc      = 0b0000100000, // 32
     rocfft_layer_mode_log_tuning   = 0b0001000000, // 64
     rocfft_layer_mode_log_graph    = 0b0010000000, //128
+    rocfft_layer_mode_roctx        = 0b0100000000, //256
+    rocfft_layer_mode_log_replay   = 0b1000000000, //512
 } rocfft_layer_mode;
 
 class LogSingleton
@@ -162,6 +167,8 @@ private:
     LogSingleton() {}
 
     rocfft_layer_mode layer_mode{};
+    // write log records as JSON Lines instead of plain text
+    bool json_format{false};
 
     LogSingleton(LogSingleton const&);
     void operator=(LogSingleton const&);
@@ -175,6 +182,14 @@ public:
     {
         return layer_mode;
     }
+    void SetJSONFormat(bool json)
+    {
+        json_format = json;
+    }
+    bool GetJSONFormat() const
+    {
+        return json_format;
+    }
     rocfft_ostream* GetTraceOS()
     {
         if(log_trace_fd == -1)
@@ -231,6 +246,13 @@ public:
         static thread_local rocfft_ostream log_graph_os(log_graph_fd);
         return &log_graph_os;
     }
+    rocfft_ostream* GetReplayOS()
+    {
+        if(log_replay_fd == -1)
+            return &rocfft_cerr;
+        static thread_local rocfft_ostream log_replay_os(log_replay_fd);
+        return &log_replay_os;
+    }
 };
 
 #define LOG_TRACE_ENABLED() \
@@ -247,17 +269,10 @@ public:
     (LogSingleton::GetInstance().GetLayerMode() & rocfft_layer_mode_log_tuning)
 #define LOG_GRAPH_ENABLED() \
     (LogSingleton::GetInstance().GetLayerMode() & rocfft_layer_mode_log_graph)
-
-// if profile logging is turned on with
-// (layer_mode & rocfft_layer_mode_log_profile) != 0
-// log_profile will call argument_profile to profile actual arguments,
-// keeping count of the number of times each set of arguments is used
-template <typename... Ts>
-inline void log_profile(Ts&&... xs)
-{
-    if(LOG_PROFILE_ENABLED())
-        log_arguments(*LogSingleton::GetInstance().GetProfileOS(), ",", std::forward<Ts>(xs)...);
-}
+#define LOG_REPLAY_ENABLED() \
+    (LogSingleton::GetInstance().GetLayerMode() & rocfft_layer_mode_log_replay)
+#define ROCTX_ENABLED() (LogSingleton::GetInstance().GetLayerMode() & rocfft_layer_mode_roctx)
+#define LOG_JSON_ENABLED() (LogSingleton::GetInstance().GetJSONFormat())
 
 /********************************************
  * Log values (for log_trace and log_bench) *
@@ -270,6 +285,159 @@ static inline void log_arguments(rocfft_ostream& os, const char* sep, H head, Ts
     os << std::endl;
 }
 
+/*****************************************************************
+ * Log values as JSON Lines (ROCFFT_LOG_FORMAT=json)             *
+ *                                                               *
+ * Each record is one object on its own line.  The first value   *
+ * is written as "function", the remaining values are taken as   *
+ * key/value pairs.  A trailing unpaired value is written under  *
+ * "value".                                                      *
+ *****************************************************************/
+static inline void json_string(std::string& out, const std::string& s)
+{
+    out += '"';
+    for(unsigned char c : s)
+    {
+        switch(c)
+        {
+        case '"':
+            out += "\\\"";
+            break;
+        case '\\':
+            out += "\\\\";
+            break;
+        case '\n':
+            out += "\\n";
+            break;
+        case '\t':
+            out += "\\t";
+            break;
+        case '\r':
+            out += "\\r";
+            break;
+        default:
+            if(c < 0x20)
+            {
+                static const char* hex = "0123456789abcdef";
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0xf];
+            }
+            else
+                out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+template <typename T>
+struct is_std_vector : std::false_type
+{
+};
+template <typename T, typename A>
+struct is_std_vector<std::vector<T, A>> : std::true_type
+{
+};
+
+template <typename T>
+static inline void json_value(std::string& out, const T& v)
+{
+    using U = std::decay_t<T>;
+    if constexpr(std::is_same_v<U, bool>)
+        out += v ? "true" : "false";
+    else if constexpr(std::is_integral_v<U>)
+        out += std::to_string(v);
+    else if constexpr(std::is_floating_point_v<U>)
+    {
+        if(std::isfinite(v))
+        {
+            std::ostringstream ss;
+            ss << std::setprecision(std::numeric_limits<U>::digits10 + 1) << v;
+            out += ss.str();
+        }
+        else
+            out += "null";
+    }
+    else if constexpr(std::is_same_v<U, std::pair<const size_t*, size_t>>)
+    {
+        out += '[';
+        for(size_t i = 0; i < v.second; ++i)
+        {
+            if(i)
+                out += ',';
+            out += std::to_string(v.first[i]);
+        }
+        out += ']';
+    }
+    else if constexpr(is_std_vector<U>::value)
+    {
+        out += '[';
+        for(size_t i = 0; i < v.size(); ++i)
+        {
+            if(i)
+                out += ',';
+            json_value(out, v[i]);
+        }
+        out += ']';
+    }
+    else
+    {
+        // everything else (strings, enums, pointers) is written as
+        // the string the text logs would print
+        rocfft_ostream ss;
+        ss << v;
+        json_string(out, ss.str());
+    }
+}
+
+static inline void json_pairs(std::string&) {}
+
+template <typename V>
+static inline void json_pairs(std::string& out, const V& v)
+{
+    out += ",\"value\":";
+    json_value(out, v);
+}
+
+template <typename K, typename V, typename... Ts>
+static inline void json_pairs(std::string& out, const K& k, const V& v, const Ts&... xs)
+{
+    out += ',';
+    rocfft_ostream key;
+    key << k;
+    json_string(out, key.str());
+    out += ':';
+    json_value(out, v);
+    json_pairs(out, xs...);
+}
+
+template <typename H, typename... Ts>
+static inline void log_json_arguments(rocfft_ostream& os, const H& head, const Ts&... xs)
+{
+    // build the whole record first so it reaches the stream in one write
+    std::string out = "{\"function\":";
+    json_value(out, head);
+    json_pairs(out, xs...);
+    out += '}';
+    os << out << std::endl;
+}
+
+// if profile logging is turned on with
+// (layer_mode & rocfft_layer_mode_log_profile) != 0
+// log_profile will log the function name followed by key/value pairs
+template <typename... Ts>
+inline void log_profile(Ts&&... xs)
+{
+    if(LOG_PROFILE_ENABLED())
+    {
+        auto& os = *LogSingleton::GetInstance().GetProfileOS();
+        if(LOG_JSON_ENABLED())
+            log_json_arguments(os, xs...);
+        else
+            log_arguments(os, ",", xs...);
+    }
+}
+
 // if trace logging is turned on with
 // (layer_mode & rocbfft_layer_mode_log_trace) != 0
 // log_function will call log_arguments to log arguments with a comma separator
@@ -277,7 +445,13 @@ template <typename... Ts>
 inline void log_trace(Ts&&... xs)
 {
     if(LOG_TRACE_ENABLED())
-        log_arguments(*LogSingleton::GetInstance().GetTraceOS(), ",", std::forward<Ts>(xs)...);
+    {
+        auto& os = *LogSingleton::GetInstance().GetTraceOS();
+        if(LOG_JSON_ENABLED())
+            log_json_arguments(os, xs...);
+        else
+            log_arguments(os, ",", xs...);
+    }
 }
 
 // if bench logging is turned on with
@@ -288,7 +462,32 @@ template <typename... Ts>
 inline void log_bench(Ts&&... xs)
 {
     if(LOG_BENCH_ENABLED())
-        log_arguments(*LogSingleton::GetInstance().GetBenchOS(), " ", std::forward<Ts>(xs)...);
+    {
+        auto& os = *LogSingleton::GetInstance().GetBenchOS();
+        if(LOG_JSON_ENABLED())
+        {
+            // the command line stays intact as a single string value
+            rocfft_ostream command;
+            ((command << xs << " "), ...);
+            auto str = command.str();
+            if(!str.empty())
+                str.pop_back();
+            log_json_arguments(os, "rocfft-bench", "command", str);
+        }
+        else
+            log_arguments(os, " ", xs...);
+    }
+}
+
+// if replay logging is turned on with
+// (layer_mode & rocfft_layer_mode_log_replay) != 0
+// log_replay writes one space-separated record of a trace that
+// rocfft-bench --replay can play back.
+template <typename... Ts>
+inline void log_replay(Ts&&... xs)
+{
+    if(LOG_REPLAY_ENABLED())
+        log_arguments(*LogSingleton::GetInstance().GetReplayOS(), " ", xs...);
 }
 
 static void log_plan(const char* msg)
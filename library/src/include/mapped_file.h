@@ -0,0 +1,97 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_MAPPED_FILE_H
+#define ROCFFT_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#if __has_include(<filesystem>)
+#include <filesystem>
+#else
+#include <experimental/filesystem>
+namespace std
+{
+    namespace filesystem = experimental::filesystem;
+}
+#endif
+
+// Read-only memory mapping of a whole file, unmapped when destroyed.
+class MappedFile
+{
+public:
+    // map the file at the path.  throws if the file can't be opened
+    // or mapped, naming the file as "what" in the error.
+    MappedFile(const std::filesystem::path& path, const std::string& what);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const
+    {
+        return ptr;
+    }
+    size_t size() const
+    {
+        return len;
+    }
+
+private:
+    const char* ptr = nullptr;
+    size_t      len = 0;
+#ifdef WIN32
+    void* file_handle    = nullptr;
+    void* mapping_handle = nullptr;
+#endif
+};
+
+// 64-bit FNV-1a.  The hash only depends on the bytes fed to it, so
+// it's stable across processes, builds and platforms, and can name
+// things that are written to disk.
+struct FNV1aHash
+{
+    uint64_t value = 0xcbf29ce484222325ULL;
+
+    void add(const void* bytes, size_t count)
+    {
+        auto p = static_cast<const unsigned char*>(bytes);
+        for(size_t i = 0; i < count; ++i)
+        {
+            value ^= p[i];
+            value *= 0x100000001b3ULL;
+        }
+    }
+    void add(const std::string& str)
+    {
+        add(str.data(), str.size());
+    }
+};
+
+static inline uint64_t fnv1a_hash(const std::string& str)
+{
+    FNV1aHash hash;
+    hash.add(str);
+    return hash.value;
+}
+
+#endif
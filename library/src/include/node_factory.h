@@ -23,6 +23,23 @@
 
 #include "tree_node.h"
 
+// One way of decomposing a root problem, for plan-level tuning: the
+// scheme of the root node, and for nodes that choose between
+// several decompositions themselves (real-data 2D and 3D nodes),
+// which one to build.  variant -1 leaves that choice to the node.
+struct TreeShape
+{
+    ComputeScheme scheme  = CS_NONE;
+    int           variant = -1;
+    // readable description, for tuning output
+    std::string name;
+
+    bool operator==(const TreeShape& rhs) const
+    {
+        return scheme == rhs.scheme && variant == rhs.variant;
+    }
+};
+
 class NodeFactory
 {
 private:
@@ -50,13 +67,29 @@ public:
     // Checks if  the non-pow2 length input is supported for a Bluestein compute scheme
     static bool NonPow2LengthSupported(rocfft_precision precision, size_t len);
 
+    // Lengths in [minLen, maxLen) accepted by NonPow2LengthSupported,
+    // in ascending order
+    static std::vector<size_t>
+        NonPow2LengthsSupported(rocfft_precision precision, size_t minLen, size_t maxLen);
+
+    // Length of the first (column) kernel when a large 1D length is
+    // block-computed over two kernels, or 0 if it is not
+    static size_t Large1DDivLength(rocfft_precision precision, size_t len);
+
+    // Length of the column kernel when a large 1D length is done as
+    // CS_L1D_CRT with a column kernel that may be derived from a row
+    // kernel, or 0 if no factorization fits
+    static size_t CRTColumnLength(const NodeMetaData& nodeData);
+
     // Gets a (potentially non-pow2) length to run Bluestein
-    static size_t GetBluesteinLength(rocfft_precision precision, size_t len);
+    static size_t GetBluesteinLength(rocfft_precision       precision,
+                                     size_t                 len,
+                                     const hipDeviceProp_t& deviceProp);
 
     // Decide scheme from the node meta node
     static ComputeScheme DecideNodeScheme(NodeMetaData& nodeData, TreeNode* parent);
     static ComputeScheme DecideRealScheme(NodeMetaData& nodeData);
-    static ComputeScheme Decide1DScheme(NodeMetaData& nodeData);
+    static ComputeScheme Decide1DScheme(NodeMetaData& nodeData, const TreeNode* parent);
     static ComputeScheme Decide2DScheme(NodeMetaData& nodeData);
     static ComputeScheme Decide3DScheme(NodeMetaData& nodeData);
 
@@ -65,9 +98,16 @@ public:
     static bool use_CS_2D_RC(NodeMetaData& nodeData); // using scheme CS_2D_RC or not
     static bool use_CS_3D_BLOCK_RC(NodeMetaData& nodeData);
     static bool use_CS_3D_RC(NodeMetaData& nodeData);
+    static bool use_CS_3D_SINGLE(NodeMetaData& nodeData); // using scheme CS_KERNEL_3D_SINGLE or not
+    static bool use_CS_REAL_TRANSFORM_PACKED(NodeMetaData& nodeData);
+    static bool use_CS_REAL_TRANSFORM_PAIR(NodeMetaData& nodeData);
     // how many SBRC kernels can we put into a 3D transform?
     static size_t count_3D_SBRC_nodes(NodeMetaData& nodeData);
 
+    // Tree shapes that plan-level tuning can try for a root node, the
+    // node's own shape first
+    static std::vector<TreeShape> TunableTreeShapes(TreeNode& root);
+
     // FuseShim Creator
     static std::unique_ptr<FuseShim> CreateFuseShim(FuseType                      type,
                                                     const std::vector<TreeNode*>& components);
@@ -0,0 +1,115 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_ONLINE_TUNER_H
+#define ROCFFT_ONLINE_TUNER_H
+
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+struct rocfft_plan_t;
+
+// Tunes problems that have no solution on first use.
+//
+// When ROCFFT_TUNE_ON_FIRST_USE is set, plans that could not apply a
+// solution from the solution map are queued here.  A background
+// thread runs rocfft_offline_tuner on each one, benchmarking a
+// bounded number of kernel configurations, and writes the winning
+// solution to the user solution map folder given by
+// ROCFFT_USER_SOL_MAP_PATH.  Processes that set up rocFFT later read
+// that folder and use the tuned solution.
+//
+// Plans that use a solution transferred from another arch (see
+// ROCFFT_SOL_MAP_TRANSFER) are queued as well, and get a quicker pass
+// that benchmarks fewer configurations.
+//
+// Plans whose description asks to measure access modes are tuned
+// right away instead, trying only the access modes of the library's
+// own kernels.
+class OnlineTuner
+{
+    OnlineTuner();
+
+public:
+    // tuner is a singleton, so no copying or assignment
+    OnlineTuner(const OnlineTuner&) = delete;
+    OnlineTuner& operator=(const OnlineTuner&) = delete;
+
+    ~OnlineTuner();
+
+    static OnlineTuner& GetTuner()
+    {
+        static OnlineTuner tuner;
+        return tuner;
+    }
+
+    // Queue the plan's problem for tuning on the given device, if
+    // tuning on first use is enabled and the problem has not been
+    // queued already.  A quick pass refines a transferred solution.
+    void Enqueue(const rocfft_plan_t& plan, int deviceId, bool quick = false);
+
+    // Benchmark the access modes of the plan's kernels on the given
+    // device and write the winners to the user solution map folder,
+    // waiting for that to finish.  Returns true if a solution was
+    // written.  Each problem is only measured once per process.
+    bool MeasureAccessModes(const rocfft_plan_t& plan, int deviceId);
+
+    // Drop any problems that have not started yet and wait for the
+    // current one to finish.
+    void Stop();
+
+private:
+    void Worker();
+
+    // rocfft_offline_tuner arguments that describe the plan's problem
+    static std::vector<std::string> ProblemArgs(const rocfft_plan_t& plan);
+
+    // tune one problem, given the rocfft_offline_tuner arguments that
+    // describe it.  returns true if a solution was written.
+    bool Tune(int deviceId, const std::vector<std::string>& problemArgs);
+
+    // most problems to tune in this process, 0 disables tuning
+    size_t max_problems = 0;
+    // most kernel configurations to benchmark for each kernel
+    size_t max_candidates = 16;
+    // same, for a quick pass
+    size_t quick_max_candidates = 4;
+    // folder that tuned solutions are written to
+    std::string user_sol_map_path;
+
+    // problems queued so far, so each is only tuned once
+    std::set<std::vector<std::string>>                   seen;
+    std::deque<std::pair<int, std::vector<std::string>>> queue;
+    std::thread                                          worker;
+    bool                                                 running = false;
+    std::mutex                                           mtx;
+
+    // problems whose access modes were measured so far
+    std::set<std::vector<std::string>> measured;
+    // held while tuning, since tuning benchmarks the device
+    std::mutex tune_mtx;
+};
+
+#endif
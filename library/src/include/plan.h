@@ -22,9 +22,12 @@
 #define PLAN_H
 
 #include <array>
+#include <atomic>
 #include <complex>
 #include <cstring>
+#include <future>
 #include <list>
+#include <mutex>
 #include <vector>
 
 #ifdef ROCFFT_MPI_ENABLE
@@ -34,9 +37,14 @@
 #endif
 #endif
 
+#ifdef ROCFFT_RCCL_ENABLE
+#include <rccl/rccl.h>
+#endif
+
 #include "../../../shared/array_predicate.h"
 #include "function_pool.h"
 #include "load_store_ops.h"
+#include "plan_create_times.h"
 #include "tree_node.h"
 
 // Calculate the maximum pow number with the given base number
@@ -119,6 +127,20 @@ struct rocfft_field_t
     std::vector<rocfft_brick_t> bricks;
 };
 
+// Multi-device plans can split each brick of a field into slabs
+// along one dimension, so that work on a slab starts as soon as the
+// data it needs has arrived, while later slabs are still in flight.
+struct PipelineSlabs
+{
+    // dimension index the bricks are split along
+    size_t dim = 0;
+    // number of slabs per brick - 1 means no pipelining
+    size_t count = 1;
+
+    // return the slab'th slab of the brick
+    rocfft_brick_t slab(const rocfft_brick_t& brick, size_t slabIdx) const;
+};
+
 #ifdef ROCFFT_MPI_ENABLE
 class MPI_Comm_wrapper_t
 {
@@ -174,6 +196,16 @@ public:
         }
     }
 
+    // split into sub-communicators of ranks with the same color,
+    // ordered by key
+    MPI_Comm_wrapper_t split(int color, int key) const
+    {
+        MPI_Comm_wrapper_t ret;
+        if(MPI_Comm_split(mpi_comm, color, key, &ret.mpi_comm) != MPI_SUCCESS)
+            throw std::runtime_error("failed to split MPI communicator");
+        return ret;
+    }
+
     // check if communicator has been initialized
     operator bool() const
     {
@@ -211,10 +243,56 @@ struct rocfft_plan_description_t
 #ifdef ROCFFT_MPI_ENABLE
     MPI_Comm_wrapper_t mpi_comm;
 #endif
+#ifdef ROCFFT_RCCL_ENABLE
+    // not owned - the caller keeps the communicator alive
+    ncclComm_t rccl_comm = nullptr;
+#endif
 
     LoadOps  loadOps;
     StoreOps storeOps;
 
+    // buffer assignment strategy - minimizing buffers means the
+    // smallest work buffer footprint, possibly with fewer fusions
+    rocfft_optimize_strategy assignOptStrategy = rocfft_optimize_balance;
+
+    // if set, plan creation orders twiddle and chirp table
+    // generation with this stream instead of waiting for it
+    hipStream_t tableStream = nullptr;
+
+    // largest piece, in bytes, that multi-device plans stage when
+    // exchanging data between bricks.  0 means no limit.
+    size_t exchangeChunkBytes = 0;
+
+    // format that multi-device plans send exchanged data in.  Data
+    // is converted as it's packed and unpacked.
+    rocfft_storage_format exchangeStorage = rocfft_storage_format_native;
+
+    // devices that plan creation distributes the transform over.
+    // Empty means the plan runs on the current device.
+    std::vector<int> devices;
+
+    // number of transforms interleaved element by element in each
+    // block of the batch.  1 means batches are not tiled.
+    size_t batchTile = 1;
+
+    // if set, rocfft_execute is given host buffers, and stages them
+    // through the device in chunks of the batch
+    bool hostBuffers = false;
+
+    // if set, real-complex transforms store the Hermitian side in
+    // packed form: N/2 elements along the fastest dimension, with the
+    // real Nyquist data folded into the imaginary part of the first
+    bool packedHermitian = false;
+
+    // if set, plan creation benchmarks the access modes of block
+    // kernels on the device instead of choosing them from static
+    // rules, and keeps the winners in the user solution map
+    bool measureAccessModes = false;
+
+    // compute units the plan is confined to, as 32-bit words of a
+    // CU mask.  Empty means the whole device.
+    std::vector<uint32_t> cuMask;
+
     rocfft_plan_description_t()  = default;
     ~rocfft_plan_description_t() = default;
 
@@ -249,6 +327,19 @@ struct rocfft_plan_description_t
     }
 };
 
+// Cheap counters that are always kept, one set per plan and one for
+// the whole process, reported by rocfft_get_counters
+struct ExecutionCounters
+{
+    std::atomic<size_t> executions{0};
+    std::atomic<size_t> kernels_launched{0};
+    std::atomic<size_t> bytes_moved{0};
+    std::atomic<size_t> work_buffer_allocations{0};
+
+    // totals across all plans
+    static ExecutionCounters& Global();
+};
+
 struct rocfft_plan_t
 {
     size_t rank = 0;
@@ -265,8 +356,16 @@ struct rocfft_plan_t
 
     rocfft_plan_description_t desc;
 
+    // Status of plan creation, if the plan is being created
+    // asynchronously by rocfft_plan_create_async
+    std::shared_future<rocfft_status> pendingCreate;
+
     rocfft_plan_t() = default;
 
+    // Wait for asynchronous plan creation to finish (if the plan is
+    // being created asynchronously), and return its status
+    rocfft_status WaitCreate() const;
+
     // Users can provide lengths+strides in any order, but we'll
     // construct the most sensible plans if they're in row-major order.
     // Sort the FFT dimensions.
@@ -291,11 +390,35 @@ struct rocfft_plan_t
     // Add a new antecedent for an existing item index
     void AddAntecedent(size_t itemIdx, size_t antecedentIdx);
 
+    // Sort the items into issue order once all items and
+    // antecedents have been added.
+    void FinalizeMultiPlan();
+
     // Execute the multi-GPU plan.
     void Execute(void* in_buffer[], void* out_buffer[], rocfft_execution_info info);
 
     size_t WorkBufBytes() const;
 
+    // Return true if the plan can be executed without allocating
+    // resources or synchronizing with the host, so that execution
+    // can be captured into a hipGraph.
+    bool IsCaptureSafe() const;
+
+    // Return true if the plan is a single ExecPlan, whose passes
+    // can be addressed by their position in its execution sequence.
+    bool IsSingleExecPlan() const;
+
+    // Return the plan's ExecPlan if it is a single ExecPlan, or
+    // nullptr otherwise
+    ExecPlan* SingleExecPlan() const;
+
+    // Wait on the host for any tables that are still being
+    // generated, so that execution has nothing to wait for
+    void WaitTables() const;
+
+    // Fill out plan info for rocfft_plan_get_info
+    void GetInfo(rocfft_plan_info& info) const;
+
     // Insert core execPlan into multi-item plan, surrounding it with
     // sufficient items to gather/scatter to/from a single device if
     // the plan needs it.  Gathering all the data to a single device is
@@ -331,6 +454,62 @@ struct rocfft_plan_t
     // after the space requirements are finalized.
     void AllocateInternalTempBuffers();
 
+    // Build a convolution plan from the plan parameters in *this:
+    // a forward transform into a temp buffer whose store multiplies
+    // by the spectrum, followed by an inverse transform from the
+    // temp buffer.
+    rocfft_status BuildConvolutionPlan(const void*             kernel_spectrum,
+                                       rocfft_convolution_type convolution_type);
+
+    // For convolution plans, the plan's copy of the kernel spectrum
+    // (conjugated for correlation).  Empty for other plans.
+    gpubuf convolutionSpectrum;
+
+    // Build an analytic signal plan from the plan parameters in
+    // *this: a real forward transform into a temp buffer, followed
+    // by a complex inverse transform whose load applies the mask to
+    // the positive frequencies and zero-pads the negative ones.
+    rocfft_status BuildAnalyticSignalPlan();
+
+    // For analytic signal plans, the real mask that weights the
+    // positive frequencies.  Empty for other plans.
+    gpubuf analyticSignalMask;
+
+    // true for plans built from separately planned passes, which
+    // can't shrink their batch or run callbacks
+    bool HasSeparatePasses() const
+    {
+        return convolutionSpectrum.data() || analyticSignalMask.data();
+    }
+
+    // executions of this plan, updated as work is enqueued
+    ExecutionCounters counters;
+
+    // where plan creation spent its time
+    std::shared_ptr<PlanCreateTimes> createTimes = std::make_shared<PlanCreateTimes>();
+    void                             LogCreateTimes() const;
+
+    // identifies this plan's records in the replay log, 0 if the
+    // plan was not logged
+    size_t replayId = 0;
+
+    // graph that rocfft_execute_batch last launched for a batch
+    // starting with this plan, and the batch's list of plans.  Later
+    // batches of the same plans update it in place if their graphs
+    // have the same shape.
+    std::mutex               batchGraphMutex;
+    hipGraphExec_wrapper_t   batchGraph;
+    std::vector<rocfft_plan> batchGraphPlans;
+
+    // kernel that reads each transform's buffers from arrays of
+    // pointers, compiled on first use by rocfft_execute_pointer_array
+    std::once_flag             pointerArrayOnce;
+    std::unique_ptr<RTCKernel> pointerArrayKernel;
+
+    // decisions recorded by rocfft_plan_serialize, that plan
+    // creation replays instead of making them again
+    std::shared_ptr<const PlanDecisions> restore;
+
 private:
     // Multi-node or multi-GPU plan is built up from a vector of plan
     // items.  Items can launch kernels on a device, or move
@@ -351,16 +530,17 @@ private:
     // (i.e. its antecedents).
     std::vector<std::vector<size_t>> multiPlanAntecedents;
 
-    // Return a stack of multiPlan indexes that are in topological
-    // order.  Traverse this vector in reverse order to follow the
-    // sorting.
+    // Return multiPlan indexes in the order they should be issued,
+    // which is a topological order of the dependencies.  Items that
+    // just became ready are issued first, so work consuming a piece
+    // of data is launched before later pieces are processed.  The
+    // order is deterministic, so all ranks agree on it.
     std::vector<size_t> MultiPlanTopologicalSort() const;
 
-    // Recursive utility function to do depth-first search.  tracks
-    // visited indexes as it goes along.
-    void TopologicalSortDFS(size_t               idx,
-                            std::vector<bool>&   visited,
-                            std::vector<size_t>& sorted) const;
+    // Issue order of multiPlan, sorted once when plan creation
+    // finishes so that executions don't need to redo it.  Cleared
+    // whenever items or dependencies are added.
+    std::vector<size_t> multiPlanOrder;
 
     // Temp buffers allocated during plan creation for multi-device
     // plans are remembered here.  Mapped per-location.  Individual
@@ -391,42 +571,119 @@ private:
 
     // Transpose the input field to the output field by adding work items
     // to the plan.  Antecedents are provided as a vector of item
-    // indexes, one per brick.  Final work item per brick (that future
-    // per-brick operations can depend on) is returned in outputItems.
+    // indexes, one per brick.  Work items that write each output
+    // brick are returned in outputItems.
+    //
+    // If outputAntecedents is non-empty, it has one item per output
+    // brick that must complete before the brick is written (e.g. the
+    // last read of a buffer that in-place plans overwrite).
+    //
+    // Exchanges are staged in pieces no bigger than
+    // desc.exchangeChunkBytes, if set.  Exchanges are also split
+    // along the output bricks' pipeline slabs, so the next operation
+    // can start on a slab once it arrives.  The field coordinates
+    // written by each output item are returned in outputRegions.
     //
-    // transposeNumber identifies this particular transpose in the
-    // plan, for debugging.
-    void GlobalTranspose(size_t                     elem_size,
-                         const rocfft_field_t&      inField,
-                         const rocfft_field_t&      outField,
-                         std::vector<BufferPtr>&    input,
-                         std::vector<BufferPtr>&    output,
-                         const std::vector<size_t>& inputAntecedents,
-                         std::vector<size_t>&       outputItems,
-                         size_t                     transposeNumber);
+    // Pieces that are contiguous in the input or output brick are
+    // sent or received in place, without a pack or unpack.
+    //
+    // The fields hold elements of arrayType.  transposeNumber
+    // identifies this particular transpose in the plan, for
+    // debugging.
+    void GlobalTranspose(rocfft_array_type            arrayType,
+                         const rocfft_field_t&        inField,
+                         const rocfft_field_t&        outField,
+                         std::vector<BufferPtr>&      input,
+                         std::vector<BufferPtr>&      output,
+                         const std::vector<size_t>&   inputAntecedents,
+                         const std::vector<size_t>&   outputAntecedents,
+                         const PipelineSlabs&         pipeline,
+                         std::vector<size_t>&         outputItems,
+                         std::vector<rocfft_brick_t>& outputRegions,
+                         size_t                       transposeNumber);
+
+    // Implement GlobalTranspose as a single all-to-all collective,
+    // packing everything each rank sends into one buffer and
+    // unpacking from one receive buffer.  Only possible for
+    // multi-process plans where each rank has exactly one brick in
+    // each field.
+    // Pipelined transposes use one collective per slab.
+    // Returns false without adding any work items if the fields
+    // don't allow this.
+    bool AllToAllTranspose(rocfft_array_type            arrayType,
+                           const rocfft_field_t&        inField,
+                           const rocfft_field_t&        outField,
+                           std::vector<BufferPtr>&      input,
+                           std::vector<BufferPtr>&      output,
+                           const std::vector<size_t>&   inputAntecedents,
+                           const std::vector<size_t>&   outputAntecedents,
+                           const PipelineSlabs&         pipeline,
+                           std::vector<size_t>&         outputItems,
+                           std::vector<rocfft_brick_t>& outputRegions,
+                           size_t                       transposeNumber);
 
     // Transform (complex-complex FFT) a whole field along specified
     // dimensions.  Input and output ptrs are provided as a vector of
-    // BufferPtrs, one per brick in the field.
+    // BufferPtrs, one per brick in the field.  outField has the
+    // same bricks as field, but may store them with different
+    // strides if input and output are different buffers.
     //
     // Input antecedents, if provided, are the last items from the
     // previous global operation (e.g. a global transpose).  Operations
     // in this transform will depend on those antecedents that touch the
     // same buffers.
     //
-    // Work items are added to the plan.  Final work item per brick (that
-    // future per-brick operations can depend on) is returned in
-    // outputItems.
-    void C2CField(const rocfft_field_t&      field,
-                  const std::vector<size_t>& fftDims,
-                  std::vector<BufferPtr>&    input,
-                  std::vector<BufferPtr>&    output,
-                  const std::vector<size_t>& inputAntecedents,
-                  std::vector<size_t>&       outputItems);
+    // If inputRegions are provided (parallel to inputAntecedents,
+    // giving the field coordinates each antecedent wrote), each brick
+    // is transformed in the pipeline's slabs, and each slab depends
+    // only on the antecedents that wrote it.
+    //
+    // Work items are added to the plan.  Final work items (that
+    // future per-brick operations can depend on) are returned in
+    // outputItems - one per brick, unless the bricks were split into
+    // slabs.
+    void C2CField(const rocfft_field_t&              field,
+                  const rocfft_field_t&              outField,
+                  const std::vector<size_t>&         fftDims,
+                  std::vector<BufferPtr>&            input,
+                  std::vector<BufferPtr>&            output,
+                  const std::vector<size_t>&         inputAntecedents,
+                  const std::vector<rocfft_brick_t>& inputRegions,
+                  const PipelineSlabs&               pipeline,
+                  std::vector<size_t>&               outputItems);
 };
 
 bool PlanPowX(ExecPlan& execPlan);
+// run setup kernels whose output can be kept in the Repo
+void PrecomputeBluesteinChirps(ExecPlan& execPlan);
+// find nodes that can run concurrently on separate streams
+void ScheduleExecSeq(ExecPlan& execPlan);
+// find runs of nodes that can execute slab by slab in cache
+void ScheduleSlabs(ExecPlan& execPlan);
 bool GetTuningKernelInfo(ExecPlan& execPlan);
+// start compiling each node's kernels in the background
+void StartRuntimeCompilePlan(ExecPlan& execPlan);
+// wait for the compiles, and check that the kernels support what
+// their nodes need
+void FinishRuntimeCompilePlan(ExecPlan& execPlan);
 void RuntimeCompilePlan(ExecPlan& execPlan);
+// estimate of the global memory traffic for one kernel launch
+size_t KernelBytesMoved(const TreeNode& node);
+// estimate of the floating-point operations for one kernel launch,
+// from the kernel's factorization.  0 for kernels that only move data.
+double KernelFlops(const TreeNode& node);
+
+// rocfft-bench command line that reproduces the plan's parameters
+std::string rocfft_bench_command(const rocfft_plan_t* plan);
+
+rocfft_status rocfft_plan_allocate(rocfft_plan* plan);
+rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
+                                          const rocfft_result_placement placement,
+                                          const rocfft_transform_type   transform_type,
+                                          const rocfft_precision        precision,
+                                          const size_t                  dimensions,
+                                          const size_t*                 lengths,
+                                          const size_t                  number_of_transforms,
+                                          const rocfft_plan_description description);
 
 #endif // PLAN_H
@@ -0,0 +1,106 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_PLAN_CACHE_H
+#define ROCFFT_PLAN_CACHE_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "tree_node.h"
+
+struct rocfft_plan_t;
+
+// In-process cache of fully-built single-device ExecPlans.
+//
+// Creating a plan that is identical to one that was already built
+// (same lengths, batch, precision, placement, description and target
+// device) can reuse the earlier plan's tree instead of re-running
+// tree building, buffer assignment, fusion and kernel lookup.
+//
+// Cached ExecPlans share their TreeNodes (and so their kernels,
+// twiddles and device-side kernel arguments) with every plan handed
+// out from the cache.  The tree is released when the last plan
+// using it is destroyed and it has been evicted from the cache.
+//
+// The cache is opt-in: it is enabled by setting the
+// ROCFFT_PLAN_CACHE_SIZE environment variable to the maximum number
+// of entries to keep.  Least-recently-used entries are evicted once
+// that limit is reached.
+class PlanCache
+{
+    PlanCache();
+
+public:
+    // cache is a singleton, so no copying or assignment
+    PlanCache(const PlanCache&) = delete;
+    PlanCache& operator=(const PlanCache&) = delete;
+
+    static PlanCache& GetCache()
+    {
+        static PlanCache cache;
+        return cache;
+    }
+
+    // Return true if the cache is enabled and the plan's parameters
+    // are eligible for caching.
+    bool Cacheable(const rocfft_plan_t& plan) const;
+
+    // Build the canonical key for a plan whose parameters have been
+    // defaulted and sorted, to be executed on the specified device.
+    static std::string MakeKey(const rocfft_plan_t&   plan,
+                               const hipDeviceProp_t& deviceProp,
+                               int                    deviceId);
+
+    // Return a new ExecPlan that shares the tree of a cached plan,
+    // or nullptr if no plan for the key is cached.
+    std::unique_ptr<ExecPlan> Get(const std::string& key);
+
+    // Remember a newly-built ExecPlan.
+    void Put(const std::string& key, const ExecPlan& execPlan);
+
+    // Return a new ExecPlan that shares the tree of the provided
+    // ExecPlan.
+    static std::unique_ptr<ExecPlan> ShareExecPlan(const ExecPlan& execPlan);
+
+    // Remove all cached plans.
+    void Clear();
+
+private:
+    // maximum number of entries, 0 means the cache is disabled
+    size_t max_entries = 0;
+
+    // most-recently-used keys are at the front of the list
+    std::list<std::string> lru;
+
+    struct entry_t
+    {
+        std::unique_ptr<ExecPlan>        execPlan;
+        std::list<std::string>::iterator lru_pos;
+    };
+    std::map<std::string, entry_t> entries;
+
+    std::mutex mtx;
+};
+
+#endif
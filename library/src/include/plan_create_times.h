@@ -0,0 +1,125 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_PLAN_CREATE_TIMES_H
+#define ROCFFT_PLAN_CREATE_TIMES_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+// Phases of plan creation that are timed for
+// rocfft_plan_get_create_times and the plan log
+enum PlanCreatePhase
+{
+    PCP_SOLUTION_MAP,
+    PCP_BUILD_TREE,
+    PCP_FUSION,
+    PCP_BUFFER_ASSIGNMENT,
+    PCP_KERNEL_GENERATION,
+    PCP_RTC_CACHE_LOOKUP,
+    PCP_RTC_COMPILE,
+    PCP_MODULE_LOAD,
+    PCP_TABLES,
+    PCP_COUNT,
+};
+
+// Time spent in each phase of one plan's creation.  Kernels are
+// compiled on worker threads, so phases are accumulated atomically
+// and the kernel phases are summed over all workers.
+struct PlanCreateTimes
+{
+    std::array<std::atomic<uint64_t>, PCP_COUNT> phase_ns{};
+    std::atomic<uint64_t>                        total_ns{0};
+
+    double ms(PlanCreatePhase phase) const
+    {
+        return phase_ns[phase] / 1e6;
+    }
+
+    // times of the plan being created on this thread, or null if
+    // no plan creation is running here
+    static std::shared_ptr<PlanCreateTimes>& Current()
+    {
+        static thread_local std::shared_ptr<PlanCreateTimes> current;
+        return current;
+    }
+};
+
+// Makes a plan's times current on this thread for the lifetime of
+// the scope, so that work done on behalf of the plan (including on
+// worker threads) is charged to it
+class PlanCreateTimesScope
+{
+public:
+    explicit PlanCreateTimesScope(std::shared_ptr<PlanCreateTimes> times)
+        : prev(std::move(PlanCreateTimes::Current()))
+    {
+        PlanCreateTimes::Current() = std::move(times);
+    }
+    ~PlanCreateTimesScope()
+    {
+        PlanCreateTimes::Current() = std::move(prev);
+    }
+    PlanCreateTimesScope(const PlanCreateTimesScope&) = delete;
+    PlanCreateTimesScope& operator=(const PlanCreateTimesScope&) = delete;
+
+private:
+    std::shared_ptr<PlanCreateTimes> prev;
+};
+
+// RAII timer that charges its lifetime to a phase of the current
+// plan's creation.  Does nothing if no plan is being created.
+class PlanCreateTimer
+{
+public:
+    explicit PlanCreateTimer(PlanCreatePhase phase)
+        : times(PlanCreateTimes::Current().get())
+        , phase(phase)
+    {
+        if(times)
+            start = std::chrono::steady_clock::now();
+    }
+    ~PlanCreateTimer()
+    {
+        Stop();
+    }
+    // stop timing before the end of the scope
+    void Stop()
+    {
+        if(!times)
+            return;
+        times->phase_ns[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count();
+        times = nullptr;
+    }
+    PlanCreateTimer(const PlanCreateTimer&) = delete;
+    PlanCreateTimer& operator=(const PlanCreateTimer&) = delete;
+
+private:
+    PlanCreateTimes*                      times;
+    PlanCreatePhase                       phase;
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif
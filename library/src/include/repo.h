@@ -23,12 +23,26 @@
 #define REPO_H
 
 #include "../../../shared/gpubuf.h"
+#include "../../../shared/hip_object_wrapper.h"
+#include <functional>
+#include <list>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <vector>
 
 class Repo
 {
-    Repo() {}
+    Repo();
+
+    static std::string radices_str(const std::vector<size_t>& radices)
+    {
+        std::string ret;
+        for(auto r : radices)
+            ret += "_" + std::to_string(r);
+        return ret;
+    }
 
     // key structure for 1D twiddles - these are the arguments to
     // twiddle creation
@@ -62,8 +76,18 @@ class Repo
                 return radices < other.radices;
             return deviceId < other.deviceId;
         }
+
+        // identifies the table to other processes, apart from the
+        // device
+        std::string str() const
+        {
+            return "twd1D_" + std::to_string(length) + "_" + std::to_string(length_limit) + "_"
+                   + std::to_string(precision) + "_" + std::to_string(large_twiddle_base) + "_"
+                   + std::to_string(attach_halfN) + radices_str(radices);
+        }
     };
-    // key structure for 2D twiddles
+    // key structure for 2D twiddles.  3D_SINGLE twiddles are
+    // also kept here, with a nonzero third length.
     struct repo_twd_key_2D_t
     {
         size_t              length0   = 0;
@@ -71,6 +95,8 @@ class Repo
         rocfft_precision    precision = rocfft_precision_single;
         std::vector<size_t> radices1;
         std::vector<size_t> radices2;
+        size_t              length2 = 0;
+        std::vector<size_t> radices3;
         // buffers are in device memory, so we need per-device
         // twiddles
         int deviceId = 0;
@@ -87,8 +113,20 @@ class Repo
                 return radices1 < other.radices1;
             if(radices2 != other.radices2)
                 return radices2 < other.radices2;
+            if(length2 != other.length2)
+                return length2 < other.length2;
+            if(radices3 != other.radices3)
+                return radices3 < other.radices3;
             return deviceId < other.deviceId;
         }
+
+        std::string str() const
+        {
+            return "twd2D_" + std::to_string(length0) + "_" + std::to_string(length1) + "_"
+                   + std::to_string(length2) + "_" + std::to_string(precision) + "_r1"
+                   + radices_str(radices1) + "_r2" + radices_str(radices2) + "_r3"
+                   + radices_str(radices3);
+        }
     };
     // key structure for chirp table
     struct repo_chirp_key_t
@@ -107,6 +145,43 @@ class Repo
                 return precision < other.precision;
             return deviceId < other.deviceId;
         }
+
+        std::string str() const
+        {
+            return "chirp_" + std::to_string(length) + "_" + std::to_string(precision);
+        }
+    };
+
+    // key structure for a chirp followed by its forward FFT, as
+    // read by single-kernel Bluestein
+    struct repo_chirp_fft_key_t
+    {
+        size_t           length     = 0;
+        size_t           lengthBlue = 0;
+        rocfft_precision precision  = rocfft_precision_single;
+        int              direction  = -1;
+        // buffers are in device memory, so we need per-device
+        // chirps
+        int deviceId = 0;
+
+        bool operator<(const repo_chirp_fft_key_t& other) const
+        {
+            if(length != other.length)
+                return length < other.length;
+            if(lengthBlue != other.lengthBlue)
+                return lengthBlue < other.lengthBlue;
+            if(precision != other.precision)
+                return precision < other.precision;
+            if(direction != other.direction)
+                return direction < other.direction;
+            return deviceId < other.deviceId;
+        }
+
+        std::string str() const
+        {
+            return "chirpFFT_" + std::to_string(length) + "_" + std::to_string(lengthBlue) + "_"
+                   + std::to_string(precision) + "_" + std::to_string(direction);
+        }
     };
 
     // twiddle tables are buffers in device memory, along with a
@@ -118,14 +193,34 @@ class Repo
     std::map<repo_twd_key_1D_t, std::pair<gpubuf, unsigned int>> twiddles_1D;
     std::map<repo_twd_key_2D_t, std::pair<gpubuf, unsigned int>> twiddles_2D;
 
-    std::map<repo_chirp_key_t, std::pair<gpubuf, unsigned int>> chirp;
+    std::map<repo_chirp_key_t, std::pair<gpubuf, unsigned int>>     chirp;
+    std::map<repo_chirp_fft_key_t, std::pair<gpubuf, unsigned int>> chirp_fft;
 
     // reverse-map the device pointers back to the keys so users can
     // free the pointer they were given
     std::map<void*, repo_twd_key_1D_t> twiddles_1D_reverse;
     std::map<void*, repo_twd_key_2D_t> twiddles_2D_reverse;
 
-    std::map<void*, repo_chirp_key_t> chirp_reverse;
+    std::map<void*, repo_chirp_key_t>     chirp_reverse;
+    std::map<void*, repo_chirp_fft_key_t> chirp_fft_reverse;
+
+    // If ROCFFT_TWIDDLE_CACHE_SIZE is set to a number of bytes, tables
+    // whose reference count drops to zero are retained for reuse, up
+    // to that many bytes in total.  The least recently released tables
+    // are evicted first.
+    size_t                                      retain_limit   = 0;
+    size_t                                      retained_bytes = 0;
+    std::list<void*>                            retained;
+    std::map<void*, std::list<void*>::iterator> retained_pos;
+
+    // take a reference to a table, taking it out of retention if
+    // nothing was using it
+    std::pair<void*, size_t> Acquire(std::pair<gpubuf, unsigned int>& entry);
+    // keep an unreferenced table, returning false if it should be
+    // freed instead
+    bool Retain(void* ptr, size_t bytes);
+    // free retained tables until they total no more than limit bytes
+    void EvictRetained(size_t limit);
 
     static std::mutex mtx;
 
@@ -184,14 +279,44 @@ public:
                                                   bool                       attach_halfN2,
                                                   const std::vector<size_t>& radices1,
                                                   const std::vector<size_t>& radices2);
+    // 3D twiddles are released with ReleaseTwiddle2D
+    static std::pair<void*, size_t> GetTwiddles3D(size_t                     length0,
+                                                  size_t                     length1,
+                                                  size_t                     length2,
+                                                  rocfft_precision           precision,
+                                                  const hipDeviceProp_t&     deviceProp,
+                                                  const std::vector<size_t>& radices1,
+                                                  const std::vector<size_t>& radices2,
+                                                  const std::vector<size_t>& radices3);
     static std::pair<void*, size_t>
         GetChirp(size_t length, rocfft_precision precision, const hipDeviceProp_t& deviceProp);
+    // Get a buffer of the given size holding a length-lengthBlue
+    // chirp followed by its forward FFT.  populate is called to
+    // enqueue the buffer's generation on a stream if the repo does
+    // not have it yet.  Released with ReleaseChirp.
+    static std::pair<void*, size_t>
+        GetChirpFFT(size_t                                         length,
+                    size_t                                         lengthBlue,
+                    rocfft_precision                               precision,
+                    int                                            direction,
+                    size_t                                         bytes,
+                    const std::function<void(void*, hipStream_t)>& populate);
     static void ReleaseTwiddle1D(void* ptr);
     static void ReleaseTwiddle2D(void* ptr);
     static void ReleaseChirp(void* ptr);
     // remove cached twiddles/chirp
     static void Clear();
 
+    // Tables are generated asynchronously on a per-device table
+    // stream.  Order generation of the current device's tables after
+    // work already enqueued on stream.
+    static void BeginTables(hipStream_t stream);
+    // Finish generating tables on the current device.  If stream is
+    // null, wait for generation to complete and return nullptr.
+    // Otherwise, order stream after the tables and return an event
+    // that is signalled once they are ready.
+    static std::shared_ptr<hipEvent_wrapper_t> EndTables(hipStream_t stream);
+
     // Repo is a singleton that should only be destroyed on static
     // deinitialization.  But it's possible for other things to want to
     // destroy plans at static deinitialization time.  So keep track of
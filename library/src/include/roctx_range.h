@@ -0,0 +1,75 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_ROCTX_RANGE_H
+#define ROCFFT_ROCTX_RANGE_H
+
+#include "logging.h"
+#include <string>
+
+#ifdef ROCFFT_ROCTX_ENABLE
+#include <roctracer/roctx.h>
+#endif
+
+// RAII roctx range around a phase of plan creation or a kernel
+// launch, so that profiler timelines show what rocFFT is doing.
+// Ranges are compiled in with ROCFFT_ROCTX_ENABLE, and pushed when
+// rocfft_layer_mode_roctx is set in ROCFFT_LAYER.
+class RoctxRange
+{
+public:
+    // true if ranges would be pushed, so callers can skip building
+    // names for them
+    static bool Enabled()
+    {
+#ifdef ROCFFT_ROCTX_ENABLE
+        return ROCTX_ENABLED();
+#else
+        return false;
+#endif
+    }
+
+    explicit RoctxRange(const char* name)
+    {
+#ifdef ROCFFT_ROCTX_ENABLE
+        if(Enabled())
+            pushed = roctxRangePush(name) >= 0;
+#endif
+    }
+    explicit RoctxRange(const std::string& name)
+        : RoctxRange(name.c_str())
+    {
+    }
+    ~RoctxRange()
+    {
+#ifdef ROCFFT_ROCTX_ENABLE
+        if(pushed)
+            roctxRangePop();
+#endif
+    }
+
+    RoctxRange(const RoctxRange&) = delete;
+    RoctxRange& operator=(const RoctxRange&) = delete;
+
+private:
+    bool pushed = false;
+};
+
+#endif // ROCFFT_ROCTX_RANGE_H
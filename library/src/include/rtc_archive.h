@@ -0,0 +1,91 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef ROCFFT_RTC_ARCHIVE_H
+#define ROCFFT_RTC_ARCHIVE_H
+
+#include "mapped_file.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Read-only archive of ahead-of-time compiled code objects.
+//
+// This is an alternative to shipping the AOT cache as a sqlite
+// database.  The archive is a flat file that is memory-mapped when
+// opened, so looking up a kernel is a binary search over a sorted
+// hash index, and the code object is handed out as a pointer into
+// the mapping without being copied.
+//
+// Layout, with all integers in native byte order:
+//
+//   header: magic[8], format version (u64), HIP version (i64),
+//           generator_sum[32], entry count (u64)
+//   index:  entry count * { key hash (u64), key offset (u64),
+//           key length (u64), code offset (u64), code length (u64) },
+//           sorted by hash and then key
+//   keys:   kernel_name + '\0' + arch for each entry
+//   code:   code objects, each aligned to CODE_ALIGN bytes
+//
+// An archive only holds kernels for one HIP version and one
+// generator_sum.  Lookups for anything else miss.
+class RTCArchive
+{
+public:
+    // map the archive at the path.  throws if the file can't be
+    // mapped or is not a valid archive.
+    explicit RTCArchive(const std::filesystem::path& path);
+
+    RTCArchive(const RTCArchive&) = delete;
+    RTCArchive& operator=(const RTCArchive&) = delete;
+
+    // return true if the file at the path starts with the archive
+    // magic
+    static bool is_archive(const std::filesystem::path& path);
+
+    // find a code object.  returns a pointer into the mapping and the
+    // code size, or a null pointer if the kernel is not present.  The
+    // pointer is valid for the lifetime of the archive.
+    std::pair<const char*, size_t> find(const std::string&          kernel_name,
+                                        const std::string&          gpu_arch,
+                                        const std::array<char, 32>& generator_sum) const;
+
+    struct record
+    {
+        std::string       kernel_name;
+        std::string       arch;
+        std::vector<char> code;
+    };
+
+    // write an archive containing the given records, replacing any
+    // existing file at the path.  throws on error.
+    static void write(const std::filesystem::path& path,
+                      const std::array<char, 32>&  generator_sum,
+                      const std::vector<record>&   records);
+
+private:
+    MappedFile mapping;
+};
+
+#endif
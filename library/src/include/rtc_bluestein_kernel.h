@@ -28,7 +28,7 @@
 struct RTCKernelBluesteinSingle : public RTCKernel
 {
     RTCKernelBluesteinSingle(const std::string&       kernel_name,
-                             const std::vector<char>& code,
+                             const RTCLoadableModule& code,
                              dim3                     gridDim,
                              dim3                     blockDim)
         : RTCKernel(kernel_name, code, gridDim, blockDim)
@@ -51,7 +51,8 @@ struct RTCKernelBluesteinMulti : public RTCKernel
                             size_t                   M,
                             size_t                   numof,
                             size_t                   count,
-                            const std::vector<char>& code,
+                            size_t                   root,
+                            const RTCLoadableModule& code,
                             dim3                     gridDim,
                             dim3                     blockDim)
         : RTCKernel(kernel_name, code, gridDim, blockDim)
@@ -60,6 +61,7 @@ struct RTCKernelBluesteinMulti : public RTCKernel
         , M(M)
         , numof(numof)
         , count(count)
+        , root(root)
     {
     }
 
@@ -75,6 +77,8 @@ private:
     size_t        M;
     size_t        numof;
     size_t        count;
+    // primitive root for rader kernels
+    size_t root;
 };
 
 #endif
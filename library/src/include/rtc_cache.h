@@ -22,9 +22,11 @@
 #define ROCFFT_RTC_CACHE_H
 
 #include "rocfft/rocfft.h"
+#include "rtc_archive.h"
 #include "rtc_generator.h"
 #include "sqlite3.h"
 #include <array>
+#include <atomic>
 #include <future>
 #include <map>
 #include <memory>
@@ -62,6 +64,23 @@ struct sqlite3_stmt_deleter
 typedef std::unique_ptr<sqlite3, sqlite3_deleter>           sqlite3_ptr;
 typedef std::unique_ptr<sqlite3_stmt, sqlite3_stmt_deleter> sqlite3_stmt_ptr;
 
+// process-wide counters of kernel cache activity, reported by
+// rocfft_cache_get_stats
+struct RTCCacheStats
+{
+    std::atomic<size_t>   memory_hits{0};
+    std::atomic<size_t>   user_hits{0};
+    std::atomic<size_t>   system_hits{0};
+    std::atomic<size_t>   misses{0};
+    std::atomic<uint64_t> compile_ns{0};
+    std::atomic<size_t>   bytes_stored{0};
+    std::atomic<size_t>   evictions{0};
+    std::atomic<size_t>   memory_evictions{0};
+};
+
+// prepended to every generated kernel source before it is compiled
+static const char* const RTC_KERNEL_SRC_PREAMBLE = "#define ROCFFT_CALLBACKS_ENABLED\n";
+
 struct RTCCache
 {
     // Get compiled code object for a kernel.  Checks the cache to
@@ -72,9 +91,12 @@ struct RTCCache
     // the source, and updates the cache before returning the compiled
     // kernel.  Tries in-process compile first and falls back to
     // subprocess if necessary.
+    //
+    // A cache hit only looks at the kernel name, arch and
+    // generator_sum - the generator is not copied or called.
     static std::vector<char> cached_compile(const std::string&          kernel_name,
                                             const std::string&          gpu_arch_with_flags,
-                                            kernel_src_gen_t            generate_src,
+                                            const kernel_src_gen_t&     generate_src,
                                             const std::array<char, 32>& generator_sum);
 
     RTCCache();
@@ -82,9 +104,20 @@ struct RTCCache
 
     // get bytes for a matching code object from the cache.
     // returns empty vector if a matching kernel was not found.
+    // if hit_tier is given, it is set to "user" or "system" on a hit.
     std::vector<char> get_code_object(const std::string&          kernel_name,
                                       const std::string&          gpu_arch,
-                                      const std::array<char, 32>& generator_sum);
+                                      const std::array<char, 32>& generator_sum,
+                                      const char**                hit_tier = nullptr);
+
+    // get a matching code object from the system-level AOT archive,
+    // if one is in use.  returns a pointer into the archive's memory
+    // mapping that remains valid until the cache is destroyed, or a
+    // null pointer if the kernel was not found.
+    std::pair<const char*, size_t>
+        get_archived_code_object(const std::string&          kernel_name,
+                                 const std::string&          gpu_arch,
+                                 const std::array<char, 32>& generator_sum);
 
     // store the code object into the cache.
     void store_code_object(const std::string&          kernel_name,
@@ -92,10 +125,31 @@ struct RTCCache
                            const std::array<char, 32>& generator_sum,
                            const std::vector<char>&    code);
 
+    // coordinate compiles with other processes sharing the user
+    // cache file, so that only one of them compiles a given kernel.
+    //
+    // returns the code object if another process compiled it while
+    // we waited.  otherwise returns an empty vector, and sets
+    // "claimed" to true if this process now owns the compile and
+    // must call release_compile once it's stored the result.
+    std::vector<char> claim_compile(const std::string&          kernel_name,
+                                    const std::string&          gpu_arch,
+                                    const std::array<char, 32>& generator_sum,
+                                    bool&                       claimed);
+    void              release_compile(const std::string&          kernel_name,
+                                      const std::string&          gpu_arch,
+                                      const std::array<char, 32>& generator_sum);
+
     // allocates buffer, call serialize_free to free it
     rocfft_status serialize(void** buffer, size_t* buffer_len_bytes);
+    // serialize only kernels whose timestamp is at least "since" (a
+    // Unix time, in seconds)
+    rocfft_status serialize_since(sqlite3_int64 since, void** buffer, size_t* buffer_len_bytes);
     static void   serialize_free(void* buffer);
-    rocfft_status deserialize(const void* buffer, size_t buffer_len_bytes);
+    // add kernels from a serialized buffer to the cache.  kernels
+    // already in the cache are replaced, unless "merge" is true, in
+    // which case existing rows are left alone.
+    rocfft_status deserialize(const void* buffer, size_t buffer_len_bytes, bool merge = false);
 
     // adjust the current cache file to be write-mostly, such as doing
     // many compilations in parallel when building the library
@@ -109,17 +163,26 @@ struct RTCCache
                          const std::array<char, 32>&     generator_sum,
                          const std::vector<std::string>& gpu_archs);
 
-    // remove kernels in the current cache to keep it roughly under a
-    // target size - this counts just the kernel name and code
-    // length, and ignores other overhead like indexes and other
-    // metadata about the kernels
+    // write out the same kernels as write_aot_cache, but as a
+    // memory-mappable RTCArchive instead of a sqlite database
+    void write_aot_archive(const std::string&              output_path,
+                           const std::array<char, 32>&     generator_sum,
+                           const std::vector<std::string>& gpu_archs);
+
+    // remove least-recently-used kernels in the current cache to
+    // keep it roughly under a target size - this counts just the
+    // kernel name and code length, and ignores other overhead like
+    // indexes and other metadata about the kernels
     void cleanup_cache(sqlite3_int64 target_size_bytes);
 
     // singleton allocated in rocfft_setup and freed in rocfft_cleanup
     static std::unique_ptr<RTCCache> single;
 
+    // counters outlive the singleton, so they cover the whole process
+    static RTCCacheStats stats;
+
 private:
-    sqlite3_ptr connect_db(const std::filesystem::path& path, bool readonly);
+    static sqlite3_ptr connect_db(const std::filesystem::path& path, bool readonly);
 
     // database handles to system- and user-level caches.  either or
     // both may be a null pointer, if that particular cache could not
@@ -127,6 +190,14 @@ private:
     sqlite3_ptr db_sys;
     sqlite3_ptr db_user;
 
+    // system-level cache, if it was shipped as an archive instead of
+    // a database
+    std::unique_ptr<RTCArchive> archive_sys;
+
+    // fill the temp.aot_arch table with the architectures to write
+    // to an AOT cache
+    void set_aot_archs(const std::vector<std::string>& gpu_archs);
+
     // query handles, with mutexes to prevent concurrent queries that
     // might stomp on one another's bound values
     sqlite3_stmt_ptr get_stmt_sys;
@@ -136,8 +207,69 @@ private:
     sqlite3_stmt_ptr store_stmt_user;
     std::mutex       store_mutex_user;
 
-    // lock around deserialization, since that attaches a fixed-name
-    // schema to the db and we don't want a collision
+    // update the timestamp of a kernel in the user cache, so
+    // cleanup_cache knows it was recently used.  uses
+    // store_mutex_user.
+    sqlite3_stmt_ptr touch_stmt_user;
+    void             touch_code_object(const std::string&          kernel_name,
+                                       const std::string&          gpu_arch,
+                                       const std::array<char, 32>& generator_sum);
+
+    // statements to manage rows in the pending_v1 table of the user
+    // cache.  a row means some process is compiling that kernel.
+    // only prepared if the user cache is a file that other processes
+    // can see.
+    sqlite3_stmt_ptr claim_stmt_user;
+    sqlite3_stmt_ptr release_stmt_user;
+    sqlite3_stmt_ptr expire_stmt_user;
+    std::mutex       pending_mutex_user;
+    // run one of the above statements on a kernel, returning the
+    // number of rows changed
+    int run_pending_stmt(sqlite3_stmt*               s,
+                         const std::string&          kernel_name,
+                         const std::string&          gpu_arch,
+                         const std::array<char, 32>& generator_sum);
+
+    // extra read-only connections to a cache file, so lookups from
+    // many threads don't all queue up on one statement.  each
+    // connection is used by one thread at a time, and new connections
+    // are opened when all existing ones are busy.
+    struct read_connection
+    {
+        sqlite3_ptr      db;
+        sqlite3_stmt_ptr get_stmt;
+    };
+    struct read_pool
+    {
+        // path to the cache file.  empty if the cache is in-memory,
+        // in which case only the main connection can see it
+        std::filesystem::path                         path;
+        std::vector<std::unique_ptr<read_connection>> idle;
+        std::mutex                                    mutex;
+
+        // get an idle connection, opening a new one if necessary.
+        // returns nullptr if no connection could be opened.
+        std::unique_ptr<read_connection> acquire();
+        void                             release(std::unique_ptr<read_connection> conn);
+    };
+    read_pool read_pool_sys;
+    read_pool read_pool_user;
+
+    // look up a code object in one cache, using a pooled connection
+    // if possible and the shared statement otherwise.  also returns
+    // the kernel's timestamp.
+    static std::vector<char> get_code_object_impl(const std::string&          kernel_name,
+                                                  const std::string&          gpu_arch,
+                                                  const std::array<char, 32>& generator_sum,
+                                                  sqlite3_ptr&                db,
+                                                  sqlite3_stmt_ptr&           get_stmt,
+                                                  std::mutex&                 get_mutex,
+                                                  read_pool&                  pool,
+                                                  sqlite3_int64&              timestamp);
+
+    // lock around (de)serialization of part of the cache, since that
+    // attaches a fixed-name schema to the db and we don't want a
+    // collision
     std::mutex deserialize_mutex;
 
     // keep track of compiles we've started but haven't finished, so
@@ -38,7 +38,7 @@ struct RTCKernelChirp : public RTCKernel
 
 protected:
     RTCKernelChirp(const std::string&       kernel_name,
-                   const std::vector<char>& code,
+                   const RTCLoadableModule& code,
                    dim3                     gridDim,
                    dim3                     blockDim)
         : RTCKernel(kernel_name, code, gridDim, blockDim)
@@ -0,0 +1,107 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef ROCFFT_RTC_COMPILE_SCHEDULER_H
+#define ROCFFT_RTC_COMPILE_SCHEDULER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+// Fixed-size pool of threads that run runtime compilation work.
+//
+// Plans start one compile per kernel, and many plans may be created
+// at once.  Running each compile on its own thread would start an
+// unbounded number of concurrent hiprtc invocations or helper
+// subprocesses, so compiles are queued here and run on at most
+// ROCFFT_RTC_COMPILE_THREADS threads (default: number of available
+// CPUs).
+//
+// Work submitted from a thread inside a BackgroundScope (such as
+// cache prefetching) is only started when no other work is queued,
+// so plans that callers are waiting on go first.
+//
+// Identical compiles are still deduplicated by RTCCache's pending
+// compile map.
+class RTCCompileScheduler
+{
+    RTCCompileScheduler();
+
+public:
+    // scheduler is a singleton, so no copying or assignment
+    RTCCompileScheduler(const RTCCompileScheduler&) = delete;
+    RTCCompileScheduler& operator=(const RTCCompileScheduler&) = delete;
+
+    static RTCCompileScheduler& GetScheduler()
+    {
+        // deliberately never destroyed - workers are detached and may
+        // still be waiting for work at static deinitialization
+        static RTCCompileScheduler* scheduler = new RTCCompileScheduler;
+        return *scheduler;
+    }
+
+    // queue work to run on a compile thread, returning a future for
+    // its result
+    template <typename T>
+    std::shared_future<T> Submit(std::function<T()> work)
+    {
+        auto task   = std::make_shared<std::packaged_task<T()>>(std::move(work));
+        auto future = task->get_future().share();
+        Enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    // while an instance is alive, work submitted by the current
+    // thread has background priority
+    struct BackgroundScope
+    {
+        BackgroundScope()
+        {
+            background_thread = true;
+        }
+        ~BackgroundScope()
+        {
+            background_thread = false;
+        }
+    };
+
+private:
+    void Enqueue(std::function<void()> task);
+    void Worker();
+
+    static thread_local bool background_thread;
+
+    std::deque<std::function<void()>> queue;
+    std::deque<std::function<void()>> background_queue;
+
+    // workers are started on demand, up to max_workers
+    size_t max_workers  = 1;
+    size_t num_workers  = 0;
+    size_t idle_workers = 0;
+
+    std::mutex              mtx;
+    std::condition_variable cv;
+};
+
+#endif
@@ -0,0 +1,42 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef RTC_GENERIC_GEN
+#define RTC_GENERIC_GEN
+
+#include "rocfft/rocfft.h"
+#include <hip/hip_runtime_api.h>
+#include <string>
+
+// Generic Stockham kernels take the length, factorization and
+// twiddle table of a 1D FFT as arguments instead of baking them into
+// the code, so one kernel per precision can run any length.  They
+// are much slower than the specialized kernels, and exist so a plan
+// can start executing while its specialized kernels are compiled.
+static const unsigned int GENERIC_THREADS = 256;
+// largest radix the generic kernel's butterfly supports
+static const unsigned int GENERIC_MAX_RADIX = 17;
+
+// generate name for generic Stockham kernel
+std::string generic_rtc_kernel_name(rocfft_precision precision);
+// generate source for generic Stockham kernel
+std::string generic_rtc(const std::string& kernel_name, rocfft_precision precision);
+
+#endif // RTC_GENERIC_GEN
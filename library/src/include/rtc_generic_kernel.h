@@ -0,0 +1,71 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_RTC_GENERIC_KERNEL_H
+#define ROCFFT_RTC_GENERIC_KERNEL_H
+
+#include "rtc_generic_gen.h"
+#include "rtc_kernel.h"
+
+// Generic Stockham kernel, used in place of a node's specialized
+// kernel until that finishes compiling in the background.
+//
+// Enabled by setting the ROCFFT_RTC_GENERIC_FALLBACK environment
+// variable to 1.  Only plain 1D Stockham nodes are supported: no
+// callbacks, load/store ops other than scaling, large twiddles or
+// fused real/Bluestein processing, and interleaved data.
+struct RTCKernelGeneric : public RTCKernel
+{
+    // true if the environment enables the fallback and node can
+    // run on the generic kernel
+    static bool supports(const TreeNode& node);
+
+    // return the generic kernel for node, loading it from the RTC
+    // cache (or compiling it) if need be.  Each node gets its own
+    // kernel object, sharing the loaded module.
+    static std::unique_ptr<RTCKernelGeneric> generate_from_node(const TreeNode&    node,
+                                                                const std::string& gpu_arch);
+
+    RTCKernelArgs get_launch_args(DeviceCallIn& data) override;
+
+    // launch for the node, with the generic kernel's own grid
+    // instead of the one chosen for the specialized kernel
+    void launch_fallback(const DeviceCallIn& data, const hipDeviceProp_t& deviceProp);
+
+    // dynamic LDS for one transform
+    unsigned int lds_bytes = 0;
+
+protected:
+    RTCKernelGeneric(const std::string&       kernel_name,
+                     const RTCLoadableModule& code,
+                     dim3                     gridDim,
+                     dim3                     blockDim)
+        : RTCKernel(kernel_name, code, gridDim, blockDim)
+    {
+    }
+};
+
+// Return the node's generic kernel if its specialized kernel is
+// still compiling, or nullptr if the specialized kernel should be
+// used.  Once the compile is done the node switches to the
+// specialized kernel for good.
+RTCKernelGeneric* rtc_fallback_kernel(const TreeNode& node);
+
+#endif // ROCFFT_RTC_GENERIC_KERNEL_H
@@ -25,8 +25,11 @@
 #include <hip/hip_runtime_api.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <future>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -76,6 +79,12 @@ public:
     {
         append(&data, sizeof(T), 8);
     }
+    // append another kernel's arguments, which start with an
+    // 8-byte aligned value
+    void append_args(const RTCKernelArgs& args)
+    {
+        append(args.data(), args.size_bytes(), 8);
+    }
 
     size_t size_bytes() const
     {
@@ -85,6 +94,10 @@ public:
     {
         return buf.data();
     }
+    const void* data() const
+    {
+        return buf.data();
+    }
 
 private:
     void append(const void* src, size_t nbytes, size_t align = 0)
@@ -103,6 +116,45 @@ private:
     std::vector<char> buf;
 };
 
+// A code object loaded onto the current device.  Unloaded when the
+// last kernel using it is destroyed.
+struct RTCModule
+{
+    RTCModule(const std::string& kernel_name, const void* image)
+    {
+        if(hipModuleLoadData(&module, image) != hipSuccess)
+            throw std::runtime_error("failed to load module for " + kernel_name);
+    }
+    ~RTCModule()
+    {
+        (void)hipModuleUnload(module);
+    }
+
+    RTCModule(const RTCModule&) = delete;
+    void operator=(const RTCModule&) = delete;
+
+    hipModule_t module = nullptr;
+};
+
+// Where a kernel gets its module from: a compiled code object to
+// load, or a module that's already loaded.  Kernels constructed from
+// a loaded module keep it, even if the module cache has since
+// dropped it.
+struct RTCLoadableModule
+{
+    RTCLoadableModule(const std::vector<char>& code)
+        : code(&code)
+    {
+    }
+    RTCLoadableModule(std::shared_ptr<RTCModule> module)
+        : module(std::move(module))
+    {
+    }
+
+    const std::vector<char>*   code = nullptr;
+    std::shared_ptr<RTCModule> module;
+};
+
 // Base class for a runtime compiled kernel.  Subclassed for
 // different kernel types that each have their own details about how
 // to be launched.
@@ -118,18 +170,17 @@ struct RTCKernel
                         std::string&       kernel_name,
                         bool               enable_callbacks = false);
 
-    // take already-compiled code object and prepare to launch the
-    // named kernel
+    // take an already-compiled code object or loaded module and
+    // prepare to launch the named kernel
     RTCKernel(const std::string&       kernel_name,
-              const std::vector<char>& code,
+              const RTCLoadableModule& code,
               dim3                     gridDim  = {},
               dim3                     blockDim = {});
 
     virtual ~RTCKernel()
     {
         kernel = nullptr;
-        (void)hipModuleUnload(module);
-        module = nullptr;
+        module.reset();
     }
 
     // disallow copies, since we expect this to be managed by smart ptr
@@ -147,6 +198,14 @@ struct RTCKernel
                 unsigned int           lds_bytes,
                 const hipDeviceProp_t& deviceProp,
                 hipStream_t            stream = nullptr);
+    // direct launch with an already-packed argument buffer
+    void launch(void*                  kargs,
+                size_t                 kargs_bytes,
+                dim3                   gridDim,
+                dim3                   blockDim,
+                unsigned int           lds_bytes,
+                const hipDeviceProp_t& deviceProp,
+                hipStream_t            stream = nullptr);
 
     // normal launch from within rocFFT execution plan
     bool get_occupancy(dim3 blockDim, unsigned int lds_bytes, int& occupancy);
@@ -157,9 +216,10 @@ struct RTCKernel
     virtual RTCKernelArgs get_launch_args(DeviceCallIn& data) = 0;
 #endif
 
-    // function to construct the correct RTCKernel object, given a kernel name and its compiled code
+    // function to construct the correct RTCKernel object, given a kernel name and its compiled
+    // code or loaded module
     using rtckernel_construct_t = std::function<std::unique_ptr<RTCKernel>(
-        const std::string&, const std::vector<char>&, dim3, dim3)>;
+        const std::string&, const RTCLoadableModule&, dim3, dim3)>;
 
     // grid parameters for this kernel.  may be set by runtime
     // compilation, if compilation of this kernel type knows how to.
@@ -195,8 +255,36 @@ protected:
     };
 #endif
 
-    hipModule_t   module = nullptr;
-    hipFunction_t kernel = nullptr;
+    // module may be shared with other kernels that use the same code
+    // object
+    std::shared_ptr<RTCModule> module;
+    hipFunction_t              kernel = nullptr;
+
+private:
+#ifndef ROCFFT_DEBUG_GENERATE_KERNEL_HARNESS
+    // A kernel object is only launched for one node, so its
+    // arguments are packed once on the first launch.  Buffer and
+    // callback pointers can change between executions, so the
+    // offsets they were packed at are remembered and overwritten on
+    // each launch.
+    struct ArgPatch
+    {
+        size_t offset;
+        // index of the per-execution value written here
+        size_t source;
+        // added to the value, for arguments that point partway into
+        // a buffer
+        uint64_t delta;
+        // value is packed as unsigned int, rather than a pointer
+        bool is_u32;
+    };
+    void pack_launch_args(DeviceCallIn& data);
+
+    std::once_flag        packed_once;
+    bool                  packed_valid = false;
+    std::vector<char>     packed_args;
+    std::vector<ArgPatch> packed_patches;
+#endif
 };
 
 #ifndef ROCFFT_DEBUG_GENERATE_KERNEL_HARNESS
@@ -0,0 +1,107 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#ifndef ROCFFT_RTC_MODULE_CACHE_H
+#define ROCFFT_RTC_MODULE_CACHE_H
+
+#include <array>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "rtc_kernel.h"
+
+// In-process cache of loaded code objects, in front of the on-disk
+// RTC cache.
+//
+// Looking up a kernel in the RTC cache queries sqlite under a mutex,
+// and constructing an RTCKernel loads the code object onto the
+// device.  Plans that need a kernel that is already loaded can
+// instead share the loaded module, so repeatedly creating plans does
+// no database queries or module loads at all.
+//
+// Modules are keyed by kernel name and device.  Least-recently-used
+// modules are dropped from the cache once the limit set by the
+// ROCFFT_RTC_MODULE_CACHE_SIZE environment variable (a number of
+// entries) is reached.  A size of 0 disables the cache.  Modules
+// stay loaded as long as any RTCKernel still uses them.
+class RTCModuleCache
+{
+    RTCModuleCache();
+
+public:
+    // cache is a singleton, so no copying or assignment
+    RTCModuleCache(const RTCModuleCache&) = delete;
+    RTCModuleCache& operator=(const RTCModuleCache&) = delete;
+
+    static RTCModuleCache& GetCache()
+    {
+        // deliberately never destroyed - static deinitialization may
+        // run after the HIP runtime is gone, so modules must not be
+        // unloaded then.  rocfft_cleanup empties the cache.
+        static RTCModuleCache* cache = new RTCModuleCache;
+        return *cache;
+    }
+
+    // Return the module for the named kernel on the current device,
+    // or nullptr if it is not loaded.
+    std::shared_ptr<RTCModule> Find(const std::string& kernel_name);
+
+    // Like Find, but if the module is not loaded and the kernel is in
+    // the system-level AOT archive, load it directly from the
+    // archive's memory mapping and cache it.
+    std::shared_ptr<RTCModule> Find(const std::string&          kernel_name,
+                                    const std::string&          gpu_arch,
+                                    const std::array<char, 32>& generator_sum);
+
+    // Return the module for the named kernel on the current device,
+    // loading the code object if the module is not already cached.
+    std::shared_ptr<RTCModule> Load(const std::string& kernel_name, const std::vector<char>& code);
+    std::shared_ptr<RTCModule> Load(const std::string& kernel_name, const void* image);
+
+    // Drop all cached modules.
+    void Clear();
+
+private:
+    // Find, without counting a hit
+    std::shared_ptr<RTCModule> Lookup(const std::string& kernel_name);
+
+    typedef std::pair<int, std::string> key_t;
+
+    struct entry_t
+    {
+        std::shared_ptr<RTCModule> module;
+        std::list<key_t>::iterator lru_pos;
+    };
+
+    std::map<key_t, entry_t> entries;
+    // most recently used key at the front
+    std::list<key_t> lru;
+
+    size_t max_entries = 256;
+
+    std::mutex mtx;
+};
+
+#endif
@@ -0,0 +1,37 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef RTC_RADIX_GEN
+#define RTC_RADIX_GEN
+
+#include <string>
+#include <vector>
+
+// prime radices above 17 that have no hand-written butterfly, and
+// whose butterflies are generated instead
+static const std::vector<unsigned int> generated_prime_radices
+    = {19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61};
+
+// generate source for the forward and inverse butterflies of a
+// prime radix, with the same signature as the hand-written ones
+// (FwdRad<N>B1 and InvRad<N>B1 taking N pointers)
+std::string prime_radix_rtc(unsigned int radix);
+
+#endif // RTC_RADIX_GEN
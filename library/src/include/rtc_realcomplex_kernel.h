@@ -26,7 +26,7 @@
 struct RTCKernelRealComplex : public RTCKernel
 {
     RTCKernelRealComplex(const std::string&       kernel_name,
-                         const std::vector<char>& code,
+                         const RTCLoadableModule& code,
                          dim3                     gridDim,
                          dim3                     blockDim)
         : RTCKernel(kernel_name, code, gridDim, blockDim)
@@ -44,7 +44,7 @@ struct RTCKernelRealComplexEven : public RTCKernel
 {
     RTCKernelRealComplexEven(const std::string&       kernel_name,
                              size_t                   half_N,
-                             const std::vector<char>& code,
+                             const RTCLoadableModule& code,
                              dim3                     gridDim,
                              dim3                     blockDim)
         : RTCKernel(kernel_name, code, gridDim, blockDim)
@@ -63,7 +63,7 @@ struct RTCKernelRealComplexEven : public RTCKernel
 struct RTCKernelRealComplexEvenTranspose : public RTCKernel
 {
     RTCKernelRealComplexEvenTranspose(const std::string&       kernel_name,
-                                      const std::vector<char>& code,
+                                      const RTCLoadableModule& code,
                                       dim3                     gridDim,
                                       dim3                     blockDim)
         : RTCKernel(kernel_name, code, gridDim, blockDim)
@@ -80,7 +80,7 @@ struct RTCKernelRealComplexEvenTranspose : public RTCKernel
 struct RTCKernelApplyCallback : public RTCKernel
 {
     RTCKernelApplyCallback(const std::string&       kernel_name,
-                           const std::vector<char>& code,
+                           const RTCLoadableModule& code,
                            dim3                     gridDim,
                            dim3                     blockDim)
         : RTCKernel(kernel_name, code, gridDim, blockDim)
@@ -23,6 +23,7 @@
 
 #include <vector>
 
+#include "../device/generator/generator.h"
 #include "../device/generator/stockham_gen.h"
 #include "compute_scheme.h"
 #include "load_store_ops.h"
@@ -44,6 +45,7 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
                                      size_t                        largeTwdBase,
                                      size_t                        largeTwdSteps,
                                      bool                          largeTwdBatchIsTransformCount,
+                                     size_t                        largeTwdComputeLength,
                                      EmbeddedType                  ebtype,
                                      DirectRegType                 dir2regMode,
                                      IntrinsicAccessType           intrinsicMode,
@@ -53,9 +55,32 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
                                      const LoadOps&                loadOps,
                                      const StoreOps&               storeOps);
 
+// One phase of a fused kernel, filled in by stockham_rtc.  The
+// phase's source defines a device function run_block in namespace
+// name, that does the work of one block of the standalone kernel.
+struct StockhamFusedPhase
+{
+    std::string               name;
+    std::string               src;
+    ArgumentList              arguments;
+    unsigned int              workgroup_size = 0;
+    std::vector<unsigned int> factors;
+    bool                      large_twiddles = false;
+    bool                      real_complex   = false;
+};
+
 // generate source for RTC stockham kernel.  transforms_per_block may
 // be nullptr, but if non-null, stockham_rtc stores the number of
-// transforms each threadblock will do
+// transforms each threadblock will do.  A persistent kernel runs the
+// transform for each entry of a work queue, instead of once per
+// launch.  A grouped kernel reads each batch's input and output
+// offsets from device tables, instead of computing them from the
+// batch distance.  A pointer-array kernel reads each batch's input
+// and output pointers from device arrays.  A direction of 0 builds a kernel that takes the
+// direction as its last argument before any load/store op arguments.
+// If fused_phase is non-null, the kernel is generated as a phase of
+// a fused kernel instead, and the returned source is also stored in
+// fused_phase.
 std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
                          const StockhamGeneratorSpecs& specs2d,
                          unsigned int*                 transforms_per_block,
@@ -70,6 +95,7 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
                          size_t                        largeTwdBase,
                          size_t                        largeTwdSteps,
                          bool                          largeTwdBatchIsTransformCount,
+                         size_t                        largeTwdComputeLength,
                          EmbeddedType                  ebtype,
                          DirectRegType                 dir2regMode,
                          IntrinsicAccessType           intrinsicMode,
@@ -77,6 +103,27 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
                          CallbackType                  cbtype,
                          const BluesteinFuseType&      fuseBlue,
                          const LoadOps&                loadOps,
-                         const StoreOps&               storeOps);
+                         const StoreOps&               storeOps,
+                         bool                          persistent    = false,
+                         bool                          grouped       = false,
+                         bool                          pointer_array = false,
+                         StockhamFusedPhase*           fused_phase   = nullptr);
+
+// Generate source for a kernel that runs each phase's blocks in
+// turn, with a grid-wide barrier between phases.  Every block of
+// the kernel must be resident at once for the barrier to complete.
+std::string stockham_fused_rtc(const std::string&                     kernel_name,
+                               rocfft_precision                       precision,
+                               const std::vector<StockhamFusedPhase>& phases);
+
+// Generate source for a device function that does one 1D transform
+// in LDS, for user kernels to call.  The function is named
+// function_name, and threads_per_transform receives the number of
+// threads that must call it together for each transform.
+std::string stockham_device_function_rtc(const StockhamGeneratorSpecs& specs,
+                                         const std::string&            function_name,
+                                         int                           direction,
+                                         rocfft_precision              precision,
+                                         unsigned int&                 threads_per_transform);
 
 #endif
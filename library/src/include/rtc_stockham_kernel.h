@@ -23,17 +23,43 @@
 
 #include "rtc_kernel.h"
 
+struct StockhamFusedPhase;
+
 struct RTCKernelStockham : public RTCKernel
 {
-    RTCKernelStockham(const std::string& kernel_name, const std::vector<char>& code)
+    RTCKernelStockham(const std::string& kernel_name, const RTCLoadableModule& code)
         : RTCKernel(kernel_name, code)
         , hardcoded_dim(kernel_name.find("_dim") != std::string::npos)
+        , runtime_direction(kernel_name.find("_anydir") != std::string::npos)
+        , static_layout(kernel_name.find("_layout_") != std::string::npos)
     {
     }
 
-    static RTCKernel::RTCGenerator generate_from_node(const TreeNode&    node,
-                                                      const std::string& gpu_arch,
-                                                      bool               enable_callbacks);
+    static RTCKernel::RTCGenerator generate_from_node(const TreeNode&     node,
+                                                      const std::string&  gpu_arch,
+                                                      bool                enable_callbacks,
+                                                      bool                persistent    = false,
+                                                      bool                grouped       = false,
+                                                      bool                pointer_array = false,
+                                                      StockhamFusedPhase* fused_phase   = nullptr);
+
+    // Compile a persistent kernel that runs the node's transform for
+    // each entry of a work queue.  Returns nullptr if the node has no
+    // Stockham kernel.
+    static std::unique_ptr<RTCKernel> compile_persistent(const TreeNode&    node,
+                                                         const std::string& gpu_arch);
+
+    // Compile a grouped kernel that reads each batch's offsets from
+    // tables, appended to the node's launch arguments.  Returns
+    // nullptr if the node has no Stockham kernel.
+    static std::unique_ptr<RTCKernel> compile_grouped(const TreeNode&    node,
+                                                      const std::string& gpu_arch);
+
+    // Compile a pointer-array kernel, whose input and output buffer
+    // arguments are device arrays of one pointer per batch.  Returns
+    // nullptr if the node has no Stockham kernel.
+    static std::unique_ptr<RTCKernel> compile_pointer_array(const TreeNode&    node,
+                                                            const std::string& gpu_arch);
 
     virtual RTCKernelArgs get_launch_args(DeviceCallIn& data) override;
 
@@ -55,11 +81,69 @@ protected:
         }
     };
 
+    // compile a variant of a node's kernel that is never precompiled
+    static std::unique_ptr<RTCKernel> compile_variant(const RTCGenerator& generator,
+                                                      const std::string&  gpu_arch);
+
 private:
     // true if the kernel is hardcoded for a number of dimensions.
     // kernels generated at runtime will be, but ahead-of-time
     // compiled kernels won't.
     bool hardcoded_dim;
+    // true if the kernel does both directions, and takes the
+    // direction as an argument
+    bool runtime_direction;
+    // true if the kernel's lengths and strides are compiled in,
+    // instead of being passed as arguments
+    bool static_layout;
+};
+
+// A kernel that does an L1D_CC plan's column and row kernels in
+// one launch.  Each block of the kernel works through column
+// blocks, waits at a grid-wide barrier for every block to finish,
+// and then works through row blocks.
+struct RTCKernelStockhamFused : public RTCKernelStockham
+{
+    RTCKernelStockhamFused(const std::string&       kernel_name,
+                           const RTCLoadableModule& code,
+                           unsigned int             columns_wgs,
+                           unsigned int             rows_wgs)
+        : RTCKernelStockham(kernel_name, code)
+        , columns_wgs(columns_wgs)
+        , rows_wgs(rows_wgs)
+    {
+    }
+
+    // Start compiling a kernel for the columns node and the rows
+    // node that follows it.  Returns an invalid future if the
+    // ROCFFT_RTC_FUSE_L1D environment variable is not set, or if
+    // the nodes can't be fused.
+    static std::shared_future<std::unique_ptr<RTCKernel>>
+        runtime_compile(const TreeNode& columns, const TreeNode& rows, const std::string& gpu_arch);
+
+    // true if every block of the kernel fits on the device at once
+    // for these grids
+    bool can_launch(const GridParam&       columns,
+                    const GridParam&       rows,
+                    const hipDeviceProp_t& deviceProp);
+
+    // launch both nodes.  barrier points to an unsigned int of
+    // device memory that the kernel may use, which is cleared on
+    // the stream before launching.
+    void launch_fused(DeviceCallIn& columns, DeviceCallIn& rows, void* barrier);
+
+private:
+    unsigned int columns_wgs;
+    unsigned int rows_wgs;
+
+    // launch configuration, decided on the first call to can_launch
+    std::once_flag config_once;
+    bool           config_valid = false;
+    unsigned int   config_blocks;
+    unsigned int   config_wgs;
+    unsigned int   config_lds_bytes;
+    unsigned int   columns_lds_stride;
+    unsigned int   rows_lds_stride;
 };
 
 #endif
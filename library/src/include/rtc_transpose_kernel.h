@@ -26,7 +26,7 @@
 struct RTCKernelTranspose : public RTCKernel
 {
     RTCKernelTranspose(const std::string&       kernel_name,
-                       const std::vector<char>& code,
+                       const RTCLoadableModule& code,
                        dim3                     gridDim,
                        dim3                     blockDim)
         : RTCKernel(kernel_name, code, gridDim, blockDim)
@@ -39,7 +39,7 @@ struct RTCKernelTwiddle : public RTCKernel
 
 protected:
     RTCKernelTwiddle(const std::string&       kernel_name,
-                     const std::vector<char>& code,
+                     const RTCLoadableModule& code,
                      dim3                     gridDim,
                      dim3                     blockDim)
         : RTCKernel(kernel_name, code, gridDim, blockDim)
@@ -23,7 +23,10 @@
 #ifndef SOLUTION_MAP_H
 #define SOLUTION_MAP_H
 
+#include "solution_map_archive.h"
 #include "tree_node.h"
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 #if __has_include(<filesystem>)
@@ -139,6 +142,9 @@ struct SolutionNode
     FMKey            kernel_key    = FMKey::EmptyFMKey();
     // like the childnodes on tree-node, a childnode could be internal/leaf/kernel-node
     std::vector<SolutionPtr> solution_childnodes;
+    // checksum of the kernel generator that a SOL_KERNEL_ONLY node was
+    // tuned with, empty if unknown.  not part of the node's identity.
+    std::string generator_sum;
 
     SolutionNode()                    = default;
     SolutionNode(const SolutionNode&) = default;
@@ -229,6 +235,25 @@ class solution_map
     ProbSolMap primary_sol_map;
     ProbSolMap temp_working_map;
 
+    // binary solution maps read into the primary map.  each archive
+    // is mapped on the first lookup that misses the primary map, and
+    // its entries are only parsed when they are looked up.
+    struct archive_source
+    {
+        fs::path                            path;
+        std::unique_ptr<SolutionMapArchive> archive;
+        bool                                failed = false;
+    };
+    std::vector<archive_source> archives;
+
+    // lookups can load entries from archives into the primary map,
+    // possibly from several threads creating plans at once
+    std::mutex lookup_mutex;
+
+    // arch whose solutions are used for problems that the current
+    // arch has no solution for, empty if transfer is disabled
+    std::string transfer_arch;
+
     ROCFFT_EXPORT solution_map();
 
 private:
@@ -250,6 +275,32 @@ private:
 
     void generate_link_info();
 
+    // map an archive if that has not been tried yet.  returns false
+    // if the archive can't be used.
+    bool map_archive(archive_source& src);
+
+    // find the solutions of a problem, loading them from an archive
+    // if they are not in the primary map yet.  returns nullptr if
+    // there are none.  lookup_mutex must be held.
+    SolutionNodeVec* find_solutions(const ProblemKey& probKey, bool primary_map);
+
+    // load the entries of all archives into the primary map, for
+    // operations that need to see the whole map
+    void load_all_archives();
+
+    // parse entries in text form and add them to a map
+    void add_entry_texts(const std::vector<std::string>& texts, ProbSolMap& dst_map);
+
+    // read the maps of solutions tuned on first use, from
+    // ROCFFT_USER_SOL_MAP_PATH
+    void read_user_folder(const std::string& arch_name);
+
+    static std::shared_ptr<solution_map>& active_map()
+    {
+        static std::shared_ptr<solution_map> sol_map(new solution_map);
+        return sol_map;
+    }
+
 public:
     // the latest version number of solution-map's format
     static const int VERSION;
@@ -264,16 +315,65 @@ public:
 
     solution_map& operator=(const solution_map&) = delete;
 
+    // the map in use is swapped out by a reload, so callers that look
+    // up solutions while other threads may reload must hold on to
+    // acquire_solution_map() instead.  the old map is freed when the
+    // last of them lets go of it.
     static solution_map& get_solution_map()
     {
-        static solution_map sol_map;
-        return sol_map;
+        return *acquire_solution_map();
+    }
+
+    static std::shared_ptr<solution_map> acquire_solution_map()
+    {
+        return std::atomic_load(&active_map());
     }
 
+    // build a new map and swap it in for lookups that start
+    // afterwards.  path is a solution map file, or a folder of them
+    // like ROCFFT_READ_SOL_MAP_FROM_FOLDER.  an empty path re-reads
+    // the maps given by the environment.  returns false and keeps the
+    // current map if a given file can't be read.
+    static bool reload(const std::string&     path,
+                       const std::string&     arch_name,
+                       const hipDeviceProp_t& prop);
+
     ~solution_map() = default;
 
     void setup(const std::string& arch_name);
 
+    // when ROCFFT_SOL_MAP_TRANSFER is set, pick the shipped arch most
+    // similar to the device to transfer solutions from
+    void setup_transfer_arch(const std::string& arch_name, const hipDeviceProp_t& prop);
+
+    const std::string& get_transfer_arch() const
+    {
+        return transfer_arch;
+    }
+
+    // arch key for solutions tuned on a partitioned or CU-masked
+    // device, e.g. "gfx942_cu32".  The CU count is rounded down to a
+    // power of 2.  Empty if the device has all of its arch's CUs, or
+    // the arch's full CU count is not known.
+    static std::string get_cu_bucket_arch(const std::string& arch_name,
+                                          const hipDeviceProp_t& prop);
+
+    // arch key that solutions tuned on the device are written under
+    static std::string get_tuning_arch(const std::string&     arch_name,
+                                       const hipDeviceProp_t& prop)
+    {
+        auto bucket_arch = get_cu_bucket_arch(arch_name, prop);
+        return bucket_arch.empty() ? arch_name : bucket_arch;
+    }
+
+    // number of CUs the solutions under an arch key were tuned on, or
+    // 0 if not known (e.g. for "any")
+    static int get_arch_num_CUs(const std::string& arch);
+
+    // remove every solution from both maps, so the tuner can start
+    // over for another tree shape
+    void clear();
+
     bool
         has_solution_node(const ProblemKey& probKey, size_t option_id = 0, bool primary_map = true);
 
@@ -322,10 +422,26 @@ public:
     // that are not used (replaced by newly-tuned), default false, return all kernels
     bool get_all_kernels(std::vector<SolutionNode>& sol_kernels, bool getUsedOnly = false);
 
+    // get the SOL_KERNEL_ONLY nodes that the solutions of the given
+    // problem tokens use, for every arch that has them.  tokens with
+    // no solution are returned in missing_tokens.
+    bool get_kernels_of_problems(const std::set<std::string>& prob_tokens,
+                                 std::vector<SolutionNode>&   sol_kernels,
+                                 std::set<std::string>&       missing_tokens);
+
+    // get the root problems whose kernels were tuned with a different
+    // kernel generator than the current one
+    bool get_stale_root_problems(std::vector<ProblemKey>& stale_probs);
+
+    // checksum of the current kernel generator, as recorded on tuned kernels
+    static const std::string& current_generator_sum();
+
     // parse the format version of the input file
     bool get_solution_map_version(const fs::path& sol_map_in_path);
 
-    // read the map from input stream
+    // read the map from input stream.  binary archives read into the
+    // primary map are only registered here, their entries are loaded
+    // when they are looked up.
     bool read_solution_map_data(const fs::path& sol_map_in_path, bool primary_map = true);
 
     // write the map to output stream,
@@ -334,6 +450,10 @@ public:
                                  bool            sort        = true,
                                  bool            primary_map = true);
 
+    // write the map as a binary archive, which loads faster than the
+    // text format
+    bool write_binary_solution_map_data(const fs::path& sol_map_out_path, bool primary_map = true);
+
     // merge solutions from src_file to primary map
     bool merge_solutions_from_file(const fs::path&                src_file,
                                    const std::vector<ProblemKey>& root_probs);
@@ -354,7 +474,11 @@ public:
     SolutionMapConverter()  = default;
     ~SolutionMapConverter() = default;
 
-    bool VersionCheckAndConvert(const std::string& in_map_path, const std::string& out_map_path);
+    // convert the input map to the latest version, writing a binary
+    // archive instead of a text map if binary is true
+    bool VersionCheckAndConvert(const std::string& in_map_path,
+                                const std::string& out_map_path,
+                                bool               binary = false);
 };
 
 #endif // SOLUTION_MAP_H
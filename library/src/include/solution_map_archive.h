@@ -0,0 +1,90 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_SOLUTION_MAP_ARCHIVE_H
+#define ROCFFT_SOLUTION_MAP_ARCHIVE_H
+
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Read-only binary form of a solution map, written by
+// rocfft_solmap_convert --binary.
+//
+// Parsing a text solution map reads every entry, so it gets slower
+// as more problems are tuned.  The archive is memory-mapped instead,
+// and a lookup is a binary search over a sorted hash index that only
+// touches the entry being looked up.  Each entry is kept in the same
+// text form as a .dat file, so it is parsed with the same code.
+//
+// Layout, with all integers in native byte order:
+//
+//   header: magic[8], format version (u64), solution map version
+//           (u64), entry count (u64)
+//   index:  entry count * { key hash (u64), key offset (u64),
+//           key length (u64), entry offset (u64), entry length (u64) },
+//           sorted by hash and then key
+//   keys:   arch + '\0' + problem token for each entry
+//   entries: text of each entry
+class SolutionMapArchive
+{
+public:
+    // map the archive at the path.  throws if the file can't be
+    // mapped or is not a valid archive.
+    explicit SolutionMapArchive(const std::filesystem::path& path);
+
+    SolutionMapArchive(const SolutionMapArchive&) = delete;
+    SolutionMapArchive& operator=(const SolutionMapArchive&) = delete;
+
+    // return true if the file at the path starts with the archive
+    // magic
+    static bool is_archive(const std::filesystem::path& path);
+
+    // version of the solution map format that the entries are in
+    uint64_t map_version() const;
+
+    // find the text of the entry for a problem, or an empty string
+    // if the problem is not present
+    std::string find(const std::string& arch, const std::string& prob_token) const;
+
+    // text of every entry in the archive
+    std::vector<std::string> all_entries() const;
+
+    struct record
+    {
+        std::string arch;
+        std::string prob_token;
+        std::string text;
+    };
+
+    // write an archive containing the given records, replacing any
+    // existing file at the path.  throws on error.
+    static void write(const std::filesystem::path& path,
+                      uint64_t                     map_version,
+                      const std::vector<record>&   records);
+
+private:
+    MappedFile mapping;
+};
+
+#endif
@@ -0,0 +1,88 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_STREAM_POOL_H
+#define ROCFFT_STREAM_POOL_H
+
+#include "../../../shared/rocfft_hip.h"
+#include <map>
+#include <mutex>
+#include <vector>
+
+// Pool of streams and events, used to run a plan's independent
+// nodes concurrently.
+//
+// Streams are non-blocking and events are created without timing,
+// and both are kept per device so that executions don't need to
+// create and destroy them each time.  A stream returned to the pool
+// may still have work queued on it; whoever acquires it next only
+// orders its work after that.
+class StreamPool
+{
+    StreamPool() = default;
+
+public:
+    // pool is a singleton, so no copying or assignment
+    StreamPool(const StreamPool&) = delete;
+    StreamPool& operator=(const StreamPool&) = delete;
+
+    static StreamPool& GetPool()
+    {
+        static StreamPool pool;
+        return pool;
+    }
+
+    // Get a stream or event for the current device, creating one if
+    // none are free.  Returns nullptr on failure.
+    hipStream_t AcquireStream();
+    hipEvent_t  AcquireEvent();
+
+    // Return objects previously obtained from Acquire* for the
+    // current device
+    void ReleaseStream(hipStream_t stream);
+    void ReleaseEvent(hipEvent_t event);
+
+    // Destroy all free streams and events
+    void Clear();
+
+private:
+    std::map<int, std::vector<hipStream_t>> streams;
+    std::map<int, std::vector<hipEvent_t>>  events;
+
+    std::mutex mtx;
+};
+
+// RAII set of streams and events from the pool, returned to the
+// pool when destroyed
+struct PooledStreams
+{
+    PooledStreams() = default;
+    ~PooledStreams();
+    PooledStreams(const PooledStreams&) = delete;
+    PooledStreams& operator=(const PooledStreams&) = delete;
+
+    // returns false if the pool could not provide everything
+    bool alloc(size_t streamCount, size_t eventCount);
+
+    std::vector<hipStream_t> streams;
+    std::vector<hipEvent_t>  events;
+};
+
+#endif
@@ -21,25 +21,141 @@
 #ifndef TRANSFORM_H
 #define TRANSFORM_H
 
+#include "../../../shared/hip_object_wrapper.h"
 #include "../../../shared/rocfft_hip.h"
+#include "rocfft/rocfft.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Ring of event pairs that time kernels launched by executions with
+// profiling enabled.  Events are recorded on the execution's stream
+// and elapsed times are only read once the stop event has
+// completed, so profiling never waits for the device.
+struct ExecutionProfile
+{
+    explicit ExecutionProfile(size_t capacity)
+        : slots(capacity)
+    {
+    }
+
+    // count a new execution, first collecting times of kernels
+    // from earlier executions that have finished
+    void StartExecution();
+
+    // record the start of a kernel on a stream, returning the slot
+    // that times it
+    size_t Begin(hipStream_t stream);
+    // record the end of the kernel timed by a slot
+    void End(size_t slot, hipStream_t stream, size_t kernel_index, size_t bytes_moved);
+
+    // move times of finished kernels to 'finished', in launch order
+    void Harvest();
+
+    // copy and remove up to 'count' of the oldest finished times
+    size_t Take(rocfft_kernel_profile* records, size_t count);
+    size_t FinishedCount();
+
+private:
+    struct Slot
+    {
+        hipEvent_wrapper_t    start;
+        hipEvent_wrapper_t    stop;
+        int                   device  = -1;
+        bool                  pending = false;
+        rocfft_kernel_profile record  = {};
+    };
+    void HarvestLocked();
+    void HarvestSlot(Slot& slot);
+
+    std::mutex        mutex;
+    std::vector<Slot> slots;
+    // next slot to record in, which is also the oldest
+    size_t next = 0;
+    // number of executions started, and index of the current one
+    size_t                             executions = 0;
+    size_t                             current    = 0;
+    std::vector<rocfft_kernel_profile> finished;
+};
+
+// Times of plan items run by executions with item timing enabled.
+// Items are timed on the host as they're run one at a time, so
+// there is nothing to collect from the device later.
+struct ExecutionItemTimes
+{
+    explicit ExecutionItemTimes(size_t capacity)
+        : capacity(capacity)
+    {
+    }
+
+    // count a new execution, returning its index
+    size_t StartExecution();
+
+    void Add(const rocfft_plan_item_time& record);
+
+    // copy and remove up to 'count' of the oldest times
+    size_t Take(rocfft_plan_item_time* records, size_t count);
+    size_t Count();
+
+private:
+    std::mutex                         mutex;
+    size_t                             capacity;
+    size_t                             executions = 0;
+    std::vector<rocfft_plan_item_time> finished;
+};
 
 struct rocfft_execution_info_t
 {
     void*       workBuffer;
     size_t      workBufferSize;
     hipStream_t rocfft_stream = 0; // by default it is stream 0
+    // guarantee no allocations or host synchronization during
+    // execution, so that execution can be captured into a hipGraph
+    bool captureMode = false;
+    // the capture is launched once by rocFFT itself, so its work is
+    // counted as if it were executed
+    bool countCapture = false;
+    // transforms to execute, if fewer than the plan was created for.
+    // 0 executes the plan's whole batch.
+    size_t batch = 0;
+    // batch the plan was created for, filled in at execution so
+    // kernels can scale their own batch down to the one executed
+    size_t planBatch = 0;
     rocfft_execution_info_t()
         : workBuffer(nullptr)
         , workBufferSize(0)
     {
     }
     UserCallbacks callbacks;
+    // store callbacks to run on interior passes of the plan, keyed
+    // by the pass's position in the plan's execution sequence
+    std::map<size_t, UserCallbacks> pass_callbacks;
+    // times kernels if profiling is enabled.  Shared so copies of
+    // the execution info made by multi-device plans record into the
+    // same ring.
+    std::shared_ptr<ExecutionProfile> profile;
+    // times plan items if item timing is enabled
+    std::shared_ptr<ExecutionItemTimes> itemTimes;
+    // priority of streams that the plan creates for itself
+    int streamPriority = 0;
 };
 
-void TransformPowX(const ExecPlan&       execPlan,
-                   void*                 in_buffer[],
-                   void*                 out_buffer[],
-                   rocfft_execution_info info,
-                   size_t                multiPlanIdx);
+// Allocate a stream that a plan uses internally, on the current
+// device.  The stream is limited to the plan's CU mask if it has
+// one, and otherwise has the execution's stream priority.  An
+// existing stream with another priority is replaced.
+void alloc_internal_stream(hipStream_wrapper_t&  stream,
+                           const rocfft_plan     plan,
+                           rocfft_execution_info info);
+
+// Run a plan's kernels.  Returns the number of kernels launched
+// for the plan's nodes, where a fused kernel that runs two nodes
+// counts once.
+size_t TransformPowX(const ExecPlan&       execPlan,
+                     void*                 in_buffer[],
+                     void*                 out_buffer[],
+                     rocfft_execution_info info,
+                     size_t                multiPlanIdx);
 
 #endif // TRANSFORM_H
@@ -21,12 +21,16 @@
 #ifndef TREE_NODE_H
 #define TREE_NODE_H
 
+#include <algorithm>
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 #include <set>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "../../../shared/gpubuf.h"
@@ -81,6 +85,20 @@ struct GridParam
     }
 };
 
+// Narrow a block count to one dimension of a launch grid.  HIP
+// limits the number of threads along a grid dimension to what fits
+// in an unsigned int, so counts computed in size_t for very large
+// transforms must be checked rather than silently truncated.
+static unsigned int checked_grid_dim(size_t blocks, size_t threads_per_block = 1)
+{
+    if(threads_per_block == 0
+       || blocks > std::numeric_limits<unsigned int>::max() / threads_per_block)
+        throw std::runtime_error("kernel grid dimension too large: " + std::to_string(blocks)
+                                 + " blocks of " + std::to_string(threads_per_block)
+                                 + " threads");
+    return static_cast<unsigned int>(blocks);
+}
+
 // get the arch name, as a part of key of solution map
 static std::string get_arch_name(const hipDeviceProp_t& prop)
 {
@@ -124,9 +142,12 @@ static bool is_diagonal_sbrc_3D_length(size_t len)
     return len == 128 || len == 256;
 }
 
-static bool is_cube_size(const std::vector<size_t>& length)
+// true if every SBRC kernel of a 3D transform can use the diagonal
+// transpose
+static bool is_diagonal_sbrc_3D_size(const std::vector<size_t>& length)
 {
-    return length.size() == 3 && length[0] == length[1] && length[1] == length[2];
+    return length.size() == 3
+           && std::all_of(length.begin(), length.end(), is_diagonal_sbrc_3D_length);
 }
 
 // Given a map of precision-length exceptions, check whether the
@@ -158,6 +179,35 @@ struct SchemeTree
 
 using SchemeTreeVec = std::vector<std::unique_ptr<SchemeTree>>;
 
+// Buffers and array types assigned to one node of a plan
+struct NodeAssignment
+{
+    OperatingBuffer   obIn         = OB_UNINIT;
+    OperatingBuffer   obOut        = OB_UNINIT;
+    rocfft_array_type inArrayType  = rocfft_array_type_unset;
+    rocfft_array_type outArrayType = rocfft_array_type_unset;
+};
+
+// Decisions made while building a single-device plan.  Replaying
+// them builds the same plan again, without looking up solutions or
+// searching for a buffer assignment.
+struct PlanDecisions
+{
+    // arch the decisions were made for
+    std::string arch;
+
+    // decomposition of the tree, before any fusions
+    std::unique_ptr<SchemeTree> scheme;
+
+    // kernels from the solution map, empty if the plan was not built
+    // from a solution
+    std::vector<FMKey> solution_kernels;
+    int                solutionNumCUs = 0;
+
+    // assignment of each node of execSeq, before any fusions
+    std::vector<NodeAssignment> buffers;
+};
+
 static SchemeTreeVec EmptySchemeTreeVec = {};
 
 using SchemeVec = std::vector<ComputeScheme>;
@@ -183,9 +233,17 @@ struct NodeMetaData
     rocfft_precision        precision    = rocfft_precision_single;
     rocfft_array_type       inArrayType  = rocfft_array_type_unset;
     rocfft_array_type       outArrayType = rocfft_array_type_unset;
+    rocfft_transform_type   r2rType      = rocfft_transform_type_complex_forward;
     hipDeviceProp_t         deviceProp   = {};
     bool                    rootIsC2C;
 
+    // optimization goal of the plan, which steers scheme choices
+    rocfft_optimize_strategy optStrategy = rocfft_optimize_balance;
+    // set for root nodes whose load or store ops must stay on the
+    // kernel they were validated for, so a single-kernel transform
+    // isn't split
+    bool keepSingleKernel = false;
+
     explicit NodeMetaData(TreeNode* refNode);
 };
 
@@ -261,10 +319,11 @@ protected:
     {
         if(p != nullptr)
         {
-            precision  = p->precision;
-            batch      = p->batch;
-            direction  = p->direction;
-            deviceProp = p->deviceProp;
+            precision   = p->precision;
+            batch       = p->batch;
+            direction   = p->direction;
+            deviceProp  = p->deviceProp;
+            optStrategy = p->optStrategy;
         }
 
         allowedOutBuf
@@ -326,6 +385,10 @@ public:
     rocfft_array_type       inArrayType  = rocfft_array_type_unset;
     rocfft_array_type       outArrayType = rocfft_array_type_unset;
 
+    // DCT/DST type of a real-to-real transform, only meaningful for
+    // CS_REAL_TO_REAL nodes and their EmbeddedType::Real2Real kernel
+    rocfft_transform_type r2rType = rocfft_transform_type_complex_forward;
+
     // Extra twiddle multiplication for large 1D
     size_t large1D = 0;
     // decompose large twiddle to product of 256(8) or 128(7) or 64(6)...or 16(4)
@@ -334,6 +397,9 @@ public:
     // flag indicating if using the 3-step decomp. for large twiddle? (16^3, 32^3, 64^3)
     // if false, always use 8 as the base (256*256*256....)
     bool largeTwd3Steps = false;
+    // compute large twiddles in the kernel instead of reading a
+    // table, so no table is allocated
+    bool largeTwdCompute = false;
     // "Steps": how many exact loops we need to decompose the LTWD?
     // if we pass this as a template arg in kernel, should avoid dynamic while-loop
     // We will update this in get_large_twd_base_steps()
@@ -352,6 +418,11 @@ public:
     // sbrc transpose type
     mutable SBRC_TRANSPOSE_TYPE sbrcTranstype = SBRC_TRANSPOSE_TYPE::NONE;
 
+    // number of grid blocks that work on each plane of the node's
+    // third length, or 0 if a block's transforms can straddle planes.
+    // Set with the grid params, so planes can be launched slab by slab.
+    size_t planeBlocks = 0;
+
     // specified kernel key from solution map. (if there is any)
     std::unique_ptr<FMKey> specified_key;
 
@@ -387,13 +458,14 @@ public:
     size_t           twiddles_large_size = 0;
     void*            chirp               = nullptr;
     size_t           chirp_size          = 0;
-    gpubuf_t<size_t> devKernArg;
-
-    // callback parameters
-    UserCallbacks callbacks;
+    // shared with other nodes that have identical kernel arguments
+    std::shared_ptr<gpubuf_t<size_t>> devKernArg;
 
     hipDeviceProp_t deviceProp = {};
 
+    // optimization goal of the plan that the node is part of
+    rocfft_optimize_strategy optStrategy = rocfft_optimize_balance;
+
     // comments inserted by optimization passes to explain changes done
     // to the node
     std::vector<std::string> comments;
@@ -401,6 +473,13 @@ public:
     // runtime-compiled kernels for this node
     std::shared_future<std::unique_ptr<RTCKernel>> compiledKernel;
     std::shared_future<std::unique_ptr<RTCKernel>> compiledKernelWithCallbacks;
+    // kernel that runs this node and the next node of the plan in
+    // one launch, if they can be fused
+    std::shared_future<std::unique_ptr<RTCKernel>> compiledFusedKernel;
+    // generic kernel that runs in place of compiledKernel until that
+    // finishes compiling, if the plan was created with the fallback
+    // enabled
+    std::unique_ptr<RTCKernel> genericKernel;
 
     // Does this node allow inplace/not-inplace? default true,
     // each class handles the exception
@@ -418,6 +497,11 @@ public:
     // in inplace kernels, enabling both is not always a good choice
     IntrinsicAccessType intrinsicMode = IntrinsicAccessType::DISABLE_BOTH;
 
+    // true if no later kernel in the plan reads this node's output,
+    // so the kernel can write it with non-temporal stores instead of
+    // filling L2 and MALL with lines that won't be read again
+    bool nontemporalStores = false;
+
     size_t                      allowedOutBuf;
     std::set<rocfft_array_type> allowedOutArrayTypes;
 
@@ -562,6 +646,14 @@ public:
                                 : FMKey(length[0], length[1], precision, scheme);
     }
 
+    // key of the kernel that the tuner benchmarks for this node.  This
+    // is the kernel key, except for built-in kernels that still have
+    // tunable launch parameters (transposes)
+    virtual FMKey GetTuningKernelKey() const
+    {
+        return GetKernelKey();
+    }
+
     // Compute the large twd decomposition base
     void set_large_twd_base_steps(size_t largeTWDLength);
 
@@ -632,6 +724,8 @@ public:
     bool                need_twd_table   = false;
     bool                twd_no_radices   = false;
     bool                twd_attach_halfN = false;
+    // twiddle table only holds the first octant of the unit circle
+    bool                twd_octant       = false;
     std::vector<size_t> kernelFactors    = {};
     size_t              bwd              = 1; // bwd, wgs, lds are for grid param lds_bytes
     size_t              wgs              = 0;
@@ -683,6 +777,17 @@ protected:
     void SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp) override;
 
 public:
+    bool KernelCheck(std::vector<FMKey>& kernel_keys = EmptyFMKeyVec) override;
+
+    // Transposes are built-in kernels, but a tuned solution can still
+    // choose their tiling.  The tiling is kept in the kernel config of
+    // the key: threads_per_transform is {tileX, tileY}, workgroup_size
+    // is tileX * tileY, and transforms_per_block is 1 for diagonal
+    // block mapping.  An empty config means the default tiling.
+    FMKey GetTuningKernelKey() const override;
+
+    std::vector<size_t> CollapsibleDims() override;
+
     // Transpose tiles read more row-ish and write more column-ish.  So
     // assume output benefits more from padding than input.
     bool PaddingBenefitsOutput() override
@@ -918,6 +1023,8 @@ private:
 };
 
 struct rocfft_mp_request_t;
+struct rocfft_mp_comm_t;
+struct rocfft_mp_staged_t;
 
 // Abstract base class for all items in a multi-node/device plan
 struct MultiPlanItem
@@ -929,6 +1036,14 @@ struct MultiPlanItem
 
     // multi-process requests
     std::vector<rocfft_mp_request_t> comm_requests;
+    // stream that stream-ordered communication libraries (RCCL)
+    // queue operations onto
+    hipStream_wrapper_t comm_stream;
+    // messages staged through host memory for MPI libraries that
+    // can't access device memory.  Kept between executions so their
+    // buffers are reused; staged_count are in use by this execution.
+    std::vector<std::unique_ptr<rocfft_mp_staged_t>> staged_messages;
+    size_t                                           staged_count = 0;
 
     // Allocate this object's stream and queue work onto it.  This
     // object's event is allocated and recorded on the stream when
@@ -947,6 +1062,47 @@ struct MultiPlanItem
     // wait for outstanding communication requests to finish
     void WaitCommRequests();
 
+    // Event that is signalled when this item's work is complete, if
+    // all of its work is ordered on a GPU stream.  nullptr if the
+    // host must call Wait() instead.
+    virtual hipEvent_t CompletionEvent() const
+    {
+        return nullptr;
+    }
+
+    // Make the next ExecuteAsync wait on the device for the given
+    // event before starting work.  Returns false if this item can't
+    // do that, in which case the host needs to wait instead.
+    virtual bool WaitOnDevice(hipEvent_t completion)
+    {
+        return false;
+    }
+
+    // Send or receive bytes between this rank and another rank,
+    // using the plan's communication library.  WaitCommRequests
+    // waits for the operation to finish.  Streams created for the
+    // operation get the execution's stream priority.
+    void CommSend(const rocfft_plan     plan,
+                  rocfft_execution_info info,
+                  const void*           buf,
+                  size_t                numBytes,
+                  int                   destRank,
+                  int                   tag);
+    void CommRecv(const rocfft_plan     plan,
+                  rocfft_execution_info info,
+                  void*                 buf,
+                  size_t                numBytes,
+                  int                   srcRank,
+                  int                   tag);
+    // start sending or receiving device memory through host memory
+    void CommStaged(const rocfft_plan     plan,
+                    rocfft_execution_info info,
+                    bool                  send,
+                    const void*           buf,
+                    size_t                numBytes,
+                    int                   rank,
+                    int                   tag);
+
     // Get work buffer requirements for this item.  Only ExecPlans
     // should need this, as data movement shouldn't need temp buffers.
     virtual size_t WorkBufBytes(size_t base_type_size) const
@@ -987,6 +1143,8 @@ struct CommPointToPoint : public MultiPlanItem
 {
     rocfft_precision  precision;
     rocfft_array_type arrayType;
+    // format that the buffers hold the data in
+    rocfft_storage_format storage = rocfft_storage_format_native;
 
     // number of elements to copy
     size_t numElems;
@@ -1018,11 +1176,29 @@ struct CommPointToPoint : public MultiPlanItem
         return srcLocation.comm_rank == comm_rank || destLocation.comm_rank == comm_rank;
     }
 
+    // copies within a rank are ordered on a stream, but messages
+    // between ranks need the host to wait
+    hipEvent_t CompletionEvent() const override
+    {
+        return srcLocation.comm_rank == destLocation.comm_rank ? static_cast<hipEvent_t>(event)
+                                                               : nullptr;
+    }
+
+    bool WaitOnDevice(hipEvent_t completion) override
+    {
+        if(srcLocation.comm_rank != destLocation.comm_rank)
+            return false;
+        deviceWaits.push_back(completion);
+        return true;
+    }
+
 private:
     // Stream to run the async operation in
     hipStream_wrapper_t stream;
     // Event to signal when the async operations are finished.
     hipEvent_wrapper_t event;
+    // Events the next execution's stream waits for before copying
+    std::vector<hipEvent_t> deviceWaits;
 };
 
 // This struct has a vector of ranks to scatter to.  Executing can
@@ -1163,6 +1339,67 @@ struct CommGather : public MultiPlanItem
     std::vector<hipEvent_wrapper_t> events;
 };
 
+// Exchange between all comm ranks as a single collective.  Each rank
+// has one send and one receive buffer.  Rank s sends
+// sendCounts[d] elements starting at sendOffsets[d] of its send
+// buffer to rank d, which receives them at recvOffsets[s] of its
+// receive buffer.  Every rank in the communicator takes part.
+struct CommAllToAll : public MultiPlanItem
+{
+    rocfft_precision  precision;
+    rocfft_array_type arrayType;
+    // format that the buffers hold the data in
+    rocfft_storage_format storage = rocfft_storage_format_native;
+
+    struct RankBuffers
+    {
+        rocfft_location_t location;
+        BufferPtr         sendPtr;
+        BufferPtr         recvPtr;
+
+        // counts and offsets in elements, indexed by the other rank
+        std::vector<size_t> sendCounts;
+        std::vector<size_t> sendOffsets;
+        std::vector<size_t> recvCounts;
+        std::vector<size_t> recvOffsets;
+    };
+    // indexed by comm rank
+    std::vector<RankBuffers> ranks;
+
+    // If set, the group each rank belongs to.  Ranks only exchange
+    // data with ranks in the same group, and each group communicates
+    // separately.
+    std::vector<size_t> rankGroup;
+
+    // Create a communicator for this rank's group, from the plan's
+    // communicator.  Must be called on all ranks at plan creation.
+    void SplitComm(const rocfft_plan plan);
+
+    void ExecuteAsync(const rocfft_plan     plan,
+                      void*                 in_buffer[],
+                      void*                 out_buffer[],
+                      rocfft_execution_info info,
+                      size_t                multiPlanIdx) override;
+    void Wait() override;
+
+    void Print(rocfft_ostream& os, const int indent) const override;
+
+    bool WritesToBuffer(const BufferPtr& ptr) const override
+    {
+        return std::any_of(ranks.begin(), ranks.end(), [&ptr](const RankBuffers& r) {
+            return ptr == r.recvPtr;
+        });
+    }
+
+    bool ExecutesOnRank(int comm_rank) const override
+    {
+        return static_cast<size_t>(comm_rank) < ranks.size();
+    }
+
+private:
+    std::shared_ptr<rocfft_mp_comm_t> groupComm;
+};
+
 // Tree-structured FFT plan.  This is specific to a single device on
 // a single rank, since the TreeNodes inside here will have device
 // memory allocated for things like kernel arguments and twiddles.
@@ -1182,6 +1419,11 @@ struct ExecPlan : public MultiPlanItem
     BufferPtr inputPtr;
     BufferPtr outputPtr;
 
+    // If plan creation did not wait for twiddle and chirp tables to
+    // be generated, signalled once they are ready.  Executions wait
+    // for it until it has been signalled.
+    std::shared_ptr<hipEvent_wrapper_t> tablesReady;
+
     void ExecuteAsync(const rocfft_plan     plan,
                       void*                 in_buffer[],
                       void*                 out_buffer[],
@@ -1190,6 +1432,9 @@ struct ExecPlan : public MultiPlanItem
 
     void Wait() override;
 
+    // wait on the host for tables that are still being generated
+    void WaitTables() const;
+
     void Print(rocfft_ostream& os, const int indent) const override;
 
     // shared pointer allows for ExecPlans to be copyable
@@ -1210,6 +1455,15 @@ struct ExecPlan : public MultiPlanItem
 
     // scheme decompositions from solution map
     std::unique_ptr<SchemeTree> rootScheme;
+    // true if the solution was transferred from another arch's map
+    bool transferredSolution = false;
+    // number of CUs the solution was tuned on, 0 if not known
+    int solutionNumCUs = 0;
+
+    // decisions made while building this plan, and decisions to
+    // replay instead of making them again (only set while building)
+    std::shared_ptr<PlanDecisions> decisions;
+    const PlanDecisions*           restore = nullptr;
 
     // flattened potentially-fusable shims of rootPlan
     std::vector<FuseShim*> fuseShims;
@@ -1217,6 +1471,31 @@ struct ExecPlan : public MultiPlanItem
     std::vector<DevFnCall> devFnCall;
     std::vector<GridParam> gridParam;
 
+    // Schedule for running independent nodes of execSeq on separate
+    // streams.  execLanes gives the lane each node runs on (lane 0
+    // is the execution's stream), execWaits lists the nodes on other
+    // lanes it must wait for, and execSignals is true for nodes that
+    // are waited for.  Empty if the nodes must run in sequence.
+    std::vector<size_t>              execLanes;
+    std::vector<std::vector<size_t>> execWaits;
+    std::vector<bool>                execSignals;
+    size_t                           execLaneCount = 1;
+
+    // Runs of consecutive execSeq nodes that each work plane by plane
+    // on the same planes of a volume, so a run can execute one slab of
+    // planes at a time while the slab stays in cache.  first is the
+    // run's first index in execSeq, planes is the number of planes in
+    // each batch member and slabPlanes (which divides planes) the
+    // number launched at a time.
+    struct SlabRun
+    {
+        size_t first      = 0;
+        size_t count      = 0;
+        size_t planes     = 0;
+        size_t slabPlanes = 0;
+    };
+    std::vector<SlabRun> slabRuns;
+
     hipDeviceProp_t deviceProp;
 
     std::vector<size_t> iLength;
@@ -1239,6 +1518,10 @@ struct ExecPlan : public MultiPlanItem
     size_t blueWorkBufSize  = 0;
     size_t chirpWorkBufSize = 0;
 
+    // space at the end of the work buffer for the grid barrier of
+    // fused kernels
+    size_t barrierWorkBufSize = 0;
+
     // OB_IN refers to iStride, OB_OUT refers to oStride
     std::map<OperatingBuffer, bool> isUnitStride;
 
@@ -1263,16 +1546,35 @@ struct ExecPlan : public MultiPlanItem
         return location.comm_rank == comm_rank;
     }
 
+    hipEvent_t CompletionEvent() const override
+    {
+        return mgpuPlan ? static_cast<hipEvent_t>(event) : nullptr;
+    }
+
+    bool WaitOnDevice(hipEvent_t completion) override
+    {
+        if(!mgpuPlan)
+            return false;
+        deviceWaits.push_back(completion);
+        return true;
+    }
+
 private:
     // Stream to run the async operations in - might be unallocated
     // if the user gave us a stream to use
     hipStream_wrapper_t stream;
     // Event to signal when the async operations are finished.
     hipEvent_wrapper_t event;
+    // Events the next execution's stream waits for before starting
+    std::vector<hipEvent_t> deviceWaits;
 };
 
 std::unique_ptr<SchemeTree> ApplySolution(ExecPlan& execPlan);
 
+// get the scheme decomposition of a built tree
+std::unique_ptr<SchemeTree> SchemeTreeOf(const TreeNode& node);
+std::unique_ptr<SchemeTree> CopySchemeTree(const SchemeTree& scheme);
+
 // get a min_token (without batch, stride, offset...) of a node, for generating a prob-key
 void GetNodeToken(const TreeNode& probNode, std::string& min_token, std::string& full_token);
 void ProcessNode(ExecPlan& execPlan);
@@ -174,6 +174,8 @@ public:
     // override for sbrcTransType
     FMKey GetKernelKey() const override;
 
+    std::vector<size_t> CollapsibleDims() override;
+
     // writes are along columns so they may benefit from padding
     bool PaddingBenefitsOutput() override
     {
@@ -133,6 +133,38 @@ protected:
     void BuildTree_internal(SchemeTreeVec& child_scheme_trees = EmptySchemeTreeVec) override;
 };
 
+/*****************************************************
+ * CS_KERNEL_3D_SINGLE  *
+ *****************************************************/
+class Single3DNode : public LeafNode
+{
+    friend class NodeFactory;
+
+protected:
+    // 3D_SINGLE has no function pool entry of its own - it is
+    // runtime-compiled from the 1D kernels of each dimension
+    Single3DNode(TreeNode* p, ComputeScheme s)
+        : LeafNode(p, s)
+    {
+        need_twd_table = true;
+    }
+
+    void SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp) override;
+
+public:
+    bool KernelCheck(std::vector<FMKey>& kernel_keys = EmptyFMKeyVec) override;
+    void GetKernelFactors() override;
+    bool CreateDeviceResources() override;
+
+    // Return the workgroup size a 3D_SINGLE kernel would use for the
+    // lengths, or 0 if the 1D kernels needed are not available.
+    // This must match what the generator derives in
+    // StockhamKernelFused3D.
+    static size_t WorkgroupSize(const std::vector<size_t>& length, rocfft_precision precision);
+    // Return the number of LDS elements needed for the volume
+    static size_t LDSElems(const std::vector<size_t>& length);
+};
+
 /*****************************************************
  * Base Class of fused SBRC and Transpose
  *****************************************************/
@@ -175,15 +207,17 @@ public:
         auto alignment_dimension = sbrc_3D_alignment_dimension();
         if(alignment_dimension == 0)
             return NONE;
+        if(alignment_dimension % blockWidth != 0)
+            return TILE_UNALIGNED;
         // NB: from the benchmark results, diagonal transpose
-        // benefits only some architectures
-        if(is_diagonal_sbrc_3D_length(length.front()) && is_cube_size(length)
+        // benefits only some architectures.  Diagonal kernels don't
+        // handle partial tiles, and only reorder tiles when there's
+        // more than one per plane.
+        if(is_diagonal_sbrc_3D_length(length.front()) && alignment_dimension / blockWidth > 1
            && (is_device_gcn_arch(deviceProp, "gfx906")
                || is_device_gcn_arch(deviceProp, "gfx1030")))
             return DIAGONAL;
-        if(alignment_dimension % blockWidth == 0)
-            return TILE_ALIGNED;
-        return TILE_UNALIGNED;
+        return TILE_ALIGNED;
     }
 
     // override for sbrcTransType
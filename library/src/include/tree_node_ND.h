@@ -0,0 +1,64 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef TREE_NODE_ND_H
+#define TREE_NODE_ND_H
+
+#include "tree_node.h"
+
+/*****************************************************
+ * CS_ND_RC  *
+ * N-D node builder, for ranks greater than 3,
+ * R: 3D FFTs over the 3 fastest dimensions, with the
+ *    higher dimensions folded into their batch,
+ * C: 1D FFTs along each higher dimension, using SBCC
+ *    kernels where they exist.
+ * The 3D FFTs run first if the input layout can be folded,
+ * and otherwise last, in place on the output.
+ *****************************************************/
+class RCNDNode : public InternalNode
+{
+    friend class NodeFactory;
+
+protected:
+    explicit RCNDNode(TreeNode* p)
+        : InternalNode(p)
+    {
+        scheme = CS_ND_RC;
+    }
+
+    void AssignParams_internal() override;
+    void BuildTree_internal(SchemeTreeVec& child_scheme_trees = EmptySchemeTreeVec) override;
+
+public:
+    // Return true if a layout's dimensions above the third, and its
+    // batch, are packed so that they can be addressed as one batch
+    // of 3D transforms.
+    static bool HigherDimsFold(const std::vector<size_t>& length,
+                               const std::vector<size_t>& stride,
+                               size_t                     dist,
+                               size_t                     batch);
+
+private:
+    // true if the 3D FFTs are the first child, reading the input
+    bool rowsFirst = true;
+};
+
+#endif // TREE_NODE_ND_H
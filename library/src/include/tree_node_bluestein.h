@@ -42,6 +42,40 @@ protected:
 
 public:
     static size_t FindBlue(size_t len, rocfft_precision precision, bool forcePow2);
+
+    // true if this node reads a real-to-complex root's real input
+    // and writes its Hermitian output without copy kernels
+    bool ReadsRealInputDirectly() const;
+};
+
+/*****************************************************
+ * CS_RADER
+ * prime length p as a cyclic convolution of length p-1
+ *****************************************************/
+class RaderNode : public InternalNode
+{
+    friend class NodeFactory;
+
+protected:
+    explicit RaderNode(TreeNode* p)
+        : InternalNode(p)
+    {
+        scheme = CS_RADER;
+    }
+    void AssignParams_internal() override;
+    void BuildTree_internal(SchemeTreeVec& child_scheme_trees = EmptySchemeTreeVec) override;
+
+public:
+    // check if a 1D length is better done with Rader than Bluestein
+    static bool
+        SizeFits(size_t length, rocfft_precision precision, const hipDeviceProp_t& deviceProp);
+    // base^exp mod p, for p < 2^32
+    static size_t PowMod(size_t base, size_t exp, size_t p);
+    // smallest generator of the multiplicative group mod prime p
+    static size_t PrimitiveRoot(size_t p);
+    // total Bluestein buffer elements required for the given number
+    // of transforms of length p
+    static size_t BufferLength(size_t length, size_t count);
 };
 
 /*****************************************************
@@ -60,7 +94,8 @@ protected:
 
 public:
     // check if the specified 1D length fits into single-kernel Bluestein
-    static bool SizeFits(size_t length, rocfft_precision precision);
+    static bool
+        SizeFits(size_t length, rocfft_precision precision, const hipDeviceProp_t& deviceProp);
 
     bool KernelCheck(std::vector<FMKey>& kernel_keys = EmptyFMKeyVec) override
     {
@@ -71,8 +106,8 @@ public:
 };
 
 /*****************************************************
- * Component of Bluestein
- * Chirp, XXXMul
+ * Component of Bluestein and Rader
+ * Chirp, XXXMul, Rader gather/scatter
  *****************************************************/
 class BluesteinComponentNode : public LeafNode
 {
@@ -85,13 +120,15 @@ protected:
         // first PAD MUL: in=parent_in, out=bluestein, must be out-of-place
         // last  RES MUL: in=bluestein, out=parent_out, must be out-of-place
         // other components, must be blue -> blue
-        if(scheme == CS_KERNEL_PAD_MUL || scheme == CS_KERNEL_RES_MUL)
+        // Rader GATHER and SCATTER are placed the same way.
+        if(scheme == CS_KERNEL_PAD_MUL || scheme == CS_KERNEL_RES_MUL
+           || scheme == CS_KERNEL_RADER_GATHER || scheme == CS_KERNEL_RADER_SCATTER)
             allowInplace = false;
         else
             allowOutofplace = false;
 
         // RES_MUL must not output to B buffer, while others must output to B buffer
-        if(scheme == CS_KERNEL_RES_MUL)
+        if(scheme == CS_KERNEL_RES_MUL || scheme == CS_KERNEL_RADER_SCATTER)
             allowedOutBuf = OB_USER_IN | OB_USER_OUT | OB_TEMP | OB_TEMP_CMPLX_FOR_REAL;
         else
         {
@@ -46,6 +46,92 @@ public:
     }
 };
 
+/*****************************************************
+ * CS_REAL_TRANSFORM_PAIR
+ *****************************************************/
+// Batched 1D real-to-complex transform that packs each pair of real
+// inputs into the real and imaginary parts of one complex input,
+// does half as many complex transforms, and separates the two
+// Hermitian outputs afterwards.  Children are batched over pairs,
+// and the iDist/oDist of the pack and unpack kernels are still the
+// distance between the real transforms.
+class RealTransPairNode : public InternalNode
+{
+    friend class NodeFactory;
+
+protected:
+    explicit RealTransPairNode(TreeNode* p)
+        : InternalNode(p)
+    {
+        scheme = CS_REAL_TRANSFORM_PAIR;
+    }
+    void AssignParams_internal() override;
+    void BuildTree_internal(SchemeTreeVec& child_scheme_trees = EmptySchemeTreeVec) override;
+
+public:
+    bool UseOutputLengthForPadding() override
+    {
+        return true;
+    }
+};
+
+/*****************************************************
+ * CS_REAL_TRANSFORM_PACKED
+ *****************************************************/
+// Real-complex transform whose Hermitian side is packed into N/2
+// elements along the fastest dimension, so that it takes the same
+// space as the real side.  The first element holds X[0] + i*X[N/2]
+// of each row, which is unpacked using the Hermitian symmetry of
+// those two planes in the other dimensions.  Forward transforms do
+// an ordinary R2C to a temp buffer and pack it; inverse transforms
+// unpack to a temp buffer and do an ordinary C2R.
+class RealTransPackedNode : public InternalNode
+{
+    friend class NodeFactory;
+
+protected:
+    explicit RealTransPackedNode(TreeNode* p)
+        : InternalNode(p)
+    {
+        scheme = CS_REAL_TRANSFORM_PACKED;
+    }
+    void AssignParams_internal() override;
+    void BuildTree_internal(SchemeTreeVec& child_scheme_trees = EmptySchemeTreeVec) override;
+
+public:
+    bool UseOutputLengthForPadding() override
+    {
+        return true;
+    }
+};
+
+/*****************************************************
+ * CS_REAL_TO_REAL
+ *****************************************************/
+// length of the complex FFT that a DCT/DST of real length
+// realLength is computed with
+size_t real_to_real_fft_length(rocfft_transform_type type, size_t realLength);
+
+class RealToRealNode : public InternalNode
+{
+    friend class NodeFactory;
+
+protected:
+    explicit RealToRealNode(TreeNode* p)
+        : InternalNode(p)
+    {
+        scheme = CS_REAL_TO_REAL;
+    }
+    void AssignParams_internal() override;
+    void BuildTree_internal(SchemeTreeVec& child_scheme_trees = EmptySchemeTreeVec) override;
+
+public:
+    bool UseOutputLengthForPadding() override
+    {
+        return true;
+    }
+};
+
 /*****************************************************
  * CS_REAL_TRANSFORM_EVEN
  *****************************************************/
@@ -160,6 +246,10 @@ protected:
  * CS_KERNEL_COPY_HERM_TO_CMPLX
  * CS_KERNEL_COPY_CMPLX_TO_HERM
  * CS_KERNEL_COPY_CMPLX_TO_R
+ * CS_KERNEL_PAIR_R_TO_CMPLX
+ * CS_KERNEL_PAIR_CMPLX_TO_HERM
+ * CS_KERNEL_PACK_HERM
+ * CS_KERNEL_UNPACK_HERM
  *****************************************************/
 class RealTransDataCopyNode : public LeafNode
 {
@@ -181,8 +271,10 @@ protected:
         /********************
         * Buffer and ArrayType
         *********************/
-        // the two r2c copy-head kernels MUST output to TEMP CMPLX buffer
-        if(scheme == CS_KERNEL_COPY_R_TO_CMPLX || scheme == CS_KERNEL_COPY_HERM_TO_CMPLX)
+        // the r2c copy-head, pair-packing and Hermitian unpacking
+        // kernels MUST output to TEMP CMPLX buffer
+        if(scheme == CS_KERNEL_COPY_R_TO_CMPLX || scheme == CS_KERNEL_COPY_HERM_TO_CMPLX
+           || scheme == CS_KERNEL_PAIR_R_TO_CMPLX || scheme == CS_KERNEL_UNPACK_HERM)
         {
             allowedOutBuf        = OB_TEMP_CMPLX_FOR_REAL | OB_TEMP;
             allowedOutArrayTypes = {rocfft_array_type_complex_interleaved};
@@ -193,7 +285,8 @@ protected:
             allowedOutArrayTypes = {rocfft_array_type_real, rocfft_array_type_complex_interleaved};
         }
         // should be HI(or HP), but could be treated as CI(or HI) (the alias type)
-        else if(scheme == CS_KERNEL_COPY_CMPLX_TO_HERM)
+        else if(scheme == CS_KERNEL_COPY_CMPLX_TO_HERM || scheme == CS_KERNEL_PAIR_CMPLX_TO_HERM
+                || scheme == CS_KERNEL_PACK_HERM)
         {
             allowedOutArrayTypes = {rocfft_array_type_hermitian_interleaved,
                                     rocfft_array_type_complex_interleaved,
@@ -28,6 +28,7 @@
 #include <string>
 #include <vector>
 
+#include "node_factory.h"
 #include "solution_map.h"
 
 struct BenchmarkInfo
@@ -47,6 +48,7 @@ struct BenchmarkInfo
     int                occupancy;
     int                numCUs;
     double             milli_seconds;
+    double             joules; // energy per execution, 0 if power isn't sampled
     double             gflops;
     double             granularity;
     double             bw_eff;
@@ -80,6 +82,18 @@ struct rocfft_tuning_packet
     // reserved, indicating if we dump a full token,
     // making the solution exclusively use by that exact problem
 
+    // if nonzero, benchmark at most this many kernel configurations
+    // for each node in each phase
+    size_t max_candidates = 0;
+
+    // rank candidates by energy per execution instead of time
+    bool energy_objective = false;
+
+    // only try the global memory access modes (direct-to-register
+    // and buffer instructions) of the library's own kernels, leaving
+    // the rest of their configurations alone
+    bool access_modes_only = false;
+
     // tuning status
     bool             init_step      = false;
     bool             is_tuning      = false;
@@ -97,6 +111,14 @@ struct rocfft_tuning_packet
     // size is #-nodes, each elem is the target_factors of this node
     std::vector<std::set<std::string>> target_factors;
 
+    // plan-level tuning: the tree shapes to try for the root problem
+    // (the library's own choice first), and the one being tuned.
+    // tree_signatures describe the trees built so far, so a shape that
+    // builds the same tree as an earlier one can be skipped.
+    std::vector<TreeShape>   tree_shapes;
+    size_t                   tree_shape_id = 0;
+    std::vector<std::string> tree_signatures;
+
     rocfft_tuning_packet() = default;
 };
 
@@ -147,15 +169,30 @@ public:
 
     int GetNumOfKernelCandidates(size_t node_id);
 
+    size_t GetNumOfTreeShapes();
+
+    // start tuning another tree shape from scratch
+    bool SetTreeShape(size_t shape_id);
+
+    // true if the current tree shape built the same tree as an earlier one
+    bool IsDuplicateTreeShape();
+
+    // the decomposition variant plan-level tuning wants for a node, or
+    // -1 to let the node decide
+    int GetTreeShapeVariant(const TreeNode& node);
+
     bool SetCurrentTuningNodeId(size_t node_id);
 
     bool SetCurrentKernelCandidateId(size_t kernel_config_id);
 
     BenchmarkInfo GetCurrBenchmarkInfo();
 
-    void UpdateCurrBenchResult(double ms, double gflops);
+    void UpdateCurrBenchResult(double ms, double gflops, double joules = 0.0);
+
+    // cost the tuner minimizes: time or energy, per the packet's objective
+    double Cost(const BenchmarkInfo& info) const;
 
-    void FindWinnerForCurrNode(double&      curr_best_msec,
+    void FindWinnerForCurrNode(double&      curr_best_cost,
                                int&         winner_phase,
                                int&         winner_config_id,
                                std::string& winner_kernel_name);
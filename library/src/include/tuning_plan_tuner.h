@@ -32,4 +32,8 @@ size_t SerializeTree(TreeNode*                         node,
                      const std::optional<std::string>& root_full_token = std::nullopt);
 void   EnumerateTrees(ExecPlan& execPlan);
 
+// return the root scheme of the tree shape being tuned, enumerating
+// the shapes to tune from the library's own root node the first time
+ComputeScheme SelectTreeShape(TreeNode& root);
+
 #endif
\ No newline at end of file
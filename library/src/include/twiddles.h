@@ -23,9 +23,16 @@
 
 #include "../../../shared/gpubuf.h"
 #include "rocfft/rocfft.h"
+#include <array>
+#include <functional>
+#include <memory>
+#include <string>
 #include <vector>
 
+struct RTCKernel;
+
 static const size_t       LTWD_BASE_DEFAULT       = 8;
+static const size_t       LTWD_MAX_STEPS          = 5;
 static const size_t       LARGE_TWIDDLE_THRESHOLD = 4096;
 static const unsigned int TWIDDLES_MAX_RADICES    = 8;
 
@@ -47,6 +54,24 @@ gpubuf twiddles_create_2D(size_t                     N1,
                           const std::vector<size_t>& radices2,
                           unsigned int               deviceId);
 
+gpubuf twiddles_create_3D(const std::array<size_t, 3>&              lengths,
+                          rocfft_precision                          precision,
+                          const hipDeviceProp_t&                    deviceProp,
+                          const std::array<std::vector<size_t>, 3>& radices,
+                          unsigned int                              deviceId);
+
 void twiddle_streams_cleanup();
 
+// Twiddle and chirp tables for a device are generated on this
+// stream.  Generation returns without waiting for the stream, so
+// users of the tables must synchronize with it first.  Table
+// streams are only used through the Repo, which serializes access.
+hipStream_t table_stream(unsigned int deviceId);
+// wait for all tables generated so far on a device
+void table_stream_synchronize(unsigned int deviceId);
+// get a kernel to launch on the current device's table stream,
+// calling generate to build it the first time it's needed
+RTCKernel& table_kernel(const std::string&                                 kernel_name,
+                        const std::function<std::unique_ptr<RTCKernel>()>& generate);
+
 #endif // defined( TWIDDLES_H )
@@ -0,0 +1,118 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_WORK_BUFFER_POOL_H
+#define ROCFFT_WORK_BUFFER_POOL_H
+
+#include "../../../shared/rocfft_hip.h"
+#include <limits>
+#include <map>
+#include <mutex>
+
+// Stream-ordered pool of work buffers, used when the user does not
+// provide a work buffer to rocfft_execute.
+//
+// Work buffers are allocated from a per-device HIP memory pool with
+// hipMallocFromPoolAsync and freed with hipFreeAsync on the
+// execution stream, so that repeated executions reuse memory instead
+// of calling hipMalloc/hipFree each time.  The pool retains up to
+// its release threshold of memory across synchronizations.  The
+// threshold doesn't cap allocations: a pool grows as large as the
+// buffers in flight need, and gives memory beyond the threshold back
+// when the stream synchronizes.
+class WorkBufferPool
+{
+    WorkBufferPool() = default;
+
+public:
+    // pool is a singleton, so no copying or assignment
+    WorkBufferPool(const WorkBufferPool&) = delete;
+    WorkBufferPool& operator=(const WorkBufferPool&) = delete;
+
+    static WorkBufferPool& GetPool()
+    {
+        static WorkBufferPool pool;
+        return pool;
+    }
+
+    // Allocate a work buffer for the current device, ordered on the
+    // stream.  Returns nullptr if memory pools are not usable, so the
+    // caller can fall back to a regular allocation.
+    void* Alloc(size_t bytes, hipStream_t stream);
+
+    // Return a buffer previously obtained from Alloc, ordered on the
+    // stream.
+    void Free(void* ptr, hipStream_t stream);
+
+    // Set the number of unused bytes each device's pool may retain
+    // across synchronizations
+    void SetReleaseThreshold(size_t bytes);
+
+    // Release all unused memory held by the pools
+    void Trim();
+
+    // Destroy all pools.  All buffers must have been freed.
+    void Clear();
+
+private:
+    // get the pool for the current device, creating it if necessary.
+    // returns nullptr if the device doesn't support memory pools.
+    hipMemPool_t GetDevicePool();
+
+    std::map<int, hipMemPool_t> pools;
+
+    // unused bytes retained by each pool - default is to keep
+    // everything
+    size_t releaseThreshold = std::numeric_limits<size_t>::max();
+
+    std::mutex mtx;
+};
+
+// RAII work buffer allocated from the pool, returned to the pool on
+// the same stream when destroyed
+struct PooledWorkBuffer
+{
+    PooledWorkBuffer() = default;
+    ~PooledWorkBuffer()
+    {
+        if(ptr)
+            WorkBufferPool::GetPool().Free(ptr, stream);
+    }
+    PooledWorkBuffer(const PooledWorkBuffer&) = delete;
+    PooledWorkBuffer& operator=(const PooledWorkBuffer&) = delete;
+
+    // returns false if the pool could not provide a buffer
+    bool alloc(size_t bytes, hipStream_t _stream)
+    {
+        stream = _stream;
+        ptr    = WorkBufferPool::GetPool().Alloc(bytes, stream);
+        return ptr != nullptr;
+    }
+    void* data() const
+    {
+        return ptr;
+    }
+
+private:
+    void*       ptr    = nullptr;
+    hipStream_t stream = nullptr;
+};
+
+#endif
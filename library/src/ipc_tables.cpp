@@ -0,0 +1,354 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "ipc_tables.h"
+#include "../../shared/environment.h"
+#include "../../shared/rocfft_hip.h"
+#include "logging.h"
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+#ifndef WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef WIN32
+
+// HIP IPC handles are not available on Windows
+
+bool ipc_tables_enabled()
+{
+    return false;
+}
+std::string ipc_table_device_key(int deviceId)
+{
+    return {};
+}
+std::pair<void*, size_t> ipc_table_open(const std::string& key)
+{
+    return {nullptr, 0};
+}
+void ipc_table_publish(const std::string& key, void* ptr, size_t bytes) {}
+bool ipc_table_published(void* ptr)
+{
+    return false;
+}
+bool ipc_table_close(void* ptr)
+{
+    return false;
+}
+void ipc_tables_clear() {}
+
+#else
+
+static const char     registry_magic[8] = {'R', 'O', 'C', 'F', 'F', 'T', 'I', 'P'};
+static const uint64_t registry_version  = 1;
+static const size_t   REGISTRY_KEY_LEN  = 256;
+static const size_t   REGISTRY_ENTRIES  = 1024;
+
+struct registry_header
+{
+    char     magic[8];
+    uint64_t version;
+    uint64_t entry_count;
+};
+
+struct registry_entry
+{
+    // empty if the entry is free
+    char              key[REGISTRY_KEY_LEN];
+    uint64_t          bytes;
+    int64_t           owner;
+    hipIpcMemHandle_t handle;
+};
+
+static const size_t REGISTRY_BYTES
+    = sizeof(registry_header) + REGISTRY_ENTRIES * sizeof(registry_entry);
+
+// holds an exclusive lock on the registry file, which other
+// processes also take.  Locks are released if a process dies.
+struct registry_lock
+{
+    explicit registry_lock(int fd)
+        : fd(fd)
+    {
+        while(flock(fd, LOCK_EX) != 0 && errno == EINTR)
+            ;
+    }
+    ~registry_lock()
+    {
+        flock(fd, LOCK_UN);
+    }
+    int fd;
+};
+
+class IpcTableRegistry
+{
+public:
+    static IpcTableRegistry& Get()
+    {
+        static IpcTableRegistry registry;
+        return registry;
+    }
+
+    bool enabled() const
+    {
+        return entries != nullptr;
+    }
+
+    std::pair<void*, size_t> open(const std::string& key)
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        registry_lock               flck(fd);
+
+        auto entry = find(key);
+        if(!entry || entry->owner == pid)
+            return {nullptr, 0};
+        if(!owner_alive(*entry))
+        {
+            std::memset(entry, 0, sizeof(*entry));
+            return {nullptr, 0};
+        }
+
+        void* ptr = nullptr;
+        if(hipIpcOpenMemHandle(&ptr, entry->handle, hipIpcMemLazyEnablePeerAccess) != hipSuccess)
+        {
+            // clear the error so later calls don't see it
+            (void)hipGetLastError();
+            return {nullptr, 0};
+        }
+        opened.insert(ptr);
+        return {ptr, entry->bytes};
+    }
+
+    void publish(const std::string& key, void* ptr, size_t bytes)
+    {
+        if(key.size() >= REGISTRY_KEY_LEN)
+            return;
+
+        std::lock_guard<std::mutex> lck(mtx);
+        registry_lock               flck(fd);
+
+        // another process may have published the same table while
+        // this one was building it
+        auto entry = find(key);
+        if(entry && owner_alive(*entry))
+            return;
+        if(!entry)
+        {
+            for(size_t i = 0; i < REGISTRY_ENTRIES; ++i)
+            {
+                if(entries[i].key[0] == '\0' || !owner_alive(entries[i]))
+                {
+                    entry = &entries[i];
+                    break;
+                }
+            }
+        }
+        if(!entry)
+            return;
+
+        hipIpcMemHandle_t handle;
+        if(hipIpcGetMemHandle(&handle, ptr) != hipSuccess)
+        {
+            (void)hipGetLastError();
+            return;
+        }
+        std::memset(entry, 0, sizeof(*entry));
+        std::memcpy(entry->key, key.c_str(), key.size());
+        entry->bytes  = bytes;
+        entry->owner  = pid;
+        entry->handle = handle;
+        published.emplace(ptr, key);
+    }
+
+    bool is_published(void* ptr)
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        return published.count(ptr);
+    }
+
+    bool close(void* ptr)
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        if(!opened.erase(ptr))
+            return false;
+        (void)hipIpcCloseMemHandle(ptr);
+        return true;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lck(mtx);
+        registry_lock               flck(fd);
+
+        for(const auto& p : published)
+        {
+            auto entry = find(p.second);
+            if(entry && entry->owner == pid)
+                std::memset(entry, 0, sizeof(*entry));
+        }
+        published.clear();
+        for(auto ptr : opened)
+            (void)hipIpcCloseMemHandle(ptr);
+        opened.clear();
+    }
+
+private:
+    IpcTableRegistry()
+    {
+        auto path = rocfft_getenv("ROCFFT_SHARE_TWIDDLES_IPC");
+        if(path.empty())
+            return;
+
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if(fd < 0)
+            return;
+
+        void* map = MAP_FAILED;
+        {
+            // the first process to open the registry sizes it
+            registry_lock flck(fd);
+            struct stat   st;
+            if(fstat(fd, &st) == 0 && st.st_size == 0)
+            {
+                registry_header header = {};
+                std::memcpy(header.magic, registry_magic, sizeof(registry_magic));
+                header.version     = registry_version;
+                header.entry_count = REGISTRY_ENTRIES;
+                if(ftruncate(fd, REGISTRY_BYTES) == 0)
+                    (void)pwrite(fd, &header, sizeof(header), 0);
+            }
+            if(fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) == REGISTRY_BYTES)
+                map = mmap(nullptr, REGISTRY_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if(map == MAP_FAILED)
+        {
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+
+        auto header = static_cast<registry_header*>(map);
+        if(std::memcmp(header->magic, registry_magic, sizeof(registry_magic)) != 0
+           || header->version != registry_version || header->entry_count != REGISTRY_ENTRIES)
+        {
+            if(LOG_TRACE_ENABLED())
+                (*LogSingleton::GetInstance().GetTraceOS())
+                    << "ignoring incompatible table registry " << path << std::endl;
+            munmap(map, REGISTRY_BYTES);
+            ::close(fd);
+            fd = -1;
+            return;
+        }
+        base    = map;
+        entries = reinterpret_cast<registry_entry*>(static_cast<char*>(map)
+                                                    + sizeof(registry_header));
+        pid     = getpid();
+    }
+
+    ~IpcTableRegistry()
+    {
+        // tables are freed by the process's own cleanup, so only the
+        // mapping of the registry is released here
+        if(base)
+            munmap(base, REGISTRY_BYTES);
+        if(fd >= 0)
+            ::close(fd);
+    }
+
+    registry_entry* find(const std::string& key)
+    {
+        for(size_t i = 0; i < REGISTRY_ENTRIES; ++i)
+        {
+            if(std::strncmp(entries[i].key, key.c_str(), REGISTRY_KEY_LEN) == 0)
+                return &entries[i];
+        }
+        return nullptr;
+    }
+
+    static bool owner_alive(const registry_entry& entry)
+    {
+        return kill(static_cast<pid_t>(entry.owner), 0) == 0 || errno != ESRCH;
+    }
+
+    std::mutex      mtx;
+    int             fd      = -1;
+    void*           base    = nullptr;
+    registry_entry* entries = nullptr;
+    int64_t         pid     = 0;
+
+    // tables this process published, and the keys they're under
+    std::map<void*, std::string> published;
+    // tables this process mapped from other processes
+    std::set<void*> opened;
+};
+
+bool ipc_tables_enabled()
+{
+    return IpcTableRegistry::Get().enabled();
+}
+
+std::string ipc_table_device_key(int deviceId)
+{
+    char busId[64] = {};
+    if(hipDeviceGetPCIBusId(busId, sizeof(busId), deviceId) != hipSuccess)
+        throw std::runtime_error("hipDeviceGetPCIBusId failed");
+    return busId;
+}
+
+std::pair<void*, size_t> ipc_table_open(const std::string& key)
+{
+    return IpcTableRegistry::Get().open(key);
+}
+
+void ipc_table_publish(const std::string& key, void* ptr, size_t bytes)
+{
+    IpcTableRegistry::Get().publish(key, ptr, bytes);
+}
+
+bool ipc_table_published(void* ptr)
+{
+    return ipc_tables_enabled() && IpcTableRegistry::Get().is_published(ptr);
+}
+
+bool ipc_table_close(void* ptr)
+{
+    return ipc_tables_enabled() && IpcTableRegistry::Get().close(ptr);
+}
+
+void ipc_tables_clear()
+{
+    if(ipc_tables_enabled())
+        IpcTableRegistry::Get().clear();
+}
+
+#endif
@@ -22,29 +22,42 @@
 
 #include "kargs.h"
 #include "../../shared/rocfft_hip.h"
+#include <array>
 #include <cassert>
+#include <map>
+#include <mutex>
 
-// malloc device buffer; copy host buffer to device buffer
-gpubuf_t<size_t> kargs_create(std::vector<size_t> length,
-                              std::vector<size_t> inStride,
-                              std::vector<size_t> outStride,
-                              size_t              iDist,
-                              size_t              oDist)
+typedef std::array<size_t, 3 * KERN_ARGS_ARRAY_WIDTH> kargs_host_t;
+
+// arrays already on a device, keyed by device and contents.  Nodes
+// own the buffers, so entries here expire with the last node.
+struct kargs_pool_t
 {
-    gpubuf_t<size_t> devk;
-    if(devk.alloc(3 * KERN_ARGS_ARRAY_WIDTH * sizeof(size_t)) != hipSuccess)
-        return devk;
+    std::mutex                                                                 mtx;
+    std::map<std::pair<int, kargs_host_t>, std::weak_ptr<gpubuf_t<size_t>>> entries;
+};
 
-    size_t devkHost[3 * KERN_ARGS_ARRAY_WIDTH];
+// never destroyed, since nodes of cached plans can be freed during
+// static destruction
+static kargs_pool_t& kargs_pool()
+{
+    static kargs_pool_t* pool = new kargs_pool_t;
+    return *pool;
+}
 
-    size_t i = 0;
-    while(i < 3 * KERN_ARGS_ARRAY_WIDTH)
-        devkHost[i++] = 0;
+// malloc device buffer; copy host buffer to device buffer
+std::shared_ptr<gpubuf_t<size_t>> kargs_create(const std::vector<size_t>& length,
+                                               const std::vector<size_t>& inStride,
+                                               const std::vector<size_t>& outStride,
+                                               size_t                     iDist,
+                                               size_t                     oDist)
+{
+    kargs_host_t devkHost = {};
 
     assert(length.size() == inStride.size());
     assert(length.size() == outStride.size());
 
-    i = 0;
+    size_t i = 0;
     while(i < length.size())
     {
         devkHost[i + 0 * KERN_ARGS_ARRAY_WIDTH] = length[i];
@@ -58,9 +71,42 @@ gpubuf_t<size_t> kargs_create(std::vector<size_t> length,
     devkHost[i + 1 * KERN_ARGS_ARRAY_WIDTH] = iDist;
     devkHost[i + 2 * KERN_ARGS_ARRAY_WIDTH] = oDist;
 
-    if(hipMemcpy(
-           devk.data(), devkHost, 3 * KERN_ARGS_ARRAY_WIDTH * sizeof(size_t), hipMemcpyHostToDevice)
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        return nullptr;
+    const auto key = std::make_pair(deviceId, devkHost);
+
+    auto&                       pool = kargs_pool();
+    std::lock_guard<std::mutex> lock(pool.mtx);
+    auto&                       entry = pool.entries[key];
+    if(auto existing = entry.lock())
+        return existing;
+
+    auto buf = std::make_unique<gpubuf_t<size_t>>();
+    if(buf->alloc(devkHost.size() * sizeof(size_t)) != hipSuccess)
+    {
+        pool.entries.erase(key);
+        return nullptr;
+    }
+    if(hipMemcpy(buf->data(),
+                 devkHost.data(),
+                 devkHost.size() * sizeof(size_t),
+                 hipMemcpyHostToDevice)
        != hipSuccess)
-        devk.free();
+    {
+        pool.entries.erase(key);
+        return nullptr;
+    }
+
+    std::shared_ptr<gpubuf_t<size_t>> devk(buf.release(), [key](gpubuf_t<size_t>* p) {
+        delete p;
+        // the entry may already have been replaced by a new buffer
+        auto&                       pool = kargs_pool();
+        std::lock_guard<std::mutex> lock(pool.mtx);
+        auto                        it = pool.entries.find(key);
+        if(it != pool.entries.end() && it->second.expired())
+            pool.entries.erase(it);
+    });
+    entry = devk;
     return devk;
 }
@@ -0,0 +1,97 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "link_topology.h"
+#include "tree_node.h"
+
+#include <algorithm>
+#include <hip/hip_runtime_api.h>
+
+// HSA_AMD_LINK_INFO_TYPE_XGMI, as returned by
+// hipExtGetLinkTypeAndHopCount
+static const uint32_t LINK_TYPE_XGMI = 4;
+
+static const double COST_XGMI   = 1.0;
+static const double COST_PCIE   = 4.0;
+static const double COST_HOST   = 8.0;
+static const double COST_REMOTE = 16.0;
+
+LinkTopology::LinkTopology()
+{
+    int deviceCount = 0;
+    if(hipGetDeviceCount(&deviceCount) != hipSuccess)
+        deviceCount = 0;
+
+    cost.assign(deviceCount, std::vector<double>(deviceCount, COST_PCIE));
+    for(int src = 0; src < deviceCount; ++src)
+    {
+        for(int dest = 0; dest < deviceCount; ++dest)
+        {
+            auto& c = cost[src][dest];
+            if(src == dest)
+            {
+                c = 0.0;
+                continue;
+            }
+
+            // peers that can't access each other copy through the
+            // host
+            int canAccess = 0;
+            if(hipDeviceCanAccessPeer(&canAccess, src, dest) != hipSuccess || !canAccess)
+            {
+                c = COST_HOST;
+                continue;
+            }
+
+            // assume PCIe if the link can't be queried
+            uint32_t linkType = 0;
+            uint32_t hopCount = 0;
+            if(hipExtGetLinkTypeAndHopCount(src, dest, &linkType, &hopCount) != hipSuccess)
+                continue;
+            c = (linkType == LINK_TYPE_XGMI ? COST_XGMI : COST_PCIE)
+                * std::max<uint32_t>(hopCount, 1);
+        }
+    }
+}
+
+const LinkTopology& LinkTopology::Local()
+{
+    static const LinkTopology topology;
+    return topology;
+}
+
+double LinkTopology::Cost(const rocfft_location_t& src, const rocfft_location_t& dest) const
+{
+    if(src.comm_rank != dest.comm_rank)
+        return COST_REMOTE;
+    if(src.device == dest.device)
+        return 0.0;
+    if(src.device < 0 || dest.device < 0 || static_cast<size_t>(src.device) >= cost.size()
+       || static_cast<size_t>(dest.device) >= cost.size())
+        return COST_PCIE;
+    return cost[src.device][dest.device];
+}
+
+bool LinkTopology::Dedicated(const rocfft_location_t& src, const rocfft_location_t& dest) const
+{
+    if(src.comm_rank != dest.comm_rank)
+        return false;
+    return Cost(src, dest) <= COST_XGMI;
+}
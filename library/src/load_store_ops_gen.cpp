@@ -20,20 +20,294 @@
 
 #include "device/generator/generator.h"
 #include "load_store_ops.h"
+#include "mapped_file.h"
 #include "rtc_kernel.h"
 #include "tree_node.h"
 
+#include <cstdio>
+#include <set>
+
+// Types of complex and real elements in memory for a storage
+// format.  Narrow formats are computed in single precision, and
+// single storage in the kernel's precision.
+static const char* storage_complex_type(rocfft_storage_format storage)
+{
+    switch(storage)
+    {
+    case rocfft_storage_format_native:
+        return "scalar_type";
+    case rocfft_storage_format_half:
+        return "rocfft_complex<_Float16>";
+    case rocfft_storage_format_bfloat16:
+        return "rocfft_complex<rocfft_bfloat16_t>";
+    case rocfft_storage_format_fp8_e4m3:
+        return "rocfft_complex<rocfft_fp8_e4m3_t>";
+    case rocfft_storage_format_fp8_e5m2:
+        return "rocfft_complex<rocfft_fp8_e5m2_t>";
+    case rocfft_storage_format_int16:
+        return "rocfft_complex<int16_t>";
+    case rocfft_storage_format_int8:
+        return "rocfft_complex<int8_t>";
+    case rocfft_storage_format_single:
+        return "rocfft_complex<float>";
+    }
+    throw std::runtime_error("unknown storage format");
+}
+
+static const char* storage_real_type(rocfft_storage_format storage)
+{
+    switch(storage)
+    {
+    case rocfft_storage_format_native:
+        return "real_type_t<scalar_type>";
+    case rocfft_storage_format_half:
+        return "_Float16";
+    case rocfft_storage_format_bfloat16:
+        return "rocfft_bfloat16_t";
+    case rocfft_storage_format_fp8_e4m3:
+        return "rocfft_fp8_e4m3_t";
+    case rocfft_storage_format_fp8_e5m2:
+        return "rocfft_fp8_e5m2_t";
+    case rocfft_storage_format_int16:
+        return "int16_t";
+    case rocfft_storage_format_int8:
+        return "int8_t";
+    case rocfft_storage_format_single:
+        return "float";
+    }
+    throw std::runtime_error("unknown storage format");
+}
+
+// Return the name of the buffer that a global load or store
+// accesses.
+static const std::string& storage_buffer_name(const Expression& ptr)
+{
+    auto var = std::get_if<Variable>(&ptr);
+    if(!var)
+        throw std::runtime_error("storage conversion needs a named buffer");
+    return var->name;
+}
+
+// Change the types of the named buffer arguments to the element
+// types of a storage format.  If real_elements is true, complex
+// buffers become buffers of real elements.
+static void set_storage_types(ArgumentList&                args,
+                              const std::set<std::string>& buffers,
+                              rocfft_storage_format        storage,
+                              bool                         real_elements = false)
+{
+    for(auto& arg : args.arguments)
+    {
+        if(!buffers.count(arg.name))
+            continue;
+        auto replace = [&arg](const std::string& from, const std::string& to) {
+            auto pos = arg.type.find(from);
+            if(pos == std::string::npos)
+                return false;
+            arg.type.replace(pos, from.size(), to);
+            return true;
+        };
+        if(!replace("real_type_t<scalar_type>", storage_real_type(storage)))
+            replace("scalar_type",
+                    real_elements ? storage_real_type(storage) : storage_complex_type(storage));
+    }
+}
+
+// true if the element at offset "index" in a buffer is inside
+// "lengths", or inside the ranges of "lengths" that begin at
+// "starts" if those are given.  Coordinates are peeled off the
+// offset within the transform, slowest dimension first.
+static Expression in_lengths(const Expression&            index,
+                             const Variable&              dist,
+                             const std::vector<Variable>& strides,
+                             const std::vector<Variable>& lengths,
+                             const std::vector<Variable>& starts = {})
+{
+    Expression rem  = Parens{Parens{index} % dist};
+    Expression cond = Literal{"true"};
+    for(size_t i = lengths.size(); i-- > 0;)
+    {
+        // unsigned arithmetic makes one comparison check both ends
+        // of a range
+        Expression coord = Parens{rem / strides[i]};
+        Expression inDim = starts.empty() ? Expression{coord < lengths[i]}
+                                          : Expression{coord - starts[i] < lengths[i]};
+        cond             = i == lengths.size() - 1 ? inDim : Expression{cond && inDim};
+        rem              = Parens{rem % strides[i]};
+    }
+    return cond;
+}
+
+// Loads from buffers in a non-native storage format convert the
+// loaded values to the kernel's precision.  Elements in the zero
+// padding are then replaced with zero (without being read), and the
+// rest are multiplied by the window and the scale factor.
+struct LoadOpsVisitor : public BaseVisitor
+{
+    LoadOpsVisitor(const LoadOps& ops)
+        : ops(ops)
+        , scale_factor("load_scale_factor", "const real_type_t<scalar_type>")
+        , dist("load_dist", "const size_t")
+        , window("load_window", "const real_type_t<scalar_type>", true, true)
+    {
+        for(size_t i = 0; i < ops.valid_lengths.size(); ++i)
+        {
+            valid_strides.emplace_back("load_valid_stride" + std::to_string(i), "const size_t");
+            valid_lengths.emplace_back("load_valid_length" + std::to_string(i), "const size_t");
+        }
+    }
+
+    Function visit_Function(const Function& x) override
+    {
+        if(!ops.enabled())
+            return x;
+
+        Function y{x};
+        if(ops.scale_factor != 1.0)
+            y.arguments.append(scale_factor);
+        if(ops.window || !ops.valid_lengths.empty())
+            y.arguments.append(dist);
+        if(ops.window)
+            y.arguments.append(window);
+        for(size_t i = 0; i < valid_lengths.size(); ++i)
+        {
+            y.arguments.append(valid_strides[i]);
+            y.arguments.append(valid_lengths[i]);
+        }
+        for(const auto& arg : y.arguments.arguments)
+        {
+            if(arg.type.find("real_type_t<scalar_type>") != std::string::npos)
+                real_buffers.insert(arg.name);
+        }
+        y = BaseVisitor::visit_Function(y);
+        set_storage_types(y.arguments, buffers, ops.storage);
+        return y;
+    }
+
+    // convert a value loaded from "buffer" to the type the kernel
+    // computes in, which is wider than the storage format for
+    // single storage in a double-precision kernel
+    Expression widen(const Expression& x, const std::string& buffer)
+    {
+        buffers.insert(buffer);
+        return CallExpr{real_buffers.count(buffer) ? "real_type_t<scalar_type>" : "scalar_type",
+                        {x}};
+    }
+
+    Expression scale(const Expression& x)
+    {
+        if(ops.scale_factor != 1.0)
+            return x * scale_factor;
+        return x;
+    }
+
+    // index of the window element for a load.  A frame window needs
+    // the element's position in its transform, which only some
+    // kernels pass to their loads.
+    Expression window_index(const Expression& index, const Expression* transform_index)
+    {
+        if(!ops.frame_window)
+            return Parens{index} % dist;
+        if(!transform_index)
+            throw std::runtime_error("frame window needs the position of loaded elements");
+        return *transform_index;
+    }
+
+    // apply padding, window and scale to a value loaded from
+    // element offset "index" in the input
+    Expression apply(const Expression& x,
+                     const Expression& index,
+                     const Expression* transform_index = nullptr)
+    {
+        Expression y = x;
+        if(ops.window)
+            y = y * Variable{window, window_index(index, transform_index)};
+        y = scale(y);
+        if(!ops.valid_lengths.empty())
+            y = Parens{Ternary{in_lengths(index, dist, valid_strides, valid_lengths),
+                               Expression{Parens{y}},
+                               Literal{"scalar_type{}"}}};
+        return y;
+    }
+
+    Expression visit_LoadGlobal(const LoadGlobal& x) override
+    {
+        const Expression* transform_index = x.args.size() > 2 ? &x.args[2] : nullptr;
+        if(ops.storage == rocfft_storage_format_native)
+            return apply(BaseVisitor::visit_LoadGlobal(x), x.args[1], transform_index);
+
+        return apply(widen(CallExpr{"load_storage", {x.args[0], std::visit(*this, x.args[1])}},
+                           storage_buffer_name(x.args[0])),
+                     x.args[1],
+                     transform_index);
+    }
+
+    Expression visit_IntrinsicLoad(const IntrinsicLoad& x) override
+    {
+        auto y     = BaseVisitor::visit_IntrinsicLoad(x);
+        auto index = x.args[1] + x.args[2];
+        if(ops.storage == rocfft_storage_format_native)
+            return apply(y, index);
+
+        return apply(widen(CallExpr{"from_storage", {y}}, storage_buffer_name(x.args[0])),
+                     index);
+    }
+
+    Expression visit_LoadGlobalPlanar(const LoadGlobalPlanar& x) override
+    {
+        if(ops.storage != rocfft_storage_format_native)
+            throw std::runtime_error("storage formats are not supported for planar data");
+        if(ops.window || !ops.valid_lengths.empty())
+            throw std::runtime_error("input window/padding is not supported for planar data");
+        return scale(BaseVisitor::visit_LoadGlobalPlanar(x));
+    }
+
+    Expression visit_IntrinsicLoadPlanar(const IntrinsicLoadPlanar& x) override
+    {
+        if(ops.storage != rocfft_storage_format_native)
+            throw std::runtime_error("storage formats are not supported for planar data");
+        if(ops.window || !ops.valid_lengths.empty())
+            throw std::runtime_error("input window/padding is not supported for planar data");
+        return scale(BaseVisitor::visit_IntrinsicLoadPlanar(x));
+    }
+
+    const LoadOps&        ops;
+    Variable              scale_factor;
+    Variable              dist;
+    Variable              window;
+    std::vector<Variable> valid_strides;
+    std::vector<Variable> valid_lengths;
+    std::set<std::string> buffers;
+    std::set<std::string> real_buffers;
+};
+
 Function LoadOps::add_ops(const Function& f) const
 {
-    return f;
+    auto visitor = LoadOpsVisitor{*this};
+    return visitor(f);
 }
 
+// Stores apply the scale factor and the spectrum multiply, reduce
+// the result to a real value if an output op is requested, add the
+// value already in memory if accumulating, and then convert to a
+// non-native storage format if the buffer needs one.  Elements
+// outside the kept lengths are not stored at all.
 struct StoreOpsVisitor : public BaseVisitor
 {
     StoreOpsVisitor(const StoreOps& ops)
         : ops(ops)
         , scale_factor("scale_factor", "const real_type_t<scalar_type>")
+        , multiply_buffer("multiply_buffer", "const scalar_type", true, true)
+        , multiply_dist("multiply_dist", "const size_t")
+        , dist("store_dist", "const size_t")
     {
+        for(size_t i = 0; i < ops.kept_lengths.size(); ++i)
+        {
+            kept_strides.emplace_back("store_kept_stride" + std::to_string(i), "const size_t");
+            kept_lengths.emplace_back("store_kept_length" + std::to_string(i), "const size_t");
+            if(ops.kept_offset())
+                kept_starts.emplace_back("store_kept_start" + std::to_string(i), "const size_t");
+        }
     }
 
     Function visit_Function(const Function& x) override
@@ -47,41 +321,177 @@ struct StoreOpsVisitor : public BaseVisitor
             Variable arg{"scale_factor", "const real_type_t<scalar_type>"};
             y.arguments.append(scale_factor);
         }
-        return BaseVisitor::visit_Function(y);
+        if(ops.multiply_buffer)
+        {
+            y.arguments.append(multiply_buffer);
+            y.arguments.append(multiply_dist);
+        }
+        if(!kept_lengths.empty())
+            y.arguments.append(dist);
+        for(size_t i = 0; i < kept_lengths.size(); ++i)
+        {
+            y.arguments.append(kept_strides[i]);
+            y.arguments.append(kept_lengths[i]);
+            if(!kept_starts.empty())
+                y.arguments.append(kept_starts[i]);
+        }
+        y = BaseVisitor::visit_Function(y);
+        set_storage_types(
+            y.arguments, buffers, ops.storage, ops.output_op != rocfft_output_op_none);
+        return y;
+    }
+
+    // true if stores can't be left to the kernel's native store,
+    // which may also go through a store callback
+    bool converts() const
+    {
+        return ops.storage != rocfft_storage_format_native || ops.needs_exclusive_output();
     }
 
     template <typename TStatement>
-    StatementList visit_Store(const TStatement& x)
+    TStatement scale(const TStatement& x)
     {
-        if(!ops.enabled())
-            return {x};
+        TStatement y{x};
+        if(ops.scale_factor != 1.0)
+            y.value = y.value * scale_factor;
+        return y;
+    }
 
+    // index is the element offset being written.  Taking it modulo
+    // the distance keeps the read in bounds even for lanes whose
+    // store is predicated off.
+    template <typename TStatement>
+    TStatement multiply(const TStatement& x, const Expression& index)
+    {
         TStatement y{x};
-        y.value = y.value * scale_factor;
-        return {y};
+        if(ops.multiply_buffer)
+            y.value = Parens{y.value}
+                      * Variable{multiply_buffer, Parens{index} % multiply_dist};
+        return y;
     }
 
-    StatementList visit_StoreGlobal(const StoreGlobal& x) override
+    // reduce a complex value to the real value requested by the
+    // output op
+    template <typename TStatement>
+    TStatement output(const TStatement& x)
+    {
+        TStatement y{x};
+        switch(ops.output_op)
+        {
+        case rocfft_output_op_none:
+            break;
+        case rocfft_output_op_power:
+            y.value = CallExpr{"output_power", {y.value}};
+            break;
+        case rocfft_output_op_magnitude:
+            y.value = CallExpr{"output_magnitude", {y.value}};
+            break;
+        case rocfft_output_op_log_power:
+            y.value = CallExpr{"output_log_power", {y.value}};
+            break;
+        }
+        return y;
+    }
+
+    // add "existing", the value currently in memory at the
+    // location being stored to
+    template <typename TStatement>
+    TStatement accumulate(const TStatement& x, const Expression& existing)
     {
-        return visit_Store(x);
+        TStatement y{x};
+        if(ops.accumulate)
+            y.value = Parens{y.value} + existing;
+        return y;
     }
 
-    StatementList visit_StoreGlobalPlanar(const StoreGlobalPlanar& x) override
+    StatementList visit_StoreGlobal(const StoreGlobal& x) override
     {
-        return visit_Store(x);
+        if(!ops.enabled())
+            return {x};
+
+        auto y = multiply(scale(x), x.index);
+        if(!converts())
+            return {y};
+
+        buffers.insert(storage_buffer_name(y.ptr));
+        y = output(y);
+        if(ops.accumulate)
+        {
+            auto& ptr = std::get<Variable>(y.ptr);
+            if(ops.storage == rocfft_storage_format_native)
+                y = accumulate(y, Variable{ptr, y.index});
+            else
+                y = accumulate(y, CallExpr{"load_storage", {ptr, y.index}});
+        }
+        Statement store = Call{"store_storage", {y.ptr, y.index, y.value}};
+        if(kept_lengths.empty())
+            return {store};
+        return {If{in_lengths(y.index, dist, kept_strides, kept_lengths, kept_starts), {store}}};
     }
 
     StatementList visit_IntrinsicStore(const IntrinsicStore& x) override
     {
-        return visit_Store(x);
+        if(!ops.enabled())
+            return {x};
+
+        auto y = multiply(scale(x), x.voffset + x.soffset);
+        if(!converts())
+            return {y};
+
+        buffers.insert(storage_buffer_name(y.ptr));
+        y = output(y);
+        if(ops.accumulate)
+        {
+            // the load is predicated the same way as the store, so
+            // it stays in bounds
+            Expression existing = IntrinsicLoad{{y.ptr, y.voffset, y.soffset, y.rw_flag}};
+            if(ops.storage != rocfft_storage_format_native)
+                existing = CallExpr{"from_storage", {existing}};
+            y = accumulate(y, existing);
+        }
+        y.value = CallExpr{"to_storage", {y.ptr, y.value}};
+        // lanes outside the kept lengths don't store
+        if(!kept_lengths.empty())
+            y.rw_flag = Parens{y.rw_flag}
+                        && in_lengths(
+                               y.voffset + y.soffset, dist, kept_strides, kept_lengths, kept_starts);
+        return {y};
+    }
+
+    StatementList visit_StoreGlobalPlanar(const StoreGlobalPlanar& x) override
+    {
+        if(ops.storage != rocfft_storage_format_native)
+            throw std::runtime_error("storage formats are not supported for planar data");
+        if(ops.multiply_buffer)
+            throw std::runtime_error("spectrum multiply is not supported for planar data");
+        if(ops.needs_exclusive_output())
+            throw std::runtime_error("output ops are not supported for planar data");
+        if(!ops.enabled())
+            return {x};
+        return {scale(x)};
     }
 
     StatementList visit_IntrinsicStorePlanar(const IntrinsicStorePlanar& x) override
     {
-        return visit_Store(x);
+        if(ops.storage != rocfft_storage_format_native)
+            throw std::runtime_error("storage formats are not supported for planar data");
+        if(ops.multiply_buffer)
+            throw std::runtime_error("spectrum multiply is not supported for planar data");
+        if(ops.needs_exclusive_output())
+            throw std::runtime_error("output ops are not supported for planar data");
+        if(!ops.enabled())
+            return {x};
+        return {scale(x)};
     }
-    const StoreOps& ops;
-    Variable        scale_factor;
+    const StoreOps&       ops;
+    Variable              scale_factor;
+    Variable              multiply_buffer;
+    Variable              multiply_dist;
+    Variable              dist;
+    std::vector<Variable> kept_strides;
+    std::vector<Variable> kept_lengths;
+    std::vector<Variable> kept_starts;
+    std::set<std::string> buffers;
 };
 
 Function StoreOps::add_ops(const Function& f) const
@@ -90,6 +500,26 @@ Function StoreOps::add_ops(const Function& f) const
     return visitor(f);
 }
 
+std::string InlineCallback::hash() const
+{
+    // FNV-1a, so that the same callback gets the same kernel names
+    // (and RTC cache entries) across processes and builds
+    FNV1aHash  h;
+    const auto feed = [&h](const std::string& str) {
+        h.add(str);
+        // separate the strings, so moving characters between them
+        // changes the hash
+        const unsigned char separator = 0xff;
+        h.add(&separator, 1);
+    };
+    feed(function);
+    feed(source);
+
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(h.value));
+    return buf;
+}
+
 std::string load_store_name_suffix(const LoadOps& loadOps, const StoreOps& storeOps)
 {
     std::string suffix;
@@ -22,27 +22,58 @@
 #include "rtc_kernel.h"
 #include "tree_node.h"
 
-void LoadOps::append_args(RTCKernelArgs& kargs, TreeNode& node) const {}
+// append a scale factor in the precision the kernel computes in
+static void append_scale_factor(RTCKernelArgs& kargs, TreeNode& node, double scale_factor)
+{
+    switch(node.precision)
+    {
+    case rocfft_precision_single:
+        kargs.append_float(scale_factor);
+        break;
+    case rocfft_precision_double:
+        kargs.append_double(scale_factor);
+        break;
+    case rocfft_precision_half:
+        // Convert scale factor to float first before truncating it to
+        // _Float16.  Directly truncating a double to _Float16 introduces
+        //  an unwanted symbol (__truncdfhf2) to rocFFT's lib.
+        kargs.append_half(static_cast<float>(scale_factor));
+        break;
+    }
+}
+
+void LoadOps::append_args(RTCKernelArgs& kargs, TreeNode& node) const
+{
+    if(scale_factor != 1.0)
+        append_scale_factor(kargs, node, scale_factor);
+    if(window || !valid_lengths.empty())
+        kargs.append_size_t(dist);
+    if(window)
+        kargs.append_ptr(window);
+    for(size_t i = 0; i < valid_lengths.size(); ++i)
+    {
+        kargs.append_size_t(valid_strides[i]);
+        kargs.append_size_t(valid_lengths[i]);
+    }
+}
 
 void StoreOps::append_args(RTCKernelArgs& kargs, TreeNode& node) const
 {
     if(scale_factor != 1.0)
+        append_scale_factor(kargs, node, scale_factor);
+    if(multiply_buffer)
+    {
+        kargs.append_ptr(multiply_buffer);
+        kargs.append_size_t(multiply_dist);
+    }
+    if(!kept_lengths.empty())
+        kargs.append_size_t(dist);
+    for(size_t i = 0; i < kept_lengths.size(); ++i)
     {
-        switch(node.precision)
-        {
-        case rocfft_precision_single:
-            kargs.append_float(scale_factor);
-            break;
-        case rocfft_precision_double:
-            kargs.append_double(scale_factor);
-            break;
-        case rocfft_precision_half:
-            // Convert scale factor to float first before truncating it to
-            // _Float16.  Directly truncating a double to _Float16 introduces
-            //  an unwanted symbol (__truncdfhf2) to rocFFT's lib.
-            kargs.append_half(static_cast<float>(scale_factor));
-            break;
-        }
+        kargs.append_size_t(kept_strides[i]);
+        kargs.append_size_t(kept_lengths[i]);
+        if(kept_offset())
+            kargs.append_size_t(kept_starts[i]);
     }
 }
 
@@ -0,0 +1,99 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "mapped_file.h"
+
+#include <stdexcept>
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::filesystem::path& path, const std::string& what)
+{
+#ifdef WIN32
+    HANDLE file = CreateFileA(path.string().c_str(),
+                              GENERIC_READ,
+                              FILE_SHARE_READ,
+                              nullptr,
+                              OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("failed to open " + what + " " + path.string());
+    file_handle = file;
+
+    LARGE_INTEGER file_size;
+    HANDLE        mapping = nullptr;
+    if(GetFileSizeEx(file, &file_size))
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(!mapping)
+    {
+        CloseHandle(file);
+        throw std::runtime_error("failed to map " + what + " " + path.string());
+    }
+    mapping_handle = mapping;
+
+    ptr = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    len = file_size.QuadPart;
+    if(!ptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("failed to map " + what + " " + path.string());
+    }
+#else
+    int fd = open(path.string().c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("failed to open " + what + " " + path.string());
+
+    struct stat st;
+    void*       mapped = MAP_FAILED;
+    if(fstat(fd, &st) == 0 && st.st_size > 0)
+        mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+    if(mapped == MAP_FAILED)
+        throw std::runtime_error("failed to map " + what + " " + path.string());
+    ptr = static_cast<const char*>(mapped);
+    len = st.st_size;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef WIN32
+    if(ptr)
+        UnmapViewOfFile(ptr);
+    if(mapping_handle)
+        CloseHandle(mapping_handle);
+    if(file_handle)
+        CloseHandle(file_handle);
+#else
+    if(ptr)
+        munmap(const_cast<char*>(ptr), len);
+#endif
+}
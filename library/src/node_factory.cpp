@@ -20,17 +20,21 @@
 
 #include "node_factory.h"
 #include "../../shared/arithmetic.h"
+#include "../../shared/array_predicate.h"
 #include "../../shared/precision_type.h"
 #include "function_pool.h"
 #include "fuse_shim.h"
 #include "hip/hip_runtime_api.h"
 #include "logging.h"
+#include "rtc_radix_gen.h"
 #include "tree_node_1D.h"
 #include "tree_node_2D.h"
 #include "tree_node_3D.h"
+#include "tree_node_ND.h"
 #include "tree_node_bluestein.h"
 #include "tree_node_real.h"
 
+#include <algorithm>
 #include <functional>
 #include <set>
 #include <vector>
@@ -334,9 +338,76 @@ bool NodeFactory::NonPow2LengthSupported(rocfft_precision precision, size_t leng
     return false;
 }
 
-size_t NodeFactory::GetBluesteinLength(rocfft_precision precision, size_t len)
+std::vector<size_t>
+    NodeFactory::NonPow2LengthsSupported(rocfft_precision precision, size_t minLen, size_t maxLen)
 {
-    return BluesteinNode::FindBlue(len, precision, BluesteinSingleNode::SizeFits(len, precision));
+    auto poolPrecision = precision == rocfft_precision_half ? rocfft_precision_single : precision;
+    const auto& map1DLength
+        = poolPrecision == rocfft_precision_single ? map1DLengthSingle : map1DLengthDouble;
+
+    auto candidates = function_pool::get_lengths(poolPrecision, CS_KERNEL_STOCKHAM);
+    for(auto itr = map1DLength.lower_bound(minLen); itr != map1DLength.end() && itr->first < maxLen;
+        ++itr)
+        candidates.push_back(itr->first);
+
+    std::vector<size_t> lengths;
+    for(auto len : candidates)
+    {
+        if(len >= minLen && len < maxLen && NonPow2LengthSupported(precision, len))
+            lengths.push_back(len);
+    }
+    std::sort(lengths.begin(), lengths.end());
+    lengths.erase(std::unique(lengths.begin(), lengths.end()), lengths.end());
+    return lengths;
+}
+
+size_t NodeFactory::Large1DDivLength(rocfft_precision precision, size_t len)
+{
+    const auto& map1DLength
+        = precision == rocfft_precision_double ? map1DLengthDouble : map1DLengthSingle;
+    auto itr = map1DLength.find(len);
+    return itr == map1DLength.end() ? 0 : itr->second;
+}
+
+size_t NodeFactory::CRTColumnLength(const NodeMetaData& nodeData)
+{
+    // SBCC assumes consecutive column FFTs are adjacent in memory
+    if(nodeData.iDist == 1 || nodeData.oDist == 1)
+        return 0;
+
+    const auto precision = nodeData.precision;
+    const auto len       = nodeData.length[0];
+
+    // the row kernel must fit on the device and do enough rows per
+    // block for its transpose to be fused into its stores (see
+    // canOptimizeWithStride), and the column kernel may be derived
+    // from a row kernel.  prefer the most balanced split, which keeps
+    // both kernels' twiddle and LDS use small.
+    const size_t minRows = precision == rocfft_precision_double ? 4 : 8;
+    size_t       best    = 0;
+    for(auto col : function_pool::get_lengths(precision, CS_KERNEL_STOCKHAM))
+    {
+        if(col <= 1 || len % col != 0 || !function_pool::has_SBCC_kernel(col, precision, true))
+            continue;
+        FMKey rowKey(len / col, precision);
+        if(!function_pool::has_function_for_device(rowKey, nodeData.deviceProp)
+           || function_pool::get_kernel(rowKey).transforms_per_block < minRows)
+            continue;
+        auto imbalance = [len](size_t c) {
+            return std::max(c * c, len) / std::min(c * c, len);
+        };
+        if(best == 0 || imbalance(col) < imbalance(best))
+            best = col;
+    }
+    return best;
+}
+
+size_t NodeFactory::GetBluesteinLength(rocfft_precision       precision,
+                                       size_t                 len,
+                                       const hipDeviceProp_t& deviceProp)
+{
+    return BluesteinNode::FindBlue(
+        len, precision, BluesteinSingleNode::SizeFits(len, precision, deviceProp));
 }
 
 bool NodeFactory::SupportedLength(rocfft_precision precision, size_t len)
@@ -361,6 +432,11 @@ bool NodeFactory::SupportedLength(rocfft_precision precision, size_t len)
         p /= 13;
     while(!(p % 17))
         p /= 17;
+    for(auto radix : generated_prime_radices)
+    {
+        while(!(p % radix))
+            p /= radix;
+    }
 
     if(p == 1)
         return true;
@@ -396,14 +472,22 @@ std::unique_ptr<TreeNode> NodeFactory::CreateNodeFromScheme(ComputeScheme s, Tre
     // Internal Node
     case CS_REAL_TRANSFORM_USING_CMPLX:
         return std::unique_ptr<RealTransCmplxNode>(new RealTransCmplxNode(parent));
+    case CS_REAL_TRANSFORM_PAIR:
+        return std::unique_ptr<RealTransPairNode>(new RealTransPairNode(parent));
+    case CS_REAL_TRANSFORM_PACKED:
+        return std::unique_ptr<RealTransPackedNode>(new RealTransPackedNode(parent));
     case CS_REAL_TRANSFORM_EVEN:
         return std::unique_ptr<RealTransEvenNode>(new RealTransEvenNode(parent));
     case CS_REAL_2D_EVEN:
         return std::unique_ptr<Real2DEvenNode>(new Real2DEvenNode(parent));
     case CS_REAL_3D_EVEN:
         return std::unique_ptr<Real3DEvenNode>(new Real3DEvenNode(parent));
+    case CS_REAL_TO_REAL:
+        return std::unique_ptr<RealToRealNode>(new RealToRealNode(parent));
     case CS_BLUESTEIN:
         return std::unique_ptr<BluesteinNode>(new BluesteinNode(parent));
+    case CS_RADER:
+        return std::unique_ptr<RaderNode>(new RaderNode(parent));
     case CS_L1D_TRTRT:
         return std::unique_ptr<TRTRT1DNode>(new TRTRT1DNode(parent));
     case CS_L1D_CC:
@@ -424,6 +508,8 @@ std::unique_ptr<TreeNode> NodeFactory::CreateNodeFromScheme(ComputeScheme s, Tre
         return std::unique_ptr<BLOCKCR3DNode>(new BLOCKCR3DNode(parent));
     case CS_3D_RC:
         return std::unique_ptr<RC3DNode>(new RC3DNode(parent));
+    case CS_ND_RC:
+        return std::unique_ptr<RCNDNode>(new RCNDNode(parent));
 
     // Leaf Node that need to check external kernel file
     case CS_KERNEL_STOCKHAM:
@@ -436,6 +522,8 @@ std::unique_ptr<TreeNode> NodeFactory::CreateNodeFromScheme(ComputeScheme s, Tre
         return std::unique_ptr<SBCRNode>(new SBCRNode(parent, s));
     case CS_KERNEL_2D_SINGLE:
         return std::unique_ptr<Single2DNode>(new Single2DNode(parent, s));
+    case CS_KERNEL_3D_SINGLE:
+        return std::unique_ptr<Single3DNode>(new Single3DNode(parent, s));
     case CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z:
         return std::unique_ptr<SBRCTransXY_ZNode>(new SBRCTransXY_ZNode(parent, s));
     case CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY:
@@ -457,11 +545,19 @@ std::unique_ptr<TreeNode> NodeFactory::CreateNodeFromScheme(ComputeScheme s, Tre
     case CS_KERNEL_COPY_HERM_TO_CMPLX:
     case CS_KERNEL_COPY_CMPLX_TO_HERM:
     case CS_KERNEL_COPY_CMPLX_TO_R:
+    case CS_KERNEL_PAIR_R_TO_CMPLX:
+    case CS_KERNEL_PAIR_CMPLX_TO_HERM:
+    case CS_KERNEL_PACK_HERM:
+    case CS_KERNEL_UNPACK_HERM:
         return std::unique_ptr<RealTransDataCopyNode>(new RealTransDataCopyNode(parent, s));
     case CS_KERNEL_CHIRP:
     case CS_KERNEL_PAD_MUL:
     case CS_KERNEL_FFT_MUL:
     case CS_KERNEL_RES_MUL:
+    case CS_KERNEL_RADER_CHIRP:
+    case CS_KERNEL_RADER_GATHER:
+    case CS_KERNEL_RADER_MUL:
+    case CS_KERNEL_RADER_SCATTER:
         return std::unique_ptr<BluesteinComponentNode>(new BluesteinComponentNode(parent, s));
     case CS_KERNEL_BLUESTEIN_SINGLE:
         return std::unique_ptr<BluesteinSingleNode>(new BluesteinSingleNode(parent, s));
@@ -538,6 +634,9 @@ std::unique_ptr<FuseShim> NodeFactory::CreateFuseShim(FuseType
 
 ComputeScheme NodeFactory::DecideNodeScheme(NodeMetaData& nodeData, TreeNode* parent)
 {
+    if((parent == nullptr) && transform_type_is_real_to_real(nodeData.r2rType))
+        return CS_REAL_TO_REAL;
+
     if((parent == nullptr)
        && ((nodeData.inArrayType == rocfft_array_type_real)
            || (nodeData.outArrayType == rocfft_array_type_real)))
@@ -548,12 +647,15 @@ ComputeScheme NodeFactory::DecideNodeScheme(NodeMetaData& nodeData, TreeNode* pa
     switch(nodeData.dimension)
     {
     case 1:
-        return Decide1DScheme(nodeData);
+        return Decide1DScheme(nodeData, parent);
     case 2:
         return Decide2DScheme(nodeData);
     case 3:
         return Decide3DScheme(nodeData);
     default:
+        // higher ranks are built from 3D and 1D transforms
+        if(nodeData.dimension > 3)
+            return CS_ND_RC;
         throw std::runtime_error("Invalid dimension");
     }
 
@@ -562,6 +664,9 @@ ComputeScheme NodeFactory::DecideNodeScheme(NodeMetaData& nodeData, TreeNode* pa
 
 ComputeScheme NodeFactory::DecideRealScheme(NodeMetaData& nodeData)
 {
+    if(use_CS_REAL_TRANSFORM_PACKED(nodeData))
+        return CS_REAL_TRANSFORM_PACKED;
+
     // use size in real units to decide what scheme to use
     const auto& realLength = nodeData.direction == -1 ? nodeData.length : nodeData.outputLength;
 
@@ -579,20 +684,117 @@ ComputeScheme NodeFactory::DecideRealScheme(NodeMetaData& nodeData)
             throw std::runtime_error("Invalid dimension");
         }
     }
+    if(use_CS_REAL_TRANSFORM_PAIR(nodeData))
+        return CS_REAL_TRANSFORM_PAIR;
+
     // Fallback method
     return CS_REAL_TRANSFORM_USING_CMPLX;
 }
 
-ComputeScheme NodeFactory::Decide1DScheme(NodeMetaData& nodeData)
+bool NodeFactory::use_CS_REAL_TRANSFORM_PACKED(NodeMetaData& nodeData)
+{
+    // packed Hermitian data is N/2 long, instead of N/2+1
+    const auto& realLength    = nodeData.direction == -1 ? nodeData.length : nodeData.outputLength;
+    const auto& complexLength = nodeData.direction == -1 ? nodeData.outputLength : nodeData.length;
+    return !realLength.empty() && !complexLength.empty()
+           && realLength.front() == 2 * complexLength.front();
+}
+
+bool NodeFactory::use_CS_REAL_TRANSFORM_PAIR(NodeMetaData& nodeData)
+{
+    if(nodeData.dimension != 1 || nodeData.direction != -1 || nodeData.batch % 2 != 0)
+        return false;
+
+    // even lengths do better as half-length complex transforms
+    if(nodeData.length[0] % 2 == 0)
+        return false;
+
+    // out-of-place lengths with a single kernel are done by that
+    // kernel directly on the real data, which beats packing
+    if(nodeData.placement == rocfft_placement_notinplace
+       && function_pool::has_function(FMKey(nodeData.length[0], nodeData.precision)))
+        return false;
+
+    return true;
+}
+
+// A single kernel does one or a few transforms per workgroup, so a
+// small batch of long transforms leaves most of the device idle.
+// Splitting the length over a column and a row kernel gives each
+// kernel many more, smaller workgroups.  Returns the column length
+// of the split and sets its scheme, or returns 0 to keep the single
+// kernel.
+static size_t LowBatchDivLength(const NodeMetaData& nodeData, ComputeScheme& scheme)
+{
+    // shorter transforms are too little work to be worth a second
+    // kernel launch
+    static const size_t MIN_SPLIT_LENGTH = 1024;
+
+    // the split needs a temp buffer for the intermediate result
+    if(nodeData.optStrategy == rocfft_optimize_min_buffer)
+        return 0;
+
+    const size_t len = nodeData.length[0];
+    const int    cus = nodeData.deviceProp.multiProcessorCount;
+    if(len < MIN_SPLIT_LENGTH || cus <= 0)
+        return 0;
+
+    size_t count = nodeData.batch;
+    for(size_t i = 1; i < nodeData.length.size(); ++i)
+        count *= nodeData.length[i];
+    const auto& kernel = function_pool::get_kernel(FMKey(len, nodeData.precision));
+    size_t      blocks
+        = DivRoundingUp<size_t>(count, std::max<size_t>(kernel.transforms_per_block, 1));
+    // leave the single kernel alone once it fills a quarter of the
+    // device, or all of it if the plan is optimized for latency
+    const size_t fillCUs = nodeData.optStrategy == rocfft_optimize_max_fusion
+                               ? static_cast<size_t>(cus)
+                               : DivRoundingUp<size_t>(cus, 4);
+    if(blocks >= fillCUs)
+        return 0;
+
+    if(auto divLength1 = NodeFactory::Large1DDivLength(nodeData.precision, len))
+    {
+        scheme = CS_L1D_CC;
+        return divLength1;
+    }
+    if(auto divLength1 = NodeFactory::CRTColumnLength(nodeData))
+    {
+        scheme = CS_L1D_CRT;
+        return divLength1;
+    }
+    return 0;
+}
+
+ComputeScheme NodeFactory::Decide1DScheme(NodeMetaData& nodeData, const TreeNode* parent)
 {
     ComputeScheme scheme = CS_NONE;
 
     // Build a node for a 1D FFT
+    // primes whose p-1 we can FFT directly avoid Bluestein's padding
     if(!SupportedLength(nodeData.precision, nodeData.length[0]))
-        return CS_BLUESTEIN;
-
-    if(function_pool::has_function(FMKey(nodeData.length[0], nodeData.precision)))
+        return RaderNode::SizeFits(nodeData.length[0], nodeData.precision, nodeData.deviceProp)
+                   ? CS_RADER
+                   : CS_BLUESTEIN;
+
+    // use a single kernel if the whole transform fits in the
+    // device's LDS.  the longest kernels don't fit everywhere.
+    if(function_pool::has_function_for_device(FMKey(nodeData.length[0], nodeData.precision),
+                                              nodeData.deviceProp))
     {
+        // unless the batch is too small to occupy the device.  only
+        // split transforms the user asked for (directly, or as the
+        // complex half of a real transform), not ones that are part
+        // of a larger algorithm like Bluestein.
+        if(parent == nullptr ? !nodeData.keepSingleKernel
+                             : parent->scheme == CS_REAL_TRANSFORM_EVEN)
+        {
+            if(auto divLength1 = LowBatchDivLength(nodeData, scheme))
+            {
+                nodeData.length.emplace_back(divLength1);
+                return scheme;
+            }
+        }
         return CS_KERNEL_STOCKHAM;
     }
 
@@ -640,6 +842,12 @@ ComputeScheme NodeFactory::Decide1DScheme(NodeMetaData& nodeData)
             {
                 scheme = CS_L1D_CC;
             }
+
+            if(failed && (divLength1 = CRTColumnLength(nodeData)))
+            {
+                scheme = CS_L1D_CRT;
+                failed = false;
+            }
         }
         else
         {
@@ -667,6 +875,15 @@ ComputeScheme NodeFactory::Decide1DScheme(NodeMetaData& nodeData)
                 divLength1 = (size_t)1 << in_x;
             }
             scheme = CS_L1D_TRTRT;
+
+            // a column kernel with fused twiddles, then a row kernel
+            // writing transposed output, is two passes instead of
+            // TRTRT's three
+            if(auto colLength = CRTColumnLength(nodeData))
+            {
+                divLength1 = colLength;
+                scheme     = CS_L1D_CRT;
+            }
         }
     }
     else // if not Pow2
@@ -703,6 +920,12 @@ ComputeScheme NodeFactory::Decide1DScheme(NodeMetaData& nodeData)
             }
         }
 
+        if(failed && (divLength1 = CRTColumnLength(nodeData)))
+        {
+            scheme = CS_L1D_CRT;
+            failed = false;
+        }
+
         if(failed)
         {
             scheme     = CS_L1D_TRTRT;
@@ -770,9 +993,10 @@ static bool Apply_SBCR(NodeMetaData& nodeData)
 
 ComputeScheme NodeFactory::Decide3DScheme(NodeMetaData& nodeData)
 {
-    // this flag can be enabled when generator can do block column fft in
-    // multi-dimension cases and small 2d, 3d within one kernel
-    bool MultiDimFuseKernelsAvailable = false;
+    // First choice is 3D_SINGLE kernel, if the whole volume will fit
+    // into LDS.
+    if(use_CS_3D_SINGLE(nodeData))
+        return CS_KERNEL_3D_SINGLE;
 
     // try 3 SBCR kernels first
     if(Apply_SBCR(nodeData))
@@ -783,16 +1007,6 @@ ComputeScheme NodeFactory::Decide3DScheme(NodeMetaData& nodeData)
     {
         return CS_3D_RC;
     }
-    else if(MultiDimFuseKernelsAvailable)
-    {
-        // conditions to choose which scheme
-        if((nodeData.length[0] * nodeData.length[1] * nodeData.length[2]) <= 2048)
-            return CS_KERNEL_3D_SINGLE;
-        else if(nodeData.length[2] <= 256)
-            return CS_3D_RC;
-        else
-            return CS_3D_RTRT;
-    }
     else
     {
         // if we can get down to 3 or 4 kernels via SBRC, prefer that
@@ -830,7 +1044,29 @@ ComputeScheme NodeFactory::Decide3DScheme(NodeMetaData& nodeData)
 
         return CS_3D_RTRT;
     }
-    // TODO: CS_KERNEL_3D_SINGLE?
+}
+
+bool NodeFactory::use_CS_3D_SINGLE(NodeMetaData& nodeData)
+{
+    // 3D_SINGLE is C2C only, it has no embedded real pre/post
+    // processing
+    if(!nodeData.rootIsC2C)
+        return false;
+
+    if(Single3DNode::WorkgroupSize(nodeData.length, nodeData.precision) == 0)
+        return false;
+
+    // the whole volume needs to fit into LDS, with some headroom
+    // like 2D_SINGLE
+    size_t ldsSize = nodeData.deviceProp.sharedMemPerBlock;
+    if(ldsSize == 0)
+        ldsSize = 64 * 1024;
+    size_t ldsUsage
+        = Single3DNode::LDSElems(nodeData.length) * complex_type_size(nodeData.precision);
+    if(1.5 * ldsUsage > ldsSize)
+        return false;
+
+    return true;
 }
 
 bool NodeFactory::use_CS_2D_SINGLE(NodeMetaData& nodeData)
@@ -839,40 +1075,24 @@ bool NodeFactory::use_CS_2D_SINGLE(NodeMetaData& nodeData)
            FMKey(nodeData.length[0], nodeData.length[1], nodeData.precision, CS_KERNEL_2D_SINGLE)))
         return false;
 
-    // Get actual LDS size, to check if we can run a 2D_SINGLE
-    // kernel that will fit the problem into LDS.
-    //
-    // NOTE: This is potentially problematic in a heterogeneous
-    // multi-device environment.  The device we query now could
-    // differ from the device we run the plan on.  That said,
-    // it's vastly more common to have multiples of the same
-    // device in the real world.
-    int ldsSize;
-    int deviceid;
-    // if this fails, device 0 is a reasonable default
-    if(hipGetDevice(&deviceid) != hipSuccess)
-    {
-        log_trace(__func__, "warning", "hipGetDevice failed - using device 0");
-        deviceid = 0;
-    }
-    // if this fails, giving 0 to Single2DSizes will assume
-    // normal size for contemporary hardware
-    if(hipDeviceGetAttribute(&ldsSize, hipDeviceAttributeMaxSharedMemoryPerMultiprocessor, deviceid)
-       != hipSuccess)
-    {
-        log_trace(__func__,
-                  "warning",
-                  "hipDeviceGetAttribute failed - assuming normal LDS size for current hardware");
-        ldsSize = 0;
-    }
+    // The whole plane lives in LDS, so larger planes only fit on
+    // devices with more LDS per workgroup.  Check the device the plan
+    // is being built for, which might not be the current device.
+    // Unknown devices are assumed to have the usual 64 KiB.
+    size_t ldsSize = nodeData.deviceProp.sharedMemPerBlock;
+    if(ldsSize == 0)
+        ldsSize = 64 * 1024;
 
     auto kernel = function_pool::get_kernel(
         FMKey(nodeData.length[0], nodeData.length[1], nodeData.precision, CS_KERNEL_2D_SINGLE));
 
-    int ldsUsage = nodeData.length[0] * nodeData.length[1] * kernel.transforms_per_block
-                   * complex_type_size(nodeData.precision);
+    size_t ldsUsage = nodeData.length[0] * nodeData.length[1] * kernel.transforms_per_block
+                      * complex_type_size(nodeData.precision);
     if(1.5 * ldsUsage > ldsSize)
         return false;
+    if(nodeData.deviceProp.maxThreadsPerBlock > 0
+       && kernel.workgroup_size > nodeData.deviceProp.maxThreadsPerBlock)
+        return false;
 
     return true;
 }
@@ -934,7 +1154,7 @@ bool NodeFactory::use_CS_3D_RC(NodeMetaData& nodeData)
         return true;
 
     FMKey key(nodeData.length[2], nodeData.precision, CS_KERNEL_STOCKHAM_BLOCK_CC);
-    if(!function_pool::has_function(key))
+    if(!function_pool::has_SBCC_kernel(nodeData.length[2], nodeData.precision))
         return false;
 
     // Check the C part.
@@ -965,3 +1185,87 @@ bool NodeFactory::use_CS_3D_RC(NodeMetaData& nodeData)
 
     return false;
 }
+
+std::vector<TreeShape> NodeFactory::TunableTreeShapes(TreeNode& root)
+{
+    // NB:
+    //   Alternatives only need to be buildable for the problem, not
+    //   preferred by the Decide*Scheme heuristics - deciding which one
+    //   is faster is the tuner's job.
+    std::vector<TreeShape> shapes = {{root.scheme, -1, PrintScheme(root.scheme)}};
+    auto add = [&shapes](ComputeScheme scheme, int variant, const char* variant_name = nullptr) {
+        TreeShape shape{scheme, variant, PrintScheme(scheme)};
+        if(variant_name)
+            shape.name += std::string(" (") + variant_name + ")";
+        if(std::find(shapes.begin(), shapes.end(), shape) == shapes.end())
+            shapes.push_back(shape);
+    };
+
+    auto has_column_kernel = [&root](size_t len) {
+        return function_pool::has_SBCC_kernel(len, root.precision)
+               || function_pool::has_function(FMKey(len, root.precision));
+    };
+
+    NodeMetaData nodeData(&root);
+    bool         innerBatch = (root.iDist == 1 || root.oDist == 1);
+
+    switch(root.scheme)
+    {
+    case CS_L1D_CC:
+    case CS_L1D_CRT:
+    case CS_L1D_TRTRT:
+    {
+        // the factorization decided for the root is at the end of the
+        // lengths, and all the L1D schemes share it
+        size_t lenFactor1 = root.length.back();
+        size_t lenFactor0 = root.length[0] / lenFactor1;
+        if(function_pool::has_SBCC_kernel(lenFactor1, root.precision)
+           && function_pool::has_SBRC_kernel(lenFactor0, root.precision))
+            add(CS_L1D_CC, -1);
+        add(CS_L1D_TRTRT, -1);
+        break;
+    }
+    case CS_2D_RC:
+    case CS_2D_RTRT:
+        if(function_pool::has_SBCC_kernel(root.length[1], root.precision))
+            add(CS_2D_RC, -1);
+        add(CS_2D_RTRT, -1);
+        break;
+    case CS_3D_RC:
+    case CS_3D_BLOCK_RC:
+    case CS_3D_BLOCK_CR:
+    case CS_3D_TRTRTR:
+    case CS_3D_RTRT:
+        if(!innerBatch && function_pool::has_SBCC_kernel(root.length[2], root.precision))
+            add(CS_3D_RC, -1);
+        if(use_CS_3D_BLOCK_RC(nodeData))
+            add(CS_3D_BLOCK_RC, -1);
+        add(CS_3D_TRTRTR, -1);
+        add(CS_3D_RTRT, -1);
+        break;
+    case CS_REAL_2D_EVEN:
+        if(has_column_kernel(root.length[1]))
+            add(CS_REAL_2D_EVEN, Real2DEvenNode::INPLACE_SBCC, "INPLACE_SBCC");
+        add(CS_REAL_2D_EVEN, Real2DEvenNode::TR_PAIR, "TR_PAIR");
+        break;
+    case CS_REAL_3D_EVEN:
+        if(has_column_kernel(root.length[1]) && has_column_kernel(root.length[2]))
+            add(CS_REAL_3D_EVEN, Real3DEvenNode::INPLACE_SBCC, "INPLACE_SBCC");
+        add(CS_REAL_3D_EVEN, Real3DEvenNode::TR_PAIRS, "TR_PAIRS");
+        break;
+    case CS_REAL_TRANSFORM_USING_CMPLX:
+    case CS_REAL_TRANSFORM_PAIR:
+        if(root.dimension == 1 && root.direction == -1 && root.batch % 2 == 0)
+            add(CS_REAL_TRANSFORM_PAIR, -1);
+        add(CS_REAL_TRANSFORM_USING_CMPLX, -1);
+        break;
+    case CS_REAL_TRANSFORM_EVEN:
+        if(root.dimension == 1 && root.direction == -1 && root.batch % 2 == 0)
+            add(CS_REAL_TRANSFORM_PAIR, -1);
+        break;
+    default:
+        // single kernels and the remaining schemes have nothing to choose
+        break;
+    }
+    return shapes;
+}
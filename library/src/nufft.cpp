@@ -0,0 +1,854 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../shared/arithmetic.h"
+#include "../../shared/device_properties.h"
+#include "../../shared/gpubuf.h"
+#include "../../shared/rocfft_hip.h"
+#include "device/kernel-generator-embed.h"
+#include "logging.h"
+#include "plan.h"
+#include "rocfft/rocfft.h"
+#include "rtc_cache.h"
+#include "rtc_kernel.h"
+#include "rtc_module_cache.h"
+#include "transform.h"
+
+// A non-uniform FFT spreads strengths at arbitrary points onto a
+// uniform grid oversampled by 2, with the "exponential of
+// semicircle" kernel
+//
+//   phi(z) = exp(beta * (sqrt(1 - z^2) - 1)),  |z| <= 1
+//
+// stretched over width grid points.  An ordinary plan transforms
+// the grid, and the wanted modes are divided by the kernel's Fourier
+// transform to undo the spreading.  Type 2 transforms run the same
+// steps backwards, interpolating the grid at the points.
+//
+// Spreading, interpolation and the pass between modes and grid are
+// runtime-compiled kernels of their own, specialized for the
+// precision, dimension and kernel width.
+
+static const unsigned int NUFFT_THREADS = 256;
+
+// grid points are spread to or interpolated from, in each dimension
+static const size_t NUFFT_MAX_WIDTH = 16;
+
+// points are sorted into bins of this many grid points in each
+// dimension, so neighbouring threads touch nearby parts of the grid
+static const std::array<size_t, 3> NUFFT_BIN_SIZE = {32, 8, 4};
+
+enum class NufftKernel
+{
+    // strengths at points onto the grid
+    SPREAD,
+    // grid at points into strengths
+    INTERP,
+    // grid modes, divided by the kernel's transform, into user modes
+    GRID_TO_MODES,
+    // the reverse, into a zeroed grid
+    MODES_TO_GRID,
+};
+
+static std::string nufft_rtc_kernel_name(NufftKernel      kind,
+                                         rocfft_precision precision,
+                                         size_t           dim,
+                                         size_t           width)
+{
+    std::string kernel_name;
+    switch(kind)
+    {
+    case NufftKernel::SPREAD:
+        kernel_name = "nufft_spread";
+        break;
+    case NufftKernel::INTERP:
+        kernel_name = "nufft_interp";
+        break;
+    case NufftKernel::GRID_TO_MODES:
+        kernel_name = "nufft_grid_to_modes";
+        break;
+    case NufftKernel::MODES_TO_GRID:
+        kernel_name = "nufft_modes_to_grid";
+        break;
+    }
+    kernel_name += rtc_precision_name(precision);
+    kernel_name += "_" + std::to_string(dim) + "D";
+    // the deconvolution doesn't depend on the kernel width
+    if(kind == NufftKernel::SPREAD || kind == NufftKernel::INTERP)
+        kernel_name += "_w" + std::to_string(width);
+    return kernel_name;
+}
+
+static double nufft_beta(size_t width)
+{
+    // shape parameter for an oversampling factor of 2
+    return 2.30 * width;
+}
+
+// kernel weights for a point, and the first grid point they apply to
+static const char* nufft_weights_src = R"_SRC(
+__device__ void nufft_weights(real_type x, size_t n, real_type* ker, long long& start)
+{
+    // grid coordinate of the point, wrapped into [0, n)
+    real_type t = x * (real_type)(1.0 / TWO_PI);
+    t -= floor(t);
+    const real_type u = t * n;
+    start             = (long long)ceil(u - (real_type)(NUFFT_WIDTH / 2.0));
+    for(unsigned int i = 0; i < NUFFT_WIDTH; ++i)
+    {
+        const real_type z = (start + (long long)i - u) * (real_type)(2.0 / NUFFT_WIDTH);
+        const real_type s = 1 - z * z;
+        ker[i]            = s > 0 ? exp(NUFFT_BETA * (sqrt(s) - 1)) : 0;
+    }
+}
+
+// weights of the point in each dimension.  Dimensions past the
+// transform's have one grid point with weight 1.
+__device__ void nufft_point_weights(size_t           M,
+                                    size_t           j,
+                                    const real_type* coords,
+                                    const size_t*    n,
+                                    real_type (*ker)[NUFFT_WIDTH],
+                                    long long* start)
+{
+    for(unsigned int d = 0; d < 3; ++d)
+    {
+        if(d < NUFFT_DIM)
+            nufft_weights(coords[d * M + j], n[d], ker[d], start[d]);
+        else
+        {
+            ker[d][0] = 1;
+            start[d]  = 0;
+        }
+    }
+}
+)_SRC";
+
+// point kernels run one thread per point, in sorted order, looping
+// over transforms in the y dimension of the grid
+static const char* nufft_point_args_src = R"_SRC(
+    (size_t M,
+     size_t ntransforms,
+     const real_type* __restrict__ coords,
+     const size_t* __restrict__ perm,
+     scalar_type* strengths,
+     scalar_type* grid,
+     size_t n0,
+     size_t n1,
+     size_t n2)
+)_SRC";
+
+static const char* nufft_spread_body_src = R"_SRC(
+{
+    const size_t j = blockIdx.x * blockDim.x + threadIdx.x;
+    if(j >= M)
+        return;
+    const size_t n[3] = {n0, n1, n2};
+
+    real_type ker[3][NUFFT_WIDTH];
+    long long start[3];
+    nufft_point_weights(M, j, coords, n, ker, start);
+
+    const unsigned int w1 = NUFFT_DIM > 1 ? NUFFT_WIDTH : 1;
+    const unsigned int w2 = NUFFT_DIM > 2 ? NUFFT_WIDTH : 1;
+    for(size_t t = blockIdx.y; t < ntransforms; t += gridDim.y)
+    {
+        const scalar_type c = strengths[t * M + perm[j]];
+        scalar_type*      g = grid + t * n0 * n1 * n2;
+        for(unsigned int i2 = 0; i2 < w2; ++i2)
+        {
+            const size_t o2 = (start[2] + i2 + n2) % n2;
+            for(unsigned int i1 = 0; i1 < w1; ++i1)
+            {
+                const size_t    o1  = o2 * n1 + (start[1] + i1 + n1) % n1;
+                const real_type w12 = ker[2][i2] * ker[1][i1];
+                for(unsigned int i0 = 0; i0 < NUFFT_WIDTH; ++i0)
+                {
+                    const size_t    o  = o1 * n0 + (start[0] + i0 + n0) % n0;
+                    const real_type wt = w12 * ker[0][i0];
+                    atomicAdd(&g[o].x, wt * c.x);
+                    atomicAdd(&g[o].y, wt * c.y);
+                }
+            }
+        }
+    }
+}
+)_SRC";
+
+static const char* nufft_interp_body_src = R"_SRC(
+{
+    const size_t j = blockIdx.x * blockDim.x + threadIdx.x;
+    if(j >= M)
+        return;
+    const size_t n[3] = {n0, n1, n2};
+
+    real_type ker[3][NUFFT_WIDTH];
+    long long start[3];
+    nufft_point_weights(M, j, coords, n, ker, start);
+
+    const unsigned int w1 = NUFFT_DIM > 1 ? NUFFT_WIDTH : 1;
+    const unsigned int w2 = NUFFT_DIM > 2 ? NUFFT_WIDTH : 1;
+    for(size_t t = blockIdx.y; t < ntransforms; t += gridDim.y)
+    {
+        const scalar_type* g = grid + t * n0 * n1 * n2;
+        scalar_type        c = {0, 0};
+        for(unsigned int i2 = 0; i2 < w2; ++i2)
+        {
+            const size_t o2 = (start[2] + i2 + n2) % n2;
+            for(unsigned int i1 = 0; i1 < w1; ++i1)
+            {
+                const size_t    o1  = o2 * n1 + (start[1] + i1 + n1) % n1;
+                const real_type w12 = ker[2][i2] * ker[1][i1];
+                for(unsigned int i0 = 0; i0 < NUFFT_WIDTH; ++i0)
+                {
+                    const size_t    o  = o1 * n0 + (start[0] + i0 + n0) % n0;
+                    const real_type wt = w12 * ker[0][i0];
+                    c.x += wt * g[o].x;
+                    c.y += wt * g[o].y;
+                }
+            }
+        }
+        strengths[t * M + perm[j]] = c;
+    }
+}
+)_SRC";
+
+// one thread per mode.  Mode k of a dimension with N modes is at
+// index k + N/2 of the user's modes, and at k mod n on the grid.
+// factors holds the inverse of the kernel's transform at each mode
+// of each dimension, one dimension after another.
+static const char* nufft_deconvolve_src = R"_SRC(
+    (size_t ntransforms,
+     size_t N0,
+     size_t N1,
+     size_t N2,
+     size_t n0,
+     size_t n1,
+     size_t n2,
+     const real_type* __restrict__ factors,
+     scalar_type* modes,
+     scalar_type* grid)
+{
+    const size_t i     = blockIdx.x * blockDim.x + threadIdx.x;
+    const size_t count = N0 * N1 * N2;
+    if(i >= count)
+        return;
+    const size_t i0 = i % N0;
+    const size_t i1 = (i / N0) % N1;
+    const size_t i2 = i / (N0 * N1);
+    const size_t g0 = i0 < N0 / 2 ? i0 + n0 - N0 / 2 : i0 - N0 / 2;
+    const size_t g1 = i1 < N1 / 2 ? i1 + n1 - N1 / 2 : i1 - N1 / 2;
+    const size_t g2 = i2 < N2 / 2 ? i2 + n2 - N2 / 2 : i2 - N2 / 2;
+    const size_t g  = (g2 * n1 + g1) * n0 + g0;
+
+    const real_type f = factors[i0] * factors[N0 + i1] * factors[N0 + N1 + i2];
+    for(size_t t = blockIdx.y; t < ntransforms; t += gridDim.y)
+    {
+        if(TO_GRID)
+        {
+            scalar_type v          = modes[t * count + i];
+            v.x                    = v.x * f;
+            v.y                    = v.y * f;
+            grid[t * n0 * n1 * n2 + g] = v;
+        }
+        else
+        {
+            scalar_type v         = grid[t * n0 * n1 * n2 + g];
+            v.x                   = v.x * f;
+            v.y                   = v.y * f;
+            modes[t * count + i] = v;
+        }
+    }
+}
+)_SRC";
+
+static std::string nufft_rtc(const std::string& kernel_name,
+                             NufftKernel        kind,
+                             rocfft_precision   precision,
+                             size_t             dim,
+                             size_t             width)
+{
+    std::string src;
+
+    src += rocfft_complex_h;
+    src += common_h;
+    src += rtc_precision_type_decl(precision);
+    src += precision == rocfft_precision_double ? "typedef double real_type;\n"
+                                                : "typedef float real_type;\n";
+    src += "static constexpr double TWO_PI = 6.283185307179586476925286766559;\n";
+    src += "static constexpr unsigned int NUFFT_DIM = " + std::to_string(dim) + ";\n";
+
+    if(kind == NufftKernel::GRID_TO_MODES || kind == NufftKernel::MODES_TO_GRID)
+    {
+        src += "static constexpr bool TO_GRID = ";
+        src += kind == NufftKernel::MODES_TO_GRID ? "true;\n" : "false;\n";
+        src += "extern \"C\" __global__ void __launch_bounds__(" + std::to_string(NUFFT_THREADS)
+               + ") ";
+        src += kernel_name;
+        src += nufft_deconvolve_src;
+        return src;
+    }
+
+    src += "static constexpr unsigned int NUFFT_WIDTH = " + std::to_string(width) + ";\n";
+    src += "static constexpr real_type NUFFT_BETA = " + std::to_string(nufft_beta(width)) + ";\n";
+    src += nufft_weights_src;
+    src += "extern \"C\" __global__ void __launch_bounds__(" + std::to_string(NUFFT_THREADS)
+           + ") ";
+    src += kernel_name;
+    src += nufft_point_args_src;
+    src += kind == NufftKernel::SPREAD ? nufft_spread_body_src : nufft_interp_body_src;
+    return src;
+}
+
+// NUFFT kernels are launched directly with their arguments, not
+// from a plan's nodes
+struct RTCKernelNufft : public RTCKernel
+{
+    static std::unique_ptr<RTCKernel> generate(const std::string& gpu_arch,
+                                               NufftKernel        kind,
+                                               rocfft_precision   precision,
+                                               size_t             dim,
+                                               size_t             width)
+    {
+        auto kernel_name = nufft_rtc_kernel_name(kind, precision, dim, width);
+
+        kernel_src_gen_t generator{[=](const std::string& kernel_name) {
+            return nufft_rtc(kernel_name, kind, precision, dim, width);
+        }};
+
+        // skip the RTC cache if the module is already loaded
+        auto module = RTCModuleCache::GetCache().Find(kernel_name, gpu_arch, generator_sum());
+        if(module)
+            return std::unique_ptr<RTCKernel>(new RTCKernelNufft(kernel_name, module));
+
+        auto code = RTCCache::cached_compile(kernel_name, gpu_arch, generator, generator_sum());
+        return std::unique_ptr<RTCKernel>(new RTCKernelNufft(kernel_name, code));
+    }
+
+    RTCKernelArgs get_launch_args(DeviceCallIn& data) override
+    {
+        return {};
+    }
+
+protected:
+    RTCKernelNufft(const std::string& kernel_name, const RTCLoadableModule& code)
+        : RTCKernel(kernel_name, code)
+    {
+    }
+};
+
+// nodes and weights of n-point Gauss-Legendre quadrature on [-1, 1]
+static void gauss_legendre(size_t n, std::vector<double>& nodes, std::vector<double>& weights)
+{
+    nodes.resize(n);
+    weights.resize(n);
+    for(size_t i = 0; i < n; ++i)
+    {
+        // Newton iteration from the Chebyshev approximation of the
+        // root
+        double x  = std::cos(M_PI * (i + 0.75) / (n + 0.5));
+        double dp = 0.0;
+        for(int iter = 0; iter < 100; ++iter)
+        {
+            double p0 = 1.0;
+            double p1 = x;
+            for(size_t k = 2; k <= n; ++k)
+            {
+                double p2 = ((2.0 * k - 1.0) * x * p1 - (k - 1.0) * p0) / k;
+                p0        = p1;
+                p1        = p2;
+            }
+            dp        = n * (x * p1 - p0) / (x * x - 1.0);
+            double dx = p1 / dp;
+            x -= dx;
+            if(std::abs(dx) < 1e-15)
+                break;
+        }
+        nodes[i]   = x;
+        weights[i] = 2.0 / ((1.0 - x * x) * dp * dp);
+    }
+}
+
+// smallest even length >= n with no prime factors above 5
+static size_t nufft_grid_length(size_t n)
+{
+    for(size_t len = n + (n % 2);; len += 2)
+    {
+        size_t rem = len;
+        for(size_t f : {2, 3, 5})
+        {
+            while(rem % f == 0)
+                rem /= f;
+        }
+        if(rem == 1)
+            return len;
+    }
+}
+
+struct rocfft_nufft_plan_t
+{
+    rocfft_nufft_plan_t() = default;
+    ~rocfft_nufft_plan_t();
+
+    rocfft_nufft_plan_t(const rocfft_nufft_plan_t&) = delete;
+    rocfft_nufft_plan_t& operator=(const rocfft_nufft_plan_t&) = delete;
+
+    rocfft_nufft_type   type      = rocfft_nufft_type_1;
+    rocfft_precision    precision = rocfft_precision_single;
+    size_t              dim       = 1;
+    size_t              batch     = 1;
+    size_t              width     = 0;
+    std::array<size_t, 3> modes   = {1, 1, 1};
+    std::array<size_t, 3> grid    = {1, 1, 1};
+
+    int             deviceId = 0;
+    hipDeviceProp_t deviceProp;
+
+    // transforms the oversampled grid in place
+    rocfft_plan           fft     = nullptr;
+    rocfft_execution_info fftInfo = nullptr;
+
+    gpubuf gridBuf;
+    // inverse of the kernel's transform, at each mode of each
+    // dimension
+    gpubuf factors;
+
+    // points sorted into bins, stored one dimension after another,
+    // and the index each sorted point was given at
+    bool   pointsSet = false;
+    size_t numPoints = 0;
+    gpubuf coords;
+    gpubuf perm;
+
+    std::unique_ptr<RTCKernel> pointKernel;
+    std::unique_ptr<RTCKernel> deconvolveKernel;
+
+    size_t RealBytes() const
+    {
+        return precision == rocfft_precision_double ? sizeof(double) : sizeof(float);
+    }
+    size_t GridElems() const
+    {
+        return grid[0] * grid[1] * grid[2];
+    }
+    size_t ModeElems() const
+    {
+        return modes[0] * modes[1] * modes[2];
+    }
+
+    void Create(double tolerance);
+    template <typename Treal>
+    void SetPoints(size_t num_points, const std::array<const void*, 3>& x);
+    void Execute(void* strengths, void* modes, rocfft_execution_info info);
+};
+
+rocfft_nufft_plan_t::~rocfft_nufft_plan_t()
+{
+    // device resources must be freed on their own device
+    try
+    {
+        rocfft_scoped_device dev(deviceId);
+        (void)rocfft_execution_info_destroy(fftInfo);
+        (void)rocfft_plan_destroy(fft);
+        gridBuf.free();
+        factors.free();
+        coords.free();
+        perm.free();
+        pointKernel.reset();
+        deconvolveKernel.reset();
+    }
+    catch(std::exception&)
+    {
+    }
+}
+
+void rocfft_nufft_plan_t::Create(double tolerance)
+{
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        throw std::runtime_error("hipGetDevice failed");
+    deviceProp = get_curr_device_prop();
+
+    // errors fall by about a factor of 10 per grid point of kernel
+    // width, down to what the precision can represent
+    const double finest = precision == rocfft_precision_double ? 1e-14 : 1e-6;
+    tolerance           = std::max(tolerance, finest);
+    width = std::clamp<size_t>(
+        static_cast<size_t>(std::ceil(-std::log10(tolerance / 10.0))), 2, NUFFT_MAX_WIDTH);
+
+    for(size_t d = 0; d < dim; ++d)
+        grid[d] = nufft_grid_length(std::max(2 * modes[d], 2 * width));
+
+    // the kernel's transform at each mode, found by quadrature
+    // of the kernel over its support
+    std::vector<double> nodes, weights;
+    gauss_legendre(2 + 3 * width, nodes, weights);
+    const double        beta = nufft_beta(width);
+    std::vector<double> phi(nodes.size());
+    for(size_t q = 0; q < nodes.size(); ++q)
+        phi[q] = std::exp(beta * (std::sqrt(1.0 - nodes[q] * nodes[q]) - 1.0));
+
+    std::vector<double> inverse;
+    for(size_t d = 0; d < 3; ++d)
+    {
+        for(size_t i = 0; i < modes[d]; ++i)
+        {
+            if(d >= dim)
+            {
+                inverse.push_back(1.0);
+                continue;
+            }
+            const double k   = static_cast<double>(i) - static_cast<double>(modes[d] / 2);
+            double       sum = 0.0;
+            for(size_t q = 0; q < nodes.size(); ++q)
+                sum += weights[q] * phi[q] * std::cos(M_PI * k * width * nodes[q] / grid[d]);
+            inverse.push_back(1.0 / (0.5 * width * sum));
+        }
+    }
+    if(factors.alloc(inverse.size() * RealBytes()) != hipSuccess)
+        throw std::runtime_error("NUFFT factor allocation failure");
+    if(precision == rocfft_precision_double)
+    {
+        if(hipMemcpy(factors.data(), inverse.data(), factors.size(), hipMemcpyHostToDevice)
+           != hipSuccess)
+            throw std::runtime_error("hipMemcpy failure");
+    }
+    else
+    {
+        std::vector<float> inverseF(inverse.begin(), inverse.end());
+        if(hipMemcpy(factors.data(), inverseF.data(), factors.size(), hipMemcpyHostToDevice)
+           != hipSuccess)
+            throw std::runtime_error("hipMemcpy failure");
+    }
+
+    if(gridBuf.alloc(GridElems() * batch * 2 * RealBytes()) != hipSuccess)
+        throw std::runtime_error("NUFFT grid allocation failure");
+
+    const auto& gpu_arch = deviceProp.gcnArchName;
+    pointKernel          = RTCKernelNufft::generate(gpu_arch,
+                                           type == rocfft_nufft_type_1 ? NufftKernel::SPREAD
+                                                                       : NufftKernel::INTERP,
+                                           precision,
+                                           dim,
+                                           width);
+    deconvolveKernel     = RTCKernelNufft::generate(gpu_arch,
+                                                type == rocfft_nufft_type_1
+                                                    ? NufftKernel::GRID_TO_MODES
+                                                    : NufftKernel::MODES_TO_GRID,
+                                                precision,
+                                                dim,
+                                                width);
+}
+
+template <typename Treal>
+void rocfft_nufft_plan_t::SetPoints(size_t num_points, const std::array<const void*, 3>& x)
+{
+    std::vector<Treal> hostCoords(dim * num_points);
+    for(size_t d = 0; d < dim; ++d)
+    {
+        if(num_points
+           && hipMemcpy(hostCoords.data() + d * num_points,
+                        x[d],
+                        num_points * sizeof(Treal),
+                        hipMemcpyDeviceToHost)
+                  != hipSuccess)
+            throw std::runtime_error("hipMemcpy failure");
+    }
+
+    // counting sort of the points by bin
+    std::array<size_t, 3> bins = {1, 1, 1};
+    for(size_t d = 0; d < dim; ++d)
+        bins[d] = DivRoundingUp(grid[d], NUFFT_BIN_SIZE[d]);
+    std::vector<size_t> pointBin(num_points);
+    for(size_t j = 0; j < num_points; ++j)
+    {
+        size_t bin = 0;
+        for(size_t d = dim; d-- > 0;)
+        {
+            double t = hostCoords[d * num_points + j] / (2.0 * M_PI);
+            t -= std::floor(t);
+            const size_t b = std::min(static_cast<size_t>(t * grid[d]) / NUFFT_BIN_SIZE[d],
+                                      bins[d] - 1);
+            bin            = bin * bins[d] + b;
+        }
+        pointBin[j] = bin;
+    }
+    std::vector<size_t> binStart(bins[0] * bins[1] * bins[2] + 1);
+    for(auto b : pointBin)
+        ++binStart[b + 1];
+    std::partial_sum(binStart.begin(), binStart.end(), binStart.begin());
+
+    std::vector<size_t> hostPerm(num_points);
+    for(size_t j = 0; j < num_points; ++j)
+        hostPerm[binStart[pointBin[j]]++] = j;
+
+    std::vector<Treal> sortedCoords(hostCoords.size());
+    for(size_t d = 0; d < dim; ++d)
+    {
+        for(size_t j = 0; j < num_points; ++j)
+            sortedCoords[d * num_points + j] = hostCoords[d * num_points + hostPerm[j]];
+    }
+
+    coords.free();
+    perm.free();
+    if(num_points)
+    {
+        if(coords.alloc(sortedCoords.size() * sizeof(Treal)) != hipSuccess
+           || perm.alloc(num_points * sizeof(size_t)) != hipSuccess)
+            throw std::runtime_error("NUFFT point allocation failure");
+        if(hipMemcpy(coords.data(), sortedCoords.data(), coords.size(), hipMemcpyHostToDevice)
+               != hipSuccess
+           || hipMemcpy(perm.data(), hostPerm.data(), perm.size(), hipMemcpyHostToDevice)
+                  != hipSuccess)
+            throw std::runtime_error("hipMemcpy failure");
+    }
+    numPoints = num_points;
+    pointsSet = true;
+}
+
+void rocfft_nufft_plan_t::Execute(void* strengths, void* modesBuf, rocfft_execution_info info)
+{
+    rocfft_scoped_device dev(deviceId);
+    hipStream_t          stream = info ? info->rocfft_stream : nullptr;
+    if(rocfft_execution_info_set_stream(fftInfo, stream) != rocfft_status_success)
+        throw std::runtime_error("failed to set NUFFT stream");
+
+    // the y dimension of the launch grid walks the batch
+    const unsigned int batchBlocks = static_cast<unsigned int>(std::min<size_t>(batch, 65535));
+
+    auto launchPoints = [&]() {
+        if(!numPoints)
+            return;
+        RTCKernelArgs kargs;
+        kargs.append_size_t(numPoints);
+        kargs.append_size_t(batch);
+        kargs.append_ptr(coords.data());
+        kargs.append_ptr(perm.data());
+        kargs.append_ptr(strengths);
+        kargs.append_ptr(gridBuf.data());
+        for(auto n : grid)
+            kargs.append_size_t(n);
+        pointKernel->launch(kargs,
+                            dim3(DivRoundingUp<size_t>(numPoints, NUFFT_THREADS), batchBlocks),
+                            dim3(NUFFT_THREADS),
+                            0,
+                            deviceProp,
+                            stream);
+    };
+    auto launchDeconvolve = [&]() {
+        RTCKernelArgs kargs;
+        kargs.append_size_t(batch);
+        for(auto N : modes)
+            kargs.append_size_t(N);
+        for(auto n : grid)
+            kargs.append_size_t(n);
+        kargs.append_ptr(factors.data());
+        kargs.append_ptr(modesBuf);
+        kargs.append_ptr(gridBuf.data());
+        deconvolveKernel->launch(kargs,
+                                 dim3(DivRoundingUp<size_t>(ModeElems(), NUFFT_THREADS),
+                                      batchBlocks),
+                                 dim3(NUFFT_THREADS),
+                                 0,
+                                 deviceProp,
+                                 stream);
+    };
+    auto transformGrid = [&]() {
+        void* gridPtr = gridBuf.data();
+        if(rocfft_execute(fft, &gridPtr, nullptr, fftInfo) != rocfft_status_success)
+            throw std::runtime_error("NUFFT grid transform failed");
+    };
+
+    // spreading accumulates into the grid, and modes only fill part
+    // of it, so it starts out zero either way
+    if(hipMemsetAsync(gridBuf.data(), 0, gridBuf.size(), stream) != hipSuccess)
+        throw std::runtime_error("hipMemsetAsync failure");
+
+    if(type == rocfft_nufft_type_1)
+    {
+        launchPoints();
+        transformGrid();
+        launchDeconvolve();
+    }
+    else
+    {
+        launchDeconvolve();
+        transformGrid();
+        launchPoints();
+    }
+}
+
+rocfft_status rocfft_nufft_plan_create(rocfft_nufft_plan*    plan,
+                                       rocfft_nufft_type     type,
+                                       rocfft_transform_type transform_type,
+                                       rocfft_precision      precision,
+                                       size_t                dimensions,
+                                       const size_t*         modes,
+                                       size_t                number_of_transforms,
+                                       double                tolerance)
+{
+    log_trace(__func__,
+              "plan",
+              plan,
+              "type",
+              type,
+              "transform_type",
+              transform_type,
+              "precision",
+              precision,
+              "dimensions",
+              dimensions,
+              "modes",
+              std::make_pair(modes, dimensions),
+              "number_of_transforms",
+              number_of_transforms,
+              "tolerance",
+              tolerance);
+
+    if(!plan || !modes || !number_of_transforms || !(tolerance > 0.0))
+        return rocfft_status_invalid_arg_value;
+    if(type != rocfft_nufft_type_1 && type != rocfft_nufft_type_2)
+        return rocfft_status_invalid_arg_value;
+    if(transform_type != rocfft_transform_type_complex_forward
+       && transform_type != rocfft_transform_type_complex_inverse)
+        return rocfft_status_invalid_arg_value;
+    // spreading accumulates with atomics, which half precision
+    // doesn't have
+    if(precision != rocfft_precision_single && precision != rocfft_precision_double)
+        return rocfft_status_invalid_arg_value;
+    if(dimensions < 1 || dimensions > 3)
+        return rocfft_status_invalid_dimensions;
+    if(std::any_of(modes, modes + dimensions, [](size_t N) { return N == 0; }))
+        return rocfft_status_invalid_arg_value;
+
+    try
+    {
+        auto nufft       = std::make_unique<rocfft_nufft_plan_t>();
+        nufft->type      = type;
+        nufft->precision = precision;
+        nufft->dim       = dimensions;
+        nufft->batch     = number_of_transforms;
+        std::copy_n(modes, dimensions, nufft->modes.begin());
+        nufft->Create(tolerance);
+
+        auto rcfft = rocfft_plan_create(&nufft->fft,
+                                        rocfft_placement_inplace,
+                                        transform_type,
+                                        precision,
+                                        dimensions,
+                                        nufft->grid.data(),
+                                        number_of_transforms,
+                                        nullptr);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+        rcfft = rocfft_execution_info_create(&nufft->fftInfo);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        *plan = nufft.release();
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_nufft_plan_set_points(
+    rocfft_nufft_plan plan, size_t num_points, const void* x, const void* y, const void* z)
+{
+    log_trace(__func__, "plan", plan, "num_points", num_points, "x", x, "y", y, "z", z);
+    if(!plan)
+        return rocfft_status_invalid_arg_value;
+    const std::array<const void*, 3> coords = {x, y, z};
+    for(size_t d = 0; d < plan->dim; ++d)
+    {
+        if(num_points && !coords[d])
+            return rocfft_status_invalid_arg_value;
+    }
+
+    try
+    {
+        rocfft_scoped_device dev(plan->deviceId);
+        if(plan->precision == rocfft_precision_double)
+            plan->SetPoints<double>(num_points, coords);
+        else
+            plan->SetPoints<float>(num_points, coords);
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_nufft_execute(const rocfft_nufft_plan plan,
+                                   void*                   strengths,
+                                   void*                   modes,
+                                   rocfft_execution_info   info)
+{
+    log_trace(
+        __func__, "plan", plan, "strengths", strengths, "modes", modes, "info", info);
+    if(!plan || !plan->pointsSet || !modes || (plan->numPoints && !strengths))
+        return rocfft_status_invalid_arg_value;
+    // the grid transform isn't captured with the rest, and the
+    // callbacks and batch of the info don't apply to a NUFFT
+    if(info
+       && (info->captureMode || info->callbacks.load_cb_fn || info->callbacks.store_cb_fn
+           || !info->pass_callbacks.empty() || info->batch))
+        return rocfft_status_invalid_arg_value;
+
+    try
+    {
+        plan->Execute(strengths, modes, info);
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_nufft_plan_destroy(rocfft_nufft_plan plan)
+{
+    log_trace(__func__, "plan", plan);
+    delete plan;
+    return rocfft_status_success;
+}
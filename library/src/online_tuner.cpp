@@ -0,0 +1,262 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "online_tuner.h"
+#include "../../shared/environment.h"
+#include "../../shared/precision_type.h"
+#include "../../shared/subprocess.h"
+#include "library_path.h"
+#include "logging.h"
+#include "plan.h"
+#include "tuning_helper.h"
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+#ifdef WIN32
+static const char* TUNER_EXE = "rocfft_offline_tuner.exe";
+#else
+static const char* TUNER_EXE = "rocfft_offline_tuner";
+#endif
+
+static fs::path find_offline_tuner()
+{
+    auto var = rocfft_getenv("ROCFFT_OFFLINE_TUNER");
+    if(!var.empty())
+        return var;
+
+    // try same dir as library
+    fs::path library_path = get_library_path();
+    if(!library_path.empty())
+    {
+        auto tuner_path = library_path.parent_path() / TUNER_EXE;
+        if(fs::exists(tuner_path))
+            return tuner_path;
+    }
+    throw std::runtime_error("unable to find rocfft_offline_tuner");
+}
+
+static size_t size_from_env(const char* var, size_t default_value)
+{
+    auto env_value = rocfft_getenv(var);
+    if(env_value.empty())
+        return default_value;
+    try
+    {
+        return std::stoull(env_value);
+    }
+    catch(std::exception&)
+    {
+        return 0;
+    }
+}
+
+OnlineTuner::OnlineTuner()
+{
+    user_sol_map_path = rocfft_getenv("ROCFFT_USER_SOL_MAP_PATH");
+    // tuned solutions would have nowhere to go
+    if(user_sol_map_path.empty())
+        return;
+
+    // ROCFFT_TUNE_ON_FIRST_USE is the most problems to tune in this
+    // process
+    max_problems   = size_from_env("ROCFFT_TUNE_ON_FIRST_USE", 0);
+    max_candidates = size_from_env("ROCFFT_TUNE_MAX_CANDIDATES", max_candidates);
+    quick_max_candidates
+        = size_from_env("ROCFFT_TUNE_TRANSFER_MAX_CANDIDATES", quick_max_candidates);
+}
+
+OnlineTuner::~OnlineTuner()
+{
+    Stop();
+}
+
+void OnlineTuner::Enqueue(const rocfft_plan_t& plan, int deviceId, bool quick)
+{
+    if(max_problems == 0)
+        return;
+
+    // tuning and compile-only processes create plans that are never
+    // meant to be used
+    if(TuningBenchmarker::GetSingleton().IsInitializingTuning()
+       || TuningBenchmarker::GetSingleton().IsProcessingTuning()
+       || rocfft_getenv("ROCFFT_INTERNAL_COMPILE_ONLY") == "1")
+        return;
+
+    auto problemArgs = ProblemArgs(plan);
+    problemArgs.insert(
+        problemArgs.end(),
+        {"--max_candidates", std::to_string(quick ? quick_max_candidates : max_candidates)});
+
+    std::lock_guard<std::mutex> lock(mtx);
+    if(seen.size() >= max_problems || !seen.insert(problemArgs).second)
+        return;
+    queue.emplace_back(deviceId, std::move(problemArgs));
+
+    // tuning benchmarks the device, so tune one problem at a time
+    if(!running)
+    {
+        if(worker.joinable())
+            worker.join();
+        running = true;
+        worker  = std::thread(&OnlineTuner::Worker, this);
+    }
+}
+
+bool OnlineTuner::MeasureAccessModes(const rocfft_plan_t& plan, int deviceId)
+{
+    // measured solutions would have nowhere to go
+    if(user_sol_map_path.empty())
+        return false;
+
+    if(TuningBenchmarker::GetSingleton().IsInitializingTuning()
+       || TuningBenchmarker::GetSingleton().IsProcessingTuning()
+       || rocfft_getenv("ROCFFT_INTERNAL_COMPILE_ONLY") == "1")
+        return false;
+
+    auto problemArgs = ProblemArgs(plan);
+    problemArgs.push_back("--access_modes_only");
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if(!measured.insert(problemArgs).second)
+            return false;
+    }
+    return Tune(deviceId, problemArgs);
+}
+
+std::vector<std::string> OnlineTuner::ProblemArgs(const rocfft_plan_t& plan)
+{
+    // the tuner only takes lengths in row-major order and the batch,
+    // so the problem is a packed one with default strides.  the
+    // solution it finds is keyed without strides, so plans with
+    // other strides use it as well.
+    std::vector<std::string> problemArgs = {"--length"};
+    for(auto len = plan.lengths.rbegin(); len != plan.lengths.rend(); ++len)
+        problemArgs.push_back(std::to_string(*len));
+    problemArgs.insert(problemArgs.end(),
+                       {"-b",
+                        std::to_string(plan.batch),
+                        "-t",
+                        std::to_string(plan.transformType),
+                        "--precision",
+                        precision_name(plan.precision),
+                        "--itype",
+                        std::to_string(plan.desc.inArrayType),
+                        "--otype",
+                        std::to_string(plan.desc.outArrayType)});
+    if(plan.placement == rocfft_placement_notinplace)
+        problemArgs.push_back("-o");
+    return problemArgs;
+}
+
+void OnlineTuner::Worker()
+{
+    while(true)
+    {
+        std::pair<int, std::vector<std::string>> item;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if(queue.empty())
+            {
+                running = false;
+                return;
+            }
+            item = std::move(queue.front());
+            queue.pop_front();
+        }
+        Tune(item.first, item.second);
+    }
+}
+
+bool OnlineTuner::Tune(int deviceId, const std::vector<std::string>& problemArgs)
+{
+    // measuring at plan creation may happen while the worker tunes
+    std::lock_guard<std::mutex> lock(tune_mtx);
+
+    // each tune gets its own workspace, since other processes may be
+    // tuning at the same time
+    auto workspace = fs::temp_directory_path()
+                     / ("rocfft_tune_"
+                        + std::to_string(
+                            std::chrono::system_clock::now().time_since_epoch().count()));
+    bool tuned = false;
+    try
+    {
+        std::vector<std::string> args
+            = {"tune", "--workspace", workspace.string(), "-d", std::to_string(deviceId)};
+        args.insert(args.end(), problemArgs.begin(), problemArgs.end());
+
+        auto               output = execute_subprocess(find_offline_tuner().string(), args, {});
+        std::stringstream  ss(std::string(output.begin(), output.end()));
+        static const char* OUTPUT_FILE = "[OUTPUT_FILE]: ";
+        fs::path           result_path;
+        for(std::string line; std::getline(ss, line);)
+        {
+            if(line.compare(0, strlen(OUTPUT_FILE), OUTPUT_FILE) == 0)
+                result_path = line.substr(strlen(OUTPUT_FILE));
+        }
+
+        // the tuner skips problems that don't fit on the device or
+        // can't be tuned
+        if(!result_path.empty() && fs::exists(result_path))
+        {
+            // result is named "<arch>_<token>.dat", which is what
+            // solution_map::setup looks for.  copy then rename, so
+            // other processes never read a partial file.
+            fs::path user_dir(user_sol_map_path);
+            fs::create_directories(user_dir);
+            auto dst_path = user_dir / result_path.filename();
+            auto tmp_path = dst_path;
+            tmp_path += "." + workspace.filename().string();
+            fs::copy_file(result_path, tmp_path, fs::copy_options::overwrite_existing);
+            fs::rename(tmp_path, dst_path);
+            tuned = true;
+
+            if(LOG_TUNING_ENABLED())
+                (*LogSingleton::GetInstance().GetTuningOS())
+                    << "tuned on first use: " << dst_path.string() << std::endl;
+        }
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TUNING_ENABLED())
+            (*LogSingleton::GetInstance().GetTuningOS())
+                << "tuning on first use failed: " << e.what() << std::endl;
+    }
+
+    std::error_code ec;
+    fs::remove_all(workspace, ec);
+    return tuned;
+}
+
+void OnlineTuner::Stop()
+{
+    std::thread to_join;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        queue.clear();
+        to_join.swap(worker);
+    }
+    if(to_join.joinable())
+        to_join.join();
+}
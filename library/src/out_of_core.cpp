@@ -0,0 +1,503 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Out-of-core execution: the batch of a plan is split into chunks
+// that fit in device memory.  Chunks are streamed from host memory
+// through a smaller-batch copy of the plan, double-buffered so that
+// one chunk's copies overlap with the other chunk's transform.
+//
+// Copies from pageable memory can't run asynchronously, so pageable
+// buffers are staged through pinned buffers owned by each slot.
+// Host-side copies into and out of the staging buffers then overlap
+// with the other slot's work on the device.
+
+#include <array>
+#include <cstring>
+#include <memory>
+
+#include "../../shared/arithmetic.h"
+#include "../../shared/array_predicate.h"
+#include "../../shared/environment.h"
+#include "../../shared/gpubuf.h"
+#include "../../shared/hip_object_wrapper.h"
+#include "../../shared/precision_type.h"
+#include "batch_layout.h"
+#include "logging.h"
+#include "plan.h"
+#include "rocfft/rocfft.h"
+#include "transform.h"
+
+// number of chunks in flight at once
+static const size_t OOC_SLOTS = 2;
+
+// fraction of free device memory we're willing to use for chunks
+static const double OOC_MEM_FRACTION = 0.9;
+
+// batches that fit in device memory are still split into this many
+// chunks, so that copies have transforms to overlap with
+static const size_t OOC_MIN_CHUNKS = 4;
+
+struct plan_deleter
+{
+    void operator()(rocfft_plan p) const
+    {
+        (void)rocfft_plan_destroy(p);
+    }
+};
+typedef std::unique_ptr<rocfft_plan_t, plan_deleter> unique_plan_t;
+
+// Create a copy of the plan that transforms a smaller batch
+static unique_plan_t create_chunk_plan(const rocfft_plan_t& plan, size_t chunkBatch)
+{
+    // the user-facing lengths of a real inverse transform are the
+    // real lengths, which the plan stores as output lengths
+    const auto& userLengths
+        = plan.transformType == rocfft_transform_type_real_inverse ? plan.outputLengths
+                                                                   : plan.lengths;
+
+    // chunks are already on the device
+    auto desc        = plan.desc;
+    desc.hostBuffers = false;
+
+    rocfft_plan p = nullptr;
+    if(rocfft_plan_create(&p,
+                          plan.placement,
+                          plan.transformType,
+                          plan.precision,
+                          plan.rank,
+                          userLengths.data(),
+                          chunkBatch,
+                          &desc)
+       != rocfft_status_success)
+    {
+        (void)rocfft_plan_destroy(p);
+        return nullptr;
+    }
+    return unique_plan_t(p);
+}
+
+// device memory needed for one chunk slot of the given batch size
+static size_t chunk_slot_bytes(const rocfft_plan_t&  plan,
+                               const batch_layout_t& in,
+                               const batch_layout_t& out,
+                               size_t                chunkBatch,
+                               size_t                workBytes)
+{
+    size_t     bytes   = workBytes;
+    const bool inplace = plan.placement == rocfft_placement_inplace;
+    for(size_t i = 0; i < in.num_pointers(); ++i)
+    {
+        auto inBytes = in.buffer_bytes(i, chunkBatch);
+        // in-place transforms need room for the larger of the two
+        if(inplace && i < out.num_pointers())
+            inBytes = std::max(inBytes, out.buffer_bytes(i, chunkBatch));
+        bytes += inBytes;
+    }
+    if(!inplace)
+    {
+        for(size_t i = 0; i < out.num_pointers(); ++i)
+            bytes += out.buffer_bytes(i, chunkBatch);
+    }
+    return bytes;
+}
+
+// true if copies to or from a host pointer can be asynchronous
+static bool host_ptr_is_pinned(const void* ptr)
+{
+    hipPointerAttribute_t attr;
+    if(hipPointerGetAttributes(&attr, ptr) != hipSuccess)
+    {
+        // memory that HIP does not know about is pageable - clear
+        // the error so it is not reported by later calls
+        (void)hipGetLastError();
+        return false;
+    }
+    return attr.type != hipMemoryTypeUnregistered;
+}
+
+// true if the current device shares physical memory with the host
+// (e.g. an MI300A APU) and can dereference all of the given host
+// buffers.  Memory that HIP knows about is always accessible, and
+// pageable memory is accessible when the device supports it (on
+// MI300A, when XNACK is enabled).
+static bool device_accesses_host_buffers(void* const ptrs[], size_t count)
+{
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        return false;
+    int integrated = 0;
+    if(hipDeviceGetAttribute(&integrated, hipDeviceAttributeIntegrated, deviceId) != hipSuccess
+       || !integrated)
+        return false;
+    int pageable = 0;
+    if(hipDeviceGetAttribute(&pageable, hipDeviceAttributePageableMemoryAccess, deviceId)
+       != hipSuccess)
+        pageable = 0;
+    for(size_t i = 0; i < count; ++i)
+    {
+        if(!pageable && !host_ptr_is_pinned(ptrs[i]))
+            return false;
+    }
+    return true;
+}
+
+// pinned host memory for staging pageable user buffers
+struct pinned_buf_t
+{
+    void* ptr = nullptr;
+
+    pinned_buf_t() = default;
+    ~pinned_buf_t()
+    {
+        if(ptr)
+            (void)hipHostFree(ptr);
+    }
+    pinned_buf_t(const pinned_buf_t&) = delete;
+    pinned_buf_t& operator=(const pinned_buf_t&) = delete;
+
+    hipError_t alloc(size_t bytes)
+    {
+        return hipHostMalloc(&ptr, bytes);
+    }
+};
+
+// resources for one chunk in flight
+struct ooc_slot_t
+{
+    hipStream_wrapper_t   stream;
+    std::array<gpubuf, 2> inBuf;
+    std::array<gpubuf, 2> outBuf;
+    gpubuf                workBuf;
+    rocfft_execution_info info = nullptr;
+
+    // pinned staging for pageable user buffers.  in-place
+    // transforms stage their output through inStage.
+    std::array<pinned_buf_t, 2> inStage;
+    std::array<pinned_buf_t, 2> outStage;
+
+    // last chunk enqueued on this slot, whose staged output still
+    // needs to be copied to the user's buffer
+    size_t pendingFirst = 0;
+    size_t pendingCount = 0;
+
+    ooc_slot_t() = default;
+    ~ooc_slot_t()
+    {
+        if(stream)
+            (void)hipStreamSynchronize(stream);
+        if(info)
+            (void)rocfft_execution_info_destroy(info);
+    }
+    ooc_slot_t(const ooc_slot_t&) = delete;
+    ooc_slot_t& operator=(const ooc_slot_t&) = delete;
+};
+
+static void execute_out_of_core(const rocfft_plan_t& plan, void* in_host[], void* out_host[])
+{
+    const auto in      = batch_layout_t::input(plan);
+    const auto out     = batch_layout_t::output(plan);
+    const bool inplace = plan.placement == rocfft_placement_inplace;
+
+    size_t freeMem  = 0;
+    size_t totalMem = 0;
+    if(hipMemGetInfo(&freeMem, &totalMem) != hipSuccess)
+        throw std::runtime_error("hipMemGetInfo failed");
+    const size_t budget = static_cast<size_t>(freeMem * OOC_MEM_FRACTION) / OOC_SLOTS;
+
+    // allow the chunk size to be limited, mostly for testing
+    size_t chunkBatch = plan.batch;
+    auto   envChunk   = rocfft_getenv("ROCFFT_OUT_OF_CORE_CHUNK");
+    if(!envChunk.empty())
+        chunkBatch = std::min(chunkBatch, std::max<size_t>(std::stoull(envChunk), 1));
+    else
+        chunkBatch = DivRoundingUp<size_t>(plan.batch, OOC_MIN_CHUNKS);
+
+    // work buffer requirements grow roughly linearly with the batch,
+    // so estimate from the full plan to find a starting chunk size
+    const size_t workPerTransform = plan.WorkBufBytes() / plan.batch + 1;
+    while(chunkBatch > 1
+          && chunk_slot_bytes(plan, in, out, chunkBatch, chunkBatch * workPerTransform) > budget)
+        chunkBatch /= 2;
+
+    // build the chunk plan, and shrink further if the estimate was
+    // too optimistic
+    unique_plan_t chunkPlan;
+    for(;;)
+    {
+        chunkPlan = create_chunk_plan(plan, chunkBatch);
+        if(!chunkPlan)
+            throw std::runtime_error("failed to create out-of-core chunk plan");
+        if(chunk_slot_bytes(plan, in, out, chunkBatch, chunkPlan->WorkBufBytes()) <= budget)
+            break;
+        if(chunkBatch == 1)
+        {
+            if(LOG_TRACE_ENABLED())
+                (*LogSingleton::GetInstance().GetTraceOS())
+                    << "a single transform does not fit in device memory" << std::endl;
+            throw rocfft_status_invalid_arg_value;
+        }
+        chunkBatch /= 2;
+    }
+
+    // the last chunk may hold fewer transforms
+    const size_t numChunks = DivRoundingUp<size_t>(plan.batch, chunkBatch);
+
+    // each chunk's results are copied back as one span, which would
+    // overwrite other chunks' results if transforms are interleaved
+    if(numChunks > 1 && out.transforms_overlap())
+    {
+        if(LOG_TRACE_ENABLED())
+            (*LogSingleton::GetInstance().GetTraceOS())
+                << "out-of-core output transforms overlap in memory" << std::endl;
+        throw rocfft_status_invalid_arg_value;
+    }
+
+    const size_t  remainder = plan.batch % chunkBatch;
+    unique_plan_t remainderPlan;
+    if(remainder)
+    {
+        remainderPlan = create_chunk_plan(plan, remainder);
+        if(!remainderPlan)
+            throw std::runtime_error("failed to create out-of-core chunk plan");
+    }
+
+    if(LOG_PLAN_ENABLED())
+    {
+        if(LOG_JSON_ENABLED())
+            log_json_arguments(*LogSingleton::GetInstance().GetPlanOS(),
+                               "out_of_core_execution",
+                               "chunks",
+                               numChunks,
+                               "chunk_batch",
+                               chunkBatch);
+        else
+            *LogSingleton::GetInstance().GetPlanOS()
+                << "out-of-core execution: " << numChunks << " chunks of " << chunkBatch
+                << " transforms" << std::endl;
+    }
+
+    // results of in-place transforms go back to the input buffers
+    auto resultHost = inplace ? in_host : out_host;
+
+    bool stageIn = false;
+    for(size_t i = 0; i < in.num_pointers(); ++i)
+        stageIn = stageIn || !host_ptr_is_pinned(in_host[i]);
+    bool stageOut = inplace && stageIn;
+    for(size_t i = 0; !inplace && i < out.num_pointers(); ++i)
+        stageOut = stageOut || !host_ptr_is_pinned(out_host[i]);
+
+    std::array<ooc_slot_t, OOC_SLOTS> slots;
+    const size_t                      slotCount = std::min(OOC_SLOTS, numChunks);
+    for(size_t s = 0; s < slotCount; ++s)
+    {
+        auto& slot = slots[s];
+        slot.stream.alloc();
+        for(size_t i = 0; i < in.num_pointers(); ++i)
+        {
+            auto bytes = in.buffer_bytes(i, chunkBatch);
+            if(inplace && i < out.num_pointers())
+                bytes = std::max(bytes, out.buffer_bytes(i, chunkBatch));
+            if(slot.inBuf[i].alloc(bytes) != hipSuccess)
+                throw std::runtime_error("out-of-core buffer allocation failure");
+            if(stageIn && slot.inStage[i].alloc(bytes) != hipSuccess)
+                throw std::runtime_error("out-of-core staging buffer allocation failure");
+        }
+        if(!inplace)
+        {
+            for(size_t i = 0; i < out.num_pointers(); ++i)
+            {
+                auto bytes = out.buffer_bytes(i, chunkBatch);
+                if(slot.outBuf[i].alloc(bytes) != hipSuccess)
+                    throw std::runtime_error("out-of-core buffer allocation failure");
+                if(stageOut && slot.outStage[i].alloc(bytes) != hipSuccess)
+                    throw std::runtime_error("out-of-core staging buffer allocation failure");
+            }
+        }
+
+        if(rocfft_execution_info_create(&slot.info) != rocfft_status_success)
+            throw std::runtime_error("failed to create execution info");
+        (void)rocfft_execution_info_set_stream(slot.info, slot.stream);
+
+        // the remainder plan is smaller, so it fits in the same
+        // work buffer
+        auto workBytes = chunkPlan->WorkBufBytes();
+        if(workBytes)
+        {
+            if(slot.workBuf.alloc(workBytes) != hipSuccess)
+                throw std::runtime_error("out-of-core work buffer allocation failure");
+            (void)rocfft_execution_info_set_work_buffer(slot.info, slot.workBuf.data(), workBytes);
+        }
+    }
+
+    // wait for a slot's last chunk, and copy its staged output to
+    // the user's buffer
+    const auto drain = [&](ooc_slot_t& slot) {
+        if(hipStreamSynchronize(slot.stream) != hipSuccess)
+            throw std::runtime_error("hipStreamSynchronize failed");
+        if(stageOut && slot.pendingCount)
+        {
+            auto& stage = inplace ? slot.inStage : slot.outStage;
+            for(size_t i = 0; i < out.num_pointers(); ++i)
+                memcpy(static_cast<char*>(resultHost[i]) + out.span_start(i, slot.pendingFirst),
+                       stage[i].ptr,
+                       out.span_bytes(slot.pendingCount));
+        }
+        slot.pendingCount = 0;
+    };
+
+    for(size_t c = 0; c < numChunks; ++c)
+    {
+        // work on a slot's stream is ordered, so a slot's device
+        // buffers are reused only after its previous chunk has been
+        // copied out.  staging buffers are written on the host, so
+        // those need the previous chunk to be finished first.
+        auto&        slot  = slots[c % slotCount];
+        const size_t first = c * chunkBatch;
+        const size_t count = std::min(chunkBatch, plan.batch - first);
+        if(stageIn || stageOut)
+            drain(slot);
+
+        std::array<void*, 2> devIn  = {slot.inBuf[0].data(), slot.inBuf[1].data()};
+        std::array<void*, 2> devOut = {slot.outBuf[0].data(), slot.outBuf[1].data()};
+
+        // only the chunk's own transforms are copied, to and from
+        // the plan's offsets in the device buffers
+        for(size_t i = 0; i < in.num_pointers(); ++i)
+        {
+            const void* src = static_cast<char*>(in_host[i]) + in.span_start(i, first);
+            if(stageIn)
+            {
+                memcpy(slot.inStage[i].ptr, src, in.span_bytes(count));
+                src = slot.inStage[i].ptr;
+            }
+            if(hipMemcpyAsync(static_cast<char*>(devIn[i]) + in.offset_bytes(i),
+                              src,
+                              in.span_bytes(count),
+                              hipMemcpyHostToDevice,
+                              slot.stream)
+               != hipSuccess)
+                throw std::runtime_error("out-of-core input copy failed");
+        }
+
+        auto& execPlan = count == chunkBatch ? *chunkPlan : *remainderPlan;
+        execPlan.Execute(devIn.data(), inplace ? devIn.data() : devOut.data(), slot.info);
+
+        auto& resultBuf   = inplace ? devIn : devOut;
+        auto& resultStage = inplace ? slot.inStage : slot.outStage;
+        for(size_t i = 0; i < out.num_pointers(); ++i)
+        {
+            void* dst = stageOut ? resultStage[i].ptr
+                                 : static_cast<char*>(resultHost[i]) + out.span_start(i, first);
+            if(hipMemcpyAsync(dst,
+                              static_cast<char*>(resultBuf[i]) + out.offset_bytes(i),
+                              out.span_bytes(count),
+                              hipMemcpyDeviceToHost,
+                              slot.stream)
+               != hipSuccess)
+                throw std::runtime_error("out-of-core output copy failed");
+        }
+        slot.pendingFirst = first;
+        slot.pendingCount = count;
+    }
+
+    for(size_t s = 0; s < slotCount; ++s)
+        drain(slots[s]);
+}
+
+rocfft_status rocfft_execute_out_of_core(const rocfft_plan     plan,
+                                         void*                 in_buffer[],
+                                         void*                 out_buffer[],
+                                         rocfft_execution_info info)
+{
+    log_trace(
+        __func__, "plan", plan, "in_buffer", in_buffer, "out_buffer", out_buffer, "info", info);
+
+    if(!plan || !in_buffer)
+        return rocfft_status_invalid_arg_value;
+
+    auto create_status = plan->WaitCreate();
+    if(create_status != rocfft_status_success)
+        return create_status;
+
+    if(plan->placement == rocfft_placement_notinplace && !out_buffer)
+        return rocfft_status_invalid_arg_value;
+
+    // chunks are only meaningful for plain single-device batches
+    if(plan->desc.comm_type != rocfft_comm_none || !plan->desc.inFields.empty()
+       || !plan->desc.outFields.empty() || plan->HasSeparatePasses())
+        return rocfft_status_invalid_arg_value;
+
+    // chunks are staged as complex results in the plan's precision
+    if(plan->desc.loadOps.storage != rocfft_storage_format_native
+       || plan->desc.storeOps.storage != rocfft_storage_format_native
+       || plan->desc.storeOps.needs_exclusive_output())
+        return rocfft_status_invalid_arg_value;
+
+    // callbacks would see chunk-relative indexes, work buffers are
+    // allocated per chunk, and chunks already cover the batch
+    if(info
+       && (info->callbacks.load_cb_fn || info->callbacks.store_cb_fn || info->captureMode
+           || info->workBuffer || (info->batch && info->batch != plan->batch)))
+        return rocfft_status_invalid_arg_value;
+
+    try
+    {
+        // devices that share memory with the host can transform the
+        // buffers where they are, so chunking would only add copies
+        const auto in  = batch_layout_t::input(*plan);
+        const auto out = batch_layout_t::output(*plan);
+        if(device_accesses_host_buffers(in_buffer, in.num_pointers())
+           && (plan->placement == rocfft_placement_inplace
+               || device_accesses_host_buffers(out_buffer, out.num_pointers())))
+        {
+            if(LOG_PLAN_ENABLED())
+            {
+                if(LOG_JSON_ENABLED())
+                    log_json_arguments(*LogSingleton::GetInstance().GetPlanOS(),
+                                       "out_of_core_execution",
+                                       "chunks",
+                                       0);
+                else
+                    *LogSingleton::GetInstance().GetPlanOS()
+                        << "out-of-core execution: host buffers accessed directly" << std::endl;
+            }
+
+            plan->Execute(in_buffer, out_buffer, nullptr);
+            if(hipStreamSynchronize(nullptr) != hipSuccess)
+                throw std::runtime_error("hipStreamSynchronize failed");
+            return rocfft_status_success;
+        }
+
+        execute_out_of_core(*plan, in_buffer, out_buffer);
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    catch(rocfft_status e)
+    {
+        return e;
+    }
+    return rocfft_status_success;
+}
@@ -0,0 +1,373 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "../../shared/array_predicate.h"
+#include "../../shared/rocfft_hip.h"
+#include "kernel_launch.h"
+#include "load_store_ops.h"
+#include "logging.h"
+#include "plan.h"
+#include "rocfft/rocfft.h"
+#include "rtc_stockham_kernel.h"
+#include "tree_node.h"
+
+// A persistent executor keeps one kernel resident on the device,
+// which runs the plan's transform on each entry of a work queue.
+//
+// The queue lives in coherent pinned host memory, so that the host
+// and kernels on the device can both produce entries and observe
+// their completion.  Per-slot counts of the blocks that have
+// finished an entry are only touched by the kernel, so they live in
+// device memory.
+struct rocfft_persistent_executor_t
+{
+    rocfft_persistent_executor_t() = default;
+    ~rocfft_persistent_executor_t();
+
+    rocfft_persistent_executor_t(const rocfft_persistent_executor_t&) = delete;
+    rocfft_persistent_executor_t& operator=(const rocfft_persistent_executor_t&) = delete;
+
+    int                        deviceId = 0;
+    std::unique_ptr<RTCKernel> kernel;
+    hipStream_t                stream  = nullptr;
+    bool                       running = false;
+
+    bool planarIn  = false;
+    bool planarOut = false;
+    bool inPlace   = false;
+
+    // queue memory, in one pinned allocation
+    void*               queueAlloc    = nullptr;
+    void**              entries       = nullptr;
+    unsigned long long* submitted     = nullptr;
+    unsigned long long* slotCompleted = nullptr;
+    unsigned int*       stop          = nullptr;
+    size_t              length        = 0;
+
+    unsigned int* slotDone = nullptr;
+
+    // serializes host-side submission
+    std::mutex submitMutex;
+
+    void Submit(void* in_buffer[], void* out_buffer[], unsigned long long& ticket);
+    void Wait(unsigned long long ticket) const;
+    // wait for all submitted entries, then stop the kernel
+    void Stop();
+};
+
+// the queue is written by one side and polled by the other while the
+// kernel runs, so host accesses are atomic
+static unsigned long long queue_load(const unsigned long long* p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+template <typename T>
+static void queue_store(T* p, T v)
+{
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+void rocfft_persistent_executor_t::Submit(void*               in_buffer[],
+                                          void*               out_buffer[],
+                                          unsigned long long& ticket)
+{
+    std::lock_guard<std::mutex> lock(submitMutex);
+
+    const unsigned long long k    = queue_load(submitted);
+    const size_t             slot = k % length;
+
+    // wait for the entry that last used this slot to finish
+    while(k >= length && queue_load(slotCompleted + slot) < k + 1 - length)
+        std::this_thread::yield();
+
+    void** entry = entries + 4 * slot;
+    entry[0]     = in_buffer[0];
+    entry[1]     = planarIn ? in_buffer[1] : nullptr;
+    entry[2]     = inPlace ? nullptr : out_buffer[0];
+    entry[3]     = !inPlace && planarOut ? out_buffer[1] : nullptr;
+    queue_store(submitted, k + 1);
+    ticket = k;
+}
+
+void rocfft_persistent_executor_t::Wait(unsigned long long ticket) const
+{
+    while(queue_load(slotCompleted + ticket % length) < ticket + 1)
+        std::this_thread::yield();
+}
+
+void rocfft_persistent_executor_t::Stop()
+{
+    if(!running)
+        return;
+
+    const auto count = queue_load(submitted);
+    if(count)
+    {
+        // entries finish in order, so waiting for the last one is
+        // enough
+        Wait(count - 1);
+    }
+    queue_store(stop, 1u);
+    (void)hipStreamSynchronize(stream);
+    running = false;
+}
+
+// caller must have made the executor's device current
+rocfft_persistent_executor_t::~rocfft_persistent_executor_t()
+{
+    Stop();
+    if(stream)
+        (void)hipStreamDestroy(stream);
+    if(queueAlloc)
+        (void)hipHostFree(queueAlloc);
+    if(slotDone)
+        (void)hipFree(slotDone);
+}
+
+// plans are executed persistently if they're a single kernel that
+// reads from and writes to user buffers, and needs nothing from the
+// execution besides those buffers
+static TreeNode* persistent_node(const rocfft_plan plan)
+{
+    if(!plan->IsCaptureSafe() || plan->WorkBufBytes())
+        return nullptr;
+    auto execPlan = plan->SingleExecPlan();
+    if(!execPlan || execPlan->execSeq.size() != 1)
+        return nullptr;
+
+    auto node = execPlan->execSeq.front();
+    if(node->scheme != CS_KERNEL_STOCKHAM && node->scheme != CS_KERNEL_2D_SINGLE
+       && node->scheme != CS_KERNEL_3D_SINGLE)
+        return nullptr;
+    if(node->fuseBlue != BFT_NONE || node->obIn != OB_USER_IN
+       || (node->obOut != OB_USER_OUT && node->obOut != OB_USER_IN))
+        return nullptr;
+
+    // the kernel only distributes work over blockIdx.x
+    const auto& gp = execPlan->gridParam.front();
+    if(gp.b_y != 1 || gp.b_z != 1)
+        return nullptr;
+    return node;
+}
+
+rocfft_status rocfft_persistent_executor_create(rocfft_persistent_executor* executor,
+                                                const rocfft_plan           plan,
+                                                size_t                      queue_length)
+{
+    log_trace(__func__, "executor", executor, "plan", plan, "queue_length", queue_length);
+
+    if(!executor || !plan || !queue_length)
+        return rocfft_status_invalid_arg_value;
+
+    auto create_status = plan->WaitCreate();
+    if(create_status != rocfft_status_success)
+        return create_status;
+
+    auto node = persistent_node(plan);
+    if(!node)
+        return rocfft_status_invalid_arg_value;
+    auto  execPlan = plan->SingleExecPlan();
+    auto& gp       = execPlan->gridParam.front();
+
+    try
+    {
+        // the kernel reads tables from the moment it starts, so they
+        // must be ready
+        plan->WaitTables();
+
+        // the executor is destroyed on its device if creation fails
+        rocfft_scoped_device dev(execPlan->location.device);
+        auto                 exec = std::make_unique<rocfft_persistent_executor_t>();
+        exec->deviceId            = execPlan->location.device;
+        exec->planarIn            = array_type_is_planar(node->inArrayType);
+        exec->planarOut           = array_type_is_planar(node->outArrayType);
+        exec->inPlace             = node->placement == rocfft_placement_inplace;
+
+        exec->kernel
+            = RTCKernelStockham::compile_persistent(*node, execPlan->deviceProp.gcnArchName);
+        if(!exec->kernel)
+            return rocfft_status_invalid_arg_value;
+
+        // every block of the kernel must be resident, since they all
+        // wait for new entries without exiting.  Use at most half of
+        // each CU's occupancy, so that the blocks can still all
+        // become resident while other work shares the device.
+        int occupancy = 0;
+        if(!exec->kernel->get_occupancy({gp.wgs_x, gp.wgs_y, gp.wgs_z}, gp.lds_bytes, occupancy)
+           || occupancy < 1)
+            return rocfft_status_failure;
+        const unsigned int resident = static_cast<unsigned int>(
+            std::max(occupancy / 2, 1) * execPlan->deviceProp.multiProcessorCount);
+        const unsigned int grid = std::min(gp.b_x, resident);
+
+        // lay out entries, the submitted count, per-slot completion
+        // and the stop flag in one allocation
+        exec->length                 = queue_length;
+        const size_t entriesBytes    = 4 * queue_length * sizeof(void*);
+        const size_t completedBytes  = queue_length * sizeof(unsigned long long);
+        const size_t queueAllocBytes = entriesBytes + sizeof(unsigned long long) + completedBytes
+                                       + sizeof(unsigned int);
+        if(hipHostMalloc(&exec->queueAlloc,
+                         queueAllocBytes,
+                         hipHostMallocMapped | hipHostMallocCoherent)
+           != hipSuccess)
+            return rocfft_status_failure;
+        std::fill_n(static_cast<char*>(exec->queueAlloc), queueAllocBytes, 0);
+        auto queueBytes     = static_cast<char*>(exec->queueAlloc);
+        exec->entries       = reinterpret_cast<void**>(queueBytes);
+        exec->submitted     = reinterpret_cast<unsigned long long*>(queueBytes + entriesBytes);
+        exec->slotCompleted = exec->submitted + 1;
+        exec->stop = reinterpret_cast<unsigned int*>(queueBytes + entriesBytes
+                                                     + sizeof(unsigned long long) + completedBytes);
+
+        if(hipMalloc(&exec->slotDone, queue_length * sizeof(unsigned int)) != hipSuccess
+           || hipMemset(exec->slotDone, 0, queue_length * sizeof(unsigned int)) != hipSuccess)
+            return rocfft_status_failure;
+
+        if(hipStreamCreateWithFlags(&exec->stream, hipStreamNonBlocking) != hipSuccess)
+            return rocfft_status_failure;
+
+        // buffer pointers come from each queue entry, so none are
+        // given to the transform's own arguments
+        DeviceCallIn data;
+        data.node          = node;
+        data.gridParam     = gp;
+        data.deviceProp    = execPlan->deviceProp;
+        data.rocfft_stream = exec->stream;
+        auto kargs         = exec->kernel->get_launch_args(data);
+
+        // offsets are applied to each entry's pointers, in elements
+        // of the format the buffers are stored in
+        const size_t inOffsetBytes
+            = node->iOffset
+              * storage_element_size(node->loadOps.storage, node->precision, node->inArrayType);
+        const size_t outOffsetBytes
+            = node->oOffset
+              * storage_element_size(node->storeOps.storage,
+                                     node->precision,
+                                     node->storeOps.stored_array_type(node->outArrayType));
+
+        kargs.append_ptr(exec->entries);
+        kargs.append_ptr(exec->submitted);
+        kargs.append_ptr(exec->slotCompleted);
+        kargs.append_ptr(exec->slotDone);
+        kargs.append_ptr(exec->stop);
+        kargs.append_size_t(queue_length);
+        kargs.append_size_t(inOffsetBytes);
+        kargs.append_size_t(outOffsetBytes);
+        kargs.append_unsigned_int(gp.b_x);
+
+        exec->kernel->launch(kargs,
+                             {grid, 1, 1},
+                             {gp.wgs_x, gp.wgs_y, gp.wgs_z},
+                             gp.lds_bytes,
+                             execPlan->deviceProp,
+                             exec->stream);
+        exec->running = true;
+
+        *executor = exec.release();
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_persistent_executor_submit(rocfft_persistent_executor executor,
+                                                void*                      in_buffer[],
+                                                void*                      out_buffer[],
+                                                unsigned long long*        ticket)
+{
+    log_trace(__func__,
+              "executor",
+              executor,
+              "in_buffer",
+              in_buffer,
+              "out_buffer",
+              out_buffer,
+              "ticket",
+              ticket);
+
+    if(!executor || !in_buffer || !ticket || !executor->running)
+        return rocfft_status_invalid_arg_value;
+    if(!executor->inPlace && !out_buffer)
+        return rocfft_status_invalid_arg_value;
+
+    executor->Submit(in_buffer, out_buffer, *ticket);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_persistent_executor_wait(rocfft_persistent_executor executor,
+                                              unsigned long long         ticket)
+{
+    log_trace(__func__, "executor", executor, "ticket", ticket);
+
+    // entries that were never submitted would never finish
+    if(!executor || ticket >= queue_load(executor->submitted))
+        return rocfft_status_invalid_arg_value;
+
+    executor->Wait(ticket);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_persistent_executor_get_queue(rocfft_persistent_executor executor,
+                                                   rocfft_persistent_queue*   queue)
+{
+    log_trace(__func__, "executor", executor, "queue", queue);
+
+    if(!executor || !queue)
+        return rocfft_status_invalid_arg_value;
+
+    queue->entries        = executor->entries;
+    queue->submitted      = executor->submitted;
+    queue->slot_completed = executor->slotCompleted;
+    queue->length         = executor->length;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_persistent_executor_destroy(rocfft_persistent_executor executor)
+{
+    log_trace(__func__, "executor", executor);
+
+    if(!executor)
+        return rocfft_status_success;
+
+    try
+    {
+        rocfft_scoped_device dev(executor->deviceId);
+        delete executor;
+    }
+    catch(std::exception&)
+    {
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
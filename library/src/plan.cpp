@@ -21,6 +21,7 @@
 #include "plan.h"
 #include "../../shared/arithmetic.h"
 #include "../../shared/array_predicate.h"
+#include "../../shared/array_validator.h"
 #include "../../shared/device_properties.h"
 #include "../../shared/environment.h"
 #include "../../shared/precision_type.h"
@@ -29,18 +30,32 @@
 #include "enum_printer.h"
 #include "function_pool.h"
 #include "hip/hip_runtime_api.h"
+#include "link_topology.h"
 #include "logging.h"
 #include "node_factory.h"
+#include "online_tuner.h"
+#include "plan_cache.h"
+#include "plan_create_times.h"
+#include "repo.h"
 #include "rocfft/rocfft-version.h"
 #include "rocfft/rocfft.h"
 #include "rocfft_ostream.hpp"
+#include "roctx_range.h"
+#include "rtc_generic_kernel.h"
 #include "rtc_kernel.h"
+#include "rtc_stockham_kernel.h"
 #include "solution_map.h"
 #include "tuning_helper.h"
+#include "tree_node_bluestein.h"
+#include "tree_node_ND.h"
+#include "tree_node_real.h"
 #include "tuning_plan_tuner.h"
 
 #include <algorithm>
 #include <assert.h>
+#include <bitset>
+#include <chrono>
+#include <cmath>
 #include <functional>
 #include <iterator>
 #include <limits>
@@ -66,6 +81,152 @@
                                TO_STR(rocfft_version_tweak) )
 // clang-format on
 
+rocfft_status rocfft_plan_description_set_minimize_work_buffer(rocfft_plan_description description,
+                                                              const int               minimize)
+{
+    log_trace(__func__, "description", description, "minimize", minimize);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    description->assignOptStrategy = minimize ? rocfft_optimize_min_buffer : rocfft_optimize_balance;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_optimization_goal(rocfft_plan_description  description,
+                                                            rocfft_optimization_goal goal)
+{
+    log_trace(__func__, "description", description, "goal", goal);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    switch(goal)
+    {
+    case rocfft_optimization_goal_throughput:
+        description->assignOptStrategy = rocfft_optimize_balance;
+        break;
+    case rocfft_optimization_goal_latency:
+        description->assignOptStrategy = rocfft_optimize_max_fusion;
+        break;
+    case rocfft_optimization_goal_memory:
+        description->assignOptStrategy = rocfft_optimize_min_buffer;
+        break;
+    default:
+        return rocfft_status_invalid_arg_value;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_exchange_chunk_size(rocfft_plan_description description,
+                                                              const size_t            chunk_bytes)
+{
+    log_trace(__func__, "description", description, "chunk_bytes", chunk_bytes);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    description->exchangeChunkBytes = chunk_bytes;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_batch_tile(rocfft_plan_description description,
+                                                    const size_t            tile_width)
+{
+    log_trace(__func__, "description", description, "tile_width", tile_width);
+    if(!description || tile_width == 0)
+        return rocfft_status_invalid_arg_value;
+    description->batchTile = tile_width;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_cu_mask(rocfft_plan_description description,
+                                                 const size_t            cu_mask_size,
+                                                 const uint32_t*         cu_mask)
+{
+    log_trace(__func__,
+              "description",
+              description,
+              "cu_mask_size",
+              cu_mask_size,
+              "cu_mask",
+              cu_mask);
+    if(!description || (cu_mask_size && !cu_mask))
+        return rocfft_status_invalid_arg_value;
+    if(cu_mask_size
+       && std::all_of(cu_mask, cu_mask + cu_mask_size, [](uint32_t word) { return word == 0; }))
+        return rocfft_status_invalid_arg_value;
+    description->cuMask.assign(cu_mask, cu_mask + cu_mask_size);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_exchange_storage_format(
+    rocfft_plan_description description, const rocfft_storage_format format)
+{
+    log_trace(__func__, "description", description, "format", storage_format_name(format));
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    switch(format)
+    {
+    case rocfft_storage_format_native:
+    case rocfft_storage_format_half:
+    case rocfft_storage_format_bfloat16:
+    case rocfft_storage_format_single:
+        break;
+    default:
+        return rocfft_status_invalid_arg_value;
+    }
+    description->exchangeStorage = format;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_devices(rocfft_plan_description description,
+                                                  const int*              devices,
+                                                  const size_t            num_devices)
+{
+    log_trace(__func__, "description", description, "num_devices", num_devices);
+    if(!description || (!devices && num_devices))
+        return rocfft_status_invalid_arg_value;
+    if(std::any_of(devices, devices + num_devices, [](int d) { return d < 0; }))
+        return rocfft_status_invalid_arg_value;
+    description->devices.assign(devices, devices + num_devices);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_table_stream(rocfft_plan_description description,
+                                                       void*                   stream)
+{
+    log_trace(__func__, "description", description, "stream", stream);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    description->tableStream = static_cast<hipStream_t>(stream);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_host_buffers(rocfft_plan_description description,
+                                                       const int               host_buffers)
+{
+    log_trace(__func__, "description", description, "host_buffers", host_buffers);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    description->hostBuffers = host_buffers != 0;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_packed_hermitian(rocfft_plan_description description,
+                                                           const int               packed)
+{
+    log_trace(__func__, "description", description, "packed", packed);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    description->packedHermitian = packed != 0;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_measure_access_modes(
+    rocfft_plan_description description, const int measure)
+{
+    log_trace(__func__, "description", description, "measure", measure);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    description->measureAccessModes = measure != 0;
+    return rocfft_status_success;
+}
+
 rocfft_status rocfft_plan_description_set_scale_factor(rocfft_plan_description description,
                                                        const double            scale_factor)
 {
@@ -76,6 +237,238 @@ rocfft_status rocfft_plan_description_set_scale_factor(rocfft_plan_description d
     return rocfft_status_success;
 }
 
+rocfft_status rocfft_plan_description_set_normalization(rocfft_plan_description    description,
+                                                        const rocfft_normalization normalization)
+{
+    log_trace(
+        __func__, "description", description, "normalization", normalization_name(normalization));
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    switch(normalization)
+    {
+    case rocfft_normalization_none:
+    case rocfft_normalization_backward:
+    case rocfft_normalization_forward:
+    case rocfft_normalization_ortho:
+        break;
+    default:
+        return rocfft_status_invalid_arg_value;
+    }
+    description->storeOps.normalization = normalization;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_input_scale_factor(rocfft_plan_description description,
+                                                             const double            scale_factor)
+{
+    log_trace(__func__, "description", description, "scale", scale_factor);
+    if(!std::isfinite(scale_factor))
+        return rocfft_status_invalid_arg_value;
+    description->loadOps.scale_factor = scale_factor;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_storage_format(rocfft_plan_description     description,
+                                                         const rocfft_storage_format format)
+{
+    log_trace(__func__, "description", description, "format", storage_format_name(format));
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    switch(format)
+    {
+    case rocfft_storage_format_native:
+    case rocfft_storage_format_half:
+    case rocfft_storage_format_bfloat16:
+    case rocfft_storage_format_fp8_e4m3:
+    case rocfft_storage_format_fp8_e5m2:
+        break;
+    default:
+        return rocfft_status_invalid_arg_value;
+    }
+    description->loadOps.storage  = format;
+    description->storeOps.storage = format;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_input_storage_format(
+    rocfft_plan_description description, const rocfft_storage_format format)
+{
+    log_trace(__func__, "description", description, "format", storage_format_name(format));
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    switch(format)
+    {
+    case rocfft_storage_format_native:
+    case rocfft_storage_format_half:
+    case rocfft_storage_format_bfloat16:
+    case rocfft_storage_format_fp8_e4m3:
+    case rocfft_storage_format_fp8_e5m2:
+    case rocfft_storage_format_int16:
+    case rocfft_storage_format_int8:
+        break;
+    default:
+        return rocfft_status_invalid_arg_value;
+    }
+    description->loadOps.storage = format;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_output_storage_format(
+    rocfft_plan_description description, const rocfft_storage_format format)
+{
+    log_trace(__func__, "description", description, "format", storage_format_name(format));
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    switch(format)
+    {
+    case rocfft_storage_format_native:
+    case rocfft_storage_format_half:
+    case rocfft_storage_format_bfloat16:
+    case rocfft_storage_format_fp8_e4m3:
+    case rocfft_storage_format_fp8_e5m2:
+        break;
+    default:
+        return rocfft_status_invalid_arg_value;
+    }
+    description->storeOps.storage = format;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_output_op(rocfft_plan_description description,
+                                                    const rocfft_output_op  op)
+{
+    log_trace(__func__, "description", description, "op", output_op_name(op));
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    switch(op)
+    {
+    case rocfft_output_op_none:
+    case rocfft_output_op_power:
+    case rocfft_output_op_magnitude:
+    case rocfft_output_op_log_power:
+        break;
+    default:
+        return rocfft_status_invalid_arg_value;
+    }
+    description->storeOps.output_op = op;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_output_accumulate(rocfft_plan_description description,
+                                                            const int               accumulate)
+{
+    log_trace(__func__, "description", description, "accumulate", accumulate);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    description->storeOps.accumulate = accumulate != 0;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_pass_callbacks(rocfft_plan_description description,
+                                                         const int               enable)
+{
+    log_trace(__func__, "description", description, "enable", enable);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    description->storeOps.pass_callbacks = enable != 0;
+    return rocfft_status_success;
+}
+
+// an empty source or function name clears the callback
+static rocfft_status set_callback_source(InlineCallback& callback,
+                                         const char*     source,
+                                         const char*     function_name)
+{
+    if(!source || !function_name || !*source || !*function_name)
+    {
+        callback = InlineCallback();
+        return rocfft_status_success;
+    }
+    callback.source   = source;
+    callback.function = function_name;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_load_callback_source(rocfft_plan_description description,
+                                                               const char*             source,
+                                                               const char* function_name)
+{
+    log_trace(__func__, "description", description, "function_name", function_name);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    return set_callback_source(description->loadOps.callback, source, function_name);
+}
+
+rocfft_status rocfft_plan_description_set_store_callback_source(rocfft_plan_description description,
+                                                                const char*             source,
+                                                                const char* function_name)
+{
+    log_trace(__func__, "description", description, "function_name", function_name);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    return set_callback_source(description->storeOps.callback, source, function_name);
+}
+
+rocfft_status rocfft_plan_description_set_input_window(rocfft_plan_description description,
+                                                       const void*             window)
+{
+    log_trace(__func__, "description", description, "window", window);
+    if(!description)
+        return rocfft_status_invalid_arg_value;
+    description->loadOps.window = window;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_input_zero_padding(rocfft_plan_description description,
+                                                             const size_t            dimensions,
+                                                             const size_t*           valid_lengths)
+{
+    log_trace(__func__,
+              "description",
+              description,
+              "valid_lengths",
+              std::make_pair(valid_lengths, dimensions));
+    if(!description || dimensions > 3 || (dimensions && !valid_lengths))
+        return rocfft_status_invalid_arg_value;
+    description->loadOps.valid_lengths.assign(valid_lengths, valid_lengths + dimensions);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_output_truncation(rocfft_plan_description description,
+                                                           const size_t            dimensions,
+                                                           const size_t*           kept_lengths)
+{
+    log_trace(__func__,
+              "description",
+              description,
+              "kept_lengths",
+              std::make_pair(kept_lengths, dimensions));
+    if(!description || dimensions > 3 || (dimensions && !kept_lengths))
+        return rocfft_status_invalid_arg_value;
+    description->storeOps.kept_starts.assign(dimensions, 0);
+    description->storeOps.kept_lengths.assign(kept_lengths, kept_lengths + dimensions);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_description_set_output_pruning(rocfft_plan_description description,
+                                                        const size_t            dimensions,
+                                                        const size_t*           first_bins,
+                                                        const size_t*           bin_counts)
+{
+    log_trace(__func__,
+              "description",
+              description,
+              "first_bins",
+              std::make_pair(first_bins, dimensions),
+              "bin_counts",
+              std::make_pair(bin_counts, dimensions));
+    if(!description || dimensions > 3 || (dimensions && (!first_bins || !bin_counts)))
+        return rocfft_status_invalid_arg_value;
+    description->storeOps.kept_starts.assign(first_bins, first_bins + dimensions);
+    description->storeOps.kept_lengths.assign(bin_counts, bin_counts + dimensions);
+    return rocfft_status_success;
+}
+
 static size_t offset_count(rocfft_array_type type)
 {
     // planar data has 2 sets of offsets, otherwise we have one
@@ -104,6 +497,14 @@ void rocfft_plan_description_t::init_defaults(rocfft_transform_type      transfo
             inArrayType = rocfft_array_type_hermitian_interleaved;
             break;
         case rocfft_transform_type_real_forward:
+        case rocfft_transform_type_dct1:
+        case rocfft_transform_type_dct2:
+        case rocfft_transform_type_dct3:
+        case rocfft_transform_type_dct4:
+        case rocfft_transform_type_dst1:
+        case rocfft_transform_type_dst2:
+        case rocfft_transform_type_dst3:
+        case rocfft_transform_type_dst4:
             inArrayType = rocfft_array_type_real;
             break;
         }
@@ -120,6 +521,14 @@ void rocfft_plan_description_t::init_defaults(rocfft_transform_type      transfo
             outArrayType = rocfft_array_type_hermitian_interleaved;
             break;
         case rocfft_transform_type_real_inverse:
+        case rocfft_transform_type_dct1:
+        case rocfft_transform_type_dct2:
+        case rocfft_transform_type_dct3:
+        case rocfft_transform_type_dct4:
+        case rocfft_transform_type_dst1:
+        case rocfft_transform_type_dst2:
+        case rocfft_transform_type_dst3:
+        case rocfft_transform_type_dst4:
             outArrayType = rocfft_array_type_real;
             break;
         }
@@ -181,9 +590,11 @@ void rocfft_plan_description_t::init_defaults(rocfft_transform_type      transfo
         // In-place 1D transforms need extra dist.
         if(transformType == rocfft_transform_type_real_forward && lengths.size() == 1
            && placement == rocfft_placement_inplace)
-            inDist = 2 * (lengths[0] / 2 + 1) * inStrides[0];
+            inDist = 2 * outputLengths[0] * inStrides[0];
         else
             inDist = lengths[rank - 1] * inStrides[rank - 1];
+        // a tile of transforms shares each element's slot
+        inDist *= batchTile;
     }
     if(outDist == 0)
     {
@@ -193,6 +604,7 @@ void rocfft_plan_description_t::init_defaults(rocfft_transform_type      transfo
             outDist = 2 * lengths[0] * outStrides[0];
         else
             outDist = outputLengths[rank - 1] * outStrides[rank - 1];
+        outDist *= batchTile;
     }
 }
 
@@ -223,32 +635,40 @@ void rocfft_plan_t::sort()
     if(iodims.empty())
         return;
 
-    bool sort_on_istride = true;
-    auto sorter          = [sort_on_istride](const rocfft_iodim& a, const rocfft_iodim& b) {
-        // move any lengths of 1 to the end
-        if(a.length == 1 && b.length != 1)
-            return false;
-        if(b.length == 1 && a.length != 1)
-            return true;
-        return sort_on_istride ? (a.istride < b.istride) : (a.ostride < b.ostride);
-    };
+    // a length-1 dimension is an identity transform wherever it is
+    // and whatever its strides, so drop it rather than building
+    // tree nodes for it.  keep at least one dimension.
+    //
+    // bricks describe their extents in the original dimensions, so
+    // plans with fields can only lose trailing length-1 dimensions.
+    auto is_length1 = [](const rocfft_iodim& d) { return d.length == 1; };
+    if(desc.inFields.empty() && desc.outFields.empty())
+        iodims.erase(std::remove_if(iodims.begin(), iodims.end(), is_length1), iodims.end());
+    else
+    {
+        while(!iodims.empty() && is_length1(iodims.back()))
+            iodims.pop_back();
+    }
+    if(iodims.empty() && start_dim == 0)
+        iodims.push_back(rocfft_iodim{1, 1, desc.inStrides[0], desc.outStrides[0]});
+    rank = start_dim + iodims.size();
 
-    // sort on istride first
-    std::sort(iodims.begin(), iodims.end(), sorter);
+    auto sort_on_istride = [](const rocfft_iodim& a, const rocfft_iodim& b) {
+        return a.istride < b.istride;
+    };
+    auto sort_on_ostride = [](const rocfft_iodim& a, const rocfft_iodim& b) {
+        return a.ostride < b.ostride;
+    };
 
-    // if that means ostride is no longer sorted, then don't bother
-    // changing anything - the user is asking for some kind of
-    // transposed FFT so let's just assume they know what they're doing
-    sort_on_istride = false;
-    if(!std::is_sorted(iodims.begin(), iodims.end(), sorter))
-        return;
+    // sort on istride first.  if that means ostride is no longer
+    // sorted, then don't bother changing the order - the user is
+    // asking for some kind of transposed FFT so let's just assume
+    // they know what they're doing
+    auto sorted = iodims;
+    std::sort(sorted.begin(), sorted.end(), sort_on_istride);
+    if(std::is_sorted(sorted.begin(), sorted.end(), sort_on_ostride))
+        iodims.swap(sorted);
 
-    // chop off any lengths of 1 from the end
-    while(iodims.size() > 1 && iodims.back().length == 1)
-    {
-        --rank;
-        iodims.pop_back();
-    }
     // copy back the sorted lengths + strides
     for(size_t dim = start_dim; dim < rank; ++dim)
     {
@@ -294,6 +714,7 @@ size_t rocfft_plan_t::AddMultiPlanItem(std::unique_ptr<MultiPlanItem>&& item,
 
     multiPlan.emplace_back(std::move(item));
     multiPlanAntecedents.emplace_back(antecedents);
+    multiPlanOrder.clear();
 
     // return index of new item
     return multiPlan.size() - 1;
@@ -308,7 +729,15 @@ void rocfft_plan_t::AddAntecedent(size_t itemIdx, size_t antecedentIdx)
 
     auto& antecedents = multiPlanAntecedents[itemIdx];
     if(std::find(antecedents.begin(), antecedents.end(), antecedentIdx) == antecedents.end())
+    {
         antecedents.push_back(antecedentIdx);
+        multiPlanOrder.clear();
+    }
+}
+
+void rocfft_plan_t::FinalizeMultiPlan()
+{
+    multiPlanOrder = MultiPlanTopologicalSort();
 }
 
 size_t rocfft_plan_t::WorkBufBytes() const
@@ -328,6 +757,81 @@ size_t rocfft_plan_t::WorkBufBytes() const
     return workBufBytes;
 }
 
+void rocfft_plan_t::WaitTables() const
+{
+    for(const auto& i : multiPlan)
+    {
+        auto execPlan = dynamic_cast<const ExecPlan*>(i.get());
+        if(execPlan)
+            execPlan->WaitTables();
+    }
+}
+
+bool rocfft_plan_t::IsSingleExecPlan() const
+{
+    return multiPlan.size() == 1 && dynamic_cast<const ExecPlan*>(multiPlan.front().get());
+}
+
+ExecPlan* rocfft_plan_t::SingleExecPlan() const
+{
+    return multiPlan.size() == 1 ? dynamic_cast<ExecPlan*>(multiPlan.front().get()) : nullptr;
+}
+
+bool rocfft_plan_t::IsCaptureSafe() const
+{
+    // host buffers are staged through with host-side copies
+    if(desc.hostBuffers)
+        return false;
+
+    // communication and multi-device items allocate streams and
+    // events, and wait on the host for antecedents to finish.  only
+    // plain single-device plans are safe to capture.
+    for(const auto& i : multiPlan)
+    {
+        if(!i)
+            continue;
+        auto execPlan = dynamic_cast<const ExecPlan*>(i.get());
+        if(!execPlan || execPlan->mgpuPlan)
+            return false;
+    }
+    return true;
+}
+
+// sum up twiddle and chirp memory held by a node and its children
+static size_t TwiddleBytes(const TreeNode& node)
+{
+    size_t bytes = node.twiddles_size + node.twiddles_large_size + node.chirp_size;
+    for(const auto& child : node.childNodes)
+        bytes += TwiddleBytes(*child);
+    return bytes;
+}
+
+void rocfft_plan_t::GetInfo(rocfft_plan_info& info) const
+{
+    info                       = rocfft_plan_info{};
+    info.work_buffer_bytes     = WorkBufBytes();
+    const auto local_comm_rank = get_local_comm_rank();
+    for(const auto& i : multiPlan)
+    {
+        if(!i || !i->ExecutesOnRank(local_comm_rank))
+            continue;
+        auto execPlan = dynamic_cast<const ExecPlan*>(i.get());
+        if(!execPlan)
+            continue;
+        info.kernel_count += execPlan->execSeq.size();
+        for(auto node : execPlan->execSeq)
+        {
+            // chirp setup only writes to global memory, so it's not
+            // a full pass over the data
+            if(node->scheme != CS_KERNEL_CHIRP && node->scheme != CS_KERNEL_RADER_CHIRP)
+                ++info.global_memory_passes;
+            info.estimated_bytes_moved += KernelBytesMoved(*node);
+        }
+        if(execPlan->rootPlan)
+            info.twiddle_bytes += TwiddleBytes(*execPlan->rootPlan);
+    }
+}
+
 rocfft_status rocfft_plan_description_set_comm(rocfft_plan_description description,
                                                rocfft_comm_type        comm_type,
                                                void*                   comm_handle)
@@ -350,6 +854,9 @@ rocfft_status rocfft_plan_description_set_comm(rocfft_plan_description descripti
     {
 #ifdef ROCFFT_MPI_ENABLE
         description->mpi_comm.free();
+#endif
+#ifdef ROCFFT_RCCL_ENABLE
+        description->rccl_comm = nullptr;
 #endif
         break;
     }
@@ -362,6 +869,13 @@ rocfft_status rocfft_plan_description_set_comm(rocfft_plan_description descripti
             return rocfft_status_failure;
         break;
     }
+#endif
+#ifdef ROCFFT_RCCL_ENABLE
+    case rocfft_comm_rccl:
+    {
+        description->rccl_comm = *static_cast<ncclComm_t*>(comm_handle);
+        break;
+    }
 #endif
     default:
         return rocfft_status_failure;
@@ -599,6 +1113,15 @@ std::string rocfft_brick_t::str() const
     return ret;
 }
 
+rocfft_brick_t PipelineSlabs::slab(const rocfft_brick_t& brick, size_t slabIdx) const
+{
+    auto         ret    = brick;
+    const size_t length = brick.upper[dim] - brick.lower[dim];
+    ret.lower[dim]      = brick.lower[dim] + length * slabIdx / count;
+    ret.upper[dim]      = brick.lower[dim] + length * (slabIdx + 1) / count;
+    return ret;
+}
+
 rocfft_status rocfft_field_add_brick(rocfft_field field, rocfft_brick brick)
 {
     log_trace(__func__, "field", field, "brick", brick);
@@ -668,7 +1191,7 @@ rocfft_status rocfft_plan_description_add_outfield(rocfft_plan_description descr
     return rocfft_status_success;
 }
 
-std::string rocfft_bench_command(rocfft_plan plan)
+std::string rocfft_bench_command(const rocfft_plan_t* plan)
 {
     std::stringstream bench;
     bench << "rocfft-bench --length ";
@@ -747,18 +1270,442 @@ rocfft_status check_array_type_validity(const rocfft_plan plan)
            && (plan->desc.inArrayType != rocfft_array_type_hermitian_interleaved))
             return rocfft_status_invalid_array_type;
         break;
+    case rocfft_transform_type_dct1:
+    case rocfft_transform_type_dct2:
+    case rocfft_transform_type_dct3:
+    case rocfft_transform_type_dct4:
+    case rocfft_transform_type_dst1:
+    case rocfft_transform_type_dst2:
+    case rocfft_transform_type_dst3:
+    case rocfft_transform_type_dst4:
+        // Input and output must be real
+        if(plan->desc.inArrayType != rocfft_array_type_real
+           || plan->desc.outArrayType != rocfft_array_type_real)
+            return rocfft_status_invalid_array_type;
+        break;
     }
     return rocfft_status_success;
 }
 
-// Given a rocfft_plan with validated parameters, set the transform parameters for the root of the
-// tree plan.
-void set_rootplan_params(const rocfft_plan plan, NodeMetaData& planData)
+// Verify that the storage format of user data is usable with the
+// rest of the plan.
+rocfft_status check_storage_format_validity(const rocfft_plan plan)
 {
-    planData.dimension = plan->rank;
-    planData.batch     = plan->batch;
-    for(size_t i = 0; i < plan->rank; i++)
-    {
+    if(plan->desc.loadOps.storage == rocfft_storage_format_native
+       && plan->desc.storeOps.storage == rocfft_storage_format_native)
+        return rocfft_status_success;
+
+    // an in-place transform's intermediate data in the user buffer is
+    // stored in the output format, and read back in the input format
+    if(plan->placement == rocfft_placement_inplace
+       && plan->desc.loadOps.storage != plan->desc.storeOps.storage)
+        return rocfft_status_invalid_arg_value;
+    if(storage_is_integer(plan->desc.storeOps.storage))
+        return rocfft_status_invalid_arg_value;
+
+    // narrow storage is only implemented for single-precision
+    // compute, and only by kernels that access user memory through
+    // generated global loads and stores
+    if(plan->precision != rocfft_precision_single)
+        return rocfft_status_invalid_arg_value;
+    if(plan->transformType != rocfft_transform_type_complex_forward
+       && plan->transformType != rocfft_transform_type_complex_inverse)
+        return rocfft_status_invalid_arg_value;
+    if(plan->desc.inArrayType != rocfft_array_type_complex_interleaved
+       || plan->desc.outArrayType != rocfft_array_type_complex_interleaved)
+        return rocfft_status_invalid_arg_value;
+    if(plan->desc.comm_type != rocfft_comm_none || !plan->desc.inFields.empty()
+       || !plan->desc.outFields.empty())
+        return rocfft_status_invalid_arg_value;
+    return rocfft_status_success;
+}
+
+// Verify that the storage format of exchanged data is narrower than
+// the plan's precision.  Exchanges are converted by the pack and
+// unpack transposes, which only support interleaved data.
+rocfft_status check_exchange_storage_validity(const rocfft_plan plan)
+{
+    switch(plan->desc.exchangeStorage)
+    {
+    case rocfft_storage_format_native:
+        return rocfft_status_success;
+    case rocfft_storage_format_single:
+        if(plan->precision != rocfft_precision_double)
+            return rocfft_status_invalid_arg_value;
+        break;
+    case rocfft_storage_format_half:
+    case rocfft_storage_format_bfloat16:
+        if(plan->precision != rocfft_precision_single)
+            return rocfft_status_invalid_arg_value;
+        break;
+    default:
+        return rocfft_status_invalid_arg_value;
+    }
+    if(array_type_is_planar(plan->desc.inArrayType)
+       || array_type_is_planar(plan->desc.outArrayType))
+        return rocfft_status_invalid_arg_value;
+    return rocfft_status_success;
+}
+
+// Plans given a device list describe the user's buffers as one
+// brick each on the current device, so they're built like plans
+// with fields.  Plan building then distributes the bricks over the
+// devices.
+rocfft_status set_device_list_fields(const rocfft_plan plan)
+{
+    auto& desc = plan->desc;
+    if(desc.devices.empty())
+        return rocfft_status_success;
+
+    if(desc.comm_type != rocfft_comm_none || !desc.inFields.empty() || !desc.outFields.empty())
+        return rocfft_status_invalid_arg_value;
+    if(array_type_is_planar(desc.inArrayType) || array_type_is_planar(desc.outArrayType))
+        return rocfft_status_invalid_arg_value;
+
+    int deviceCount = 0;
+    if(hipGetDeviceCount(&deviceCount) != hipSuccess)
+        return rocfft_status_failure;
+    std::set<int> seen;
+    for(auto device : desc.devices)
+    {
+        if(device >= deviceCount || !seen.insert(device).second)
+            return rocfft_status_invalid_arg_value;
+    }
+
+    const auto location = rocfft_location_t::rank0_current_device();
+    auto       userBrick
+        = [&](const std::vector<size_t>& length, const std::vector<size_t>& stride, size_t dist) {
+              rocfft_brick_t brick;
+              brick.lower.assign(plan->rank + 1, 0);
+              brick.upper.assign(length.begin(), length.begin() + plan->rank);
+              brick.upper.push_back(plan->batch);
+              brick.stride.assign(stride.begin(), stride.begin() + plan->rank);
+              brick.stride.push_back(dist);
+              brick.location = location;
+              rocfft_field_t field;
+              field.bricks.push_back(std::move(brick));
+              return field;
+          };
+    desc.inFields.push_back(userBrick(plan->lengths, desc.inStrides, desc.inDist));
+    desc.outFields.push_back(userBrick(plan->outputLengths, desc.outStrides, desc.outDist));
+    return rocfft_status_success;
+}
+
+// Verify that output ops and accumulation are usable with the rest
+// of the plan.  Both are applied by the last kernel, which must be
+// the only one to write the output buffer.
+rocfft_status check_output_op_validity(const rocfft_plan plan)
+{
+    if(!plan->desc.storeOps.needs_exclusive_output())
+        return rocfft_status_success;
+
+    if(plan->placement != rocfft_placement_notinplace)
+        return rocfft_status_invalid_arg_value;
+    if(plan->transformType != rocfft_transform_type_complex_forward
+       && plan->transformType != rocfft_transform_type_complex_inverse
+       && plan->transformType != rocfft_transform_type_real_forward)
+        return rocfft_status_invalid_arg_value;
+    if(plan->desc.outArrayType != rocfft_array_type_complex_interleaved
+       && plan->desc.outArrayType != rocfft_array_type_hermitian_interleaved)
+        return rocfft_status_invalid_arg_value;
+    if(plan->desc.comm_type != rocfft_comm_none || !plan->desc.inFields.empty()
+       || !plan->desc.outFields.empty())
+        return rocfft_status_invalid_arg_value;
+    return rocfft_status_success;
+}
+
+// Verify that callbacks given as source are usable with the rest of
+// the plan.  They're compiled into the same kernels as function
+// pointer callbacks, which are only built for native data.
+rocfft_status check_inline_callback_validity(const rocfft_plan plan)
+{
+    if(plan->desc.loadOps.callback.empty() && plan->desc.storeOps.callback.empty())
+        return rocfft_status_success;
+
+    if(plan->desc.loadOps.storage != rocfft_storage_format_native
+       || plan->desc.storeOps.storage != rocfft_storage_format_native)
+        return rocfft_status_invalid_arg_value;
+    if(plan->desc.storeOps.needs_exclusive_output())
+        return rocfft_status_invalid_arg_value;
+    return rocfft_status_success;
+}
+
+// Factor that a transform in the given direction is scaled by to
+// apply a normalization.  lengths are the plan's logical
+// (real-domain, for real transforms) lengths.
+static double normalization_scale(rocfft_normalization       normalization,
+                                  const std::vector<size_t>& lengths,
+                                  bool                       forward)
+{
+    const double n = static_cast<double>(product(lengths.begin(), lengths.end()));
+    switch(normalization)
+    {
+    case rocfft_normalization_none:
+        break;
+    case rocfft_normalization_backward:
+        return forward ? 1.0 : 1.0 / n;
+    case rocfft_normalization_forward:
+        return forward ? 1.0 / n : 1.0;
+    case rocfft_normalization_ortho:
+        return 1.0 / std::sqrt(n);
+    }
+    return 1.0;
+}
+
+// Verify that sub_lengths (the input's valid lengths or the
+// output's kept lengths) fit in a buffer of the given lengths and
+// layout.  Coordinates are peeled off an element's offset slowest
+// dimension first, so the buffer's dimensions must not overlap.
+static rocfft_status check_sub_lengths(const rocfft_plan          plan,
+                                       const std::vector<size_t>& sub_lengths,
+                                       const std::vector<size_t>& lengths,
+                                       const std::vector<size_t>& strides,
+                                       size_t                     dist)
+{
+    if(sub_lengths.size() != plan->rank)
+        return rocfft_status_invalid_dimensions;
+    for(size_t i = 0; i < plan->rank; ++i)
+    {
+        if(sub_lengths[i] == 0 || sub_lengths[i] > lengths[i])
+            return rocfft_status_invalid_arg_value;
+    }
+
+    std::vector<size_t> order(plan->rank);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&strides](size_t a, size_t b) {
+        return strides[a] < strides[b];
+    });
+    size_t span = 1;
+    for(auto i : order)
+    {
+        if(strides[i] < span)
+            return rocfft_status_invalid_arg_value;
+        span += strides[i] * (lengths[i] - 1);
+    }
+    if(plan->batch > 1 && dist < span)
+        return rocfft_status_invalid_arg_value;
+    return rocfft_status_success;
+}
+
+// Verify that the input window and zero padding are usable with
+// the rest of the plan, and remember the input layout they need.
+// This is done before the plan's dimensions are sorted, while the
+// valid lengths still line up with the user's lengths and strides.
+rocfft_status set_load_ops_layout(const rocfft_plan plan)
+{
+    auto& loadOps = plan->desc.loadOps;
+    if(!loadOps.window && loadOps.valid_lengths.empty())
+        return rocfft_status_success;
+
+    // the ops find an element's position from its offset in the
+    // input, which only means one thing for complex interleaved data
+    if(plan->transformType != rocfft_transform_type_complex_forward
+       && plan->transformType != rocfft_transform_type_complex_inverse)
+        return rocfft_status_invalid_arg_value;
+    if(plan->desc.inArrayType != rocfft_array_type_complex_interleaved)
+        return rocfft_status_invalid_arg_value;
+    if(plan->desc.comm_type != rocfft_comm_none || !plan->desc.inFields.empty()
+       || !plan->desc.outFields.empty())
+        return rocfft_status_invalid_arg_value;
+
+    // a frame window is applied by position within 1D frames, which
+    // only single-kernel Stockham plans pass to their loads
+    if(loadOps.frame_window)
+    {
+        if(plan->rank != 1 || plan->placement != rocfft_placement_notinplace
+           || !loadOps.valid_lengths.empty())
+            return rocfft_status_invalid_arg_value;
+        if(!function_pool::has_function(FMKey(plan->lengths.front(), plan->precision)))
+            return rocfft_status_invalid_dimensions;
+    }
+
+    if(!loadOps.valid_lengths.empty())
+    {
+        auto rcfft = check_sub_lengths(plan,
+                                       loadOps.valid_lengths,
+                                       plan->lengths,
+                                       plan->desc.inStrides,
+                                       plan->desc.inDist);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+    }
+
+    loadOps.set_layout(plan->desc.inStrides, plan->desc.inDist);
+    return rocfft_status_success;
+}
+
+// Verify that output truncation or pruning is usable with the rest
+// of the plan, and remember the output layout it needs.  Like the input padding,
+// this is done before the plan's dimensions are sorted.  The rest
+// of the plan is checked with the other ops that need exclusive use
+// of the output buffer.
+rocfft_status set_store_ops_layout(const rocfft_plan plan)
+{
+    auto& storeOps = plan->desc.storeOps;
+    if(storeOps.kept_lengths.empty())
+        return rocfft_status_success;
+
+    // the kept range is found from an element's offset in the
+    // output, which needs interleaved output
+    if(plan->desc.outArrayType != rocfft_array_type_complex_interleaved
+       && plan->desc.outArrayType != rocfft_array_type_hermitian_interleaved)
+        return rocfft_status_invalid_arg_value;
+    if(plan->desc.comm_type != rocfft_comm_none || !plan->desc.inFields.empty()
+       || !plan->desc.outFields.empty())
+        return rocfft_status_invalid_arg_value;
+
+    auto rcfft = check_sub_lengths(plan,
+                                   storeOps.kept_lengths,
+                                   plan->outputLengths,
+                                   plan->desc.outStrides,
+                                   plan->desc.outDist);
+    if(rcfft != rocfft_status_success)
+        return rcfft;
+    for(size_t i = 0; i < plan->rank; ++i)
+    {
+        if(storeOps.kept_starts[i] + storeOps.kept_lengths[i] > plan->outputLengths[i])
+            return rocfft_status_invalid_arg_value;
+    }
+
+    storeOps.set_layout(plan->desc.outStrides, plan->desc.outDist);
+    return rocfft_status_success;
+}
+
+// Verify that a real-to-real transform is one we can do.
+rocfft_status check_real_to_real_validity(const rocfft_plan plan)
+{
+    if(!transform_type_is_real_to_real(plan->transformType))
+        return rocfft_status_success;
+
+    // only 1D transforms whose complex FFT is a single kernel are
+    // implemented
+    if(plan->rank != 1)
+        return rocfft_status_invalid_dimensions;
+    if(plan->desc.comm_type != rocfft_comm_none || !plan->desc.inFields.empty()
+       || !plan->desc.outFields.empty())
+        return rocfft_status_invalid_arg_value;
+    // DCT-I needs at least two points to define its extension
+    if(plan->transformType == rocfft_transform_type_dct1 && plan->lengths.front() < 2)
+        return rocfft_status_invalid_dimensions;
+    auto fftLength = real_to_real_fft_length(plan->transformType, plan->lengths.front());
+    if(!function_pool::has_function(FMKey(fftLength, plan->precision)))
+        return rocfft_status_invalid_dimensions;
+    return rocfft_status_success;
+}
+
+rocfft_status check_batch_tile_validity(const rocfft_plan plan)
+{
+    const auto tile = plan->desc.batchTile;
+    if(tile == 1)
+        return rocfft_status_success;
+
+    // the batch must be made of whole tiles
+    if(plan->batch % tile != 0)
+        return rocfft_status_invalid_arg_value;
+    // bricks and real-to-real pre/post-processing assume each
+    // transform is contiguous in batch
+    if(plan->desc.comm_type != rocfft_comm_none || !plan->desc.inFields.empty()
+       || !plan->desc.outFields.empty() || !plan->desc.devices.empty()
+       || transform_type_is_real_to_real(plan->transformType))
+        return rocfft_status_invalid_arg_value;
+    return rocfft_status_success;
+}
+
+// Packed Hermitian data is produced and consumed by a kernel that
+// folds the Nyquist data into the first element.  Verify that the
+// plan is one that kernel can handle.
+rocfft_status check_packed_hermitian_validity(const rocfft_plan plan)
+{
+    if(!plan->desc.packedHermitian)
+        return rocfft_status_success;
+
+    if(plan->transformType != rocfft_transform_type_real_forward
+       && plan->transformType != rocfft_transform_type_real_inverse)
+        return rocfft_status_invalid_arg_value;
+    if(plan->rank > 3)
+        return rocfft_status_invalid_dimensions;
+    const auto hermArrayType = plan->transformType == rocfft_transform_type_real_forward
+                                   ? plan->desc.outArrayType
+                                   : plan->desc.inArrayType;
+    if(hermArrayType != rocfft_array_type_hermitian_interleaved)
+        return rocfft_status_invalid_array_type;
+    // pruning keeps ranges of bins, which the first packed element
+    // doesn't correspond to
+    if(plan->desc.comm_type != rocfft_comm_none || !plan->desc.inFields.empty()
+       || !plan->desc.outFields.empty() || !plan->desc.devices.empty()
+       || plan->desc.batchTile != 1 || !plan->desc.storeOps.kept_lengths.empty())
+        return rocfft_status_invalid_arg_value;
+    return rocfft_status_success;
+}
+
+// Transforms of rank greater than 3 are built from 3D transforms,
+// batched over the higher dimensions, and 1D transforms along each
+// higher dimension.  Verify that the plan is one we can build that
+// way.
+rocfft_status check_rank_validity(const rocfft_plan plan)
+{
+    if(plan->rank <= 3)
+        return rocfft_status_success;
+
+    // only complex transforms on a single device are implemented
+    if(plan->transformType != rocfft_transform_type_complex_forward
+       && plan->transformType != rocfft_transform_type_complex_inverse)
+        return rocfft_status_invalid_dimensions;
+    if(plan->desc.comm_type != rocfft_comm_none || !plan->desc.inFields.empty()
+       || !plan->desc.outFields.empty() || !plan->desc.devices.empty()
+       || plan->desc.batchTile != 1)
+        return rocfft_status_invalid_arg_value;
+
+    // the higher dimensions of the input or output must fold into
+    // the batch of the 3D transforms
+    if(!RCNDNode::HigherDimsFold(
+           plan->lengths, plan->desc.inStrides, plan->desc.inDist, plan->batch)
+       && !RCNDNode::HigherDimsFold(
+           plan->outputLengths, plan->desc.outStrides, plan->desc.outDist, plan->batch))
+        return rocfft_status_invalid_arg_value;
+    return rocfft_status_success;
+}
+
+rocfft_status check_input_alias_validity(const rocfft_plan plan)
+{
+    // out-of-place transforms may share input elements between
+    // transforms (e.g. overlapping sliding windows), since that
+    // input is only read.  in-place transforms would write shared
+    // elements while other transforms still need to read them.
+    if(plan->placement != rocfft_placement_inplace || !plan->desc.inFields.empty())
+        return rocfft_status_success;
+
+    auto length = plan->lengths;
+    auto stride = plan->desc.inStrides;
+    length.push_back(plan->batch);
+    stride.push_back(plan->desc.inDist);
+    return array_valid(length, stride) ? rocfft_status_success : rocfft_status_invalid_arg_value;
+}
+
+// Properties of the current device as a plan sees them.  A plan
+// confined to a CU mask treats the masked CUs as the whole device,
+// so that launch grids and solution lookup are sized for them.
+static hipDeviceProp_t plan_device_prop(const rocfft_plan_t& plan)
+{
+    auto prop = get_curr_device_prop();
+    if(!plan.desc.cuMask.empty())
+    {
+        int cus = 0;
+        for(auto word : plan.desc.cuMask)
+            cus += static_cast<int>(std::bitset<32>(word).count());
+        prop.multiProcessorCount = std::min(prop.multiProcessorCount, cus);
+    }
+    return prop;
+}
+
+// Given a rocfft_plan with validated parameters, set the transform parameters for the root of the
+// tree plan.
+void set_rootplan_params(const rocfft_plan plan, NodeMetaData& planData)
+{
+    planData.dimension = plan->rank;
+    planData.batch     = plan->batch;
+    for(size_t i = 0; i < plan->rank; i++)
+    {
         planData.length.push_back(plan->lengths[i]);
         planData.outputLength.push_back(plan->outputLengths[i]);
 
@@ -769,6 +1716,24 @@ void set_rootplan_params(const rocfft_plan plan, NodeMetaData& planData)
     planData.oDist     = plan->desc.outDist;
     planData.placement = plan->placement;
 
+    // Tiled batches interleave each tile's transforms element by
+    // element.  Describe the lane within a tile as an extra
+    // unit-stride data dimension, so the kernels see a tile as a
+    // contiguous group of batches and lanes are read coalesced.
+    const auto tile = plan->desc.batchTile;
+    if(tile > 1)
+    {
+        for(auto& s : planData.inStride)
+            s *= tile;
+        for(auto& s : planData.outStride)
+            s *= tile;
+        planData.length.push_back(tile);
+        planData.outputLength.push_back(tile);
+        planData.inStride.push_back(1);
+        planData.outStride.push_back(1);
+        planData.batch /= tile;
+    }
+
     // If in+out fields are specified, currently that means we're
     // gathering the data to one device and doing FFT there.  So
     // the FFT becomes in-place.
@@ -822,6 +1787,8 @@ void set_rootplan_params(const rocfft_plan plan, NodeMetaData& planData)
     planData.outArrayType = plan->desc.outArrayType;
     planData.rootIsC2C    = (planData.inArrayType != rocfft_array_type_real)
                          && (planData.outArrayType != rocfft_array_type_real);
+    if(transform_type_is_real_to_real(plan->transformType))
+        planData.r2rType = plan->transformType;
 }
 
 void set_bluestein_strides(const rocfft_plan plan, NodeMetaData& planData)
@@ -845,9 +1812,10 @@ void set_bluestein_strides(const rocfft_plan plan, NodeMetaData& planData)
     auto fftLength
         = transformType == rocfft_transform_type_real_inverse ? plan->outputLengths : plan->lengths;
 
-    lengthsBlue[0] = NodeFactory::SupportedLength(precision, fftLength[0])
-                         ? fftLength[0]
-                         : NodeFactory::GetBluesteinLength(precision, fftLength[0]);
+    lengthsBlue[0]
+        = NodeFactory::SupportedLength(precision, fftLength[0])
+              ? fftLength[0]
+              : NodeFactory::GetBluesteinLength(precision, fftLength[0], planData.deviceProp);
     for(size_t i = 1; i < dimension; i++)
         lengthsBlue[i] = fftLength[i];
 
@@ -954,7 +1922,9 @@ std::unique_ptr<ExecPlan> transpose_brick(int                        local_comm_
                                           BufferPtr                  outputPtr,
                                           size_t                     offsetOut,
                                           const std::vector<size_t>& strideOut,
-                                          std::string&&              description)
+                                          std::string&&              description,
+                                          rocfft_storage_format      inStorage,
+                                          rocfft_storage_format      outStorage)
 {
     auto      execPlanMultiItem = std::make_unique<ExecPlan>();
     ExecPlan& execPlan          = *execPlanMultiItem;
@@ -1030,6 +2000,11 @@ std::unique_ptr<ExecPlan> transpose_brick(int                        local_comm_
     execPlan.rootPlan->inArrayType  = arrayType;
     execPlan.rootPlan->outArrayType = arrayType;
 
+    // pack and unpack may convert to and from the format that data
+    // is exchanged in
+    execPlan.rootPlan->loadOps.storage  = inStorage;
+    execPlan.rootPlan->storeOps.storage = outStorage;
+
     execPlan.execSeq.push_back(execPlan.rootPlan.get());
 
     // only initialize the execPlan with kernels, twiddles, etcn if it
@@ -1144,9 +2119,21 @@ void rocfft_plan_t::AllocateInternalTempBuffers()
 
         t.second->alloc(t.first.device);
         if(LOG_PLAN_ENABLED())
-            *LogSingleton::GetInstance().GetPlanOS()
-                << "temp buffer " << t.second->data() << ", device " << t.first.device
-                << ", size_bytes " << t.second->get_size_bytes() << std::endl;
+        {
+            if(LOG_JSON_ENABLED())
+                log_json_arguments(*LogSingleton::GetInstance().GetPlanOS(),
+                                   "temp_buffer",
+                                   "ptr",
+                                   t.second->data(),
+                                   "device",
+                                   t.first.device,
+                                   "size_bytes",
+                                   t.second->get_size_bytes());
+            else
+                *LogSingleton::GetInstance().GetPlanOS()
+                    << "temp buffer " << t.second->data() << ", device " << t.first.device
+                    << ", size_bytes " << t.second->get_size_bytes() << std::endl;
+        }
     }
 }
 
@@ -1296,7 +2283,9 @@ std::vector<size_t> rocfft_plan_t::GatherBricksToField(rocfft_location_t current
                                                    BufferPtr::temp(gatherPackBufs.back().data()),
                                                    contiguousOffset,
                                                    brick.contiguous_strides(),
-                                                   std::move(description)),
+                                                   std::move(description),
+                                                   rocfft_storage_format_native,
+                                                   rocfft_storage_format_native),
                                    antecedents);
             AddAntecedent(gatherIdx, packIdx);
 
@@ -1326,7 +2315,9 @@ std::vector<size_t> rocfft_plan_t::GatherBricksToField(rocfft_location_t current
                                                  output,
                                                  brick.offset_in_field(field_stride),
                                                  field_stride,
-                                                 std::move(description)),
+                                                 std::move(description),
+                                                 rocfft_storage_format_native,
+                                                 rocfft_storage_format_native),
                                  {gatherIdx}));
         }
 
@@ -1421,7 +2412,9 @@ std::vector<size_t> rocfft_plan_t::ScatterFieldToBricks(rocfft_location_t
                                                             BufferPtr::temp(scatterSrcBuf->data()),
                                                             contiguousOffset,
                                                             brick.contiguous_strides(),
-                                                            std::move(description)),
+                                                            std::move(description),
+                                                            rocfft_storage_format_native,
+                                                            rocfft_storage_format_native),
                                             antecedents);
             AddAntecedent(scatterIdx, packIdx);
 
@@ -1460,7 +2453,9 @@ std::vector<size_t> rocfft_plan_t::ScatterFieldToBricks(rocfft_location_t
                                                      outputBufs[brickIdx],
                                                      0,
                                                      brick.stride,
-                                                     std::move(description)),
+                                                     std::move(description),
+                                                     rocfft_storage_format_native,
+                                                     rocfft_storage_format_native),
                                      {scatterIdx}));
             }
         }
@@ -1625,7 +2620,10 @@ static std::unique_ptr<ExecPlan> BuildSingleDevicePlan(NodeMetaData&         roo
                                                        rocfft_location_t     location,
                                                        rocfft_transform_type transformType,
                                                        LoadOps&              loadOps,
-                                                       StoreOps&             storeOps)
+                                                       StoreOps&             storeOps,
+                                                       rocfft_optimize_strategy assignOptStrategy,
+                                                       hipStream_t tableStream = nullptr,
+                                                       const PlanDecisions* restore = nullptr)
 {
     rocfft_scoped_device dev(location.device);
 
@@ -1633,9 +2631,17 @@ static std::unique_ptr<ExecPlan> BuildSingleDevicePlan(NodeMetaData&         roo
     ExecPlan& execPlan          = *execPlanMultiItem;
     try
     {
-        execPlan.location   = location;
-        execPlan.deviceProp = rootPlanData.deviceProp;
-        execPlan.rootPlan   = NodeFactory::CreateExplicitNode(rootPlanData, nullptr);
+        // frame windows are only applied by single Stockham kernels,
+        // and other ops were validated for the kernel the plan would
+        // otherwise use
+        rootPlanData.keepSingleKernel
+            = loadOps.frame_window || loadOps.enabled() || storeOps.enabled();
+
+        execPlan.location          = location;
+        execPlan.deviceProp        = rootPlanData.deviceProp;
+        execPlan.assignOptStrategy = assignOptStrategy;
+        rootPlanData.optStrategy   = assignOptStrategy;
+        execPlan.rootPlan          = NodeFactory::CreateExplicitNode(rootPlanData, nullptr);
 
         // TODO: some solutions require the problems to be unit_stride, otherwise the
         //   scheme-tree may not be applicable. In this case, we can't apply the solutions.
@@ -1644,7 +2650,18 @@ static std::unique_ptr<ExecPlan> BuildSingleDevicePlan(NodeMetaData&         roo
 
         // If we are doing tuning initialzing now, we shouldn't apply any solution,
         // since we are trying enumerating solutions now
-        if(TuningBenchmarker::GetSingleton().IsInitializingTuning() == false)
+        if(restore)
+        {
+            // replay the decisions recorded by rocfft_plan_serialize
+            execPlan.restore          = restore;
+            execPlan.rootScheme       = CopySchemeTree(*restore->scheme);
+            execPlan.solution_kernels = restore->solution_kernels;
+            execPlan.solutionNumCUs   = restore->solutionNumCUs;
+            execPlan.rootPlan         = nullptr;
+            execPlan.rootPlan         = NodeFactory::CreateExplicitNode(
+                rootPlanData, nullptr, execPlan.rootScheme->curScheme);
+        }
+        else if(TuningBenchmarker::GetSingleton().IsInitializingTuning() == false)
         {
             execPlan.rootScheme = ApplySolution(execPlan);
             if(execPlan.rootScheme)
@@ -1654,6 +2671,18 @@ static std::unique_ptr<ExecPlan> BuildSingleDevicePlan(NodeMetaData&         roo
                     rootPlanData, nullptr, execPlan.rootScheme->curScheme);
             }
         }
+        else
+        {
+            // plan-level tuning: build the root with the tree shape
+            // being tuned instead of the library's own choice
+            auto shapeScheme = SelectTreeShape(*execPlan.rootPlan);
+            if(shapeScheme != execPlan.rootPlan->scheme)
+            {
+                execPlan.rootPlan = nullptr;
+                execPlan.rootPlan
+                    = NodeFactory::CreateExplicitNode(rootPlanData, nullptr, shapeScheme);
+            }
+        }
 
         execPlan.iLength = rootPlanData.length;
         execPlan.oLength
@@ -1664,9 +2693,9 @@ static std::unique_ptr<ExecPlan> BuildSingleDevicePlan(NodeMetaData&         roo
         execPlan.rootPlan->outStrideUnit = BufferIsUnitStride(execPlan, OB_USER_OUT);
 
         // set load/store ops on the root plan
-        if(loadOps.enabled())
+        if(loadOps.enabled() || !loadOps.callback.empty())
             execPlan.rootPlan->loadOps = loadOps;
-        if(storeOps.enabled())
+        if(storeOps.enabled() || !storeOps.callback.empty() || storeOps.pass_callbacks)
             execPlan.rootPlan->storeOps = storeOps;
 
         // only allocate kernels, twiddles, etc if plan will run on this rank
@@ -1688,13 +2717,27 @@ static std::unique_ptr<ExecPlan> BuildSingleDevicePlan(NodeMetaData&         roo
 
         // Plan is compiled, no need to alloc twiddles + kargs etc
         if(rocfft_getenv("ROCFFT_INTERNAL_COMPILE_ONLY") == "1")
+        {
+            FinishRuntimeCompilePlan(execPlan);
             return execPlanMultiItem;
+        }
+
+        if(tableStream)
+            Repo::BeginTables(tableStream);
 
         if(!PlanPowX(execPlan)) // PlanPowX enqueues the GPU kernels by function
         {
             throw std::runtime_error("Unable to create execution plan.");
         }
 
+        // tuning benchmarks kernels by their position in the plan
+        if(!TuningBenchmarker::GetSingleton().IsProcessingTuning())
+            PrecomputeBluesteinChirps(execPlan);
+        ScheduleExecSeq(execPlan);
+        ScheduleSlabs(execPlan);
+
+        execPlan.tablesReady = Repo::EndTables(tableStream);
+
         // When running each solution during tuning, get the information to packet,
         // then we can dump the information to a table for analysis
         if(TuningBenchmarker::GetSingleton().IsProcessingTuning())
@@ -1716,44 +2759,58 @@ static std::unique_ptr<ExecPlan> BuildSingleDevicePlan(NodeMetaData&         roo
 // Transform (complex-complex FFT) one dimension of a brick, by
 // adding a multi-plan item to the rocfft_plan_t, and return the new
 // item's index.  A brick is on a single device and has the specified
-// length and stride.  Input and output may point to the same buffer.
+// length.  Input and output may point to the same buffer, in which
+// case their strides and offsets must match.
 //
 // The specified dimension is assumed to be contiguous on the brick.
 // Other dimensions (including batch) may have any length (including
 // length 1).
 //
+// The data starts inOffset and outOffset elements into input and
+// output, so that part of a brick can be transformed.  Storing
+// input and output with different strides lets the transform also
+// rearrange the brick, e.g. for an exchange that follows.
+//
 // Specified antecedent items are required to complete before this
 // new item will begin execution.
 //
-// NOTE: lengths and stride include batch dimension
+// NOTE: lengths and strides include batch dimension
 static size_t C2CBrickOneDimension(rocfft_plan_t&             plan,
                                    size_t                     dimIdx,
                                    rocfft_location_t          location,
                                    const std::vector<size_t>& lengths,
-                                   const std::vector<size_t>& stride,
+                                   const std::vector<size_t>& inStride,
+                                   size_t                     inOffset,
+                                   const std::vector<size_t>& outStride,
+                                   size_t                     outOffset,
                                    BufferPtr                  input,
                                    BufferPtr                  output,
                                    const std::vector<size_t>& antecedents)
 {
-    auto transformLengths = lengths;
-    auto transformStride  = stride;
+    auto transformLengths   = lengths;
+    auto transformInStride  = inStride;
+    auto transformOutStride = outStride;
 
     // move the dimension-we-want-to-transform to the front
     std::swap(transformLengths.front(), transformLengths[dimIdx]);
-    std::swap(transformStride.front(), transformStride[dimIdx]);
+    std::swap(transformInStride.front(), transformInStride[dimIdx]);
+    std::swap(transformOutStride.front(), transformOutStride[dimIdx]);
 
     NodeMetaData rootPlanData(nullptr);
 
     rootPlanData.batch = transformLengths.back();
-    rootPlanData.iDist = transformStride.back();
-    rootPlanData.oDist = transformStride.back();
+    rootPlanData.iDist = transformInStride.back();
+    rootPlanData.oDist = transformOutStride.back();
     transformLengths.pop_back();
-    transformStride.pop_back();
+    transformInStride.pop_back();
+    transformOutStride.pop_back();
 
     rootPlanData.dimension = 1;
     rootPlanData.length    = transformLengths;
-    rootPlanData.inStride  = transformStride;
-    rootPlanData.outStride = transformStride;
+    rootPlanData.inStride  = transformInStride;
+    rootPlanData.outStride = transformOutStride;
+    rootPlanData.iOffset   = inOffset;
+    rootPlanData.oOffset   = outOffset;
     rootPlanData.direction = plan.transformType == rocfft_transform_type_complex_forward
                                      || plan.transformType == rocfft_transform_type_real_forward
                                  ? -1
@@ -1763,58 +2820,159 @@ static size_t C2CBrickOneDimension(rocfft_plan_t&             plan,
     rootPlanData.precision    = plan.precision;
     rootPlanData.inArrayType  = rocfft_array_type_complex_interleaved;
     rootPlanData.outArrayType = rocfft_array_type_complex_interleaved;
-    rootPlanData.deviceProp   = get_curr_device_prop();
+    rootPlanData.deviceProp   = plan_device_prop(plan);
+
+    // the non-real dimensions of real-complex plans are also
+    // transformed here, as complex data
+    auto singlePlan       = BuildSingleDevicePlan(rootPlanData,
+                                            plan.get_local_comm_rank(),
+                                            location,
+                                            rootPlanData.direction == -1
+                                                ? rocfft_transform_type_complex_forward
+                                                : rocfft_transform_type_complex_inverse,
+                                            plan.desc.loadOps,
+                                            plan.desc.storeOps,
+                                            plan.desc.assignOptStrategy);
+    singlePlan->mgpuPlan  = true;
+    singlePlan->inputPtr  = input;
+    singlePlan->outputPtr = output;
+    return plan.AddMultiPlanItem(std::move(singlePlan), antecedents);
+}
+
+// Transform (real-complex FFT) the fastest dimension of a brick, by
+// adding a multi-plan item to the rocfft_plan_t, and return the new
+// item's index.  The real side of the transform is the plan's input
+// for forward transforms and its output for inverse transforms.
+// The brick is on a single device, has the specified (real) lengths,
+// and is stored with realStride on the real side and complexStride
+// on the complex side.
+//
+// Specified antecedent items are required to complete before this
+// new item will begin execution.
+//
+// NOTE: lengths and strides include batch dimension
+static size_t RealBrickFastestDimension(rocfft_plan_t&             plan,
+                                        rocfft_location_t          location,
+                                        const std::vector<size_t>& lengths,
+                                        const std::vector<size_t>& realStride,
+                                        const std::vector<size_t>& complexStride,
+                                        BufferPtr                  input,
+                                        BufferPtr                  output,
+                                        const std::vector<size_t>& antecedents)
+{
+    const bool forward = plan.transformType == rocfft_transform_type_real_forward;
+
+    auto realLengths       = lengths;
+    auto complexLengths    = lengths;
+    complexLengths.front() = lengths.front() / 2 + 1;
+    auto inStride          = forward ? realStride : complexStride;
+    auto outStride         = forward ? complexStride : realStride;
+
+    NodeMetaData rootPlanData(nullptr);
+
+    rootPlanData.batch = lengths.back();
+    rootPlanData.iDist = inStride.back();
+    rootPlanData.oDist = outStride.back();
+    realLengths.pop_back();
+    complexLengths.pop_back();
+    inStride.pop_back();
+    outStride.pop_back();
+
+    rootPlanData.dimension    = 1;
+    rootPlanData.length       = forward ? realLengths : complexLengths;
+    rootPlanData.outputLength = forward ? complexLengths : realLengths;
+    rootPlanData.inStride     = inStride;
+    rootPlanData.outStride    = outStride;
+    rootPlanData.direction    = forward ? -1 : 1;
+    rootPlanData.placement    = rocfft_placement_notinplace;
+    rootPlanData.precision    = plan.precision;
+    rootPlanData.inArrayType
+        = forward ? rocfft_array_type_real : rocfft_array_type_hermitian_interleaved;
+    rootPlanData.outArrayType
+        = forward ? rocfft_array_type_hermitian_interleaved : rocfft_array_type_real;
+    rootPlanData.deviceProp = plan_device_prop(plan);
 
     auto singlePlan       = BuildSingleDevicePlan(rootPlanData,
                                             plan.get_local_comm_rank(),
                                             location,
                                             plan.transformType,
                                             plan.desc.loadOps,
-                                            plan.desc.storeOps);
+                                            plan.desc.storeOps,
+                                            plan.desc.assignOptStrategy);
     singlePlan->mgpuPlan  = true;
     singlePlan->inputPtr  = input;
     singlePlan->outputPtr = output;
     return plan.AddMultiPlanItem(std::move(singlePlan), antecedents);
 }
 
-void rocfft_plan_t::C2CField(const rocfft_field_t&      field,
-                             const std::vector<size_t>& fftDims,
-                             std::vector<BufferPtr>&    input,
-                             std::vector<BufferPtr>&    output,
-                             const std::vector<size_t>& inputAntecedents,
-                             std::vector<size_t>&       outputItems)
+void rocfft_plan_t::C2CField(const rocfft_field_t&              field,
+                             const rocfft_field_t&              outField,
+                             const std::vector<size_t>&         fftDims,
+                             std::vector<BufferPtr>&            input,
+                             std::vector<BufferPtr>&            output,
+                             const std::vector<size_t>&         inputAntecedents,
+                             const std::vector<rocfft_brick_t>& inputRegions,
+                             const PipelineSlabs&               pipeline,
+                             std::vector<size_t>&               outputItems)
 {
-    outputItems.resize(field.bricks.size());
+    outputItems.clear();
+
+    // without knowing what each antecedent wrote, the whole brick
+    // has to wait for all of them
+    const size_t slabCount = inputRegions.empty() ? 1 : pipeline.count;
 
     for(size_t i = 0; i < field.bricks.size(); ++i)
     {
-        const auto& inBrick = field.bricks[i];
+        const auto& inBrick  = field.bricks[i];
+        const auto& outBrick = outField.bricks[i];
 
-        std::vector<size_t> antecedents;
-        BufferPtr           fftInput = input[i];
-        for(auto item : inputAntecedents)
+        for(size_t slabIdx = 0; slabIdx < slabCount; ++slabIdx)
         {
-            if(multiPlan[item]->WritesToBuffer(fftInput))
-                antecedents.push_back(item);
-        }
+            const auto   slab      = slabCount == 1 ? inBrick : pipeline.slab(inBrick, slabIdx);
+            const size_t slabStart = slab.lower[pipeline.dim] - inBrick.lower[pipeline.dim];
 
-        for(auto dimIdx : fftDims)
-        {
-            auto transformItem              = C2CBrickOneDimension(*this,
-                                                      dimIdx,
-                                                      inBrick.location,
-                                                      inBrick.length(),
-                                                      inBrick.stride,
-                                                      fftInput,
-                                                      output[i],
-                                                      antecedents);
-            multiPlan[transformItem]->group = "fft_dim_" + std::to_string(dimIdx);
-            multiPlan[transformItem]->description
-                = "FFT dim " + std::to_string(dimIdx) + " brick " + std::to_string(i);
-
-            antecedents    = {transformItem};
-            outputItems[i] = transformItem;
-            fftInput       = output[i];
+            std::vector<size_t> antecedents;
+            BufferPtr           fftInput = input[i];
+            for(size_t a = 0; a < inputAntecedents.size(); ++a)
+            {
+                auto item = inputAntecedents[a];
+                if(!multiPlan[item]->WritesToBuffer(fftInput))
+                    continue;
+                if(!inputRegions.empty() && inputRegions[a].intersect(slab).empty())
+                    continue;
+                if(std::find(antecedents.begin(), antecedents.end(), item) == antecedents.end())
+                    antecedents.push_back(item);
+            }
+
+            // the first dimension reads the input layout, the rest
+            // are in-place on the output
+            const std::vector<size_t>* fftInStride = &inBrick.stride;
+            size_t                     lastItem    = 0;
+            for(auto dimIdx : fftDims)
+            {
+                auto transformItem              = C2CBrickOneDimension(*this,
+                                                          dimIdx,
+                                                          inBrick.location,
+                                                          slab.length(),
+                                                          *fftInStride,
+                                                          slabStart * (*fftInStride)[pipeline.dim],
+                                                          outBrick.stride,
+                                                          slabStart * outBrick.stride[pipeline.dim],
+                                                          fftInput,
+                                                          output[i],
+                                                          antecedents);
+                multiPlan[transformItem]->group = "fft_dim_" + std::to_string(dimIdx);
+                multiPlan[transformItem]->description
+                    = "FFT dim " + std::to_string(dimIdx) + " brick " + std::to_string(i);
+                if(slabCount > 1)
+                    multiPlan[transformItem]->description += " slab " + std::to_string(slabIdx);
+
+                antecedents = {transformItem};
+                lastItem    = transformItem;
+                fftInput    = output[i];
+                fftInStride = &outBrick.stride;
+            }
+            outputItems.push_back(lastItem);
         }
     }
 }
@@ -1878,167 +3036,1260 @@ static rocfft_field_t MakeFieldDimContiguous(const rocfft_field_t&      field,
     return out;
 }
 
-void rocfft_plan_t::GlobalTranspose(size_t                     elem_size,
-                                    const rocfft_field_t&      inField,
-                                    const rocfft_field_t&      outField,
-                                    std::vector<BufferPtr>&    input,
-                                    std::vector<BufferPtr>&    output,
-                                    const std::vector<size_t>& inputAntecedents,
-                                    std::vector<size_t>&       outputItems,
-                                    size_t                     transposeNumber)
+// Give the regions of a field's bricks to other bricks so that the
+// data exchanged with the previous layout stays on its device or
+// moves over the fastest links.  Each brick keeps its location.
+// Starting from the bricks' own regions, pairs of bricks swap
+// regions for as long as that lowers the total cost of the
+// exchange.
+static void PlaceBricksForLinks(rocfft_field_t& field, const rocfft_field_t& prevField)
 {
-    std::string                  itemGroup = "transpose_" + std::to_string(transposeNumber);
-    std::vector<TempBufferLease> packBufs;
-
-    const auto local_comm_rank = get_local_comm_rank();
+    const auto&  links = LinkTopology::Local();
+    const size_t count = field.bricks.size();
 
-    // loop over each input brick, finding the intersection of it with
-    // every output brick
-    for(size_t inBrickIdx = 0; inBrickIdx < inField.bricks.size(); ++inBrickIdx)
+    // cost[r][b] of moving the data for brick r's region to brick b
+    std::vector<std::vector<double>> cost(count, std::vector<double>(count, 0.0));
+    for(size_t r = 0; r < count; ++r)
     {
-        const auto& inBrick = inField.bricks[inBrickIdx];
-        for(size_t outBrickIdx = 0; outBrickIdx < outField.bricks.size(); ++outBrickIdx)
+        for(const auto& prevBrick : prevField.bricks)
         {
-            const auto& outBrick = outField.bricks[outBrickIdx];
-
-            auto intersection = inBrick.intersect(outBrick);
-            if(intersection.empty())
+            const auto elems = field.bricks[r].intersect(prevBrick).count_elems();
+            if(elems == 0)
                 continue;
-            intersection.stride = intersection.contiguous_strides();
+            for(size_t b = 0; b < count; ++b)
+                cost[r][b] += elems * links.Cost(prevBrick.location, field.bricks[b].location);
+        }
+    }
 
-            // pack data for communication
-            packBufs.reserve(packBufs.size() + 2);
-            TempBufferLease& pack = packBufs.emplace_back(tempBuffers,
-                                                          local_comm_rank,
-                                                          inBrick.location,
-                                                          intersection.count_elems(),
-                                                          elem_size);
-            TempBufferLease& recv = packBufs.emplace_back(tempBuffers,
-                                                          local_comm_rank,
-                                                          outBrick.location,
-                                                          intersection.count_elems(),
-                                                          elem_size);
-            auto             packIdx
-                = AddMultiPlanItem(transpose_brick(local_comm_rank,
-                                                   inBrick.location,
-                                                   intersection.length(),
-                                                   precision,
-                                                   desc.inArrayType,
-                                                   input[inBrickIdx],
-                                                   intersection.offset_in_field(inBrick.stride)
-                                                       - inBrick.offset_in_field(inBrick.stride),
-                                                   inBrick.stride,
-                                                   BufferPtr::temp(pack.data()),
-                                                   0,
-                                                   intersection.stride,
-                                                   "pack brick for global transpose"),
-                                   {inputAntecedents[inBrickIdx]});
-            multiPlan[packIdx]->group = itemGroup;
-            multiPlan[packIdx]->description
-                = "pack " + std::to_string(inBrickIdx) + " + " + std::to_string(outBrickIdx);
-
-            // send packed data
-            auto sendOp          = std::make_unique<CommPointToPoint>();
-            sendOp->precision    = precision;
-            sendOp->arrayType    = desc.inArrayType;
-            sendOp->numElems     = intersection.count_elems();
-            sendOp->srcLocation  = inBrick.location;
-            sendOp->srcPtr       = BufferPtr::temp(pack.data());
-            sendOp->destLocation = outBrick.location;
-            sendOp->destPtr      = BufferPtr::temp(recv.data());
-
-            auto sendIdx              = AddMultiPlanItem(std::move(sendOp), {packIdx});
-            multiPlan[sendIdx]->group = itemGroup;
-            multiPlan[sendIdx]->description
-                = "send " + std::to_string(inBrickIdx) + " + " + std::to_string(outBrickIdx);
-
-            // unpack data on destination to output
-            auto unpackIdx
-                = AddMultiPlanItem(transpose_brick(local_comm_rank,
-                                                   outBrick.location,
-                                                   intersection.length(),
-                                                   precision,
-                                                   desc.inArrayType,
-                                                   BufferPtr::temp(recv.data()),
-                                                   0,
-                                                   intersection.stride,
-                                                   output[outBrickIdx],
-                                                   intersection.offset_in_field(outBrick.stride)
-                                                       - outBrick.offset_in_field(outBrick.stride),
-                                                   outBrick.stride,
-                                                   "unpack brick for global transpose"),
-                                   {sendIdx});
-            multiPlan[unpackIdx]->group = itemGroup;
-            multiPlan[unpackIdx]->description
-                = "unpack " + std::to_string(inBrickIdx) + " + " + std::to_string(outBrickIdx);
-            outputItems.push_back(unpackIdx);
+    // region[b] is the region that brick b takes
+    std::vector<size_t> region(count);
+    std::iota(region.begin(), region.end(), 0);
+    for(bool improved = true; improved;)
+    {
+        improved = false;
+        for(size_t a = 0; a < count; ++a)
+        {
+            for(size_t b = a + 1; b < count; ++b)
+            {
+                if(cost[region[a]][b] + cost[region[b]][a]
+                   < cost[region[a]][a] + cost[region[b]][b])
+                {
+                    std::swap(region[a], region[b]);
+                    improved = true;
+                }
+            }
         }
     }
+
+    const auto regions = field.bricks;
+    for(size_t b = 0; b < count; ++b)
+    {
+        auto& brick  = field.bricks[b];
+        brick.lower  = regions[region[b]].lower;
+        brick.upper  = regions[region[b]].upper;
+        brick.stride = regions[region[b]].stride;
+    }
 }
 
-bool rocfft_plan_t::BuildOptMultiDevicePlan()
+// Return a layout that makes dimension dimIdx contiguous by
+// rotating a pencil decomposition: the way bricks divide dimIdx is
+// moved onto wholeDim, which no brick may divide.  Each brick keeps
+// its device and its coordinates in all other dimensions, so data
+// only moves between bricks in the same row of the brick grid -
+// sqrt(P) bricks when P bricks form a square grid over two
+// dimensions, instead of all P bricks for a slab re-split.
+//
+// Returns nothing if the bricks don't divide dimIdx into a single
+// partition, or wholeDim is split or too short to take it over.
+static std::optional<rocfft_field_t> RotatePencils(const rocfft_field_t&      field,
+                                                   const std::vector<size_t>& length,
+                                                   size_t                     dimIdx,
+                                                   size_t                     wholeDim)
 {
-    const auto local_comm_rank = get_local_comm_rank();
+    // distinct pieces of dimIdx that bricks cover must tile it
+    std::vector<std::pair<size_t, size_t>> pieces;
+    for(const auto& b : field.bricks)
+    {
+        if(b.lower[wholeDim] != 0 || b.upper[wholeDim] != length[wholeDim])
+            return {};
+        pieces.emplace_back(b.lower[dimIdx], b.upper[dimIdx]);
+    }
+    std::sort(pieces.begin(), pieces.end());
+    pieces.erase(std::unique(pieces.begin(), pieces.end()), pieces.end());
+    if(pieces.front().first != 0 || pieces.back().second != length[dimIdx]
+       || pieces.size() > length[wholeDim])
+        return {};
+    for(size_t i = 1; i < pieces.size(); ++i)
+    {
+        if(pieces[i].first != pieces[i - 1].second)
+            return {};
+    }
 
-    // keep track of how many transposes we've done so we can log
-    // distinct messages about each one
-    size_t transposeNumber = 0;
+    rocfft_field_t out = field;
+    for(auto& b : out.bricks)
+    {
+        const size_t piece = std::lower_bound(pieces.begin(),
+                                              pieces.end(),
+                                              std::make_pair(b.lower[dimIdx], b.upper[dimIdx]))
+                             - pieces.begin();
+
+        b.lower[dimIdx]   = 0;
+        b.upper[dimIdx]   = length[dimIdx];
+        b.lower[wholeDim] = length[wholeDim] / pieces.size() * piece;
+        b.upper[wholeDim] = piece == pieces.size() - 1
+                                ? length[wholeDim]
+                                : length[wholeDim] / pieces.size() * (piece + 1);
+
+        // contiguous dim has stride 1, the rest follow in order
+        const auto brickLength = b.length();
+        size_t     dist        = 1;
+        b.stride[dimIdx]       = dist;
+        dist *= brickLength[dimIdx];
+        for(size_t s = 0; s < b.stride.size(); ++s)
+        {
+            if(s == dimIdx)
+                continue;
+            b.stride[s] = dist;
+            dist *= brickLength[s];
+        }
+    }
+    return out;
+}
 
-    // currently, can only optimize c2c
-    if(transformType != rocfft_transform_type_complex_forward
-       && transformType != rocfft_transform_type_complex_inverse)
+// Return dense strides for a piece of a brick, with the piece's
+// dimensions in the same order in memory as the brick's.
+static std::vector<size_t> PieceStridesInBrickOrder(const rocfft_brick_t& piece,
+                                                    const rocfft_brick_t& brick)
+{
+    std::vector<size_t> order(brick.stride.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&brick](size_t a, size_t b) {
+        return brick.stride[a] < brick.stride[b];
+    });
+
+    const auto          length = piece.length();
+    std::vector<size_t> ret(order.size());
+    size_t              dist = 1;
+    for(auto d : order)
+    {
+        ret[d] = dist;
+        dist *= length[d];
+    }
+    return ret;
+}
+
+// Check if a piece of a brick is stored in the brick exactly as it
+// would be in a separate buffer with pieceStride, so it can be sent
+// or received in place.
+static bool PieceContiguousInBrick(const rocfft_brick_t&      piece,
+                                   const std::vector<size_t>& pieceStride,
+                                   const rocfft_brick_t&      brick)
+{
+    const auto length = piece.length();
+    for(size_t d = 0; d < length.size(); ++d)
+    {
+        if(length[d] > 1 && brick.stride[d] != pieceStride[d])
+            return false;
+    }
+    return true;
+}
+
+// Return the one dimension that another field's bricks split a brick
+// along, if there is exactly one.
+static std::optional<size_t> SplitDimension(const rocfft_brick_t& brick,
+                                            const rocfft_field_t& other)
+{
+    std::optional<size_t> ret;
+    for(const auto& o : other.bricks)
+    {
+        const auto intersection = brick.intersect(o);
+        if(intersection.empty())
+            continue;
+        for(size_t d = 0; d < brick.lower.size(); ++d)
+        {
+            if(intersection.lower[d] == brick.lower[d] && intersection.upper[d] == brick.upper[d])
+                continue;
+            if(ret && *ret != d)
+                return {};
+            ret = d;
+        }
+    }
+    return ret;
+}
+
+// Lay out the bricks of a temporary field so that the pieces it
+// exchanges with another field are contiguous in them, and are sent
+// or received in place instead of being packed separately.  The
+// transforms before and after the exchange write and read the
+// brick with these strides.
+//
+// Each brick is stored densely with the dimension the other field
+// splits it along slowest.  Only one side of an exchange can
+// transfer in place, since the exchange also reorders the data, and
+// the sending side goes first.  So sending to sendTo is preferred,
+// then receiving from recvFrom.  Bricks that neither field splits
+// along exactly one dimension keep their layout.
+static void LayoutForExchange(rocfft_field_t&       field,
+                              const rocfft_field_t* sendTo,
+                              const rocfft_field_t* recvFrom)
+{
+    for(auto& b : field.bricks)
+    {
+        std::optional<size_t> slowDim;
+        if(sendTo)
+            slowDim = SplitDimension(b, *sendTo);
+        if(!slowDim && recvFrom)
+            slowDim = SplitDimension(b, *recvFrom);
+        if(!slowDim)
+            continue;
+
+        const auto length = b.length();
+        size_t     dist   = 1;
+        for(size_t d = 0; d < length.size(); ++d)
+        {
+            if(d == *slowDim)
+                continue;
+            b.stride[d] = dist;
+            dist *= length[d];
+        }
+        b.stride[*slowDim] = dist;
+    }
+}
+
+// Choose how to split a field's bricks into pipeline slabs, for FFTs
+// along fftDims.  Slabs are along the slowest dimension that the
+// FFTs don't run along, and aren't too small to be worth separate
+// exchanges and kernel launches.  Length includes batch dimension.
+//
+// preferDim is tried first if given.  Exchanges sent in place are
+// split along the sending bricks' slowest dimension, so slabs along
+// it stay contiguous on that side.
+static PipelineSlabs ChoosePipeline(const rocfft_field_t&      field,
+                                    const std::vector<size_t>& fftDims,
+                                    size_t                     elem_size,
+                                    std::optional<size_t>      preferDim = {})
+{
+    static const size_t maxPipelineSlabs     = 4;
+    static const size_t minPipelineSlabBytes = 4 * 1024 * 1024;
+
+    PipelineSlabs ret;
+    if(field.bricks.empty())
+        return ret;
+
+    size_t minBrickBytes = std::numeric_limits<size_t>::max();
+    for(const auto& b : field.bricks)
+        minBrickBytes = std::min(minBrickBytes, b.count_elems() * elem_size);
+    const size_t maxSlabs
+        = std::min(maxPipelineSlabs, std::max<size_t>(minBrickBytes / minPipelineSlabBytes, 1));
+    if(maxSlabs == 1)
+        return ret;
+
+    std::vector<size_t> candidates;
+    if(preferDim)
+        candidates.push_back(*preferDim);
+    for(size_t dim = field.bricks.front().lower.size(); dim-- > 0;)
+        candidates.push_back(dim);
+    for(auto dim : candidates)
+    {
+        if(std::find(fftDims.begin(), fftDims.end(), dim) != fftDims.end())
+            continue;
+        size_t minLength = std::numeric_limits<size_t>::max();
+        for(const auto& b : field.bricks)
+            minLength = std::min(minLength, b.upper[dim] - b.lower[dim]);
+        if(minLength > 1)
+        {
+            ret.dim   = dim;
+            ret.count = std::min(maxSlabs, minLength);
+            break;
+        }
+    }
+    return ret;
+}
+
+// Return the layout of a field's complex data on the other side of
+// a real-complex transform along the fastest dimension, which must
+// not be split in the field.  Bricks stay on the same devices and
+// cover the same coordinates in the other dimensions, with
+// contiguous strides.
+static rocfft_field_t MakeHermitianField(const rocfft_field_t& realField, size_t hermitianLength)
+{
+    rocfft_field_t out = realField;
+    for(auto& b : out.bricks)
+    {
+        b.upper.front() = hermitianLength;
+        b.stride        = b.contiguous_strides();
+    }
+    return out;
+}
+
+// Choose how plans given a device list divide their input and
+// output into contiguous bricks on those devices.  Problems with at
+// least one batch per device are divided along the batch, so each
+// device transforms whole problems.  Otherwise the input is divided
+// along its slowest dimension and the output along its fastest, so
+// one exchange makes the rest of the dimensions contiguous.  Real
+// inverse transforms are divided the other way around, since their
+// real output can't be split along the fastest dimension.
+//
+// Returns false if the data can't be divided over at least two
+// devices.
+static bool DistributeOverDevices(const std::vector<int>&    devices,
+                                  const std::vector<size_t>& inLengths,
+                                  const std::vector<size_t>& outLengths,
+                                  bool                       realInverse,
+                                  rocfft_field_t&            inField,
+                                  rocfft_field_t&            outField)
+{
+    // lengths include the batch as their last dimension
+    const size_t rank  = inLengths.size() - 1;
+    const size_t batch = inLengths.back();
+
+    size_t inDim  = rank;
+    size_t outDim = rank;
+    if(batch < devices.size() && rank > 1)
+    {
+        inDim  = realInverse ? 0 : rank - 1;
+        outDim = realInverse ? rank - 1 : 0;
+    }
+    const size_t count = std::min({devices.size(), inLengths[inDim], outLengths[outDim]});
+    if(count < 2)
         return false;
 
-    // must be out-of-place so that we don't have to worry about
-    // overwriting an input before everything's done reading
-    if(placement == rocfft_placement_inplace)
+    auto divide = [&](const std::vector<size_t>& length, size_t dim) {
+        rocfft_field_t field;
+        for(size_t i = 0; i < count; ++i)
+        {
+            rocfft_brick_t brick;
+            brick.lower.assign(length.size(), 0);
+            brick.upper      = length;
+            brick.lower[dim] = length[dim] * i / count;
+            brick.upper[dim] = length[dim] * (i + 1) / count;
+            brick.stride     = brick.contiguous_strides();
+            brick.location   = rocfft_location_t(0, devices[i]);
+            field.bricks.push_back(std::move(brick));
+        }
+        return field;
+    };
+    inField  = divide(inLengths, inDim);
+    outField = divide(outLengths, outDim);
+    return true;
+}
+
+void rocfft_plan_t::GlobalTranspose(rocfft_array_type            arrayType,
+                                    const rocfft_field_t&        inField,
+                                    const rocfft_field_t&        outField,
+                                    std::vector<BufferPtr>&      input,
+                                    std::vector<BufferPtr>&      output,
+                                    const std::vector<size_t>&   inputAntecedents,
+                                    const std::vector<size_t>&   outputAntecedents,
+                                    const PipelineSlabs&         pipeline,
+                                    std::vector<size_t>&         outputItems,
+                                    std::vector<rocfft_brick_t>& outputRegions,
+                                    size_t                       transposeNumber)
+{
+    // a single collective needs far fewer messages than point-to-point
+    // exchanges between every pair of bricks, but can't be staged in
+    // chunks
+    if(desc.comm_type != rocfft_comm_none && desc.exchangeChunkBytes == 0
+       && AllToAllTranspose(arrayType,
+                            inField,
+                            outField,
+                            input,
+                            output,
+                            inputAntecedents,
+                            outputAntecedents,
+                            pipeline,
+                            outputItems,
+                            outputRegions,
+                            transposeNumber))
+        return;
+
+    std::string                  itemGroup = "transpose_" + std::to_string(transposeNumber);
+    std::vector<TempBufferLease> packBufs;
+    const auto                   storage    = desc.exchangeStorage;
+    const auto                   elem_size  = storage_element_size(storage, precision, arrayType);
+    const size_t                 chunkElems = desc.exchangeChunkBytes / elem_size;
+    const bool                   native     = storage == rocfft_storage_format_native;
+
+    const auto  local_comm_rank = get_local_comm_rank();
+    const auto& links           = LinkTopology::Local();
+
+    // last send from each location over a link that's shared with
+    // other devices
+    std::map<rocfft_location_t, size_t> lastSharedSend;
+
+    // loop over each input brick, finding the intersection of it with
+    // every output brick
+    for(size_t inBrickIdx = 0; inBrickIdx < inField.bricks.size(); ++inBrickIdx)
+    {
+        const auto& inBrick = inField.bricks[inBrickIdx];
+
+        // packing waits for whatever wrote the input brick
+        std::vector<size_t> inBrickAntecedents;
+        for(auto item : inputAntecedents)
+        {
+            if(multiPlan[item]->WritesToBuffer(input[inBrickIdx]))
+                inBrickAntecedents.push_back(item);
+        }
+
+        // visit output bricks in rounds starting from the one at the
+        // same index, so that the input bricks send to different
+        // output bricks at once instead of all to the same one
+        for(size_t round = 0; round < outField.bricks.size(); ++round)
+        {
+            const size_t outBrickIdx = (inBrickIdx + round) % outField.bricks.size();
+            const auto&  outBrick    = outField.bricks[outBrickIdx];
+
+            auto intersection = inBrick.intersect(outBrick);
+            if(intersection.empty())
+                continue;
+
+            // copies within a rank over links that other devices'
+            // transfers also use go one at a time from each source,
+            // so they don't compete for the link
+            const bool sharedLink = inBrick.location.comm_rank == outBrick.location.comm_rank
+                                    && !links.Dedicated(inBrick.location, outBrick.location);
+
+            // split the exchange along the output brick's pipeline
+            // slabs, and then into pieces along the slowest
+            // dimension that's longer than 1, each no bigger than the
+            // chunk size if one is set
+            std::vector<rocfft_brick_t> pieces;
+            size_t                      maxPieceElems = 0;
+            for(size_t slabIdx = 0; slabIdx < pipeline.count; ++slabIdx)
+            {
+                const auto slabPart = intersection.intersect(pipeline.slab(outBrick, slabIdx));
+                if(slabPart.empty())
+                    continue;
+
+                const auto slabLength = slabPart.length();
+                size_t     slowDim    = slabLength.size() - 1;
+                while(slowDim > 0 && slabLength[slowDim] == 1)
+                    --slowDim;
+                const size_t sliceElems     = slabPart.count_elems() / slabLength[slowDim];
+                size_t       slicesPerPiece = slabLength[slowDim];
+                if(chunkElems)
+                    slicesPerPiece
+                        = std::clamp<size_t>(chunkElems / sliceElems, 1, slicesPerPiece);
+
+                for(size_t start = 0; start < slabLength[slowDim]; start += slicesPerPiece)
+                {
+                    auto& piece = pieces.emplace_back(slabPart);
+                    piece.lower[slowDim] += start;
+                    piece.upper[slowDim]
+                        = std::min(piece.lower[slowDim] + slicesPerPiece, slabPart.upper[slowDim]);
+                    piece.stride  = piece.contiguous_strides();
+                    maxPieceElems = std::max(maxPieceElems, piece.count_elems());
+                }
+            }
+
+            // if the chunk size bounds staging memory, pieces reuse
+            // the same staging buffers one after another.  Otherwise
+            // each piece gets its own, so pieces can be in flight at
+            // the same time.
+            const bool reuseStaging = chunkElems != 0;
+
+            BufferPtr             packPtr;
+            BufferPtr             recvPtr;
+            std::optional<size_t> prevSendIdx;
+            std::optional<size_t> prevUnpackIdx;
+            for(size_t pieceIdx = 0; pieceIdx < pieces.size(); ++pieceIdx)
+            {
+                auto& piece = pieces[pieceIdx];
+
+                // stage the piece in the same order as one of the
+                // bricks if it's contiguous there, so that side can
+                // send or receive it in place without a separate
+                // pack or unpack.  Data that's exchanged in another
+                // format is always converted by a pack and unpack.
+                const auto inOrderStride  = PieceStridesInBrickOrder(piece, inBrick);
+                const auto outOrderStride = PieceStridesInBrickOrder(piece, outBrick);
+                if(PieceContiguousInBrick(piece, inOrderStride, inBrick))
+                    piece.stride = inOrderStride;
+                else if(PieceContiguousInBrick(piece, outOrderStride, outBrick))
+                    piece.stride = outOrderStride;
+                const bool   sendInPlace
+                    = native && PieceContiguousInBrick(piece, piece.stride, inBrick);
+                const bool   recvInPlace
+                    = native && PieceContiguousInBrick(piece, piece.stride, outBrick);
+                const size_t inOffset    = piece.offset_in_field(inBrick.stride)
+                                           - inBrick.offset_in_field(inBrick.stride);
+                const size_t outOffset   = piece.offset_in_field(outBrick.stride)
+                                           - outBrick.offset_in_field(outBrick.stride);
+
+                const size_t stagingElems = reuseStaging ? maxPieceElems : piece.count_elems();
+                auto         leaseStaging = [&](const rocfft_location_t& location) {
+                    packBufs.emplace_back(
+                        tempBuffers, local_comm_rank, location, stagingElems, elem_size);
+                    return BufferPtr::temp(packBufs.back().data());
+                };
+                if(!sendInPlace && (!reuseStaging || !packPtr))
+                    packPtr = leaseStaging(inBrick.location);
+                if(!recvInPlace && (!reuseStaging || !recvPtr))
+                    recvPtr = leaseStaging(outBrick.location);
+
+                std::string pieceName
+                    = std::to_string(inBrickIdx) + " + " + std::to_string(outBrickIdx);
+                if(pieces.size() > 1)
+                    pieceName += " piece " + std::to_string(pieceIdx);
+
+                // send the piece, once the previous piece is
+                // unpacked from the receive buffer
+                auto sendOp          = std::make_unique<CommPointToPoint>();
+                sendOp->precision    = precision;
+                sendOp->arrayType    = arrayType;
+                sendOp->storage      = storage;
+                sendOp->numElems     = piece.count_elems();
+                sendOp->srcLocation  = inBrick.location;
+                sendOp->destLocation = outBrick.location;
+
+                std::vector<size_t> sendAntecedents;
+                if(sendInPlace)
+                {
+                    sendOp->srcPtr    = input[inBrickIdx];
+                    sendOp->srcOffset = inOffset;
+                    sendAntecedents   = inBrickAntecedents;
+                }
+                else
+                {
+                    // the previous piece must be sent before its
+                    // staging buffer is overwritten
+                    std::vector<size_t> packAntecedents = inBrickAntecedents;
+                    if(prevSendIdx)
+                        packAntecedents.push_back(*prevSendIdx);
+                    auto packIdx = AddMultiPlanItem(
+                        transpose_brick(local_comm_rank,
+                                        inBrick.location,
+                                        piece.length(),
+                                        precision,
+                                        arrayType,
+                                        input[inBrickIdx],
+                                        inOffset,
+                                        inBrick.stride,
+                                        packPtr,
+                                        0,
+                                        piece.stride,
+                                        "pack brick for global transpose",
+                                        rocfft_storage_format_native,
+                                        storage),
+                        packAntecedents);
+                    multiPlan[packIdx]->group       = itemGroup;
+                    multiPlan[packIdx]->description = "pack " + pieceName;
+
+                    sendOp->srcPtr  = packPtr;
+                    sendAntecedents = {packIdx};
+                }
+                if(recvInPlace)
+                {
+                    sendOp->destPtr    = output[outBrickIdx];
+                    sendOp->destOffset = outOffset;
+                    if(!outputAntecedents.empty())
+                        sendAntecedents.push_back(outputAntecedents[outBrickIdx]);
+                }
+                else
+                    sendOp->destPtr = recvPtr;
+                if(prevUnpackIdx)
+                    sendAntecedents.push_back(*prevUnpackIdx);
+                auto lastSend = lastSharedSend.find(inBrick.location);
+                if(sharedLink && lastSend != lastSharedSend.end())
+                    sendAntecedents.push_back(lastSend->second);
+
+                auto sendIdx = AddMultiPlanItem(std::move(sendOp), sendAntecedents);
+                multiPlan[sendIdx]->group       = itemGroup;
+                multiPlan[sendIdx]->description = "send " + pieceName;
+                if(sharedLink)
+                    lastSharedSend[inBrick.location] = sendIdx;
+                if(reuseStaging && !sendInPlace)
+                    prevSendIdx = sendIdx;
+
+                if(recvInPlace)
+                {
+                    outputItems.push_back(sendIdx);
+                    outputRegions.push_back(piece);
+                    continue;
+                }
+
+                // unpack data on destination to output
+                std::vector<size_t> unpackAntecedents = {sendIdx};
+                if(!outputAntecedents.empty())
+                    unpackAntecedents.push_back(outputAntecedents[outBrickIdx]);
+                auto unpackIdx = AddMultiPlanItem(
+                    transpose_brick(local_comm_rank,
+                                    outBrick.location,
+                                    piece.length(),
+                                    precision,
+                                    arrayType,
+                                    recvPtr,
+                                    0,
+                                    piece.stride,
+                                    output[outBrickIdx],
+                                    outOffset,
+                                    outBrick.stride,
+                                    "unpack brick for global transpose",
+                                    storage,
+                                    rocfft_storage_format_native),
+                    unpackAntecedents);
+                multiPlan[unpackIdx]->group       = itemGroup;
+                multiPlan[unpackIdx]->description = "unpack " + pieceName;
+                outputItems.push_back(unpackIdx);
+                outputRegions.push_back(piece);
+
+                if(reuseStaging)
+                    prevUnpackIdx = unpackIdx;
+            }
+        }
+    }
+}
+
+bool rocfft_plan_t::AllToAllTranspose(rocfft_array_type            arrayType,
+                                      const rocfft_field_t&        inField,
+                                      const rocfft_field_t&        outField,
+                                      std::vector<BufferPtr>&      input,
+                                      std::vector<BufferPtr>&      output,
+                                      const std::vector<size_t>&   inputAntecedents,
+                                      const std::vector<size_t>&   outputAntecedents,
+                                      const PipelineSlabs&         pipeline,
+                                      std::vector<size_t>&         outputItems,
+                                      std::vector<rocfft_brick_t>& outputRegions,
+                                      size_t                       transposeNumber)
+{
+    const auto   local_comm_rank = get_local_comm_rank();
+    const size_t commSize        = get_local_comm_size();
+
+    // find the one brick each rank has in a field
+    auto brickPerRank = [commSize](const rocfft_field_t& field) {
+        std::vector<size_t> brickIdx(commSize, std::numeric_limits<size_t>::max());
+        if(field.bricks.size() != commSize)
+            return std::vector<size_t>();
+        for(size_t i = 0; i < field.bricks.size(); ++i)
+        {
+            auto rank = static_cast<size_t>(field.bricks[i].location.comm_rank);
+            if(rank >= commSize || brickIdx[rank] != std::numeric_limits<size_t>::max())
+                return std::vector<size_t>();
+            brickIdx[rank] = i;
+        }
+        return brickIdx;
+    };
+    const auto inBrickOfRank  = brickPerRank(inField);
+    const auto outBrickOfRank = brickPerRank(outField);
+    if(inBrickOfRank.empty() || outBrickOfRank.empty())
         return false;
 
+    // one collective per pipeline slab of the output bricks.  Work
+    // out all of them before adding any work items, in case they
+    // can't be done.
+    //
+    struct SlabExchange
+    {
+        std::unique_ptr<CommAllToAll> exchange;
+        // intersections[src][dest] is between each source rank's
+        // input brick and the slab of each destination rank's output
+        // brick
+        std::vector<std::vector<rocfft_brick_t>> intersections;
+        // ranks that send from their input brick or receive into
+        // their output brick in place, without packing
+        std::vector<bool> sendInPlace;
+        std::vector<bool> recvInPlace;
+    };
+    std::vector<SlabExchange> slabs(pipeline.count);
+    for(size_t slabIdx = 0; slabIdx < pipeline.count; ++slabIdx)
+    {
+        auto& slab          = slabs[slabIdx];
+        auto& exchange      = slab.exchange;
+        exchange            = std::make_unique<CommAllToAll>();
+        exchange->precision = precision;
+        exchange->arrayType = arrayType;
+        exchange->storage   = desc.exchangeStorage;
+        exchange->ranks.resize(commSize);
+        for(size_t r = 0; r < commSize; ++r)
+        {
+            auto& rankBufs    = exchange->ranks[r];
+            rankBufs.location = inField.bricks[inBrickOfRank[r]].location;
+            rankBufs.sendCounts.resize(commSize);
+            rankBufs.sendOffsets.resize(commSize);
+            rankBufs.recvCounts.resize(commSize);
+            rankBufs.recvOffsets.resize(commSize);
+        }
+        auto& slabIntersections = slab.intersections;
+        slabIntersections.resize(commSize);
+        for(size_t src = 0; src < commSize; ++src)
+        {
+            const auto& inBrick = inField.bricks[inBrickOfRank[src]];
+            for(size_t dest = 0; dest < commSize; ++dest)
+            {
+                const auto& outBrick = outField.bricks[outBrickOfRank[dest]];
+                auto&       intersection
+                    = slabIntersections[src].emplace_back(inBrick.intersect(outBrick).intersect(
+                        pipeline.slab(outBrick, slabIdx)));
+                intersection.stride = intersection.contiguous_strides();
+
+                const size_t count                    = intersection.count_elems();
+                exchange->ranks[src].sendCounts[dest] = count;
+                exchange->ranks[dest].recvCounts[src] = count;
+            }
+        }
+
+        // a rank sends in place if everything it sends is
+        // contiguous in its input brick, and its pieces are staged in
+        // the brick's order.  Other pieces are staged in the order of
+        // the receiving brick, and a rank receives in place if that
+        // makes everything it receives contiguous in its output
+        // brick.  Data that's exchanged in another format is
+        // always packed and unpacked to convert it.
+        const bool native = desc.exchangeStorage == rocfft_storage_format_native;
+        slab.sendInPlace.resize(commSize, native);
+        slab.recvInPlace.resize(commSize, native);
+        for(size_t src = 0; src < commSize; ++src)
+        {
+            const auto& inBrick = inField.bricks[inBrickOfRank[src]];
+            for(const auto& intersection : slabIntersections[src])
+            {
+                if(!intersection.empty()
+                   && !PieceContiguousInBrick(intersection,
+                                              PieceStridesInBrickOrder(intersection, inBrick),
+                                              inBrick))
+                    slab.sendInPlace[src] = false;
+            }
+        }
+        for(size_t src = 0; src < commSize; ++src)
+        {
+            const auto& inBrick = inField.bricks[inBrickOfRank[src]];
+            for(size_t dest = 0; dest < commSize; ++dest)
+            {
+                const auto& outBrick     = outField.bricks[outBrickOfRank[dest]];
+                auto&       intersection = slabIntersections[src][dest];
+                if(intersection.empty())
+                    continue;
+                intersection.stride = PieceStridesInBrickOrder(
+                    intersection, slab.sendInPlace[src] ? inBrick : outBrick);
+                if(!PieceContiguousInBrick(intersection, intersection.stride, outBrick))
+                    slab.recvInPlace[dest] = false;
+            }
+        }
+
+        // data is sent and received at its offset in the brick if in
+        // place, and otherwise ordered by the other rank in a
+        // staging buffer
+        auto setOffsets = [commSize](std::vector<size_t>&       offsets,
+                                     const std::vector<size_t>& counts,
+                                     bool                       inPlace,
+                                     const std::vector<size_t>& brickOffsets) {
+            size_t extent = 0;
+            for(size_t other = 0; other < commSize; ++other)
+            {
+                if(inPlace)
+                    offsets[other] = brickOffsets[other];
+                else if(other > 0)
+                    offsets[other] = offsets[other - 1] + counts[other - 1];
+                extent = std::max(extent, offsets[other] + counts[other]);
+            }
+            return extent;
+        };
+        size_t maxSendElems = 0;
+        size_t maxRecvElems = 0;
+        for(size_t r = 0; r < commSize; ++r)
+        {
+            const auto& inBrick  = inField.bricks[inBrickOfRank[r]];
+            const auto& outBrick = outField.bricks[outBrickOfRank[r]];
+            std::vector<size_t> sendBrickOffsets(commSize);
+            std::vector<size_t> recvBrickOffsets(commSize);
+            for(size_t other = 0; other < commSize; ++other)
+            {
+                const auto& sent = slabIntersections[r][other];
+                const auto& recv = slabIntersections[other][r];
+                if(!sent.empty())
+                    sendBrickOffsets[other] = sent.offset_in_field(inBrick.stride)
+                                              - inBrick.offset_in_field(inBrick.stride);
+                if(!recv.empty())
+                    recvBrickOffsets[other] = recv.offset_in_field(outBrick.stride)
+                                              - outBrick.offset_in_field(outBrick.stride);
+            }
+            auto& rankBufs = exchange->ranks[r];
+            maxSendElems   = std::max(maxSendElems,
+                                    setOffsets(rankBufs.sendOffsets,
+                                               rankBufs.sendCounts,
+                                               slab.sendInPlace[r],
+                                               sendBrickOffsets));
+            maxRecvElems   = std::max(maxRecvElems,
+                                    setOffsets(rankBufs.recvOffsets,
+                                               rankBufs.recvCounts,
+                                               slab.recvInPlace[r],
+                                               recvBrickOffsets));
+        }
+        // MPI counts and displacements are ints
+        if(desc.comm_type == rocfft_comm_mpi
+           && std::max(maxSendElems, maxRecvElems)
+                  > static_cast<size_t>(std::numeric_limits<int>::max()))
+            return false;
+    }
+
+    std::string                  itemGroup = "transpose_" + std::to_string(transposeNumber);
+    std::vector<TempBufferLease> exchangeBufs;
+    const auto                   storage   = desc.exchangeStorage;
+    const auto                   elem_size = storage_element_size(storage, precision, arrayType);
+
+    // packing waits for whatever wrote each rank's input brick
+    std::vector<std::vector<size_t>> packAntecedents(commSize);
+    for(size_t src = 0; src < commSize; ++src)
+    {
+        for(auto item : inputAntecedents)
+        {
+            if(multiPlan[item]->WritesToBuffer(input[inBrickOfRank[src]]))
+                packAntecedents[src].push_back(item);
+        }
+    }
+
+    for(size_t slabIdx = 0; slabIdx < pipeline.count; ++slabIdx)
+    {
+        auto&       slab              = slabs[slabIdx];
+        auto&       exchange          = slab.exchange;
+        const auto& slabIntersections = slab.intersections;
+        const auto  slabName = pipeline.count > 1 ? " slab " + std::to_string(slabIdx) : "";
+
+        // ranks that exchange data with each other, directly or
+        // through other ranks, form a group.  Pencil decompositions
+        // only exchange within a row or column of the rank grid, so
+        // each group's collective can run over just its own ranks.
+        std::vector<size_t> group(commSize);
+        std::iota(group.begin(), group.end(), 0);
+        auto findGroup = [&group](size_t r) {
+            while(group[r] != r)
+                r = group[r] = group[group[r]];
+            return r;
+        };
+        for(size_t src = 0; src < commSize; ++src)
+        {
+            for(size_t dest = 0; dest < commSize; ++dest)
+            {
+                if(exchange->ranks[src].sendCounts[dest])
+                    group[findGroup(dest)] = findGroup(src);
+            }
+        }
+        std::vector<size_t> groupIdx(commSize, commSize);
+        size_t              groupCount = 0;
+        for(size_t r = 0; r < commSize; ++r)
+        {
+            auto& idx = groupIdx[findGroup(r)];
+            if(idx == commSize)
+                idx = groupCount++;
+            exchange->rankGroup.push_back(idx);
+        }
+        if(groupCount > 1)
+            exchange->SplitComm(this);
+        else
+            exchange->rankGroup.clear();
+
+        // pack each rank's outgoing data into its send buffer, unless
+        // it sends in place
+        std::vector<size_t> exchangeAntecedents;
+        for(size_t src = 0; src < commSize; ++src)
+        {
+            auto&       rankBufs    = exchange->ranks[src];
+            const auto  inBrickIdx  = inBrickOfRank[src];
+            const auto  outBrickIdx = outBrickOfRank[src];
+            const auto& inBrick     = inField.bricks[inBrickIdx];
+            const auto& outBrick    = outField.bricks[outBrickIdx];
+
+            if(slab.recvInPlace[src])
+            {
+                rankBufs.recvPtr = output[outBrickIdx];
+                if(!outputAntecedents.empty())
+                    exchangeAntecedents.push_back(outputAntecedents[outBrickIdx]);
+            }
+            else
+            {
+                TempBufferLease& recv = exchangeBufs.emplace_back(
+                    tempBuffers,
+                    local_comm_rank,
+                    outBrick.location,
+                    std::max<size_t>(rankBufs.recvOffsets.back() + rankBufs.recvCounts.back(), 1),
+                    elem_size);
+                rankBufs.recvPtr = BufferPtr::temp(recv.data());
+            }
+
+            if(slab.sendInPlace[src])
+            {
+                rankBufs.sendPtr = input[inBrickIdx];
+                exchangeAntecedents.insert(exchangeAntecedents.end(),
+                                           packAntecedents[src].begin(),
+                                           packAntecedents[src].end());
+                continue;
+            }
+            TempBufferLease& send = exchangeBufs.emplace_back(
+                tempBuffers,
+                local_comm_rank,
+                inBrick.location,
+                std::max<size_t>(rankBufs.sendOffsets.back() + rankBufs.sendCounts.back(), 1),
+                elem_size);
+            rankBufs.sendPtr = BufferPtr::temp(send.data());
+
+            for(size_t dest = 0; dest < commSize; ++dest)
+            {
+                const auto& intersection = slabIntersections[src][dest];
+                if(intersection.empty())
+                    continue;
+
+                auto packIdx = AddMultiPlanItem(
+                    transpose_brick(local_comm_rank,
+                                    inBrick.location,
+                                    intersection.length(),
+                                    precision,
+                                    arrayType,
+                                    input[inBrickIdx],
+                                    intersection.offset_in_field(inBrick.stride)
+                                        - inBrick.offset_in_field(inBrick.stride),
+                                    inBrick.stride,
+                                    rankBufs.sendPtr,
+                                    rankBufs.sendOffsets[dest],
+                                    intersection.stride,
+                                    "pack brick for global transpose",
+                                    rocfft_storage_format_native,
+                                    storage),
+                    packAntecedents[src]);
+                multiPlan[packIdx]->group       = itemGroup;
+                multiPlan[packIdx]->description = "pack " + std::to_string(src) + " for "
+                                                  + std::to_string(dest) + slabName;
+                exchangeAntecedents.push_back(packIdx);
+            }
+        }
+
+        // exchange between all ranks at once
+        const CommAllToAll& exchangeItem = *exchange;
+        auto exchangeIdx = AddMultiPlanItem(std::move(exchange), exchangeAntecedents);
+        multiPlan[exchangeIdx]->group       = itemGroup;
+        multiPlan[exchangeIdx]->description = "all-to-all" + slabName;
+
+        // unpack each rank's receive buffer into its output brick,
+        // unless it received in place
+        for(size_t dest = 0; dest < commSize; ++dest)
+        {
+            const auto  outBrickIdx = outBrickOfRank[dest];
+            const auto& outBrick    = outField.bricks[outBrickIdx];
+            const auto& rankBufs    = exchangeItem.ranks[dest];
+
+            for(size_t src = 0; src < commSize; ++src)
+            {
+                const auto& intersection = slabIntersections[src][dest];
+                if(intersection.empty())
+                    continue;
+
+                if(slab.recvInPlace[dest])
+                {
+                    outputItems.push_back(exchangeIdx);
+                    outputRegions.push_back(intersection);
+                    continue;
+                }
+
+                std::vector<size_t> unpackAntecedents = {exchangeIdx};
+                if(!outputAntecedents.empty())
+                    unpackAntecedents.push_back(outputAntecedents[outBrickIdx]);
+                auto unpackIdx = AddMultiPlanItem(
+                    transpose_brick(local_comm_rank,
+                                    outBrick.location,
+                                    intersection.length(),
+                                    precision,
+                                    arrayType,
+                                    rankBufs.recvPtr,
+                                    rankBufs.recvOffsets[src],
+                                    intersection.stride,
+                                    output[outBrickIdx],
+                                    intersection.offset_in_field(outBrick.stride)
+                                        - outBrick.offset_in_field(outBrick.stride),
+                                    outBrick.stride,
+                                    "unpack brick for global transpose",
+                                    storage,
+                                    rocfft_storage_format_native),
+                    unpackAntecedents);
+                multiPlan[unpackIdx]->group       = itemGroup;
+                multiPlan[unpackIdx]->description = "unpack " + std::to_string(dest) + " from "
+                                                    + std::to_string(src) + slabName;
+                outputItems.push_back(unpackIdx);
+                outputRegions.push_back(intersection);
+            }
+        }
+    }
+    return true;
+}
+
+bool rocfft_plan_t::BuildOptMultiDevicePlan()
+{
+    const auto local_comm_rank = get_local_comm_rank();
+
+    // keep track of how many transposes we've done so we can log
+    // distinct messages about each one
+    size_t transposeNumber = 0;
+
+    const bool realForward = transformType == rocfft_transform_type_real_forward;
+    const bool realInverse = transformType == rocfft_transform_type_real_inverse;
+
     if(desc.inFields.empty() || desc.outFields.empty())
         return false;
 
+    // plans given a device list transform internal bricks spread
+    // over the devices.  The user's single bricks are scattered to
+    // them first and the result is gathered back at the end.
+    const auto&    userInField  = desc.inFields.front();
+    const auto&    userOutField = desc.outFields.front();
+    const bool     distribute   = desc.devices.size() > 1;
+    rocfft_field_t inField      = userInField;
+    rocfft_field_t outField     = userOutField;
+    if(distribute)
+    {
+        auto inLengths = std::vector<size_t>(lengths.begin(), lengths.begin() + rank);
+        inLengths.push_back(batch);
+        auto outLengths = std::vector<size_t>(outputLengths.begin(), outputLengths.begin() + rank);
+        outLengths.push_back(batch);
+        if(!DistributeOverDevices(
+               desc.devices, inLengths, outLengths, realInverse, inField, outField))
+            return false;
+    }
+
+    // in-place plans write each output brick to the buffer of the
+    // input brick at the same position, once nothing needs to read
+    // that buffer any more.  So each output brick must be on the
+    // same device as its input brick and fit in its buffer.
+    // Real-complex data changes shape, so only c2c is supported.
+    // Distributed plans only write the user's buffer when gathering
+    // the result, so they're built like out-of-place plans.
+    const bool inPlace = placement == rocfft_placement_inplace && !distribute;
+    if(inPlace)
+    {
+        if(realForward || realInverse || inField.bricks.size() != outField.bricks.size())
+            return false;
+        for(size_t i = 0; i < inField.bricks.size(); ++i)
+        {
+            const auto& inBrick  = inField.bricks[i];
+            const auto& outBrick = outField.bricks[i];
+            if(inBrick.location.comm_rank != outBrick.location.comm_rank
+               || inBrick.location.device != outBrick.location.device
+               || compute_ptrdiff(outBrick.length(), outBrick.stride, 1, 0)
+                      > compute_ptrdiff(inBrick.length(), inBrick.stride, 1, 0))
+                return false;
+        }
+    }
+
+    // real-complex transforms do the real dimension on each brick,
+    // first for forward transforms and last for inverse transforms,
+    // so it must not be split on the real side.  The other
+    // dimensions are complex transforms of the Hermitian data, which
+    // is distributed like the real data.
+    rocfft_field_t hermitianField;
+    if(realForward)
+    {
+        if(DimensionSplitInField(lengths.front(), 0, inField))
+            return false;
+        hermitianField = MakeHermitianField(inField, outputLengths.front());
+    }
+    else if(realInverse)
+    {
+        if(DimensionSplitInField(outputLengths.front(), 0, outField))
+            return false;
+        hermitianField = MakeHermitianField(outField, lengths.front());
+    }
+    const auto& complexInField  = realForward ? hermitianField : inField;
+    const auto& complexOutField = realInverse ? hermitianField : outField;
+    const auto& complexLengths  = realForward ? outputLengths : lengths;
+
     // work out what FFT dimensions are already contiguous in the fields
     std::vector<size_t> contiguousInputDims;
     std::vector<size_t> contiguousOutputDims;
     std::vector<size_t> nonContiguousDims;
-    for(size_t dimIdx = 0; dimIdx < rank; ++dimIdx)
+    for(size_t dimIdx = (realForward || realInverse) ? 1 : 0; dimIdx < rank; ++dimIdx)
     {
-        if(!DimensionSplitInField(lengths[dimIdx], dimIdx, desc.inFields.front()))
+        if(!DimensionSplitInField(complexLengths[dimIdx], dimIdx, complexInField))
             contiguousInputDims.push_back(dimIdx);
-        else if(!DimensionSplitInField(lengths[dimIdx], dimIdx, desc.outFields.front()))
+        else if(!DimensionSplitInField(complexLengths[dimIdx], dimIdx, complexOutField))
             contiguousOutputDims.push_back(dimIdx);
         else
             nonContiguousDims.push_back(dimIdx);
     }
 
-    // can optimize if at least one FFT dim is contiguous in input and output
-    if(contiguousInputDims.empty() || contiguousOutputDims.empty())
+    // can optimize if at least one FFT dim is contiguous in input and
+    // output.  The real dimension counts for the side it's done on.
+    // Distributed plans divided along the batch have every dim
+    // contiguous in the input, and just move the result to the
+    // output bricks.
+    if((contiguousInputDims.empty() && !realForward)
+       || (contiguousOutputDims.empty() && !realInverse
+           && !(distribute && nonContiguousDims.empty())))
         return false;
 
-    const auto elem_size = element_size(precision, desc.inArrayType);
+    const auto arrayType = realForward || realInverse ? rocfft_array_type_complex_interleaved
+                                                      : desc.inArrayType;
+    const auto elem_size = element_size(precision, arrayType);
+
+    // types of the transform's input and output data, which are real
+    // on the real side of real-complex transforms
+    const auto inType  = realForward ? rocfft_array_type_real : arrayType;
+    const auto outType = realInverse ? rocfft_array_type_real : arrayType;
+
+    // work out the layouts the data is transposed through, and how
+    // each transpose is pipelined, before building any of it
+    auto lengthsWithBatch = complexLengths;
+    lengthsWithBatch.push_back(batch);
+    std::vector<rocfft_field_t> midFields;
+    std::vector<PipelineSlabs>  midPipelines;
+    {
+        // dims that no brick divides in the layout being transposed,
+        // which can take over how bricks divide the next dim
+        std::vector<size_t> wholeDims = contiguousInputDims;
+        if(realForward)
+            wholeDims.insert(wholeDims.begin(), 0);
+        for(auto dimIdx : nonContiguousDims)
+        {
+            const auto& prevField = midFields.empty() ? complexInField : midFields.back();
+
+            // transpose so this dim is contiguous, preferring to keep
+            // a pencil decomposition so each brick only exchanges with
+            // its row of the brick grid
+            std::optional<rocfft_field_t> rotated;
+            for(auto wholeDim : wholeDims)
+            {
+                rotated = RotatePencils(prevField, lengthsWithBatch, dimIdx, wholeDim);
+                if(rotated)
+                    break;
+            }
+            auto nextField = rotated
+                                 ? std::move(*rotated)
+                                 : MakeFieldDimContiguous(complexInField, lengthsWithBatch, dimIdx);
+            // bricks of a new slab decomposition can go on whichever
+            // device is cheapest to move their data to
+            if(!rotated)
+                PlaceBricksForLinks(nextField, prevField);
+
+            // the FFTs can start on each slab of the transposed bricks
+            // while the rest is still being exchanged
+            midPipelines.push_back(ChoosePipeline(nextField,
+                                                  {dimIdx},
+                                                  elem_size,
+                                                  SplitDimension(prevField.bricks.front(), nextField)));
+            midFields.push_back(std::move(nextField));
+            wholeDims = {dimIdx};
+        }
+    }
+    const auto& lastMidField = midFields.empty() ? complexInField : midFields.back();
+    const auto  finalPipeline
+        = contiguousOutputDims.empty()
+              ? PipelineSlabs()
+              : ChoosePipeline(complexOutField,
+                               contiguousOutputDims,
+                               elem_size,
+                               SplitDimension(lastMidField.bricks.front(), complexOutField));
+
+    // temp bricks are laid out so the transforms on either side of
+    // each transpose write or read the exchanged pieces in place
+    rocfft_field_t exchangeInField = complexInField;
+    LayoutForExchange(
+        exchangeInField, midFields.empty() ? &complexOutField : &midFields.front(), nullptr);
+    for(size_t i = 0; i < midFields.size(); ++i)
+    {
+        const auto& prevField = i == 0 ? exchangeInField : midFields[i - 1];
+        const auto& nextField = i + 1 < midFields.size() ? midFields[i + 1] : complexOutField;
+        LayoutForExchange(midFields[i], &nextField, &prevField);
+    }
+    if(realInverse)
+        LayoutForExchange(hermitianField, nullptr, &lastMidField);
 
     // transform contiguous input dims
 
+    // distributed plans scatter the user's input to temp bricks
+    // first
+    std::vector<BufferPtr> inputBufs = GatherUserBuffers(BufferPtr::user_input, userInField.bricks);
+    std::vector<TempBufferLease> distributeTemp;
+    distributeTemp.reserve(inField.bricks.size() + outField.bricks.size());
+    std::vector<size_t> scatterItems;
+    if(distribute)
+    {
+        std::vector<BufferPtr> scatterBufs;
+        for(const auto& b : inField.bricks)
+        {
+            distributeTemp.emplace_back(tempBuffers,
+                                        local_comm_rank,
+                                        b.location,
+                                        b.count_elems(),
+                                        element_size(precision, inType));
+            scatterBufs.emplace_back(BufferPtr::temp(distributeTemp.back().data()));
+        }
+        std::vector<rocfft_brick_t> scatterRegions;
+        GlobalTranspose(inType,
+                        userInField,
+                        inField,
+                        inputBufs,
+                        scatterBufs,
+                        {},
+                        {},
+                        PipelineSlabs(),
+                        scatterItems,
+                        scatterRegions,
+                        transposeNumber++);
+        inputBufs = std::move(scatterBufs);
+    }
+
     // gather up input pointers and allocate temp storage for
     // FFTed contiguous input dims (since we don't want to
     // overwrite input)
-    std::vector<BufferPtr> inputBufs
-        = GatherUserBuffers(BufferPtr::user_input, desc.inFields.front().bricks);
     std::vector<BufferPtr> inputFFTBufs;
-    inputBufs.reserve(desc.inFields.front().bricks.size());
-    inputFFTBufs.reserve(desc.inFields.front().bricks.size());
+    inputFFTBufs.reserve(exchangeInField.bricks.size());
     std::vector<TempBufferLease> inputTemp;
-    inputTemp.reserve(desc.inFields.front().bricks.size());
-    for(size_t inBrickIdx = 0; inBrickIdx < desc.inFields.front().bricks.size(); ++inBrickIdx)
+    inputTemp.reserve(exchangeInField.bricks.size());
+    for(const auto& b : exchangeInField.bricks)
     {
-        const auto& inBrick = desc.inFields.front().bricks[inBrickIdx];
-        inputTemp.emplace_back(
-            tempBuffers, local_comm_rank, inBrick.location, inBrick.count_elems(), elem_size);
+        inputTemp.emplace_back(tempBuffers, local_comm_rank, b.location, b.count_elems(), elem_size);
         inputFFTBufs.emplace_back(BufferPtr::temp(inputTemp.back().data()));
     }
     std::vector<size_t> inputFFTItems;
-    C2CField(
-        desc.inFields.front(), contiguousInputDims, inputBufs, inputFFTBufs, {}, inputFFTItems);
+    if(realForward)
+    {
+        for(size_t i = 0; i < inField.bricks.size(); ++i)
+        {
+            const auto& inBrick = inField.bricks[i];
+
+            std::vector<size_t> antecedents;
+            for(auto item : scatterItems)
+            {
+                if(multiPlan[item]->WritesToBuffer(inputBufs[i]))
+                    antecedents.push_back(item);
+            }
+
+            auto transformItem = RealBrickFastestDimension(*this,
+                                                           inBrick.location,
+                                                           inBrick.length(),
+                                                           inBrick.stride,
+                                                           exchangeInField.bricks[i].stride,
+                                                           inputBufs[i],
+                                                           inputFFTBufs[i],
+                                                           antecedents);
+            multiPlan[transformItem]->group       = "fft_dim_0";
+            multiPlan[transformItem]->description = "FFT dim 0 brick " + std::to_string(i);
+            inputFFTItems.push_back(transformItem);
+        }
+        // remaining contiguous dims are transformed in-place on the
+        // Hermitian bricks
+        if(!contiguousInputDims.empty())
+        {
+            std::vector<size_t> realFFTItems;
+            std::swap(realFFTItems, inputFFTItems);
+            C2CField(exchangeInField,
+                     exchangeInField,
+                     contiguousInputDims,
+                     inputFFTBufs,
+                     inputFFTBufs,
+                     realFFTItems,
+                     {},
+                     {},
+                     inputFFTItems);
+        }
+    }
+    else
+        C2CField(inField,
+                 exchangeInField,
+                 contiguousInputDims,
+                 inputBufs,
+                 inputFFTBufs,
+                 scatterItems,
+                 {},
+                 {},
+                 inputFFTItems);
 
     // now transpose non-contiguous dims to be contiguous and
     // transform them too
@@ -2047,40 +4298,44 @@ bool rocfft_plan_t::BuildOptMultiDevicePlan()
     std::vector<BufferPtr>       transposeOutputBufs;
     auto                         transposeInputAntecedents = inputFFTItems;
     std::vector<size_t>          midFFTItems               = inputFFTItems;
-    rocfft_field_t               transposedField;
 
-    auto lengthsWithBatch = lengths;
-    lengthsWithBatch.push_back(batch);
-    for(auto dimIdx : nonContiguousDims)
+    for(size_t i = 0; i < midFields.size(); ++i)
     {
-        // transpose so this dim is contiguous
-        transposedField = MakeFieldDimContiguous(desc.inFields.front(), lengthsWithBatch, dimIdx);
+        const auto& prevField = i == 0 ? exchangeInField : midFields[i - 1];
+        const auto& nextField = midFields[i];
+        const auto  dimIdx    = nonContiguousDims[i];
 
         // allocate bricks to store the transposed data
-        for(auto& b : transposedField.bricks)
+        for(auto& b : nextField.bricks)
         {
             transposeOutputTemp.emplace_back(
                 tempBuffers, local_comm_rank, b.location, b.count_elems(), elem_size);
             transposeOutputBufs.emplace_back(BufferPtr::temp(transposeOutputTemp.back().data()));
         }
 
-        std::vector<size_t> transposeItems;
-        GlobalTranspose(elem_size,
-                        desc.inFields.front(),
-                        transposedField,
+        std::vector<size_t>         transposeItems;
+        std::vector<rocfft_brick_t> transposeRegions;
+        GlobalTranspose(arrayType,
+                        prevField,
+                        nextField,
                         transposeInputBufs,
                         transposeOutputBufs,
                         transposeInputAntecedents,
+                        {},
+                        midPipelines[i],
                         transposeItems,
+                        transposeRegions,
                         transposeNumber++);
 
         // now dimIdx dimension is contiguous on all bricks
-        midFFTItems.clear();
-        C2CField(transposedField,
+        C2CField(nextField,
+                 nextField,
                  {dimIdx},
                  transposeOutputBufs,
                  transposeOutputBufs,
                  transposeItems,
+                 transposeRegions,
+                 midPipelines[i],
                  midFFTItems);
 
         // next iteration of loop will depend on these fft items and
@@ -2092,33 +4347,125 @@ bool rocfft_plan_t::BuildOptMultiDevicePlan()
         transposeOutputBufs.clear();
     }
 
-    // transpose data to output layout and transform along remaining dimensions
-    std::vector<BufferPtr> outputBufs
-        = GatherUserBuffers(BufferPtr::user_output, desc.outFields.front().bricks);
-    std::vector<size_t> finalTransposeItems;
-    std::vector<size_t> finalFFTItems;
-    GlobalTranspose(elem_size,
-                    transposedField.bricks.empty() ? desc.inFields.front() : transposedField,
-                    desc.outFields.front(),
+    // transpose data to output layout and transform along remaining
+    // dimensions.  Inverse real-complex transforms finish with the
+    // real dimension, so their complex data goes to temp bricks laid
+    // out like the output first.
+    // Distributed plans transform into temp bricks that are gathered
+    // to the user's buffer at the end.
+    std::vector<BufferPtr> userOutputBufs
+        = GatherUserBuffers(placement == rocfft_placement_inplace ? BufferPtr::user_input
+                                                                  : BufferPtr::user_output,
+                            userOutField.bricks);
+    std::vector<BufferPtr> outputBufs = userOutputBufs;
+    if(distribute)
+    {
+        outputBufs.clear();
+        for(const auto& b : outField.bricks)
+        {
+            distributeTemp.emplace_back(tempBuffers,
+                                        local_comm_rank,
+                                        b.location,
+                                        b.count_elems(),
+                                        element_size(precision, outType));
+            outputBufs.emplace_back(BufferPtr::temp(distributeTemp.back().data()));
+        }
+    }
+    std::vector<BufferPtr>       complexOutputBufs = outputBufs;
+    std::vector<TempBufferLease> outputTemp;
+    if(realInverse)
+    {
+        complexOutputBufs.clear();
+        outputTemp.reserve(hermitianField.bricks.size());
+        for(const auto& b : hermitianField.bricks)
+        {
+            outputTemp.emplace_back(
+                tempBuffers, local_comm_rank, b.location, b.count_elems(), elem_size);
+            complexOutputBufs.emplace_back(BufferPtr::temp(outputTemp.back().data()));
+        }
+    }
+    std::vector<size_t>         finalTransposeItems;
+    std::vector<rocfft_brick_t> finalTransposeRegions;
+    std::vector<size_t>         finalFFTItems;
+    // input bricks are last read by the first transforms, and
+    // in-place plans overwrite them here
+    GlobalTranspose(arrayType,
+                    midFields.empty() ? exchangeInField : midFields.back(),
+                    complexOutField,
                     transposeInputBufs,
-                    outputBufs,
+                    complexOutputBufs,
                     midFFTItems,
+                    inPlace ? inputFFTItems : std::vector<size_t>{},
+                    finalPipeline,
                     finalTransposeItems,
+                    finalTransposeRegions,
                     transposeNumber++);
-    C2CField(desc.outFields.front(),
-             contiguousOutputDims,
-             outputBufs,
-             outputBufs,
-             finalTransposeItems,
-             finalFFTItems);
-    return true;
-}
+    if(contiguousOutputDims.empty())
+        finalFFTItems = finalTransposeItems;
+    else
+        C2CField(complexOutField,
+                 complexOutField,
+                 contiguousOutputDims,
+                 complexOutputBufs,
+                 complexOutputBufs,
+                 finalTransposeItems,
+                 finalTransposeRegions,
+                 finalPipeline,
+                 finalFFTItems);
+
+    // items that write the output bricks
+    std::vector<size_t> lastItems = realInverse ? std::vector<size_t>{} : finalFFTItems;
+    if(realInverse)
+    {
+        for(size_t i = 0; i < outField.bricks.size(); ++i)
+        {
+            const auto& outBrick = outField.bricks[i];
 
-#ifdef ROCFFT_MPI_ENABLE
+            std::vector<size_t> antecedents;
+            for(auto item : finalFFTItems)
+            {
+                if(multiPlan[item]->WritesToBuffer(complexOutputBufs[i]))
+                    antecedents.push_back(item);
+            }
 
-// RAII wrapper around MPI_Datatypes
-class MPI_Datatype_vector_wrapper_t
-{
+            auto transformItem = RealBrickFastestDimension(*this,
+                                                           outBrick.location,
+                                                           outBrick.length(),
+                                                           outBrick.stride,
+                                                           hermitianField.bricks[i].stride,
+                                                           complexOutputBufs[i],
+                                                           outputBufs[i],
+                                                           antecedents);
+            multiPlan[transformItem]->group       = "fft_dim_0";
+            multiPlan[transformItem]->description = "FFT dim 0 brick " + std::to_string(i);
+            lastItems.push_back(transformItem);
+        }
+    }
+
+    if(distribute)
+    {
+        std::vector<size_t>         gatherItems;
+        std::vector<rocfft_brick_t> gatherRegions;
+        GlobalTranspose(outType,
+                        outField,
+                        userOutField,
+                        outputBufs,
+                        userOutputBufs,
+                        lastItems,
+                        {},
+                        PipelineSlabs(),
+                        gatherItems,
+                        gatherRegions,
+                        transposeNumber++);
+    }
+    return true;
+}
+
+#ifdef ROCFFT_MPI_ENABLE
+
+// RAII wrapper around MPI_Datatypes
+class MPI_Datatype_vector_wrapper_t
+{
 public:
     MPI_Datatype_vector_wrapper_t(size_t size_bytes)
         : type(MPI_DATATYPE_NULL)
@@ -2489,6 +4836,155 @@ bool all_mpi_ranks_same_scalar(const Tval val, MPI_Comm comm)
 }
 #endif
 
+#if defined ROCFFT_MPI_ENABLE
+// Fill in a field's bricks without gathering them, if they form a
+// regular grid with one brick per rank.  That is, all bricks have
+// the same shape and strides, they tile the field exactly, and
+// ranks own cells of the grid in rank order.  The grid is
+// recognized with a few reductions whose size doesn't depend on
+// the number of ranks, where gathering every rank's brick costs
+// several collectives of a length proportional to it.
+//
+// Devices need to be the same on every rank, or assigned to ranks
+// round-robin, for the other ranks' devices to be known.  Returns
+// false on every rank if the bricks aren't laid out like that.
+static bool grid_brick_params_mpi(rocfft_plan&    plan,
+                                  rocfft_field_t& field,
+                                  const size_t    global_brick_length)
+{
+    const auto   comm     = plan->desc.mpi_comm;
+    const size_t commSize = plan->get_local_comm_size();
+    const size_t commRank = plan->get_local_comm_rank();
+    const size_t dim      = global_brick_length;
+    if(dim == 0)
+        return false;
+
+    // reduce brick count, shape, strides and bounds together.
+    // ranks without exactly one brick contribute placeholder values
+    // that only matter through the count.
+    const bool          one     = field.bricks.size() == 1;
+    const auto          brick   = one ? field.bricks.front() : rocfft_brick_t();
+    const auto          length  = one ? brick.length() : std::vector<size_t>(dim);
+    const auto          stride  = one ? brick.stride : std::vector<size_t>(dim);
+    const auto          lower   = one ? brick.lower : std::vector<size_t>(dim);
+    const auto          upper   = one ? brick.upper : std::vector<size_t>(dim);
+    std::vector<size_t> reduced = {field.bricks.size()};
+    reduced.insert(reduced.end(), length.begin(), length.end());
+    reduced.insert(reduced.end(), stride.begin(), stride.end());
+
+    std::vector<size_t> localMin = reduced;
+    localMin.insert(localMin.end(), lower.begin(), lower.end());
+    std::vector<size_t> localMax = reduced;
+    localMax.insert(localMax.end(), upper.begin(), upper.end());
+    localMax.push_back(one ? brick.location.device : 0);
+
+    std::vector<size_t> globalMin(localMin.size());
+    std::vector<size_t> globalMax(localMax.size());
+    auto                rcmpi = MPI_Allreduce(localMin.data(),
+                                              globalMin.data(),
+                                              localMin.size(),
+                                              type_to_mpi_type<size_t>(),
+                                              MPI_MIN,
+                                              comm);
+    if(rcmpi == MPI_SUCCESS)
+        rcmpi = MPI_Allreduce(localMax.data(),
+                              globalMax.data(),
+                              localMax.size(),
+                              type_to_mpi_type<size_t>(),
+                              MPI_MAX,
+                              comm);
+    if(rcmpi != MPI_SUCCESS)
+        throw std::runtime_error("MPI_Allreduce failed: " + std::to_string(rcmpi));
+
+    // every rank needs one brick of the same non-empty shape and
+    // strides
+    if(globalMin[0] != 1 || globalMax[0] != 1)
+        return false;
+    if(!std::equal(globalMin.begin(), globalMin.begin() + 1 + 2 * dim, globalMax.begin()))
+        return false;
+    const auto fieldLower = std::vector<size_t>(globalMin.begin() + 1 + 2 * dim, globalMin.end());
+    const auto fieldUpper
+        = std::vector<size_t>(globalMax.begin() + 1 + 2 * dim, globalMax.begin() + 1 + 3 * dim);
+    const int numDevices = static_cast<int>(globalMax.back()) + 1;
+
+    // the grid has to have exactly one cell per rank
+    std::vector<size_t> grid(dim);
+    size_t              cells = 1;
+    for(size_t d = 0; d < dim; ++d)
+    {
+        if(length[d] == 0 || (fieldUpper[d] - fieldLower[d]) % length[d] != 0)
+            return false;
+        grid[d] = (fieldUpper[d] - fieldLower[d]) / length[d];
+        cells *= grid[d];
+    }
+    if(cells != commSize)
+        return false;
+
+    // find out whether every rank's cell is its rank in column-major
+    // or row-major order, and whether devices are round-robin
+    std::vector<size_t> cell(dim);
+    bool                aligned = true;
+    for(size_t d = 0; d < dim; ++d)
+    {
+        aligned = aligned && (lower[d] - fieldLower[d]) % length[d] == 0;
+        cell[d] = (lower[d] - fieldLower[d]) / length[d];
+    }
+    size_t colMajor = 0;
+    size_t rowMajor = 0;
+    for(size_t d = dim; d-- > 0;)
+        colMajor = colMajor * grid[d] + cell[d];
+    for(size_t d = 0; d < dim; ++d)
+        rowMajor = rowMajor * grid[d] + cell[d];
+
+    const int device     = brick.location.device;
+    int       localOK[4] = {aligned && colMajor == commRank,
+                            aligned && rowMajor == commRank,
+                            device == numDevices - 1,
+                            device == static_cast<int>(commRank % numDevices)};
+    int       globalOK[4] = {};
+    rcmpi = MPI_Allreduce(localOK, globalOK, 4, MPI_INT, MPI_LAND, comm);
+    if(rcmpi != MPI_SUCCESS)
+        throw std::runtime_error("MPI_Allreduce failed: " + std::to_string(rcmpi));
+    if((!globalOK[0] && !globalOK[1]) || (!globalOK[2] && !globalOK[3]))
+        return false;
+
+    field.bricks.clear();
+    field.bricks.reserve(commSize);
+    for(size_t r = 0; r < commSize; ++r)
+    {
+        // cell of rank r in the grid
+        size_t index = r;
+        if(globalOK[0])
+        {
+            for(size_t d = 0; d < dim; ++d)
+            {
+                cell[d] = index % grid[d];
+                index /= grid[d];
+            }
+        }
+        else
+        {
+            for(size_t d = dim; d-- > 0;)
+            {
+                cell[d] = index % grid[d];
+                index /= grid[d];
+            }
+        }
+
+        auto& b = field.bricks.emplace_back();
+        for(size_t d = 0; d < dim; ++d)
+        {
+            b.lower.push_back(fieldLower[d] + cell[d] * length[d]);
+            b.upper.push_back(b.lower.back() + length[d]);
+        }
+        b.stride             = stride;
+        b.location.device    = globalOK[2] ? numDevices - 1 : static_cast<int>(r % numDevices);
+        b.location.comm_rank = static_cast<int>(r);
+    }
+    return true;
+}
+#endif
+
 rocfft_status allgather_brick_params_mpi(rocfft_plan& plan)
 {
 #if !defined ROCFFT_MPI_ENABLE
@@ -2599,9 +5095,13 @@ rocfft_status allgather_brick_params_mpi(rocfft_plan& plan)
         return rocfft_status_failure;
     }
 
-    // Communicate the brick info so that all ranks know about all the bricks.
+    // Communicate the brick info so that all ranks know about all the
+    // bricks.  Bricks on a regular grid are worked out without
+    // communicating them.
     for(auto& field : plan->desc.inFields)
     {
+        if(grid_brick_params_mpi(plan, field, global_brick_length))
+            continue;
         const auto rcfft = allgather_brick_params_lus_mpi(plan, field, global_brick_length);
         if(rcfft != rocfft_status_success)
         {
@@ -2610,6 +5110,8 @@ rocfft_status allgather_brick_params_mpi(rocfft_plan& plan)
     }
     for(auto& field : plan->desc.outFields)
     {
+        if(grid_brick_params_mpi(plan, field, global_brick_length))
+            continue;
         const auto rcfft = allgather_brick_params_lus_mpi(plan, field, global_brick_length);
         if(rcfft != rocfft_status_success)
         {
@@ -2624,6 +5126,154 @@ rocfft_status allgather_brick_params_mpi(rocfft_plan& plan)
 #endif
 }
 
+#ifdef ROCFFT_RCCL_ENABLE
+// All-gather the same number of values from every RCCL rank.  RCCL
+// only moves device memory, so values are staged through the
+// communicator's device.
+static std::vector<uint64_t>
+    rccl_allgather(ncclComm_t comm, size_t commSize, const std::vector<uint64_t>& local)
+{
+    std::vector<uint64_t> global(local.size() * commSize);
+    if(global.empty())
+        return global;
+
+    int  device = 0;
+    auto rcrccl = ncclCommCuDevice(comm, &device);
+    if(rcrccl != ncclSuccess)
+        throw std::runtime_error(std::string("ncclCommCuDevice failed: ")
+                                 + ncclGetErrorString(rcrccl));
+    rocfft_scoped_device dev(device);
+
+    const size_t       localBytes = local.size() * sizeof(uint64_t);
+    gpubuf_t<uint64_t> sendBuf;
+    gpubuf_t<uint64_t> recvBuf;
+    if(sendBuf.alloc(localBytes) != hipSuccess
+       || recvBuf.alloc(localBytes * commSize) != hipSuccess)
+        throw std::runtime_error("failed to allocate RCCL staging buffers");
+    if(hipMemcpy(sendBuf.data(), local.data(), localBytes, hipMemcpyHostToDevice) != hipSuccess)
+        throw std::runtime_error("hipMemcpy failed");
+
+    hipStream_wrapper_t stream;
+    stream.alloc();
+    rcrccl = ncclAllGather(sendBuf.data(), recvBuf.data(), local.size(), ncclUint64, comm, stream);
+    if(rcrccl != ncclSuccess)
+        throw std::runtime_error(std::string("ncclAllGather failed: ")
+                                 + ncclGetErrorString(rcrccl));
+    if(hipStreamSynchronize(stream) != hipSuccess)
+        throw std::runtime_error("hipStreamSynchronize failed");
+
+    if(hipMemcpy(global.data(), recvBuf.data(), localBytes * commSize, hipMemcpyDeviceToHost)
+       != hipSuccess)
+        throw std::runtime_error("hipMemcpy failed");
+    return global;
+}
+#endif
+
+// Communicate bricks on all RCCL ranks to all other ranks.  Each
+// rank packs its bricks into fixed-size records, as RCCL has no
+// variable-sized gathers.
+rocfft_status allgather_brick_params_rccl(rocfft_plan& plan)
+{
+#if !defined ROCFFT_RCCL_ENABLE
+    return rocfft_status_failure;
+#else
+    if(!plan->desc.rccl_comm)
+        return rocfft_status_failure;
+
+    const auto   comm            = plan->desc.rccl_comm;
+    const int    local_comm_rank = plan->get_local_comm_rank();
+    const size_t commSize        = plan->get_local_comm_size();
+
+    // RCCL moves data on the communicator's device, so that's the only
+    // device this rank can have bricks on
+    int comm_device = 0;
+    if(ncclCommCuDevice(comm, &comm_device) != ncclSuccess)
+        return rocfft_status_failure;
+
+    // label local bricks with this rank, and check they all have the
+    // same dimension.  Problems are reported to all ranks below, so
+    // no rank is left waiting in a collective.
+    uint64_t local_brick_length = 0;
+    uint64_t local_valid        = 1;
+    for(auto fields : {&plan->desc.inFields, &plan->desc.outFields})
+    {
+        for(auto& field : *fields)
+        {
+            for(auto& brick : field.bricks)
+            {
+                brick.location.comm_rank = local_comm_rank;
+                if(brick.location.device != comm_device)
+                    local_valid = 0;
+                if(local_brick_length == 0)
+                    local_brick_length = brick.lower.size();
+                else if(local_brick_length != brick.lower.size())
+                    local_valid = 0;
+            }
+        }
+    }
+
+    // all ranks must have the same fields, and the same brick
+    // dimension if they provide bricks
+    auto shape = rccl_allgather(
+        comm,
+        commSize,
+        {local_valid, plan->desc.inFields.size(), plan->desc.outFields.size(), local_brick_length});
+    uint64_t brick_length = 0;
+    for(size_t rank = 0; rank < commSize; ++rank)
+    {
+        const auto rankShape = shape.begin() + 4 * rank;
+        if(!rankShape[0] || rankShape[1] != plan->desc.inFields.size()
+           || rankShape[2] != plan->desc.outFields.size())
+            return rocfft_status_failure;
+        if(rankShape[3] == 0)
+            continue;
+        if(brick_length != 0 && brick_length != rankShape[3])
+            return rocfft_status_failure;
+        brick_length = rankShape[3];
+    }
+
+    // each brick is a record of device, lower, upper, and stride
+    const size_t record_length = 1 + 3 * brick_length;
+    for(auto fields : {&plan->desc.inFields, &plan->desc.outFields})
+    {
+        for(auto& field : *fields)
+        {
+            auto counts = rccl_allgather(comm, commSize, {field.bricks.size()});
+            const size_t max_count = *std::max_element(counts.begin(), counts.end());
+
+            std::vector<uint64_t> local(max_count * record_length);
+            auto                  out = local.begin();
+            for(const auto& brick : field.bricks)
+            {
+                *out++ = brick.location.device;
+                out    = std::copy(brick.lower.begin(), brick.lower.end(), out);
+                out    = std::copy(brick.upper.begin(), brick.upper.end(), out);
+                out    = std::copy(brick.stride.begin(), brick.stride.end(), out);
+            }
+            auto global = rccl_allgather(comm, commSize, local);
+
+            field.bricks.clear();
+            for(size_t rank = 0; rank < commSize; ++rank)
+            {
+                for(size_t i = 0; i < counts[rank]; ++i)
+                {
+                    auto in = global.begin() + (rank * max_count + i) * record_length;
+
+                    rocfft_brick_t brick;
+                    brick.location.comm_rank = rank;
+                    brick.location.device    = *in++;
+                    brick.lower.assign(in, in + brick_length);
+                    brick.upper.assign(in + brick_length, in + 2 * brick_length);
+                    brick.stride.assign(in + 2 * brick_length, in + 3 * brick_length);
+                    field.bricks.push_back(std::move(brick));
+                }
+            }
+        }
+    }
+    return rocfft_status_success;
+#endif
+}
+
 void rocfft_plan_t::ValidateFields() const
 {
     auto validateField = [](const char*                type,
@@ -2684,47 +5334,92 @@ void rocfft_plan_t::ValidateFields() const
 int rocfft_plan_t::get_local_comm_rank() const
 {
 #ifdef ROCFFT_MPI_ENABLE
-    if(desc.comm_type == rocfft_comm_none || !desc.mpi_comm)
-        return 0;
-
-    int  mpi_rank = 0;
-    auto rcmpi    = MPI_Comm_rank(desc.mpi_comm, &mpi_rank);
-    if(rcmpi != MPI_SUCCESS)
-        throw std::runtime_error("MPI_Comm_rank failed: " + std::to_string(rcmpi));
-    return mpi_rank;
-#else
-    return 0;
+    if(desc.comm_type == rocfft_comm_mpi && desc.mpi_comm)
+    {
+        int  mpi_rank = 0;
+        auto rcmpi    = MPI_Comm_rank(desc.mpi_comm, &mpi_rank);
+        if(rcmpi != MPI_SUCCESS)
+            throw std::runtime_error("MPI_Comm_rank failed: " + std::to_string(rcmpi));
+        return mpi_rank;
+    }
+#endif
+#ifdef ROCFFT_RCCL_ENABLE
+    if(desc.comm_type == rocfft_comm_rccl && desc.rccl_comm)
+    {
+        int  rccl_rank = 0;
+        auto rcrccl    = ncclCommUserRank(desc.rccl_comm, &rccl_rank);
+        if(rcrccl != ncclSuccess)
+            throw std::runtime_error(std::string("ncclCommUserRank failed: ")
+                                     + ncclGetErrorString(rcrccl));
+        return rccl_rank;
+    }
 #endif
+    return 0;
 }
 
 int rocfft_plan_t::get_local_comm_size() const
 {
 #ifdef ROCFFT_MPI_ENABLE
-    if(desc.comm_type == rocfft_comm_none || !desc.mpi_comm)
-        return 1;
-
-    int  mpi_size = 0;
-    auto rcmpi    = MPI_Comm_size(desc.mpi_comm, &mpi_size);
-    if(rcmpi != MPI_SUCCESS)
-        throw std::runtime_error("MPI_Comm_rank failed: " + std::to_string(rcmpi));
-    return mpi_size;
-#else
-    return 1;
+    if(desc.comm_type == rocfft_comm_mpi && desc.mpi_comm)
+    {
+        int  mpi_size = 0;
+        auto rcmpi    = MPI_Comm_size(desc.mpi_comm, &mpi_size);
+        if(rcmpi != MPI_SUCCESS)
+            throw std::runtime_error("MPI_Comm_rank failed: " + std::to_string(rcmpi));
+        return mpi_size;
+    }
+#endif
+#ifdef ROCFFT_RCCL_ENABLE
+    if(desc.comm_type == rocfft_comm_rccl && desc.rccl_comm)
+    {
+        int  rccl_size = 0;
+        auto rcrccl    = ncclCommCount(desc.rccl_comm, &rccl_size);
+        if(rcrccl != ncclSuccess)
+            throw std::runtime_error(std::string("ncclCommCount failed: ")
+                                     + ncclGetErrorString(rcrccl));
+        return rccl_size;
+    }
 #endif
+    return 1;
 }
 
-rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
-                                          const rocfft_result_placement placement,
-                                          const rocfft_transform_type   transform_type,
-                                          const rocfft_precision        precision,
-                                          const size_t                  dimensions,
-                                          const size_t*                 lengths,
-                                          const size_t                  number_of_transforms,
-                                          const rocfft_plan_description description)
+// true if the plan has kernels whose access modes (direct-to-register
+// and buffer instructions) were chosen by static rules, which
+// measuring could choose better
+static bool has_unmeasured_access_modes(const ExecPlan& execPlan)
 {
-    if(dimensions > 3)
+    return std::any_of(execPlan.execSeq.begin(), execPlan.execSeq.end(), [](TreeNode* node) {
+        switch(node->scheme)
+        {
+        case CS_KERNEL_STOCKHAM_BLOCK_CC:
+        case CS_KERNEL_STOCKHAM_BLOCK_RC:
+        case CS_KERNEL_STOCKHAM_BLOCK_CR:
+        case CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z:
+        case CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY:
+        case CS_KERNEL_STOCKHAM_R_TO_CMPLX_TRANSPOSE_Z_XY:
+            return node->specified_key == nullptr;
+        default:
+            return false;
+        }
+    });
+}
+
+static rocfft_status plan_create_impl(rocfft_plan                   plan,
+                                      const rocfft_result_placement placement,
+                                      const rocfft_transform_type   transform_type,
+                                      const rocfft_precision        precision,
+                                      const size_t                  dimensions,
+                                      const size_t*                 lengths,
+                                      const size_t                  number_of_transforms,
+                                      const rocfft_plan_description description)
+{
+    // kernel arguments hold the lengths and strides of each
+    // dimension, plus the batch and a dimension that large 1D
+    // decompositions add
+    if(dimensions > KERN_ARGS_ARRAY_WIDTH - 2)
         return rocfft_status_invalid_dimensions;
 
+    RoctxRange range("rocfft_plan_create");
     try
     {
         plan->rank = dimensions;
@@ -2734,23 +5429,49 @@ rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
         plan->precision     = precision;
         plan->transformType = transform_type;
 
+        if(description != nullptr)
+        {
+            plan->desc = *description;
+        }
+
         plan->outputLengths = plan->lengths;
         if(transform_type == rocfft_transform_type_real_forward
            || transform_type == rocfft_transform_type_real_inverse)
         {
-            plan->outputLengths.front() = plan->outputLengths.front() / 2 + 1;
+            // packed Hermitian data drops the Nyquist element, which
+            // only exists for even lengths
+            if(plan->desc.packedHermitian)
+            {
+                if(plan->outputLengths.front() % 2 != 0)
+                    return rocfft_status_invalid_dimensions;
+                plan->outputLengths.front() = plan->outputLengths.front() / 2;
+            }
+            else
+                plan->outputLengths.front() = plan->outputLengths.front() / 2 + 1;
         }
         if(transform_type == rocfft_transform_type_real_inverse)
             std::swap(plan->outputLengths, plan->lengths);
-
-        if(description != nullptr)
-        {
-            plan->desc = *description;
-        }
         plan->desc.init_defaults(
             plan->transformType, plan->placement, plan->lengths, plan->outputLengths);
 
-        auto rcfft = rocfft_status_success;
+        // the output lengths are the real lengths of real inverse
+        // transforms
+        plan->desc.storeOps.scale_factor *= normalization_scale(
+            plan->desc.storeOps.normalization,
+            transform_type == rocfft_transform_type_real_inverse ? plan->outputLengths
+                                                                 : plan->lengths,
+            transform_type == rocfft_transform_type_complex_forward
+                || transform_type == rocfft_transform_type_real_forward);
+        // the scale factor now carries the normalization, so a
+        // plan created from this description doesn't apply it again
+        plan->desc.storeOps.normalization = rocfft_normalization_none;
+
+        auto rcfft = set_load_ops_layout(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+        rcfft = set_store_ops_layout(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
 
         if(plan->desc.comm_type == rocfft_comm_mpi)
         {
@@ -2760,20 +5481,80 @@ rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
             if(rcfft != rocfft_status_success)
                 throw std::runtime_error("gather brick params failed");
         }
+        else if(plan->desc.comm_type == rocfft_comm_rccl)
+        {
+            rcfft = allgather_brick_params_rccl(plan);
+            if(rcfft != rocfft_status_success)
+                throw std::runtime_error("gather brick params failed");
+        }
 
         // Sort the parameters to be row major, in case they're not
         plan->sort();
 
+        rcfft = set_device_list_fields(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
         rcfft = check_array_type_validity(plan);
         if(rcfft != rocfft_status_success)
             return rcfft;
 
+        rcfft = check_storage_format_validity(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        rcfft = check_exchange_storage_validity(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        rcfft = check_output_op_validity(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        rcfft = check_inline_callback_validity(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        rcfft = check_real_to_real_validity(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        rcfft = check_batch_tile_validity(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        rcfft = check_rank_validity(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        rcfft = check_packed_hermitian_validity(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        rcfft = check_input_alias_validity(plan);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
         log_bench(rocfft_bench_command(plan));
 
         // Construct the plan
 
         // Build an optimized multi-device plan, if possible
         plan->ValidateFields();
+        bool builtMultiDevice = false;
+        if(!plan->desc.inFields.empty() || !plan->desc.outFields.empty())
+        {
+            builtMultiDevice = plan->BuildOptMultiDevicePlan();
+
+            // plans given a device list that can't be distributed
+            // run on the current device, directly on the user's
+            // buffers
+            if(!builtMultiDevice && !plan->desc.devices.empty())
+            {
+                plan->desc.inFields.clear();
+                plan->desc.outFields.clear();
+            }
+        }
 
         // If we have no input/output fields, then the single ExecPlan is
         // exactly what we need to do/
@@ -2782,43 +5563,869 @@ rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
         {
             NodeMetaData rootPlanData(nullptr);
             set_rootplan_params(plan, rootPlanData);
+            rootPlanData.deviceProp = plan_device_prop(*plan);
+            set_bluestein_strides(plan, rootPlanData);
+
+            // reuse an identical plan that was already built, if
+            // the plan cache is enabled
+            auto&       planCache = PlanCache::GetCache();
+            const bool  cacheable = planCache.Cacheable(*plan);
+            const auto  location  = rocfft_location_t::rank0_current_device();
+            std::string cacheKey;
+            if(cacheable)
+            {
+                cacheKey = PlanCache::MakeKey(*plan, rootPlanData.deviceProp, location.device);
+                auto cachedPlan = planCache.Get(cacheKey);
+                if(cachedPlan)
+                {
+                    plan->AddMultiPlanItem(std::move(cachedPlan), {});
+                    plan->FinalizeMultiPlan();
+                    return rocfft_status_success;
+                }
+            }
+
+            // replay decisions from a deserialized plan if they were
+            // made for this arch, and fall back to building the plan
+            // from scratch if they don't fit
+            std::unique_ptr<ExecPlan> singleDevicePlan;
+            if(plan->restore && plan->restore->arch == get_arch_name(rootPlanData.deviceProp)
+               && !TuningBenchmarker::GetSingleton().IsInitializingTuning()
+               && !TuningBenchmarker::GetSingleton().IsProcessingTuning())
+            {
+                try
+                {
+                    singleDevicePlan = BuildSingleDevicePlan(rootPlanData,
+                                                             0,
+                                                             location,
+                                                             plan->transformType,
+                                                             plan->desc.loadOps,
+                                                             plan->desc.storeOps,
+                                                             plan->desc.assignOptStrategy,
+                                                             plan->desc.tableStream,
+                                                             plan->restore.get());
+                }
+                catch(std::exception& e)
+                {
+                    if(LOG_TRACE_ENABLED())
+                        (*LogSingleton::GetInstance().GetTraceOS())
+                            << "unable to replay plan decisions: " << e.what() << std::endl;
+                }
+            }
+            if(!singleDevicePlan)
+                singleDevicePlan = BuildSingleDevicePlan(rootPlanData,
+                                                         0,
+                                                         location,
+                                                         plan->transformType,
+                                                         plan->desc.loadOps,
+                                                         plan->desc.storeOps,
+                                                         plan->desc.assignOptStrategy,
+                                                         plan->desc.tableStream);
+            bool noSolution = !singleDevicePlan->rootScheme
+                              || (singleDevicePlan->decisions
+                                  && singleDevicePlan->decisions->solution_kernels.empty());
+
+            // measure the access modes of a problem without a
+            // solution if asked to, and rebuild the plan from the
+            // solution that measuring wrote to the user folder
+            if(plan->desc.measureAccessModes && noSolution
+               && has_unmeasured_access_modes(*singleDevicePlan)
+               && OnlineTuner::GetTuner().MeasureAccessModes(*plan, location.device)
+               && solution_map::reload(
+                   "", get_arch_name(rootPlanData.deviceProp), rootPlanData.deviceProp))
+            {
+                singleDevicePlan = BuildSingleDevicePlan(rootPlanData,
+                                                         0,
+                                                         location,
+                                                         plan->transformType,
+                                                         plan->desc.loadOps,
+                                                         plan->desc.storeOps,
+                                                         plan->desc.assignOptStrategy,
+                                                         plan->desc.tableStream);
+                noSolution = !singleDevicePlan->rootScheme
+                             || (singleDevicePlan->decisions
+                                 && singleDevicePlan->decisions->solution_kernels.empty());
+            }
+
+            // no solution was found for this problem, tune it in
+            // the background if asked to.  a solution transferred
+            // from another arch gets a quicker tuning pass.
+            if(noSolution || singleDevicePlan->transferredSolution)
+                OnlineTuner::GetTuner().Enqueue(
+                    *plan, location.device, singleDevicePlan->transferredSolution);
+            if(cacheable)
+                planCache.Put(cacheKey, *singleDevicePlan);
+            plan->AddMultiPlanItem(std::move(singleDevicePlan), {});
+        }
+        else if(!builtMultiDevice)
+        {
+            // If optimized multi-device was not possible (either because
+            // multi-device was not requested, or we can't optimize for
+            // that case), fall back to single-device plan
+
+            NodeMetaData rootPlanData(nullptr);
+            set_rootplan_params(plan, rootPlanData);
+            rootPlanData.deviceProp = plan_device_prop(*plan);
             set_bluestein_strides(plan, rootPlanData);
-            rootPlanData.deviceProp = get_curr_device_prop();
 
-            auto singleDevicePlan = BuildSingleDevicePlan(rootPlanData,
-                                                          0,
-                                                          rocfft_location_t::rank0_current_device(),
-                                                          plan->transformType,
-                                                          plan->desc.loadOps,
-                                                          plan->desc.storeOps);
-            plan->AddMultiPlanItem(std::move(singleDevicePlan), {});
-        }
-        else
-        {
-            if(!plan->BuildOptMultiDevicePlan())
-            {
-                // If optimized multi-device was not possible (either because
-                // multi-device was not requested, or we can't optimize for
-                // that case), fall back to single-device plan
-
-                NodeMetaData rootPlanData(nullptr);
-                set_rootplan_params(plan, rootPlanData);
-                rootPlanData.deviceProp = get_curr_device_prop();
-                set_bluestein_strides(plan, rootPlanData);
-
-                auto singleDevicePlan
-                    = BuildSingleDevicePlan(rootPlanData,
-                                            0,
-                                            rocfft_location_t::rank0_current_device(),
-                                            plan->transformType,
-                                            plan->desc.loadOps,
-                                            plan->desc.storeOps);
-
-                plan->GatherScatterSingleDevicePlan(std::move(singleDevicePlan));
-            }
-        }
+            auto singleDevicePlan = BuildSingleDevicePlan(rootPlanData,
+                                                          0,
+                                                          rocfft_location_t::rank0_current_device(),
+                                                          plan->transformType,
+                                                          plan->desc.loadOps,
+                                                          plan->desc.storeOps,
+                                                          plan->desc.assignOptStrategy);
+
+            plan->GatherScatterSingleDevicePlan(std::move(singleDevicePlan));
+        }
+
+        plan->FinalizeMultiPlan();
+        plan->AllocateInternalTempBuffers();
+        return rocfft_status_success;
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+}
+
+void rocfft_plan_t::LogCreateTimes() const
+{
+    if(!LOG_PLAN_ENABLED())
+        return;
+
+    const auto& t  = *createTimes;
+    auto&       os = *LogSingleton::GetInstance().GetPlanOS();
+    if(LOG_JSON_ENABLED())
+    {
+        log_json_arguments(os,
+                           "plan_create_times",
+                           "solution_map_ms",
+                           t.ms(PCP_SOLUTION_MAP),
+                           "build_tree_ms",
+                           t.ms(PCP_BUILD_TREE),
+                           "fusion_ms",
+                           t.ms(PCP_FUSION),
+                           "buffer_assignment_ms",
+                           t.ms(PCP_BUFFER_ASSIGNMENT),
+                           "kernel_generation_ms",
+                           t.ms(PCP_KERNEL_GENERATION),
+                           "rtc_cache_lookup_ms",
+                           t.ms(PCP_RTC_CACHE_LOOKUP),
+                           "rtc_compile_ms",
+                           t.ms(PCP_RTC_COMPILE),
+                           "module_load_ms",
+                           t.ms(PCP_MODULE_LOAD),
+                           "tables_ms",
+                           t.ms(PCP_TABLES),
+                           "total_ms",
+                           t.total_ns / 1e6);
+        return;
+    }
+    os << "plan creation times (ms):" << std::endl
+       << "  solution map: " << t.ms(PCP_SOLUTION_MAP) << std::endl
+       << "  build tree: " << t.ms(PCP_BUILD_TREE) << std::endl
+       << "  fusion: " << t.ms(PCP_FUSION) << std::endl
+       << "  buffer assignment: " << t.ms(PCP_BUFFER_ASSIGNMENT) << std::endl
+       << "  kernel generation: " << t.ms(PCP_KERNEL_GENERATION) << std::endl
+       << "  RTC cache lookup: " << t.ms(PCP_RTC_CACHE_LOOKUP) << std::endl
+       << "  RTC compile: " << t.ms(PCP_RTC_COMPILE) << std::endl
+       << "  module load: " << t.ms(PCP_MODULE_LOAD) << std::endl
+       << "  twiddle/chirp tables: " << t.ms(PCP_TABLES) << std::endl
+       << "  total: " << t.total_ns / 1e6 << std::endl;
+}
+
+rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
+                                          const rocfft_result_placement placement,
+                                          const rocfft_transform_type   transform_type,
+                                          const rocfft_precision        precision,
+                                          const size_t                  dimensions,
+                                          const size_t*                 lengths,
+                                          const size_t                  number_of_transforms,
+                                          const rocfft_plan_description description)
+{
+    // time each phase of creation, charging work to this plan
+    PlanCreateTimesScope timesScope(plan->createTimes);
+    auto                 begin = std::chrono::steady_clock::now();
+
+    auto ret = plan_create_impl(plan,
+                                placement,
+                                transform_type,
+                                precision,
+                                dimensions,
+                                lengths,
+                                number_of_transforms,
+                                description);
+
+    plan->createTimes->total_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                      std::chrono::steady_clock::now() - begin)
+                                      .count();
+    if(ret == rocfft_status_success)
+    {
+        plan->LogCreateTimes();
+        if(LOG_REPLAY_ENABLED())
+        {
+            static std::atomic<size_t> nextReplayId{0};
+            plan->replayId = ++nextReplayId;
+            log_replay("plan", plan->replayId, rocfft_bench_command(plan));
+        }
+    }
+    return ret;
+}
+
+rocfft_status rocfft_plan_get_create_times(const rocfft_plan plan, rocfft_plan_create_times* times)
+{
+    log_trace(__func__, "plan", plan, "times", times);
+
+    if(!plan || !times)
+        return rocfft_status_invalid_arg_value;
+
+    // finish asynchronous plan creation, if necessary
+    auto create_status = plan->WaitCreate();
+    if(create_status != rocfft_status_success)
+        return create_status;
+
+    const auto& t               = *plan->createTimes;
+    times->solution_map_ms      = t.ms(PCP_SOLUTION_MAP);
+    times->build_tree_ms        = t.ms(PCP_BUILD_TREE);
+    times->fusion_ms            = t.ms(PCP_FUSION);
+    times->buffer_assignment_ms = t.ms(PCP_BUFFER_ASSIGNMENT);
+    times->kernel_generation_ms = t.ms(PCP_KERNEL_GENERATION);
+    times->rtc_cache_lookup_ms  = t.ms(PCP_RTC_CACHE_LOOKUP);
+    times->rtc_compile_ms       = t.ms(PCP_RTC_COMPILE);
+    times->module_load_ms       = t.ms(PCP_MODULE_LOAD);
+    times->tables_ms            = t.ms(PCP_TABLES);
+    times->total_ms             = t.total_ns / 1e6;
+    return rocfft_status_success;
+}
+
+// conjugate interleaved complex data on the host by flipping the
+// sign bit of each imaginary part
+static void conjugate_interleaved(std::vector<unsigned char>& data, size_t real_size)
+{
+    for(size_t i = real_size; i < data.size(); i += 2 * real_size)
+        data[i + real_size - 1] ^= 0x80;
+}
+
+// Set up one pass of a convolution plan as a standalone plan, and
+// build its ExecPlan.
+static rocfft_status build_convolution_pass(rocfft_plan_t&              pass,
+                                            rocfft_location_t           location,
+                                            std::unique_ptr<ExecPlan>& execPlan)
+{
+    pass.sort();
+
+    auto rcfft = check_array_type_validity(&pass);
+    if(rcfft != rocfft_status_success)
+        return rcfft;
+    rcfft = check_storage_format_validity(&pass);
+    if(rcfft != rocfft_status_success)
+        return rcfft;
+    rcfft = check_output_op_validity(&pass);
+    if(rcfft != rocfft_status_success)
+        return rcfft;
+    rcfft = check_inline_callback_validity(&pass);
+    if(rcfft != rocfft_status_success)
+        return rcfft;
+
+    NodeMetaData rootPlanData(nullptr);
+    set_rootplan_params(&pass, rootPlanData);
+    rootPlanData.deviceProp = plan_device_prop(pass);
+    set_bluestein_strides(&pass, rootPlanData);
+
+    execPlan = BuildSingleDevicePlan(rootPlanData,
+                                     0,
+                                     location,
+                                     pass.transformType,
+                                     pass.desc.loadOps,
+                                     pass.desc.storeOps,
+                                     pass.desc.assignOptStrategy,
+                                     pass.desc.tableStream);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_t::BuildConvolutionPlan(const void*             kernel_spectrum,
+                                                  rocfft_convolution_type convolution_type)
+{
+    const bool real = transformType == rocfft_transform_type_real_forward;
+
+    // the spectrum has the shape of one forward transform's output,
+    // and the forward transform is stored contiguously in the same
+    // shape, so that an output index modulo the distance is the
+    // index of the spectrum element to multiply by
+    std::vector<size_t> spectrumLengths = lengths;
+    if(real)
+        spectrumLengths.front() = spectrumLengths.front() / 2 + 1;
+    std::vector<size_t> spectrumStrides;
+    size_t              spectrumElems = 1;
+    for(auto len : spectrumLengths)
+    {
+        spectrumStrides.push_back(spectrumElems);
+        spectrumElems *= len;
+    }
+    const size_t elemSize = complex_type_size(precision);
+
+    if(convolutionSpectrum.alloc(spectrumElems * elemSize) != hipSuccess)
+        throw std::runtime_error("spectrum allocation failure");
+    if(convolution_type == rocfft_convolution_type_correlate)
+    {
+        std::vector<unsigned char> host(spectrumElems * elemSize);
+        if(hipMemcpy(host.data(), kernel_spectrum, host.size(), hipMemcpyDeviceToHost)
+           != hipSuccess)
+            throw std::runtime_error("spectrum copy failure");
+        conjugate_interleaved(host, real_type_size(precision));
+        if(hipMemcpy(convolutionSpectrum.data(), host.data(), host.size(), hipMemcpyHostToDevice)
+           != hipSuccess)
+            throw std::runtime_error("spectrum copy failure");
+    }
+    else if(hipMemcpy(convolutionSpectrum.data(),
+                      kernel_spectrum,
+                      spectrumElems * elemSize,
+                      hipMemcpyDeviceToDevice)
+            != hipSuccess)
+        throw std::runtime_error("spectrum copy failure");
+
+    const auto location        = rocfft_location_t::rank0_current_device();
+    const auto local_comm_rank = get_local_comm_rank();
+
+    TempBufferLease fftBuf(tempBuffers, local_comm_rank, location, spectrumElems * batch, elemSize);
+
+    // forward pass reads the user's input and stores the product
+    // with the spectrum to the temp buffer
+    rocfft_plan_t fwd;
+    fwd.rank          = rank;
+    fwd.lengths       = lengths;
+    fwd.outputLengths = spectrumLengths;
+    fwd.batch         = batch;
+    fwd.placement     = rocfft_placement_notinplace;
+    fwd.precision     = precision;
+    fwd.transformType = transformType;
+    fwd.desc          = desc;
+    fwd.desc.outArrayType
+        = real ? rocfft_array_type_hermitian_interleaved : rocfft_array_type_complex_interleaved;
+    fwd.desc.outStrides = spectrumStrides;
+    fwd.desc.outDist    = spectrumElems;
+    fwd.desc.outOffset  = {0, 0};
+    fwd.desc.storeOps   = StoreOps{};
+
+    fwd.desc.storeOps.multiply_buffer = convolutionSpectrum.data();
+    fwd.desc.storeOps.multiply_dist   = spectrumElems;
+
+    // inverse pass reads the temp buffer and stores to the user's
+    // output.  For in-place plans, execution passes it the input
+    // pointers as its output.
+    rocfft_plan_t inv;
+    inv.rank          = rank;
+    inv.lengths       = spectrumLengths;
+    inv.outputLengths = lengths;
+    inv.batch         = batch;
+    inv.placement     = rocfft_placement_notinplace;
+    inv.precision     = precision;
+    inv.transformType
+        = real ? rocfft_transform_type_real_inverse : rocfft_transform_type_complex_inverse;
+    inv.desc             = desc;
+    inv.desc.inArrayType = fwd.desc.outArrayType;
+    inv.desc.inStrides   = spectrumStrides;
+    inv.desc.inDist      = spectrumElems;
+    inv.desc.inOffset    = {0, 0};
+    inv.desc.loadOps     = LoadOps{};
+
+    std::unique_ptr<ExecPlan> fwdExec;
+    auto                      rcfft = build_convolution_pass(fwd, location, fwdExec);
+    if(rcfft != rocfft_status_success)
+        return rcfft;
+    std::unique_ptr<ExecPlan> invExec;
+    rcfft = build_convolution_pass(inv, location, invExec);
+    if(rcfft != rocfft_status_success)
+        return rcfft;
+
+    fwdExec->description = "FFT forward with spectrum multiply";
+    fwdExec->outputPtr   = BufferPtr::temp(fftBuf.data());
+    invExec->description = "FFT inverse";
+    invExec->inputPtr    = BufferPtr::temp(fftBuf.data());
+
+    // both passes run on the execution stream, so the inverse is
+    // ordered after the forward without any extra synchronization
+    auto fwdIdx = AddMultiPlanItem(std::move(fwdExec), {});
+    AddMultiPlanItem(std::move(invExec), {fwdIdx});
+    return rocfft_status_success;
+}
+
+// weights of the bins in the non-redundant half of a real
+// transform's spectrum: the zero and Nyquist bins are kept and the
+// other positive frequencies are doubled
+template <typename Treal>
+static std::vector<unsigned char> analytic_signal_mask(size_t length)
+{
+    const size_t               bins = length / 2 + 1;
+    std::vector<unsigned char> host(bins * sizeof(Treal));
+    auto                       mask = reinterpret_cast<Treal*>(host.data());
+    for(size_t k = 0; k < bins; ++k)
+        mask[k] = static_cast<Treal>(k == 0 || 2 * k == length ? 1.0 : 2.0);
+    return host;
+}
+
+rocfft_status rocfft_plan_t::BuildAnalyticSignalPlan()
+{
+    const size_t length = lengths.front();
+    const size_t bins   = length / 2 + 1;
+
+    std::vector<unsigned char> host;
+    switch(precision)
+    {
+    case rocfft_precision_single:
+        host = analytic_signal_mask<float>(length);
+        break;
+    case rocfft_precision_double:
+        host = analytic_signal_mask<double>(length);
+        break;
+    case rocfft_precision_half:
+        host = analytic_signal_mask<_Float16>(length);
+        break;
+    }
+    if(analyticSignalMask.alloc(host.size()) != hipSuccess)
+        throw std::runtime_error("mask allocation failure");
+    if(hipMemcpy(analyticSignalMask.data(), host.data(), host.size(), hipMemcpyHostToDevice)
+       != hipSuccess)
+        throw std::runtime_error("mask copy failure");
+
+    const auto location        = rocfft_location_t::rank0_current_device();
+    const auto local_comm_rank = get_local_comm_rank();
+
+    // the spectrum is stored with the distance of a full complex
+    // transform, which the inverse pass's zero padding requires
+    TempBufferLease fftBuf(
+        tempBuffers, local_comm_rank, location, length * batch, complex_type_size(precision));
+
+    // forward pass reads the user's input and stores its Hermitian
+    // spectrum to the temp buffer
+    rocfft_plan_t fwd;
+    fwd.rank              = rank;
+    fwd.lengths           = lengths;
+    fwd.outputLengths     = {bins};
+    fwd.batch             = batch;
+    fwd.placement         = rocfft_placement_notinplace;
+    fwd.precision         = precision;
+    fwd.transformType     = rocfft_transform_type_real_forward;
+    fwd.desc              = desc;
+    fwd.desc.outArrayType = rocfft_array_type_hermitian_interleaved;
+    fwd.desc.outStrides   = {1};
+    fwd.desc.outDist      = length;
+    fwd.desc.outOffset    = {0, 0};
+    fwd.desc.storeOps     = StoreOps{};
+
+    // inverse pass loads the positive frequencies multiplied by the
+    // mask, and the negative ones as zero, then stores to the user's
+    // output
+    rocfft_plan_t inv;
+    inv.rank             = rank;
+    inv.lengths          = lengths;
+    inv.outputLengths    = lengths;
+    inv.batch            = batch;
+    inv.placement        = rocfft_placement_notinplace;
+    inv.precision        = precision;
+    inv.transformType    = rocfft_transform_type_complex_inverse;
+    inv.desc             = desc;
+    inv.desc.inArrayType = rocfft_array_type_complex_interleaved;
+    inv.desc.inStrides   = {1};
+    inv.desc.inDist      = length;
+    inv.desc.inOffset    = {0, 0};
+    inv.desc.loadOps     = LoadOps{};
+
+    inv.desc.loadOps.window        = analyticSignalMask.data();
+    inv.desc.loadOps.valid_lengths = {bins};
+
+    auto rcfft = set_load_ops_layout(&inv);
+    if(rcfft != rocfft_status_success)
+        return rcfft;
+
+    std::unique_ptr<ExecPlan> fwdExec;
+    rcfft = build_convolution_pass(fwd, location, fwdExec);
+    if(rcfft != rocfft_status_success)
+        return rcfft;
+    std::unique_ptr<ExecPlan> invExec;
+    rcfft = build_convolution_pass(inv, location, invExec);
+    if(rcfft != rocfft_status_success)
+        return rcfft;
+
+    fwdExec->description = "FFT real forward";
+    fwdExec->outputPtr   = BufferPtr::temp(fftBuf.data());
+    invExec->description = "FFT inverse with analytic signal mask";
+    invExec->inputPtr    = BufferPtr::temp(fftBuf.data());
+
+    auto fwdIdx = AddMultiPlanItem(std::move(fwdExec), {});
+    AddMultiPlanItem(std::move(invExec), {fwdIdx});
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_allocate(rocfft_plan* plan)
+{
+    *plan = new rocfft_plan_t;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_create(rocfft_plan*                  plan,
+                                 const rocfft_result_placement placement,
+                                 const rocfft_transform_type   transform_type,
+                                 const rocfft_precision        precision,
+                                 const size_t                  dimensions,
+                                 const size_t*                 lengths,
+                                 const size_t                  number_of_transforms,
+                                 const rocfft_plan_description description)
+{
+    rocfft_plan_allocate(plan);
+
+    size_t log_len[3] = {1, 1, 1};
+    if(dimensions > 0)
+        log_len[0] = lengths[0];
+    if(dimensions > 1)
+        log_len[1] = lengths[1];
+    if(dimensions > 2)
+        log_len[2] = lengths[2];
+
+    log_trace(__func__,
+              "plan",
+              *plan,
+              "placement",
+              placement,
+              "transform_type",
+              transform_type,
+              "precision",
+              precision,
+              "dimensions",
+              dimensions,
+              "lengths",
+              std::make_pair(lengths, dimensions),
+              "number_of_transforms",
+              number_of_transforms,
+              "description",
+              description);
+
+    return rocfft_plan_create_internal(*plan,
+                                       placement,
+                                       transform_type,
+                                       precision,
+                                       dimensions,
+                                       lengths,
+                                       number_of_transforms,
+                                       description);
+}
+
+rocfft_status rocfft_plan_t::WaitCreate() const
+{
+    if(!pendingCreate.valid())
+        return rocfft_status_success;
+    return pendingCreate.get();
+}
+
+rocfft_status rocfft_plan_create_async(rocfft_plan*                  plan,
+                                       const rocfft_result_placement placement,
+                                       const rocfft_transform_type   transform_type,
+                                       const rocfft_precision        precision,
+                                       const size_t                  dimensions,
+                                       const size_t*                 lengths,
+                                       const size_t                  number_of_transforms,
+                                       const rocfft_plan_description description)
+{
+    // plans are created on the caller's current device.  Query it
+    // before allocating, so a failure doesn't leak the plan.
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        return rocfft_status_failure;
+
+    auto allocate_status = rocfft_plan_allocate(plan);
+    if(allocate_status != rocfft_status_success)
+        return allocate_status;
+
+    log_trace(__func__,
+              "plan",
+              *plan,
+              "placement",
+              placement,
+              "transform_type",
+              transform_type,
+              "precision",
+              precision,
+              "dimensions",
+              dimensions,
+              "lengths",
+              std::make_pair(lengths, dimensions),
+              "number_of_transforms",
+              number_of_transforms,
+              "description",
+              description);
+
+    // the caller may modify or destroy the lengths and description
+    // as soon as we return, so take copies for the creation task
+    std::vector<size_t> lengthsCopy(lengths, lengths + dimensions);
+    std::shared_ptr<rocfft_plan_description_t> descCopy;
+    if(description)
+        descCopy = std::make_shared<rocfft_plan_description_t>(*description);
+
+    rocfft_plan p = *plan;
+    auto create = [=]() {
+        if(hipSetDevice(deviceId) != hipSuccess)
+            return rocfft_status_failure;
+        return rocfft_plan_create_internal(p,
+                                           placement,
+                                           transform_type,
+                                           precision,
+                                           dimensions,
+                                           lengthsCopy.data(),
+                                           number_of_transforms,
+                                           descCopy.get());
+    };
+    p->pendingCreate = std::async(std::launch::async, create);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_create_stft(rocfft_plan*                  plan,
+                                      const rocfft_precision        precision,
+                                      const size_t                  frame_length,
+                                      const size_t                  hop_size,
+                                      const size_t                  number_of_frames,
+                                      const void*                   window,
+                                      const rocfft_plan_description description)
+{
+    rocfft_plan_allocate(plan);
+
+    log_trace(__func__,
+              "plan",
+              *plan,
+              "precision",
+              precision,
+              "frame_length",
+              frame_length,
+              "hop_size",
+              hop_size,
+              "number_of_frames",
+              number_of_frames,
+              "window",
+              window,
+              "description",
+              description);
+
+    if(frame_length == 0 || hop_size == 0 || number_of_frames == 0)
+        return rocfft_status_invalid_arg_value;
+
+    // frames are a batch of 1D transforms whose input distance is
+    // the hop, so consecutive frames overlap in the input buffer
+    rocfft_plan_description_t desc;
+    if(description)
+        desc = *description;
+    if(desc.inDist != 0 || desc.inStrides.size() > 1 || desc.loadOps.window
+       || !desc.loadOps.valid_lengths.empty())
+        return rocfft_status_invalid_arg_value;
+    const size_t inStride = desc.inStrides.empty() ? 1 : desc.inStrides.front();
+    desc.inDist           = hop_size * inStride;
+    if(window)
+    {
+        desc.loadOps.window       = window;
+        desc.loadOps.frame_window = true;
+    }
+
+    return rocfft_plan_create_internal(*plan,
+                                       rocfft_placement_notinplace,
+                                       rocfft_transform_type_complex_forward,
+                                       precision,
+                                       1,
+                                       &frame_length,
+                                       number_of_frames,
+                                       &desc);
+}
+
+rocfft_status rocfft_plan_create_convolution(rocfft_plan*                  plan,
+                                             const rocfft_result_placement placement,
+                                             const rocfft_transform_type   transform_type,
+                                             const rocfft_precision        precision,
+                                             const size_t                  dimensions,
+                                             const size_t*                 lengths,
+                                             const size_t                  number_of_transforms,
+                                             const void*                   kernel_spectrum,
+                                             const rocfft_convolution_type convolution_type,
+                                             const rocfft_plan_description description)
+{
+    rocfft_plan_allocate(plan);
+
+    log_trace(__func__,
+              "plan",
+              *plan,
+              "placement",
+              placement,
+              "transform_type",
+              transform_type,
+              "precision",
+              precision,
+              "dimensions",
+              dimensions,
+              "lengths",
+              std::make_pair(lengths, dimensions),
+              "number_of_transforms",
+              number_of_transforms,
+              "kernel_spectrum",
+              kernel_spectrum,
+              "convolution_type",
+              convolution_type,
+              "description",
+              description);
+
+    if(dimensions < 1 || dimensions > 3)
+        return rocfft_status_invalid_dimensions;
+    if(transform_type != rocfft_transform_type_complex_forward
+       && transform_type != rocfft_transform_type_real_forward)
+        return rocfft_status_invalid_arg_value;
+    if(!kernel_spectrum
+       || (convolution_type != rocfft_convolution_type_convolve
+           && convolution_type != rocfft_convolution_type_correlate))
+        return rocfft_status_invalid_arg_value;
+
+    auto p = *plan;
+    try
+    {
+        p->rank = dimensions;
+        std::copy(lengths, lengths + dimensions, std::back_inserter(p->lengths));
+        p->outputLengths = p->lengths;
+        p->batch         = number_of_transforms;
+        p->placement     = placement;
+        p->precision     = precision;
+        p->transformType = transform_type;
+
+        if(description != nullptr)
+            p->desc = *description;
+        if(p->desc.comm_type != rocfft_comm_none || !p->desc.inFields.empty()
+           || !p->desc.outFields.empty() || p->desc.batchTile != 1)
+            return rocfft_status_invalid_arg_value;
+
+        // input and output both hold data of the transform's input
+        // type in the same shape, which is how a complex transform
+        // lays out its defaults
+        const bool real = transform_type == rocfft_transform_type_real_forward;
+        if(p->desc.inArrayType == rocfft_array_type_unset)
+            p->desc.inArrayType
+                = real ? rocfft_array_type_real : rocfft_array_type_complex_interleaved;
+        if(p->desc.outArrayType == rocfft_array_type_unset)
+            p->desc.outArrayType
+                = real ? rocfft_array_type_real : rocfft_array_type_complex_interleaved;
+        p->desc.init_defaults(
+            rocfft_transform_type_complex_forward, placement, p->lengths, p->outputLengths);
+        // the inverse pass stores the result, so it applies the
+        // normalization of both passes
+        p->desc.storeOps.scale_factor
+            *= normalization_scale(p->desc.storeOps.normalization, p->lengths, true)
+               * normalization_scale(p->desc.storeOps.normalization, p->lengths, false);
+        p->desc.storeOps.normalization = rocfft_normalization_none;
+        auto rcfft = set_load_ops_layout(p);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+        rcfft = set_store_ops_layout(p);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        if(real
+           && (p->desc.inArrayType != rocfft_array_type_real
+               || p->desc.outArrayType != rocfft_array_type_real))
+            return rocfft_status_invalid_array_type;
+        if(!real
+           && (!array_type_is_complex(p->desc.inArrayType)
+               || !array_type_is_complex(p->desc.outArrayType)))
+            return rocfft_status_invalid_array_type;
+        if(placement == rocfft_placement_inplace && p->desc.inArrayType != p->desc.outArrayType)
+            return rocfft_status_invalid_array_type;
+        // the passes are out-of-place, so check in-place storage
+        // formats here
+        if(placement == rocfft_placement_inplace
+           && p->desc.loadOps.storage != p->desc.storeOps.storage)
+            return rocfft_status_invalid_arg_value;
+
+        rcfft = p->BuildConvolutionPlan(kernel_spectrum, convolution_type);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        p->FinalizeMultiPlan();
+        p->AllocateInternalTempBuffers();
+        return rocfft_status_success;
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+}
+
+rocfft_status rocfft_plan_create_analytic_signal(rocfft_plan*                  plan,
+                                                 const rocfft_precision        precision,
+                                                 const size_t                  length,
+                                                 const size_t                  number_of_transforms,
+                                                 const rocfft_plan_description description)
+{
+    rocfft_plan_allocate(plan);
+
+    log_trace(__func__,
+              "plan",
+              *plan,
+              "precision",
+              precision,
+              "length",
+              length,
+              "number_of_transforms",
+              number_of_transforms,
+              "description",
+              description);
+
+    if(length < 2 || number_of_transforms == 0)
+        return rocfft_status_invalid_arg_value;
+
+    auto p = *plan;
+    try
+    {
+        p->rank          = 1;
+        p->lengths       = {length};
+        p->outputLengths = p->lengths;
+        p->batch         = number_of_transforms;
+        p->placement     = rocfft_placement_notinplace;
+        p->precision     = precision;
+        p->transformType = rocfft_transform_type_real_forward;
+
+        if(description != nullptr)
+            p->desc = *description;
+        if(p->desc.comm_type != rocfft_comm_none || !p->desc.inFields.empty()
+           || !p->desc.outFields.empty() || p->desc.batchTile != 1
+           || p->desc.loadOps.window || !p->desc.loadOps.valid_lengths.empty()
+           || p->desc.storeOps.normalization != rocfft_normalization_none)
+            return rocfft_status_invalid_arg_value;
+
+        // real input and complex output of the same length, which is
+        // how a complex transform lays out its defaults
+        if(p->desc.inArrayType == rocfft_array_type_unset)
+            p->desc.inArrayType = rocfft_array_type_real;
+        p->desc.init_defaults(rocfft_transform_type_complex_forward,
+                              rocfft_placement_notinplace,
+                              p->lengths,
+                              p->outputLengths);
+        if(p->desc.inArrayType != rocfft_array_type_real
+           || (p->desc.outArrayType != rocfft_array_type_complex_interleaved
+               && p->desc.outArrayType != rocfft_array_type_complex_planar))
+            return rocfft_status_invalid_array_type;
+
+        // the inverse pass stores the result, so it divides by the
+        // length
+        p->desc.storeOps.scale_factor /= static_cast<double>(length);
+        auto rcfft = set_store_ops_layout(p);
+        if(rcfft != rocfft_status_success)
+            return rcfft;
 
-        plan->AllocateInternalTempBuffers();
+        rcfft = p->BuildAnalyticSignalPlan();
+        if(rcfft != rocfft_status_success)
+            return rcfft;
+
+        p->FinalizeMultiPlan();
+        p->AllocateInternalTempBuffers();
         return rocfft_status_success;
     }
     catch(std::exception& e)
@@ -2831,61 +6438,30 @@ rocfft_status rocfft_plan_create_internal(rocfft_plan                   plan,
     }
 }
 
-rocfft_status rocfft_plan_allocate(rocfft_plan* plan)
+rocfft_status rocfft_plan_wait(const rocfft_plan plan)
 {
-    *plan = new rocfft_plan_t;
-    return rocfft_status_success;
+    log_trace(__func__, "plan", plan);
+    if(!plan)
+        return rocfft_status_failure;
+    return plan->WaitCreate();
 }
 
-rocfft_status rocfft_plan_create(rocfft_plan*                  plan,
-                                 const rocfft_result_placement placement,
-                                 const rocfft_transform_type   transform_type,
-                                 const rocfft_precision        precision,
-                                 const size_t                  dimensions,
-                                 const size_t*                 lengths,
-                                 const size_t                  number_of_transforms,
-                                 const rocfft_plan_description description)
+rocfft_status rocfft_plan_is_ready(const rocfft_plan plan, int* ready)
 {
-    rocfft_plan_allocate(plan);
-
-    size_t log_len[3] = {1, 1, 1};
-    if(dimensions > 0)
-        log_len[0] = lengths[0];
-    if(dimensions > 1)
-        log_len[1] = lengths[1];
-    if(dimensions > 2)
-        log_len[2] = lengths[2];
-
-    log_trace(__func__,
-              "plan",
-              *plan,
-              "placement",
-              placement,
-              "transform_type",
-              transform_type,
-              "precision",
-              precision,
-              "dimensions",
-              dimensions,
-              "lengths",
-              std::make_pair(lengths, dimensions),
-              "number_of_transforms",
-              number_of_transforms,
-              "description",
-              description);
+    log_trace(__func__, "plan", plan, "ready", ready);
+    if(!plan || !ready)
+        return rocfft_status_invalid_arg_value;
 
-    return rocfft_plan_create_internal(*plan,
-                                       placement,
-                                       transform_type,
-                                       precision,
-                                       dimensions,
-                                       lengths,
-                                       number_of_transforms,
-                                       description);
+    *ready = !plan->pendingCreate.valid()
+             || plan->pendingCreate.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    return rocfft_status_success;
 }
 
 rocfft_status rocfft_plan_destroy(rocfft_plan plan)
 {
+    // creation may still be running in the background
+    if(plan)
+        plan->WaitCreate();
     delete plan;
     return rocfft_status_success;
 }
@@ -2895,14 +6471,35 @@ rocfft_status rocfft_plan_get_work_buffer_size(const rocfft_plan plan, size_t* s
     if(!plan)
         return rocfft_status_failure;
 
+    auto create_status = plan->WaitCreate();
+    if(create_status != rocfft_status_success)
+        return create_status;
+
     *size_in_bytes = plan->WorkBufBytes();
     log_trace(__func__, "plan", plan, "size_in_bytes ptr", size_in_bytes, "val", *size_in_bytes);
     return rocfft_status_success;
 }
 
+rocfft_status rocfft_plan_get_info(const rocfft_plan plan, rocfft_plan_info* info)
+{
+    log_trace(__func__, "plan", plan, "info", info);
+    if(!plan || !info)
+        return rocfft_status_invalid_arg_value;
+
+    auto create_status = plan->WaitCreate();
+    if(create_status != rocfft_status_success)
+        return create_status;
+
+    plan->GetInfo(*info);
+    return rocfft_status_success;
+}
+
 rocfft_status rocfft_plan_get_print(const rocfft_plan plan)
 {
     log_trace(__func__, "plan", plan);
+    auto create_status = plan->WaitCreate();
+    if(create_status != rocfft_status_success)
+        return create_status;
     rocfft_cout << std::endl;
     rocfft_cout << "precision: " << precision_name(plan->precision) << std::endl;
 
@@ -2921,6 +6518,30 @@ rocfft_status rocfft_plan_get_print(const rocfft_plan plan)
     case rocfft_transform_type_real_inverse:
         rocfft_cout << "real inverse";
         break;
+    case rocfft_transform_type_dct1:
+        rocfft_cout << "DCT-I";
+        break;
+    case rocfft_transform_type_dct2:
+        rocfft_cout << "DCT-II";
+        break;
+    case rocfft_transform_type_dct3:
+        rocfft_cout << "DCT-III";
+        break;
+    case rocfft_transform_type_dct4:
+        rocfft_cout << "DCT-IV";
+        break;
+    case rocfft_transform_type_dst1:
+        rocfft_cout << "DST-I";
+        break;
+    case rocfft_transform_type_dst2:
+        rocfft_cout << "DST-II";
+        break;
+    case rocfft_transform_type_dst3:
+        rocfft_cout << "DST-III";
+        break;
+    case rocfft_transform_type_dst4:
+        rocfft_cout << "DST-IV";
+        break;
     }
     rocfft_cout << std::endl;
 
@@ -3061,9 +6682,10 @@ void get_large_twd_base_steps(size_t large1DLen, bool use3steps, size_t& base, s
     while(pow(lenLargeTwdBase, steps) < large1DLen)
         steps++;
 
-    if(base == 8 && steps > 3)
-        throw std::runtime_error(
-            "large-twd-base 8 could be 2,3 steps, but not supported for 4-steps yet");
+    // 5 steps of base 8 covers lengths up to 2^40
+    if(base == 8 && steps > LTWD_MAX_STEPS)
+        throw std::runtime_error("large-twd-base 8 supports at most "
+                                 + std::to_string(LTWD_MAX_STEPS) + " steps");
     if(base < 8 && steps != 3)
         throw std::runtime_error("large-twd-base for 4,5,6 must be 3-steps");
 }
@@ -3122,18 +6744,21 @@ void TreeNode::CopyNodeData(const TreeNode& srcNode)
     direction       = srcNode.direction;
     inArrayType     = srcNode.inArrayType;
     outArrayType    = srcNode.outArrayType;
+    r2rType         = srcNode.r2rType;
     allowInplace    = srcNode.allowInplace;
     allowOutofplace = srcNode.allowOutofplace;
     deviceProp      = srcNode.deviceProp;
+    optStrategy     = srcNode.optStrategy;
 
     // conditional
-    large1D        = srcNode.large1D;
-    largeTwd3Steps = srcNode.largeTwd3Steps;
-    largeTwdBase   = srcNode.largeTwdBase;
-    lengthBlue     = srcNode.lengthBlue;
-    lengthBlueN    = srcNode.lengthBlueN;
-    typeBlue       = srcNode.typeBlue;
-    fuseBlue       = srcNode.fuseBlue;
+    large1D         = srcNode.large1D;
+    largeTwd3Steps  = srcNode.largeTwd3Steps;
+    largeTwdCompute = srcNode.largeTwdCompute;
+    largeTwdBase    = srcNode.largeTwdBase;
+    lengthBlue      = srcNode.lengthBlue;
+    lengthBlueN     = srcNode.lengthBlueN;
+    typeBlue        = srcNode.typeBlue;
+    fuseBlue        = srcNode.fuseBlue;
 
     //
     obIn  = srcNode.obIn;
@@ -3172,7 +6797,9 @@ void TreeNode::CopyNodeData(const NodeMetaData& data)
     direction     = data.direction;
     inArrayType   = data.inArrayType;
     outArrayType  = data.outArrayType;
+    r2rType       = data.r2rType;
     deviceProp    = data.deviceProp;
+    optStrategy   = data.optStrategy;
 }
 
 bool TreeNode::isPlacementAllowed(rocfft_result_placement test_placement) const
@@ -3455,6 +7082,102 @@ void OrderFuseShims(std::vector<TreeNode*>& seq, std::vector<FuseShim*>& fuseSeq
     fuseSeq.swap(reordered);
 }
 
+// Fusions that can be proposed for any adjacent pair of leaves in
+// execSeq.  The shim checks whether the pair's load/store patterns
+// can be emitted by a fused kernel; "before" and "after" are the
+// number of neighbouring leaves the shim also needs to look at,
+// which are not themselves fused.
+struct AdjacentFusionRule
+{
+    FuseType type;
+    size_t   before;
+    size_t   after;
+};
+
+static const std::vector<AdjacentFusionRule> adjacentFusionRules = {
+    {FT_TRANS_WITH_STOCKHAM, 0, 0},
+    {FT_STOCKHAM_WITH_TRANS, 0, 0},
+    {FT_STOCKHAM_WITH_TRANS_Z_XY, 1, 0},
+    {FT_STOCKHAM_WITH_TRANS_XY_Z, 0, 1},
+};
+
+// General fusion pass over execSeq.  Tree nodes propose the fusions
+// they know about in their own BuildTree; this looks for any other
+// adjacent pair of sibling leaves that a rule can fuse, and accepts
+// them in order of estimated global memory traffic saved: the
+// intermediate written by the first kernel and read back by the
+// second.  Pairs that overlap an already-proposed fusion are left
+// alone.
+void ProposeAdjacentFusions(ExecPlan& execPlan)
+{
+    auto& seq = execPlan.execSeq;
+
+    std::set<TreeNode*> fused;
+    for(auto shim : execPlan.fuseShims)
+        shim->ForEachNode([&](TreeNode* node) { fused.insert(node); });
+
+    struct Candidate
+    {
+        std::unique_ptr<FuseShim> shim;
+        size_t                    bytesSaved;
+    };
+    std::vector<Candidate> candidates;
+
+    for(size_t i = 0; i + 1 < seq.size(); ++i)
+    {
+        auto first  = seq[i];
+        auto second = seq[i + 1];
+        if(first->parent == nullptr || first->parent != second->parent || fused.count(first)
+           || fused.count(second))
+            continue;
+
+        // neighbours are only meaningful to the shims if they're
+        // siblings of the pair
+        auto sibling = [&](size_t idx) -> TreeNode* {
+            return idx < seq.size() && seq[idx]->parent == first->parent ? seq[idx] : nullptr;
+        };
+
+        auto intermediate = product(first->length.begin(), first->length.end()) * first->batch
+                            * element_size(first->precision, first->outArrayType);
+
+        for(const auto& rule : adjacentFusionRules)
+        {
+            // missing neighbours are passed as nullptr
+            std::vector<TreeNode*> window;
+            for(size_t b = rule.before; b > 0; --b)
+                window.push_back(i >= b ? sibling(i - b) : nullptr);
+            window.push_back(first);
+            window.push_back(second);
+            for(size_t a = 1; a <= rule.after; ++a)
+                window.push_back(sibling(i + 1 + a));
+
+            auto shim = NodeFactory::CreateFuseShim(rule.type, window);
+            if(!shim->IsSchemeFusable() || shim->FirstFuseNode() != first
+               || shim->LastFuseNode() != second)
+                continue;
+            candidates.push_back({std::move(shim), 2 * intermediate});
+            break;
+        }
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.bytesSaved > b.bytesSaved;
+    });
+
+    for(auto& c : candidates)
+    {
+        auto first  = c.shim->FirstFuseNode();
+        auto second = c.shim->LastFuseNode();
+        if(fused.count(first) || fused.count(second))
+            continue;
+        fused.insert(first);
+        fused.insert(second);
+
+        execPlan.fuseShims.push_back(c.shim.get());
+        first->parent->fuseShims.emplace_back(std::move(c.shim));
+    }
+}
+
 void CheckFuseShimForArch(ExecPlan& execPlan)
 {
     // for gfx906...
@@ -3506,6 +7229,14 @@ void TreeNode::DetermineBufferMemory(size_t& tmpBufSize,
             tmpBufSize = std::max(outputPtrDiff, tmpBufSize);
     }
 
+    // Rader's index tables and kernel sit in front of the data, so
+    // the leaves' own extents don't cover the whole buffer
+    if(scheme == CS_RADER)
+    {
+        auto count = batch * product(length.begin() + 1, length.end());
+        blueSize = std::max(RaderNode::BufferLength(length[0], count), blueSize);
+    }
+
     for(auto& child : childNodes)
         child->DetermineBufferMemory(tmpBufSize, cmplxForRealSize, blueSize, chirpSize);
 }
@@ -3602,6 +7333,8 @@ void TreeNode::Print(rocfft_ostream& os, const int indent) const
         os << "\n" << indentStr << "large1D: " << large1D;
         os << "\n" << indentStr << "largeTwdBase: " << largeTwdBase;
         os << "\n" << indentStr << "largeTwdSteps: " << ltwdSteps;
+        if(largeTwdCompute)
+            os << "\n" << indentStr << "largeTwdCompute: true";
     }
     if(twiddles)
     {
@@ -3627,6 +7360,15 @@ void TreeNode::Print(rocfft_ostream& os, const int indent) const
     case EmbeddedType::Real2C_POST:
         os << indentStr << "EmbeddedType: Real2C_POST\n";
         break;
+    case EmbeddedType::Real2C_ODD:
+        os << indentStr << "EmbeddedType: Real2C_ODD\n";
+        break;
+    case EmbeddedType::C2Real_ODD:
+        os << indentStr << "EmbeddedType: C2Real_ODD\n";
+        break;
+    case EmbeddedType::Real2Real:
+        os << indentStr << "EmbeddedType: Real2Real\n";
+        break;
     }
 
     os << indentStr << "SBRC_Trans_Type: " << PrintSBRCTransposeType(sbrcTranstype);
@@ -3789,8 +7531,10 @@ std::pair<TreeNode*, TreeNode*> ExecPlan::get_load_store_nodes() const
     return std::make_pair(load, store);
 }
 
-void RuntimeCompilePlan(ExecPlan& execPlan)
+void StartRuntimeCompilePlan(ExecPlan& execPlan)
 {
+    RoctxRange range("rocFFT RuntimeCompilePlan");
+
     std::string kernel_name;
     bool        is_tuning = TuningBenchmarker::GetSingleton().IsProcessingTuning();
 
@@ -3813,39 +7557,129 @@ void RuntimeCompilePlan(ExecPlan& execPlan)
         }
     }
 
+    // kernels that fuse a node with the next one are an alternative
+    // to the nodes' own kernels, so tuning doesn't build them
+    if(!is_tuning)
+    {
+        for(size_t i = 0; i + 1 < execPlan.execSeq.size(); ++i)
+            execPlan.execSeq[i]->compiledFusedKernel
+                = RTCKernelStockhamFused::runtime_compile(*execPlan.execSeq[i],
+                                                          *execPlan.execSeq[i + 1],
+                                                          execPlan.deviceProp.gcnArchName);
+    }
+
     TreeNode* load_node             = nullptr;
     TreeNode* store_node            = nullptr;
     std::tie(load_node, store_node) = execPlan.get_load_store_nodes();
 
-    // callbacks are only possible on plans that don't use planar format for input or output
-    bool need_callbacks = !array_type_is_planar(load_node->inArrayType)
-                          && !array_type_is_planar(store_node->outArrayType);
+    // callbacks are only possible on plans that store data natively
+    bool need_callbacks = load_node->loadOps.storage == rocfft_storage_format_native
+                          && store_node->storeOps.storage == rocfft_storage_format_native
+                          && !store_node->storeOps.needs_exclusive_output();
 
     // don't spend time compiling callback
     if(need_callbacks && !is_tuning)
     {
-        load_node->compiledKernelWithCallbacks = RTCKernel::runtime_compile(
-            *load_node, execPlan.deviceProp.gcnArchName, kernel_name, true);
-
-        if(store_node != load_node)
+        // usually only the nodes that touch user memory run
+        // callbacks, but pass callbacks can be set on any node
+        const bool pass_callbacks = execPlan.rootPlan->storeOps.pass_callbacks;
+        for(auto& node : execPlan.execSeq)
         {
-            store_node->compiledKernelWithCallbacks = RTCKernel::runtime_compile(
-                *store_node, execPlan.deviceProp.gcnArchName, kernel_name, true);
+            if(node != load_node && node != store_node && !pass_callbacks)
+                continue;
+            node->compiledKernelWithCallbacks = RTCKernel::runtime_compile(
+                *node, execPlan.deviceProp.gcnArchName, kernel_name, true);
         }
     }
+}
+
+void FinishRuntimeCompilePlan(ExecPlan& execPlan)
+{
+    bool is_tuning = TuningBenchmarker::GetSingleton().IsProcessingTuning();
 
     // All of the compilations are started in parallel (via futures),
     // so resolve the futures now.  That ensures that the plan is
     // ready to run as soon as the caller gets the plan back.
     for(auto& node : execPlan.execSeq)
     {
+        // unless the node can run a generic kernel while its own
+        // kernel keeps compiling in the background
+        if(!is_tuning && node->compiledKernel.valid()
+           && node->compiledKernel.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            node->genericKernel
+                = RTCKernelGeneric::generate_from_node(*node, execPlan.deviceProp.gcnArchName);
+            if(node->genericKernel)
+                continue;
+        }
+
         if(node->compiledKernel.valid())
             node->compiledKernel.get();
         if(node->compiledKernelWithCallbacks.valid())
             node->compiledKernelWithCallbacks.get();
+
+        // only runtime-compiled kernels can convert storage formats
+        if((node->loadOps.storage != rocfft_storage_format_native
+            || node->storeOps.storage != rocfft_storage_format_native)
+           && !node->compiledKernel.get())
+            throw std::runtime_error(std::string("storage format not supported by ")
+                                     + PrintScheme(node->scheme));
+
+        // and only they can fuse windowing, zero padding or a
+        // convolution's spectrum multiply
+        if((node->loadOps.window || !node->loadOps.valid_lengths.empty())
+           && !node->compiledKernel.get())
+            throw std::runtime_error(std::string("input window/padding not supported by ")
+                                     + PrintScheme(node->scheme));
+        if(node->loadOps.frame_window && node->scheme != CS_KERNEL_STOCKHAM)
+            throw std::runtime_error(std::string("frame window not supported by ")
+                                     + PrintScheme(node->scheme));
+        if(node->storeOps.multiply_buffer && !node->compiledKernel.get())
+            throw std::runtime_error(std::string("spectrum multiply not supported by ")
+                                     + PrintScheme(node->scheme));
+        if(node->storeOps.needs_exclusive_output() && !node->compiledKernel.get())
+            throw std::runtime_error(std::string("output op not supported by ")
+                                     + PrintScheme(node->scheme));
+
+        // callbacks given as source only exist in the kernel built
+        // with callbacks
+        if((!node->loadOps.callback.empty() || !node->storeOps.callback.empty()) && !is_tuning
+           && !(node->compiledKernelWithCallbacks.valid()
+                && node->compiledKernelWithCallbacks.get()))
+            throw std::runtime_error(std::string("inline callback not supported by ")
+                                     + PrintScheme(node->scheme));
+    }
+
+    // nodes that don't get a fused kernel run their own kernels.  A
+    // node running a generic kernel doesn't wait for one either.
+    for(size_t i = 0; i < execPlan.execSeq.size(); ++i)
+    {
+        auto& fused = execPlan.execSeq[i]->compiledFusedKernel;
+        if(!fused.valid())
+            continue;
+        if(execPlan.execSeq[i]->genericKernel || execPlan.execSeq[i + 1]->genericKernel)
+        {
+            fused = {};
+            continue;
+        }
+        try
+        {
+            if(!fused.get())
+                fused = {};
+        }
+        catch(std::exception&)
+        {
+            fused = {};
+        }
     }
 }
 
+void RuntimeCompilePlan(ExecPlan& execPlan)
+{
+    StartRuntimeCompilePlan(execPlan);
+    FinishRuntimeCompilePlan(execPlan);
+}
+
 // Input a node, get the representative prob-token as the key of solution-map
 void GetNodeToken(const TreeNode& probNode, std::string& min_token, std::string& full_token)
 {
@@ -3893,7 +7727,13 @@ void GetNodeToken(const TreeNode& probNode, std::string& min_token, std::string&
                           || (probNode.outArrayType == rocfft_array_type_real));
     bool is_fwd        = (probNode.direction == -1);
 
-    if(is_real_trans)
+    if(probNode.scheme == CS_REAL_TO_REAL)
+    {
+        // real-to-real problems must not pick up R2C/C2R solutions
+        token += "r2r_" + std::to_string(probNode.r2rType);
+        min_token = token;
+    }
+    else if(is_real_trans)
     {
         token += "real_";
         token += (is_fwd) ? "fwd" : "bwd";
@@ -3925,7 +7765,9 @@ void GetNodeToken(const TreeNode& probNode, std::string& min_token, std::string&
 }
 
 // generate all possible keys from a root problem, try them all to find a solution.
-void GenerateProbKeys(const TreeNode& probNode, std::vector<ProblemKey>& possibleKeys)
+void GenerateProbKeys(const TreeNode&          probNode,
+                      const solution_map&      sol_map,
+                      std::vector<ProblemKey>& possibleKeys)
 {
     possibleKeys.clear();
 
@@ -3934,7 +7776,20 @@ void GenerateProbKeys(const TreeNode& probNode, std::vector<ProblemKey>& possibl
     std::string archName = get_arch_name(probNode.deviceProp);
     GetNodeToken(probNode, min_token, full_token);
 
-    for(auto arch : {archName, std::string("any")})
+    // solutions tuned for this device's CU bucket come first, then the
+    // arch's own solutions.  solutions transferred from a similar
+    // arch come before the generic ones
+    std::vector<std::string> archs;
+    auto bucketArch = solution_map::get_cu_bucket_arch(archName, probNode.deviceProp);
+    if(!bucketArch.empty())
+        archs.push_back(bucketArch);
+    archs.push_back(archName);
+    const auto& transferArch = sol_map.get_transfer_arch();
+    if(!transferArch.empty())
+        archs.push_back(transferArch);
+    archs.push_back("any");
+
+    for(const auto& arch : archs)
     {
         for(auto prob_token : {full_token, min_token})
         {
@@ -3947,10 +7802,11 @@ void GenerateProbKeys(const TreeNode& probNode, std::vector<ProblemKey>& possibl
 // recursively apply the solutions (breadth-first)
 // return: A pointer of a sub-scheme-tree
 // If solution is a kernel, append the kernel_key to the output vector
-std::unique_ptr<SchemeTree>
-    RecursivelyApplySol(const ProblemKey& problemKey, ExecPlan& execPlan, size_t sol_option)
+std::unique_ptr<SchemeTree> RecursivelyApplySol(const ProblemKey& problemKey,
+                                                solution_map&     sol_map_single,
+                                                ExecPlan&         execPlan,
+                                                size_t            sol_option)
 {
-    auto& sol_map_single = solution_map::get_solution_map();
     if(!sol_map_single.has_solution_node(problemKey, sol_option))
         return nullptr;
 
@@ -3981,7 +7837,8 @@ std::unique_ptr<SchemeTree>
         for(auto& child_node : sol_node.solution_childnodes)
         {
             ProblemKey probKey(arch, child_node.child_token);
-            auto childScheme = RecursivelyApplySol(probKey, execPlan, child_node.child_option);
+            auto childScheme = RecursivelyApplySol(
+                probKey, sol_map_single, execPlan, child_node.child_option);
             if(!childScheme)
                 return nullptr;
 
@@ -4078,18 +7935,52 @@ std::unique_ptr<SchemeTree>
     return curScheme;
 }
 
+std::unique_ptr<SchemeTree> SchemeTreeOf(const TreeNode& node)
+{
+    auto scheme = std::make_unique<SchemeTree>(node.scheme);
+    for(const auto& child : node.childNodes)
+    {
+        scheme->children.emplace_back(SchemeTreeOf(*child));
+        scheme->numKernels += scheme->children.back()->numKernels;
+    }
+    if(node.childNodes.empty())
+        scheme->numKernels = 1;
+    return scheme;
+}
+
+std::unique_ptr<SchemeTree> CopySchemeTree(const SchemeTree& scheme)
+{
+    auto copy        = std::make_unique<SchemeTree>(scheme.curScheme);
+    copy->numKernels = scheme.numKernels;
+    for(const auto& child : scheme.children)
+        copy->children.emplace_back(CopySchemeTree(*child));
+    return copy;
+}
+
 std::unique_ptr<SchemeTree> ApplySolution(ExecPlan& execPlan)
 {
+    RoctxRange      range("rocFFT ApplySolution");
+    PlanCreateTimer timer(PCP_SOLUTION_MAP);
+
     std::vector<ProblemKey>     possibleKeys;
     std::unique_ptr<SchemeTree> rootNodeScheme = nullptr;
-    GenerateProbKeys(*(execPlan.rootPlan), possibleKeys);
+
+    // hold on to the current map for the whole lookup, so a reload
+    // in the meantime doesn't mix solutions from two maps
+    auto sol_map = solution_map::acquire_solution_map();
+    GenerateProbKeys(*(execPlan.rootPlan), *sol_map, possibleKeys);
 
     for(const auto& probKey : possibleKeys)
     {
         // found a valid solution-tree-decomposition
-        rootNodeScheme = RecursivelyApplySol(probKey, execPlan, 0);
+        rootNodeScheme = RecursivelyApplySol(probKey, *sol_map, execPlan, 0);
         if(rootNodeScheme)
+        {
+            execPlan.transferredSolution
+                = probKey.arch == sol_map->get_transfer_arch();
+            execPlan.solutionNumCUs = solution_map::get_arch_num_CUs(probKey.arch);
             break;
+        }
 
         execPlan.solution_kernels = EmptyFMKeyVec;
     }
@@ -4097,11 +7988,235 @@ std::unique_ptr<SchemeTree> ApplySolution(ExecPlan& execPlan)
     return rootNodeScheme;
 }
 
+// Output pruning keeps a range of bins in each output dimension.
+// When the last kernel's batch-like dimensions (those past its FFT
+// dimension) are output dimensions, sub-transforms outside the kept
+// range would only be discarded, so shrink those dimensions to the
+// kept range and offset the kernel's buffers to its start instead.
+static void PruneStoreNode(ExecPlan& execPlan)
+{
+    auto node = execPlan.execSeq.back();
+    auto& ops = node->storeOps;
+    if(ops.kept_lengths.empty())
+        return;
+
+    // only kernels whose dimensions past the first are plain loops
+    // over sub-transforms, and whose other ops don't depend on an
+    // element's position relative to the buffer pointers
+    if(node->scheme != CS_KERNEL_STOCKHAM && node->scheme != CS_KERNEL_STOCKHAM_BLOCK_CC)
+        return;
+    if(node->large1D != 0 || node->fuseBlue != BluesteinFuseType::BFT_NONE
+       || node->ebtype != EmbeddedType::NONE)
+        return;
+    if(node->loadOps.window || !node->loadOps.valid_lengths.empty() || ops.multiply_buffer)
+        return;
+
+    const auto& root          = *execPlan.rootPlan;
+    const auto& outputLengths = root.outputLength.empty() ? root.length : root.outputLength;
+    for(size_t i = 1; i < node->length.size(); ++i)
+    {
+        for(size_t d = 0; d < ops.kept_lengths.size(); ++d)
+        {
+            // the node's dimension must be exactly one output
+            // dimension, not several collapsed together
+            auto rootDim = std::find(root.outStride.begin(), root.outStride.end(), node->outStride[i]);
+            if(node->outStride[i] != ops.kept_strides[d] || rootDim == root.outStride.end()
+               || outputLengths[rootDim - root.outStride.begin()] != node->length[i]
+               || ops.kept_lengths[d] == node->length[i])
+                continue;
+
+            node->iOffset += ops.kept_starts[d] * node->inStride[i];
+            node->oOffset += ops.kept_starts[d] * node->outStride[i];
+            node->length[i]    = ops.kept_lengths[d];
+            ops.kept_starts[d] = 0;
+            break;
+        }
+    }
+}
+
+// Input zero padding loads elements past the valid lengths as zero.
+// When the first kernel's batch-like dimensions are padded input
+// dimensions, the sub-transforms past the valid lengths only see
+// zeros and produce zeros, so shrink those dimensions to the valid
+// lengths and have the next kernel load the skipped part of their
+// output as zero instead of reading it.
+static void ZeroPadLoadNode(ExecPlan& execPlan)
+{
+    if(execPlan.execSeq.size() < 2)
+        return;
+    auto        node = execPlan.execSeq[0];
+    auto        next = execPlan.execSeq[1];
+    const auto& ops  = node->loadOps;
+    const auto& root = *execPlan.rootPlan;
+    if(ops.valid_lengths.empty() || node->obIn != root.obIn)
+        return;
+
+    if(node->scheme != CS_KERNEL_STOCKHAM && node->scheme != CS_KERNEL_STOCKHAM_BLOCK_CC)
+        return;
+    if(node->large1D != 0 || node->fuseBlue != BluesteinFuseType::BFT_NONE
+       || node->ebtype != EmbeddedType::NONE || !node->outputLength.empty() || node->oOffset != 0)
+        return;
+
+    // the next kernel must be the only reader of this kernel's
+    // output, and able to fuse zero padding into its loads
+    switch(next->scheme)
+    {
+    case CS_KERNEL_STOCKHAM:
+    case CS_KERNEL_STOCKHAM_BLOCK_CC:
+    case CS_KERNEL_STOCKHAM_BLOCK_RC:
+    case CS_KERNEL_STOCKHAM_BLOCK_CR:
+    case CS_KERNEL_TRANSPOSE:
+    case CS_KERNEL_TRANSPOSE_XY_Z:
+    case CS_KERNEL_TRANSPOSE_Z_XY:
+        break;
+    default:
+        return;
+    }
+    if(next->obIn != node->obOut || next->iOffset != 0
+       || next->inArrayType != rocfft_array_type_complex_interleaved
+       || node->outArrayType != rocfft_array_type_complex_interleaved)
+        return;
+    if(next->loadOps.enabled() || !next->loadOps.callback.empty() || next->large1D != 0
+       || next->fuseBlue != BluesteinFuseType::BFT_NONE || next->ebtype != EmbeddedType::NONE)
+        return;
+
+    // the next kernel peels coordinates off offsets in this kernel's
+    // output, which needs each dimension to nest inside the next
+    // slower one
+    std::vector<size_t> order(node->length.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [node](size_t a, size_t b) {
+        return node->outStride[a] < node->outStride[b];
+    });
+    for(size_t i = 1; i < order.size(); ++i)
+    {
+        if(node->outStride[order[i]]
+           < node->outStride[order[i - 1]] * node->length[order[i - 1]])
+            return;
+    }
+    const size_t span = node->outStride[order.back()] * node->length[order.back()];
+    if(node->batch > 1 && node->oDist < span)
+        return;
+
+    bool shrunk = false;
+    for(size_t i = 1; i < node->length.size(); ++i)
+    {
+        for(size_t d = 0; d < ops.valid_lengths.size(); ++d)
+        {
+            // as with output pruning, the node's dimension must be
+            // exactly one input dimension
+            auto rootDim = std::find(root.inStride.begin(), root.inStride.end(), node->inStride[i]);
+            if(node->inStride[i] != ops.valid_strides[d] || rootDim == root.inStride.end()
+               || root.length[rootDim - root.inStride.begin()] != node->length[i]
+               || ops.valid_lengths[d] >= node->length[i])
+                continue;
+
+            node->length[i] = ops.valid_lengths[d];
+            shrunk          = true;
+            break;
+        }
+    }
+    if(!shrunk)
+        return;
+
+    next->loadOps.valid_lengths = node->length;
+    next->loadOps.set_layout(node->outStride, node->batch > 1 ? node->oDist : span);
+}
+
+// Solutions choose transforms per block for the CU count they were
+// tuned on.  When a solution was tuned on a device with a different
+// number of CUs (e.g. a full GPU's solution on a partition of it),
+// re-derive the transforms per block of batched Stockham kernels so
+// that each CU gets about as many blocks as it did on the tuned
+// device.
+static void RederiveSolutionGrids(ExecPlan& execPlan)
+{
+    // LDS and workgroup size bounds that the tuner uses for candidates
+    static const size_t LDS_BYTE_LIMIT = 32 * 1024;
+    static const size_t MAX_WGS        = 1024;
+
+    int deviceCUs = execPlan.deviceProp.multiProcessorCount;
+    int tunedCUs  = execPlan.solutionNumCUs;
+    if(tunedCUs <= 0 || deviceCUs <= 0)
+        return;
+    // compare at the granularity of CU buckets
+    if(std::floor(std::log2(tunedCUs)) == std::floor(std::log2(deviceCUs)))
+        return;
+
+    for(auto node : execPlan.execSeq)
+    {
+        if(node->scheme != CS_KERNEL_STOCKHAM || !node->specified_key)
+            continue;
+
+        auto& config = node->specified_key->kernel_config;
+        // leave default kernels, and kernels with large twiddles in
+        // LDS, alone
+        if(config.workgroup_size == 0 || config.transforms_per_block == 0
+           || config.threads_per_transform[0] <= 0 || config.use_3steps_large_twd)
+            continue;
+
+        size_t batch_accum = node->batch;
+        for(size_t i = 1; i < node->length.size(); ++i)
+            batch_accum *= node->length[i];
+
+        size_t tpb          = config.transforms_per_block;
+        size_t tpt          = config.threads_per_transform[0];
+        double tuned_blocks = DivRoundingUp<size_t>(batch_accum, tpb);
+        // the tuned device wasn't filled either, so there is nothing
+        // to spread
+        if(tuned_blocks < tunedCUs)
+            continue;
+
+        double target_blocks = tuned_blocks / tunedCUs * deviceCUs;
+        size_t new_tpb       = std::max<size_t>(
+            1, static_cast<size_t>(std::ceil(static_cast<double>(batch_accum) / target_blocks)));
+
+        size_t length          = node->length[0];
+        size_t bytes_per_batch = length * complex_type_size(node->precision);
+        if(config.half_lds)
+            bytes_per_batch /= 2;
+        auto valid_tpb = [&](size_t t) {
+            size_t wgs = t * tpt;
+            if(wgs > MAX_WGS || (length >= 64 && wgs < 64))
+                return false;
+            if(IsPo2(length) && length % wgs != 0)
+                return false;
+            // never need more LDS than the tuned kernel, or the tuner allows
+            return t <= tpb || t * bytes_per_batch <= LDS_BYTE_LIMIT;
+        };
+        // step back towards the tuned value until the config is valid
+        while(new_tpb != tpb && !valid_tpb(new_tpb))
+        {
+            if(new_tpb < tpb)
+                ++new_tpb;
+            else
+                --new_tpb;
+        }
+        if(new_tpb == tpb)
+            continue;
+
+        if(LOG_TRACE_ENABLED())
+            (*LogSingleton::GetInstance().GetTraceOS())
+                << "solution kernel was tuned on " << tunedCUs << " CUs, device has "
+                << deviceCUs << ": transforms per block " << tpb << " -> " << new_tpb
+                << std::endl;
+
+        config.transforms_per_block = new_tpb;
+        config.workgroup_size       = new_tpb * tpt;
+        function_pool::add_new_kernel(*node->specified_key);
+    }
+}
+
 void ProcessNode(ExecPlan& execPlan)
 {
+    // builds the tree of nodes, and compiles their kernels
+    RoctxRange range("rocFFT ProcessNode");
+
     SchemeTree* rootScheme = (execPlan.rootScheme) ? execPlan.rootScheme.get() : nullptr;
-    bool        noSolution = (rootScheme == nullptr);
+    // a replayed plan can have a scheme tree without solution kernels
+    bool noSolution = (rootScheme == nullptr) || execPlan.solution_kernels.empty();
 
+    PlanCreateTimer buildTreeTimer(PCP_BUILD_TREE);
     execPlan.rootPlan->RecursiveBuildTree(rootScheme);
 
     assert(execPlan.rootPlan->length.size() == execPlan.rootPlan->inStride.size());
@@ -4109,9 +8224,19 @@ void ProcessNode(ExecPlan& execPlan)
 
     // collect leaf-nodes to execSeq and fuseShims
     execPlan.rootPlan->CollectLeaves(execPlan.execSeq, execPlan.fuseShims);
+    buildTreeTimer.Stop();
+
+    // remember the decisions made for this plan, so it can be
+    // serialized.  SanityCheck consumes solution_kernels.
+    execPlan.decisions                   = std::make_shared<PlanDecisions>();
+    execPlan.decisions->arch             = get_arch_name(execPlan.deviceProp);
+    execPlan.decisions->scheme           = SchemeTreeOf(*execPlan.rootPlan);
+    execPlan.decisions->solution_kernels = execPlan.solution_kernels;
+    execPlan.decisions->solutionNumCUs   = execPlan.solutionNumCUs;
 
     if(noSolution)
     {
+        ProposeAdjacentFusions(execPlan);
         CheckFuseShimForArch(execPlan);
         OrderFuseShims(execPlan.execSeq, execPlan.fuseShims);
     }
@@ -4123,17 +8248,22 @@ void ProcessNode(ExecPlan& execPlan)
         execPlan.rootPlan->obIn
             = execPlan.rootPlan->placement == rocfft_placement_inplace ? OB_USER_OUT : OB_USER_IN;
 
-    // guarantee min buffers but possible less fusions
-    // execPlan.assignOptStrategy = rocfft_optimize_min_buffer;
-    // starting from ABT
-    execPlan.assignOptStrategy = rocfft_optimize_balance;
-    // try to use all buffer to get most fusion
-    //execPlan.assignOptStrategy = rocfft_optimize_max_fusion;
+    // assignOptStrategy defaults to balance (starting from ABT), but
+    // the plan description may ask for minimal buffers (possibly
+    // fewer fusions).  rocfft_optimize_max_fusion would try to use all
+    // buffers to get the most fusion.
+    PlanCreateTimer  assignTimer(PCP_BUFFER_ASSIGNMENT);
     AssignmentPolicy policy;
-    policy.AssignBuffers(execPlan);
+    if(!execPlan.restore || !policy.RestoreBuffers(execPlan, execPlan.restore->buffers))
+        policy.AssignBuffers(execPlan);
+    assignTimer.Stop();
+    for(auto node : execPlan.execSeq)
+        execPlan.decisions->buffers.push_back(
+            {node->obIn, node->obOut, node->inArrayType, node->outArrayType});
 
     if(TuningBenchmarker::GetSingleton().IsProcessingTuning() == false)
     {
+        PlanCreateTimer fusionTimer(PCP_FUSION);
         // Apply the fusion after buffer, strides are assigned
         execPlan.rootPlan->ApplyFusion();
 
@@ -4146,7 +8276,10 @@ void ProcessNode(ExecPlan& execPlan)
     execPlan.rootPlan->RefreshTree();
 
     // add padding if necessary
-    policy.PadPlan(execPlan);
+    {
+        PlanCreateTimer padTimer(PCP_BUFFER_ASSIGNMENT);
+        policy.PadPlan(execPlan);
+    }
 
     // Collapse high dims on leaf nodes where possible
     execPlan.rootPlan->CollapseContiguousDims();
@@ -4156,7 +8289,8 @@ void ProcessNode(ExecPlan& execPlan)
     {
         // rootScheme might be nullptr and solution_kernels might be empty (when no solution)
         // if has solution, will also check if it's valid
-        execPlan.rootPlan->SanityCheck(rootScheme, execPlan.solution_kernels);
+        execPlan.rootPlan->SanityCheck(noSolution ? nullptr : rootScheme,
+                                       execPlan.solution_kernels);
     }
     catch(const std::exception& e)
     {
@@ -4175,6 +8309,9 @@ void ProcessNode(ExecPlan& execPlan)
         }
     }
 
+    if(!TuningBenchmarker::GetSingleton().IsProcessingTuning())
+        RederiveSolutionGrids(execPlan);
+
     // get workBufSize..
     size_t tmpBufSize       = 0;
     size_t cmplxForRealSize = 0;
@@ -4182,7 +8319,7 @@ void ProcessNode(ExecPlan& execPlan)
     size_t chirpSize        = 0;
     execPlan.rootPlan->DetermineBufferMemory(tmpBufSize, cmplxForRealSize, blueSize, chirpSize);
 
-    if(execPlan.rootPlan->loadOps.enabled())
+    if(execPlan.rootPlan->loadOps.enabled() || !execPlan.rootPlan->loadOps.callback.empty())
     {
         // Load ops happen on first node that reads input
         auto load_node = std::find_if(
@@ -4192,7 +8329,7 @@ void ProcessNode(ExecPlan& execPlan)
         (*load_node)->loadOps = execPlan.rootPlan->loadOps;
     }
 
-    if(execPlan.rootPlan->storeOps.enabled())
+    if(execPlan.rootPlan->storeOps.enabled() || !execPlan.rootPlan->storeOps.callback.empty())
     {
         // Store ops happen on last node of the plan that writes
         // output
@@ -4203,14 +8340,54 @@ void ProcessNode(ExecPlan& execPlan)
         (*store_node)->storeOps = execPlan.rootPlan->storeOps;
     }
 
-    // compile kernels for applicable nodes
-    RuntimeCompilePlan(execPlan);
+    // User buffers hold data in the plan's storage format for the
+    // whole transform, so every node that reads or writes them
+    // converts, not just the first and last ones.  The input buffer
+    // is in the input format, and the output buffer (which is also
+    // the input for in-place transforms, whose formats must match)
+    // is in the output format.
+    for(auto node : execPlan.execSeq)
+    {
+        if(node->obIn == OB_USER_IN)
+            node->loadOps.storage = execPlan.rootPlan->loadOps.storage;
+        else if(node->obIn == OB_USER_OUT)
+            node->loadOps.storage = execPlan.rootPlan->storeOps.storage;
+        if(node->obOut == OB_USER_IN)
+            node->storeOps.storage = execPlan.rootPlan->loadOps.storage;
+        else if(node->obOut == OB_USER_OUT)
+            node->storeOps.storage = execPlan.rootPlan->storeOps.storage;
+    }
+
+    ZeroPadLoadNode(execPlan);
+    PruneStoreNode(execPlan);
+
+    // nothing in the plan reads what its last kernel writes to the
+    // output buffer, so those stores needn't stay in the caches,
+    // where they'd evict data the next pass wants
+    if(!execPlan.execSeq.empty() && execPlan.execSeq.back()->obOut == execPlan.rootPlan->obOut)
+        execPlan.execSeq.back()->nontemporalStores = true;
+
+    // compile kernels for applicable nodes.  The compiles are
+    // finished once the plan's tables are set up, so that building
+    // twiddles and kernel arguments overlaps with them.
+    StartRuntimeCompilePlan(execPlan);
 
     execPlan.workBufSize      = tmpBufSize + cmplxForRealSize + blueSize + chirpSize;
     execPlan.tmpWorkBufSize   = tmpBufSize;
     execPlan.copyWorkBufSize  = cmplxForRealSize;
     execPlan.blueWorkBufSize  = blueSize;
     execPlan.chirpWorkBufSize = chirpSize;
+
+    // a fused kernel's grid barrier counts in one complex element at
+    // the end of the work buffer, which keeps it with the rest of an
+    // execution's temporary data
+    if(std::any_of(execPlan.execSeq.begin(), execPlan.execSeq.end(), [](const TreeNode* node) {
+           return node->compiledFusedKernel.valid();
+       }))
+    {
+        execPlan.barrierWorkBufSize = 1;
+        execPlan.workBufSize += execPlan.barrierWorkBufSize;
+    }
 }
 
 void PrintNode(rocfft_ostream& os, const ExecPlan& execPlan, const int indent)
@@ -4246,6 +8423,14 @@ void PrintNode(rocfft_ostream& os, const ExecPlan& execPlan, const int indent)
     }
     os << indentStr << "End GridParams\n";
 
+    if(!execPlan.execLanes.empty())
+    {
+        os << indentStr << "Stream lanes:";
+        for(auto lane : execPlan.execLanes)
+            os << " " << lane;
+        os << "\n";
+    }
+
     os << indentStr
        << "======================================================================"
           "========="
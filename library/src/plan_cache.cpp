@@ -0,0 +1,219 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "plan_cache.h"
+#include "../../shared/environment.h"
+#include "logging.h"
+#include "plan.h"
+#include "tuning_helper.h"
+
+#include <sstream>
+
+PlanCache::PlanCache()
+{
+    auto env_size = rocfft_getenv("ROCFFT_PLAN_CACHE_SIZE");
+    if(!env_size.empty())
+    {
+        try
+        {
+            max_entries = std::stoull(env_size);
+        }
+        catch(std::exception&)
+        {
+            max_entries = 0;
+        }
+    }
+}
+
+bool PlanCache::Cacheable(const rocfft_plan_t& plan) const
+{
+    if(max_entries == 0)
+        return false;
+
+    // only plain single-device plans are cached - multi-device and
+    // multi-process plans own temp buffers and communication state.
+    // Descriptions with a device list are distributed over those
+    // devices, which the key doesn't record.
+    if(plan.desc.comm_type != rocfft_comm_none || !plan.desc.inFields.empty()
+       || !plan.desc.outFields.empty() || !plan.desc.devices.empty())
+        return false;
+
+    // tuning enumerates and benchmarks different trees for the same
+    // problem, so those must always be rebuilt
+    if(TuningBenchmarker::GetSingleton().IsInitializingTuning()
+       || TuningBenchmarker::GetSingleton().IsProcessingTuning())
+        return false;
+
+    // compile-only plans are not executable
+    if(rocfft_getenv("ROCFFT_INTERNAL_COMPILE_ONLY") == "1")
+        return false;
+
+    return true;
+}
+
+std::string PlanCache::MakeKey(const rocfft_plan_t&   plan,
+                               const hipDeviceProp_t& deviceProp,
+                               int                    deviceId)
+{
+    // the bench command already covers lengths, batch, placement,
+    // transform type, precision, array types, strides, distances and
+    // offsets
+    std::stringstream key;
+    key << rocfft_bench_command(&plan);
+    // load and store ops are not part of the bench command, print
+    // the scale factors exactly
+    key << " --scale " << std::hexfloat << plan.desc.storeOps.scale_factor;
+    key << " --input-scale " << std::hexfloat << plan.desc.loadOps.scale_factor;
+    key << " --storage " << storage_format_name(plan.desc.loadOps.storage) << " "
+        << storage_format_name(plan.desc.storeOps.storage);
+    key << " --output-op " << output_op_name(plan.desc.storeOps.output_op);
+    key << " --accumulate " << plan.desc.storeOps.accumulate;
+    if(!plan.desc.loadOps.callback.empty())
+        key << " --load-cb " << plan.desc.loadOps.callback.hash();
+    if(!plan.desc.storeOps.callback.empty())
+        key << " --store-cb " << plan.desc.storeOps.callback.hash();
+    if(plan.desc.storeOps.pass_callbacks)
+        key << " --pass-callbacks";
+    // the window is read in place, so plans are only equivalent if
+    // they read the same array
+    key << " --input-window " << plan.desc.loadOps.window;
+    if(plan.desc.loadOps.frame_window)
+        key << " --frame-window";
+    key << " --input-valid-lengths";
+    for(auto len : plan.desc.loadOps.valid_lengths)
+        key << " " << len;
+    key << " --output-kept-range";
+    for(size_t i = 0; i < plan.desc.storeOps.kept_lengths.size(); ++i)
+        key << " " << plan.desc.storeOps.kept_starts[i] << " "
+            << plan.desc.storeOps.kept_lengths[i];
+    // packed Hermitian data has different lengths and kernels
+    if(plan.desc.packedHermitian)
+        key << " --packed-hermitian";
+    key << " --strategy " << plan.desc.assignOptStrategy;
+    key << " --batch-tile " << plan.desc.batchTile;
+    // kernels are sized for the CUs a plan is confined to
+    key << " --cu-mask";
+    for(auto word : plan.desc.cuMask)
+        key << " " << std::hex << word << std::dec;
+    // plans on host buffers stage their data through the device
+    if(plan.desc.hostBuffers)
+        key << " --host-buffers";
+    // plans built without measuring may have chosen other kernels
+    if(plan.desc.measureAccessModes)
+        key << " --measure-access-modes";
+    key << " --device " << deviceId << " " << deviceProp.gcnArchName;
+    return key.str();
+}
+
+std::unique_ptr<ExecPlan> PlanCache::ShareExecPlan(const ExecPlan& execPlan)
+{
+    auto ret = std::make_unique<ExecPlan>();
+
+    ret->description = execPlan.description;
+    ret->group       = execPlan.group;
+
+    ret->location    = execPlan.location;
+    ret->mgpuPlan    = execPlan.mgpuPlan;
+    ret->inputPtr    = execPlan.inputPtr;
+    ret->outputPtr   = execPlan.outputPtr;
+    ret->tablesReady = execPlan.tablesReady;
+
+    // tree is shared, along with the leaf nodes that point into it
+    ret->rootPlan         = execPlan.rootPlan;
+    ret->execSeq          = execPlan.execSeq;
+    ret->solution_kernels = execPlan.solution_kernels;
+    ret->fuseShims        = execPlan.fuseShims;
+
+    ret->devFnCall = execPlan.devFnCall;
+    ret->gridParam = execPlan.gridParam;
+
+    ret->execLanes     = execPlan.execLanes;
+    ret->execWaits     = execPlan.execWaits;
+    ret->execSignals   = execPlan.execSignals;
+    ret->execLaneCount = execPlan.execLaneCount;
+    ret->slabRuns      = execPlan.slabRuns;
+
+    ret->deviceProp = execPlan.deviceProp;
+    ret->iLength    = execPlan.iLength;
+    ret->oLength    = execPlan.oLength;
+
+    ret->decisions = execPlan.decisions;
+
+    ret->IsChirpPlan       = execPlan.IsChirpPlan;
+    ret->assignOptStrategy = execPlan.assignOptStrategy;
+
+    ret->workBufSize      = execPlan.workBufSize;
+    ret->tmpWorkBufSize   = execPlan.tmpWorkBufSize;
+    ret->copyWorkBufSize  = execPlan.copyWorkBufSize;
+    ret->blueWorkBufSize  = execPlan.blueWorkBufSize;
+    ret->chirpWorkBufSize = execPlan.chirpWorkBufSize;
+
+    ret->barrierWorkBufSize = execPlan.barrierWorkBufSize;
+
+    ret->isUnitStride = execPlan.isUnitStride;
+    return ret;
+}
+
+std::unique_ptr<ExecPlan> PlanCache::Get(const std::string& key)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    auto it = entries.find(key);
+    if(it == entries.end())
+        return nullptr;
+
+    // mark as most recently used
+    lru.splice(lru.begin(), lru, it->second.lru_pos);
+
+    if(LOG_PLAN_ENABLED())
+    {
+        if(LOG_JSON_ENABLED())
+            log_json_arguments(
+                *LogSingleton::GetInstance().GetPlanOS(), "plan_cache_hit", "key", key);
+        else
+            *LogSingleton::GetInstance().GetPlanOS() << "plan cache hit: " << key << std::endl;
+    }
+    return ShareExecPlan(*it->second.execPlan);
+}
+
+void PlanCache::Put(const std::string& key, const ExecPlan& execPlan)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if(max_entries == 0 || entries.count(key))
+        return;
+
+    // evict least-recently-used entries to make room
+    while(entries.size() >= max_entries)
+    {
+        entries.erase(lru.back());
+        lru.pop_back();
+    }
+
+    lru.push_front(key);
+    entries.emplace(key, entry_t{ShareExecPlan(execPlan), lru.begin()});
+}
+
+void PlanCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.clear();
+    lru.clear();
+}
@@ -0,0 +1,378 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Serialized plans are written in the same text format as the
+// solution map, preceded by a header line holding the format
+// version and a checksum of the rest of the buffer:
+//
+//   rocfft_plan <version> <checksum>
+//   {"arch":...,"lengths":[ ... ],...,"buffers":[ ... ]}
+//
+// The plan's parameters are enough to create the plan from
+// scratch.  The decisions that follow them are only replayed on a
+// device of the same arch.
+
+#include "data_descriptor.h"
+#include "logging.h"
+#include "plan.h"
+#include "rocfft/rocfft.h"
+#include "solution_map.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <regex>
+#include <sstream>
+
+#define REGEX "[^:;,\"\\{\\}\\[\\s]+"
+
+static const char* PLAN_MAGIC   = "rocfft_plan";
+static const int   PLAN_VERSION = 2;
+
+// doubles are written as hex floats so they round-trip exactly
+static std::string double_to_str(double value)
+{
+    std::stringstream ss;
+    ss << std::hexfloat << value;
+    return ss.str();
+}
+
+// flatten a scheme tree in pre-order, with the number of children
+// of each node
+static void FlattenSchemeTree(const SchemeTree&         scheme,
+                              std::vector<std::string>& schemes,
+                              std::vector<size_t>&      childCounts)
+{
+    schemes.push_back(PrintScheme(scheme.curScheme));
+    childCounts.push_back(scheme.children.size());
+    for(const auto& child : scheme.children)
+        FlattenSchemeTree(*child, schemes, childCounts);
+}
+
+static std::unique_ptr<SchemeTree> UnflattenSchemeTree(const std::vector<std::string>& schemes,
+                                                       const std::vector<size_t>& childCounts,
+                                                       size_t&                    pos)
+{
+    if(pos >= schemes.size() || schemes.size() != childCounts.size())
+        throw std::runtime_error("invalid scheme tree");
+    auto   scheme     = std::make_unique<SchemeTree>(StrToComputeScheme(schemes[pos]));
+    size_t childCount = childCounts[pos];
+    ++pos;
+    for(size_t i = 0; i < childCount; ++i)
+    {
+        scheme->children.emplace_back(UnflattenSchemeTree(schemes, childCounts, pos));
+        scheme->numKernels += scheme->children.back()->numKernels;
+    }
+    if(childCount == 0)
+        scheme->numKernels = 1;
+    return scheme;
+}
+
+// Check that a plan can be serialized: it must be a single-device
+// plan whose description does not refer to anything in the process.
+// Device ordinals are specific to the process, so descriptions that
+// name devices are refused too.
+static bool PlanSerializable(const rocfft_plan_t& plan)
+{
+    const auto& desc = plan.desc;
+    if(desc.comm_type != rocfft_comm_none || !desc.inFields.empty() || !desc.outFields.empty())
+        return false;
+    if(!desc.devices.empty())
+        return false;
+    if(desc.loadOps.window || desc.storeOps.multiply_buffer)
+        return false;
+    if(!desc.loadOps.callback.empty() || !desc.storeOps.callback.empty())
+        return false;
+    if(!desc.loadOps.valid_lengths.empty() || !desc.storeOps.kept_lengths.empty())
+        return false;
+
+    auto execPlan = plan.SingleExecPlan();
+    return execPlan && !execPlan->mgpuPlan && execPlan->decisions
+           && execPlan->decisions->scheme;
+}
+
+static std::string SerializePlan(const rocfft_plan_t& plan)
+{
+    const auto& desc      = plan.desc;
+    const auto& decisions = *plan.SingleExecPlan()->decisions;
+
+    // plans hold the complex lengths of real inverse transforms, but
+    // are created with the real lengths
+    const auto& createLengths
+        = plan.transformType == rocfft_transform_type_real_inverse ? plan.outputLengths
+                                                                   : plan.lengths;
+    std::vector<size_t> lengths(createLengths.begin(), createLengths.begin() + plan.rank);
+    std::vector<size_t> inStrides(desc.inStrides.begin(), desc.inStrides.begin() + plan.rank);
+    std::vector<size_t> outStrides(desc.outStrides.begin(), desc.outStrides.begin() + plan.rank);
+    std::vector<size_t> inOffset(desc.inOffset.begin(), desc.inOffset.end());
+    std::vector<size_t> outOffset(desc.outOffset.begin(), desc.outOffset.end());
+    std::vector<size_t> cuMask(desc.cuMask.begin(), desc.cuMask.end());
+
+    std::vector<std::string> schemes;
+    std::vector<size_t>      childCounts;
+    FlattenSchemeTree(*decisions.scheme, schemes, childCounts);
+
+    std::vector<int> buffers;
+    for(const auto& b : decisions.buffers)
+        buffers.insert(buffers.end(), {b.obIn, b.obOut, b.inArrayType, b.outArrayType});
+
+    std::string str = "{";
+    str += FieldDescriptor<std::string>().describe("arch", decisions.arch) + ",";
+    str += FieldDescriptor<std::string>().describe("placement", PrintPlacement(plan.placement))
+           + ",";
+    str += FieldDescriptor<int>().describe("transform_type", plan.transformType) + ",";
+    str += FieldDescriptor<std::string>().describe("precision", PrintPrecision(plan.precision))
+           + ",";
+    str += VectorFieldDescriptor<size_t>().describe("lengths", lengths) + ",";
+    str += FieldDescriptor<size_t>().describe("batch", plan.batch) + ",";
+    str += FieldDescriptor<std::string>().describe("itype", PrintArrayType(desc.inArrayType))
+           + ",";
+    str += FieldDescriptor<std::string>().describe("otype", PrintArrayType(desc.outArrayType))
+           + ",";
+    str += VectorFieldDescriptor<size_t>().describe("istride", inStrides) + ",";
+    str += VectorFieldDescriptor<size_t>().describe("ostride", outStrides) + ",";
+    str += FieldDescriptor<size_t>().describe("idist", desc.inDist) + ",";
+    str += FieldDescriptor<size_t>().describe("odist", desc.outDist) + ",";
+    str += VectorFieldDescriptor<size_t>().describe("ioffset", inOffset) + ",";
+    str += VectorFieldDescriptor<size_t>().describe("ooffset", outOffset) + ",";
+    // normalization has already been folded into the scale factor
+    str += FieldDescriptor<std::string>().describe("input_scale",
+                                                   double_to_str(desc.loadOps.scale_factor))
+           + ",";
+    str += FieldDescriptor<std::string>().describe("scale",
+                                                   double_to_str(desc.storeOps.scale_factor))
+           + ",";
+    str += FieldDescriptor<int>().describe("istorage", desc.loadOps.storage) + ",";
+    str += FieldDescriptor<int>().describe("ostorage", desc.storeOps.storage) + ",";
+    str += FieldDescriptor<int>().describe("output_op", desc.storeOps.output_op) + ",";
+    str += FieldDescriptor<bool>().describe("accumulate", desc.storeOps.accumulate) + ",";
+    str += FieldDescriptor<bool>().describe("pass_callbacks", desc.storeOps.pass_callbacks) + ",";
+    str += FieldDescriptor<int>().describe("strategy", desc.assignOptStrategy) + ",";
+    str += FieldDescriptor<size_t>().describe("batch_tile", desc.batchTile) + ",";
+    str += FieldDescriptor<bool>().describe("host_buffers", desc.hostBuffers) + ",";
+    str += FieldDescriptor<bool>().describe("packed_hermitian", desc.packedHermitian) + ",";
+    str += FieldDescriptor<bool>().describe("measure_access_modes", desc.measureAccessModes)
+           + ",";
+    str += VectorFieldDescriptor<size_t>().describe("cu_mask", cuMask) + ",";
+    str += VectorFieldDescriptor<std::string>().describe("schemes", schemes) + ",";
+    str += VectorFieldDescriptor<size_t>().describe("child_counts", childCounts) + ",";
+    str += VectorFieldDescriptor<FMKey>().describe("solution_kernels", decisions.solution_kernels)
+           + ",";
+    str += FieldDescriptor<int>().describe("solution_num_cus", decisions.solutionNumCUs) + ",";
+    str += VectorFieldDescriptor<int>().describe("buffers", buffers);
+    str += "}";
+
+    std::stringstream ss;
+    ss << PLAN_MAGIC << " " << PLAN_VERSION << " " << std::hash<std::string>{}(str) << "\n"
+       << str;
+    return ss.str();
+}
+
+// Parameters and decisions read from a serialized plan
+struct DeserializedPlan
+{
+    rocfft_result_placement        placement;
+    rocfft_transform_type          transformType;
+    rocfft_precision               precision;
+    std::vector<size_t>            lengths;
+    size_t                         batch = 1;
+    rocfft_plan_description_t      desc;
+    std::shared_ptr<PlanDecisions> decisions = std::make_shared<PlanDecisions>();
+};
+
+// Read a serialized plan, returning false if the buffer is not one
+// written by this version of the library.
+static bool DeserializePlan(const std::string& text, DeserializedPlan& ret)
+{
+    // check the header before parsing anything, since the parser
+    // assumes well-formed input
+    auto headerEnd = text.find('\n');
+    if(headerEnd == std::string::npos)
+        return false;
+    std::stringstream header(text.substr(0, headerEnd));
+    std::string       magic;
+    int               version  = 0;
+    size_t            checksum = 0;
+    if(!(header >> magic >> version >> checksum) || magic != PLAN_MAGIC
+       || version != PLAN_VERSION)
+        return false;
+    const std::string body = text.substr(headerEnd + 1);
+    if(std::hash<std::string>{}(body) != checksum)
+        return false;
+
+    // kernel keys are written in the current solution map format
+    DescriptorFormatVersion::UsingVersion = solution_map::VERSION;
+
+    static std::regex          regEx(REGEX, std::regex_constants::optimize);
+    std::sregex_token_iterator current{body.begin(), body.end(), regEx, 0};
+
+    std::string              placementStr, precisionStr, itypeStr, otypeStr;
+    std::string              inScaleStr, outScaleStr;
+    int                      transformType = 0, inStorage = 0, outStorage = 0, outputOp = 0;
+    int                      strategy      = 0;
+    std::vector<size_t>      inOffset, outOffset, cuMask, childCounts;
+    std::vector<std::string> schemes;
+    std::vector<int>         buffers;
+
+    auto& desc      = ret.desc;
+    auto& decisions = *ret.decisions;
+    FieldParser<std::string>().parse("arch", decisions.arch, current);
+    FieldParser<std::string>().parse("placement", placementStr, current);
+    FieldParser<int>().parse("transform_type", transformType, current);
+    FieldParser<std::string>().parse("precision", precisionStr, current);
+    VectorFieldParser<size_t>().parse("lengths", ret.lengths, current);
+    FieldParser<size_t>().parse("batch", ret.batch, current);
+    FieldParser<std::string>().parse("itype", itypeStr, current);
+    FieldParser<std::string>().parse("otype", otypeStr, current);
+    VectorFieldParser<size_t>().parse("istride", desc.inStrides, current);
+    VectorFieldParser<size_t>().parse("ostride", desc.outStrides, current);
+    FieldParser<size_t>().parse("idist", desc.inDist, current);
+    FieldParser<size_t>().parse("odist", desc.outDist, current);
+    VectorFieldParser<size_t>().parse("ioffset", inOffset, current);
+    VectorFieldParser<size_t>().parse("ooffset", outOffset, current);
+    FieldParser<std::string>().parse("input_scale", inScaleStr, current);
+    FieldParser<std::string>().parse("scale", outScaleStr, current);
+    FieldParser<int>().parse("istorage", inStorage, current);
+    FieldParser<int>().parse("ostorage", outStorage, current);
+    FieldParser<int>().parse("output_op", outputOp, current);
+    FieldParser<bool>().parse("accumulate", desc.storeOps.accumulate, current);
+    FieldParser<bool>().parse("pass_callbacks", desc.storeOps.pass_callbacks, current);
+    FieldParser<int>().parse("strategy", strategy, current);
+    FieldParser<size_t>().parse("batch_tile", desc.batchTile, current);
+    FieldParser<bool>().parse("host_buffers", desc.hostBuffers, current);
+    FieldParser<bool>().parse("packed_hermitian", desc.packedHermitian, current);
+    FieldParser<bool>().parse("measure_access_modes", desc.measureAccessModes, current);
+    VectorFieldParser<size_t>().parse("cu_mask", cuMask, current);
+    VectorFieldParser<std::string>().parse("schemes", schemes, current);
+    VectorFieldParser<size_t>().parse("child_counts", childCounts, current);
+    VectorFieldParser<FMKey>().parse("solution_kernels", decisions.solution_kernels, current);
+    FieldParser<int>().parse("solution_num_cus", decisions.solutionNumCUs, current);
+    VectorFieldParser<int>().parse("buffers", buffers, current);
+
+    if(ret.lengths.empty() || desc.inStrides.size() != ret.lengths.size()
+       || desc.outStrides.size() != ret.lengths.size() || inOffset.size() != 2
+       || outOffset.size() != 2 || buffers.size() % 4 != 0)
+        return false;
+    // a CU mask is made of 32-bit words, with at least one bit set
+    if(std::any_of(cuMask.begin(), cuMask.end(), [](size_t word) { return word > UINT32_MAX; })
+       || (!cuMask.empty()
+           && std::all_of(cuMask.begin(), cuMask.end(), [](size_t word) { return word == 0; })))
+        return false;
+
+    ret.placement              = StrToPlacement(placementStr);
+    ret.transformType          = static_cast<rocfft_transform_type>(transformType);
+    ret.precision              = StrToPrecision(precisionStr);
+    desc.inArrayType           = StrToArrayType(itypeStr);
+    desc.outArrayType          = StrToArrayType(otypeStr);
+    desc.inOffset              = {inOffset[0], inOffset[1]};
+    desc.outOffset             = {outOffset[0], outOffset[1]};
+    desc.loadOps.scale_factor  = std::strtod(inScaleStr.c_str(), nullptr);
+    desc.storeOps.scale_factor = std::strtod(outScaleStr.c_str(), nullptr);
+    desc.loadOps.storage       = static_cast<rocfft_storage_format>(inStorage);
+    desc.storeOps.storage      = static_cast<rocfft_storage_format>(outStorage);
+    desc.storeOps.output_op    = static_cast<rocfft_output_op>(outputOp);
+    desc.assignOptStrategy     = static_cast<rocfft_optimize_strategy>(strategy);
+    desc.cuMask.assign(cuMask.begin(), cuMask.end());
+
+    size_t pos       = 0;
+    decisions.scheme = UnflattenSchemeTree(schemes, childCounts, pos);
+    for(size_t i = 0; i < buffers.size(); i += 4)
+        decisions.buffers.push_back({static_cast<OperatingBuffer>(buffers[i]),
+                                     static_cast<OperatingBuffer>(buffers[i + 1]),
+                                     static_cast<rocfft_array_type>(buffers[i + 2]),
+                                     static_cast<rocfft_array_type>(buffers[i + 3])});
+    return true;
+}
+
+rocfft_status rocfft_plan_serialize(const rocfft_plan plan, void** buffer, size_t* buffer_len_bytes)
+{
+    log_trace(__func__, "plan", plan, "buffer", buffer, "buffer_len_bytes", buffer_len_bytes);
+
+    if(!plan || !buffer || !buffer_len_bytes)
+        return rocfft_status_invalid_arg_value;
+
+    // finish asynchronous plan creation, if necessary
+    auto create_status = plan->WaitCreate();
+    if(create_status != rocfft_status_success)
+        return create_status;
+
+    if(!PlanSerializable(*plan))
+        return rocfft_status_invalid_arg_value;
+
+    try
+    {
+        auto str = SerializePlan(*plan);
+        *buffer  = malloc(str.size());
+        if(!*buffer)
+            return rocfft_status_failure;
+        memcpy(*buffer, str.data(), str.size());
+        *buffer_len_bytes = str.size();
+        return rocfft_status_success;
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        return rocfft_status_failure;
+    }
+}
+
+rocfft_status rocfft_plan_buffer_free(void* buffer)
+{
+    log_trace(__func__, "buffer", buffer);
+
+    free(buffer);
+    return rocfft_status_success;
+}
+
+rocfft_status
+    rocfft_plan_deserialize(rocfft_plan* plan, const void* buffer, size_t buffer_len_bytes)
+{
+    log_trace(__func__, "plan", plan, "buffer", buffer, "buffer_len_bytes", buffer_len_bytes);
+
+    if(!plan || !buffer || !buffer_len_bytes)
+        return rocfft_status_invalid_arg_value;
+
+    DeserializedPlan params;
+    try
+    {
+        if(!DeserializePlan(std::string(static_cast<const char*>(buffer), buffer_len_bytes),
+                            params))
+            return rocfft_status_invalid_arg_value;
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        return rocfft_status_invalid_arg_value;
+    }
+
+    rocfft_plan_allocate(plan);
+    (*plan)->restore = params.decisions;
+    return rocfft_plan_create_internal(*plan,
+                                       params.placement,
+                                       params.transformType,
+                                       params.precision,
+                                       params.lengths.size(),
+                                       params.lengths.data(),
+                                       params.batch,
+                                       &params.desc);
+}
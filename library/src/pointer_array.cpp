@@ -0,0 +1,154 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include <stdexcept>
+
+#include "../../shared/array_predicate.h"
+#include "../../shared/rocfft_hip.h"
+#include "kernel_launch.h"
+#include "logging.h"
+#include "plan.h"
+#include "rocfft/rocfft.h"
+#include "rtc_stockham_kernel.h"
+#include "transform.h"
+#include "tree_node.h"
+
+// Pointer-array execution runs a plan whose transforms are each in
+// a buffer of their own.  The plan's single Stockham kernel is
+// compiled in a variant that reads each batch's input and output
+// pointers from device arrays, so the whole batch is one launch.
+
+// Return the plan's kernel node if every transform of the plan's
+// batch is one batch of a single Stockham kernel that reads the
+// user's input and writes the user's output, or nullptr otherwise.
+static TreeNode* pointer_array_node(const rocfft_plan plan)
+{
+    auto execPlan = plan->SingleExecPlan();
+    if(plan->desc.hostBuffers || !execPlan || execPlan->mgpuPlan
+       || execPlan->execSeq.size() != 1)
+        return nullptr;
+    auto node = execPlan->execSeq.front();
+    if(node->scheme != CS_KERNEL_STOCKHAM || node->ebtype != EmbeddedType::NONE
+       || node->fuseBlue != BFT_NONE || node->obIn != OB_USER_IN
+       || (node->obOut != OB_USER_OUT && node->obOut != OB_USER_IN))
+        return nullptr;
+    // each pointer is the start of a whole transform of the plan
+    if(node->batch != plan->batch || node->iOffset || node->oOffset
+       || !array_type_is_interleaved(node->inArrayType)
+       || !array_type_is_interleaved(node->outArrayType)
+       || node->loadOps.storage != rocfft_storage_format_native
+       || node->storeOps.storage != rocfft_storage_format_native)
+        return nullptr;
+    return node;
+}
+
+rocfft_status rocfft_execute_pointer_array(const rocfft_plan     plan,
+                                           void* const*          in_pointers,
+                                           void* const*          out_pointers,
+                                           rocfft_execution_info info)
+{
+    log_trace(__func__,
+              "plan",
+              plan,
+              "in_pointers",
+              in_pointers,
+              "out_pointers",
+              out_pointers,
+              "info",
+              info);
+
+    if(!plan || !in_pointers)
+        return rocfft_status_invalid_arg_value;
+
+    auto create_status = plan->WaitCreate();
+    if(create_status != rocfft_status_success)
+        return create_status;
+
+    const bool inplace = plan->placement == rocfft_placement_inplace;
+    if(!inplace && !out_pointers)
+        return rocfft_status_invalid_arg_value;
+
+    // the kernel's pointers come from the arrays, so there's nowhere
+    // for callbacks or a smaller batch to go
+    if(info
+       && (info->callbacks.load_cb_fn || info->callbacks.store_cb_fn
+           || !info->pass_callbacks.empty() || (info->batch && info->batch != plan->batch)))
+        return rocfft_status_invalid_arg_value;
+
+    auto node = pointer_array_node(plan);
+    if(!node)
+        return rocfft_status_invalid_arg_value;
+    auto execPlan = plan->SingleExecPlan();
+
+    try
+    {
+        rocfft_scoped_device dev(execPlan->location.device);
+
+        std::call_once(plan->pointerArrayOnce, [&]() {
+            plan->pointerArrayKernel = RTCKernelStockham::compile_pointer_array(
+                *node, execPlan->deviceProp.gcnArchName);
+        });
+        if(!plan->pointerArrayKernel)
+            return rocfft_status_failure;
+
+        // the kernel reads tables from the plan, which must be
+        // ready before it is launched
+        plan->WaitTables();
+
+        const auto& gp = execPlan->gridParam.front();
+
+        // the arrays of pointers take the place of the buffers
+        DeviceCallIn data;
+        data.node          = node;
+        data.bufIn[0]      = const_cast<void**>(in_pointers);
+        data.bufOut[0]     = const_cast<void**>(inplace ? in_pointers : out_pointers);
+        data.gridParam     = gp;
+        data.deviceProp    = execPlan->deviceProp;
+        data.rocfft_stream = info ? info->rocfft_stream : nullptr;
+
+        auto kargs = plan->pointerArrayKernel->get_launch_args(data);
+        plan->pointerArrayKernel->launch(kargs,
+                                         {gp.b_x, gp.b_y, gp.b_z},
+                                         {gp.wgs_x, gp.wgs_y, gp.wgs_z},
+                                         gp.lds_bytes,
+                                         execPlan->deviceProp,
+                                         data.rocfft_stream);
+
+        if(!info || !info->captureMode)
+        {
+            const size_t bytes = KernelBytesMoved(*node);
+            ++plan->counters.executions;
+            ++plan->counters.kernels_launched;
+            plan->counters.bytes_moved += bytes;
+            ++ExecutionCounters::Global().executions;
+            ++ExecutionCounters::Global().kernels_launched;
+            ExecutionCounters::Global().bytes_moved += bytes;
+        }
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
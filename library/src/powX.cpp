@@ -18,12 +18,18 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
 #include <numeric>
+#include <optional>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -34,7 +40,13 @@
 
 #include "logging.h"
 #include "plan.h"
+#include "plan_create_times.h"
+#include "repo.h"
+#include "roctx_range.h"
+#include "rtc_generic_kernel.h"
 #include "rtc_kernel.h"
+#include "rtc_stockham_kernel.h"
+#include "stream_pool.h"
 #include "transform.h"
 #include "tuning_helper.h"
 
@@ -44,6 +56,7 @@
 
 #include "real2complex.h"
 
+#include "../../shared/arithmetic.h"
 #include "../../shared/array_predicate.h"
 #include "../../shared/environment.h"
 #include "../../shared/fft_hash.h"
@@ -59,6 +72,10 @@
 // failure returns false right away.
 bool PlanPowX(ExecPlan& execPlan)
 {
+    // creates twiddle tables and kernel arguments
+    RoctxRange      range("rocFFT PlanPowX");
+    PlanCreateTimer timer(PCP_TABLES);
+
     for(const auto& node : execPlan.execSeq)
     {
         if(node->CreateDeviceResources() == false)
@@ -68,6 +85,13 @@ bool PlanPowX(ExecPlan& execPlan)
             return false;
     }
 
+    // kernels were compiling in the background while the tables
+    // were built; grid params below come from the compiled kernels.
+    // the compiles are timed by the workers, so waiting for them
+    // isn't charged to the tables.
+    timer.Stop();
+    FinishRuntimeCompilePlan(execPlan);
+
     for(const auto& node : execPlan.execSeq)
     {
         DevFnCall ptr = nullptr;
@@ -76,8 +100,9 @@ bool PlanPowX(ExecPlan& execPlan)
         // if this kernel is runtime compiled, use the grid params
         // from compilation as a default.  the node is free to
         // override this default in its SetupGPAndFnPtr_internal
-        // method.
-        auto& rtcKernel = node->compiledKernel.get();
+        // method.  nodes running the generic fallback always set
+        // their own.
+        RTCKernel* rtcKernel = node->genericKernel ? nullptr : node->compiledKernel.get().get();
         if(rtcKernel)
         {
             gp.b_x   = rtcKernel->gridDim.x;
@@ -96,6 +121,393 @@ bool PlanPowX(ExecPlan& execPlan)
     return true;
 }
 
+// Single-kernel Bluestein's setup kernels build the chirp and then
+// FFT it, which only depends on the length, padded length, precision
+// and direction.  Run them once into a buffer kept in the Repo and
+// drop them from the execution sequence, so executing the plan only
+// launches the Bluestein kernel itself.
+void PrecomputeBluesteinChirps(ExecPlan& execPlan)
+{
+    PlanCreateTimer timer(PCP_TABLES);
+
+    std::vector<bool> precomputed(execPlan.execSeq.size(), false);
+    for(size_t i = 2; i < execPlan.execSeq.size(); ++i)
+    {
+        auto node = execPlan.execSeq[i];
+        if(node->scheme != CS_KERNEL_BLUESTEIN_SINGLE)
+            continue;
+
+        // the chirp and its FFT immediately precede the Bluestein kernel
+        auto  chirpNode   = execPlan.execSeq[i - 2];
+        auto  fftNode     = execPlan.execSeq[i - 1];
+        auto& chirpKernel = chirpNode->compiledKernel.get();
+        auto& fftKernel   = fftNode->compiledKernel.get();
+        if(chirpNode->scheme != CS_KERNEL_CHIRP || chirpNode->parent != node->parent
+           || fftNode->parent != node->parent || !chirpKernel || !fftKernel)
+            continue;
+
+        const auto& chirpGP = execPlan.gridParam[i - 2];
+        const auto& fftGP   = execPlan.gridParam[i - 1];
+        auto        populate = [&](void* buf, hipStream_t stream) {
+            DeviceCallIn data;
+            data.rocfft_stream = stream;
+            data.deviceProp    = execPlan.deviceProp;
+
+            data.node      = chirpNode;
+            data.gridParam = chirpGP;
+            data.bufIn[0] = data.bufOut[0] = buf;
+            chirpKernel->launch(data, execPlan.deviceProp);
+
+            data.node      = fftNode;
+            data.gridParam = fftGP;
+            data.bufIn[0]  = static_cast<char*>(buf)
+                            + fftNode->iOffset * complex_type_size(fftNode->precision);
+            data.bufOut[0] = data.bufIn[0];
+            fftKernel->launch(data, execPlan.deviceProp);
+        };
+
+        std::tie(node->chirp, node->chirp_size)
+            = Repo::GetChirpFFT(node->length[0],
+                                node->lengthBlue,
+                                node->precision,
+                                node->direction,
+                                2 * node->lengthBlue * complex_type_size(node->precision),
+                                populate);
+        if(!node->chirp)
+            continue;
+        precomputed[i - 2] = true;
+        precomputed[i - 1] = true;
+    }
+
+    if(std::find(precomputed.begin(), precomputed.end(), true) == precomputed.end())
+        return;
+
+    std::vector<TreeNode*> execSeq;
+    std::vector<DevFnCall> devFnCall;
+    std::vector<GridParam> gridParam;
+    for(size_t i = 0; i < execPlan.execSeq.size(); ++i)
+    {
+        if(precomputed[i])
+            continue;
+        execSeq.push_back(execPlan.execSeq[i]);
+        devFnCall.push_back(execPlan.devFnCall[i]);
+        gridParam.push_back(execPlan.gridParam[i]);
+    }
+    execPlan.execSeq   = std::move(execSeq);
+    execPlan.devFnCall = std::move(devFnCall);
+    execPlan.gridParam = std::move(gridParam);
+
+    // the Bluestein and chirp parts of the work buffer may no longer
+    // be needed
+    bool needBlue = std::any_of(execPlan.execSeq.begin(), execPlan.execSeq.end(), [](auto n) {
+        return n->obIn == OB_TEMP_BLUESTEIN || n->obOut == OB_TEMP_BLUESTEIN
+               || (n->scheme == CS_KERNEL_BLUESTEIN_SINGLE && !n->chirp);
+    });
+    bool needChirp = std::any_of(execPlan.execSeq.begin(), execPlan.execSeq.end(), [](auto n) {
+        return n->scheme == CS_KERNEL_CHIRP;
+    });
+    if(!needBlue && !needChirp)
+    {
+        execPlan.workBufSize -= execPlan.blueWorkBufSize + execPlan.chirpWorkBufSize;
+        execPlan.blueWorkBufSize  = 0;
+        execPlan.chirpWorkBufSize = 0;
+    }
+}
+
+// most streams a plan's nodes are spread over
+static const size_t EXEC_MAX_LANES = 4;
+
+// Find nodes of the execution sequence that don't depend on each
+// other, and spread them over lanes that run on separate streams.
+// Small kernels that underfill the device can then overlap - for
+// example, Bluestein's chirp setup can run alongside the FFTs of an
+// earlier dimension.
+//
+// Nodes depend on each other if one writes a buffer that the other
+// reads or writes.  Buffers are tracked coarsely: the user's input
+// and output are one region since they may alias, and the temp,
+// complex-for-real and Bluestein parts of the work buffer are each
+// one region.  Kernels that compute their own offsets into a buffer
+// therefore can't be mistaken for independent ones.
+void ScheduleExecSeq(ExecPlan& execPlan)
+{
+    execPlan.execLanes.clear();
+    execPlan.execWaits.clear();
+    execPlan.execSignals.clear();
+    execPlan.execLaneCount = 1;
+
+    const auto& execSeq = execPlan.execSeq;
+    if(execSeq.size() < 2 || rocfft_getenv("ROCFFT_EXEC_LANES") == "0")
+        return;
+
+    // callbacks compiled into the plan could access any memory
+    for(auto node : execSeq)
+    {
+        if(!node->loadOps.callback.empty() || !node->storeOps.callback.empty())
+            return;
+    }
+
+    static const unsigned int REGION_USER            = 1;
+    static const unsigned int REGION_TEMP            = 2;
+    static const unsigned int REGION_TEMP_CMPLX_REAL = 4;
+    static const unsigned int REGION_TEMP_BLUESTEIN  = 8;
+    static const unsigned int REGION_ALL             = ~0u;
+
+    auto regions = [](OperatingBuffer ob) {
+        switch(ob)
+        {
+        case OB_USER_IN:
+        case OB_USER_OUT:
+            return REGION_USER;
+        case OB_TEMP:
+            return REGION_TEMP;
+        case OB_TEMP_CMPLX_FOR_REAL:
+            return REGION_TEMP_CMPLX_REAL;
+        case OB_TEMP_BLUESTEIN:
+            return REGION_TEMP_BLUESTEIN;
+        default:
+            return REGION_ALL;
+        }
+    };
+
+    const size_t              n = execSeq.size();
+    std::vector<unsigned int> reads(n);
+    std::vector<unsigned int> writes(n);
+    for(size_t i = 0; i < n; ++i)
+    {
+        reads[i]  = regions(execSeq[i]->obIn);
+        writes[i] = regions(execSeq[i]->obOut);
+        // single-kernel Bluestein uses the Bluestein buffer as
+        // scratch, unless its chirp is precomputed
+        if(execSeq[i]->scheme == CS_KERNEL_BLUESTEIN_SINGLE && !execSeq[i]->chirp)
+            writes[i] |= REGION_TEMP_BLUESTEIN;
+    }
+
+    std::vector<size_t>              lanes(n);
+    std::vector<std::vector<size_t>> waits(n);
+    std::vector<bool>                signals(n, false);
+    // last node assigned to each lane
+    std::vector<size_t> laneTails;
+    for(size_t i = 0; i < n; ++i)
+    {
+        // latest node on each lane that this node depends on
+        std::map<size_t, size_t> deps;
+        for(size_t j = 0; j < i; ++j)
+        {
+            if((writes[i] & (reads[j] | writes[j])) || (writes[j] & reads[i]))
+                deps[lanes[j]] = j;
+        }
+
+        // follow a dependency if it's the end of its lane, otherwise
+        // start a new lane.  Once there are enough lanes, follow the
+        // latest dependency.
+        size_t lane = laneTails.size();
+        for(const auto& dep : deps)
+        {
+            if(laneTails[dep.first] == dep.second)
+            {
+                lane = dep.first;
+                break;
+            }
+        }
+        if(lane == laneTails.size() && laneTails.size() == EXEC_MAX_LANES)
+        {
+            lane          = 0;
+            size_t latest = 0;
+            for(const auto& dep : deps)
+            {
+                if(dep.second >= latest)
+                {
+                    latest = dep.second;
+                    lane   = dep.first;
+                }
+            }
+        }
+        if(lane == laneTails.size())
+            laneTails.push_back(i);
+        else
+            laneTails[lane] = i;
+        lanes[i] = lane;
+
+        for(const auto& dep : deps)
+        {
+            if(dep.first == lane)
+                continue;
+            waits[i].push_back(dep.second);
+            signals[dep.second] = true;
+        }
+    }
+
+    // everything depends on what came before, so keep it simple
+    if(laneTails.size() == 1)
+        return;
+
+    execPlan.execLanes     = std::move(lanes);
+    execPlan.execWaits     = std::move(waits);
+    execPlan.execSignals   = std::move(signals);
+    execPlan.execLaneCount = laneTails.size();
+}
+
+// Bytes of the last level of cache that slabs may fill.  HIP only
+// reports L2, so the Infinity Cache (MALL) of the archs that have one
+// comes from a table.  Half of it is used, leaving room for
+// everything else the passes touch.
+static size_t slab_cache_bytes(const hipDeviceProp_t& prop)
+{
+    auto env = rocfft_getenv("ROCFFT_SLAB_CACHE_BYTES");
+    if(!env.empty())
+    {
+        try
+        {
+            return std::stoull(env);
+        }
+        catch(std::exception&)
+        {
+            return 0;
+        }
+    }
+
+    static const std::vector<std::pair<std::string, size_t>> mall_bytes = {
+        {"gfx942", 256ull << 20},
+        {"gfx1030", 128ull << 20},
+        {"gfx1100", 96ull << 20},
+        {"gfx1101", 64ull << 20},
+    };
+    size_t cache = prop.l2CacheSize > 0 ? prop.l2CacheSize : 0;
+    for(const auto& arch : mall_bytes)
+    {
+        if(is_device_gcn_arch(prop, arch.first))
+            cache = std::max(cache, arch.second);
+    }
+    return cache / 2;
+}
+
+// Find runs of nodes that can execute one slab of planes at a time.
+// Each pass of a multi-pass transform normally streams the whole
+// volume through global memory.  Kernels that work on each plane of
+// their third length independently, such as the row and column
+// passes of a 2D FFT that a 3D plan does on every XY plane, can
+// instead run all their passes on a slab of planes that fits in
+// cache before moving to the next slab.
+//
+// A run's nodes must agree on which memory is a "plane": every node
+// that reads or writes a buffer must use the same plane stride,
+// batch distance and offset for it, and planes must not overlap.
+// Then a later node's slab only reads what an earlier node's slab
+// wrote, and only overwrites data that earlier slabs are done with.
+void ScheduleSlabs(ExecPlan& execPlan)
+{
+    execPlan.slabRuns.clear();
+
+    const auto& execSeq    = execPlan.execSeq;
+    const auto  cacheBytes = slab_cache_bytes(execPlan.deviceProp);
+    if(execSeq.size() < 2 || !cacheBytes)
+        return;
+
+    // the plane stride, batch distance and offset of a buffer
+    typedef std::tuple<size_t, size_t, size_t> PlaneGeometry;
+
+    // true if planes of a node's input or output are disjoint
+    auto disjoint = [](const TreeNode&            node,
+                       const std::vector<size_t>& stride,
+                       size_t                     dist) {
+        size_t span = 1 + (node.length[0] - 1) * stride[0] + (node.length[1] - 1) * stride[1];
+        return span <= stride[2]
+               && (node.batch == 1 || (node.length[2] - 1) * stride[2] + span <= dist);
+    };
+
+    auto eligible = [&](size_t i) {
+        const auto& node = *execSeq[i];
+        const auto& gp   = execPlan.gridParam[i];
+        if(!node.planeBlocks || node.length.size() != 3 || node.large1D
+           || node.ebtype != EmbeddedType::NONE || node.genericKernel)
+            return false;
+        if(!node.loadOps.callback.empty() || !node.storeOps.callback.empty()
+           || node.loadOps.storage != rocfft_storage_format_native
+           || node.storeOps.storage != rocfft_storage_format_native)
+            return false;
+        if(!array_type_is_complex(node.inArrayType) || !array_type_is_complex(node.outArrayType))
+            return false;
+        // the kernel's blocks must go plane by plane
+        if(gp.b_y != 1 || gp.b_z != 1
+           || gp.b_x != node.planeBlocks * node.length[2] * node.batch)
+            return false;
+        return node.inStride.size() == 3 && node.outStride.size() == 3
+               && disjoint(node, node.inStride, node.iDist)
+               && disjoint(node, node.outStride, node.oDist);
+    };
+
+    for(size_t first = 0; first < execSeq.size();)
+    {
+        if(!eligible(first))
+        {
+            ++first;
+            continue;
+        }
+
+        // geometry of each buffer the run touches.  User input and
+        // output may alias, so they're one buffer.
+        std::map<OperatingBuffer, PlaneGeometry> buffers;
+        auto consistent = [&](OperatingBuffer ob, const PlaneGeometry& geometry) {
+            auto found = buffers.emplace(ob == OB_USER_IN ? OB_USER_OUT : ob, geometry);
+            return found.second || found.first->second == geometry;
+        };
+
+        const auto& head  = *execSeq[first];
+        size_t      count = 0;
+        for(size_t i = first; i < execSeq.size() && eligible(i); ++i)
+        {
+            const auto& node = *execSeq[i];
+            if(node.length[2] != head.length[2] || node.batch != head.batch
+               || node.precision != head.precision)
+                break;
+            auto saved = buffers;
+            if(!consistent(node.obIn, {node.inStride[2], node.iDist, node.iOffset})
+               || !consistent(node.obOut, {node.outStride[2], node.oDist, node.oOffset}))
+            {
+                buffers = saved;
+                break;
+            }
+            ++count;
+        }
+
+        if(count >= 2)
+        {
+            // each slab keeps a slab of every buffer the run touches
+            // in cache
+            size_t planeBytes = 0;
+            for(const auto& buf : buffers)
+                planeBytes += std::get<0>(buf.second) * complex_type_size(head.precision);
+
+            const size_t planes     = head.length[2];
+            size_t       slabPlanes = 0;
+            for(size_t p = 1; p <= planes; ++p)
+            {
+                if(planes % p == 0 && p * planeBytes <= cacheBytes)
+                    slabPlanes = p;
+            }
+
+            // not worthwhile if the whole volume fits in cache
+            // anyway, or if a slab can't fill the device
+            size_t minBlocks = std::numeric_limits<size_t>::max();
+            for(size_t i = first; i < first + count; ++i)
+                minBlocks = std::min(minBlocks, execSeq[i]->planeBlocks * slabPlanes);
+            bool wholeVolume = slabPlanes == planes && head.batch == 1;
+            if(slabPlanes && !wholeVolume
+               && minBlocks >= static_cast<size_t>(execPlan.deviceProp.multiProcessorCount))
+            {
+                ExecPlan::SlabRun run;
+                run.first      = first;
+                run.count      = count;
+                run.planes     = planes;
+                run.slabPlanes = slabPlanes;
+                execPlan.slabRuns.push_back(run);
+            }
+        }
+        first += std::max<size_t>(count, 1);
+    }
+}
+
 bool GetTuningKernelInfo(ExecPlan& execPlan)
 {
     auto tuningPacket = TuningBenchmarker::GetSingleton().GetPacket();
@@ -107,7 +519,7 @@ bool GetTuningKernelInfo(ExecPlan& execPlan)
         TreeNode*    curNode             = execPlan.execSeq[i];
         RTCKernel*   localCompiledKernel = curNode->compiledKernel.get().get();
         GridParam    gp                  = execPlan.gridParam[i];
-        FMKey        key                 = curNode->GetKernelKey();
+        FMKey        key                 = curNode->GetTuningKernelKey();
         auto         lengths             = key.lengths;
         auto         scheme              = key.scheme;
         KernelConfig config              = key.kernel_config;
@@ -182,15 +594,14 @@ bool GetTuningKernelInfo(ExecPlan& execPlan)
     return true;
 }
 
+// elemsize is the size of one real number in the buffer
 static size_t data_size_bytes(const std::vector<size_t>& lengths,
-                              rocfft_precision           precision,
+                              size_t                     elemsize,
                               rocfft_array_type          type)
 {
     // first compute the raw number of elements
     const size_t elems = std::accumulate(
         lengths.begin(), lengths.end(), static_cast<size_t>(1), std::multiplies<size_t>());
-    // size of each element
-    const size_t elemsize = real_type_size(precision);
     switch(type)
     {
     case rocfft_array_type_complex_interleaved:
@@ -215,6 +626,88 @@ static size_t data_size_bytes(const std::vector<size_t>& lengths,
     }
 }
 
+// get the precision to use when printing user data in "storage"
+// format, for a kernel computing in "precision".  returns false if
+// the debug printing code can't interpret that format.
+static bool storage_print_precision(rocfft_storage_format storage,
+                                    rocfft_precision      precision,
+                                    rocfft_precision&     print_precision)
+{
+    switch(storage)
+    {
+    case rocfft_storage_format_native:
+        print_precision = precision;
+        return true;
+    case rocfft_storage_format_half:
+        print_precision = rocfft_precision_half;
+        return true;
+    case rocfft_storage_format_single:
+        print_precision = rocfft_precision_single;
+        return true;
+    case rocfft_storage_format_bfloat16:
+    case rocfft_storage_format_fp8_e4m3:
+    case rocfft_storage_format_fp8_e5m2:
+    case rocfft_storage_format_int16:
+    case rocfft_storage_format_int8:
+        return false;
+    }
+    return false;
+}
+
+size_t KernelBytesMoved(const TreeNode& node)
+{
+    // chirp kernel has no input - it constructs the chirp buffer from nothing
+    size_t in_size_bytes
+        = (node.scheme == CS_KERNEL_CHIRP || node.scheme == CS_KERNEL_RADER_CHIRP)
+              ? 0
+              : data_size_bytes(node.length,
+                                storage_real_size(node.loadOps.storage, node.precision),
+                                node.inArrayType);
+    size_t out_size_bytes
+        = data_size_bytes(node.length,
+                          storage_real_size(node.storeOps.storage, node.precision),
+                          node.storeOps.stored_array_type(node.outArrayType));
+    // accumulating reads the output as well as writing it
+    if(node.storeOps.accumulate)
+        out_size_bytes *= 2;
+    return (in_size_bytes + out_size_bytes) * node.batch;
+}
+
+double KernelFlops(const TreeNode& node)
+{
+    auto leaf = dynamic_cast<const LeafNode*>(&node);
+    if(!leaf)
+        return 0.0;
+
+    // the factors of each FFT dimension the kernel does are
+    // concatenated, so walk them in order and move to the next
+    // dimension when the product reaches that dimension's length
+    const size_t elems = product(node.length.begin(), node.length.end()) * node.batch;
+    double       flops = 0.0;
+    size_t       dim   = 0;
+    size_t       done  = 1;
+    for(auto radix : leaf->kernelFactors)
+    {
+        if(dim == node.length.size() || radix < 2)
+            break;
+        // each pass does a radix-r butterfly for every r elements:
+        // about 5 r log2(r) flops, plus a complex multiply per
+        // non-trivial twiddle after the first pass of a dimension
+        double perElem = 5.0 * std::log2(static_cast<double>(radix));
+        if(done > 1)
+            perElem += 6.0 * (radix - 1) / radix;
+        flops += perElem * elems;
+
+        done *= radix;
+        if(done >= node.length[dim])
+        {
+            ++dim;
+            done = 1;
+        }
+    }
+    return flops;
+}
+
 static float execution_bandwidth_GB_per_s(size_t data_size_bytes, float duration_ms)
 {
     // divide bytes by (1000000 * milliseconds) to get GB/s
@@ -443,12 +936,32 @@ void SetDefaultCallback(const TreeNode* node, const SetCallbackType& type, void*
     auto node_callback_type = node->GetCallbackType(true);
 
     bool is_complex = array_type_is_complex(array_type);
-    // load r2c kernels and store c2r kernels need real-valued callbacks
+    // load r2c kernels and store c2r kernels need real-valued
+    // callbacks, as does planar data
     if((type == SetCallbackType::LOAD && node_callback_type == CallbackType::USER_LOAD_STORE_R2C)
        || (type == SetCallbackType::STORE
-           && node_callback_type == CallbackType::USER_LOAD_STORE_C2R))
+           && node_callback_type == CallbackType::USER_LOAD_STORE_C2R)
+       || array_type_is_planar(array_type))
         is_complex = false;
 
+    // symbol addresses don't change, so only copy each one from the
+    // device once instead of on every execution
+    int device = 0;
+    if(hipGetDevice(&device) != hipSuccess)
+        throw std::runtime_error("hipGetDevice failure");
+    static std::mutex cached_cb_mutex;
+    static std::map<std::tuple<int, bool, SetCallbackType, rocfft_precision>, void*> cached_cb;
+    const auto key = std::make_tuple(device, is_complex, type, node->precision);
+    {
+        std::lock_guard<std::mutex> lock(cached_cb_mutex);
+        auto                        it = cached_cb.find(key);
+        if(it != cached_cb.end())
+        {
+            *cb = it->second;
+            return;
+        }
+    }
+
     if(is_complex && type == SetCallbackType::LOAD)
     {
         switch(node->precision)
@@ -518,15 +1031,41 @@ void SetDefaultCallback(const TreeNode* node, const SetCallbackType& type, void*
 
     if(result != hipSuccess)
         throw std::runtime_error("hipMemcpyFromSymbol failure");
+
+    std::lock_guard<std::mutex> lock(cached_cb_mutex);
+    cached_cb[key] = *cb;
 }
 
 // Internal plan executor.
 // For in-place transforms, in_buffer == out_buffer.
-void TransformPowX(const ExecPlan&       execPlan,
-                   void*                 in_buffer[],
-                   void*                 out_buffer[],
-                   rocfft_execution_info info,
-                   size_t                multiPlanIdx)
+// Transforms a node executes when an execution asks for fewer than
+// the plan was created for.  Each node's batch is a multiple of the
+// plan's, since contiguous dimensions may be folded into it, except
+// for chirp setup, which builds the same chirp for every transform.
+static size_t ExecBatch(TreeNode& node, size_t planBatch, size_t batch)
+{
+    if(node.IsBluesteinChirpSetup())
+        return node.batch;
+    return node.batch / planBatch * batch;
+}
+
+// Shrink a node's launch grid to the transforms it executes.
+// Transposes count whole batches along grid Z.  Other kernels
+// cover the batch along grid X and check their bounds against the
+// batch they're given, so a rounded-up grid is enough.
+static void ScaleGridToBatch(GridParam& gp, size_t nodeBatch, size_t batch)
+{
+    if(gp.b_z > 1)
+        gp.b_z = gp.b_z / nodeBatch * batch;
+    else
+        gp.b_x = DivRoundingUp<size_t>(static_cast<size_t>(gp.b_x) * batch, nodeBatch);
+}
+
+size_t TransformPowX(const ExecPlan&       execPlan,
+                     void*                 in_buffer[],
+                     void*                 out_buffer[],
+                     rocfft_execution_info info,
+                     size_t                multiPlanIdx)
 {
     assert(execPlan.execSeq.size() == execPlan.devFnCall.size());
     assert(execPlan.execSeq.size() == execPlan.gridParam.size());
@@ -535,8 +1074,19 @@ void TransformPowX(const ExecPlan&       execPlan,
     auto tuningPacket      = TuningBenchmarker::GetSingleton().GetPacket();
     // we can log profile information if we're on the null stream,
     // since we will be able to wait for the transform to finish
-    bool emit_profile_log  = (processing_tuning || LOG_PROFILE_ENABLED()) && !info->rocfft_stream;
-    bool emit_kernelio_log = LOG_KERNELIO_ENABLED();
+    //
+    // capture mode forbids allocating events and synchronizing with
+    // the device, so profile and kernel IO logs are skipped.
+    // Executions that enable profiling time kernels asynchronously
+    // instead, so they can be on any stream.
+    auto profile = processing_tuning || info->captureMode ? nullptr : info->profile.get();
+    bool emit_profile_log
+        = (processing_tuning || (LOG_PROFILE_ENABLED() && !profile)) && !info->rocfft_stream
+          && !info->captureMode;
+    bool emit_kernelio_log = LOG_KERNELIO_ENABLED() && !info->captureMode;
+    // executions of fewer transforms than the plan's batch shrink
+    // each node's batch and grid
+    const bool partialBatch = info->batch && info->batch != info->planBatch;
 
     rocfft_ostream*    kernelio_stream = nullptr;
     float              max_memory_bw   = 0.0;
@@ -554,21 +1104,169 @@ void TransformPowX(const ExecPlan&       execPlan,
     TreeNode* store_node            = nullptr;
     std::tie(load_node, store_node) = execPlan.get_load_store_nodes();
 
-    load_node->callbacks.load_cb_fn        = info->callbacks.load_cb_fn;
-    load_node->callbacks.load_cb_data      = info->callbacks.load_cb_data;
-    load_node->callbacks.load_cb_lds_bytes = info->callbacks.load_cb_lds_bytes;
+    // callback kernels aren't built for data in a non-native
+    // storage format
+    if((info->callbacks.load_cb_fn || info->callbacks.store_cb_fn)
+       && (load_node->loadOps.storage != rocfft_storage_format_native
+           || store_node->storeOps.storage != rocfft_storage_format_native))
+        throw rocfft_status_invalid_arg_value;
+
+    // callbacks belong to this execution, so they're kept here
+    // rather than on the plan's nodes.  That lets one plan execute
+    // concurrently with different callbacks.
+    std::vector<UserCallbacks> nodeCallbacks(execPlan.execSeq.size());
+    for(size_t i = 0; i < execPlan.execSeq.size(); ++i)
+    {
+        if(execPlan.execSeq[i] == load_node)
+        {
+            nodeCallbacks[i].load_cb_fn        = info->callbacks.load_cb_fn;
+            nodeCallbacks[i].load_cb_data      = info->callbacks.load_cb_data;
+            nodeCallbacks[i].load_cb_lds_bytes = info->callbacks.load_cb_lds_bytes;
+        }
+        if(execPlan.execSeq[i] == store_node)
+        {
+            nodeCallbacks[i].store_cb_fn        = info->callbacks.store_cb_fn;
+            nodeCallbacks[i].store_cb_data      = info->callbacks.store_cb_data;
+            nodeCallbacks[i].store_cb_lds_bytes = info->callbacks.store_cb_lds_bytes;
+        }
+    }
 
-    store_node->callbacks.store_cb_fn        = info->callbacks.store_cb_fn;
-    store_node->callbacks.store_cb_data      = info->callbacks.store_cb_data;
-    store_node->callbacks.store_cb_lds_bytes = info->callbacks.store_cb_lds_bytes;
+    // store callbacks on interior passes need the pass to have a
+    // callback kernel, and can't replace the output's store callback
+    for(const auto& pass_cb : info->pass_callbacks)
+    {
+        if(pass_cb.first >= execPlan.execSeq.size())
+            throw rocfft_status_invalid_arg_value;
+        auto node = execPlan.execSeq[pass_cb.first];
+        if(node == store_node && info->callbacks.store_cb_fn)
+            throw rocfft_status_invalid_arg_value;
+        if(!node->compiledKernelWithCallbacks.valid() || !node->compiledKernelWithCallbacks.get())
+            throw rocfft_status_invalid_arg_value;
+
+        auto& callbacks              = nodeCallbacks[pass_cb.first];
+        callbacks.store_cb_fn        = pass_cb.second.store_cb_fn;
+        callbacks.store_cb_data      = pass_cb.second.store_cb_data;
+        callbacks.store_cb_lds_bytes = pass_cb.second.store_cb_lds_bytes;
+    }
 
-    for(size_t i = 0; i < execPlan.execSeq.size(); i++)
+    // run independent nodes on their own streams, if the plan has
+    // any.  Tuning, profiling and kernel IO logs look at each kernel
+    // on its own, capture can't take streams from the pool, and
+    // callbacks could access any memory, so those stay in sequence.
+    bool concurrent = execPlan.execLanes.size() == execPlan.execSeq.size() && !processing_tuning
+                      && !profile && !emit_profile_log && !emit_kernelio_log && !info->captureMode
+                      && !info->callbacks.load_cb_fn && !info->callbacks.store_cb_fn
+                      && info->pass_callbacks.empty();
+
+    // events are those of nodes that others wait on, followed by one
+    // to fork the lanes from the execution's stream and one to join
+    // each of them back
+    PooledStreams       lanes;
+    std::vector<size_t> nodeEvents(execPlan.execSeq.size(), 0);
+    size_t              forkEvent = 0;
+    if(concurrent)
     {
+        for(size_t i = 0; i < execPlan.execSignals.size(); ++i)
+        {
+            if(execPlan.execSignals[i])
+                nodeEvents[i] = forkEvent++;
+        }
+        concurrent
+            = lanes.alloc(execPlan.execLaneCount - 1, forkEvent + execPlan.execLaneCount);
+    }
+    if(concurrent)
+    {
+        if(hipEventRecord(lanes.events[forkEvent], info->rocfft_stream) != hipSuccess)
+            throw std::runtime_error("hipEventRecord failure");
+        for(auto stream : lanes.streams)
+        {
+            if(hipStreamWaitEvent(stream, lanes.events[forkEvent], 0) != hipSuccess)
+                throw std::runtime_error("hipStreamWaitEvent failure");
+        }
+    }
+
+    // Run each slab of a slab run through all of the run's nodes
+    // before the next slab, so later nodes read it from cache.  A
+    // step with no planes runs its node on the whole volume.  Slabs
+    // shift the pointers kernels see, which would change the offsets
+    // given to callbacks, and tuning and logs look at each kernel's
+    // whole launch, so those keep the plain sequence - as do
+    // concurrent lanes, whose dependencies are between whole nodes.
+    // Slabs are cut from the plan's whole batch, so a smaller batch
+    // runs plainly too.
+    struct ExecStep
+    {
+        size_t node   = 0;
+        size_t batch  = 0;
+        size_t plane  = 0;
+        size_t planes = 0;
+    };
+    bool slabbed = !execPlan.slabRuns.empty() && !concurrent && !processing_tuning && !profile
+                   && !emit_profile_log && !emit_kernelio_log && !info->callbacks.load_cb_fn
+                   && !info->callbacks.store_cb_fn && info->pass_callbacks.empty()
+                   && !partialBatch;
+    std::vector<ExecStep> steps;
+    for(size_t i = 0; i < execPlan.execSeq.size();)
+    {
+        auto run = std::find_if(execPlan.slabRuns.begin(),
+                                execPlan.slabRuns.end(),
+                                [i](const ExecPlan::SlabRun& r) { return r.first == i; });
+        // nodes still waiting on their compiled kernel work on the
+        // whole volume
+        bool runSlabs = slabbed && run != execPlan.slabRuns.end()
+                        && std::none_of(execPlan.execSeq.begin() + i,
+                                        execPlan.execSeq.begin() + i + run->count,
+                                        [](TreeNode* n) { return rtc_fallback_kernel(*n); });
+        if(!runSlabs)
+        {
+            ExecStep step;
+            step.node = i++;
+            steps.push_back(step);
+            continue;
+        }
+        for(size_t b = 0; b < execPlan.execSeq[i]->batch; ++b)
+        {
+            for(size_t plane = 0; plane < run->planes; plane += run->slabPlanes)
+            {
+                for(size_t n = i; n < i + run->count; ++n)
+                    steps.push_back({n, b, plane, run->slabPlanes});
+            }
+        }
+        i += run->count;
+    }
+
+    // a node with a fused kernel runs with the next node in one
+    // launch.  The kernel covers both nodes whole, and has no
+    // callbacks, so it's only used where the nodes would otherwise
+    // run one after the other with no logs or timing in between.
+    const bool fuse = !concurrent && !processing_tuning && !profile && !emit_profile_log
+                      && !emit_kernelio_log && !partialBatch && !info->callbacks.load_cb_fn
+                      && !info->callbacks.store_cb_fn && info->pass_callbacks.empty();
+    std::optional<DeviceCallIn> fusedFirst;
+    size_t                      fusedLaunches = 0;
+
+    for(size_t s = 0; s < steps.size(); ++s)
+    {
+        const auto&  step = steps[s];
+        const size_t i    = step.node;
         DeviceCallIn data;
         data.node          = execPlan.execSeq[i];
         data.rocfft_stream = (info == nullptr) ? 0 : info->rocfft_stream;
+        if(concurrent && execPlan.execLanes[i] > 0)
+            data.rocfft_stream = lanes.streams[execPlan.execLanes[i] - 1];
+        if(concurrent)
+        {
+            for(auto wait : execPlan.execWaits[i])
+            {
+                if(hipStreamWaitEvent(data.rocfft_stream, lanes.events[nodeEvents[wait]], 0)
+                   != hipSuccess)
+                    throw std::runtime_error("hipStreamWaitEvent failure");
+            }
+        }
         data.deviceProp    = execPlan.deviceProp;
-        if(LOG_PLAN_ENABLED())
+        // launch lines are free-form text, so JSON logs get kernel
+        // records from the plan instead
+        if(LOG_PLAN_ENABLED() && !LOG_JSON_ENABLED())
             data.log_func = log_plan;
         else
             data.log_func = nullptr;
@@ -622,8 +1320,9 @@ void TransformPowX(const ExecPlan&       execPlan,
             data.bufIn[0]
                 = (void*)((char*)info->workBuffer
                           + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize) * complexTSize);
-            // Bluestein mul-kernels (3 types) work well for CI->CI
-            // so we only consider CI->CI now
+            // the Bluestein buffer is always CI.  Fused Bluestein
+            // kernels access planar, real and Hermitian user buffers
+            // directly, so they never need a planar temp here.
             break;
         case OB_UNINIT:
             rocfft_cerr << "Error: operating buffer not initialized for kernel!\n";
@@ -680,67 +1379,94 @@ void TransformPowX(const ExecPlan&       execPlan,
             data.bufOut[0]
                 = (void*)((char*)info->workBuffer
                           + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize) * complexTSize);
-            // Bluestein mul-kernels (3 types) work well for CI->CI
-            // so we only consider CI->CI now
+            // the Bluestein buffer is always CI.  Fused Bluestein
+            // kernels access planar, real and Hermitian user buffers
+            // directly, so they never need a planar temp here.
             break;
         default:
             assert(false);
         }
 
-        // apply offsets to pointers
-        if(data.node->iOffset)
+        // apply offsets to pointers, in elements of the format the
+        // buffers are stored in.  A slab starts at its first plane.
+        size_t iOffset = data.node->iOffset;
+        size_t oOffset = data.node->oOffset;
+        if(step.planes)
         {
-            if(data.bufIn[0])
-                data.bufIn[0] = ptr_offset(data.bufIn[0],
-                                           data.node->iOffset,
-                                           data.node->precision,
-                                           data.node->inArrayType);
-            if(data.bufIn[1])
-                data.bufIn[1] = ptr_offset(data.bufIn[1],
-                                           data.node->iOffset,
-                                           data.node->precision,
-                                           data.node->inArrayType);
+            iOffset += step.batch * data.node->iDist + step.plane * data.node->inStride[2];
+            oOffset += step.batch * data.node->oDist + step.plane * data.node->outStride[2];
         }
-        if(data.node->oOffset)
+        if(iOffset)
         {
-            if(data.bufOut[0])
-                data.bufOut[0] = ptr_offset(data.bufOut[0],
-                                            data.node->oOffset,
-                                            data.node->precision,
-                                            data.node->outArrayType);
-            if(data.bufOut[1])
-                data.bufOut[1] = ptr_offset(data.bufOut[1],
-                                            data.node->oOffset,
-                                            data.node->precision,
-                                            data.node->outArrayType);
+            for(auto& buf : data.bufIn)
+            {
+                if(buf)
+                    buf = storage_ptr_offset(buf,
+                                             iOffset,
+                                             data.node->loadOps.storage,
+                                             data.node->precision,
+                                             data.node->inArrayType);
+            }
+        }
+        if(oOffset)
+        {
+            for(auto& buf : data.bufOut)
+            {
+                if(buf)
+                    buf = storage_ptr_offset(
+                        buf,
+                        oOffset,
+                        data.node->storeOps.storage,
+                        data.node->precision,
+                        data.node->storeOps.stored_array_type(data.node->outArrayType));
+            }
         }
 
         // single-kernel bluestein requires a bluestein temp buffer separate from input and output
         if(data.node->scheme == CS_KERNEL_BLUESTEIN_SINGLE)
         {
-            data.bufTemp = ((char*)info->workBuffer
-                            + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize) * complexTSize);
+            // the chirp and its FFT might already be in the repo
+            if(data.node->chirp)
+                data.bufTemp = data.node->chirp;
+            else
+                data.bufTemp
+                    = ((char*)info->workBuffer
+                       + (execPlan.tmpWorkBufSize + execPlan.copyWorkBufSize) * complexTSize);
         }
 
-        // if callbacks are enabled, make sure load_cb_fn and store_cb_fn are not nullptrs
-        if((data.node->callbacks.load_cb_fn == nullptr
-            && data.node->callbacks.store_cb_fn != nullptr))
+        // if callbacks are enabled, make sure load_cb_fn and store_cb_fn are not nullptrs.
+        // Callbacks compiled from source are always enabled - their
+        // kernel ignores the function pointers, but is only chosen
+        // when they're set.
+        bool inline_cb = !data.node->loadOps.callback.empty()
+                         || !data.node->storeOps.callback.empty();
+        data.callbacks = nodeCallbacks[i];
+        if(data.callbacks.load_cb_fn == nullptr
+           && (data.callbacks.store_cb_fn != nullptr || inline_cb))
         {
             // set default load callback
-            SetDefaultCallback(data.node, SetCallbackType::LOAD, &data.node->callbacks.load_cb_fn);
+            SetDefaultCallback(data.node, SetCallbackType::LOAD, &data.callbacks.load_cb_fn);
         }
-        else if((data.node->callbacks.load_cb_fn != nullptr
-                 && data.node->callbacks.store_cb_fn == nullptr))
+        if(data.callbacks.store_cb_fn == nullptr
+           && (data.callbacks.load_cb_fn != nullptr || inline_cb))
         {
             // set default store callback
-            SetDefaultCallback(
-                data.node, SetCallbackType::STORE, &data.node->callbacks.store_cb_fn);
+            SetDefaultCallback(data.node, SetCallbackType::STORE, &data.callbacks.store_cb_fn);
         }
 
         data.gridParam = execPlan.gridParam[i];
+        if(step.planes)
+            data.gridParam.b_x = data.node->planeBlocks * step.planes;
+        if(partialBatch)
+        {
+            data.batch = ExecBatch(*data.node, info->planBatch, info->batch);
+            if(data.batch != data.node->batch)
+                ScaleGridToBatch(data.gridParam, data.node->batch, data.batch);
+        }
 
         // chirp kernel has no input - it constructs the chirp buffer from nothing
-        if(emit_kernelio_log && data.node->scheme != CS_KERNEL_CHIRP)
+        if(emit_kernelio_log && data.node->scheme != CS_KERNEL_CHIRP
+           && data.node->scheme != CS_KERNEL_RADER_CHIRP)
         {
             kernelio_stream = LogSingleton::GetInstance().GetKernelIOOS();
             *kernelio_stream << "--- --- multiPlanIdx " << multiPlanIdx << " kernel " << i << " ("
@@ -748,39 +1474,92 @@ void TransformPowX(const ExecPlan&       execPlan,
             if(hipDeviceSynchronize() != hipSuccess)
                 throw std::runtime_error("hipDeviceSynchronize failure");
 
-            std::vector<hostbuf> bufInHost;
-            CopyDeviceBufferToHost(data.node->inArrayType,
-                                   data.node->precision,
-                                   data.bufIn,
-                                   data.node->length,
-                                   data.node->inStride,
-                                   data.node->iDist,
-                                   data.node->batch,
-                                   bufInHost);
-
-            DebugPrintBuffer(*kernelio_stream,
-                             data.node->inArrayType,
-                             data.node->precision,
-                             bufInHost,
-                             data.node->length,
-                             data.node->inStride,
-                             data.node->iDist,
-                             data.node->batch);
-            *kernelio_stream << "--- --- multiPlanIdx " << multiPlanIdx << " kernel " << i << " ("
-                             << PrintScheme(data.node->scheme) << ") input hash: " << std::endl;
-            DebugPrintHash(*kernelio_stream,
-                           data.node->inArrayType,
-                           data.node->precision,
-                           bufInHost,
-                           data.node->length,
-                           data.node->inStride,
-                           data.node->iDist,
-                           data.node->batch);
-            *kernelio_stream << std::endl;
+            // user buffers may hold data in a narrower storage format
+            rocfft_precision inPrecision;
+            if(!storage_print_precision(
+                   data.node->loadOps.storage, data.node->precision, inPrecision))
+            {
+                *kernelio_stream << "(" << storage_format_name(data.node->loadOps.storage)
+                                 << " storage not printed)" << std::endl
+                                 << std::endl;
+            }
+            else
+            {
+                std::vector<hostbuf> bufInHost;
+                CopyDeviceBufferToHost(data.node->inArrayType,
+                                       inPrecision,
+                                       data.bufIn,
+                                       data.node->length,
+                                       data.node->inStride,
+                                       data.node->iDist,
+                                       data.get_batch(),
+                                       bufInHost);
+
+                DebugPrintBuffer(*kernelio_stream,
+                                 data.node->inArrayType,
+                                 inPrecision,
+                                 bufInHost,
+                                 data.node->length,
+                                 data.node->inStride,
+                                 data.node->iDist,
+                                 data.get_batch());
+                *kernelio_stream << "--- --- multiPlanIdx " << multiPlanIdx << " kernel " << i
+                                 << " (" << PrintScheme(data.node->scheme)
+                                 << ") input hash: " << std::endl;
+                DebugPrintHash(*kernelio_stream,
+                               data.node->inArrayType,
+                               inPrecision,
+                               bufInHost,
+                               data.node->length,
+                               data.node->inStride,
+                               data.node->iDist,
+                               data.get_batch());
+                *kernelio_stream << std::endl;
+            }
+        }
+
+        // hold the first node of a fused pair until the second
+        // node's arguments are ready, then launch both
+        if(fusedFirst)
+        {
+            auto kernel = static_cast<RTCKernelStockhamFused*>(
+                fusedFirst->node->compiledFusedKernel.get().get());
+            void* barrier
+                = (char*)info->workBuffer
+                  + (execPlan.workBufSize - execPlan.barrierWorkBufSize) * complexTSize;
+
+            std::optional<RoctxRange> kernelRange;
+            if(RoctxRange::Enabled())
+                kernelRange.emplace(PrintScheme(fusedFirst->node->parent->scheme) + " "
+                                    + kernel->kernel_name);
+            kernel->launch_fused(*fusedFirst, data, barrier);
+            kernelRange.reset();
+
+            fusedFirst.reset();
+            ++fusedLaunches;
+            continue;
+        }
+
+        RTCKernelStockhamFused* fusedKernel = nullptr;
+        if(fuse && !step.planes && s + 1 < steps.size() && steps[s + 1].node == i + 1
+           && !steps[s + 1].planes && execPlan.barrierWorkBufSize
+           && data.node->compiledFusedKernel.valid())
+            fusedKernel
+                = static_cast<RTCKernelStockhamFused*>(data.node->compiledFusedKernel.get().get());
+        if(fusedKernel
+           && fusedKernel->can_launch(data.gridParam, execPlan.gridParam[i + 1], data.deviceProp))
+        {
+            fusedFirst = data;
+            continue;
         }
 
         DevFnCall fn = execPlan.devFnCall[i];
-        if(fn || data.node->compiledKernel.get())
+        // a node whose kernel is still compiling runs the generic
+        // kernel, unless callbacks need the specialized one
+        RTCKernelGeneric* fallbackKernel = data.get_callback_type() == CallbackType::NONE
+                                               ? rtc_fallback_kernel(*data.node)
+                                               : nullptr;
+        if(fn || fallbackKernel || data.node->compiledKernel.get())
         {
 #ifdef REF_DEBUG
             rocfft_cout << "\n---------------------------------------------\n";
@@ -817,26 +1596,42 @@ void TransformPowX(const ExecPlan&       execPlan,
             if(emit_profile_log)
                 if(hipEventRecord(start) != hipSuccess)
                     throw std::runtime_error("hipEventRecord failure");
+            size_t profileSlot = 0;
+            if(profile)
+                profileSlot = profile->Begin(data.rocfft_stream);
 
             DeviceCallOut back;
 
-            // give callback parameters to kernel launcher
-            data.callbacks = execPlan.execSeq[i]->callbacks;
-
             // choose which compiled kernel to run
             RTCKernel* localCompiledKernel
-                = data.get_callback_type() == CallbackType::NONE
+                = fallbackKernel ? fallbackKernel
+                  : data.get_callback_type() == CallbackType::NONE
                       ? data.node->compiledKernel.get().get()
                       : data.node->compiledKernelWithCallbacks.get().get();
 
-            if(localCompiledKernel)
+            // name the kernel's range after its node
+            std::optional<RoctxRange> kernelRange;
+            if(RoctxRange::Enabled())
+            {
+                auto name = PrintScheme(data.node->scheme);
+                if(localCompiledKernel)
+                    name += " " + localCompiledKernel->kernel_name;
+                kernelRange.emplace(name);
+            }
+
+            if(fallbackKernel)
+                fallbackKernel->launch_fallback(data, data.node->deviceProp);
+            else if(localCompiledKernel)
                 localCompiledKernel->launch(data, data.node->deviceProp);
             else
                 fn(&data, &back);
+            kernelRange.reset();
 
             if(emit_profile_log)
                 if(hipEventRecord(stop) != hipSuccess)
                     throw std::runtime_error("hipEventRecord failure");
+            if(profile)
+                profile->End(profileSlot, data.rocfft_stream, i, KernelBytesMoved(*data.node));
 
             // If we were on the null stream, measure elapsed time
             // and emit profile logging.  If a stream was given, we
@@ -847,10 +1642,14 @@ void TransformPowX(const ExecPlan&       execPlan,
                 if(hipEventSynchronize(stop) != hipSuccess)
                     throw std::runtime_error("hipEventSynchronize failure");
                 size_t in_size_bytes = data_size_bytes(
-                    data.node->length, data.node->precision, data.node->inArrayType);
+                    data.node->length,
+                    storage_real_size(data.node->loadOps.storage, data.node->precision),
+                    data.node->inArrayType);
                 size_t out_size_bytes = data_size_bytes(
-                    data.node->length, data.node->precision, data.node->outArrayType);
-                size_t total_size_bytes = (in_size_bytes + out_size_bytes) * data.node->batch;
+                    data.node->length,
+                    storage_real_size(data.node->storeOps.storage, data.node->precision),
+                    data.node->outArrayType);
+                size_t total_size_bytes = (in_size_bytes + out_size_bytes) * data.get_batch();
 
                 float duration_ms = 0.0f;
                 if(hipEventElapsedTime(&duration_ms, start, stop) != hipSuccess)
@@ -862,9 +1661,35 @@ void TransformPowX(const ExecPlan&       execPlan,
                 if(processing_tuning)
                     tuningPacket->bw_effs[i] = efficiency_pct;
 
+                const auto&  gp      = data.gridParam;
+                const size_t grid[]  = {gp.b_x, gp.b_y, gp.b_z};
+                const size_t block[] = {gp.wgs_x, gp.wgs_y, gp.wgs_z};
+
+                // roofline position: flops from the kernel's factorization
+                // over the bytes it moves.  occupancy is 0 for kernels
+                // that were not runtime-compiled, and -1 if the query
+                // failed.
+                double flops  = KernelFlops(*data.node) * data.get_batch() / data.node->batch;
+                double gflops = duration_ms > 0.0f ? flops / (1e6 * duration_ms) : 0.0;
+                double arithmetic_intensity
+                    = total_size_bytes ? flops / static_cast<double>(total_size_bytes) : 0.0;
+                int occupancy = 0;
+                if(localCompiledKernel
+                   && !localCompiledKernel->get_occupancy(
+                       {gp.wgs_x, gp.wgs_y, gp.wgs_z}, gp.lds_bytes, occupancy))
+                    occupancy = -1;
                 log_profile(__func__,
                             "scheme",
                             PrintScheme(execPlan.execSeq[i]->scheme),
+                            "kernel_name",
+                            localCompiledKernel ? localCompiledKernel->kernel_name
+                                                : std::string(),
+                            "grid",
+                            std::make_pair(static_cast<const size_t*>(grid), size_t(3)),
+                            "block",
+                            std::make_pair(static_cast<const size_t*>(block), size_t(3)),
+                            "lds_bytes",
+                            gp.lds_bytes,
                             "duration_ms",
                             duration_ms,
                             "in_size",
@@ -878,6 +1703,16 @@ void TransformPowX(const ExecPlan&       execPlan,
                             max_memory_bw,
                             "bw_efficiency_pct",
                             efficiency_pct,
+                            "flops",
+                            flops,
+                            "gflops",
+                            gflops,
+                            "arithmetic_intensity",
+                            arithmetic_intensity,
+                            "occupancy",
+                            occupancy,
+                            "precision",
+                            data.node->precision,
                             "kernel_index",
                             i);
             }
@@ -891,7 +1726,14 @@ void TransformPowX(const ExecPlan&       execPlan,
             rocfft_cout << "null ptr function call error\n";
         }
 
-        if(emit_kernelio_log && data.node->scheme != CS_KERNEL_CHIRP)
+        if(concurrent && execPlan.execSignals[i])
+        {
+            if(hipEventRecord(lanes.events[nodeEvents[i]], data.rocfft_stream) != hipSuccess)
+                throw std::runtime_error("hipEventRecord failure");
+        }
+
+        if(emit_kernelio_log && data.node->scheme != CS_KERNEL_CHIRP
+           && data.node->scheme != CS_KERNEL_RADER_CHIRP)
         {
             hipError_t err = hipPeekAtLastError();
             if(err != hipSuccess)
@@ -907,51 +1749,83 @@ void TransformPowX(const ExecPlan&       execPlan,
         }
     }
 
-    if(emit_kernelio_log)
+    // join the lanes back to the execution's stream
+    if(concurrent)
+    {
+        for(size_t lane = 1; lane < execPlan.execLaneCount; ++lane)
+        {
+            auto join = lanes.events[forkEvent + lane];
+            if(hipEventRecord(join, lanes.streams[lane - 1]) != hipSuccess)
+                throw std::runtime_error("hipEventRecord failure");
+            if(hipStreamWaitEvent(info->rocfft_stream, join, 0) != hipSuccess)
+                throw std::runtime_error("hipStreamWaitEvent failure");
+        }
+    }
+
+    rocfft_precision outPrecision;
+    if(emit_kernelio_log
+       && !storage_print_precision(
+           execPlan.rootPlan->storeOps.storage, execPlan.rootPlan->precision, outPrecision))
+    {
+        *kernelio_stream << "multiPlanIdx " << multiPlanIdx << " final output: ("
+                         << storage_format_name(execPlan.rootPlan->storeOps.storage)
+                         << " storage not printed)" << std::endl
+                         << std::endl;
+    }
+    else if(emit_kernelio_log)
     {
+        // output ops leave real values in the output buffer
+        auto outArrayType
+            = execPlan.rootPlan->storeOps.stored_array_type(execPlan.rootPlan->outArrayType);
+
         // offsets have only been applied to pointers given to kernels,
         // so apply them here for printing too
         void* out_buffer_offset[2] = {out_buffer[0], out_buffer[1]};
         if(execPlan.rootPlan->oOffset)
         {
-            out_buffer_offset[0] = ptr_offset(out_buffer_offset[0],
-                                              execPlan.rootPlan->oOffset,
-                                              execPlan.rootPlan->precision,
-                                              execPlan.rootPlan->outArrayType);
-            out_buffer_offset[1] = ptr_offset(out_buffer_offset[1],
-                                              execPlan.rootPlan->oOffset,
-                                              execPlan.rootPlan->precision,
-                                              execPlan.rootPlan->outArrayType);
+            for(auto& buf : out_buffer_offset)
+                buf = storage_ptr_offset(buf,
+                                         execPlan.rootPlan->oOffset,
+                                         execPlan.rootPlan->storeOps.storage,
+                                         execPlan.rootPlan->precision,
+                                         outArrayType);
         }
 
+        // only the executed transforms are in the output
+        const size_t outBatch = partialBatch
+                                    ? ExecBatch(*execPlan.rootPlan, info->planBatch, info->batch)
+                                    : execPlan.rootPlan->batch;
+
         std::vector<hostbuf> bufOutHost;
-        CopyDeviceBufferToHost(execPlan.rootPlan->outArrayType,
-                               execPlan.rootPlan->precision,
+        CopyDeviceBufferToHost(outArrayType,
+                               outPrecision,
                                out_buffer_offset,
                                execPlan.rootPlan->GetOutputLength(),
                                execPlan.rootPlan->outStride,
                                execPlan.rootPlan->oDist,
-                               execPlan.rootPlan->batch,
+                               outBatch,
                                bufOutHost);
 
         *kernelio_stream << "multiPlanIdx " << multiPlanIdx << " final output: " << std::endl;
         DebugPrintBuffer(*kernelio_stream,
-                         execPlan.rootPlan->outArrayType,
-                         execPlan.rootPlan->precision,
+                         outArrayType,
+                         outPrecision,
                          bufOutHost,
                          execPlan.rootPlan->GetOutputLength(),
                          execPlan.rootPlan->outStride,
                          execPlan.rootPlan->oDist,
-                         execPlan.rootPlan->batch);
+                         outBatch);
         *kernelio_stream << "multiPlanIdx " << multiPlanIdx << " final output hash: " << std::endl;
         DebugPrintHash(*kernelio_stream,
-                       execPlan.rootPlan->outArrayType,
-                       execPlan.rootPlan->precision,
+                       outArrayType,
+                       outPrecision,
                        bufOutHost,
                        execPlan.rootPlan->GetOutputLength(),
                        execPlan.rootPlan->outStride,
                        execPlan.rootPlan->oDist,
-                       execPlan.rootPlan->batch);
+                       outBatch);
         *kernelio_stream << std::endl;
     }
+
+    return execPlan.execSeq.size() - fusedLaunches;
 }
@@ -25,7 +25,9 @@
 #include <numeric>
 #include <vector>
 
+#include "../../shared/environment.h"
 #include "chirp.h"
+#include "ipc_tables.h"
 #include "logging.h"
 #include "node_factory.h"
 #include "plan.h"
@@ -37,6 +39,158 @@
 std::mutex        Repo::mtx;
 std::atomic<bool> Repo::repoDestroyed(false);
 
+Repo::Repo()
+{
+    auto env_size = rocfft_getenv("ROCFFT_TWIDDLE_CACHE_SIZE");
+    if(!env_size.empty())
+    {
+        try
+        {
+            retain_limit = std::stoull(env_size);
+        }
+        catch(std::exception&)
+        {
+            retain_limit = 0;
+        }
+    }
+}
+
+std::pair<void*, size_t> Repo::Acquire(std::pair<gpubuf, unsigned int>& entry)
+{
+    if(entry.second == 0)
+    {
+        auto pos = retained_pos.find(entry.first.data());
+        if(pos != retained_pos.end())
+        {
+            retained.erase(pos->second);
+            retained_pos.erase(pos);
+            retained_bytes -= entry.first.size();
+        }
+    }
+    entry.second += 1;
+    return {entry.first.data(), entry.first.size()};
+}
+
+bool Repo::Retain(void* ptr, size_t bytes)
+{
+    if(bytes > retain_limit)
+        return false;
+    retained.push_front(ptr);
+    retained_pos.emplace(ptr, retained.begin());
+    retained_bytes += bytes;
+    EvictRetained(retain_limit);
+    return true;
+}
+
+void Repo::EvictRetained(size_t limit)
+{
+    // remove ptr's table from whichever map holds it, returning its size
+    auto erase_table = [](void* ptr, auto& tables, auto& tables_reverse) -> size_t {
+        auto reverse_it = tables_reverse.find(ptr);
+        if(reverse_it == tables_reverse.end())
+            return 0;
+        size_t bytes    = 0;
+        auto forward_it = tables.find(reverse_it->second);
+        if(forward_it != tables.end())
+        {
+            bytes = forward_it->second.first.size();
+            tables.erase(forward_it);
+        }
+        tables_reverse.erase(reverse_it);
+        return bytes;
+    };
+
+    while(retained_bytes > limit && !retained.empty())
+    {
+        void* ptr = retained.back();
+        retained.pop_back();
+        retained_pos.erase(ptr);
+
+        size_t bytes = erase_table(ptr, twiddles_1D, twiddles_1D_reverse);
+        if(!bytes)
+            bytes = erase_table(ptr, twiddles_2D, twiddles_2D_reverse);
+        if(!bytes)
+            bytes = erase_table(ptr, chirp, chirp_reverse);
+        if(!bytes)
+            bytes = erase_table(ptr, chirp_fft, chirp_fft_reverse);
+        retained_bytes -= std::min(bytes, retained_bytes);
+    }
+}
+
+// Twiddle and chirp tables are read-only, so if
+// ROCFFT_SHARE_TWIDDLES=1, a device can read another device's copy of
+// a table through peer access instead of building its own.
+static bool share_tables_across_devices()
+{
+    return rocfft_getenv("ROCFFT_SHARE_TWIDDLES") == "1";
+}
+
+// Find a table matching key on another device that key.deviceId (the
+// current device) can access as a peer, enabling that access if needed.
+template <typename KeyType>
+static typename std::map<KeyType, std::pair<gpubuf, unsigned int>>::iterator
+    find_peer_table(KeyType key, std::map<KeyType, std::pair<gpubuf, unsigned int>>& tables)
+{
+    int deviceId    = key.deviceId;
+    int deviceCount = 0;
+    if(hipGetDeviceCount(&deviceCount) != hipSuccess)
+        return tables.end();
+
+    for(int peer = 0; peer < deviceCount; ++peer)
+    {
+        if(peer == deviceId)
+            continue;
+        key.deviceId = peer;
+        auto it      = tables.find(key);
+        if(it == tables.end())
+            continue;
+
+        int canAccess = 0;
+        if(hipDeviceCanAccessPeer(&canAccess, deviceId, peer) != hipSuccess || !canAccess)
+            continue;
+        auto err = hipDeviceEnablePeerAccess(peer, 0);
+        if(err == hipErrorPeerAccessAlreadyEnabled)
+        {
+            // clear the sticky error so later calls don't see it
+            (void)hipGetLastError();
+        }
+        else if(err != hipSuccess)
+            continue;
+        // the peer's copy may still be generating
+        table_stream_synchronize(peer);
+        return it;
+    }
+    return tables.end();
+}
+
+// With ROCFFT_SHARE_TWIDDLES_IPC, map a table that another process
+// on the node built for the same physical device.  Imported tables
+// are not owned by the repo - they're unmapped when released.
+template <typename KeyType>
+static typename std::map<KeyType, std::pair<gpubuf, unsigned int>>::iterator
+    open_ipc_table(const KeyType&                                      key,
+                   const std::string&                                  ipcKey,
+                   std::map<KeyType, std::pair<gpubuf, unsigned int>>& tables,
+                   std::map<void*, KeyType>&                           tables_reverse)
+{
+    auto shared = ipc_table_open(ipcKey);
+    if(!shared.first)
+        return tables.end();
+    auto buf = gpubuf::make_nonowned(shared.first, shared.second);
+    auto it  = tables.insert({key, std::make_pair(std::move(buf), 1)}).first;
+    tables_reverse.insert({shared.first, key});
+    return it;
+}
+
+// publish a table this process just built.  Other processes may
+// read it as soon as it's published, so it must finish generating
+// first.
+static void publish_ipc_table(const std::string& ipcKey, int deviceId, const gpubuf& buf)
+{
+    table_stream_synchronize(deviceId);
+    ipc_table_publish(ipcKey, buf.data(), buf.size());
+}
+
 template <typename KeyType>
 std::pair<void*, size_t>
     Repo::GetTwiddlesInternal(KeyType                                             key,
@@ -59,8 +213,25 @@ std::pair<void*, size_t>
     if(it != twiddles.end())
     {
         // already had this length
-        it->second.second += 1;
-        return {it->second.first.data(), it->second.first.size()};
+        return Repo::GetRepo().Acquire(it->second);
+    }
+
+    // or another device might have it
+    if(share_tables_across_devices())
+    {
+        it = find_peer_table(key, twiddles);
+        if(it != twiddles.end())
+            return Repo::GetRepo().Acquire(it->second);
+    }
+
+    // or another process
+    std::string ipcKey;
+    if(ipc_tables_enabled())
+    {
+        ipcKey = ipc_table_device_key(key.deviceId) + "_" + key.str();
+        it     = open_ipc_table(key, ipcKey, twiddles, twiddles_reverse);
+        if(it != twiddles.end())
+            return {it->second.first.data(), it->second.first.size()};
     }
 
     // otherwise, need to allocate
@@ -68,6 +239,8 @@ std::pair<void*, size_t>
     // if allocation failed, don't update maps
     if(buf.data() == nullptr)
         return {nullptr, 0};
+    if(!ipcKey.empty())
+        publish_ipc_table(ipcKey, key.deviceId, buf);
     it = twiddles.insert({key, std::make_pair(std::move(buf), 1)}).first;
     twiddles_reverse.insert({it->second.first.data(), key});
     return {it->second.first.data(), it->second.first.size()};
@@ -95,8 +268,25 @@ std::pair<void*, size_t>
     if(it != chirp.end())
     {
         // already had this length
-        it->second.second += 1;
-        return {it->second.first.data(), it->second.first.size()};
+        return Repo::GetRepo().Acquire(it->second);
+    }
+
+    // or another device might have it
+    if(share_tables_across_devices())
+    {
+        it = find_peer_table(key, chirp);
+        if(it != chirp.end())
+            return Repo::GetRepo().Acquire(it->second);
+    }
+
+    // or another process
+    std::string ipcKey;
+    if(ipc_tables_enabled())
+    {
+        ipcKey = ipc_table_device_key(key.deviceId) + "_" + key.str();
+        it     = open_ipc_table(key, ipcKey, chirp, chirp_reverse);
+        if(it != chirp.end())
+            return {it->second.first.data(), it->second.first.size()};
     }
 
     // otherwise, need to allocate
@@ -104,6 +294,8 @@ std::pair<void*, size_t>
     // if allocation failed, don't update maps
     if(buf.data() == nullptr)
         return {nullptr, 0};
+    if(!ipcKey.empty())
+        publish_ipc_table(ipcKey, key.deviceId, buf);
     it = chirp.insert({key, std::make_pair(std::move(buf), 1)}).first;
     chirp_reverse.insert({it->second.first.data(), key});
     return {it->second.first.data(), it->second.first.size()};
@@ -132,6 +324,13 @@ void Repo::ReleaseTwiddlesInternal(void*
     forward_it->second.second -= 1;
     if(forward_it->second.second == 0)
     {
+        // other processes may still be reading a published table,
+        // and an imported one is cheap to map again
+        if(ipc_table_published(ptr))
+            return;
+        // keep it for reuse if there's room
+        if(!ipc_table_close(ptr) && Repo::GetRepo().Retain(ptr, forward_it->second.first.size()))
+            return;
         // remove from both maps
         twiddles.erase(forward_it);
         twiddles_reverse.erase(reverse_it);
@@ -161,6 +360,13 @@ void Repo::ReleaseChirpInternal(void*
     forward_it->second.second -= 1;
     if(forward_it->second.second == 0)
     {
+        // other processes may still be reading a published table,
+        // and an imported one is cheap to map again
+        if(ipc_table_published(ptr))
+            return;
+        // keep it for reuse if there's room
+        if(!ipc_table_close(ptr) && Repo::GetRepo().Retain(ptr, forward_it->second.first.size()))
+            return;
         // remove from both maps
         chirp.erase(forward_it);
         chirp_reverse.erase(reverse_it);
@@ -219,6 +425,29 @@ std::pair<void*, size_t> Repo::GetTwiddles2D(size_t                     length0,
         });
 }
 
+std::pair<void*, size_t> Repo::GetTwiddles3D(size_t                     length0,
+                                             size_t                     length1,
+                                             size_t                     length2,
+                                             rocfft_precision           precision,
+                                             const hipDeviceProp_t&     deviceProp,
+                                             const std::vector<size_t>& radices1,
+                                             const std::vector<size_t>& radices2,
+                                             const std::vector<size_t>& radices3)
+{
+    std::lock_guard<std::mutex> lck(mtx);
+    Repo&                       repo = Repo::GetRepo();
+
+    repo_twd_key_2D_t key{length0, length1, precision, radices1, radices2, length2, radices3};
+    return GetTwiddlesInternal(
+        key, repo.twiddles_2D, repo.twiddles_2D_reverse, [&](unsigned int deviceId) {
+            return twiddles_create_3D({length0, length1, length2},
+                                      precision,
+                                      deviceProp,
+                                      {radices1, radices2, radices3},
+                                      deviceId);
+        });
+}
+
 std::pair<void*, size_t>
     Repo::GetChirp(size_t length, rocfft_precision precision, const hipDeviceProp_t& deviceProp)
 {
@@ -231,6 +460,31 @@ std::pair<void*, size_t>
     });
 }
 
+std::pair<void*, size_t>
+    Repo::GetChirpFFT(size_t                                         length,
+                      size_t                                         lengthBlue,
+                      rocfft_precision                               precision,
+                      int                                            direction,
+                      size_t                                         bytes,
+                      const std::function<void(void*, hipStream_t)>& populate)
+{
+    std::lock_guard<std::mutex> lck(mtx);
+    Repo&                       repo = Repo::GetRepo();
+
+    // generation is enqueued while the lock is held, so any plan
+    // that finds this buffer ends its tables after the generation
+    repo_chirp_fft_key_t key{length, lengthBlue, precision, direction};
+    return GetChirpInternal(
+        key, repo.chirp_fft, repo.chirp_fft_reverse, [&](unsigned int deviceId) {
+            gpubuf buf;
+            if(buf.alloc(bytes) != hipSuccess)
+                throw std::runtime_error("unable to allocate chirp FFT length "
+                                         + std::to_string(lengthBlue));
+            populate(buf.data(), table_stream(deviceId));
+            return buf;
+        });
+}
+
 void Repo::ReleaseTwiddle1D(void* ptr)
 {
     std::lock_guard<std::mutex> lck(mtx);
@@ -252,7 +506,8 @@ void Repo::ReleaseChirp(void* ptr)
     std::lock_guard<std::mutex> lck(mtx);
 
     Repo& repo = Repo::GetRepo();
-    return ReleaseChirpInternal(ptr, repo.chirp, repo.chirp_reverse);
+    ReleaseChirpInternal(ptr, repo.chirp, repo.chirp_reverse);
+    ReleaseChirpInternal(ptr, repo.chirp_fft, repo.chirp_fft_reverse);
 }
 
 void Repo::Clear()
@@ -262,10 +517,55 @@ void Repo::Clear()
         return;
     Repo& repo = Repo::GetRepo();
 
+    ipc_tables_clear();
     repo.twiddles_1D.clear();
     repo.twiddles_2D.clear();
     twiddle_streams_cleanup();
 
     repo.chirp.clear();
-    chirp_streams_cleanup();
+    repo.chirp_fft.clear();
+
+    repo.retained.clear();
+    repo.retained_pos.clear();
+    repo.retained_bytes = 0;
+}
+
+void Repo::BeginTables(hipStream_t stream)
+{
+    std::lock_guard<std::mutex> lck(mtx);
+
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        throw std::runtime_error("hipGetDevice failed.");
+
+    // the event can be destroyed as soon as the wait is enqueued
+    hipEvent_wrapper_t event;
+    event.alloc();
+    if(hipEventRecord(event, stream) != hipSuccess
+       || hipStreamWaitEvent(table_stream(deviceId), event, 0) != hipSuccess)
+        throw std::runtime_error("failed to order table generation after stream");
+}
+
+std::shared_ptr<hipEvent_wrapper_t> Repo::EndTables(hipStream_t stream)
+{
+    std::lock_guard<std::mutex> lck(mtx);
+
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        throw std::runtime_error("hipGetDevice failed.");
+
+    if(!stream)
+    {
+        table_stream_synchronize(deviceId);
+        return nullptr;
+    }
+
+    // the table stream is in-order, so this event also covers
+    // tables that other plans are still waiting for
+    auto event = std::make_shared<hipEvent_wrapper_t>();
+    event->alloc();
+    if(hipEventRecord(*event, table_stream(deviceId)) != hipSuccess
+       || hipStreamWaitEvent(stream, *event, 0) != hipSuccess)
+        throw std::runtime_error("failed to order stream after table generation");
+    return event;
 }
@@ -18,17 +18,27 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <atomic>
+#include <fstream>
 #include <functional>
+#include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <thread>
 
+#include <hip/hip_version.h>
+
 using namespace std::placeholders;
 
 #include "../../shared/concurrency.h"
 #include "../../shared/environment.h"
 #include "../../shared/work_queue.h"
 #include "function_pool.h"
+#include "mapped_file.h"
 #include "rtc_cache.h"
+#include "rtc_generic_gen.h"
 #include "rtc_realcomplex_gen.h"
 #include "rtc_stockham_gen.h"
 #include "rtc_twiddle_gen.h"
@@ -55,6 +65,167 @@ struct WorkItem
 };
 typedef WorkQueue<WorkItem> CompileQueue;
 
+// Code objects addressed by the content of their source, so that a
+// build can reuse kernels whose source has not changed even when
+// other parts of the generator have (which changes the generator
+// checksum that the RTC cache is keyed on).  The directory holds:
+//
+//   <arch>/<key>.co - compiled code objects
+//   src/<key>.cpp   - sources of kernels listed in a compile manifest
+//
+// A manifest lists kernels that are not in the directory instead of
+// compiling them, one "arch source output kernel_name" line per
+// kernel, with paths relative to the directory.  Each line can be
+// compiled elsewhere with "rocfft_rtc_helper arch < source > output",
+// and the outputs copied back into the directory for the next run to
+// reuse.
+class SourceAddressedCache
+{
+public:
+    SourceAddressedCache(const std::string& dir, const std::string& manifest_path)
+        : dir(dir)
+    {
+        std::error_code ec;
+        fs::create_directories(this->dir / "src", ec);
+        if(!manifest_path.empty())
+        {
+            manifest.open(manifest_path, std::ios::trunc);
+            if(!manifest)
+                throw std::runtime_error("unable to open manifest " + manifest_path);
+        }
+    }
+
+    bool writing_manifest() const
+    {
+        return manifest.is_open();
+    }
+    size_t manifest_entries() const
+    {
+        return manifest_count;
+    }
+
+    // key for a kernel's full source, including the compiler version
+    // since code objects differ between compilers
+    static std::string key(const std::string& kernel_src)
+    {
+        // FNV-1a, with the length to make collisions even less likely
+        FNV1aHash h;
+        h.add(std::to_string(HIP_VERSION) + "\n");
+        h.add(kernel_src);
+        std::stringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << h.value << "_" << std::dec
+           << kernel_src.size();
+        return ss.str();
+    }
+
+    bool find(const std::string& gpu_arch, const std::string& key, std::vector<char>& code) const
+    {
+        std::ifstream in(code_path(gpu_arch, key), std::ios::binary);
+        if(!in)
+            return false;
+        code.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return !code.empty();
+    }
+
+    void store(const std::string& gpu_arch, const std::string& key, const std::vector<char>& code)
+    {
+        // write to a temporary file and rename, so that concurrent
+        // builds sharing the directory never see a partial code object
+        auto            final_path = code_path(gpu_arch, key);
+        std::error_code ec;
+        fs::create_directories(final_path.parent_path(), ec);
+        auto tmp_path = final_path.string() + ".tmp" + std::to_string(tmp_counter++);
+        {
+            std::ofstream out(tmp_path, std::ios::binary);
+            out.write(code.data(), code.size());
+            if(!out)
+            {
+                fs::remove(tmp_path, ec);
+                return;
+            }
+        }
+        fs::rename(tmp_path, final_path, ec);
+        if(ec)
+            fs::remove(tmp_path, ec);
+    }
+
+    void add_to_manifest(const std::string& gpu_arch,
+                         const std::string& key,
+                         const std::string& kernel_name,
+                         const std::string& kernel_src)
+    {
+        auto src_path = dir / "src" / (key + ".cpp");
+        if(!fs::exists(src_path))
+        {
+            std::ofstream out(src_path, std::ios::binary);
+            out << kernel_src;
+        }
+
+        std::lock_guard<std::mutex> lock(manifest_mutex);
+        manifest << gpu_arch << " " << (fs::path("src") / (key + ".cpp")).string() << " "
+                 << (fs::path(gpu_arch) / (key + ".co")).string() << " " << kernel_name
+                 << std::endl;
+        ++manifest_count;
+    }
+
+private:
+    fs::path code_path(const std::string& gpu_arch, const std::string& key) const
+    {
+        return dir / gpu_arch / (key + ".co");
+    }
+
+    fs::path            dir;
+    std::ofstream       manifest;
+    std::mutex          manifest_mutex;
+    size_t              manifest_count = 0;
+    std::atomic<size_t> tmp_counter{0};
+};
+
+// compile one kernel for one arch into the temp cache, reusing or
+// listing it in the source-addressed cache if one is in use
+static void compile_kernel(const WorkItem&       item,
+                           const std::string&    gpu_arch_with_flags,
+                           SourceAddressedCache* source_cache)
+{
+    if(!source_cache)
+    {
+        RTCCache::cached_compile(
+            item.kernel_name, gpu_arch_with_flags, item.generate_src, generator_sum());
+        return;
+    }
+
+    // flags on the arch don't change the code that's generated
+    const auto gpu_arch = gpu_arch_with_flags.substr(0, gpu_arch_with_flags.find(':'));
+
+    // already built with this generator
+    if(!RTCCache::single->get_code_object(item.kernel_name, gpu_arch, generator_sum()).empty())
+        return;
+
+    kernel_src_gen_t  generate_src = item.generate_src;
+    const std::string generated    = generate_src(item.kernel_name);
+    const std::string kernel_src   = RTC_KERNEL_SRC_PREAMBLE + generated;
+    const auto        key          = SourceAddressedCache::key(kernel_src);
+
+    std::vector<char> code;
+    if(source_cache->find(gpu_arch, key, code))
+    {
+        RTCCache::single->store_code_object(item.kernel_name, gpu_arch, generator_sum(), code);
+        return;
+    }
+
+    if(source_cache->writing_manifest())
+    {
+        source_cache->add_to_manifest(gpu_arch, key, item.kernel_name, kernel_src);
+        return;
+    }
+
+    // the source is already generated, and cached_compile adds the
+    // preamble itself
+    code = RTCCache::cached_compile(
+        item.kernel_name, gpu_arch, generate_src, generator_sum());
+    source_cache->store(gpu_arch, key, code);
+}
+
 // call supplied function with exploded out combinations of
 // direction, placement, array types, unitstride-ness, callbacks
 void stockham_combo(ComputeScheme                     scheme,
@@ -249,6 +420,9 @@ void build_stockham_function_pool(CompileQueue& queue)
         specs.threads_per_transform = i.second.threads_per_transform[0];
         specs.half_lds              = i.second.half_lds;
         specs.direct_to_from_reg    = i.second.direct_to_from_reg;
+        if(scheme == CS_KERNEL_STOCKHAM)
+            specs.lds_bank_shift = StockhamGeneratorSpecs::resolve_lds_bank_shift(
+                i.second.lds_bank_shift, specs.length);
 
         stockham_combo(
             scheme,
@@ -292,6 +466,7 @@ void build_stockham_function_pool(CompileQueue& queue)
                                                             ltwd_base,
                                                             ltwd_step,
                                                             false,
+                                                            0,
                                                             ebtype,
                                                             dir_reg_type,
                                                             intrinsic,
@@ -310,6 +485,9 @@ void build_stockham_function_pool(CompileQueue& queue)
                     specs.threads_per_transform = i.second.threads_per_transform[0];
                     specs.half_lds              = i.second.half_lds;
                     specs.direct_to_from_reg    = i.second.direct_to_from_reg;
+                    if(scheme == CS_KERNEL_STOCKHAM)
+                        specs.lds_bank_shift = StockhamGeneratorSpecs::resolve_lds_bank_shift(
+                            i.second.lds_bank_shift, specs.length);
                     return stockham_rtc(specs,
                                         specs,
                                         nullptr,
@@ -324,6 +502,7 @@ void build_stockham_function_pool(CompileQueue& queue)
                                         ltwd_base,
                                         ltwd_step,
                                         false,
+                                        0,
                                         ebtype,
                                         dir_reg_type,
                                         intrinsic,
@@ -428,6 +607,21 @@ void build_twiddle(CompileQueue& queue)
     }
 }
 
+// generic kernels stand in for kernels that are still compiling, so
+// they're always needed
+void build_generic(CompileQueue& queue)
+{
+    for(auto precision : {rocfft_precision_single, rocfft_precision_double})
+    {
+        auto kernel_name = generic_rtc_kernel_name(precision);
+        std::function<std::string(const std::string&)> generate_src
+            = [=](const std::string& kernel_name) -> std::string {
+            return generic_rtc(kernel_name, precision);
+        };
+        queue.push({kernel_name, generate_src, ""});
+    }
+}
+
 void solution_kernel_combo(FMKey                             kernel_key,
                            std::function<void(int,
                                               rocfft_result_placement,
@@ -498,8 +692,13 @@ void solution_kernel_combo(FMKey                             kernel_key,
         {
             static_dims_range = {2, 3};
         }
+        // kernels that compute large twiddles are specialised for
+        // the large 1D length, which is not known here, so they are
+        // left to runtime compilation
+        if(config.compute_large_twd)
+            base_steps = {{0, 0}};
         // depends on use_3steps flag
-        if(config.use_3steps_large_twd)
+        else if(config.use_3steps_large_twd)
             base_steps = {{5, 3}, {6, 3}};
         else
             base_steps = {{8, 2}, {8, 3}};
@@ -608,14 +807,8 @@ void solution_kernel_combo(FMKey                             kernel_key,
     }
 }
 
-void build_solution_kernels(CompileQueue& queue)
+void build_solution_kernels(CompileQueue& queue, const std::vector<SolutionNode>& kernel_nodes)
 {
-    // build every kernel in the solution map
-    solution_map& solmap = solution_map::get_solution_map();
-
-    std::vector<SolutionNode> kernel_nodes;
-    solmap.get_all_kernels(kernel_nodes, true);
-
     // fused Bluestein kernels are always built at runtime
     auto fuseBlue = BluesteinFuseType::BFT_NONE;
 
@@ -630,6 +823,12 @@ void build_solution_kernels(CompileQueue& queue)
         auto                      precision = kernel_key.precision;
         auto                      scheme    = kernel_key.scheme;
         std::vector<unsigned int> factors;
+
+        // tuned transposes only choose the tiling of a built-in
+        // kernel, which is compiled at runtime
+        if(scheme == CS_KERNEL_TRANSPOSE || scheme == CS_KERNEL_TRANSPOSE_XY_Z
+           || scheme == CS_KERNEL_TRANSPOSE_Z_XY)
+            continue;
         std::copy(config.factors.begin(), config.factors.end(), std::back_inserter(factors));
 
         solution_kernel_combo(
@@ -670,7 +869,19 @@ void build_solution_kernels(CompileQueue& queue)
                 specs.threads_per_transform = config.threads_per_transform[0];
                 specs.half_lds              = config.half_lds;
                 specs.direct_to_from_reg    = config.direct_to_from_reg;
-                specs.wgs_is_derived        = true;
+                specs.matrix_butterflies
+                    = config.matrix_butterflies
+                      && StockhamGeneratorSpecs::can_use_matrix_butterflies(
+                          precision, config.workgroup_size, config.factors);
+                specs.pipelined_loads = config.pipelined_loads && scheme == CS_KERNEL_STOCKHAM;
+                if(scheme == CS_KERNEL_STOCKHAM)
+                    specs.lds_bank_shift = StockhamGeneratorSpecs::resolve_lds_bank_shift(
+                        config.lds_bank_shift, specs.length);
+                specs.octant_twiddles
+                    = config.octant_twiddles && scheme == CS_KERNEL_STOCKHAM
+                      && ebtype == EmbeddedType::NONE
+                      && StockhamGeneratorSpecs::can_use_octant_twiddles(specs.length);
+                specs.wgs_is_derived  = true;
                 // kernel_sol should specify the static_dim, need to set here,
                 // so move specs to local instead of captured (need mutable if captured)
                 specs.static_dim = static_dim;
@@ -687,6 +898,7 @@ void build_solution_kernels(CompileQueue& queue)
                                                             ltwd_base,
                                                             ltwd_step,
                                                             false,
+                                                            0,
                                                             ebtype,
                                                             dir_reg_type,
                                                             intrinsic,
@@ -712,6 +924,7 @@ void build_solution_kernels(CompileQueue& queue)
                                         ltwd_base,
                                         ltwd_step,
                                         false,
+                                        0,
                                         ebtype,
                                         dir_reg_type,
                                         intrinsic,
@@ -730,7 +943,7 @@ int main(int argc, char** argv)
 {
     if(argc < 5)
     {
-        puts("Usage: rocfft_aot_helper temp_cachefile.db output_cachefile.db "
+        puts("Usage: rocfft_aot_helper temp_cachefile.db output_cachefile.{db,rka} "
              "path/to/rocfft_rtc_helper gfx000 gfx001 ...");
         return 1;
     }
@@ -763,6 +976,20 @@ int main(int argc, char** argv)
 
     RTCCache::single->enable_write_mostly();
 
+    // optionally reuse code objects by the content of their source,
+    // and list the kernels that still need compiling in a manifest
+    // instead of compiling them here
+    std::unique_ptr<SourceAddressedCache> source_cache;
+    const auto source_cache_dir = rocfft_getenv("ROCFFT_AOT_SOURCE_CACHE");
+    const auto manifest_path    = rocfft_getenv("ROCFFT_AOT_MANIFEST");
+    if(!manifest_path.empty() && source_cache_dir.empty())
+    {
+        std::cerr << "ROCFFT_AOT_MANIFEST requires ROCFFT_AOT_SOURCE_CACHE" << std::endl;
+        return 1;
+    }
+    if(!source_cache_dir.empty())
+        source_cache = std::make_unique<SourceAddressedCache>(source_cache_dir, manifest_path);
+
     CompileQueue queue;
 
     static const size_t      NUM_THREADS = rocfft_concurrency();
@@ -770,7 +997,7 @@ int main(int argc, char** argv)
     threads.reserve(NUM_THREADS);
     for(size_t i = 0; i < NUM_THREADS; ++i)
     {
-        threads.emplace_back([&queue, &gpu_archs]() {
+        threads.emplace_back([&queue, &gpu_archs, &source_cache]() {
             while(true)
             {
                 auto item = queue.pop();
@@ -779,27 +1006,66 @@ int main(int argc, char** argv)
 
                 for(const auto& gpu_arch : gpu_archs)
                 {
-                    if(item.sol_arch_name.empty())
-                    {
-                        RTCCache::cached_compile(
-                            item.kernel_name, gpu_arch, item.generate_src, generator_sum());
-                    }
-                    else if(gpu_arch.find(item.sol_arch_name) != std::string::npos)
-                    {
-                        // std::cout << "arch: " << gpu_arch
-                        //           << ", solution-kernel: " << item.kernel_name << std::endl;
-                        RTCCache::cached_compile(
-                            item.kernel_name, gpu_arch, item.generate_src, generator_sum());
-                    }
+                    // solution kernels are only built for the arch
+                    // they were tuned on
+                    if(item.sol_arch_name.empty()
+                       || gpu_arch.find(item.sol_arch_name) != std::string::npos)
+                        compile_kernel(item, gpu_arch, source_cache.get());
                 }
             }
         });
     }
 
-    build_stockham_function_pool(queue);
-    build_realcomplex(queue);
+    // a workload profile lists the problem tokens of the plans to
+    // build kernels for.  Only their tuned kernels and the twiddle
+    // kernels every plan uses are built, instead of the generic set.
+    solution_map&             solmap       = solution_map::get_solution_map();
+    std::vector<SolutionNode> kernel_nodes;
+    const auto                profile_path = rocfft_getenv("ROCFFT_AOT_PROFILE");
+
+    // solutions tuned for the workload may come from their own file
+    const auto sol_map_path = rocfft_getenv("ROCFFT_AOT_SOL_MAP");
+    if(!sol_map_path.empty() && !solmap.read_solution_map_data(sol_map_path))
+    {
+        std::cerr << "failed to read solution map " << sol_map_path << std::endl;
+        return 1;
+    }
+    if(!profile_path.empty())
+    {
+        std::ifstream         profile(profile_path);
+        std::set<std::string> prob_tokens;
+        std::string           line;
+        while(std::getline(profile, line))
+        {
+            // one token per line, allowing blank lines and comments
+            line.erase(0, line.find_first_not_of(" \t"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if(!line.empty() && line[0] != '#')
+                prob_tokens.insert(line);
+        }
+        if(!profile || prob_tokens.empty())
+        {
+            std::cerr << "no problem tokens read from " << profile_path << std::endl;
+            return 1;
+        }
+
+        std::set<std::string> missing_tokens;
+        solmap.get_kernels_of_problems(prob_tokens, kernel_nodes, missing_tokens);
+        for(const auto& token : missing_tokens)
+            std::cerr << "warning: no solution for " << token
+                      << ", its kernels will be compiled at runtime" << std::endl;
+    }
+    else
+    {
+        // build every kernel in the solution map
+        solmap.get_all_kernels(kernel_nodes, true);
+
+        build_stockham_function_pool(queue);
+        build_realcomplex(queue);
+    }
     build_twiddle(queue);
-    build_solution_kernels(queue);
+    build_generic(queue);
+    build_solution_kernels(queue, kernel_nodes);
 
     // signal end of results with empty work items
     for(size_t i = 0; i < NUM_THREADS; ++i)
@@ -807,9 +1073,22 @@ int main(int argc, char** argv)
     for(size_t i = 0; i < NUM_THREADS; ++i)
         threads[i].join();
 
+    // the output would be missing the listed kernels, so leave it
+    // for the run after they're compiled
+    if(source_cache && source_cache->writing_manifest())
+    {
+        std::cout << source_cache->manifest_entries() << " kernels written to " << manifest_path
+                  << std::endl;
+        return 0;
+    }
+
     // write the output file using what we collected in the temporary
-    // cache
-    RTCCache::single->write_aot_cache(output_cache_file, generator_sum(), gpu_archs);
+    // cache.  an .rka output is written as a memory-mappable archive
+    // instead of a database.
+    if(fs::path(output_cache_file).extension() == ".rka")
+        RTCCache::single->write_aot_archive(output_cache_file, generator_sum(), gpu_archs);
+    else
+        RTCCache::single->write_aot_cache(output_cache_file, generator_sum(), gpu_archs);
 
     // try to shrink the temp cache file to 10 GiB
     try
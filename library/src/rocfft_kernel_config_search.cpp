@@ -45,7 +45,7 @@
 #include <set>
 
 static const std::vector<unsigned int> supported_factors
-    = {2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 16, 17};
+    = {2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 16, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61};
 static const std::vector<unsigned int> supported_wgs{64, 128, 256};
 
 // recursively find all unique factorizations of given length.  each
@@ -180,6 +180,7 @@ std::string test_kernel_src(const std::string&               kernel_name,
                         0,
                         0,
                         false,
+                        0,
                         EmbeddedType::NONE,
                         direct_to_from_reg ? DirectRegType::TRY_ENABLE_IF_SUPPORT
                                            : DirectRegType::FORCE_OFF_OR_NOT_SUPPORT,
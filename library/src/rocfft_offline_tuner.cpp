@@ -18,10 +18,13 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <filesystem>
 #include <iostream>
 #include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -30,8 +33,10 @@
 #include "../../shared/environment.h"
 #include "../../shared/gpubuf.h"
 #include "../../shared/hip_object_wrapper.h"
+#include "../../shared/power_sampler.h"
 #include "../../shared/rocfft_params.h"
 #include "rocfft/rocfft.h"
+#include "solution_map.h"
 #include "tuning_helper.h"
 
 inline void
@@ -106,11 +111,58 @@ int merge_solutions(const std::string& base_filename,
     return EXIT_SUCCESS;
 }
 
-int offline_tune_problems(rocfft_params& params, int verbose, int ntrial)
+// print the root problems of a solution map that were tuned with a
+// different kernel generator than this build's
+int list_stale_solutions(const std::string& sol_filename)
 {
     // don't use anything from solutions.cpp
     rocfft_setenv("ROCFFT_USE_EMPTY_SOL_MAP", "1");
 
+    auto& sol_map = solution_map::get_solution_map();
+    if(!sol_map.read_solution_map_data(sol_filename))
+    {
+        std::cout << "Reading Solution Map Failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<ProblemKey> stale_probs;
+    sol_map.get_stale_root_problems(stale_probs);
+
+    std::cout << "[GENERATOR_SUM]: " << solution_map::current_generator_sum() << std::endl;
+    for(const auto& key : stale_probs)
+        std::cout << "[STALE]: " << key.arch << ":" << key.probToken << std::endl;
+
+    return EXIT_SUCCESS;
+}
+
+int offline_tune_problems(rocfft_params&     params,
+                          int                verbose,
+                          int                ntrial,
+                          int                deviceId,
+                          const std::string& workspace,
+                          size_t             max_candidates,
+                          size_t             max_tree_shapes,
+                          bool               energy_objective,
+                          bool               access_modes_only)
+{
+    // don't use anything from solutions.cpp
+    rocfft_setenv("ROCFFT_USE_EMPTY_SOL_MAP", "1");
+
+    // we may have been started by a library that tunes on first use,
+    // don't let our own plans queue more tuning
+    rocfft_unsetenv("ROCFFT_TUNE_ON_FIRST_USE");
+
+    // results and csv files are written to subfolders of the
+    // workspace, so make sure they exist
+    if(!workspace.empty())
+    {
+        rocfft_setenv("TUNING_WORKSPACE", workspace.c_str());
+        std::filesystem::create_directories(std::filesystem::path(workspace) / "ResultSolutions");
+        std::filesystem::create_directories(std::filesystem::path(workspace) / "TuningData");
+    }
+
+    HIP_V_THROW(hipSetDevice(deviceId), "hipSetDevice failed");
+
     rocfft_setup();
 
     params.validate();
@@ -125,6 +177,19 @@ int offline_tune_problems(rocfft_params& params, int verbose, int ntrial)
     // create tuning parameters
     TuningBenchmarker* offline_tuner = nullptr;
     rocfft_get_offline_tuner_handle((void**)(&offline_tuner));
+    offline_tuner->GetPacket()->max_candidates    = max_candidates;
+    offline_tuner->GetPacket()->energy_objective  = energy_objective;
+    offline_tuner->GetPacket()->access_modes_only = access_modes_only;
+
+    // energy is the mean power while a trial ran, over its GPU time
+    std::unique_ptr<power_sampler> sampler;
+    if(energy_objective)
+    {
+        sampler = std::make_unique<power_sampler>(deviceId);
+        if(!sampler->valid())
+            throw std::runtime_error("GPU power draw is not readable for device "
+                                     + std::to_string(deviceId));
+    }
 
     // first time call create_plan is actually generating a bunch of combination of configs
     offline_tuner->SetInitStep(0);
@@ -202,11 +267,11 @@ int offline_tune_problems(rocfft_params& params, int verbose, int ntrial)
     static const double max_double = std::numeric_limits<double>().max();
 
     bool                     csv_is_created    = false;
-    double                   overall_best_time = max_double;
-    std::vector<int>         winner_phases     = std::vector<int>(num_nodes, 0);
-    std::vector<int>         winner_ids        = std::vector<int>(num_nodes, 0);
-    std::vector<std::string> kernels           = std::vector<std::string>(num_nodes, "");
-    std::vector<double>      node_best_times   = std::vector<double>(num_nodes, max_double);
+    double                   overall_best_cost = max_double;
+    std::string              best_shape_name;
+    std::vector<int>         best_winner_phases;
+    std::vector<int>         best_winner_ids;
+    std::vector<std::string> best_kernels;
 
     // calculate this once only
     const double totsize
@@ -216,140 +281,216 @@ int offline_tune_problems(rocfft_params& params, int verbose, int ntrial)
                                                                                            : 5.0;
     const double opscount = (double)params.nbatch * k * totsize * log(totsize) / log(2.0);
 
-    static const int TUNING_PHASE = 2;
-    for(int curr_phase = 0; curr_phase < TUNING_PHASE; ++curr_phase)
+    // trying only access modes keeps the library's factorizations,
+    // so there is nothing to permute in a second phase
+    const int TUNING_PHASE = access_modes_only ? 1 : 2;
+
+    // plan-level tuning: tune the kernels of every tree shape the
+    // problem can be decomposed into, and keep the fastest tree.
+    // access modes are only tried on the library's own tree.
+    size_t num_shapes = offline_tuner->GetNumOfTreeShapes();
+    if(max_tree_shapes > 0)
+        num_shapes = std::min(num_shapes, max_tree_shapes);
+    if(access_modes_only)
+        num_shapes = std::min<size_t>(num_shapes, 1);
+    for(size_t shape_id = 0; shape_id < num_shapes; ++shape_id)
     {
-        if(curr_phase > 0)
+        auto&       shapes     = offline_tuner->GetPacket()->tree_shapes;
+        std::string shape_name = (shape_id < shapes.size()) ? shapes[shape_id].name : "";
+        if(shape_id > 0)
         {
-            // SET TARGET_FACTOR and current PHASE
-            offline_tuner->SetInitStep(curr_phase);
+            // enumerate the candidates of this shape from scratch
+            offline_tuner->SetTreeShape(shape_id);
+            offline_tuner->SetInitStep(0);
 
-            // make sure we can re-create the plan
             params.free();
-
-            LIB_V_THROW(params.create_plan(), "Plan creation failed");
+            if(params.create_plan() != fft_status_success)
+            {
+                std::cout << "\nTree shape " << shape_name << " can't be built, Skipped"
+                          << std::endl;
+                continue;
+            }
+            if(offline_tuner->IsDuplicateTreeShape())
+            {
+                std::cout << "\nTree shape " << shape_name << " builds an earlier tree, Skipped"
+                          << std::endl;
+                continue;
+            }
+            num_nodes = offline_tuner->UpdateNumOfTuningNodes();
+            if(num_nodes == 0)
+                continue;
         }
+        std::cout << "\n[TREE_SHAPE]: " << shape_id << "/" << (num_shapes - 1) << ": "
+                  << shape_name << std::endl;
 
-        // keeping creating plan
-        for(int node_id = 0; node_id < num_nodes; ++node_id)
-        {
-            std::string winner_name;
-            int         winner_phase;
-            int         winner_id;
-            int         num_benchmarks = offline_tuner->GetNumOfKernelCandidates(node_id);
+        double                   shape_best_cost = max_double;
+        std::vector<int>         winner_phases   = std::vector<int>(num_nodes, 0);
+        std::vector<int>         winner_ids      = std::vector<int>(num_nodes, 0);
+        std::vector<std::string> kernels         = std::vector<std::string>(num_nodes, "");
+        std::vector<double>      node_best_costs = std::vector<double>(num_nodes, max_double);
 
-            offline_tuner->SetCurrentTuningNodeId(node_id);
-            for(int ssn = 0; ssn < num_benchmarks; ++ssn)
+        for(int curr_phase = 0; curr_phase < TUNING_PHASE; ++curr_phase)
+        {
+            if(curr_phase > 0)
             {
-                offline_tuner->SetCurrentKernelCandidateId(ssn);
-                std::cout << "\nTuning for node " << node_id << "/" << (num_nodes - 1)
-                          << ", tuning phase :" << curr_phase << "/" << (TUNING_PHASE - 1)
-                          << ", config :" << ssn << "/" << (num_benchmarks - 1) << std::endl;
+                // SET TARGET_FACTOR and current PHASE
+                offline_tuner->SetInitStep(curr_phase);
 
                 // make sure we can re-create the plan
                 params.free();
 
                 LIB_V_THROW(params.create_plan(), "Plan creation failed");
+            }
 
-                // skip low occupancy test...simple output gflops 0, and a max double as ms
-                BenchmarkInfo info = offline_tuner->GetCurrBenchmarkInfo();
-                // we allow 2D_SINGLE kernels with occupancy 1
-                if(info.threads_per_trans[1] != 0)
+            // keeping creating plan
+            for(int node_id = 0; node_id < num_nodes; ++node_id)
+            {
+                std::string winner_name;
+                int         winner_phase;
+                int         winner_id;
+                int         num_benchmarks = offline_tuner->GetNumOfKernelCandidates(node_id);
+
+                offline_tuner->SetCurrentTuningNodeId(node_id);
+                for(int ssn = 0; ssn < num_benchmarks; ++ssn)
                 {
-                    if(info.occupancy < 0)
+                    offline_tuner->SetCurrentKernelCandidateId(ssn);
+                    std::cout << "\nTuning for node " << node_id << "/" << (num_nodes - 1)
+                              << ", tuning phase :" << curr_phase << "/" << (TUNING_PHASE - 1)
+                              << ", config :" << ssn << "/" << (num_benchmarks - 1) << std::endl;
+
+                    // make sure we can re-create the plan
+                    params.free();
+
+                    LIB_V_THROW(params.create_plan(), "Plan creation failed");
+
+                    // skip low occupancy test...simple output gflops 0, and a max double as ms
+                    BenchmarkInfo info = offline_tuner->GetCurrBenchmarkInfo();
+                    // we allow 2D_SINGLE kernels with occupancy 1
+                    if(info.threads_per_trans[1] != 0)
                     {
-                        std::cout << "\nOccupancy -1 (unable to gen kernel), Skipped" << std::endl;
-                        offline_tuner->UpdateCurrBenchResult(max_double, 0);
-                        continue;
+                        if(info.occupancy < 0)
+                        {
+                            std::cout << "\nOccupancy -1 (unable to gen kernel), Skipped" << std::endl;
+                            offline_tuner->UpdateCurrBenchResult(max_double, 0, max_double);
+                            continue;
+                        }
                     }
-                }
-                else
-                {
-                    if(info.occupancy == 1 || info.occupancy < 0)
+                    else
                     {
-                        std::cout << "\nOccupancy 1 or -1, Skipped" << std::endl;
-                        offline_tuner->UpdateCurrBenchResult(max_double, 0);
-                        continue;
+                        if(info.occupancy == 1 || info.occupancy < 0)
+                        {
+                            std::cout << "\nOccupancy 1 or -1, Skipped" << std::endl;
+                            offline_tuner->UpdateCurrBenchResult(max_double, 0, max_double);
+                            continue;
+                        }
                     }
-                }
 
-                params.execute(pibuffer.data(), pobuffer.data());
+                    params.execute(pibuffer.data(), pobuffer.data());
+
+                    // Run the transform several times and record the execution time:
+                    std::vector<double> gpu_time(ntrial);
+                    std::vector<double> energy(sampler ? ntrial : 0);
 
-                // Run the transform several times and record the execution time:
-                std::vector<double> gpu_time(ntrial);
+                    hipEvent_wrapper_t start, stop;
+                    start.alloc();
+                    stop.alloc();
+                    for(unsigned int itrial = 0; itrial < gpu_time.size(); ++itrial)
+                    {
+                        if(sampler)
+                            HIP_V_THROW(hipDeviceSynchronize(), "hipDeviceSynchronize failed");
+                        const auto host_start = power_sampler::clock::now();
 
-                hipEvent_wrapper_t start, stop;
-                start.alloc();
-                stop.alloc();
-                for(unsigned int itrial = 0; itrial < gpu_time.size(); ++itrial)
-                {
-                    HIP_V_THROW(hipEventRecord(start), "hipEventRecord failed");
+                        HIP_V_THROW(hipEventRecord(start), "hipEventRecord failed");
 
-                    params.execute(pibuffer.data(), pobuffer.data());
+                        params.execute(pibuffer.data(), pobuffer.data());
 
-                    HIP_V_THROW(hipEventRecord(stop), "hipEventRecord failed");
-                    HIP_V_THROW(hipEventSynchronize(stop), "hipEventSynchronize failed");
+                        HIP_V_THROW(hipEventRecord(stop), "hipEventRecord failed");
+                        HIP_V_THROW(hipEventSynchronize(stop), "hipEventSynchronize failed");
+                        const auto host_stop = power_sampler::clock::now();
 
-                    float time;
-                    HIP_V_THROW(hipEventElapsedTime(&time, start, stop),
-                                "hipEventElapsedTime failed");
-                    gpu_time[itrial] = time;
-                }
+                        float time;
+                        HIP_V_THROW(hipEventElapsedTime(&time, start, stop),
+                                    "hipEventElapsedTime failed");
+                        gpu_time[itrial] = time;
+                        if(sampler)
+                            energy[itrial]
+                                = sampler->average_watts(host_start, host_stop) * time / 1e3;
+                    }
 
-                std::cout << "Execution gpu time:";
-                for(const auto& i : gpu_time)
-                {
-                    std::cout << " " << i;
-                }
-                std::cout << " ms" << std::endl;
+                    std::cout << "Execution gpu time:";
+                    for(const auto& i : gpu_time)
+                    {
+                        std::cout << " " << i;
+                    }
+                    std::cout << " ms" << std::endl;
 
-                std::cout << "Execution gflops:  ";
-                for(const auto& i : gpu_time)
-                {
-                    double gflops = opscount / (1e6 * i);
-                    std::cout << " " << gflops;
+                    std::cout << "Execution gflops:  ";
+                    for(const auto& i : gpu_time)
+                    {
+                        double gflops = opscount / (1e6 * i);
+                        std::cout << " " << gflops;
+                    }
+                    std::cout << std::endl;
+
+                    if(sampler)
+                    {
+                        std::cout << "Execution energy:";
+                        for(const auto& e : energy)
+                            std::cout << " " << e;
+                        std::cout << " J" << std::endl;
+                    }
+
+                    // get median, if odd, get middle one, else get avg(middle twos)
+                    auto median = [](std::vector<double>& v) {
+                        std::sort(v.begin(), v.end());
+                        return (v.size() % 2 == 1) ? v[v.size() / 2]
+                                                   : (v[v.size() / 2] + v[v.size() / 2 - 1]) / 2;
+                    };
+                    double ms_median     = median(gpu_time);
+                    double joules_median = energy.empty() ? 0.0 : median(energy);
+                    double gflops_median = opscount / (1e6 * ms_median);
+
+                    offline_tuner->UpdateCurrBenchResult(ms_median, gflops_median, joules_median);
+                    shape_best_cost = std::min(shape_best_cost,
+                                               energy_objective ? joules_median : ms_median);
                 }
-                std::cout << std::endl;
-
-                // get median, if odd, get middle one, else get avg(middle twos)
-                std::sort(gpu_time.begin(), gpu_time.end());
-                double ms_median
-                    = (gpu_time.size() % 2 == 1)
-                          ? gpu_time[gpu_time.size() / 2]
-                          : (gpu_time[gpu_time.size() / 2] + gpu_time[gpu_time.size() / 2 - 1]) / 2;
-                double gflops_median = opscount / (1e6 * ms_median);
-
-                offline_tuner->UpdateCurrBenchResult(ms_median, gflops_median);
-                overall_best_time = std::min(overall_best_time, ms_median);
+
+                offline_tuner->FindWinnerForCurrNode(
+                    node_best_costs[node_id], winner_phase, winner_id, winner_name);
+                std::cout << "\n[UP_TO_PHASE_" << curr_phase << "_RESULT]:" << std::endl;
+                std::cout << "\n[BEST_KERNEL]: In Phase: " << winner_phase
+                          << ", Config ID: " << winner_id << std::endl;
+
+                // update the latest winner info
+                winner_phases[node_id] = winner_phase;
+                winner_ids[node_id]    = winner_id;
+                kernels[node_id]       = winner_name;
+
+                bool is_last_phase = (curr_phase == TUNING_PHASE - 1);
+
+                // output data of this turn to csv
+                csv_is_created = offline_tuner->ExportCSV(csv_is_created) || csv_is_created;
+                if(!csv_is_created)
+                    std::cout << "CSV is not created or is written failed." << std::endl;
+
+                // pass the target factors to next phase with permutation
+                if(!is_last_phase)
+                    offline_tuner->PropagateBestFactorsToNextPhase();
             }
+        }
+
 
-            offline_tuner->FindWinnerForCurrNode(
-                node_best_times[node_id], winner_phase, winner_id, winner_name);
-            std::cout << "\n[UP_TO_PHASE_" << curr_phase << "_RESULT]:" << std::endl;
-            std::cout << "\n[BEST_KERNEL]: In Phase: " << winner_phase
-                      << ", Config ID: " << winner_id << std::endl;
-
-            // update the latest winner info
-            winner_phases[node_id] = winner_phase;
-            winner_ids[node_id]    = winner_id;
-            kernels[node_id]       = winner_name;
-
-            bool is_last_phase = (curr_phase == TUNING_PHASE - 1);
-            bool is_last_node  = (node_id == num_nodes - 1);
-
-            // output data of this turn to csv
-            csv_is_created = offline_tuner->ExportCSV(csv_is_created) || csv_is_created;
-            if(!csv_is_created)
-                std::cout << "CSV is not created or is written failed." << std::endl;
-
-            // pass the target factors to next phase with permutation
-            if(!is_last_phase)
-                offline_tuner->PropagateBestFactorsToNextPhase();
-
-            // in last phase and last node: finished tuning
-            // export to file (output the winner solutions to solution map)
-            if(is_last_phase && is_last_node)
-                offline_tuner->ExportWinnerToSolutions();
+        // export the winner solutions to the solution map file, if
+        // this tree is the fastest (or most frugal) so far
+        if(shape_best_cost < overall_best_cost)
+        {
+            overall_best_cost = shape_best_cost;
+            offline_tuner->ExportWinnerToSolutions();
+
+            best_shape_name    = shape_name;
+            best_winner_phases = winner_phases;
+            best_winner_ids    = winner_ids;
+            best_kernels       = kernels;
         }
     }
 
@@ -358,16 +499,22 @@ int offline_tune_problems(rocfft_params& params, int verbose, int ntrial)
 
     std::cout << "\n[OUTPUT_FILE]: " << out_path << std::endl;
     std::cout << "\n[BEST_SOLUTION]: " << params.token() << std::endl;
-    for(int node_id = 0; node_id < num_nodes; ++node_id)
+    std::cout << "[Result]: Tree shape: " << best_shape_name << std::endl;
+    for(size_t node_id = 0; node_id < best_kernels.size(); ++node_id)
     {
         std::cout << "[Result]: Node " << node_id << ":" << std::endl;
-        std::cout << "[Result]:     in phase   : " << winner_phases[node_id] << std::endl;
-        std::cout << "[Result]:     best config: " << winner_ids[node_id] << std::endl;
-        std::cout << "[Result]:     kernel name: " << kernels[node_id] << std::endl;
+        std::cout << "[Result]:     in phase   : " << best_winner_phases[node_id] << std::endl;
+        std::cout << "[Result]:     best config: " << best_winner_ids[node_id] << std::endl;
+        std::cout << "[Result]:     kernel name: " << best_kernels[node_id] << std::endl;
+    }
+    if(energy_objective)
+        std::cout << "[Result]: Energy: " << overall_best_cost << " J" << std::endl;
+    else
+    {
+        double best_gflops = opscount / (1e6 * overall_best_cost);
+        std::cout << "[Result]: GPU Time: " << overall_best_cost << std::endl;
+        std::cout << "[Result]: GFLOPS: " << best_gflops << std::endl;
     }
-    double best_gflops = opscount / (1e6 * overall_best_time);
-    std::cout << "[Result]: GPU Time: " << overall_best_time << std::endl;
-    std::cout << "[Result]: GFLOPS: " << best_gflops << std::endl;
 
     rocfft_cleanup();
 
@@ -389,11 +536,19 @@ int main(int argc, char* argv[])
     int  deviceId;
     int  ntrial;
 
+    std::string workspace       = "";
+    size_t      max_candidates  = 0;
+    size_t      max_tree_shapes = 0;
+    std::string objective       = "time";
+    bool        access_modes    = false;
+
     std::string base_sol_filename   = "";
     std::string adding_sol_filename = "";
     std::string adding_problemkey   = "";
     std::string output_sol_filename = "";
 
+    std::string stale_sol_filename = "";
+
     CLI::App app{"rocFFT offline tuner"};
 
     // Declare the supported options. Some option pointers are declared to track passed opts.
@@ -414,6 +569,34 @@ int main(int argc, char* argv[])
     tuning->add_option("-N, --ntrial", ntrial, "Trial size for the problem")
         ->default_val(1)
         ->check(CLI::NonNegativeNumber);
+    tuning->add_option("--workspace",
+                       workspace,
+                       "Folder to write results to (default: TUNING_WORKSPACE, or the current "
+                       "folder)");
+    tuning
+        ->add_option("--max_candidates",
+                     max_candidates,
+                     "Most kernel configurations to benchmark for each node in each phase, "
+                     "keeping the ones ranked highest by an analytic cost model, 0 for all")
+        ->default_val(0);
+    tuning
+        ->add_option("--max_tree_shapes",
+                     max_tree_shapes,
+                     "Most tree shapes (decompositions of the problem into kernels) to tune, "
+                     "starting with the library's own choice, 0 for all")
+        ->default_val(0);
+    tuning
+        ->add_option("--objective",
+                     objective,
+                     "What to minimize: time (default), or energy per execution, from the "
+                     "GPU's sampled power draw")
+        ->default_val("time")
+        ->check(CLI::IsMember({"time", "energy"}));
+    tuning->add_flag("--access_modes_only",
+                     access_modes,
+                     "Keep the library's own tree and kernel configurations, only trying "
+                     "direct-to-register and buffer instruction modes of SBCC, SBRC and SBCR "
+                     "kernels");
     tuning
         ->add_option("-t, --transformType",
                      params.transform_type,
@@ -498,6 +681,12 @@ int main(int argc, char* argv[])
         ->required()
         ->check(CLI::ExistingFile);
 
+    auto stale = app.add_subcommand(
+        "stale", "List problems whose solutions were tuned with a different kernel generator");
+    stale->add_option("--sol_file", stale_sol_filename, "Filename of solution-map to check")
+        ->required()
+        ->check(CLI::ExistingFile);
+
     app.require_subcommand(0, 1);
 
     CLI11_PARSE(app, argc, argv);
@@ -505,7 +694,15 @@ int main(int argc, char* argv[])
     if(tuning->parsed())
     {
         std::cout << std::flush;
-        return offline_tune_problems(params, verbose, ntrial);
+        return offline_tune_problems(params,
+                                     verbose,
+                                     ntrial,
+                                     deviceId,
+                                     workspace,
+                                     max_candidates,
+                                     max_tree_shapes,
+                                     objective == "energy",
+                                     access_modes);
     }
 
     if(merging->parsed())
@@ -514,6 +711,9 @@ int main(int argc, char* argv[])
             base_sol_filename, adding_sol_filename, adding_problemkey, output_sol_filename);
     }
 
+    if(stale->parsed())
+        return list_stale_solutions(stale_sol_filename);
+
     if(!tuning->parsed() && !merging->parsed())
         std::cout << app.help() << std::endl;
 }
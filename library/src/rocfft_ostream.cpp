@@ -422,6 +422,30 @@ rocfft_ostream& operator<<(rocfft_ostream& os, rocfft_transform_type type)
     case rocfft_transform_type_real_inverse:
         os << "real_inverse";
         break;
+    case rocfft_transform_type_dct1:
+        os << "dct1";
+        break;
+    case rocfft_transform_type_dct2:
+        os << "dct2";
+        break;
+    case rocfft_transform_type_dct3:
+        os << "dct3";
+        break;
+    case rocfft_transform_type_dct4:
+        os << "dct4";
+        break;
+    case rocfft_transform_type_dst1:
+        os << "dst1";
+        break;
+    case rocfft_transform_type_dst2:
+        os << "dst2";
+        break;
+    case rocfft_transform_type_dst3:
+        os << "dst3";
+        break;
+    case rocfft_transform_type_dst4:
+        os << "dst4";
+        break;
     }
     return os;
 }
@@ -19,6 +19,8 @@
 // THE SOFTWARE.
 
 #include "rtc_compile.h"
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <iterator>
 
@@ -27,6 +29,49 @@
 #include <io.h>
 #endif
 
+// read a length-prefixed string from stdin, returns false at EOF
+static bool read_request_string(std::string& str)
+{
+    uint64_t len = 0;
+    if(!std::cin.read(reinterpret_cast<char*>(&len), sizeof(len)))
+        return false;
+    str.resize(len);
+    return static_cast<bool>(std::cin.read(str.data(), len));
+}
+
+static void write_reply(char status, const char* data, uint64_t len)
+{
+    std::cout.write(&status, sizeof(status));
+    std::cout.write(reinterpret_cast<const char*>(&len), sizeof(len));
+    std::cout.write(data, len);
+    std::cout.flush();
+}
+
+// Serve compile requests until stdin is closed.  Each request is a
+// length-prefixed gpu arch followed by length-prefixed kernel
+// source.  Each reply is a status byte (0 for success), a length,
+// and the code object or error message.
+static int serve()
+{
+    std::string gpu_arch;
+    std::string kernel_src;
+    while(read_request_string(gpu_arch) && read_request_string(kernel_src))
+    {
+        try
+        {
+            auto code = compile_inprocess(kernel_src, gpu_arch);
+            write_reply(0, code.data(), code.size());
+        }
+        catch(std::exception& e)
+        {
+            write_reply(1, e.what(), strlen(e.what()));
+        }
+        if(!std::cout.good())
+            return 1;
+    }
+    return 0;
+}
+
 int main(int argc, const char* const* argv)
 {
 #ifdef WIN32
@@ -34,6 +79,9 @@ int main(int argc, const char* const* argv)
     _setmode(_fileno(stdout), _O_BINARY);
 #endif
 
+    if(argc == 2 && strcmp(argv[1], "--server") == 0)
+        return serve();
+
     try
     {
         if(argc != 2)
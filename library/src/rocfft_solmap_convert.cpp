@@ -37,6 +37,7 @@ int main(int argc, char* argv[])
 
     std::string input_filename  = "";
     std::string output_filename = "";
+    bool        binary          = false;
 
     // Declare the supported options.
     CLI::App app{"rocfft solution map converter command line options"};
@@ -45,8 +46,10 @@ int main(int argc, char* argv[])
         ->required()
         ->check(CLI::ExistingFile);
     app.add_option("--output_file", output_filename, "filename of new-solution-map")
-        ->required()
-        ->check(CLI::ExistingFile);
+        ->required();
+    app.add_flag("--binary",
+                 binary,
+                 "write a binary solution map, which loads faster than the text format");
 
     CLI11_PARSE(app, argc, argv);
 
@@ -54,7 +57,7 @@ int main(int argc, char* argv[])
     rocfft_setenv("ROCFFT_USE_EMPTY_SOL_MAP", "1");
 
     SolutionMapConverter converter;
-    bool check_result = converter.VersionCheckAndConvert(input_filename, output_filename);
+    bool check_result = converter.VersionCheckAndConvert(input_filename, output_filename, binary);
 
     if(!check_result)
     {
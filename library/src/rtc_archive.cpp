@@ -0,0 +1,183 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "rtc_archive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <hip/hip_version.h>
+#include <stdexcept>
+
+static const char     archive_magic[8] = {'R', 'O', 'C', 'F', 'F', 'T', 'K', 'A'};
+static const uint64_t archive_version  = 1;
+// alignment of code objects in the archive
+static const size_t CODE_ALIGN = 64;
+
+struct archive_header
+{
+    char                 magic[8];
+    uint64_t             version;
+    int64_t              hip_version;
+    std::array<char, 32> generator_sum;
+    uint64_t             entry_count;
+};
+static_assert(sizeof(archive_header) == 64, "unexpected archive header padding");
+
+struct archive_entry
+{
+    uint64_t hash;
+    uint64_t key_offset;
+    uint64_t key_len;
+    uint64_t code_offset;
+    uint64_t code_len;
+};
+static_assert(sizeof(archive_entry) == 40, "unexpected archive entry padding");
+
+// entries are looked up by the key "kernel_name\0arch"
+static std::string archive_key(const std::string& kernel_name, const std::string& gpu_arch)
+{
+    std::string key = kernel_name;
+    key.push_back('\0');
+    key += gpu_arch;
+    return key;
+}
+
+RTCArchive::RTCArchive(const std::filesystem::path& path)
+    : mapping(path, "archive")
+{
+    const char*  data = mapping.data();
+    const size_t size = mapping.size();
+
+    // check that the header and index are present.  offsets of
+    // individual entries are checked on lookup.
+    const auto header = reinterpret_cast<const archive_header*>(data);
+    if(size < sizeof(archive_header)
+       || std::memcmp(header->magic, archive_magic, sizeof(archive_magic)) != 0
+       || header->version != archive_version
+       || header->entry_count > (size - sizeof(archive_header)) / sizeof(archive_entry))
+        throw std::runtime_error("invalid archive " + path.string());
+}
+
+bool RTCArchive::is_archive(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char          magic[sizeof(archive_magic)] = {};
+    if(!file.read(magic, sizeof(magic)))
+        return false;
+    return std::memcmp(magic, archive_magic, sizeof(archive_magic)) == 0;
+}
+
+std::pair<const char*, size_t> RTCArchive::find(const std::string&          kernel_name,
+                                                const std::string&          gpu_arch,
+                                                const std::array<char, 32>& generator_sum) const
+{
+    const char*  data   = mapping.data();
+    const size_t size   = mapping.size();
+    const auto   header = reinterpret_cast<const archive_header*>(data);
+    if(header->hip_version != HIP_VERSION || header->generator_sum != generator_sum)
+        return {nullptr, 0};
+
+    auto key  = archive_key(kernel_name, gpu_arch);
+    auto hash = fnv1a_hash(key);
+
+    const auto begin = reinterpret_cast<const archive_entry*>(data + sizeof(archive_header));
+    const auto end   = begin + header->entry_count;
+    auto       it    = std::lower_bound(
+        begin, end, hash, [](const archive_entry& e, uint64_t h) { return e.hash < h; });
+
+    // entries with colliding hashes are adjacent, compare their keys
+    for(; it != end && it->hash == hash; ++it)
+    {
+        if(it->key_offset > size || it->key_len > size - it->key_offset
+           || it->code_offset > size || it->code_len > size - it->code_offset)
+            return {nullptr, 0};
+        if(it->key_len == key.size()
+           && std::memcmp(data + it->key_offset, key.data(), key.size()) == 0)
+            return {data + it->code_offset, it->code_len};
+    }
+    return {nullptr, 0};
+}
+
+void RTCArchive::write(const std::filesystem::path& path,
+                       const std::array<char, 32>&  generator_sum,
+                       const std::vector<record>&   records)
+{
+    struct sorted_record
+    {
+        std::string   key;
+        uint64_t      hash;
+        const record* rec;
+    };
+    std::vector<sorted_record> sorted;
+    sorted.reserve(records.size());
+    for(const auto& r : records)
+    {
+        auto key = archive_key(r.kernel_name, r.arch);
+        auto h   = fnv1a_hash(key);
+        sorted.push_back({std::move(key), h, &r});
+    }
+    // sort by key as well as hash, so the output is reproducible
+    std::sort(sorted.begin(), sorted.end(), [](const sorted_record& a, const sorted_record& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.key < b.key;
+    });
+
+    archive_header header;
+    std::memcpy(header.magic, archive_magic, sizeof(archive_magic));
+    header.version       = archive_version;
+    header.hip_version   = HIP_VERSION;
+    header.generator_sum = generator_sum;
+    header.entry_count   = sorted.size();
+
+    // lay out keys after the index, then code objects
+    std::vector<archive_entry> entries(sorted.size());
+    uint64_t offset = sizeof(archive_header) + sizeof(archive_entry) * sorted.size();
+    for(size_t i = 0; i < sorted.size(); ++i)
+    {
+        entries[i].hash       = sorted[i].hash;
+        entries[i].key_offset = offset;
+        entries[i].key_len    = sorted[i].key.size();
+        offset += sorted[i].key.size();
+    }
+    for(size_t i = 0; i < sorted.size(); ++i)
+    {
+        offset                 = (offset + CODE_ALIGN - 1) / CODE_ALIGN * CODE_ALIGN;
+        entries[i].code_offset = offset;
+        entries[i].code_len    = sorted[i].rec->code.size();
+        offset += sorted[i].rec->code.size();
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              sizeof(archive_entry) * entries.size());
+    for(const auto& s : sorted)
+        out.write(s.key.data(), s.key.size());
+    for(size_t i = 0; i < sorted.size(); ++i)
+    {
+        // zero-fill up to the aligned code offset
+        static const char padding[CODE_ALIGN] = {};
+        out.write(padding, entries[i].code_offset - static_cast<uint64_t>(out.tellp()));
+        out.write(sorted[i].rec->code.data(), sorted[i].rec->code.size());
+    }
+    if(!out)
+        throw std::runtime_error("failed to write archive " + path.string());
+}
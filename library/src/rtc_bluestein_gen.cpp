@@ -61,6 +61,31 @@ std::string bluestein_single_rtc_kernel_name(const BluesteinSingleSpecs& specs)
     return kernel_name;
 }
 
+// chirp value exp(dir * i * pi * n^2 / N).  n^2 is reduced modulo
+// 2N exactly in integer arithmetic, so sincospi's argument is always
+// in [-1, 1].
+static const char* bluestein_chirp_h = R"_SRC(
+template <typename T>
+__device__ T bluestein_chirp(size_t n, const size_t N, const int dir)
+{
+    long long r = (n * n) % (2 * N);
+    if(r > static_cast<long long>(N))
+        r -= 2 * N;
+    if constexpr(sizeof(real_type_t<T>) == sizeof(double))
+    {
+        double s, c;
+        sincospi(static_cast<double>(r) / N, &s, &c);
+        return T(c, dir * s);
+    }
+    else
+    {
+        float s, c;
+        sincospi(static_cast<float>(r) / N, &s, &c);
+        return T(c, dir * s);
+    }
+}
+)_SRC";
+
 std::string bluestein_single_rtc(const std::string& kernel_name, const BluesteinSingleSpecs& specs)
 {
     auto length               = specs.length;
@@ -79,6 +104,7 @@ std::string bluestein_single_rtc(const std::string& kernel_name, const Bluestein
     src += rtc_precision_type_decl(specs.precision);
 
     src += rtc_const_cbtype_decl(specs.cbtype);
+    src += bluestein_chirp_h;
 
     src += "static const unsigned int dim = " + std::to_string(specs.dim) + ";\n";
 
@@ -106,7 +132,6 @@ std::string bluestein_single_rtc(const std::string& kernel_name, const Bluestein
     func.body += CallbackStoreDeclaration("scalar_type", "cbtype");
 
     func.body += Declaration{lds};
-    func.body += Assign{bluestein.a, bluestein.buf_temp};
     func.body += Assign{bluestein.B, bluestein.buf_temp + lengthBlue};
     func.body += Assign{bluestein.A, lds};
 
@@ -154,6 +179,18 @@ std::string bluestein_multi_rtc_kernel_name(const BluesteinMultiSpecs& specs)
     case CS_KERNEL_RES_MUL:
         kernel_name += "bluestein_res_mul";
         break;
+    case CS_KERNEL_RADER_CHIRP:
+        kernel_name += "rader_chirp";
+        break;
+    case CS_KERNEL_RADER_GATHER:
+        kernel_name += "rader_gather";
+        break;
+    case CS_KERNEL_RADER_MUL:
+        kernel_name += "rader_mul";
+        break;
+    case CS_KERNEL_RADER_SCATTER:
+        kernel_name += "rader_scatter";
+        break;
     default:
         throw std::runtime_error("invalid bluestein rtc scheme");
     }
@@ -226,6 +263,76 @@ static std::string bluestein_multi_chirp_rtc(const std::string&         kernel_n
     return src;
 }
 
+// square-and-multiply, p < 2^32 so products fit in 64 bits
+static const char* rader_pow_mod_h = R"_SRC(
+__device__ size_t rader_pow_mod(size_t base, size_t exp, const size_t mod)
+{
+    size_t result = 1;
+    for(base %= mod; exp; exp >>= 1)
+    {
+        if(exp & 1)
+            result = result * base % mod;
+        base = base * base % mod;
+    }
+    return result;
+}
+)_SRC";
+
+static std::string rader_chirp_rtc(const std::string& kernel_name, const BluesteinMultiSpecs& specs)
+{
+    // function arguments
+    Variable N{"N", "const size_t"};
+    Variable M{"M", "const size_t"};
+    Variable output{"output", "scalar_type", true, true};
+    Variable root{"root", "const size_t"};
+    Variable root_inv{"root_inv", "const size_t"};
+    Variable dir{"dir", "const int"};
+
+    Function func{kernel_name};
+    func.launch_bounds = LAUNCH_BOUNDS_BLUESTEIN_MULTI_KERNEL;
+    func.qualifier     = "extern \"C\" __global__";
+    func.arguments.append(N);
+    func.arguments.append(M);
+    func.arguments.append(output);
+    func.arguments.append(root);
+    func.arguments.append(root_inv);
+    func.arguments.append(dir);
+
+    Variable tx{"tx", "size_t"};
+    Variable rader_idx{"rader_idx", "unsigned int", true};
+    Variable gq{"gq", "size_t"};
+    Variable gi{"gi", "size_t"};
+    Variable theta{"theta", "double"};
+    Variable MI{"MI", "double"};
+
+    func.body += Declaration{tx, "threadIdx.x + blockIdx.x * blockDim.x"};
+    func.body += If{tx >= N - 1, {Return{}}};
+
+    func.body += CommentLines{"g^q and g^-q tables at the front of the buffer, used to",
+                              "gather the input and scatter the output"};
+    func.body += Declaration{rader_idx, Literal{"reinterpret_cast<unsigned int*>(output)"}};
+    func.body += Declaration{gq, CallExpr{"rader_pow_mod", {root, tx, N}}};
+    func.body += Declaration{gi, CallExpr{"rader_pow_mod", {root_inv, tx, N}}};
+    func.body += Assign{rader_idx[tx], gq};
+    func.body += Assign{rader_idx[N - 1 + tx], gi};
+
+    func.body += CommentLines{"convolution kernel W^(g^-q), with the inverse FFT's",
+                              "1/(p-1) normalization folded in"};
+    func.body += Declaration{
+        theta,
+        CallExpr{"double", {dir}} * Literal{"6.283185307179586476925286766559"} * gi / N};
+    func.body += Declaration{MI, Literal{"1.0"} / CallExpr{"double", {N - 1}}};
+    func.body += Assign{output[2 * M + tx],
+                        CallExpr{"scalar_type",
+                                 {CallExpr{"real_type_t<scalar_type>", {MI * CallExpr{"cos", {theta}}}},
+                                  CallExpr{"real_type_t<scalar_type>",
+                                           {MI * CallExpr{"sin", {theta}}}}}}};
+
+    auto src = func.render();
+    write_standalone_test_harness(func, src);
+    return src;
+}
+
 std::string bluestein_multi_rtc(const std::string& kernel_name, const BluesteinMultiSpecs& specs)
 {
     std::string src;
@@ -244,6 +351,12 @@ std::string bluestein_multi_rtc(const std::string& kernel_name, const BluesteinM
         src += bluestein_multi_chirp_rtc(kernel_name, specs);
         return src;
     }
+    if(specs.scheme == CS_KERNEL_RADER_CHIRP)
+    {
+        src += rader_pow_mod_h;
+        src += rader_chirp_rtc(kernel_name, specs);
+        return src;
+    }
 
     // function arguments
     Variable numof{"numof", "const size_t"};
@@ -252,6 +365,7 @@ std::string bluestein_multi_rtc(const std::string& kernel_name, const BluesteinM
     Variable M{"M", "const size_t"};
     Variable input{"input", "scalar_type", true, true};
     Variable output{"output", "scalar_type", true, true};
+    Variable rader_idx{"rader_idx", "const unsigned int", true, true};
     Variable dim{"dim", "const size_t"};
     Variable lengths{"lengths", "const size_t", true, true};
     Variable stride_in{"stride_in", "const size_t", true, true};
@@ -267,6 +381,10 @@ std::string bluestein_multi_rtc(const std::string& kernel_name, const BluesteinM
     func.arguments.append(M);
     func.arguments.append(input);
     func.arguments.append(output);
+    // rader reorders data through the index tables written by its
+    // chirp kernel
+    if(specs.scheme == CS_KERNEL_RADER_GATHER || specs.scheme == CS_KERNEL_RADER_SCATTER)
+        func.arguments.append(rader_idx);
     func.arguments.append(dim);
     func.arguments.append(lengths);
     func.arguments.append(stride_in);
@@ -379,6 +497,55 @@ std::string bluestein_multi_rtc(const std::string& kernel_name, const BluesteinM
         func.body += StoreGlobal{output, oIdx, out_elem};
         break;
     }
+    case CS_KERNEL_RADER_GATHER:
+    {
+        func.body += CommentLines{"GATHER is the first non-setup step of rader and",
+                                  "should never be the last kernel to write global memory.",
+                                  "So we should never need to run a \"store\" callback."};
+        func.body += CommentLines{"thread q < p-1 reads x[g^q], the last thread keeps x[0]"};
+        func.body += Assign{iIdx, Ternary{tx < N - 1, rader_idx[tx], Literal{0}} * stride_in[0]};
+        func.body += AddAssign(iIdx, iOffset);
+        func.body += AddAssign(oIdx, oOffset);
+        func.body += Assign{output[oIdx], LoadGlobal{input, iIdx}};
+        break;
+    }
+    case CS_KERNEL_RADER_MUL:
+    {
+        func.body += CommentLines{"MUL is in the middle of rader and should never be",
+                                  "the first/last kernel to read/write global memory.  So we",
+                                  "don't need to run callbacks."};
+        func.body += AddAssign(output, oOffset);
+        func.body += Declaration{out_elem, output[oIdx]};
+        func.body += Assign{output[oIdx].x(),
+                            input[iIdx].x() * out_elem.x() - input[iIdx].y() * out_elem.y()};
+        func.body += Assign{output[oIdx].y(),
+                            input[iIdx].x() * out_elem.y() + input[iIdx].y() * out_elem.x()};
+        func.body += CommentLines{"the DC term is needed for X[0], and x[0] contributes",
+                                  "equally to every other output"};
+        func.body += If{tx == 0,
+                        {Assign{output[N], out_elem},
+                         AddAssign(output[oIdx].x(), output[N - 1].x()),
+                         AddAssign(output[oIdx].y(), output[N - 1].y())}};
+        break;
+    }
+    case CS_KERNEL_RADER_SCATTER:
+    {
+        func.body += CommentLines{"SCATTER is the last step of rader and",
+                                  "should never be the first kernel to read global memory.",
+                                  "So we should never need to run a \"load\" callback."};
+        func.body += AddAssign(iIdx, iOffset);
+        func.body += Declaration{out_elem};
+        func.body += CommentLines{"thread m < p-1 writes X[g^-m], the last thread X[0]"};
+        func.body += If{tx < N - 1,
+                        {Assign{out_elem, input[iIdx]},
+                         Assign{oIdx, rader_idx[N - 1 + tx] * stride_out[0]}}};
+        func.body += Else{{Assign{out_elem.x(), input[iIdx].x() + input[iIdx + 1].x()},
+                           Assign{out_elem.y(), input[iIdx].y() + input[iIdx + 1].y()},
+                           Assign{oIdx, 0}}};
+        func.body += AddAssign(oIdx, oOffset);
+        func.body += StoreGlobal{output, oIdx, out_elem};
+        break;
+    }
     default:
         throw std::runtime_error("invalid bluestein rtc scheme");
     }
@@ -26,6 +26,7 @@
 #include "kernel_launch.h"
 #include "rtc_bluestein_gen.h"
 #include "tree_node.h"
+#include "tree_node_bluestein.h"
 
 RTCKernel::RTCGenerator RTCKernelBluesteinSingle::generate_from_node(const TreeNode&    node,
                                                                      const std::string& gpu_arch,
@@ -75,7 +76,7 @@ RTCKernel::RTCGenerator RTCKernelBluesteinSingle::generate_from_node(const TreeN
         = [=](const std::string& kernel_name) { return bluestein_single_rtc(kernel_name, specs); };
 
     generator.construct_rtckernel = [=](const std::string&       kernel_name,
-                                        const std::vector<char>& code,
+                                        const RTCLoadableModule& code,
                                         dim3                     gridDim,
                                         dim3                     blockDim) {
         return std::unique_ptr<RTCKernel>(
@@ -96,7 +97,7 @@ RTCKernelArgs RTCKernelBluesteinSingle::get_launch_args(DeviceCallIn& data)
     {
         kargs.append_ptr(kargs_stride_out(data.node->devKernArg));
     }
-    kargs.append_size_t(data.node->batch);
+    kargs.append_size_t(data.get_batch());
     kargs.append_unsigned_int(0);
     kargs.append_ptr(data.bufIn[0]);
     if(array_type_is_planar(data.node->inArrayType))
@@ -128,13 +129,20 @@ RTCKernel::RTCGenerator RTCKernelBluesteinMulti::generate_from_node(const TreeNo
 
     auto scheme = node.scheme;
 
+    bool isRader = scheme == CS_KERNEL_RADER_CHIRP || scheme == CS_KERNEL_RADER_GATHER
+                   || scheme == CS_KERNEL_RADER_MUL || scheme == CS_KERNEL_RADER_SCATTER;
+
     if(scheme != CS_KERNEL_CHIRP && node.scheme != CS_KERNEL_PAD_MUL
-       && node.scheme != CS_KERNEL_FFT_MUL && node.scheme != CS_KERNEL_RES_MUL)
+       && node.scheme != CS_KERNEL_FFT_MUL && node.scheme != CS_KERNEL_RES_MUL && !isRader)
         return generator;
 
+    // for rader, N is the prime and M the per-transform slot size
     size_t N = node.length[0];
     size_t M = node.lengthBlue;
 
+    // rader's generator is found once at plan time
+    size_t root = isRader ? RaderNode::PrimitiveRoot(N) : 0;
+
     size_t numof = 0;
     if(scheme == CS_KERNEL_FFT_MUL)
     {
@@ -144,6 +152,10 @@ RTCKernel::RTCGenerator RTCKernelBluesteinMulti::generate_from_node(const TreeNo
     {
         numof = M;
     }
+    else if(scheme == CS_KERNEL_RADER_CHIRP || scheme == CS_KERNEL_RADER_MUL)
+    {
+        numof = N - 1;
+    }
     else
     {
         // CS_KERNEL_RES_MUL
@@ -155,6 +167,9 @@ RTCKernel::RTCGenerator RTCKernelBluesteinMulti::generate_from_node(const TreeNo
         count *= node.length[i];
     count *= numof;
 
+    if(scheme == CS_KERNEL_RADER_CHIRP)
+        count = numof;
+
     if(scheme == CS_KERNEL_CHIRP)
     {
         generator.gridDim
@@ -182,11 +197,11 @@ RTCKernel::RTCGenerator RTCKernelBluesteinMulti::generate_from_node(const TreeNo
         = [=](const std::string& kernel_name) { return bluestein_multi_rtc(kernel_name, specs); };
 
     generator.construct_rtckernel = [=](const std::string&       kernel_name,
-                                        const std::vector<char>& code,
+                                        const RTCLoadableModule& code,
                                         dim3                     gridDim,
                                         dim3                     blockDim) {
         return std::unique_ptr<RTCKernel>(new RTCKernelBluesteinMulti(
-            kernel_name, scheme, N, M, numof, count, code, gridDim, blockDim));
+            kernel_name, scheme, N, M, numof, count, root, code, gridDim, blockDim));
     };
 
     return generator;
@@ -219,6 +234,18 @@ RTCKernelArgs RTCKernelBluesteinMulti::get_launch_args(DeviceCallIn& data)
         kargs.append_int(twl);
         kargs.append_int(data.node->direction);
     }
+    else if(scheme == CS_KERNEL_RADER_CHIRP)
+    {
+        // g^-1 = g^(p-2), since g^(p-1) = 1
+        size_t rootInv = RaderNode::PowMod(root, N - 2, N);
+
+        kargs.append_size_t(N);
+        kargs.append_size_t(M);
+        kargs.append_ptr(data.bufOut[0]);
+        kargs.append_size_t(root);
+        kargs.append_size_t(rootInv);
+        kargs.append_int(data.node->direction);
+    }
     else
     {
         const size_t cBytes = complex_type_size(data.node->precision);
@@ -238,8 +265,27 @@ RTCKernelArgs RTCKernelBluesteinMulti::get_launch_args(DeviceCallIn& data)
             bufOut0 = static_cast<char*>(bufOut0) + M * cBytes;
         }
 
+        // rader data follows the index tables and the kernel
+        void* raderIdx = nullptr;
+        if(scheme == CS_KERNEL_RADER_GATHER)
+        {
+            raderIdx = bufOut0;
+            bufOut0  = static_cast<char*>(bufOut0) + 3 * M * cBytes;
+        }
+        else if(scheme == CS_KERNEL_RADER_MUL)
+        {
+            bufIn0  = static_cast<char*>(bufIn0) + 2 * M * cBytes;
+            bufOut0 = static_cast<char*>(bufOut0) + 3 * M * cBytes;
+        }
+        else if(scheme == CS_KERNEL_RADER_SCATTER)
+        {
+            raderIdx = bufIn0;
+            bufIn0   = static_cast<char*>(bufIn0) + 3 * M * cBytes;
+        }
+
+        // count covers every transform the node was planned for
         kargs.append_size_t(numof);
-        kargs.append_size_t(count);
+        kargs.append_size_t(count / data.node->batch * data.get_batch());
         kargs.append_size_t(N);
         kargs.append_size_t(M);
         kargs.append_ptr(bufIn0);
@@ -248,6 +294,8 @@ RTCKernelArgs RTCKernelBluesteinMulti::get_launch_args(DeviceCallIn& data)
         kargs.append_ptr(bufOut0);
         if(array_type_is_planar(data.node->outArrayType))
             kargs.append_ptr(bufOut1);
+        if(scheme == CS_KERNEL_RADER_GATHER || scheme == CS_KERNEL_RADER_SCATTER)
+            kargs.append_ptr(raderIdx);
         kargs.append_size_t(data.node->length.size());
         kargs.append_ptr(kargs_lengths(data.node->devKernArg));
         kargs.append_ptr(kargs_stride_in(data.node->devKernArg));
@@ -22,22 +22,34 @@
 
 #include "library_path.h"
 #include "logging.h"
+#include "plan_create_times.h"
 #include "rtc_cache.h"
 #include "rtc_compile.h"
 #include "rtc_subprocess.h"
 #include "sqlite3.h"
 
 #include <chrono>
+#include <cstring>
+#include <ctime>
+#include <deque>
 #include <hip/hip_version.h>
 #include <hip/hiprtc.h>
+#include <map>
 #include <mutex>
 #include <optional>
+#include <thread>
+
+#ifdef ROCFFT_RTC_CACHE_ZSTD
+#include <zstd.h>
+#endif
 
 namespace fs = std::filesystem;
 
 std::unique_ptr<RTCCache> RTCCache::single;
+RTCCacheStats             RTCCache::stats;
 
-static const char* default_cache_filename = "rocfft_kernel_cache.db";
+static const char* default_cache_filename   = "rocfft_kernel_cache.db";
+static const char* default_archive_filename = "rocfft_kernel_cache.rka";
 
 // Lock for in-process compilation - due to limits in ROCclr, we
 // can do at most one compilation in a process before we have to
@@ -45,6 +57,76 @@ static const char* default_cache_filename = "rocfft_kernel_cache.db";
 // in-process instead of making everything go to subprocess.
 static std::mutex compile_lock;
 
+// Code objects may be stored zstd-compressed.  Compressed blobs are
+// recognized by the zstd frame magic number, which neither ELF code
+// objects nor offload bundles start with.
+static const char zstd_magic[] = {'\x28', '\xb5', '\x2f', '\xfd'};
+
+static bool is_compressed(const char* data, size_t len)
+{
+    return len >= sizeof(zstd_magic) && memcmp(data, zstd_magic, sizeof(zstd_magic)) == 0;
+}
+
+// get a zstd compression level from an environment variable, or 0
+// if compression is disabled or unsupported
+static int compress_level_from_env(const char* var)
+{
+#ifdef ROCFFT_RTC_CACHE_ZSTD
+    auto level = rocfft_getenv(var);
+    if(!level.empty())
+    {
+        try
+        {
+            return std::stoi(level);
+        }
+        catch(std::exception&)
+        {
+        }
+    }
+#endif
+    return 0;
+}
+
+static std::vector<char> compress_code(const char* data, size_t len, int level)
+{
+#ifdef ROCFFT_RTC_CACHE_ZSTD
+    if(level > 0 && !is_compressed(data, len))
+    {
+        std::vector<char> out(ZSTD_compressBound(len));
+        auto              out_len = ZSTD_compress(out.data(), out.size(), data, len, level);
+        if(!ZSTD_isError(out_len))
+        {
+            out.resize(out_len);
+            return out;
+        }
+    }
+#endif
+    return std::vector<char>(data, data + len);
+}
+
+// returns an empty vector if the code is compressed but can't be
+// decompressed, so it's treated as a cache miss
+static std::vector<char> decompress_code(const char* data, size_t len)
+{
+    if(!is_compressed(data, len))
+        return std::vector<char>(data, data + len);
+#ifdef ROCFFT_RTC_CACHE_ZSTD
+    auto out_len = ZSTD_getFrameContentSize(data, len);
+    if(out_len != ZSTD_CONTENTSIZE_ERROR && out_len != ZSTD_CONTENTSIZE_UNKNOWN)
+    {
+        std::vector<char> out(out_len);
+        if(!ZSTD_isError(ZSTD_decompress(out.data(), out.size(), data, len)))
+            return out;
+    }
+#endif
+    return {};
+}
+
+static std::string gpu_arch_strip_flags(const std::string gpu_arch_with_flags)
+{
+    return gpu_arch_with_flags.substr(0, gpu_arch_with_flags.find(':'));
+}
+
 // Get paths to system RTC cache, in decreasing order of preference.
 static std::vector<fs::path> rtccache_db_sys_paths()
 {
@@ -61,15 +143,26 @@ static std::vector<fs::path> rtccache_db_sys_paths()
         auto lib_path = get_library_path();
         if(!lib_path.empty())
         {
-            // try next to the library, and in rocfft subdir
+            // try next to the library, and in rocfft subdir.  prefer
+            // an archive over a database in the same location.
             fs::path library_parent_path = lib_path.parent_path();
-            paths.push_back(library_parent_path / default_cache_filename);
-            paths.push_back(library_parent_path / "rocfft" / default_cache_filename);
+            for(const auto& dir : {library_parent_path, library_parent_path / "rocfft"})
+            {
+                paths.push_back(dir / default_archive_filename);
+                paths.push_back(dir / default_cache_filename);
+            }
         }
     }
     return paths;
 }
 
+// check if a cache path refers to a file, rather than an in-memory
+// database that only one connection can see
+static bool is_file_db(const fs::path& path)
+{
+    return !path.empty() && path != ":memory:";
+}
+
 // Get list of candidate paths to RTC user cache DB, in decreasing
 // order of preference.
 static std::vector<fs::path> rtccache_db_user_paths()
@@ -94,6 +187,14 @@ static sqlite3_stmt_ptr prepare_stmt(sqlite3_ptr& db, const char* sql)
     throw std::runtime_error(std::string("sqlite_prepare_v2 failed: ") + sqlite3_errmsg(db.get()));
 }
 
+static const char* get_stmt_text = "SELECT code, timestamp "
+                                   "FROM cache_v1 "
+                                   "WHERE"
+                                   "  kernel_name = :kernel_name "
+                                   "  AND arch = :arch "
+                                   "  AND hip_version = :hip_version "
+                                   "  AND generator_sum = :generator_sum ";
+
 sqlite3_ptr RTCCache::connect_db(const fs::path& path, bool readonly)
 {
     sqlite3* db_raw = nullptr;
@@ -144,9 +245,27 @@ RTCCache::RTCCache()
     auto sys_paths = rtccache_db_sys_paths();
     for(const auto& p : sys_paths)
     {
+        // system cache may be an archive instead of a database
+        if(RTCArchive::is_archive(p))
+        {
+            try
+            {
+                archive_sys = std::make_unique<RTCArchive>(p);
+                break;
+            }
+            catch(std::exception&)
+            {
+                // unusable archive, try the next location
+                continue;
+            }
+        }
         db_sys = connect_db(p, true);
         if(db_sys)
+        {
+            if(is_file_db(p))
+                read_pool_sys.path = p;
             break;
+        }
     }
 
     auto paths = rtccache_db_user_paths();
@@ -154,17 +273,13 @@ RTCCache::RTCCache()
     {
         db_user = connect_db(p, false);
         if(db_user)
+        {
+            if(is_file_db(p))
+                read_pool_user.path = p;
             break;
+        }
     }
 
-    static const char* get_stmt_text = "SELECT code "
-                                       "FROM cache_v1 "
-                                       "WHERE"
-                                       "  kernel_name = :kernel_name "
-                                       "  AND arch = :arch "
-                                       "  AND hip_version = :hip_version "
-                                       "  AND generator_sum = :generator_sum ";
-
     static const char* store_stmt_text = "INSERT OR REPLACE INTO cache_v1 ("
                                          "    kernel_name,"
                                          "    arch,"
@@ -195,31 +310,148 @@ RTCCache::RTCCache()
         catch(std::exception&)
         {
             db_sys.reset();
+            read_pool_sys.path.clear();
         }
     }
     if(db_user)
     {
         get_stmt_user   = prepare_stmt(db_user, get_stmt_text);
         store_stmt_user = prepare_stmt(db_user, store_stmt_text);
+        touch_stmt_user = prepare_stmt(db_user,
+                                       "UPDATE cache_v1 "
+                                       "SET timestamp = CAST(STRFTIME('%s','now') AS INTEGER) "
+                                       "WHERE"
+                                       "  kernel_name = :kernel_name "
+                                       "  AND arch = :arch "
+                                       "  AND hip_version = :hip_version "
+                                       "  AND generator_sum = :generator_sum ");
+    }
+
+    // other processes can only see our pending compiles if the user
+    // cache is a file
+    if(db_user && !read_pool_user.path.empty())
+    {
+        try
+        {
+            auto create = prepare_stmt(db_user,
+                                       "CREATE TABLE IF NOT EXISTS pending_v1 ("
+                                       "  kernel_name TEXT NOT NULL,"
+                                       "  arch TEXT NOT NULL,"
+                                       "  hip_version INTEGER NOT NULL,"
+                                       "  generator_sum BLOB NOT NULL,"
+                                       "  timestamp INTEGER NOT NULL,"
+                                       "  PRIMARY KEY ("
+                                       "      kernel_name, arch, hip_version, generator_sum"
+                                       "      ))");
+            if(sqlite3_step(create.get()) != SQLITE_DONE)
+                throw std::runtime_error("failed to create pending_v1");
+
+            claim_stmt_user = prepare_stmt(db_user,
+                                           "INSERT OR IGNORE INTO pending_v1 ("
+                                           "    kernel_name,"
+                                           "    arch,"
+                                           "    hip_version,"
+                                           "    generator_sum,"
+                                           "    timestamp"
+                                           ")"
+                                           "VALUES ("
+                                           "    :kernel_name,"
+                                           "    :arch,"
+                                           "    :hip_version,"
+                                           "    :generator_sum,"
+                                           "    CAST(STRFTIME('%s','now') AS INTEGER)"
+                                           ")");
+            release_stmt_user = prepare_stmt(db_user,
+                                             "DELETE FROM pending_v1 "
+                                             "WHERE"
+                                             "  kernel_name = :kernel_name "
+                                             "  AND arch = :arch "
+                                             "  AND hip_version = :hip_version "
+                                             "  AND generator_sum = :generator_sum ");
+            // claims older than the timeout are assumed to belong to a
+            // process that died before finishing its compile
+            expire_stmt_user = prepare_stmt(db_user,
+                                            "DELETE FROM pending_v1 "
+                                            "WHERE"
+                                            "  kernel_name = :kernel_name "
+                                            "  AND arch = :arch "
+                                            "  AND hip_version = :hip_version "
+                                            "  AND generator_sum = :generator_sum "
+                                            "  AND timestamp"
+                                            "      < CAST(STRFTIME('%s','now') AS INTEGER)"
+                                            "        - :timeout");
+        }
+        catch(std::exception&)
+        {
+            // coordination is an optimization - just compile
+            // independently if it's not available
+            claim_stmt_user.reset();
+            release_stmt_user.reset();
+            expire_stmt_user.reset();
+        }
+    }
+
+    // trim the user cache file to a size limit, if one is set
+    auto env_max_size = rocfft_getenv("ROCFFT_RTC_CACHE_MAX_SIZE");
+    if(db_user && !read_pool_user.path.empty() && !env_max_size.empty()
+       && rocfft_getenv("ROCFFT_RTC_CACHE_WRITE_DISABLE").empty())
+    {
+        try
+        {
+            cleanup_cache(std::stoll(env_max_size));
+        }
+        catch(std::exception&)
+        {
+            // an untrimmed cache is still usable
+        }
     }
 }
 
-static std::vector<char> get_code_object_impl(const std::string&          kernel_name,
-                                              const std::string&          gpu_arch,
-                                              const std::array<char, 32>& generator_sum,
-                                              sqlite3_ptr&                db,
-                                              sqlite3_stmt_ptr&           get_stmt,
-                                              std::mutex&                 get_mutex)
+std::unique_ptr<RTCCache::read_connection> RTCCache::read_pool::acquire()
 {
-    std::vector<char> code;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(!idle.empty())
+        {
+            auto conn = std::move(idle.back());
+            idle.pop_back();
+            return conn;
+        }
+    }
 
-    // allow env variable to disable reads
-    if(!rocfft_getenv("ROCFFT_RTC_CACHE_READ_DISABLE").empty())
-        return code;
+    // open a new connection outside the lock, so other threads can
+    // keep reusing idle ones meanwhile
+    auto conn = std::make_unique<read_connection>();
+    conn->db  = connect_db(path, true);
+    if(!conn->db)
+        return nullptr;
+    try
+    {
+        conn->get_stmt = prepare_stmt(conn->db, get_stmt_text);
+    }
+    catch(std::exception&)
+    {
+        return nullptr;
+    }
+    return conn;
+}
 
-    std::lock_guard<std::mutex> lock(get_mutex);
+void RTCCache::read_pool::release(std::unique_ptr<read_connection> conn)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    idle.push_back(std::move(conn));
+}
+
+// run the get statement, which the caller must have exclusive use of
+static std::vector<char> run_get_stmt(const std::string&          kernel_name,
+                                      const std::string&          gpu_arch,
+                                      const std::array<char, 32>& generator_sum,
+                                      sqlite3*                    db,
+                                      sqlite3_stmt*               s,
+                                      sqlite3_int64&              timestamp)
+{
+    std::vector<char> code;
 
-    auto s = get_stmt.get();
     sqlite3_reset(s);
 
     // bind arguments to the query and execute
@@ -230,35 +462,143 @@ static std::vector<char> get_code_object_impl(const std::string&          kernel
        || sqlite3_bind_blob(s, 4, generator_sum.data(), generator_sum.size(), SQLITE_TRANSIENT)
               != SQLITE_OK)
     {
-        throw std::runtime_error(std::string("get_code_object bind: ") + sqlite3_errmsg(db.get()));
+        throw std::runtime_error(std::string("get_code_object bind: ") + sqlite3_errmsg(db));
     }
     if(sqlite3_step(s) == SQLITE_ROW)
     {
         // cache hit, get the value out
         int         nbytes = sqlite3_column_bytes(s, 0);
         const char* data   = static_cast<const char*>(sqlite3_column_blob(s, 0));
-        std::copy(data, data + nbytes, std::back_inserter(code));
+        code               = decompress_code(data, nbytes);
+        timestamp          = sqlite3_column_int64(s, 1);
     }
     sqlite3_reset(s);
     return code;
 }
 
+std::vector<char> RTCCache::get_code_object_impl(const std::string&          kernel_name,
+                                                 const std::string&          gpu_arch,
+                                                 const std::array<char, 32>& generator_sum,
+                                                 sqlite3_ptr&                db,
+                                                 sqlite3_stmt_ptr&           get_stmt,
+                                                 std::mutex&                 get_mutex,
+                                                 read_pool&                  pool,
+                                                 sqlite3_int64&              timestamp)
+{
+    // allow env variable to disable reads
+    if(!rocfft_getenv("ROCFFT_RTC_CACHE_READ_DISABLE").empty())
+        return {};
+
+    // prefer a connection of our own, so concurrent lookups don't
+    // wait for each other
+    if(!pool.path.empty())
+    {
+        auto conn = pool.acquire();
+        if(conn)
+        {
+            auto code = run_get_stmt(kernel_name,
+                                     gpu_arch,
+                                     generator_sum,
+                                     conn->db.get(),
+                                     conn->get_stmt.get(),
+                                     timestamp);
+            pool.release(std::move(conn));
+            return code;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(get_mutex);
+    return run_get_stmt(
+        kernel_name, gpu_arch, generator_sum, db.get(), get_stmt.get(), timestamp);
+}
+
 std::vector<char> RTCCache::get_code_object(const std::string&          kernel_name,
                                             const std::string&          gpu_arch,
-                                            const std::array<char, 32>& generator_sum)
+                                            const std::array<char, 32>& generator_sum,
+                                            const char**                hit_tier)
 {
     std::vector<char> code;
+    sqlite3_int64     timestamp = 0;
     // try user cache first
     if(get_stmt_user)
-        code = get_code_object_impl(
-            kernel_name, gpu_arch, generator_sum, db_user, get_stmt_user, get_mutex_user);
+        code = get_code_object_impl(kernel_name,
+                                    gpu_arch,
+                                    generator_sum,
+                                    db_user,
+                                    get_stmt_user,
+                                    get_mutex_user,
+                                    read_pool_user,
+                                    timestamp);
+    if(!code.empty())
+    {
+        ++stats.user_hits;
+        if(hit_tier)
+            *hit_tier = "user";
+        // the timestamp is only refreshed occasionally, so that hits
+        // don't all have to write to the cache
+        static const sqlite3_int64 touch_interval_seconds = 3600;
+        if(timestamp < static_cast<sqlite3_int64>(time(nullptr)) - touch_interval_seconds)
+            touch_code_object(kernel_name, gpu_arch, generator_sum);
+        return code;
+    }
+
     // fall back to system cache
+    if(archive_sys)
+    {
+        auto archived = get_archived_code_object(kernel_name, gpu_arch, generator_sum);
+        code.assign(archived.first, archived.first + archived.second);
+    }
     if(code.empty() && get_stmt_sys)
-        code = get_code_object_impl(
-            kernel_name, gpu_arch, generator_sum, db_sys, get_stmt_sys, get_mutex_sys);
+        code = get_code_object_impl(kernel_name,
+                                    gpu_arch,
+                                    generator_sum,
+                                    db_sys,
+                                    get_stmt_sys,
+                                    get_mutex_sys,
+                                    read_pool_sys,
+                                    timestamp);
+    if(!code.empty())
+    {
+        ++stats.system_hits;
+        if(hit_tier)
+            *hit_tier = "system";
+    }
     return code;
 }
 
+std::pair<const char*, size_t>
+    RTCCache::get_archived_code_object(const std::string&          kernel_name,
+                                       const std::string&          gpu_arch,
+                                       const std::array<char, 32>& generator_sum)
+{
+    // allow env variable to disable reads
+    if(!archive_sys || !rocfft_getenv("ROCFFT_RTC_CACHE_READ_DISABLE").empty())
+        return {nullptr, 0};
+    return archive_sys->find(kernel_name, gpu_arch_strip_flags(gpu_arch), generator_sum);
+}
+
+void RTCCache::touch_code_object(const std::string&          kernel_name,
+                                 const std::string&          gpu_arch,
+                                 const std::array<char, 32>& generator_sum)
+{
+    if(!touch_stmt_user || !rocfft_getenv("ROCFFT_RTC_CACHE_WRITE_DISABLE").empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(store_mutex_user);
+
+    auto s = touch_stmt_user.get();
+    sqlite3_reset(s);
+    // the cache is still usable if this fails, so ignore errors
+    if(sqlite3_bind_text(s, 1, kernel_name.c_str(), kernel_name.size(), SQLITE_TRANSIENT)
+           == SQLITE_OK
+       && sqlite3_bind_text(s, 2, gpu_arch.c_str(), gpu_arch.size(), SQLITE_TRANSIENT) == SQLITE_OK
+       && sqlite3_bind_int64(s, 3, HIP_VERSION) == SQLITE_OK
+       && sqlite3_bind_blob(s, 4, generator_sum.data(), generator_sum.size(), SQLITE_TRANSIENT)
+              == SQLITE_OK)
+        sqlite3_step(s);
+    sqlite3_reset(s);
+}
+
 void RTCCache::store_code_object(const std::string&          kernel_name,
                                  const std::string&          gpu_arch,
                                  const std::array<char, 32>& generator_sum,
@@ -268,6 +608,10 @@ void RTCCache::store_code_object(const std::string&          kernel_name,
     if(!rocfft_getenv("ROCFFT_RTC_CACHE_WRITE_DISABLE").empty())
         return;
 
+    // compress outside the lock, since it can take a while
+    auto compress_level = compress_level_from_env("ROCFFT_RTC_CACHE_COMPRESS");
+    auto stored         = compress_code(code.data(), code.size(), compress_level);
+
     std::lock_guard<std::mutex> lock(store_mutex_user);
 
     auto s = store_stmt_user.get();
@@ -280,12 +624,14 @@ void RTCCache::store_code_object(const std::string&          kernel_name,
        || sqlite3_bind_int64(s, 3, HIP_VERSION) != SQLITE_OK
        || sqlite3_bind_blob(s, 4, generator_sum.data(), generator_sum.size(), SQLITE_TRANSIENT)
               != SQLITE_OK
-       || sqlite3_bind_blob(s, 5, code.data(), code.size(), SQLITE_TRANSIENT))
+       || sqlite3_bind_blob(s, 5, stored.data(), stored.size(), SQLITE_TRANSIENT))
     {
         throw std::runtime_error(std::string("store_code_object bind: ")
                                  + sqlite3_errmsg(db_user.get()));
     }
-    if(sqlite3_step(s) != SQLITE_DONE)
+    if(sqlite3_step(s) == SQLITE_DONE)
+        stats.bytes_stored += stored.size();
+    else
     {
         std::cerr << "Error: failed to store code object for " << kernel_name << ": "
                   << sqlite3_errmsg(db_user.get()) << std::endl;
@@ -298,6 +644,95 @@ void RTCCache::store_code_object(const std::string&          kernel_name,
     sqlite3_reset(s);
 }
 
+int RTCCache::run_pending_stmt(sqlite3_stmt*               s,
+                               const std::string&          kernel_name,
+                               const std::string&          gpu_arch,
+                               const std::array<char, 32>& generator_sum)
+{
+    sqlite3_reset(s);
+    if(sqlite3_bind_text(s, 1, kernel_name.c_str(), kernel_name.size(), SQLITE_TRANSIENT)
+           != SQLITE_OK
+       || sqlite3_bind_text(s, 2, gpu_arch.c_str(), gpu_arch.size(), SQLITE_TRANSIENT) != SQLITE_OK
+       || sqlite3_bind_int64(s, 3, HIP_VERSION) != SQLITE_OK
+       || sqlite3_bind_blob(s, 4, generator_sum.data(), generator_sum.size(), SQLITE_TRANSIENT)
+              != SQLITE_OK)
+    {
+        throw std::runtime_error(std::string("pending compile bind: ")
+                                 + sqlite3_errmsg(db_user.get()));
+    }
+    int changes = 0;
+    if(sqlite3_step(s) == SQLITE_DONE)
+        changes = sqlite3_changes(db_user.get());
+    sqlite3_reset(s);
+    return changes;
+}
+
+std::vector<char> RTCCache::claim_compile(const std::string&          kernel_name,
+                                          const std::string&          gpu_arch,
+                                          const std::array<char, 32>& generator_sum,
+                                          bool&                       claimed)
+{
+    claimed = false;
+    if(!claim_stmt_user || !rocfft_getenv("ROCFFT_RTC_CACHE_WRITE_DISABLE").empty())
+        return {};
+
+    // seconds after which another process's claim is ignored.  0
+    // disables coordination.
+    sqlite3_int64 timeout  = 60;
+    auto          env_wait = rocfft_getenv("ROCFFT_RTC_CACHE_LOCK_TIMEOUT");
+    if(!env_wait.empty())
+    {
+        try
+        {
+            timeout = std::stoll(env_wait);
+        }
+        catch(std::exception&)
+        {
+        }
+    }
+    if(timeout <= 0)
+        return {};
+
+    auto poll_interval = std::chrono::milliseconds(10);
+    while(true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_user);
+            if(run_pending_stmt(claim_stmt_user.get(), kernel_name, gpu_arch, generator_sum))
+            {
+                claimed = true;
+                return {};
+            }
+        }
+
+        // someone else is compiling it, give them some time
+        std::this_thread::sleep_for(poll_interval);
+        poll_interval = std::min(poll_interval * 2, std::chrono::milliseconds(500));
+
+        auto code = get_code_object(kernel_name, gpu_arch, generator_sum);
+        if(!code.empty())
+            return code;
+
+        // drop the other claim if it's stale, so the next loop can
+        // take it over.  if the other process gave up or failed
+        // without storing a result, its claim is already gone.
+        std::lock_guard<std::mutex> lock(pending_mutex_user);
+        auto                        s = expire_stmt_user.get();
+        sqlite3_reset(s);
+        if(sqlite3_bind_int64(s, 5, timeout) != SQLITE_OK)
+            return {};
+        run_pending_stmt(s, kernel_name, gpu_arch, generator_sum);
+    }
+}
+
+void RTCCache::release_compile(const std::string&          kernel_name,
+                               const std::string&          gpu_arch,
+                               const std::array<char, 32>& generator_sum)
+{
+    std::lock_guard<std::mutex> lock(pending_mutex_user);
+    run_pending_stmt(release_stmt_user.get(), kernel_name, gpu_arch, generator_sum);
+}
+
 rocfft_status RTCCache::serialize(void** buffer, size_t* buffer_len_bytes)
 {
     sqlite3_int64 db_size = 0;
@@ -311,12 +746,54 @@ rocfft_status RTCCache::serialize(void** buffer, size_t* buffer_len_bytes)
     return rocfft_status_failure;
 }
 
+rocfft_status
+    RTCCache::serialize_since(sqlite3_int64 since, void** buffer, size_t* buffer_len_bytes)
+{
+    std::lock_guard<std::mutex> lock(deserialize_mutex);
+
+    // copy the matching kernels into an attached in-memory db, and
+    // serialize that.  the result is an ordinary cache that
+    // deserialize can read.
+    if(sqlite3_exec(db_user.get(), "ATTACH DATABASE ':memory:' AS delta", nullptr, nullptr, nullptr)
+       != SQLITE_OK)
+        return rocfft_status_failure;
+
+    rocfft_status ret = rocfft_status_failure;
+    try
+    {
+        auto copy_stmt = prepare_stmt(db_user,
+                                      "CREATE TABLE delta.cache_v1 AS "
+                                      "SELECT * "
+                                      "FROM cache_v1 "
+                                      "WHERE timestamp >= :since "
+                                      "ORDER BY kernel_name, arch, hip_version");
+        if(sqlite3_bind_int64(copy_stmt.get(), 1, since) == SQLITE_OK
+           && sqlite3_step(copy_stmt.get()) == SQLITE_DONE)
+        {
+            sqlite3_int64 db_size = 0;
+            auto          ptr     = sqlite3_serialize(db_user.get(), "delta", &db_size, 0);
+            if(ptr)
+            {
+                *buffer           = ptr;
+                *buffer_len_bytes = db_size;
+                ret               = rocfft_status_success;
+            }
+        }
+    }
+    catch(std::exception&)
+    {
+    }
+
+    sqlite3_exec(db_user.get(), "DETACH DATABASE delta", nullptr, nullptr, nullptr);
+    return ret;
+}
+
 void RTCCache::serialize_free(void* buffer)
 {
     sqlite3_free(buffer);
 }
 
-rocfft_status RTCCache::deserialize(const void* buffer, size_t buffer_len_bytes)
+rocfft_status RTCCache::deserialize(const void* buffer, size_t buffer_len_bytes, bool merge)
 {
     std::lock_guard<std::mutex> lock(deserialize_mutex);
 
@@ -341,27 +818,26 @@ rocfft_status RTCCache::deserialize(const void* buffer, size_t buffer_len_bytes)
         return rocfft_status_failure;
 
     // now the deserialized db is in memory.  run an additive query to
-    // update the real db with the temp contents.
-    sql_err           = sqlite3_exec(db_user.get(),
-                           "INSERT OR REPLACE INTO cache_v1 ("
-                           "    kernel_name,"
-                           "    arch,"
-                           "    hip_version,"
-                           "    generator_sum,"
-                           "    timestamp,"
-                           "    code"
-                           ")"
-                           "SELECT"
-                           "    kernel_name,"
-                           "    arch,"
-                           "    hip_version,"
-                           "    generator_sum,"
-                           "    timestamp,"
-                           "    code "
-                           "FROM deserialized.cache_v1",
-                           nullptr,
-                           nullptr,
-                           nullptr);
+    // update the real db with the temp contents.  merging keeps rows
+    // we already have, instead of rewriting them.
+    std::string insert_sql = merge ? "INSERT OR IGNORE" : "INSERT OR REPLACE";
+    insert_sql += " INTO cache_v1 ("
+                  "    kernel_name,"
+                  "    arch,"
+                  "    hip_version,"
+                  "    generator_sum,"
+                  "    timestamp,"
+                  "    code"
+                  ")"
+                  "SELECT"
+                  "    kernel_name,"
+                  "    arch,"
+                  "    hip_version,"
+                  "    generator_sum,"
+                  "    timestamp,"
+                  "    code "
+                  "FROM deserialized.cache_v1";
+    sql_err           = sqlite3_exec(db_user.get(), insert_sql.c_str(), nullptr, nullptr, nullptr);
     rocfft_status ret = sql_err == SQLITE_OK ? rocfft_status_success : rocfft_status_failure;
 
     // detach the temp db
@@ -400,21 +876,55 @@ static RTCProcessType get_rtc_process_type()
     return RTCProcessType::DEFAULT;
 }
 
-static std::string gpu_arch_strip_flags(const std::string gpu_arch_with_flags)
+// Kernel names encode everything that affects a kernel's source,
+// and the source does not depend on the GPU arch.  Remember recently
+// generated sources, so that compiling the same kernel for another
+// device or after a code object was evicted does not have to run the
+// generator again.
+static std::string generate_kernel_src(const std::string&      kernel_name,
+                                       const kernel_src_gen_t& generate_src)
 {
-    return gpu_arch_with_flags.substr(0, gpu_arch_with_flags.find(':'));
+    static const size_t                       MAX_ENTRIES = 256;
+    static std::mutex                         mutex;
+    static std::map<std::string, std::string> sources;
+    static std::deque<std::string>            order;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        it = sources.find(kernel_name);
+        if(it != sources.end())
+            return it->second;
+    }
+
+    // generators remember what they generate, so call a copy
+    auto generate = generate_src;
+    auto src      = generate(kernel_name);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if(sources.emplace(kernel_name, src).second)
+    {
+        order.push_back(kernel_name);
+        if(order.size() > MAX_ENTRIES)
+        {
+            sources.erase(order.front());
+            order.pop_front();
+        }
+    }
+    return src;
 }
 
 static std::vector<char> cached_compile_impl(const std::string&          kernel_name,
                                              const std::string&          gpu_arch,
-                                             kernel_src_gen_t            generate_src,
+                                             const kernel_src_gen_t&     generate_src,
                                              const std::array<char, 32>& generator_sum)
 {
     // check cache first
     std::vector<char> code;
+    const char*       hit_tier = nullptr;
+    PlanCreateTimer   lookupTimer(PCP_RTC_CACHE_LOOKUP);
     if(RTCCache::single)
     {
-        code = RTCCache::single->get_code_object(kernel_name, gpu_arch, generator_sum);
+        code = RTCCache::single->get_code_object(kernel_name, gpu_arch, generator_sum, &hit_tier);
     }
 
     if(!code.empty())
@@ -424,8 +934,16 @@ static std::vector<char> cached_compile_impl(const std::string&          kernel_
         {
             if(LOG_RTC_ENABLED())
             {
-                (*LogSingleton::GetInstance().GetRTCOS())
-                    << "// cache hit for " << kernel_name << std::endl;
+                if(LOG_JSON_ENABLED())
+                    log_json_arguments(*LogSingleton::GetInstance().GetRTCOS(),
+                                       "rtc_cache_hit",
+                                       "kernel_name",
+                                       kernel_name,
+                                       "cache_tier",
+                                       hit_tier ? hit_tier : "unknown");
+                else
+                    (*LogSingleton::GetInstance().GetRTCOS())
+                        << "// cache hit for " << kernel_name << std::endl;
             }
             return code;
         }
@@ -442,23 +960,88 @@ static std::vector<char> cached_compile_impl(const std::string&          kernel_
         }
     }
 
+    // other processes sharing the cache file might be compiling the
+    // same kernel - wait for one of them instead of also compiling it
+    bool claimed = false;
+    if(RTCCache::single)
+    {
+        code = RTCCache::single->claim_compile(kernel_name, gpu_arch, generator_sum, claimed);
+        lookupTimer.Stop();
+        if(!code.empty())
+        {
+            if(LOG_RTC_ENABLED())
+            {
+                if(LOG_JSON_ENABLED())
+                    log_json_arguments(*LogSingleton::GetInstance().GetRTCOS(),
+                                       "rtc_cache_hit",
+                                       "kernel_name",
+                                       kernel_name,
+                                       "cache_tier",
+                                       "user",
+                                       "waited",
+                                       true);
+                else
+                    (*LogSingleton::GetInstance().GetRTCOS())
+                        << "// cache hit after waiting for " << kernel_name << std::endl;
+            }
+            return code;
+        }
+    }
+    // release our claim once the result is stored, or if the compile
+    // fails
+    struct ReleaseClaim
+    {
+        bool                        claimed;
+        const std::string&          kernel_name;
+        const std::string&          gpu_arch;
+        const std::array<char, 32>& generator_sum;
+        ~ReleaseClaim()
+        {
+            if(!claimed || !RTCCache::single)
+                return;
+            try
+            {
+                RTCCache::single->release_compile(kernel_name, gpu_arch, generator_sum);
+            }
+            catch(std::exception&)
+            {
+                // other processes will expire the claim eventually
+            }
+        }
+    } release_claim{claimed, kernel_name, gpu_arch, generator_sum};
+
     // callbacks are always potentially enabled, and activated by
     // checking the enable_callbacks variable later
-    std::string kernel_src{"#define ROCFFT_CALLBACKS_ENABLED\n"};
+    std::string kernel_src{RTC_KERNEL_SRC_PREAMBLE};
+
+    lookupTimer.Stop();
 
     auto generate_begin = std::chrono::steady_clock::now();
-    kernel_src += generate_src(kernel_name);
+    {
+        PlanCreateTimer generateTimer(PCP_KERNEL_GENERATION);
+        kernel_src += generate_kernel_src(kernel_name, generate_src);
+    }
     auto generate_end = std::chrono::steady_clock::now();
 
     if(LOG_RTC_ENABLED())
     {
         std::chrono::duration<float, std::milli> generate_ms = generate_end - generate_begin;
 
-        (*LogSingleton::GetInstance().GetRTCOS())
-            << "// ROCFFT_RTC_BEGIN " << kernel_name << "\n"
-            << kernel_src << "\n// ROCFFT_RTC_END " << kernel_name << "\n// " << kernel_name
-            << " generate duration: " << static_cast<int>(generate_ms.count()) << " ms"
-            << std::endl;
+        // JSON records leave out the source, so that each record stays
+        // a single line
+        if(LOG_JSON_ENABLED())
+            log_json_arguments(*LogSingleton::GetInstance().GetRTCOS(),
+                               "rtc_generate",
+                               "kernel_name",
+                               kernel_name,
+                               "generate_ms",
+                               generate_ms.count());
+        else
+            (*LogSingleton::GetInstance().GetRTCOS())
+                << "// ROCFFT_RTC_BEGIN " << kernel_name << "\n"
+                << kernel_src << "\n// ROCFFT_RTC_END " << kernel_name << "\n// " << kernel_name
+                << " generate duration: " << static_cast<int>(generate_ms.count()) << " ms"
+                << std::endl;
     }
 
     // try to set compile_begin time right when we're really
@@ -521,14 +1104,34 @@ static std::vector<char> cached_compile_impl(const std::string&          kernel_
     }
     auto compile_end = std::chrono::steady_clock::now();
 
+    if(auto& times = PlanCreateTimes::Current())
+        times->phase_ns[PCP_RTC_COMPILE]
+            += std::chrono::duration_cast<std::chrono::nanoseconds>(compile_end - compile_begin)
+                   .count();
+
+    ++RTCCache::stats.misses;
+    RTCCache::stats.compile_ns
+        += std::chrono::duration_cast<std::chrono::nanoseconds>(compile_end - compile_begin)
+               .count();
+
     if(LOG_RTC_ENABLED())
     {
         std::chrono::duration<float, std::milli> compile_ms = compile_end - compile_begin;
 
-        (*LogSingleton::GetInstance().GetRTCOS())
-            << "// " << kernel_name << " compile duration: " << static_cast<int>(compile_ms.count())
-            << " ms\n"
-            << std::endl;
+        if(LOG_JSON_ENABLED())
+            log_json_arguments(*LogSingleton::GetInstance().GetRTCOS(),
+                               "rtc_compile",
+                               "kernel_name",
+                               kernel_name,
+                               "gpu_arch",
+                               gpu_arch,
+                               "compile_ms",
+                               compile_ms.count());
+        else
+            (*LogSingleton::GetInstance().GetRTCOS())
+                << "// " << kernel_name
+                << " compile duration: " << static_cast<int>(compile_ms.count()) << " ms\n"
+                << std::endl;
     }
 
     if(RTCCache::single)
@@ -559,7 +1162,7 @@ struct PendingCompileCleanup
 
 std::vector<char> RTCCache::cached_compile(const std::string&          kernel_name,
                                            const std::string&          gpu_arch_with_flags,
-                                           kernel_src_gen_t            generate_src,
+                                           const kernel_src_gen_t&     generate_src,
                                            const std::array<char, 32>& generator_sum)
 {
     // Supplied gpu arch may have extra flags on it
@@ -579,31 +1182,41 @@ std::vector<char> RTCCache::cached_compile(const std::string&          kernel_na
     if(RTCCache::single)
     {
         // check the map of pending work for this compile
-        std::lock_guard<std::mutex> lock(RTCCache::single->pending_compiles_mutex);
-        auto                        pc = RTCCache::single->pending_compiles.find(key);
-        if(pc == RTCCache::single->pending_compiles.end())
+        std::promise<std::vector<char>> work;
+        bool                            do_work = false;
+        {
+            std::lock_guard<std::mutex> lock(RTCCache::single->pending_compiles_mutex);
+            auto                        pc = RTCCache::single->pending_compiles.find(key);
+            if(pc == RTCCache::single->pending_compiles.end())
+            {
+                // not in the pending map, so add a future that this
+                // thread will fulfill.  callers are already running
+                // on a bounded number of compile threads, so the work
+                // is done here instead of on yet another thread.
+                pc = RTCCache::single->pending_compiles.emplace(key, work.get_future().share())
+                         .first;
+                cleanup.emplace(key);
+                do_work = true;
+            }
+            result = pc->second;
+        }
+        if(do_work)
         {
-            // not in the pending map, so add a future and launch the
-            // work to look up the kernel in the cache or compile it.
-            pc = RTCCache::single->pending_compiles
-                     .emplace(key,
-                              std::async(std::launch::async,
-                                         cached_compile_impl,
-                                         kernel_name,
-                                         gpu_arch,
-                                         generate_src,
-                                         generator_sum))
-                     .first;
-            cleanup.emplace(key);
+            try
+            {
+                work.set_value(
+                    cached_compile_impl(kernel_name, gpu_arch, generate_src, generator_sum));
+            }
+            catch(...)
+            {
+                work.set_exception(std::current_exception());
+            }
         }
-        result = pc->second;
     }
     else
     {
         // no cache?  just directly compile
-        std::promise<std::vector<char>> p;
-        p.set_value(cached_compile_impl(kernel_name, gpu_arch, generate_src, generator_sum));
-        result = p.get_future();
+        return cached_compile_impl(kernel_name, gpu_arch, generate_src, generator_sum);
     }
     return result.get();
 }
@@ -622,6 +1235,34 @@ void RTCCache::enable_write_mostly()
     sqlite3_step(wal_stmt.get());
 }
 
+void RTCCache::set_aot_archs(const std::vector<std::string>& gpu_archs)
+{
+    // copy only the required arches, in case more are present in the
+    // cache than we need
+    auto create_temp_stmt = prepare_stmt(db_user,
+                                         "CREATE TABLE IF NOT EXISTS temp.aot_arch ("
+                                         "  arch TEXT NOT NULL )");
+    if(sqlite3_step(create_temp_stmt.get()) != SQLITE_DONE)
+        throw std::runtime_error(std::string("write_aot_cache create temp table: ")
+                                 + sqlite3_errmsg(db_user.get()));
+
+    auto insert_temp_stmt = prepare_stmt(db_user, "INSERT INTO temp.aot_arch VALUES ( ? )");
+    for(const auto& gpu_arch_with_flags : gpu_archs)
+    {
+        std::string gpu_arch = gpu_arch_strip_flags(gpu_arch_with_flags);
+
+        if(sqlite3_bind_text(
+               insert_temp_stmt.get(), 1, gpu_arch.c_str(), gpu_arch.size(), SQLITE_TRANSIENT)
+           != SQLITE_OK)
+            throw std::runtime_error(std::string("write_aot_cache temp bind: ")
+                                     + sqlite3_errmsg(db_user.get()));
+        if(sqlite3_step(insert_temp_stmt.get()) != SQLITE_DONE)
+            throw std::runtime_error(std::string("write_aot_cache temp step: ")
+                                     + sqlite3_errmsg(db_user.get()));
+        sqlite3_reset(insert_temp_stmt.get());
+    }
+}
+
 void RTCCache::write_aot_cache(const std::string&              output_path,
                                const std::array<char, 32>&     generator_sum,
                                const std::vector<std::string>& gpu_archs)
@@ -648,31 +1289,27 @@ void RTCCache::write_aot_cache(const std::string&              output_path,
                                  + sqlite3_errmsg(db_user.get()));
     sqlite3_reset(attach_stmt.get());
 
-    // copy only the required arches, in case more are present in the
-    // cache than we need
-    auto create_temp_stmt = prepare_stmt(db_user,
-                                         "CREATE TABLE IF NOT EXISTS temp.aot_arch ("
-                                         "  arch TEXT NOT NULL )");
-    if(sqlite3_step(create_temp_stmt.get()) != SQLITE_DONE)
-        throw std::runtime_error(std::string("write_aot_cache create temp table: ")
+    set_aot_archs(gpu_archs);
+
+    // kernels can be compressed on the way into the output file
+    static const int aot_compress_level = compress_level_from_env("ROCFFT_RTC_CACHE_AOT_COMPRESS");
+    auto             compress_fn = [](sqlite3_context* ctx, int, sqlite3_value** args) {
+        auto data = static_cast<const char*>(sqlite3_value_blob(args[0]));
+        auto out  = compress_code(data, sqlite3_value_bytes(args[0]), aot_compress_level);
+        sqlite3_result_blob(ctx, out.data(), out.size(), SQLITE_TRANSIENT);
+    };
+    if(sqlite3_create_function(db_user.get(),
+                               "rocfft_compress",
+                               1,
+                               SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+                               nullptr,
+                               compress_fn,
+                               nullptr,
+                               nullptr)
+       != SQLITE_OK)
+        throw std::runtime_error(std::string("write_aot_cache create function: ")
                                  + sqlite3_errmsg(db_user.get()));
 
-    auto insert_temp_stmt = prepare_stmt(db_user, "INSERT INTO temp.aot_arch VALUES ( ? )");
-    for(const auto& gpu_arch_with_flags : gpu_archs)
-    {
-        std::string gpu_arch = gpu_arch_strip_flags(gpu_arch_with_flags);
-
-        if(sqlite3_bind_text(
-               insert_temp_stmt.get(), 1, gpu_arch.c_str(), gpu_arch.size(), SQLITE_TRANSIENT)
-           != SQLITE_OK)
-            throw std::runtime_error(std::string("write_aot_cache temp bind: ")
-                                     + sqlite3_errmsg(db_user.get()));
-        if(sqlite3_step(insert_temp_stmt.get()) != SQLITE_DONE)
-            throw std::runtime_error(std::string("write_aot_cache temp step: ")
-                                     + sqlite3_errmsg(db_user.get()));
-        sqlite3_reset(insert_temp_stmt.get());
-    }
-
     // copy the kernels over in a consistent order and zero out the timestamps
     auto copy_stmt = prepare_stmt(db_user,
                                   "INSERT INTO out_db.cache_v1 ("
@@ -683,7 +1320,8 @@ void RTCCache::write_aot_cache(const std::string&              output_path,
                                   "    code,"
                                   "    timestamp"
                                   ")"
-                                  "SELECT kernel_name, arch, hip_version, generator_sum, code, 0 "
+                                  "SELECT kernel_name, arch, hip_version, generator_sum, "
+                                  "    rocfft_compress(code), 0 "
                                   "FROM cache_v1 "
                                   "WHERE "
                                   "  generator_sum = :generator_sum "
@@ -705,6 +1343,53 @@ void RTCCache::write_aot_cache(const std::string&              output_path,
     sqlite3_reset(copy_stmt.get());
 }
 
+void RTCCache::write_aot_archive(const std::string&              output_path,
+                                 const std::array<char, 32>&     generator_sum,
+                                 const std::vector<std::string>& gpu_archs)
+{
+    set_aot_archs(gpu_archs);
+
+    auto select_stmt = prepare_stmt(db_user,
+                                    "SELECT kernel_name, arch, code "
+                                    "FROM cache_v1 "
+                                    "WHERE "
+                                    "  generator_sum = :generator_sum "
+                                    "  AND hip_version = :hip_version "
+                                    "  AND arch IN ("
+                                    "    SELECT arch FROM temp.aot_arch "
+                                    "  )");
+    if(sqlite3_bind_blob(
+           select_stmt.get(), 1, generator_sum.data(), generator_sum.size(), SQLITE_TRANSIENT)
+           != SQLITE_OK
+       || sqlite3_bind_int64(select_stmt.get(), 2, HIP_VERSION) != SQLITE_OK)
+        throw std::runtime_error(std::string("write_aot_archive select bind: ")
+                                 + sqlite3_errmsg(db_user.get()));
+
+    std::vector<RTCArchive::record> records;
+    int                             rc;
+    while((rc = sqlite3_step(select_stmt.get())) == SQLITE_ROW)
+    {
+        RTCArchive::record r;
+        r.kernel_name = reinterpret_cast<const char*>(sqlite3_column_text(select_stmt.get(), 0));
+        r.arch        = reinterpret_cast<const char*>(sqlite3_column_text(select_stmt.get(), 1));
+        int         nbytes = sqlite3_column_bytes(select_stmt.get(), 2);
+        const char* data   = static_cast<const char*>(sqlite3_column_blob(select_stmt.get(), 2));
+        // archived code is loaded directly from the mapping, so it
+        // can't stay compressed
+        r.code = decompress_code(data, nbytes);
+        if(r.code.empty())
+            throw std::runtime_error("write_aot_archive: unable to decompress " + r.kernel_name);
+        records.push_back(std::move(r));
+    }
+    if(rc != SQLITE_DONE)
+        throw std::runtime_error(std::string("write_aot_archive select step: ")
+                                 + sqlite3_errmsg(db_user.get()));
+    sqlite3_reset(select_stmt.get());
+
+    // archive writer sorts the records, so the output is reproducible
+    RTCArchive::write(output_path, generator_sum, records);
+}
+
 void RTCCache::cleanup_cache(sqlite3_int64 target_size_bytes)
 {
     // delete any kernels that are older than the newest
@@ -720,7 +1405,7 @@ void RTCCache::cleanup_cache(sqlite3_int64 target_size_bytes)
                                     "      ( "
                                     "      SELECT "
                                     "        ROWID AS rid, "
-                                    "        kernel_name "
+                                    "        kernel_name, "
                                     "        timestamp, "
                                     "        SUM(LENGTH(code) + LENGTH(kernel_name)) "
                                     "          OVER "
@@ -739,6 +1424,7 @@ void RTCCache::cleanup_cache(sqlite3_int64 target_size_bytes)
     if(sqlite3_step(delete_stmt.get()) != SQLITE_DONE)
         throw std::runtime_error(std::string("cleanup_cache delete step: ")
                                  + sqlite3_errmsg(db_user.get()));
+    stats.evictions += sqlite3_changes(db_user.get());
     delete_stmt.reset();
 
     // check if we can reclaim 20% or more of the file's space by vacuuming
@@ -21,6 +21,7 @@
 #include "rtc_chirp_kernel.h"
 #include "device/kernel-generator-embed.h"
 #include "rtc_cache.h"
+#include "rtc_module_cache.h"
 
 RTCKernelChirp RTCKernelChirp::generate(const std::string& gpu_arch, rocfft_precision precision)
 {
@@ -29,7 +30,11 @@ RTCKernelChirp RTCKernelChirp::generate(const std::string& gpu_arch, rocfft_prec
     kernel_src_gen_t generator{
         [=](const std::string& kernel_name) { return chirp_rtc(kernel_name, precision); }};
 
-    auto code = RTCCache::cached_compile(kernel_name, gpu_arch, generator, generator_sum());
+    // skip the RTC cache if the module is already loaded
+    auto module = RTCModuleCache::GetCache().Find(kernel_name, gpu_arch, generator_sum());
+    if(module)
+        return RTCKernelChirp{kernel_name, module, {}, {}};
 
+    auto code = RTCCache::cached_compile(kernel_name, gpu_arch, generator, generator_sum());
     return RTCKernelChirp{kernel_name, code, {}, {}};
 }
@@ -0,0 +1,85 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "rtc_compile_scheduler.h"
+#include "../../shared/concurrency.h"
+#include "../../shared/environment.h"
+
+#include <algorithm>
+#include <thread>
+
+thread_local bool RTCCompileScheduler::background_thread = false;
+
+RTCCompileScheduler::RTCCompileScheduler()
+{
+    max_workers = rocfft_concurrency();
+
+    auto env_threads = rocfft_getenv("ROCFFT_RTC_COMPILE_THREADS");
+    if(!env_threads.empty())
+    {
+        try
+        {
+            max_workers = std::stoull(env_threads);
+        }
+        catch(std::exception&)
+        {
+        }
+    }
+    max_workers = std::max<size_t>(max_workers, 1);
+}
+
+void RTCCompileScheduler::Enqueue(std::function<void()> task)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    if(background_thread)
+        background_queue.push_back(std::move(task));
+    else
+        queue.push_back(std::move(task));
+
+    // start another worker if there's more queued work than free
+    // workers to pick it up
+    if(queue.size() + background_queue.size() > idle_workers && num_workers < max_workers)
+    {
+        ++num_workers;
+        std::thread(&RTCCompileScheduler::Worker, this).detach();
+    }
+    cv.notify_one();
+}
+
+void RTCCompileScheduler::Worker()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    while(true)
+    {
+        ++idle_workers;
+        cv.wait(lock, [this]() { return !queue.empty() || !background_queue.empty(); });
+        --idle_workers;
+
+        auto& from = queue.empty() ? background_queue : queue;
+        auto  task = std::move(from.front());
+        from.pop_front();
+
+        lock.unlock();
+        // packaged_task stores any exception in its future
+        task();
+        lock.lock();
+    }
+}
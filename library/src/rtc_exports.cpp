@@ -18,7 +18,11 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include "function_pool.h"
 #include "rtc_cache.h"
+#include "rtc_stockham_gen.h"
+
+#include <cstring>
 
 rocfft_status rocfft_cache_serialize(void** buffer, size_t* buffer_len_bytes)
 {
@@ -49,3 +53,100 @@ rocfft_status rocfft_cache_deserialize(const void* buffer, size_t buffer_len_byt
 
     return RTCCache::single->deserialize(buffer, buffer_len_bytes);
 }
+
+rocfft_status rocfft_cache_serialize_since(int64_t since, void** buffer, size_t* buffer_len_bytes)
+{
+    if(!buffer || !buffer_len_bytes)
+        return rocfft_status_invalid_arg_value;
+
+    if(!RTCCache::single)
+        return rocfft_status_failure;
+
+    return RTCCache::single->serialize_since(since, buffer, buffer_len_bytes);
+}
+
+rocfft_status rocfft_cache_deserialize_merge(const void* buffer, size_t buffer_len_bytes)
+{
+    if(!buffer || !buffer_len_bytes)
+        return rocfft_status_invalid_arg_value;
+
+    if(!RTCCache::single)
+        return rocfft_status_failure;
+
+    return RTCCache::single->deserialize(buffer, buffer_len_bytes, true);
+}
+
+rocfft_status rocfft_cache_get_stats(rocfft_cache_stats* stats)
+{
+    if(!stats)
+        return rocfft_status_invalid_arg_value;
+
+    stats->memory_hits      = RTCCache::stats.memory_hits;
+    stats->user_hits        = RTCCache::stats.user_hits;
+    stats->system_hits      = RTCCache::stats.system_hits;
+    stats->misses           = RTCCache::stats.misses;
+    stats->compile_seconds  = RTCCache::stats.compile_ns / 1e9;
+    stats->bytes_stored     = RTCCache::stats.bytes_stored;
+    stats->evictions        = RTCCache::stats.evictions;
+    stats->memory_evictions = RTCCache::stats.memory_evictions;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_device_function_get_source(size_t                length,
+                                                rocfft_precision      precision,
+                                                rocfft_transform_type transform_type,
+                                                char*                 source,
+                                                size_t*               source_size,
+                                                unsigned int*         threads)
+{
+    if(!source_size)
+        return rocfft_status_invalid_arg_value;
+    if(transform_type != rocfft_transform_type_complex_forward
+       && transform_type != rocfft_transform_type_complex_inverse)
+        return rocfft_status_invalid_arg_value;
+
+    // device functions come from the single-kernel 1D transforms in
+    // the function pool
+    FMKey key(length, precision);
+    if(!function_pool::has_function(key))
+        return rocfft_status_invalid_arg_value;
+    auto kernel = function_pool::get_kernel(key);
+
+    std::vector<unsigned int> factors(kernel.factors.begin(), kernel.factors.end());
+
+    StockhamGeneratorSpecs specs(factors,
+                                 {},
+                                 {static_cast<unsigned int>(precision)},
+                                 static_cast<unsigned int>(kernel.workgroup_size),
+                                 "CS_KERNEL_STOCKHAM");
+    specs.threads_per_transform = kernel.threads_per_transform[0];
+
+    const bool        forward = transform_type == rocfft_transform_type_complex_forward;
+    const std::string name    = "rocfft_device_fft_len" + std::to_string(length)
+                             + (forward ? "_fwd" : "_inv") + rtc_precision_name(precision);
+
+    unsigned int function_threads = 0;
+    std::string  src;
+    try
+    {
+        src = stockham_device_function_rtc(
+            specs, name, forward ? -1 : 1, precision, function_threads);
+    }
+    catch(std::exception&)
+    {
+        return rocfft_status_failure;
+    }
+
+    if(threads)
+        *threads = function_threads;
+
+    // size includes the terminating null
+    if(source)
+    {
+        if(*source_size < src.size() + 1)
+            return rocfft_status_invalid_arg_value;
+        std::memcpy(source, src.c_str(), src.size() + 1);
+    }
+    *source_size = src.size() + 1;
+    return rocfft_status_success;
+}
@@ -0,0 +1,182 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "rtc_generic_gen.h"
+#include "device/kernel-generator-embed.h"
+#include "rtc_kernel.h"
+#include "rtc_twiddle_gen.h"
+#include "twiddles.h"
+
+std::string generic_rtc_kernel_name(rocfft_precision precision)
+{
+    std::string kernel_name = "fft_rtc_generic";
+    kernel_name += rtc_precision_name(precision);
+    return kernel_name;
+}
+
+const char* generic_rtc_header = "extern \"C\" __global__ void ";
+
+static std::string generic_rtc_launch_bounds()
+{
+    std::string bounds = "__launch_bounds__(";
+    bounds += std::to_string(GENERIC_THREADS);
+    bounds += ") ";
+    return bounds;
+}
+
+static std::string generic_rtc_args()
+{
+    // input and output are the same buffer for in-place transforms,
+    // so neither is restrict
+    std::string args = "(";
+    args += "const scalar_type* __restrict__ twiddles";
+    args += ", size_t dim";
+    args += ", const size_t* __restrict__ lengths";
+    args += ", const size_t* __restrict__ stride_in";
+    args += ", const size_t* __restrict__ stride_out";
+    args += ", size_t nbatch";
+    args += ", size_t num_radices";
+    args += ", radices_t radices";
+    args += ", int direction";
+    args += ", double load_scale";
+    args += ", double store_scale";
+    args += ", const scalar_type* input";
+    args += ", scalar_type* output";
+    args += ")";
+    return args;
+}
+
+static std::string generic_rtc_body()
+{
+    std::string body = "{";
+    body += R"_SRC(
+        extern __shared__ unsigned char __attribute__((aligned(sizeof(scalar_type)))) lds_bytes[];
+
+        // each block does one transform, ping-ponging between two
+        // halves of LDS on each pass
+        const size_t N    = lengths[0];
+        scalar_type* bufA = reinterpret_cast<scalar_type*>(lds_bytes);
+        scalar_type* bufB = bufA + N;
+
+        // higher dimensions are just more transforms
+        size_t transform  = blockIdx.x;
+        size_t offset_in  = 0;
+        size_t offset_out = 0;
+        for(size_t d = 1; d < dim; ++d)
+        {
+            const size_t idx = transform % lengths[d];
+            transform /= lengths[d];
+            offset_in += idx * stride_in[d];
+            offset_out += idx * stride_out[d];
+        }
+        if(transform >= nbatch)
+            return;
+        offset_in += transform * stride_in[dim];
+        offset_out += transform * stride_out[dim];
+
+        for(size_t i = threadIdx.x; i < N; i += blockDim.x)
+            bufA[i] = input[offset_in + i * stride_in[0]]
+                      * static_cast<real_type_t<scalar_type>>(load_scale);
+        __syncthreads();
+
+        // Ns is the length of the sub-transforms already done.  The
+        // twiddle table has no entries for the first pass, and
+        // (R - 1) entries for each of the Ns sub-transforms of the
+        // later ones.
+        size_t Ns       = 1;
+        size_t twd_base = 0;
+        for(size_t p = 0; p < num_radices; ++p)
+        {
+            const size_t R           = radices.data[p];
+            const size_t butterflies = N / R;
+
+            scalar_type roots[GENERIC_MAX_RADIX];
+            for(size_t m = 0; m < R; ++m)
+            {
+                double s, c;
+                sincospi(2.0 * m / R, &s, &c);
+                roots[m] = scalar_type(c, direction * s);
+            }
+
+            for(size_t t = threadIdx.x; t < butterflies; t += blockDim.x)
+            {
+                const size_t k = t % Ns;
+
+                scalar_type v[GENERIC_MAX_RADIX];
+                for(size_t r = 0; r < R; ++r)
+                {
+                    v[r] = bufA[t + r * butterflies];
+                    if(p > 0 && r > 0)
+                    {
+                        // table holds forward twiddles
+                        auto w = twiddles[twd_base + k * (R - 1) + (r - 1)];
+                        if(direction > 0)
+                            w.y = -w.y;
+                        v[r] = v[r] * w;
+                    }
+                }
+
+                const size_t out_base = (t / Ns) * Ns * R + k;
+                for(size_t j = 0; j < R; ++j)
+                {
+                    scalar_type sum = v[0];
+                    for(size_t r = 1; r < R; ++r)
+                        sum += v[r] * roots[(j * r) % R];
+                    bufB[out_base + j * Ns] = sum;
+                }
+            }
+            __syncthreads();
+
+            auto tmp = bufA;
+            bufA     = bufB;
+            bufB     = tmp;
+            if(p > 0)
+                twd_base += Ns * (R - 1);
+            Ns *= R;
+        }
+
+        for(size_t i = threadIdx.x; i < N; i += blockDim.x)
+            output[offset_out + i * stride_out[0]]
+                = bufA[i] * static_cast<real_type_t<scalar_type>>(store_scale);
+        )_SRC";
+    body += "}";
+    return body;
+}
+
+std::string generic_rtc(const std::string& kernel_name, rocfft_precision precision)
+{
+    std::string src;
+
+    src += rocfft_complex_h;
+    src += common_h;
+    src += rtc_precision_type_decl(precision);
+    src += "static const unsigned int TWIDDLES_MAX_RADICES = "
+           + std::to_string(TWIDDLES_MAX_RADICES) + ";\n";
+    src += "static const unsigned int GENERIC_MAX_RADIX = " + std::to_string(GENERIC_MAX_RADIX)
+           + ";\n";
+
+    src += radices_t_str;
+    src += generic_rtc_header;
+    src += generic_rtc_launch_bounds();
+    src += kernel_name;
+    src += generic_rtc_args();
+    src += generic_rtc_body();
+    return src;
+}
@@ -0,0 +1,177 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "rtc_generic_kernel.h"
+#include "../../shared/environment.h"
+#include "../../shared/precision_type.h"
+#include "device/kernel-generator-embed.h"
+#include "kernel_launch.h"
+#include "rtc_cache.h"
+#include "rtc_module_cache.h"
+#include "rtc_twiddle_gen.h"
+#include "tree_node.h"
+
+#include <chrono>
+
+bool RTCKernelGeneric::supports(const TreeNode& node)
+{
+    if(rocfft_getenv("ROCFFT_RTC_GENERIC_FALLBACK") != "1")
+        return false;
+
+    auto leaf = dynamic_cast<const LeafNode*>(&node);
+    if(!leaf || node.scheme != CS_KERNEL_STOCKHAM || node.large1D != 0
+       || node.ebtype != EmbeddedType::NONE || node.fuseBlue != BFT_NONE || leaf->twd_no_radices)
+        return false;
+    if(node.precision != rocfft_precision_single && node.precision != rocfft_precision_double)
+        return false;
+
+    auto interleaved = [](rocfft_array_type type) {
+        return type == rocfft_array_type_complex_interleaved
+               || type == rocfft_array_type_hermitian_interleaved;
+    };
+    if(!interleaved(node.inArrayType) || !interleaved(node.outArrayType))
+        return false;
+
+    // scaling is the only load/store op the kernel does
+    LoadOps  loadOps  = node.loadOps;
+    StoreOps storeOps = node.storeOps;
+    loadOps.scale_factor  = 1.0;
+    storeOps.scale_factor = 1.0;
+    if(loadOps.enabled() || storeOps.enabled() || !loadOps.callback.empty()
+       || !storeOps.callback.empty())
+        return false;
+
+    // the factors are needed to walk the (stacked) twiddle table,
+    // and the kernel ping-pongs a whole transform between two LDS
+    // buffers
+    const auto& factors = leaf->kernelFactors;
+    if(factors.empty() || factors.size() > TWIDDLES_RTC_MAX_RADICES || !node.devKernArg
+       || leaf->twd_octant)
+        return false;
+    size_t product = 1;
+    for(auto f : factors)
+    {
+        if(f > GENERIC_MAX_RADIX)
+            return false;
+        product *= f;
+    }
+    if(product != node.length[0])
+        return false;
+    return 2 * node.length[0] * complex_type_size(node.precision)
+           <= node.deviceProp.sharedMemPerBlock;
+}
+
+std::unique_ptr<RTCKernelGeneric> RTCKernelGeneric::generate_from_node(const TreeNode&    node,
+                                                                       const std::string& gpu_arch)
+{
+    if(!supports(node))
+        return nullptr;
+
+    auto precision   = node.precision;
+    auto kernel_name = generic_rtc_kernel_name(precision);
+
+    kernel_src_gen_t generator{
+        [=](const std::string& kernel_name) { return generic_rtc(kernel_name, precision); }};
+
+    // generic kernels are in the AOT cache, so this is normally just
+    // a lookup
+    auto module = RTCModuleCache::GetCache().Find(kernel_name, gpu_arch, generator_sum());
+    std::vector<char> code;
+    if(!module)
+        code = RTCCache::cached_compile(kernel_name, gpu_arch, generator, generator_sum());
+
+    // one block per transform
+    size_t batch_accum = node.batch;
+    for(size_t j = 1; j < node.length.size(); ++j)
+        batch_accum *= node.length[j];
+
+    // construct from the module that was found, since the cache may
+    // drop it before a second lookup
+    std::unique_ptr<RTCKernelGeneric> kernel(
+        new RTCKernelGeneric(kernel_name,
+                             module ? RTCLoadableModule(module) : RTCLoadableModule(code),
+                             dim3(checked_grid_dim(batch_accum, GENERIC_THREADS)),
+                             dim3(GENERIC_THREADS)));
+    kernel->lds_bytes = 2 * node.length[0] * complex_type_size(precision);
+    return kernel;
+}
+
+RTCKernelArgs RTCKernelGeneric::get_launch_args(DeviceCallIn& data)
+{
+    const auto& node = *data.node;
+    const auto& leaf = static_cast<const LeafNode&>(node);
+
+    radices_t radices = {};
+    std::copy(leaf.kernelFactors.begin(), leaf.kernelFactors.end(), radices.data);
+
+    const bool inplace = node.placement == rocfft_placement_inplace;
+
+    RTCKernelArgs kargs;
+    kargs.append_ptr(node.twiddles);
+    kargs.append_size_t(node.length.size());
+    kargs.append_ptr(kargs_lengths(node.devKernArg));
+    kargs.append_ptr(kargs_stride_in(node.devKernArg));
+    kargs.append_ptr(inplace ? kargs_stride_in(node.devKernArg)
+                             : kargs_stride_out(node.devKernArg));
+    kargs.append_size_t(data.get_batch());
+    kargs.append_size_t(leaf.kernelFactors.size());
+    kargs.append_struct(radices);
+    kargs.append_int(node.direction);
+    kargs.append_double(node.loadOps.scale_factor);
+    kargs.append_double(node.storeOps.scale_factor);
+    kargs.append_ptr(data.bufIn[0]);
+    kargs.append_ptr(inplace ? data.bufIn[0] : data.bufOut[0]);
+    return kargs;
+}
+
+void RTCKernelGeneric::launch_fallback(const DeviceCallIn& data, const hipDeviceProp_t& deviceProp)
+{
+    DeviceCallIn fallbackData = data;
+
+    auto& gp     = fallbackData.gridParam;
+    gp.b_x       = gridDim.x / data.node->batch * data.get_batch();
+    gp.b_y       = 1;
+    gp.b_z       = 1;
+    gp.wgs_x     = blockDim.x;
+    gp.wgs_y     = 1;
+    gp.wgs_z     = 1;
+    gp.lds_bytes = lds_bytes;
+    launch(fallbackData, deviceProp);
+}
+
+RTCKernelGeneric* rtc_fallback_kernel(const TreeNode& node)
+{
+    if(!node.genericKernel)
+        return nullptr;
+    if(node.compiledKernel.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return static_cast<RTCKernelGeneric*>(node.genericKernel.get());
+
+    // a compile that failed leaves the node on the generic kernel,
+    // which is already known to work
+    try
+    {
+        if(node.compiledKernel.get())
+            return nullptr;
+    }
+    catch(std::exception&)
+    {
+    }
+    return static_cast<RTCKernelGeneric*>(node.genericKernel.get());
+}
@@ -27,15 +27,20 @@
 #include "device/kernel-generator-embed.h"
 #include "kernel_launch.h"
 #include "logging.h"
+#include "plan_create_times.h"
 #include "rtc_bluestein_kernel.h"
 #include "rtc_cache.h"
+#include "rtc_compile_scheduler.h"
+#include "rtc_module_cache.h"
 #include "rtc_realcomplex_kernel.h"
 #include "rtc_stockham_kernel.h"
 #include "rtc_transpose_kernel.h"
 #include "tree_node.h"
 
+#include <cstring>
+
 RTCKernel::RTCKernel(const std::string&       kernel_name,
-                     const std::vector<char>& code,
+                     const RTCLoadableModule& code,
                      dim3                     gridDim,
                      dim3                     blockDim)
     : gridDim(gridDim)
@@ -47,21 +52,200 @@ RTCKernel::RTCKernel(const std::string&       kernel_name,
     if(rocfft_getenv("ROCFFT_INTERNAL_COMPILE_ONLY") == "1")
         return;
 #endif
-    if(hipModuleLoadData(&module, code.data()) != hipSuccess)
-        throw std::runtime_error("failed to load module for " + kernel_name);
+    if(code.module)
+        module = code.module;
+#ifndef ROCFFT_DEBUG_GENERATE_KERNEL_HARNESS
+    else
+        module = RTCModuleCache::GetCache().Load(kernel_name, *code.code);
+#else
+    else
+        module = std::make_shared<RTCModule>(kernel_name, code.code->data());
+#endif
 
-    if(hipModuleGetFunction(&kernel, module, kernel_name.c_str()) != hipSuccess)
+    if(hipModuleGetFunction(&kernel, module->module, kernel_name.c_str()) != hipSuccess)
         throw std::runtime_error("failed to get function " + kernel_name);
 }
 
 #ifndef ROCFFT_DEBUG_GENERATE_KERNEL_HARNESS
-void RTCKernel::launch(DeviceCallIn& data, const hipDeviceProp_t& deviceProp)
+// Values in DeviceCallIn that can change between executions of a
+// plan.  The callback LDS sizes are packed as unsigned ints, the
+// rest are pointers.
+static const size_t PER_CALL_ARG_COUNT  = 11;
+static const size_t PER_CALL_ARG_PTRS   = 9;
+static const size_t PACKED_ARGS_MAX_LEN = 4096;
+
+static void per_call_args(const DeviceCallIn& data, uint64_t (&values)[PER_CALL_ARG_COUNT])
+{
+    const void* ptrs[PER_CALL_ARG_PTRS] = {data.bufIn[0],
+                                           data.bufIn[1],
+                                           data.bufOut[0],
+                                           data.bufOut[1],
+                                           data.bufTemp,
+                                           data.callbacks.load_cb_fn,
+                                           data.callbacks.load_cb_data,
+                                           data.callbacks.store_cb_fn,
+                                           data.callbacks.store_cb_data};
+    for(size_t i = 0; i < PER_CALL_ARG_PTRS; ++i)
+        values[i] = reinterpret_cast<uintptr_t>(ptrs[i]);
+    values[PER_CALL_ARG_PTRS]     = static_cast<unsigned int>(data.callbacks.load_cb_lds_bytes);
+    values[PER_CALL_ARG_PTRS + 1] = static_cast<unsigned int>(data.callbacks.store_cb_lds_bytes);
+}
+
+// Distinct placeholder for each per-call value in each probe.  The
+// difference between a value's two placeholders is unique to that
+// value, so a packed argument can be traced back to its source even
+// if the kernel offset it.
+static uint64_t per_call_arg_sentinel(size_t probe, size_t source)
 {
-    RTCKernelArgs kargs = get_launch_args(data);
+    if(source < PER_CALL_ARG_PTRS)
+        return probe == 0 ? 0x5a5a5a5a00000000ULL + (source << 20)
+                          : 0xa5a5a5a500000000ULL + (source << 24);
+    return probe == 0 ? 0x5a5a0000U + (source << 8) : 0xa5a50000U + (source << 12);
+}
+
+void RTCKernel::pack_launch_args(DeviceCallIn& data)
+{
+    // pack the arguments twice with different placeholders for the
+    // per-call values - anything that differs between the two
+    // packings must be explained by one of them
+    RTCKernelArgs probes[2];
+    for(size_t probe = 0; probe < 2; ++probe)
+    {
+        DeviceCallIn probeData = data;
+        // the packed arguments are for the node's whole batch
+        probeData.batch = 0;
+        void**       ptrs[PER_CALL_ARG_PTRS]
+            = {&probeData.bufIn[0],
+               &probeData.bufIn[1],
+               &probeData.bufOut[0],
+               &probeData.bufOut[1],
+               &probeData.bufTemp,
+               &probeData.callbacks.load_cb_fn,
+               &probeData.callbacks.load_cb_data,
+               &probeData.callbacks.store_cb_fn,
+               &probeData.callbacks.store_cb_data};
+        for(size_t i = 0; i < PER_CALL_ARG_PTRS; ++i)
+            *ptrs[i] = reinterpret_cast<void*>(per_call_arg_sentinel(probe, i));
+        probeData.callbacks.load_cb_lds_bytes
+            = per_call_arg_sentinel(probe, PER_CALL_ARG_PTRS);
+        probeData.callbacks.store_cb_lds_bytes
+            = per_call_arg_sentinel(probe, PER_CALL_ARG_PTRS + 1);
+        probes[probe] = get_launch_args(probeData);
+    }
+
+    const size_t size = probes[0].size_bytes();
+    if(size != probes[1].size_bytes() || size > PACKED_ARGS_MAX_LEN)
+        return;
+    const char* a = static_cast<const char*>(probes[0].data());
+    const char* b = static_cast<const char*>(probes[1].data());
+
+    auto match_ptr = [&](size_t offset) {
+        uint64_t va, vb;
+        memcpy(&va, a + offset, sizeof(va));
+        memcpy(&vb, b + offset, sizeof(vb));
+        for(size_t source = 0; source < PER_CALL_ARG_PTRS; ++source)
+        {
+            uint64_t delta = va - per_call_arg_sentinel(0, source);
+            if(delta == vb - per_call_arg_sentinel(1, source))
+            {
+                packed_patches.push_back({offset, source, delta, false});
+                return true;
+            }
+        }
+        return false;
+    };
+    auto match_u32 = [&](size_t offset) {
+        uint32_t va, vb;
+        memcpy(&va, a + offset, sizeof(va));
+        memcpy(&vb, b + offset, sizeof(vb));
+        if(va == vb)
+            return true;
+        for(size_t source = PER_CALL_ARG_PTRS; source < PER_CALL_ARG_COUNT; ++source)
+        {
+            if(va == per_call_arg_sentinel(0, source) && vb == per_call_arg_sentinel(1, source))
+            {
+                packed_patches.push_back({offset, source, 0, true});
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // pointers are 8-byte aligned in the argument buffer
+    size_t offset = 0;
+    for(; offset + 8 <= size; offset += 8)
+    {
+        if(std::equal(a + offset, a + offset + 8, b + offset))
+            continue;
+        if(match_ptr(offset))
+            continue;
+        if(!match_u32(offset) || !match_u32(offset + 4))
+        {
+            packed_patches.clear();
+            return;
+        }
+    }
+    if(offset + 4 <= size)
+    {
+        if(!match_u32(offset))
+        {
+            packed_patches.clear();
+            return;
+        }
+        offset += 4;
+    }
+    if(!std::equal(a + offset, a + size, b + offset))
+    {
+        packed_patches.clear();
+        return;
+    }
+
+    packed_args.assign(a, a + size);
+    packed_valid = true;
+}
 
+void RTCKernel::launch(DeviceCallIn& data, const hipDeviceProp_t& deviceProp)
+{
     const auto& gp = data.gridParam;
 
+    std::call_once(packed_once, [&]() { pack_launch_args(data); });
+
+    // kernels whose arguments can't be patched are packed on every
+    // launch, as are launches for fewer transforms than the node's
+    // batch
+    if(!packed_valid || data.get_batch() != data.node->batch)
+    {
+        RTCKernelArgs kargs = get_launch_args(data);
+        launch(kargs,
+               {gp.b_x, gp.b_y, gp.b_z},
+               {gp.wgs_x, gp.wgs_y, gp.wgs_z},
+               gp.lds_bytes,
+               deviceProp,
+               data.rocfft_stream);
+        return;
+    }
+
+    uint64_t values[PER_CALL_ARG_COUNT];
+    per_call_args(data, values);
+
+    alignas(16) char kargs[PACKED_ARGS_MAX_LEN];
+    std::copy(packed_args.begin(), packed_args.end(), kargs);
+    for(const auto& patch : packed_patches)
+    {
+        if(patch.is_u32)
+        {
+            uint32_t value = static_cast<uint32_t>(values[patch.source]);
+            memcpy(kargs + patch.offset, &value, sizeof(value));
+        }
+        else
+        {
+            uint64_t value = values[patch.source] + patch.delta;
+            memcpy(kargs + patch.offset, &value, sizeof(value));
+        }
+    }
+
     launch(kargs,
+           packed_args.size(),
            {gp.b_x, gp.b_y, gp.b_z},
            {gp.wgs_x, gp.wgs_y, gp.wgs_z},
            gp.lds_bytes,
@@ -76,11 +260,22 @@ void RTCKernel::launch(RTCKernelArgs&         kargs,
                        unsigned int           lds_bytes,
                        const hipDeviceProp_t& deviceProp,
                        hipStream_t            stream)
+{
+    launch(kargs.data(), kargs.size_bytes(), gridDim, blockDim, lds_bytes, deviceProp, stream);
+}
+
+void RTCKernel::launch(void*                  kargs,
+                       size_t                 kargs_bytes,
+                       dim3                   gridDim,
+                       dim3                   blockDim,
+                       unsigned int           lds_bytes,
+                       const hipDeviceProp_t& deviceProp,
+                       hipStream_t            stream)
 {
     launch_limits_check(kernel_name, gridDim, blockDim, deviceProp);
-    auto  size     = kargs.size_bytes();
+    auto  size     = kargs_bytes;
     void* config[] = {HIP_LAUNCH_PARAM_BUFFER_POINTER,
-                      kargs.data(),
+                      kargs,
                       HIP_LAUNCH_PARAM_BUFFER_SIZE,
                       &size,
                       HIP_LAUNCH_PARAM_END};
@@ -92,7 +287,17 @@ void RTCKernel::launch(RTCKernelArgs&         kargs,
         hipError_t ret = hipModuleOccupancyMaxActiveBlocksPerMultiprocessor(
             &max_blocks_per_sm, kernel, blockDim.x * blockDim.y * blockDim.z, lds_bytes);
         rocfft_ostream* kernelplan_stream = LogSingleton::GetInstance().GetPlanOS();
-        if(ret == hipSuccess)
+        if(LOG_JSON_ENABLED())
+        {
+            if(ret == hipSuccess)
+                log_json_arguments(*kernelplan_stream,
+                                   "kernel_occupancy",
+                                   "kernel_name",
+                                   kernel_name,
+                                   "max_blocks_per_cu",
+                                   max_blocks_per_sm);
+        }
+        else if(ret == hipSuccess)
             *kernelplan_stream << "Kernel occupancy: " << max_blocks_per_sm << std::endl;
         else
             *kernelplan_stream << "Can not retrieve occupancy info." << std::endl;
@@ -122,6 +327,61 @@ bool RTCKernel::get_occupancy(dim3 blockDim, unsigned int lds_bytes, int& occupa
     return ret == hipSuccess;
 }
 
+// Compile callbacks that were given as source into a
+// callback-enabled kernel.  The source hashes go into the kernel
+// name, so each callback gets its own RTC cache entries.
+static void add_inline_callbacks(const TreeNode&   node,
+                                 std::string&      kernel_name,
+                                 kernel_src_gen_t& generate_src)
+{
+    const auto& load  = node.loadOps.callback;
+    const auto& store = node.storeOps.callback;
+    if(load.empty() && store.empty())
+        return;
+
+    if(!load.empty())
+        kernel_name += "_loadCB" + load.hash();
+    if(!store.empty())
+        kernel_name += "_storeCB" + store.hash();
+
+    generate_src = [=](const std::string& kernel_name) mutable {
+        std::string src;
+        if(!load.empty())
+            src += "#define ROCFFT_INLINE_LOAD_CALLBACK\n";
+        if(!store.empty())
+            src += "#define ROCFFT_INLINE_STORE_CALLBACK\n";
+        src += generate_src(kernel_name);
+
+        // the wrappers declared in callback.h are templates, so they
+        // can be defined after the kernel that uses them
+        if(!load.empty())
+        {
+            src += "\n" + load.source + "\n";
+            src += "template <typename T>\n"
+                   "__device__ T rocfft_inline_load_cb(T* data, size_t offset, void* cbdata, "
+                   "void* sharedMem)\n"
+                   "{\n"
+                   "    return "
+                   + load.function
+                   + "(data, offset, cbdata, sharedMem);\n"
+                     "}\n";
+        }
+        if(!store.empty())
+        {
+            src += "\n" + store.source + "\n";
+            src += "template <typename T>\n"
+                   "__device__ void rocfft_inline_store_cb(T* data, size_t offset, T element, "
+                   "void* cbdata, void* sharedMem)\n"
+                   "{\n"
+                   "    "
+                   + store.function
+                   + "(data, offset, element, cbdata, sharedMem);\n"
+                     "}\n";
+        }
+        return src;
+    };
+}
+
 std::shared_future<std::unique_ptr<RTCKernel>>
     RTCKernel::runtime_compile(const TreeNode&    node,
                                const std::string& gpu_arch,
@@ -154,16 +414,35 @@ std::shared_future<std::unique_ptr<RTCKernel>>
     if(generator.valid())
     {
         kernel_name = generator.generate_name();
+        if(enable_callbacks)
+            add_inline_callbacks(node, kernel_name, generator.generate_src);
 
-        auto compile = [=]() {
+        // charge the compile to the plan being created, even though
+        // it runs on a worker thread
+        auto createTimes = PlanCreateTimes::Current();
+        auto compile     = [=]() {
             if(hipSetDevice(deviceId) != hipSuccess)
             {
                 throw std::runtime_error("failed to set device");
             }
+            PlanCreateTimesScope timesScope(createTimes);
             try
             {
-                std::vector<char> code = RTCCache::cached_compile(
+                // a module that's already loaded (or that can be
+                // loaded straight from the AOT archive) needs no code
+                // object - the kernel takes it as is, since the cache
+                // may drop it before a second lookup
+                PlanCreateTimer findTimer(PCP_MODULE_LOAD);
+                auto module
+                    = RTCModuleCache::GetCache().Find(kernel_name, gpu_arch, generator_sum());
+                if(module)
+                    return generator.construct_rtckernel(
+                        kernel_name, module, generator.gridDim, generator.blockDim);
+                findTimer.Stop();
+
+                auto code = RTCCache::cached_compile(
                     kernel_name, gpu_arch, generator.generate_src, generator_sum());
+                PlanCreateTimer loadTimer(PCP_MODULE_LOAD);
                 return generator.construct_rtckernel(
                     kernel_name, code, generator.gridDim, generator.blockDim);
             }
@@ -176,7 +455,7 @@ std::shared_future<std::unique_ptr<RTCKernel>>
         };
 
         // compile to code object
-        return std::async(std::launch::async, compile);
+        return RTCCompileScheduler::GetScheduler().Submit<std::unique_ptr<RTCKernel>>(compile);
     }
     // a pre-compiled rtc-stockham-kernel goes here
     else if(generator.is_pre_compiled())
@@ -0,0 +1,140 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+
+#include "rtc_module_cache.h"
+#include "../../shared/environment.h"
+#include "rtc_cache.h"
+
+#include <stdexcept>
+
+RTCModuleCache::RTCModuleCache()
+{
+    auto env_size = rocfft_getenv("ROCFFT_RTC_MODULE_CACHE_SIZE");
+    if(!env_size.empty())
+    {
+        try
+        {
+            max_entries = std::stoull(env_size);
+        }
+        catch(std::exception&)
+        {
+            max_entries = 0;
+        }
+    }
+}
+
+std::shared_ptr<RTCModule> RTCModuleCache::Find(const std::string& kernel_name)
+{
+    auto module = Lookup(kernel_name);
+    if(module)
+        ++RTCCache::stats.memory_hits;
+    return module;
+}
+
+std::shared_ptr<RTCModule> RTCModuleCache::Lookup(const std::string& kernel_name)
+{
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        return nullptr;
+
+    std::lock_guard<std::mutex> lock(mtx);
+
+    auto it = entries.find(key_t{deviceId, kernel_name});
+    if(it == entries.end())
+        return nullptr;
+
+    // mark as most recently used
+    lru.splice(lru.begin(), lru, it->second.lru_pos);
+    return it->second.module;
+}
+
+std::shared_ptr<RTCModule> RTCModuleCache::Find(const std::string&          kernel_name,
+                                                const std::string&          gpu_arch,
+                                                const std::array<char, 32>& generator_sum)
+{
+    auto module = Find(kernel_name);
+    if(module || max_entries == 0 || !RTCCache::single)
+        return module;
+
+    // compile-only processes don't load code objects
+    if(rocfft_getenv("ROCFFT_INTERNAL_COMPILE_ONLY") == "1")
+        return nullptr;
+
+    auto archived
+        = RTCCache::single->get_archived_code_object(kernel_name, gpu_arch, generator_sum);
+    if(!archived.first)
+        return nullptr;
+    ++RTCCache::stats.system_hits;
+    return Load(kernel_name, archived.first);
+}
+
+std::shared_ptr<RTCModule> RTCModuleCache::Load(const std::string&       kernel_name,
+                                                const std::vector<char>& code)
+{
+    return Load(kernel_name, code.empty() ? nullptr : code.data());
+}
+
+std::shared_ptr<RTCModule> RTCModuleCache::Load(const std::string& kernel_name, const void* image)
+{
+    auto module = Lookup(kernel_name);
+    if(module)
+        return module;
+
+    if(!image)
+        throw std::runtime_error("no code object for " + kernel_name);
+
+    // load outside of the lock - if another thread loads the same
+    // module concurrently, the first one to be inserted wins
+    module = std::make_shared<RTCModule>(kernel_name, image);
+
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        throw std::runtime_error("failed to get device");
+
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if(max_entries == 0)
+        return module;
+
+    key_t key{deviceId, kernel_name};
+    auto  it = entries.find(key);
+    if(it != entries.end())
+        return it->second.module;
+
+    // evict least-recently-used entries to make room
+    while(entries.size() >= max_entries)
+    {
+        entries.erase(lru.back());
+        lru.pop_back();
+        ++RTCCache::stats.memory_evictions;
+    }
+
+    lru.push_front(key);
+    entries.emplace(key, entry_t{module, lru.begin()});
+    return module;
+}
+
+void RTCModuleCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    entries.clear();
+    lru.clear();
+}
@@ -0,0 +1,127 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "rtc_radix_gen.h"
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+// literal for a butterfly constant, converted to the real type of
+// the butterfly's complex type
+static std::string radix_constant(long double value)
+{
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.21Lg", value);
+    return std::string("static_cast<real_type_t<T>>(") + buf + ")";
+}
+
+static const long double RADIX_TWO_PI = 6.283185307179586476925286766559L;
+
+static std::string radix_ptr(unsigned int i)
+{
+    return "(*R" + std::to_string(i) + ")";
+}
+
+// A length-N DFT with N odd pairs up inputs j and N-j, so that
+// outputs k and N-k share the same products:
+//
+//   dp = R[j] + R[N-j], dm = R[j] - R[N-j]
+//   X[k]   += cos(2 pi jk/N) * dp -/+ i sin(2 pi jk/N) * dm
+//   X[N-k] += cos(2 pi jk/N) * dp +/- i sin(2 pi jk/N) * dm
+//
+// which needs roughly half the multiplies of a direct DFT.
+static std::string prime_radix_butterfly(unsigned int radix, bool forward)
+{
+    const unsigned int half = (radix - 1) / 2;
+
+    std::string src = "template <typename T>\n__device__ void ";
+    src += forward ? "Fwd" : "Inv";
+    src += "Rad" + std::to_string(radix) + "B1(";
+    for(unsigned int i = 0; i < radix; ++i)
+    {
+        if(i > 0)
+            src += ", ";
+        src += "T* R" + std::to_string(i);
+    }
+    src += ")\n{\n";
+
+    // cos and sin of 2 pi m / N for m = 1 .. (N-1)/2 - other
+    // multiples of the angle reuse these by symmetry
+    for(unsigned int m = 1; m <= half; ++m)
+    {
+        auto angle = RADIX_TWO_PI * m / radix;
+        src += "    const real_type_t<T> C" + std::to_string(m) + " = "
+               + radix_constant(cosl(angle)) + ";\n";
+        src += "    const real_type_t<T> S" + std::to_string(m) + " = "
+               + radix_constant(sinl(angle)) + ";\n";
+    }
+
+    src += "    T x0 = " + radix_ptr(0);
+    for(unsigned int i = 1; i < radix; ++i)
+        src += " + " + radix_ptr(i);
+    src += ";\n";
+    for(unsigned int k = 1; k < radix; ++k)
+        src += "    T x" + std::to_string(k) + " = " + radix_ptr(0) + ";\n";
+    src += "    T dp, dm;\n";
+
+    for(unsigned int j = 1; j <= half; ++j)
+    {
+        src += "    dp = " + radix_ptr(j) + " + " + radix_ptr(radix - j) + ";\n";
+        src += "    dm = " + radix_ptr(j) + " - " + radix_ptr(radix - j) + ";\n";
+        for(unsigned int k = 1; k <= half; ++k)
+        {
+            // reduce the angle's multiple into the first half, where
+            // sin(2 pi (N-m) / N) == -sin(2 pi m / N)
+            unsigned int m        = (j * k) % radix;
+            bool         positive = m <= half;
+            if(!positive)
+                m = radix - m;
+            // forward transforms use e^(-i angle), which moves the
+            // sin term to the other output of the pair
+            if(!forward)
+                positive = !positive;
+
+            const std::string c  = "C" + std::to_string(m);
+            const std::string s  = "S" + std::to_string(m);
+            const std::string lo = "x" + std::to_string(k);
+            const std::string hi = "x" + std::to_string(radix - k);
+            const char*       p  = positive ? " + " : " - ";
+            const char*       n  = positive ? " - " : " + ";
+
+            src += "    " + lo + ".x += " + c + " * dp.x" + p + s + " * dm.y;\n";
+            src += "    " + lo + ".y += " + c + " * dp.y" + n + s + " * dm.x;\n";
+            src += "    " + hi + ".x += " + c + " * dp.x" + n + s + " * dm.y;\n";
+            src += "    " + hi + ".y += " + c + " * dp.y" + p + s + " * dm.x;\n";
+        }
+    }
+
+    for(unsigned int k = 0; k < radix; ++k)
+        src += "    " + radix_ptr(k) + " = x" + std::to_string(k) + ";\n";
+    src += "}\n\n";
+    return src;
+}
+
+std::string prime_radix_rtc(unsigned int radix)
+{
+    if(radix < 3 || radix % 2 == 0)
+        throw std::runtime_error("cannot generate butterfly for radix " + std::to_string(radix));
+    return prime_radix_butterfly(radix, true) + prime_radix_butterfly(radix, false);
+}
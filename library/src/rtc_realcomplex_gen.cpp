@@ -44,6 +44,18 @@ std::string realcomplex_rtc_kernel_name(const RealComplexSpecs& specs)
     case CS_KERNEL_COPY_HERM_TO_CMPLX:
         kernel_name += "herm2c_copy_rtc";
         break;
+    case CS_KERNEL_PAIR_R_TO_CMPLX:
+        kernel_name += "r2c_pair_rtc";
+        break;
+    case CS_KERNEL_PAIR_CMPLX_TO_HERM:
+        kernel_name += "c2herm_pair_rtc";
+        break;
+    case CS_KERNEL_PACK_HERM:
+        kernel_name += "herm_pack_rtc";
+        break;
+    case CS_KERNEL_UNPACK_HERM:
+        kernel_name += "herm_unpack_rtc";
+        break;
     default:
         throw std::runtime_error("invalid realcomplex rtc scheme");
     }
@@ -76,7 +88,9 @@ std::string r2c_copy_rtc(const std::string& kernel_name, const RealComplexSpecs&
     src += "static const unsigned int dim = " + std::to_string(specs.dim) + ";\n";
 
     const char* input_type
-        = specs.scheme == CS_KERNEL_COPY_R_TO_CMPLX ? "real_type_t<scalar_type>" : "scalar_type";
+        = specs.scheme == CS_KERNEL_COPY_R_TO_CMPLX || specs.scheme == CS_KERNEL_PAIR_R_TO_CMPLX
+              ? "real_type_t<scalar_type>"
+              : "scalar_type";
     const char* output_type
         = specs.scheme == CS_KERNEL_COPY_CMPLX_TO_R ? "real_type_t<scalar_type>" : "scalar_type";
 
@@ -101,7 +115,7 @@ std::string r2c_copy_rtc(const std::string& kernel_name, const RealComplexSpecs&
     func.launch_bounds = LAUNCH_BOUNDS_R2C_C2R_KERNEL;
     func.qualifier     = "extern \"C\" __global__";
 
-    if(specs.scheme == CS_KERNEL_COPY_HERM_TO_CMPLX)
+    if(specs.scheme == CS_KERNEL_COPY_HERM_TO_CMPLX || specs.scheme == CS_KERNEL_PAIR_CMPLX_TO_HERM)
         func.arguments.append(hermitian_size);
 
     func.arguments.append(lengths0);
@@ -131,11 +145,13 @@ std::string r2c_copy_rtc(const std::string& kernel_name, const RealComplexSpecs&
     Variable idx_2{"idx_2", "const unsigned int"};
     Variable idx_batch{"idx_batch", "const unsigned int"};
 
-    // variable to divide by when counting lengths0 - herm2c
-    // allocates threads along hermitian length, but other kernels
-    // allocate threads along FFT length
-    Variable& lengths0_divide
-        = specs.scheme == CS_KERNEL_COPY_HERM_TO_CMPLX ? hermitian_size : lengths0;
+    // variable to divide by when counting lengths0 - herm2c and
+    // pair unpacking allocate threads along hermitian length, but
+    // other kernels allocate threads along FFT length
+    Variable& lengths0_divide = specs.scheme == CS_KERNEL_COPY_HERM_TO_CMPLX
+                                        || specs.scheme == CS_KERNEL_PAIR_CMPLX_TO_HERM
+                                    ? hermitian_size
+                                    : lengths0;
 
     func.body += CommentLines{"per-dimension indexes"};
     func.body += Declaration{idx_0, global_idx % lengths0_divide};
@@ -163,7 +179,143 @@ std::string r2c_copy_rtc(const std::string& kernel_name, const RealComplexSpecs&
     func.body += CommentLines{"any excess threads will be past the end of batch"};
     func.body += If{idx_batch >= nbatch, {Return{}}};
 
-    if(specs.scheme == CS_KERNEL_COPY_HERM_TO_CMPLX)
+    // pair kernels handle two real transforms per batch index, and
+    // the dist of their real side is between those transforms
+    if(specs.scheme == CS_KERNEL_PAIR_R_TO_CMPLX)
+    {
+        Variable   inputIdx{"inputIdx", "auto"};
+        Variable   outputIdx{"outputIdx", "auto"};
+        Expression dist_in = Literal{"stride_in" + std::to_string(specs.dim)};
+        func.body += Declaration{inputIdx,
+                                 idx_0 * stride_in0 + idx_1 * stride_in1 + idx_2 * stride_in2
+                                     + idx_batch * 2 * dist_in};
+        func.body += Declaration{outputIdx,
+                                 idx_0 * stride_out0 + idx_1 * stride_out1 + idx_2 * stride_out2
+                                     + idx_batch * ("stride_out" + std::to_string(specs.dim))};
+
+        If guard{idx_0 < lengths0, {}};
+        guard.body += CommentLines{"pack the pair of real inputs into the real and imaginary",
+                                   "parts of one complex input.  this is never the last kernel",
+                                   "to write to global memory, so don't bother going through",
+                                   "the store cb."};
+        guard.body += CallbackLoadDeclaration("real_type_t<scalar_type>", "cbtype");
+        guard.body += CallbackStoreDeclaration("real_type_t<scalar_type>", "cbtype");
+
+        ComplexLiteral elem{LoadGlobal{input, inputIdx}, LoadGlobal{input, inputIdx + dist_in}};
+        guard.body += Assign{output[outputIdx], elem};
+        func.body += guard;
+    }
+    else if(specs.scheme == CS_KERNEL_PAIR_CMPLX_TO_HERM)
+    {
+        if(specs.dim != 1)
+            throw std::runtime_error("real pair unpacking only supports 1D transforms");
+
+        Variable   inputIdx{"inputIdx", "auto"};
+        Variable   inputConjIdx{"inputConjIdx", "auto"};
+        Variable   outputIdx{"outputIdx", "auto"};
+        Expression dist_out = Literal{"stride_out" + std::to_string(specs.dim)};
+        func.body += Declaration{inputIdx,
+                                 idx_0 * stride_in0
+                                     + idx_batch * ("stride_in" + std::to_string(specs.dim))};
+        func.body += Declaration{inputConjIdx,
+                                 Ternary{idx_0 == 0, 0, lengths0 - idx_0} * stride_in0
+                                     + idx_batch * ("stride_in" + std::to_string(specs.dim))};
+        func.body += Declaration{outputIdx, idx_0 * stride_out0 + idx_batch * 2 * dist_out};
+
+        func.body += CommentLines{"this is never the first kernel to read from global memory,",
+                                  "so don't bother going through the load cb."};
+        func.body += CallbackLoadDeclaration("scalar_type", "cbtype");
+        func.body += CallbackStoreDeclaration("scalar_type", "cbtype");
+
+        func.body += CommentLines{"with Z = FFT(a + ib), A[k] = (Z[k] + conj(Z[N-k])) / 2 and",
+                                  "B[k] = (Z[k] - conj(Z[N-k])) / 2i"};
+        Variable half{"half", "const real_type_t<scalar_type>"};
+        Variable z{"z", "const scalar_type"};
+        Variable zc{"zc", "const scalar_type"};
+        func.body += Declaration{half, Literal{"0.5"}};
+        func.body += Declaration{z, input[inputIdx]};
+        func.body += Declaration{zc, input[inputConjIdx]};
+
+        Variable a{"a", "const scalar_type"};
+        Variable b{"b", "const scalar_type"};
+        func.body += Declaration{
+            a, ComplexLiteral{(z.x() + zc.x()) * half, (z.y() - zc.y()) * half}};
+        func.body += Declaration{
+            b, ComplexLiteral{(z.y() + zc.y()) * half, (zc.x() - z.x()) * half}};
+        func.body += StoreGlobal{output, outputIdx, a};
+        func.body += StoreGlobal{output, outputIdx + dist_out, b};
+    }
+    else if(specs.scheme == CS_KERNEL_PACK_HERM || specs.scheme == CS_KERNEL_UNPACK_HERM)
+    {
+        // threads are allocated along the packed length, which is
+        // lengths0.  the Nyquist element is just past the end of it.
+        Variable inputIdx{"inputIdx", "auto"};
+        Variable outputIdx{"outputIdx", "auto"};
+        func.body += Declaration{inputIdx,
+                                 idx_0 * stride_in0 + idx_1 * stride_in1 + idx_2 * stride_in2
+                                     + idx_batch * ("stride_in" + std::to_string(specs.dim))};
+        func.body += Declaration{outputIdx,
+                                 idx_0 * stride_out0 + idx_1 * stride_out1 + idx_2 * stride_out2
+                                     + idx_batch * ("stride_out" + std::to_string(specs.dim))};
+
+        if(specs.scheme == CS_KERNEL_PACK_HERM)
+        {
+            func.body += CommentLines{"we would pack at the end of an R2C transform, so it would",
+                                      "never be the first kernel to read from global memory.",
+                                      "don't bother going through the load cb."};
+            func.body += CallbackLoadDeclaration("scalar_type", "cbtype");
+            func.body += CallbackStoreDeclaration("scalar_type", "cbtype");
+
+            Variable elem{"elem", "scalar_type"};
+            func.body += Declaration{elem, input[inputIdx]};
+
+            If fold{idx_0 == 0, {}};
+            fold.body += CommentLines{"fold the Nyquist element into the first one, as",
+                                      "X[0] + i*X[N/2]"};
+            Variable nyquist{"nyquist", "const scalar_type"};
+            fold.body += Declaration{nyquist, input[inputIdx + lengths0 * stride_in0]};
+            fold.body += Assign{
+                elem, ComplexLiteral{elem.x() - nyquist.y(), elem.y() + nyquist.x()}};
+            func.body += fold;
+            func.body += StoreGlobal{output, outputIdx, elem};
+        }
+        else
+        {
+            func.body += CommentLines{"we would unpack at the start of a C2R transform, so it",
+                                      "would never be the last kernel to write to global memory.",
+                                      "don't bother going through the store cb."};
+            func.body += CallbackLoadDeclaration("scalar_type", "cbtype");
+            func.body += CallbackStoreDeclaration("scalar_type", "cbtype");
+
+            Variable z{"z", "const scalar_type"};
+            func.body += Declaration{z, LoadGlobal{input, inputIdx}};
+
+            If copy{idx_0 != 0, {}};
+            copy.body += Assign{output[outputIdx], z};
+            copy.body += Return{};
+            func.body += copy;
+
+            func.body += CommentLines{"with Z = X[0] + i*X[N/2], and both planes Hermitian in the",
+                                      "other dimensions, X[0] = (Z[k] + conj(Z[-k])) / 2 and",
+                                      "X[N/2] = (Z[k] - conj(Z[-k])) / 2i"};
+            Variable inputConjIdx{"inputConjIdx", "auto"};
+            func.body += Declaration{
+                inputConjIdx,
+                Ternary{idx_1 == 0, 0, lengths1 - idx_1} * stride_in1
+                    + Ternary{idx_2 == 0, 0, lengths2 - idx_2} * stride_in2
+                    + idx_batch * ("stride_in" + std::to_string(specs.dim))};
+
+            Variable half{"half", "const real_type_t<scalar_type>"};
+            Variable zc{"zc", "const scalar_type"};
+            func.body += Declaration{half, Literal{"0.5"}};
+            func.body += Declaration{zc, LoadGlobal{input, inputConjIdx}};
+            func.body += Assign{output[outputIdx],
+                                ComplexLiteral{(z.x() + zc.x()) * half, (z.y() - zc.y()) * half}};
+            func.body += Assign{output[outputIdx + lengths0 * stride_out0],
+                                ComplexLiteral{(z.y() + zc.y()) * half, (zc.x() - z.x()) * half}};
+        }
+    }
+    else if(specs.scheme == CS_KERNEL_COPY_HERM_TO_CMPLX)
     {
         Variable input_offset{"input_offset", "auto"};
         func.body += Declaration{input_offset,
@@ -306,6 +458,10 @@ std::string realcomplex_rtc(const std::string& kernel_name, const RealComplexSpe
     case CS_KERNEL_COPY_CMPLX_TO_HERM:
     case CS_KERNEL_COPY_CMPLX_TO_R:
     case CS_KERNEL_COPY_HERM_TO_CMPLX:
+    case CS_KERNEL_PAIR_R_TO_CMPLX:
+    case CS_KERNEL_PAIR_CMPLX_TO_HERM:
+    case CS_KERNEL_PACK_HERM:
+    case CS_KERNEL_UNPACK_HERM:
         return r2c_copy_rtc(kernel_name, specs);
     default:
         throw std::runtime_error("invalid realcomplex rtc scheme");
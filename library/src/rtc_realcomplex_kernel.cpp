@@ -33,7 +33,9 @@ RTCKernel::RTCGenerator RTCKernelRealComplex::generate_from_node(const TreeNode&
     RTCGenerator generator;
 
     if(node.scheme != CS_KERNEL_COPY_R_TO_CMPLX && node.scheme != CS_KERNEL_COPY_CMPLX_TO_HERM
-       && node.scheme != CS_KERNEL_COPY_HERM_TO_CMPLX && node.scheme != CS_KERNEL_COPY_CMPLX_TO_R)
+       && node.scheme != CS_KERNEL_COPY_HERM_TO_CMPLX && node.scheme != CS_KERNEL_COPY_CMPLX_TO_R
+       && node.scheme != CS_KERNEL_PAIR_R_TO_CMPLX && node.scheme != CS_KERNEL_PAIR_CMPLX_TO_HERM
+       && node.scheme != CS_KERNEL_PACK_HERM && node.scheme != CS_KERNEL_UNPACK_HERM)
     {
         return generator;
     }
@@ -43,6 +45,9 @@ RTCKernel::RTCGenerator RTCKernelRealComplex::generate_from_node(const TreeNode&
     // hermitian size is used for hermitian->complex copy
     if(node.scheme == CS_KERNEL_COPY_HERM_TO_CMPLX)
         input_size = node.outputLength[0] / 2 + 1;
+    // pair unpacking writes only the hermitian outputs
+    else if(node.scheme == CS_KERNEL_PAIR_CMPLX_TO_HERM)
+        input_size = node.length[0] / 2 + 1;
 
     size_t elems = std::accumulate(node.length.begin() + 1,
                                    node.length.end(),
@@ -69,7 +74,7 @@ RTCKernel::RTCGenerator RTCKernelRealComplex::generate_from_node(const TreeNode&
         = [=](const std::string& kernel_name) { return realcomplex_rtc(kernel_name, specs); };
 
     generator.construct_rtckernel = [=](const std::string&       kernel_name,
-                                        const std::vector<char>& code,
+                                        const RTCLoadableModule& code,
                                         dim3                     gridDim,
                                         dim3                     blockDim) {
         return std::unique_ptr<RTCKernel>(
@@ -100,10 +105,15 @@ RTCKernelArgs RTCKernelRealComplex::get_launch_args(DeviceCallIn& data)
         size_t hermitian_size = kern_lengths[0] / 2 + 1;
         kargs.append_unsigned_int(hermitian_size);
     }
+    else if(data.node->scheme == CS_KERNEL_PAIR_CMPLX_TO_HERM)
+    {
+        size_t hermitian_size = kern_lengths[0] / 2 + 1;
+        kargs.append_unsigned_int(hermitian_size);
+    }
     kargs.append_unsigned_int(kern_lengths[0]);
     kargs.append_unsigned_int(kern_lengths[1]);
     kargs.append_unsigned_int(kern_lengths[2]);
-    kargs.append_unsigned_int(data.node->batch);
+    kargs.append_unsigned_int(data.get_batch());
     kargs.append_unsigned_int(kern_stride_in[0]);
     kargs.append_unsigned_int(kern_stride_in[1]);
     kargs.append_unsigned_int(kern_stride_in[2]);
@@ -182,7 +192,7 @@ RTCKernel::RTCGenerator RTCKernelRealComplexEven::generate_from_node(const TreeN
         = [=](const std::string& kernel_name) { return realcomplex_even_rtc(kernel_name, specs); };
 
     generator.construct_rtckernel = [=](const std::string&       kernel_name,
-                                        const std::vector<char>& code,
+                                        const RTCLoadableModule& code,
                                         dim3                     gridDim,
                                         dim3                     blockDim) {
         return std::unique_ptr<RTCKernel>(
@@ -203,7 +213,7 @@ RTCKernelArgs RTCKernelRealComplexEven::get_launch_args(DeviceCallIn& data)
     }
     unsigned int higherFFTLengths = product(data.node->length.begin() + 1, data.node->length.end());
     kargs.append_unsigned_int(higherFFTLengths);
-    kargs.append_unsigned_int(data.node->batch);
+    kargs.append_unsigned_int(data.get_batch());
     kargs.append_ptr(data.bufIn[0]);
     if(array_type_is_planar(data.node->inArrayType))
         kargs.append_ptr(data.bufIn[1]);
@@ -294,7 +304,7 @@ RTCKernel::RTCGenerator RTCKernelRealComplexEvenTranspose::generate_from_node(
     };
 
     generator.construct_rtckernel = [=](const std::string&       kernel_name,
-                                        const std::vector<char>& code,
+                                        const RTCLoadableModule& code,
                                         dim3                     gridDim,
                                         dim3                     blockDim) {
         return std::unique_ptr<RTCKernel>(
@@ -18,7 +18,13 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <functional>
+#include <map>
+#include <set>
+#include <stdexcept>
 
 #include "../../shared/array_predicate.h"
 #include "rtc_stockham_gen.h"
@@ -37,9 +43,44 @@ using namespace std::placeholders;
 #include "device/generator/stockham_gen_rr.h"
 
 #include "device/generator/stockham_gen_2d.h"
+#include "device/generator/stockham_gen_3d.h"
 
 #include "device/kernel-generator-embed.h"
 
+static std::string r2r_type_name(rocfft_transform_type type)
+{
+    switch(type)
+    {
+    case rocfft_transform_type_dct1:
+        return "dct1";
+    case rocfft_transform_type_dct2:
+        return "dct2";
+    case rocfft_transform_type_dct3:
+        return "dct3";
+    case rocfft_transform_type_dct4:
+        return "dct4";
+    case rocfft_transform_type_dst1:
+        return "dst1";
+    case rocfft_transform_type_dst2:
+        return "dst2";
+    case rocfft_transform_type_dst3:
+        return "dst3";
+    case rocfft_transform_type_dst4:
+        return "dst4";
+    default:
+        throw std::runtime_error("invalid real-to-real transform type");
+    }
+}
+
+// the last fused Bluestein kernel of a real-to-complex transform
+// writes the Hermitian output, and skips its redundant half
+static bool bluestein_stores_hermitian(BluesteinFuseType fuseBlue, rocfft_array_type outArrayType)
+{
+    return fuseBlue == BFT_INV_CHIRP_MUL
+           && (outArrayType == rocfft_array_type_hermitian_interleaved
+               || outArrayType == rocfft_array_type_hermitian_planar);
+}
+
 // generate name for RTC stockham kernel
 std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
                                      const StockhamGeneratorSpecs& specs2d,
@@ -53,6 +94,7 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
                                      size_t                        largeTwdBase,
                                      size_t                        largeTwdSteps,
                                      bool                          largeTwdBatchIsTransformCount,
+                                     size_t                        largeTwdComputeLength,
                                      EmbeddedType                  ebtype,
                                      DirectRegType                 dir2regMode,
                                      IntrinsicAccessType           intrinsicMode,
@@ -66,13 +108,18 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
 
     if(direction == -1)
         kernel_name += "_fwd";
-    else
+    else if(direction == 1)
         kernel_name += "_back";
+    else
+        kernel_name += "_anydir";
 
     kernel_name += "_len";
     kernel_name += std::to_string(specs.length);
-    if(scheme == CS_KERNEL_2D_SINGLE)
+    if(scheme == CS_KERNEL_2D_SINGLE || scheme == CS_KERNEL_3D_SINGLE)
         kernel_name += "x" + std::to_string(specs2d.length);
+    if(scheme == CS_KERNEL_3D_SINGLE)
+        kernel_name
+            += "x" + std::to_string(product(specs.factors3d.begin(), specs.factors3d.end()));
 
     // need to save the kernel configurations in name,
     kernel_name += "_factors";
@@ -81,7 +128,7 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
         kernel_name += "_";
         kernel_name += std::to_string(f);
     }
-    if(scheme == CS_KERNEL_2D_SINGLE)
+    if(scheme == CS_KERNEL_2D_SINGLE || scheme == CS_KERNEL_3D_SINGLE)
     {
         kernel_name += "_x";
         for(auto f : specs2d.factors)
@@ -90,22 +137,57 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
             kernel_name += std::to_string(f);
         }
     }
+    if(scheme == CS_KERNEL_3D_SINGLE)
+    {
+        kernel_name += "_x";
+        for(auto f : specs.factors3d)
+        {
+            kernel_name += "_";
+            kernel_name += std::to_string(f);
+        }
+    }
     kernel_name += "_wgs_";
     kernel_name += std::to_string(specs.workgroup_size);
     kernel_name += "_tpt_";
     kernel_name += std::to_string(specs.threads_per_transform);
-    if(scheme == CS_KERNEL_2D_SINGLE)
+    if(scheme == CS_KERNEL_2D_SINGLE || scheme == CS_KERNEL_3D_SINGLE)
         kernel_name += "x" + std::to_string(specs2d.threads_per_transform);
+    if(scheme == CS_KERNEL_3D_SINGLE)
+        kernel_name += "x" + std::to_string(specs.threads_per_transform3d);
 
     if(specs.half_lds)
         kernel_name += "_halfLds";
 
+    if(specs.wave_size)
+        kernel_name += "_wave" + std::to_string(specs.wave_size);
+
+    if(specs.vector_width)
+        kernel_name += "_vec" + std::to_string(specs.vector_width);
+
     if(specs.static_dim)
     {
         kernel_name += "_dim";
         kernel_name += std::to_string(specs.static_dim);
     }
 
+    if(specs.index32)
+        kernel_name += "_idx32";
+
+    if(specs.matrix_butterflies)
+        kernel_name += "_mbfly";
+
+    if(specs.pipelined_loads)
+        kernel_name += "_pipe" + std::to_string(StockhamGeneratorSpecs::PIPELINE_TILES);
+
+    if(specs.nontemporal_stores)
+        kernel_name += "_nt";
+
+    if(specs.lds_bank_shift)
+        kernel_name += "_bshift" + std::to_string(specs.lds_bank_shift);
+
+    if(specs.octant_twiddles)
+        kernel_name += "_octtwd";
+
     kernel_name += rtc_precision_name(precision);
 
     if(placement == rocfft_placement_inplace)
@@ -123,6 +205,20 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
     if(unitstride)
         kernel_name += "_unitstride";
 
+    if(!specs.static_lengths.empty())
+    {
+        auto join = [](const std::vector<size_t>& values) {
+            std::string out;
+            for(auto v : values)
+                out += (out.empty() ? "" : "x") + std::to_string(v);
+            return out;
+        };
+        kernel_name += "_layout_" + join(specs.static_lengths);
+        kernel_name += "_is" + join(specs.static_stride_in);
+        if(placement == rocfft_placement_notinplace)
+            kernel_name += "_os" + join(specs.static_stride_out);
+    }
+
     switch(scheme)
     {
     case CS_KERNEL_STOCKHAM:
@@ -138,6 +234,9 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
         // both lengths were already added above, which indicates it's
         // 2D_SINGLE
         break;
+    case CS_KERNEL_3D_SINGLE:
+        // likewise, three lengths indicate 3D_SINGLE
+        break;
     case CS_KERNEL_STOCKHAM_BLOCK_RC:
     {
         kernel_name += "_sbrc";
@@ -174,6 +273,10 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
         break;
     case BFT_INV_CHIRP_MUL:
         kernel_name += "_inv_chirp_mul";
+        // hermitian arrays are named like complex ones, but
+        // real-to-complex Bluestein only stores half of the output
+        if(bluestein_stores_hermitian(fuseBlue, outArrayType))
+            kernel_name += "_herm";
         break;
     }
 
@@ -194,8 +297,15 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
 
     if(largeTwdBase > 0 && largeTwdSteps > 0)
     {
-        kernel_name += "_twdbase" + std::to_string(largeTwdBase);
-        kernel_name += "_" + std::to_string(largeTwdSteps) + "step";
+        // computed twiddles are specialised for the large 1D length
+        // instead of the table layout
+        if(largeTwdComputeLength)
+            kernel_name += "_twdlen" + std::to_string(largeTwdComputeLength);
+        else
+        {
+            kernel_name += "_twdbase" + std::to_string(largeTwdBase);
+            kernel_name += "_" + std::to_string(largeTwdSteps) + "step";
+        }
         if(largeTwdBatchIsTransformCount)
             kernel_name += "_batchcount";
     }
@@ -210,6 +320,16 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
     case EmbeddedType::Real2C_POST:
         kernel_name += "_R2C";
         break;
+    case EmbeddedType::Real2C_ODD:
+        kernel_name += "_R2C_odd";
+        break;
+    case EmbeddedType::C2Real_ODD:
+        kernel_name += "_C2R_odd";
+        break;
+    case EmbeddedType::Real2Real:
+        kernel_name += "_R2R_" + r2r_type_name(specs.r2r_type) + "_"
+                       + std::to_string(specs.r2r_length);
+        break;
     }
 
     if(dir2regMode == DirectRegType::TRY_ENABLE_IF_SUPPORT)
@@ -236,6 +356,571 @@ std::string stockham_rtc_kernel_name(const StockhamGeneratorSpecs& specs,
     return kernel_name;
 }
 
+// odd-length real transforms read real input (forward) or write
+// real output (backward), so change the type of that buffer
+// v * exp(dir * i * pi * r / d), the twiddles that real-to-real
+// kernels apply around their complex FFT.  r is always less than
+// d, so sincospi's argument is in [0, 1).
+static const char* real_to_real_h = R"_SRC(
+template <typename T>
+__device__ T r2r_rotate(const T& v, const size_t r, const size_t d, const int dir)
+{
+    real_type_t<T> s, c;
+    if constexpr(sizeof(real_type_t<T>) == sizeof(double))
+    {
+        double sd, cd;
+        sincospi(static_cast<double>(r) / d, &sd, &cd);
+        s = dir * sd;
+        c = cd;
+    }
+    else
+    {
+        float sf, cf;
+        sincospi(static_cast<float>(r) / d, &sf, &cf);
+        s = dir * sf;
+        c = cf;
+    }
+    return T(v.x * c - v.y * s, v.x * s + v.y * c);
+}
+)_SRC";
+
+struct MakeRealBufferVisitor : public BaseVisitor
+{
+    MakeRealBufferVisitor(const std::string& buf_name)
+        : buf_name(buf_name)
+    {
+    }
+
+    ArgumentList visit_ArgumentList(const ArgumentList& x) override
+    {
+        ArgumentList ret;
+        for(auto arg : x.arguments)
+        {
+            if(arg.name == buf_name)
+                arg.type = "real_type_t<scalar_type>";
+            ret.append(arg);
+        }
+        return ret;
+    }
+
+    std::string buf_name;
+};
+
+// Persistent kernels poll a queue that the host or other kernels
+// write to while the kernel runs, so the queue is accessed at
+// system scope.
+static const char* persistent_queue_h = R"_SRC(
+__device__ unsigned long long persistent_queue_load(const unsigned long long* p)
+{
+    return __hip_atomic_load(p, __ATOMIC_ACQUIRE, __HIP_MEMORY_SCOPE_SYSTEM);
+}
+
+__device__ unsigned int persistent_queue_load(const unsigned int* p)
+{
+    return __hip_atomic_load(p, __ATOMIC_ACQUIRE, __HIP_MEMORY_SCOPE_SYSTEM);
+}
+
+__device__ void persistent_queue_store(unsigned long long* p, unsigned long long v)
+{
+    __hip_atomic_store(p, v, __ATOMIC_RELEASE, __HIP_MEMORY_SCOPE_SYSTEM);
+}
+)_SRC";
+
+// Turn the global function into a device function that a persistent
+// kernel calls for each block of work, passing the block's index
+// instead of using blockIdx
+struct MakePersistentTransformVisitor : public BaseVisitor
+{
+    Function visit_Function(const Function& x) override
+    {
+        auto y          = BaseVisitor::visit_Function(x);
+        y.qualifier     = "__device__";
+        y.launch_bounds = 0;
+        y.templates.arguments.clear();
+        y.arguments.append(Variable{"persistent_block_id", "const unsigned int"});
+        return y;
+    }
+
+    Expression visit_Variable(const Variable& x) override
+    {
+        Variable y{x};
+        if(y.name == "blockIdx.x")
+            y.name = "persistent_block_id";
+        if(y.index)
+            y.index = std::visit(*this, *y.index);
+        if(y.index2D)
+            y.index2D = std::visit(*this, *y.index2D);
+        return y;
+    }
+};
+
+// Generate the persistent kernel that calls the transform function.
+// It takes the transform's arguments, whose buffer pointers are
+// ignored in favour of those in each queue entry, followed by the
+// queue.
+//
+// Each entry has 4 pointers: input, then output, with a second
+// pointer for the imaginary parts of planar data.  Every block of
+// the kernel works through the entries in order, and the last block
+// to finish an entry writes its completion to the slot.
+static std::string persistent_kernel_src(const Function&    transform,
+                                         const std::string& kernel_name,
+                                         unsigned int       workgroup_size)
+{
+    static const std::map<std::string, unsigned int> entry_pointers = {{"buf", 0},
+                                                                       {"bufre", 0},
+                                                                       {"bufim", 1},
+                                                                       {"buf_in", 0},
+                                                                       {"buf_inre", 0},
+                                                                       {"buf_inim", 1},
+                                                                       {"buf_out", 2},
+                                                                       {"buf_outre", 2},
+                                                                       {"buf_outim", 3}};
+
+    ArgumentList kernel_args;
+    std::string  call_args;
+    for(const auto& arg : transform.arguments.arguments)
+    {
+        if(!call_args.empty())
+            call_args += ", ";
+        if(arg.name == "persistent_block_id")
+        {
+            call_args += "block";
+            continue;
+        }
+        kernel_args.append(arg);
+        auto ptr = entry_pointers.find(arg.name);
+        if(ptr == entry_pointers.end())
+        {
+            call_args += arg.name;
+            continue;
+        }
+        call_args += "reinterpret_cast<" + arg.type + "*>(static_cast<char*>(entry["
+                     + std::to_string(ptr->second) + "]) + "
+                     + (ptr->second < 2 ? "queue_in_offset" : "queue_out_offset") + ")";
+    }
+
+    std::string src;
+    src += "extern \"C\" __global__ void __launch_bounds__(" + std::to_string(workgroup_size)
+           + ") " + kernel_name + "(" + kernel_args.render_decl() + ",";
+    src += R"_SRC(
+    void* const*              queue_entries,
+    const unsigned long long* queue_submitted,
+    unsigned long long*       queue_slot_completed,
+    unsigned int*             queue_slot_done,
+    const unsigned int*       queue_stop,
+    const size_t              queue_length,
+    const size_t              queue_in_offset,
+    const size_t              queue_out_offset,
+    const unsigned int        blocks_per_entry)
+{
+    __shared__ void* entry[4];
+    __shared__ bool  stopped;
+    for(unsigned long long k = 0;; ++k)
+    {
+        const size_t slot = k % queue_length;
+
+        // wait for the entry to be submitted, or for the executor to
+        // be stopped
+        if(threadIdx.x == 0)
+        {
+            stopped = false;
+            while(persistent_queue_load(queue_submitted) <= k)
+            {
+                if(persistent_queue_load(queue_stop))
+                {
+                    stopped = true;
+                    break;
+                }
+                __builtin_amdgcn_s_sleep(1);
+            }
+            if(!stopped)
+            {
+                for(unsigned int i = 0; i < 4; ++i)
+                    entry[i] = queue_entries[4 * slot + i];
+            }
+        }
+        __syncthreads();
+        if(stopped)
+            return;
+
+        for(unsigned int block = blockIdx.x; block < blocks_per_entry; block += gridDim.x)
+        {
+            )_SRC";
+    src += transform.name + "(" + call_args + ");";
+    src += R"_SRC(
+            __syncthreads();
+        }
+
+        if(threadIdx.x == 0)
+        {
+            __threadfence_system();
+            if(atomicAdd(queue_slot_done + slot, 1u) == gridDim.x - 1)
+            {
+                queue_slot_done[slot] = 0;
+                persistent_queue_store(queue_slot_completed + slot, k + 1);
+            }
+        }
+    }
+}
+)_SRC";
+    return src;
+}
+
+// Turn the global function into a device function that a fused
+// kernel calls for each block of one phase.  The caller passes the
+// block and thread index within the phase, and the part of the
+// fused kernel's LDS that the block may use.
+struct MakeFusedPhaseVisitor : public BaseVisitor
+{
+    Function visit_Function(const Function& x) override
+    {
+        auto y          = BaseVisitor::visit_Function(x);
+        y.name          = "run_block";
+        y.qualifier     = "__device__";
+        y.launch_bounds = 0;
+        y.templates.arguments.clear();
+        y.arguments.append(Variable{"fused_block_id", "const unsigned int"});
+        y.arguments.append(Variable{"fused_thread_id", "const unsigned int"});
+        y.arguments.append(Variable{"fused_lds", "unsigned char", true});
+        return y;
+    }
+
+    StatementList visit_LDSDeclaration(const LDSDeclaration& x) override
+    {
+        auto real_type = "real_type_t<" + x.scalar_type + ">";
+
+        StatementList stmts;
+        stmts += Declaration{Variable{"lds_real", real_type, true},
+                             Literal{"reinterpret_cast<" + real_type + "*>(fused_lds)"}};
+        stmts += Declaration{Variable{"lds_complex", x.scalar_type, true},
+                             Literal{"reinterpret_cast<" + x.scalar_type + "*>(fused_lds)"}};
+        return stmts;
+    }
+
+    Expression visit_Variable(const Variable& x) override
+    {
+        Variable y{x};
+        if(y.name == "blockIdx.x")
+            y.name = "fused_block_id";
+        else if(y.name == "threadIdx.x")
+            y.name = "fused_thread_id";
+        if(y.index)
+            y.index = std::visit(*this, *y.index);
+        if(y.index2D)
+            y.index2D = std::visit(*this, *y.index2D);
+        return y;
+    }
+};
+
+static const char* fused_barrier_h = R"_SRC(
+// wait for every block of the grid to arrive at the barrier.  the
+// counter starts at zero, and the nth barrier of the kernel waits
+// for it to reach n * gridDim.x.
+__device__ void fused_grid_barrier(unsigned int* counter, unsigned int target)
+{
+    __syncthreads();
+    if(threadIdx.x == 0)
+    {
+        __threadfence();
+        atomicAdd(counter, 1u);
+        while(__hip_atomic_load(counter, __ATOMIC_ACQUIRE, __HIP_MEMORY_SCOPE_AGENT) < target)
+            __builtin_amdgcn_s_sleep(1);
+    }
+    __syncthreads();
+    __threadfence();
+}
+)_SRC";
+
+std::string stockham_fused_rtc(const std::string&                     kernel_name,
+                               rocfft_precision                       precision,
+                               const std::vector<StockhamFusedPhase>& phases)
+{
+    std::vector<unsigned int> all_factors;
+    unsigned int              workgroup_size = 0;
+    for(const auto& phase : phases)
+    {
+        all_factors.insert(all_factors.end(), phase.factors.begin(), phase.factors.end());
+        workgroup_size = std::max(workgroup_size, phase.workgroup_size);
+    }
+
+    std::string src;
+    src += rocfft_complex_h;
+    src += common_h;
+    src += memory_gfx_h;
+    src += callback_h;
+    src += butterfly_constant_h;
+    if(std::any_of(phases.begin(), phases.end(), [](const StockhamFusedPhase& phase) {
+           return phase.large_twiddles;
+       }))
+        src += large_twiddles_h;
+    append_radix_h(src, all_factors);
+    if(std::any_of(phases.begin(), phases.end(), [](const StockhamFusedPhase& phase) {
+           return phase.real_complex;
+       }))
+        src += real2complex_device_h;
+    src += rtc_precision_type_decl(precision);
+    src += fused_barrier_h;
+    for(const auto& phase : phases)
+        src += phase.src;
+
+    // the output of one phase is the input of the next, so the
+    // kernel's buffer arguments must not be restrict
+    ArgumentList             kernel_args;
+    std::vector<std::string> call_args(phases.size());
+    for(size_t i = 0; i < phases.size(); ++i)
+    {
+        for(auto arg : phases[i].arguments.arguments)
+        {
+            arg.name     = "phase" + std::to_string(i) + "_" + arg.name;
+            arg.restrict = false;
+            kernel_args.append(arg);
+            call_args[i] += arg.name + ", ";
+        }
+    }
+
+    src += "extern \"C\" __global__ void __launch_bounds__(" + std::to_string(workgroup_size)
+           + ") " + kernel_name + "(" + kernel_args.render_decl() + ",\n"
+           + "unsigned int* fused_barrier";
+    for(size_t i = 0; i < phases.size(); ++i)
+    {
+        auto phase_name = "phase" + std::to_string(i);
+        src += ",\nconst unsigned int " + phase_name + "_blocks";
+        src += ",\nconst unsigned int " + phase_name + "_lds_bytes";
+    }
+    src += ")\n{\n";
+    src += "extern __shared__ unsigned char __attribute__((aligned(16))) fused_lds[];\n";
+
+    // each block of the fused kernel does workgroup_size /
+    // phase.workgroup_size of a phase's blocks at a time.  a block
+    // that runs out of work repeats the phase's last block, so that
+    // every thread reaches the same barriers.
+    for(size_t i = 0; i < phases.size(); ++i)
+    {
+        auto phase_name = "phase" + std::to_string(i);
+        auto sub_blocks = std::to_string(workgroup_size / phases[i].workgroup_size);
+        auto phase_wgs  = std::to_string(phases[i].workgroup_size);
+        if(i > 0)
+            src += "fused_grid_barrier(fused_barrier, " + std::to_string(i) + " * gridDim.x);\n";
+        src += "for(unsigned int block = blockIdx.x * " + sub_blocks + "; block < " + phase_name
+               + "_blocks; block += gridDim.x * " + sub_blocks + ")\n{\n";
+        src += "const unsigned int sub_block = threadIdx.x / " + phase_wgs + ";\n";
+        src += "const unsigned int tile = block + sub_block < " + phase_name
+               + "_blocks ? block + sub_block : " + phase_name + "_blocks - 1;\n";
+        src += phases[i].name + "::run_block(" + call_args[i] + "tile, threadIdx.x % " + phase_wgs
+               + ", fused_lds + sub_block * " + phase_name + "_lds_bytes);\n";
+        src += "__syncthreads();\n}\n";
+    }
+    src += "}\n";
+    return src;
+}
+
+// Read each transform's offsets from tables indexed by its batch,
+// instead of multiplying the batch by the distance between
+// transforms, so that a grouped kernel's transforms can be placed
+// anywhere in their buffers.
+struct MakeGroupedVisitor : public BaseVisitor
+{
+    Variable offsets_in{"group_offsets_in", "const size_t", true, true};
+    Variable offsets_out{"group_offsets_out", "const size_t", true, true};
+
+    Function visit_Function(const Function& x) override
+    {
+        auto y = BaseVisitor::visit_Function(x);
+        y.arguments.append(offsets_in);
+        y.arguments.append(offsets_out);
+        return y;
+    }
+
+    Expression visit_Multiply(const Multiply& x) override
+    {
+        if(x.args.size() == 2)
+        {
+            auto batch = std::get_if<Variable>(&x.args[0]);
+            auto dist  = std::get_if<Variable>(&x.args[1]);
+            if(batch && dist && batch->name == "batch" && dist->index)
+            {
+                if(dist->name == "stride" || dist->name == "stride_in")
+                    return offsets_in[*batch];
+                if(dist->name == "stride_out")
+                    return offsets_out[*batch];
+            }
+        }
+        return BaseVisitor::visit_Multiply(x);
+    }
+};
+
+// Read each transform's buffers from arrays of pointers indexed by
+// its batch, instead of offsetting one buffer by the batch times the
+// distance between transforms, so that a pointer-array kernel's
+// transforms can each be in an allocation of their own.
+struct MakePointerArrayVisitor : public BaseVisitor
+{
+    Variable batch{"batch", "size_t"};
+    Variable nbatch{"nbatch", "const size_t"};
+
+    static bool is_buffer(const std::string& name)
+    {
+        return name == "buf" || name == "buf_in" || name == "buf_out";
+    }
+
+    // the array of pointers that replaces a buffer argument
+    static Variable pointers(const Variable& buffer)
+    {
+        return Variable{buffer.name + "_ptrs", buffer.type + "* const", true, true};
+    }
+
+    Function visit_Function(const Function& x) override
+    {
+        auto y = BaseVisitor::visit_Function(x);
+        ArgumentList arguments;
+        for(const auto& arg : x.arguments.arguments)
+            arguments.append(is_buffer(arg.name) ? pointers(arg) : arg);
+        y.arguments = arguments;
+        return y;
+    }
+
+    Expression visit_Variable(const Variable& x) override
+    {
+        // threads past the last transform don't access memory, but
+        // still need a pointer to compute addresses from
+        if(is_buffer(x.name) && !x.index)
+            return pointers(x)[Ternary{Parens{batch < nbatch}, batch, Literal{"0"}}];
+        return BaseVisitor::visit_Variable(x);
+    }
+
+    Expression visit_Multiply(const Multiply& x) override
+    {
+        if(x.args.size() == 2)
+        {
+            auto batch = std::get_if<Variable>(&x.args[0]);
+            auto dist  = std::get_if<Variable>(&x.args[1]);
+            if(batch && dist && batch->name == "batch" && dist->index
+               && (dist->name == "stride" || dist->name == "stride_in"
+                   || dist->name == "stride_out"))
+                return Literal{"0"};
+        }
+        return BaseVisitor::visit_Multiply(x);
+    }
+};
+
+// Replace array arguments of a global function with constant
+// local arrays, so that the function's index math on them can be
+// folded at compile time.
+struct MakeStaticArraysVisitor : public BaseVisitor
+{
+    explicit MakeStaticArraysVisitor(const std::map<std::string, std::vector<size_t>>& arrays)
+        : arrays(arrays)
+    {
+    }
+
+    Function visit_Function(const Function& x) override
+    {
+        auto y = BaseVisitor::visit_Function(x);
+
+        ArgumentList  arguments;
+        StatementList body;
+        for(const auto& arg : y.arguments.arguments)
+        {
+            auto array = arrays.find(arg.name);
+            if(array == arrays.end())
+            {
+                arguments.append(arg);
+                continue;
+            }
+            std::string values;
+            for(auto v : array->second)
+                values += (values.empty() ? "" : ", ") + std::to_string(v);
+            body += Declaration{
+                Variable{arg.name + "[" + std::to_string(array->second.size()) + "]",
+                         "const size_t"},
+                Literal{"{" + values + "}"}};
+        }
+        body += y.body;
+
+        y.arguments = arguments;
+        y.body      = body;
+        return y;
+    }
+
+    std::map<std::string, std::vector<size_t>> arrays;
+};
+
+// Do a global function's index math in 32-bit integers, by
+// narrowing the locals that hold offsets and indexes and the length,
+// stride and batch values they're computed from.  Only valid if
+// every offset the function computes fits in 32 bits.
+struct MakeIndex32Visitor : public BaseVisitor
+{
+    // locals that are computed from lengths and strides, without
+    // any out-of-place "_in" or "_out" suffix
+    const std::set<std::string> index_names = {"batch",
+                                               "batch0",
+                                               "dim",
+                                               "global_data_id",
+                                               "global_load_data_offset",
+                                               "global_load_transf_offset",
+                                               "global_store_data_offset",
+                                               "global_store_transf_offset",
+                                               "global_transf_id",
+                                               "index_along_d",
+                                               "num_of_tiles",
+                                               "offset",
+                                               "plength",
+                                               "remaining",
+                                               "stride0",
+                                               "tile_index",
+                                               "tile_length",
+                                               "trans_local",
+                                               "transform"};
+    // arguments those locals are computed from
+    const std::set<std::string> array_names = {"lengths", "stride", "stride_in", "stride_out"};
+
+    bool is_index(std::string name) const
+    {
+        for(const std::string suffix : {"_in", "_out"})
+        {
+            if(name.size() > suffix.size()
+               && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0)
+            {
+                name.resize(name.size() - suffix.size());
+                break;
+            }
+        }
+        return index_names.count(name) != 0;
+    }
+
+    // only visit the body, since arguments keep their types
+    Function visit_Function(const Function& x) override
+    {
+        Function y{x};
+        y.body = visit_StatementList(x.body);
+        return y;
+    }
+
+    StatementList visit_Declaration(const Declaration& x) override
+    {
+        Declaration y{x};
+        if(!x.var.pointer && is_index(x.var.name))
+        {
+            if(x.var.type == "size_t")
+                y.var.type = "unsigned int";
+            else if(x.var.type == "const size_t")
+                y.var.type = "const unsigned int";
+        }
+        if(x.value)
+            y.value = std::visit(*this, *x.value);
+        return {y};
+    }
+
+    Expression visit_Variable(const Variable& x) override
+    {
+        if((x.index && array_names.count(x.name)) || x.name == "nbatch")
+            return CallExpr{"static_cast<unsigned int>", {x}};
+        return x;
+    }
+};
+
 std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
                          const StockhamGeneratorSpecs& specs2d,
                          unsigned int*                 transforms_per_block,
@@ -250,6 +935,7 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
                          size_t                        largeTwdBase,
                          size_t                        largeTwdSteps,
                          bool                          largeTwdBatchIsTransformCount,
+                         size_t                        largeTwdComputeLength,
                          EmbeddedType                  ebtype,
                          DirectRegType                 dir2regMode,
                          IntrinsicAccessType           intrinsicMode,
@@ -257,10 +943,15 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
                          CallbackType                  cbtype,
                          const BluesteinFuseType&      fuseBlue,
                          const LoadOps&                loadOps,
-                         const StoreOps&               storeOps)
+                         const StoreOps&               storeOps,
+                         bool                          persistent,
+                         bool                          grouped,
+                         bool                          pointer_array,
+                         StockhamFusedPhase*           fused_phase)
 {
     std::unique_ptr<Function> lds2reg, reg2lds, device;
     std::unique_ptr<Function> lds2reg1, reg2lds1, device1;
+    std::unique_ptr<Function> lds2reg2, reg2lds2, device2;
     std::unique_ptr<Function> bluestein_load, bluestein_intrinsic_load;
     std::unique_ptr<Function> bluestein_store, bluestein_intrinsic_store;
     std::unique_ptr<Function> global;
@@ -293,6 +984,49 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
         all_factors.insert(
             all_factors.end(), kernel.kernel1.factors.begin(), kernel.kernel1.factors.end());
     }
+    else if(scheme == CS_KERNEL_3D_SINGLE)
+    {
+        // the third dimension is described by specs' 3D fields
+        StockhamGeneratorSpecs specs3d(specs.factors3d,
+                                       {},
+                                       specs.precisions,
+                                       specs.threads_per_transform3d,
+                                       specs.scheme);
+        specs3d.threads_per_transform = specs.threads_per_transform3d;
+        specs3d.half_lds              = specs.half_lds;
+        specs3d.static_dim            = specs.static_dim;
+        specs3d.wgs_is_derived        = true;
+
+        StockhamKernelFused3D kernel(specs, specs2d, specs3d);
+        if(transforms_per_block)
+            *transforms_per_block = kernel.transforms_per_block;
+        lds2reg = std::make_unique<Function>(kernel.kernel0.generate_lds_to_reg_input_function());
+        reg2lds
+            = std::make_unique<Function>(kernel.kernel0.generate_lds_from_reg_output_function());
+        device = std::make_unique<Function>(kernel.kernel0.generate_device_function());
+        // device functions are named by length, so only generate
+        // them once per distinct length
+        if(kernel.kernel1.length != kernel.kernel0.length)
+        {
+            lds2reg1
+                = std::make_unique<Function>(kernel.kernel1.generate_lds_to_reg_input_function());
+            reg2lds1 = std::make_unique<Function>(
+                kernel.kernel1.generate_lds_from_reg_output_function());
+            device1 = std::make_unique<Function>(kernel.kernel1.generate_device_function());
+        }
+        if(kernel.kernel2.length != kernel.kernel0.length
+           && kernel.kernel2.length != kernel.kernel1.length)
+        {
+            lds2reg2
+                = std::make_unique<Function>(kernel.kernel2.generate_lds_to_reg_input_function());
+            reg2lds2 = std::make_unique<Function>(
+                kernel.kernel2.generate_lds_from_reg_output_function());
+            device2 = std::make_unique<Function>(kernel.kernel2.generate_device_function());
+        }
+        global = std::make_unique<Function>(kernel.generate_global_function());
+
+        all_factors = kernel.launcher_factors();
+    }
     else
     {
         std::unique_ptr<StockhamKernel> kernel;
@@ -322,18 +1056,20 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
         if(fuseBluestein)
         {
             auto planar_blue_load = array_type_is_planar(inArrayType);
+            auto real_blue_load   = inArrayType == rocfft_array_type_real;
             bluestein_load = std::make_unique<Function>(generate_bluestein_device_load_function(
-                scheme, fuseBlue, direction, planar_blue_load, false));
+                scheme, fuseBlue, direction, planar_blue_load, false, real_blue_load));
             bluestein_intrinsic_load
                 = std::make_unique<Function>(generate_bluestein_device_load_function(
-                    scheme, fuseBlue, direction, planar_blue_load, true));
+                    scheme, fuseBlue, direction, planar_blue_load, true, real_blue_load));
 
-            auto planar_blue_store = array_type_is_planar(outArrayType);
+            auto planar_blue_store    = array_type_is_planar(outArrayType);
+            auto hermitian_blue_store = bluestein_stores_hermitian(fuseBlue, outArrayType);
             bluestein_store = std::make_unique<Function>(generate_bluestein_device_store_function(
-                scheme, fuseBlue, direction, planar_blue_store, false));
+                scheme, fuseBlue, direction, planar_blue_store, false, hermitian_blue_store));
             bluestein_intrinsic_store
                 = std::make_unique<Function>(generate_bluestein_device_store_function(
-                    scheme, fuseBlue, direction, planar_blue_store, true));
+                    scheme, fuseBlue, direction, planar_blue_store, true, hermitian_blue_store));
         }
 
         global = std::make_unique<Function>(kernel->generate_global_function());
@@ -349,11 +1085,11 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
         *device = make_inverse(*device);
         if(device1)
             *device1 = make_inverse(*device1);
+        if(device2)
+            *device2 = make_inverse(*device2);
         *global = make_inverse(*global);
     }
 
-    make_load_store_ops(*global, loadOps, storeOps);
-
     if(placement == rocfft_placement_notinplace)
     {
         *global = make_outofplace(*global);
@@ -361,32 +1097,82 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
             *global = make_planar(*global, "buf_in");
         if(array_type_is_planar(outArrayType))
             *global = make_planar(*global, "buf_out");
+        if(specs.odd_real_direction != 0)
+        {
+            MakeRealBufferVisitor visitor{specs.odd_real_direction == -1 ? "buf_in" : "buf_out"};
+            *global = visitor(*global);
+        }
+        if(specs.is_real_to_real())
+        {
+            *global = MakeRealBufferVisitor{"buf_in"}(*global);
+            *global = MakeRealBufferVisitor{"buf_out"}(*global);
+        }
+        // fused Bluestein kernels of real-to-complex transforms read
+        // the real input directly
+        if(fuseBluestein && inArrayType == rocfft_array_type_real)
+            *global = MakeRealBufferVisitor{"buf_in"}(*global);
     }
     else
     {
         if(array_type_is_planar(inArrayType))
             *global = make_planar(*global, "buf");
+        if(specs.is_real_to_real())
+            *global = MakeRealBufferVisitor{"buf"}(*global);
     }
 
+    if(!specs.static_lengths.empty())
+    {
+        std::map<std::string, std::vector<size_t>> arrays = {{"lengths", specs.static_lengths}};
+        if(placement == rocfft_placement_notinplace)
+        {
+            arrays["stride_in"]  = specs.static_stride_in;
+            arrays["stride_out"] = specs.static_stride_out;
+        }
+        else
+            arrays["stride"] = specs.static_stride_in;
+        *global = MakeStaticArraysVisitor{arrays}(*global);
+    }
+
+    if(specs.index32)
+        *global = MakeIndex32Visitor{}(*global);
+
+    // direction 0 means the direction is a kernel argument.
+    // conjugate the raw buffer accesses before ops are applied, so
+    // ops see the same values as in a kernel built for one direction.
+    if(direction == 0)
+        *global = make_runtime_direction(*global);
+
+    // apply ops once input and output buffers are separate, since
+    // they can be stored in different formats
+    make_load_store_ops(*global, loadOps, storeOps);
+
     if(fuseBluestein)
         *global = make_bluestein(scheme, fuseBlue, *global);
 
-    // start off with includes
+    // start off with includes.  a fused kernel includes them once
+    // for all of its phases.
     std::string src;
-    src += rocfft_complex_h;
-    src += common_h;
-    src += memory_gfx_h;
-    src += callback_h;
-    src += butterfly_constant_h;
+    if(!fused_phase)
+    {
+        if(specs.nontemporal_stores)
+            src += "#define ROCFFT_NONTEMPORAL_STORES\n";
+        src += rocfft_complex_h;
+        src += common_h;
+        src += memory_gfx_h;
+        src += callback_h;
+        src += butterfly_constant_h;
 
-    // only SBCCs need this
-    if(scheme == CS_KERNEL_STOCKHAM_BLOCK_CC)
-        src += large_twiddles_h;
-    // append the neccessary functions only
-    append_radix_h(src, all_factors);
-    // SBCCs don't need this
-    if(scheme != CS_KERNEL_STOCKHAM_BLOCK_CC)
-        src += real2complex_device_h;
+        // only SBCCs and kernels with octant twiddle tables need this
+        if(scheme == CS_KERNEL_STOCKHAM_BLOCK_CC || specs.octant_twiddles)
+            src += large_twiddles_h;
+        // append the neccessary functions only
+        append_radix_h(src, all_factors);
+        // SBCCs don't need this
+        if(scheme != CS_KERNEL_STOCKHAM_BLOCK_CC)
+            src += real2complex_device_h;
+        if(specs.is_real_to_real())
+            src += real_to_real_h;
+    }
 
     src += lds2reg->render();
     src += reg2lds->render();
@@ -397,6 +1183,12 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
         src += reg2lds1->render();
     if(device1)
         src += device1->render();
+    if(lds2reg2)
+        src += lds2reg2->render();
+    if(reg2lds2)
+        src += reg2lds2->render();
+    if(device2)
+        src += device2->render();
     if(bluestein_load)
         src += bluestein_load->render();
     if(bluestein_intrinsic_load)
@@ -408,7 +1200,8 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
 
     // make_rtc removes templates from global function - add typedefs
     // and constants to replace them
-    src += rtc_precision_type_decl(precision);
+    if(!fused_phase)
+        src += rtc_precision_type_decl(precision);
     if(unit_stride)
         src += "static const StrideBin sb = SB_UNIT;\n";
     else
@@ -425,6 +1218,15 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
     case EmbeddedType::C2Real_PRE:
         src += "static const EmbeddedType ebtype = EmbeddedType::C2Real_PRE;\n";
         break;
+    case EmbeddedType::Real2C_ODD:
+        src += "static const EmbeddedType ebtype = EmbeddedType::Real2C_ODD;\n";
+        break;
+    case EmbeddedType::C2Real_ODD:
+        src += "static const EmbeddedType ebtype = EmbeddedType::C2Real_ODD;\n";
+        break;
+    case EmbeddedType::Real2Real:
+        src += "static const EmbeddedType ebtype = EmbeddedType::Real2Real;\n";
+        break;
     }
 
     // SBRC-specific template parameters that are ignored for other kernels
@@ -473,8 +1275,10 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
     src += "static const bool apply_large_twiddle = ";
     src += (largeTwdBase > 0 && largeTwdSteps > 0) ? "true;\n" : "false;\n";
 
-    // callback kernels need to disable buffer load/store
-    if(cbtype != CallbackType::NONE || dir2regMode == DirectRegType::FORCE_OFF_OR_NOT_SUPPORT)
+    // callback kernels need to disable buffer load/store.  so do
+    // pointer-array kernels, whose buffers differ between threads.
+    if(cbtype != CallbackType::NONE || dir2regMode == DirectRegType::FORCE_OFF_OR_NOT_SUPPORT
+       || pointer_array)
         intrinsicMode = IntrinsicAccessType::DISABLE_BOTH;
 
     switch(intrinsicMode)
@@ -495,11 +1299,144 @@ std::string stockham_rtc(const StockhamGeneratorSpecs& specs,
 
     src += "static const size_t large_twiddle_base = " + std::to_string(largeTwdBase) + ";\n";
     src += "static const size_t large_twiddle_steps = " + std::to_string(largeTwdSteps) + ";\n";
+    src += "static const size_t large_twiddle_length = " + std::to_string(largeTwdComputeLength)
+           + ";\n";
 
     *global = make_callback_realcomplex(*global, cbtype);
 
+    // only single-kernel transforms find their batch's offset in
+    // one place
+    if(grouped)
+    {
+        if(scheme != CS_KERNEL_STOCKHAM)
+            throw std::runtime_error("grouped kernels must be CS_KERNEL_STOCKHAM");
+        *global = MakeGroupedVisitor{}(*global);
+    }
+    if(pointer_array)
+    {
+        if(scheme != CS_KERNEL_STOCKHAM)
+            throw std::runtime_error("pointer-array kernels must be CS_KERNEL_STOCKHAM");
+        *global = MakePointerArrayVisitor{}(*global);
+    }
+
+    if(fused_phase)
+    {
+        if(persistent || specs.is_real_to_real())
+            throw std::runtime_error("unsupported fused kernel phase");
+        fused_phase->name           = kernel_name;
+        fused_phase->arguments      = global->arguments;
+        fused_phase->workgroup_size = global->launch_bounds;
+        fused_phase->factors        = all_factors;
+        fused_phase->large_twiddles
+            = scheme == CS_KERNEL_STOCKHAM_BLOCK_CC || specs.octant_twiddles;
+        fused_phase->real_complex = scheme != CS_KERNEL_STOCKHAM_BLOCK_CC;
+
+        src += MakeFusedPhaseVisitor{}(*global).render();
+        fused_phase->src = "namespace " + kernel_name + "\n{\n" + src + "}\n";
+        return fused_phase->src;
+    }
+
+    if(persistent)
+    {
+        src += persistent_queue_h;
+        auto transform = MakePersistentTransformVisitor{}(*global);
+        transform.name = kernel_name + "_transform";
+        src += transform.render();
+        src += persistent_kernel_src(transform, kernel_name, global->launch_bounds);
+        return src;
+    }
+
     *global = make_rtc(*global, kernel_name);
     src += global->render();
     write_standalone_test_harness(*global, src);
     return src;
 }
+
+// Compute the twiddle table for a Stockham transform's passes on the
+// host, the same way the twiddle kernel fills it on the device.
+// Pass p uses (width - 1) twiddles for each of the cumulative
+// product of the previous widths.
+static std::vector<std::pair<double, double>>
+    stockham_twiddle_values(const std::vector<unsigned int>& factors)
+{
+    std::vector<std::pair<double, double>> table;
+    size_t                                 L = factors.front();
+    for(size_t p = 1; p < factors.size(); ++p)
+    {
+        auto radix = factors[p];
+        L *= radix;
+        for(size_t k = 0; k < L / radix; ++k)
+        {
+            double theta = -6.283185307179586476925286766559 * k / L;
+            for(size_t j = 1; j < radix; ++j)
+                table.emplace_back(cos(j * theta), sin(j * theta));
+        }
+    }
+    return table;
+}
+
+std::string stockham_device_function_rtc(const StockhamGeneratorSpecs& specs,
+                                         const std::string&            function_name,
+                                         int                           direction,
+                                         rocfft_precision              precision,
+                                         unsigned int&                 threads_per_transform)
+{
+    StockhamKernelRR kernel(specs);
+    threads_per_transform = kernel.threads_per_transform;
+
+    auto lds2reg = kernel.generate_lds_to_reg_input_function();
+    auto reg2lds = kernel.generate_lds_from_reg_output_function();
+    auto device  = kernel.generate_device_function();
+    if(direction == 1)
+        device = make_inverse(device);
+
+    // the common headers have include guards, but everything else is
+    // specific to this transform, so it goes in a namespace.  then
+    // several of these functions can be compiled together.
+    const std::string impl = function_name + "_impl";
+
+    std::string src;
+    src += rocfft_complex_h;
+    src += common_h;
+    src += butterfly_constant_h;
+
+    src += "namespace " + impl + " {\n";
+    src += rtc_precision_type_decl(precision);
+    append_radix_h(src, kernel.factors);
+    src += lds2reg.render();
+    src += reg2lds.render();
+    src += device.render();
+
+    // hex floats keep the table's values exact until they're
+    // converted to the transform's precision
+    auto twiddles = stockham_twiddle_values(kernel.factors);
+    if(twiddles.empty())
+        twiddles.emplace_back(1.0, 0.0);
+    src += "__device__ const scalar_type twiddles[] = {\n";
+    char value[96];
+    for(const auto& t : twiddles)
+    {
+        snprintf(value, sizeof(value), "    scalar_type(%a, %a),\n", t.first, t.second);
+        src += value;
+    }
+    src += "};\n";
+    src += "}\n";
+
+    const std::string length = std::to_string(kernel.length);
+    const std::string nregs  = std::to_string(kernel.nregisters);
+    src += "__device__ void " + function_name + "(" + impl
+           + "::scalar_type* lds, unsigned int thread)\n";
+    src += "{\n";
+    src += "    using " + impl + "::scalar_type;\n";
+    src += "    scalar_type R[" + nregs + "];\n";
+    src += "    " + impl + "::lds_to_reg_input_length" + length
+           + "_device<scalar_type, SB_UNIT>(R, lds, 1, 0, thread, true);\n";
+    src += "    " + impl + "::" + device.name
+           + "<scalar_type, false, SB_UNIT, true, false>(R, "
+             "reinterpret_cast<real_type_t<scalar_type>*>(lds), lds, "
+           + impl + "::twiddles, 1, 0, thread, true);\n";
+    src += "    " + impl + "::lds_from_reg_output_length" + length
+           + "_device<scalar_type, SB_UNIT>(R, lds, 1, 0, thread, true);\n";
+    src += "}\n";
+    return src;
+}
@@ -18,19 +18,94 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 // THE SOFTWARE.
 
+#include <algorithm>
+#include <limits>
 #include <optional>
 
+#include "../../shared/environment.h"
 #include "function_pool.h"
 #include "kernel_launch.h"
+#include "logging.h"
+#include "plan_create_times.h"
+#include "rtc_cache.h"
+#include "rtc_compile_scheduler.h"
 #include "rtc_stockham_gen.h"
 #include "rtc_stockham_kernel.h"
 #include "tree_node.h"
 
 #include "device/kernel-generator-embed.h"
 
-RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&    node,
-                                                              const std::string& gpu_arch,
-                                                              bool               enable_callbacks)
+// Return how many complex elements a 1D kernel with one thread per
+// transform can move in each 128-bit global access for this node, or
+// 0 if it must access global memory one element at a time.  The
+// generated kernel still checks pointer alignment at runtime, this
+// just decides if a vectorised variant is worth building.
+static unsigned int stockham_vector_width(const TreeNode&  node,
+                                          const FFTKernel& kernel,
+                                          bool             enable_callbacks)
+{
+    if(node.scheme != CS_KERNEL_STOCKHAM || kernel.threads_per_transform[0] != 1
+       || kernel.aot_rtc || node.ebtype != EmbeddedType::NONE
+       || node.dir2regMode != DirectRegType::TRY_ENABLE_IF_SUPPORT
+       || node.GetCallbackType(enable_callbacks) != CallbackType::NONE
+       || node.fuseBlue != BluesteinFuseType::BFT_NONE || node.loadOps.enabled()
+       || node.storeOps.enabled())
+        return 0;
+    if(node.inArrayType != rocfft_array_type_complex_interleaved
+       || node.outArrayType != rocfft_array_type_complex_interleaved)
+        return 0;
+
+    // double-precision elements are already 128 bits wide
+    unsigned int width = 0;
+    if(node.precision == rocfft_precision_single)
+        width = 2;
+    else if(node.precision == rocfft_precision_half)
+        width = 4;
+    else
+        return 0;
+
+    // elements must be contiguous, and every transform must start
+    // as aligned as the first one
+    if(node.length[0] % width != 0 || node.inStride[0] != 1 || node.outStride[0] != 1
+       || node.iDist % width != 0 || node.oDist % width != 0)
+        return 0;
+    for(size_t i = 1; i < node.length.size(); ++i)
+    {
+        if(node.inStride[i] % width != 0 || node.outStride[i] % width != 0)
+            return 0;
+    }
+    return width;
+}
+
+// Return true if every offset and index a node's kernel computes
+// fits in 32 bits.  Lengths of either the input or output are
+// counted, since real-complex kernels read and write different
+// lengths.
+static bool stockham_fits_index32(const TreeNode& node)
+{
+    size_t count      = node.batch;
+    size_t in_extent  = (node.batch - 1) * node.iDist + 1;
+    size_t out_extent = (node.batch - 1) * node.oDist + 1;
+    for(size_t i = 0; i < node.length.size(); ++i)
+    {
+        size_t len = node.length[i];
+        if(i < node.outputLength.size())
+            len = std::max(len, node.outputLength[i]);
+        count *= len;
+        in_extent += (len - 1) * node.inStride[i];
+        out_extent += (len - 1) * node.outStride[i];
+    }
+    const size_t limit = std::numeric_limits<unsigned int>::max();
+    return count <= limit && in_extent <= limit && out_extent <= limit;
+}
+
+RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&     node,
+                                                              const std::string&  gpu_arch,
+                                                              bool                enable_callbacks,
+                                                              bool                persistent,
+                                                              bool                grouped,
+                                                              bool                pointer_array,
+                                                              StockhamFusedPhase* fused_phase)
 {
     RTCStockhamGenerator generator;
     function_pool&       pool = function_pool::get_function_pool();
@@ -38,6 +113,10 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
     std::optional<StockhamGeneratorSpecs> specs;
     std::optional<StockhamGeneratorSpecs> specs2d;
 
+    // grouped and pointer-array kernels find each batch's data
+    // through tables, rather than at a multiple of the distance
+    const bool batch_table = grouped || pointer_array;
+
     // SBRC variants look in the function pool for plain BLOCK_RC to
     // learn the block width, then decide on the transpose type once
     // that's known.
@@ -74,10 +153,15 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
         // the generator as-is
         kernel = pool.get_kernel(key);
         // if a kernel is already precompiled, just use that.  but
-        // changing largeTwdBatch transform count requires RTC, so we
-        // can't use a precompiled kernel in that case.
-        if(kernel->device_function && !node.loadOps.enabled() && !node.storeOps.enabled()
-           && !node.largeTwdBatchIsTransformCount)
+        // changing largeTwdBatch transform count or computing large
+        // twiddles requires RTC, so we can't use a precompiled kernel
+        // in that case.  persistent, batch table and fused kernels
+        // are only ever built at runtime.
+        if(!persistent && !batch_table && !fused_phase && kernel->device_function
+           && !node.loadOps.enabled() && !node.storeOps.enabled()
+           && !node.largeTwdBatchIsTransformCount && !node.largeTwdCompute
+           && node.ebtype != EmbeddedType::Real2C_ODD && node.ebtype != EmbeddedType::C2Real_ODD
+           && node.ebtype != EmbeddedType::Real2Real)
         {
             is_pre_compiled = true;
         }
@@ -94,13 +178,61 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
         specs->threads_per_transform = kernel->threads_per_transform[0];
         specs->half_lds              = kernel->half_lds;
         specs->direct_to_from_reg    = kernel->direct_to_from_reg;
+        // kernels compiled ahead of time are shared by all archs, so
+        // only specialise for the device's wavefront size when
+        // compiling at runtime
+        if(!kernel->aot_rtc)
+            specs->wave_size = node.deviceProp.warpSize;
+        // precompiled kernels only have the per-element variant.
+        // transforms found through tables can start at any offset,
+        // so aren't aligned for vector accesses.
+        if(!is_pre_compiled && !batch_table)
+            specs->vector_width = stockham_vector_width(node, *kernel, enable_callbacks);
+        // odd-length real transforms read or write a real buffer
+        if(node.ebtype == EmbeddedType::Real2C_ODD)
+            specs->odd_real_direction = -1;
+        else if(node.ebtype == EmbeddedType::C2Real_ODD)
+            specs->odd_real_direction = 1;
+        else if(node.ebtype == EmbeddedType::Real2Real)
+        {
+            specs->r2r_type   = node.r2rType;
+            specs->r2r_length = node.outputLength[0];
+        }
+        // these kernels go through LDS to reshape the data, and the
+        // direct-to-register path would access their real buffers as
+        // complex
+        if(node.ebtype == EmbeddedType::Real2C_ODD || node.ebtype == EmbeddedType::C2Real_ODD
+           || node.ebtype == EmbeddedType::Real2Real)
+            specs->direct_to_from_reg = false;
+        // the tuner may ask for radix-16 butterflies on matrix
+        // cores.  devices without FP64 matrix cores compile the
+        // regular butterflies instead.
+        specs->matrix_butterflies
+            = kernel->matrix_butterflies
+              && StockhamGeneratorSpecs::can_use_matrix_butterflies(
+                  node.precision, kernel->workgroup_size, kernel->factors);
+        // the node launches fewer blocks for pipelined kernels, see
+        // Stockham1DNode::SetupGPAndFnPtr_internal
+        specs->pipelined_loads = kernel->pipelined_loads && node.scheme == CS_KERNEL_STOCKHAM;
+        // Stockham1DNode::SetupGPAndFnPtr_internal sizes LDS for the
+        // padding.  Fused Bluestein kernels keep their LDS unpadded.
+        if(node.scheme == CS_KERNEL_STOCKHAM && node.fuseBlue == BluesteinFuseType::BFT_NONE)
+            specs->lds_bank_shift = StockhamGeneratorSpecs::resolve_lds_bank_shift(
+                kernel->lds_bank_shift, specs->length);
+        // the node creates a matching twiddle table, see
+        // Stockham1DNode::CreateDeviceResources
+        specs->octant_twiddles
+            = kernel->octant_twiddles && node.scheme == CS_KERNEL_STOCKHAM
+              && node.ebtype == EmbeddedType::NONE && node.fuseBlue == BluesteinFuseType::BFT_NONE
+              && StockhamGeneratorSpecs::can_use_octant_twiddles(specs->length);
         break;
     }
     case CS_KERNEL_2D_SINGLE:
     {
         kernel = pool.get_kernel(key);
         // already precompiled?
-        if(kernel->device_function && !node.loadOps.enabled() && !node.storeOps.enabled())
+        if(!persistent && kernel->device_function && !node.loadOps.enabled()
+           && !node.storeOps.enabled())
         {
             is_pre_compiled = true;
         }
@@ -141,6 +273,39 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
         specs2d->half_lds              = kernel->half_lds;
         break;
     }
+    case CS_KERNEL_3D_SINGLE:
+    {
+        // 3D_SINGLE has no function pool entry of its own, and is
+        // always runtime-compiled from the 1D kernels of each
+        // dimension
+        std::vector<FFTKernel> kernels;
+        for(unsigned int i = 0; i < 3; ++i)
+            kernels.push_back(pool.get_kernel(FMKey(node.length[i], node.precision)));
+
+        std::vector<std::vector<unsigned int>> factors(3);
+        for(unsigned int i = 0; i < 3; ++i)
+            std::copy(kernels[i].factors.begin(),
+                      kernels[i].factors.end(),
+                      std::back_inserter(factors[i]));
+        std::vector<unsigned int> precisions = {static_cast<unsigned int>(node.precision)};
+
+        specs.emplace(factors[0],
+                      factors[1],
+                      precisions,
+                      static_cast<unsigned int>(kernels[0].workgroup_size),
+                      PrintScheme(node.scheme));
+        specs->threads_per_transform   = kernels[0].threads_per_transform[0];
+        specs->factors3d               = factors[2];
+        specs->threads_per_transform3d = kernels[2].threads_per_transform[0];
+
+        specs2d.emplace(factors[1],
+                        factors[0],
+                        precisions,
+                        static_cast<unsigned int>(kernels[1].workgroup_size),
+                        PrintScheme(node.scheme));
+        specs2d->threads_per_transform = kernels[1].threads_per_transform[0];
+        break;
+    }
     default:
     {
         // no supported scheme, not the correct type
@@ -152,8 +317,9 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
     // built for exactly that dimension.  But kernels that are
     // compiled ahead of time are general across all dims and take
     // 'dim' as an argument.  So set static_dim to 0 to communicate
-    // this to the generator and launch machinery.
-    if(kernel && kernel->aot_rtc)
+    // this to the generator and launch machinery.  Phases of fused
+    // kernels are only ever built at runtime, so they keep it.
+    if(kernel && kernel->aot_rtc && !fused_phase)
         static_dim = 0;
     specs->static_dim = static_dim;
 
@@ -164,27 +330,79 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
 
     bool unit_stride = node.inStride.front() == 1 && node.outStride.front() == 1;
 
+    // RTC kernels are built for one problem, so can do 32-bit index
+    // math when the problem is small enough
+    if(static_dim && !is_pre_compiled && !persistent && !batch_table
+       && node.fuseBlue == BluesteinFuseType::BFT_NONE && stockham_fits_index32(node))
+        specs->index32 = true;
+
+    // the plan's last kernel can stream its output past the caches.
+    // Kernels compiled ahead of time keep their default stores, so
+    // that they're still found in the AOT cache.  A fused kernel's
+    // phases share one set of includes, so keep default stores
+    // there too.
+    if(node.nontemporalStores && !is_pre_compiled && !(kernel && kernel->aot_rtc) && !fused_phase)
+        specs->nontemporal_stores = true;
+
+    // optionally bake the node's lengths and strides into the
+    // kernel, for plans that run often enough to be worth a kernel
+    // per layout
+    if(rocfft_getenv("ROCFFT_RTC_STATIC_LAYOUT") == "1" && static_dim == node.length.size()
+       && !is_pre_compiled && !persistent && !batch_table && !fused_phase
+       && node.fuseBlue == BluesteinFuseType::BFT_NONE)
+    {
+        specs->static_lengths   = node.length;
+        specs->static_stride_in = node.inStride;
+        specs->static_stride_in.push_back(node.iDist);
+        if(node.placement == rocfft_placement_notinplace)
+        {
+            specs->static_stride_out = node.outStride;
+            specs->static_stride_out.push_back(node.oDist);
+        }
+    }
+
+    // optionally build one kernel for both directions, which
+    // conjugates its input and output for inverse transforms.  AOT
+    // cache entries keep their per-direction names, and vector
+    // accesses, callbacks, and fused real/Bluestein steps aren't
+    // plain complex loads and stores that can be conjugated.
+    int direction = node.direction;
+    if(rocfft_getenv("ROCFFT_RTC_DIRECTION_AGNOSTIC") == "1" && kernel && !kernel->aot_rtc
+       && !is_pre_compiled && !persistent && !batch_table && !fused_phase
+       && specs->vector_width == 0 && node.ebtype == EmbeddedType::NONE
+       && node.fuseBlue == BluesteinFuseType::BFT_NONE
+       && node.GetCallbackType(enable_callbacks) == CallbackType::NONE)
+        direction = 0;
+
     generator.generate_name = [=, &node]() {
-        return stockham_rtc_kernel_name(*specs,
-                                        specs2d ? *specs2d : *specs,
-                                        node.scheme,
-                                        node.direction,
-                                        node.precision,
-                                        node.placement,
-                                        node.inArrayType,
-                                        node.outArrayType,
-                                        unit_stride,
-                                        node.largeTwdBase,
-                                        node.ltwdSteps,
-                                        node.largeTwdBatchIsTransformCount,
-                                        node.ebtype,
-                                        node.dir2regMode,
-                                        node.intrinsicMode,
-                                        node.sbrcTranstype,
-                                        node.GetCallbackType(enable_callbacks),
-                                        node.fuseBlue,
-                                        node.loadOps,
-                                        node.storeOps);
+        auto name = stockham_rtc_kernel_name(*specs,
+                                             specs2d ? *specs2d : *specs,
+                                             node.scheme,
+                                             direction,
+                                             node.precision,
+                                             node.placement,
+                                             node.inArrayType,
+                                             node.outArrayType,
+                                             unit_stride,
+                                             node.largeTwdBase,
+                                             node.ltwdSteps,
+                                             node.largeTwdBatchIsTransformCount,
+                                             node.largeTwdCompute ? node.large1D : 0,
+                                             node.ebtype,
+                                             node.dir2regMode,
+                                             node.intrinsicMode,
+                                             node.sbrcTranstype,
+                                             node.GetCallbackType(enable_callbacks),
+                                             node.fuseBlue,
+                                             node.loadOps,
+                                             node.storeOps);
+        if(persistent)
+            name += "_persistent";
+        if(grouped)
+            name += "_grouped";
+        if(pointer_array)
+            name += "_ptrarray";
+        return name;
     };
 
     // if is pre-compiled, we assign the name-function only
@@ -197,7 +415,7 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
                             nullptr,
                             kernel_name,
                             node.scheme,
-                            node.direction,
+                            direction,
                             node.precision,
                             node.placement,
                             node.inArrayType,
@@ -206,6 +424,7 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
                             node.largeTwdBase,
                             node.ltwdSteps,
                             node.largeTwdBatchIsTransformCount,
+                            node.largeTwdCompute ? node.large1D : 0,
                             node.ebtype,
                             node.dir2regMode,
                             node.intrinsicMode,
@@ -213,16 +432,52 @@ RTCKernel::RTCGenerator RTCKernelStockham::generate_from_node(const TreeNode&
                             node.GetCallbackType(enable_callbacks),
                             node.fuseBlue,
                             node.loadOps,
-                            node.storeOps);
+                            node.storeOps,
+                            persistent,
+                            grouped,
+                            pointer_array,
+                            fused_phase);
     };
 
     generator.construct_rtckernel
-        = [](const std::string& kernel_name, const std::vector<char>& code, dim3, dim3) {
+        = [](const std::string& kernel_name, const RTCLoadableModule& code, dim3, dim3) {
               return std::unique_ptr<RTCKernel>(new RTCKernelStockham(kernel_name, code));
           };
     return generator;
 }
 
+std::unique_ptr<RTCKernel> RTCKernelStockham::compile_variant(const RTCGenerator& generator,
+                                                              const std::string&  gpu_arch)
+{
+    if(!generator.generate_src || !generator.construct_rtckernel)
+        return nullptr;
+
+    auto kernel_name = generator.generate_name();
+    auto code
+        = RTCCache::cached_compile(kernel_name, gpu_arch, generator.generate_src, generator_sum());
+    return generator.construct_rtckernel(
+        kernel_name, code, generator.gridDim, generator.blockDim);
+}
+
+std::unique_ptr<RTCKernel> RTCKernelStockham::compile_persistent(const TreeNode&    node,
+                                                                 const std::string& gpu_arch)
+{
+    return compile_variant(generate_from_node(node, gpu_arch, false, true), gpu_arch);
+}
+
+std::unique_ptr<RTCKernel> RTCKernelStockham::compile_grouped(const TreeNode&    node,
+                                                              const std::string& gpu_arch)
+{
+    return compile_variant(generate_from_node(node, gpu_arch, false, false, true), gpu_arch);
+}
+
+std::unique_ptr<RTCKernel> RTCKernelStockham::compile_pointer_array(const TreeNode&    node,
+                                                                    const std::string& gpu_arch)
+{
+    return compile_variant(generate_from_node(node, gpu_arch, false, false, false, true),
+                           gpu_arch);
+}
+
 RTCKernelArgs RTCKernelStockham::get_launch_args(DeviceCallIn& data)
 {
     // construct arguments to pass to the kernel
@@ -235,14 +490,17 @@ RTCKernelArgs RTCKernelStockham::get_launch_args(DeviceCallIn& data)
         kargs.append_ptr(data.node->twiddles_large);
     if(!hardcoded_dim)
         kargs.append_size_t(data.node->length.size());
-    // lengths
-    kargs.append_ptr(kargs_lengths(data.node->devKernArg));
-    // stride in/out
-    kargs.append_ptr(kargs_stride_in(data.node->devKernArg));
-    if(data.node->placement == rocfft_placement_notinplace)
-        kargs.append_ptr(kargs_stride_out(data.node->devKernArg));
+    if(!static_layout)
+    {
+        // lengths
+        kargs.append_ptr(kargs_lengths(data.node->devKernArg));
+        // stride in/out
+        kargs.append_ptr(kargs_stride_in(data.node->devKernArg));
+        if(data.node->placement == rocfft_placement_notinplace)
+            kargs.append_ptr(kargs_stride_out(data.node->devKernArg));
+    }
     // nbatch
-    kargs.append_size_t(data.node->batch);
+    kargs.append_size_t(data.get_batch());
     // lds padding
     kargs.append_unsigned_int(data.node->lds_padding);
     // callback params
@@ -263,6 +521,9 @@ RTCKernelArgs RTCKernelStockham::get_launch_args(DeviceCallIn& data)
             kargs.append_ptr(data.bufOut[1]);
     }
 
+    if(runtime_direction)
+        kargs.append_int(data.node->direction);
+
     append_load_store_args(kargs, *data.node);
 
     // fused bluestein data (chirp table and lengths)
@@ -342,3 +603,147 @@ RTCKernelArgs RTCKernelStockham::get_launch_args(DeviceCallIn& data)
     }
     return kargs;
 }
+
+// true if an L1D_CC plan's columns node and the rows node after it
+// are plain enough to run as phases of one fused kernel.  Each
+// phase must read and write separate buffers, since blocks of a
+// phase may repeat the phase's last block.
+static bool stockham_fusable_nodes(const TreeNode& columns, const TreeNode& rows)
+{
+    auto plain = [](const TreeNode& node) {
+        return node.placement == rocfft_placement_notinplace && node.ebtype == EmbeddedType::NONE
+               && node.fuseBlue == BluesteinFuseType::BFT_NONE && !node.loadOps.enabled()
+               && !node.storeOps.enabled() && node.loadOps.callback.empty()
+               && node.storeOps.callback.empty();
+    };
+    return columns.scheme == CS_KERNEL_STOCKHAM_BLOCK_CC
+           && rows.scheme == CS_KERNEL_STOCKHAM_BLOCK_RC && columns.parent
+           && columns.parent == rows.parent && columns.parent->scheme == CS_L1D_CC
+           && columns.obOut == rows.obIn && plain(columns) && plain(rows);
+}
+
+std::shared_future<std::unique_ptr<RTCKernel>> RTCKernelStockhamFused::runtime_compile(
+    const TreeNode& columns, const TreeNode& rows, const std::string& gpu_arch)
+{
+    if(rocfft_getenv("ROCFFT_RTC_FUSE_L1D") != "1" || !stockham_fusable_nodes(columns, rows))
+        return {};
+
+    // a block of the fused kernel does several blocks of the phase
+    // with the smaller workgroup at once.  those blocks synchronize
+    // with wave barriers, so must each be whole waves.
+    auto columns_wgs = static_cast<unsigned int>(
+        function_pool::get_kernel(columns.GetKernelKey()).workgroup_size);
+    auto rows_wgs
+        = static_cast<unsigned int>(function_pool::get_kernel(rows.GetKernelKey()).workgroup_size);
+    auto small_wgs = std::min(columns_wgs, rows_wgs);
+    auto large_wgs = std::max(columns_wgs, rows_wgs);
+    if(small_wgs == 0 || large_wgs % small_wgs != 0
+       || (small_wgs != large_wgs && small_wgs % columns.deviceProp.warpSize != 0))
+        return {};
+
+    auto phases = std::make_shared<std::vector<StockhamFusedPhase>>(2);
+    auto columns_generator
+        = generate_from_node(columns, gpu_arch, false, false, false, false, &(*phases)[0]);
+    auto rows_generator
+        = generate_from_node(rows, gpu_arch, false, false, false, false, &(*phases)[1]);
+    if(!columns_generator.generate_src || !rows_generator.generate_src)
+        return {};
+
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        throw std::runtime_error("failed to get device");
+
+    auto columns_name = columns_generator.generate_name();
+    auto rows_name    = rows_generator.generate_name();
+    auto kernel_name  = columns_name + "_" + rows_name + "_fused";
+
+    auto             precision = columns.precision;
+    kernel_src_gen_t generate_src;
+    generate_src = [=](const std::string& name) mutable {
+        // each phase's source is in a namespace named after its
+        // standalone kernel
+        columns_generator.generate_src(columns_name);
+        rows_generator.generate_src(rows_name);
+        return stockham_fused_rtc(name, precision, *phases);
+    };
+
+    // charge the compile to the plan being created, even though it
+    // runs on a worker thread
+    auto createTimes = PlanCreateTimes::Current();
+    auto compile     = [=]() -> std::unique_ptr<RTCKernel> {
+        if(hipSetDevice(deviceId) != hipSuccess)
+            throw std::runtime_error("failed to set device");
+        PlanCreateTimesScope timesScope(createTimes);
+        try
+        {
+            auto code
+                = RTCCache::cached_compile(kernel_name, gpu_arch, generate_src, generator_sum());
+            PlanCreateTimer loadTimer(PCP_MODULE_LOAD);
+            return std::unique_ptr<RTCKernel>(
+                new RTCKernelStockhamFused(kernel_name, code, columns_wgs, rows_wgs));
+        }
+        catch(std::exception& e)
+        {
+            if(LOG_RTC_ENABLED())
+                (*LogSingleton::GetInstance().GetRTCOS()) << e.what() << std::endl;
+            throw;
+        }
+    };
+    return RTCCompileScheduler::GetScheduler().Submit<std::unique_ptr<RTCKernel>>(compile);
+}
+
+bool RTCKernelStockhamFused::can_launch(const GridParam&       columns,
+                                        const GridParam&       rows,
+                                        const hipDeviceProp_t& deviceProp)
+{
+    // the grids are the nodes' own, so the configuration only needs
+    // to be worked out once
+    std::call_once(config_once, [&]() {
+        if(columns.b_y != 1 || columns.b_z != 1 || rows.b_y != 1 || rows.b_z != 1
+           || columns.wgs_x != columns_wgs || rows.wgs_x != rows_wgs)
+            return;
+
+        config_wgs = std::max(columns_wgs, rows_wgs);
+        auto columns_sub_blocks = config_wgs / columns_wgs;
+        auto rows_sub_blocks    = config_wgs / rows_wgs;
+
+        // sub-blocks' LDS is kept aligned for any scalar type
+        columns_lds_stride = DivRoundingUp<unsigned int>(columns.lds_bytes, 16) * 16;
+        rows_lds_stride    = DivRoundingUp<unsigned int>(rows.lds_bytes, 16) * 16;
+        config_lds_bytes
+            = std::max(columns_sub_blocks * columns_lds_stride, rows_sub_blocks * rows_lds_stride);
+        if(config_lds_bytes > deviceProp.sharedMemPerBlock)
+            return;
+
+        // the grid barrier needs every block to be resident at once
+        int occupancy = 0;
+        if(!get_occupancy({config_wgs}, config_lds_bytes, occupancy) || occupancy < 1)
+            return;
+        size_t blocks   = std::max(DivRoundingUp<size_t>(columns.b_x, columns_sub_blocks),
+                                 DivRoundingUp<size_t>(rows.b_x, rows_sub_blocks));
+        size_t resident = static_cast<size_t>(occupancy) * deviceProp.multiProcessorCount;
+        config_blocks   = static_cast<unsigned int>(std::min(blocks, resident));
+        config_valid    = config_blocks > 0;
+    });
+    return config_valid;
+}
+
+void RTCKernelStockhamFused::launch_fused(DeviceCallIn& columns, DeviceCallIn& rows, void* barrier)
+{
+    RTCKernelArgs kargs = get_launch_args(columns);
+    kargs.append_args(get_launch_args(rows));
+    kargs.append_ptr(barrier);
+    kargs.append_unsigned_int(columns.gridParam.b_x);
+    kargs.append_unsigned_int(columns_lds_stride);
+    kargs.append_unsigned_int(rows.gridParam.b_x);
+    kargs.append_unsigned_int(rows_lds_stride);
+
+    if(hipMemsetAsync(barrier, 0, sizeof(unsigned int), columns.rocfft_stream) != hipSuccess)
+        throw std::runtime_error("hipMemsetAsync failure");
+    launch(kargs,
+           {config_blocks},
+           {config_wgs},
+           config_lds_bytes,
+           columns.deviceProp,
+           columns.rocfft_stream);
+}
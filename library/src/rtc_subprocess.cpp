@@ -23,6 +23,16 @@
 #include "../../shared/subprocess.h"
 #include "library_path.h"
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#ifndef WIN32
+#include <csignal>
+#include <ctime>
+#include <pthread.h>
+#endif
+
 #if __has_include(<filesystem>)
 #include <filesystem>
 #else
@@ -76,10 +86,204 @@ static fs::path find_rtc_helper()
     throw std::runtime_error("unable to find rtc helper");
 }
 
+#ifndef WIN32
+// A long-lived helper process started with --server.  Requests are
+// written to its stdin as length-prefixed gpu arch and kernel source
+// strings.  Each reply on its stdout is a status byte (0 for
+// success), a length and then either the code object or an error
+// message.  Each server is used by one thread at a time.
+class RTCHelperServer
+{
+public:
+    explicit RTCHelperServer(const std::string& exe)
+    {
+        int stdin_fds[2] = {-1, -1};
+        if(pipe2(stdin_fds, O_CLOEXEC) != 0)
+            throw std::runtime_error("failed to create stdin pipe");
+        file_handle_wrapper child_stdin_read(stdin_fds[0]);
+        to_child.fd = stdin_fds[1];
+
+        int stdout_fds[2] = {-1, -1};
+        if(pipe2(stdout_fds, O_CLOEXEC) != 0)
+            throw std::runtime_error("failed to create stdout pipe");
+        from_child.fd = stdout_fds[0];
+        file_handle_wrapper child_stdout_write(stdout_fds[1]);
+
+        const char* child_argv[] = {exe.c_str(), "--server", nullptr};
+
+        posix_spawn_file_actions_t spawn_file_actions;
+        posix_spawn_file_actions_init(&spawn_file_actions);
+        posix_spawn_file_actions_adddup2(&spawn_file_actions, child_stdin_read, STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&spawn_file_actions, child_stdout_write, STDOUT_FILENO);
+
+        int spawn_result = posix_spawn(&pid,
+                                       exe.c_str(),
+                                       &spawn_file_actions,
+                                       nullptr,
+                                       const_cast<char* const*>(child_argv),
+                                       environ);
+        posix_spawn_file_actions_destroy(&spawn_file_actions);
+        if(spawn_result != 0)
+            throw std::runtime_error("failed to spawn helper server");
+    }
+    ~RTCHelperServer()
+    {
+        // closing stdin tells the server to exit
+        to_child.close();
+        from_child.close();
+        int wait_status = 0;
+        waitpid(pid, &wait_status, 0);
+    }
+
+    RTCHelperServer(const RTCHelperServer&) = delete;
+    void operator=(const RTCHelperServer&) = delete;
+
+    // returns the code object, or throws if the compile failed.  If
+    // the server itself went away, alive() becomes false.
+    std::vector<char> compile(const std::string& kernel_src, const std::string& gpu_arch)
+    {
+        if(!write_string(gpu_arch) || !write_string(kernel_src))
+        {
+            dead = true;
+            throw std::runtime_error("helper server stopped accepting requests");
+        }
+
+        char     status = 0;
+        uint64_t len    = 0;
+        if(!read_bytes(&status, sizeof(status)) || !read_bytes(&len, sizeof(len)))
+        {
+            dead = true;
+            throw std::runtime_error("helper server exited during compile");
+        }
+        std::vector<char> reply(len);
+        if(!read_bytes(reply.data(), len))
+        {
+            dead = true;
+            throw std::runtime_error("helper server exited during compile");
+        }
+        if(status != 0)
+            throw std::runtime_error(std::string(reply.data(), reply.size()));
+        if(reply.empty())
+            throw std::runtime_error("helper server failed to produce code");
+        return reply;
+    }
+
+    bool alive() const
+    {
+        return !dead;
+    }
+
+private:
+    bool write_bytes(const void* data, size_t len)
+    {
+        // the server may have crashed, so writing could raise
+        // SIGPIPE.  block it while writing, and discard it if it
+        // was raised.
+        sigset_t sigpipe_mask, old_mask;
+        sigemptyset(&sigpipe_mask);
+        sigaddset(&sigpipe_mask, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &sigpipe_mask, &old_mask);
+
+        bool        ok  = true;
+        const char* ptr = static_cast<const char*>(data);
+        while(len)
+        {
+            ssize_t written = write(to_child, ptr, len);
+            if(written < 0 && errno == EINTR)
+                continue;
+            if(written <= 0)
+            {
+                ok = false;
+                if(errno == EPIPE)
+                {
+                    timespec no_wait = {0, 0};
+                    sigtimedwait(&sigpipe_mask, nullptr, &no_wait);
+                }
+                break;
+            }
+            ptr += written;
+            len -= written;
+        }
+        pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+        return ok;
+    }
+    bool write_string(const std::string& str)
+    {
+        uint64_t len = str.size();
+        return write_bytes(&len, sizeof(len)) && write_bytes(str.data(), str.size());
+    }
+    bool read_bytes(void* data, size_t len)
+    {
+        char* ptr = static_cast<char*>(data);
+        while(len)
+        {
+            ssize_t bytes_read = read(from_child, ptr, len);
+            if(bytes_read < 0 && errno == EINTR)
+                continue;
+            if(bytes_read <= 0)
+                return false;
+            ptr += bytes_read;
+            len -= bytes_read;
+        }
+        return true;
+    }
+
+    pid_t               pid = 0;
+    file_handle_wrapper to_child;
+    file_handle_wrapper from_child;
+    bool                dead = false;
+};
+
+// idle helper servers, kept alive between compiles.  deliberately
+// never destroyed - the servers exit on their own when this process
+// exits and their stdin is closed.
+static std::mutex                                     helper_servers_mutex;
+static std::vector<std::unique_ptr<RTCHelperServer>>* helper_servers
+    = new std::vector<std::unique_ptr<RTCHelperServer>>;
+
+static std::vector<char> compile_helper_server(const std::string& exe,
+                                               const std::string& kernel_src,
+                                               const std::string& gpu_arch)
+{
+    std::unique_ptr<RTCHelperServer> server;
+    {
+        std::lock_guard<std::mutex> lock(helper_servers_mutex);
+        if(!helper_servers->empty())
+        {
+            server = std::move(helper_servers->back());
+            helper_servers->pop_back();
+        }
+    }
+    if(!server)
+        server = std::make_unique<RTCHelperServer>(exe);
+
+    // return the server to the pool afterwards, unless it died
+    struct ReturnServer
+    {
+        std::unique_ptr<RTCHelperServer>& server;
+        ~ReturnServer()
+        {
+            if(!server->alive())
+                return;
+            std::lock_guard<std::mutex> lock(helper_servers_mutex);
+            helper_servers->push_back(std::move(server));
+        }
+    } return_server{server};
+
+    return server->compile(kernel_src, gpu_arch);
+}
+#endif
+
 std::vector<char> compile_subprocess(const std::string& kernel_src, const std::string& gpu_arch)
 {
     static std::string rtc_helper_exe = find_rtc_helper().string();
 
+#ifndef WIN32
+    // reuse a long-lived helper unless that's disabled
+    if(rocfft_getenv("ROCFFT_RTC_HELPER_SERVER") != "0")
+        return compile_helper_server(rtc_helper_exe, kernel_src, gpu_arch);
+#endif
+
     // HACK: on Windows, rtc_helper_exe seems to have an embedded NUL
     // byte at the end.  Append c_str() to hide this.
     auto code = execute_subprocess(rtc_helper_exe.c_str(), {gpu_arch}, kernel_src);
@@ -40,21 +40,39 @@ RTCKernel::RTCGenerator RTCKernelTranspose::generate_from_node(const TreeNode&
     unsigned int tileX = node.precision == rocfft_precision_single ? 64 : 32;
     unsigned int tileY = node.precision == rocfft_precision_single ? 16 : 32;
 
+    // check the length along the fast output dimension to decide if
+    // we should do diagonal block ordering
+    size_t fastOut = node.length[1];
+    // diagonal ordering only seems to help 2D cases, not 3D
+    bool diagonal = (fastOut % 256) == 0 && (node.outStride[0] % 256 == 0)
+                    && node.scheme == CS_KERNEL_TRANSPOSE;
+
+    // a tuned solution overrides the default tiling
+    const auto tuned = node.GetTuningKernelKey().kernel_config;
+    if(tuned.workgroup_size)
+    {
+        tileX    = tuned.threads_per_transform[0];
+        tileY    = tuned.threads_per_transform[1];
+        diagonal = tuned.transforms_per_block == 1;
+    }
+
     // grid Y counts rows on dims Y+Z, sliced into tiles of tileX.
     // grid Z counts any dims beyond Y+Z, plus batch
-    unsigned int gridYrows = length[1] * (length.size() > 2 ? length[2] : 1);
-    auto         highdim   = std::min<size_t>(length.size(), 3);
-    unsigned int gridZ     = std::accumulate(
-        length.begin() + highdim, length.end(), node.batch, std::multiplies<unsigned int>());
-
-    generator.gridDim  = {DivRoundingUp<unsigned int>(length[0], tileX),
-                         DivRoundingUp<unsigned int>(gridYrows, tileX),
-                         gridZ};
+    size_t gridYrows = length[1] * (length.size() > 2 ? length[2] : 1);
+    auto   highdim   = std::min<size_t>(length.size(), 3);
+    size_t gridZ     = std::accumulate(
+        length.begin() + highdim, length.end(), node.batch, std::multiplies<size_t>());
+
+    generator.gridDim  = {checked_grid_dim(DivRoundingUp<size_t>(length[0], tileX), tileX),
+                         checked_grid_dim(DivRoundingUp<size_t>(gridYrows, tileX), tileY),
+                         checked_grid_dim(gridZ)};
     generator.blockDim = {tileX, tileY};
 
     size_t largeTwdSteps = 0;
-    if(node.large1D > (size_t)256 * 256 * 256 * 256)
+    if(node.large1D > (size_t)256 * 256 * 256 * 256 * 256)
         throw std::runtime_error("large1D twiddle size too large error");
+    else if(node.large1D > (size_t)256 * 256 * 256 * 256)
+        largeTwdSteps = 5;
     else if(node.large1D > (size_t)256 * 256 * 256)
         largeTwdSteps = 4;
     else if(node.large1D > (size_t)256 * 256)
@@ -65,13 +83,6 @@ RTCKernel::RTCGenerator RTCKernelTranspose::generate_from_node(const TreeNode&
     else if(node.large1D > 0)
         largeTwdSteps = 1;
 
-    // check the length along the fast output dimension to decide if
-    // we should do diagonal block ordering
-    size_t fastOut = node.length[1];
-    // diagonal ordering only seems to help 2D cases, not 3D
-    bool diagonal = (fastOut % 256) == 0 && (node.outStride[0] % 256 == 0)
-                    && node.scheme == CS_KERNEL_TRANSPOSE;
-
     bool tileAligned = node.length[0] % tileX == 0 && node.length[1] % tileX == 0;
 
     TransposeSpecs specs{tileX,
@@ -94,7 +105,7 @@ RTCKernel::RTCGenerator RTCKernelTranspose::generate_from_node(const TreeNode&
         = [=](const std::string& kernel_name) { return transpose_rtc(kernel_name, specs); };
 
     generator.construct_rtckernel = [=](const std::string&       kernel_name,
-                                        const std::vector<char>& code,
+                                        const RTCLoadableModule& code,
                                         dim3                     gridDim,
                                         dim3                     blockDim) {
         return std::unique_ptr<RTCKernel>(
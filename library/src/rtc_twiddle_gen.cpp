@@ -90,6 +90,7 @@ static std::string twiddle_rtc_args(TwiddleTableType type, rocfft_precision prec
         break;
     case TwiddleTableType::LARGE:
         args += "double phi";
+        args += ", size_t N";
         args += ", size_t base";
         args += ", size_t X";
         args += ", size_t Y";
@@ -169,7 +170,9 @@ static std::string twiddle_rtc_body(TwiddleTableType type)
 
             if(iX < X)
             {
-                auto j = (static_cast<size_t>(1) << (iY * base)) * iX;
+                // reduce the index exactly before scaling by phi,
+                // so the angle stays small however large N is
+                auto j = ((static_cast<size_t>(1) << (iY * base)) * iX) % N;
 
                 double c = cos(phi * j);
                 double s = sin(phi * j);
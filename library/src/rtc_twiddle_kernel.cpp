@@ -21,6 +21,7 @@
 #include "rtc_twiddle_kernel.h"
 #include "device/kernel-generator-embed.h"
 #include "rtc_cache.h"
+#include "rtc_module_cache.h"
 
 RTCKernelTwiddle RTCKernelTwiddle::generate(const std::string& gpu_arch,
                                             TwiddleTableType   type,
@@ -31,7 +32,11 @@ RTCKernelTwiddle RTCKernelTwiddle::generate(const std::string& gpu_arch,
     kernel_src_gen_t generator{
         [=](const std::string& kernel_name) { return twiddle_rtc(kernel_name, type, precision); }};
 
-    auto code = RTCCache::cached_compile(kernel_name, gpu_arch, generator, generator_sum());
+    // skip the RTC cache if the module is already loaded
+    auto module = RTCModuleCache::GetCache().Find(kernel_name, gpu_arch, generator_sum());
+    if(module)
+        return RTCKernelTwiddle{kernel_name, module, {}, {}};
 
+    auto code = RTCCache::cached_compile(kernel_name, gpu_arch, generator, generator_sum());
     return RTCKernelTwiddle{kernel_name, code, {}, {}};
 }
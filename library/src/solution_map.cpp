@@ -23,11 +23,17 @@
 #include "solution_map.h"
 #include "../../shared/environment.h"
 #include "data_descriptor.h"
+#include "device/kernel-generator-embed.h"
 #include "library_path.h"
 #include "logging.h"
 #include "node_factory.h"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 
 namespace fs = std::filesystem;
 
@@ -35,7 +41,7 @@ namespace fs = std::filesystem;
 
 static const char* def_solution_map_path = "rocfft_solution_map.dat";
 
-const int   solution_map::VERSION                       = 3;
+const int   solution_map::VERSION                       = 9;
 const char* solution_map::KERNEL_TOKEN_BUILTIN_KERNEL   = "kernel_token_builtin_kernel";
 const char* solution_map::LEAFNODE_TOKEN_BUILTIN_KERNEL = "leafnode_token_builtin_kernel";
 
@@ -80,6 +86,12 @@ static fs::path get_solution_map_path(const std::string& read_folder,
     fs::path    file_name(prefix.c_str());
     file_name += def_solution_map_path;
 
+    // prefer a binary archive of the map if one was converted
+    auto archive_path = folder_path / file_name;
+    archive_path.replace_extension(".bin");
+    if(fs::exists(archive_path))
+        return archive_path;
+
     return folder_path / file_name;
 }
 
@@ -120,7 +132,11 @@ struct ToString<SolutionNode>
             str += ",";
             if(value.sol_node_type == SOL_KERNEL_ONLY)
             {
-                str += FieldDescriptor<FMKey>().describe("kernel_key", value.kernel_key);
+                str += FieldDescriptor<FMKey>().describe("kernel_key", value.kernel_key) + ",";
+                // empty strings aren't tokens to the parser, so write
+                // something for an unknown checksum
+                str += FieldDescriptor<std::string>().describe(
+                    "generator_sum", value.generator_sum.empty() ? "unknown" : value.generator_sum);
             }
             else
             {
@@ -154,6 +170,14 @@ struct FromString<SolutionNode>
             {
                 FieldParser<FMKey>().parse("kernel_key", ret.kernel_key, current);
                 ret.using_scheme = ret.kernel_key.scheme;
+
+                // (version >= 4) records the generator checksum of kernels
+                if(DescriptorFormatVersion::UsingVersion >= 4)
+                {
+                    FieldParser<std::string>().parse("generator_sum", ret.generator_sum, current);
+                    if(ret.generator_sum == "unknown")
+                        ret.generator_sum.clear();
+                }
             }
             else
             {
@@ -330,8 +354,97 @@ bool solution_map::remove_solution_node(SolutionNodeVec& nodeVec, SolutionNode&
     return true;
 }
 
+bool solution_map::map_archive(archive_source& src)
+{
+    if(src.archive)
+        return true;
+    if(src.failed)
+        return false;
+
+    try
+    {
+        auto archive = std::make_unique<SolutionMapArchive>(src.path);
+        if(archive->map_version() != static_cast<uint64_t>(solution_map::VERSION))
+            throw std::runtime_error("solution map archive " + src.path.string() + " is version "
+                                     + std::to_string(archive->map_version()) + ", expected "
+                                     + std::to_string(solution_map::VERSION));
+        src.archive = std::move(archive);
+        return true;
+    }
+    catch(std::exception& e)
+    {
+        // don't try this archive again
+        src.failed = true;
+        if(LOG_TRACE_ENABLED())
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        return false;
+    }
+}
+
+void solution_map::add_entry_texts(const std::vector<std::string>& texts, ProbSolMap& dst_map)
+{
+    static std::regex regEx(REGEX, std::regex_constants::optimize);
+
+    // archives are only written in the latest version format
+    DescriptorFormatVersion::UsingVersion = solution_map::VERSION;
+
+    for(const auto& text : texts)
+    {
+        std::sregex_token_iterator tokens{text.begin(), text.end(), regEx, 0};
+        SolMapEntry                entry;
+        FromString<SolMapEntry>().Get(entry, tokens);
+
+        // automatically set arch_name which is not in the text
+        for(auto& sol : entry.second)
+            sol.arch_name = entry.first.arch;
+        dst_map.emplace(entry.first, entry.second);
+    }
+}
+
+SolutionNodeVec* solution_map::find_solutions(const ProblemKey& probKey, bool primary_map)
+{
+    ProbSolMap& dst_map = (primary_map) ? primary_sol_map : temp_working_map;
+
+    auto it = dst_map.find(probKey);
+    if(it != dst_map.end())
+        return &it->second;
+
+    // archives are only read into the primary map
+    if(!primary_map)
+        return nullptr;
+
+    for(auto& src : archives)
+    {
+        if(!map_archive(src))
+            continue;
+        auto text = src.archive->find(probKey.arch, probKey.probToken);
+        if(text.empty())
+            continue;
+
+        add_entry_texts({text}, primary_sol_map);
+        it = primary_sol_map.find(probKey);
+        if(it != primary_sol_map.end())
+            return &it->second;
+    }
+    return nullptr;
+}
+
+void solution_map::load_all_archives()
+{
+    std::lock_guard<std::mutex> lock(lookup_mutex);
+    for(auto& src : archives)
+    {
+        if(map_archive(src))
+            add_entry_texts(src.archive->all_entries(), primary_sol_map);
+    }
+}
+
 void solution_map::generate_link_info()
 {
+    // looking up children below must not add entries while we
+    // iterate over the map
+    load_all_archives();
+
     for(auto& [key, value] : primary_sol_map)
     {
         SolutionNodeVec& solNodeVec = value;
@@ -364,60 +477,229 @@ void solution_map::setup(const std::string& arch_name)
     {
         fs::path read_from_path(explict_read_path_str.c_str());
         read_solution_map_data(read_from_path);
+    }
+    else
+    {
+        // set ROCFFT_READ_SOL_MAP_FROM_FOLDER to enable reading solution map text files in runtime
+        // default is empty
+        std::string read_folder_str = rocfft_getenv("ROCFFT_READ_SOL_MAP_FROM_FOLDER");
+        if(!read_folder_str.empty())
+        {
+            // read data from any_arch
+            auto sol_map_input = get_solution_map_path(read_folder_str);
+            read_solution_map_data(sol_map_input);
+
+            // read data from current arch
+            sol_map_input = get_solution_map_path(read_folder_str, arch_name);
+            read_solution_map_data(sol_map_input);
+        }
+    }
+
+    read_user_folder(arch_name);
+}
+
+void solution_map::read_user_folder(const std::string& arch_name)
+{
+    // ROCFFT_USER_SOL_MAP_PATH is a folder of solutions tuned on
+    // first use, one "<arch>_<token>.dat" file per problem, possibly
+    // converted to binary ".bin" archives.  Only read the ones for
+    // the current arch.
+    std::string user_folder_str = rocfft_getenv("ROCFFT_USER_SOL_MAP_PATH");
+    if(!user_folder_str.empty())
+    {
+        std::error_code ec;
+        const auto      prefix = arch_name + "_";
+        for(fs::directory_iterator it(user_folder_str, ec), end; !ec && it != end;
+            it.increment(ec))
+        {
+            const auto filename = it->path().filename().string();
+            const auto extension = it->path().extension();
+            if((extension == ".dat" || extension == ".bin")
+               && filename.compare(0, prefix.size(), prefix) == 0)
+                read_solution_map_data(it->path());
+        }
+    }
+}
+
+bool solution_map::reload(const std::string&     path,
+                          const std::string&     arch_name,
+                          const hipDeviceProp_t& prop)
+{
+    // the new map starts from the shipped solutions, the same as the
+    // one built at setup
+    std::shared_ptr<solution_map> new_map(new solution_map);
+    if(path.empty())
+        new_map->setup(arch_name);
+    else
+    {
+        std::error_code ec;
+        if(fs::is_directory(path, ec))
+        {
+            new_map->read_solution_map_data(get_solution_map_path(path));
+            new_map->read_solution_map_data(get_solution_map_path(path, arch_name));
+        }
+        else if(!new_map->read_solution_map_data(path))
+            return false;
+        new_map->read_user_folder(arch_name);
+    }
+    new_map->setup_transfer_arch(arch_name, prop);
+
+    std::atomic_store(&active_map(), new_map);
+
+    if(LOG_TRACE_ENABLED())
+        (*LogSingleton::GetInstance().GetTraceOS())
+            << "reloaded solution map" << (path.empty() ? "" : " from ") << path << std::endl;
+    return true;
+}
+
+// archs that rocFFT ships tuned solutions for, with the device
+// properties the solutions were tuned on
+struct shipped_arch_props
+{
+    const char* arch;
+    int         numCUs;
+    size_t      ldsBytes;
+    int         warpSize;
+};
+static const shipped_arch_props shipped_archs[] = {
+    {"gfx908", 120, 64 * 1024, 64},
+    {"gfx90a", 110, 64 * 1024, 64},
+    {"gfx942", 304, 64 * 1024, 64},
+};
+
+static int floor_pow2(int n)
+{
+    int ret = 1;
+    while(ret * 2 <= n)
+        ret *= 2;
+    return ret;
+}
+
+static const std::string CU_BUCKET_SUFFIX = "_cu";
+
+std::string solution_map::get_cu_bucket_arch(const std::string&     arch_name,
+                                             const hipDeviceProp_t& prop)
+{
+    for(const auto& shipped : shipped_archs)
+    {
+        if(arch_name == shipped.arch)
+        {
+            if(prop.multiProcessorCount <= 0 || prop.multiProcessorCount >= shipped.numCUs)
+                return {};
+            return arch_name + CU_BUCKET_SUFFIX
+                   + std::to_string(floor_pow2(prop.multiProcessorCount));
+        }
+    }
+    return {};
+}
+
+int solution_map::get_arch_num_CUs(const std::string& arch)
+{
+    auto suffix_pos = arch.rfind(CU_BUCKET_SUFFIX);
+    if(suffix_pos != std::string::npos)
+    {
+        try
+        {
+            return std::stoi(arch.substr(suffix_pos + CU_BUCKET_SUFFIX.size()));
+        }
+        catch(std::exception&)
+        {
+            return 0;
+        }
+    }
+
+    for(const auto& shipped : shipped_archs)
+    {
+        if(arch == shipped.arch)
+            return shipped.numCUs;
+    }
+    return 0;
+}
+
+void solution_map::setup_transfer_arch(const std::string& arch_name, const hipDeviceProp_t& prop)
+{
+    transfer_arch.clear();
+    if(rocfft_getenv("ROCFFT_SOL_MAP_TRANSFER") != "1")
         return;
+
+    // only archs that were built into the library can be used
+    std::set<std::string> archs_in_map;
+    {
+        std::lock_guard<std::mutex> lock(lookup_mutex);
+        for(const auto& [key, value] : primary_sol_map)
+            archs_in_map.insert(key.arch);
     }
 
-    // set ROCFFT_READ_SOL_MAP_FROM_FOLDER to enable reading solution map text files in runtime
-    // default is empty
-    std::string read_folder_str = rocfft_getenv("ROCFFT_READ_SOL_MAP_FROM_FOLDER");
-    if(!read_folder_str.empty())
+    // prefer the same wavefront size, then the closest CU count.
+    // kernels tuned for more LDS than the device has might not
+    // launch, so those archs are never used.
+    double best_distance = std::numeric_limits<double>::max();
+    for(const auto& shipped : shipped_archs)
     {
-        // read data from any_arch
-        auto sol_map_input = get_solution_map_path(read_folder_str);
-        read_solution_map_data(sol_map_input);
+        if(arch_name == shipped.arch || !archs_in_map.count(shipped.arch)
+           || shipped.ldsBytes > prop.sharedMemPerBlock)
+            continue;
+
+        double distance = std::abs(
+            std::log2(static_cast<double>(std::max(prop.multiProcessorCount, 1)) / shipped.numCUs));
+        if(shipped.warpSize != prop.warpSize)
+            distance += 2.0;
 
-        // read data from current arch
-        sol_map_input = get_solution_map_path(read_folder_str, arch_name);
-        read_solution_map_data(sol_map_input);
+        if(distance < best_distance)
+        {
+            best_distance = distance;
+            transfer_arch = shipped.arch;
+        }
     }
+
+    if(!transfer_arch.empty() && LOG_TRACE_ENABLED())
+        (*LogSingleton::GetInstance().GetTraceOS())
+            << "transferring solutions from " << transfer_arch << " to " << arch_name
+            << std::endl;
+}
+
+void solution_map::clear()
+{
+    std::lock_guard<std::mutex> lock(lookup_mutex);
+    primary_sol_map.clear();
+    temp_working_map.clear();
+    archives.clear();
 }
 
 bool solution_map::has_solution_node(const ProblemKey& probKey, size_t option_id, bool primary_map)
 {
-    ProbSolMap& dst_map = (primary_map) ? primary_sol_map : temp_working_map;
+    std::lock_guard<std::mutex> lock(lookup_mutex);
 
     // no this key
-    if(dst_map.count(probKey) == 0)
+    auto solutions = find_solutions(probKey, primary_map);
+    if(!solutions)
         return false;
 
     // no this option_id
-    SolutionNodeVec& solutions = dst_map.at(probKey);
-    return solutions.size() > option_id;
+    return solutions->size() > option_id;
 }
 
 SolutionNode&
     solution_map::get_solution_node(const ProblemKey& probKey, size_t option_id, bool primary_map)
 {
+    std::lock_guard<std::mutex> lock(lookup_mutex);
+
     // be sure we have checked has_solution_node();
-    if(!has_solution_node(probKey, option_id, primary_map))
+    auto solutions = find_solutions(probKey, primary_map);
+    if(!solutions || solutions->size() <= option_id)
         throw std::runtime_error(
             "get_solution_node failed. the solution_node doesn't exist: ProbKey=(" + probKey.arch
             + "," + probKey.probToken + "), option_id=" + std::to_string(option_id));
 
-    ProbSolMap& dst_map = (primary_map) ? primary_sol_map : temp_working_map;
-
-    SolutionNodeVec& solutions = dst_map.at(probKey);
-    return solutions[option_id];
+    // elements of the map don't move when other entries are loaded,
+    // so the reference stays valid after the lock is released
+    return (*solutions)[option_id];
 }
 
 FMKey&
     solution_map::get_solution_kernel(const ProblemKey& probKey, size_t option_id, bool primary_map)
 {
-    // be sure we have checked has_solution_node();
-    ProbSolMap& dst_map = (primary_map) ? primary_sol_map : temp_working_map;
-
-    SolutionNodeVec& solutions = dst_map.at(probKey);
-    return solutions[option_id].kernel_key;
+    return get_solution_node(probKey, option_id, primary_map).kernel_key;
 }
 
 // setup a solution of a problem and insert to the map, should be called by a benchmarker
@@ -449,6 +731,8 @@ size_t solution_map::add_solution(const ProblemKey& probKey,
     solution.sol_node_type
         = (kernel_key == FMKey::EmptyFMKey()) ? SOL_BUILTIN_KERNEL : SOL_KERNEL_ONLY;
     solution.kernel_key = kernel_key;
+    if(solution.sol_node_type == SOL_KERNEL_ONLY)
+        solution.generator_sum = current_generator_sum();
 
     return add_solution(probKey, solution, false, check_dup, primary_map);
 }
@@ -500,7 +784,12 @@ size_t solution_map::add_solution(const ProblemKey&   probKey,
         {
             // find an existing solution that is identical, then don't insert, simply return that option
             if(SolutionNodesAreEqual(solution, sol_vec[check_option_id], arch, primary_map))
+            {
+                // a kernel that was tuned again is current as of the newer tuning
+                if(!solution.generator_sum.empty())
+                    sol_vec[check_option_id].generator_sum = solution.generator_sum;
                 return check_option_id;
+            }
         }
     }
 
@@ -534,6 +823,8 @@ bool solution_map::get_typed_nodes_of_tree(const SolutionNode&     root,
 
 bool solution_map::get_all_kernels(std::vector<SolutionNode>& sol_kernels, bool getUsedOnly)
 {
+    load_all_archives();
+
     // if get all, then we simply return all "SOL_KERNEL_ONLY" nodes
     if(!getUsedOnly)
     {
@@ -576,6 +867,69 @@ bool solution_map::get_all_kernels(std::vector<SolutionNode>& sol_kernels, bool
     return true;
 }
 
+bool solution_map::get_kernels_of_problems(const std::set<std::string>& prob_tokens,
+                                           std::vector<SolutionNode>&   sol_kernels,
+                                           std::set<std::string>&       missing_tokens)
+{
+    load_all_archives();
+
+    missing_tokens = prob_tokens;
+    std::set<SolutionNode> kernels_set; // to avoid duplicates
+    for(auto& [key, value] : primary_sol_map)
+    {
+        if(!prob_tokens.count(key.probToken) || value.empty())
+            continue;
+        missing_tokens.erase(key.probToken);
+
+        // the first option is the one plans use
+        get_typed_nodes_of_tree(value.front(), SOL_KERNEL_ONLY, kernels_set);
+    }
+
+    std::copy(kernels_set.begin(), kernels_set.end(), std::back_inserter(sol_kernels));
+    return true;
+}
+
+bool solution_map::get_stale_root_problems(std::vector<ProblemKey>& stale_probs)
+{
+    load_all_archives();
+
+    // root problems are found the same way as get_all_kernels does
+    for(auto& [key, value] : primary_sol_map)
+    {
+        SolutionNode& first_node = value.front();
+        if((first_node.sol_node_type != SOL_INTERNAL_NODE)
+           && !(first_node.sol_node_type == SOL_LEAF_NODE
+                && ComputeSchemeIsAProblem(first_node.using_scheme)))
+            continue;
+
+        std::set<SolutionNode> kernels_set;
+        get_typed_nodes_of_tree(first_node, SOL_KERNEL_ONLY, kernels_set);
+        for(const auto& kernel : kernels_set)
+        {
+            if(kernel.generator_sum != current_generator_sum())
+            {
+                stale_probs.push_back(key);
+                break;
+            }
+        }
+    }
+
+    std::sort(stale_probs.begin(), stale_probs.end());
+    return true;
+}
+
+const std::string& solution_map::current_generator_sum()
+{
+    static const std::string sum_str = []() {
+        std::stringstream ss;
+        ss << std::hex << std::setfill('0');
+        for(char c : generator_sum())
+            ss << std::setw(2) << (static_cast<unsigned int>(c) & 0xff);
+        return ss.str();
+    }();
+    return sum_str;
+}
+
 // parse the format version of the input file, call by converter
 bool solution_map::get_solution_map_version(const fs::path& sol_map_in_path)
 {
@@ -615,6 +969,21 @@ bool solution_map::read_solution_map_data(const fs::path& sol_map_in_path, bool
         (*LogSingleton::GetInstance().GetTraceOS())
             << "reading solution map data from: " << sol_map_in_path.c_str() << std::endl;
 
+    if(SolutionMapArchive::is_archive(sol_map_in_path))
+    {
+        if(primary_map)
+        {
+            archives.push_back({sol_map_in_path});
+            return true;
+        }
+
+        archive_source src{sol_map_in_path};
+        if(!map_archive(src))
+            return false;
+        add_entry_texts(src.archive->all_entries(), temp_working_map);
+        return true;
+    }
+
     // Read text from the file. If file not found, do nothing
     std::string solution_map_text = "";
     if(fs::exists(sol_map_in_path))
@@ -628,7 +997,7 @@ bool solution_map::read_solution_map_data(const fs::path& sol_map_in_path, bool
         }
     }
 
-    if(solution_map_text.back() == ']')
+    if(!solution_map_text.empty() && solution_map_text.back() == ']')
         solution_map_text.resize(solution_map_text.size() - 1);
 
     ProbSolMap& dst_map = (primary_map) ? primary_sol_map : temp_working_map;
@@ -695,7 +1064,7 @@ bool solution_map::read_solution_map_data(const fs::path& sol_map_in_path, bool
             dst_map.emplace(probKey, solutionVec);
         }
     }
-    else if(self_version == 1 || self_version == 2)
+    else if(self_version >= 1 && self_version <= solution_map::VERSION)
     {
         try
         {
@@ -735,6 +1104,9 @@ bool solution_map::write_solution_map_data(const fs::path& sol_map_out_path,
         throw std::runtime_error("Write solution map failed. Cannot open/create output file: "
                                  + sol_map_out_path.string());
 
+    if(primary_map)
+        load_all_archives();
+
     std::stringstream ss;
     ProbSolMap&       writing_map = (primary_map) ? primary_sol_map : temp_working_map;
 
@@ -761,6 +1133,33 @@ bool solution_map::write_solution_map_data(const fs::path& sol_map_out_path,
     return true;
 }
 
+bool solution_map::write_binary_solution_map_data(const fs::path& sol_map_out_path,
+                                                  bool            primary_map)
+{
+    if(LOG_TUNING_ENABLED())
+        (*LogSingleton::GetInstance().GetTuningOS())
+            << "writing binary solution map data to: " << sol_map_out_path.c_str() << std::endl;
+
+    if(primary_map)
+        load_all_archives();
+
+    ProbSolMap& writing_map = (primary_map) ? primary_sol_map : temp_working_map;
+
+    // entries are stored in the same form as the text map, so always
+    // write with the latest version format
+    DescriptorFormatVersion::UsingVersion = solution_map::VERSION;
+
+    std::vector<SolutionMapArchive::record> records;
+    records.reserve(writing_map.size());
+    for(auto& entry : writing_map)
+        records.push_back({entry.first.arch,
+                           entry.first.probToken,
+                           ToString<SolMapEntry>().print(SolMapEntry(entry.first, entry.second))});
+
+    SolutionMapArchive::write(sol_map_out_path, solution_map::VERSION, records);
+    return true;
+}
+
 bool solution_map::merge_solutions_from_file(const fs::path&                src_file,
                                              const std::vector<ProblemKey>& root_probs)
 {
@@ -928,7 +1327,8 @@ void SolutionMapConverter::remove_all_marked(ProbSolMap& target_map)
 }
 
 bool SolutionMapConverter::VersionCheckAndConvert(const std::string& in_map_path,
-                                                  const std::string& out_map_path)
+                                                  const std::string& out_map_path,
+                                                  bool               binary)
 {
     auto& sol_map = solution_map::get_solution_map();
 
@@ -942,7 +1342,7 @@ bool SolutionMapConverter::VersionCheckAndConvert(const std::string& in_map_path
             return false;
 
         bool has_conversion = sol_map.self_version != solution_map::VERSION;
-        if(!has_conversion)
+        if(!has_conversion && !binary)
         {
             std::cout << "solution map is already at the latest version.\n";
             return true;
@@ -964,6 +1364,8 @@ bool SolutionMapConverter::VersionCheckAndConvert(const std::string& in_map_path
 
         std::cout << "successfully converted solution map from version(" << sol_map.self_version
                   << ") to latest version(" << solution_map::VERSION << ").\n";
+        if(binary)
+            return sol_map.write_binary_solution_map_data(out_map_path);
         return sol_map.write_solution_map_data(out_map_path);
     }
     catch(const std::exception& e)
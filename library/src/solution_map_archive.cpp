@@ -0,0 +1,194 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "solution_map_archive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static const char     archive_magic[8] = {'R', 'O', 'C', 'F', 'F', 'T', 'S', 'M'};
+static const uint64_t archive_version  = 1;
+
+struct archive_header
+{
+    char     magic[8];
+    uint64_t version;
+    uint64_t map_version;
+    uint64_t entry_count;
+};
+static_assert(sizeof(archive_header) == 32, "unexpected archive header padding");
+
+struct archive_entry
+{
+    uint64_t hash;
+    uint64_t key_offset;
+    uint64_t key_len;
+    uint64_t text_offset;
+    uint64_t text_len;
+};
+static_assert(sizeof(archive_entry) == 40, "unexpected archive entry padding");
+
+// entries are looked up by the key "arch\0prob_token"
+static std::string archive_key(const std::string& arch, const std::string& prob_token)
+{
+    std::string key = arch;
+    key.push_back('\0');
+    key += prob_token;
+    return key;
+}
+
+SolutionMapArchive::SolutionMapArchive(const std::filesystem::path& path)
+    : mapping(path, "solution map archive")
+{
+    const char*  data = mapping.data();
+    const size_t size = mapping.size();
+
+    // check that the header and index are present.  offsets of
+    // individual entries are checked on lookup.
+    const auto header = reinterpret_cast<const archive_header*>(data);
+    if(size < sizeof(archive_header)
+       || std::memcmp(header->magic, archive_magic, sizeof(archive_magic)) != 0
+       || header->version != archive_version
+       || header->entry_count > (size - sizeof(archive_header)) / sizeof(archive_entry))
+        throw std::runtime_error("invalid solution map archive " + path.string());
+}
+
+bool SolutionMapArchive::is_archive(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char          magic[sizeof(archive_magic)] = {};
+    if(!file.read(magic, sizeof(magic)))
+        return false;
+    return std::memcmp(magic, archive_magic, sizeof(archive_magic)) == 0;
+}
+
+uint64_t SolutionMapArchive::map_version() const
+{
+    return reinterpret_cast<const archive_header*>(mapping.data())->map_version;
+}
+
+// return true if the entry's key and text are inside the mapping
+static bool entry_in_bounds(const archive_entry& e, size_t size)
+{
+    return e.key_offset <= size && e.key_len <= size - e.key_offset && e.text_offset <= size
+           && e.text_len <= size - e.text_offset;
+}
+
+std::string SolutionMapArchive::find(const std::string& arch, const std::string& prob_token) const
+{
+    auto key  = archive_key(arch, prob_token);
+    auto hash = fnv1a_hash(key);
+
+    const char*  data   = mapping.data();
+    const size_t size   = mapping.size();
+    const auto   header = reinterpret_cast<const archive_header*>(data);
+    const auto   begin  = reinterpret_cast<const archive_entry*>(data + sizeof(archive_header));
+    const auto   end    = begin + header->entry_count;
+    auto         it     = std::lower_bound(
+        begin, end, hash, [](const archive_entry& e, uint64_t h) { return e.hash < h; });
+
+    // entries with colliding hashes are adjacent, compare their keys
+    for(; it != end && it->hash == hash; ++it)
+    {
+        if(!entry_in_bounds(*it, size))
+            return {};
+        if(it->key_len == key.size()
+           && std::memcmp(data + it->key_offset, key.data(), key.size()) == 0)
+            return std::string(data + it->text_offset, it->text_len);
+    }
+    return {};
+}
+
+std::vector<std::string> SolutionMapArchive::all_entries() const
+{
+    const char*  data   = mapping.data();
+    const size_t size   = mapping.size();
+    const auto   header = reinterpret_cast<const archive_header*>(data);
+    const auto   begin  = reinterpret_cast<const archive_entry*>(data + sizeof(archive_header));
+
+    std::vector<std::string> ret;
+    ret.reserve(header->entry_count);
+    for(auto it = begin; it != begin + header->entry_count; ++it)
+    {
+        if(entry_in_bounds(*it, size))
+            ret.emplace_back(data + it->text_offset, it->text_len);
+    }
+    return ret;
+}
+
+void SolutionMapArchive::write(const std::filesystem::path& path,
+                               uint64_t                     map_version,
+                               const std::vector<record>&   records)
+{
+    struct sorted_record
+    {
+        std::string   key;
+        uint64_t      hash;
+        const record* rec;
+    };
+    std::vector<sorted_record> sorted;
+    sorted.reserve(records.size());
+    for(const auto& r : records)
+    {
+        auto key = archive_key(r.arch, r.prob_token);
+        auto h   = fnv1a_hash(key);
+        sorted.push_back({std::move(key), h, &r});
+    }
+    // sort by key as well as hash, so the output is reproducible
+    std::sort(sorted.begin(), sorted.end(), [](const sorted_record& a, const sorted_record& b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.key < b.key;
+    });
+
+    archive_header header;
+    std::memcpy(header.magic, archive_magic, sizeof(archive_magic));
+    header.version     = archive_version;
+    header.map_version = map_version;
+    header.entry_count = sorted.size();
+
+    // lay out keys after the index, then entry text
+    std::vector<archive_entry> entries(sorted.size());
+    uint64_t offset = sizeof(archive_header) + sizeof(archive_entry) * sorted.size();
+    for(size_t i = 0; i < sorted.size(); ++i)
+    {
+        entries[i].hash       = sorted[i].hash;
+        entries[i].key_offset = offset;
+        entries[i].key_len    = sorted[i].key.size();
+        offset += sorted[i].key.size();
+    }
+    for(size_t i = 0; i < sorted.size(); ++i)
+    {
+        entries[i].text_offset = offset;
+        entries[i].text_len    = sorted[i].rec->text.size();
+        offset += sorted[i].rec->text.size();
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              sizeof(archive_entry) * entries.size());
+    for(const auto& s : sorted)
+        out.write(s.key.data(), s.key.size());
+    for(const auto& s : sorted)
+        out.write(s.rec->text.data(), s.rec->text.size());
+    if(!out)
+        throw std::runtime_error("failed to write solution map archive " + path.string());
+}
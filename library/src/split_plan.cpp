@@ -0,0 +1,563 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../shared/array_predicate.h"
+#include "../../shared/gpubuf.h"
+#include "../../shared/hip_object_wrapper.h"
+#include "../../shared/precision_type.h"
+#include "../../shared/rocfft_hip.h"
+#include "batch_layout.h"
+#include "logging.h"
+#include "plan.h"
+#include "rocfft/rocfft.h"
+#include "transform.h"
+
+// A split plan divides the batch of a transform between several
+// devices.  Transforms in a batch are independent, so each device
+// gets a contiguous range of the batch and an ordinary plan for that
+// many transforms, and the devices never exchange data.
+//
+// The batch can be given to the plan already divided, as one buffer
+// per device, or in buffers on the calling device, which are
+// scattered to buffers owned by each device and gathered back.
+struct rocfft_split_plan_t
+{
+    // the part of the batch run by one device
+    struct DeviceShare
+    {
+        int    deviceId = 0;
+        size_t first    = 0;
+        size_t count    = 0;
+
+        rocfft_plan           plan = nullptr;
+        rocfft_execution_info info = nullptr;
+        hipStream_wrapper_t   stream;
+
+        // buffers that share is scattered to, allocated when first
+        // needed
+        std::array<gpubuf, 2> inBuf;
+        std::array<gpubuf, 2> outBuf;
+
+        DeviceShare() = default;
+        ~DeviceShare()
+        {
+            (void)rocfft_execution_info_destroy(info);
+            (void)rocfft_plan_destroy(plan);
+        }
+        DeviceShare(const DeviceShare&) = delete;
+        DeviceShare& operator=(const DeviceShare&) = delete;
+    };
+
+    rocfft_split_plan_t() = default;
+    ~rocfft_split_plan_t();
+
+    rocfft_split_plan_t(const rocfft_split_plan_t&) = delete;
+    rocfft_split_plan_t& operator=(const rocfft_split_plan_t&) = delete;
+
+    rocfft_result_placement placement = rocfft_placement_inplace;
+
+    // one share per device in the list, some of which may be empty
+    // if the batch is smaller than the number of devices
+    std::vector<std::unique_ptr<DeviceShare>> shares;
+
+    batch_layout_t InLayout() const;
+    batch_layout_t OutLayout() const;
+
+    // plan of the first non-empty share, which describes the layout
+    // that all shares have in common
+    const rocfft_plan_t& Layout() const;
+
+    void ExecuteLocal(void* in_buffers[], void* out_buffers[]);
+    void Execute(void* in_buffer[], void* out_buffer[]);
+
+private:
+    void Synchronize();
+};
+
+rocfft_split_plan_t::~rocfft_split_plan_t()
+{
+    // device resources must be freed on their own device
+    for(auto& s : shares)
+    {
+        try
+        {
+            rocfft_scoped_device dev(s->deviceId);
+            s.reset();
+        }
+        catch(std::exception&)
+        {
+            s.reset();
+        }
+    }
+}
+
+const rocfft_plan_t& rocfft_split_plan_t::Layout() const
+{
+    for(const auto& s : shares)
+    {
+        if(s->plan)
+            return *s->plan;
+    }
+    throw std::runtime_error("split plan has no transforms");
+}
+
+batch_layout_t rocfft_split_plan_t::InLayout() const
+{
+    return batch_layout_t::input(Layout());
+}
+
+batch_layout_t rocfft_split_plan_t::OutLayout() const
+{
+    return batch_layout_t::output(Layout());
+}
+
+void rocfft_split_plan_t::Synchronize()
+{
+    for(auto& s : shares)
+    {
+        if(!s->count)
+            continue;
+        if(hipStreamSynchronize(s->stream) != hipSuccess)
+            throw std::runtime_error("hipStreamSynchronize failed");
+    }
+}
+
+void rocfft_split_plan_t::ExecuteLocal(void* in_buffers[], void* out_buffers[])
+{
+    const size_t inPtrs  = InLayout().num_pointers();
+    const size_t outPtrs = OutLayout().num_pointers();
+    const bool   inplace = placement == rocfft_placement_inplace;
+
+    // launch on every device before waiting for any of them
+    for(size_t d = 0; d < shares.size(); ++d)
+    {
+        auto& s = *shares[d];
+        if(!s.count)
+            continue;
+        rocfft_scoped_device dev(s.deviceId);
+        auto                 in  = in_buffers + d * inPtrs;
+        auto                 out = inplace ? nullptr : out_buffers + d * outPtrs;
+        s.plan->Execute(in, inplace ? in : out, s.info);
+    }
+    Synchronize();
+}
+
+void rocfft_split_plan_t::Execute(void* in_buffer[], void* out_buffer[])
+{
+    int homeDevice = 0;
+    if(hipGetDevice(&homeDevice) != hipSuccess)
+        throw std::runtime_error("hipGetDevice failed");
+
+    const auto   inLayout  = InLayout();
+    const auto   outLayout = OutLayout();
+    const size_t inPtrs    = inLayout.num_pointers();
+    const size_t outPtrs   = outLayout.num_pointers();
+    const bool   inplace   = placement == rocfft_placement_inplace;
+
+    // results of in-place transforms go back to the input buffers
+    auto resultHome = inplace ? in_buffer : out_buffer;
+
+    for(auto& sPtr : shares)
+    {
+        auto& s = *sPtr;
+        if(!s.count)
+            continue;
+        rocfft_scoped_device dev(s.deviceId);
+
+        // a share on the calling device runs on the user's buffers
+        // directly, and its plan applies the offsets itself
+        if(s.deviceId == homeDevice)
+        {
+            std::array<void*, 2> in  = {};
+            std::array<void*, 2> out = {};
+            for(size_t i = 0; i < inPtrs; ++i)
+                in[i] = static_cast<char*>(in_buffer[i]) + inLayout.transform_start(s.first);
+            for(size_t i = 0; !inplace && i < outPtrs; ++i)
+                out[i] = static_cast<char*>(out_buffer[i]) + outLayout.transform_start(s.first);
+            s.plan->Execute(in.data(), inplace ? in.data() : out.data(), s.info);
+            continue;
+        }
+
+        for(size_t i = 0; i < inPtrs; ++i)
+        {
+            auto bytes = inLayout.buffer_bytes(i, s.count);
+            if(inplace && i < outPtrs)
+                bytes = std::max(bytes, outLayout.buffer_bytes(i, s.count));
+            if(!s.inBuf[i].data() && s.inBuf[i].alloc(bytes) != hipSuccess)
+                throw std::runtime_error("split plan buffer allocation failure");
+        }
+        for(size_t i = 0; !inplace && i < outPtrs; ++i)
+        {
+            if(!s.outBuf[i].data()
+               && s.outBuf[i].alloc(outLayout.buffer_bytes(i, s.count)) != hipSuccess)
+                throw std::runtime_error("split plan buffer allocation failure");
+        }
+
+        // scatter, transform and gather on the share's stream, so
+        // that the devices work concurrently.  Only the share's own
+        // transforms are copied, to and from the plan's offsets in
+        // the device's buffers.
+        std::array<void*, 2> devIn  = {s.inBuf[0].data(), s.inBuf[1].data()};
+        std::array<void*, 2> devOut = {s.outBuf[0].data(), s.outBuf[1].data()};
+        for(size_t i = 0; i < inPtrs; ++i)
+        {
+            auto src = static_cast<char*>(in_buffer[i]) + inLayout.span_start(i, s.first);
+            if(hipMemcpyPeerAsync(static_cast<char*>(devIn[i]) + inLayout.offset_bytes(i),
+                                  s.deviceId,
+                                  src,
+                                  homeDevice,
+                                  inLayout.span_bytes(s.count),
+                                  s.stream)
+               != hipSuccess)
+                throw std::runtime_error("split plan scatter failed");
+        }
+
+        s.plan->Execute(devIn.data(), inplace ? devIn.data() : devOut.data(), s.info);
+
+        auto& result = inplace ? devIn : devOut;
+        for(size_t i = 0; i < outPtrs; ++i)
+        {
+            if(hipMemcpyPeerAsync(static_cast<char*>(resultHome[i])
+                                      + outLayout.span_start(i, s.first),
+                                  homeDevice,
+                                  static_cast<char*>(result[i]) + outLayout.offset_bytes(i),
+                                  s.deviceId,
+                                  outLayout.span_bytes(s.count),
+                                  s.stream)
+               != hipSuccess)
+                throw std::runtime_error("split plan gather failed");
+        }
+    }
+    Synchronize();
+}
+
+// relative speed of a device, for dividing the batch.  FFTs are
+// usually limited by memory bandwidth, so estimate that from the
+// device's memory clock and bus width, and fall back to its compute
+// throughput if those aren't reported.
+static double device_speed(int deviceId)
+{
+    hipDeviceProp_t prop;
+    if(hipGetDeviceProperties(&prop, deviceId) != hipSuccess)
+        throw std::runtime_error("hipGetDeviceProperties failed");
+    double speed = static_cast<double>(prop.memoryClockRate) * prop.memoryBusWidth;
+    if(speed <= 0.0)
+        speed = static_cast<double>(prop.clockRate) * prop.multiProcessorCount;
+    return speed > 0.0 ? speed : 1.0;
+}
+
+// divide batch transforms in proportion to the weights, giving any
+// remainder to the devices whose exact shares were rounded down the
+// most
+static std::vector<size_t> divide_batch(size_t batch, const std::vector<double>& weights)
+{
+    const double total = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    std::vector<size_t> counts(weights.size());
+    std::vector<double> remainders(weights.size());
+    size_t              assigned = 0;
+    for(size_t i = 0; i < weights.size(); ++i)
+    {
+        const double exact = batch * weights[i] / total;
+        counts[i]          = static_cast<size_t>(std::floor(exact));
+        remainders[i]      = exact - counts[i];
+        assigned += counts[i];
+    }
+
+    std::vector<size_t> order(weights.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return remainders[a] > remainders[b];
+    });
+    // rounding error can leave more than one transform per device,
+    // so go around again if necessary, skipping devices that were
+    // given no weight
+    for(size_t i = 0; assigned < batch; i = (i + 1) % order.size())
+    {
+        if(weights[order[i]] > 0.0)
+        {
+            ++counts[order[i]];
+            ++assigned;
+        }
+    }
+    return counts;
+}
+
+rocfft_status rocfft_split_plan_create(rocfft_split_plan*            plan,
+                                       rocfft_result_placement       placement,
+                                       rocfft_transform_type         transform_type,
+                                       rocfft_precision              precision,
+                                       size_t                        dimensions,
+                                       const size_t*                 lengths,
+                                       size_t                        number_of_transforms,
+                                       const rocfft_plan_description description,
+                                       const int*                    devices,
+                                       size_t                        num_devices,
+                                       const double*                 weights)
+{
+    log_trace(__func__,
+              "plan",
+              plan,
+              "placement",
+              placement,
+              "transform_type",
+              transform_type,
+              "precision",
+              precision,
+              "dimensions",
+              dimensions,
+              "lengths",
+              std::make_pair(lengths, dimensions),
+              "number_of_transforms",
+              number_of_transforms,
+              "description",
+              description,
+              "devices",
+              devices,
+              "num_devices",
+              num_devices,
+              "weights",
+              weights);
+
+    if(!plan || !lengths || !number_of_transforms || !devices || !num_devices)
+        return rocfft_status_invalid_arg_value;
+
+    // the batch is divided here, so the description can't also ask
+    // for the transform to be distributed or staged
+    if(description
+       && (description->comm_type != rocfft_comm_none || !description->inFields.empty()
+           || !description->outFields.empty() || !description->devices.empty()
+           || description->hostBuffers || description->batchTile != 1))
+        return rocfft_status_invalid_arg_value;
+
+    int deviceCount = 0;
+    if(hipGetDeviceCount(&deviceCount) != hipSuccess)
+        return rocfft_status_failure;
+    for(size_t i = 0; i < num_devices; ++i)
+    {
+        if(devices[i] < 0 || devices[i] >= deviceCount
+           || std::find(devices, devices + i, devices[i]) != devices + i)
+            return rocfft_status_invalid_arg_value;
+        if(weights && !(std::isfinite(weights[i]) && weights[i] >= 0.0))
+            return rocfft_status_invalid_arg_value;
+    }
+    if(weights && std::all_of(weights, weights + num_devices, [](double w) { return w == 0.0; }))
+        return rocfft_status_invalid_arg_value;
+
+    try
+    {
+        auto split       = std::make_unique<rocfft_split_plan_t>();
+        split->placement = placement;
+
+        std::vector<double> speeds(num_devices);
+        for(size_t i = 0; i < num_devices; ++i)
+            speeds[i] = weights ? weights[i] : device_speed(devices[i]);
+        const auto counts = divide_batch(number_of_transforms, speeds);
+
+        size_t first = 0;
+        for(size_t i = 0; i < num_devices; ++i)
+        {
+            split->shares.emplace_back(std::make_unique<rocfft_split_plan_t::DeviceShare>());
+            auto& s    = *split->shares.back();
+            s.deviceId = devices[i];
+            s.first    = first;
+            s.count    = counts[i];
+            first += counts[i];
+            if(!s.count)
+                continue;
+
+            rocfft_scoped_device dev(s.deviceId);
+
+            auto status = rocfft_plan_create(&s.plan,
+                                             placement,
+                                             transform_type,
+                                             precision,
+                                             dimensions,
+                                             lengths,
+                                             s.count,
+                                             description);
+            if(status != rocfft_status_success)
+                return status;
+            status = s.plan->WaitCreate();
+            if(status != rocfft_status_success)
+                return status;
+
+            s.stream.alloc();
+            if(rocfft_execution_info_create(&s.info) != rocfft_status_success)
+                throw std::runtime_error("failed to create execution info");
+            (void)rocfft_execution_info_set_stream(s.info, s.stream);
+        }
+
+        // each share's results are written as one span, which would
+        // overwrite other shares' results if transforms are
+        // interleaved
+        const auto busyShares
+            = std::count_if(split->shares.begin(), split->shares.end(), [](const auto& s) {
+                  return s->count > 0;
+              });
+        if(busyShares > 1 && split->OutLayout().transforms_overlap())
+        {
+            if(LOG_TRACE_ENABLED())
+                (*LogSingleton::GetInstance().GetTraceOS())
+                    << "split plan output transforms overlap in memory" << std::endl;
+            return rocfft_status_invalid_arg_value;
+        }
+
+        if(LOG_PLAN_ENABLED())
+        {
+            for(const auto& s : split->shares)
+            {
+                if(LOG_JSON_ENABLED())
+                    log_json_arguments(*LogSingleton::GetInstance().GetPlanOS(),
+                                       "split_plan_share",
+                                       "device",
+                                       s->deviceId,
+                                       "first",
+                                       s->first,
+                                       "count",
+                                       s->count);
+                else
+                    *LogSingleton::GetInstance().GetPlanOS()
+                        << "split plan: device " << s->deviceId << " runs " << s->count
+                        << " transforms from " << s->first << std::endl;
+            }
+        }
+
+        *plan = split.release();
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_split_plan_get_share(const rocfft_split_plan plan,
+                                          size_t                  device_index,
+                                          size_t*                 first_transform,
+                                          size_t*                 num_transforms)
+{
+    log_trace(__func__,
+              "plan",
+              plan,
+              "device_index",
+              device_index,
+              "first_transform",
+              first_transform,
+              "num_transforms",
+              num_transforms);
+
+    if(!plan || device_index >= plan->shares.size() || !first_transform || !num_transforms)
+        return rocfft_status_invalid_arg_value;
+
+    *first_transform = plan->shares[device_index]->first;
+    *num_transforms  = plan->shares[device_index]->count;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_split_plan_execute(const rocfft_split_plan plan,
+                                        void*                   in_buffer[],
+                                        void*                   out_buffer[])
+{
+    log_trace(__func__, "plan", plan, "in_buffer", in_buffer, "out_buffer", out_buffer);
+
+    if(!plan || !in_buffer)
+        return rocfft_status_invalid_arg_value;
+    if(plan->placement == rocfft_placement_notinplace && !out_buffer)
+        return rocfft_status_invalid_arg_value;
+
+    try
+    {
+        plan->Execute(in_buffer, out_buffer);
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    catch(rocfft_status e)
+    {
+        return e;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_split_plan_execute_local(const rocfft_split_plan plan,
+                                              void*                   in_buffers[],
+                                              void*                   out_buffers[])
+{
+    log_trace(__func__, "plan", plan, "in_buffers", in_buffers, "out_buffers", out_buffers);
+
+    if(!plan || !in_buffers)
+        return rocfft_status_invalid_arg_value;
+    if(plan->placement == rocfft_placement_notinplace && !out_buffers)
+        return rocfft_status_invalid_arg_value;
+
+    try
+    {
+        plan->ExecuteLocal(in_buffers, out_buffers);
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    catch(rocfft_status e)
+    {
+        return e;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_split_plan_destroy(rocfft_split_plan plan)
+{
+    log_trace(__func__, "plan", plan);
+
+    if(!plan)
+        return rocfft_status_success;
+
+    try
+    {
+        delete plan;
+    }
+    catch(std::exception&)
+    {
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
@@ -0,0 +1,147 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "stream_pool.h"
+
+static int current_device()
+{
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        return -1;
+    return deviceId;
+}
+
+hipStream_t StreamPool::AcquireStream()
+{
+    auto deviceId = current_device();
+    if(deviceId < 0)
+        return nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto&                       free = streams[deviceId];
+        if(!free.empty())
+        {
+            auto stream = free.back();
+            free.pop_back();
+            return stream;
+        }
+    }
+
+    hipStream_t stream = nullptr;
+    if(hipStreamCreateWithFlags(&stream, hipStreamNonBlocking) != hipSuccess)
+        return nullptr;
+    return stream;
+}
+
+hipEvent_t StreamPool::AcquireEvent()
+{
+    auto deviceId = current_device();
+    if(deviceId < 0)
+        return nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto&                       free = events[deviceId];
+        if(!free.empty())
+        {
+            auto event = free.back();
+            free.pop_back();
+            return event;
+        }
+    }
+
+    hipEvent_t event = nullptr;
+    if(hipEventCreateWithFlags(&event, hipEventDisableTiming) != hipSuccess)
+        return nullptr;
+    return event;
+}
+
+void StreamPool::ReleaseStream(hipStream_t stream)
+{
+    if(!stream)
+        return;
+    auto deviceId = current_device();
+    if(deviceId < 0)
+    {
+        (void)hipStreamDestroy(stream);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    streams[deviceId].push_back(stream);
+}
+
+void StreamPool::ReleaseEvent(hipEvent_t event)
+{
+    if(!event)
+        return;
+    auto deviceId = current_device();
+    if(deviceId < 0)
+    {
+        (void)hipEventDestroy(event);
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    events[deviceId].push_back(event);
+}
+
+void StreamPool::Clear()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for(auto& s : streams)
+    {
+        for(auto stream : s.second)
+            (void)hipStreamDestroy(stream);
+    }
+    for(auto& e : events)
+    {
+        for(auto event : e.second)
+            (void)hipEventDestroy(event);
+    }
+    streams.clear();
+    events.clear();
+}
+
+bool PooledStreams::alloc(size_t streamCount, size_t eventCount)
+{
+    auto& pool = StreamPool::GetPool();
+    while(streams.size() < streamCount)
+    {
+        auto stream = pool.AcquireStream();
+        if(!stream)
+            return false;
+        streams.push_back(stream);
+    }
+    while(events.size() < eventCount)
+    {
+        auto event = pool.AcquireEvent();
+        if(!event)
+            return false;
+        events.push_back(event);
+    }
+    return true;
+}
+
+PooledStreams::~PooledStreams()
+{
+    auto& pool = StreamPool::GetPool();
+    for(auto stream : streams)
+        pool.ReleaseStream(stream);
+    for(auto event : events)
+        pool.ReleaseEvent(event);
+}
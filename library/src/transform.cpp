@@ -20,7 +20,9 @@
 * THE SOFTWARE.
 *******************************************************************************/
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <vector>
@@ -30,7 +32,10 @@
 #include "logging.h"
 #include "plan.h"
 #include "rocfft/rocfft.h"
+#include "rtc_cache.h"
+#include "rtc_generic_kernel.h"
 #include "transform.h"
+#include "work_buffer_pool.h"
 
 rocfft_status rocfft_execution_info_create(rocfft_execution_info* info)
 {
@@ -70,6 +75,279 @@ rocfft_status rocfft_execution_info_set_stream(rocfft_execution_info info, void*
     return rocfft_status_success;
 }
 
+rocfft_status rocfft_execution_info_set_stream_priority(rocfft_execution_info info, int priority)
+{
+    log_trace(__func__, "info", info, "priority", priority);
+    if(!info)
+        return rocfft_status_invalid_arg_value;
+    info->streamPriority = priority;
+    return rocfft_status_success;
+}
+
+void alloc_internal_stream(hipStream_wrapper_t&  stream,
+                           const rocfft_plan     plan,
+                           rocfft_execution_info info)
+{
+    // HIP can't create a stream with both a CU mask and a priority
+    const auto& cuMask = plan->desc.cuMask;
+    if(!cuMask.empty())
+    {
+        stream.alloc_with([&cuMask](hipStream_t* s) {
+            return hipExtStreamCreateWithCUMask(s, cuMask.size(), cuMask.data());
+        });
+        return;
+    }
+
+    // clamp to the device's range, so that the stream's priority
+    // can be compared with the requested one
+    int priority = info ? info->streamPriority : 0;
+    int least    = 0;
+    int greatest = 0;
+    if(priority != 0 && hipDeviceGetStreamPriorityRange(&least, &greatest) == hipSuccess)
+        priority = std::min(std::max(priority, greatest), least);
+
+    if(stream)
+    {
+        int current = 0;
+        if(hipStreamGetPriority(stream, &current) == hipSuccess && current == priority)
+            return;
+        // work already queued on the old stream still runs
+        stream.free();
+    }
+    stream.alloc_with([priority](hipStream_t* s) {
+        return hipStreamCreateWithPriority(s, hipStreamDefault, priority);
+    });
+}
+
+rocfft_status rocfft_execution_info_set_capture_mode(rocfft_execution_info info, int capture)
+{
+    log_trace(__func__, "info", info, "capture", capture);
+    if(!info)
+        return rocfft_status_invalid_arg_value;
+    info->captureMode = capture != 0;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_execution_info_set_batch(rocfft_execution_info info, size_t batch)
+{
+    log_trace(__func__, "info", info, "batch", batch);
+    if(!info)
+        return rocfft_status_invalid_arg_value;
+    info->batch = batch;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_execution_info_set_profile(rocfft_execution_info info, size_t max_kernels)
+{
+    log_trace(__func__, "info", info, "max_kernels", max_kernels);
+    if(!info)
+        return rocfft_status_invalid_arg_value;
+    info->profile = max_kernels ? std::make_shared<ExecutionProfile>(max_kernels) : nullptr;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_execution_info_get_profile(rocfft_execution_info  info,
+                                                rocfft_kernel_profile* records,
+                                                size_t*                num_records)
+{
+    log_trace(__func__, "info", info, "records", records, "num_records", num_records);
+    if(!info || !num_records)
+        return rocfft_status_invalid_arg_value;
+    if(!info->profile)
+    {
+        *num_records = 0;
+        return rocfft_status_success;
+    }
+    try
+    {
+        info->profile->Harvest();
+        *num_records = records ? info->profile->Take(records, *num_records)
+                               : info->profile->FinishedCount();
+    }
+    catch(std::exception&)
+    {
+        return rocfft_status_failure;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_execution_info_set_item_timing(rocfft_execution_info info, size_t max_items)
+{
+    log_trace(__func__, "info", info, "max_items", max_items);
+    if(!info)
+        return rocfft_status_invalid_arg_value;
+    info->itemTimes = max_items ? std::make_shared<ExecutionItemTimes>(max_items) : nullptr;
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_execution_info_get_item_times(rocfft_execution_info  info,
+                                                   rocfft_plan_item_time* records,
+                                                   size_t*                num_records)
+{
+    log_trace(__func__, "info", info, "records", records, "num_records", num_records);
+    if(!info || !num_records)
+        return rocfft_status_invalid_arg_value;
+    if(!info->itemTimes)
+    {
+        *num_records = 0;
+        return rocfft_status_success;
+    }
+    *num_records = records ? info->itemTimes->Take(records, *num_records)
+                           : info->itemTimes->Count();
+    return rocfft_status_success;
+}
+
+void ExecutionProfile::StartExecution()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    HarvestLocked();
+    current = executions++;
+}
+
+size_t ExecutionProfile::Begin(hipStream_t stream)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // reuse the oldest slot.  If its kernel hasn't finished, its
+    // time is lost.
+    const size_t idx  = next;
+    auto&        slot = slots[idx];
+    next              = (next + 1) % slots.size();
+    HarvestSlot(slot);
+
+    // events must be created on the device whose stream records them
+    int device = 0;
+    if(hipGetDevice(&device) != hipSuccess)
+        throw std::runtime_error("hipGetDevice failure");
+    if(slot.device != device)
+    {
+        slot.start.free();
+        slot.stop.free();
+        slot.start.alloc();
+        slot.stop.alloc();
+        slot.device = device;
+    }
+    if(hipEventRecord(slot.start, stream) != hipSuccess)
+        throw std::runtime_error("hipEventRecord failure");
+    slot.pending = false;
+    return idx;
+}
+
+void ExecutionProfile::End(size_t      idx,
+                           hipStream_t stream,
+                           size_t      kernel_index,
+                           size_t      bytes_moved)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto&                       slot = slots[idx];
+    if(hipEventRecord(slot.stop, stream) != hipSuccess)
+        throw std::runtime_error("hipEventRecord failure");
+    slot.record.execution_index = current;
+    slot.record.kernel_index    = kernel_index;
+    slot.record.device          = slot.device;
+    slot.record.bytes_moved     = bytes_moved;
+    slot.pending                = true;
+}
+
+void ExecutionProfile::Harvest()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    HarvestLocked();
+}
+
+void ExecutionProfile::HarvestLocked()
+{
+    // visit slots oldest first, so finished times stay in launch
+    // order.  Kernels on other streams may finish out of order, so
+    // keep looking past ones that haven't finished.
+    for(size_t i = 0; i < slots.size(); ++i)
+        HarvestSlot(slots[(next + i) % slots.size()]);
+}
+
+void ExecutionProfile::HarvestSlot(Slot& slot)
+{
+    if(!slot.pending || hipEventQuery(slot.stop) != hipSuccess)
+        return;
+    if(hipEventElapsedTime(&slot.record.duration_ms, slot.start, slot.stop) != hipSuccess)
+        throw std::runtime_error("hipEventElapsedTime failure");
+    slot.pending = false;
+
+    log_profile("ExecutionProfile",
+                "execution_index",
+                slot.record.execution_index,
+                "kernel_index",
+                slot.record.kernel_index,
+                "device",
+                slot.record.device,
+                "duration_ms",
+                slot.record.duration_ms,
+                "total_size_bytes",
+                slot.record.bytes_moved);
+
+    // hold at most as many finished times as there are slots,
+    // dropping the oldest
+    if(finished.size() == slots.size())
+        finished.erase(finished.begin());
+    finished.push_back(slot.record);
+}
+
+size_t ExecutionProfile::Take(rocfft_kernel_profile* records, size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    count = std::min(count, finished.size());
+    std::copy_n(finished.begin(), count, records);
+    finished.erase(finished.begin(), finished.begin() + count);
+    return count;
+}
+
+size_t ExecutionProfile::FinishedCount()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return finished.size();
+}
+
+size_t ExecutionItemTimes::StartExecution()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return executions++;
+}
+
+void ExecutionItemTimes::Add(const rocfft_plan_item_time& record)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(finished.size() == capacity)
+        finished.erase(finished.begin());
+    finished.push_back(record);
+}
+
+size_t ExecutionItemTimes::Take(rocfft_plan_item_time* records, size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    count = std::min(count, finished.size());
+    std::copy_n(finished.begin(), count, records);
+    finished.erase(finished.begin(), finished.begin() + count);
+    return count;
+}
+
+size_t ExecutionItemTimes::Count()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return finished.size();
+}
+
+// ExecPlans around communication are described as packing or
+// unpacking data, and everything else they do is FFT work
+static rocfft_plan_item_phase item_phase(const MultiPlanItem& item)
+{
+    if(!dynamic_cast<const ExecPlan*>(&item))
+        return rocfft_plan_item_phase_communication;
+    if(item.description.compare(0, 6, "unpack") == 0)
+        return rocfft_plan_item_phase_unpack;
+    if(item.description.compare(0, 4, "pack") == 0)
+        return rocfft_plan_item_phase_pack;
+    return rocfft_plan_item_phase_fft;
+}
+
 rocfft_status rocfft_execution_info_set_load_callback(rocfft_execution_info info,
                                                       void**                cb_functions,
                                                       void**                cb_data,
@@ -102,34 +380,68 @@ rocfft_status rocfft_execution_info_set_store_callback(rocfft_execution_info inf
     return rocfft_status_success;
 }
 
-std::vector<size_t> rocfft_plan_t::MultiPlanTopologicalSort() const
+rocfft_status rocfft_execution_info_set_pass_store_callback(rocfft_execution_info info,
+                                                            size_t                pass,
+                                                            void**                cb_functions,
+                                                            void**                cb_data,
+                                                            size_t shared_mem_bytes)
 {
-    std::vector<size_t> ret;
-    std::vector<bool>   visited(multiPlan.size(), false);
+    if(shared_mem_bytes)
+        return rocfft_status_invalid_arg_value;
 
-    for(size_t idx = 0; idx < visited.size(); ++idx)
+    if(!cb_functions || !cb_functions[0])
     {
-        if(!visited[idx])
-        {
-            TopologicalSortDFS(idx, visited, ret);
-        }
+        info->pass_callbacks.erase(pass);
+        return rocfft_status_success;
     }
-    return ret;
+
+    auto& callbacks              = info->pass_callbacks[pass];
+    callbacks.store_cb_fn        = cb_functions[0];
+    callbacks.store_cb_data      = cb_data ? cb_data[0] : nullptr;
+    callbacks.store_cb_lds_bytes = shared_mem_bytes;
+    return rocfft_status_success;
 }
 
-void rocfft_plan_t::TopologicalSortDFS(size_t               idx,
-                                       std::vector<bool>&   visited,
-                                       std::vector<size_t>& sorted) const
+std::vector<size_t> rocfft_plan_t::MultiPlanTopologicalSort() const
 {
-    visited[idx] = true;
-    for(auto adjacent : multiPlanAntecedents[idx])
+    // count unfinished antecedents of each item, and remember which
+    // items each item is an antecedent of
+    std::vector<size_t>              pending(multiPlan.size());
+    std::vector<std::vector<size_t>> successors(multiPlan.size());
+    for(size_t idx = 0; idx < multiPlan.size(); ++idx)
+    {
+        pending[idx] = multiPlanAntecedents[idx].size();
+        for(auto antecedent : multiPlanAntecedents[idx])
+            successors[antecedent].push_back(idx);
+    }
+
+    // stack of items whose antecedents are all issued.  Push in
+    // reverse so lower indexes are issued first.
+    std::vector<size_t> ready;
+    for(size_t idx = multiPlan.size(); idx-- > 0;)
     {
-        if(!visited[adjacent])
+        if(pending[idx] == 0)
+            ready.push_back(idx);
+    }
+
+    std::vector<size_t> ret;
+    ret.reserve(multiPlan.size());
+    while(!ready.empty())
+    {
+        auto idx = ready.back();
+        ready.pop_back();
+        ret.push_back(idx);
+
+        // items that just became ready go on top of the stack, so
+        // they're issued before older ready items
+        const auto& succ = successors[idx];
+        for(auto s = succ.rbegin(); s != succ.rend(); ++s)
         {
-            TopologicalSortDFS(adjacent, visited, sorted);
+            if(--pending[*s] == 0)
+                ready.push_back(*s);
         }
     }
-    sorted.push_back(idx);
+    return ret;
 }
 
 void rocfft_plan_t::LogFields(const char* description, const std::vector<rocfft_field_t>& fields)
@@ -175,12 +487,75 @@ void rocfft_plan_t::LogFields(const char* description, const std::vector<rocfft_
     }
 }
 
+// log one JSON record per kernel of each ExecPlan in the multi-plan
+static void LogPlanKernelsJSON(const std::vector<std::unique_ptr<MultiPlanItem>>& multiPlan,
+                               const std::vector<size_t>&                        sortedIdx)
+{
+    auto& os = *LogSingleton::GetInstance().GetPlanOS();
+    for(auto idx : sortedIdx)
+    {
+        auto exec = dynamic_cast<const ExecPlan*>(multiPlan[idx].get());
+        if(!exec)
+            continue;
+        for(size_t i = 0; i < exec->execSeq.size(); ++i)
+        {
+            const auto* node = exec->execSeq[i];
+
+            std::string kernel_name;
+            if(auto fallbackKernel = rtc_fallback_kernel(*node))
+                kernel_name = fallbackKernel->kernel_name;
+            else if(node->compiledKernel.valid() && node->compiledKernel.get())
+                kernel_name = node->compiledKernel.get()->kernel_name;
+
+            GridParam gp;
+            if(i < exec->gridParam.size())
+                gp = exec->gridParam[i];
+
+            log_json_arguments(os,
+                               "plan_kernel",
+                               "multi_plan_index",
+                               idx,
+                               "kernel_index",
+                               i,
+                               "device",
+                               exec->location.device,
+                               "scheme",
+                               PrintScheme(node->scheme),
+                               "kernel_name",
+                               kernel_name,
+                               "precision",
+                               node->precision,
+                               "length",
+                               node->length,
+                               "batch",
+                               node->batch,
+                               "in_stride",
+                               node->inStride,
+                               "out_stride",
+                               node->outStride,
+                               "idist",
+                               node->iDist,
+                               "odist",
+                               node->oDist,
+                               "grid",
+                               std::vector<unsigned int>{gp.b_x, gp.b_y, gp.b_z},
+                               "block",
+                               std::vector<unsigned int>{gp.wgs_x, gp.wgs_y, gp.wgs_z},
+                               "lds_bytes",
+                               gp.lds_bytes);
+        }
+    }
+}
+
 void rocfft_plan_t::LogSortedPlan(const std::vector<size_t>& sortedIdx) const
 {
+    if(LOG_PLAN_ENABLED() && LOG_JSON_ENABLED())
+        LogPlanKernelsJSON(multiPlan, sortedIdx);
+
     // If we have a single-node plan, just log that without any extra indenting
     if(multiPlan.size() == 1)
     {
-        if(LOG_PLAN_ENABLED())
+        if(LOG_PLAN_ENABLED() && !LOG_JSON_ENABLED())
         {
             auto& os = *LogSingleton::GetInstance().GetPlanOS();
             multiPlan.front()->Print(os, 0);
@@ -253,15 +628,52 @@ void rocfft_plan_t::LogSortedPlan(const std::vector<size_t>& sortedIdx) const
     os << "}\n" << std::endl;
 }
 
+ExecutionCounters& ExecutionCounters::Global()
+{
+    static ExecutionCounters counters;
+    return counters;
+}
+
 void rocfft_plan_t::Execute(void* in_buffer[], void* out_buffer[], rocfft_execution_info info)
 {
-    // Vector of topologically sorted indexes to the items in multiPlan
-    auto sortedIdx = MultiPlanTopologicalSort();
+    // Vector of topologically sorted indexes to the items in multiPlan.
+    // Plan creation normally sorts them already.  Executions may be
+    // concurrent, so an unsorted plan is sorted into a local copy.
+    std::vector<size_t> localOrder;
+    if(multiPlanOrder.size() != multiPlan.size())
+        localOrder = MultiPlanTopologicalSort();
+    const auto& sortedIdx = localOrder.empty() ? multiPlanOrder : localOrder;
 
     const auto local_comm_rank = get_local_comm_rank();
 
+    // captured work runs whenever the graph is launched, which we
+    // can't see, so captures aren't counted unless we launch them
+    if(!info || !info->captureMode || info->countCapture)
+    {
+        ++counters.executions;
+        ++ExecutionCounters::Global().executions;
+
+        // replay keeps the cadence of executions, so note when this
+        // one was enqueued
+        if(replayId)
+            log_replay("execute",
+                       replayId,
+                       std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch())
+                           .count());
+    }
+
+    // collect kernel times from earlier executions
+    if(info && info->profile && !info->captureMode)
+        info->profile->StartExecution();
+
+    // item timing runs items one at a time, which synchronizes with
+    // the device and so can't be captured
+    auto itemTimes = info && !info->captureMode ? info->itemTimes : nullptr;
+    const size_t executionIndex = itemTimes ? itemTimes->StartExecution() : 0;
+
     // Log input/output pointers
-    if(LOG_PLAN_ENABLED())
+    if(LOG_PLAN_ENABLED() && !LOG_JSON_ENABLED())
     {
         auto& os         = *LogSingleton::GetInstance().GetPlanOS();
         auto  inPtrCount = desc.count_pointers(desc.inFields, desc.inArrayType, local_comm_rank);
@@ -302,18 +714,55 @@ void rocfft_plan_t::Execute(void* in_buffer[], void* out_buffer[], rocfft_execut
             // check if antecedent involved us
             auto& antecedent = *multiPlan[antecedentIdx];
 
-            // the antecedent involved us somehow, wait for it
+            // the antecedent involved us somehow, wait for it.  If
+            // both items are ordered on GPU streams, the wait can
+            // happen on the device so the host keeps issuing work.
             if(antecedent.ExecutesOnRank(local_comm_rank))
-                antecedent.Wait();
+            {
+                auto completion = antecedent.CompletionEvent();
+                if(!completion || !item.ExecutesOnRank(local_comm_rank)
+                   || !item.WaitOnDevice(completion))
+                    antecedent.Wait();
+            }
         }
 
         // done waiting for all our antecedents, so this item can now proceed
 
-        // launch this item async
-        if(item.ExecutesOnRank(local_comm_rank))
+        if(!item.ExecutesOnRank(local_comm_rank))
+            continue;
+
+        if(!itemTimes)
+        {
+            // launch this item async
             item.ExecuteAsync(this, in_buffer, out_buffer, info, idx);
+            continue;
+        }
+
+        // run this item to completion and time it.  Every rank
+        // issues items in the same order, so running them one at a
+        // time can't leave ranks waiting on each other forever.
+        auto start = std::chrono::steady_clock::now();
+        item.ExecuteAsync(this, in_buffer, out_buffer, info, idx);
+        item.Wait();
+        // single-device plans don't record completion events, so
+        // wait for the stream they ran on
+        auto execPlan = dynamic_cast<ExecPlan*>(&item);
+        if(execPlan && !execPlan->mgpuPlan && hipStreamSynchronize(info->rocfft_stream) != hipSuccess)
+            throw std::runtime_error("hipStreamSynchronize failure");
+        auto end = std::chrono::steady_clock::now();
+
+        rocfft_plan_item_time record = {};
+        record.execution_index       = executionIndex;
+        record.item_index            = idx;
+        record.phase                 = item_phase(item);
+        record.duration_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        itemTimes->Add(record);
     }
 
+    // timed items have all finished already
+    if(itemTimes)
+        return;
+
     // finished executing all items, wait for outstanding work to complete
     for(auto i = sortedIdx.begin(); i != sortedIdx.end(); ++i)
     {
@@ -328,6 +777,40 @@ void rocfft_plan_t::Execute(void* in_buffer[], void* out_buffer[], rocfft_execut
     }
 }
 
+// callbacks would run on both passes of a convolution or analytic
+// signal plan, and output ops replace the store that a callback
+// would see.  Pass callbacks count passes within one single-device
+// plan.
+static bool has_unsupported_callbacks(const rocfft_plan plan, const rocfft_execution_info info)
+{
+    if(!info)
+        return false;
+    if(!info->pass_callbacks.empty()
+       && (plan->HasSeparatePasses() || !plan->IsSingleExecPlan()))
+        return true;
+    return (plan->HasSeparatePasses() || plan->desc.storeOps.needs_exclusive_output())
+           && (info->callbacks.load_cb_fn || info->callbacks.store_cb_fn);
+}
+
+// executing fewer transforms than the plan was created for shrinks
+// the batch of each kernel in a single-device plan.  kernels whose
+// batch isn't a multiple of the plan's batch can't be shrunk.
+static bool has_unsupported_batch(const rocfft_plan plan, const rocfft_execution_info info)
+{
+    if(!info || !info->batch || info->batch == plan->batch)
+        return false;
+    if(info->batch > plan->batch || plan->desc.hostBuffers || plan->HasSeparatePasses())
+        return true;
+    auto execPlan = plan->SingleExecPlan();
+    if(!execPlan || execPlan->mgpuPlan)
+        return true;
+    // chirp setup builds the same chirp however many transforms
+    // use it
+    return std::any_of(execPlan->execSeq.begin(), execPlan->execSeq.end(), [plan](TreeNode* n) {
+        return !n->IsBluesteinChirpSetup() && n->batch % plan->batch != 0;
+    });
+}
+
 rocfft_status rocfft_execute(const rocfft_plan     plan,
                              void*                 in_buffer[],
                              void*                 out_buffer[],
@@ -339,6 +822,25 @@ rocfft_status rocfft_execute(const rocfft_plan     plan,
     if(!plan)
         return rocfft_status_failure;
 
+    // finish asynchronous plan creation, if necessary
+    auto create_status = plan->WaitCreate();
+    if(create_status != rocfft_status_success)
+        return create_status;
+
+    if(has_unsupported_batch(plan, info))
+        return rocfft_status_invalid_arg_value;
+
+    // plans for host buffers stage them through the device in
+    // chunks of the batch
+    if(plan->desc.hostBuffers)
+        return rocfft_execute_out_of_core(plan, in_buffer, out_buffer, info);
+
+    if(info && info->captureMode && !plan->IsCaptureSafe())
+        return rocfft_status_invalid_arg_value;
+
+    if(has_unsupported_callbacks(plan, info))
+        return rocfft_status_invalid_arg_value;
+
     try
     {
         plan->Execute(in_buffer, out_buffer, info);
@@ -358,6 +860,360 @@ rocfft_status rocfft_execute(const rocfft_plan     plan,
     return rocfft_status_success;
 }
 
+rocfft_status rocfft_get_counters(const rocfft_plan plan, rocfft_counters* counters)
+{
+    if(!counters)
+        return rocfft_status_invalid_arg_value;
+
+    const auto& c                     = plan ? plan->counters : ExecutionCounters::Global();
+    counters->executions              = c.executions;
+    counters->kernels_launched        = c.kernels_launched;
+    counters->bytes_moved             = c.bytes_moved;
+    counters->work_buffer_allocations = c.work_buffer_allocations;
+    // kernels are compiled and cached for the whole process
+    if(plan)
+    {
+        counters->rtc_compiles = 0;
+        counters->cache_hits   = 0;
+    }
+    else
+    {
+        counters->rtc_compiles = RTCCache::stats.misses;
+        counters->cache_hits   = RTCCache::stats.memory_hits + RTCCache::stats.user_hits
+                               + RTCCache::stats.system_hits;
+    }
+    return rocfft_status_success;
+}
+
+// Return true if a batch of plans can be captured into one graph:
+// they must all be safe to capture on the current device and
+// execute on the same stream, which is returned
+static bool can_batch_in_graph(const rocfft_plan*          plans,
+                               const rocfft_execution_info infos[],
+                               size_t                      num_plans,
+                               hipStream_t&                stream)
+{
+    // a single plan gains nothing from a graph
+    if(num_plans < 2)
+        return false;
+
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        return false;
+
+    for(size_t i = 0; i < num_plans; ++i)
+    {
+        auto execPlan = plans[i]->SingleExecPlan();
+        if(!plans[i]->IsCaptureSafe() || !execPlan || execPlan->location.device != deviceId)
+            return false;
+
+        // capture can't allocate a work buffer or time kernels, and
+        // the caller may be capturing already
+        auto info = infos ? infos[i] : nullptr;
+        if(plans[i]->WorkBufBytes() && !(info && info->workBuffer))
+            return false;
+        if(info && (info->captureMode || info->profile || info->itemTimes))
+            return false;
+
+        auto planStream = info ? info->rocfft_stream : nullptr;
+        if(i == 0)
+            stream = planStream;
+        else if(planStream != stream)
+            return false;
+    }
+
+    hipStreamCaptureStatus captureStatus = hipStreamCaptureStatusNone;
+    if(stream
+       && (hipStreamIsCapturing(stream, &captureStatus) != hipSuccess
+           || captureStatus != hipStreamCaptureStatusNone))
+        return false;
+    return true;
+}
+
+// Capture a batch of plans into a graph and launch it on the
+// stream, so that all of their kernels go to the device at once
+static rocfft_status execute_batch_graph(const rocfft_plan*          plans,
+                                         void**                      in_buffers[],
+                                         void**                      out_buffers[],
+                                         const rocfft_execution_info infos[],
+                                         size_t                      num_plans,
+                                         hipStream_t                 stream)
+{
+    // the captured graph can't depend on table generation that
+    // happens outside of it, so finish that now.  the null stream
+    // can't be captured either, so capture to our own stream if the
+    // plans execute on the null stream.
+    hipStream_wrapper_t capture_stream;
+    hipStream_t         captureTo = stream;
+    try
+    {
+        for(size_t i = 0; i < num_plans; ++i)
+            plans[i]->WaitTables();
+        if(!captureTo)
+        {
+            capture_stream.alloc();
+            captureTo = capture_stream;
+        }
+    }
+    catch(std::exception&)
+    {
+        return rocfft_status_failure;
+    }
+
+    if(hipStreamBeginCapture(captureTo, hipStreamCaptureModeThreadLocal) != hipSuccess)
+        return rocfft_status_failure;
+
+    rocfft_status ret = rocfft_status_success;
+    try
+    {
+        for(size_t i = 0; i < num_plans; ++i)
+        {
+            rocfft_execution_info_t exec_info;
+            if(infos && infos[i])
+                exec_info = *infos[i];
+            exec_info.rocfft_stream = captureTo;
+            exec_info.captureMode   = true;
+            exec_info.countCapture  = true;
+            plans[i]->Execute(in_buffers[i], out_buffers ? out_buffers[i] : nullptr, &exec_info);
+        }
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        ret = rocfft_status_failure;
+    }
+    catch(rocfft_status e)
+    {
+        ret = e;
+    }
+
+    // always end the capture so the stream is usable afterwards
+    hipGraph_t captured = nullptr;
+    if(hipStreamEndCapture(captureTo, &captured) != hipSuccess && ret == rocfft_status_success)
+        ret = rocfft_status_failure;
+
+    if(ret == rocfft_status_success)
+    {
+        std::lock_guard<std::mutex> lock(plans[0]->batchGraphMutex);
+        auto&                       exec = plans[0]->batchGraph;
+
+        // repeated batches of the same plans usually capture the same
+        // kernels, maybe on other buffers, so the last executable can
+        // be updated instead of instantiating a new one.  The batch is
+        // still captured every time, since buffers and callbacks
+        // can't be patched into the executable's kernel nodes without
+        // running the plans' launch logic again.
+        auto& cachedPlans = plans[0]->batchGraphPlans;
+        if(!std::equal(cachedPlans.begin(), cachedPlans.end(), plans, plans + num_plans))
+        {
+            exec.free();
+            cachedPlans.assign(plans, plans + num_plans);
+        }
+        if(exec)
+        {
+            hipGraphNode_t           errorNode = nullptr;
+            hipGraphExecUpdateResult updateResult;
+            if(hipGraphExecUpdate(exec, captured, &errorNode, &updateResult) != hipSuccess)
+                exec.free();
+        }
+        try
+        {
+            exec.alloc_with([captured](hipGraphExec_t* graphExec) {
+                return hipGraphInstantiate(graphExec, captured, nullptr, nullptr, 0);
+            });
+            if(hipGraphLaunch(exec, stream) != hipSuccess)
+                ret = rocfft_status_failure;
+        }
+        catch(std::exception&)
+        {
+            ret = rocfft_status_failure;
+        }
+    }
+
+    if(captured)
+        (void)hipGraphDestroy(captured);
+    return ret;
+}
+
+rocfft_status rocfft_execute_batch(const rocfft_plan*          plans,
+                                   void**                      in_buffers[],
+                                   void**                      out_buffers[],
+                                   const rocfft_execution_info infos[],
+                                   size_t                      num_plans)
+{
+    log_trace(__func__,
+              "plans",
+              plans,
+              "in_buffers",
+              in_buffers,
+              "out_buffers",
+              out_buffers,
+              "infos",
+              infos,
+              "num_plans",
+              num_plans);
+
+    if(num_plans && (!plans || !in_buffers))
+        return rocfft_status_invalid_arg_value;
+
+    // validate everything up front, so that either all of the plans
+    // are launched or none of them are
+    for(size_t i = 0; i < num_plans; ++i)
+    {
+        if(!plans[i])
+            return rocfft_status_invalid_arg_value;
+
+        auto create_status = plans[i]->WaitCreate();
+        if(create_status != rocfft_status_success)
+            return create_status;
+
+        // host buffers are copied on the host, which can't be
+        // enqueued alongside other plans
+        if(plans[i]->desc.hostBuffers)
+            return rocfft_status_invalid_arg_value;
+
+        auto info = infos ? infos[i] : nullptr;
+        if(info && info->captureMode && !plans[i]->IsCaptureSafe())
+            return rocfft_status_invalid_arg_value;
+        if(has_unsupported_callbacks(plans[i], info) || has_unsupported_batch(plans[i], info))
+            return rocfft_status_invalid_arg_value;
+    }
+
+    // plans that all execute on one stream are captured into a
+    // graph, so they cost one launch instead of one per kernel
+    hipStream_t stream = nullptr;
+    if(can_batch_in_graph(plans, infos, num_plans, stream))
+        return execute_batch_graph(plans, in_buffers, out_buffers, infos, num_plans, stream);
+
+    try
+    {
+        // otherwise plans are enqueued back-to-back without
+        // returning to the caller in between.  single-device plans
+        // on separate streams can then overlap on the device.
+        for(size_t i = 0; i < num_plans; ++i)
+        {
+            plans[i]->Execute(in_buffers[i],
+                              out_buffers ? out_buffers[i] : nullptr,
+                              infos ? infos[i] : nullptr);
+        }
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        return rocfft_status_failure;
+    }
+    catch(rocfft_status e)
+    {
+        return e;
+    }
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_plan_capture_graph(const rocfft_plan     plan,
+                                        void*                 in_buffer[],
+                                        void*                 out_buffer[],
+                                        rocfft_execution_info info,
+                                        void**                graph)
+{
+    log_trace(__func__,
+              "plan",
+              plan,
+              "in_buffer",
+              in_buffer,
+              "out_buffer",
+              out_buffer,
+              "info",
+              info,
+              "graph",
+              graph);
+
+    if(!plan || !graph)
+        return rocfft_status_invalid_arg_value;
+
+    auto create_status = plan->WaitCreate();
+    if(create_status != rocfft_status_success)
+        return create_status;
+
+    if(!plan->IsCaptureSafe() || has_unsupported_callbacks(plan, info)
+       || has_unsupported_batch(plan, info))
+        return rocfft_status_invalid_arg_value;
+
+    // the captured graph can't depend on table generation that
+    // happens outside of it, so finish that now
+    try
+    {
+        plan->WaitTables();
+    }
+    catch(std::exception&)
+    {
+        return rocfft_status_failure;
+    }
+
+    rocfft_execution_info_t exec_info;
+    if(info)
+        exec_info = *info;
+    exec_info.captureMode = true;
+
+    // the null stream can't be captured, so capture to our own
+    // stream if the user didn't provide one
+    hipStream_wrapper_t capture_stream;
+    if(!exec_info.rocfft_stream)
+    {
+        try
+        {
+            capture_stream.alloc();
+        }
+        catch(std::exception&)
+        {
+            return rocfft_status_failure;
+        }
+        exec_info.rocfft_stream = capture_stream;
+    }
+
+    if(hipStreamBeginCapture(exec_info.rocfft_stream, hipStreamCaptureModeThreadLocal)
+       != hipSuccess)
+        return rocfft_status_failure;
+
+    rocfft_status ret = rocfft_status_success;
+    try
+    {
+        plan->Execute(in_buffer, out_buffer, &exec_info);
+    }
+    catch(std::exception& e)
+    {
+        if(LOG_TRACE_ENABLED())
+        {
+            (*LogSingleton::GetInstance().GetTraceOS()) << e.what() << std::endl;
+        }
+        ret = rocfft_status_failure;
+    }
+    catch(rocfft_status e)
+    {
+        ret = e;
+    }
+
+    // always end the capture so the stream is usable afterwards
+    hipGraph_t captured = nullptr;
+    if(hipStreamEndCapture(exec_info.rocfft_stream, &captured) != hipSuccess
+       && ret == rocfft_status_success)
+        ret = rocfft_status_failure;
+
+    if(ret != rocfft_status_success)
+    {
+        if(captured)
+            (void)hipGraphDestroy(captured);
+        return ret;
+    }
+    *graph = captured;
+    return rocfft_status_success;
+}
+
 void ExecPlan::ExecuteAsync(const rocfft_plan     plan,
                             void*                 in_buffer[],
                             void*                 out_buffer[],
@@ -370,6 +1226,7 @@ void ExecPlan::ExecuteAsync(const rocfft_plan     plan,
     rocfft_execution_info_t exec_info;
     if(info)
         exec_info = *info;
+    exec_info.planBatch = plan->batch;
 
     // allocate stream for async operations if necessary
     // for a single-device plan, we don't need to create
@@ -378,7 +1235,7 @@ void ExecPlan::ExecuteAsync(const rocfft_plan     plan,
     {
         if(!exec_info.rocfft_stream)
         {
-            this->stream.alloc();
+            alloc_internal_stream(this->stream, plan, info);
             exec_info.rocfft_stream = this->stream;
         }
         event.alloc();
@@ -387,11 +1244,13 @@ void ExecPlan::ExecuteAsync(const rocfft_plan     plan,
     // TransformPowX below needs in_buffer, out_buffer to work with.
     // But we need to potentially override pointers in those arrays.
     // So copy them to temporary vectors.
-    // This is not necessary for single-device plans.
+    // This is only necessary for multi-device plans and for items
+    // that read or write temp buffers.
     std::vector<void*> in_buffer_copy;
     std::vector<void*> out_buffer_copy;
 
-    if(mgpuPlan)
+    const bool overridePtrs = mgpuPlan || inputPtr || outputPtr;
+    if(overridePtrs)
     {
         auto local_comm_rank = plan->get_local_comm_rank();
         std::copy_n(
@@ -405,7 +1264,12 @@ void ExecPlan::ExecuteAsync(const rocfft_plan     plan,
 
         if(rootPlan->placement == rocfft_placement_notinplace)
         {
-            std::copy_n(out_buffer,
+            // a single-device in-place plan can be made of
+            // out-of-place items that write back to the input, in
+            // which case the user's output pointers are unused
+            auto out_src = !mgpuPlan && plan->placement == rocfft_placement_inplace ? in_buffer
+                                                                                    : out_buffer;
+            std::copy_n(out_src,
                         plan->desc.count_pointers(
                             plan->desc.outFields, plan->desc.outArrayType, local_comm_rank),
                         std::back_inserter(out_buffer_copy));
@@ -416,21 +1280,40 @@ void ExecPlan::ExecuteAsync(const rocfft_plan     plan,
 
     // select the input and output buffers based on whether
     // we have a single or multi device plan.
-    auto in_transform_ptrs  = mgpuPlan ? in_buffer_copy.data() : in_buffer;
-    auto out_transform_ptrs = mgpuPlan ? out_buffer_copy.data() : out_buffer;
+    auto in_transform_ptrs  = overridePtrs ? in_buffer_copy.data() : in_buffer;
+    auto out_transform_ptrs = overridePtrs ? out_buffer_copy.data() : out_buffer;
 
-    gpubuf autoAllocWorkBuf;
+    PooledWorkBuffer pooledWorkBuf;
+    gpubuf           autoAllocWorkBuf;
 
     if(workBufSize > 0)
     {
         auto requiredWorkBufBytes = WorkBufBytes(real_type_size(rootPlan->precision));
         if(!exec_info.workBuffer)
         {
-            // user didn't provide a buffer, alloc one now
-            if(autoAllocWorkBuf.alloc(requiredWorkBufBytes) != hipSuccess)
-                throw std::runtime_error("work buffer allocation failure");
+            // capture mode must not allocate, so the user has to
+            // provide the work buffer
+            if(exec_info.captureMode)
+            {
+                if(LOG_TRACE_ENABLED())
+                    (*LogSingleton::GetInstance().GetTraceOS())
+                        << "work buffer required in capture mode" << std::endl;
+                throw rocfft_status_invalid_work_buffer;
+            }
+
+            // user didn't provide a buffer, get one from the pool,
+            // falling back to allocating one now
+            if(pooledWorkBuf.alloc(requiredWorkBufBytes, exec_info.rocfft_stream))
+                exec_info.workBuffer = pooledWorkBuf.data();
+            else
+            {
+                if(autoAllocWorkBuf.alloc(requiredWorkBufBytes) != hipSuccess)
+                    throw std::runtime_error("work buffer allocation failure");
+                exec_info.workBuffer = autoAllocWorkBuf.data();
+            }
             exec_info.workBufferSize = requiredWorkBufBytes;
-            exec_info.workBuffer     = autoAllocWorkBuf.data();
+            ++plan->counters.work_buffer_allocations;
+            ++ExecutionCounters::Global().work_buffer_allocations;
         }
         // otherwise user provided a buffer, but complain if it's too small
         else if(exec_info.workBufferSize < requiredWorkBufBytes)
@@ -442,19 +1325,48 @@ void ExecPlan::ExecuteAsync(const rocfft_plan     plan,
         }
     }
 
-    // Callbacks do not currently support planar format
-    if((array_type_is_planar(rootPlan->inArrayType) || array_type_is_planar(rootPlan->outArrayType))
-       && (exec_info.callbacks.load_cb_fn || exec_info.callbacks.store_cb_fn))
-        throw std::runtime_error("callbacks not supported with planar format");
+    // tables might still be generating if the plan was created
+    // with a table stream.  capture can't wait on an event recorded
+    // outside of it, but capturing already waited for them.
+    if(tablesReady && !exec_info.captureMode && hipEventQuery(*tablesReady) != hipSuccess)
+    {
+        if(hipStreamWaitEvent(exec_info.rocfft_stream, *tablesReady, 0) != hipSuccess)
+            throw std::runtime_error("hipStreamWaitEvent failed");
+    }
+
+    // antecedents that run on GPU streams are waited for here
+    for(auto completion : deviceWaits)
+    {
+        if(hipStreamWaitEvent(exec_info.rocfft_stream, completion, 0) != hipSuccess)
+            throw std::runtime_error("hipStreamWaitEvent failed");
+    }
+    deviceWaits.clear();
 
     try
     {
-        TransformPowX(*this,
-                      in_transform_ptrs,
-                      (rootPlan->placement == rocfft_placement_inplace) ? in_transform_ptrs
-                                                                        : out_transform_ptrs,
-                      &exec_info,
-                      multiPlanIdx);
+        size_t kernels
+            = TransformPowX(*this,
+                            in_transform_ptrs,
+                            (rootPlan->placement == rocfft_placement_inplace) ? in_transform_ptrs
+                                                                              : out_transform_ptrs,
+                            &exec_info,
+                            multiPlanIdx);
+        if(!exec_info.captureMode || exec_info.countCapture)
+        {
+            size_t bytes = 0;
+            for(auto node : execSeq)
+            {
+                // a smaller batch moves a share of each node's bytes
+                size_t nodeBytes = KernelBytesMoved(*node);
+                if(exec_info.batch && !node->IsBluesteinChirpSetup())
+                    nodeBytes = nodeBytes / exec_info.planBatch * exec_info.batch;
+                bytes += nodeBytes;
+            }
+            plan->counters.kernels_launched += kernels;
+            plan->counters.bytes_moved += bytes;
+            ExecutionCounters::Global().kernels_launched += kernels;
+            ExecutionCounters::Global().bytes_moved += bytes;
+        }
         // all work is enqueued to the stream, record the event on
         // the stream. Not needed for single-device plans.
         if(mgpuPlan)
@@ -473,6 +1385,12 @@ void ExecPlan::ExecuteAsync(const rocfft_plan     plan,
     }
 }
 
+void ExecPlan::WaitTables() const
+{
+    if(tablesReady && hipEventSynchronize(*tablesReady) != hipSuccess)
+        throw std::runtime_error("hipEventSynchronize failed");
+}
+
 void ExecPlan::Wait()
 {
     // for a single-device plan, we don't need to synchronize
@@ -19,18 +19,33 @@
 // THE SOFTWARE.
 
 #include "tree_node.h"
+#include "../../shared/arithmetic.h"
+#include "../../shared/environment.h"
 #include "../../shared/precision_type.h"
 #include "function_pool.h"
 #include "kernel_launch.h"
 #include "logging.h"
 #include "plan.h"
 #include "repo.h"
+#include "transform.h"
 #include "twiddles.h"
 
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <numeric>
 #include <sstream>
+#include <thread>
 
 #ifdef ROCFFT_MPI_ENABLE
 #include <mpi.h>
+#if defined(OPEN_MPI) && __has_include(<mpi-ext.h>)
+#include <mpi-ext.h>
+#endif
+#endif
+
+#ifdef ROCFFT_RCCL_ENABLE
+#include <rccl/rccl.h>
 #endif
 
 struct rocfft_mp_request_t
@@ -44,11 +59,285 @@ struct rocfft_mp_request_t
 #endif
 };
 
+struct rocfft_mp_comm_t
+{
+#ifdef ROCFFT_MPI_ENABLE
+    MPI_Comm_wrapper_t comm;
+#endif
+};
+
+#ifndef ROCFFT_MPI_ENABLE
+struct rocfft_mp_staged_t
+{
+};
+#else
+// MPI libraries that can't access device memory are given messages
+// staged through pinned host memory.  ROCFFT_MPI_HOST_STAGING=1
+// forces staging and 0 turns it off.  Otherwise, Open MPI is asked
+// if it supports ROCm, and other MPI libraries are assumed to.
+static bool mpi_host_staging()
+{
+    static const bool staging = []() {
+        auto env = rocfft_getenv("ROCFFT_MPI_HOST_STAGING");
+        if(!env.empty())
+            return env != "0";
+#if defined(MPIX_ROCM_AWARE_SUPPORT) && MPIX_ROCM_AWARE_SUPPORT
+        return MPIX_Query_rocm_support() == 0;
+#else
+        return false;
+#endif
+    }();
+    return staging;
+}
+
+// A message between ranks staged through pinned host memory.  The
+// message moves in chunks through a few bounce buffers, so that on
+// the sender, copying chunk k+1 to the host overlaps MPI's transfer
+// of chunk k, and on the receiver, MPI's transfer of chunk k overlaps
+// copying chunk k-1 to the device.
+struct rocfft_mp_staged_t
+{
+    static const size_t CHUNK_BYTES = 4 * 1024 * 1024;
+    static const size_t NUM_SLOTS   = 3;
+
+    enum SlotState
+    {
+        SLOT_IDLE,
+        // copying between host and device
+        SLOT_COPYING,
+        // waiting for MPI
+        SLOT_COMM,
+    };
+
+    // chunks use the slots round-robin
+    struct Slot
+    {
+        void*              host = nullptr;
+        hipEvent_wrapper_t event;
+        MPI_Request        request = MPI_REQUEST_NULL;
+        SlotState          state   = SLOT_IDLE;
+        size_t             chunk   = 0;
+    };
+
+    rocfft_mp_staged_t() = default;
+    ~rocfft_mp_staged_t()
+    {
+        for(auto& slot : slots)
+        {
+            if(slot.host)
+                (void)hipHostFree(slot.host);
+        }
+    }
+    rocfft_mp_staged_t(const rocfft_mp_staged_t&) = delete;
+    rocfft_mp_staged_t& operator=(const rocfft_mp_staged_t&) = delete;
+
+    // set up a message on the current device and start its first
+    // chunks
+    void Start(const rocfft_plan     plan,
+               rocfft_execution_info info,
+               bool                  isSend,
+               const void*           buf,
+               size_t                bytes,
+               int                   peer,
+               int                   msgTag,
+               MPI_Comm              msgComm)
+    {
+        int curDevice = 0;
+        if(hipGetDevice(&curDevice) != hipSuccess)
+            throw std::runtime_error("hipGetDevice failed");
+        // streams and events belong to a device, but pinned memory
+        // can be reused from any device
+        if(curDevice != device)
+        {
+            stream.free();
+            for(auto& slot : slots)
+                slot.event.free();
+            device = curDevice;
+        }
+        alloc_internal_stream(stream, plan, info);
+
+        const size_t chunk = std::min(bytes, CHUNK_BYTES);
+        for(auto& slot : slots)
+        {
+            slot.event.alloc();
+            slot.state = SLOT_IDLE;
+            if(slotBytes < chunk && slot.host)
+            {
+                (void)hipHostFree(slot.host);
+                slot.host = nullptr;
+            }
+            if(!slot.host && chunk && hipHostMalloc(&slot.host, chunk) != hipSuccess)
+                throw std::runtime_error("MPI staging buffer allocation failure");
+        }
+        slotBytes = std::max(slotBytes, chunk);
+
+        send       = isSend;
+        dev        = static_cast<char*>(const_cast<void*>(buf));
+        numBytes   = bytes;
+        rank       = peer;
+        tag        = msgTag;
+        comm       = msgComm;
+        chunkBytes = chunk;
+        numChunks  = chunk ? DivRoundingUp(bytes, chunk) : 0;
+        nextChunk  = 0;
+        nextComm   = 0;
+        doneChunks = 0;
+        Progress();
+    }
+
+    bool Done() const
+    {
+        return doneChunks == numChunks;
+    }
+
+    // advance whichever chunks can advance without waiting.  Returns
+    // true once the whole message is done.
+    bool Progress()
+    {
+        for(auto& slot : slots)
+        {
+            if(slot.state == SLOT_COPYING)
+            {
+                auto hiprt = hipEventQuery(slot.event);
+                if(hiprt == hipErrorNotReady)
+                    continue;
+                if(hiprt != hipSuccess)
+                    throw std::runtime_error("hipEventQuery failed");
+                if(!send)
+                {
+                    slot.state = SLOT_IDLE;
+                    ++doneChunks;
+                    continue;
+                }
+                // chunks must be sent in order, since receives match
+                // messages with the same tag in the order they're
+                // sent
+                if(slot.chunk != nextComm)
+                    continue;
+                auto rcmpi = MPI_Isend(slot.host,
+                                       ChunkSize(slot.chunk),
+                                       MPI_BYTE,
+                                       rank,
+                                       tag,
+                                       comm,
+                                       &slot.request);
+                if(rcmpi != MPI_SUCCESS)
+                    throw std::runtime_error("MPI_Isend failed: " + std::to_string(rcmpi));
+                ++nextComm;
+                slot.state = SLOT_COMM;
+            }
+            else if(slot.state == SLOT_COMM)
+            {
+                int  flag  = 0;
+                auto rcmpi = MPI_Test(&slot.request, &flag, MPI_STATUS_IGNORE);
+                if(rcmpi != MPI_SUCCESS)
+                    throw std::runtime_error("MPI_Test failed: " + std::to_string(rcmpi));
+                if(!flag)
+                    continue;
+                if(send)
+                {
+                    slot.state = SLOT_IDLE;
+                    ++doneChunks;
+                    continue;
+                }
+                if(hipMemcpyAsync(dev + slot.chunk * chunkBytes,
+                                  slot.host,
+                                  ChunkSize(slot.chunk),
+                                  hipMemcpyHostToDevice,
+                                  stream)
+                       != hipSuccess
+                   || hipEventRecord(slot.event, stream) != hipSuccess)
+                    throw std::runtime_error("MPI staging copy failed");
+                slot.state = SLOT_COPYING;
+            }
+        }
+
+        // start chunks in order as their slots free up, so that
+        // receives are also posted in order
+        while(nextChunk < numChunks && slots[nextChunk % NUM_SLOTS].state == SLOT_IDLE)
+            StartChunk(nextChunk++);
+        return Done();
+    }
+
+private:
+    size_t ChunkSize(size_t chunk) const
+    {
+        return std::min(chunkBytes, numBytes - chunk * chunkBytes);
+    }
+
+    void StartChunk(size_t chunk)
+    {
+        auto& slot = slots[chunk % NUM_SLOTS];
+        slot.chunk = chunk;
+        if(send)
+        {
+            if(hipMemcpyAsync(slot.host,
+                              dev + chunk * chunkBytes,
+                              ChunkSize(chunk),
+                              hipMemcpyDeviceToHost,
+                              stream)
+                   != hipSuccess
+               || hipEventRecord(slot.event, stream) != hipSuccess)
+                throw std::runtime_error("MPI staging copy failed");
+            slot.state = SLOT_COPYING;
+        }
+        else
+        {
+            auto rcmpi = MPI_Irecv(
+                slot.host, ChunkSize(chunk), MPI_BYTE, rank, tag, comm, &slot.request);
+            if(rcmpi != MPI_SUCCESS)
+                throw std::runtime_error("MPI_Irecv failed: " + std::to_string(rcmpi));
+            slot.state = SLOT_COMM;
+        }
+    }
+
+    bool                        send       = false;
+    char*                       dev        = nullptr;
+    size_t                      numBytes   = 0;
+    int                         rank       = 0;
+    int                         tag        = 0;
+    MPI_Comm                    comm       = MPI_COMM_NULL;
+    size_t                      chunkBytes = 0;
+    size_t                      numChunks  = 0;
+    size_t                      nextChunk  = 0;
+    size_t                      nextComm   = 0;
+    size_t                      doneChunks = 0;
+    int                         device     = -1;
+    size_t                      slotBytes  = 0;
+    hipStream_wrapper_t         stream;
+    std::array<Slot, NUM_SLOTS> slots;
+};
+
+// Staged messages that haven't finished, from every item.  Waiting
+// for any item progresses all of them, so that a rank waiting on one
+// item keeps sending what other ranks are waiting for.
+static std::mutex                       staged_mutex;
+static std::vector<rocfft_mp_staged_t*> staged_active;
+
+// progress and drop finished messages, with staged_mutex held
+static void progress_staged_messages()
+{
+    auto unfinished = std::remove_if(staged_active.begin(),
+                                     staged_active.end(),
+                                     [](rocfft_mp_staged_t* msg) { return msg->Progress(); });
+    staged_active.erase(unfinished, staged_active.end());
+}
+#endif
+
 TreeNode::~TreeNode()
 {
+    // kernels compiling in the background while a generic kernel
+    // stands in for them generate their source from this node
+    if(genericKernel)
+    {
+        if(compiledKernel.valid())
+            compiledKernel.wait();
+        if(compiledKernelWithCallbacks.valid())
+            compiledKernelWithCallbacks.wait();
+    }
     if(twiddles)
     {
-        if(scheme == CS_KERNEL_2D_SINGLE)
+        if(scheme == CS_KERNEL_2D_SINGLE || scheme == CS_KERNEL_3D_SINGLE)
             Repo::ReleaseTwiddle2D(twiddles);
         else
             Repo::ReleaseTwiddle1D(twiddles);
@@ -70,17 +359,18 @@ NodeMetaData::NodeMetaData(TreeNode* refNode)
 {
     if(refNode != nullptr)
     {
-        precision  = refNode->precision;
-        batch      = refNode->batch;
-        direction  = refNode->direction;
-        rootIsC2C  = refNode->IsRootPlanC2CTransform();
-        deviceProp = refNode->deviceProp;
+        precision   = refNode->precision;
+        batch       = refNode->batch;
+        direction   = refNode->direction;
+        rootIsC2C   = refNode->IsRootPlanC2CTransform();
+        deviceProp  = refNode->deviceProp;
+        optStrategy = refNode->optStrategy;
     }
 }
 
 bool LeafNode::CreateLargeTwdTable()
 {
-    if(large1D != 0)
+    if(large1D != 0 && !largeTwdCompute)
     {
         std::tie(twiddles_large, twiddles_large_size)
             = Repo::GetTwiddles1D(large1D, 0, precision, deviceProp, largeTwdBase, false, {});
@@ -224,14 +514,20 @@ bool LeafNode::CreateDeviceResources()
     {
         if(!twd_no_radices)
             GetKernelFactors();
-        size_t twd_len                    = GetTwiddleTableLength();
-        std::tie(twiddles, twiddles_size) = Repo::GetTwiddles1D(twd_len,
-                                                                GetTwiddleTableLengthLimit(),
-                                                                precision,
-                                                                deviceProp,
-                                                                0,
-                                                                twd_attach_halfN,
-                                                                kernelFactors);
+        size_t twd_len = GetTwiddleTableLength();
+        // an octant table is the first twd_len / 8 + 1 entries of
+        // the plain length-N table
+        if(twd_octant)
+            std::tie(twiddles, twiddles_size) = Repo::GetTwiddles1D(
+                twd_len, twd_len / 8 + 1, precision, deviceProp, 0, false, {});
+        else
+            std::tie(twiddles, twiddles_size) = Repo::GetTwiddles1D(twd_len,
+                                                                    GetTwiddleTableLengthLimit(),
+                                                                    precision,
+                                                                    deviceProp,
+                                                                    0,
+                                                                    twd_attach_halfN,
+                                                                    kernelFactors);
     }
 
     return CreateLargeTwdTable();
@@ -280,8 +576,22 @@ void LeafNode::SetupGridParamAndFuncPtr(DevFnCall& fnPtr, GridParam& gp)
                 gp.lds_bytes /= 2;
         }
     }
-    // NB:
-    //   SBCR / SBRC are not able to use half-lds due to both of them can't satisfy dir-to/from-registers at them same time.
+    // SBRC / SBCR support half-lds when their registers side is
+    // direct, staging the transposed side one component at a time.
+    // The ERC variant of SBRC does its post-processing in LDS, so it
+    // always needs complex LDS.
+    bool sbrc = scheme == CS_KERNEL_STOCKHAM_BLOCK_RC || scheme == CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z
+                || scheme == CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY;
+    bool sbcr = scheme == CS_KERNEL_STOCKHAM_BLOCK_CR && ebtype == EmbeddedType::NONE;
+    if((sbrc || sbcr) && dir2regMode == DirectRegType::TRY_ENABLE_IF_SUPPORT)
+    {
+        if(function_pool::has_function(key))
+        {
+            auto kernel = function_pool::get_kernel(key);
+            if(kernel.half_lds && kernel.direct_to_from_reg)
+                gp.lds_bytes /= 2;
+        }
+    }
 
     // Confirm that the requested LDS bytes will fit into what the
     // device can provide.  If it can't, we've made a mistake in our
@@ -301,6 +611,53 @@ void LeafNode::SetupGridParamAndFuncPtr(DevFnCall& fnPtr, GridParam& gp)
 // grid params are set up by RTC
 void TransposeNode::SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp) {}
 
+bool TransposeNode::KernelCheck(std::vector<FMKey>& kernel_keys)
+{
+    specified_key = nullptr;
+
+    // untuned transposes keep an empty key in the solution map, which
+    // the built-in kernel check consumes
+    if(kernel_keys.empty() || kernel_keys.front() == FMKey::EmptyFMKey())
+        return LeafNode::KernelCheck(kernel_keys);
+
+    FMKey assignedKey = kernel_keys.front();
+    kernel_keys.erase(kernel_keys.begin());
+
+    // tiling doesn't depend on lengths, so only check the kind of transpose
+    if(precision != assignedKey.precision || scheme != assignedKey.scheme)
+    {
+        if(LOG_TRACE_ENABLED())
+            (*LogSingleton::GetInstance().GetTraceOS())
+                << "solution kernel keys are invalid: key properties != node's properties"
+                << std::endl;
+        return false;
+    }
+
+    specified_key = std::make_unique<FMKey>(assignedKey);
+    return true;
+}
+
+std::vector<size_t> TransposeNode::CollapsibleDims()
+{
+    // dims past the ones being permuted are just batches of planes
+    // or volumes.  collapsing them lets the kernel be specialized
+    // for its dimension instead of looping over higher dims.
+    const size_t first = scheme == CS_KERNEL_TRANSPOSE ? 2 : 3;
+    if(length.size() <= first)
+        return {};
+    std::vector<size_t> ret(length.size() - first);
+    std::iota(ret.begin(), ret.end(), first);
+    return ret;
+}
+
+FMKey TransposeNode::GetTuningKernelKey() const
+{
+    if(specified_key)
+        return *specified_key.get();
+
+    return FMKey(length[0], length[1], precision, scheme, NONE);
+}
+
 void TreeNode::SetTransposeOutputLength()
 {
     switch(scheme)
@@ -409,6 +766,10 @@ void TreeNode::CollapseContiguousDims()
 
 bool TreeNode::IsBluesteinChirpSetup()
 {
+    // rader only has its index and kernel setup as the first child
+    if(parent && parent->scheme == CS_RADER)
+        return this == parent->childNodes[0].get();
+
     // setup nodes must be under a bluestein parent. multi-kernel fused
     // bluestein is an exception to this rule as the first two chirp + padding
     // nodes are under an L1D_CC node.
@@ -434,7 +795,16 @@ bool TreeNode::IsBluesteinChirpSetup()
 
 MultiPlanItem::MultiPlanItem() {}
 
-MultiPlanItem::~MultiPlanItem() {}
+MultiPlanItem::~MultiPlanItem()
+{
+#ifdef ROCFFT_MPI_ENABLE
+    // an execution that failed might have left messages running
+    std::lock_guard<std::mutex> lock(staged_mutex);
+    for(const auto& msg : staged_messages)
+        staged_active.erase(std::remove(staged_active.begin(), staged_active.end(), msg.get()),
+                            staged_active.end());
+#endif
+}
 
 std::string MultiPlanItem::PrintBufferPtrOffset(const BufferPtr& ptr, size_t offset)
 {
@@ -455,7 +825,32 @@ int MultiPlanItem::GetOperationCommTag(size_t multiPlanIdx, size_t opIdx)
 
 void MultiPlanItem::WaitCommRequests()
 {
+    // stream-ordered operations are finished once the stream is idle
+    if(comm_stream && hipStreamSynchronize(comm_stream) != hipSuccess)
+        throw std::runtime_error("hipStreamSynchronize failed");
+
 #ifdef ROCFFT_MPI_ENABLE
+    if(staged_count)
+    {
+        std::unique_lock<std::mutex> lock(staged_mutex);
+        auto                         unfinished = [this]() {
+            return std::any_of(staged_messages.begin(),
+                               staged_messages.begin() + staged_count,
+                               [](const std::unique_ptr<rocfft_mp_staged_t>& msg) {
+                                   return !msg->Done();
+                               });
+        };
+        while(unfinished())
+        {
+            progress_staged_messages();
+            // let other threads progress their messages too
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        }
+        staged_count = 0;
+    }
+
     if(comm_requests.empty())
         return;
 
@@ -472,6 +867,148 @@ void MultiPlanItem::WaitCommRequests()
 #endif
 }
 
+#ifdef ROCFFT_RCCL_ENABLE
+// Return the item's stream for RCCL operations, allocating it on the
+// communicator's device.  The stream is replaced if the execution
+// asks for another priority.
+static hipStream_t
+    rccl_stream(const rocfft_plan plan, rocfft_execution_info info, hipStream_wrapper_t& stream)
+{
+    int  device = 0;
+    auto rcrccl = ncclCommCuDevice(plan->desc.rccl_comm, &device);
+    if(rcrccl != ncclSuccess)
+        throw std::runtime_error(std::string("ncclCommCuDevice failed: ")
+                                 + ncclGetErrorString(rcrccl));
+    rocfft_scoped_device dev(device);
+    alloc_internal_stream(stream, plan, info);
+    return stream;
+}
+#endif
+
+void MultiPlanItem::CommStaged(const rocfft_plan     plan,
+                               rocfft_execution_info info,
+                               bool                  send,
+                               const void*           buf,
+                               size_t                numBytes,
+                               int                   rank,
+                               int                   tag)
+{
+#if !defined ROCFFT_MPI_ENABLE
+    throw std::runtime_error("MPI communication not enabled");
+#else
+    if(staged_count == staged_messages.size())
+        staged_messages.push_back(std::make_unique<rocfft_mp_staged_t>());
+    auto& msg = *staged_messages[staged_count++];
+
+    std::lock_guard<std::mutex> lock(staged_mutex);
+    msg.Start(plan, info, send, buf, numBytes, rank, tag, plan->desc.mpi_comm);
+    if(!msg.Done())
+        staged_active.push_back(&msg);
+#endif
+}
+
+void MultiPlanItem::CommSend(const rocfft_plan     plan,
+                             rocfft_execution_info info,
+                             const void*           buf,
+                             size_t                numBytes,
+                             int                   destRank,
+                             int                   tag)
+{
+    switch(plan->desc.comm_type)
+    {
+    case rocfft_comm_mpi:
+    {
+#if !defined ROCFFT_MPI_ENABLE
+        throw std::runtime_error("MPI communication not enabled");
+#else
+        if(mpi_host_staging())
+        {
+            CommStaged(plan, info, true, buf, numBytes, destRank, tag);
+            break;
+        }
+        MPI_Request request;
+        const auto  mpiret
+            = MPI_Isend(buf, numBytes, MPI_BYTE, destRank, tag, plan->desc.mpi_comm, &request);
+        if(mpiret != MPI_SUCCESS)
+            throw std::runtime_error("MPI_Isend failed on rank "
+                                     + std::to_string(plan->get_local_comm_rank()) + ": "
+                                     + std::to_string(mpiret));
+        comm_requests.push_back(request);
+        break;
+#endif
+    }
+    case rocfft_comm_rccl:
+    {
+#if !defined ROCFFT_RCCL_ENABLE
+        throw std::runtime_error("RCCL communication not enabled");
+#else
+        // RCCL matches sends and receives between a pair of ranks in
+        // the order they're issued, so the tag isn't needed
+        auto       stream = rccl_stream(plan, info, comm_stream);
+        const auto rcrccl
+            = ncclSend(buf, numBytes, ncclUint8, destRank, plan->desc.rccl_comm, stream);
+        if(rcrccl != ncclSuccess)
+            throw std::runtime_error("ncclSend failed on rank "
+                                     + std::to_string(plan->get_local_comm_rank()) + ": "
+                                     + ncclGetErrorString(rcrccl));
+        break;
+#endif
+    }
+    default:
+        throw std::runtime_error("multi-process communication not configured");
+    }
+}
+
+void MultiPlanItem::CommRecv(const rocfft_plan     plan,
+                             rocfft_execution_info info,
+                             void*                 buf,
+                             size_t                numBytes,
+                             int                   srcRank,
+                             int                   tag)
+{
+    switch(plan->desc.comm_type)
+    {
+    case rocfft_comm_mpi:
+    {
+#if !defined ROCFFT_MPI_ENABLE
+        throw std::runtime_error("MPI communication not enabled");
+#else
+        if(mpi_host_staging())
+        {
+            CommStaged(plan, info, false, buf, numBytes, srcRank, tag);
+            break;
+        }
+        MPI_Request request;
+        const auto  mpiret
+            = MPI_Irecv(buf, numBytes, MPI_BYTE, srcRank, tag, plan->desc.mpi_comm, &request);
+        if(mpiret != MPI_SUCCESS)
+            throw std::runtime_error("MPI_Irecv failed on rank "
+                                     + std::to_string(plan->get_local_comm_rank()) + ": "
+                                     + std::to_string(mpiret));
+        comm_requests.push_back(request);
+        break;
+#endif
+    }
+    case rocfft_comm_rccl:
+    {
+#if !defined ROCFFT_RCCL_ENABLE
+        throw std::runtime_error("RCCL communication not enabled");
+#else
+        auto       stream = rccl_stream(plan, info, comm_stream);
+        const auto rcrccl
+            = ncclRecv(buf, numBytes, ncclUint8, srcRank, plan->desc.rccl_comm, stream);
+        if(rcrccl != ncclSuccess)
+            throw std::runtime_error("ncclRecv failed on rank "
+                                     + std::to_string(plan->get_local_comm_rank()) + ": "
+                                     + ncclGetErrorString(rcrccl));
+        break;
+#endif
+    }
+    default:
+        throw std::runtime_error("multi-process communication not configured");
+    }
+}
+
 void CommPointToPoint::ExecuteAsync(const rocfft_plan     plan,
                                     void*                 in_buffer[],
                                     void*                 out_buffer[],
@@ -479,19 +1016,33 @@ void CommPointToPoint::ExecuteAsync(const rocfft_plan     plan,
                                     size_t                multiPlanIdx)
 {
     rocfft_scoped_device dev(srcLocation.device);
-    stream.alloc();
+    alloc_internal_stream(stream, plan, info);
     event.alloc();
 
     auto local_comm_rank = plan->get_local_comm_rank();
 
-    auto memSize       = numElems * element_size(precision, arrayType);
-    auto srcWithOffset = ptr_offset(
-        srcPtr.get(in_buffer, out_buffer, local_comm_rank), srcOffset, precision, arrayType);
-    auto destWithOffset = ptr_offset(
-        destPtr.get(in_buffer, out_buffer, local_comm_rank), destOffset, precision, arrayType);
+    auto memSize       = numElems * storage_element_size(storage, precision, arrayType);
+    auto srcWithOffset = storage_ptr_offset(srcPtr.get(in_buffer, out_buffer, local_comm_rank),
+                                            srcOffset,
+                                            storage,
+                                            precision,
+                                            arrayType);
+    auto destWithOffset = storage_ptr_offset(destPtr.get(in_buffer, out_buffer, local_comm_rank),
+                                             destOffset,
+                                             storage,
+                                             precision,
+                                             arrayType);
 
     if(srcLocation.comm_rank == destLocation.comm_rank)
     {
+        // antecedents that run on GPU streams are waited for here
+        for(auto completion : deviceWaits)
+        {
+            if(hipStreamWaitEvent(stream, completion, 0) != hipSuccess)
+                throw std::runtime_error("hipStreamWaitEvent failed");
+        }
+        deviceWaits.clear();
+
         auto hiprt = hipSuccess;
         if(srcLocation.device == destLocation.device)
         {
@@ -518,44 +1069,10 @@ void CommPointToPoint::ExecuteAsync(const rocfft_plan     plan,
     }
     else
     {
-#if !defined ROCFFT_MPI_ENABLE
-        throw std::runtime_error("MPI communication not enabled");
-#else
         if(srcLocation.comm_rank == local_comm_rank)
-        {
-            MPI_Request request;
-            const auto  mpiret = MPI_Isend(srcWithOffset,
-                                          memSize,
-                                          MPI_BYTE,
-                                          destLocation.comm_rank,
-                                          multiPlanIdx,
-                                          plan->desc.mpi_comm,
-                                          &request);
-            if(mpiret != MPI_SUCCESS)
-            {
-                throw std::runtime_error("MPI_Isend PointToPoint failed on rank "
-                                         + std::to_string(local_comm_rank));
-            }
-            comm_requests.push_back(request);
-        }
+            CommSend(plan, info, srcWithOffset, memSize, destLocation.comm_rank, multiPlanIdx);
         else if(destLocation.comm_rank == local_comm_rank)
-        {
-            MPI_Request request;
-            const auto  mpiret = MPI_Irecv(destWithOffset,
-                                          memSize,
-                                          MPI_BYTE,
-                                          srcLocation.comm_rank,
-                                          multiPlanIdx,
-                                          plan->desc.mpi_comm,
-                                          &request);
-            if(mpiret != MPI_SUCCESS)
-            {
-                throw std::runtime_error("MPI_Irecv PointToPoint failed on rank "
-                                         + std::to_string(local_comm_rank));
-            }
-            comm_requests.push_back(request);
-        }
-#endif
+            CommRecv(plan, info, destWithOffset, memSize, srcLocation.comm_rank, multiPlanIdx);
     }
 }
 
@@ -581,6 +1098,8 @@ void CommPointToPoint::Print(rocfft_ostream& os, const int indent) const
     os << indentStr << "  destDeviceID: " << destLocation.device << "\n";
     os << indentStr << "  destBuf: " << PrintBufferPtrOffset(destPtr, destOffset) << "\n";
     os << indentStr << "  numElems: " << numElems << "\n";
+    if(storage != rocfft_storage_format_native)
+        os << indentStr << "  storage: " << storage_format_name(storage) << "\n";
     os << std::endl;
 }
 
@@ -591,7 +1110,7 @@ void CommScatter::ExecuteAsync(const rocfft_plan     plan,
                                size_t                multiPlanIdx)
 {
     rocfft_scoped_device dev(srcLocation.device);
-    stream.alloc();
+    alloc_internal_stream(stream, plan, info);
     event.alloc();
 
     auto local_comm_rank = plan->get_local_comm_rank();
@@ -631,46 +1150,20 @@ void CommScatter::ExecuteAsync(const rocfft_plan     plan,
         else
         {
             // Inter-proccess communication
-#if !defined ROCFFT_MPI_ENABLE
-            throw std::runtime_error("MPI communication not enabled");
-#else
             if(local_comm_rank == srcLocation.comm_rank)
-            {
-                MPI_Request request;
-                const auto  mpiret = MPI_Isend(srcWithOffset,
-                                              memSize,
-                                              MPI_BYTE,
-                                              op.destLocation.comm_rank,
-                                              GetOperationCommTag(multiPlanIdx, opIdx),
-                                              plan->desc.mpi_comm,
-                                              &request);
-                if(mpiret != MPI_SUCCESS)
-                {
-                    throw std::runtime_error("MPI_Isend failed on rank"
-                                             + std::to_string(local_comm_rank));
-                }
-                comm_requests.push_back(request);
-            }
+                CommSend(plan,
+                         info,
+                         srcWithOffset,
+                         memSize,
+                         op.destLocation.comm_rank,
+                         GetOperationCommTag(multiPlanIdx, opIdx));
             else if(local_comm_rank == op.destLocation.comm_rank)
-            {
-                MPI_Request request;
-                const auto  mpiret = MPI_Irecv(destWithOffset,
-                                              memSize,
-                                              MPI_BYTE,
-                                              srcLocation.comm_rank,
-                                              GetOperationCommTag(multiPlanIdx, opIdx),
-                                              plan->desc.mpi_comm,
-                                              &request);
-                if(mpiret != MPI_SUCCESS)
-                {
-                    throw std::runtime_error("MPI_Irecv failed on rank"
-                                             + std::to_string(local_comm_rank) + " for op index "
-                                             + std::to_string(opIdx));
-                }
-                comm_requests.push_back(request);
-            }
-
-#endif
+                CommRecv(plan,
+                         info,
+                         destWithOffset,
+                         memSize,
+                         srcLocation.comm_rank,
+                         GetOperationCommTag(multiPlanIdx, opIdx));
         }
     }
     // All work is enqueued to the stream, record the event on the stream
@@ -728,7 +1221,7 @@ void CommGather::ExecuteAsync(const rocfft_plan     plan,
         auto&       event  = events[opIdx];
 
         rocfft_scoped_device dev(op.srcLocation.device);
-        stream.alloc();
+        alloc_internal_stream(stream, plan, info);
         event.alloc();
 
         auto memSize = op.numElems * element_size(precision, arrayType);
@@ -768,39 +1261,20 @@ void CommGather::ExecuteAsync(const rocfft_plan     plan,
         else
         {
             // Inter-proccess communication
-#if !defined ROCFFT_MPI_ENABLE
-            throw std::runtime_error("MPI communication not enabled");
-#else
-
             if(local_comm_rank == op.srcLocation.comm_rank)
-            {
-                MPI_Request request;
-                auto        rcmpi = MPI_Isend(srcWithOffset,
-                                       memSize,
-                                       MPI_BYTE,
-                                       destLocation.comm_rank,
-                                       GetOperationCommTag(multiPlanIdx, opIdx),
-                                       plan->desc.mpi_comm,
-                                       &request);
-                if(rcmpi != MPI_SUCCESS)
-                    throw std::runtime_error("MPI_Isend failed: " + std::to_string(rcmpi));
-                comm_requests.push_back(request);
-            }
+                CommSend(plan,
+                         info,
+                         srcWithOffset,
+                         memSize,
+                         destLocation.comm_rank,
+                         GetOperationCommTag(multiPlanIdx, opIdx));
             else if(local_comm_rank == destLocation.comm_rank)
-            {
-                MPI_Request request;
-                auto        rcmpi = MPI_Irecv(destWithOffset,
-                                       memSize,
-                                       MPI_BYTE,
-                                       op.srcLocation.comm_rank,
-                                       GetOperationCommTag(multiPlanIdx, opIdx),
-                                       plan->desc.mpi_comm,
-                                       &request);
-                if(rcmpi != MPI_SUCCESS)
-                    throw std::runtime_error("MPI_Irecv failed: " + std::to_string(rcmpi));
-                comm_requests.push_back(request);
-            }
-#endif
+                CommRecv(plan,
+                         info,
+                         destWithOffset,
+                         memSize,
+                         op.srcLocation.comm_rank,
+                         GetOperationCommTag(multiPlanIdx, opIdx));
         }
 
         // FIXME: we don't need events for MPI communications.
@@ -845,6 +1319,195 @@ void CommGather::Print(rocfft_ostream& os, const int indent) const
     }
 }
 
+void CommAllToAll::SplitComm(const rocfft_plan plan)
+{
+    // RCCL only involves ranks that have data to exchange, so only
+    // MPI collectives need a smaller communicator
+    if(rankGroup.empty() || plan->desc.comm_type != rocfft_comm_mpi)
+        return;
+#ifdef ROCFFT_MPI_ENABLE
+    const auto local_comm_rank = plan->get_local_comm_rank();
+    groupComm                  = std::make_shared<rocfft_mp_comm_t>();
+    groupComm->comm = plan->desc.mpi_comm.split(rankGroup.at(local_comm_rank), local_comm_rank);
+#endif
+}
+
+void CommAllToAll::ExecuteAsync(const rocfft_plan     plan,
+                                void*                 in_buffer[],
+                                void*                 out_buffer[],
+                                rocfft_execution_info info,
+                                size_t                multiPlanIdx)
+{
+    auto        local_comm_rank = plan->get_local_comm_rank();
+    const auto& local           = ranks.at(local_comm_rank);
+
+    rocfft_scoped_device dev(local.location.device);
+
+    auto sendBuf = local.sendPtr.get(in_buffer, out_buffer, local_comm_rank);
+    auto recvBuf = local.recvPtr.get(in_buffer, out_buffer, local_comm_rank);
+
+    if(plan->desc.comm_type == rocfft_comm_rccl)
+    {
+#if !defined ROCFFT_RCCL_ENABLE
+        throw std::runtime_error("RCCL communication not enabled");
+#else
+        // RCCL has no all-to-all with per-rank counts, but point-to-point
+        // operations in a group run together
+        const auto elem_size = storage_element_size(storage, precision, arrayType);
+        auto       rcrccl    = ncclGroupStart();
+        if(rcrccl != ncclSuccess)
+            throw std::runtime_error(std::string("ncclGroupStart failed: ")
+                                     + ncclGetErrorString(rcrccl));
+        for(size_t other = 0; other < ranks.size(); ++other)
+        {
+            if(local.sendCounts[other])
+                CommSend(plan,
+                         info,
+                         storage_ptr_offset(
+                             sendBuf, local.sendOffsets[other], storage, precision, arrayType),
+                         local.sendCounts[other] * elem_size,
+                         other,
+                         multiPlanIdx);
+            if(local.recvCounts[other])
+                CommRecv(plan,
+                         info,
+                         storage_ptr_offset(
+                             recvBuf, local.recvOffsets[other], storage, precision, arrayType),
+                         local.recvCounts[other] * elem_size,
+                         other,
+                         multiPlanIdx);
+        }
+        rcrccl = ncclGroupEnd();
+        if(rcrccl != ncclSuccess)
+            throw std::runtime_error("ncclGroupEnd failed on rank "
+                                     + std::to_string(local_comm_rank) + ": "
+                                     + ncclGetErrorString(rcrccl));
+#endif
+        return;
+    }
+
+#if !defined ROCFFT_MPI_ENABLE
+    throw std::runtime_error("MPI communication not enabled");
+#else
+    // a collective can't be staged, so exchange staged messages with
+    // each rank instead.  Ranks are numbered as in the plan's
+    // communicator, which every message goes over.
+    if(mpi_host_staging())
+    {
+        const auto elem_size = storage_element_size(storage, precision, arrayType);
+        for(size_t other = 0; other < ranks.size(); ++other)
+        {
+            if(local.recvCounts[other])
+                CommStaged(plan,
+                           info,
+                           false,
+                           storage_ptr_offset(
+                               recvBuf, local.recvOffsets[other], storage, precision, arrayType),
+                           local.recvCounts[other] * elem_size,
+                           other,
+                           multiPlanIdx);
+            if(local.sendCounts[other])
+                CommStaged(plan,
+                           info,
+                           true,
+                           storage_ptr_offset(
+                               sendBuf, local.sendOffsets[other], storage, precision, arrayType),
+                           local.sendCounts[other] * elem_size,
+                           other,
+                           multiPlanIdx);
+        }
+        return;
+    }
+
+    // grouped ranks exchange over their group's communicator, whose
+    // ranks are the group's members in order
+    std::vector<size_t> peers;
+    for(size_t other = 0; other < ranks.size(); ++other)
+    {
+        if(rankGroup.empty() || rankGroup[other] == rankGroup[local_comm_rank])
+            peers.push_back(other);
+    }
+    const MPI_Comm comm = groupComm ? static_cast<MPI_Comm>(groupComm->comm)
+                                    : static_cast<MPI_Comm>(plan->desc.mpi_comm);
+
+    // MPI counts and displacements are ints, so count whole elements
+    // instead of bytes.  Plan creation only uses this item if they fit.
+    auto to_int = [&peers](const std::vector<size_t>& v) {
+        std::vector<int> ret;
+        ret.reserve(peers.size());
+        for(auto p : peers)
+            ret.push_back(v[p]);
+        return ret;
+    };
+    auto sendCounts  = to_int(local.sendCounts);
+    auto sendOffsets = to_int(local.sendOffsets);
+    auto recvCounts  = to_int(local.recvCounts);
+    auto recvOffsets = to_int(local.recvOffsets);
+
+    MPI_Datatype elemType;
+    auto         rcmpi = MPI_Type_contiguous(
+        storage_element_size(storage, precision, arrayType), MPI_BYTE, &elemType);
+    if(rcmpi == MPI_SUCCESS)
+        rcmpi = MPI_Type_commit(&elemType);
+    if(rcmpi != MPI_SUCCESS)
+        throw std::runtime_error("MPI element type creation failed: " + std::to_string(rcmpi));
+
+    MPI_Request request;
+    rcmpi = MPI_Ialltoallv(sendBuf,
+                           sendCounts.data(),
+                           sendOffsets.data(),
+                           elemType,
+                           recvBuf,
+                           recvCounts.data(),
+                           recvOffsets.data(),
+                           elemType,
+                           comm,
+                           &request);
+    // pending communication keeps the type alive
+    MPI_Type_free(&elemType);
+    if(rcmpi != MPI_SUCCESS)
+        throw std::runtime_error("MPI_Ialltoallv failed on rank " + std::to_string(local_comm_rank)
+                                 + ": " + std::to_string(rcmpi));
+    comm_requests.push_back(request);
+#endif
+}
+
+void CommAllToAll::Wait()
+{
+    WaitCommRequests();
+}
+
+void CommAllToAll::Print(rocfft_ostream& os, const int indent) const
+{
+    const std::string indentStr("    ", indent);
+
+    os << indentStr << "CommAllToAll " << precision_name(precision) << " "
+       << PrintArrayType(arrayType) << ":\n";
+    if(storage != rocfft_storage_format_native)
+        os << indentStr << "  storage: " << storage_format_name(storage) << "\n";
+
+    for(size_t rank = 0; rank < ranks.size(); ++rank)
+    {
+        const auto& r = ranks[rank];
+        os << indentStr << "  commRank: " << rank << "\n";
+        if(!rankGroup.empty())
+            os << indentStr << "  group: " << rankGroup[rank] << "\n";
+        os << indentStr << "  deviceID: " << r.location.device << "\n";
+        os << indentStr << "  sendBuf: " << PrintBufferPtrOffset(r.sendPtr, 0) << "\n";
+        os << indentStr << "  recvBuf: " << PrintBufferPtrOffset(r.recvPtr, 0) << "\n";
+        for(size_t other = 0; other < ranks.size(); ++other)
+        {
+            if(r.sendCounts[other])
+                os << indentStr << "    send to " << other << ": " << r.sendCounts[other]
+                   << " elems at offset " << r.sendOffsets[other] << "\n";
+            if(r.recvCounts[other])
+                os << indentStr << "    recv from " << other << ": " << r.recvCounts[other]
+                   << " elems at offset " << r.recvOffsets[other] << "\n";
+        }
+        os << "\n";
+    }
+}
+
 void ExecPlan::Print(rocfft_ostream& os, const int indent) const
 {
     std::string indentStr;
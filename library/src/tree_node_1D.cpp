@@ -19,8 +19,9 @@
 // THE SOFTWARE.
 
 #include "tree_node_1D.h"
+#include "../../shared/arithmetic.h"
 #include "../../shared/precision_type.h"
-#include "../device/kernels/bank_shift.h"
+#include "device/generator/stockham_gen.h"
 #include "function_pool.h"
 #include "fuse_shim.h"
 #include "node_factory.h"
@@ -906,37 +907,62 @@ void Stockham1DNode::SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp)
     if(ebtype != EmbeddedType::NONE)
         lds_padding = 1;
 
-    bwd      = kernel.transforms_per_block;
-    wgs      = kernel.workgroup_size;
-    gp.b_x   = (batch_accum + bwd - 1) / bwd;
+    bwd = kernel.transforms_per_block;
+    wgs = kernel.workgroup_size;
+    // blocks of pipelined kernels work through several tiles of
+    // transforms
+    size_t transforms_per_grid_block
+        = kernel.pipelined_loads ? bwd * StockhamGeneratorSpecs::PIPELINE_TILES : bwd;
+    gp.b_x = checked_grid_dim(DivRoundingUp(batch_accum, transforms_per_grid_block), wgs);
     gp.wgs_x = wgs;
 
-    // we don't even need lds (kernel_1,2,3,4,5,6,7,10,11,13,17) since we don't use them at all
+    // rows of a plane fill whole blocks if they divide evenly
+    if(length.size() == 3 && ebtype == EmbeddedType::NONE
+       && length[1] % transforms_per_grid_block == 0)
+        planeBlocks = length[1] / transforms_per_grid_block;
+
+    // we don't even need lds (kernel_1,2,3,4,5,6,7,10,11,13,17) since we don't use them at all.
+    // Likewise for tiny kernels that keep a whole transform in one
+    // thread's registers between passes.
     // TODO: we can even use swizzle to do the butterfly shuffle if threads_per_transform[0] <= warpSize
     //       such as kernel_8 = [4, 2] can probably gain some perf.
     if(kernel.threads_per_transform[0] <= deviceProp.warpSize && ebtype == EmbeddedType::NONE
        && kernel.factors.size() == 1)
         lds = 0;
+    else if(ebtype == EmbeddedType::NONE
+            && StockhamGeneratorSpecs::is_registers_only(
+                length[0], kernel.threads_per_transform[0], kernel.direct_to_from_reg))
+        lds = 0;
     else
     {
-        // NB:
-        //   When lds conflict becomes significant enough, we can apply lds bank shift to reduce it.
-        //   One of the costs is extra lds allocation. We enable it for small pow of 2 cases on all
-        //   supported archs for now.
-        if(length[0] == 64)
-        {
-            lds = (length[0] + lds_padding) * bwd + length[0] * bwd / LDS_BANK_SHIFT;
-        }
-        else
-        {
-            lds = (length[0] + lds_padding) * bwd;
-        }
+        // kernels can pad LDS with an extra element every
+        // lds_bank_shift elements to reduce bank conflicts, at the
+        // cost of a larger LDS allocation
+        lds = (length[0] + lds_padding) * bwd;
+        auto bank_shift
+            = StockhamGeneratorSpecs::resolve_lds_bank_shift(kernel.lds_bank_shift, length[0]);
+        if(bank_shift)
+            lds += DivRoundingUp<size_t>(lds, bank_shift);
     }
 }
 
 bool Stockham1DNode::CreateDeviceResources()
 {
-    twd_attach_halfN = (ebtype != EmbeddedType::NONE);
+    // only even-length real pre/post-processing needs the extra
+    // half-length twiddles
+    twd_attach_halfN
+        = (ebtype == EmbeddedType::Real2C_POST || ebtype == EmbeddedType::C2Real_PRE);
+    // the kernel reads an octant table if its config asks for one -
+    // see RTCKernelStockham::generate_from_node, which makes the
+    // same decision
+    twd_octant = false;
+    if(ebtype == EmbeddedType::NONE && fuseBlue == BluesteinFuseType::BFT_NONE
+       && StockhamGeneratorSpecs::can_use_octant_twiddles(length[0]))
+    {
+        auto key = GetKernelKey();
+        if(function_pool::has_function(key))
+            twd_octant = function_pool::get_kernel(key).octant_twiddles;
+    }
     return LeafNode::CreateDeviceResources();
 }
 
@@ -965,7 +991,8 @@ bool SBCCNode::KernelCheck(std::vector<FMKey>& kernel_keys)
     {
         FMKey key      = GetKernelKey();
         auto  kernel   = function_pool::get_kernel(key);
-        largeTwd3Steps = kernel.use_3steps_large_twd;
+        largeTwd3Steps  = kernel.use_3steps_large_twd;
+        largeTwdCompute = kernel.compute_large_twd;
         get_large_twd_base_steps(large1D, largeTwd3Steps, largeTwdBase, ltwdSteps);
     }
 
@@ -1106,9 +1133,15 @@ void SBCCNode::SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp)
     bwd         = kernel.transforms_per_block;
     wgs         = kernel.workgroup_size;
     lds         = length[0] * bwd;
-    gp.b_x      = ((length[1]) - 1) / bwd + 1;
-    gp.b_x *= std::accumulate(length.begin() + 2, length.end(), batch, std::multiplies<size_t>());
+    gp.b_x      = checked_grid_dim(
+        DivRoundingUp(length[1], bwd)
+            * std::accumulate(length.begin() + 2, length.end(), batch, std::multiplies<size_t>()),
+        wgs);
     gp.wgs_x = wgs;
+
+    // blocks tile the columns of one plane at a time
+    if(length.size() == 3)
+        planeBlocks = DivRoundingUp(length[1], bwd);
 }
 
 std::vector<size_t> SBCCNode::CollapsibleDims()
@@ -1126,6 +1159,20 @@ std::vector<size_t> SBCCNode::CollapsibleDims()
 /*****************************************************
  * SBRC  *
  *****************************************************/
+std::vector<size_t> SBRCNode::CollapsibleDims()
+{
+    // do not collapse on multi-kernel fused Bluestein nodes
+    if(typeBlue == BT_MULTI_KERNEL_FUSED)
+        return {};
+
+    // fastest two dims are transposed, higher dims are collapsible
+    if(length.size() <= 2)
+        return {};
+    std::vector<size_t> ret(length.size() - 2);
+    std::iota(ret.begin(), ret.end(), 2);
+    return ret;
+}
+
 FMKey SBRCNode::GetKernelKey() const
 {
     if(specified_key)
@@ -1220,9 +1267,16 @@ void SBRCNode::SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp)
     bwd         = kernel.transforms_per_block;
     wgs         = kernel.workgroup_size;
     lds         = length[0] * bwd;
-    gp.b_x      = (length[1] - 1) / bwd + 1;
-    gp.b_x *= std::accumulate(length.begin() + 2, length.end(), batch, std::multiplies<size_t>());
+    gp.b_x      = checked_grid_dim(
+        DivRoundingUp(length[1], bwd)
+            * std::accumulate(length.begin() + 2, length.end(), batch, std::multiplies<size_t>()),
+        wgs);
     gp.wgs_x = wgs;
+
+    // blocks tile the rows of one plane at a time, and transpose
+    // them within that plane
+    if(length.size() == 3 && ebtype == EmbeddedType::NONE)
+        planeBlocks = DivRoundingUp(length[1], bwd);
 }
 
 SBRC_TRANSPOSE_TYPE SBRCNode::sbrc_transpose_type(unsigned int blockWidth) const
@@ -1337,8 +1391,10 @@ void SBCRNode::SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp)
     wgs         = kernel.workgroup_size;
     bwd         = kernel.transforms_per_block;
     lds         = length[0] * bwd;
-    gp.b_x      = ((length[1]) - 1) / bwd + 1;
-    gp.b_x *= std::accumulate(length.begin() + 2, length.end(), batch, std::multiplies<size_t>());
+    gp.b_x      = checked_grid_dim(
+        DivRoundingUp(length[1], bwd)
+            * std::accumulate(length.begin() + 2, length.end(), batch, std::multiplies<size_t>()),
+        wgs);
     gp.wgs_x = wgs;
 
     if(ebtype != EmbeddedType::NONE)
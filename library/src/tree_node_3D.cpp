@@ -23,6 +23,7 @@
 #include "function_pool.h"
 #include "logging.h"
 #include "node_factory.h"
+#include "repo.h"
 #include "tuning_helper.h"
 #include <numeric>
 
@@ -319,7 +320,7 @@ void BLOCKRC3DNode::BuildTree_internal(SchemeTreeVec& child_scheme_trees)
     bool has100          = (length[0] == 100 || length[1] == 100 || length[2] == 100);
     bool has200          = (length[0] == 200 || length[1] == 200 || length[2] == 200);
     bool hasPow2         = (IsPo2(length[0]) || IsPo2(length[1]) || IsPo2(length[2]));
-    bool isDiagonalTrans = is_diagonal_sbrc_3D_length(length[0]) && is_cube_size(length);
+    bool isDiagonalTrans = is_diagonal_sbrc_3D_size(length);
 
     //   none of diagonal is better by Z_XY (every arch)
     //   both 50, 100 are worse by Z_XY (every arch)
@@ -676,6 +677,104 @@ void RC3DNode::AssignParams_internal()
 }
 
 // Leaf Node
+/*****************************************************
+ * CS_KERNEL_3D_SINGLE  *
+ *****************************************************/
+size_t Single3DNode::WorkgroupSize(const std::vector<size_t>& length, rocfft_precision precision)
+{
+    static const size_t MAX_WORKGROUP_SIZE = 1024;
+
+    size_t              num_elems = length[0] * length[1] * length[2];
+    size_t              wgs       = 0;
+    std::vector<size_t> tpts;
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        FMKey key(length[i], precision);
+        if(!function_pool::has_function(key))
+            return 0;
+        size_t tpt = function_pool::get_kernel(key).threads_per_transform[0];
+        tpts.push_back(tpt);
+        wgs = std::max(wgs, tpt * (num_elems / length[i]));
+    }
+
+    // each dimension loops over its transforms if there are more
+    // than fit in one block at once
+    wgs = std::min(wgs, MAX_WORKGROUP_SIZE);
+    for(auto tpt : tpts)
+    {
+        if(wgs % tpt != 0)
+            return 0;
+    }
+    return wgs;
+}
+
+size_t Single3DNode::LDSElems(const std::vector<size_t>& length)
+{
+    // if fastest length is power of 2, pad it to avoid LDS bank conflicts
+    size_t padded_len0 = IsPo2(length[0]) ? length[0] + 1 : length[0];
+    return padded_len0 * length[1] * length[2];
+}
+
+bool Single3DNode::KernelCheck(std::vector<FMKey>& kernel_keys)
+{
+    // consumes the empty key this node has in solution maps
+    if(!LeafNode::KernelCheck(kernel_keys))
+        return false;
+
+    if(WorkgroupSize(length, precision) == 0)
+    {
+        if(LOG_TRACE_ENABLED())
+            (*LogSingleton::GetInstance().GetTraceOS())
+                << "1D kernels for 3D_SINGLE not found" << std::endl;
+        return false;
+    }
+
+    GetKernelFactors();
+    return true;
+}
+
+void Single3DNode::GetKernelFactors()
+{
+    kernelFactors.clear();
+    for(unsigned int i = 0; i < 3; ++i)
+    {
+        auto kernel = function_pool::get_kernel(FMKey(length[i], precision));
+        kernelFactors.insert(kernelFactors.end(), kernel.factors.begin(), kernel.factors.end());
+    }
+}
+
+bool Single3DNode::CreateDeviceResources()
+{
+    std::array<std::vector<size_t>, 3> radices;
+    for(unsigned int i = 0; i < 3; ++i)
+        radices[i] = function_pool::get_kernel(FMKey(length[i], precision)).factors;
+
+    // one set of twiddles for each distinct dimension
+    std::tie(twiddles, twiddles_size) = Repo::GetTwiddles3D(length[0],
+                                                            length[1],
+                                                            length[2],
+                                                            precision,
+                                                            deviceProp,
+                                                            radices[0],
+                                                            radices[1],
+                                                            radices[2]);
+
+    return CreateLargeTwdTable();
+}
+
+void Single3DNode::SetupGPAndFnPtr_internal(DevFnCall& fnPtr, GridParam& gp)
+{
+    // always runtime-compiled
+    fnPtr = nullptr;
+    bwd   = 1;
+    wgs   = WorkgroupSize(length, precision);
+
+    gp.b_x   = batch;
+    gp.wgs_x = wgs;
+
+    lds = LDSElems(length);
+}
+
 /*****************************************************
  * Base Class of fused SBRC and Transpose
  *****************************************************/
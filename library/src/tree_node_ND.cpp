@@ -0,0 +1,197 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "tree_node_ND.h"
+#include "function_pool.h"
+#include "node_factory.h"
+
+#include <numeric>
+
+bool RCNDNode::HigherDimsFold(const std::vector<size_t>& length,
+                              const std::vector<size_t>& stride,
+                              size_t                     dist,
+                              size_t                     batch)
+{
+    for(size_t i = 3; i + 1 < length.size(); ++i)
+    {
+        if(stride[i + 1] != stride[i] * length[i])
+            return false;
+    }
+    return batch == 1 || dist == stride.back() * length.back();
+}
+
+// a layout for one child, strides and distance between batches
+struct NDLayout
+{
+    std::vector<size_t> stride;
+    size_t              dist = 0;
+};
+
+// packed layout of the whole transform, for intermediate results
+static NDLayout contiguous_layout(const std::vector<size_t>& length)
+{
+    NDLayout layout;
+    layout.stride.push_back(1);
+    for(size_t i = 1; i < length.size(); ++i)
+        layout.stride.push_back(layout.stride.back() * length[i - 1]);
+    layout.dist = layout.stride.back() * length.back();
+    return layout;
+}
+
+// layout between the 3D ffts and the columns, when the 3D ffts run
+// first: the output, unless it can't be folded into their batch
+static NDLayout rows_first_mid_layout(const TreeNode& node)
+{
+    if(RCNDNode::HigherDimsFold(node.length, node.outStride, node.oDist, node.batch))
+        return NDLayout{node.outStride, node.oDist};
+    return contiguous_layout(node.length);
+}
+
+// move dimension dim to the front of a vector of lengths or strides,
+// for the 1D FFTs along it
+static std::vector<size_t> dim_to_front(const std::vector<size_t>& v, size_t dim)
+{
+    std::vector<size_t> ret = {v[dim]};
+    for(size_t i = 0; i < v.size(); ++i)
+    {
+        if(i != dim)
+            ret.push_back(v[i]);
+    }
+    return ret;
+}
+
+void RCNDNode::BuildTree_internal(SchemeTreeVec& child_scheme_trees)
+{
+    bool noSolution = child_scheme_trees.empty();
+
+    const size_t numCols = length.size() - 3;
+    if(!noSolution && child_scheme_trees.size() != numCols + 1)
+        throw std::runtime_error("RCNDNode: Unexpected child scheme from solution map");
+
+    // the root's layouts are already known, and decide the order of
+    // the children
+    rowsFirst = HigherDimsFold(length, inStride, iDist, batch);
+    if(!rowsFirst && !HigherDimsFold(length, outStride, oDist, batch))
+        throw std::runtime_error("RCNDNode: no layout folds the higher dimensions into a batch");
+
+    const size_t rowsIdx = rowsFirst ? 0 : numCols;
+    auto         child_scheme
+        = [&](size_t idx) { return noSolution ? CS_NONE : child_scheme_trees[idx]->curScheme; };
+    auto child_tree
+        = [&](size_t idx) { return noSolution ? nullptr : child_scheme_trees[idx].get(); };
+
+    // 3D ffts, whose batch covers the higher dimensions
+    NodeMetaData rowsPlanData(this);
+    rowsPlanData.dimension = 3;
+    rowsPlanData.length.assign(length.begin(), length.begin() + 3);
+    rowsPlanData.batch = std::accumulate(
+        length.begin() + 3, length.end(), batch, std::multiplies<size_t>());
+    // schemes depend on the layout, so give children the ones they
+    // will read
+    const NDLayout inLayout{inStride, iDist};
+    const NDLayout outLayout{outStride, oDist};
+    const NDLayout rowsLayout = rowsFirst ? inLayout : outLayout;
+    const NDLayout colsLayout = rowsFirst ? rows_first_mid_layout(*this) : outLayout;
+    rowsPlanData.inStride.assign(rowsLayout.stride.begin(), rowsLayout.stride.begin() + 3);
+    rowsPlanData.iDist     = rowsLayout.stride[3];
+    rowsPlanData.outStride = rowsPlanData.inStride;
+    rowsPlanData.oDist     = rowsPlanData.iDist;
+    auto rowsPlan = NodeFactory::CreateExplicitNode(rowsPlanData, this, child_scheme(rowsIdx));
+    rowsPlan->RecursiveBuildTree(child_tree(rowsIdx));
+
+    if(rowsFirst)
+        childNodes.emplace_back(std::move(rowsPlan));
+
+    // column ffts along each higher dimension
+    for(size_t dim = 3; dim < length.size(); ++dim)
+    {
+        const size_t colIdx = rowsFirst ? dim - 2 : dim - 3;
+
+        NodeMetaData colPlanData(this);
+        colPlanData.dimension = 1;
+        colPlanData.length    = dim_to_front(length, dim);
+        // the first column reads the input when the 3D ffts run last
+        const NDLayout& colIn = !rowsFirst && dim == 3 ? inLayout : colsLayout;
+        colPlanData.inStride  = dim_to_front(colIn.stride, dim);
+        colPlanData.outStride = dim_to_front(colsLayout.stride, dim);
+        colPlanData.iDist     = colIn.dist;
+        colPlanData.oDist     = colsLayout.dist;
+
+        std::unique_ptr<TreeNode> colPlan;
+        if(child_scheme(colIdx) == CS_NONE
+           && function_pool::has_SBCC_kernel(length[dim], precision))
+        {
+            colPlan
+                = NodeFactory::CreateNodeFromScheme(CS_KERNEL_STOCKHAM_BLOCK_CC, this);
+            colPlan->length    = colPlanData.length;
+            colPlan->dimension = 1;
+        }
+        else
+        {
+            colPlan = NodeFactory::CreateExplicitNode(colPlanData, this, child_scheme(colIdx));
+            colPlan->RecursiveBuildTree(child_tree(colIdx));
+        }
+        childNodes.emplace_back(std::move(colPlan));
+    }
+
+    if(!rowsFirst)
+        childNodes.emplace_back(std::move(rowsPlan));
+}
+
+void RCNDNode::AssignParams_internal()
+{
+    const size_t numCols = length.size() - 3;
+    const NDLayout inLayout{inStride, iDist};
+    const NDLayout outLayout{outStride, oDist};
+
+    // 3D ffts see the higher dimensions as their batch
+    auto assign_rows = [](TreeNode& rows, const NDLayout& in, const NDLayout& out) {
+        rows.inStride.assign(in.stride.begin(), in.stride.begin() + 3);
+        rows.iDist = in.stride[3];
+        rows.outStride.assign(out.stride.begin(), out.stride.begin() + 3);
+        rows.oDist = out.stride[3];
+        rows.AssignParams();
+    };
+    auto assign_col = [](TreeNode& col, size_t dim, const NDLayout& in, const NDLayout& out) {
+        col.inStride  = dim_to_front(in.stride, dim);
+        col.iDist     = in.dist;
+        col.outStride = dim_to_front(out.stride, dim);
+        col.oDist     = out.dist;
+        col.AssignParams();
+    };
+
+    if(rowsFirst)
+    {
+        // the columns finish in place after the 3D ffts, except for
+        // the last which writes the output
+        const NDLayout mid = rows_first_mid_layout(*this);
+        assign_rows(*childNodes[0], inLayout, mid);
+        for(size_t i = 0; i < numCols; ++i)
+            assign_col(*childNodes[i + 1], i + 3, mid, i + 1 == numCols ? outLayout : mid);
+    }
+    else
+    {
+        // the first column reads the input, and everything else
+        // happens in place on the output
+        for(size_t i = 0; i < numCols; ++i)
+            assign_col(*childNodes[i], i + 3, i == 0 ? inLayout : outLayout, outLayout);
+        assign_rows(*childNodes[numCols], outLayout, outLayout);
+    }
+}
@@ -19,11 +19,77 @@
 // THE SOFTWARE.
 
 #include "tree_node_bluestein.h"
+#include "../../shared/arithmetic.h"
 #include "function_pool.h"
 #include "kernel_launch.h"
 #include "node_factory.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <numeric>
 
+// Estimated relative cost of one kernel's FFT pass over a length.
+// Every kernel reads and writes the whole length once, and each
+// radix pass inside it goes through LDS.  Butterfly slots left idle
+// by a poor length/thread fit are wasted.
+static double BlueKernelCost(size_t length, const FMKey& key)
+{
+    // global memory traffic vs. one LDS pass, roughly
+    static const double ldsPassWeight = 0.25;
+
+    if(!function_pool::has_function(key))
+    {
+        // no single kernel; assume radix-8 passes and perfect fit
+        size_t passes = 1;
+        for(size_t p = 8; p < length; p *= 8)
+            ++passes;
+        return length * (1.0 + ldsPassWeight * passes);
+    }
+
+    auto   kernel       = function_pool::get_kernel(key);
+    size_t tpt          = std::max(kernel.threads_per_transform[0], 1);
+    double useful_slots = 0.0;
+    double total_slots  = 0.0;
+    for(auto width : kernel.factors)
+    {
+        double height = static_cast<double>(length) / width / tpt;
+        useful_slots += height;
+        total_slots += std::ceil(height);
+    }
+    double util = total_slots > 0.0 ? useful_slots / total_slots : 1.0;
+    return length * (1.0 + ldsPassWeight * kernel.factors.size()) / util;
+}
+
+// Estimated relative cost of the forward and inverse FFTs Bluestein
+// runs at lengthBlue.
+static double BlueLengthCost(size_t lengthBlue, rocfft_precision precision)
+{
+    if(precision == rocfft_precision_half)
+        precision = rocfft_precision_single;
+
+    double cost;
+    if(function_pool::has_function(FMKey(lengthBlue, precision)))
+        cost = BlueKernelCost(lengthBlue, FMKey(lengthBlue, precision));
+    else if(auto divLength1 = NodeFactory::Large1DDivLength(precision, lengthBlue))
+    {
+        // column kernel plus row kernel, each over the whole length
+        auto   divLength0 = lengthBlue / divLength1;
+        FMKey  ccKey(divLength1, precision, CS_KERNEL_STOCKHAM_BLOCK_CC);
+        FMKey  rcKey(divLength0, precision, CS_KERNEL_STOCKHAM_BLOCK_RC, TILE_ALIGNED);
+        double ccCost = BlueKernelCost(divLength1, ccKey) / divLength1;
+        double rcCost = BlueKernelCost(divLength0, rcKey) / divLength0;
+        cost          = (ccCost + rcCost) * lengthBlue;
+    }
+    else
+        cost = BlueKernelCost(lengthBlue, FMKey(lengthBlue, precision));
+
+    // non-pow2 radices need more arithmetic per point, which has been
+    // measured at roughly 10% in practice
+    if(!IsPo2(lengthBlue))
+        cost /= 0.9;
+    return cost;
+}
+
 size_t BluesteinNode::FindBlue(size_t len, rocfft_precision precision, bool forcePow2)
 {
     if(forcePow2)
@@ -39,22 +105,22 @@ size_t BluesteinNode::FindBlue(size_t len, rocfft_precision precision, bool forc
         lenPow2 <<= 1;
 
     size_t minLenBlue  = 2 * len - 1;
-    size_t length      = minLenBlue;
     size_t lenPow2Blue = 2 * lenPow2;
 
-    // We don't want to choose a non-pow2 length that is too close to lenPow2Blue,
-    // otherwise using a non-pow2 length may end up being slower than using lenPow2Blue.
-    // This ratio has been experimentally verified to yield a non-pow2 length that is at
-    // least as fast as its corresponding pow2 length.
-    double lenCutOffRatio = .9;
-
-    for(length = minLenBlue; length < lenPow2Blue; ++length)
+    // Lengths between minLenBlue and lenPow2Blue move less data, but
+    // their kernels can need more passes or leave more butterfly
+    // slots idle, so pick whichever has the lowest estimated cost
+    // rather than the first one that fits.
+    size_t length   = lenPow2Blue;
+    double bestCost = BlueLengthCost(lenPow2Blue, precision);
+    for(auto candidate : NodeFactory::NonPow2LengthsSupported(precision, minLenBlue, lenPow2Blue))
     {
-        auto lenSupported = NodeFactory::NonPow2LengthSupported(precision, length);
-        auto lenRatio     = static_cast<double>(length) / static_cast<double>(lenPow2Blue);
-
-        if(lenSupported && lenRatio < lenCutOffRatio)
-            break;
+        auto cost = BlueLengthCost(candidate, precision);
+        if(cost < bestCost)
+        {
+            length   = candidate;
+            bestCost = cost;
+        }
     }
 
     return length;
@@ -62,7 +128,16 @@ size_t BluesteinNode::FindBlue(size_t len, rocfft_precision precision, bool forc
 
 BluesteinType BluesteinNode::DecideBlueType()
 {
-    bool useSingleKernel = BluesteinSingleNode::SizeFits(length[0], precision);
+    // single and fused kernels access user buffers through Bluestein
+    // helper functions, which don't convert storage formats
+    const TreeNode* root = this;
+    while(root->parent)
+        root = root->parent;
+    bool nativeStorage = root->loadOps.storage == rocfft_storage_format_native
+                         && root->storeOps.storage == rocfft_storage_format_native;
+
+    bool useSingleKernel
+        = nativeStorage && BluesteinSingleNode::SizeFits(length[0], precision, deviceProp);
 
     // single kernel sticks to pow2 lengthBlue.  the kernel does many
     // other things besides FFTs, so keep radices simple to reduce
@@ -82,8 +157,10 @@ BluesteinType BluesteinNode::DecideBlueType()
     if(scheme == CS_L1D_CC)
     {
         // Allow fused Bluestein optimization only for 1D
-        // complex forward and complex inverse transforms.
-        auto fusedBluesteinAllow = (parent) ? false : true;
+        // complex forward and complex inverse transforms, and for
+        // real-to-complex transforms whose real input and Hermitian
+        // output the fused kernels access directly.
+        auto fusedBluesteinAllow = (parent && !ReadsRealInputDirectly()) ? false : nativeStorage;
 
         auto type = fusedBluesteinAllow ? BluesteinType::BT_MULTI_KERNEL_FUSED
                                         : BluesteinType::BT_MULTI_KERNEL;
@@ -97,6 +174,14 @@ BluesteinType BluesteinNode::DecideBlueType()
     return BluesteinType::BT_NONE;
 }
 
+bool BluesteinNode::ReadsRealInputDirectly() const
+{
+    // the only child of a real-to-complex root, in place of the
+    // copy kernels that would otherwise surround it
+    return parent && !parent->parent && parent->scheme == CS_REAL_TRANSFORM_USING_CMPLX
+           && parent->inArrayType == rocfft_array_type_real && !outputLength.empty();
+}
+
 /*****************************************************
  * CS_BLUESTEIN
  *****************************************************/
@@ -407,16 +492,227 @@ void BluesteinNode::AssignParams_internal()
     }
 }
 
+/*****************************************************
+ * CS_RADER
+ *****************************************************/
+bool RaderNode::SizeFits(size_t                 length,
+                         rocfft_precision       precision,
+                         const hipDeviceProp_t& deviceProp)
+{
+    // small primes are faster as single-kernel Bluestein
+    if(length < 3 || BluesteinSingleNode::SizeFits(length, precision, deviceProp))
+        return false;
+
+    // index tables are 32-bit, and index products must fit in 64 bits
+    if(length > std::numeric_limits<unsigned int>::max())
+        return false;
+
+    for(size_t f = 2; f * f <= length; ++f)
+    {
+        if(length % f == 0)
+            return false;
+    }
+
+    // the convolution is done with ordinary FFTs of length p-1
+    return NodeFactory::SupportedLength(precision, length - 1);
+}
+
+size_t RaderNode::PowMod(size_t base, size_t exp, size_t p)
+{
+    size_t result = 1;
+    for(base %= p; exp; exp >>= 1)
+    {
+        if(exp & 1)
+            result = result * base % p;
+        base = base * base % p;
+    }
+    return result;
+}
+
+size_t RaderNode::PrimitiveRoot(size_t p)
+{
+    // distinct prime factors of p-1
+    std::vector<size_t> factors;
+    size_t              rem = p - 1;
+    for(size_t f = 2; f * f <= rem; ++f)
+    {
+        if(rem % f == 0)
+            factors.push_back(f);
+        while(rem % f == 0)
+            rem /= f;
+    }
+    if(rem > 1)
+        factors.push_back(rem);
+
+    // g generates the group iff g^((p-1)/q) != 1 for every prime q
+    for(size_t g = 2; g < p; ++g)
+    {
+        if(std::all_of(factors.begin(), factors.end(), [&](size_t q) {
+               return PowMod(g, (p - 1) / q, p) != 1;
+           }))
+            return g;
+    }
+    throw std::runtime_error("no primitive root for Rader length " + std::to_string(p));
+}
+
+size_t RaderNode::BufferLength(size_t length, size_t count)
+{
+    // index tables, convolution kernel, then one slot per transform
+    return (count + 3) * (length + 1);
+}
+
+void RaderNode::BuildTree_internal(SchemeTreeVec& child_scheme_trees)
+{
+    // With g a primitive root mod p and a[q] = x[g^q], the nonzero
+    // outputs are
+    //
+    //   X[g^-m] = x[0] + sum_q a[q] * W^(g^(q-m))
+    //
+    // i.e. a cyclic convolution of length p-1, done with forward
+    // and inverse FFTs of length p-1.
+    //
+    // Bluestein buffer layout in complex elements, with D = p + 1:
+    //   [0, 2D)   g^q and g^-q index tables, as unsigned ints
+    //   [2D, 3D)  convolution kernel, FFTed along with the data
+    //   [3D, ...) D per transform: p-1 reordered points, x[0],
+    //             and the DC term of their FFT
+    lengthBlue = length[0] + 1;
+
+    auto chirpPlan        = NodeFactory::CreateNodeFromScheme(CS_KERNEL_RADER_CHIRP, this);
+    chirpPlan->dimension  = 1;
+    chirpPlan->length     = {length[0]};
+    chirpPlan->lengthBlue = lengthBlue;
+    chirpPlan->direction  = direction;
+    chirpPlan->batch      = 1;
+
+    auto gatherPlan        = NodeFactory::CreateNodeFromScheme(CS_KERNEL_RADER_GATHER, this);
+    gatherPlan->dimension  = 1;
+    gatherPlan->length     = length;
+    gatherPlan->lengthBlue = lengthBlue;
+
+    NodeMetaData fwdPlanData(this);
+    fwdPlanData.dimension = 1;
+    fwdPlanData.length.push_back(length[0] - 1);
+    fwdPlanData.batch
+        *= std::accumulate(length.begin() + 1, length.end(), 1, std::multiplies<size_t>());
+    fwdPlanData.batch++;
+    fwdPlanData.direction = -1;
+    fwdPlanData.iOffset   = 2 * lengthBlue;
+    fwdPlanData.oOffset   = 2 * lengthBlue;
+    auto fwdPlan          = NodeFactory::CreateExplicitNode(fwdPlanData, this);
+    // in-place for the same reason as Bluestein: the kernel and the
+    // data are transformed together via the offsets
+    fwdPlan->allowOutofplace = false;
+    fwdPlan->RecursiveBuildTree();
+
+    auto mulPlan        = NodeFactory::CreateNodeFromScheme(CS_KERNEL_RADER_MUL, this);
+    mulPlan->dimension  = 1;
+    mulPlan->length     = length;
+    mulPlan->lengthBlue = lengthBlue;
+
+    NodeMetaData invPlanData(this);
+    invPlanData.dimension = 1;
+    invPlanData.length.push_back(length[0] - 1);
+    for(size_t index = 1; index < length.size(); index++)
+        invPlanData.length.push_back(length[index]);
+    invPlanData.direction    = 1;
+    invPlanData.iOffset      = 3 * lengthBlue;
+    invPlanData.oOffset      = 3 * lengthBlue;
+    auto invPlan             = NodeFactory::CreateExplicitNode(invPlanData, this);
+    invPlan->allowOutofplace = false;
+    invPlan->RecursiveBuildTree();
+
+    auto scatterPlan        = NodeFactory::CreateNodeFromScheme(CS_KERNEL_RADER_SCATTER, this);
+    scatterPlan->dimension  = 1;
+    scatterPlan->length     = length;
+    scatterPlan->lengthBlue = lengthBlue;
+
+    childNodes.emplace_back(std::move(chirpPlan));
+    childNodes.emplace_back(std::move(gatherPlan));
+    childNodes.emplace_back(std::move(fwdPlan));
+    childNodes.emplace_back(std::move(mulPlan));
+    childNodes.emplace_back(std::move(invPlan));
+    childNodes.emplace_back(std::move(scatterPlan));
+}
+
+void RaderNode::AssignParams_internal()
+{
+    auto& chirpPlan   = childNodes[0];
+    auto& gatherPlan  = childNodes[1];
+    auto& fwdPlan     = childNodes[2];
+    auto& mulPlan     = childNodes[3];
+    auto& invPlan     = childNodes[4];
+    auto& scatterPlan = childNodes[5];
+
+    chirpPlan->inStride.push_back(1);
+    chirpPlan->iDist = lengthBlue;
+    chirpPlan->outStride.push_back(1);
+    chirpPlan->oDist = lengthBlue;
+
+    gatherPlan->inStride = inStride;
+    gatherPlan->iDist    = iDist;
+
+    gatherPlan->outStride.push_back(1);
+    gatherPlan->oDist = lengthBlue;
+    for(size_t index = 1; index < length.size(); index++)
+    {
+        gatherPlan->outStride.push_back(gatherPlan->oDist);
+        gatherPlan->oDist *= length[index];
+    }
+
+    fwdPlan->inStride  = chirpPlan->outStride;
+    fwdPlan->iDist     = chirpPlan->oDist;
+    fwdPlan->outStride = fwdPlan->inStride;
+    fwdPlan->oDist     = fwdPlan->iDist;
+    fwdPlan->AssignParams();
+
+    mulPlan->inStride  = gatherPlan->outStride;
+    mulPlan->iDist     = gatherPlan->oDist;
+    mulPlan->outStride = mulPlan->inStride;
+    mulPlan->oDist     = mulPlan->iDist;
+
+    invPlan->inStride  = mulPlan->outStride;
+    invPlan->iDist     = mulPlan->oDist;
+    invPlan->outStride = invPlan->inStride;
+    invPlan->oDist     = invPlan->iDist;
+    invPlan->AssignParams();
+
+    scatterPlan->inStride  = invPlan->outStride;
+    scatterPlan->iDist     = invPlan->oDist;
+    scatterPlan->outStride = outStride;
+    scatterPlan->oDist     = oDist;
+}
+
 BluesteinSingleNode::BluesteinSingleNode(TreeNode* p, ComputeScheme s)
     : LeafNode(p, s)
 {
     need_twd_table = true;
 }
 
-bool BluesteinSingleNode::SizeFits(size_t length, rocfft_precision precision)
+bool BluesteinSingleNode::SizeFits(size_t                 length,
+                                   rocfft_precision       precision,
+                                   const hipDeviceProp_t& deviceProp)
 {
-    // 2N - 1 must fit into a single kernel
-    return 2 * length - 1 < function_pool::get_largest_length(precision);
+    // the pow2 lengthBlue >= 2N - 1 must fit into a single kernel.
+    // the kernel does many other things besides FFTs, so it stays at
+    // 8192 points even where longer Stockham kernels exist.  medium
+    // primes past 2048 are still far fewer global passes this way,
+    // as long as the padded length fits in the device's LDS.
+    static const size_t maxLengthBlue = 8192;
+    auto                lengthBlue    = BluesteinNode::FindBlue(length, precision, true);
+    if(lengthBlue > maxLengthBlue)
+        return false;
+
+    FMKey key(lengthBlue, precision);
+    if(!function_pool::has_function(key))
+        return false;
+
+    // the kernel keeps whole lengthBlue transforms in LDS
+    size_t ldsSize = deviceProp.sharedMemPerBlock;
+    if(ldsSize == 0)
+        ldsSize = 64 * 1024;
+    auto transforms = std::max(function_pool::get_kernel(key).transforms_per_block, 1u);
+    return lengthBlue * transforms * complex_type_size(precision) <= ldsSize;
 }
 
 size_t BluesteinSingleNode::GetTwiddleTableLength()
@@ -431,12 +727,14 @@ void BluesteinSingleNode::GetKernelFactors()
     // lot of VGPRs.  these kernels already do a lot of other stuff
     // besides FFTs, so we need to keep VGPR usage down to get enough
     // occupancy.  fortunately, single-kernel bluestein is always
-    // using pow2 <= 4096, and only at length 2048 do we start to
+    // using pow2 <= 8192, and only at length 2048 do we start to
     // want radix-16 anyway.
     if(lengthBlue == 2048)
         kernelFactors = {8, 8, 8, 4};
     else if(lengthBlue == 4096)
         kernelFactors = {8, 8, 8, 8};
+    else if(lengthBlue == 8192)
+        kernelFactors = {8, 8, 8, 8, 2};
     else
         kernelFactors
             = function_pool::get_kernel(FMKey(lengthBlue, precision, CS_KERNEL_STOCKHAM)).factors;
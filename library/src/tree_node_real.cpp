@@ -23,6 +23,7 @@
 #include "function_pool.h"
 #include "node_factory.h"
 #include "real2complex.h"
+#include "tuning_helper.h"
 
 // work out the real and complex lengths on a real-complex plan, and
 // return pointers to those lengths
@@ -57,6 +58,18 @@ static void set_complex_length(TreeNode&                   node,
     }
 }
 
+// ask an even-length real transform child of a multi-dimensional
+// plan to fuse its pre/post-processing into its row FFT, so that
+// transpose-based layouts don't depend on a transpose fuse shim
+// surviving buffer assignment.  Rows longer than 2048 points would
+// need too much LDS, so those keep a separate kernel.
+static void try_fuse_row_pre_post_processing(TreeNode& rowPlan, size_t rowLength)
+{
+    static const size_t maxFusedRowLength = 2048;
+    static_cast<RealTransEvenNode&>(rowPlan).try_fuse_pre_post_processing
+        = rowLength <= maxFusedRowLength;
+}
+
 // check if we have an SBCC kernel along the specified dimension
 static bool SBCC_dim_available(const std::vector<size_t>& length,
                                size_t                     sbcc_dim,
@@ -68,7 +81,7 @@ static bool SBCC_dim_available(const std::vector<size_t>& length,
     // do we have a purpose-built sbcc kernel
     bool  have_sbcc = false;
     FMKey sbcc_key(length[sbcc_dim], precision, CS_KERNEL_STOCKHAM_BLOCK_CC);
-    if(function_pool::has_function(sbcc_key))
+    if(function_pool::has_SBCC_kernel(length[sbcc_dim], precision))
     {
         numTrans  = function_pool::get_kernel(sbcc_key).transforms_per_block;
         have_sbcc = true;
@@ -101,12 +114,28 @@ static bool SBCC_dim_available(const std::vector<size_t>& length,
     return true;
 }
 
-// check if we have an SBCR kernel along the specified dimension
+// check if we have an SBCR kernel along the specified dimension,
+// including ones derived from row kernels
 static bool SBCR_dim_available(const std::vector<size_t>& length,
                                size_t                     sbcr_dim,
                                rocfft_precision           precision)
 {
-    return function_pool::has_SBCR_kernel(length[sbcr_dim], precision);
+    return function_pool::has_SBCR_kernel(length[sbcr_dim], precision, true);
+}
+
+// scheme to transform a higher dimension of an SBCR plan with.
+// Without an SBCR kernel, a row kernel reads the strided column and
+// writes it rotated the same way, which costs coalescing on the
+// load but still avoids the standalone transposes of TR_PAIRS.
+static ComputeScheme SBCR_dim_scheme(const std::vector<size_t>& length,
+                                     size_t                     sbcr_dim,
+                                     rocfft_precision           precision)
+{
+    if(SBCR_dim_available(length, sbcr_dim, precision))
+        return CS_KERNEL_STOCKHAM_BLOCK_CR;
+    if(function_pool::has_function(FMKey(length[sbcr_dim], precision)))
+        return CS_KERNEL_STOCKHAM;
+    return CS_NONE;
 }
 
 /*****************************************************
@@ -139,6 +168,49 @@ void RealTransCmplxNode::BuildTree_internal(SchemeTreeVec& child_scheme_trees)
         determined_scheme = child_scheme_trees[1]->curScheme;
     }
 
+    // A 1D transform that one kernel can do can read the real input
+    // or write the real output itself, and only touch the
+    // non-redundant half of the Hermitian data - so there's no
+    // need to copy to and from a full-length complex buffer.
+    if(noSolution && parent == nullptr && dimension == 1 && realLength->front() % 2 == 1
+       && placement == rocfft_placement_notinplace
+       && loadOps.storage == rocfft_storage_format_native
+       && storeOps.storage == rocfft_storage_format_native
+       && function_pool::has_function(FMKey(realLength->front(), precision)))
+    {
+        auto fftPlan          = NodeFactory::CreateNodeFromScheme(CS_KERNEL_STOCKHAM, this);
+        fftPlan->dimension    = dimension;
+        fftPlan->length       = *realLength;
+        fftPlan->outputLength = r2c ? *complexLength : *realLength;
+        fftPlan->ebtype       = r2c ? EmbeddedType::Real2C_ODD : EmbeddedType::C2Real_ODD;
+        childNodes.emplace_back(std::move(fftPlan));
+        return;
+    }
+
+    // Likewise, a forward 1D transform done with fused Bluestein
+    // kernels can read the real input in its first chirp multiply
+    // and write only the Hermitian half in its last one.
+    if(noSolution && parent == nullptr && dimension == 1 && r2c
+       && placement == rocfft_placement_notinplace
+       && loadOps.storage == rocfft_storage_format_native
+       && storeOps.storage == rocfft_storage_format_native)
+    {
+        NodeMetaData bluePlanData(this);
+        bluePlanData.dimension    = dimension;
+        bluePlanData.length       = *realLength;
+        bluePlanData.outputLength = *complexLength;
+        if(NodeFactory::DecideNodeScheme(bluePlanData, this) == CS_BLUESTEIN)
+        {
+            auto bluePlan = NodeFactory::CreateExplicitNode(bluePlanData, this, CS_BLUESTEIN);
+            bluePlan->RecursiveBuildTree();
+            if(bluePlan->typeBlue == BluesteinType::BT_MULTI_KERNEL_FUSED)
+            {
+                childNodes.emplace_back(std::move(bluePlan));
+                return;
+            }
+        }
+    }
+
     auto copyHeadPlan = NodeFactory::CreateNodeFromScheme(copyHeadScheme, this);
     // head copy plan
     copyHeadPlan->dimension = dimension;
@@ -174,6 +246,26 @@ void RealTransCmplxNode::BuildTree_internal(SchemeTreeVec& child_scheme_trees)
 
 void RealTransCmplxNode::AssignParams_internal()
 {
+    if(childNodes.size() == 1)
+    {
+        // single kernel or fused Bluestein reads and writes the user
+        // buffers
+        auto& fftPlan      = childNodes[0];
+        fftPlan->inStride  = inStride;
+        fftPlan->iDist     = iDist;
+        fftPlan->outStride = outStride;
+        fftPlan->oDist     = oDist;
+        if(fftPlan->scheme == CS_BLUESTEIN)
+        {
+            fftPlan->inStrideBlue  = inStrideBlue;
+            fftPlan->iDistBlue     = iDistBlue;
+            fftPlan->outStrideBlue = outStrideBlue;
+            fftPlan->oDistBlue     = oDistBlue;
+            fftPlan->AssignParams();
+        }
+        return;
+    }
+
     assert(childNodes.size() == 3);
     auto& copyHeadPlan = childNodes[0];
     auto& fftPlan      = childNodes[1];
@@ -205,6 +297,281 @@ void RealTransCmplxNode::AssignParams_internal()
     copyTailPlan->oDist     = oDist;
 }
 
+/*****************************************************
+ * CS_REAL_TRANSFORM_PAIR
+ *****************************************************/
+void RealTransPairNode::BuildTree_internal(SchemeTreeVec& child_scheme_trees)
+{
+    bool noSolution = child_scheme_trees.empty();
+
+    if(direction != -1 || dimension != 1 || batch % 2 != 0)
+        throw std::runtime_error("RealTransPairNode needs a 1D forward transform with even batch");
+
+    const std::vector<size_t>* realLength    = nullptr;
+    const std::vector<size_t>* complexLength = nullptr;
+    set_complex_length(*this, realLength, complexLength);
+
+    // check schemes from solution map
+    ComputeScheme determined_scheme = CS_NONE;
+    if(!noSolution)
+    {
+        if((child_scheme_trees.size() != 3)
+           || (child_scheme_trees[0]->curScheme != CS_KERNEL_PAIR_R_TO_CMPLX)
+           || (child_scheme_trees[2]->curScheme != CS_KERNEL_PAIR_CMPLX_TO_HERM))
+        {
+            throw std::runtime_error(
+                "RealTransPairNode: Unexpected child scheme from solution map");
+        }
+        determined_scheme = child_scheme_trees[1]->curScheme;
+    }
+
+    // each child transform handles a pair of real transforms
+    auto packPlan       = NodeFactory::CreateNodeFromScheme(CS_KERNEL_PAIR_R_TO_CMPLX, this);
+    packPlan->dimension = dimension;
+    packPlan->length    = *realLength;
+    packPlan->batch     = batch / 2;
+    childNodes.emplace_back(std::move(packPlan));
+
+    NodeMetaData fftPlanData(this);
+    fftPlanData.dimension = dimension;
+    fftPlanData.length    = *realLength;
+    fftPlanData.batch     = batch / 2;
+
+    auto fftPlan = NodeFactory::CreateExplicitNode(fftPlanData, this, determined_scheme);
+    fftPlan->RecursiveBuildTree((noSolution) ? nullptr : child_scheme_trees[1].get());
+
+    // the unpack kernel reads both Z[k] and Z[N-k] from one complex
+    // interleaved buffer
+    fftPlan->GetLastLeaf()->allowedOutArrayTypes = {rocfft_array_type_complex_interleaved};
+    childNodes.emplace_back(std::move(fftPlan));
+
+    auto unpackPlan = NodeFactory::CreateNodeFromScheme(CS_KERNEL_PAIR_CMPLX_TO_HERM, this);
+    unpackPlan->dimension    = dimension;
+    unpackPlan->length       = *realLength;
+    unpackPlan->outputLength = *complexLength;
+    unpackPlan->batch        = batch / 2;
+    childNodes.emplace_back(std::move(unpackPlan));
+}
+
+void RealTransPairNode::AssignParams_internal()
+{
+    assert(childNodes.size() == 3);
+    auto& packPlan   = childNodes[0];
+    auto& fftPlan    = childNodes[1];
+    auto& unpackPlan = childNodes[2];
+
+    packPlan->inStride = inStride;
+    packPlan->iDist    = iDist;
+
+    packPlan->outStride = {1};
+    packPlan->oDist     = packPlan->length[0];
+
+    fftPlan->inStride  = packPlan->outStride;
+    fftPlan->iDist     = packPlan->oDist;
+    fftPlan->outStride = fftPlan->inStride;
+    fftPlan->oDist     = fftPlan->iDist;
+
+    fftPlan->AssignParams();
+
+    unpackPlan->inStride = fftPlan->outStride;
+    unpackPlan->iDist    = fftPlan->oDist;
+
+    unpackPlan->outStride = outStride;
+    unpackPlan->oDist     = oDist;
+}
+
+/*****************************************************
+ * CS_REAL_TRANSFORM_PACKED
+ *****************************************************/
+// contiguous strides and distance for data of the given lengths
+static void set_contiguous_strides(const std::vector<size_t>& length,
+                                   std::vector<size_t>&       stride,
+                                   size_t&                    dist)
+{
+    stride.clear();
+    dist = 1;
+    for(auto len : length)
+    {
+        stride.push_back(dist);
+        dist *= len;
+    }
+}
+
+void RealTransPackedNode::BuildTree_internal(SchemeTreeVec& child_scheme_trees)
+{
+    bool noSolution = child_scheme_trees.empty();
+
+    const std::vector<size_t>* realLength    = nullptr;
+    const std::vector<size_t>* complexLength = nullptr;
+    set_complex_length(*this, realLength, complexLength);
+
+    if(realLength->front() != 2 * complexLength->front())
+        throw std::runtime_error("RealTransPackedNode needs packed Hermitian lengths");
+
+    const bool    r2c            = direction == -1;
+    ComputeScheme packScheme     = r2c ? CS_KERNEL_PACK_HERM : CS_KERNEL_UNPACK_HERM;
+    const size_t  packChild      = r2c ? 1 : 0;
+    const size_t  transformChild = r2c ? 0 : 1;
+
+    // check schemes from solution map
+    ComputeScheme determined_scheme = CS_NONE;
+    if(!noSolution)
+    {
+        if((child_scheme_trees.size() != 2)
+           || (child_scheme_trees[packChild]->curScheme != packScheme))
+        {
+            throw std::runtime_error(
+                "RealTransPackedNode: Unexpected child scheme from solution map");
+        }
+        determined_scheme = child_scheme_trees[transformChild]->curScheme;
+    }
+
+    // the ordinary Hermitian data has the Nyquist element too
+    auto hermLength = *complexLength;
+    hermLength.front() += 1;
+
+    auto packPlan          = NodeFactory::CreateNodeFromScheme(packScheme, this);
+    packPlan->dimension    = dimension;
+    packPlan->length       = *complexLength;
+    packPlan->outputLength = r2c ? *complexLength : hermLength;
+
+    // the real transform goes between the user's real data and
+    // contiguous Hermitian data in a temp buffer
+    NodeMetaData fftPlanData(this);
+    fftPlanData.dimension    = dimension;
+    fftPlanData.length       = r2c ? *realLength : hermLength;
+    fftPlanData.outputLength = r2c ? hermLength : *realLength;
+    fftPlanData.placement    = rocfft_placement_notinplace;
+    fftPlanData.inArrayType
+        = r2c ? rocfft_array_type_real : rocfft_array_type_hermitian_interleaved;
+    fftPlanData.outArrayType
+        = r2c ? rocfft_array_type_hermitian_interleaved : rocfft_array_type_real;
+    if(r2c)
+    {
+        fftPlanData.inStride = inStride;
+        fftPlanData.iDist    = iDist;
+        set_contiguous_strides(hermLength, fftPlanData.outStride, fftPlanData.oDist);
+    }
+    else
+    {
+        set_contiguous_strides(hermLength, fftPlanData.inStride, fftPlanData.iDist);
+        fftPlanData.outStride = outStride;
+        fftPlanData.oDist     = oDist;
+    }
+    if(determined_scheme == CS_NONE)
+        determined_scheme = NodeFactory::DecideRealScheme(fftPlanData);
+
+    auto fftPlan = NodeFactory::CreateExplicitNode(fftPlanData, this, determined_scheme);
+    fftPlan->RecursiveBuildTree((noSolution) ? nullptr : child_scheme_trees[transformChild].get());
+
+    if(r2c)
+    {
+        // the pack kernel reads X[0] and X[N/2] from one complex
+        // interleaved buffer
+        fftPlan->GetLastLeaf()->allowedOutArrayTypes = {rocfft_array_type_complex_interleaved};
+        childNodes.emplace_back(std::move(fftPlan));
+        childNodes.emplace_back(std::move(packPlan));
+    }
+    else
+    {
+        childNodes.emplace_back(std::move(packPlan));
+        childNodes.emplace_back(std::move(fftPlan));
+    }
+}
+
+void RealTransPackedNode::AssignParams_internal()
+{
+    assert(childNodes.size() == 2);
+    const bool r2c      = direction == -1;
+    auto&      fftPlan  = childNodes[r2c ? 0 : 1];
+    auto&      packPlan = childNodes[r2c ? 1 : 0];
+
+    if(r2c)
+    {
+        fftPlan->inStride = inStride;
+        fftPlan->iDist    = iDist;
+        set_contiguous_strides(fftPlan->outputLength, fftPlan->outStride, fftPlan->oDist);
+        fftPlan->AssignParams();
+
+        packPlan->inStride  = fftPlan->outStride;
+        packPlan->iDist     = fftPlan->oDist;
+        packPlan->outStride = outStride;
+        packPlan->oDist     = oDist;
+    }
+    else
+    {
+        packPlan->inStride = inStride;
+        packPlan->iDist    = iDist;
+        set_contiguous_strides(packPlan->outputLength, packPlan->outStride, packPlan->oDist);
+
+        fftPlan->inStride  = packPlan->outStride;
+        fftPlan->iDist     = packPlan->oDist;
+        fftPlan->outStride = outStride;
+        fftPlan->oDist     = oDist;
+        fftPlan->AssignParams();
+    }
+}
+
+/*****************************************************
+ * CS_REAL_TO_REAL
+ *****************************************************/
+size_t real_to_real_fft_length(rocfft_transform_type type, size_t realLength)
+{
+    switch(type)
+    {
+    case rocfft_transform_type_dct1:
+        // even extension of x[0..N-1] without repeating the endpoints
+        return 2 * (realLength - 1);
+    case rocfft_transform_type_dst1:
+        // odd extension of 0,x[0..N-1],0
+        return 2 * (realLength + 1);
+    case rocfft_transform_type_dct4:
+    case rocfft_transform_type_dst4:
+        // even lengths pack pairs of inputs into an N/2-point FFT,
+        // odd lengths are zero-padded to a 2N-point FFT
+        return realLength % 2 == 0 ? realLength / 2 : 2 * realLength;
+    default:
+        // types II and III reorder (and twiddle) the input into an
+        // N-point complex FFT
+        return realLength;
+    }
+}
+
+void RealToRealNode::BuildTree_internal(SchemeTreeVec& child_scheme_trees)
+{
+    if(dimension != 1)
+        throw std::runtime_error("RealToRealNode only supports 1D transforms");
+
+    const size_t fftLength = real_to_real_fft_length(r2rType, length[0]);
+    if(!function_pool::has_function(FMKey(fftLength, precision)))
+        throw std::runtime_error("RealToRealNode: no single kernel for length "
+                                 + std::to_string(fftLength));
+
+    // the whole transform is one Stockham kernel, whose loads and
+    // stores do the extension/reordering and twiddling
+    auto fftPlan          = NodeFactory::CreateNodeFromScheme(CS_KERNEL_STOCKHAM, this);
+    fftPlan->dimension    = 1;
+    fftPlan->length       = {fftLength};
+    fftPlan->outputLength = length;
+    fftPlan->ebtype       = EmbeddedType::Real2Real;
+    fftPlan->r2rType      = r2rType;
+    fftPlan->direction
+        = (r2rType == rocfft_transform_type_dct3 || r2rType == rocfft_transform_type_dst3) ? 1
+                                                                                           : -1;
+    childNodes.emplace_back(std::move(fftPlan));
+}
+
+void RealToRealNode::AssignParams_internal()
+{
+    assert(childNodes.size() == 1);
+    auto& fftPlan = childNodes[0];
+
+    fftPlan->inStride  = inStride;
+    fftPlan->iDist     = iDist;
+    fftPlan->outStride = outStride;
+    fftPlan->oDist     = oDist;
+}
+
 /*****************************************************
  * CS_REAL_TRANSFORM_EVEN
  *****************************************************/
@@ -485,6 +852,30 @@ void Real2DEvenNode::BuildTree_internal(SchemeTreeVec& child_scheme_trees)
             solution = REAL_2D_SINGLE;
     }
 
+    // a decomposition recorded in the solution map, or asked for by
+    // plan-level tuning, overrides the choice above
+    switch(child_scheme_trees.size())
+    {
+    case 0:
+    {
+        int variant = TuningBenchmarker::GetSingleton().GetTreeShapeVariant(*this);
+        if(variant >= 0)
+            solution = static_cast<Solution>(variant);
+        break;
+    }
+    case 1:
+        solution = REAL_2D_SINGLE;
+        break;
+    case 2:
+        solution = INPLACE_SBCC;
+        break;
+    case 4:
+        solution = TR_PAIR;
+        break;
+    default:
+        throw std::runtime_error("Real2DEvenNode: Unexpected child scheme from solution map");
+    }
+
     switch(solution)
     {
     case REAL_2D_SINGLE:
@@ -555,9 +946,7 @@ void Real2DEvenNode::BuildTree_internal_SBCC(SchemeTreeVec& child_scheme_trees)
 
         // first row fft + postproc is mandatory for fastest dimension
         auto rcplan = NodeFactory::CreateNodeFromScheme(CS_REAL_TRANSFORM_EVEN, this);
-        // for length > 2048, don't try pre/post because LDS usage is too high
-        static_cast<RealTransEvenNode*>(rcplan.get())->try_fuse_pre_post_processing
-            = length[0] <= 2048;
+        try_fuse_row_pre_post_processing(*rcplan, length[0]);
 
         rcplan->length    = length;
         rcplan->dimension = 1;
@@ -593,9 +982,7 @@ void Real2DEvenNode::BuildTree_internal_SBCC(SchemeTreeVec& child_scheme_trees)
 
         // c2r
         auto crplan = NodeFactory::CreateNodeFromScheme(CS_REAL_TRANSFORM_EVEN, this);
-        // for length > 2048, don't try pre/post because LDS usage is too high
-        static_cast<RealTransEvenNode*>(crplan.get())->try_fuse_pre_post_processing
-            = length[0] <= 2048;
+        try_fuse_row_pre_post_processing(*crplan, length[0]);
 
         crplan->length    = outputLength;
         crplan->dimension = 1;
@@ -629,6 +1016,7 @@ void Real2DEvenNode::BuildTree_internal_TR_pair(SchemeTreeVec& child_scheme_tree
         auto row1Plan       = NodeFactory::CreateNodeFromScheme(CS_REAL_TRANSFORM_EVEN, this);
         row1Plan->length    = length;
         row1Plan->dimension = 1;
+        try_fuse_row_pre_post_processing(*row1Plan, length[0]);
         row1Plan->RecursiveBuildTree((noSolution) ? nullptr : child_scheme_trees[0].get());
 
         // first transpose
@@ -726,6 +1114,7 @@ void Real2DEvenNode::BuildTree_internal_TR_pair(SchemeTreeVec& child_scheme_tree
             throw std::runtime_error("Real2DEvenNode: Unexpected child scheme from solution map");
         auto c2rPlan    = NodeFactory::CreateNodeFromScheme(CS_REAL_TRANSFORM_EVEN, this);
         c2rPlan->length = outputLength;
+        try_fuse_row_pre_post_processing(*c2rPlan, outputLength[0]);
         c2rPlan->RecursiveBuildTree((noSolution) ? nullptr : child_scheme_trees[3].get());
 
         // --------------------------------
@@ -959,6 +1348,32 @@ void Real3DEvenNode::BuildTree_internal(SchemeTreeVec& child_scheme_trees)
 {
     Build_solution();
 
+    // a decomposition recorded in the solution map, or asked for by
+    // plan-level tuning, overrides the choice above
+    switch(child_scheme_trees.size())
+    {
+    case 0:
+    {
+        int variant = TuningBenchmarker::GetSingleton().GetTreeShapeVariant(*this);
+        if(variant >= 0)
+            solution = static_cast<Solution>(variant);
+        break;
+    }
+    case 2:
+        solution = REAL_2D_SINGLE_SBCC;
+        break;
+    case 3:
+        solution = (child_scheme_trees[2]->curScheme == CS_KERNEL_STOCKHAM_BLOCK_CR)
+                       ? SBCR
+                       : INPLACE_SBCC;
+        break;
+    case 6:
+        solution = TR_PAIRS;
+        break;
+    default:
+        throw std::runtime_error("Real3DEvenNode: Unexpected child scheme from solution map");
+    }
+
     switch(solution)
     {
     case REAL_2D_SINGLE_SBCC:
@@ -1029,11 +1444,14 @@ void Real3DEvenNode::Build_solution()
         //       implementation for unit/non-unit strides cases both on host and
         //       device side.
         //    2. Enable for gfx908 and gfx90a only. Need more tuning for Navi arch.
+        //
+        // The fastest dimension needs an SBCR kernel to embed the
+        // C2R pre-processing; the others can fall back to row kernels.
         std::vector<size_t> c2r_length = {outputLength[0] / 2, outputLength[1], outputLength[2]};
         if((is_device_gcn_arch(deviceProp, "gfx908") || is_device_gcn_arch(deviceProp, "gfx90a"))
            && (SBCR_dim_available(c2r_length, 0, precision))
-           && (SBCR_dim_available(c2r_length, 1, precision))
-           && (SBCR_dim_available(c2r_length, 2, precision))
+           && (SBCR_dim_scheme(c2r_length, 1, precision) != CS_NONE)
+           && (SBCR_dim_scheme(c2r_length, 2, precision) != CS_NONE)
            && (placement
                == rocfft_placement_notinplace) // In-place SBCC is faster than SBCR solution for in-place
            && (inStride[0] == 1 && outStride[0] == 1
@@ -1191,9 +1609,7 @@ void Real3DEvenNode::BuildTree_internal_SBCC(SchemeTreeVec& child_scheme_trees)
 
         // first row fft + postproc is mandatory for fastest dimension
         auto rcplan = NodeFactory::CreateNodeFromScheme(CS_REAL_TRANSFORM_EVEN, this);
-        // for length > 2048, don't try pre/post because LDS usage is too high
-        static_cast<RealTransEvenNode*>(rcplan.get())->try_fuse_pre_post_processing
-            = length[0] <= 2048;
+        try_fuse_row_pre_post_processing(*rcplan, length[0]);
 
         rcplan->length    = length;
         rcplan->dimension = 1;
@@ -1222,9 +1638,7 @@ void Real3DEvenNode::BuildTree_internal_SBCC(SchemeTreeVec& child_scheme_trees)
 
         // c2r
         auto crplan = NodeFactory::CreateNodeFromScheme(CS_REAL_TRANSFORM_EVEN, this);
-        // for length > 2048, don't try pre/post because LDS usage is too high
-        static_cast<RealTransEvenNode*>(crplan.get())->try_fuse_pre_post_processing
-            = length[0] <= 2048;
+        try_fuse_row_pre_post_processing(*crplan, length[0]);
 
         crplan->length    = outputLength;
         crplan->dimension = 1;
@@ -1246,26 +1660,39 @@ void Real3DEvenNode::BuildTree_internal_SBCC(SchemeTreeVec& child_scheme_trees)
 void Real3DEvenNode::BuildTree_internal_SBCR(SchemeTreeVec& child_scheme_trees)
 {
     bool noSolution = child_scheme_trees.empty();
+
+    std::vector<size_t> c2r_length = {outputLength[0] / 2, outputLength[1], outputLength[2]};
+    ComputeScheme       scheme_dimZ = SBCR_dim_scheme(c2r_length, 2, precision);
+    ComputeScheme       scheme_dimY = SBCR_dim_scheme(c2r_length, 1, precision);
+
     // check schemes from solution map
     if(!noSolution)
     {
-        if((child_scheme_trees.size() != 3)
-           || (child_scheme_trees[0]->curScheme != CS_KERNEL_STOCKHAM_BLOCK_CR)
-           || (child_scheme_trees[1]->curScheme != CS_KERNEL_STOCKHAM_BLOCK_CR)
+        auto higher_dim_ok = [](ComputeScheme s) {
+            return s == CS_KERNEL_STOCKHAM_BLOCK_CR || s == CS_KERNEL_STOCKHAM;
+        };
+        if((child_scheme_trees.size() != 3) || !higher_dim_ok(child_scheme_trees[0]->curScheme)
+           || !higher_dim_ok(child_scheme_trees[1]->curScheme)
            || (child_scheme_trees[2]->curScheme != CS_KERNEL_STOCKHAM_BLOCK_CR))
         {
             throw std::runtime_error("Real3DEvenNode: Unexpected child scheme from solution map");
         }
+        scheme_dimZ = child_scheme_trees[0]->curScheme;
+        scheme_dimY = child_scheme_trees[1]->curScheme;
     }
 
-    auto sbcrZ       = NodeFactory::CreateNodeFromScheme(CS_KERNEL_STOCKHAM_BLOCK_CR, this);
-    sbcrZ->length    = {outputLength[2], (outputLength[0] / 2 + 1) * outputLength[1]};
-    sbcrZ->dimension = 1;
+    // row kernels used in place of SBCR write rotated output, so
+    // they can't work in-place either
+    auto sbcrZ          = NodeFactory::CreateNodeFromScheme(scheme_dimZ, this);
+    sbcrZ->length       = {outputLength[2], (outputLength[0] / 2 + 1) * outputLength[1]};
+    sbcrZ->dimension    = 1;
+    sbcrZ->allowInplace = false;
     childNodes.emplace_back(std::move(sbcrZ));
 
-    auto sbcrY       = NodeFactory::CreateNodeFromScheme(CS_KERNEL_STOCKHAM_BLOCK_CR, this);
-    sbcrY->length    = {outputLength[1], outputLength[2] * (outputLength[0] / 2 + 1)};
-    sbcrY->dimension = 1;
+    auto sbcrY          = NodeFactory::CreateNodeFromScheme(scheme_dimY, this);
+    sbcrY->length       = {outputLength[1], outputLength[2] * (outputLength[0] / 2 + 1)};
+    sbcrY->dimension    = 1;
+    sbcrY->allowInplace = false;
     childNodes.emplace_back(std::move(sbcrY));
 
     auto sbcrX       = NodeFactory::CreateNodeFromScheme(CS_KERNEL_STOCKHAM_BLOCK_CR, this);
@@ -1300,6 +1727,7 @@ void Real3DEvenNode::BuildTree_internal_TR_pairs(SchemeTreeVec& child_scheme_tre
 
         // first row fft + postproc is mandatory for fastest dimension
         auto rcplan = NodeFactory::CreateNodeFromScheme(CS_REAL_TRANSFORM_EVEN, this);
+        try_fuse_row_pre_post_processing(*rcplan, length[0]);
 
         rcplan->length    = length;
         rcplan->dimension = 1;
@@ -1479,6 +1907,7 @@ void Real3DEvenNode::BuildTree_internal_TR_pairs(SchemeTreeVec& child_scheme_tre
 
         // c2r
         auto crplan = NodeFactory::CreateNodeFromScheme(CS_REAL_TRANSFORM_EVEN, this);
+        try_fuse_row_pre_post_processing(*crplan, outputLength[0]);
 
         crplan->length    = outputLength;
         crplan->dimension = 1;
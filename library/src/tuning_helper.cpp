@@ -25,6 +25,7 @@
 #include "solution_map.h"
 #include "twiddles.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iterator>
 #include <random>
@@ -160,6 +161,54 @@ int TuningBenchmarker::GetNumOfKernelCandidates(size_t node_id)
     return 0;
 }
 
+size_t TuningBenchmarker::GetNumOfTreeShapes()
+{
+    // EnumerateTrees always builds at least the library's own tree
+    if(!packet || packet->tree_shapes.empty())
+        return 1;
+
+    return packet->tree_shapes.size();
+}
+
+bool TuningBenchmarker::SetTreeShape(size_t shape_id)
+{
+    if(!packet || shape_id >= packet->tree_shapes.size())
+        return false;
+
+    packet->tree_shape_id = shape_id;
+
+    // candidates and winners of the previous shape belong to another
+    // tree, so start over with an empty map
+    binding_solution_map->clear();
+    packet->target_factors.clear();
+    packet->winner_phases.clear();
+    packet->winner_ids.clear();
+    packet->winner_kernel_names.clear();
+    benchmark_infos_of_node.clear();
+
+    return true;
+}
+
+bool TuningBenchmarker::IsDuplicateTreeShape()
+{
+    if(!packet || packet->tree_shape_id >= packet->tree_signatures.size())
+        return false;
+
+    auto  curr       = packet->tree_signatures.begin() + packet->tree_shape_id;
+    auto& signatures = packet->tree_signatures;
+    return !curr->empty() && std::find(signatures.begin(), curr, *curr) != curr;
+}
+
+int TuningBenchmarker::GetTreeShapeVariant(const TreeNode& node)
+{
+    // only the root is tuned, and only while enumerating - afterwards
+    // the tree is rebuilt from the serialized solution
+    if(!IsInitializingTuning() || !node.isRootNode() || packet->tree_shapes.empty())
+        return -1;
+
+    return packet->tree_shapes[packet->tree_shape_id].variant;
+}
+
 bool TuningBenchmarker::SetCurrentTuningNodeId(size_t node_id)
 {
     if(node_id >= (size_t)packet->total_nodes)
@@ -210,7 +259,7 @@ BenchmarkInfo TuningBenchmarker::GetCurrBenchmarkInfo()
     return info;
 }
 
-void TuningBenchmarker::UpdateCurrBenchResult(double ms, double gflops)
+void TuningBenchmarker::UpdateCurrBenchResult(double ms, double gflops, double joules)
 {
     int    curr_tuning_node_id   = packet->tuning_node_id;
     int    curr_kernel_config_id = packet->current_ssn;
@@ -221,10 +270,16 @@ void TuningBenchmarker::UpdateCurrBenchResult(double ms, double gflops)
     auto& info            = bench_infos_vec[curr_kernel_config_id];
     info.bw_eff           = curr_node_bw_eff;
     info.milli_seconds    = ms;
+    info.joules           = joules;
     info.gflops           = gflops;
 }
 
-void TuningBenchmarker::FindWinnerForCurrNode(double&      curr_best_msec,
+double TuningBenchmarker::Cost(const BenchmarkInfo& info) const
+{
+    return packet->energy_objective ? info.joules : info.milli_seconds;
+}
+
+void TuningBenchmarker::FindWinnerForCurrNode(double&      curr_best_cost,
                                               int&         winner_phase,
                                               int&         winner_config_id,
                                               std::string& winner_kernel_name)
@@ -251,21 +306,20 @@ void TuningBenchmarker::FindWinnerForCurrNode(double&      curr_best_msec,
     // if not empty, then sort and update IDs
     if(!bench_infos_vec.empty())
     {
-        std::sort(
-            bench_infos_vec.begin(), bench_infos_vec.end(), [](BenchmarkInfo& a, BenchmarkInfo& b) {
-                return a.milli_seconds < b.milli_seconds;
-            });
+        std::sort(bench_infos_vec.begin(),
+                  bench_infos_vec.end(),
+                  [this](BenchmarkInfo& a, BenchmarkInfo& b) { return Cost(a) < Cost(b); });
 
         // check if the best of this phase is better than previous winner
         auto& winner_of_this_phase = bench_infos_vec.front();
-        if(winner_of_this_phase.milli_seconds < curr_best_msec)
+        if(Cost(winner_of_this_phase) < curr_best_cost)
         {
             winner_phase       = winner_of_this_phase.tuning_phase;
             winner_config_id   = winner_of_this_phase.SSN;
             winner_kernel_name = winner_of_this_phase.kernel_name;
 
-            // update the best ms up to now
-            curr_best_msec = winner_of_this_phase.milli_seconds;
+            // update the best cost up to now
+            curr_best_cost = Cost(winner_of_this_phase);
         }
     }
 
@@ -446,17 +500,17 @@ bool TuningBenchmarker::ExportCSV(bool append_data)
     if(append_data)
         outfile << std::endl << std::endl;
 
-    outfile << "SSN, Problem, MS, GFLOPS, NumBlocks, WGS, TPT_0, TPT_1, TPB, LDS_Bytes, GRW_PT, "
-               "Util_Rate, Factors, Occupancy, NumCUs, Granularity, BW_EFF, KernelName"
+    outfile << "SSN, Problem, MS, Joules, GFLOPS, NumBlocks, WGS, TPT_0, TPT_1, TPB, LDS_Bytes, "
+               "GRW_PT, Util_Rate, Factors, Occupancy, NumCUs, Granularity, BW_EFF, KernelName"
             << std::endl;
 
     for(auto& info : bench_infos_vec)
     {
         outfile << info.SSN << "," << info.prob_token << "," << info.milli_seconds << ","
-                << info.gflops << "," << info.num_blocks << "," << info.workgroup_size << ","
-                << info.threads_per_trans[0] << "," << info.threads_per_trans[1] << ","
-                << info.trans_per_block << "," << info.LDS_bytes << "," << info.globalRW_per_thread
-                << ","
+                << info.joules << "," << info.gflops << "," << info.num_blocks << ","
+                << info.workgroup_size << "," << info.threads_per_trans[0] << ","
+                << info.threads_per_trans[1] << "," << info.trans_per_block << ","
+                << info.LDS_bytes << "," << info.globalRW_per_thread << ","
                 << "\"" << info.util_rate << "\""
                 << ","
                 << "\"" << info.factors_str << "\""
@@ -21,6 +21,7 @@
 #include "tuning_kernel_tuner.h"
 #include "../../shared/arithmetic.h"
 #include "../../shared/environment.h"
+#include "device/generator/stockham_gen.h"
 #include "function_pool.h"
 #include "logging.h"
 #include "rocfft/rocfft.h"
@@ -29,6 +30,7 @@
 #include "twiddles.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iterator>
 #include <random>
 #include <regex>
@@ -36,7 +38,8 @@
 
 static const char* candidates_folder = "TuningCandidates";
 
-static const std::vector<size_t> supported_factors = {2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 16, 17};
+static const std::vector<size_t> supported_factors
+    = {2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 16, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61};
 
 // TODO- support half precision
 static const size_t LDS_BYTE_LIMIT    = 32 * 1024;
@@ -463,7 +466,8 @@ std::set<KernelConfig> SupportedKernelConfigs(size_t length,
                                               bool   is_sbcc,
                                               bool   is_sbrc,
                                               bool   is_sbcr,
-                                              size_t large1D)
+                                              size_t large1D,
+                                              size_t wave_size)
 {
     std::set<KernelConfig> configs;
 
@@ -472,6 +476,7 @@ std::set<KernelConfig> SupportedKernelConfigs(size_t length,
     bool   has_ltwd_mul     = is_sbcc && (large1D > 0);
     // so far our kernel-gen implements intrinsic mode only on these two type
     bool   can_do_intrinsic = is_sbcc || is_sbcr;
+    bool   is_sbrr          = !is_sbcc && !is_sbrc && !is_sbcr;
     size_t conservative_tpb = ConservativeMaxTPB(length, is_single);
 
     // [reduce search space]:
@@ -487,10 +492,20 @@ std::set<KernelConfig> SupportedKernelConfigs(size_t length,
     size_t      min_wgs      = min_wgs_str.empty() ? 64 : std::atoi(min_wgs_str.c_str());
     size_t      max_wgs      = max_wgs_str.empty() ? 512 : std::atoi(max_wgs_str.c_str());
 
+    // workgroup sizes are tried in steps of the device's wavefront
+    // size, so that no candidate leaves lanes of its last wave idle
+    if(wave_size == 0)
+        wave_size = 64;
+
+    // matrix butterflies are double precision, and need the 64-lane
+    // wavefronts of devices with FP64 matrix cores
+    bool try_matrix_bfly = !is_single && wave_size == 64;
+
     // if min_wgs is greater than length, then we lower it.
     min_wgs = (length < min_wgs) ? length : min_wgs;
-    min_wgs = (min_wgs % 64 == 0) ? min_wgs : std::max((size_t)0, min_wgs - (min_wgs % 64));
-    max_wgs = (max_wgs % 64 == 0) ? max_wgs : max_wgs - (max_wgs % 64);
+    min_wgs = (min_wgs % wave_size == 0) ? min_wgs
+                                         : std::max((size_t)0, min_wgs - (min_wgs % wave_size));
+    max_wgs = (max_wgs % wave_size == 0) ? max_wgs : max_wgs - (max_wgs % wave_size);
 
     auto& target_factors_strs = TuningBenchmarker::GetSingleton().GetPacket()->target_factors;
     bool  is_phase0           = (target_factors_strs.empty());
@@ -543,10 +558,17 @@ std::set<KernelConfig> SupportedKernelConfigs(size_t length,
             ++tpt;
         }
 
+        // tiny sbrr kernels can also do a whole transform per thread
+        // entirely in registers.  Utilization rate doesn't apply to
+        // those since there's no LDS exchange between passes.
+        if(!is_sbcc && !is_sbrc && !is_sbcr && factorization.size() > 1
+           && StockhamGeneratorSpecs::is_registers_only(length, 1, true))
+            tpts.insert(1);
+
         // go through all permutations of the factors
         do
         {
-            for(size_t wgs = min_wgs; wgs <= max_wgs; wgs += 64)
+            for(size_t wgs = min_wgs; wgs <= max_wgs; wgs += wave_size)
             {
                 for(const auto tpt : tpts)
                 {
@@ -554,13 +576,6 @@ std::set<KernelConfig> SupportedKernelConfigs(size_t length,
                     {
                         for(bool half_lds : {true, false})
                         {
-                            if(half_lds && (is_sbcr || is_sbrc))
-                            {
-                                PrintRejectionMsg("reject: only sbrr and sbcc support half-lds\n",
-                                                  print_reject);
-                                continue;
-                            }
-
                             for(bool use_ltwd_3steps : {true, false})
                             {
                                 // skip ltwd_3steps if not needed
@@ -588,7 +603,7 @@ std::set<KernelConfig> SupportedKernelConfigs(size_t length,
                                     size_t final_wgs = tpt * tpb;
                                     if(final_wgs > max_wgs)
                                         continue;
-                                    if(final_wgs <= (wgs - 64))
+                                    if(final_wgs + wave_size <= wgs)
                                         continue;
 
                                     // [reduce search space]
@@ -661,6 +676,70 @@ std::set<KernelConfig> SupportedKernelConfigs(size_t length,
                                             config.factors               = factorization;
 
                                             configs.insert(config);
+
+                                            // radix-16 butterflies on matrix cores
+                                            // can beat the vector units for double
+                                            if(try_matrix_bfly
+                                               && StockhamGeneratorSpecs::
+                                                   can_use_matrix_butterflies(
+                                                       rocfft_precision_double,
+                                                       final_wgs,
+                                                       factorization))
+                                            {
+                                                auto matrix_config = config;
+                                                matrix_config.matrix_butterflies = true;
+                                                configs.insert(matrix_config);
+                                            }
+
+                                            // sbrr blocks can overlap the next
+                                            // tile's loads with this tile's work
+                                            if(is_sbrr && tpb > 1 && direct_to_from_reg)
+                                            {
+                                                auto pipelined_config = config;
+                                                pipelined_config.pipelined_loads = true;
+                                                configs.insert(pipelined_config);
+                                            }
+
+                                            // sbrr kernels can trade a smaller twiddle
+                                            // table for some index math
+                                            if(is_sbrr
+                                               && StockhamGeneratorSpecs::
+                                                   can_use_octant_twiddles(length))
+                                            {
+                                                auto octant_config = config;
+                                                octant_config.octant_twiddles = true;
+                                                configs.insert(octant_config);
+                                            }
+
+                                            // the LDS padding that avoids bank
+                                            // conflicts depends on the arch's LDS
+                                            // banks, so sbrr kernels that use LDS
+                                            // try several bank shifts
+                                            if(is_sbrr
+                                               && !StockhamGeneratorSpecs::is_registers_only(
+                                                   length, tpt, direct_to_from_reg))
+                                            {
+                                                unsigned int default_shift
+                                                    = StockhamGeneratorSpecs::
+                                                        resolve_lds_bank_shift(-1, length);
+                                                for(int shift : {0, 16, 32, 64})
+                                                {
+                                                    if(static_cast<unsigned int>(shift)
+                                                       == default_shift)
+                                                        continue;
+                                                    auto shift_config = config;
+                                                    shift_config.lds_bank_shift = shift;
+                                                    configs.insert(shift_config);
+                                                }
+                                            }
+
+                                            // computed large twiddles need no table,
+                                            // in LDS or otherwise
+                                            if(has_ltwd_mul && !use_ltwd_3steps)
+                                            {
+                                                config.compute_large_twd = true;
+                                                configs.insert(config);
+                                            }
                                         }
                                     }
                                 }
@@ -757,10 +836,206 @@ std::set<KernelConfig> SupportedKernelConfigs(size_t length,
     return configs;
 }
 
+// [reduce search space]
+// analytic estimate of how well a configuration will run, used to
+// rank candidates before any of them are compiled.  Higher is
+// better.  The estimate considers:
+//  - butterfly utilization: each pass does ceil(height) butterflies
+//    per thread, so fractional heights leave threads idle
+//  - occupancy: resident threads per CU, limited by LDS usage and
+//    workgroup size
+//  - register pressure: elements each thread holds in registers
+double EstimateKernelConfigScore(const KernelConfig&    config,
+                                 size_t                 length0,
+                                 size_t                 length1,
+                                 bool                   is_single,
+                                 const hipDeviceProp_t& deviceProp)
+{
+    size_t bytes_per_elem = (is_single) ? BYTES_PER_FLOAT2 : BYTES_PER_DOUBLE2;
+
+    // 2D kernels store the factors of both dimensions one after the
+    // other, so switch dimensions once the first length is covered
+    double useful_slots     = 0.0;
+    double total_slots      = 0.0;
+    size_t elems_per_thread = 0;
+    size_t dim              = 0;
+    size_t dim_product      = 1;
+    for(auto width : config.factors)
+    {
+        size_t len = (dim == 0) ? length0 : length1;
+        size_t tpt = config.threads_per_transform[dim];
+        if(tpt == 0)
+            return 0.0;
+
+        double height = static_cast<double>(len) / width / tpt;
+        useful_slots += height;
+        total_slots += std::ceil(height);
+        elems_per_thread = std::max(elems_per_thread, len / tpt);
+
+        dim_product *= width;
+        if(dim == 0 && length1 > 0 && dim_product == length0)
+            dim = 1;
+    }
+    if(total_slots == 0.0)
+        return 0.0;
+    double util_score = useful_slots / total_slots;
+
+    size_t lds_bytes = (length1 > 0) ? length0 * length1 * bytes_per_elem
+                                     : length0 * config.transforms_per_block * bytes_per_elem;
+    if(config.half_lds)
+        lds_bytes /= 2;
+
+    size_t lds_per_cu = deviceProp.maxSharedMemoryPerMultiProcessor
+                            ? deviceProp.maxSharedMemoryPerMultiProcessor
+                            : 2 * LDS_BYTE_LIMIT;
+    size_t threads_per_cu
+        = deviceProp.maxThreadsPerMultiProcessor ? deviceProp.maxThreadsPerMultiProcessor : 2048;
+    size_t wgs = std::max(config.workgroup_size, 1);
+
+    size_t blocks_per_cu = threads_per_cu / wgs;
+    if(lds_bytes > 0)
+        blocks_per_cu = std::min(blocks_per_cu, lds_per_cu / lds_bytes);
+    blocks_per_cu    = std::max<size_t>(blocks_per_cu, 1);
+    double occupancy = std::min(1.0, static_cast<double>(blocks_per_cu * wgs) / threads_per_cu);
+    // FFTs are memory bound, so once half the threads are resident
+    // more occupancy no longer helps
+    double occupancy_score = std::min(1.0, 2.0 * occupancy);
+
+    // beyond this many elements per thread, registers start spilling
+    size_t max_elems_in_regs = (is_single) ? 32 : 16;
+    double reg_score         = (elems_per_thread > max_elems_in_regs)
+                                   ? static_cast<double>(max_elems_in_regs) / elems_per_thread
+                                   : 1.0;
+
+    return util_score * occupancy_score * reg_score;
+}
+
+// keep the max_candidates configurations with the best estimated
+// score, in order of decreasing score
+std::vector<KernelConfig> PruneKernelConfigs(const std::set<KernelConfig>& configs,
+                                             size_t                        max_candidates,
+                                             size_t                        length0,
+                                             size_t                        length1,
+                                             bool                          is_single,
+                                             const hipDeviceProp_t&        deviceProp)
+{
+    std::vector<std::pair<double, KernelConfig>> scored;
+    scored.reserve(configs.size());
+    for(const auto& config : configs)
+        scored.emplace_back(
+            EstimateKernelConfigScore(config, length0, length1, is_single, deviceProp), config);
+
+    // stable, so equally-scored configs keep their enumeration order
+    std::stable_sort(scored.begin(),
+                     scored.end(),
+                     [](const std::pair<double, KernelConfig>& a,
+                        const std::pair<double, KernelConfig>& b) { return a.first > b.first; });
+
+    bool print_reject = !rocfft_getenv("PRINT_REJECT_REASON").empty();
+
+    std::vector<KernelConfig> ret;
+    for(size_t i = 0; i < scored.size(); ++i)
+    {
+        if(i < max_candidates)
+            ret.push_back(scored[i].second);
+        else
+            PrintRejectionMsg("reject: estimated score " + std::to_string(scored[i].first)
+                                  + " is not in the top " + std::to_string(max_candidates) + "\n"
+                                  + scored[i].second.Print() + "\n\n",
+                              print_reject);
+    }
+    return ret;
+}
+
+// Transposes move tileX * tileX tiles through LDS with a block of
+// tileX * tileY threads, so each thread moves tileX / tileY elements.
+// Candidates are encoded as described in TransposeNode::GetTuningKernelKey.
+std::set<KernelConfig> SupportedTransposeConfigs(bool is_single)
+{
+    std::set<KernelConfig> configs;
+
+    // tiling isn't refined in later phases
+    if(TuningBenchmarker::GetSingleton().GetPacket()->tuning_phase != 0)
+        return configs;
+
+    bool   print_reject = !rocfft_getenv("PRINT_REJECT_REASON").empty();
+    size_t elem_bytes   = is_single ? BYTES_PER_FLOAT2 : BYTES_PER_DOUBLE2;
+
+    for(unsigned int tileX : {16, 32, 64})
+    {
+        for(unsigned int elems_per_thread : {1, 2, 4, 8})
+        {
+            unsigned int tileY = tileX / elems_per_thread;
+            unsigned int wgs   = tileX * tileY;
+            size_t       lds   = tileX * tileX * elem_bytes;
+
+            std::string tile_str = std::to_string(tileX) + "x" + std::to_string(tileY);
+            if(wgs < 64 || wgs > 1024)
+            {
+                PrintRejectionMsg("reject: transpose tile " + tile_str + ", wgs "
+                                      + std::to_string(wgs) + " is out of range\n",
+                                  print_reject);
+                continue;
+            }
+            if(lds > LDS_BYTE_LIMIT)
+            {
+                PrintRejectionMsg("reject: transpose tile " + tile_str + ", lds bytes "
+                                      + std::to_string(lds) + " exceeds limit\n",
+                                  print_reject);
+                continue;
+            }
+
+            for(bool diagonal : {false, true})
+            {
+                KernelConfig config;
+                config.threads_per_transform = {static_cast<int>(tileX), static_cast<int>(tileY)};
+                config.workgroup_size        = wgs;
+                config.transforms_per_block  = diagonal ? 1 : 0;
+                configs.insert(config);
+            }
+        }
+    }
+
+    return configs;
+}
+
+// The library's own configuration of a block kernel, with each
+// combination of direct-to-register and buffer instruction modes that
+// it can be built with.  These are the choices that
+// TuneDirectRegType and TuneIntrinsicMode otherwise make from static
+// rules.
+std::set<KernelConfig> AccessModeKernelConfigs(const KernelConfig& base_config,
+                                               bool                is_sbcc_or_sbcr)
+{
+    std::set<KernelConfig> configs;
+    for(bool direct_to_from_reg : {true, false})
+    {
+        // half lds requires direct to/from reg, and giving up half
+        // lds would change how many transforms fit in a block
+        if(base_config.half_lds && !direct_to_from_reg)
+            continue;
+
+        for(bool intrinsic : {true, false})
+        {
+            // intrinsic requires direct to/from reg, and is only
+            // implemented for sbcc/sbcr
+            if(intrinsic && (!direct_to_from_reg || !is_sbcc_or_sbcr))
+                continue;
+
+            KernelConfig config          = base_config;
+            config.direct_to_from_reg    = direct_to_from_reg;
+            config.intrinsic_buffer_inst = intrinsic;
+            configs.insert(config);
+        }
+    }
+    return configs;
+}
+
 void EnumerateKernelConfigs(const ExecPlan& execPlan)
 {
     auto        tuningPacket = TuningBenchmarker::GetSingleton().GetPacket();
-    std::string archName     = get_arch_name(execPlan.deviceProp);
+    std::string archName
+        = solution_map::get_tuning_arch(get_arch_name(execPlan.deviceProp), execPlan.deviceProp);
 
     tuningPacket->tuning_arch_name = archName;
     tuningPacket->numCUs           = execPlan.deviceProp.multiProcessorCount;
@@ -783,11 +1058,14 @@ void EnumerateKernelConfigs(const ExecPlan& execPlan)
         bool   is_sbcc   = curNode->scheme == CS_KERNEL_STOCKHAM_BLOCK_CC;
         bool   is_sbrc   = curNode->scheme == CS_KERNEL_STOCKHAM_BLOCK_RC;
         bool   is_sbcr   = curNode->scheme == CS_KERNEL_STOCKHAM_BLOCK_CR;
+        bool   is_trans  = curNode->scheme == CS_KERNEL_TRANSPOSE
+                        || curNode->scheme == CS_KERNEL_TRANSPOSE_XY_Z
+                        || curNode->scheme == CS_KERNEL_TRANSPOSE_Z_XY;
         size_t large1D   = curNode->large1D;
-        auto   base_key  = curNode->GetKernelKey();
+        auto   base_key  = curNode->GetTuningKernelKey();
 
-        // if this kernel is an internal built-in one, we are not tunining it yet, (transpose..etc)
-        // but we will plan to tune it in the future.
+        // if this kernel is an internal built-in one without tunable parameters, (r2c, c2r..etc)
+        // we are not tuning it yet, but we will plan to tune it in the future.
         if(base_key == FMKey::EmptyFMKey())
         {
             check_dup = true;
@@ -812,11 +1090,47 @@ void EnumerateKernelConfigs(const ExecPlan& execPlan)
         ProblemKey probKey_kernel(archName, kernel_token);
 
         // enumerate !
-        auto kernel_configs = (is_2D)
-                                  ? Supported2DKernelConfigs(len, curNode->length[1], node_id)
-                                  : SupportedKernelConfigs(
-                                      len, node_id, is_single, is_sbcc, is_sbrc, is_sbcr, large1D);
-        for(KernelConfig config : kernel_configs)
+        std::set<KernelConfig> kernel_configs;
+        if(tuningPacket->access_modes_only && function_pool::has_function(base_key))
+        {
+            // keep the library's own kernel, only block kernels have
+            // access modes to choose between
+            auto base_config = function_pool::get_kernel(base_key).get_kernel_config();
+            bool is_sbrc_3D  = curNode->scheme == CS_KERNEL_STOCKHAM_TRANSPOSE_XY_Z
+                              || curNode->scheme == CS_KERNEL_STOCKHAM_TRANSPOSE_Z_XY
+                              || curNode->scheme == CS_KERNEL_STOCKHAM_R_TO_CMPLX_TRANSPOSE_Z_XY;
+            if(is_sbcc || is_sbrc || is_sbcr || is_sbrc_3D)
+                kernel_configs = AccessModeKernelConfigs(base_config, is_sbcc || is_sbcr);
+            else
+                kernel_configs.insert(base_config);
+        }
+        else
+            kernel_configs = (is_trans) ? SupportedTransposeConfigs(is_single)
+                             : (is_2D)
+                                 ? Supported2DKernelConfigs(len, curNode->length[1], node_id)
+                                 : SupportedKernelConfigs(len,
+                                                          node_id,
+                                                          is_single,
+                                                          is_sbcc,
+                                                          is_sbrc,
+                                                          is_sbcr,
+                                                          large1D,
+                                                          execPlan.deviceProp.warpSize);
+
+        // if the number of candidates is limited, only benchmark the
+        // configurations that the cost model ranks highest.  the model
+        // is for Stockham kernels, and transposes have few candidates
+        std::vector<KernelConfig> candidates(kernel_configs.begin(), kernel_configs.end());
+        size_t                    max_candidates = tuningPacket->max_candidates;
+        if(max_candidates && candidates.size() > max_candidates && !is_trans)
+            candidates = PruneKernelConfigs(kernel_configs,
+                                            max_candidates,
+                                            len,
+                                            is_2D ? curNode->length[1] : 0,
+                                            is_single,
+                                            execPlan.deviceProp);
+
+        for(KernelConfig config : candidates)
         {
             // We can set the ebType and direction here. But we still don't know static_dim, aryType,
             // placement until buffer-assignment and collapse-dim. We'll get them later. (PowX.cpp)
@@ -19,6 +19,7 @@
 // THE SOFTWARE.
 
 #include "tuning_plan_tuner.h"
+#include "node_factory.h"
 #include "solution_map.h"
 #include "tuning_helper.h"
 #include "tuning_kernel_tuner.h"
@@ -31,7 +32,8 @@
 // Some problems are not supported yet.
 // NB:
 //   if root-problem is one of the followings, then we don't tune the problem.
-static const std::set<ComputeScheme> not_supported_tuning_prob_schemes = {CS_BLUESTEIN};
+static const std::set<ComputeScheme> not_supported_tuning_prob_schemes
+    = {CS_BLUESTEIN, CS_RADER};
 
 // return size_t: the "option_id" of the return node in its sol-vector
 size_t SerializeTree(TreeNode*                         node,
@@ -54,7 +56,7 @@ size_t SerializeTree(TreeNode*                         node,
     // should have an only childnode that is SOL_KERNEL_ONLY
     if(node->nodeType == NT_LEAF)
     {
-        auto kernel_key = node->GetKernelKey();
+        auto kernel_key = node->GetTuningKernelKey();
 
         if(kernel_key == FMKey::EmptyFMKey())
             min_token = solution_map::KERNEL_TOKEN_BUILTIN_KERNEL;
@@ -99,16 +101,47 @@ size_t SerializeTree(TreeNode*                         node,
     return my_option_id;
 }
 
+// describe the shape of a tree by the schemes of its nodes
+static std::string TreeSignature(const TreeNode& node)
+{
+    std::string signature = PrintScheme(node.scheme);
+    if(!node.childNodes.empty())
+    {
+        std::string COMMA = "";
+        signature += "(";
+        for(const auto& c : node.childNodes)
+        {
+            signature += COMMA + TreeSignature(*c);
+            COMMA = ", ";
+        }
+        signature += ")";
+    }
+    return signature;
+}
+
+ComputeScheme SelectTreeShape(TreeNode& root)
+{
+    auto packet = TuningBenchmarker::GetSingleton().GetPacket();
+
+    // shapes are enumerated once, from the library's own root node
+    if(packet->tree_shapes.empty())
+        packet->tree_shapes = NodeFactory::TunableTreeShapes(root);
+
+    return packet->tree_shapes[packet->tree_shape_id].scheme;
+}
+
 void EnumerateTrees(ExecPlan& execPlan)
 {
-    std::string archName = get_arch_name(execPlan.deviceProp);
+    std::string archName
+        = solution_map::get_tuning_arch(get_arch_name(execPlan.deviceProp), execPlan.deviceProp);
 
     // NB:
     //  Get Root's token before build tree. Since Real-Transform may modify the length.
     std::string root_min_token, root_full_token;
     GetNodeToken(*execPlan.rootPlan, root_min_token, root_full_token);
 
-    // TODO- plan-tuning: build tree several times to generate different trees
+    // the root was created with the tree shape being tuned, see
+    // SelectTreeShape.  the offline tuner tunes each shape in turn.
     {
         execPlan.rootPlan->RecursiveBuildTree();
 
@@ -127,8 +160,16 @@ void EnumerateTrees(ExecPlan& execPlan)
         // the kernels exist in function_pool which is not always true for RTC and tuning
         // execPlan.rootPlan->SanityCheck(rootScheme, execPlan.solution_kernels);
 
-        if(TuningBenchmarker::GetSingleton().GetPacket()->tuning_phase == 0)
+        auto packet = TuningBenchmarker::GetSingleton().GetPacket();
+        if(packet->tuning_phase == 0)
         {
+            // remember what this shape built, to skip shapes that build
+            // the same tree as an earlier one
+            auto& signatures = packet->tree_signatures;
+            if(signatures.size() <= packet->tree_shape_id)
+                signatures.resize(packet->tree_shape_id + 1);
+            signatures[packet->tree_shape_id] = TreeSignature(*execPlan.rootPlan);
+
             // Adding decompoistion solutions from this tree-decomposition
             SerializeTree(execPlan.rootPlan.get(), archName, root_min_token, root_full_token);
         }
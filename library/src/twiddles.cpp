@@ -28,22 +28,78 @@
 #include "rtc_cache.h"
 #include "rtc_kernel.h"
 #include "rtc_twiddle_kernel.h"
+#include <algorithm>
 #include <cassert>
+#include <map>
 #include <math.h>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <string>
 #include <tuple>
 
+// twiddle and chirp tables are generated on one stream per device,
+// so that a single event or synchronize covers every table that has
+// been generated on the device.
+struct table_stream_t
+{
+    // table generation doesn't wait for the kernels it launches, so
+    // keep them loaded for the life of the stream.  declared before
+    // the stream so that they're destroyed after it.
+    std::map<std::string, std::unique_ptr<RTCKernel>> kernels;
+    hipStream_wrapper_t                               stream;
+};
+
 // this vector stores streams for each device id.  index in the
 // vector is device id.  note that this vector needs to be protected
-// against concurrent access, but twiddles are always accessed
+// against concurrent access, but tables are always generated
 // through the Repo which guarantees exclusive access.
-static std::vector<hipStream_wrapper_t> twiddle_streams;
+static std::vector<table_stream_t> table_streams;
 
 void twiddle_streams_cleanup()
 {
-    twiddle_streams.clear();
+    table_streams.clear();
+}
+
+hipStream_t table_stream(unsigned int deviceId)
+{
+    if(deviceId >= table_streams.size())
+        table_streams.resize(deviceId + 1);
+    hipStream_wrapper_t& stream = table_streams[deviceId].stream;
+    if(!stream)
+        stream.alloc();
+    return stream;
+}
+
+void table_stream_synchronize(unsigned int deviceId)
+{
+    if(deviceId >= table_streams.size() || !table_streams[deviceId].stream)
+        return;
+    if(hipStreamSynchronize(table_streams[deviceId].stream) != hipSuccess)
+        throw std::runtime_error("hipStream failure");
+}
+
+RTCKernel& table_kernel(const std::string&                          kernel_name,
+                        const std::function<std::unique_ptr<RTCKernel>()>& generate)
+{
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        throw std::runtime_error("hipGetDevice failed.");
+    table_stream(deviceId);
+
+    auto& kernel = table_streams[deviceId].kernels[kernel_name];
+    if(!kernel)
+        kernel = generate();
+    return *kernel;
+}
+
+static RTCKernel&
+    twiddle_kernel(const hipDeviceProp_t& deviceProp, TwiddleTableType type, rocfft_precision precision)
+{
+    return table_kernel(twiddle_rtc_kernel_name(type, precision), [&]() {
+        return std::unique_ptr<RTCKernel>(new RTCKernelTwiddle(
+            RTCKernelTwiddle::generate(deviceProp.gcnArchName, type, precision)));
+    });
 }
 
 // Twiddle factors table
@@ -156,8 +212,7 @@ protected:
 
         auto device_data_ptr = static_cast<T*>(output.data());
 
-        auto kernel = RTCKernelTwiddle::generate(
-            deviceProp.gcnArchName, TwiddleTableType::LENGTH_N, precision);
+        auto& kernel = twiddle_kernel(deviceProp, TwiddleTableType::LENGTH_N, precision);
         RTCKernelArgs kargs;
         kargs.append_size_t(length_limit);
         kargs.append_size_t(N);
@@ -192,8 +247,7 @@ protected:
         std::copy(radices_prod.begin(), radices_prod.end(), radices_prod_device.data);
         std::copy(radices_sum_prod.begin(), radices_sum_prod.end(), radices_sum_prod_device.data);
 
-        auto kernel = RTCKernelTwiddle::generate(
-            deviceProp.gcnArchName, TwiddleTableType::RADICES, precision);
+        auto& kernel = twiddle_kernel(deviceProp, TwiddleTableType::RADICES, precision);
         RTCKernelArgs kargs;
         kargs.append_size_t(length_limit);
         kargs.append_size_t(num_radices);
@@ -209,8 +263,7 @@ protected:
     {
         auto blockSize = TWIDDLES_THREADS;
 
-        auto kernel = RTCKernelTwiddle::generate(
-            deviceProp.gcnArchName, TwiddleTableType::HALF_N, precision);
+        auto& kernel = twiddle_kernel(deviceProp, TwiddleTableType::HALF_N, precision);
         RTCKernelArgs kargs;
         kargs.append_size_t(half_N);
         kargs.append_size_t(N);
@@ -334,6 +387,76 @@ public:
     }
 };
 
+// Twiddle factors table for 3D_SINGLE kernels: one table per
+// dimension, appended one after another.  A dimension whose radices
+// match an earlier dimension's reuses that table instead.
+template <typename T>
+class TwiddleTable3D : public TwiddleTable<T>
+{
+private:
+    std::array<size_t, 3> lengths;
+
+public:
+    TwiddleTable3D(rocfft_precision             precision,
+                   const hipDeviceProp_t&       deviceProp,
+                   const std::array<size_t, 3>& _lengths)
+        : TwiddleTable<T>(precision, deviceProp, 0, 0, false)
+        , lengths(_lengths)
+    {
+    }
+
+    void GenerateTwiddleTable(const std::array<std::vector<size_t>, 3>& radices,
+                              hipStream_t&                              stream,
+                              gpubuf&                                   output)
+    {
+        std::array<size_t, 3>              table_sz = {};
+        std::array<size_t, 3>              maxElem  = {};
+        std::array<size_t, 3>              minElem  = {};
+        std::array<std::vector<size_t>, 3> radices_prod, radices_sum_prod;
+        std::array<bool, 3>                is_new_table = {};
+
+        size_t total_table_sz = 0;
+        for(size_t d = 0; d < 3; ++d)
+        {
+            is_new_table[d] = std::find(radices.begin(), radices.begin() + d, radices[d])
+                              == radices.begin() + d;
+            if(!is_new_table[d])
+                continue;
+            TwiddleTable<T>::GetKernelParams(radices[d],
+                                             radices_prod[d],
+                                             radices_sum_prod[d],
+                                             maxElem[d],
+                                             minElem[d],
+                                             table_sz[d]);
+            total_table_sz += table_sz[d];
+        }
+
+        auto table_bytes = total_table_sz * sizeof(T);
+        if(table_bytes == 0)
+            return;
+
+        if(output.alloc(table_bytes) != hipSuccess)
+            throw std::runtime_error("unable to allocate twiddle length "
+                                     + std::to_string(total_table_sz));
+
+        auto device_data_ptr = static_cast<T*>(output.data());
+        for(size_t d = 0; d < 3; ++d)
+        {
+            if(!is_new_table[d])
+                continue;
+            TwiddleTable<T>::length_limit = lengths[d];
+            TwiddleTable<T>::launch_radices_kernel(radices[d],
+                                                   radices_prod[d],
+                                                   radices_sum_prod[d],
+                                                   maxElem[d],
+                                                   minElem[d],
+                                                   stream,
+                                                   device_data_ptr);
+            device_data_ptr += table_sz[d];
+        }
+    }
+};
+
 // Twiddle factors table for large N > 4096
 // used in 3-step algorithm
 template <typename T>
@@ -381,10 +504,10 @@ public:
         auto numBlocksX = DivRoundingUp<size_t>(X, blockSize);
         auto numBlocksY = DivRoundingUp<size_t>(Y, blockSize);
 
-        auto kernel = RTCKernelTwiddle::generate(
-            deviceProp.gcnArchName, TwiddleTableType::LARGE, precision);
+        auto& kernel = twiddle_kernel(deviceProp, TwiddleTableType::LARGE, precision);
         RTCKernelArgs kargs;
         kargs.append_double(phi);
+        kargs.append_size_t(N);
         kargs.append_size_t(largeTwdBase);
         kargs.append_size_t(X);
         kargs.append_size_t(Y);
@@ -408,15 +531,8 @@ gpubuf twiddles_create_pr(size_t                     N,
     if(largeTwdBase && length_limit)
         throw std::runtime_error("length-limited large twiddles are not supported");
 
-    gpubuf twts;
-    if(deviceId >= twiddle_streams.size())
-        twiddle_streams.resize(deviceId + 1);
-    if(twiddle_streams[deviceId] == nullptr)
-        twiddle_streams[deviceId].alloc();
-    hipStream_wrapper_t& stream = twiddle_streams[deviceId];
-
-    if(!stream)
-        stream.alloc();
+    gpubuf      twts;
+    hipStream_t stream = table_stream(deviceId);
 
     if((N <= LARGE_TWIDDLE_THRESHOLD) && largeTwdBase == 0)
     {
@@ -440,9 +556,6 @@ gpubuf twiddles_create_pr(size_t                     N,
         }
     }
 
-    if(hipStreamSynchronize(stream) != hipSuccess)
-        throw std::runtime_error("hipStream failure");
-
     return twts;
 }
 
@@ -480,19 +593,12 @@ gpubuf twiddles_create_2D_pr(size_t                     N1,
                              const std::vector<size_t>& radices2,
                              unsigned int               deviceId)
 {
-    gpubuf twts;
-    if(deviceId >= twiddle_streams.size())
-        twiddle_streams.resize(deviceId + 1);
-    hipStream_wrapper_t& stream = twiddle_streams[deviceId];
-    if(!stream)
-        stream.alloc();
+    gpubuf      twts;
+    hipStream_t stream = table_stream(deviceId);
 
     TwiddleTable2D<T> twTable(precision, deviceProp, N1, N2, attach_halfN, attach_halfN2);
     twTable.GenerateTwiddleTable(radices1, radices2, stream, twts);
 
-    if(hipStreamSynchronize(stream) != hipSuccess)
-        throw std::runtime_error("hipStream failure");
-
     return twts;
 }
 
@@ -540,3 +646,39 @@ gpubuf twiddles_create_2D(size_t                     N1,
                                                                deviceId);
     }
 }
+
+template <typename T>
+gpubuf twiddles_create_3D_pr(const std::array<size_t, 3>&              lengths,
+                             rocfft_precision                          precision,
+                             const hipDeviceProp_t&                    deviceProp,
+                             const std::array<std::vector<size_t>, 3>& radices,
+                             unsigned int                              deviceId)
+{
+    gpubuf      twts;
+    hipStream_t stream = table_stream(deviceId);
+
+    TwiddleTable3D<T> twTable(precision, deviceProp, lengths);
+    twTable.GenerateTwiddleTable(radices, stream, twts);
+
+    return twts;
+}
+
+gpubuf twiddles_create_3D(const std::array<size_t, 3>&              lengths,
+                          rocfft_precision                          precision,
+                          const hipDeviceProp_t&                    deviceProp,
+                          const std::array<std::vector<size_t>, 3>& radices,
+                          unsigned int                              deviceId)
+{
+    switch(precision)
+    {
+    case rocfft_precision_single:
+        return twiddles_create_3D_pr<rocfft_complex<float>>(
+            lengths, precision, deviceProp, radices, deviceId);
+    case rocfft_precision_double:
+        return twiddles_create_3D_pr<rocfft_complex<double>>(
+            lengths, precision, deviceProp, radices, deviceId);
+    case rocfft_precision_half:
+        return twiddles_create_3D_pr<rocfft_complex<_Float16>>(
+            lengths, precision, deviceProp, radices, deviceId);
+    }
+}
@@ -0,0 +1,136 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "work_buffer_pool.h"
+#include "../../shared/environment.h"
+#include "logging.h"
+#include "rocfft/rocfft.h"
+
+hipMemPool_t WorkBufferPool::GetDevicePool()
+{
+    int deviceId = 0;
+    if(hipGetDevice(&deviceId) != hipSuccess)
+        return nullptr;
+
+    auto it = pools.find(deviceId);
+    if(it != pools.end())
+        return it->second;
+
+    // remember unsupported devices as a null pool, so we don't keep
+    // asking
+    hipMemPool_t pool      = nullptr;
+    int          supported = 0;
+    if(hipDeviceGetAttribute(&supported, hipDeviceAttributeMemoryPoolsSupported, deviceId)
+           == hipSuccess
+       && supported)
+    {
+        hipMemPoolProps props = {};
+        props.allocType       = hipMemAllocationTypePinned;
+        props.location.type   = hipMemLocationTypeDevice;
+        props.location.id     = deviceId;
+        if(hipMemPoolCreate(&pool, &props) != hipSuccess)
+            pool = nullptr;
+        else
+        {
+            uint64_t threshold = releaseThreshold;
+            (void)hipMemPoolSetAttribute(pool, hipMemPoolAttrReleaseThreshold, &threshold);
+        }
+    }
+    pools.emplace(deviceId, pool);
+    return pool;
+}
+
+void* WorkBufferPool::Alloc(size_t bytes, hipStream_t stream)
+{
+    // allow env variable to disable the pool
+    static const bool disabled = rocfft_getenv("ROCFFT_WORK_BUFFER_POOL") == "0";
+    if(disabled)
+        return nullptr;
+
+    hipMemPool_t pool = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        pool = GetDevicePool();
+    }
+    if(!pool)
+        return nullptr;
+
+    void* ptr = nullptr;
+    if(hipMallocFromPoolAsync(&ptr, bytes, pool, stream) != hipSuccess)
+        return nullptr;
+    return ptr;
+}
+
+void WorkBufferPool::Free(void* ptr, hipStream_t stream)
+{
+    // called from destructors, so ignore errors
+    if(ptr)
+        (void)hipFreeAsync(ptr, stream);
+}
+
+void WorkBufferPool::SetReleaseThreshold(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    releaseThreshold = bytes;
+    for(auto& p : pools)
+    {
+        if(!p.second)
+            continue;
+        uint64_t threshold = releaseThreshold;
+        (void)hipMemPoolSetAttribute(p.second, hipMemPoolAttrReleaseThreshold, &threshold);
+        // give back anything beyond the new threshold right away
+        (void)hipMemPoolTrimTo(p.second, releaseThreshold);
+    }
+}
+
+void WorkBufferPool::Trim()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for(auto& p : pools)
+    {
+        if(p.second)
+            (void)hipMemPoolTrimTo(p.second, 0);
+    }
+}
+
+void WorkBufferPool::Clear()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    for(auto& p : pools)
+    {
+        if(p.second)
+            (void)hipMemPoolDestroy(p.second);
+    }
+    pools.clear();
+}
+
+rocfft_status rocfft_work_buffer_pool_set_limit(size_t size_in_bytes)
+{
+    log_trace(__func__, "size_in_bytes", size_in_bytes);
+    WorkBufferPool::GetPool().SetReleaseThreshold(size_in_bytes);
+    return rocfft_status_success;
+}
+
+rocfft_status rocfft_work_buffer_pool_trim()
+{
+    log_trace(__func__);
+    WorkBufferPool::GetPool().Trim();
+    return rocfft_status_success;
+}
@@ -7,5 +7,9 @@ import perflib.tuner
 import perflib.timer
 import perflib.utils
 import perflib.accutest
+import perflib.profile
+import perflib.history
+import perflib.bisection
+import perflib.git
 
 from .specs import get_machine_specs
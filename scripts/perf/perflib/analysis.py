@@ -69,6 +69,25 @@ def ratio_confidence_interval(Avals, Bvals, alpha=0.95, nboot=2000):
     return low, high
 
 
+def significance_test(Avals, Bvals, method):
+    """Test whether two samples of times differ.
+
+    Returns the p-value, and the measure of each sample that the
+    method compares (median or mean).
+    """
+    import scipy.stats
+    if method == 'moods':
+        _, pval, _, _ = scipy.stats.median_test(Avals, Bvals)
+        return pval, statistics.median(Avals), statistics.median(Bvals)
+    if method == 'ttest':
+        _, pval = scipy.stats.ttest_ind(Avals, Bvals)
+        return pval, np.mean(Avals), np.mean(Bvals)
+    if method == 'mwu':
+        _, pval = scipy.stats.mannwhitneyu(Avals, Bvals)
+        return pval, statistics.median(Avals), statistics.median(Bvals)
+    raise ValueError('unsupported statistical method: ' + method)
+
+
 @dataclass
 class MoodsResult:
     pval: float
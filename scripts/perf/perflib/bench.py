@@ -27,6 +27,51 @@ import tempfile
 import time
 
 
+def transform_args(length,
+                   direction=-1,
+                   real=False,
+                   inplace=True,
+                   precision='single',
+                   nbatch=1):
+    """Return the rocfft-bench options that describe a transform."""
+    cmd = []
+    if isinstance(length, int):
+        cmd += ['--length', length]
+    else:
+        cmd += ['--length'] + list(length)
+
+    cmd += ['-b', nbatch]
+    if not inplace:
+        cmd += ['-o']
+    if precision in ['half', 'single', 'double']:
+        cmd += ['--precision', precision]
+
+    if real:
+        if direction == -1:
+            cmd += ['-t', 2, '--itype', 2, '--otype', 3]
+        if direction == 1:
+            cmd += ['-t', 3, '--itype', 3, '--otype', 2]
+    else:
+        if direction == -1:
+            cmd += ['-t', 0]
+        if direction == 1:
+            cmd += ['-t', 1]
+    return [str(x) for x in cmd]
+
+
+def parse_times(out):
+    """Return the execution times and energies reported in `out`."""
+    times = []
+    energies = []
+    for m in re.finditer('Execution gpu time: ([ 0-9.]*) ms', out,
+                         re.MULTILINE):
+        times.append(list(map(float, m.group(1).split(' '))))
+    for m in re.finditer('Execution energy: ([ 0-9.e+-]*) J', out,
+                         re.MULTILINE):
+        energies.append(list(map(float, m.group(1).split(' '))))
+    return times, energies
+
+
 def run(bench,
         length,
         direction=-1,
@@ -39,14 +84,16 @@ def run(bench,
         libraries=None,
         verbose=False,
         timeout=300,
-        sequence=None):
-    """Run rocFFT bench and return execution times."""
-    cmd = [pathlib.Path(bench).resolve()]
+        sequence=None,
+        power=False):
+    """Run rocFFT bench and return execution times.
 
-    if isinstance(length, int):
-        cmd += ['--length', length]
-    else:
-        cmd += ['--length'] + list(length)
+    If `power` is set, the GPU's power draw is sampled during each
+    trial and the energy in joules of each trial is also returned.
+    """
+    cmd = [pathlib.Path(bench).resolve()]
+    cmd += transform_args(length, direction, real, inplace, precision,
+                          nbatch)
 
     if libraries is not None:
         for library in libraries:
@@ -57,29 +104,10 @@ def run(bench,
                 cmd += ['--sequence', str(sequence)]
 
     cmd += ['-N', ntrial]
-    cmd += ['-b', nbatch]
-    if not inplace:
-        cmd += ['-o']
-    if precision == 'half':
-        cmd += ['--precision', 'half']
-    elif precision == 'single':
-        cmd += ['--precision', 'single']
-    elif precision == 'double':
-        cmd += ['--precision', 'double']
     if device is not None:
         cmd += ['--device', device]
-
-    itype, otype = 0, 0
-    if real:
-        if direction == -1:
-            cmd += ['-t', 2, '--itype', 2, '--otype', 3]
-        if direction == 1:
-            cmd += ['-t', 3, '--itype', 3, '--otype', 2]
-    else:
-        if direction == -1:
-            cmd += ['-t', 0]
-        if direction == 1:
-            cmd += ['-t', 1]
+    if power:
+        cmd += ['--power']
 
     cmd = [str(x) for x in cmd]
     logging.info('running: ' + ' '.join(cmd))
@@ -109,6 +137,7 @@ def run(bench,
     tokentoken = "Token: "
     token = ""
     times = []
+    energies = []
 
     soltokenTag = "[SolToken]: "
     soltoken = ""
@@ -126,9 +155,7 @@ def run(bench,
             match = line[len(matchTag):]
 
     if proc.returncode == 0:
-        for m in re.finditer('Execution gpu time: ([ 0-9.]*) ms', cout,
-                             re.MULTILINE):
-            times.append(list(map(float, m.group(1).split(' '))))
+        times, energies = parse_times(cout)
     else:
         logging.info("PROCESS FAILED with return code " + str(proc.returncode))
 
@@ -146,4 +173,118 @@ def run(bench,
 
     success = proc.returncode == 0
 
-    return token, times, success, soltoken, match
+    return token, times, success, soltoken, match, energies
+
+
+def run_token(bench, token, ntrial=1, device=None, timeout=300):
+    """Run rocFFT bench on `token` and return its execution times.
+
+    Returns None if the run failed.
+    """
+    cmd = [
+        str(pathlib.Path(bench).resolve()), '--token', token, '-N',
+        str(ntrial)
+    ]
+    if device is not None:
+        cmd += ['--device', str(device)]
+    logging.info('running: ' + ' '.join(cmd))
+    try:
+        p = subprocess.run(cmd,
+                           stdout=subprocess.PIPE,
+                           stderr=subprocess.DEVNULL,
+                           encoding='ascii',
+                           errors='replace',
+                           timeout=None if timeout == 0 else timeout,
+                           check=True)
+    except (subprocess.CalledProcessError, subprocess.TimeoutExpired):
+        logging.info('run failed: ' + token)
+        return None
+    times, _ = parse_times(p.stdout)
+    return times[0] if times else None
+
+
+def run_batch(bench,
+              problems,
+              ntrial=1,
+              device=None,
+              verbose=False,
+              timeout=300,
+              power=False):
+    """Run a list of problems in one rocFFT bench process.
+
+    Each problem is a dict of `transform_args` keyword arguments.
+    Returns a (token, times, success, energies) tuple for each
+    problem, in order.  `timeout` applies to each problem, so the
+    whole batch is allowed `timeout` times the number of problems.
+    """
+    if not problems:
+        return []
+
+    batch = tempfile.NamedTemporaryFile(mode="w+", suffix=".txt")
+    for problem in problems:
+        batch.write(' '.join(transform_args(**problem)) + '\n')
+    batch.flush()
+
+    cmd = [pathlib.Path(bench).resolve(), '--batch', batch.name]
+    cmd += ['-N', ntrial]
+    if device is not None:
+        cmd += ['--device', device]
+    if power:
+        cmd += ['--power']
+
+    cmd = [str(x) for x in cmd]
+    logging.info('running: ' + ' '.join(cmd))
+    if verbose:
+        print('running: ' + ' '.join(cmd))
+    fout = tempfile.TemporaryFile(mode="w+")
+    ferr = tempfile.TemporaryFile(mode="w+")
+
+    time_start = time.time()
+    proc = subprocess.Popen(cmd, stdout=fout, stderr=ferr)
+    try:
+        proc.wait(timeout=None if timeout == 0 else timeout * len(problems))
+    except subprocess.TimeoutExpired:
+        logging.info("killed")
+        proc.kill()
+    time_end = time.time()
+    logging.info("elapsed time in seconds: " + str(time_end - time_start))
+    batch.close()
+
+    fout.seek(0)
+    ferr.seek(0)
+    cout = fout.read()
+    cerr = ferr.read()
+
+    logging.debug(cout)
+    logging.debug(cerr)
+
+    # each problem's output starts with a Problem line and ends with
+    # a Status line; problems missing from the output (because the
+    # process crashed or timed out) failed
+    results = [('', [], False, []) for _ in problems]
+    for block in re.split(r'^Problem: ', cout, flags=re.MULTILINE)[1:]:
+        index, _, body = block.partition('\n')
+        token = ''
+        m = re.search('^Token: (.*)$', body, re.MULTILINE)
+        if m:
+            token = m.group(1)
+        m = re.search('^Status: (.*)$', body, re.MULTILINE)
+        status = m.group(1) if m else 'failed'
+        if status.startswith('failed'):
+            logging.info("PROBLEM FAILED: " + status)
+            times, energies = [], []
+        else:
+            times, energies = parse_times(body)
+        results[int(index)] = (token, times, not status.startswith('failed'),
+                               energies)
+        if status == 'skipped':
+            print('s', end='', flush=True)
+        elif status.startswith('failed'):
+            print('x', end='', flush=True)
+        else:
+            print('.', end='', flush=True)
+
+    if verbose:
+        print('finished: ' + ' '.join(cmd))
+
+    return results
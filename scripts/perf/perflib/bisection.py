@@ -0,0 +1,156 @@
+# Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+"""Find the commit that made a transform slower."""
+
+import logging
+import statistics
+import subprocess
+
+from dataclasses import dataclass, field
+from pathlib import Path
+from typing import Dict, List
+
+from . import git
+from .analysis import significance_test
+from .bench import run_token
+from .build import build_rocfft
+
+
+@dataclass
+class Bisector:
+    """Binary search for a performance regression between two commits.
+
+    Every commit is built in one checkout under `workdir`, so each
+    build only recompiles what changed since the last.  The AOT kernel
+    cache build reuses compiled kernels between builds through a
+    shared build kernel cache and kernel source cache.
+    """
+    repo: str
+    token: str
+    workdir: Path
+    ntrial: int = 20
+    device: int = None
+    timeout: float = 600
+    method: str = 'moods'
+    significance: float = 0.05
+    times: Dict[str, List[float]] = field(default_factory=dict)
+
+    def bench(self, commit):
+        """Build `commit` if needed and return its times, or None."""
+        if commit in self.times:
+            return self.times[commit]
+
+        dest = self.workdir / f'build-{commit}'
+        bench = dest / 'rocfft-bench'
+        if not bench.exists():
+            sources = self.workdir / 'kernel-sources'
+            sources.mkdir(parents=True, exist_ok=True)
+            defs = [
+                '-DROCFFT_BUILD_KERNEL_CACHE_PATH=' +
+                str(self.workdir / 'build-kernel-cache.db'),
+                '-DROCFFT_KERNEL_SOURCE_CACHE_PATH=' + str(sources)
+            ]
+            try:
+                build_rocfft(commit,
+                             dest=dest,
+                             repo=self.repo,
+                             top=self.checkout(),
+                             extra_defs=defs)
+            except subprocess.CalledProcessError:
+                logging.info('build failed: ' + commit)
+                self.times[commit] = None
+                return None
+
+        times = run_token(bench, self.token, self.ntrial, self.device,
+                          self.timeout)
+        self.times[commit] = times
+        return times
+
+    def checkout(self):
+        top = self.workdir / 'rocFFT'
+        if not top.exists():
+            self.workdir.mkdir(parents=True, exist_ok=True)
+            git.clone(self.repo, top)
+        return top
+
+    def is_bad(self, good_times, bad_times, times):
+        """Decide whether `times` look like the bad commit's.
+
+        A commit is bad if it is significantly slower than the good
+        commit, and closer to the bad commit's time than to the good
+        one's.
+        """
+        pval, good_measure, measure = significance_test(
+            good_times, times, self.method)
+        _, _, bad_measure = significance_test(good_times, bad_times,
+                                              self.method)
+        if pval >= self.significance or measure <= good_measure:
+            return False
+        return measure >= (good_measure + bad_measure) / 2
+
+    def run(self, good, bad):
+        """Return the last good commit and the first bad one after it.
+
+        Commits that fail to build or run are skipped, so other
+        commits may lie between the two that are returned.  None is
+        returned if `bad` is not significantly slower than `good`.
+        """
+        commits = git.rev_list(self.checkout(), good, bad)
+        if not commits:
+            raise RuntimeError(f'{bad} does not come after {good}')
+
+        good_times = self.bench(good)
+        bad_times = self.bench(bad)
+        if good_times is None or bad_times is None:
+            raise RuntimeError('unable to build and time the good and bad '
+                               'commits')
+        self.report(good, 'good')
+        self.report(bad, 'bad')
+
+        if not self.is_bad(good_times, bad_times, bad_times):
+            return None
+
+        # candidates[lo] is known good and candidates[hi] known bad
+        candidates = [good] + commits
+        lo, hi = 0, len(candidates) - 1
+        while hi - lo > 1:
+            mid = (lo + hi) // 2
+            times = self.bench(candidates[mid])
+            if times is None:
+                self.report(candidates[mid], 'skipped')
+                del candidates[mid]
+                hi -= 1
+                continue
+            if self.is_bad(good_times, bad_times, times):
+                self.report(candidates[mid], 'bad')
+                hi = mid
+            else:
+                self.report(candidates[mid], 'good')
+                lo = mid
+        return candidates[lo], candidates[hi]
+
+    def report(self, commit, verdict):
+        median = statistics.median(self.times[commit]) if self.times.get(
+            commit) else None
+        line = f'{commit[:12]}: {verdict}'
+        if median is not None:
+            line += f' ({median:.4f} ms median)'
+        print(line, flush=True)
+        logging.info('bisect ' + line)
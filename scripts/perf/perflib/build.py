@@ -52,10 +52,18 @@ def local_amdgpu_target():
 def build_rocfft(
         commit,
         dest=None,
-        repo='git@github.com:ROCmSoftwarePlatform/rocFFT-internal.git'):
-    """Build public rocFFT (at specified git `commit`) and install into `dest`."""
+        repo='git@github.com:ROCmSoftwarePlatform/rocFFT-internal.git',
+        top=None,
+        extra_defs=None):
+    """Build public rocFFT (at specified git `commit`) and install into `dest`.
+
+    The checkout is `top`, or a new `rocFFT-<commit>` directory.
+    Reusing one checkout for several commits lets each build reuse
+    the objects of the last.  `extra_defs` are more CMake definitions.
+    """
 
-    top = Path('.').resolve() / ('rocFFT-' + commit)
+    if top is None:
+        top = Path('.').resolve() / ('rocFFT-' + commit)
 
     if not top.exists():
         git.clone(repo, top)
@@ -76,6 +84,8 @@ def build_rocfft(
         defs += [f'-DCMAKE_INSTALL_PREFIX={dest}']
     if which('ccache') is not None:
         defs += ['-DCMAKE_CXX_COMPILER_LAUNCHER=ccache']
+    if extra_defs:
+        defs += extra_defs
 
     use_ninja = which('ninja') is not None
 
@@ -49,3 +49,18 @@ def branch(repo):
                        encoding='ascii',
                        check=True)
     return p.stdout.strip()
+
+
+def rev_list(repo, good, bad):
+    """Commits after `good` up to and including `bad`, oldest first.
+
+    Only first parents are followed, so merged branches are tested
+    as a whole at their merge commits.
+    """
+    p = subprocess.run(
+        ['git', 'rev-list', '--first-parent', '--reverse', f'{good}..{bad}'],
+        cwd=str(repo),
+        stdout=subprocess.PIPE,
+        encoding='ascii',
+        check=True)
+    return p.stdout.split()
@@ -0,0 +1,342 @@
+# Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+"""Persistent history of performance runs.
+
+Runs are recorded in an sqlite database, keyed by rocFFT commit, GPU
+architecture and ROCm version, with the median time of every token in
+every suite.  Trends are followed per (suite, architecture, ROCm
+version), in commit order.
+"""
+
+import json
+import math
+import re
+import sqlite3
+import statistics
+import subprocess
+import time
+
+from dataclasses import dataclass
+from pathlib import Path
+from typing import List
+
+from .utils import read_run
+
+SCHEMA = '''
+CREATE TABLE IF NOT EXISTS runs (
+    id INTEGER PRIMARY KEY,
+    commit_hash TEXT NOT NULL,
+    commit_time INTEGER NOT NULL,
+    arch TEXT NOT NULL,
+    rocm_version TEXT NOT NULL,
+    label TEXT NOT NULL,
+    recorded_time INTEGER NOT NULL
+);
+CREATE TABLE IF NOT EXISTS results (
+    run_id INTEGER NOT NULL REFERENCES runs(id) ON DELETE CASCADE,
+    suite TEXT NOT NULL,
+    token TEXT NOT NULL,
+    median_ms REAL NOT NULL,
+    times TEXT NOT NULL,
+    PRIMARY KEY (run_id, suite, token)
+);
+CREATE INDEX IF NOT EXISTS results_token ON results (suite, token);
+'''
+
+
+def connect(db):
+    """Open (creating if necessary) a history database."""
+    conn = sqlite3.connect(str(db))
+    conn.execute('PRAGMA foreign_keys = ON')
+    conn.executescript(SCHEMA)
+    return conn
+
+
+def commit_info(repo, rev='HEAD'):
+    """Return the full hash and commit time of `rev` in `repo`."""
+    p = subprocess.run(['git', 'log', '-1', '--format=%H %ct', rev],
+                       cwd=str(repo),
+                       stdout=subprocess.PIPE,
+                       encoding='ascii',
+                       check=True)
+    commit, ctime = p.stdout.split()
+    return commit, int(ctime)
+
+
+def detect_arch():
+    """Return the gfx architecture of the first GPU, or None."""
+    try:
+        p = subprocess.run(['rocm_agent_enumerator'],
+                           stdout=subprocess.PIPE,
+                           encoding='ascii')
+    except FileNotFoundError:
+        return None
+    for agent in p.stdout.split():
+        if agent != 'gfx000':
+            return agent
+    return None
+
+
+def rocm_version_from_specs(run_dir):
+    """Return the ROCm version in a run's specs.txt, or None."""
+    specs = Path(run_dir) / 'specs.txt'
+    if not specs.is_file():
+        return None
+    m = re.search(r'rocm version:\s*(.*?)$', specs.read_text(),
+                  re.MULTILINE)
+    return m.group(1).strip() if m else None
+
+
+def record(conn,
+           run_dir,
+           commit,
+           commit_time,
+           arch,
+           rocm_version,
+           label=''):
+    """Record the .dat files of a run directory.
+
+    Recording the same commit, architecture and ROCm version again
+    replaces the earlier results.  Returns the new run's ID.
+    """
+    run = read_run(run_dir)
+    with conn:
+        conn.execute(
+            'DELETE FROM runs WHERE commit_hash = ? AND arch = ? AND rocm_version = ?',
+            (commit, arch, rocm_version))
+        cur = conn.execute(
+            'INSERT INTO runs (commit_hash, commit_time, arch, rocm_version, label, recorded_time)'
+            ' VALUES (?, ?, ?, ?, ?, ?)', (commit, commit_time, arch,
+                                          rocm_version, label, int(
+                                              time.time())))
+        run_id = cur.lastrowid
+        for dat in run.dats.values():
+            suite = dat.meta.get('suite', dat.tag)
+            for token, sample in dat.get_samples():
+                if not sample.times:
+                    continue
+                conn.execute(
+                    'INSERT OR REPLACE INTO results VALUES (?, ?, ?, ?, ?)',
+                    (run_id, suite, token, statistics.median(sample.times),
+                     json.dumps(sample.times)))
+    return run_id
+
+
+@dataclass
+class TrendPoint:
+    """One run's position in a suite's trend."""
+    run_id: int
+    commit: str
+    commit_time: int
+    label: str
+    # suite's time relative to its first run (lower is faster)
+    relative: float
+    # tokens compared with the previous run
+    ncompared: int
+
+
+@dataclass
+class ChangePoint:
+    """A run where a suite's time shifted and stayed shifted."""
+    index: int
+    # fractional change in time, positive is slower
+    change: float
+
+
+@dataclass
+class Trend:
+    suite: str
+    arch: str
+    rocm_version: str
+    points: List[TrendPoint]
+    changes: List[ChangePoint]
+
+
+def chained_index(conn, suite, arch, rocm_version):
+    """Return a suite's trend points in commit order.
+
+    Each run is compared with the previous one by the geometric mean
+    of the time ratios of the tokens both ran, so the index stays
+    meaningful as problems are added to or removed from the suite.
+    """
+    runs = conn.execute(
+        'SELECT DISTINCT runs.id, commit_hash, commit_time, label FROM runs'
+        ' JOIN results ON results.run_id = runs.id'
+        ' WHERE suite = ? AND arch = ? AND rocm_version = ?'
+        ' ORDER BY commit_time, recorded_time',
+        (suite, arch, rocm_version)).fetchall()
+
+    points = []
+    previous = None
+    relative = 1.0
+    for run_id, commit, commit_time, label in runs:
+        medians = dict(
+            conn.execute(
+                'SELECT token, median_ms FROM results WHERE run_id = ? AND suite = ?',
+                (run_id, suite)))
+        ncompared = 0
+        if previous is not None:
+            common = [t for t in medians if t in previous]
+            if common:
+                logs = [
+                    math.log(medians[t] / previous[t]) for t in common
+                    if medians[t] > 0 and previous[t] > 0
+                ]
+                if logs:
+                    relative *= math.exp(statistics.mean(logs))
+                ncompared = len(logs)
+        points.append(
+            TrendPoint(run_id, commit, commit_time, label, relative,
+                       ncompared))
+        previous = medians
+    return points
+
+
+def change_points(values, threshold=0.05, window=3):
+    """Find where a series shifts by more than `threshold` and stays.
+
+    Each index is scored by comparing the mean of the `window` values
+    starting there with the mean of the `window` values before it.  A
+    change is reported at the first index with the largest score among
+    its neighbours, so one shift is only reported once.
+    """
+    scores = [0.0] * len(values)
+    for i in range(1, len(values)):
+        before = statistics.mean(values[max(0, i - window):i])
+        after = statistics.mean(values[i:i + window])
+        scores[i] = after / before - 1.0
+
+    changes = []
+    for i in range(1, len(values)):
+        if abs(scores[i]) <= threshold:
+            continue
+        lo = max(1, i - window + 1)
+        neighbours = [abs(s) for s in scores[lo:i + window]]
+        if lo + neighbours.index(max(neighbours)) == i:
+            changes.append(ChangePoint(i, scores[i]))
+    return changes
+
+
+def trends(conn, threshold=0.05, window=3, arch=None, rocm_version=None):
+    """Return the trend of every suite on every architecture and ROCm."""
+    query = 'SELECT DISTINCT suite, arch, rocm_version FROM results JOIN runs ON results.run_id = runs.id'
+    conditions, params = [], []
+    if arch is not None:
+        conditions.append('arch = ?')
+        params.append(arch)
+    if rocm_version is not None:
+        conditions.append('rocm_version = ?')
+        params.append(rocm_version)
+    if conditions:
+        query += ' WHERE ' + ' AND '.join(conditions)
+    query += ' ORDER BY suite, arch, rocm_version'
+
+    ret = []
+    for suite, run_arch, run_rocm in conn.execute(query, params).fetchall():
+        points = chained_index(conn, suite, run_arch, run_rocm)
+        changes = change_points([p.relative for p in points], threshold,
+                                window)
+        ret.append(Trend(suite, run_arch, run_rocm, points, changes))
+    return ret
+
+
+def print_changes(all_trends):
+    """Print the change points of each trend."""
+    for trend in all_trends:
+        for change in trend.changes:
+            point = trend.points[change.index]
+            before = trend.points[change.index - 1]
+            kind = 'slower' if change.change > 0 else 'faster'
+            print(f'{trend.suite} ({trend.arch}, ROCm {trend.rocm_version}):'
+                  f' {100 * abs(change.change):.1f}% {kind} at'
+                  f' {point.commit[:12]} (after {before.commit[:12]})')
+
+
+def make_trend_html(all_trends, outfile, title='Performance trends'):
+    """Write an html report with a trend plot for each suite."""
+    from plotly import graph_objs as go
+
+    by_suite = {}
+    for trend in all_trends:
+        by_suite.setdefault(trend.suite, []).append(trend)
+
+    out = open(outfile, 'w')
+    out.write('''
+<html>
+  <head>
+    <title>{}</title>
+  </head>
+  <body>
+'''.format(title))
+
+    include_js = True
+    for suite, suite_trends in by_suite.items():
+        traces = []
+        for trend in suite_trends:
+            name = f'{trend.arch}, ROCm {trend.rocm_version}'
+            x = [
+                time.strftime('%Y-%m-%d', time.gmtime(p.commit_time))
+                for p in trend.points
+            ]
+            hover = [
+                f'{p.commit[:12]} {p.label} ({p.ncompared} problems compared)'
+                for p in trend.points
+            ]
+            traces.append(
+                go.Scatter(x=x,
+                           y=[p.relative for p in trend.points],
+                           hovertext=hover,
+                           mode='lines+markers',
+                           name=name))
+            if trend.changes:
+                traces.append(
+                    go.Scatter(
+                        x=[x[c.index] for c in trend.changes],
+                        y=[trend.points[c.index].relative
+                           for c in trend.changes],
+                        hovertext=[
+                            f'{100 * c.change:+.1f}% at {trend.points[c.index].commit[:12]}'
+                            for c in trend.changes
+                        ],
+                        mode='markers',
+                        marker=dict(size=14,
+                                    symbol='x',
+                                    color=[
+                                        'red' if c.change > 0 else 'green'
+                                        for c in trend.changes
+                                    ]),
+                        name=f'{name} change points'))
+
+        layout = go.Layout(title=suite,
+                           xaxis=dict(title='Commit date'),
+                           yaxis=dict(title='Time relative to first run',
+                                      rangemode='tozero'),
+                           hovermode='closest',
+                           width=900,
+                           height=500)
+        fig = go.Figure(data=traces, layout=layout)
+        out.write(fig.to_html(full_html=False, include_plotlyjs=include_js))
+        include_js = False
+
+    out.write('''
+    </body>
+    </html>
+    ''')
+    out.close()
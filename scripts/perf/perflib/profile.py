@@ -0,0 +1,113 @@
+# Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+"""Per-kernel profiling utilities."""
+
+import collections
+import json
+import logging
+import os
+import statistics
+import subprocess
+import tempfile
+
+from dataclasses import dataclass
+from pathlib import Path
+from typing import List
+
+
+@dataclass
+class Kernel:
+    """Median time of one kernel of a transform's execution plan."""
+    index: int
+    scheme: str
+    name: str
+    median_ms: float
+
+
+def run_profile(bench, token, ntrial=10, device=None, timeout=300):
+    """Run rocFFT bench on `token` with the profile log layer.
+
+    Returns the kernels of the execution plan in launch order, or
+    None if the run failed.
+    """
+    with tempfile.TemporaryDirectory() as tmpdir:
+        log = Path(tmpdir) / 'profile.log'
+        env = dict(os.environ)
+        env['ROCFFT_LAYER'] = '4'
+        env['ROCFFT_LOG_PROFILE_PATH'] = str(log)
+        env['ROCFFT_LOG_FORMAT'] = 'json'
+
+        cmd = [str(Path(bench).resolve()), '--token', token, '-N', str(ntrial)]
+        if device is not None:
+            cmd += ['--device', str(device)]
+        logging.info('profiling: ' + ' '.join(cmd))
+        try:
+            subprocess.run(cmd,
+                           env=env,
+                           stdout=subprocess.DEVNULL,
+                           stderr=subprocess.DEVNULL,
+                           timeout=None if timeout == 0 else timeout,
+                           check=True)
+        except (subprocess.CalledProcessError, subprocess.TimeoutExpired):
+            logging.info('profiling failed: ' + token)
+            return None
+
+        durations = collections.defaultdict(list)
+        for line in log.read_text().splitlines():
+            try:
+                record = json.loads(line)
+            except ValueError:
+                continue
+            if record.get('function') != 'TransformPowX':
+                continue
+            key = (int(record['kernel_index']), record['scheme'],
+                   record.get('kernel_name', ''))
+            durations[key].append(float(record['duration_ms']))
+
+    return [
+        Kernel(index, scheme, name, statistics.median(times))
+        for (index, scheme, name), times in sorted(durations.items())
+    ]
+
+
+def attribute(reference: List[Kernel], test: List[Kernel]):
+    """Describe what made `test` slower than `reference`.
+
+    A different decomposition is reported as a scheme change.
+    Otherwise, the kernel whose time grew the most is reported.
+    """
+    ref_schemes = [k.scheme for k in reference]
+    test_schemes = [k.scheme for k in test]
+    if ref_schemes != test_schemes:
+        return 'scheme change: ' + ' '.join(ref_schemes) + ' -> ' + ' '.join(
+            test_schemes)
+    if not reference:
+        return 'no kernels profiled'
+
+    deltas = [(t.median_ms - r.median_ms, r, t)
+              for r, t in zip(reference, test)]
+    delta, r, t = max(deltas, key=lambda d: d[0])
+    desc = f'kernel {r.index} {r.scheme}'
+    if r.name != t.name:
+        desc += f' ({r.name} -> {t.name})'
+    elif r.name:
+        desc += f' ({r.name})'
+    pct = 100.0 * delta / r.median_ms if r.median_ms > 0 else float('inf')
+    return desc + f': {r.median_ms:.4f} -> {t.median_ms:.4f} ms (+{pct:.1f}%)'
@@ -42,6 +42,8 @@ class Timer:
     verbose: bool = False
     timeout: float = 0
     sequence: int = None
+    power: bool = False
+    batch: bool = False
 
     def run_cases(self, generator):
 
@@ -53,23 +55,9 @@ class Timer:
 
         total_prob_count = 0
         no_accutest_prob_count = 0
-        for prob in generator.generate_problems():
+        for prob, (token, seconds, success,
+                   joules) in self.run_problems(generator):
             total_prob_count += 1
-            token, seconds, success, __, __ = perflib.bench.run(
-                self.bench,
-                prob.length,
-                direction=prob.direction,
-                real=prob.real,
-                inplace=prob.inplace,
-                precision=prob.precision,
-                nbatch=prob.nbatch,
-                ntrial=self.ntrial,
-                device=self.device,
-                libraries=self.lib,
-                verbose=self.verbose,
-                timeout=self.timeout,
-                sequence=self.sequence)
-
             if success:
                 for idx, vals in enumerate(seconds):
                     out = path(self.out[idx])
@@ -77,6 +65,10 @@ class Timer:
                     meta = {'title': prob.tag}
                     meta.update(prob.meta)
                     perflib.utils.write_dat(out, token, seconds[idx], meta)
+                    # energies go next to the times, in the same format
+                    if idx < len(joules):
+                        perflib.utils.write_dat(out.with_suffix('.jdat'),
+                                                token, joules[idx], meta)
             else:
                 failed_tokens.append(token)
 
@@ -95,6 +87,50 @@ class Timer:
 
         return failed_tokens
 
+    def run_problems(self, generator):
+        """Time each problem, yielding it with its bench results.
+
+        In batch mode, all problems run in one rocfft-bench process.
+        dyna-bench has no batch mode, so comparisons between libraries
+        always run each problem in its own process.
+        """
+        if self.batch and not self.lib:
+            problems = list(generator.generate_problems())
+            results = perflib.bench.run_batch(
+                self.bench, [{
+                    'length': prob.length,
+                    'direction': prob.direction,
+                    'real': prob.real,
+                    'inplace': prob.inplace,
+                    'precision': prob.precision,
+                    'nbatch': prob.nbatch
+                } for prob in problems],
+                ntrial=self.ntrial,
+                device=self.device,
+                verbose=self.verbose,
+                timeout=self.timeout,
+                power=self.power)
+            yield from zip(problems, results)
+            return
+
+        for prob in generator.generate_problems():
+            token, seconds, success, __, __, joules = perflib.bench.run(
+                self.bench,
+                prob.length,
+                direction=prob.direction,
+                real=prob.real,
+                inplace=prob.inplace,
+                precision=prob.precision,
+                nbatch=prob.nbatch,
+                ntrial=self.ntrial,
+                device=self.device,
+                libraries=self.lib,
+                verbose=self.verbose,
+                timeout=self.timeout,
+                sequence=self.sequence,
+                power=self.power)
+            yield prob, (token, seconds, success, joules)
+
 
 @dataclass
 class GroupedTimer:
@@ -107,6 +143,8 @@ class GroupedTimer:
     ntrial: int = 10
     verbose: bool = False
     timeout: float = 0
+    power: bool = False
+    batch: bool = False
 
     def run_cases(self, generator):
         failed_tokens = []
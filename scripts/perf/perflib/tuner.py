@@ -40,9 +40,15 @@ def run(tuner,
         nbatch=1,
         ntrial=1,
         device=None,
+        max_candidates=None,
+        objective=None,
         verbose=False,
-        timeout=10):
-    """Run rocFFT tuner and return best solution"""
+        timeout=10,
+        env=None):
+    """Run rocFFT tuner and return best solution.
+
+    The tuner runs with the given environment, or with this process's
+    environment if env is None."""
     cmd = [pathlib.Path(tuner).resolve()]
     cmd += ['tune']
 
@@ -63,6 +69,10 @@ def run(tuner,
         cmd += ['--precision', 'double']
     if device is not None:
         cmd += ['--device', device]
+    if max_candidates is not None:
+        cmd += ['--max_candidates', max_candidates]
+    if objective is not None:
+        cmd += ['--objective', objective]
 
     if real:
         if direction == -1:
@@ -90,7 +100,7 @@ def run(tuner,
     async def run_command(*args, timeout=None):
 
         process = await asyncio.create_subprocess_exec(
-            *args, stdout=asyncio.subprocess.PIPE)
+            *args, stdout=asyncio.subprocess.PIPE, env=env)
 
         nonlocal token
         nonlocal outFileName
@@ -245,3 +255,38 @@ def merge(merger,
         print('Failed on merging:' + ' '.join(cmd))
 
     return success
+
+
+def stale(tuner, sol_file_path, verbose=False, timeout=60):
+    """Run rocFFT tuner with command stale, returning the list of
+    'arch:probToken' problems that were tuned with a different kernel
+    generator."""
+
+    cmd = [pathlib.Path(tuner).resolve(), 'stale']
+    cmd += ['--sol_file', str(sol_file_path)]
+
+    cmd = [str(x) for x in cmd]
+    logging.info('checking: ' + ' '.join(cmd))
+    if verbose:
+        print('checking: ' + ' '.join(cmd))
+
+    try:
+        proc = subprocess.run(cmd,
+                              stdout=PIPE,
+                              stderr=STDOUT,
+                              timeout=None if timeout == 0 else timeout)
+    except subprocess.TimeoutExpired:
+        logging.info("timeout expired. killed. Please check the process.")
+        print('Failed on checking:' + ' '.join(cmd))
+        return None
+
+    if proc.returncode != 0:
+        print('Failed on checking:' + ' '.join(cmd))
+        return None
+
+    stale_probs = []
+    for line in proc.stdout.decode('utf-8', errors='replace').splitlines():
+        m = re.match(r'\[STALE\]: (\S+)', line)
+        if m:
+            stale_probs.append(m.group(1))
+    return stale_probs
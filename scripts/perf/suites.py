@@ -679,6 +679,114 @@ def batch_const_count():
                                       precision=precision)
 
 
+# Throughput targets in GB/s for the application-shaped suites below,
+# set for an MI300X-class GPU (5.3 TB/s peak memory bandwidth).  The
+# targets are stored in each .dat file, so that
+# "rocfft-perf throughput" can report results against them.
+throughput_targets = {
+    'cryo_em': 3200,
+    'seismic': 2400,
+    'ml_spectral': 2800,
+    'radar': 3600,
+}
+
+
+def application_params(suite, lengths, elements, precisions, reals,
+                       directions=all_directions, inplaces=all_inplaces):
+    """Yield batched problems for an application suite.
+
+    Each length is batched up to roughly `elements` points in total.
+    """
+    meta = {'suite': suite, 'target_GB_s': throughput_targets[suite]}
+    for precision, direction, inplace, real in product(precisions, directions,
+                                                       inplaces, reals):
+        for length in lengths:
+            length = (length, ) if isinstance(length, int) else length
+            nbatch = max(1, elements // int(np.prod(length)))
+            yield Problem(length,
+                          tag=mktag(suite, len(length), precision, direction,
+                                    inplace, real),
+                          nbatch=nbatch,
+                          direction=direction,
+                          inplace=inplace,
+                          real=real,
+                          precision=precision,
+                          meta=meta)
+
+
+def cryo_em():
+    """Cryo-EM: batched 2D real transforms of micrograph-sized images."""
+
+    lengths = [(n, n) for n in [256, 384, 512, 768, 1024, 2048, 3072, 4096]]
+    yield from application_params('cryo_em',
+                                  lengths,
+                                  2**26,
+                                  precisions=all_precisions,
+                                  reals=[True])
+
+
+def seismic():
+    """Seismic: 3D volumes with odd, non-power-of-2 dimensions."""
+
+    lengths = [
+        (135, 135, 135),
+        (175, 175, 175),
+        (225, 225, 225),
+        (231, 231, 231),
+        (243, 243, 243),
+        (315, 315, 315),
+        (375, 375, 375),
+        (99, 175, 315),
+        (125, 243, 375),
+    ]
+    yield from application_params('seismic',
+                                  lengths,
+                                  2**25,
+                                  precisions=['single'],
+                                  reals=all_reals)
+
+
+def ml_spectral():
+    """ML spectral layers: small batched 2D half-precision transforms.
+
+    rocfft-bench has no bfloat16 storage option, so these run in half
+    precision.
+    """
+
+    lengths = [(n, n) for n in [16, 32, 64, 128, 256, 512]]
+    yield from application_params('ml_spectral',
+                                  lengths,
+                                  2**24,
+                                  precisions=['half'],
+                                  reals=all_reals)
+
+
+def radar():
+    """Radar: large batched 1D complex transforms of pulse returns.
+
+    Applications usually fuse windowing into these transforms with
+    callbacks, which rocfft-bench can't set up, so they are timed
+    without.
+    """
+
+    lengths = [4096, 8192, 16384, 32768, 65536, 131072]
+    yield from application_params('radar',
+                                  lengths,
+                                  2**26,
+                                  precisions=all_precisions,
+                                  reals=[False],
+                                  inplaces=[False])
+
+
+def applications():
+    """All application-shaped suites."""
+
+    yield from cryo_em()
+    yield from seismic()
+    yield from ml_spectral()
+    yield from radar()
+
+
 def benchmarks():
     """Benchmarks: XXX"""
 
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+"""Compare file size and kernel load latency of an RTC cache at
+different zstd compression levels.
+
+Each level writes a copy of the input cache with compressed code
+objects, in the same way that rocFFT does when built with
+ROCFFT_RTC_CACHE_ZSTD.  Load latency is the time to look up every
+kernel in the copy by its primary key and decompress it, matching
+what rocFFT does on a cache hit.
+
+Requires the 'zstandard' Python module.
+"""
+
+import argparse
+import os
+import sqlite3
+import statistics
+import sys
+import tempfile
+import time
+
+try:
+    import zstandard
+except ImportError:
+    sys.exit('this script requires the zstandard module')
+
+ZSTD_MAGIC = b'\x28\xb5\x2f\xfd'
+
+
+def write_copy(src, dst, level):
+    """Copy the cache_v1 table of src into dst, compressing code at
+    the given level (0 for uncompressed)."""
+    if os.path.exists(dst):
+        os.remove(dst)
+    compressor = zstandard.ZstdCompressor(
+        level=level, write_content_size=True) if level > 0 else None
+    decompressor = zstandard.ZstdDecompressor()
+
+    out = sqlite3.connect(dst)
+    out.execute('CREATE TABLE cache_v1 ('
+                '  kernel_name TEXT NOT NULL,'
+                '  arch TEXT NOT NULL,'
+                '  hip_version INTEGER NOT NULL,'
+                '  generator_sum BLOB NOT NULL,'
+                '  code BLOB NOT NULL,'
+                '  timestamp INTEGER NOT NULL,'
+                '  PRIMARY KEY ('
+                '      kernel_name, arch, hip_version, generator_sum'
+                '      ))')
+    rows = src.execute('SELECT kernel_name, arch, hip_version, generator_sum, '
+                       'code, timestamp FROM cache_v1 '
+                       'ORDER BY kernel_name, arch, hip_version')
+    for name, arch, hip_version, generator_sum, code, timestamp in rows:
+        # input may already be compressed
+        if code.startswith(ZSTD_MAGIC):
+            code = decompressor.decompress(code)
+        if compressor:
+            code = compressor.compress(code)
+        out.execute('INSERT INTO cache_v1 VALUES (?, ?, ?, ?, ?, ?)',
+                    (name, arch, hip_version, generator_sum, code, timestamp))
+    out.commit()
+    out.close()
+
+
+def time_loads(path, repeats):
+    """Return per-kernel load times in microseconds, for a lookup and
+    decompression of every kernel in the cache."""
+    db = sqlite3.connect(path)
+    keys = db.execute('SELECT kernel_name, arch, hip_version, generator_sum '
+                      'FROM cache_v1').fetchall()
+    decompressor = zstandard.ZstdDecompressor()
+    times = []
+    for _ in range(repeats):
+        for key in keys:
+            begin = time.perf_counter()
+            (code, ) = db.execute(
+                'SELECT code FROM cache_v1 WHERE kernel_name = ? '
+                'AND arch = ? AND hip_version = ? AND generator_sum = ?',
+                key).fetchone()
+            if code.startswith(ZSTD_MAGIC):
+                code = decompressor.decompress(code)
+            times.append((time.perf_counter() - begin) * 1e6)
+    db.close()
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('cache', help='RTC cache file to measure')
+    parser.add_argument('--levels',
+                        type=int,
+                        nargs='+',
+                        default=[0, 1, 3, 9, 19],
+                        help='zstd levels to try, 0 meaning uncompressed')
+    parser.add_argument('--repeats',
+                        type=int,
+                        default=3,
+                        help='number of times to load every kernel')
+    args = parser.parse_args()
+
+    src = sqlite3.connect(args.cache)
+    with tempfile.TemporaryDirectory() as tmpdir:
+        print('level,file_bytes,write_s,median_load_us,p95_load_us')
+        for level in args.levels:
+            dst = os.path.join(tmpdir, f'cache_{level}.db')
+            begin = time.perf_counter()
+            write_copy(src, dst, level)
+            write_s = time.perf_counter() - begin
+
+            times = sorted(time_loads(dst, args.repeats))
+            if not times:
+                sys.exit('cache has no kernels')
+            p95 = times[min(len(times) - 1, int(len(times) * 0.95))]
+            print(f'{level},{os.path.getsize(dst)},{write_s:.2f},'
+                  f'{statistics.median(times):.1f},{p95:.1f}')
+
+
+if __name__ == '__main__':
+    main()
@@ -34,14 +34,17 @@
 #include "enum_to_string.h"
 #include "fft_params.h"
 #include "fftw_transform.h"
+#include "gpu_reference.h"
 #include "gpubuf.h"
 #include "gtest_except.h"
+#include "reference_cache.h"
 #include "rocfft_against_fftw.h"
 #include "test_params.h"
 
 extern int    verbose;
 extern size_t ramgb;
 extern bool   fftw_compare;
+extern bool   gpu_reference_compare;
 
 static const size_t ONE_GiB = 1 << 30;
 
@@ -67,6 +70,10 @@ struct last_cpu_fft_cache
 };
 extern last_cpu_fft_cache last_cpu_fft_data;
 
+// Longer-lived cache of FFTW outputs, addressed by the input's
+// contents, that can also reuse results across non-adjacent tests.
+extern reference_fft_cache reference_cache;
+
 struct system_memory
 {
     size_t total_bytes = 0;
@@ -358,9 +365,12 @@ inline void execute_cpu_fft(fft_params&                                  params,
     apply_load_callback(params, *input_ptr);
     fftw_run<Tfloat>(contiguous_params.transform_type, cpu_plan, *input_ptr, cpu_output);
     // clean up
-    fftw_destroy_plan_type(cpu_plan);
-    // ask FFTW to fully clean up, since it tries to cache plan details
-    fftw_cleanup();
+    fftw_release_plan<Tfloat>(cpu_plan);
+    // ask FFTW to fully clean up, since it tries to cache plan
+    // details.  That would also forget wisdom, and invalidate cached
+    // plans.
+    if(!fftw_state_is_reused())
+        fftw_cleanup();
     cpu_plan = nullptr;
     apply_store_callback(params, cpu_output);
 }
@@ -866,6 +876,199 @@ struct StoreCPUDataToCache
     std::vector<hostbuf>& cpu_output;
 };
 
+// check the norms of a transform's output and its difference from a
+// GPU reference against the same cutoffs as the CPU comparison
+template <class Tparams>
+inline void check_gpu_reference_result(Tparams&                     params,
+                                       const gpu_reference::result& r,
+                                       size_t                       total_length)
+{
+    ASSERT_TRUE(std::isfinite(r.ref.l_2));
+    ASSERT_TRUE(std::isfinite(r.ref.l_inf));
+
+    if(verbose > 1)
+    {
+        std::cout << "GPU reference Linf norm: " << r.ref.l_inf << "\n";
+        std::cout << "GPU reference L2 norm:   " << r.ref.l_2 << "\n";
+        std::cout << "GPU output Linf norm: " << r.out.l_inf << "\n";
+        std::cout << "GPU output L2 norm:   " << r.out.l_2 << "\n";
+        std::cout << "L2 diff: " << r.diff.l_2 << "\n";
+        std::cout << "Linf diff: " << r.diff.l_inf << "\n";
+        std::cout << "GPU linf norm failures:";
+        for(const auto& i : r.failures)
+        {
+            std::cout << " (" << i.first << "," << i.second << ")";
+        }
+        std::cout << std::endl;
+    }
+
+    // norms of a comparison that stopped early only cover part of
+    // the output
+    std::string partial;
+    if(r.compared < r.total)
+        partial = "\tstopped after " + std::to_string(r.compared) + " of "
+                  + std::to_string(r.total) + " elements";
+
+    EXPECT_TRUE(std::isfinite(r.out.l_inf)) << params.str();
+    EXPECT_TRUE(std::isfinite(r.out.l_2)) << params.str();
+
+    const double linf_eps = r.diff.l_inf / r.ref.l_inf / log(total_length);
+    const double l2_eps   = r.diff.l_2 / r.ref.l_2 * sqrt(log2(total_length));
+    switch(params.precision)
+    {
+    case fft_precision_half:
+        max_linf_eps_half = std::max(max_linf_eps_half, linf_eps);
+        max_l2_eps_half   = std::max(max_l2_eps_half, l2_eps);
+        break;
+    case fft_precision_single:
+        max_linf_eps_single = std::max(max_linf_eps_single, linf_eps);
+        max_l2_eps_single   = std::max(max_l2_eps_single, l2_eps);
+        break;
+    case fft_precision_double:
+        max_linf_eps_double = std::max(max_linf_eps_double, linf_eps);
+        max_l2_eps_double   = std::max(max_l2_eps_double, l2_eps);
+        break;
+    }
+
+    const double linf_cutoff = type_epsilon(params.precision) * r.ref.l_inf * log(total_length);
+    EXPECT_TRUE(r.diff.l_inf <= linf_cutoff)
+        << "Linf test failed.  Linf:" << r.diff.l_inf
+        << "\tnormalized Linf: " << r.diff.l_inf / r.ref.l_inf << "\tcutoff: " << linf_cutoff
+        << partial << params.str();
+
+    EXPECT_TRUE(r.diff.l_2 / r.ref.l_2 < sqrt(log2(total_length)) * type_epsilon(params.precision))
+        << "L2 test failed. L2: " << r.diff.l_2 << "\tnormalized L2: " << r.diff.l_2 / r.ref.l_2
+        << "\tepsilon: " << sqrt(log2(total_length)) * type_epsilon(params.precision)
+        << partial << params.str();
+}
+
+// run rocFFT transform with the given params and compare against a
+// reference computed on the GPU.  Only the norms of the output and
+// of the error are copied back to the host.
+template <class Tparams>
+inline void fft_vs_gpu_reference_impl(Tparams& params, bool round_trip)
+{
+    auto runtime_failure = [](std::stringstream&& ss) {
+        ++n_hip_failures;
+        if(skip_runtime_fails)
+            throw ROCFFT_GTEST_SKIP{std::move(ss)};
+        else
+            throw ROCFFT_GTEST_FAIL{std::move(ss)};
+    };
+
+    check_problem_fits_device_memory(params, verbose);
+
+    auto plan_status = fft_status_success;
+    try
+    {
+        plan_status = params.create_plan();
+    }
+    catch(fft_params::work_buffer_alloc_failure& e)
+    {
+        std::stringstream ss;
+        ss << "Work buffer allocation failed with size: " << params.workbuffersize;
+        runtime_failure(std::move(ss));
+    }
+    ASSERT_EQ(plan_status, fft_status_success) << "plan creation failed";
+
+    auto                ibuffer_sizes = params.ibuffer_sizes();
+    std::vector<gpubuf> ibuffer(ibuffer_sizes.size());
+    std::vector<void*>  pibuffer(ibuffer_sizes.size());
+    for(unsigned int i = 0; i < ibuffer.size(); ++i)
+    {
+        auto hip_status = ibuffer[i].alloc(ibuffer_sizes[i]);
+        if(hip_status != hipSuccess)
+        {
+            std::stringstream ss;
+            ss << "hipMalloc failure for input buffer " << i << " size " << ibuffer_sizes[i] << "("
+               << bytes_to_GiB(ibuffer_sizes[i]) << " GiB)"
+               << " with code " << hipError_to_string(hip_status);
+            runtime_failure(std::move(ss));
+        }
+        pibuffer[i] = ibuffer[i].data();
+    }
+
+    std::vector<gpubuf>  obuffer_data;
+    std::vector<gpubuf>* obuffer = &ibuffer;
+    if(params.placement != fft_placement_inplace)
+    {
+        auto obuffer_sizes = params.obuffer_sizes();
+        obuffer_data.resize(obuffer_sizes.size());
+        for(unsigned int i = 0; i < obuffer_data.size(); ++i)
+        {
+            auto hip_status = obuffer_data[i].alloc(obuffer_sizes[i]);
+            if(hip_status != hipSuccess)
+            {
+                std::stringstream ss;
+                ss << "hipMalloc failure for output buffer " << i << " size " << obuffer_sizes[i]
+                   << "(" << bytes_to_GiB(obuffer_sizes[i]) << " GiB)"
+                   << " with code " << hipError_to_string(hip_status);
+                runtime_failure(std::move(ss));
+            }
+        }
+        obuffer = &obuffer_data;
+    }
+    std::vector<void*> pobuffer(obuffer->size());
+    for(unsigned int i = 0; i < obuffer->size(); ++i)
+        pobuffer[i] = obuffer->at(i).data();
+
+    // the reference reads the input before an in-place transform
+    // overwrites it
+    gpu_reference reference(params);
+    params.compute_input(ibuffer);
+    reference.gather_input(params, pibuffer);
+
+    auto fft_status = params.execute(pibuffer.data(), pobuffer.data());
+    if(fft_status != fft_status_success)
+        throw std::runtime_error("rocFFT plan execution failure");
+    params.free();
+
+    reference.transform(params);
+
+    const auto total_length = std::accumulate(params.length.begin(),
+                                              params.length.end(),
+                                              static_cast<size_t>(1),
+                                              std::multiplies<size_t>());
+
+    // stop comparing at the first tile that fails the Linf check
+    const double linf_tolerance = type_epsilon(params.precision) * log(total_length);
+    check_gpu_reference_result(
+        params, reference.compare_output(params, pobuffer, linf_tolerance), total_length);
+
+    if(round_trip)
+    {
+        Tparams params_inverse;
+        params_inverse.inverse_from_forward(params);
+        params_inverse.validate();
+        ASSERT_TRUE(params_inverse.valid(verbose));
+
+        try
+        {
+            plan_status = params_inverse.create_plan();
+        }
+        catch(fft_params::work_buffer_alloc_failure& e)
+        {
+            std::stringstream ss;
+            ss << "Failed to allocate work buffer (size: " << params_inverse.workbuffersize
+               << ")";
+            runtime_failure(std::move(ss));
+        }
+        ASSERT_EQ(plan_status, fft_status_success) << "round trip inverse plan creation failed";
+
+        fft_status = params_inverse.execute(pobuffer.data(), pibuffer.data());
+        if(fft_status != fft_status_success)
+            throw std::runtime_error("rocFFT plan execution failure");
+        params_inverse.free();
+
+        check_gpu_reference_result(params_inverse,
+                                   reference.compare_input(params_inverse,
+                                                           pibuffer,
+                                                           1.0 / total_length,
+                                                           linf_tolerance),
+                                   total_length);
+    }
+}
+
 // run CPU + rocFFT transform with the given params and compare
 template <class Tfloat, class Tparams>
 inline void fft_vs_reference_impl(Tparams& params, bool round_trip)
@@ -877,6 +1080,14 @@ inline void fft_vs_reference_impl(Tparams& params, bool round_trip)
     // Make sure that the parameters make sense:
     ASSERT_TRUE(params.valid(verbose));
 
+    // Where the transform allows it, compute the reference on the
+    // GPU instead of with FFTW
+    if(fftw_compare && gpu_reference_compare && gpu_reference::supported(params))
+    {
+        fft_vs_gpu_reference_impl(params, round_trip);
+        return;
+    }
+
     auto ibuffer_sizes = params.ibuffer_sizes();
     auto obuffer_sizes = params.obuffer_sizes();
 
@@ -1098,6 +1309,7 @@ inline void fft_vs_reference_impl(Tparams& params, bool round_trip)
     }
 
     std::vector<hostbuf> gpu_input_data;
+    std::string          reference_key;
 
     // allocate and populate the input buffer (cpu/gpu)
     if(run_fftw)
@@ -1173,9 +1385,36 @@ inline void fft_vs_reference_impl(Tparams& params, bool round_trip)
                 }
             }
         }
+
+        // The input for this problem is now known, so see if an
+        // earlier test already computed the same reference.
+        if(fftw_compare && reference_cache.enabled())
+        {
+            reference_key = reference_fft_cache::key(params, contiguous_params, cpu_input);
+            if(reference_cache.find(reference_key, cpu_output))
+            {
+                fftw_release_plan<Tfloat>(cpu_plan);
+                cpu_plan = nullptr;
+                run_fftw = false;
+                if(verbose > 1)
+                    std::cout << "Reusing cached reference " << reference_key << std::endl;
+            }
+        }
+    }
+    else if(fftw_compare && !convert_cpu_input_precision.valid())
+    {
+        gpu_input_data = allocate_host_buffer(params.precision, params.itype, ibuffer_sizes_elems);
+
+        // Device generation is seeded by each element's logical
+        // index, so regenerating the input on the GPU reproduces the
+        // cached input in this problem's layout, without reformatting
+        // it on the host and copying it over.
+        params.compute_input(ibuffer);
     }
     else if(fftw_compare)
     {
+        // The cached input was narrowed from a wider precision, which
+        // the generator can't reproduce, so stage it from the host.
         gpu_input_data = allocate_host_buffer(params.precision, params.itype, ibuffer_sizes_elems);
 
         // In case the cached cpu input needed conversion, wait for it
@@ -1456,6 +1695,10 @@ inline void fft_vs_reference_impl(Tparams& params, bool round_trip)
     if(compare_output.valid())
         compare_output.get();
 
+    // a freshly computed reference goes to the persistent cache
+    if(run_fftw && !reference_key.empty())
+        reference_cache.insert(reference_key, cpu_output);
+
     if(!store_to_cache)
         store_to_cache = std::make_unique<StoreCPUDataToCache>(cpu_input, cpu_output);
 
@@ -42,6 +42,13 @@ namespace
         return type == rocfft_array_type_complex_planar
                || type == rocfft_array_type_hermitian_planar;
     }
+    bool transform_type_is_real_to_real(rocfft_transform_type type)
+    {
+        return type == rocfft_transform_type_dct1 || type == rocfft_transform_type_dct2
+               || type == rocfft_transform_type_dct3 || type == rocfft_transform_type_dct4
+               || type == rocfft_transform_type_dst1 || type == rocfft_transform_type_dst2
+               || type == rocfft_transform_type_dst3 || type == rocfft_transform_type_dst4;
+    }
 }
 
 #endif
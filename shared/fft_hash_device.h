@@ -0,0 +1,192 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef FFT_HASH_DEVICE_H
+#define FFT_HASH_DEVICE_H
+
+// Hash a transform's buffer on the device, so that only the digest
+// is copied back to the host.
+//
+// Each element's bits are mixed with its logical index using
+// xxHash64's round and avalanche steps, and the per-element hashes
+// are summed.  Summing is order-independent, so the digest does not
+// depend on how the work is split across threads, and padding
+// between strided elements is never read.
+
+#include "fft_hash.h"
+#include "gpu_reference.h"
+#include <cstdint>
+
+static const uint64_t FFT_HASH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t FFT_HASH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t FFT_HASH_PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t FFT_HASH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t FFT_HASH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+__device__ static uint64_t fft_hash_rotl(const uint64_t x, const unsigned int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+// hash one 64-bit word at a logical index
+__device__ static uint64_t fft_hash_mix(const uint64_t value, const uint64_t index)
+{
+    uint64_t h = FFT_HASH_PRIME64_5 + index * FFT_HASH_PRIME64_1;
+    h ^= fft_hash_rotl(value * FFT_HASH_PRIME64_2, 31) * FFT_HASH_PRIME64_1;
+    h = fft_hash_rotl(h, 27) * FFT_HASH_PRIME64_1 + FFT_HASH_PRIME64_4;
+
+    h ^= h >> 33;
+    h *= FFT_HASH_PRIME64_2;
+    h ^= h >> 29;
+    h *= FFT_HASH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+// Hash the real and imaginary parts of a buffer's elements into
+// digest[0] and digest[1].  Values are widened to double first,
+// which is exact, so the digest reflects the stored bits.
+template <typename Treal>
+__global__ static void __launch_bounds__(GPU_REF_THREADS)
+    fft_hash_device_kernel(const void*          buf0,
+                           const void*          buf1,
+                           const fft_array_type type,
+                           const gpu_ref_layout layout,
+                           const size_t         nbatch,
+                           unsigned long long*  digest)
+{
+    __shared__ unsigned long long block_real[GPU_REF_THREADS];
+    __shared__ unsigned long long block_imag[GPU_REF_THREADS];
+
+    uint64_t     hash_real = 0;
+    uint64_t     hash_imag = 0;
+    const size_t count     = layout.count();
+    for(size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < count * nbatch;
+        i += static_cast<size_t>(gridDim.x) * blockDim.x)
+    {
+        const size_t batch = i / count;
+        size_t       idx[3];
+        gpu_ref_unflatten(layout, i % count, idx);
+
+        size_t pos = batch * layout.dist;
+        for(unsigned int d = 0; d < layout.dim; ++d)
+            pos += idx[d] * layout.stride[d];
+
+        const auto val = gpu_ref_load<Treal>(buf0, buf1, type, layout, pos);
+        hash_real += fft_hash_mix(__double_as_longlong(val.x), i);
+        if(type != fft_array_type_real)
+            hash_imag += fft_hash_mix(__double_as_longlong(val.y), i);
+    }
+
+    block_real[threadIdx.x] = hash_real;
+    block_imag[threadIdx.x] = hash_imag;
+    __syncthreads();
+    for(unsigned int s = blockDim.x / 2; s > 0; s /= 2)
+    {
+        if(threadIdx.x < s)
+        {
+            block_real[threadIdx.x] += block_real[threadIdx.x + s];
+            block_imag[threadIdx.x] += block_imag[threadIdx.x + s];
+        }
+        __syncthreads();
+    }
+    // wrapping addition is commutative, so blocks can be combined in
+    // any order
+    if(threadIdx.x == 0)
+    {
+        atomicAdd(&digest[0], block_real[0]);
+        atomicAdd(&digest[1], block_imag[0]);
+    }
+}
+
+// Hash a device buffer with the given layout.
+static hash_output<size_t> compute_hash_device(const std::vector<void*>&  buffer,
+                                               const fft_precision        precision,
+                                               const fft_array_type       type,
+                                               const std::vector<size_t>& length,
+                                               const std::vector<size_t>& stride,
+                                               const size_t               dist,
+                                               const size_t               nbatch,
+                                               const std::vector<size_t>& offset)
+{
+    const auto layout = gpu_ref_make_layout(length, stride, dist, offset);
+    const auto blocks = gpu_ref_blocks(layout.count() * nbatch);
+    const auto buf1   = buffer.size() > 1 ? buffer[1] : nullptr;
+
+    gpubuf_t<unsigned long long> digest;
+    gpu_ref_check(digest.alloc(2 * sizeof(unsigned long long)), "digest allocation");
+    gpu_ref_check(hipMemset(digest.data(), 0, 2 * sizeof(unsigned long long)), "digest init");
+
+    switch(precision)
+    {
+    case fft_precision_half:
+        hipLaunchKernelGGL(HIP_KERNEL_NAME(fft_hash_device_kernel<_Float16>),
+                           blocks,
+                           GPU_REF_THREADS,
+                           0,
+                           0,
+                           buffer[0],
+                           buf1,
+                           type,
+                           layout,
+                           nbatch,
+                           digest.data());
+        break;
+    case fft_precision_single:
+        hipLaunchKernelGGL(HIP_KERNEL_NAME(fft_hash_device_kernel<float>),
+                           blocks,
+                           GPU_REF_THREADS,
+                           0,
+                           0,
+                           buffer[0],
+                           buf1,
+                           type,
+                           layout,
+                           nbatch,
+                           digest.data());
+        break;
+    case fft_precision_double:
+        hipLaunchKernelGGL(HIP_KERNEL_NAME(fft_hash_device_kernel<double>),
+                           blocks,
+                           GPU_REF_THREADS,
+                           0,
+                           0,
+                           buffer[0],
+                           buf1,
+                           type,
+                           layout,
+                           nbatch,
+                           digest.data());
+        break;
+    }
+    gpu_ref_check(hipGetLastError(), "hash kernel launch");
+
+    unsigned long long host_digest[2] = {};
+    gpu_ref_check(
+        hipMemcpy(host_digest, digest.data(), sizeof(host_digest), hipMemcpyDeviceToHost),
+        "digest copy");
+
+    hash_output<size_t> hash_out;
+    hash_out.buffer_real = host_digest[0];
+    hash_out.buffer_imag = host_digest[1];
+    return hash_out;
+}
+
+#endif // FFT_HASH_DEVICE_H
@@ -220,6 +220,25 @@ inline void fftw_destroy_plan_type<fftw_plan>(fftw_plan plan)
     return fftw_destroy_plan(plan);
 }
 
+// Template wrappers for FFTW buffer alignment queries:
+template <typename Tfloat>
+inline int fftw_alignment_of_type(void* p);
+template <>
+inline int fftw_alignment_of_type<_Float16>(void* p)
+{
+    return fftwf_alignment_of(static_cast<float*>(p));
+}
+template <>
+inline int fftw_alignment_of_type<float>(void* p)
+{
+    return fftwf_alignment_of(static_cast<float*>(p));
+}
+template <>
+inline int fftw_alignment_of_type<double>(void* p)
+{
+    return fftw_alignment_of(static_cast<double*>(p));
+}
+
 // Template wrappers for FFTW c2c planners:
 template <typename Tfloat>
 inline typename fftw_trait<Tfloat>::fftw_plan_type
@@ -0,0 +1,755 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef GPU_REFERENCE_H
+#define GPU_REFERENCE_H
+
+// Reference transforms computed on the device, so that accuracy
+// tests can check a transform without a CPU FFT and without copying
+// whole buffers back to the host.
+//
+// The reference is a naive DFT in double precision, applied one
+// dimension at a time.  That is independent of how rocFFT factors
+// the problem, and accurate enough to check single and half
+// precision transforms.  Only the error norms come back to the host.
+
+#include "../shared/fft_params.h"
+#include "../shared/gpubuf.h"
+#include "../shared/rocfft_complex.h"
+#include <hip/hip_runtime.h>
+#include <hip/hip_runtime_api.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const unsigned int GPU_REF_THREADS = 256;
+static const unsigned int GPU_REF_BLOCKS  = 1024;
+
+// Elements compared per launch.  Comparison stops after the first
+// tile that has an element outside the tolerance.
+static const size_t GPU_REF_TILE = 1 << 24;
+
+// Most failing elements whose indices are copied back to the host.
+static const unsigned int GPU_REF_MAX_FAILURES = 16;
+
+// Longest dimension the naive DFT is used for.  Its cost grows with
+// the product of the problem size and the length of each dimension.
+static const size_t GPU_REF_MAX_LENGTH = 4096;
+
+// Row-major shape and layout of one side of a transform, fastest
+// dimension last
+struct gpu_ref_layout
+{
+    unsigned int dim       = 0;
+    size_t       length[3] = {1, 1, 1};
+    size_t       stride[3] = {0, 0, 0};
+    size_t       dist      = 0;
+    size_t       offset[2] = {0, 0};
+
+    // number of elements in one batch
+    __host__ __device__ size_t count() const
+    {
+        return length[0] * length[1] * length[2];
+    }
+};
+
+static gpu_ref_layout gpu_ref_make_layout(const std::vector<size_t>& length,
+                                          const std::vector<size_t>& stride,
+                                          const size_t               dist,
+                                          const std::vector<size_t>& offset)
+{
+    gpu_ref_layout layout;
+    layout.dim = length.size();
+    for(unsigned int d = 0; d < layout.dim; ++d)
+    {
+        layout.length[d] = length[d];
+        layout.stride[d] = d < stride.size() ? stride[d] : 0;
+    }
+    layout.dist = dist;
+    for(unsigned int i = 0; i < 2 && i < offset.size(); ++i)
+        layout.offset[i] = offset[i];
+    return layout;
+}
+
+// contiguous layout of the full logical length of a transform
+static gpu_ref_layout gpu_ref_contiguous_layout(const std::vector<size_t>& length)
+{
+    std::vector<size_t> stride(length.size(), 1);
+    for(size_t d = length.size() - 1; d > 0; --d)
+        stride[d - 1] = stride[d] * length[d];
+    return gpu_ref_make_layout(
+        length, stride, stride.front() * length.front(), std::vector<size_t>{0});
+}
+
+// split a row-major index within one batch into per-dimension indexes
+__device__ static void gpu_ref_unflatten(const gpu_ref_layout& layout, size_t i, size_t idx[3])
+{
+    for(unsigned int d = layout.dim; d-- > 0;)
+    {
+        idx[d] = i % layout.length[d];
+        i /= layout.length[d];
+    }
+}
+
+// read one element of a buffer of the given type as double complex,
+// from position pos past the layout's offset(s)
+template <typename Treal>
+__device__ static rocfft_complex<double> gpu_ref_load(const void*           buf0,
+                                                      const void*           buf1,
+                                                      const fft_array_type  type,
+                                                      const gpu_ref_layout& layout,
+                                                      const size_t          pos)
+{
+    switch(type)
+    {
+    case fft_array_type_complex_interleaved:
+    case fft_array_type_hermitian_interleaved:
+    {
+        auto val = static_cast<const rocfft_complex<Treal>*>(buf0)[pos + layout.offset[0]];
+        return {static_cast<double>(val.x), static_cast<double>(val.y)};
+    }
+    case fft_array_type_complex_planar:
+    case fft_array_type_hermitian_planar:
+        return {static_cast<double>(static_cast<const Treal*>(buf0)[pos + layout.offset[0]]),
+                static_cast<double>(static_cast<const Treal*>(buf1)[pos + layout.offset[1]])};
+    default:
+        return {static_cast<double>(static_cast<const Treal*>(buf0)[pos + layout.offset[0]]),
+                0.0};
+    }
+}
+
+// Copy a transform's input to a contiguous double-precision complex
+// buffer of its full logical length.  Hermitian input is expanded
+// to the full length using its symmetry.
+template <typename Treal>
+__global__ static void __launch_bounds__(GPU_REF_THREADS)
+    gpu_ref_gather_kernel(const void*             in0,
+                          const void*             in1,
+                          const fft_array_type    itype,
+                          const gpu_ref_layout    in,
+                          const gpu_ref_layout    full,
+                          const size_t            nbatch,
+                          rocfft_complex<double>* ref)
+{
+    const bool   hermitian = itype == fft_array_type_hermitian_interleaved
+                           || itype == fft_array_type_hermitian_planar;
+    const auto   last      = full.dim - 1;
+    const size_t count     = full.count();
+    for(size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < count * nbatch;
+        i += static_cast<size_t>(gridDim.x) * blockDim.x)
+    {
+        size_t idx[3];
+        gpu_ref_unflatten(full, i % count, idx);
+
+        // the upper half of the fastest dimension is the conjugate of
+        // the element mirrored through the origin
+        bool conjugate = false;
+        if(hermitian && idx[last] > full.length[last] / 2)
+        {
+            for(unsigned int d = 0; d < full.dim; ++d)
+                idx[d] = (full.length[d] - idx[d]) % full.length[d];
+            conjugate = true;
+        }
+
+        size_t pos = (i / count) * in.dist;
+        for(unsigned int d = 0; d < full.dim; ++d)
+            pos += idx[d] * in.stride[d];
+
+        auto val = gpu_ref_load<Treal>(in0, in1, itype, in, pos);
+        if(conjugate)
+            val.y = -val.y;
+        ref[i] = val;
+    }
+}
+
+// Naive DFT along dimension d of a contiguous double-precision
+// complex buffer, scaling the result by scale.
+__global__ static void __launch_bounds__(GPU_REF_THREADS)
+    gpu_ref_dft_kernel(const rocfft_complex<double>* in,
+                       rocfft_complex<double>*       out,
+                       const gpu_ref_layout          full,
+                       const size_t                  nbatch,
+                       const unsigned int            d,
+                       const int                     sign,
+                       const double                  scale)
+{
+    const size_t n      = full.length[d];
+    const size_t stride = full.stride[d];
+    const size_t total  = full.count() * nbatch;
+    for(size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < total;
+        i += static_cast<size_t>(gridDim.x) * blockDim.x)
+    {
+        const size_t k    = (i / stride) % n;
+        const size_t base = i - k * stride;
+
+        // (j * k) mod n keeps the twiddle angles exact
+        double re = 0.0;
+        double im = 0.0;
+        for(size_t j = 0, jk = 0; j < n; ++j)
+        {
+            double s, c;
+            sincospi(2.0 * static_cast<double>(jk) / static_cast<double>(n), &s, &c);
+            s *= sign;
+
+            const auto x = in[base + j * stride];
+            re += x.x * c - x.y * s;
+            im += x.x * s + x.y * c;
+
+            jk += k;
+            if(jk >= n)
+                jk -= n;
+        }
+        out[i] = {re * scale, im * scale};
+    }
+}
+
+// Norms of a reference, a transform's output, and their difference,
+// as reduced by one block.  This has no default member initializers
+// since it's used in shared memory.
+struct gpu_ref_partial
+{
+    double ref_linf;
+    double ref_l2;
+    double out_linf;
+    double out_l2;
+    double diff_linf;
+    double diff_l2;
+};
+
+// max that keeps NaN, so that a non-finite output fails the
+// comparison instead of disappearing from it
+__host__ __device__ static void gpu_ref_max(double& m, const double v)
+{
+    if(!(v <= m))
+        m = v;
+}
+
+__host__ __device__ static void gpu_ref_combine(gpu_ref_partial& a, const gpu_ref_partial& b)
+{
+    gpu_ref_max(a.ref_linf, b.ref_linf);
+    gpu_ref_max(a.out_linf, b.out_linf);
+    gpu_ref_max(a.diff_linf, b.diff_linf);
+    a.ref_l2 += b.ref_l2;
+    a.out_l2 += b.out_l2;
+    a.diff_l2 += b.diff_l2;
+}
+
+// returns the absolute difference
+__device__ static double gpu_ref_accumulate(gpu_ref_partial& p, const double ref, const double out)
+{
+    const double diff = fabs(out - ref);
+    gpu_ref_max(p.ref_linf, fabs(ref));
+    gpu_ref_max(p.out_linf, fabs(out));
+    gpu_ref_max(p.diff_linf, diff);
+    p.ref_l2 += ref * ref;
+    p.out_l2 += out * out;
+    p.diff_l2 += diff * diff;
+    return diff;
+}
+
+// (batch, element) indices of the first few elements that were
+// outside the tolerance
+struct gpu_ref_failures
+{
+    unsigned int count;
+    size_t       batch[GPU_REF_MAX_FAILURES];
+    size_t       index[GPU_REF_MAX_FAILURES];
+};
+
+// Linf norm of a contiguous reference, reduced per block.  Only the
+// real parts are considered if real_only is set.
+__global__ static void __launch_bounds__(GPU_REF_THREADS)
+    gpu_ref_linf_kernel(const rocfft_complex<double>* ref,
+                        const size_t                  count,
+                        const bool                    real_only,
+                        double*                       partials)
+{
+    __shared__ double block[GPU_REF_THREADS];
+
+    double linf = 0.0;
+    for(size_t i = static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < count;
+        i += static_cast<size_t>(gridDim.x) * blockDim.x)
+    {
+        gpu_ref_max(linf, fabs(ref[i].x));
+        if(!real_only)
+            gpu_ref_max(linf, fabs(ref[i].y));
+    }
+
+    block[threadIdx.x] = linf;
+    __syncthreads();
+    for(unsigned int s = blockDim.x / 2; s > 0; s /= 2)
+    {
+        if(threadIdx.x < s)
+            gpu_ref_max(block[threadIdx.x], block[threadIdx.x + s]);
+        __syncthreads();
+    }
+    if(threadIdx.x == 0)
+        partials[blockIdx.x] = block[0];
+}
+
+// Compare elements [begin, end) of a transform's output with a
+// contiguous full-length reference.  Output values are multiplied
+// by out_scale.  Real output is compared with the reference's real
+// part.
+//
+// Elements that differ by more than a non-negative linf_cutoff are
+// recorded in failures, and threads stop early once enough failures
+// have been recorded.
+template <typename Treal>
+__global__ static void __launch_bounds__(GPU_REF_THREADS)
+    gpu_ref_compare_kernel(const void*                   out0,
+                           const void*                   out1,
+                           const fft_array_type          otype,
+                           const gpu_ref_layout          out,
+                           const gpu_ref_layout          full,
+                           const size_t                  begin,
+                           const size_t                  end,
+                           const rocfft_complex<double>* ref,
+                           const double                  out_scale,
+                           const double                  linf_cutoff,
+                           gpu_ref_partial*              partials,
+                           gpu_ref_failures*             failures)
+{
+    __shared__ gpu_ref_partial block[GPU_REF_THREADS];
+
+    gpu_ref_partial p     = {};
+    const size_t    count = out.count();
+    for(size_t i = begin + static_cast<size_t>(blockIdx.x) * blockDim.x + threadIdx.x; i < end;
+        i += static_cast<size_t>(gridDim.x) * blockDim.x)
+    {
+        if(*static_cast<volatile unsigned int*>(&failures->count) >= GPU_REF_MAX_FAILURES)
+            break;
+
+        const size_t batch = i / count;
+        size_t       idx[3];
+        gpu_ref_unflatten(out, i % count, idx);
+
+        size_t pos  = batch * out.dist;
+        size_t rpos = batch * full.dist;
+        for(unsigned int d = 0; d < out.dim; ++d)
+        {
+            pos += idx[d] * out.stride[d];
+            rpos += idx[d] * full.stride[d];
+        }
+
+        const auto val  = gpu_ref_load<Treal>(out0, out1, otype, out, pos);
+        double     diff = gpu_ref_accumulate(p, ref[rpos].x, val.x * out_scale);
+        if(otype != fft_array_type_real)
+            gpu_ref_max(diff, gpu_ref_accumulate(p, ref[rpos].y, val.y * out_scale));
+
+        if(linf_cutoff >= 0.0 && !(diff <= linf_cutoff))
+        {
+            const auto slot = atomicAdd(&failures->count, 1u);
+            if(slot < GPU_REF_MAX_FAILURES)
+            {
+                failures->batch[slot] = batch;
+                failures->index[slot] = i % count;
+            }
+        }
+    }
+
+    block[threadIdx.x] = p;
+    __syncthreads();
+    for(unsigned int s = blockDim.x / 2; s > 0; s /= 2)
+    {
+        if(threadIdx.x < s)
+            gpu_ref_combine(block[threadIdx.x], block[threadIdx.x + s]);
+        __syncthreads();
+    }
+    if(threadIdx.x == 0)
+        partials[blockIdx.x] = block[0];
+}
+
+static void gpu_ref_check(const hipError_t ret, const char* what)
+{
+    if(ret != hipSuccess)
+        throw std::runtime_error(std::string("GPU reference: ") + what + " failed with error "
+                                 + std::to_string(ret));
+}
+
+static unsigned int gpu_ref_blocks(const size_t elems)
+{
+    return std::min<size_t>(GPU_REF_BLOCKS, DivRoundingUp<size_t>(elems, GPU_REF_THREADS));
+}
+
+class gpu_reference
+{
+public:
+    // Norms of the reference, of the transform's output, and of
+    // their difference
+    struct result
+    {
+        VectorNorms ref;
+        VectorNorms out;
+        VectorNorms diff;
+        // (batch, element) indices of the first few elements outside
+        // the tolerance
+        std::vector<std::pair<size_t, size_t>> failures;
+        // number of elements compared, which is less than total if
+        // the comparison stopped early
+        size_t compared = 0;
+        size_t total    = 0;
+    };
+
+    // Return true if a transform with these parameters can be checked
+    // against a reference computed on the device.  The reference must
+    // be in a higher precision than the transform, and features that
+    // need the host to model them (callbacks, fields across devices,
+    // checking untouched output) use the CPU reference instead.
+    static bool supported(fft_params& params)
+    {
+        if(params.precision == fft_precision_double || params.run_callbacks
+           || params.check_output_strides || !params.ifields.empty() || !params.ofields.empty()
+           || params.mp_lib != fft_params::fft_mp_lib_none || params.length.empty()
+           || params.length.size() > 3)
+            return false;
+        for(auto len : params.length)
+            if(len > GPU_REF_MAX_LENGTH)
+                return false;
+
+        // the input, output and (for multi-D) scratch references must
+        // fit next to the transform's own buffers
+        size_t free  = 0;
+        size_t total = 0;
+        if(hipMemGetInfo(&free, &total) != hipSuccess)
+            return false;
+        return reference_bytes(params) + params.vram_footprint() < free;
+    }
+
+    explicit gpu_reference(const fft_params& params)
+        : full(gpu_ref_contiguous_layout(params.length))
+        , nbatch(params.nbatch)
+    {
+        const size_t bytes = full.count() * nbatch * sizeof(rocfft_complex<double>);
+        gpu_ref_check(input.alloc(bytes), "input allocation");
+        gpu_ref_check(output.alloc(bytes), "output allocation");
+        if(full.dim > 1)
+            gpu_ref_check(scratch.alloc(bytes), "scratch allocation");
+    }
+
+    // copy the transform's input out of its (device) input buffers
+    void gather_input(const fft_params& params, const std::vector<void*>& ibuffer)
+    {
+        const auto in = gpu_ref_make_layout(
+            params.ilength(), params.istride, params.idist, params.ioffset);
+        const void* in1    = ibuffer.size() > 1 ? ibuffer[1] : nullptr;
+        const auto  blocks = gpu_ref_blocks(full.count() * nbatch);
+        switch(params.precision)
+        {
+        case fft_precision_half:
+            hipLaunchKernelGGL(HIP_KERNEL_NAME(gpu_ref_gather_kernel<_Float16>),
+                               blocks,
+                               GPU_REF_THREADS,
+                               0,
+                               0,
+                               ibuffer[0],
+                               in1,
+                               params.itype,
+                               in,
+                               full,
+                               nbatch,
+                               input.data());
+            break;
+        case fft_precision_single:
+            hipLaunchKernelGGL(HIP_KERNEL_NAME(gpu_ref_gather_kernel<float>),
+                               blocks,
+                               GPU_REF_THREADS,
+                               0,
+                               0,
+                               ibuffer[0],
+                               in1,
+                               params.itype,
+                               in,
+                               full,
+                               nbatch,
+                               input.data());
+            break;
+        case fft_precision_double:
+            hipLaunchKernelGGL(HIP_KERNEL_NAME(gpu_ref_gather_kernel<double>),
+                               blocks,
+                               GPU_REF_THREADS,
+                               0,
+                               0,
+                               ibuffer[0],
+                               in1,
+                               params.itype,
+                               in,
+                               full,
+                               nbatch,
+                               input.data());
+            break;
+        }
+        gpu_ref_check(hipGetLastError(), "gather kernel launch");
+    }
+
+    // compute the reference output from the gathered input
+    void transform(const fft_params& params)
+    {
+        const int sign = (params.transform_type == fft_transform_type_complex_forward
+                          || params.transform_type == fft_transform_type_real_forward)
+                             ? -1
+                             : 1;
+
+        // ping-pong between scratch and output so that the last
+        // dimension lands in output, and input is kept for a round
+        // trip's comparison
+        const rocfft_complex<double>* src = input.data();
+        for(unsigned int d = 0; d < full.dim; ++d)
+        {
+            const bool last  = d == full.dim - 1;
+            auto       dst   = ((full.dim - 1 - d) % 2 == 0) ? output.data() : scratch.data();
+            const auto scale = last ? params.scale_factor : 1.0;
+            hipLaunchKernelGGL(gpu_ref_dft_kernel,
+                               gpu_ref_blocks(full.count() * nbatch),
+                               GPU_REF_THREADS,
+                               0,
+                               0,
+                               src,
+                               dst,
+                               full,
+                               nbatch,
+                               d,
+                               sign,
+                               scale);
+            gpu_ref_check(hipGetLastError(), "DFT kernel launch");
+            src = dst;
+        }
+    }
+
+    // Compare the output of the transform described by params with
+    // the reference output.  If linf_tolerance is positive, the
+    // comparison stops once an element differs by more than
+    // linf_tolerance times the reference's Linf norm.
+    result compare_output(const fft_params&         params,
+                          const std::vector<void*>& obuffer,
+                          const double              linf_tolerance = 0.0)
+    {
+        return compare(params, obuffer, output.data(), 1.0, linf_tolerance);
+    }
+
+    // compare the output of a round trip's inverse transform with the
+    // gathered input, after multiplying the output by out_scale
+    result compare_input(const fft_params&         params_inverse,
+                         const std::vector<void*>& obuffer,
+                         const double              out_scale,
+                         const double              linf_tolerance = 0.0)
+    {
+        return compare(params_inverse, obuffer, input.data(), out_scale, linf_tolerance);
+    }
+
+private:
+    gpu_ref_layout                   full;
+    size_t                           nbatch;
+    gpubuf_t<rocfft_complex<double>> input;
+    gpubuf_t<rocfft_complex<double>> output;
+    gpubuf_t<rocfft_complex<double>> scratch;
+
+    static size_t reference_bytes(const fft_params& params)
+    {
+        size_t elems = params.nbatch;
+        for(auto len : params.length)
+            elems *= len;
+        return elems * sizeof(rocfft_complex<double>) * (params.length.size() > 1 ? 3 : 2);
+    }
+
+    // Linf norm of a reference buffer
+    double reference_linf(const rocfft_complex<double>* ref, const bool real_only) const
+    {
+        const size_t count  = full.count() * nbatch;
+        const auto   blocks = gpu_ref_blocks(count);
+
+        gpubuf_t<double> partials;
+        gpu_ref_check(partials.alloc(blocks * sizeof(double)), "partials allocation");
+        hipLaunchKernelGGL(gpu_ref_linf_kernel,
+                           blocks,
+                           GPU_REF_THREADS,
+                           0,
+                           0,
+                           ref,
+                           count,
+                           real_only,
+                           partials.data());
+        gpu_ref_check(hipGetLastError(), "norm kernel launch");
+
+        std::vector<double> host_partials(blocks);
+        gpu_ref_check(hipMemcpy(host_partials.data(),
+                                partials.data(),
+                                blocks * sizeof(double),
+                                hipMemcpyDeviceToHost),
+                      "partials copy");
+        double linf = 0.0;
+        for(auto h : host_partials)
+            gpu_ref_max(linf, h);
+        return linf;
+    }
+
+    template <typename Treal>
+    static void launch_compare(const unsigned int            blocks,
+                               const fft_params&             params,
+                               const std::vector<void*>&     obuffer,
+                               const gpu_ref_layout&         out,
+                               const gpu_ref_layout&         full,
+                               const size_t                  begin,
+                               const size_t                  end,
+                               const rocfft_complex<double>* ref,
+                               const double                  out_scale,
+                               const double                  linf_cutoff,
+                               gpu_ref_partial*              partials,
+                               gpu_ref_failures*             failures)
+    {
+        hipLaunchKernelGGL(HIP_KERNEL_NAME(gpu_ref_compare_kernel<Treal>),
+                           blocks,
+                           GPU_REF_THREADS,
+                           0,
+                           0,
+                           obuffer[0],
+                           obuffer.size() > 1 ? obuffer[1] : nullptr,
+                           params.otype,
+                           out,
+                           full,
+                           begin,
+                           end,
+                           ref,
+                           out_scale,
+                           linf_cutoff,
+                           partials,
+                           failures);
+    }
+
+    result compare(const fft_params&             params,
+                   const std::vector<void*>&     obuffer,
+                   const rocfft_complex<double>* ref,
+                   const double                  out_scale,
+                   const double                  linf_tolerance)
+    {
+        const auto out = gpu_ref_make_layout(
+            params.olength(), params.ostride, params.odist, params.ooffset);
+        const size_t total = out.count() * nbatch;
+
+        // a negative cutoff disables early exit
+        double ref_linf    = 0.0;
+        double linf_cutoff = -1.0;
+        if(linf_tolerance > 0.0)
+        {
+            ref_linf    = reference_linf(ref, params.otype == fft_array_type_real);
+            linf_cutoff = linf_tolerance * ref_linf;
+        }
+
+        gpubuf_t<gpu_ref_partial> partials;
+        gpu_ref_check(partials.alloc(gpu_ref_blocks(std::min(total, GPU_REF_TILE))
+                                     * sizeof(gpu_ref_partial)),
+                      "partials allocation");
+        gpubuf_t<gpu_ref_failures> failures;
+        gpu_ref_check(failures.alloc(sizeof(gpu_ref_failures)), "failures allocation");
+        gpu_ref_check(hipMemset(failures.data(), 0, sizeof(gpu_ref_failures)), "failures init");
+
+        gpu_ref_partial  p             = {};
+        gpu_ref_failures host_failures = {};
+        size_t           begin         = 0;
+        while(begin < total && host_failures.count == 0)
+        {
+            const size_t end    = std::min(total, begin + GPU_REF_TILE);
+            const auto   blocks = gpu_ref_blocks(end - begin);
+            switch(params.precision)
+            {
+            case fft_precision_half:
+                launch_compare<_Float16>(blocks,
+                                         params,
+                                         obuffer,
+                                         out,
+                                         full,
+                                         begin,
+                                         end,
+                                         ref,
+                                         out_scale,
+                                         linf_cutoff,
+                                         partials.data(),
+                                         failures.data());
+                break;
+            case fft_precision_single:
+                launch_compare<float>(blocks,
+                                      params,
+                                      obuffer,
+                                      out,
+                                      full,
+                                      begin,
+                                      end,
+                                      ref,
+                                      out_scale,
+                                      linf_cutoff,
+                                      partials.data(),
+                                      failures.data());
+                break;
+            case fft_precision_double:
+                launch_compare<double>(blocks,
+                                       params,
+                                       obuffer,
+                                       out,
+                                       full,
+                                       begin,
+                                       end,
+                                       ref,
+                                       out_scale,
+                                       linf_cutoff,
+                                       partials.data(),
+                                       failures.data());
+                break;
+            }
+            gpu_ref_check(hipGetLastError(), "compare kernel launch");
+
+            // only one partial result per block, and the failures,
+            // come back to the host
+            std::vector<gpu_ref_partial> host_partials(blocks);
+            gpu_ref_check(hipMemcpy(host_partials.data(),
+                                    partials.data(),
+                                    blocks * sizeof(gpu_ref_partial),
+                                    hipMemcpyDeviceToHost),
+                          "partials copy");
+            for(const auto& h : host_partials)
+                gpu_ref_combine(p, h);
+            gpu_ref_check(hipMemcpy(&host_failures,
+                                    failures.data(),
+                                    sizeof(gpu_ref_failures),
+                                    hipMemcpyDeviceToHost),
+                          "failures copy");
+            begin = end;
+        }
+
+        result r;
+        r.ref  = {.l_2 = sqrt(p.ref_l2), .l_inf = p.ref_linf};
+        r.out  = {.l_2 = sqrt(p.out_l2), .l_inf = p.out_linf};
+        r.diff = {.l_2 = sqrt(p.diff_l2), .l_inf = p.diff_linf};
+        for(unsigned int i = 0; i < std::min(host_failures.count, GPU_REF_MAX_FAILURES); ++i)
+            r.failures.emplace_back(host_failures.batch[i], host_failures.index[i]);
+        std::sort(r.failures.begin(), r.failures.end());
+        r.compared = begin;
+        r.total    = total;
+
+        // report the whole reference's Linf norm if the comparison
+        // stopped early, so the cutoff it stopped at is reproduced
+        if(r.compared < r.total)
+            r.ref.l_inf = ref_linf;
+        return r;
+    }
+};
+
+#endif
@@ -40,6 +40,15 @@ struct hip_object_wrapper_t
             throw std::runtime_error("hip create failure");
     }
 
+    // allocate with another creation function, e.g. one that takes
+    // flags or a priority
+    template <typename TCreateWith>
+    void alloc_with(TCreateWith create)
+    {
+        if(obj == nullptr && create(&obj) != hipSuccess)
+            throw std::runtime_error("hip create failure");
+    }
+
     void free()
     {
         if(obj)
@@ -82,5 +91,7 @@ private:
 
 typedef hip_object_wrapper_t<hipStream_t, hipStreamCreate, hipStreamDestroy> hipStream_wrapper_t;
 typedef hip_object_wrapper_t<hipEvent_t, hipEventCreate, hipEventDestroy>    hipEvent_wrapper_t;
+// graph executables are instantiated from a graph with alloc_with
+typedef hip_object_wrapper_t<hipGraphExec_t, nullptr, hipGraphExecDestroy> hipGraphExec_wrapper_t;
 
 #endif // ROCFFT_HIP_OBJ_WRAPPER_H
@@ -0,0 +1,157 @@
+/******************************************************************************
+* Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+* THE SOFTWARE.
+*******************************************************************************/
+
+#ifndef ROCFFT_POWER_SAMPLER_H
+#define ROCFFT_POWER_SAMPLER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "rocfft_hip.h"
+
+// Return the amdgpu driver's sysfs directory for a HIP device, or
+// empty if it can't be found.
+static std::string gpu_sysfs_dir(int deviceId)
+{
+#ifdef WIN32
+    return {};
+#else
+    char bus_id[64] = {};
+    if(hipDeviceGetPCIBusId(bus_id, sizeof(bus_id), deviceId) != hipSuccess)
+        return {};
+    std::string dir = std::string("/sys/bus/pci/devices/") + bus_id;
+    std::transform(
+        dir.begin(), dir.end(), dir.begin(), [](unsigned char c) { return std::tolower(c); });
+    return std::filesystem::exists(dir) ? dir : std::string();
+#endif
+}
+
+// Polls a GPU's power draw from the driver's hwmon files on a
+// background thread, so that energy can be attributed to intervals
+// of host time.
+class power_sampler
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    explicit power_sampler(int                       deviceId,
+                           std::chrono::microseconds period = std::chrono::microseconds(1000))
+    {
+        auto dir = gpu_sysfs_dir(deviceId);
+        if(dir.empty())
+            return;
+        std::error_code ec;
+        for(const auto& hwmon : std::filesystem::directory_iterator(dir + "/hwmon", ec))
+        {
+            for(const char* sensor : {"power1_average", "power1_input"})
+            {
+                auto path = hwmon.path() / sensor;
+                if(std::filesystem::exists(path))
+                {
+                    power_path = path.string();
+                    break;
+                }
+            }
+            if(!power_path.empty())
+                break;
+        }
+        if(power_path.empty())
+            return;
+
+        thread = std::thread([this, period]() {
+            while(!done)
+            {
+                // the driver reports microwatts
+                std::ifstream in(power_path);
+                double        microwatts = 0.0;
+                if(in >> microwatts)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    samples.emplace_back(clock::now(), microwatts / 1e6);
+                }
+                std::this_thread::sleep_for(period);
+            }
+        });
+    }
+    ~power_sampler()
+    {
+        done = true;
+        if(thread.joinable())
+            thread.join();
+    }
+    power_sampler(const power_sampler&) = delete;
+    power_sampler& operator=(const power_sampler&) = delete;
+
+    // true if the GPU's power can be read
+    bool valid() const
+    {
+        return !power_path.empty();
+    }
+
+    // Mean power in watts over [begin, end], or NaN if nothing was
+    // sampled by end.  If no sample falls in the interval, the last
+    // one before it is used.  Samples older than begin are dropped,
+    // so intervals are expected to be queried in increasing order.
+    double average_watts(clock::time_point begin, clock::time_point end)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto first = std::find_if(samples.begin(), samples.end(), [&](const auto& s) {
+            return s.first >= begin;
+        });
+        double sum   = 0.0;
+        size_t count = 0;
+        for(auto s = first; s != samples.end() && s->first <= end; ++s, ++count)
+            sum += s->second;
+
+        double watts = std::numeric_limits<double>::quiet_NaN();
+        if(count)
+            watts = sum / count;
+        else if(first != samples.begin())
+            watts = std::prev(first)->second;
+
+        // keep the last sample before begin for later queries
+        if(first != samples.begin())
+            samples.erase(samples.begin(), std::prev(first));
+        return watts;
+    }
+
+private:
+    std::string                                       power_path;
+    std::mutex                                        mutex;
+    std::vector<std::pair<clock::time_point, double>> samples;
+    std::atomic<bool>                                 done{false};
+    std::thread                                       thread;
+};
+
+#endif
@@ -0,0 +1,243 @@
+// Copyright (C) 2024 Advanced Micro Devices, Inc. All rights reserved.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ROCFFT_REFERENCE_CACHE_H
+#define ROCFFT_REFERENCE_CACHE_H
+
+#include <complex>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <list>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "fft_hash.h"
+#include "fft_params.h"
+#include "hostbuf.h"
+#include "precision_type.h"
+#include "rocfft_params.h"
+
+// Content-addressed cache of reference (FFTW) outputs.
+//
+// Entries are keyed by a hash of the contiguous CPU input plus the
+// parameters that affect the reference output, so that placement
+// and stride variants of the same logical problem share one entry.
+// Entries are kept in memory up to a byte budget (least recently
+// used are evicted first), and can optionally be persisted to a
+// directory so that later runs can reuse them.
+class reference_fft_cache
+{
+public:
+    // in-memory budget in bytes; 0 disables the in-memory cache
+    size_t max_bytes = 0;
+    // directory to persist entries to; empty disables the disk cache
+    std::string directory;
+
+    bool enabled() const
+    {
+        return max_bytes > 0 || !directory.empty();
+    }
+
+    // Compute the cache key for a problem, given its contiguous
+    // input on the host.
+    static std::string key(const fft_params&           params,
+                           const fft_params&           contiguous_params,
+                           const std::vector<hostbuf>& cpu_input)
+    {
+        hash_input hash_in(rocfft_precision_from_fftparams(contiguous_params.precision),
+                           contiguous_params.ilength(),
+                           contiguous_params.istride,
+                           contiguous_params.idist,
+                           rocfft_array_type_from_fftparams(contiguous_params.itype),
+                           contiguous_params.nbatch);
+        hash_output<size_t> hash_out;
+        compute_hash(cpu_input, hash_in, hash_out);
+
+        std::stringstream ss;
+        ss << std::hex << hash_out.buffer_real << "_" << hash_out.buffer_imag << std::dec << "_"
+           << params.transform_type_name() << "_len";
+        for(auto len : params.length)
+            ss << "_" << len;
+        ss << "_batch_" << params.nbatch << "_" << precision_name(hash_in.buf_precision)
+           << "_scale_" << params.scale_factor;
+        if(params.run_callbacks)
+            ss << "_CB";
+        return ss.str();
+    }
+
+    // Look up an entry, copying its output to cpu_output.  Returns
+    // true if the entry was found.
+    bool find(const std::string& k, std::vector<hostbuf>& cpu_output)
+    {
+        auto it = entries.find(k);
+        if(it != entries.end())
+        {
+            lru.splice(lru.begin(), lru, it->second.lru_pos);
+            copy_out(it->second.output, cpu_output);
+            ++hits;
+            return true;
+        }
+
+        if(load(k, cpu_output))
+        {
+            ++hits;
+            insert_memory(k, cpu_output);
+            return true;
+        }
+        return false;
+    }
+
+    // Store an entry in memory and, if enabled, on disk.
+    void insert(const std::string& k, const std::vector<hostbuf>& cpu_output)
+    {
+        if(!directory.empty())
+            save(k, cpu_output);
+        insert_memory(k, cpu_output);
+    }
+
+    void clear()
+    {
+        entries.clear();
+        lru.clear();
+        cur_bytes = 0;
+    }
+
+    size_t hits = 0;
+
+private:
+    struct entry
+    {
+        std::vector<hostbuf>             output;
+        size_t                           bytes = 0;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    std::map<std::string, entry> entries;
+    // most recently used keys first
+    std::list<std::string> lru;
+    size_t                 cur_bytes = 0;
+
+    static void copy_out(const std::vector<hostbuf>& src, std::vector<hostbuf>& dst)
+    {
+        dst.resize(src.size());
+        for(size_t i = 0; i < src.size(); ++i)
+        {
+            if(dst[i].size() != src[i].size())
+                dst[i].alloc(src[i].size());
+            memcpy(dst[i].data(), src[i].data(), src[i].size());
+        }
+    }
+
+    void insert_memory(const std::string& k, const std::vector<hostbuf>& cpu_output)
+    {
+        size_t bytes = 0;
+        for(const auto& buf : cpu_output)
+            bytes += buf.size();
+        if(bytes > max_bytes || entries.count(k))
+            return;
+
+        // evict least recently used entries to make room
+        while(cur_bytes + bytes > max_bytes && !lru.empty())
+        {
+            auto victim = entries.find(lru.back());
+            cur_bytes -= victim->second.bytes;
+            entries.erase(victim);
+            lru.pop_back();
+        }
+
+        lru.push_front(k);
+        auto& e   = entries[k];
+        e.bytes   = bytes;
+        e.lru_pos = lru.begin();
+        for(const auto& buf : cpu_output)
+            e.output.emplace_back(buf.copy());
+        cur_bytes += bytes;
+    }
+
+    // entries are stored in files named by a hash of the key; the
+    // full key is written at the start of the file to guard against
+    // collisions
+    std::filesystem::path path(const std::string& k) const
+    {
+        std::stringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>{}(k)
+           << ".ref";
+        return std::filesystem::path(directory) / ss.str();
+    }
+
+    void save(const std::string& k, const std::vector<hostbuf>& cpu_output) const
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+
+        // write to a temporary file and rename, so that concurrent
+        // test processes never see a partial entry
+        auto          final_path = path(k);
+        auto          tmp_path   = final_path.string() + ".tmp";
+        std::ofstream out(tmp_path, std::ios::binary);
+        if(!out)
+            return;
+        out << k << "\n" << cpu_output.size() << "\n";
+        for(const auto& buf : cpu_output)
+            out << buf.size() << "\n";
+        for(const auto& buf : cpu_output)
+            out.write(static_cast<const char*>(buf.data()), buf.size());
+        out.close();
+        if(out)
+            std::filesystem::rename(tmp_path, final_path, ec);
+        else
+            std::filesystem::remove(tmp_path, ec);
+    }
+
+    bool load(const std::string& k, std::vector<hostbuf>& cpu_output) const
+    {
+        if(directory.empty())
+            return false;
+        std::ifstream in(path(k), std::ios::binary);
+        if(!in)
+            return false;
+
+        std::string file_key;
+        size_t      nbuf = 0;
+        if(!std::getline(in, file_key) || file_key != k || !(in >> nbuf))
+            return false;
+        std::vector<size_t> sizes(nbuf);
+        for(auto& s : sizes)
+            if(!(in >> s))
+                return false;
+        in.ignore(1);
+
+        std::vector<hostbuf> bufs(nbuf);
+        for(size_t i = 0; i < nbuf; ++i)
+        {
+            bufs[i].alloc(sizes[i]);
+            if(!in.read(static_cast<char*>(bufs[i].data()), sizes[i]))
+                return false;
+        }
+        cpu_output.swap(bufs);
+        return true;
+    }
+};
+
+#endif
@@ -22,8 +22,11 @@
 #ifndef ROCFFT_AGAINST_FFTW
 #define ROCFFT_AGAINST_FFTW
 
+#include <list>
+#include <map>
 #include <math.h>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "fftw_transform.h"
@@ -43,18 +46,93 @@ inline fft_precision precision_selector<double>()
 }
 
 extern bool use_fftw_wisdom;
+// Number of FFTW plans to keep for reuse by later references with
+// the same dimensions, strides, transform type and precision.  0
+// creates and destroys a plan for every reference.
+extern size_t fftw_plan_cache_size;
 
-// construct and return an FFTW plan with the specified type,
-// precision, and dimensions.  cpu_out is required if we're using
-// wisdom, which runs actual FFTs to work out the best plan.
+// FFTW plans kept for reuse, least recently used first out.  Plans
+// are run with FFTW's new-array execute functions, so a cached plan
+// can run on any buffers with the same placement and alignment as
+// the ones it was planned with.  Like the FFTW planner, this is not
+// thread-safe.
+template <typename Tfftw_plan>
+class fftw_plan_cache
+{
+public:
+    static fftw_plan_cache& get()
+    {
+        static fftw_plan_cache cache;
+        return cache;
+    }
+
+    ~fftw_plan_cache()
+    {
+        for(auto& p : plans)
+            fftw_destroy_plan_type(p.second.first);
+    }
+
+    Tfftw_plan find(const std::string& key)
+    {
+        auto it = plans.find(key);
+        if(it == plans.end())
+            return nullptr;
+        lru.splice(lru.begin(), lru, it->second.second);
+        return it->second.first;
+    }
+
+    // keep a new plan, evicting the least recently used ones
+    void insert(const std::string& key, Tfftw_plan plan)
+    {
+        lru.push_front(key);
+        plans.emplace(key, std::make_pair(plan, lru.begin()));
+        while(plans.size() > fftw_plan_cache_size)
+        {
+            auto victim = plans.find(lru.back());
+            fftw_destroy_plan_type(victim->second.first);
+            plans.erase(victim);
+            lru.pop_back();
+        }
+    }
+
+    bool contains(Tfftw_plan plan) const
+    {
+        for(const auto& p : plans)
+            if(p.second.first == plan)
+                return true;
+        return false;
+    }
+
+private:
+    std::list<std::string>                                                       lru;
+    std::map<std::string, std::pair<Tfftw_plan, std::list<std::string>::iterator>> plans;
+};
+
+// done with a plan returned by fftw_plan_via_rocfft - destroy it
+// unless the plan cache owns it
+template <typename Tfloat>
+static void fftw_release_plan(typename fftw_trait<Tfloat>::fftw_plan_type plan)
+{
+    if(plan && !fftw_plan_cache<typename fftw_trait<Tfloat>::fftw_plan_type>::get().contains(plan))
+        fftw_destroy_plan_type(plan);
+}
+
+// true if FFTW keeps state between references that fftw_cleanup
+// would throw away
+inline bool fftw_state_is_reused()
+{
+    return use_fftw_wisdom || fftw_plan_cache_size > 0;
+}
+
+// create a new FFTW plan for fftw_plan_with_precision
 template <typename Tfloat>
 static typename fftw_trait<Tfloat>::fftw_plan_type
-    fftw_plan_with_precision(const std::vector<fftw_iodim64>& dims,
-                             const std::vector<fftw_iodim64>& howmany_dims,
-                             const fft_transform_type         transformType,
-                             const size_t                     isize,
-                             void*                            cpu_in,
-                             void*                            cpu_out)
+    fftw_plan_with_precision_uncached(const std::vector<fftw_iodim64>& dims,
+                                      const std::vector<fftw_iodim64>& howmany_dims,
+                                      const fft_transform_type         transformType,
+                                      const size_t                     isize,
+                                      void*                            cpu_in,
+                                      void*                            cpu_out)
 {
     using fftw_complex_type = typename fftw_trait<Tfloat>::fftw_complex_type;
 
@@ -104,6 +182,46 @@ static typename fftw_trait<Tfloat>::fftw_plan_type
     }
 }
 
+// construct and return an FFTW plan with the specified type,
+// precision, and dimensions.  cpu_out is required if we're using
+// wisdom, which runs actual FFTs to work out the best plan.
+template <typename Tfloat>
+static typename fftw_trait<Tfloat>::fftw_plan_type
+    fftw_plan_with_precision(const std::vector<fftw_iodim64>& dims,
+                             const std::vector<fftw_iodim64>& howmany_dims,
+                             const fft_transform_type         transformType,
+                             const size_t                     isize,
+                             void*                            cpu_in,
+                             void*                            cpu_out)
+{
+    using fftw_plan_type = typename fftw_trait<Tfloat>::fftw_plan_type;
+
+    // a plan is reusable for the same problem on buffers with the
+    // same placement and alignment
+    std::string key = std::to_string(transformType) + (use_fftw_wisdom ? "_measure" : "_estimate");
+    for(const auto& d : dims)
+        key += "_" + std::to_string(d.n) + "_" + std::to_string(d.is) + "_" + std::to_string(d.os);
+    for(const auto& d : howmany_dims)
+        key += "_b" + std::to_string(d.n) + "_" + std::to_string(d.is) + "_" + std::to_string(d.os);
+    key += cpu_in == cpu_out ? "_inplace" : "_notinplace";
+    key += "_" + std::to_string(fftw_alignment_of_type<Tfloat>(cpu_in));
+    if(cpu_out && cpu_out != cpu_in)
+        key += "_" + std::to_string(fftw_alignment_of_type<Tfloat>(cpu_out));
+
+    auto& cache = fftw_plan_cache<fftw_plan_type>::get();
+    if(fftw_plan_cache_size > 0)
+    {
+        auto plan = cache.find(key);
+        if(plan)
+            return plan;
+    }
+    auto plan = fftw_plan_with_precision_uncached<Tfloat>(
+        dims, howmany_dims, transformType, isize, cpu_in, cpu_out);
+    if(plan && fftw_plan_cache_size > 0)
+        cache.insert(key, plan);
+    return plan;
+}
+
 // construct an FFTW plan, given rocFFT parameters.  output is
 // required if planning with wisdom.
 template <typename Tfloat>
@@ -243,6 +243,64 @@ struct rocfft_complex
     }
 };
 
+// Half-precision complex arithmetic on AMD GPUs works on both parts
+// at once, so that FFT butterflies and twiddle multiplies use packed
+// FP16 instructions (v_pk_add_f16, v_pk_mul_f16, v_pk_fma_f16).
+#if defined(__HIP_DEVICE_COMPILE__) && !defined(__HIP_PLATFORM_NVIDIA__)
+#define ROCFFT_PACKED_HALF_MATH
+typedef _Float16 rocfft_half2_t __attribute__((ext_vector_type(2)));
+#endif
+
+template <>
+__device__ __host__ inline auto& rocfft_complex<_Float16>::operator+=(const rocfft_complex& rhs)
+{
+#ifdef ROCFFT_PACKED_HALF_MATH
+    rocfft_half2_t r = rocfft_half2_t{x, y} + rocfft_half2_t{rhs.x, rhs.y};
+    return *this = {r.x, r.y};
+#else
+    return *this = {x + rhs.x, y + rhs.y};
+#endif
+}
+
+template <>
+__device__ __host__ inline auto& rocfft_complex<_Float16>::operator-=(const rocfft_complex& rhs)
+{
+#ifdef ROCFFT_PACKED_HALF_MATH
+    rocfft_half2_t r = rocfft_half2_t{x, y} - rocfft_half2_t{rhs.x, rhs.y};
+    return *this = {r.x, r.y};
+#else
+    return *this = {x - rhs.x, y - rhs.y};
+#endif
+}
+
+template <>
+__device__ __host__ inline auto& rocfft_complex<_Float16>::operator*=(const rocfft_complex& rhs)
+{
+#ifdef ROCFFT_PACKED_HALF_MATH
+    // (x * rhs.x - y * rhs.y, x * rhs.y + y * rhs.x) as one multiply
+    // and one fma of swizzled operands
+    rocfft_half2_t r = rocfft_half2_t{x, x} * rocfft_half2_t{rhs.x, rhs.y}
+                       + rocfft_half2_t{y, y} * rocfft_half2_t{-rhs.y, rhs.x};
+    return *this = {r.x, r.y};
+#else
+    return *this = {x * rhs.x - y * rhs.y, y * rhs.x + x * rhs.y};
+#endif
+}
+
+// complex-real products convert the real operand first, so this
+// covers scaling by any real type
+template <>
+template <>
+__device__ __host__ inline auto& rocfft_complex<_Float16>::operator*=(const _Float16& rhs)
+{
+#ifdef ROCFFT_PACKED_HALF_MATH
+    rocfft_half2_t r = rocfft_half2_t{x, y} * rhs;
+    return *this = {r.x, r.y};
+#else
+    return (x *= rhs), (y *= rhs), *this;
+#endif
+}
+
 // Stream operators
 #if !defined(__HIPCC_RTC__)
 static std::ostream& operator<<(std::ostream& stream, const _Float16& f)
@@ -276,6 +334,15 @@ __device__ __host__ rocfft_complex<Treal> operator*(const U& lhs, const rocfft_c
     return {Treal(lhs) * rhs.x, Treal(lhs) * rhs.y};
 }
 
+// real-complex products in half precision go through the packed
+// complex-real product above
+template <typename U>
+__device__ __host__ rocfft_complex<_Float16> operator*(const U&                         lhs,
+                                                      const rocfft_complex<_Float16>& rhs)
+{
+    return rhs * lhs;
+}
+
 template <typename U, typename Treal>
 __device__ __host__ rocfft_complex<Treal> operator/(const U& lhs, const rocfft_complex<Treal>& rhs)
 {